@@ -0,0 +1,70 @@
+# Runs the benchmark harness of a sample on a device and compares its report with a baseline, run by the
+# <sample>-benchmark-regression targets of Sample.cmake as
+#     cmake -DADB=<adb> -DPACKAGE=<package> -DHARNESS=<harness> -DLIBRARY=<libNative.so> -DCOMPARE=<benchmark-compare>
+#           -DBASELINE=<json> -DOUTPUT=<json> [-DARGUMENTS=<harness options>] [-DCOMPARE_ARGUMENTS=<options>]
+#           -P BenchmarkRegression.cmake
+# Lists are separated by | rather than ; so they survive the command line.
+#
+# The sample has to be installed and run once, the harness runs in its sandbox where its assets were extracted.
+# The report is pulled to OUTPUT. Without a BASELINE file yet, the report becomes the baseline and nothing is
+# compared, so the first run on a known good build records it. Otherwise benchmark-compare runs on the device and
+# its table is printed, and saved next to OUTPUT; a regression fails the target.
+
+cmake_minimum_required(VERSION 3.5)
+
+foreach(variable ADB PACKAGE HARNESS LIBRARY COMPARE BASELINE OUTPUT)
+	if (NOT ${variable})
+		message(FATAL_ERROR "BenchmarkRegression.cmake needs ${variable}.")
+	endif()
+endforeach()
+
+string(REPLACE "|" ";" ARGUMENTS "${ARGUMENTS}")
+string(REPLACE "|" ";" COMPARE_ARGUMENTS "${COMPARE_ARGUMENTS}")
+
+set(device_directory /data/local/tmp/benchmark)
+get_filename_component(harness_name ${HARNESS} NAME)
+get_filename_component(compare_name ${COMPARE} NAME)
+
+function(run_adb)
+	execute_process(COMMAND ${ADB} ${ARGN} RESULT_VARIABLE result)
+	if (NOT result EQUAL 0)
+		message(FATAL_ERROR "adb ${ARGN} failed: ${result}")
+	endif()
+endfunction()
+
+run_adb(shell mkdir -p ${device_directory})
+run_adb(push ${HARNESS} ${LIBRARY} ${COMPARE} ${device_directory}/)
+
+message(STATUS "Benchmarking ${PACKAGE}")
+run_adb(shell run-as ${PACKAGE} ${device_directory}/${harness_name} --library ${device_directory}/libNative.so
+	--output files/benchmark.json ${ARGUMENTS})
+
+get_filename_component(output_directory ${OUTPUT} DIRECTORY)
+get_filename_component(output_name ${OUTPUT} NAME_WE)
+file(MAKE_DIRECTORY ${output_directory})
+execute_process(COMMAND ${ADB} exec-out run-as ${PACKAGE} cat files/benchmark.json OUTPUT_FILE ${OUTPUT} RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "Cannot pull the report of ${PACKAGE}.")
+endif()
+
+if (NOT EXISTS ${BASELINE})
+	get_filename_component(baseline_directory ${BASELINE} DIRECTORY)
+	file(MAKE_DIRECTORY ${baseline_directory})
+	configure_file(${OUTPUT} ${BASELINE} COPYONLY)
+	message(STATUS "No baseline for ${PACKAGE}, recorded ${BASELINE}.")
+	return()
+endif()
+
+# Both reports are compared where the tool was built for, the device.
+run_adb(push ${BASELINE} ${device_directory}/baseline.json)
+run_adb(push ${OUTPUT} ${device_directory}/current.json)
+execute_process(COMMAND ${ADB} shell ${device_directory}/${compare_name} --baseline ${device_directory}/baseline.json
+		--current ${device_directory}/current.json ${COMPARE_ARGUMENTS}
+	OUTPUT_VARIABLE table RESULT_VARIABLE result)
+file(WRITE ${output_directory}/${output_name}.txt "${table}")
+message("${table}")
+
+# adb shell passes the exit status on since Android 7.0, older devices are caught by the table.
+if (NOT result EQUAL 0 OR table MATCHES "REGRESSED")
+	message(FATAL_ERROR "${PACKAGE} regressed or could not be compared with ${BASELINE}.")
+endif()
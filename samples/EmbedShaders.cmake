@@ -0,0 +1,227 @@
+# Generates a header embedding shader sources, run by sample_embed_shaders() in Sample.cmake as
+#     cmake -DOUTPUT=<header> -DSHADERS=<files> [-DINCLUDE_DIRECTORIES=<dirs>] [-DPERMUTATIONS=<permutations>]
+#           [-DMINIFY=ON] [-DVALIDATOR=<glslangValidator>] -DWORK_DIRECTORY=<dir> -P EmbedShaders.cmake
+# Lists are separated by | rather than ; so they survive the command line.
+#
+# Every shader becomes a null-terminated constexpr char array named after its file, terrain.vert as terrain_vert.
+# #include "file" lines are replaced by the file, looked up next to the including file and then in
+# INCLUDE_DIRECTORIES, each file being included once. A permutation name:A,B=1 adds a terrain_vert_name array
+# with #define A and #define B 1 after the #version line. MINIFY strips comments and indentation, keeping the lines
+# the preprocessor needs. The sources have to start with #version, and are compiled by VALIDATOR if it is set.
+
+cmake_minimum_required(VERSION 3.5)
+
+foreach(variable OUTPUT SHADERS WORK_DIRECTORY)
+	if (NOT ${variable})
+		message(FATAL_ERROR "EmbedShaders.cmake needs ${variable}.")
+	endif()
+endforeach()
+
+string(REPLACE "|" ";" SHADERS "${SHADERS}")
+string(REPLACE "|" ";" INCLUDE_DIRECTORIES "${INCLUDE_DIRECTORIES}")
+string(REPLACE "|" ";" PERMUTATIONS "${PERMUTATIONS}")
+
+# Shader sources contain ; and [], which lists would split on, so they are only handled as whole strings.
+function(resolve_includes PATH SOURCE_VARIABLE)
+	file(READ ${PATH} source)
+	get_filename_component(directory ${PATH} DIRECTORY)
+	set(resolved "")
+
+	while (TRUE)
+		string(REGEX MATCH "(^|\n)[ \t]*#[ \t]*include[ \t]*\"([^\"\n]*)\"[^\n]*" directive "${source}")
+		if (NOT directive)
+			break()
+		endif()
+		set(name ${CMAKE_MATCH_2})
+		string(FIND "${source}" "${directive}" position)
+		string(LENGTH "${directive}" length)
+		math(EXPR end "${position} + ${length}")
+		string(SUBSTRING "${source}" 0 ${position} before)
+		string(SUBSTRING "${source}" ${end} -1 source)
+		string(APPEND resolved "${before}")
+		if (CMAKE_MATCH_1)
+			string(APPEND resolved "\n")
+		endif()
+
+		set(included "")
+		foreach(include_directory ${directory} ${INCLUDE_DIRECTORIES})
+			if (NOT included AND EXISTS ${include_directory}/${name})
+				get_filename_component(included ${include_directory}/${name} ABSOLUTE)
+			endif()
+		endforeach()
+		if (NOT included)
+			message(FATAL_ERROR "${PATH}: cannot find the included file ${name}.")
+		endif()
+
+		list(FIND INCLUDED_FILES ${included} found)
+		if (found EQUAL -1)
+			set(INCLUDED_FILES ${INCLUDED_FILES} ${included})
+			resolve_includes(${included} included_source)
+			string(APPEND resolved "${included_source}")
+		endif()
+	endwhile()
+
+	string(APPEND resolved "${source}")
+	set(INCLUDED_FILES ${INCLUDED_FILES} PARENT_SCOPE)
+	set(${SOURCE_VARIABLE} "${resolved}" PARENT_SCOPE)
+endfunction()
+
+# Comments are removed in one pass, as // may be inside a block comment and /* after a line comment.
+function(minify SOURCE_VARIABLE)
+	set(source "${${SOURCE_VARIABLE}}")
+	set(minified "")
+
+	while (TRUE)
+		string(FIND "${source}" "/*" block)
+		string(FIND "${source}" "//" line)
+		if (block EQUAL -1 AND line EQUAL -1)
+			break()
+		endif()
+
+		if (line EQUAL -1 OR (NOT block EQUAL -1 AND block LESS line))
+			string(SUBSTRING "${source}" 0 ${block} before)
+			math(EXPR start "${block} + 2")
+			string(SUBSTRING "${source}" ${start} -1 source)
+			string(FIND "${source}" "*/" end)
+			if (end EQUAL -1)
+				message(FATAL_ERROR "Unterminated comment.")
+			endif()
+			string(SUBSTRING "${source}" 0 ${end} comment)
+			math(EXPR end "${end} + 2")
+			string(SUBSTRING "${source}" ${end} -1 source)
+
+			# A comment over several lines still ends the line it starts on, which may be a directive.
+			string(APPEND minified "${before}")
+			string(FIND "${comment}" "\n" newline)
+			if (newline EQUAL -1)
+				string(APPEND minified " ")
+			else()
+				string(APPEND minified "\n")
+			endif()
+		else()
+			string(SUBSTRING "${source}" 0 ${line} before)
+			string(SUBSTRING "${source}" ${line} -1 source)
+			string(FIND "${source}" "\n" end)
+			if (end EQUAL -1)
+				set(source "")
+			else()
+				string(SUBSTRING "${source}" ${end} -1 source)
+			endif()
+			string(APPEND minified "${before}")
+		endif()
+	endwhile()
+	string(APPEND minified "${source}")
+
+	string(REGEX REPLACE "[ \t\r]+" " " minified "${minified}")
+	string(REGEX REPLACE " ?\n ?" "\n" minified "${minified}")
+	string(REGEX REPLACE "\n\n+" "\n" minified "${minified}")
+	string(STRIP "${minified}" minified)
+	set(${SOURCE_VARIABLE} "${minified}\n" PARENT_SCOPE)
+endfunction()
+
+# The stage of glslangValidator from the file extension, including the short ones used by the samples.
+function(shader_stage PATH STAGE_VARIABLE)
+	get_filename_component(extension ${PATH} EXT)
+	string(REGEX REPLACE ".*\\." "" extension "${extension}")
+	set(stage "")
+	if (extension MATCHES "^(vert|vs)$")
+		set(stage vert)
+	elseif (extension MATCHES "^(frag|fs)$")
+		set(stage frag)
+	elseif (extension MATCHES "^(comp|cs)$")
+		set(stage comp)
+	elseif (extension MATCHES "^(geom|gs)$")
+		set(stage geom)
+	elseif (extension MATCHES "^(tesc|tcs)$")
+		set(stage tesc)
+	elseif (extension MATCHES "^(tese|tes)$")
+		set(stage tese)
+	endif()
+	set(${STAGE_VARIABLE} ${stage} PARENT_SCOPE)
+endfunction()
+
+get_filename_component(header_name ${OUTPUT} NAME)
+string(MAKE_C_IDENTIFIER "${header_name}" guard)
+string(TOUPPER "EMBEDDED_${guard}" guard)
+
+set(header "/* Generated by EmbedShaders.cmake, do not edit. */\n\n#ifndef ${guard}\n#define ${guard}\n")
+file(MAKE_DIRECTORY ${WORK_DIRECTORY})
+
+foreach(shader ${SHADERS})
+	set(INCLUDED_FILES "")
+	resolve_includes(${shader} source)
+
+	if (NOT source MATCHES "^[ \t\r\n]*(/\\*([^*]|\\*+[^*/])*\\*+/[ \t\r\n]*|//[^\n]*\n[ \t\r\n]*)*#[ \t]*version[^\n]*\n")
+		message(FATAL_ERROR "${shader}: the source has to start with a #version line.")
+	endif()
+	set(version_line "${CMAKE_MATCH_0}")
+	string(LENGTH "${version_line}" version_length)
+	string(SUBSTRING "${source}" ${version_length} -1 body)
+
+	get_filename_component(file_name ${shader} NAME)
+	string(MAKE_C_IDENTIFIER "${file_name}" symbol)
+	shader_stage(${shader} stage)
+
+	# The shader itself first, then one array per permutation.
+	foreach(permutation "" ${PERMUTATIONS})
+		set(variant_symbol ${symbol})
+		set(defines "")
+		set(description "")
+		if (permutation)
+			string(FIND "${permutation}" ":" separator)
+			if (separator LESS 1)
+				message(FATAL_ERROR "Permutation ${permutation} is not name:DEFINE,DEFINE=value.")
+			endif()
+			string(SUBSTRING "${permutation}" 0 ${separator} permutation_name)
+			math(EXPR separator "${separator} + 1")
+			string(SUBSTRING "${permutation}" ${separator} -1 permutation_defines)
+			string(MAKE_C_IDENTIFIER "${permutation_name}" permutation_name)
+			set(variant_symbol ${symbol}_${permutation_name})
+
+			string(REPLACE "," ";" permutation_defines "${permutation_defines}")
+			string(REPLACE ";" " " description ", with ${permutation_defines}")
+			foreach(define ${permutation_defines})
+				string(REPLACE "=" " " define "${define}")
+				string(APPEND defines "#define ${define}\n")
+			endforeach()
+		endif()
+
+		set(variant "${version_line}${defines}${body}")
+		if (MINIFY)
+			minify(variant)
+		endif()
+
+		set(variant_file ${WORK_DIRECTORY}/${variant_symbol}.${stage})
+		if (NOT stage)
+			set(variant_file ${WORK_DIRECTORY}/${variant_symbol}.glsl)
+		endif()
+		file(WRITE ${variant_file} "${variant}")
+
+		if (VALIDATOR AND stage)
+			execute_process(COMMAND ${VALIDATOR} ${variant_file} RESULT_VARIABLE result OUTPUT_VARIABLE log ERROR_VARIABLE log)
+			if (NOT result EQUAL 0)
+				message(FATAL_ERROR "${shader} (${variant_symbol}) does not compile, see ${variant_file}:\n${log}")
+			endif()
+		endif()
+
+		# Bytes rather than a string literal, which would need escaping and is limited in length by some compilers.
+		file(READ ${variant_file} bytes HEX)
+		string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1, " bytes "${bytes}")
+		string(REGEX REPLACE "(0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., 0x.., )" "\\1\n    " bytes "${bytes}")
+
+		file(RELATIVE_PATH shader_path ${CMAKE_CURRENT_LIST_DIR} ${shader})
+		string(APPEND header "\n/* ${shader_path}${description} */\n")
+		string(APPEND header "static constexpr char ${variant_symbol}[] =\n{\n    ${bytes}0x00\n};\n")
+	endforeach()
+endforeach()
+
+string(APPEND header "\n#endif /* ${guard} */\n")
+
+# Only touch the header when it changes, so the sample is not recompiled for nothing.
+set(previous "")
+if (EXISTS ${OUTPUT})
+	file(READ ${OUTPUT} previous)
+endif()
+if (NOT previous STREQUAL header)
+	file(WRITE ${OUTPUT} "${header}")
+endif()
@@ -1,3 +1,92 @@
+# The benchmark harness lives with the common native code of the advanced samples.
+set(SAMPLE_BENCHMARK_SOURCE ${CMAKE_CURRENT_LIST_DIR}/advanced_samples/common_native/benchmark/Benchmark.cpp)
+set(SAMPLE_BENCHMARK_COMPARE_SOURCE ${CMAKE_CURRENT_LIST_DIR}/advanced_samples/common_native/benchmark/BenchmarkCompare.cpp)
+set(SAMPLE_BENCHMARK_REGRESSION_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/BenchmarkRegression.cmake)
+
+# The regression targets run the harness on the device adb is connected to, and compare with the baselines.
+find_program(ADB adb)
+set(BENCHMARK_SAMPLES "" CACHE STRING "Samples checked by the benchmark-regression target, all the samples built if empty.")
+set(BENCHMARK_BASELINE_DIRECTORY ${CMAKE_CURRENT_LIST_DIR}/benchmark_baselines CACHE PATH "Baseline reports, one <sample>.json per sample.")
+set(BENCHMARK_ARGUMENTS "--frames|1000" CACHE STRING "Options of the harness in regression runs, separated by |.")
+set(BENCHMARK_COMPARE_ARGUMENTS "--threshold|0.05" CACHE STRING "Options of benchmark-compare in regression runs, separated by |.")
+
+# The native render-thread host, built into samples added with the NATIVE_HOST option.
+set(SAMPLE_NATIVE_HOST_SOURCE ${CMAKE_CURRENT_LIST_DIR}/advanced_samples/common_native/host/NativeHost.cpp)
+
+# Shaders built into the samples by sample_embed_shaders(), compiled by glslangValidator when it is installed.
+set(SAMPLE_EMBED_SHADERS_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/EmbedShaders.cmake)
+find_program(GLSLANG_VALIDATOR glslangValidator)
+
+function(sample_jni_prefix OUTPUT SOURCES)
+	# The harness and the host find the JNI entry points by name, take the prefix from the sample's step() function.
+	set(jni_prefix "")
+	foreach(source ${SOURCES})
+		file(STRINGS ${source} step_lines REGEX "Java_[A-Za-z0-9_]+_step")
+		if (step_lines AND NOT jni_prefix)
+			string(REGEX MATCH "Java_[A-Za-z0-9_]+_step" jni_step "${step_lines}")
+			string(REGEX REPLACE "_step$" "" jni_prefix "${jni_step}")
+		endif()
+	endforeach()
+	set(${OUTPUT} "${jni_prefix}" PARENT_SCOPE)
+endfunction()
+
+function(add_sample_benchmark TARGET SOURCES COMMON_TARGET)
+	sample_jni_prefix(jni_prefix "${SOURCES}")
+
+	# The sample library is loaded at run time, it is only a dependency so both get built together.
+	add_executable(${TARGET}-benchmark ${SAMPLE_BENCHMARK_SOURCE})
+	target_link_libraries(${TARGET}-benchmark ${COMMON_TARGET})
+	target_compile_definitions(${TARGET}-benchmark PRIVATE BENCHMARK_JNI_PREFIX="${jni_prefix}")
+	add_dependencies(${TARGET}-benchmark ${TARGET})
+
+	# One comparison tool for every sample of the build, it only reads reports.
+	if (NOT TARGET benchmark-compare)
+		add_executable(benchmark-compare ${SAMPLE_BENCHMARK_COMPARE_SOURCE})
+		target_link_libraries(benchmark-compare ${COMMON_TARGET})
+	endif()
+	add_sample_benchmark_regression(${TARGET})
+endfunction()
+
+function(add_sample_benchmark_regression TARGET)
+	if (NOT ADB)
+		return()
+	endif()
+	if (BENCHMARK_SAMPLES AND NOT ${TARGET} IN_LIST BENCHMARK_SAMPLES)
+		return()
+	endif()
+
+	# run-as needs the package of the installed sample.
+	file(STRINGS ${CMAKE_CURRENT_SOURCE_DIR}/AndroidManifest.xml manifest_lines REGEX "package=\"[^\"]+\"")
+	string(REGEX MATCH "package=\"([^\"]+)\"" package "${manifest_lines}")
+	if (NOT package)
+		return()
+	endif()
+	set(package ${CMAKE_MATCH_1})
+
+	add_custom_target(${TARGET}-benchmark-regression
+		COMMAND ${CMAKE_COMMAND} -DADB=${ADB} -DPACKAGE=${package} -DHARNESS=$<TARGET_FILE:${TARGET}-benchmark>
+			-DLIBRARY=$<TARGET_FILE:${TARGET}> -DCOMPARE=$<TARGET_FILE:benchmark-compare>
+			-DBASELINE=${BENCHMARK_BASELINE_DIRECTORY}/${TARGET}.json -DOUTPUT=${CMAKE_BINARY_DIR}/benchmark_reports/${TARGET}.json
+			-DARGUMENTS=${BENCHMARK_ARGUMENTS} -DCOMPARE_ARGUMENTS=${BENCHMARK_COMPARE_ARGUMENTS}
+			-P ${SAMPLE_BENCHMARK_REGRESSION_SCRIPT}
+		COMMENT "Checking ${TARGET} for performance regressions"
+		VERBATIM)
+	add_dependencies(${TARGET}-benchmark-regression ${TARGET}-benchmark benchmark-compare)
+
+	# Builds the regression targets of every sample in the set, the reports are in benchmark_reports.
+	if (NOT TARGET benchmark-regression)
+		add_custom_target(benchmark-regression)
+	endif()
+	add_dependencies(benchmark-regression ${TARGET}-benchmark-regression)
+endfunction()
+
+function(add_sample_native_host TARGET SOURCES)
+	# Hosted by android.app.NativeActivity, which drives the same entry points from a render thread of its own.
+	sample_jni_prefix(jni_prefix "${SOURCES}")
+	target_sources(${TARGET} PRIVATE ${SAMPLE_NATIVE_HOST_SOURCE})
+	target_compile_definitions(${TARGET} PRIVATE NATIVE_HOST_JNI_PREFIX="${jni_prefix}")
+endfunction()
+
 function(add_sample_inner TARGET SOURCES)
 	# For Android, always emit libnative.so since we only build one sample per APK.
 	# Otherwise, we want to control our output folder so we can pick up assets without any problems.
@@ -5,6 +94,10 @@ function(add_sample_inner TARGET SOURCES)
 	target_link_libraries(${TARGET} common-native)
 	set_target_properties(${TARGET} PROPERTIES LIBRARY_OUTPUT_NAME Native)
 	target_include_directories(${TARGET} PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/jni)
+	add_sample_benchmark(${TARGET} "${SOURCES}" common-native)
+	if (NATIVE_HOST IN_LIST ARGN)
+		add_sample_native_host(${TARGET} "${SOURCES}")
+	endif()
 endfunction()
 
 function(add_sample_inner_gles3 TARGET SOURCES)
@@ -14,16 +107,76 @@ function(add_sample_inner_gles3 TARGET SOURCES)
 	target_link_libraries(${TARGET} common-native-gles3)
 	set_target_properties(${TARGET} PROPERTIES LIBRARY_OUTPUT_NAME Native)
 	target_include_directories(${TARGET} PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/jni)
+	add_sample_benchmark(${TARGET} "${SOURCES}" common-native-gles3)
+	if (NATIVE_HOST IN_LIST ARGN)
+		add_sample_native_host(${TARGET} "${SOURCES}")
+	endif()
 endfunction()
 
+# Pass NATIVE_HOST after the sources to run the sample in android.app.NativeActivity instead of its Java activity.
 function(add_sample TARGET SOURCES)
 	if (${FILTER_TARGET} STREQUAL ${TARGET})
-		add_sample_inner(${TARGET} "${SOURCES}")
+		add_sample_inner(${TARGET} "${SOURCES}" ${ARGN})
 	endif(${FILTER_TARGET} STREQUAL ${TARGET})
 endfunction()
 
 function(add_sample_gles3 TARGET SOURCES)
 	if (${FILTER_TARGET} STREQUAL ${TARGET})
-		add_sample_inner_gles3(${TARGET} "${SOURCES}")
+		add_sample_inner_gles3(${TARGET} "${SOURCES}" ${ARGN})
 	endif(${FILTER_TARGET} STREQUAL ${TARGET})
 endfunction()
+
+# Embeds shader files into a sample as a generated header of constexpr char arrays, so they need no asset loading:
+#     sample_embed_shaders(${sample} shaders.h SHADERS jni/shaders/a.vert jni/shaders/a.frag
+#                          [INCLUDE_DIRECTORIES dirs...] [PERMUTATIONS name:DEFINE,DEFINE=value ...] [MINIFY])
+# Call it after add_sample(), see EmbedShaders.cmake for what is done to the sources.
+function(sample_embed_shaders TARGET HEADER)
+	# Samples not matching FILTER_TARGET have no target.
+	if (NOT TARGET ${TARGET})
+		return()
+	endif()
+
+	cmake_parse_arguments(EMBED "MINIFY" "" "SHADERS;INCLUDE_DIRECTORIES;PERMUTATIONS" ${ARGN})
+
+	set(output_directory ${CMAKE_CURRENT_BINARY_DIR}/embedded_shaders)
+	set(output ${output_directory}/${HEADER})
+
+	# Includes are only known once resolved, so anything next to the shaders or in the include directories is a dependency.
+	set(shaders "")
+	set(include_directories "")
+	set(dependencies ${SAMPLE_EMBED_SHADERS_SCRIPT})
+	foreach(shader ${EMBED_SHADERS})
+		get_filename_component(shader ${shader} ABSOLUTE)
+		get_filename_component(shader_directory ${shader} DIRECTORY)
+		file(GLOB shader_directory_files ${shader_directory}/*)
+		list(APPEND shaders ${shader})
+		list(APPEND dependencies ${shader_directory_files})
+	endforeach()
+	foreach(include_directory ${EMBED_INCLUDE_DIRECTORIES})
+		get_filename_component(include_directory ${include_directory} ABSOLUTE)
+		file(GLOB include_directory_files ${include_directory}/*)
+		list(APPEND include_directories ${include_directory})
+		list(APPEND dependencies ${include_directory_files})
+	endforeach()
+	list(REMOVE_DUPLICATES dependencies)
+
+	set(validator "")
+	if (GLSLANG_VALIDATOR)
+		set(validator ${GLSLANG_VALIDATOR})
+	endif()
+
+	string(REPLACE ";" "|" shaders "${shaders}")
+	string(REPLACE ";" "|" include_directories "${include_directories}")
+	string(REPLACE ";" "|" permutations "${EMBED_PERMUTATIONS}")
+
+	add_custom_command(OUTPUT ${output}
+		COMMAND ${CMAKE_COMMAND} -DOUTPUT=${output} -DSHADERS=${shaders} -DINCLUDE_DIRECTORIES=${include_directories}
+			-DPERMUTATIONS=${permutations} -DMINIFY=${EMBED_MINIFY} -DVALIDATOR=${validator}
+			-DWORK_DIRECTORY=${output_directory}/${HEADER}.sources -P ${SAMPLE_EMBED_SHADERS_SCRIPT}
+		DEPENDS ${dependencies}
+		COMMENT "Embedding shaders in ${HEADER}"
+		VERBATIM)
+
+	target_sources(${TARGET} PRIVATE ${output})
+	target_include_directories(${TARGET} PRIVATE ${output_directory})
+endfunction()
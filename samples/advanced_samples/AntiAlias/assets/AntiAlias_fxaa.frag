@@ -0,0 +1,187 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * FXAA, single pass over the resolved scene. The luma gradient of the 3x3 neighbourhood decides
+ * whether the pixel is on an edge and which way it runs, then the edge is followed both ways
+ * until the luma changes, and the pixel is resampled across the edge by how close it is to the nearer end.
+ * The scene texture must be bilinearly filtered.
+ */
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+/* Smallest contrast considered an edge, relative to the brightest of the neighbourhood, and absolute for dark areas. */
+#define EDGE_THRESHOLD 0.125
+#define EDGE_THRESHOLD_MIN 0.0312
+/* Steps taken along the edge in each direction, the later ones skip texels. */
+#define SEARCH_STEPS 8
+/* How much of the sub-pixel aliasing is removed, 0 to 1. */
+#define SUBPIXEL_QUALITY 0.75
+
+uniform sampler2D u_s2dColor;
+uniform vec2 u_v2TexelSize;
+
+varying vec2 v_v2TexCoord;
+
+float luma(vec3 color)
+{
+    return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+float lumaAt(vec2 texCoord)
+{
+    return luma(texture2D(u_s2dColor, texCoord).rgb);
+}
+
+float stepScale(int step)
+{
+    return step < 4 ? 1.0 : (step < 6 ? 2.0 : 4.0);
+}
+
+void main()
+{
+    vec2 uv = v_v2TexCoord;
+    vec3 colorCenter = texture2D(u_s2dColor, uv).rgb;
+
+    float lumaCenter = luma(colorCenter);
+    float lumaDown = lumaAt(uv + vec2(0.0, -u_v2TexelSize.y));
+    float lumaUp = lumaAt(uv + vec2(0.0, u_v2TexelSize.y));
+    float lumaLeft = lumaAt(uv + vec2(-u_v2TexelSize.x, 0.0));
+    float lumaRight = lumaAt(uv + vec2(u_v2TexelSize.x, 0.0));
+
+    float lumaMin = min(lumaCenter, min(min(lumaDown, lumaUp), min(lumaLeft, lumaRight)));
+    float lumaMax = max(lumaCenter, max(max(lumaDown, lumaUp), max(lumaLeft, lumaRight)));
+    float lumaRange = lumaMax - lumaMin;
+
+    /* Most pixels are not on an edge and leave here after five fetches. */
+    if (lumaRange < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD))
+    {
+        gl_FragColor = vec4(colorCenter, 1.0);
+        return;
+    }
+
+    float lumaDownLeft = lumaAt(uv - u_v2TexelSize);
+    float lumaUpRight = lumaAt(uv + u_v2TexelSize);
+    float lumaUpLeft = lumaAt(uv + vec2(-u_v2TexelSize.x, u_v2TexelSize.y));
+    float lumaDownRight = lumaAt(uv + vec2(u_v2TexelSize.x, -u_v2TexelSize.y));
+
+    float lumaDownUp = lumaDown + lumaUp;
+    float lumaLeftRight = lumaLeft + lumaRight;
+    float lumaLeftCorners = lumaDownLeft + lumaUpLeft;
+    float lumaDownCorners = lumaDownLeft + lumaDownRight;
+    float lumaRightCorners = lumaDownRight + lumaUpRight;
+    float lumaUpCorners = lumaUpRight + lumaUpLeft;
+
+    float edgeHorizontal = abs(-2.0 * lumaLeft + lumaLeftCorners) + abs(-2.0 * lumaCenter + lumaDownUp) * 2.0 + abs(-2.0 * lumaRight + lumaRightCorners);
+    float edgeVertical = abs(-2.0 * lumaUp + lumaUpCorners) + abs(-2.0 * lumaCenter + lumaLeftRight) * 2.0 + abs(-2.0 * lumaDown + lumaDownCorners);
+    bool isHorizontal = edgeHorizontal >= edgeVertical;
+
+    /* Pick the side of the pixel the edge is on. */
+    float luma1 = isHorizontal ? lumaDown : lumaLeft;
+    float luma2 = isHorizontal ? lumaUp : lumaRight;
+    float gradient1 = luma1 - lumaCenter;
+    float gradient2 = luma2 - lumaCenter;
+    bool is1Steepest = abs(gradient1) >= abs(gradient2);
+    float gradientScaled = 0.25 * max(abs(gradient1), abs(gradient2));
+
+    float stepLength = isHorizontal ? u_v2TexelSize.y : u_v2TexelSize.x;
+    float lumaLocalAverage;
+    if (is1Steepest)
+    {
+        stepLength = -stepLength;
+        lumaLocalAverage = 0.5 * (luma1 + lumaCenter);
+    }
+    else
+    {
+        lumaLocalAverage = 0.5 * (luma2 + lumaCenter);
+    }
+
+    /* Search from half a texel towards the edge, so bilinear filtering averages both sides of it. */
+    vec2 currentUv = uv;
+    if (isHorizontal)
+    {
+        currentUv.y += stepLength * 0.5;
+    }
+    else
+    {
+        currentUv.x += stepLength * 0.5;
+    }
+
+    vec2 offset = isHorizontal ? vec2(u_v2TexelSize.x, 0.0) : vec2(0.0, u_v2TexelSize.y);
+    vec2 uv1 = currentUv;
+    vec2 uv2 = currentUv;
+    float lumaEnd1 = 0.0;
+    float lumaEnd2 = 0.0;
+    bool reached1 = false;
+    bool reached2 = false;
+
+    for (int i = 0; i < SEARCH_STEPS; i++)
+    {
+        if (!reached1)
+        {
+            uv1 -= offset * stepScale(i);
+            lumaEnd1 = lumaAt(uv1) - lumaLocalAverage;
+            reached1 = abs(lumaEnd1) >= gradientScaled;
+        }
+        if (!reached2)
+        {
+            uv2 += offset * stepScale(i);
+            lumaEnd2 = lumaAt(uv2) - lumaLocalAverage;
+            reached2 = abs(lumaEnd2) >= gradientScaled;
+        }
+        if (reached1 && reached2)
+        {
+            break;
+        }
+    }
+
+    float distance1 = isHorizontal ? (uv.x - uv1.x) : (uv.y - uv1.y);
+    float distance2 = isHorizontal ? (uv2.x - uv.x) : (uv2.y - uv.y);
+    bool isDirection1 = distance1 < distance2;
+    float distanceFinal = min(distance1, distance2);
+    float edgeLength = distance1 + distance2;
+
+    /* Only move towards the edge if the nearer end agrees on which side of the edge the pixel is. */
+    bool isLumaCenterSmaller = lumaCenter < lumaLocalAverage;
+    bool correctVariation = ((isDirection1 ? lumaEnd1 : lumaEnd2) < 0.0) != isLumaCenterSmaller;
+    float pixelOffset = correctVariation ? 0.5 - distanceFinal / edgeLength : 0.0;
+
+    /* Thin features shorter than the search, blended by how much the pixel stands out of its neighbourhood. */
+    float lumaAverage = (1.0 / 12.0) * (2.0 * (lumaDownUp + lumaLeftRight) + lumaLeftCorners + lumaRightCorners);
+    float subPixelOffset1 = clamp(abs(lumaAverage - lumaCenter) / lumaRange, 0.0, 1.0);
+    float subPixelOffset2 = (-2.0 * subPixelOffset1 + 3.0) * subPixelOffset1 * subPixelOffset1;
+    pixelOffset = max(pixelOffset, subPixelOffset2 * subPixelOffset2 * SUBPIXEL_QUALITY);
+
+    vec2 finalUv = uv;
+    if (isHorizontal)
+    {
+        finalUv.y += pixelOffset * stepLength;
+    }
+    else
+    {
+        finalUv.x += pixelOffset * stepLength;
+    }
+
+    gl_FragColor = vec4(texture2D(u_s2dColor, finalUv).rgb, 1.0);
+}
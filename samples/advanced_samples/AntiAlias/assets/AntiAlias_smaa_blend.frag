@@ -0,0 +1,67 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * SMAA 1x, pass 3 of 3: neighbourhood blending.
+ * Each pixel mixes in its four neighbours by the weights of the edges it shares with them,
+ * which are stored on the pixel above or to the right of the edge.
+ */
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+uniform sampler2D u_s2dColor;
+uniform sampler2D u_s2dWeights;
+uniform vec2 u_v2TexelSize;
+
+varying vec2 v_v2TexCoord;
+
+void main()
+{
+    vec2 uv = v_v2TexCoord;
+    vec4 weights = texture2D(u_s2dWeights, uv);
+    float weightUp = texture2D(u_s2dWeights, uv + vec2(0.0, u_v2TexelSize.y)).g;
+    float weightRight = texture2D(u_s2dWeights, uv + vec2(u_v2TexelSize.x, 0.0)).a;
+    vec4 color = texture2D(u_s2dColor, uv);
+
+    float weightSum = weights.r + weights.b + weightUp + weightRight;
+    if (weightSum == 0.0)
+    {
+        gl_FragColor = color;
+        return;
+    }
+
+    vec4 blended = weights.r * texture2D(u_s2dColor, uv + vec2(0.0, -u_v2TexelSize.y))
+                 + weights.b * texture2D(u_s2dColor, uv + vec2(-u_v2TexelSize.x, 0.0))
+                 + weightUp * texture2D(u_s2dColor, uv + vec2(0.0, u_v2TexelSize.y))
+                 + weightRight * texture2D(u_s2dColor, uv + vec2(u_v2TexelSize.x, 0.0));
+
+    /* Corners can collect more than a whole pixel worth of weight. */
+    if (weightSum > 1.0)
+    {
+        blended /= weightSum;
+        weightSum = 1.0;
+    }
+
+    gl_FragColor = color * (1.0 - weightSum) + blended;
+}
@@ -0,0 +1,75 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * SMAA 1x, pass 1 of 3: luma edge detection.
+ * Red marks an edge with the pixel on the left, green an edge with the pixel below.
+ * Weak edges next to a much stronger one are dropped (local contrast adaptation), as they are mostly
+ * the other side of the same staircase and would blur it twice.
+ */
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+#define EDGE_THRESHOLD 0.1
+#define LOCAL_CONTRAST_ADAPTATION_FACTOR 2.0
+
+uniform sampler2D u_s2dColor;
+uniform vec2 u_v2TexelSize;
+
+varying vec2 v_v2TexCoord;
+
+float lumaAt(vec2 offset)
+{
+    return dot(texture2D(u_s2dColor, v_v2TexCoord + offset * u_v2TexelSize).rgb, vec3(0.299, 0.587, 0.114));
+}
+
+void main()
+{
+    float lumaCenter = lumaAt(vec2(0.0, 0.0));
+    float lumaLeft = lumaAt(vec2(-1.0, 0.0));
+    float lumaDown = lumaAt(vec2(0.0, -1.0));
+
+    vec2 delta = abs(lumaCenter - vec2(lumaLeft, lumaDown));
+    vec2 edges = step(EDGE_THRESHOLD, delta);
+
+    if (edges.x + edges.y == 0.0)
+    {
+        gl_FragColor = vec4(0.0);
+        return;
+    }
+
+    /* The largest contrast around both edges, including the far side of the left and bottom neighbours. */
+    float lumaRight = lumaAt(vec2(1.0, 0.0));
+    float lumaUp = lumaAt(vec2(0.0, 1.0));
+    float lumaLeftLeft = lumaAt(vec2(-2.0, 0.0));
+    float lumaDownDown = lumaAt(vec2(0.0, -2.0));
+
+    vec2 deltaMax = max(delta, abs(lumaCenter - vec2(lumaRight, lumaUp)));
+    deltaMax = max(deltaMax, abs(vec2(lumaLeft, lumaDown) - vec2(lumaLeftLeft, lumaDownDown)));
+    float finalDelta = max(deltaMax.x, deltaMax.y);
+
+    edges *= step(finalDelta, LOCAL_CONTRAST_ADAPTATION_FACTOR * delta);
+
+    gl_FragColor = vec4(edges, 0.0, 0.0);
+}
@@ -0,0 +1,170 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * SMAA 1x, pass 2 of 3: blending weights.
+ * For both edges of the pixel, the edge is followed to its two ends and the edges crossing it there
+ * tell the shape of the staircase (L, Z or U). The silhouette is reconstructed as a line through the
+ * middle of the crossing edges and the area it cuts out of the pixel and its neighbour becomes the weight.
+ * Reference SMAA reads the areas from a precomputed texture and searches with bilinear fetches.
+ * Here the area is computed analytically and the search takes one texel per step, so no lookup textures are needed.
+ *
+ * Red is how much of the pixel below is blended into this one, green how much of this one is blended into the one below.
+ * Blue and alpha are the same for the pixel on the left.
+ */
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+#define MAX_SEARCH_STEPS 16
+
+uniform sampler2D u_s2dEdges;
+uniform vec2 u_v2TexelSize;
+
+varying vec2 v_v2TexCoord;
+
+vec4 edgesAt(vec2 offset)
+{
+    return texture2D(u_s2dEdges, v_v2TexCoord + offset * u_v2TexelSize);
+}
+
+/* Area under a line falling from half a pixel at 0 to nothing at lineLength, between offset and offset + 1. */
+float coverage(float offset, float lineLength)
+{
+    float start = 0.5 * (1.0 - offset / lineLength);
+
+    if (offset + 1.0 <= lineLength)
+    {
+        return start - 0.25 / lineLength;
+    }
+    else if (offset < lineLength)
+    {
+        return 0.5 * start * (lineLength - offset);
+    }
+
+    return 0.0;
+}
+
+/*
+ * Weights of one edge, from the distances to its ends and the crossing edges found there:
+ * 1 when the crossing edge is on this pixel's side, -1 on the neighbour's side, 0 for none.
+ */
+vec2 area(float distance1, float distance2, float crossing1, float crossing2)
+{
+    float edgeLength = distance1 + distance2 + 1.0;
+    float offset = min(distance1, distance2);
+    float crossingNear = distance1 <= distance2 ? crossing1 : crossing2;
+    float crossingFar = distance1 <= distance2 ? crossing2 : crossing1;
+    float side;
+    float weight;
+
+    if (crossingNear != 0.0)
+    {
+        /* The line ends in the middle of the edge for Z and U shapes, at the far end for L shapes. */
+        side = crossingNear;
+        weight = coverage(offset, crossingFar != 0.0 ? 0.5 * edgeLength : edgeLength);
+    }
+    else
+    {
+        side = crossingFar;
+        weight = coverage(edgeLength - 1.0 - offset, edgeLength);
+    }
+
+    if (side > 0.0)
+    {
+        return vec2(weight, 0.0);
+    }
+    else if (side < 0.0)
+    {
+        return vec2(0.0, weight);
+    }
+
+    return vec2(0.0);
+}
+
+void main()
+{
+    vec2 edges = edgesAt(vec2(0.0)).rg;
+    vec4 weights = vec4(0.0);
+
+    if (edges.g > 0.0)
+    {
+        /* Edge with the pixel below, runs horizontally. */
+        float distanceLeft = 0.0;
+        float distanceRight = 0.0;
+
+        for (int i = 1; i <= MAX_SEARCH_STEPS; i++)
+        {
+            if (edgesAt(vec2(-float(i), 0.0)).g == 0.0)
+            {
+                break;
+            }
+            distanceLeft += 1.0;
+        }
+        for (int i = 1; i <= MAX_SEARCH_STEPS; i++)
+        {
+            if (edgesAt(vec2(float(i), 0.0)).g == 0.0)
+            {
+                break;
+            }
+            distanceRight += 1.0;
+        }
+
+        /* Vertical edges on the left of the first pixel and on the right of the last one, in both rows. */
+        float crossingLeft = edgesAt(vec2(-distanceLeft, 0.0)).r - edgesAt(vec2(-distanceLeft, -1.0)).r;
+        float crossingRight = edgesAt(vec2(distanceRight + 1.0, 0.0)).r - edgesAt(vec2(distanceRight + 1.0, -1.0)).r;
+
+        weights.rg = area(distanceLeft, distanceRight, crossingLeft, crossingRight);
+    }
+
+    if (edges.r > 0.0)
+    {
+        /* Edge with the pixel on the left, runs vertically. */
+        float distanceDown = 0.0;
+        float distanceUp = 0.0;
+
+        for (int i = 1; i <= MAX_SEARCH_STEPS; i++)
+        {
+            if (edgesAt(vec2(0.0, -float(i))).r == 0.0)
+            {
+                break;
+            }
+            distanceDown += 1.0;
+        }
+        for (int i = 1; i <= MAX_SEARCH_STEPS; i++)
+        {
+            if (edgesAt(vec2(0.0, float(i))).r == 0.0)
+            {
+                break;
+            }
+            distanceUp += 1.0;
+        }
+
+        float crossingDown = edgesAt(vec2(0.0, -distanceDown)).g - edgesAt(vec2(-1.0, -distanceDown)).g;
+        float crossingUp = edgesAt(vec2(0.0, distanceUp + 1.0)).g - edgesAt(vec2(-1.0, distanceUp + 1.0)).g;
+
+        weights.ba = area(distanceDown, distanceUp, crossingDown, crossingUp);
+    }
+
+    gl_FragColor = weights;
+}
@@ -0,0 +1,90 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Temporal anti-aliasing resolve. The scene is rendered with a different sub-pixel offset every frame,
+ * and accumulated into the history by following the motion vectors back to where the pixel was.
+ * The history is clamped to the colours around the pixel in the current frame, which rejects what
+ * became visible or changed since, instead of leaving a trail behind moving edges.
+ */
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+#define VELOCITY_SUBPIXELS 8.0
+
+uniform sampler2D u_s2dColor;
+uniform sampler2D u_s2dHistory;
+uniform sampler2D u_s2dVelocity;
+uniform vec2 u_v2TexelSize;
+/* Weight of the current frame, 1 when there is no history yet. */
+uniform float u_fBlend;
+
+varying vec2 v_v2TexCoord;
+
+vec2 velocityAt(vec2 offset)
+{
+    vec2 encoded = texture2D(u_s2dVelocity, v_v2TexCoord + offset * u_v2TexelSize).rg;
+    return (encoded * 255.0 - 128.0) / VELOCITY_SUBPIXELS * u_v2TexelSize;
+}
+
+void main()
+{
+    vec2 uv = v_v2TexCoord;
+
+    /* The longest motion of the neighbourhood, so the pixels just outside a moving edge follow it. */
+    vec2 velocity = velocityAt(vec2(0.0, 0.0));
+    vec2 candidate = velocityAt(vec2(-1.0, 0.0));
+    velocity = dot(candidate, candidate) > dot(velocity, velocity) ? candidate : velocity;
+    candidate = velocityAt(vec2(1.0, 0.0));
+    velocity = dot(candidate, candidate) > dot(velocity, velocity) ? candidate : velocity;
+    candidate = velocityAt(vec2(0.0, -1.0));
+    velocity = dot(candidate, candidate) > dot(velocity, velocity) ? candidate : velocity;
+    candidate = velocityAt(vec2(0.0, 1.0));
+    velocity = dot(candidate, candidate) > dot(velocity, velocity) ? candidate : velocity;
+
+    vec3 current = texture2D(u_s2dColor, uv).rgb;
+    vec3 colorMin = current;
+    vec3 colorMax = current;
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            vec3 neighbour = texture2D(u_s2dColor, uv + vec2(float(x), float(y)) * u_v2TexelSize).rgb;
+            colorMin = min(colorMin, neighbour);
+            colorMax = max(colorMax, neighbour);
+        }
+    }
+
+    vec2 previousUv = uv - velocity;
+    vec3 history = clamp(texture2D(u_s2dHistory, previousUv).rgb, colorMin, colorMax);
+
+    /* Off screen in the previous frame, nothing to accumulate. */
+    float blend = u_fBlend;
+    if (any(lessThan(previousUv, vec2(0.0))) || any(greaterThan(previousUv, vec2(1.0))))
+    {
+        blend = 1.0;
+    }
+
+    gl_FragColor = vec4(mix(history, current, blend), 1.0);
+}
@@ -0,0 +1,46 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Motion in pixels since the previous frame, in eighths of a pixel with 128 for no motion,
+ * so it fits an RGBA8 target. That is +/-16 pixels, faster motion is clamped and left to the
+ * neighbourhood clamp of the resolve.
+ */
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+#define VELOCITY_SUBPIXELS 8.0
+
+uniform vec2 u_v2ScreenSize;
+
+varying vec4 v_v4Current;
+varying vec4 v_v4Previous;
+
+void main()
+{
+    vec2 motion = (v_v4Current.xy / v_v4Current.w - v_v4Previous.xy / v_v4Previous.w) * 0.5 * u_v2ScreenSize;
+    vec2 encoded = clamp(floor(motion * VELOCITY_SUBPIXELS + 0.5) + 128.0, 0.0, 255.0) / 255.0;
+
+    gl_FragColor = vec4(encoded, 0.0, 0.0);
+}
@@ -0,0 +1,41 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Motion vectors for temporal anti-aliasing. The triangle is rasterised with the jittered projection,
+ * exactly like in the scene pass, and its position with and without the jitter of this frame and the
+ * previous one gives the screen space motion.
+ */
+
+uniform mat4 u_m4Projection;
+uniform mat4 u_m4Current;
+uniform mat4 u_m4Previous;
+
+attribute vec4 a_v4Position;
+
+varying vec4 v_v4Current;
+varying vec4 v_v4Previous;
+
+void main()
+{
+    v_v4Current = u_m4Current * a_v4Position;
+    v_v4Previous = u_m4Previous * a_v4Position;
+    gl_Position = u_m4Projection * a_v4Position;
+}
@@ -20,14 +20,23 @@
 
 /**
  * \file AntiAlias.cpp
- * \brief A sample to show how to enable AntiAliasing
+ * \brief A sample to compare the cost of anti-aliasing techniques
  *
- * \warning AntiAliasing is disabled on Windows and Desktop Linux platforms.
- * If your graphics card supports it, enable it in WindowsPlatform.cpp or DesktopLinux.cpp
- * depending on your platform.
+ * A rotating triangle is rendered to a texture and anti-aliased by one of five pipelines,
+ * which take turns every 10 seconds:
+ *  - None, the scene is copied to the window as it is.
+ *  - MSAA, the scene is rendered with GL_EXT_multisampled_render_to_texture, which resolves the samples on tile.
+ *  - FXAA, a single post-processing pass.
+ *  - SMAA 1x, edge detection, blending weights and neighbourhood blending.
+ *  - Temporal AA, the projection is jittered every frame and the frames are accumulated along motion vectors.
  *
- * EGL_SAMPLES is used to specifiy the level of AntiAliasing to be used.
- * On Mali platforms, 4x AntiAliasing incurs almost no performance penalty.
+ * Every pass is a Profiler scope, so its GPU time is measured with GL_EXT_disjoint_timer_query.
+ * The bandwidth of a pipeline comes from the Mali hardware counters when GPUCounters supports them,
+ * and from the RenderPass estimates otherwise. The averages of every pipeline are shown on screen and
+ * logged when it hands over to the next, to pick the cheapest acceptable anti-aliasing of a device
+ * rather than assume 4x MSAA is free.
+ *
+ * The window surface is single sampled (see AntiAlias.java), so only the MSAA pipeline pays for samples.
  */
  
 #include <GLES2/gl2.h>
@@ -36,16 +45,22 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 #include <string>
 
 #include <jni.h>
 #include <android/log.h>
+#include <EGL/egl.h>
 #include <unistd.h> 
 
 #include "AntiAlias.h"
 #include "Text.h"
 #include "Shader.h"
 #include "Matrix.h"
+#include "Timer.h"
+#include "Profiler.h"
+#include "GPUCounters.h"
+#include "RenderPass.h"
 #include "AndroidPlatform.h"
 
 using std::string;
@@ -55,6 +70,44 @@ using namespace MaliSDK;
 string resourceDirectory = "/data/data/com.arm.malideveloper.openglessdk.antialias/";
 string vertexShaderFilename = "AntiAlias_triangle.vert";
 string fragmentShaderFilename = "AntiAlias_triangle.frag";
+string velocityVertexShaderFilename = "AntiAlias_velocity.vert";
+string velocityFragmentShaderFilename = "AntiAlias_velocity.frag";
+string quadVertexShaderFilename = "AntiAlias_quad.vert";
+string presentFragmentShaderFilename = "AntiAlias_present.frag";
+string fxaaFragmentShaderFilename = "AntiAlias_fxaa.frag";
+string smaaEdgesFragmentShaderFilename = "AntiAlias_smaa_edges.frag";
+string smaaWeightsFragmentShaderFilename = "AntiAlias_smaa_weights.frag";
+string smaaBlendFragmentShaderFilename = "AntiAlias_smaa_blend.frag";
+string taaFragmentShaderFilename = "AntiAlias_taa.frag";
+
+/* Seconds each pipeline is shown and measured for. */
+#define MODE_DURATION 10.0f
+/* Samples of the MSAA pipeline, lowered to GL_MAX_SAMPLES_EXT if needed. */
+#define MSAA_SAMPLES 4
+/* Length of the Halton (2, 3) sequence the temporal AA jitter cycles through. */
+#define TAA_JITTER_SAMPLES 8
+/* Weight of the current frame in the temporal AA history. */
+#define TAA_BLEND 0.1f
+
+/* Texture units of the post-processing passes. The second one holds the edges, weights or history. */
+#define TEXTURE_UNIT_COLOR 0
+#define TEXTURE_UNIT_AUXILIARY 1
+#define TEXTURE_UNIT_VELOCITY 2
+
+/* The anti-aliasing pipelines, in the order they are shown. */
+enum AntiAliasMode
+{
+    ANTI_ALIAS_NONE,
+    ANTI_ALIAS_MSAA,
+    ANTI_ALIAS_FXAA,
+    ANTI_ALIAS_SMAA,
+    ANTI_ALIAS_TAA,
+    ANTI_ALIAS_MODE_COUNT
+};
+
+const char *modeNames[ANTI_ALIAS_MODE_COUNT] = { "None", "MSAA", "FXAA", "SMAA 1x", "Temporal AA" };
+/* Profiler scopes of the whole pipelines. */
+const char *modeScopes[ANTI_ALIAS_MODE_COUNT] = { "aa_none", "aa_msaa", "aa_fxaa", "aa_smaa", "aa_taa" };
 
 /* Shader variables. */
 GLuint programID = 0;
@@ -62,26 +115,276 @@ GLint iLocPosition = -1;
 GLint iLocFillColor = -1;
 GLint iLocProjection = -1;
 
-/* EGL variables. */
-int numberOfSamples = 0;
+GLuint velocityProgramID = 0;
+GLint iLocVelocityPosition = -1;
+GLint iLocVelocityProjection = -1;
+GLint iLocVelocityCurrent = -1;
+GLint iLocVelocityPrevious = -1;
+
+/* A full screen pass. */
+struct PostProgram
+{
+    GLuint programID;
+    GLint iLocPosition;
+};
+
+PostProgram presentProgram;
+PostProgram fxaaProgram;
+PostProgram smaaEdgesProgram;
+PostProgram smaaWeightsProgram;
+PostProgram smaaBlendProgram;
+PostProgram taaProgram;
+GLint iLocTAABlend = -1;
+
+/* Render targets, RGBA8 and the size of the window. The MSAA framebuffer renders to the scene texture. */
+GLuint sceneTexture = 0;
+GLuint sceneFramebuffer = 0;
+GLuint msaaFramebuffer = 0;
+GLuint edgesTexture = 0;
+GLuint edgesFramebuffer = 0;
+GLuint weightsTexture = 0;
+GLuint weightsFramebuffer = 0;
+GLuint velocityTexture = 0;
+GLuint velocityFramebuffer = 0;
+GLuint historyTextures[2] = { 0, 0 };
+GLuint historyFramebuffers[2] = { 0, 0 };
+
+/* The history written this frame, the other one is read. */
+int currentHistory = 0;
+bool historyValid = false;
+
+/* GL_EXT_multisampled_render_to_texture, not part of the core headers. */
+typedef void (GL_APIENTRYP PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC_LOCAL) (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples);
+PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC_LOCAL framebufferTexture2DMultisample = NULL;
+#define GL_MAX_SAMPLES_EXT_LOCAL 0x8D57
+GLint msaaSamples = 0;
+
+/* Window and animation. */
+int windowWidth = 0;
+int windowHeight = 0;
+Matrix viewProjection;
+Matrix previousModelViewProjection;
+float animationTime = 0.0f;
+unsigned int frameIndex = 0;
+Timer timer;
+
+/* The pipeline in use, and how long it has been. */
+AntiAliasMode currentMode = ANTI_ALIAS_NONE;
+float modeTimer = 0.0f;
+bool modeSupported[ANTI_ALIAS_MODE_COUNT];
+
+/* Measurements of a pipeline, while it is shown and the averages of the last time it was. */
+struct ModeStatistics
+{
+    unsigned int frames;
+    unsigned int countedFrames;
+    double externalBytes;
+    double estimatedBytes;
+
+    bool measured;
+    double averageGPUTime;
+    double averageExternalBytes;
+    double averageEstimatedBytes;
+};
+
+ModeStatistics modeStatistics[ANTI_ALIAS_MODE_COUNT];
+
+/* The counters read at the start of a frame are those of the previous frame, and so of this pipeline. */
+AntiAliasMode countedMode = ANTI_ALIAS_NONE;
+GPUCounters *gpuCounters = NULL;
 
 /* A text object to draw text on the screen. */ 
 Text* text;
 
+bool extensionAvailable(const char *extensionName)
+{
+    const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+    return extensions != NULL && strstr(extensions, extensionName) != NULL;
+}
+
+/* Element of the Halton low discrepancy sequence, in [0, 1). */
+float halton(unsigned int index, unsigned int base)
+{
+    float result = 0.0f;
+    float fraction = 1.0f;
+
+    while (index > 0)
+    {
+        fraction /= base;
+        result += fraction * (index % base);
+        index /= base;
+    }
+
+    return result;
+}
+
+GLuint createRenderTexture(GLint filter)
+{
+    GLuint texture = 0;
+
+    GL_CHECK(glGenTextures(1, &texture));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+    GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, windowWidth, windowHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+    return texture;
+}
+
+/* Samples of 0 attach the texture as it is. */
+GLuint createFramebuffer(GLuint texture, GLsizei samples)
+{
+    GLuint framebuffer = 0;
+
+    GL_CHECK(glGenFramebuffers(1, &framebuffer));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+    if (samples > 0)
+    {
+        GL_CHECK(framebufferTexture2DMultisample(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0, samples));
+    }
+    else
+    {
+        GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0));
+    }
+
+    GLenum status = GL_CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOGE("Framebuffer is incomplete, status 0x%x.", status);
+    }
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+    return framebuffer;
+}
+
+void setSampler(GLuint program, const char *name, GLint textureUnit)
+{
+    GLint location = GL_CHECK(glGetUniformLocation(program, name));
+    if (location != -1)
+    {
+        GL_CHECK(glUniform1i(location, textureUnit));
+    }
+}
+
+bool setupPostProgram(PostProgram *postProgram, const string &postFragmentShaderFilename)
+{
+    string vertexShaderPath = resourceDirectory + quadVertexShaderFilename;
+    string fragmentShaderPath = resourceDirectory + postFragmentShaderFilename;
+
+    Shader::processProgram(&postProgram->programID, vertexShaderPath.c_str(), fragmentShaderPath.c_str());
+    GL_CHECK(glUseProgram(postProgram->programID));
+
+    postProgram->iLocPosition = GL_CHECK(glGetAttribLocation(postProgram->programID, "a_v2Position"));
+    if (postProgram->iLocPosition == -1)
+    {
+        LOGE("Attribute not found at %s:%i\n", __FILE__, __LINE__);
+        return false;
+    }
+
+    GLint iLocTexelSize = GL_CHECK(glGetUniformLocation(postProgram->programID, "u_v2TexelSize"));
+    if (iLocTexelSize != -1)
+    {
+        GL_CHECK(glUniform2f(iLocTexelSize, 1.0f / windowWidth, 1.0f / windowHeight));
+    }
+
+    /* Each pass only declares the samplers it reads. */
+    setSampler(postProgram->programID, "u_s2dColor", TEXTURE_UNIT_COLOR);
+    setSampler(postProgram->programID, "u_s2dEdges", TEXTURE_UNIT_AUXILIARY);
+    setSampler(postProgram->programID, "u_s2dWeights", TEXTURE_UNIT_AUXILIARY);
+    setSampler(postProgram->programID, "u_s2dHistory", TEXTURE_UNIT_AUXILIARY);
+    setSampler(postProgram->programID, "u_s2dVelocity", TEXTURE_UNIT_VELOCITY);
+
+    return true;
+}
+
+bool setupVelocityProgram(void)
+{
+    string vertexShaderPath = resourceDirectory + velocityVertexShaderFilename;
+    string fragmentShaderPath = resourceDirectory + velocityFragmentShaderFilename;
+
+    Shader::processProgram(&velocityProgramID, vertexShaderPath.c_str(), fragmentShaderPath.c_str());
+    GL_CHECK(glUseProgram(velocityProgramID));
+
+    iLocVelocityPosition = GL_CHECK(glGetAttribLocation(velocityProgramID, "a_v4Position"));
+    if (iLocVelocityPosition == -1)
+    {
+        LOGE("Attribute not found at %s:%i\n", __FILE__, __LINE__);
+        return false;
+    }
+    iLocVelocityProjection = GL_CHECK(glGetUniformLocation(velocityProgramID, "u_m4Projection"));
+    iLocVelocityCurrent = GL_CHECK(glGetUniformLocation(velocityProgramID, "u_m4Current"));
+    iLocVelocityPrevious = GL_CHECK(glGetUniformLocation(velocityProgramID, "u_m4Previous"));
+
+    GLint iLocScreenSize = GL_CHECK(glGetUniformLocation(velocityProgramID, "u_v2ScreenSize"));
+    GL_CHECK(glUniform2f(iLocScreenSize, (float)windowWidth, (float)windowHeight));
+
+    return true;
+}
+
+void setupRenderTargets(void)
+{
+    /* FXAA resamples the scene between texels, and temporal AA the history. */
+    sceneTexture = createRenderTexture(GL_LINEAR);
+    sceneFramebuffer = createFramebuffer(sceneTexture, 0);
+    edgesTexture = createRenderTexture(GL_NEAREST);
+    edgesFramebuffer = createFramebuffer(edgesTexture, 0);
+    weightsTexture = createRenderTexture(GL_NEAREST);
+    weightsFramebuffer = createFramebuffer(weightsTexture, 0);
+    velocityTexture = createRenderTexture(GL_NEAREST);
+    velocityFramebuffer = createFramebuffer(velocityTexture, 0);
+    for (int i = 0; i < 2; i++)
+    {
+        historyTextures[i] = createRenderTexture(GL_LINEAR);
+        historyFramebuffers[i] = createFramebuffer(historyTextures[i], 0);
+    }
+
+    /* Multisampled rendering to the scene texture, resolved when the tiles are written out. */
+    if (extensionAvailable("GL_EXT_multisampled_render_to_texture"))
+    {
+        framebufferTexture2DMultisample = (PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC_LOCAL)eglGetProcAddress("glFramebufferTexture2DMultisampleEXT");
+    }
+    if (framebufferTexture2DMultisample)
+    {
+        GLint maxSamples = 0;
+        GL_CHECK(glGetIntegerv(GL_MAX_SAMPLES_EXT_LOCAL, &maxSamples));
+        msaaSamples = maxSamples < MSAA_SAMPLES ? maxSamples : MSAA_SAMPLES;
+        msaaFramebuffer = createFramebuffer(sceneTexture, msaaSamples);
+    }
+    else
+    {
+        LOGI("GL_EXT_multisampled_render_to_texture is not supported, the MSAA pipeline is skipped.");
+    }
+}
+
+void deleteRenderTargets(void)
+{
+    GLuint textures[] = { sceneTexture, edgesTexture, weightsTexture, velocityTexture, historyTextures[0], historyTextures[1] };
+    GLuint framebuffers[] = { sceneFramebuffer, msaaFramebuffer, edgesFramebuffer, weightsFramebuffer, velocityFramebuffer, historyFramebuffers[0], historyFramebuffers[1] };
+
+    GL_CHECK(glDeleteTextures(sizeof(textures) / sizeof(textures[0]), textures));
+    GL_CHECK(glDeleteFramebuffers(sizeof(framebuffers) / sizeof(framebuffers[0]), framebuffers));
+    msaaFramebuffer = 0;
+}
+
 bool setupGraphics(int width, int height)
 {
     /* Full paths to the shader files */
     string vertexShaderPath = resourceDirectory + vertexShaderFilename; 
     string fragmentShaderPath = resourceDirectory + fragmentShaderFilename;
+
+    windowWidth = width;
+    windowHeight = height;
     
-    /* Initialize OpenGL ES. */
-    GL_CHECK(glEnable(GL_BLEND));
+    /* Initialize OpenGL ES. Blending is only enabled for the text, the post-processing passes overwrite. */
     /* Should do src * (src alpha) + dest * (1-src alpha). */
     GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    GL_CHECK(glDisable(GL_DEPTH_TEST));
 
-    /* Initialize the Text object and add some text. */
+    /* Initialize the Text object. */
     text = new Text(resourceDirectory.c_str(), width, height);
-    text->addString(0, 0, "Anti-aliased triangle", 255, 255, 0, 255);
 
     /* Process shaders. */
     GLuint vertexShaderID = 0;
@@ -112,7 +415,6 @@ bool setupGraphics(int width, int height)
         LOGE("Attribute not found at %s:%i\n", __FILE__, __LINE__);
         return false;
     }
-    GL_CHECK(glEnableVertexAttribArray(iLocPosition));
 
     /* Fill colors. */
     iLocFillColor = GL_CHECK(glGetAttribLocation(programID, "a_v4FillColor"));
@@ -120,10 +422,6 @@ bool setupGraphics(int width, int height)
     {
         LOGD("Warning: Uniform not found at %s:%i\n", __FILE__, __LINE__);
     }
-    else
-    {
-        GL_CHECK(glEnableVertexAttribArray(iLocFillColor));
-    }
 
     /* Projection matrix. */
     iLocProjection = GL_CHECK(glGetUniformLocation(programID, "u_m4Projection"));
@@ -131,28 +429,85 @@ bool setupGraphics(int width, int height)
     {
         LOGD("Warning: Uniform not found at %s:%i\n", __FILE__, __LINE__);
     }
-    else
+
+    /* Post-processing and motion vectors. */
+    if (!setupPostProgram(&presentProgram, presentFragmentShaderFilename)
+        || !setupPostProgram(&fxaaProgram, fxaaFragmentShaderFilename)
+        || !setupPostProgram(&smaaEdgesProgram, smaaEdgesFragmentShaderFilename)
+        || !setupPostProgram(&smaaWeightsProgram, smaaWeightsFragmentShaderFilename)
+        || !setupPostProgram(&smaaBlendProgram, smaaBlendFragmentShaderFilename)
+        || !setupPostProgram(&taaProgram, taaFragmentShaderFilename)
+        || !setupVelocityProgram())
+    {
+        return false;
+    }
+    iLocTAABlend = GL_CHECK(glGetUniformLocation(taaProgram.programID, "u_fBlend"));
+
+    setupRenderTargets();
+
+    /* The camera looks at the triangle from 1.5 units away. */
+    Matrix projection = Matrix::matrixPerspective(45.0f * M_PI / 180.0f, (float)width / (float)height, 0.1f, 10.0f);
+    Matrix view = Matrix::createTranslation(0.0f, 0.0f, -1.5f);
+    viewProjection = projection * view;
+    previousModelViewProjection = viewProjection;
+
+    for (int mode = 0; mode < ANTI_ALIAS_MODE_COUNT; mode++)
     {
-        GL_CHECK(glUniformMatrix4fv(iLocProjection, 1, GL_FALSE, Matrix::identityMatrix.getAsArray()));
+        modeSupported[mode] = mode != ANTI_ALIAS_MSAA || msaaFramebuffer != 0;
+        memset(&modeStatistics[mode], 0, sizeof(ModeStatistics));
     }
+    currentMode = ANTI_ALIAS_NONE;
+    countedMode = ANTI_ALIAS_NONE;
+    modeTimer = 0.0f;
+    historyValid = false;
 
-    /* Set clear screen color. RGBA format, so opaque blue. */
-    GL_CHECK(glClearColor(0.0f, 0.0f, 1.0f, 1.0f));
+    Profiler::initialize();
 
     return true;
 }
 
-void renderFrame(void)
+void bindTexture(GLint textureUnit, GLuint texture)
 {
-    /* Clear the screen on the EGL surface. */
-    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0 + textureUnit));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+}
+
+void drawQuad(const PostProgram &postProgram)
+{
+    GL_CHECK(glUseProgram(postProgram.programID));
+    GL_CHECK(glVertexAttribPointer(postProgram.iLocPosition, 2, GL_FLOAT, GL_FALSE, 0, quadVertices));
+    GL_CHECK(glEnableVertexAttribArray(postProgram.iLocPosition));
+    GL_CHECK(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+    GL_CHECK(glDisableVertexAttribArray(postProgram.iLocPosition));
+}
+
+/* A full screen pass to a render target, every pixel is written so the previous contents are not loaded. */
+void renderPostPass(GLuint framebuffer, const PostProgram &postProgram)
+{
+    RenderPass pass(framebuffer, windowWidth, windowHeight);
+    pass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_DONT_CARE, RenderPass::STORE_OP_STORE, 4);
+
+    pass.begin();
+    drawQuad(postProgram);
+    pass.end();
+}
+
+void renderScene(GLuint framebuffer, const Matrix &modelViewProjection)
+{
+    /* The samples of the MSAA framebuffer only live on tile, 4 bytes per pixel are written either way. */
+    RenderPass pass(framebuffer, windowWidth, windowHeight);
+    pass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 4);
+    /* RGBA format, so opaque blue. */
+    pass.setClearColor(0.0f, 0.0f, 1.0f, 1.0f);
+
+    pass.begin();
 
     GL_CHECK(glUseProgram(programID));
 
-    /* Load EGL window-specific projection and modelview matrices. */
     if(iLocProjection != -1)
     {
-        GL_CHECK(glUniformMatrix4fv(iLocProjection, 1, GL_FALSE, Matrix::identityMatrix.getAsArray()));
+        Matrix matrix = modelViewProjection;
+        GL_CHECK(glUniformMatrix4fv(iLocProjection, 1, GL_FALSE, matrix.getAsArray()));
     }
 
     /* Set triangle vertex. */
@@ -169,8 +524,297 @@ void renderFrame(void)
     /* Draw the triangle. */
     GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
 
+    GL_CHECK(glDisableVertexAttribArray(iLocPosition));
+    if(iLocFillColor != -1)
+    {
+        GL_CHECK(glDisableVertexAttribArray(iLocFillColor));
+    }
+
+    pass.end();
+}
+
+/* The triangle again, rasterised like in the scene pass, to write its motion since the previous frame. */
+void renderVelocity(const Matrix &jitteredModelViewProjection, const Matrix &modelViewProjection)
+{
+    RenderPass pass(velocityFramebuffer, windowWidth, windowHeight);
+    pass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 4);
+    /* 128 is no motion. */
+    pass.setClearColor(128.0f / 255.0f, 128.0f / 255.0f, 0.0f, 0.0f);
+
+    pass.begin();
+
+    Matrix jittered = jitteredModelViewProjection;
+    Matrix current = modelViewProjection;
+    GL_CHECK(glUseProgram(velocityProgramID));
+    GL_CHECK(glUniformMatrix4fv(iLocVelocityProjection, 1, GL_FALSE, jittered.getAsArray()));
+    GL_CHECK(glUniformMatrix4fv(iLocVelocityCurrent, 1, GL_FALSE, current.getAsArray()));
+    GL_CHECK(glUniformMatrix4fv(iLocVelocityPrevious, 1, GL_FALSE, previousModelViewProjection.getAsArray()));
+
+    GL_CHECK(glVertexAttribPointer(iLocVelocityPosition, 3, GL_FLOAT, GL_FALSE, 0, triangleVertices));
+    GL_CHECK(glEnableVertexAttribArray(iLocVelocityPosition));
+    GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+    GL_CHECK(glDisableVertexAttribArray(iLocVelocityPosition));
+
+    pass.end();
+}
+
+/* Bytes moved by the last frame of a pipeline, from the counters or else the estimate. */
+void getBandwidthString(double externalBytes, double estimatedBytes, char *buffer, size_t size)
+{
+    if (gpuCounters->isSupported())
+    {
+        snprintf(buffer, size, "%6.2f MB/frame", externalBytes / (1024.0 * 1024.0));
+    }
+    else
+    {
+        snprintf(buffer, size, "%6.2f MB/frame (estimated)", estimatedBytes / (1024.0 * 1024.0));
+    }
+}
+
+void updateText(void)
+{
+    char line[128];
+    int lineHeight = Text::textureCharacterHeight;
+    int y = windowHeight - lineHeight;
+
+    text->clear();
+    snprintf(line, sizeof(line), "Anti-aliasing: %s (%4.1f / %.1f s)", modeNames[currentMode], modeTimer, MODE_DURATION);
+    text->addString(0, y, line, 255, 255, 0, 255);
+    y -= 2 * lineHeight;
+
+    /* The pipeline shown is averaged so far, the others over the last time they were shown. */
+    for (int mode = 0; mode < ANTI_ALIAS_MODE_COUNT; mode++)
+    {
+        const ModeStatistics &statistics = modeStatistics[mode];
+        char name[32];
+        char bandwidth[64];
+
+        if (mode == ANTI_ALIAS_MSAA)
+        {
+            snprintf(name, sizeof(name), "%dx %s", msaaSamples, modeNames[mode]);
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "%s", modeNames[mode]);
+        }
+
+        if (!modeSupported[mode])
+        {
+            snprintf(line, sizeof(line), "%-12s not supported", name);
+        }
+        else if (mode == currentMode && statistics.frames > 0)
+        {
+            double gpuTime = 0.0;
+            Profiler::getGPUAverage(modeScopes[mode], &gpuTime);
+            getBandwidthString(statistics.externalBytes / (statistics.countedFrames > 0 ? statistics.countedFrames : 1), statistics.estimatedBytes / statistics.frames, bandwidth, sizeof(bandwidth));
+            snprintf(line, sizeof(line), "%-12s GPU %6.3f ms %s", name, gpuTime, bandwidth);
+        }
+        else if (statistics.measured)
+        {
+            getBandwidthString(statistics.averageExternalBytes, statistics.averageEstimatedBytes, bandwidth, sizeof(bandwidth));
+            snprintf(line, sizeof(line), "%-12s GPU %6.3f ms %s", name, statistics.averageGPUTime, bandwidth);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "%-12s not measured yet", name);
+        }
+
+        int brightness = mode == currentMode ? 255 : 160;
+        text->addString(0, y, line, brightness, brightness, brightness, 255);
+        y -= lineHeight;
+    }
+}
+
+/* Keep the averages of the pipeline shown, then move on to the next supported one. */
+void nextMode(void)
+{
+    ModeStatistics &statistics = modeStatistics[currentMode];
+
+    if (statistics.frames > 0)
+    {
+        statistics.measured = true;
+        Profiler::getGPUAverage(modeScopes[currentMode], &statistics.averageGPUTime);
+        statistics.averageExternalBytes = statistics.countedFrames > 0 ? statistics.externalBytes / statistics.countedFrames : 0.0;
+        statistics.averageEstimatedBytes = statistics.estimatedBytes / statistics.frames;
+        LOGI("%s: GPU %.3f ms, external memory %.2f MB, estimated %.2f MB per frame.", modeNames[currentMode],
+             statistics.averageGPUTime, statistics.averageExternalBytes / (1024.0 * 1024.0), statistics.averageEstimatedBytes / (1024.0 * 1024.0));
+    }
+    statistics.frames = 0;
+    statistics.countedFrames = 0;
+    statistics.externalBytes = 0.0;
+    statistics.estimatedBytes = 0.0;
+
+    /* Prints the time of every pass, and starts the averages over for the next pipeline. */
+    Profiler::log(modeNames[currentMode]);
+
+    do
+    {
+        currentMode = (AntiAliasMode)((currentMode + 1) % ANTI_ALIAS_MODE_COUNT);
+    }
+    while (!modeSupported[currentMode]);
+
+    modeTimer = 0.0f;
+    historyValid = false;
+}
+
+void renderFrame(float deltaTime)
+{
+    /* Counters of the previous frame, which was rendered by the pipeline it was counted for. */
+    gpuCounters->sample();
+    if (gpuCounters->isSupported() && countedMode == currentMode)
+    {
+        modeStatistics[currentMode].externalBytes += gpuCounters->getExternalReadBytes() + gpuCounters->getExternalWriteBytes();
+        modeStatistics[currentMode].countedFrames++;
+    }
+
+    animationTime += deltaTime;
+    Matrix model = Matrix::createRotationY(25.0f * sinf(animationTime * 0.5f)) * Matrix::createRotationZ(animationTime * 10.0f);
+    Matrix modelViewProjection = viewProjection * model;
+
+    /* Every pixel of the window is written by the last pass, and depth is not used. */
+    RenderPass windowPass(0, windowWidth, windowHeight);
+    windowPass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_DONT_CARE, RenderPass::STORE_OP_STORE, 2);
+    windowPass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_DONT_CARE, RenderPass::STORE_OP_DONT_CARE, 2);
+
+    {
+        PROFILE_SCOPE(modeScopes[currentMode]);
+
+        switch (currentMode)
+        {
+            case ANTI_ALIAS_NONE:
+            {
+                {
+                    PROFILE_SCOPE("scene");
+                    renderScene(sceneFramebuffer, modelViewProjection);
+                }
+
+                PROFILE_SCOPE("present");
+                bindTexture(TEXTURE_UNIT_COLOR, sceneTexture);
+                windowPass.begin();
+                drawQuad(presentProgram);
+                break;
+            }
+
+            case ANTI_ALIAS_MSAA:
+            {
+                {
+                    PROFILE_SCOPE("scene_msaa");
+                    renderScene(msaaFramebuffer, modelViewProjection);
+                }
+
+                PROFILE_SCOPE("present");
+                bindTexture(TEXTURE_UNIT_COLOR, sceneTexture);
+                windowPass.begin();
+                drawQuad(presentProgram);
+                break;
+            }
+
+            case ANTI_ALIAS_FXAA:
+            {
+                {
+                    PROFILE_SCOPE("scene");
+                    renderScene(sceneFramebuffer, modelViewProjection);
+                }
+
+                PROFILE_SCOPE("fxaa");
+                bindTexture(TEXTURE_UNIT_COLOR, sceneTexture);
+                windowPass.begin();
+                drawQuad(fxaaProgram);
+                break;
+            }
+
+            case ANTI_ALIAS_SMAA:
+            {
+                {
+                    PROFILE_SCOPE("scene");
+                    renderScene(sceneFramebuffer, modelViewProjection);
+                }
+                {
+                    PROFILE_SCOPE("smaa_edges");
+                    bindTexture(TEXTURE_UNIT_COLOR, sceneTexture);
+                    renderPostPass(edgesFramebuffer, smaaEdgesProgram);
+                }
+                {
+                    PROFILE_SCOPE("smaa_weights");
+                    bindTexture(TEXTURE_UNIT_AUXILIARY, edgesTexture);
+                    renderPostPass(weightsFramebuffer, smaaWeightsProgram);
+                }
+
+                PROFILE_SCOPE("smaa_blend");
+                bindTexture(TEXTURE_UNIT_AUXILIARY, weightsTexture);
+                windowPass.begin();
+                drawQuad(smaaBlendProgram);
+                break;
+            }
+
+            case ANTI_ALIAS_TAA:
+            {
+                /* Sub-pixel offset of this frame, applied after the projection so it is the same on the whole screen. */
+                unsigned int jitterIndex = frameIndex % TAA_JITTER_SAMPLES + 1;
+                float jitterX = halton(jitterIndex, 2) - 0.5f;
+                float jitterY = halton(jitterIndex, 3) - 0.5f;
+                Matrix jitter = Matrix::createTranslation(2.0f * jitterX / windowWidth, 2.0f * jitterY / windowHeight, 0.0f);
+                Matrix jitteredModelViewProjection = jitter * modelViewProjection;
+
+                {
+                    PROFILE_SCOPE("scene_jittered");
+                    renderScene(sceneFramebuffer, jitteredModelViewProjection);
+                }
+                {
+                    /* OpenGL ES 2.0 has no multiple render targets, so motion vectors take a pass of their own. */
+                    PROFILE_SCOPE("velocity");
+                    renderVelocity(jitteredModelViewProjection, modelViewProjection);
+                }
+                {
+                    PROFILE_SCOPE("taa_resolve");
+                    bindTexture(TEXTURE_UNIT_COLOR, sceneTexture);
+                    bindTexture(TEXTURE_UNIT_AUXILIARY, historyTextures[1 - currentHistory]);
+                    bindTexture(TEXTURE_UNIT_VELOCITY, velocityTexture);
+                    GL_CHECK(glUseProgram(taaProgram.programID));
+                    GL_CHECK(glUniform1f(iLocTAABlend, historyValid ? TAA_BLEND : 1.0f));
+                    renderPostPass(historyFramebuffers[currentHistory], taaProgram);
+                }
+
+                PROFILE_SCOPE("present");
+                bindTexture(TEXTURE_UNIT_COLOR, historyTextures[currentHistory]);
+                windowPass.begin();
+                drawQuad(presentProgram);
+
+                currentHistory = 1 - currentHistory;
+                historyValid = true;
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
     /* Draw fonts. */
+    updateText();
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    GL_CHECK(glEnable(GL_BLEND));
     text->draw();
+    GL_CHECK(glDisable(GL_BLEND));
+
+    windowPass.end();
+
+    ModeStatistics &statistics = modeStatistics[currentMode];
+    statistics.frames++;
+    statistics.estimatedBytes += RenderPass::getBytesTransferred();
+    RenderPass::endFrame();
+    Profiler::endFrame();
+
+    previousModelViewProjection = modelViewProjection;
+    frameIndex++;
+
+    /* Change the pipeline over time. */
+    countedMode = currentMode;
+    modeTimer += deltaTime;
+    if (modeTimer > MODE_DURATION)
+    {
+        nextMode();
+    }
 }
 
 extern "C"
@@ -180,21 +824,42 @@ extern "C"
     (JNIEnv *env, jclass jcls, jint width, jint height)
     {
         /* Make sure that all resource files are in place */
-        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), vertexShaderFilename.c_str());
-        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), fragmentShaderFilename.c_str());
+        const string *filenames[] =
+        {
+            &vertexShaderFilename, &fragmentShaderFilename, &velocityVertexShaderFilename, &velocityFragmentShaderFilename,
+            &quadVertexShaderFilename, &presentFragmentShaderFilename, &fxaaFragmentShaderFilename,
+            &smaaEdgesFragmentShaderFilename, &smaaWeightsFragmentShaderFilename, &smaaBlendFragmentShaderFilename,
+            &taaFragmentShaderFilename
+        };
+        for (unsigned int i = 0; i < sizeof(filenames) / sizeof(filenames[0]); i++)
+        {
+            AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), filenames[i]->c_str());
+        }
+
+        /* Counting keeps running across a context loss, only start it once. */
+        if (!gpuCounters)
+        {
+            gpuCounters = new GPUCounters;
+        }
 
         setupGraphics(width, height);
+        timer.reset();
     }
 
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_antialias_AntiAlias_step
     (JNIEnv *env, jclass jcls)
     {
-        renderFrame();
+        renderFrame(timer.getInterval());
     }
 
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_antialias_AntiAlias_uninit
     (JNIEnv *, jclass)
     {
+        deleteRenderTargets();
+        Profiler::terminate();
         delete text;
+        text = NULL;
+        delete gpuCounters;
+        gpuCounters = NULL;
     }
 }
@@ -41,4 +41,13 @@ const float triangleColors[] =
     0.0, 1.0, 0.0, 1.0,
 };
 
+/* Full screen quad of the post-processing passes, as a triangle strip. */
+const float quadVertices[] =
+{
+    -1.0f, -1.0f,
+     1.0f, -1.0f,
+    -1.0f,  1.0f,
+     1.0f,  1.0f,
+};
+
 #endif /* ANTIALIAS_H */
\ No newline at end of file
@@ -37,6 +37,15 @@ class AntiAliasView extends MaliSamplesView
         super(context);
     }
 	
+    /*
+     * The window is single sampled, multisampling is one of the
+     * pipelines of the sample and renders to a texture instead.
+     */
+    @Override protected int getNumberOfSamples()
+    {
+        return 0;
+    }
+
     @Override protected void setRendererCallback()
     {
         setRenderer(new Renderer());
@@ -23,6 +23,7 @@
 
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 #include <string>
 
 #include "Text.h"
@@ -31,6 +32,7 @@
 #include "SolidSphere.h"
 
 using namespace AstcTextures;
+using namespace MaliSDK;
 using namespace std;
 
 /* Instance of Timer used to measure texture switch time. */
@@ -83,7 +83,7 @@ namespace AstcTextures
         textIndex              = NULL;
 
         /* Create an orthographic projection. */
-        projectionMatrix = Matrix::matrixOrthographic(0, (float)windowWidth, 0, (float)windowHeight, 0, 1);
+        projectionMatrix = MaliSDK::Matrix::matrixOrthographic(0, (float)windowWidth, 0, (float)windowHeight, 0, 1);
 
         /* Create program object and initialize it. */
         programID = create_program(fontVertexShaderSource, fontFragmentShaderSource);
@@ -101,7 +101,7 @@ namespace AstcTextures
              */
             static const float scale;
 
-            Matrix projectionMatrix;
+            MaliSDK::Matrix projectionMatrix;
             int numberOfCharacters;
             float* textVertex;
             float* textTextureCoordinates;
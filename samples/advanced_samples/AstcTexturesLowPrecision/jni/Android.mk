@@ -4,7 +4,9 @@ LOCAL_PATH := $(call my-dir)
 include $(CLEAR_VARS)
 
 LOCAL_MODULE    := Native
-LOCAL_SRC_FILES := AstcTextures.cpp Matrix.cpp Text.cpp Timer.cpp SolidSphere.cpp
+LOCAL_SRC_FILES := AstcTextures.cpp Text.cpp SolidSphere.cpp ../../common_native/src/Matrix.cpp ../../common_native/src/Timer.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../common_native/inc
+LOCAL_CFLAGS    := -DGLES_VERSION=3
 LOCAL_LDLIBS    := -llog -lGLESv3
 
 include $(BUILD_SHARED_LIBRARY)
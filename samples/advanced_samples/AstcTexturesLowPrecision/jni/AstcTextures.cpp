@@ -23,7 +23,9 @@
 
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "Text.h"
 #include "AstcTextures.h"
@@ -31,6 +33,7 @@
 #include "SolidSphere.h"
 
 using namespace AstcTextures;
+using namespace MaliSDK;
 using namespace std;
 
 /* Instance of Timer used to measure texture switch time. */
@@ -159,6 +162,10 @@ const int n_texture_ids = sizeof(texture_sets_info) / sizeof(texture_sets_info[0
 /* Array storing texture bindings. */
 texture_set texture_ids[n_texture_ids] = { 0 };
 
+/* Dimensions of the cloud, day and night textures, the same for every texture set. */
+GLsizei texture_widths[3]  = { 0 };
+GLsizei texture_heights[3] = { 0 };
+
 /* Please see header for specification. */
 GLint get_and_check_attrib_location(GLuint program, const GLchar* attrib_name)
 {
@@ -329,8 +336,10 @@ void update_texture_bindings(bool force_switch_texture)
  * \param[in] file_name                       Texture file name.
  * \param[in] decode_format                   ASTC internal decode format
  * \param[in] compressed_data_internal_format ASTC compression internal format.
+ * \param[out] width_ptr                      If not NULL, used to store the texture width.
+ * \param[out] height_ptr                     If not NULL, used to store the texture height.
  */
-GLuint load_texture(const char* file_name, GLenum decode_format, GLenum compressed_data_internal_format)
+GLuint load_texture(const char* file_name, GLenum decode_format, GLenum compressed_data_internal_format, GLsizei* width_ptr = NULL, GLsizei* height_ptr = NULL)
 {
     unsigned char* compressed_data = NULL;
     unsigned char* input_data      = NULL;
@@ -425,6 +434,16 @@ GLuint load_texture(const char* file_name, GLenum decode_format, GLenum compress
     /* Unbind texture from target. */
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
 
+    if (width_ptr != NULL)
+    {
+        *width_ptr = xsize;
+    }
+
+    if (height_ptr != NULL)
+    {
+        *height_ptr = ysize;
+    }
+
     /* Terminate file operations. */
     fclose(compressed_data_file);
     FREE_CHECK(input_data);
@@ -448,9 +467,9 @@ void load_textures(void)
         earth_color_texture_file_path     = resource_directory + texture_sets_info[i].earth_color_texture_file_path;
         earth_night_texture_file_path     = resource_directory + texture_sets_info[i].earth_night_texture_file_path;
 
-        texture_ids[i].cloud_and_gloss_texture_id = load_texture(cloud_and_gloss_texture_file_path.c_str(), texture_sets_info[i].cloud_and_gloss_decode_format, texture_sets_info[i].compressed_data_internal_format);
-        texture_ids[i].earth_color_texture_id     = load_texture(earth_color_texture_file_path.c_str(),     texture_sets_info[i].earth_color_decode_format, texture_sets_info[i].compressed_data_internal_format);
-        texture_ids[i].earth_night_texture_id     = load_texture(earth_night_texture_file_path.c_str(),     texture_sets_info[i].earth_night_decode_format, texture_sets_info[i].compressed_data_internal_format);
+        texture_ids[i].cloud_and_gloss_texture_id = load_texture(cloud_and_gloss_texture_file_path.c_str(), texture_sets_info[i].cloud_and_gloss_decode_format, texture_sets_info[i].compressed_data_internal_format, &texture_widths[0], &texture_heights[0]);
+        texture_ids[i].earth_color_texture_id     = load_texture(earth_color_texture_file_path.c_str(),     texture_sets_info[i].earth_color_decode_format, texture_sets_info[i].compressed_data_internal_format, &texture_widths[1], &texture_heights[1]);
+        texture_ids[i].earth_night_texture_id     = load_texture(earth_night_texture_file_path.c_str(),     texture_sets_info[i].earth_night_decode_format, texture_sets_info[i].compressed_data_internal_format, &texture_widths[2], &texture_heights[2]);
         texture_ids[i].name                       = texture_sets_info[i].compressed_texture_format_name;
     }
 
@@ -563,6 +582,321 @@ void load_buffer_data(void)
     sphere_indices = solid_sphere->getSphereIndices(&sphere_indices_size);
 }
 
+/**
+ * \brief Read back the texels of level 0 of a texture, decoded by the GPU, as RGBA8.
+ *
+ * \param[in]  texture_id  Texture to read.
+ * \param[in]  width       Texture width.
+ * \param[in]  height      Texture height.
+ * \param[in]  copy_program_id Program drawing texels one to one, from texel_copy_*_shader_source.
+ * \param[out] texels      Used to store width * height RGBA8 texels.
+ */
+void read_texels(GLuint texture_id, GLsizei width, GLsizei height, GLuint copy_program_id, vector<unsigned char>& texels)
+{
+    GLuint target_texture_id = 0;
+    GLuint fbo_id            = 0;
+
+    GL_CHECK(glGenTextures(1, &target_texture_id));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, target_texture_id));
+    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height));
+
+    GL_CHECK(glGenFramebuffers(1, &fbo_id));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo_id));
+    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target_texture_id, 0));
+
+    GL_CHECK(glViewport(0, 0, width, height));
+    GL_CHECK(glUseProgram(copy_program_id));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture_id));
+    GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+
+    texels.resize(width * height * 4);
+
+    GL_CHECK(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0]));
+
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GL_CHECK(glDeleteFramebuffers(1, &fbo_id));
+    GL_CHECK(glDeleteTextures(1, &target_texture_id));
+}
+
+/**
+ * \brief Compute the peak signal-to-noise ratio of 8-bit data against a reference.
+ *
+ * \param[in] data      Data to measure.
+ * \param[in] reference Reference data, of the same size.
+ * \return    PSNR in dB, infinite if the data are identical.
+ */
+float compute_psnr(const vector<unsigned char>& data, const vector<unsigned char>& reference)
+{
+    double squared_error_sum = 0.0;
+
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        double difference = (double) data[i] - (double) reference[i];
+
+        squared_error_sum += difference * difference;
+    }
+
+    double mean_squared_error = squared_error_sum / (double) data.size();
+
+    if (mean_squared_error == 0.0)
+    {
+        return INFINITY;
+    }
+
+    return (float) (10.0 * log10(255.0 * 255.0 / mean_squared_error));
+}
+
+/**
+ * \brief Draw the globe in a fixed position, so that every texture set renders the same view.
+ */
+void draw_profiler_frame(void)
+{
+    const float profiler_time = 2.0f;
+
+    model_view_matrix = Matrix::createRotationX(profiler_time * X_ROTATION_SPEED);
+    rotate_matrix     = Matrix::createRotationY(profiler_time * Y_ROTATION_SPEED);
+    model_view_matrix = rotate_matrix * model_view_matrix;
+    rotate_matrix     = Matrix::createRotationZ(-profiler_time * Z_ROTATION_SPEED);
+    model_view_matrix = rotate_matrix * model_view_matrix;
+
+    model_view_matrix[14] -= 2.5f + sinf(profiler_time / 5.0f) * 0.5f;
+
+    mvp_matrix = perspective_matrix * model_view_matrix;
+
+    GL_CHECK(glUniformMatrix4fv(mv_location,  1, GL_FALSE, &model_view_matrix[0]));
+    GL_CHECK(glUniformMatrix4fv(mvp_location, 1, GL_FALSE, &mvp_matrix[0]));
+
+    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    GL_CHECK(glDrawElements(GL_TRIANGLES, sphere_indices_size, GL_UNSIGNED_SHORT, sphere_indices));
+}
+
+/**
+ * \brief Bind the three textures of a set to the texture units used by the globe program.
+ */
+void bind_profiler_textures(const GLuint texture_ids_to_bind[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        GL_CHECK(glActiveTexture(GL_TEXTURE0 + i));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture_ids_to_bind[i]));
+    }
+}
+
+/* Please see header for specification. */
+void run_profiler(void)
+{
+    /* Block footprints of GL_COMPRESSED_RGBA_ASTC_4x4_KHR to GL_COMPRESSED_RGBA_ASTC_12x12_KHR. */
+    const int block_dimensions[][2] = { { 4, 4 },  { 5, 4 },  { 5, 5 },  { 6, 5 },   { 6, 6 },   { 8, 5 },    { 8, 6 },
+                                        { 8, 8 },  { 10, 5 }, { 10, 6 }, { 10, 8 },  { 10, 10 }, { 12, 10 },  { 12, 12 } };
+    const char* texture_names[3] = { "cloud and gloss", "earth color", "earth night" };
+
+    /* GL_RGBA16F is the precision used without the decode mode extension. */
+    GLenum      decode_formats[3]      = { GL_RGBA16F, GL_RGBA8, GL_RGB9_E5 };
+    const char* decode_format_names[3] = { "RGBA16F", "RGBA8", "RGB9_E5" };
+    int         n_decode_formats       = 1;
+
+    if (astc_decode_mode_supported)
+    {
+        n_decode_formats = astc_decode_mode_rgb9e5_supported ? 3 : 2;
+    }
+
+    GLuint copy_program_id = create_program(texel_copy_vertex_shader_source, texel_copy_fragment_shader_source);
+
+    GL_CHECK(glUseProgram(copy_program_id));
+    GL_CHECK(glUniform1i(get_and_check_uniform_location(copy_program_id, "source_texture"), 0));
+
+    /* The copies must not be blended, depth tested or culled, and read no vertex attributes. */
+    GL_CHECK(glDisable(GL_BLEND));
+    GL_CHECK(glDisable(GL_DEPTH_TEST));
+    GL_CHECK(glDisable(GL_CULL_FACE));
+    GL_CHECK(glBindVertexArray(0));
+
+    /* Decode the highest quality set at full precision into uncompressed reference textures. */
+    vector<unsigned char> reference_texels[3];
+    GLuint                reference_texture_ids[3] = { 0 };
+    GLuint                set_texture_ids[3]       = { texture_ids[0].cloud_and_gloss_texture_id,
+                                                       texture_ids[0].earth_color_texture_id,
+                                                       texture_ids[0].earth_night_texture_id };
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (astc_decode_mode_supported)
+        {
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D, set_texture_ids[i]));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_ASTC_DECODE_PRECISION_EXT, GL_RGBA16F));
+        }
+
+        read_texels(set_texture_ids[i], texture_widths[i], texture_heights[i], copy_program_id, reference_texels[i]);
+
+        GL_CHECK(glGenTextures(1, &reference_texture_ids[i]));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, reference_texture_ids[i]));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, texture_widths[i], texture_heights[i]));
+        GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texture_widths[i], texture_heights[i], GL_RGBA, GL_UNSIGNED_BYTE, &reference_texels[i][0]));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_REPEAT));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_REPEAT));
+    }
+
+    /* Frames are rendered off-screen, at the resolution of the window. */
+    GLuint fbo_id           = 0;
+    GLuint renderbuffer_ids[2] = { 0 };
+
+    GL_CHECK(glGenRenderbuffers(2, renderbuffer_ids));
+    GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer_ids[0]));
+    GL_CHECK(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, window_width, window_height));
+    GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer_ids[1]));
+    GL_CHECK(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, window_width, window_height));
+
+    GL_CHECK(glGenFramebuffers(1, &fbo_id));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo_id));
+    GL_CHECK(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer_ids[0]));
+    GL_CHECK(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,  GL_RENDERBUFFER, renderbuffer_ids[1]));
+
+    GL_CHECK(glViewport(0, 0, window_width, window_height));
+    GL_CHECK(glEnable(GL_BLEND));
+    GL_CHECK(glEnable(GL_DEPTH_TEST));
+    GL_CHECK(glEnable(GL_CULL_FACE));
+    GL_CHECK(glUseProgram(program_id));
+    GL_CHECK(glBindVertexArray(vao_id));
+
+    vector<unsigned char> reference_frame(window_width * window_height * 4);
+    vector<unsigned char> frame(window_width * window_height * 4);
+    vector<unsigned char> texels;
+
+    bind_profiler_textures(reference_texture_ids);
+    draw_profiler_frame();
+    GL_CHECK(glReadPixels(0, 0, window_width, window_height, GL_RGBA, GL_UNSIGNED_BYTE, &reference_frame[0]));
+
+    /* Largest footprint meeting ASTC_PROFILER_PSNR_THRESHOLD for each texture, at any precision. */
+    int recommended_set_ids[3] = { 0, 0, 0 };
+
+    LOGI("ASTC profiler: %d frames of %dx%d per measurement, PSNR against 4x4 decoded at full precision.\n",
+         ASTC_PROFILER_FRAMES, window_width, window_height);
+    LOGI("ASTC profiler: block  bpp   decode   frame ms  frame dB  cloud dB  color dB  night dB\n");
+
+    /* Only the UNORM sets, the decode precision of sRGB textures is always 8 bits. */
+    for (int set_id = 0; set_id < n_texture_ids; set_id++)
+    {
+        GLenum internal_format = texture_sets_info[set_id].compressed_data_internal_format;
+
+        if (internal_format < GL_COMPRESSED_RGBA_ASTC_4x4_KHR || internal_format > GL_COMPRESSED_RGBA_ASTC_12x12_KHR)
+        {
+            continue;
+        }
+
+        const int* block_dimension = block_dimensions[internal_format - GL_COMPRESSED_RGBA_ASTC_4x4_KHR];
+        float      bits_per_pixel  = 128.0f / (float) (block_dimension[0] * block_dimension[1]);
+
+        set_texture_ids[0] = texture_ids[set_id].cloud_and_gloss_texture_id;
+        set_texture_ids[1] = texture_ids[set_id].earth_color_texture_id;
+        set_texture_ids[2] = texture_ids[set_id].earth_night_texture_id;
+
+        for (int decode_format_id = 0; decode_format_id < n_decode_formats; decode_format_id++)
+        {
+            float texture_psnr[3];
+
+            for (int i = 0; i < 3; i++)
+            {
+                if (astc_decode_mode_supported)
+                {
+                    GL_CHECK(glBindTexture(GL_TEXTURE_2D, set_texture_ids[i]));
+                    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_ASTC_DECODE_PRECISION_EXT, decode_formats[decode_format_id]));
+                }
+            }
+
+            /* One untimed frame, as the driver may only act on the new precision when the textures are first used. */
+            bind_profiler_textures(set_texture_ids);
+            draw_profiler_frame();
+            GL_CHECK(glFinish());
+
+            Timer frame_timer;
+
+            frame_timer.reset();
+
+            for (int frame_id = 0; frame_id < ASTC_PROFILER_FRAMES; frame_id++)
+            {
+                draw_profiler_frame();
+            }
+
+            GL_CHECK(glFinish());
+
+            float frame_time = frame_timer.getTime() * 1000.0f / ASTC_PROFILER_FRAMES;
+
+            GL_CHECK(glReadPixels(0, 0, window_width, window_height, GL_RGBA, GL_UNSIGNED_BYTE, &frame[0]));
+
+            float frame_psnr = compute_psnr(frame, reference_frame);
+
+            /* Texel read back changes the program, viewport and state, restore them after. */
+            GL_CHECK(glDisable(GL_BLEND));
+            GL_CHECK(glDisable(GL_DEPTH_TEST));
+            GL_CHECK(glDisable(GL_CULL_FACE));
+            GL_CHECK(glBindVertexArray(0));
+
+            for (int i = 0; i < 3; i++)
+            {
+                read_texels(set_texture_ids[i], texture_widths[i], texture_heights[i], copy_program_id, texels);
+                texture_psnr[i] = compute_psnr(texels, reference_texels[i]);
+
+                if (texture_psnr[i] >= ASTC_PROFILER_PSNR_THRESHOLD)
+                {
+                    recommended_set_ids[i] = set_id;
+                }
+            }
+
+            GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo_id));
+            GL_CHECK(glViewport(0, 0, window_width, window_height));
+            GL_CHECK(glEnable(GL_BLEND));
+            GL_CHECK(glEnable(GL_DEPTH_TEST));
+            GL_CHECK(glEnable(GL_CULL_FACE));
+            GL_CHECK(glUseProgram(program_id));
+            GL_CHECK(glBindVertexArray(vao_id));
+
+            LOGI("ASTC profiler: %5dx%-2d %4.2f  %-7s  %8.3f  %8.2f  %8.2f  %8.2f  %8.2f\n",
+                 block_dimension[0], block_dimension[1], bits_per_pixel, decode_format_names[decode_format_id],
+                 frame_time, frame_psnr, texture_psnr[0], texture_psnr[1], texture_psnr[2]);
+        }
+
+        /* Put back the precision the demo uses for this set. */
+        if (astc_decode_mode_supported)
+        {
+            GLenum demo_decode_formats[3] = { texture_sets_info[set_id].cloud_and_gloss_decode_format,
+                                              texture_sets_info[set_id].earth_color_decode_format,
+                                              texture_sets_info[set_id].earth_night_decode_format };
+
+            for (int i = 0; i < 3; i++)
+            {
+                if ((demo_decode_formats[i] == GL_RGB9_E5) && !astc_decode_mode_rgb9e5_supported)
+                {
+                    demo_decode_formats[i] = GL_RGBA16F;
+                }
+
+                GL_CHECK(glBindTexture(GL_TEXTURE_2D, set_texture_ids[i]));
+                GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_ASTC_DECODE_PRECISION_EXT, demo_decode_formats[i]));
+            }
+        }
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        LOGI("ASTC profiler: largest block size above %.1f dB for %s: %s\n",
+             ASTC_PROFILER_PSNR_THRESHOLD, texture_names[i], texture_sets_info[recommended_set_ids[i]].compressed_texture_format_name);
+    }
+
+    /* Release the profiler resources and restore the state the demo expects. */
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GL_CHECK(glDeleteFramebuffers(1, &fbo_id));
+    GL_CHECK(glDeleteRenderbuffers(2, renderbuffer_ids));
+    GL_CHECK(glDeleteTextures(3, reference_texture_ids));
+    GL_CHECK(glDeleteProgram(copy_program_id));
+
+    GL_CHECK(glViewport(0, 0, window_width, window_height));
+    GL_CHECK(glUseProgram(program_id));
+
+    update_texture_bindings(true);
+}
+
 void setup_graphics(int width, int height)
 {
     window_width  = width;
@@ -618,6 +952,10 @@ void setup_graphics(int width, int height)
     /* Prepare buffer objects that will hold mesh data. */
     load_buffer_data();
 
+#if ASTC_PROFILER_MODE
+    run_profiler();
+#endif
+
     /* Start counting time. */
     timer.reset();
     fps_timer.reset();
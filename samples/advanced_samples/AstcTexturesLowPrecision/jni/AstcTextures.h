@@ -103,6 +103,16 @@
 /* Time period for each texture set to be displayed. */
 #define ASTC_TEXTURE_SWITCH_INTERVAL               (5) /* sec */
 
+/* Set to 1 to profile every block size and decode precision once at start-up, before the demo runs.
+   The results are written to logcat. */
+#define ASTC_PROFILER_MODE                         (0)
+
+/* Number of frames timed for each block size and decode precision. */
+#define ASTC_PROFILER_FRAMES                       (32)
+
+/* Lowest PSNR considered good enough when recommending a block size for a texture. */
+#define ASTC_PROFILER_PSNR_THRESHOLD               (35.0f) /* dB */
+
 /* Angular rates around several axes. */
 #define X_ROTATION_SPEED                           (5)
 #define Y_ROTATION_SPEED                           (4)
@@ -162,6 +172,28 @@ const char earth_fragment_shader_source[] =
     "}\n"
 };
 
+/* Vertex shader source code of the profiler, a triangle covering the whole viewport. */
+const char texel_copy_vertex_shader_source[] =
+{
+    "#version 300 es\n"
+    "void main() {\n"
+    "    vec2 position = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 4.0 - 1.0;\n"
+    "    gl_Position = vec4(position, 0.0, 1.0);\n"
+    "}\n"
+};
+
+/* Fragment shader source code of the profiler, copies texels one to one without filtering. */
+const char texel_copy_fragment_shader_source[] =
+{
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "uniform highp sampler2D source_texture;\n"
+    "out vec4 color;\n"
+    "void main() {\n"
+    "    color = texelFetch(source_texture, ivec2(gl_FragCoord.xy), 0);\n"
+    "}\n"
+};
+
 /**
  * \brief Create shader object and compile its source code.
  *
@@ -245,4 +277,15 @@ GLint get_and_check_attrib_location(GLuint program, const GLchar* attrib_name);
  */
 GLint get_and_check_uniform_location(GLuint program, const GLchar* uniform_name);
 
+/**
+ * \brief Render every UNORM texture set with every decode precision the implementation supports
+ *        and log the frame time and the PSNR against an uncompressed reference.
+ *
+ *        The reference is the 4x4 texture set decoded at full precision into RGBA8 textures,
+ *        as the sample does not ship the images the ASTC files were compressed from.
+ *        PSNR is given both for the rendered frame and for each texture on its own,
+ *        the latter being what a block size should be chosen on for each kind of texture.
+ */
+void run_profiler(void);
+
 #endif /* ASTC_TEXTURES_H */
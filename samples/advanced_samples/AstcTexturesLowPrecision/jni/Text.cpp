@@ -23,6 +23,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 
 namespace AstcTextures
@@ -83,7 +84,7 @@ namespace AstcTextures
         textIndex              = NULL;
 
         /* Create an orthographic projection. */
-        projectionMatrix = Matrix::matrixOrthographic(0, (float)windowWidth, 0, (float)windowHeight, 0, 1);
+        projectionMatrix = MaliSDK::Matrix::matrixOrthographic(0, (float)windowWidth, 0, (float)windowHeight, 0, 1);
 
         /* Create program object and initialize it. */
         programID = create_program(fontVertexShaderSource, fontFragmentShaderSource);
@@ -0,0 +1,52 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The radix sort reorders the whole draw buffer, so the slots past the particles update.cs
+ * wrote this frame would be sorted in with them. They are marked dead here, and the vertex
+ * shaders cull them. Not needed when the particles are not sorted, as the draw then stops
+ * at the alive count.
+ */
+
+layout (local_size_x = 64) in;
+
+layout (std430, binding = 3) readonly buffer Counters {
+    uint aliveCount[2];
+    uint deadCount;
+    uint emitCount;
+    uint deadBase;
+};
+
+layout (std430, binding = 5) writeonly buffer DrawBuffer {
+    vec4 Position[];
+};
+
+uniform uint currentList;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= aliveCount[currentList])
+    {
+        Position[index] = vec4(0.0, 0.0, 0.0, -1.0);
+    }
+}
@@ -0,0 +1,73 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Sizes the frame's emission and simulation from the counters, so the CPU never reads them back.
+ *
+ * The particles live in a fixed pool. Free slots are on the dead list, and particles in use
+ * are on one of two alive lists, which spawn.cs appends to and update.cs reads from while it
+ * builds the other one. This single thread clamps the emission requested by the emitters to
+ * the free slots, takes them off the dead list, and writes the work group counts of both
+ * passes for glDispatchComputeIndirect.
+ */
+
+layout (local_size_x = 1) in;
+
+layout (std430, binding = 3) buffer Counters {
+    uint aliveCount[2];
+    uint deadCount;
+    uint emitCount;
+    uint deadBase;
+};
+
+// Arrays rather than uvec3, which std430 would pad to 16 bytes.
+layout (std430, binding = 4) writeonly buffer IndirectArgs {
+    uint emitGroups[3];
+    uint simulateGroups[3];
+};
+
+uniform uint requestedCount;
+uniform uint currentList;
+
+const uint WORK_GROUP_SIZE = 64u;
+
+void main()
+{
+    // If the pool runs dry, the emitters late in the request are the ones left short.
+    uint count = min(requestedCount, deadCount);
+
+    // spawn.cs takes the free slots below deadBase, the top of the dead list before this frame.
+    emitCount = count;
+    deadBase = deadCount;
+    deadCount -= count;
+
+    // Every particle emitted is alive for update.cs.
+    emitGroups[0] = (count + WORK_GROUP_SIZE - 1u) / WORK_GROUP_SIZE;
+    emitGroups[1] = 1u;
+    emitGroups[2] = 1u;
+    simulateGroups[0] = (aliveCount[currentList] + count + WORK_GROUP_SIZE - 1u) / WORK_GROUP_SIZE;
+    simulateGroups[1] = 1u;
+    simulateGroups[2] = 1u;
+
+    // The list update.cs builds.
+    aliveCount[1u - currentList] = 0u;
+}
@@ -34,13 +34,27 @@ uniform vec3 smokeColor;
 uniform vec3 smokeShadow;
 uniform sampler2D shadowMap0;
 
+// Sprites smaller than this many pixels are left to particle_bin.cs, 0 to draw them all.
+uniform float binnedSize;
+
 const float scale = 0.85;
 
 void main()
 {
     vec4 viewPos = view * vec4(position.xyz, 1.0);
     float viewDist = length(viewPos.xyz);
-    gl_PointSize = scale * (20.0 - 6.0 * (viewDist - 1.0) / (3.0 - 1.0));
+    float size = scale * (20.0 - 6.0 * (viewDist - 1.0) / (3.0 - 1.0));
+
+    // Dead slots of the draw buffer, see clear_dead.cs, and the particles rasterized by
+    // particle_accumulate.cs. Points outside the clip volume are culled.
+    if (position.w < 0.0 || size < binnedSize)
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 1.0;
+        return;
+    }
+
+    gl_PointSize = size;
     lifetime = position.w;
     gl_Position = projection * viewPos;
 
@@ -0,0 +1,132 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Rasterizes the particles too small to be worth a point sprite, without drawing them.
+ *
+ * A cloud of tiny sprites is bound by the blending units, which process every covered pixel
+ * of every sprite one at a time. Instead, particle_bin.cs, particle_scan.cs and
+ * particle_scatter.cs sort the particles into lists of screen tiles, and a work group per
+ * tile blends the sprites of its list in shared memory, before writing the whole tile out
+ * once. The sprites land in any order, so they are blended order independently: the opacity
+ * weighted average colour, covering the pixel as much as all of them together, which is close
+ * to sorted blending for a cloud of similar particles. The tile counts are left cleared for
+ * the next frame.
+ */
+
+layout (local_size_x = 16, local_size_y = 16) in;
+
+struct Splat
+{
+    vec4 sprite;
+    vec4 color;
+};
+
+layout (std430, binding = 1) readonly buffer SplatBuffer {
+    Splat splats[];
+};
+
+layout (std430, binding = 2) buffer TileCounts {
+    uint tileCount[];
+};
+
+layout (std430, binding = 4) readonly buffer TileStarts {
+    uint tileStart[];
+};
+
+layout (std430, binding = 5) readonly buffer TileLists {
+    uint tileList[];
+};
+
+// Average colour times coverage (rgb) and transmittance (a), composited by particle_composite.fs.
+layout (rgba16f, binding = 0) writeonly uniform highp image2D smallParticles;
+
+#define TILE_SIZE 16
+#define TILE_PIXELS 256u
+
+// Fixed point sums per pixel of the tile: premultiplied colour, opacity and optical depth.
+shared uint colorSum[3u * TILE_PIXELS];
+shared uint opacitySum[TILE_PIXELS];
+shared uint depthSum[TILE_PIXELS];
+
+const float FIXED_POINT = 4096.0;
+
+void main()
+{
+    uint tile = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    ivec2 tileOrigin = ivec2(gl_WorkGroupID.xy) * TILE_SIZE;
+    uint threads = gl_WorkGroupSize.x * gl_WorkGroupSize.y;
+    uint pixel = gl_LocalInvocationIndex;
+
+    colorSum[pixel] = 0u;
+    colorSum[TILE_PIXELS + pixel] = 0u;
+    colorSum[2u * TILE_PIXELS + pixel] = 0u;
+    opacitySum[pixel] = 0u;
+    depthSum[pixel] = 0u;
+    memoryBarrierShared();
+    barrier();
+
+    uint count = tileCount[tile];
+    uint start = tileStart[tile];
+    for (uint i = gl_LocalInvocationIndex; i < count; i += threads)
+    {
+        Splat splat = splats[tileList[start + i]];
+        vec2 center = splat.sprite.xy;
+        float halfSize = 0.5 * splat.sprite.z;
+        ivec2 lo = max(ivec2(floor(center - halfSize)), tileOrigin);
+        ivec2 hi = min(ivec2(floor(center + halfSize)), tileOrigin + TILE_SIZE - 1);
+
+        for (int y = lo.y; y <= hi.y; y++)
+        {
+            for (int x = lo.x; x <= hi.x; x++)
+            {
+                // The sprite of particle.fs, over the pixels whose centre it covers
+                vec2 xy = (vec2(x, y) + 0.5 - center) / halfSize;
+                if (any(greaterThan(abs(xy), vec2(1.0))))
+                    continue;
+                float alpha = exp2(-dot(xy, xy) * 5.0) * splat.sprite.w;
+                if (alpha * FIXED_POINT < 0.5)
+                    continue;
+
+                uint t = uint((y - tileOrigin.y) * TILE_SIZE + (x - tileOrigin.x));
+                uvec3 premultiplied = uvec3(splat.color.rgb * alpha * FIXED_POINT + 0.5);
+                atomicAdd(colorSum[t], premultiplied.r);
+                atomicAdd(colorSum[TILE_PIXELS + t], premultiplied.g);
+                atomicAdd(colorSum[2u * TILE_PIXELS + t], premultiplied.b);
+                atomicAdd(opacitySum[t], uint(alpha * FIXED_POINT + 0.5));
+                atomicAdd(depthSum[t], uint(-log2(1.0 - min(alpha, 0.999)) * FIXED_POINT + 0.5));
+            }
+        }
+    }
+    memoryBarrierShared();
+    barrier();
+
+    vec3 color = vec3(colorSum[pixel], colorSum[TILE_PIXELS + pixel], colorSum[2u * TILE_PIXELS + pixel]);
+    float opacity = float(opacitySum[pixel]);
+    float transmittance = exp2(-float(depthSum[pixel]) / FIXED_POINT);
+    vec3 average = opacity > 0.0 ? color / opacity : vec3(0.0);
+    imageStore(smallParticles, tileOrigin + ivec2(gl_LocalInvocationID.xy), vec4(average * (1.0 - transmittance), transmittance));
+
+    // Every thread has read the count before the barrier above
+    if (gl_LocalInvocationIndex == 0u)
+        tileCount[tile] = 0u;
+}
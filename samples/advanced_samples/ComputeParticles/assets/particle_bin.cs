@@ -0,0 +1,147 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * First pass of the compute rasterization of the small particles, see particle_accumulate.cs.
+ *
+ * Every particle whose point sprite would be smaller than maxSize pixels is projected, depth
+ * tested against the scene at its centre, lit as particle.vs does, and counted into the screen
+ * tiles its sprite touches. Its slot in each of them is kept for particle_scatter.cs. The
+ * larger particles are left to the point sprites.
+ */
+
+precision mediump sampler2D;
+
+layout (local_size_x = 64) in;
+
+layout (std430, binding = 0) readonly buffer DrawBuffer {
+    vec4 Position[];
+};
+
+// Window position (xy), sprite size in pixels (z, negative when not binned) and opacity (w) of
+// the sprite, and the colour of each particle.
+struct Splat
+{
+    vec4 sprite;
+    vec4 color;
+};
+
+layout (std430, binding = 1) writeonly buffer SplatBuffer {
+    Splat splats[];
+};
+
+layout (std430, binding = 2) buffer TileCounts {
+    uint tileCount[];
+};
+
+// Slot of the particle in each of the up to 2x2 tiles it touches, row after row.
+layout (std430, binding = 3) writeonly buffer SplatSlots {
+    uvec4 splatSlot[];
+};
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 projectionViewLight;
+uniform vec3 smokeColor;
+uniform vec3 smokeShadow;
+uniform float particleLifetime;
+uniform float maxSize;
+uniform ivec2 resolution;
+uniform ivec2 tiles;
+uniform highp sampler2D sceneDepth;
+uniform sampler2D shadowMap0;
+
+#define TILE_SIZE 16
+
+// Point size of particle.vs.
+const float scale = 0.85;
+
+bool project(vec4 particle, out Splat splat)
+{
+    splat.sprite = vec4(0.0, 0.0, -1.0, 0.0);
+    splat.color = vec4(0.0);
+
+    // Dead slots, see clear_dead.cs
+    if (particle.w < 0.0)
+        return false;
+
+    vec4 viewPos = view * vec4(particle.xyz, 1.0);
+    float size = scale * (20.0 - 6.0 * (length(viewPos.xyz) - 1.0) / (3.0 - 1.0));
+    if (size >= maxSize)
+        return false;
+
+    // Points outside the clip volume are culled, as by the rasterizer
+    vec4 clipPos = projection * viewPos;
+    if (any(greaterThan(abs(clipPos.xyz), vec3(clipPos.w))))
+        return false;
+    vec3 ndc = clipPos.xyz / clipPos.w;
+    vec2 window = (0.5 + 0.5 * ndc.xy) * vec2(resolution);
+
+    // A point sprite is at the same depth all over, so testing it at its centre is enough
+    // for sprites this small
+    if (0.5 + 0.5 * ndc.z > texelFetch(sceneDepth, min(ivec2(window), resolution - 1), 0).r)
+        return false;
+
+    // Same shadow as particle.vs
+    vec4 lightPos = projectionViewLight * vec4(particle.xyz, 1.0);
+    vec3 shadowTexel = vec3(0.5) + 0.5 * lightPos.xyz;
+    vec4 shadow0 = textureLod(shadowMap0, shadowTexel.xy, 0.0);
+    vec4 mask0 = clamp((vec4(shadowTexel.z) - vec4(0.00, 0.25, 0.50, 0.75)) * 4.0, vec4(0.0), vec4(1.0));
+    float shadow = clamp(dot(shadow0 * mask0, vec4(1.0)), 0.0, 1.0);
+
+    // Faded into and out of existence as in particle.fs
+    splat.sprite = vec4(window, size, clamp(particle.w / particleLifetime, 0.0, 1.0));
+    splat.color = vec4(smokeColor * (1.0 - shadow) + shadow * smokeShadow, 0.0);
+    return true;
+}
+
+// The tiles the sprite covers, the same in particle_scatter.cs.
+void tile_range(vec4 sprite, out ivec2 tileMin, out ivec2 tileMax)
+{
+    tileMin = clamp(ivec2(floor(sprite.xy - 0.5 * sprite.z)) / TILE_SIZE, ivec2(0), tiles - 1);
+    tileMax = clamp(ivec2(floor(sprite.xy + 0.5 * sprite.z)) / TILE_SIZE, ivec2(0), tiles - 1);
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    Splat splat;
+    bool binned = project(Position[index], splat);
+    splats[index] = splat;
+    if (!binned)
+        return;
+
+    // Sprites are smaller than a tile, so they touch 2x2 tiles at most
+    ivec2 tileMin, tileMax;
+    tile_range(splat.sprite, tileMin, tileMax);
+    uvec4 slot = uvec4(0u);
+    int i = 0;
+    for (int y = tileMin.y; y <= tileMax.y; y++)
+    {
+        for (int x = tileMin.x; x <= tileMax.x; x++)
+        {
+            slot[i] = atomicAdd(tileCount[y * tiles.x + x], 1u);
+            i++;
+        }
+    }
+    splatSlot[index] = slot;
+}
@@ -0,0 +1,49 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+
+precision mediump float;
+
+in float lifetime;
+in vec3 color;
+
+uniform float particleLifetime;
+
+// Weighted blended order-independent transparency, see WeightedBlendedOIT.h
+layout(location = 0) out vec4 accumulation;
+layout(location = 1) out vec4 weight;
+
+void main()
+{
+    vec2 xy = 2.0 * gl_PointCoord.xy - vec2(1.0);
+    float r2 = dot(xy, xy);
+
+    // Smooth alphablending into and out of existence
+    float s = clamp(lifetime / particleLifetime, 0.0, 1.0);
+    float alpha = exp2(-r2 * 5.0) * s;
+
+    // Nearer particles weigh more, with the view space distance taken from w.
+    // The weights stay small so thousands of overlapping particles do not
+    // overflow the half float sums.
+    float z = 1.0 / gl_FragCoord.w;
+    float w = clamp(1.0 / (1e-5 + pow(z / 5.0, 2.0) + pow(z / 200.0, 6.0)), 1e-2, 3e3);
+
+    accumulation = vec4(color * alpha * w, alpha);
+    weight = vec4(alpha * w);
+}
@@ -0,0 +1,75 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Second pass of the compute rasterization of the small particles, see particle_accumulate.cs.
+ *
+ * Exclusive prefix sum of the tile counts of particle_bin.cs, which is where the list of each
+ * tile starts. A single work group: every thread adds up a run of tiles, the run totals are
+ * scanned in shared memory, and every thread writes out the starts of its run.
+ */
+
+layout (local_size_x = 256) in;
+
+layout (std430, binding = 2) readonly buffer TileCounts {
+    uint tileCount[];
+};
+
+layout (std430, binding = 4) writeonly buffer TileStarts {
+    uint tileStart[];
+};
+
+uniform uint numTiles;
+
+shared uint runTotal[256];
+
+void main()
+{
+    uint thread = gl_LocalInvocationIndex;
+    uint run = (numTiles + 255u) / 256u;
+    uint begin = thread * run;
+    uint end = min(begin + run, numTiles);
+
+    uint sum = 0u;
+    for (uint i = begin; i < end; i++)
+        sum += tileCount[i];
+    runTotal[thread] = sum;
+    memoryBarrierShared();
+    barrier();
+
+    // Inclusive scan of the run totals
+    for (uint offset = 1u; offset < 256u; offset *= 2u)
+    {
+        uint value = thread >= offset ? runTotal[thread - offset] : 0u;
+        barrier();
+        runTotal[thread] += value;
+        memoryBarrierShared();
+        barrier();
+    }
+
+    uint start = runTotal[thread] - sum;
+    for (uint i = begin; i < end; i++)
+    {
+        tileStart[i] = start;
+        start += tileCount[i];
+    }
+}
@@ -0,0 +1,85 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Third pass of the compute rasterization of the small particles, see particle_accumulate.cs.
+ *
+ * Writes every binned particle to the slots particle_bin.cs took in the lists of its tiles,
+ * now that particle_scan.cs has laid the lists out one after the other.
+ */
+
+layout (local_size_x = 64) in;
+
+struct Splat
+{
+    vec4 sprite;
+    vec4 color;
+};
+
+layout (std430, binding = 1) readonly buffer SplatBuffer {
+    Splat splats[];
+};
+
+layout (std430, binding = 3) readonly buffer SplatSlots {
+    uvec4 splatSlot[];
+};
+
+layout (std430, binding = 4) readonly buffer TileStarts {
+    uint tileStart[];
+};
+
+layout (std430, binding = 5) writeonly buffer TileLists {
+    uint tileList[];
+};
+
+uniform ivec2 tiles;
+
+#define TILE_SIZE 16
+
+// Same as particle_bin.cs.
+void tile_range(vec4 sprite, out ivec2 tileMin, out ivec2 tileMax)
+{
+    tileMin = clamp(ivec2(floor(sprite.xy - 0.5 * sprite.z)) / TILE_SIZE, ivec2(0), tiles - 1);
+    tileMax = clamp(ivec2(floor(sprite.xy + 0.5 * sprite.z)) / TILE_SIZE, ivec2(0), tiles - 1);
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    vec4 sprite = splats[index].sprite;
+    if (sprite.z < 0.0)
+        return;
+
+    ivec2 tileMin, tileMax;
+    tile_range(sprite, tileMin, tileMax);
+    uvec4 slot = splatSlot[index];
+    int i = 0;
+    for (int y = tileMin.y; y <= tileMax.y; y++)
+    {
+        for (int x = tileMin.x; x <= tileMax.x; x++)
+        {
+            uint tile = uint(y * tiles.x + x);
+            tileList[tileStart[tile] + slot[i]] = index;
+            i++;
+        }
+    }
+}
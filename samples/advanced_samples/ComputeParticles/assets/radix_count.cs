@@ -0,0 +1,83 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * First step of a 4-bit radix sort pass. The 2-bit sort (scan_first.cs and friends)
+ * needs 8 passes over 16-bit keys; working on 4 bits at a time halves that, and
+ * replaces the recursive scan with a small histogram which a single work group can scan.
+ *
+ * A pass is done in three dispatches:
+ *   radix_count.cs   - Every work group counts how many of its keys have each of the 16 digit values.
+ *   radix_scan.cs    - An exclusive scan of all the counts gives every (digit, work group) pair
+ *                      the position of its first element in the sorted output.
+ *   radix_scatter.cs - Every element is written to that position plus its rank among the elements
+ *                      with the same digit in its work group.
+ *
+ * The counts are stored digit-major, all work groups' counts for digit 0 first, then digit 1, etc.
+ * With that layout a single linear scan puts all elements with a smaller digit first,
+ * and elements with the same digit in their original order, which keeps the sort stable.
+ */
+
+layout(local_size_x = 128) in; // One key per thread, so this value should be BLOCK_SIZE.
+#define NUM_BINS 16u
+
+layout(binding = 0, std430) readonly buffer Data
+{
+    vec4 in_points[];
+};
+
+layout(binding = 1, std430) writeonly buffer HistogramData
+{
+    uint histogram[];
+};
+
+shared uint digitCount[NUM_BINS];
+
+uniform int bitOffset;
+uniform vec3 axis;
+uniform float zMin;
+uniform float zMax;
+
+// Same key as in scan_first.cs, but extracting 4 bits. Must match radix_scatter.cs exactly.
+uint decodeKey(vec4 point)
+{
+    float z = dot(point.xyz, axis);
+    z = 65535.0 * clamp((z - zMin) / (zMax - zMin), 0.0, 1.0);
+    return bitfieldExtract(uint(z), bitOffset, 4);
+}
+
+void main()
+{
+    uint local_ident = gl_LocalInvocationID.x;
+
+    if (local_ident < NUM_BINS)
+        digitCount[local_ident] = 0u;
+    memoryBarrierShared();
+    barrier();
+
+    atomicAdd(digitCount[decodeKey(in_points[gl_GlobalInvocationID.x])], 1u);
+    memoryBarrierShared();
+    barrier();
+
+    if (local_ident < NUM_BINS)
+        histogram[local_ident * gl_NumWorkGroups.x + gl_WorkGroupID.x] = digitCount[local_ident];
+}
@@ -0,0 +1,72 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * See radix_count.cs for an overview of the 4-bit radix sort.
+ * Exclusive scan of the per work group digit counts, in place.
+ * Runs as a single work group. Every thread scans a contiguous chunk in registers,
+ * and the chunk sums are combined with a scan in shared memory.
+ */
+
+layout(local_size_x = 128) in;
+
+layout(binding = 0, std430) buffer HistogramData
+{
+    uint histogram[];
+};
+
+shared uint sharedData[gl_WorkGroupSize.x];
+
+void main()
+{
+    uint local_ident = gl_LocalInvocationID.x;
+
+    // The histogram size must be a multiple of the work group size, see sort.cpp.
+    uint count = uint(histogram.length()) / gl_WorkGroupSize.x;
+    uint base = local_ident * count;
+
+    uint sum = 0u;
+    for (uint i = 0u; i < count; i++)
+        sum += histogram[base + i];
+
+    sharedData[local_ident] = sum;
+    memoryBarrierShared();
+    barrier();
+
+    // Inclusive scan of the chunk sums, doubling the distance every step.
+    for (uint step = 1u; step < gl_WorkGroupSize.x; step <<= 1u) {
+        uint prev = local_ident >= step ? sharedData[local_ident - step] : 0u;
+        memoryBarrierShared();
+        barrier();
+        sharedData[local_ident] += prev;
+        memoryBarrierShared();
+        barrier();
+    }
+
+    // Everything before our chunk is the inclusive sum of the previous thread.
+    uint running = local_ident > 0u ? sharedData[local_ident - 1u] : 0u;
+    for (uint i = 0u; i < count; i++) {
+        uint value = histogram[base + i];
+        histogram[base + i] = running;
+        running += value;
+    }
+}
@@ -0,0 +1,90 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * See radix_count.cs for an overview of the 4-bit radix sort.
+ * Moves every element to its sorted position for the current digit.
+ * The position is the scanned histogram entry for the element's digit and work group,
+ * plus the number of elements before it in the work group with the same digit.
+ *
+ * To find that rank, every thread sets its bit in a shared bit mask per digit.
+ * Counting the bits below our own then gives the rank without any further synchronization.
+ */
+
+layout(local_size_x = 128) in; // One key per thread, so this value should be BLOCK_SIZE.
+#define NUM_BINS 16u
+#define MASK_WORDS (gl_WorkGroupSize.x / 32u)
+
+layout(binding = 0, std430) readonly buffer Data
+{
+    vec4 in_points[];
+};
+
+layout(binding = 1, std430) readonly buffer HistogramData
+{
+    uint histogram[];
+};
+
+layout(binding = 2, std430) writeonly buffer OutData
+{
+    vec4 out_points[];
+};
+
+shared uint digitMask[NUM_BINS * MASK_WORDS];
+
+uniform int bitOffset;
+uniform vec3 axis;
+uniform float zMin;
+uniform float zMax;
+
+// Must match radix_count.cs exactly.
+uint decodeKey(vec4 point)
+{
+    float z = dot(point.xyz, axis);
+    z = 65535.0 * clamp((z - zMin) / (zMax - zMin), 0.0, 1.0);
+    return bitfieldExtract(uint(z), bitOffset, 4);
+}
+
+void main()
+{
+    uint local_ident = gl_LocalInvocationID.x;
+
+    if (local_ident < NUM_BINS * MASK_WORDS)
+        digitMask[local_ident] = 0u;
+    memoryBarrierShared();
+    barrier();
+
+    vec4 point = in_points[gl_GlobalInvocationID.x];
+    uint digit = decodeKey(point);
+    uint word = local_ident >> 5u;
+    uint bit = local_ident & 31u;
+
+    atomicOr(digitMask[digit * MASK_WORDS + word], 1u << bit);
+    memoryBarrierShared();
+    barrier();
+
+    uint rank = uint(bitCount(digitMask[digit * MASK_WORDS + word] & ((1u << bit) - 1u)));
+    for (uint i = 0u; i < word; i++)
+        rank += uint(bitCount(digitMask[digit * MASK_WORDS + i]));
+
+    out_points[histogram[digit * gl_NumWorkGroups.x + gl_WorkGroupID.x] + rank] = point;
+}
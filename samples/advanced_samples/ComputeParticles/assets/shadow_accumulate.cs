@@ -0,0 +1,114 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Accumulates the opacity shadow map at a fraction of the resolution of the full one,
+ * without drawing the particles.
+ *
+ * Blending every particle as a point sprite into the full map costs as much as the
+ * overdraw of the cloud from the light, all of it through the blending units. Instead,
+ * shadow_bin.cs bins the particles into tiles, and a work group per tile adds up the splats
+ * of its particles in shared memory, one fixed point sum per texel and depth slice, before
+ * writing the whole tile out once. The tile lists are left empty for the next update.
+ */
+
+layout (local_size_x = 16, local_size_y = 8) in;
+
+layout (std430, binding = 1) readonly buffer SplatBuffer {
+    vec4 Splat[];
+};
+
+layout (std430, binding = 2) buffer TileCounts {
+    uint tileCount[];
+};
+
+layout (std430, binding = 3) readonly buffer TileLists {
+    uint tileList[];
+};
+
+layout (rgba8, binding = 0) writeonly uniform highp image2D shadowMap;
+
+uniform uint poolSize;
+
+#define TILE_SIZE 16
+#define TILE_TEXELS 256u
+
+// Four depth slices of every texel of the tile, slice after slice.
+shared uint opacity[4u * TILE_TEXELS];
+
+const float FIXED_POINT = 4096.0;
+
+void main()
+{
+    uint tile = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    ivec2 tileOrigin = ivec2(gl_WorkGroupID.xy) * TILE_SIZE;
+    uint threads = gl_WorkGroupSize.x * gl_WorkGroupSize.y;
+
+    for (uint i = gl_LocalInvocationIndex; i < 4u * TILE_TEXELS; i += threads)
+        opacity[i] = 0u;
+    memoryBarrierShared();
+    barrier();
+
+    uint count = tileCount[tile];
+    for (uint i = gl_LocalInvocationIndex; i < count; i += threads)
+    {
+        vec4 splat = Splat[tileList[tile * poolSize + i]];
+        vec2 corner = splat.xy - 0.5;
+        vec2 base = floor(corner);
+        vec2 f = corner - base;
+
+        // Same depth slices as shadowmap.vs
+        vec4 mask = clamp(floor(mod(vec4(splat.w) + vec4(1.00, 0.75, 0.50, 0.25), vec4(1.25))), vec4(0.0), vec4(1.0));
+
+        for (int y = 0; y < 2; y++)
+        {
+            for (int x = 0; x < 2; x++)
+            {
+                ivec2 texel = ivec2(base) + ivec2(x, y) - tileOrigin;
+                if (any(lessThan(texel, ivec2(0))) || any(greaterThanEqual(texel, ivec2(TILE_SIZE))))
+                    continue;
+
+                float weight = (x == 0 ? 1.0 - f.x : f.x) * (y == 0 ? 1.0 - f.y : f.y) * splat.z;
+                uvec4 value = uvec4(mask * weight * FIXED_POINT + 0.5);
+                uint t = uint(texel.y * TILE_SIZE + texel.x);
+                for (uint slice = 0u; slice < 4u; slice++)
+                {
+                    if (value[slice] != 0u)
+                        atomicAdd(opacity[slice * TILE_TEXELS + t], value[slice]);
+                }
+            }
+        }
+    }
+    memoryBarrierShared();
+    barrier();
+
+    for (uint row = gl_LocalInvocationID.y; row < uint(TILE_SIZE); row += gl_WorkGroupSize.y)
+    {
+        uint t = row * uint(TILE_SIZE) + gl_LocalInvocationID.x;
+        vec4 value = vec4(opacity[t], opacity[TILE_TEXELS + t], opacity[2u * TILE_TEXELS + t], opacity[3u * TILE_TEXELS + t]) / FIXED_POINT;
+        imageStore(shadowMap, tileOrigin + ivec2(gl_LocalInvocationID.x, row), clamp(value, vec4(0.0), vec4(1.0)));
+    }
+
+    // Every thread has read the count before the barrier above
+    if (gl_LocalInvocationIndex == 0u)
+        tileCount[tile] = 0u;
+}
@@ -0,0 +1,99 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * First pass of the binned opacity shadow map, see shadow_accumulate.cs.
+ *
+ * Every particle is projected into the low resolution map and turned into a bilinear splat
+ * over the 2x2 texels around it, with the opacity shadowmap.fs would have blended in over
+ * its whole point sprite. It is then added to the list of every tile the splat touches.
+ */
+
+layout (local_size_x = 64) in;
+
+layout (std430, binding = 0) readonly buffer DrawBuffer {
+    vec4 Position[];
+};
+
+// Texel position (xy), opacity (z) and light depth (w) of each particle.
+layout (std430, binding = 1) writeonly buffer SplatBuffer {
+    vec4 Splat[];
+};
+
+layout (std430, binding = 2) buffer TileCounts {
+    uint tileCount[];
+};
+
+// poolSize entries per tile, as many as there can be particles touching it.
+layout (std430, binding = 3) writeonly buffer TileLists {
+    uint tileList[];
+};
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform int resolution;
+uniform float spriteScale;
+uniform uint poolSize;
+
+#define TILE_SIZE 16
+
+// Point size of shadowmap.vs.
+const float scale = 0.7;
+
+// The sprite of shadowmap.fs, exp2(-5 r^2) * 0.025, integrated over its disc of radius 1, is
+// 0.025 * pi / (5 ln 2) times the area of the disc.
+const float spriteOpacity = 0.025 * 3.14159265 / (5.0 * 0.69314718);
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    vec4 particle = Position[index];
+
+    // Dead slots, see clear_dead.cs
+    if (particle.w < 0.0)
+        return;
+
+    vec4 viewPos = view * vec4(particle.xyz, 1.0);
+    vec4 lightPos = projection * viewPos;
+    float diameter = spriteScale * scale * (16.0 - 6.0 * (length(viewPos.xyz) - 1.0) / (3.0 - 1.0));
+    float opacity = spriteOpacity * 0.25 * diameter * diameter;
+
+    vec2 texel = (0.5 + 0.5 * lightPos.xy) * float(resolution);
+    Splat[index] = vec4(texel, opacity, 0.5 + 0.5 * lightPos.z);
+
+    // The splat covers the texels from base to base + 1
+    ivec2 base = ivec2(floor(texel - 0.5));
+    if (any(lessThan(base, ivec2(-1))) || any(greaterThanEqual(base, ivec2(resolution))))
+        return;
+
+    int tilesPerSide = resolution / TILE_SIZE;
+    ivec2 tileMin = clamp((base + TILE_SIZE) / TILE_SIZE - 1, ivec2(0), ivec2(tilesPerSide - 1));
+    ivec2 tileMax = clamp((base + 1) / TILE_SIZE, ivec2(0), ivec2(tilesPerSide - 1));
+    for (int y = tileMin.y; y <= tileMax.y; y++)
+    {
+        for (int x = tileMin.x; x <= tileMax.x; x++)
+        {
+            uint tile = uint(y * tilesPerSide + x);
+            tileList[tile * poolSize + atomicAdd(tileCount[tile], 1u)] = index;
+        }
+    }
+}
@@ -30,6 +30,14 @@ const float scale = 0.7;
 
 void main()
 {
+    // Dead slots of the draw buffer, see clear_dead.cs. Points outside the clip volume are culled.
+    if (position.w < 0.0)
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 1.0;
+        return;
+    }
+
     vec4 viewPos = view * vec4(position.xyz, 1.0);
     gl_Position = projection * viewPos;
     gl_PointSize = scale * (16.0 - 6.0 * (length(viewPos.xyz) - 1.0) / (3.0 - 1.0));
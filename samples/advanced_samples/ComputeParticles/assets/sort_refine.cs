@@ -0,0 +1,92 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Refines an almost sorted particle buffer, used instead of a full radix sort
+ * while the order from the previous frame is still close to correct.
+ *
+ * Every work group loads a block of 2 * gl_WorkGroupSize.x particles into shared memory
+ * and runs <numSteps> steps of odd-even transposition sort on it. Each step compares
+ * and swaps disjoint neighbour pairs, alternating between even and odd pairs.
+ * Particles can only move within their block, so sort.cpp alternates <blockOffset>
+ * between 0 and half a block to let them cross block boundaries.
+ */
+
+layout(local_size_x = 128) in;
+#define BLOCK_ELEMENTS (2u * gl_WorkGroupSize.x)
+
+layout(binding = 0, std430) buffer Data
+{
+    vec4 points[];
+};
+
+shared vec4 sharedPoints[BLOCK_ELEMENTS];
+shared float sharedDepth[BLOCK_ELEMENTS];
+
+uniform vec3 axis;
+uniform uint blockOffset;
+uniform uint numSteps;
+
+void main()
+{
+    uint local_ident = gl_LocalInvocationID.x;
+    uint base = blockOffset + gl_WorkGroupID.x * BLOCK_ELEMENTS;
+    uint count = uint(points.length());
+
+    // With an offset the last block runs past the end of the buffer.
+    // Padding with the largest depth keeps the padding at the end of the block.
+    for (uint i = 0u; i < 2u; i++) {
+        uint local_index = local_ident + i * gl_WorkGroupSize.x;
+        uint index = base + local_index;
+        if (index < count) {
+            vec4 point = points[index];
+            sharedPoints[local_index] = point;
+            sharedDepth[local_index] = dot(point.xyz, axis);
+        } else {
+            sharedDepth[local_index] = 3.4e38;
+        }
+    }
+    memoryBarrierShared();
+    barrier();
+
+    for (uint step = 0u; step < numSteps; step++) {
+        uint a = 2u * local_ident + (step & 1u);
+        uint b = a + 1u;
+        if (b < BLOCK_ELEMENTS && sharedDepth[a] > sharedDepth[b]) {
+            vec4 point = sharedPoints[a];
+            float depth = sharedDepth[a];
+            sharedPoints[a] = sharedPoints[b];
+            sharedDepth[a] = sharedDepth[b];
+            sharedPoints[b] = point;
+            sharedDepth[b] = depth;
+        }
+        memoryBarrierShared();
+        barrier();
+    }
+
+    for (uint i = 0u; i < 2u; i++) {
+        uint local_index = local_ident + i * gl_WorkGroupSize.x;
+        uint index = base + local_index;
+        if (index < count)
+            points[index] = sharedPoints[local_index];
+    }
+}
@@ -41,17 +41,47 @@ float snoise(float x)
 
 layout (local_size_x = 64) in;
 
-layout (std140, binding = 0) buffer SpawnBuffer {
-    vec4 SpawnInfo[];
+layout (std430, binding = 0) writeonly buffer ParticleBuffer {
+    vec4 Particle[];
 };
 
-uniform vec3 emitterPos;
+layout (std430, binding = 1) writeonly buffer AliveList {
+    uint Alive[];
+};
+
+layout (std430, binding = 2) readonly buffer DeadList {
+    uint Dead[];
+};
+
+layout (std430, binding = 3) buffer Counters {
+    uint aliveCount[2];
+    uint deadCount;
+    uint emitCount;
+    uint deadBase;
+};
+
+#define MAX_EMITTERS 4
+
+// Position (xyz) and spawn radius (w) of each emitter, and the end of its range of this frame's particles.
+uniform vec4 emitterPos[MAX_EMITTERS];
+uniform uint emitterEnd[MAX_EMITTERS];
 uniform float particleLifetime;
 uniform float time;
+uniform uint currentList;
+uniform uint poolSize;
 
 void main()
 {
-    uint index = gl_GlobalInvocationID.x;
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= emitCount)
+        return;
+
+    uint emitter = 0u;
+    while (emitter < uint(MAX_EMITTERS - 1) && id >= emitterEnd[emitter])
+        emitter++;
+
+    // emit_args.cs has already taken these slots off the dead list.
+    uint index = Dead[deadBase - 1u - id];
 
     vec3 p;
 
@@ -62,13 +92,14 @@ void main()
     p.y = snoise(seed + 127.0);
 
     // Normalize to get sphere distribution
-    p = (0.06 + 0.04 * snoise(seed + 491.0)) * normalize(p);
+    p = emitterPos[emitter].w * (0.6 + 0.4 * snoise(seed + 491.0)) * normalize(p);
 
-    // Particle respawns at emitter
-    p += emitterPos;
+    // Particle spawns at its emitter
+    p += emitterPos[emitter].xyz;
 
     // New lifetime with slight variation
     float newLifetime = (1.0 + 0.25 * snoise(seed)) * particleLifetime;
 
-    SpawnInfo[index] = vec4(p, newLifetime);
+    Particle[index] = vec4(p, newLifetime);
+    Alive[currentList * poolSize + atomicAdd(aliveCount[currentList], 1u)] = index;
 }
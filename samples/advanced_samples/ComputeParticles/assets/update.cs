@@ -20,20 +20,36 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+// Simulates the particles on the current alive list, and moves them to the other list
+// and into the draw buffer, or onto the dead list once their lifetime runs out.
 layout (local_size_x = 64) in;
-layout (std140, binding = 0) buffer SpawnBuffer {
-    vec4 SpawnInfo[];
+layout (std430, binding = 0) buffer ParticleBuffer {
+    vec4 Particle[];
 };
-layout (std140, binding = 1) buffer PositionBuffer {
+layout (std430, binding = 1) buffer AliveList {
+    uint Alive[];
+};
+layout (std430, binding = 2) writeonly buffer DeadList {
+    uint Dead[];
+};
+layout (std430, binding = 3) buffer Counters {
+    uint aliveCount[2];
+    uint deadCount;
+    uint emitCount;
+    uint deadBase;
+};
+// Compacted to the alive particles, which is what the particles are sorted and drawn from.
+layout (std430, binding = 5) writeonly buffer DrawBuffer {
     vec4 Position[];
 };
 
 uniform float dt;
 uniform float time;
 uniform vec3 seed;
-uniform vec3 emitterPos;
 uniform vec3 spherePos;
 uniform float particleLifetime;
+uniform uint currentList;
+uniform uint poolSize;
 const vec2 eps = vec2(0.002, 0.0);
 const vec3 dx = eps.xyy;
 const vec3 dy = eps.yxy;
@@ -72,13 +88,17 @@ vec3 gradphi(vec3 p)
 
 void main()
 {
-    uint index = gl_GlobalInvocationID.x;
-    vec4 status = Position[index];
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= aliveCount[currentList])
+        return;
+
+    uint index = Alive[currentList * poolSize + id];
+    vec4 status = Particle[index];
     float lifetime = status.w;
     if (lifetime < 0.0)
     {
-        // Respawn particle (note that lifetime is stored in w-component)
-        Position[index] = SpawnInfo[index];
+        // The slot is free for the emitters again (note that lifetime is stored in w-component)
+        Dead[atomicAdd(deadCount, 1u)] = index;
     }
     else
     {
@@ -125,7 +145,13 @@ void main()
 
         // Euler integration
         p += v * dt;
-        Position[index] = vec4(p, status.w - dt);
+        vec4 particle = vec4(p, status.w - dt);
+        Particle[index] = particle;
+
+        uint nextList = 1u - currentList;
+        uint slot = atomicAdd(aliveCount[nextList], 1u);
+        Alive[nextList * poolSize + slot] = index;
+        Position[slot] = particle;
     }
 }
 
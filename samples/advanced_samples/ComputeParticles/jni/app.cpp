@@ -24,16 +24,68 @@
 #include "primitives.h"
 #include "noise.h"
 #include "sort.h"
+#include "WeightedBlendedOIT.h"
+#include "SampleParameters.h"
 #include <math.h>
+#include <stddef.h>
+#include <algorithm>
+
+using MaliSDK::GLStateCache;
+using MaliSDK::SampleParameters;
+using MaliSDK::WeightedBlendedOIT;
 const float TIMESTEP = 0.005f;
-const uint32 NUM_PARTICLES = NUM_KEYS;
+
+// The size of the particle pool, and of every buffer holding particles. The number_of_particles
+// parameter changes it, see SampleParameters.h, rounded down to a multiple of SORT_KEY_MULTIPLE.
+const uint32 DEFAULT_NUM_PARTICLES = 1 << 14;
+const uint32 MAX_NUM_PARTICLES = 1 << 18;
+uint32 num_particles = DEFAULT_NUM_PARTICLES;
+
+// Blend the particles with weighted blended order-independent transparency,
+// which needs no sorting at all. The smoke looks much the same, as its
+// particles are all of a similar colour.
+bool order_independent = false;
+WeightedBlendedOIT *oit = NULL;
+
+// Accumulate the particle shadows in compute shaders, into a smaller opacity map updated every
+// SHADOW_UPDATE_INTERVAL frames, instead of blending every particle into the full one each frame.
+// See shadow_accumulate.cs.
+bool binned_shadows = false;
+const int SHADOW_BIN_RESOLUTION = 128;
+const int SHADOW_TILE_SIZE = 16;
+const uint32 SHADOW_UPDATE_INTERVAL = 2;
+
+// Rasterize the particles whose sprites are under BINNED_PARTICLE_SIZE pixels across in compute
+// shaders, binned into screen tiles and blended in shared memory, see particle_accumulate.cs.
+// The larger ones are still drawn as point sprites, on top. Only used when the particles are
+// sorted, as it is order independent already. The sprites of this sample are 12 to 17 pixels
+// across, so this takes the far half of the cloud; it must stay below the tile size.
+bool binned_particles = false;
+const float BINNED_PARTICLE_SIZE = 14.5f;
+const int PARTICLE_TILE_SIZE = 16;
+
+// Simulate and sort the particles one frame ahead of drawing them, into a second draw buffer.
+// A frame draws what the previous frame's compute passes left, so its own passes have no
+// consumer until the next frame and can run alongside the draws instead of behind a barrier.
+// The particles are shown one step late. See swap_draw_buffers().
+bool pipelined_simulation = true;
 
 Shader
     shader_plane,
     shader_sphere,
     shader_update,
     shader_spawn,
+    shader_emit_args,
+    shader_clear_dead,
+    shader_shadow_bin,
+    shader_shadow_accumulate,
+    shader_particle_bin,
+    shader_particle_scan,
+    shader_particle_scatter,
+    shader_particle_accumulate,
+    shader_particle_composite,
     shader_draw_particle,
+    shader_draw_particle_oit,
     shader_shadow_map;
 
 Mesh
@@ -72,39 +124,142 @@ bool
 
 GLuint
     buffer_position,
-    buffer_spawn,
+    buffer_position_next,
+    buffer_draw_args,
+    buffer_draw_args_next,
+    buffer_particles,
+    buffer_alive,
+    buffer_dead,
+    buffer_counters,
+    buffer_indirect,
+    buffer_shadow_splats,
+    buffer_shadow_tile_counts,
+    buffer_shadow_tile_lists,
+    buffer_particle_splats,
+    buffer_particle_splat_slots,
+    buffer_particle_tile_counts,
+    buffer_particle_tile_starts,
+    buffer_particle_tile_lists,
     shadow_map_tex,
-    shadow_map_fbo;
+    shadow_map_binned_tex,
+    shadow_map_fbo,
+    particle_depth_tex,
+    particle_depth_fbo,
+    particle_binned_tex;
+
+uint32 frame_index;
 
 int
     window_width,
     window_height,
     shadow_map_width,
-    shadow_map_height;
+    shadow_map_height,
+    particle_tiles_x,
+    particle_tiles_y;
 
 Shader
     shader_count;
 
+/*
+ * The particles are emitted into a fixed pool shared by all emitters. A slot is on the dead
+ * list while it is free, and on one of two alive lists while its particle lives: spawn.cs
+ * appends to the current list, and update.cs simulates it and appends the survivors to the
+ * other list, compacted into buffer_position for sorting and drawing. All the dispatches are
+ * indirect, sized on the GPU by emit_args.cs, so the simulation costs as much as there are
+ * particles alive rather than num_particles.
+ */
+const uint32 MAX_EMITTERS = 4;
+
+// Particles are emitted at <rate> per simulated second, plus <burst> at a time every <interval> seconds.
+struct Emitter
+{
+    vec3 position;
+    float radius;
+    float rate;
+    uint32 burst;
+    float interval;
+
+    // Particles owed by the rate, emitted once there is a whole one.
+    float pending;
+    float next_burst;
+};
+
+Emitter emitters[MAX_EMITTERS];
+uint32 num_emitters;
+
+// The alive list spawn.cs appends to this frame, update.cs builds the other one.
+uint32 current_list;
+
+// Layout of buffer_counters and buffer_indirect, which must match the shaders.
+struct ParticleCounters
+{
+    GLuint alive_count[2];
+    GLuint dead_count;
+    GLuint emit_count;
+    GLuint dead_base;
+};
+
+struct ParticleIndirectArgs
+{
+    GLuint emit_groups[3];
+    GLuint simulate_groups[3];
+};
+
+// glDrawArraysIndirect arguments of buffer_draw_args, the count is copied from the alive count update.cs leaves.
+// Kept apart from buffer_indirect, so they can follow the draw buffer they belong to.
+struct ParticleDrawArgs
+{
+    GLuint count;
+    GLuint instance_count;
+    GLuint first;
+    GLuint reserved;
+};
+
 bool load_app()
 {
     string res = "/data/data/com.arm.malideveloper.openglessdk.computeparticles/files/";
     if (!shader_update.load_compute_from_file(res + "update.cs") ||
         !shader_spawn.load_compute_from_file(res + "spawn.cs") ||
+        !shader_emit_args.load_compute_from_file(res + "emit_args.cs") ||
+        !shader_clear_dead.load_compute_from_file(res + "clear_dead.cs") ||
+        !shader_shadow_bin.load_compute_from_file(res + "shadow_bin.cs") ||
+        !shader_shadow_accumulate.load_compute_from_file(res + "shadow_accumulate.cs") ||
+        !shader_particle_bin.load_compute_from_file(res + "particle_bin.cs") ||
+        !shader_particle_scan.load_compute_from_file(res + "particle_scan.cs") ||
+        !shader_particle_scatter.load_compute_from_file(res + "particle_scatter.cs") ||
+        !shader_particle_accumulate.load_compute_from_file(res + "particle_accumulate.cs") ||
+        !shader_particle_composite.load_from_file(res + "particle_composite.vs", res + "particle_composite.fs") ||
         !shader_plane.load_from_file(res + "plane.vs", res + "plane.fs") ||
         !shader_sphere.load_from_file(res + "sphere.vs", res + "sphere.fs") ||
         !shader_shadow_map.load_from_file(res + "shadowmap.vs", res + "shadowmap.fs") ||
-        !shader_draw_particle.load_from_file(res + "particle.vs", res + "particle.fs"))
+        !shader_draw_particle.load_from_file(res + "particle.vs", res + "particle.fs") ||
+        !shader_draw_particle_oit.load_from_file(res + "particle.vs", res + "particle_oit.fs"))
         return false;
 
     if (!shader_update.link() ||
         !shader_spawn.link() ||
+        !shader_emit_args.link() ||
+        !shader_clear_dead.link() ||
+        !shader_shadow_bin.link() ||
+        !shader_shadow_accumulate.link() ||
+        !shader_particle_bin.link() ||
+        !shader_particle_scan.link() ||
+        !shader_particle_scatter.link() ||
+        !shader_particle_accumulate.link() ||
+        !shader_particle_composite.link() ||
         !shader_plane.link() ||
         !shader_sphere.link() ||
         !shader_shadow_map.link() ||
-        !shader_draw_particle.link())
+        !shader_draw_particle.link() ||
+        !shader_draw_particle_oit.link())
         return false;
 
-    if (!sort_init())
+    SampleParameters::load("/data/data/com.arm.malideveloper.openglessdk.computeparticles/");
+    num_particles = SampleParameters::getInt("number_of_particles", DEFAULT_NUM_PARTICLES,
+                                             SORT_KEY_MULTIPLE, MAX_NUM_PARTICLES);
+    num_particles -= num_particles % SORT_KEY_MULTIPLE;
+
+    if (!sort_init(num_particles))
         return false;
 
     return true;
@@ -116,32 +271,64 @@ void free_app()
     shader_sphere.dispose();
     shader_update.dispose();
     shader_spawn.dispose();
+    shader_emit_args.dispose();
+    shader_clear_dead.dispose();
+    shader_shadow_bin.dispose();
+    shader_shadow_accumulate.dispose();
+    shader_particle_bin.dispose();
+    shader_particle_scan.dispose();
+    shader_particle_scatter.dispose();
+    shader_particle_accumulate.dispose();
+    shader_particle_composite.dispose();
     shader_shadow_map.dispose();
     shader_draw_particle.dispose();
+    shader_draw_particle_oit.dispose();
 
     del_buffer(buffer_position);
-    del_buffer(buffer_spawn);
+    del_buffer(buffer_position_next);
+    del_buffer(buffer_draw_args);
+    del_buffer(buffer_draw_args_next);
+    del_buffer(buffer_particles);
+    del_buffer(buffer_alive);
+    del_buffer(buffer_dead);
+    del_buffer(buffer_counters);
+    del_buffer(buffer_indirect);
+    del_buffer(buffer_shadow_splats);
+    del_buffer(buffer_shadow_tile_counts);
+    del_buffer(buffer_shadow_tile_lists);
+    del_buffer(buffer_particle_splats);
+    del_buffer(buffer_particle_splat_slots);
+    del_buffer(buffer_particle_tile_counts);
+    del_buffer(buffer_particle_tile_starts);
+    del_buffer(buffer_particle_tile_lists);
 
     quad.dispose();
     plane.dispose();
     sphere.dispose();
 
-    glDeleteTextures(1, &shadow_map_tex);
+    GLStateCache::deleteTextures(1, &shadow_map_tex);
+    GLStateCache::deleteTextures(1, &shadow_map_binned_tex);
     glDeleteFramebuffers(1, &shadow_map_fbo);
+    GLStateCache::deleteTextures(1, &particle_depth_tex);
+    GLStateCache::deleteTextures(1, &particle_binned_tex);
+    glDeleteFramebuffers(1, &particle_depth_fbo);
 
     sort_free();
+
+    delete oit;
+    oit = NULL;
 }
 
 void init_shadowmap(int width, int height)
 {
     glGenTextures(1, &shadow_map_tex);
-    glBindTexture(GL_TEXTURE_2D, shadow_map_tex);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, shadow_map_tex);
     glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
     glGenFramebuffers(1, &shadow_map_fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, shadow_map_fbo);
@@ -152,25 +339,121 @@ void init_shadowmap(int width, int height)
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void init_binned_shadowmap()
+{
+    // Written with imageStore, sampled like the full map
+    glGenTextures(1, &shadow_map_binned_tex);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, shadow_map_binned_tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, SHADOW_BIN_RESOLUTION, SHADOW_BIN_RESOLUTION);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+    // A tile can be touched by every particle, shadow_accumulate.cs empties the lists after use
+    const uint32 num_tiles = (SHADOW_BIN_RESOLUTION / SHADOW_TILE_SIZE) * (SHADOW_BIN_RESOLUTION / SHADOW_TILE_SIZE);
+    std::vector<GLuint> counts(num_tiles, 0);
+    buffer_shadow_splats = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_particles * sizeof(vec4), NULL);
+    buffer_shadow_tile_counts = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_tiles * sizeof(GLuint), &counts[0]);
+    buffer_shadow_tile_lists = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_tiles * num_particles * sizeof(GLuint), NULL);
+}
+
+void init_binned_particles(int width, int height)
+{
+    // The scene depth the small particles are tested against, drawn again into a texture
+    glGenTextures(1, &particle_depth_tex);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, particle_depth_tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Written with imageStore, one texel per pixel
+    glGenTextures(1, &particle_binned_tex);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, particle_binned_tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &particle_depth_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, particle_depth_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, particle_depth_tex, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    ASSERT(status == GL_FRAMEBUFFER_COMPLETE, "Framebuffer not complete\n");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // A sprite is smaller than a tile, so it is in the lists of 2x2 tiles at most.
+    // particle_accumulate.cs clears the counts after use
+    particle_tiles_x = (width + PARTICLE_TILE_SIZE - 1) / PARTICLE_TILE_SIZE;
+    particle_tiles_y = (height + PARTICLE_TILE_SIZE - 1) / PARTICLE_TILE_SIZE;
+    const uint32 num_tiles = particle_tiles_x * particle_tiles_y;
+    std::vector<GLuint> counts(num_tiles, 0);
+    buffer_particle_splats = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_particles * 2 * sizeof(vec4), NULL);
+    buffer_particle_splat_slots = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_particles * 4 * sizeof(GLuint), NULL);
+    buffer_particle_tile_counts = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_tiles * sizeof(GLuint), &counts[0]);
+    buffer_particle_tile_starts = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_tiles * sizeof(GLuint), NULL);
+    buffer_particle_tile_lists = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_particles * 4 * sizeof(GLuint), NULL);
+}
+
 void init_particles()
 {
-    // Store particle position (x, y, z) and lifetime (w)
-    vec4 *data = new vec4[NUM_PARTICLES];
-    for (int i = 0; i < NUM_PARTICLES; ++i)
+    // Store particle position (x, y, z) and lifetime (w), the pool starts out empty
+    buffer_particles = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_particles * sizeof(vec4), NULL);
+    buffer_alive = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, 2 * num_particles * sizeof(GLuint), NULL);
+
+    // Nothing is drawn until the first particles are emitted
+    vec4 *positions = new vec4[num_particles];
+    for (uint32 i = 0; i < num_particles; ++i)
+        positions[i] = vec4(0.0f, 0.0f, 0.0f, -1.0f);
+    buffer_position = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_particles * sizeof(vec4), positions);
+    buffer_position_next = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_particles * sizeof(vec4), positions);
+    delete[] positions;
+
+    // Every slot is free
+    GLuint *dead = new GLuint[num_particles];
+    for (uint32 i = 0; i < num_particles; ++i)
+        dead[i] = num_particles - 1 - i;
+    buffer_dead = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_particles * sizeof(GLuint), dead);
+    delete[] dead;
+
+    ParticleCounters counters = { { 0, 0 }, num_particles, 0, 0 };
+    buffer_counters = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, sizeof(counters), &counters);
+
+    ParticleIndirectArgs args = { { 0, 1, 1 }, { 0, 1, 1 } };
+    buffer_indirect = gen_buffer(GL_DISPATCH_INDIRECT_BUFFER, GL_DYNAMIC_COPY, sizeof(args), &args);
+
+    ParticleDrawArgs draw_args = { 0, 1, 0, 0 };
+    buffer_draw_args = gen_buffer(GL_DRAW_INDIRECT_BUFFER, GL_DYNAMIC_COPY, sizeof(draw_args), &draw_args);
+    buffer_draw_args_next = gen_buffer(GL_DRAW_INDIRECT_BUFFER, GL_DYNAMIC_COPY, sizeof(draw_args), &draw_args);
+
+    current_list = 0;
+}
+
+void init_emitters()
+{
+    // Follows emitter_pos, and keeps about three quarters of the pool alive on its own
+    Emitter &smoke = emitters[0];
+    smoke.radius = 0.1f;
+    smoke.rate = 0.75f * num_particles / (1.125f * particle_lifetime);
+    smoke.burst = 0;
+    smoke.interval = 0.0f;
+
+    // Puffs out of the sphere every couple of seconds into the rest of the pool
+    Emitter &puff = emitters[1];
+    puff.radius = 0.12f;
+    puff.rate = 0.0f;
+    puff.burst = num_particles / 5;
+    puff.interval = 2.0f;
+
+    num_emitters = 2;
+    for (uint32 i = 0; i < num_emitters; ++i)
     {
-        // Distribute initial position inside a sphere of radius 0.3
-        vec3 p = vec3(0.0f, 0.0f, 0.0f);
-        p.x = 0.3f * (-1.0f + 2.0f * frand());
-        p.y = 0.3f * (-1.0f + 2.0f * frand());
-        p.z = 0.3f * (-1.0f + 2.0f * frand());
-
-        // Each particle has a slightly randomized lifetime, around a constant value
-        float lifetime = (1.0 + 0.25 * frand()) * particle_lifetime;
-        data[i] = vec4(p, lifetime);
+        emitters[i].position = vec3(0.0f, 0.0f, 0.0f);
+        emitters[i].pending = 0.0f;
+        emitters[i].next_burst = emitters[i].interval;
     }
-    buffer_position = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_DRAW, NUM_PARTICLES * sizeof(vec4), data);
-    buffer_spawn = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_DRAW, NUM_PARTICLES * sizeof(vec4), NULL);
-    delete[] data;
 }
 
 void init_app(int width, int height)
@@ -204,7 +487,21 @@ void init_app(int width, int height)
     shadow_map_height = 512;
 
     init_particles();
+    init_emitters();
     init_shadowmap(shadow_map_width, shadow_map_height);
+    init_binned_shadowmap();
+    init_binned_particles(width, height);
+    frame_index = 0;
+
+    delete oit;
+    oit = NULL;
+    if (order_independent)
+    {
+        if (WeightedBlendedOIT::isSupported())
+            oit = new WeightedBlendedOIT(width, height);
+        else
+            LOGD("Half float render targets are not supported, sorting the particles instead");
+    }
 }
 
 /*
@@ -214,46 +511,155 @@ void init_app(int width, int height)
  * from a valid range (here -2 to 2) to [0, 65535].
 */
 int pass = 0;
+
+// incremental_sort() is not used: the particles are compacted into buffer_position_next again every
+// frame in the order update.cs hands out slots, so there is no previous order left to refine.
 void sort_particles()
 {
     // Calculate vector towards eye (in world space)
     vec4 v = vec4(0.0, 0.0, 0.0, 1.0);
     v = inverse(mat_view) * v;
     vec3 view_axis = normalize(v.xyz());
-    radix_sort(buffer_position, view_axis, -2.0f, 2.0f);
+    radix_sort(buffer_position_next, view_axis, -2.0f, 2.0f,
+               pipelined_simulation ? 0 : GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
 }
 
 /*
- * Simulates the particles according to a turbulent curl-noise fluid field,
+ * The simulation writes buffer_position_next and buffer_draw_args_next, which are drawn from
+ * once they are swapped with buffer_position and buffer_draw_args. Without pipelining that
+ * happens right after the simulation, behind its barriers. Otherwise it happens before the
+ * next frame's simulation, with the barrier the passes left out, so it waits for the previous
+ * frame's compute work only and this frame's passes overlap the draws of what it finished.
+ * The buffer the simulation writes into was last read by the draws of the frame before, so
+ * it needs no barrier.
+ */
+void swap_draw_buffers()
+{
+    if (pipelined_simulation)
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    std::swap(buffer_position, buffer_position_next);
+    std::swap(buffer_draw_args, buffer_draw_args_next);
+}
+
+/*
+ * Emits the particles the emitters have asked for since the last frame, and simulates
+ * the particles according to a turbulent curl-noise fluid field,
  * superposed with a repulsion field around the sphere.
- * Particles run out of life after a while and respawn, using the information
- * stored in the spawn buffer.
+ * Particles run out of life after a while, and their slots go back to the dead list
+ * for any emitter to use.
 */
 void update_particles()
 {
     const uint32 WORK_GROUP_SIZE = 64;
 
-    // Generate respawn info
+    // The draws and shadows wait for the particles only when they are the ones drawn this frame
+    GLbitfield draw_barrier = pipelined_simulation ? 0 : GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+
+    // Each emitter gets a range of this frame's particles, spawn.cs finds its emitter from the ends
+    float time = get_elapsed_time();
+    vec4 emitter_positions[MAX_EMITTERS];
+    GLuint emitter_ends[MAX_EMITTERS];
+    uint32 requested = 0;
+    for (uint32 i = 0; i < MAX_EMITTERS; ++i)
+    {
+        if (i < num_emitters)
+        {
+            Emitter &emitter = emitters[i];
+            emitter.pending += emitter.rate * TIMESTEP;
+            uint32 count = uint32(emitter.pending);
+            emitter.pending -= count;
+            if (emitter.burst > 0 && time >= emitter.next_burst)
+            {
+                count += emitter.burst;
+                emitter.next_burst = time + emitter.interval;
+            }
+            requested += count;
+            emitter_positions[i] = vec4(emitter.position, emitter.radius);
+        }
+        else
+            emitter_positions[i] = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+        emitter_ends[i] = requested;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer_particles);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffer_alive);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buffer_dead);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, buffer_counters);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffer_indirect);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, buffer_position_next);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, buffer_indirect);
+
+    // Take the free slots off the dead list, and size both passes
+    use_shader(shader_emit_args);
+    uniform("requestedCount", requested);
+    uniform("currentList", current_list);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+    // Generate the new particles, onto the current alive list
     use_shader(shader_spawn);
-    uniform("time", get_elapsed_time());
-    uniform("emitterPos", emitter_pos);
+    GLint loc_emitter_pos = shader_spawn.get_uniform_location("emitterPos");
+    GLint loc_emitter_end = shader_spawn.get_uniform_location("emitterEnd");
+    for (uint32 i = 0; i < MAX_EMITTERS; ++i)
+    {
+        uniform(loc_emitter_pos + GLint(i), emitter_positions[i]);
+        uniform(loc_emitter_end + GLint(i), emitter_ends[i]);
+    }
+    uniform("time", time);
     uniform("particleLifetime", particle_lifetime);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer_spawn);
-    glDispatchCompute(NUM_PARTICLES / WORK_GROUP_SIZE, 1, 1);
+    uniform("currentList", current_list);
+    uniform("poolSize", num_particles);
+    glDispatchComputeIndirect(offsetof(ParticleIndirectArgs, emit_groups));
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
     // Advect through velocity field
     use_shader(shader_update);
     uniform("dt", TIMESTEP);
-    uniform("time", get_elapsed_time());
+    uniform("time", time);
     uniform("seed", vec3(13.0f, 127.0f, 449.0f));
     uniform("spherePos", sphere_pos);
     uniform("particleLifetime", particle_lifetime);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffer_position);
-    glDispatchCompute(NUM_PARTICLES / WORK_GROUP_SIZE, 1, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+    uniform("currentList", current_list);
+    uniform("poolSize", num_particles);
+    glDispatchComputeIndirect(offsetof(ParticleIndirectArgs, simulate_groups));
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT | draw_barrier);
+    current_list = 1 - current_list;
+
+    // The draw stops at the particles update.cs has just compacted
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer_counters);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_draw_args_next);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                        offsetof(ParticleCounters, alive_count) + current_list * sizeof(GLuint),
+                        offsetof(ParticleDrawArgs, count), sizeof(GLuint));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // Except when sorting or binning shadows, which go through the whole draw buffer, see clear_dead.cs
+    if (!oit || binned_shadows)
+    {
+        use_shader(shader_clear_dead);
+        uniform("currentList", current_list);
+        glDispatchCompute(num_particles / WORK_GROUP_SIZE, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | draw_barrier);
+    }
+
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+    for (GLuint i = 0; i <= 5; ++i)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+}
+
+// Sorted particles can be anywhere in the draw buffer, with the dead slots culled by the
+// vertex shaders. Otherwise only the alive particles at the start of it are drawn.
+void draw_particle_points()
+{
+    if (oit)
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer_draw_args);
+        glDrawArraysIndirect(GL_POINTS, (const void *)offsetof(ParticleDrawArgs, count));
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    else
+        glDrawArrays(GL_POINTS, 0, num_particles);
 }
 
 void update_shadow_map()
@@ -271,15 +677,53 @@ void update_shadow_map()
     use_shader(shader_shadow_map);
     uniform("projection", mat_projection_light);
     uniform("view", mat_view_light);
-    glBindBuffer(GL_ARRAY_BUFFER, buffer_position);
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, buffer_position);
     attribfv("position", 4, 0, 0);
-    glDrawArrays(GL_POINTS, 0, NUM_PARTICLES);
+    draw_particle_points();
 
     blend_mode(false);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glViewport(0, 0, window_width, window_height);
 }
 
+void update_binned_shadow_map()
+{
+    const uint32 WORK_GROUP_SIZE = 64;
+    const GLuint tiles_per_side = SHADOW_BIN_RESOLUTION / SHADOW_TILE_SIZE;
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer_position);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffer_shadow_splats);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buffer_shadow_tile_counts);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, buffer_shadow_tile_lists);
+
+    // Bin the particles into the tiles their splats touch
+    use_shader(shader_shadow_bin);
+    uniform("projection", mat_projection_light);
+    uniform("view", mat_view_light);
+    uniform("resolution", SHADOW_BIN_RESOLUTION);
+    uniform("spriteScale", float(SHADOW_BIN_RESOLUTION) / shadow_map_width);
+    uniform("poolSize", num_particles);
+    glDispatchCompute(num_particles / WORK_GROUP_SIZE, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Add up and write out one tile per work group
+    use_shader(shader_shadow_accumulate);
+    uniform("poolSize", num_particles);
+    glBindImageTexture(0, shadow_map_binned_tex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    glDispatchCompute(tiles_per_side, tiles_per_side, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+    for (GLuint i = 0; i <= 3; ++i)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+}
+
+// The shadow map the scene is lit with.
+GLuint get_shadow_map()
+{
+    return binned_shadows ? shadow_map_binned_tex : shadow_map_tex;
+}
+
 void update_app(float dt)
 {
     float t = get_elapsed_time() * 0.7f;
@@ -298,16 +742,29 @@ void update_app(float dt)
 
     sphere_pos += (sphere_pos_target - sphere_pos) * 3.5f * dt;
 
-    update_particles();
-    sort_particles();
+    emitters[0].position = emitter_pos;
+    emitters[1].position = sphere_pos;
 
-    update_shadow_map();
+    // Draw what the previous frame simulated, while this frame's passes run
+    if (pipelined_simulation)
+        swap_draw_buffers();
+    update_particles();
+    if (!oit)
+        sort_particles();
+    if (!pipelined_simulation)
+        swap_draw_buffers();
+
+    if (!binned_shadows)
+        update_shadow_map();
+    else if (frame_index % SHADOW_UPDATE_INTERVAL == 0)
+        update_binned_shadow_map();
+    frame_index++;
 }
 
 void render_geometry()
 {
     // Sphere
-    glBindTexture(GL_TEXTURE_2D, shadow_map_tex);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, get_shadow_map());
     cull(true, GL_CW, GL_BACK);
     use_shader(shader_sphere);
     uniform("projection", mat_projection);
@@ -318,7 +775,7 @@ void render_geometry()
     uniform("model", translate(sphere_pos) * scale(0.1f));
     uniform("color", vec3(0.20f, 0.34f, 0.09f));
     sphere.bind();
-    attribfv("position", 3, 0, 0);
+    attrib("position", sphere.layout, sphere.position);
     glDrawElements(GL_TRIANGLES, sphere.num_indices, GL_UNSIGNED_INT, 0);
 
     // Floor
@@ -330,16 +787,21 @@ void render_geometry()
     uniform("model", translate(0.0f, -1.0f, 0.0f) * scale(8.0f));
     uniform("color", vec3(0.20f, 0.05f, 0.022f));
     plane.bind();
-    attribfv("position", 3, 6, 0);
+    attrib("position", plane.layout, plane.position);
     glDrawElements(GL_TRIANGLES, plane.num_indices, GL_UNSIGNED_INT, 0);
 }
 
 void render_particles()
 {
-    // Alphablending with premultiplied alpha
-    blend_mode(true, GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_FUNC_ADD);
-
-    use_shader(shader_draw_particle);
+    // Alphablending with premultiplied alpha, unless the blend state
+    // of the order-independent accumulation is set
+    if (oit)
+        use_shader(shader_draw_particle_oit);
+    else
+    {
+        blend_mode(true, GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_FUNC_ADD);
+        use_shader(shader_draw_particle);
+    }
     uniform("projection", mat_projection);
     uniform("view", mat_view);
     uniform("particleLifetime", particle_lifetime);
@@ -347,20 +809,105 @@ void render_particles()
     uniform("smokeColor", smoke_color);
     uniform("smokeShadow", smoke_shadow);
     uniform("shadowMap0", 0);
-    glBindTexture(GL_TEXTURE_2D, shadow_map_tex);
-    glBindBuffer(GL_ARRAY_BUFFER, buffer_position);
+    uniform("binnedSize", binned_particles && !oit ? BINNED_PARTICLE_SIZE : 0.0f);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, get_shadow_map());
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, buffer_position);
     attribfv("position", 4, 0, 0);
-    glDrawArrays(GL_POINTS, 0, NUM_PARTICLES);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    draw_particle_points();
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+}
+
+/*
+ * Bins the particles smaller than BINNED_PARTICLE_SIZE into screen tiles and blends each
+ * tile in shared memory, into particle_binned_tex. The particles are tested against the depth
+ * of the scene, which the geometry is drawn into first.
+ */
+void rasterize_binned_particles()
+{
+    const uint32 WORK_GROUP_SIZE = 64;
+    const GLuint num_tiles = particle_tiles_x * particle_tiles_y;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, particle_depth_fbo);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    render_geometry();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer_position);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffer_particle_splats);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buffer_particle_tile_counts);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, buffer_particle_splat_slots);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffer_particle_tile_starts);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, buffer_particle_tile_lists);
+
+    // Project, light and count the particles into their tiles
+    use_shader(shader_particle_bin);
+    uniform("projection", mat_projection);
+    uniform("view", mat_view);
+    uniform("projectionViewLight", mat_projection_light * mat_view_light);
+    uniform("smokeColor", smoke_color);
+    uniform("smokeShadow", smoke_shadow);
+    uniform("particleLifetime", particle_lifetime);
+    uniform("maxSize", BINNED_PARTICLE_SIZE);
+    glUniform2i(shader_particle_bin.get_uniform_location("resolution"), window_width, window_height);
+    glUniform2i(shader_particle_bin.get_uniform_location("tiles"), particle_tiles_x, particle_tiles_y);
+    uniform("shadowMap0", 0);
+    uniform("sceneDepth", 1);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, get_shadow_map());
+    GLStateCache::activeTexture(GL_TEXTURE1);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, particle_depth_tex);
+    glDispatchCompute(num_particles / WORK_GROUP_SIZE, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+    // Lay the tile lists out one after the other
+    use_shader(shader_particle_scan);
+    uniform("numTiles", num_tiles);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Fill them in
+    use_shader(shader_particle_scatter);
+    glUniform2i(shader_particle_scatter.get_uniform_location("tiles"), particle_tiles_x, particle_tiles_y);
+    glDispatchCompute(num_particles / WORK_GROUP_SIZE, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Blend and write out one tile per work group
+    use_shader(shader_particle_accumulate);
+    glBindImageTexture(0, particle_binned_tex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDispatchCompute(particle_tiles_x, particle_tiles_y, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    for (GLuint i = 0; i <= 5; ++i)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+}
+
+// Blends the binned particles over the scene, behind the point sprites drawn after them.
+void composite_binned_particles()
+{
+    depth_test(false);
+    blend_mode(true, GL_ONE, GL_SRC_ALPHA, GL_FUNC_ADD);
+    use_shader(shader_particle_composite);
+    uniform("smallParticles", 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, particle_binned_tex);
+    quad.bind();
+    attrib("position", quad.layout, quad.position);
+    glDrawElements(GL_TRIANGLES, quad.num_indices, GL_UNSIGNED_INT, 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+    blend_mode(false);
+    depth_test(true, GL_LEQUAL);
 }
 
 void render_app(float dt)
 {
-    glEnable(GL_DEPTH_TEST);
-    glDepthMask(GL_TRUE);
-    glDepthRangef(0.0f, 1.0f);
-    glDepthFunc(GL_LEQUAL);
+    depth_test(true, GL_LEQUAL);
+    depth_write(true);
+    if (binned_particles && !oit)
+        rasterize_binned_particles();
+
     glClearDepthf(1.0f);
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -369,8 +916,25 @@ void render_app(float dt)
 
     // The particles are rendered without depth writes, but with depth testing
     // If they write to the depth buffer you'll likely get some artifacts here and there.
-    glDepthMask(GL_FALSE);
-    render_particles();
+    depth_write(false);
+    if (oit)
+    {
+        // The particles are accumulated offscreen, depth tested against
+        // the geometry drawn again without colour, and composited on top
+        oit->beginOccluders();
+        depth_write(true);
+        render_geometry();
+        oit->beginAccumulation();
+        render_particles();
+        oit->resolve(0, window_width, window_height);
+        blend_mode(false);
+    }
+    else
+    {
+        if (binned_particles)
+            composite_binned_particles();
+        render_particles();
+    }
 }
 
 void on_pointer_down(float x, float y)
@@ -25,6 +25,9 @@
 #include <cstdio>
 #include <cstdlib>
 #include <GLES3/gl31.h>
+#include "GLCallCounters.h"
+#include "GLCapture.h"
+#include "GLStateCache.h"
 
 #include <string>
 #include <vector>
@@ -19,22 +19,26 @@
  */
 
 #include "glutil.h"
+#include "GPUMemory.h"
 #include <fstream>
 #include <iostream>
 
-Shader current;
+using MaliSDK::GLStateCache;
+using MaliSDK::GPUMemory;
+
+Shader *current = NULL;
 
 void cull(bool enabled, GLenum front, GLenum mode)
 {
     if (enabled)
     {
-        glEnable(GL_CULL_FACE);
-        glFrontFace(front);
-        glCullFace(mode);
+        GLStateCache::setEnabled(GL_CULL_FACE, true);
+        GLStateCache::frontFace(front);
+        GLStateCache::cullFace(mode);
     }
     else
     {
-        glDisable(GL_CULL_FACE);
+        GLStateCache::setEnabled(GL_CULL_FACE, false);
     }
 }
 
@@ -42,12 +46,12 @@ void depth_test(bool enabled, GLenum func)
 {
     if (enabled)
     {
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(func);
+        GLStateCache::setEnabled(GL_DEPTH_TEST, true);
+        GLStateCache::depthFunc(func);
     }
     else
     {
-        glDisable(GL_DEPTH_TEST);
+        GLStateCache::setEnabled(GL_DEPTH_TEST, false);
     }
 }
 
@@ -55,12 +59,12 @@ void depth_write(bool enabled)
 {
     if (enabled)
     {
-        glDepthMask(GL_TRUE);
+        GLStateCache::depthMask(GL_TRUE);
         glDepthRangef(0.0f, 1.0f);
     }
     else
     {
-        glDepthMask(GL_FALSE);
+        GLStateCache::depthMask(GL_FALSE);
     }
 }
 
@@ -68,40 +72,54 @@ void blend_mode(bool enabled, GLenum src, GLenum dest, GLenum func)
 {
     if (enabled)
     {
-        glEnable(GL_BLEND);
-        glBlendFunc(src, dest);
-        glBlendEquation(func);
+        GLStateCache::setEnabled(GL_BLEND, true);
+        GLStateCache::blendFunc(src, dest);
+        GLStateCache::blendEquation(func);
     }
     else
     {
-        glDisable(GL_BLEND);
+        GLStateCache::setEnabled(GL_BLEND, false);
     }
 }
 
-void use_shader(Shader shader)
+void use_shader(Shader &shader)
 {
-    current = shader;
-    current.use();
+    current = &shader;
+    current->use();
 }
 
-void attribfv(string name, GLsizei num_components, GLsizei stride, GLsizei offset)
+void attribfv(const string &name, GLsizei num_components, GLsizei stride, GLsizei offset)
 { 
-    current.set_attribfv(name, num_components, stride, offset); 
+    current->set_attribfv(name, num_components, stride, offset); 
+}
+
+void attrib(const string &name, const MaliSDK::VertexLayout &layout, int attribute)
+{
+    layout.enable(attribute, current->get_attribute_location(name));
 }
 
-void unset_attrib(string name)
+void unset_attrib(const string &name)
 {
-    current.unset_attrib(name);
+    current->unset_attrib(name);
 }
 
-void uniform(string name, const mat4 &v) { current.set_uniform(name, v); }
-void uniform(string name, const vec4 &v) { current.set_uniform(name, v); }
-void uniform(string name, const vec3 &v) { current.set_uniform(name, v); }
-void uniform(string name, const vec2 &v) { current.set_uniform(name, v); }
-void uniform(string name, double v) { current.set_uniform(name, v); }
-void uniform(string name, float v) { current.set_uniform(name, v); }
-void uniform(string name, int v) { current.set_uniform(name, v); }
-void uniform(string name, unsigned int v) { current.set_uniform(name, v); }
+void uniform(const string &name, const mat4 &v) { current->set_uniform(name, v); }
+void uniform(const string &name, const vec4 &v) { current->set_uniform(name, v); }
+void uniform(const string &name, const vec3 &v) { current->set_uniform(name, v); }
+void uniform(const string &name, const vec2 &v) { current->set_uniform(name, v); }
+void uniform(const string &name, double v) { current->set_uniform(name, v); }
+void uniform(const string &name, float v) { current->set_uniform(name, v); }
+void uniform(const string &name, int v) { current->set_uniform(name, v); }
+void uniform(const string &name, unsigned int v) { current->set_uniform(name, v); }
+
+void uniform(GLint location, const mat4 &v) { current->set_uniform(location, v); }
+void uniform(GLint location, const vec4 &v) { current->set_uniform(location, v); }
+void uniform(GLint location, const vec3 &v) { current->set_uniform(location, v); }
+void uniform(GLint location, const vec2 &v) { current->set_uniform(location, v); }
+void uniform(GLint location, double v) { current->set_uniform(location, v); }
+void uniform(GLint location, float v) { current->set_uniform(location, v); }
+void uniform(GLint location, int v) { current->set_uniform(location, v); }
+void uniform(GLint location, unsigned int v) { current->set_uniform(location, v); }
 
 bool read_file(const std::string &path, std::string &dest)
 {
@@ -123,9 +141,10 @@ GLuint gen_buffer(GLenum target, GLenum usage, GLsizei size, const void *data)
 {
     GLuint buffer;
     glGenBuffers(1, &buffer);
-    glBindBuffer(target, buffer);
+    GLStateCache::bindBuffer(target, buffer);
     glBufferData(target, size, data, usage);
-    glBindBuffer(target, 0);
+    GLStateCache::bindBuffer(target, 0);
+    GPUMemory::trackBuffer(buffer, size, usage, "glutil");
     return buffer;
 }
 
@@ -136,5 +155,5 @@ GLuint gen_buffer(GLenum target, GLsizei size, const void *data)
 
 void del_buffer(GLuint buffer)
 {
-    glDeleteBuffers(1, &buffer);
+    GLStateCache::deleteBuffers(1, &buffer);
 }
\ No newline at end of file
@@ -23,6 +23,7 @@
 #include "matrix.h"
 #include "common.h"
 #include "shader.h"
+#include "VertexLayout.h"
 #include <string>
 #include <sstream>
 
@@ -49,18 +50,30 @@ values that are already in the frame buffer (the destination values).
 */
 void blend_mode(bool enabled, GLenum src = GL_ONE, GLenum dest = GL_ONE, GLenum func = GL_FUNC_ADD);
 
-void use_shader(Shader shader);
-void attribfv(string name, GLsizei num_components, GLsizei stride, GLsizei offset);
-void unset_attrib(string name);
+// The shader is referenced, not copied, so it must outlive its use.
+void use_shader(Shader &shader);
+void attribfv(const string &name, GLsizei num_components, GLsizei stride, GLsizei offset);
+// Points an attribute of the current shader at one of an interleaved, quantized layout in the bound buffer.
+void attrib(const string &name, const MaliSDK::VertexLayout &layout, int attribute);
+void unset_attrib(const string &name);
 
-void uniform(string name, const mat4 &v);
-void uniform(string name, const vec4 &v);
-void uniform(string name, const vec3 &v);
-void uniform(string name, const vec2 &v);
-void uniform(string name, double v);
-void uniform(string name, float v);
-void uniform(string name, int v);
-void uniform(string name, unsigned int v);
+void uniform(const string &name, const mat4 &v);
+void uniform(const string &name, const vec4 &v);
+void uniform(const string &name, const vec3 &v);
+void uniform(const string &name, const vec2 &v);
+void uniform(const string &name, double v);
+void uniform(const string &name, float v);
+void uniform(const string &name, int v);
+void uniform(const string &name, unsigned int v);
+
+void uniform(GLint location, const mat4 &v);
+void uniform(GLint location, const vec4 &v);
+void uniform(GLint location, const vec3 &v);
+void uniform(GLint location, const vec2 &v);
+void uniform(GLint location, double v);
+void uniform(GLint location, float v);
+void uniform(GLint location, int v);
+void uniform(GLint location, unsigned int v);
 
 bool read_file(const std::string &path, std::string &dest);
 GLuint gen_buffer(GLenum target, GLsizei size, const void *data);
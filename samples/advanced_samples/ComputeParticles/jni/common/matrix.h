@@ -151,6 +151,11 @@ struct mat4
     float *value_ptr() { return &(x[0]); }
 };
 
+static float dot(const vec3 &a, const vec3 &b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
 static vec3 normalize(const vec3 &v)
 {
     return v / sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
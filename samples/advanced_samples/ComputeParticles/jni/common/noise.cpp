@@ -19,7 +19,7 @@
  */
 
 #include "noise.h"
-#include <random>
+#include "Random.h"
 
 float clamp(float x, float min, float max)
 {
@@ -36,21 +36,20 @@ float min(float x, float y)
 	return x < y ? x : y;
 }
 
-// See http://en.wikipedia.org/wiki/Xorshift
+// See http://en.wikipedia.org/wiki/Xorshift, four generators side by side so batches are vectorized
+static MaliSDK::Random generator(123456789);
+
 unsigned int xor128()
 {
-	static unsigned int x = 123456789;
-	static unsigned int y = 362436069;
-	static unsigned int z = 521288629;
-	static unsigned int w = 88675123;
-	unsigned int t;
-
-	t = x ^ (x << 11);
-	x = y; y = z; z = w;
-	return w = w ^ (w >> 19) ^ (t ^ (t >>8));
+	return generator.next();
 }
 
 float frand()
 {
-	return xor128() / float(4294967295.0f);
-}
\ No newline at end of file
+	return generator.nextFloat();
+}
+
+void frand(float *values, size_t count, float min, float max)
+{
+	generator.fill(values, count, min, max);
+}
@@ -21,6 +21,8 @@
 #ifndef NOISE_H
 #define NOISE_H
 
+#include <cstddef>
+
 float clamp(float x, float min, float max);
 float max(float x, float y);
 float min(float x, float y);
@@ -28,7 +30,10 @@ float min(float x, float y);
 // Returns a random integer with a period of 2^128 - 1
 unsigned int xor128();
 
-// Returns a single precision floating-point value uniformly over the interval [0.0, 1.0]
+// Returns a single precision floating-point value uniformly over the interval [0.0, 1.0)
 float frand();
 
+// Fills values with count values uniformly over the interval [min, max), several times faster than calling frand()
+void frand(float *values, size_t count, float min = 0.0f, float max = 1.0f);
+
 #endif
\ No newline at end of file
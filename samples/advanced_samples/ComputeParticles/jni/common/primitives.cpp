@@ -19,27 +19,55 @@
  */
 
 #include "primitives.h"
+#include <vector>
+
+using MaliSDK::VertexLayout;
+
+// Positions as half floats, normals in 2_10_10_10 and texture coordinates as normalized shorts.
+static Mesh gen_mesh(const float *positions, const float *normals, const float *texcoords, int num_vertices,
+                     const uint32 *indices, int num_indices)
+{
+    Mesh mesh;
+    mesh.position = mesh.layout.add(4, VertexLayout::HalfFloat);
+    mesh.normal = normals ? mesh.layout.add(4, VertexLayout::Int2101010Rev) : -1;
+    mesh.texcoord = texcoords ? mesh.layout.add(2, VertexLayout::UnsignedShort) : -1;
+
+    std::vector<unsigned char> vertices(mesh.layout.getStride() * num_vertices);
+    mesh.layout.pack(mesh.position, positions, 3, num_vertices, &vertices[0]);
+    if (normals)
+        mesh.layout.pack(mesh.normal, normals, 3, num_vertices, &vertices[0]);
+    if (texcoords)
+        mesh.layout.pack(mesh.texcoord, texcoords, 2, num_vertices, &vertices[0]);
+
+    mesh.vertex_buffer = gen_buffer(GL_ARRAY_BUFFER, vertices.size(), &vertices[0]);
+    mesh.index_buffer = gen_buffer(GL_ELEMENT_ARRAY_BUFFER, num_indices * sizeof(uint32), indices);
+    mesh.num_indices = num_indices;
+    mesh.num_vertices = num_vertices;
+    return mesh;
+}
 
 Mesh gen_normal_plane()
 {
     const float hs = 1.0f;
 
     // All faces are oriented counter-clockwise outwards
-    float vertices[] = {
-        -hs, 0.0f, -hs, 0.0f, 1.0f, 0.0f,
-         hs, 0.0f, -hs, 0.0f, 1.0f, 0.0f,
-         hs, 0.0f,  hs, 0.0f, 1.0f, 0.0f,
-        -hs, 0.0f,  hs, 0.0f, 1.0f, 0.0f
+    float positions[] = {
+        -hs, 0.0f, -hs,
+         hs, 0.0f, -hs,
+         hs, 0.0f,  hs,
+        -hs, 0.0f,  hs
+    };
+
+    float normals[] = {
+        0.0f, 1.0f, 0.0f,
+        0.0f, 1.0f, 0.0f,
+        0.0f, 1.0f, 0.0f,
+        0.0f, 1.0f, 0.0f
     };
 
     uint32 indices[] = { 0, 1, 2, 2, 3, 0 };
 
-    Mesh mesh;
-    mesh.vertex_buffer = gen_buffer(GL_ARRAY_BUFFER, sizeof(vertices), vertices);
-    mesh.index_buffer = gen_buffer(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices);
-    mesh.num_indices = 6;
-    mesh.num_vertices = 4;
-    return mesh;
+    return gen_mesh(positions, normals, NULL, 4, indices, 6);
 }
 
 Mesh gen_tex_quad()
@@ -47,21 +75,23 @@ Mesh gen_tex_quad()
     const float hs = 1.0f;
 
     // All faces are oriented counter-clockwise outwards
-    float vertices[] = {
-        -hs, -hs, 0.0f, 0.0f, 0.0f,
-         hs, -hs, 0.0f, 1.0f, 0.0f,
-         hs,  hs, 0.0f, 1.0f, 1.0f,
-        -hs,  hs, 0.0f, 0.0f, 1.0f
+    float positions[] = {
+        -hs, -hs, 0.0f,
+         hs, -hs, 0.0f,
+         hs,  hs, 0.0f,
+        -hs,  hs, 0.0f
+    };
+
+    float texcoords[] = {
+        0.0f, 0.0f,
+        1.0f, 0.0f,
+        1.0f, 1.0f,
+        0.0f, 1.0f
     };
 
     uint32 indices[] = { 0, 1, 2, 2, 3, 0 };
 
-    Mesh mesh;
-    mesh.vertex_buffer = gen_buffer(GL_ARRAY_BUFFER, sizeof(vertices), vertices);
-    mesh.index_buffer = gen_buffer(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices);
-    mesh.num_indices = 6;
-    mesh.num_vertices = 4;
-    return mesh;
+    return gen_mesh(positions, NULL, texcoords, 4, indices, 6);
 }
 
 Mesh gen_unit_sphere(int t_samples, int s_samples)
@@ -105,11 +135,10 @@ Mesh gen_unit_sphere(int t_samples, int s_samples)
         }
     }   
 
-    Mesh mesh;
-    mesh.vertex_buffer = gen_buffer(GL_ARRAY_BUFFER, t_samples * s_samples * 4 * sizeof(vec3), vertices);
-    mesh.index_buffer = gen_buffer(GL_ELEMENT_ARRAY_BUFFER, t_samples * s_samples * 6 * sizeof(uint32), indices);
-    mesh.num_indices = index_index;
-    mesh.num_vertices = vertex_index;
+    // The sphere shader derives the normal from the position.
+    Mesh mesh = gen_mesh(&vertices[0].x, NULL, NULL, vertex_index, indices, index_index);
+    delete[] vertices;
+    delete[] indices;
     return mesh;
 }
 
@@ -121,6 +150,6 @@ void Mesh::dispose()
 
 void Mesh::bind()
 {
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    MaliSDK::GLStateCache::bindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    MaliSDK::GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
 }
\ No newline at end of file
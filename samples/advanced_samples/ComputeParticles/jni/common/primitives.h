@@ -23,6 +23,8 @@
 #include "glutil.h"
 #include "shader.h"
 
+// Vertices are interleaved and quantized, see MaliSDK::VertexLayout.
+// Attributes a mesh does not have are -1.
 struct Mesh
 {
     GLuint vertex_buffer;
@@ -30,6 +32,11 @@ struct Mesh
     int num_indices;
     int num_vertices;
 
+    MaliSDK::VertexLayout layout;
+    int position;
+    int normal;
+    int texcoord;
+
     void dispose();
     void bind();
 };
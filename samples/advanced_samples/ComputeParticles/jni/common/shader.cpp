@@ -123,7 +123,42 @@ bool Shader::load_compute_from_file(string cs_path)
 
 bool Shader::link()
 {
-    return link_program(m_id, m_shaders);
+    if (!link_program(m_id, m_shaders))
+        return false;
+    cache_uniform_locations();
+    return true;
+}
+
+void Shader::cache_uniform_locations()
+{
+    m_uniforms.clear();
+
+    GLint count = 0;
+    GLint max_length = 0;
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    if (count <= 0 || max_length <= 0)
+        return;
+
+    std::vector<GLchar> name(max_length);
+    for (GLint i = 0; i < count; ++i)
+    {
+        GLint size;
+        GLenum type;
+        GLsizei length;
+        glGetActiveUniform(m_id, i, max_length, &length, &size, &type, &name[0]);
+
+        // Uniforms in blocks have no location and are skipped.
+        GLint location = glGetUniformLocation(m_id, &name[0]);
+        if (location < 0)
+            continue;
+
+        // Arrays are reported as "name[0]", but are usually looked up by "name".
+        string key(&name[0], length);
+        if (key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0)
+            key.resize(key.size() - 3);
+        m_uniforms[key] = location;
+    }
 }
 
 void Shader::dispose()
@@ -137,15 +172,15 @@ void Shader::dispose()
 
 void Shader::use()
 {
-    glUseProgram(m_id);
+    MaliSDK::GLStateCache::useProgram(m_id);
 }
 
 void Shader::unuse()
 {
-    glUseProgram(0);
+    MaliSDK::GLStateCache::useProgram(0);
 }
 
-GLint Shader::get_uniform_location(string name)
+GLint Shader::get_uniform_location(const string &name)
 {
     std::unordered_map<std::string, GLint>::iterator it = m_uniforms.find(name);
     if(it != m_uniforms.end())
@@ -162,7 +197,7 @@ GLint Shader::get_uniform_location(string name)
     }
 }
 
-GLint Shader::get_attribute_location(string name)
+GLint Shader::get_attribute_location(const string &name)
 {
     std::unordered_map<std::string, GLint>::iterator it = m_attributes.find(name);
     if(it != m_attributes.end())
@@ -179,7 +214,7 @@ GLint Shader::get_attribute_location(string name)
     }
 }
 
-void Shader::set_attribfv(string name, GLsizei num_components, 
+void Shader::set_attribfv(const string &name, GLsizei num_components, 
                           GLsizei stride, GLsizei offset)
 {
     GLint loc = get_attribute_location(name);
@@ -194,16 +229,25 @@ void Shader::set_attribfv(string name, GLsizei num_components,
         );
 }
 
-void Shader::unset_attrib(string name)
+void Shader::unset_attrib(const string &name)
 {
     glDisableVertexAttribArray(get_attribute_location(name));
 }
 
-void Shader::set_uniform(string name, const mat4 &v) { glUniformMatrix4fv(get_uniform_location(name), 1, GL_FALSE, v.value_ptr()); }
-void Shader::set_uniform(string name, const vec4 &v) { glUniform4f(get_uniform_location(name), v.x, v.y, v.z, v.w); }
-void Shader::set_uniform(string name, const vec3 &v) { glUniform3f(get_uniform_location(name), v.x, v.y, v.z); }
-void Shader::set_uniform(string name, const vec2 &v) { glUniform2f(get_uniform_location(name), v.x, v.y); }
-void Shader::set_uniform(string name, double v) { glUniform1f(get_uniform_location(name), v); }
-void Shader::set_uniform(string name, float v) { glUniform1f(get_uniform_location(name), v); }
-void Shader::set_uniform(string name, int v) { glUniform1i(get_uniform_location(name), v); }
-void Shader::set_uniform(string name, unsigned int v) { glUniform1ui(get_uniform_location(name), v); }
+void Shader::set_uniform(const string &name, const mat4 &v) { glUniformMatrix4fv(get_uniform_location(name), 1, GL_FALSE, v.value_ptr()); }
+void Shader::set_uniform(const string &name, const vec4 &v) { glUniform4f(get_uniform_location(name), v.x, v.y, v.z, v.w); }
+void Shader::set_uniform(const string &name, const vec3 &v) { glUniform3f(get_uniform_location(name), v.x, v.y, v.z); }
+void Shader::set_uniform(const string &name, const vec2 &v) { glUniform2f(get_uniform_location(name), v.x, v.y); }
+void Shader::set_uniform(const string &name, double v) { glUniform1f(get_uniform_location(name), v); }
+void Shader::set_uniform(const string &name, float v) { glUniform1f(get_uniform_location(name), v); }
+void Shader::set_uniform(const string &name, int v) { glUniform1i(get_uniform_location(name), v); }
+void Shader::set_uniform(const string &name, unsigned int v) { glUniform1ui(get_uniform_location(name), v); }
+
+void Shader::set_uniform(GLint location, const mat4 &v) { glUniformMatrix4fv(location, 1, GL_FALSE, v.value_ptr()); }
+void Shader::set_uniform(GLint location, const vec4 &v) { glUniform4f(location, v.x, v.y, v.z, v.w); }
+void Shader::set_uniform(GLint location, const vec3 &v) { glUniform3f(location, v.x, v.y, v.z); }
+void Shader::set_uniform(GLint location, const vec2 &v) { glUniform2f(location, v.x, v.y); }
+void Shader::set_uniform(GLint location, double v) { glUniform1f(location, v); }
+void Shader::set_uniform(GLint location, float v) { glUniform1f(location, v); }
+void Shader::set_uniform(GLint location, int v) { glUniform1i(location, v); }
+void Shader::set_uniform(GLint location, unsigned int v) { glUniform1ui(location, v); }
@@ -40,21 +40,35 @@ public:
 	void use();
 	void unuse();
 
-	GLint get_uniform_location(string name);
-	GLint get_attribute_location(string name);
+	// Locations of all active uniforms are cached when the program is linked, so
+	// name lookups never reach the driver. Code that sets uniforms every frame should
+	// look the location up once and use the GLint overloads below.
+	GLint get_uniform_location(const string &name);
+	GLint get_attribute_location(const string &name);
 
-	void set_attribfv(string name, GLsizei num_components, GLsizei stride, GLsizei offset);
-	void unset_attrib(string name);
+	void set_attribfv(const string &name, GLsizei num_components, GLsizei stride, GLsizei offset);
+	void unset_attrib(const string &name);
 
-	void set_uniform(string name, const mat4 &v);
-	void set_uniform(string name, const vec4 &v);
-	void set_uniform(string name, const vec3 &v);
-	void set_uniform(string name, const vec2 &v);
-	void set_uniform(string name, double v);
-	void set_uniform(string name, float v);
-	void set_uniform(string name, int v);
-	void set_uniform(string name, unsigned int v);
+	void set_uniform(const string &name, const mat4 &v);
+	void set_uniform(const string &name, const vec4 &v);
+	void set_uniform(const string &name, const vec3 &v);
+	void set_uniform(const string &name, const vec2 &v);
+	void set_uniform(const string &name, double v);
+	void set_uniform(const string &name, float v);
+	void set_uniform(const string &name, int v);
+	void set_uniform(const string &name, unsigned int v);
+
+	void set_uniform(GLint location, const mat4 &v);
+	void set_uniform(GLint location, const vec4 &v);
+	void set_uniform(GLint location, const vec3 &v);
+	void set_uniform(GLint location, const vec2 &v);
+	void set_uniform(GLint location, double v);
+	void set_uniform(GLint location, float v);
+	void set_uniform(GLint location, int v);
+	void set_uniform(GLint location, unsigned int v);
 private:
+	void cache_uniform_locations();
+
 	std::unordered_map<string, GLint> m_attributes;
 	std::unordered_map<string, GLint> m_uniforms;
 	GLuint m_id;
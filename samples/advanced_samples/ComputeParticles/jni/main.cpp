@@ -52,6 +52,10 @@ extern "C"
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_computeparticles_ComputeParticles_init
     (JNIEnv *env, jclass jcls, jint width, jint height)
     {
+        // The context is new, so nothing the state cache knew about applies any more.
+        MaliSDK::GLStateCache::invalidate();
+        MaliSDK::GLStateCache::activeTexture(GL_TEXTURE0);
+
         ASSERT(load_app(), "Failed to load content");
         init_app(width, height);
 
@@ -69,6 +73,17 @@ extern "C"
         update_app(dt);
         render_app(dt);
 
+        MaliSDK::GLCallCounters::endFrame();
+#if defined(GL_CALL_COUNTERS)
+        // Once a second is enough to follow the per-pass uniform updates without flooding logcat.
+        if (floor(curr_tick) != floor(curr_tick - dt))
+        {
+            char counters[128];
+            MaliSDK::GLCallCounters::getLastFrameString(counters, sizeof(counters));
+            LOGI("%s\n", counters);
+        }
+#endif
+
         GLenum error = glGetError();
         bool were_errors = false;
         while (error != GL_NO_ERROR)
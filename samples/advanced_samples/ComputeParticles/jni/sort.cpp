@@ -31,23 +31,93 @@ Shader
     shader_scan,
     shader_scan_first,
     shader_resolve,
-    shader_reorder;
+    shader_reorder,
+    shader_radix_count,
+    shader_radix_scan,
+    shader_radix_scatter,
+    shader_refine;
 
 GLuint
     buf_scan[MAX_SCAN_LEVELS],
     buf_sums[MAX_SCAN_LEVELS],
     buf_flags,
-    buf_sorted;
+    buf_sorted,
+    buf_histogram;
 
 unsigned scan_levels;
 
-bool sort_init()
+// Set by sort_init(), num_blocks work groups of BLOCK_SIZE keys each.
+uint32_t num_keys;
+uint32_t num_blocks;
+
+SortMethod sort_method = SORT_METHOD_4BIT_HISTOGRAM;
+
+// Refinement work per incremental_sort(). Every dispatch runs REFINE_STEPS odd-even steps
+// on blocks of 2 * REFINE_GROUP_SIZE particles, alternately offset by half a block.
+const uint32_t REFINE_GROUP_SIZE = 128;
+const uint32_t REFINE_STEPS = 8;
+const uint32_t REFINE_DISPATCHES = 4;
+
+// Below this, the camera has moved enough that the previous order is no use (about 2.5 degrees).
+const float REFINE_MIN_AXIS_COS = 0.999f;
+
+GLint
+    loc_refine_axis,
+    loc_refine_block_offset,
+    loc_refine_num_steps;
+
+uint32_t frames_since_full_sort;
+vec3 last_full_sort_axis;
+
+// Uniforms of the shaders that compute the sort keys. They are set for every radix pass,
+// so their locations are resolved once up front.
+struct KeyUniforms
+{
+    GLint bit_offset;
+    GLint axis;
+    GLint z_min;
+    GLint z_max;
+};
+
+KeyUniforms
+    uniforms_scan_first,
+    uniforms_radix_count,
+    uniforms_radix_scatter;
+
+KeyUniforms get_key_uniforms(Shader &shader)
 {
+    KeyUniforms uniforms;
+    uniforms.bit_offset = shader.get_uniform_location("bitOffset");
+    uniforms.axis       = shader.get_uniform_location("axis");
+    uniforms.z_min      = shader.get_uniform_location("zMin");
+    uniforms.z_max      = shader.get_uniform_location("zMax");
+    return uniforms;
+}
+
+// Expects the shader to be current.
+void set_key_uniforms(const KeyUniforms &uniforms, int bit_offset, vec3 axis, float z_min, float z_max)
+{
+    uniform(uniforms.bit_offset, bit_offset);
+    uniform(uniforms.axis, axis);
+    uniform(uniforms.z_min, z_min);
+    uniform(uniforms.z_max, z_max);
+}
+
+bool sort_init(uint32_t keys)
+{
+    ASSERT(keys > 0 && keys % SORT_KEY_MULTIPLE == 0, "The number of keys must be a multiple of SORT_KEY_MULTIPLE");
+    num_keys = keys;
+    num_blocks = keys / BLOCK_SIZE;
+
     string res = "/data/data/com.arm.malideveloper.openglessdk.computeparticles/files/";
     if (!shader_scan.load_compute_from_file(res + "scan.cs") ||
             !shader_scan_first.load_compute_from_file(res + "scan_first.cs") ||
             !shader_resolve.load_compute_from_file(res + "scan_resolve.cs") ||
-            !shader_reorder.load_compute_from_file(res + "scan_reorder.cs"))
+            !shader_reorder.load_compute_from_file(res + "scan_reorder.cs") ||
+            !shader_radix_count.load_compute_from_file(res + "radix_count.cs") ||
+            !shader_radix_scan.load_compute_from_file(res + "radix_scan.cs") ||
+            !shader_radix_scatter.load_compute_from_file(res + "radix_scatter.cs") ||
+            !shader_refine.load_compute_from_file(res + "sort_refine.cs"))
     {
         return false;
     }
@@ -55,25 +125,41 @@ bool sort_init()
     if (!shader_scan.link() ||
             !shader_scan_first.link() ||
             !shader_resolve.link() ||
-            !shader_reorder.link())
+            !shader_reorder.link() ||
+            !shader_radix_count.link() ||
+            !shader_radix_scan.link() ||
+            !shader_radix_scatter.link() ||
+            !shader_refine.link())
     {
         return false;
     }
 
+    uniforms_scan_first    = get_key_uniforms(shader_scan_first);
+    uniforms_radix_count   = get_key_uniforms(shader_radix_count);
+    uniforms_radix_scatter = get_key_uniforms(shader_radix_scatter);
+
+    loc_refine_axis         = shader_refine.get_uniform_location("axis");
+    loc_refine_block_offset = shader_refine.get_uniform_location("blockOffset");
+    loc_refine_num_steps    = shader_refine.get_uniform_location("numSteps");
+
+    // Make the first incremental_sort() do a full sort.
+    frames_since_full_sort = SORT_FULL_INTERVAL;
+
     // We do the scan recursively. We have to do scan until one the entire dispatch can be computed by a single work group.
-    unsigned elems = NUM_KEYS;
+    unsigned elems = num_keys;
     scan_levels = 0;
     while (elems > 1)
     {
        scan_levels++;
        elems = (elems + BLOCK_SIZE - 1) / BLOCK_SIZE;
     }
+    ASSERT(scan_levels <= MAX_SCAN_LEVELS, "Too many keys for MAX_SCAN_LEVELS");
 
-    buf_sorted = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, NUM_KEYS * sizeof(vec4), NULL);
-    buf_flags  = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, NUM_KEYS * sizeof(GLuint), NULL);
+    buf_sorted = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_keys * sizeof(vec4), NULL);
+    buf_flags  = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, num_keys * sizeof(GLuint), NULL);
 
     // Allocate memory for scan levels. Make sure to properly pad them to a workgroups worth of work.
-    elems = NUM_BLOCKS;
+    elems = num_blocks;
     for (unsigned i = 0; i < scan_levels; i++)
     {
         buf_scan[i] = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, elems * BLOCK_SIZE * 4 * sizeof(GLuint), NULL);
@@ -81,6 +167,10 @@ bool sort_init()
         buf_sums[i] = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, elems * BLOCK_SIZE * 4 * sizeof(GLuint), NULL);
     }
 
+    // One count per digit and work group. radix_scan.cs splits this evenly over its 128 threads.
+    ASSERT((NUM_RADIX_BINS * num_blocks) % 128 == 0, "Histogram size must be a multiple of the scan work group size");
+    buf_histogram = gen_buffer(GL_SHADER_STORAGE_BUFFER, GL_DYNAMIC_COPY, NUM_RADIX_BINS * num_blocks * sizeof(GLuint), NULL);
+
     return true;
 }
 
@@ -88,6 +178,7 @@ void sort_free()
 {
     del_buffer(buf_sorted);
     del_buffer(buf_flags);
+    del_buffer(buf_histogram);
 
     for (unsigned i = 0; i < scan_levels; i++)
     {
@@ -99,6 +190,10 @@ void sort_free()
     shader_scan_first.dispose();
     shader_resolve.dispose();
     shader_reorder.dispose();
+    shader_radix_count.dispose();
+    shader_radix_scan.dispose();
+    shader_radix_scatter.dispose();
+    shader_refine.dispose();
 }
 
 void sort_bits(GLuint buf_input, int bit_offset, vec3 axis, float z_min, float z_max)
@@ -106,7 +201,7 @@ void sort_bits(GLuint buf_input, int bit_offset, vec3 axis, float z_min, float z
     // Keep track of which dispatch sizes we used to make the resolve steps simpler.
     unsigned dispatch_sizes[MAX_SCAN_LEVELS] = {0};
 
-    unsigned blocks = NUM_BLOCKS;
+    unsigned blocks = num_blocks;
 
     // First pass. Compute 16-bit unsigned depth and apply first pass of scan algorithm.
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buf_input);
@@ -114,10 +209,7 @@ void sort_bits(GLuint buf_input, int bit_offset, vec3 axis, float z_min, float z
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buf_sums[0]);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, buf_flags);
     use_shader(shader_scan_first);
-    uniform("bitOffset", bit_offset);
-    uniform("axis", axis);
-    uniform("zMin", z_min);
-    uniform("zMax", z_max);
+    set_key_uniforms(uniforms_scan_first, bit_offset, axis, z_min, z_max);
     dispatch_sizes[0] = blocks;
     glDispatchCompute(blocks, 1, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
@@ -172,24 +264,104 @@ void sort_bits(GLuint buf_input, int bit_offset, vec3 axis, float z_min, float z
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buf_sums[0]);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, buf_sorted);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buf_flags);
-    glDispatchCompute(NUM_BLOCKS, 1, 1);
+    glDispatchCompute(num_blocks, 1, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
     // Now we're done :)
 }
 
-void radix_sort(GLuint buf_input, vec3 axis, float z_min, float z_max)
+// Sort by a 4-bit digit in three dispatches. See radix_count.cs for the details.
+void sort_digit(GLuint buf_input, int bit_offset, vec3 axis, float z_min, float z_max)
+{
+    // Count the digits of every block of BLOCK_SIZE keys.
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buf_input);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buf_histogram);
+    use_shader(shader_radix_count);
+    set_key_uniforms(uniforms_radix_count, bit_offset, axis, z_min, z_max);
+    glDispatchCompute(num_blocks, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // The histogram is small enough for a single work group to scan it.
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buf_histogram);
+    use_shader(shader_radix_scan);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Move every element to its sorted position for this digit.
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buf_input);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buf_histogram);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buf_sorted);
+    use_shader(shader_radix_scatter);
+    set_key_uniforms(uniforms_radix_scatter, bit_offset, axis, z_min, z_max);
+    glDispatchCompute(num_blocks, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void radix_sort(GLuint buf_input, vec3 axis, float z_min, float z_max, GLbitfield barriers)
 {
-    for (uint32_t i = 0; i < 8; i++)
+    // Both methods do an even number of passes over the 16-bit keys,
+    // so the sorted data always ends up back in <buf_input>.
+    if (sort_method == SORT_METHOD_4BIT_HISTOGRAM)
+    {
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            sort_digit(buf_input, i * 4, axis, z_min, z_max);
+            std::swap(buf_input, buf_sorted);
+        }
+    }
+    else
     {
-        sort_bits(buf_input, i * 2, axis, z_min, z_max);
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            sort_bits(buf_input, i * 2, axis, z_min, z_max);
 
-        // Swap for the next digit stage
-        // The <buf_input> buffer will in the end hold the latest sorted data
-        std::swap(buf_input, buf_sorted);
+            // Swap for the next digit stage
+            // The <buf_input> buffer will in the end hold the latest sorted data
+            std::swap(buf_input, buf_sorted);
+        }
     }
 
     // We use the position data to draw the particles afterwards
     // Thus we need to ensure that the data is up to date
+    if (barriers)
+        glMemoryBarrier(barriers);
+}
+
+void incremental_sort(GLuint buf_input, vec3 axis, float z_min, float z_max)
+{
+    if (frames_since_full_sort >= SORT_FULL_INTERVAL || dot(axis, last_full_sort_axis) < REFINE_MIN_AXIS_COS)
+    {
+        radix_sort(buf_input, axis, z_min, z_max);
+        frames_since_full_sort = 0;
+        last_full_sort_axis = axis;
+        return;
+    }
+    frames_since_full_sort++;
+
+    const uint32_t block_elements = 2 * REFINE_GROUP_SIZE;
+
+    // Refine in place, alternating the block offset so particles can cross block boundaries.
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buf_input);
+    use_shader(shader_refine);
+    uniform(loc_refine_axis, axis);
+    uniform(loc_refine_num_steps, REFINE_STEPS);
+    for (uint32_t i = 0; i < REFINE_DISPATCHES; i++)
+    {
+        uint32_t offset = (i & 1) ? REFINE_GROUP_SIZE : 0;
+        uniform(loc_refine_block_offset, offset);
+        glDispatchCompute((num_keys - offset + block_elements - 1) / block_elements, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
     glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
 }
+
+void sort_set_method(SortMethod method)
+{
+    sort_method = method;
+}
+
+SortMethod sort_get_method()
+{
+    return sort_method;
+}
@@ -23,11 +23,35 @@
 
 #include "common/common.h"
 const uint32_t BLOCK_SIZE = 128;
-const uint32_t NUM_KEYS = 1 << 14;
-const uint32_t NUM_BLOCKS = NUM_KEYS / BLOCK_SIZE;
 
-bool sort_init();
+// Digit values per pass of the 4-bit sort.
+const uint32_t NUM_RADIX_BINS = 16;
+
+// The number of keys has to be a multiple of this, so the histogram of the 4-bit sort
+// splits evenly over the threads of radix_scan.cs.
+const uint32_t SORT_KEY_MULTIPLE = BLOCK_SIZE * 128 / NUM_RADIX_BINS;
+
+enum SortMethod
+{
+    SORT_METHOD_2BIT_SCAN,      // 8 passes of 2-bit digits, each with a recursive block scan.
+    SORT_METHOD_4BIT_HISTOGRAM  // 4 passes of 4-bit digits, each with per work group histograms.
+};
+
+// Sorts <num_keys> particles, a multiple of SORT_KEY_MULTIPLE.
+bool sort_init(uint32_t num_keys);
 void sort_free();
-void radix_sort(GLuint particles, vec3 axis, float z_min, float z_max);
+// <barriers> are issued once the particles are sorted, 0 when the caller waits for them later.
+void radix_sort(GLuint particles, vec3 axis, float z_min, float z_max,
+                GLbitfield barriers = GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+// Both methods give the same result, so they can be switched at any time to compare them.
+void sort_set_method(SortMethod method);
+SortMethod sort_get_method();
+
+// Particles barely change depth order between frames. Instead of sorting from scratch,
+// this refines the order left by the previous call with a few odd-even transposition passes,
+// and only falls back to radix_sort() every SORT_FULL_INTERVAL calls or when the axis has moved.
+const uint32_t SORT_FULL_INTERVAL = 30;
+void incremental_sort(GLuint particles, vec3 axis, float z_min, float z_max);
 
 #endif
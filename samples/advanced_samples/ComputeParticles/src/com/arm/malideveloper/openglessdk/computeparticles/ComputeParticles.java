@@ -123,15 +123,25 @@ public class ComputeParticles extends MaliSamplesActivity
 
         extractAsset("particle.vs");
         extractAsset("particle.fs");
+        extractAsset("particle_oit.fs");
 
         extractAsset("spawn.cs");
         extractAsset("update.cs");
+        extractAsset("emit_args.cs");
+        extractAsset("clear_dead.cs");
+        extractAsset("shadow_bin.cs");
+        extractAsset("shadow_accumulate.cs");
 
         extractAsset("scan.cs");
         extractAsset("scan_first.cs");
         extractAsset("scan_resolve.cs");
         extractAsset("scan_reorder.cs");
 
+        extractAsset("radix_count.cs");
+        extractAsset("radix_scan.cs");
+        extractAsset("radix_scatter.cs");
+        extractAsset("sort_refine.cs");
+
         mView = new ComputeView(getApplication());
 
         // Change resolution to half
@@ -0,0 +1,52 @@
+#version 300 es
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#extension GL_EXT_shader_pixel_local_storage : require
+precision highp float;
+
+// The whole G-buffer fits in the 128 bits of fast local storage per pixel.
+__pixel_localEXT FragDataLocal {
+    layout(rgb10_a2) vec4 lighting;
+    layout(rgba8) vec4 albedo;
+    layout(rg16f) vec2 normal;
+    layout(r32f) float depth;
+} storage;
+
+uniform float ambient;
+in vec4 vPosition;
+in vec3 vNormal;
+flat in vec4 vAlbedo; // Diffuse colour, and specular intensity in alpha
+
+// Octahedral encoding packs a unit vector into two components without losing the sign of z.
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 wrapped = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n.z >= 0.0 ? n.xy : wrapped;
+}
+
+void main()
+{
+    storage.lighting = vec4(vAlbedo.rgb * ambient, 1.0);
+    storage.albedo = vAlbedo;
+    storage.normal = encodeNormal(normalize(vNormal));
+    storage.depth = -vPosition.z;
+}
@@ -0,0 +1,42 @@
+#version 300 es
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+in vec3 position;
+in vec3 normal;
+
+// Per instance, so all the objects sharing a mesh are drawn by one call, see DrawQueue.
+layout(location = 2) in mat4 instanceModel;
+layout(location = 6) in vec4 instanceAlbedo;
+
+out vec4 vPosition;
+out vec3 vNormal;
+flat out vec4 vAlbedo;
+uniform mat4 projection;
+uniform mat4 view;
+
+void main()
+{
+    mat4 model = instanceModel;
+    vAlbedo = instanceAlbedo;
+    vNormal = (view * model * vec4(normal, 0.0)).xyz;
+    vPosition = view * model * vec4(position, 1.0);
+    gl_Position = projection * vPosition;
+}
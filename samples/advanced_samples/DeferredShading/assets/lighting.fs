@@ -0,0 +1,71 @@
+#version 300 es
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#extension GL_EXT_shader_pixel_local_storage : require
+precision highp float;
+
+__pixel_localEXT FragDataLocal {
+    layout(rgb10_a2) vec4 lighting;
+    layout(rgba8) vec4 albedo;
+    layout(rg16f) vec2 normal;
+    layout(r32f) float depth;
+} storage;
+
+flat in vec4 vLightPositionRadius;
+flat in vec4 vLightColorIntensity;
+
+// Position reconstruction parameters
+uniform vec2 tanHalfFov;
+uniform vec2 invResolution;
+
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+void main()
+{
+    // Reconstruct view-space position from the stored linear depth
+    float depth = storage.depth;
+    vec2 ndc = vec2(-1.0) + 2.0 * gl_FragCoord.xy * invResolution;
+    vec3 P = vec3(ndc * tanHalfFov * depth, -depth);
+    vec3 V = -normalize(P);
+    vec3 N = decodeNormal(storage.normal);
+
+    vec3 L = vLightPositionRadius.xyz - P;
+    float r = length(L);
+    L /= r;
+
+    // Smooth falloff that reaches zero at the radius of influence, so the volume bounds the light exactly
+    float falloff = clamp(1.0 - r / vLightPositionRadius.w, 0.0, 1.0);
+    float attenuation = vLightColorIntensity.a * falloff * falloff;
+
+    // Blinn-Phong
+    vec3 H = normalize(V + L);
+    float NdotL = max(dot(N, L), 0.0);
+    float specular = storage.albedo.a * exp2(-64.0 * (1.0 - max(dot(N, H), 0.0)));
+
+    // Additive lighting, read and written in place
+    storage.lighting.rgb += attenuation * (NdotL * storage.albedo.rgb + specular) * vLightColorIntensity.rgb;
+}
@@ -0,0 +1,38 @@
+#version 300 es
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+in vec3 position;
+in vec4 lightPositionRadius;
+in vec4 lightColorIntensity;
+
+flat out vec4 vLightPositionRadius;
+flat out vec4 vLightColorIntensity;
+uniform mat4 projection;
+uniform float volumeScale;
+
+void main()
+{
+    // The light position is already in view space, and a sphere looks the same from any direction
+    vec3 P = lightPositionRadius.xyz + position * lightPositionRadius.w * volumeScale;
+    vLightPositionRadius = lightPositionRadius;
+    vLightColorIntensity = lightColorIntensity;
+    gl_Position = projection * vec4(P, 1.0);
+}
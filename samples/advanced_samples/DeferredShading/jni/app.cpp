@@ -0,0 +1,564 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * On-tile deferred shading with pixel local storage.
+ *
+ * The G-buffer (albedo, normal and depth) and the lighting accumulator live in
+ * pixel local storage, which on Mali is the on-chip tile buffer. The geometry
+ * pass writes the G-buffer, every light volume then reads it and adds its
+ * contribution in place, and a final resolve pass converts the accumulated
+ * lighting to the framebuffer colour. The G-buffer is never written to, or read
+ * back from, main memory.
+ */
+
+#include <GLES3/gl3.h>
+#include "app.h"
+#include "DrawQueue.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Mathematics.h"
+#include "Matrix.h"
+#include "Platform.h"
+#include "Shader.h"
+#include "StreamingBuffer.h"
+#include "VectorTypes.h"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace MaliSDK;
+using std::string;
+using std::vector;
+
+#ifndef GL_EXT_shader_pixel_local_storage
+#define GL_EXT_shader_pixel_local_storage 1
+#define GL_MAX_SHADER_PIXEL_LOCAL_STORAGE_FAST_SIZE_EXT 0x8F63
+#define GL_MAX_SHADER_PIXEL_LOCAL_STORAGE_SIZE_EXT 0x8F67
+#define GL_SHADER_PIXEL_LOCAL_STORAGE_EXT 0x8F64
+#endif
+
+// Size of the FragDataLocal block declared by the shaders: four 32-bit members.
+static const GLint local_storage_size = 16;
+
+int
+    window_width,
+    window_height;
+
+GLuint
+    program_geometry = 0,
+    program_lighting = 0,
+    program_resolve = 0;
+
+Matrix
+    mat_projection,
+    mat_view;
+
+// Indexed triangles in a vertex array object of their own.
+struct Mesh
+{
+    GLuint vertex_array;
+    GLuint vertex_buffer;
+    GLuint index_buffer;
+    GLsizei num_indices;
+};
+
+Mesh quad, cube, sphere;
+
+// The floor and the pillars are all cubes, queued and drawn together with instancing.
+// Each instance carries its model matrix and albedo, see geometry.vs.
+static const GLuint geometry_instance_location = 2;
+static const unsigned int geometry_instance_vec4s = 5;
+DrawQueue *geometry_queue = NULL;
+
+// Uniform locations, queried once the programs are linked.
+GLint
+    geometry_projection_location,
+    geometry_view_location,
+    geometry_ambient_location,
+    lighting_projection_location,
+    lighting_volume_scale_location,
+    lighting_tan_half_fov_location,
+    lighting_inv_resolution_location;
+
+GLint
+    light_position_radius_location,
+    light_color_intensity_location;
+
+// Per-instance data of the light volumes, see lighting.vs.
+struct LightInstance
+{
+    Vec4f position_radius; // View-space position and radius of influence
+    Vec4f color_intensity;
+};
+
+const int num_lights = 128;
+Vec3f light_color[num_lights];
+
+// The lights move every frame, so they are written straight into a streaming buffer instead of copied by glBufferSubData.
+StreamingBuffer *light_stream = NULL;
+GLintptr light_offset = 0;
+
+// The lights orbit the pillars on rings of different radius, height and speed.
+static float light_radius = 0.6f;
+static float light_intensity = 1.2f;
+
+// The tessellated sphere is inscribed in the unit sphere, so it is scaled up
+// slightly to make sure the volume covers the whole radius of influence.
+static float light_volume_scale = 1.05f;
+
+static const int pillars_per_side = 7;
+static float pillar_spacing = 0.5f;
+
+// Camera parameters, the angles are in radians
+static float zoom = 4.0f;
+static float rot_x = -0.6f;
+static float rot_y = 0.0f;
+static float delta_x = 0.0f;
+static float delta_y = 0.0f;
+static float elapsed_time = 0.0f;
+
+static const float pi = float(M_PI);
+
+// Perspective projection parameters, Matrix::matrixPerspective() takes the field of view in radians
+static float z_near = 0.1f;
+static float z_far = 20.0f;
+static float fov_y = pi / 4.0f;
+static float aspect_ratio = 1.0f;
+
+static float radians_to_degrees(float radians)
+{
+    return radians * 180.0f / pi;
+}
+
+// Each vertex is a position, followed by a normal if floats_per_vertex is 6. A normal_location of -1 leaves it out.
+static Mesh create_mesh(const vector<float>& vertices, int floats_per_vertex, const vector<GLushort>& indices,
+                        GLint position_location, GLint normal_location)
+{
+    GLsizei stride = floats_per_vertex * sizeof(float);
+    Mesh mesh;
+
+    GL_CHECK(glGenVertexArrays(1, &mesh.vertex_array));
+    GL_CHECK(glBindVertexArray(mesh.vertex_array));
+
+    GL_CHECK(glGenBuffers(1, &mesh.vertex_buffer));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, mesh.vertex_buffer));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW));
+
+    GL_CHECK(glGenBuffers(1, &mesh.index_buffer));
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.index_buffer));
+    GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), &indices[0], GL_STATIC_DRAW));
+    mesh.num_indices = GLsizei(indices.size());
+
+    GL_CHECK(glEnableVertexAttribArray(position_location));
+    GL_CHECK(glVertexAttribPointer(position_location, 3, GL_FLOAT, GL_FALSE, stride, 0));
+    if (normal_location >= 0)
+    {
+        GL_CHECK(glEnableVertexAttribArray(normal_location));
+        GL_CHECK(glVertexAttribPointer(normal_location, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float))));
+    }
+
+    GL_CHECK(glBindVertexArray(0));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    return mesh;
+}
+
+static void delete_mesh(Mesh& mesh)
+{
+    GL_CHECK(glDeleteVertexArrays(1, &mesh.vertex_array));
+    GL_CHECK(glDeleteBuffers(1, &mesh.vertex_buffer));
+    GL_CHECK(glDeleteBuffers(1, &mesh.index_buffer));
+}
+
+// A cube from -1 to 1, all faces are oriented counter-clockwise outwards.
+static Mesh create_cube(GLint position_location, GLint normal_location)
+{
+    static const float face_normals[6][3] =
+    {
+        { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { -1.0f, 0.0f, 0.0f },
+        { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }
+    };
+    static const float face_corners[6][4][3] =
+    {
+        { { -1.0f, -1.0f, 1.0f }, { 1.0f, -1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { -1.0f, 1.0f, 1.0f } },
+        { { 1.0f, -1.0f, -1.0f }, { -1.0f, -1.0f, -1.0f }, { -1.0f, 1.0f, -1.0f }, { 1.0f, 1.0f, -1.0f } },
+        { { -1.0f, -1.0f, -1.0f }, { -1.0f, -1.0f, 1.0f }, { -1.0f, 1.0f, 1.0f }, { -1.0f, 1.0f, -1.0f } },
+        { { 1.0f, -1.0f, 1.0f }, { 1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } },
+        { { -1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, -1.0f }, { -1.0f, 1.0f, -1.0f } },
+        { { 1.0f, -1.0f, 1.0f }, { -1.0f, -1.0f, 1.0f }, { -1.0f, -1.0f, -1.0f }, { 1.0f, -1.0f, -1.0f } }
+    };
+
+    vector<float> vertices;
+    vector<GLushort> indices;
+    for (int face = 0; face < 6; face++)
+    {
+        for (int corner = 0; corner < 4; corner++)
+        {
+            vertices.insert(vertices.end(), face_corners[face][corner], face_corners[face][corner] + 3);
+            vertices.insert(vertices.end(), face_normals[face], face_normals[face] + 3);
+        }
+
+        GLushort first = GLushort(face * 4);
+        GLushort face_indices[] = { first, GLushort(first + 1), GLushort(first + 2),
+                                    GLushort(first + 2), GLushort(first + 3), first };
+        indices.insert(indices.end(), face_indices, face_indices + 6);
+    }
+
+    return create_mesh(vertices, 6, indices, position_location, normal_location);
+}
+
+// A full screen quad in normalized device coordinates.
+static Mesh create_quad(GLint position_location)
+{
+    static const float quad_vertices[] =
+    {
+        -1.0f, -1.0f, 0.0f,
+         1.0f, -1.0f, 0.0f,
+         1.0f,  1.0f, 0.0f,
+        -1.0f,  1.0f, 0.0f
+    };
+    static const GLushort quad_indices[] = { 0, 1, 2, 2, 3, 0 };
+
+    return create_mesh(vector<float>(quad_vertices, quad_vertices + 12), 3, vector<GLushort>(quad_indices, quad_indices + 6),
+                       position_location, -1);
+}
+
+// A unit sphere made of t_samples by s_samples quads, oriented counter-clockwise outwards.
+static Mesh create_sphere(int t_samples, int s_samples, GLint position_location, GLint normal_location)
+{
+    vector<float> vertices;
+    vector<GLushort> indices;
+
+    float dtheta = 2.0f * pi / float(t_samples);
+    float dphi = pi / float(s_samples);
+    for (int t = 0; t < t_samples; ++t)
+    {
+        for (int s = 0; s < s_samples; ++s)
+        {
+            float theta = t * dtheta;
+            float phi = s * dphi;
+
+            float r0 = std::sin(phi);
+            float r1 = std::sin(phi + dphi);
+
+            Vec3f corners[4] =
+            {
+                { r0 * std::cos(theta), std::cos(phi), r0 * std::sin(theta) },
+                { r0 * std::cos(theta + dtheta), std::cos(phi), r0 * std::sin(theta + dtheta) },
+                { r1 * std::cos(theta + dtheta), std::cos(phi + dphi), r1 * std::sin(theta + dtheta) },
+                { r1 * std::cos(theta), std::cos(phi + dphi), r1 * std::sin(theta) }
+            };
+
+            GLushort first = GLushort(vertices.size() / 6);
+            for (int corner = 0; corner < 4; corner++)
+            {
+                Vec3f normal = corners[corner];
+                normal.normalize();
+
+                vertices.insert(vertices.end(), &corners[corner].x, &corners[corner].x + 3);
+                vertices.insert(vertices.end(), &normal.x, &normal.x + 3);
+            }
+
+            GLushort quad_indices[] = { first, GLushort(first + 1), GLushort(first + 2),
+                                        GLushort(first + 2), GLushort(first + 3), first };
+            indices.insert(indices.end(), quad_indices, quad_indices + 6);
+        }
+    }
+
+    return create_mesh(vertices, 6, indices, position_location, normal_location);
+}
+
+bool init_app(int width, int height)
+{
+    window_width  = width;
+    window_height = height;
+    aspect_ratio = float(width) / height;
+
+    // The cache starts out unknown in a new context.
+    GLStateCache::invalidate();
+
+    // Check if we have support for pixel local storage, and enough of it to keep the whole G-buffer on-chip
+    if (!GLExtensions::isSupported("GL_EXT_shader_pixel_local_storage"))
+    {
+        LOGE("This device does not support shader pixel local storage");
+        return false;
+    }
+
+    GLint fast_size = 0;
+    GL_CHECK(glGetIntegerv(GL_MAX_SHADER_PIXEL_LOCAL_STORAGE_FAST_SIZE_EXT, &fast_size));
+    if (fast_size < local_storage_size)
+    {
+        LOGE("This device does not have enough fast pixel local storage for the G-buffer");
+        return false;
+    }
+
+    string res = "/data/data/com.arm.malideveloper.openglessdk.deferredshading/files/";
+    Shader::processProgram(&program_geometry, (res + "geometry.vs").c_str(), (res + "geometry.fs").c_str());
+    Shader::processProgram(&program_lighting, (res + "lighting.vs").c_str(), (res + "lighting.fs").c_str());
+    Shader::processProgram(&program_resolve, (res + "resolve.vs").c_str(), (res + "resolve.fs").c_str());
+
+    geometry_projection_location = GL_CHECK(glGetUniformLocation(program_geometry, "projection"));
+    geometry_view_location = GL_CHECK(glGetUniformLocation(program_geometry, "view"));
+    geometry_ambient_location = GL_CHECK(glGetUniformLocation(program_geometry, "ambient"));
+    lighting_projection_location = GL_CHECK(glGetUniformLocation(program_lighting, "projection"));
+    lighting_volume_scale_location = GL_CHECK(glGetUniformLocation(program_lighting, "volumeScale"));
+    lighting_tan_half_fov_location = GL_CHECK(glGetUniformLocation(program_lighting, "tanHalfFov"));
+    lighting_inv_resolution_location = GL_CHECK(glGetUniformLocation(program_lighting, "invResolution"));
+    light_position_radius_location = GL_CHECK(glGetAttribLocation(program_lighting, "lightPositionRadius"));
+    light_color_intensity_location = GL_CHECK(glGetAttribLocation(program_lighting, "lightColorIntensity"));
+
+    // The vertex arrays keep the attributes of each mesh, the draw queue adds the instance attributes of the cubes.
+    GLint geometry_position_location = GL_CHECK(glGetAttribLocation(program_geometry, "position"));
+    GLint geometry_normal_location = GL_CHECK(glGetAttribLocation(program_geometry, "normal"));
+    GLint lighting_position_location = GL_CHECK(glGetAttribLocation(program_lighting, "position"));
+    GLint resolve_position_location = GL_CHECK(glGetAttribLocation(program_resolve, "position"));
+    cube = create_cube(geometry_position_location, geometry_normal_location);
+    sphere = create_sphere(12, 12, lighting_position_location, -1);
+    quad = create_quad(resolve_position_location);
+
+    // The light volumes read their instances from the streaming buffer, a divisor of 1 steps once per light.
+    GL_CHECK(glBindVertexArray(sphere.vertex_array));
+    GL_CHECK(glEnableVertexAttribArray(light_position_radius_location));
+    GL_CHECK(glEnableVertexAttribArray(light_color_intensity_location));
+    GL_CHECK(glVertexAttribDivisor(light_position_radius_location, 1));
+    GL_CHECK(glVertexAttribDivisor(light_color_intensity_location, 1));
+    GL_CHECK(glBindVertexArray(0));
+
+    delete geometry_queue;
+    geometry_queue = new DrawQueue(geometry_instance_location, geometry_instance_vec4s,
+                                   1 + pillars_per_side * pillars_per_side);
+
+    // Spread the light colours around the hue circle
+    for (int i = 0; i < num_lights; i++)
+    {
+        float hue = 2.0f * pi * i / float(num_lights);
+        light_color[i] = Vec3f{ 0.5f + 0.5f * std::cos(hue),
+                                0.5f + 0.5f * std::cos(hue - 2.0f * pi / 3.0f),
+                                0.5f + 0.5f * std::cos(hue + 2.0f * pi / 3.0f) };
+    }
+    delete light_stream;
+    light_stream = new StreamingBuffer(GL_ARRAY_BUFFER, num_lights * sizeof(LightInstance));
+    LOGD("Light instances are streamed %s.", light_stream->isPersistent() ? "through a persistent mapping" : "through glMapBufferRange");
+
+    mat_projection = Matrix::matrixPerspective(fov_y, aspect_ratio, z_near, z_far);
+    elapsed_time = 0.0f;
+
+    return true;
+}
+
+void free_app()
+{
+    GL_CHECK(glDeleteProgram(program_geometry));
+    GL_CHECK(glDeleteProgram(program_lighting));
+    GL_CHECK(glDeleteProgram(program_resolve));
+    delete_mesh(quad);
+    delete_mesh(cube);
+    delete_mesh(sphere);
+    delete geometry_queue;
+    geometry_queue = NULL;
+    if (light_stream)
+    {
+        LOGD("Streamed %llu bytes of light instances, %u stalls, %u orphaned buffers.",
+             light_stream->getTotalUploadedBytes(), light_stream->getStalls(), light_stream->getOrphans());
+    }
+    delete light_stream;
+    light_stream = NULL;
+}
+
+void update_app(float dt)
+{
+    elapsed_time += dt;
+    rot_y += 0.01f * delta_x * dt + 0.05f * dt;
+    rot_x += 0.01f * delta_y * dt;
+    mat_view =
+        Matrix::createTranslation(0.0f, 0.0f, -zoom) *
+        Matrix::createRotationX(radians_to_degrees(rot_x)) *
+        Matrix::createRotationY(radians_to_degrees(rot_y));
+
+    light_stream->beginFrame();
+    LightInstance *light_instances = static_cast<LightInstance*>(light_stream->map(num_lights * sizeof(LightInstance), &light_offset));
+    if (!light_instances)
+        return;
+
+    float t = elapsed_time;
+    for (int i = 0; i < num_lights; i++)
+    {
+        float ring = float(i % 8);
+        float orbit = 0.4f + 0.25f * ring;
+        float speed = (i % 2 == 0 ? 0.3f : -0.2f) * (1.0f + 0.1f * ring);
+        float phase = 2.0f * pi * i / float(num_lights) * 8.0f;
+        Vec3f position = { orbit * std::cos(phase + speed * t),
+                           0.15f + 0.1f * std::sin(1.3f * t + phase),
+                           orbit * std::sin(phase + speed * t) };
+        Vec3f view_position = Matrix::vertexTransform(&position, &mat_view);
+
+        light_instances[i].position_radius = Vec4f{ view_position.x, view_position.y, view_position.z, light_radius };
+        light_instances[i].color_intensity = Vec4f{ light_color[i].x, light_color[i].y, light_color[i].z, light_intensity };
+    }
+    light_stream->unmap();
+}
+
+void queue_cube(Matrix model, Vec4f albedo)
+{
+    DrawQueue::Draw draw;
+    draw.program = program_geometry;
+    draw.texture = 0;
+    draw.vertexArray = cube.vertex_array;
+    draw.mode = GL_TRIANGLES;
+    draw.indexType = GL_UNSIGNED_SHORT;
+    draw.count = cube.num_indices;
+    draw.first = 0;
+
+    // Front to back by the distance to the centre, so the early depth test rejects the hidden pixels.
+    Matrix model_view = mat_view * model;
+    float depth = -model_view[14] / z_far;
+
+    float instance[geometry_instance_vec4s * 4];
+    memcpy(instance, model.getAsArray(), 16 * sizeof(float));
+    instance[16] = albedo.x;
+    instance[17] = albedo.y;
+    instance[18] = albedo.z;
+    instance[19] = albedo.w;
+
+    geometry_queue->submit(DrawQueue::makeKey(0, draw.program, draw.texture, draw.vertexArray, depth), draw, instance);
+}
+
+void render_pass_geometry()
+{
+    GL_CHECK(glUseProgram(program_geometry));
+    GL_CHECK(glUniformMatrix4fv(geometry_projection_location, 1, GL_FALSE, mat_projection.getAsArray()));
+    GL_CHECK(glUniformMatrix4fv(geometry_view_location, 1, GL_FALSE, mat_view.getAsArray()));
+    GL_CHECK(glUniform1f(geometry_ambient_location, 0.05f));
+
+    // Floor
+    queue_cube(Matrix::createTranslation(0.0f, -0.05f, 0.0f) * Matrix::createScaling(3.0f, 0.05f, 3.0f),
+               Vec4f{ 0.8f, 0.8f, 0.8f, 0.2f });
+
+    // A grid of pillars of varying height, with shinier materials
+    float offset = 0.5f * pillar_spacing * (pillars_per_side - 1);
+    for (int z = 0; z < pillars_per_side; z++)
+    {
+        for (int x = 0; x < pillars_per_side; x++)
+        {
+            float height = 0.1f + 0.08f * ((x * 3 + z * 5) % 7);
+            queue_cube(Matrix::createTranslation(x * pillar_spacing - offset, height, z * pillar_spacing - offset) *
+                       Matrix::createScaling(0.06f, height, 0.06f),
+                       Vec4f{ 0.4f + 0.08f * x, 0.5f, 0.4f + 0.08f * z, 0.8f });
+        }
+    }
+
+    geometry_queue->flush();
+}
+
+void render_pass_lighting()
+{
+    // Only the back faces of the light volumes are rasterized, and only where
+    // they lie behind the stored geometry. This leaves out pixels in front of
+    // and outside the volumes, and still works with the camera inside a volume.
+    GL_CHECK(glUseProgram(program_lighting));
+    GL_CHECK(glUniformMatrix4fv(lighting_projection_location, 1, GL_FALSE, mat_projection.getAsArray()));
+    GL_CHECK(glUniform1f(lighting_volume_scale_location, light_volume_scale));
+    GL_CHECK(glUniform2f(lighting_tan_half_fov_location, aspect_ratio * std::tan(fov_y / 2.0f), std::tan(fov_y / 2.0f)));
+    GL_CHECK(glUniform2f(lighting_inv_resolution_location, 1.0f / window_width, 1.0f / window_height));
+
+    // All the lights are drawn in a single instanced draw call, this frame's instances start at light_offset.
+    GL_CHECK(glBindVertexArray(sphere.vertex_array));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, light_stream->getBuffer()));
+    GL_CHECK(glVertexAttribPointer(light_position_radius_location, 4, GL_FLOAT, GL_FALSE, sizeof(LightInstance),
+                                   (void*)(light_offset + offsetof(LightInstance, position_radius))));
+    GL_CHECK(glVertexAttribPointer(light_color_intensity_location, 4, GL_FLOAT, GL_FALSE, sizeof(LightInstance),
+                                   (void*)(light_offset + offsetof(LightInstance, color_intensity))));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+    GL_CHECK(glDrawElementsInstanced(GL_TRIANGLES, sphere.num_indices, GL_UNSIGNED_SHORT, 0, num_lights));
+    GL_CHECK(glBindVertexArray(0));
+}
+
+void render_pass_resolve()
+{
+    GL_CHECK(glUseProgram(program_resolve));
+    GL_CHECK(glBindVertexArray(quad.vertex_array));
+    GL_CHECK(glDrawElements(GL_TRIANGLES, quad.num_indices, GL_UNSIGNED_SHORT, 0));
+    GL_CHECK(glBindVertexArray(0));
+}
+
+void render_app(float dt)
+{
+    // Clearing all buffers at the beginning can lead to better performance
+    GL_CHECK(glEnable(GL_SHADER_PIXEL_LOCAL_STORAGE_EXT));
+    GLStateCache::depthMask(GL_TRUE);
+    GL_CHECK(glClearDepthf(1.0f));
+    GL_CHECK(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+    // Write the material properties of the closest surface to the local storage.
+    GLStateCache::setEnabled(GL_DEPTH_TEST, true);
+    GLStateCache::depthFunc(GL_LEQUAL);
+    GLStateCache::setEnabled(GL_CULL_FACE, true);
+    GLStateCache::frontFace(GL_CCW);
+    GLStateCache::cullFace(GL_BACK);
+    render_pass_geometry();
+
+    // Accumulate the lights in the local storage.
+    GLStateCache::depthMask(GL_FALSE);
+    GLStateCache::depthFunc(GL_GEQUAL);
+    GLStateCache::cullFace(GL_FRONT);
+    render_pass_lighting();
+
+    // Write back lighting for all the pixels.
+    GLStateCache::setEnabled(GL_DEPTH_TEST, false);
+    GLStateCache::setEnabled(GL_CULL_FACE, false);
+    render_pass_resolve();
+    GL_CHECK(glDisable(GL_SHADER_PIXEL_LOCAL_STORAGE_EXT));
+
+    // The depth buffer is no longer needed, so we don't bother writing it back to memory.
+    GLenum to_invalidate[] = { GL_DEPTH };
+    GL_CHECK(glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, to_invalidate));
+
+    // The GPU may read this frame's light instances until the fence is signalled.
+    light_stream->endFrame();
+}
+
+static bool dragging = false;
+static float last_x = 0.0f;
+static float last_y = 0.0f;
+void on_pointer_down(float x, float y)
+{
+    if (!dragging)
+    {
+        dragging = true;
+        last_x = x;
+        last_y = y;
+    }
+    else
+    {
+        delta_x = x - last_x;
+        delta_y = y - last_y;
+    }
+}
+
+void on_pointer_up(float x, float y)
+{
+    dragging = false;
+    delta_x = 0.0f;
+    delta_y = 0.0f;
+}
@@ -18,62 +18,55 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include "app.h"
+
+#include <cstdlib>
+
+#include <jni.h>
+#include "Platform.h"
 #include "Timer.h"
 
-#include <sys/time.h>
+using namespace MaliSDK;
 
-namespace AstcTextures
-{
-    /* Please see header for specification. */
-    Timer::Timer() :
-        startTime(),
-        currentTime(),
-        lastIntervalTime(0.0f),
-        frameCount(0),
-        fpsTime(0.0f),
-        fps(0.0f)
-    {    
-        startTime.tv_sec    = 0;
-        startTime.tv_usec   = 0;
-        currentTime.tv_sec  = 0;
-        currentTime.tv_usec = 0;
+Timer timer;
 
-        reset();
+extern "C"
+{
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_deferredshading_NativeLibrary_init
+    (JNIEnv *env, jclass jcls, jint width, jint height)
+    {
+        if (!init_app(width, height))
+        {
+            LOGE("Failed to initialize app");
+            exit(1);
+        }
+        LOGD("OK!");
+        timer.reset();
     }
 
-    /* Please see header for specification. */
-    void Timer::reset()
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_deferredshading_NativeLibrary_step
+    (JNIEnv *env, jclass jcls)
     {
-        gettimeofday(&startTime, NULL);
-
-        lastIntervalTime = 0.0f;
-        frameCount       = 0;
-        fpsTime          = 0.0f;
+        float dt = timer.getInterval();
+        update_app(dt);
+        render_app(dt);
     }
 
-    /* Please see header for specification. */
-    float Timer::getTime()
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_deferredshading_NativeLibrary_uninit
+    (JNIEnv *, jclass)
     {
-        gettimeofday(&currentTime, NULL);
-
-        float seconds      = (currentTime.tv_sec - startTime.tv_sec);
-        float milliseconds = (float (currentTime.tv_usec - startTime.tv_usec)) / 1000000.0f;
-
-        return (seconds + milliseconds);
+        free_app();
     }
 
-    /* Please see header for specification. */
-    bool Timer::isTimePassed(float seconds)
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_deferredshading_NativeLibrary_onpointerdown
+    (JNIEnv * env, jobject obj, jfloat x, jfloat y)
     {
-        float time = getTime();
-
-        if (time - lastTime > seconds)
-        {
-            lastTime = time;
-
-            return true;
-        }
+        on_pointer_down(x, y);
+    }
 
-        return false;
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_deferredshading_NativeLibrary_onpointerup
+    (JNIEnv * env, jobject obj, jfloat x, jfloat y)
+    {
+        on_pointer_up(x, y);
     }
 }
@@ -18,48 +18,17 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifndef TIMER_H
-#define TIMER_H
+package com.arm.malideveloper.openglessdk.deferredshading;
 
-#include <cstdio>
-
-#if defined(_WIN32)
-#else
-#include <sys/time.h>
-#endif
-
-namespace MaliSDK
+public class NativeLibrary
 {
-    /**
-     * \brief Provides a platform independent high resolution timer.
-     * \note The timer measures real time, not CPU time.
-     */
-    class Timer
+    static
     {
-    private:
-    #if defined(_WIN32)
-        double resetStamp;
-        double invFreq;
-    #else
-        timeval startTime;
-        timeval currentTime;
-    #endif
-    public:
-        /**
-         * \brief Default Constructor
-         */
-        Timer();
-
-        /**
-         * \brief Resets the timer to 0.0f.
-         */
-        void reset();
-
-        /**
-         * \brief Returns the time passed since object creation or since reset() was last called.
-         * \return Float containing the current time.
-         */
-        float getTime();
-    };
-}
-#endif /* TIMER_H */
\ No newline at end of file
+        System.loadLibrary("Native");
+    }
+    public static native void init(int width, int height);
+    public static native void uninit();
+    public static native void step();
+    public static native void onpointerdown(float x, float y);
+    public static native void onpointerup(float x, float y);
+}
\ No newline at end of file
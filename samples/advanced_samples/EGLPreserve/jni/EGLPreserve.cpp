@@ -22,9 +22,10 @@
  * \file EGLPreserve.cpp
  * \brief A sample to show how to use glScissor() and EGL_SWAP_BEHAVIOUR
  *
- * The sample changes between three states:
+ * The sample changes between these states:
  * # running with scissoring on and EGL_SWAP_BEHAVIOUR set to EGL_BUFFER_PRESERVED
  * # running with scissoring on and EGL_SWAP_BEHAVIOUR set to EGL_BUFFER_DESTROYED
+ * # running with scissoring on and EGL_KHR_partial_update, if supported
  * # running with scissoring off
  * Scissoring specifies a rectangle on screen, only ares inside that rectangle are then
  * affected by draw calls.
@@ -35,6 +36,9 @@
  * The effect is that in case 1 above the left half of the cube is preserved (not moving) 
  * in the color buffer while the right halve is updated (keeps spinning). 
  * In case 2 the left the left half of the screen is cleared and the right half is updated.
+ * Case 3 looks like case 1, but instead of reading the whole previous frame back in, only the
+ * right half is declared damaged: the buffer age says what the back buffer still holds and
+ * the tiles of the left half are neither loaded nor written out.
  */
 
 #include <GLES2/gl2.h>
@@ -56,6 +60,7 @@
 #include "Platform.h"
 #include "Timer.h"
 #include "AndroidPlatform.h"
+#include "PartialUpdate.h"
 
 using std::string;
 using namespace MaliSDK;
@@ -69,6 +74,16 @@ string scissorOff = "Scissor:  off";
 string scissorOn = "Scissor:  on ";
 string preserveOff = "Preserve: off";
 string preserveOn = "Preserve: on ";
+string damageOn = "Damage:   on ";
+
+/* How the left half of the screen is kept while scissoring is on. */
+enum SwapMode
+{
+    SWAP_MODE_PRESERVED,
+    SWAP_MODE_DESTROYED,
+    SWAP_MODE_DAMAGE,
+    SWAP_MODE_COUNT
+};
 
 /* Shader variables. */
 GLuint programID = 0;
@@ -90,6 +105,20 @@ Timer animationTimer;
 /* A text object to draw text on the screen. */
 Text *text;
 
+/* Tracks the damage of each frame for EGL_KHR_partial_update. */
+PartialUpdate *partialUpdate = NULL;
+
+/* The cube kept in the left half of the screen while scissoring with a damage region. */
+Matrix frozenModelView;
+
+static void setSwapBehaviour(EGLint swapBehaviour)
+{
+    if(eglSurfaceAttrib(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), EGL_SWAP_BEHAVIOR, swapBehaviour) != EGL_TRUE)
+    {
+        LOGD("Warning: eglSurfaceAttrib() failed at %s:%i\n", __FILE__, __LINE__);
+    }
+}
+
 bool setupGraphics(int width, int height)
 {
     windowWidth = width;
@@ -115,6 +144,9 @@ bool setupGraphics(int width, int height)
     /* Initialize the Text object. */
     text = new Text(resourceDirectory.c_str(), windowWidth, windowHeight);
 
+    delete partialUpdate;
+    partialUpdate = new PartialUpdate();
+
     /* Process shaders. */
     GLuint vertexShaderID = 0;
     GLuint fragmentShaderID = 0;
@@ -196,14 +228,32 @@ bool setupGraphics(int width, int height)
     }
 
     /* Set preserve bit. */
-    if(eglSurfaceAttrib(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED) != EGL_TRUE)
-    {
-        LOGD("Warning: eglSurfaceAttrib() failed at %s:%i\n", __FILE__, __LINE__);
-    }
+    setSwapBehaviour(EGL_BUFFER_PRESERVED);
     
     return true;
 }
 
+static void drawCube(Matrix &modelView)
+{
+    GL_CHECK(glUseProgram(programID));
+
+    GL_CHECK(glUniformMatrix4fv(iLocModelview, 1, GL_FALSE, modelView.getAsArray()));
+    GL_CHECK(glUniformMatrix4fv(iLocProjection, 1, GL_FALSE, perspective.getAsArray()));
+
+    /* Both drawing surfaces also share vertex data. */
+    GL_CHECK(glEnableVertexAttribArray(iLocPosition));
+    GL_CHECK(glVertexAttribPointer(iLocPosition, 3, GL_FLOAT, GL_FALSE, 0, cubeVertices));
+
+    if(iLocFillColor != -1)
+    {
+        GL_CHECK(glEnableVertexAttribArray(iLocFillColor));
+        GL_CHECK(glVertexAttribPointer(iLocFillColor, 4, GL_FLOAT, GL_FALSE, 0, cubeColors));
+    }
+
+    /* Draw the cube. */
+    GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, 22, GL_UNSIGNED_BYTE, cubeIndices));
+}
+
 void renderFrame(void)
 {
     static float angleX = 0.0f;
@@ -211,10 +261,12 @@ void renderFrame(void)
     static float angleZ = 0.0f;
 
     static bool fullScreen = false;
-    static bool preserve = false;
+    /* No mode is applied until the first state change. */
+    static int swapMode = -1;
 
     /* Change the animation state if more than 3 seconds are passed since the last state change. */
-    if(animationTimer.isTimePassed(3.0f))
+    bool stateChanged = animationTimer.isTimePassed(3.0f);
+    if(stateChanged)
     {
         fullScreen = !fullScreen;
 
@@ -225,24 +277,23 @@ void renderFrame(void)
             LOGI("Scissor off\n");
 
             GL_CHECK(glDisable(GL_SCISSOR_TEST))
-            preserve = !preserve;
-            if(preserve)
+            swapMode = (swapMode + 1) % SWAP_MODE_COUNT;
+            if(swapMode == SWAP_MODE_DAMAGE && !partialUpdate->isSupported())
+            {
+                swapMode = SWAP_MODE_PRESERVED;
+            }
+
+            if(swapMode == SWAP_MODE_PRESERVED)
             {
                 /* Set preserve bit. */
                 LOGI("Preserve on\n");
-                if(eglSurfaceAttrib(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED) != EGL_TRUE)
-                {
-                    LOGD("Warning: eglSurfaceAttrib() failed at %s:%i\n", __FILE__, __LINE__);
-                }
+                setSwapBehaviour(EGL_BUFFER_PRESERVED);
             }
             else
             {
-                /* Clear preserve bit. */
-                LOGI("Preserve off\n");
-                if(eglSurfaceAttrib(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), EGL_SWAP_BEHAVIOR, EGL_BUFFER_DESTROYED) != EGL_TRUE)
-                {
-                    LOGD("Warning: eglSurfaceAttrib() failed at %s:%i\n", __FILE__, __LINE__);
-                }
+                /* Clear preserve bit, the damage region keeps what is needed of the previous frames. */
+                LOGI(swapMode == SWAP_MODE_DAMAGE ? "Damage on\n" : "Preserve off\n");
+                setSwapBehaviour(EGL_BUFFER_DESTROYED);
             }
         }
         else
@@ -251,10 +302,14 @@ void renderFrame(void)
             LOGI("Scissor on\n");
             GL_CHECK(glEnable(GL_SCISSOR_TEST));
             GL_CHECK(glScissor(windowWidth / 2, 0, windowWidth / 2, windowHeight));
-            if(preserve)
+            if(swapMode == SWAP_MODE_PRESERVED)
             {
                 text->addString(windowWidth - preserveOn.length() * Text::textureCharacterWidth, 0, preserveOn.c_str(), 0, 255, 0, 255);
             }
+            else if(swapMode == SWAP_MODE_DAMAGE)
+            {
+                text->addString(windowWidth - damageOn.length() * Text::textureCharacterWidth, 0, damageOn.c_str(), 0, 255, 0, 255);
+            }
             else
             {
                 text->addString(windowWidth - preserveOff.length() * Text::textureCharacterWidth, 0, preserveOff.c_str(), 255, 0, 0, 255);
@@ -262,8 +317,6 @@ void renderFrame(void)
         }
     }
 
-    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-
     Matrix rotationX = Matrix::createRotationX(angleX);
     Matrix rotationY = Matrix::createRotationY(angleY);
     Matrix rotationZ = Matrix::createRotationZ(angleZ);
@@ -282,23 +335,48 @@ void renderFrame(void)
     modelView = modelView * rotationY;
     modelView = modelView * rotationZ;
 
-    GL_CHECK(glUseProgram(programID));
+    /*
+     * Only the right half changes while scissoring, but a back buffer which has not been drawn to since
+     * the state changed is refreshed completely. Each back buffer holds its own older frame, so the left
+     * half is redrawn with the cube as it was when scissoring started, rather than relying on what the buffer holds.
+     */
+    EGLint damageX = 0;
+    EGLint damageWidth = 0;
 
-    GL_CHECK(glUniformMatrix4fv(iLocModelview, 1, GL_FALSE, modelView.getAsArray()));
-    GL_CHECK(glUniformMatrix4fv(iLocProjection, 1, GL_FALSE, perspective.getAsArray()));
+    if(swapMode == SWAP_MODE_DAMAGE)
+    {
+        EGLint damageY, damageHeight;
 
-    /* Both drawing surfaces also share vertex data. */
-    GL_CHECK(glEnableVertexAttribArray(iLocPosition));
-    GL_CHECK(glVertexAttribPointer(iLocPosition, 3, GL_FLOAT, GL_FALSE, 0, cubeVertices));
+        if(fullScreen || stateChanged)
+        {
+            partialUpdate->addFullDamage();
+        }
+        else
+        {
+            partialUpdate->addDamage(windowWidth / 2, 0, windowWidth / 2, windowHeight);
+        }
+        partialUpdate->beginFrame(&damageX, &damageY, &damageWidth, &damageHeight);
 
-    if(iLocFillColor != -1)
+        if(!fullScreen)
+        {
+            if(stateChanged)
+            {
+                frozenModelView = modelView;
+            }
+            GL_CHECK(glScissor(damageX, damageY, damageWidth, damageHeight));
+        }
+    }
+
+    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+    if(swapMode == SWAP_MODE_DAMAGE && !fullScreen && damageX < (EGLint)windowWidth / 2)
     {
-        GL_CHECK(glEnableVertexAttribArray(iLocFillColor));
-        GL_CHECK(glVertexAttribPointer(iLocFillColor, 4, GL_FLOAT, GL_FALSE, 0, cubeColors));
+        GL_CHECK(glScissor(damageX, 0, windowWidth / 2 - damageX, windowHeight));
+        drawCube(frozenModelView);
+        GL_CHECK(glScissor(windowWidth / 2, 0, windowWidth / 2, windowHeight));
     }
 
-    /* Draw the cube. */
-    GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, 22, GL_UNSIGNED_BYTE, cubeIndices));
+    drawCube(modelView);
 
     /* Draw fonts. */
     text->draw();
@@ -329,5 +407,7 @@ extern "C"
     (JNIEnv *, jclass)
     {
         delete text;
+        delete partialUpdate;
+        partialUpdate = NULL;
     }
 }
@@ -46,9 +46,13 @@
 #include "Texture.h"
 #include "ETCHeader.h"
 #include "AndroidPlatform.h"
+#include "AssetFile.h"
+#include "AtlasMipmapBuilder.h"
+#include "TextureFormatSelector.h"
 
 using std::stringstream;
 using std::string;
+using std::vector;
 using namespace MaliSDK;
 string resourceDirectory = "/data/data/com.arm.malideveloper.openglessdk.etcatlasalpha/";
 string textureFilename = "good_atlas_mip_";
@@ -60,6 +64,75 @@ string fragmentShaderFilename = "ETCAtlasAlpha_atlastex.frag";
 /* Texture variables. */
 GLuint textureID = 0;
 
+/*
+ * Build the mipmaps from level 0 rather than loading the prebuilt ones, every level of the RGB and alpha halves
+ * being filtered from that half only, so the alpha of the lower levels does not bleed into the colour and back.
+ */
+#define BUILD_ATLAS_MIPMAPS 1
+
+#if BUILD_ATLAS_MIPMAPS
+/**
+ * \brief Load level 0 of the atlas and build all its mipmaps, compressing every level again.
+ */
+bool loadAtlasMipmaps(const string &levelZeroPath, GLuint *texture)
+{
+    const size_t sizeOfETCHeader = 16;
+    AssetFile file;
+
+    if (!file.open(levelZeroPath.c_str()) || file.getSize() < sizeOfETCHeader)
+    {
+        LOGE("Could not open %s", levelZeroPath.c_str());
+        return false;
+    }
+
+    ETCHeader header((unsigned char *)file.getData());
+    int width = header.getWidth();
+    int height = header.getHeight();
+    vector<unsigned char> image;
+
+    TextureFormatSelector::decodeETC1(file.getData() + sizeOfETCHeader, width, height, &image);
+
+    /* The RGB image is the top half of the atlas and its alpha channel the bottom half. They touch, so there is no padding. */
+    vector<AtlasMipmapBuilder::SubImage> subImages(2);
+    AtlasMipmapBuilder::SubImage rgb = { 0, 0, width, height / 2 };
+    AtlasMipmapBuilder::SubImage alpha = { 0, height / 2, width, height / 2 };
+
+    subImages[0] = rgb;
+    subImages[1] = alpha;
+
+    /*
+     * OpenGL ES 2.0 cannot stop sampling at the last level in which the halves are still made of whole ETC blocks,
+     * so the whole chain is built. The levels past it are a few texels in size and share the blocks on the boundary.
+     */
+    int numberOfLevels = AtlasMipmapBuilder::getNumberOfLevels(width, height);
+    vector<vector<unsigned char> > levels;
+
+    LOGD("%d of the %d levels keep the halves of the atlas apart",
+         AtlasMipmapBuilder::getNumberOfSafeLevels(width, height, subImages), numberOfLevels);
+
+    if (!AtlasMipmapBuilder::build(&image[0], width, height, 3, subImages, 0, numberOfLevels, &levels))
+    {
+        return false;
+    }
+
+    GL_CHECK(glGenTextures(1, texture));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, *texture));
+
+    for (int level = 0; level < numberOfLevels; level++)
+    {
+        int levelWidth = width >> level > 1 ? width >> level : 1;
+        int levelHeight = height >> level > 1 ? height >> level : 1;
+        vector<unsigned char> blocks;
+
+        TextureFormatSelector::encodeETC1(&levels[level][0], levelWidth, levelHeight, &blocks);
+        GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, level, GL_ETC1_RGB8_OES, levelWidth, levelHeight, 0,
+                                        (GLsizei)blocks.size(), &blocks[0]));
+    }
+
+    return true;
+}
+#endif
+
 /* Shader variables. */
 GLuint programID = 0;
 GLint iLocPosition = -1;
@@ -88,8 +161,16 @@ bool setupGraphics(int width, int height)
     /* Should do src * (src alpha) + dest * (1-src alpha). */
     GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 
+#if BUILD_ATLAS_MIPMAPS
+    /* Initialize textures. Using an atlas, load level 0 and build the mipmap levels of each half separately. */
+    if (!loadAtlasMipmaps(texturePath + "0" + imageExtension, &textureID))
+    {
+        return false;
+    }
+#else
     /* Initialize textures. Using an atlas, load atlas and all mipmap levels from files. */
     Texture::loadCompressedMipmaps(texturePath.c_str(), imageExtension.c_str(), &textureID);
+#endif
 
     /* Process shaders. */
     GLuint vertexShaderID = 0;
@@ -30,47 +30,465 @@
  * the Alpha channel.
  * In this sample both images are loaded and the RGB and Alpha components are merged back
  * together in the fragment shader.
+ *
+ * The sample also benchmarks that method against the other ways of adding alpha to ETC1: a separate
+ * uncompressed alpha image, colour and alpha in the two halves of one atlas texture, and, where the
+ * driver exposes it, the native GL_COMPRESSED_RGBA8_ETC2_EAC format. Every methodDuration seconds it
+ * switches to the next method, drawing the same scene, and logs the texture memory, the external
+ * bandwidth and the frame times of the method it leaves.
  */
 
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 
+#include <climits>
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include <jni.h>
 #include <android/log.h> 
  
 #include "ETCCompressedAlpha.h"
+#include "AssetFile.h"
+#include "ETCHeader.h"
+#include "FrameStatistics.h"
+#include "GPUCounters.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "TextureFormatSelector.h"
+#include "TextureManager.h"
+#include "Timer.h"
 #include "AndroidPlatform.h"
 
+/* Not in the OpenGL ES 2.0 headers, the format can only be used where the driver lists it. */
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
 using std::stringstream;
 using std::string;
+using std::vector;
 using namespace MaliSDK;
 
 string resourceDirectory = "/data/data/com.arm.malideveloper.openglessdk.etccompressedalpha/";
 string textureFilename = "good_compressed_mip_";
 string imageExtension = ".pkm";
 string alphaExtension = "_alpha.pkm";
+string uncompressedAlphaFilename = "good_compressed_mip_0_alpha.pgm";
+string atlasFilename = "good_atlas_mip_";
 
 string vertexShaderFilename = "ETCCompressedAlpha_dualtex.vert";
 string fragmentShaderFilename = "ETCCompressedAlpha_dualtex.frag";
+string singleFragmentShaderFilename = "ETCCompressedAlpha_singletex.frag";
+string atlasVertexShaderFilename = "ETCCompressedAlpha_atlastex.vert";
+string atlasFragmentShaderFilename = "ETCCompressedAlpha_atlastex.frag";
+
+/* The ways of adding alpha to ETC1 colour the sample compares. */
+enum AlphaMethod
+{
+    ALPHA_METHOD_COMPRESSED,    /* Separate ETC1 image for alpha. */
+    ALPHA_METHOD_UNCOMPRESSED,  /* Separate GL_LUMINANCE image for alpha. */
+    ALPHA_METHOD_ATLAS,         /* Colour in the top half of one ETC1 texture, alpha in the bottom half. */
+    ALPHA_METHOD_ETC2_EAC,      /* GL_COMPRESSED_RGBA8_ETC2_EAC, EAC alpha in the same blocks as the colour. */
+    NUMBER_OF_ALPHA_METHODS
+};
+
+struct AlphaMethodResources
+{
+    const char *name;
+    bool supported;
+
+    GLuint programID;
+    GLint iLocPosition;
+    GLint iLocTexCoord;
+
+    /* Bound to texture unit 0 and 1, alphaTextureID is 0 where the alpha is in textureID. */
+    GLuint textureID;
+    GLuint alphaTextureID;
 
-/* Texture variables. */
-GLuint textureID = 0;
-GLuint alphaTextureID = 0;
+    /* The textures in textureManager, -1 where there is none. */
+    TextureManager::Handle textureHandle;
+    TextureManager::Handle alphaTextureHandle;
+
+    /* Bytes of all mipmap levels of both textures. */
+    unsigned int textureMemory;
+};
+
+AlphaMethodResources methods[NUMBER_OF_ALPHA_METHODS];
+AlphaMethod currentMethod = ALPHA_METHOD_COMPRESSED;
+
+/* Benchmark state of the current method. */
+float methodDuration = 10.0f;
+float methodTime = 0.0f;
+double methodReadBytes = 0.0;
+int methodCounterSamples = 0;
+bool methodStarted = false;
+
+Timer timer;
+FrameStatistics frameStatistics;
+GPUCounters *gpuCounters = NULL;
+TextureManager textureManager;
 
 /* Shader variables. */
 GLuint vertexShaderID = 0;
 GLuint fragmentShaderID = 0;
-GLuint programID = 0;
-GLint iLocPosition = -1;
-GLint iLocTexCoord = -1;
-GLint iLocSampler = -1;
+GLuint singleFragmentShaderID = 0;
+GLuint atlasVertexShaderID = 0;
+GLuint atlasFragmentShaderID = 0;
+
+/*
+ * Layers of 1, 2x2, 4x4 and 8x8 tiles over the whole screen, drawn behind the mipmap strip. They give every
+ * method the same blended overdraw, sampled across a range of mipmap levels, to measure.
+ */
+const int numberOfLayers = 4;
+vector<GLfloat> layerVertices;
+vector<GLfloat> layerTextureCoordinates;
+vector<GLushort> layerIndices;
+
+/* EAC modifier tables, from the OpenGL ES 3.0 specification. */
+static const int eacModifierTables[16][8] =
+{
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+};
+
+/* Bytes of a full mipmap chain stored in square blocks of blockSize pixels. */
+static unsigned int getMipmapChainSize(int width, int height, int blockSize, unsigned int bytesPerBlock)
+{
+    unsigned int size = 0;
+
+    while (true)
+    {
+        size += ((width + blockSize - 1) / blockSize) * ((height + blockSize - 1) / blockSize) * bytesPerBlock;
+        if (width == 1 && height == 1)
+        {
+            break;
+        }
+        width = (width > 1) ? width >> 1 : 1;
+        height = (height > 1) ? height >> 1 : 1;
+    }
+
+    return size;
+}
+
+/* Size of the base level of a PKM file, the levels below are named by their level number. */
+static void getPKMSize(const string &filename, int *width, int *height)
+{
+    AssetFile file;
+    if (!file.open(filename.c_str()) || file.getSize() < 16)
+    {
+        LOGE("Failed to open '%s'\n", filename.c_str());
+        exit(1);
+    }
+    ETCHeader header((unsigned char *)file.getData());
+    *width = header.getWidth();
+    *height = header.getHeight();
+}
+
+/* Load an 8-bit binary PGM image, see http://netpbm.sourceforge.net/doc/pgm.html for the format. */
+static bool loadPGM(const string &filename, vector<unsigned char> *pixels, int *width, int *height)
+{
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == NULL)
+    {
+        LOGE("Failed to open '%s'\n", filename.c_str());
+        return false;
+    }
+
+    int range = 0;
+    /* A single whitespace character separates the header from the pixels. */
+    if (fscanf(file, "P5 %d %d %d", width, height, &range) != 3 || range != 255 || fgetc(file) == EOF)
+    {
+        LOGE("Error reading file header of %s", filename.c_str());
+        fclose(file);
+        return false;
+    }
+
+    pixels->resize(*width * *height);
+    size_t read = fread(&(*pixels)[0], 1, pixels->size(), file);
+    fclose(file);
+    if (read != pixels->size())
+    {
+        LOGE("Failed to read in '%s'\n", filename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/* Halve an alpha image with a box filter, the way glGenerateMipmap makes the next level. */
+static void downsampleAlpha(const vector<unsigned char> &source, int width, int height, vector<unsigned char> *destination)
+{
+    int destinationWidth = (width > 1) ? width >> 1 : 1;
+    int destinationHeight = (height > 1) ? height >> 1 : 1;
+    destination->resize(destinationWidth * destinationHeight);
+
+    for (int y = 0; y < destinationHeight; y++)
+    {
+        for (int x = 0; x < destinationWidth; x++)
+        {
+            int x0 = 2 * x, x1 = (2 * x + 1 < width) ? 2 * x + 1 : 2 * x;
+            int y0 = 2 * y, y1 = (2 * y + 1 < height) ? 2 * y + 1 : 2 * y;
+            if (x0 >= width) x0 = x1 = width - 1;
+            if (y0 >= height) y0 = y1 = height - 1;
+
+            int sum = source[y0 * width + x0] + source[y0 * width + x1] + source[y1 * width + x0] + source[y1 * width + x1];
+            (*destination)[y * destinationWidth + x] = (unsigned char)((sum + 2) / 4);
+        }
+    }
+}
+
+/*
+ * Encode a 4x4 block of alpha, row by row, as an 8 byte EAC block. The base is the midpoint of the block
+ * and every table and multiplier is tried; multiplier 0 is left out as only OpenGL ES 3.0 defines it.
+ */
+static void encodeEACBlock(const unsigned char *alpha, unsigned char *block)
+{
+    int minimum = 255;
+    int maximum = 0;
+    for (int pixel = 0; pixel < 16; pixel++)
+    {
+        minimum = (alpha[pixel] < minimum) ? alpha[pixel] : minimum;
+        maximum = (alpha[pixel] > maximum) ? alpha[pixel] : maximum;
+    }
+    int base = (minimum + maximum + 1) / 2;
+
+    int bestError = INT_MAX;
+    int bestTable = 0;
+    int bestMultiplier = 1;
+    unsigned char bestIndices[16] = { 0 };
+
+    for (int table = 0; table < 16 && bestError > 0; table++)
+    {
+        for (int multiplier = 1; multiplier < 16 && bestError > 0; multiplier++)
+        {
+            unsigned char indices[16];
+            int error = 0;
+
+            for (int pixel = 0; pixel < 16 && error < bestError; pixel++)
+            {
+                int bestPixelError = INT_MAX;
+                for (int index = 0; index < 8; index++)
+                {
+                    int value = base + eacModifierTables[table][index] * multiplier;
+                    value = (value < 0) ? 0 : ((value > 255) ? 255 : value);
+                    int pixelError = (value - alpha[pixel]) * (value - alpha[pixel]);
+                    if (pixelError < bestPixelError)
+                    {
+                        bestPixelError = pixelError;
+                        indices[pixel] = (unsigned char)index;
+                    }
+                }
+                error += bestPixelError;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                bestTable = table;
+                bestMultiplier = multiplier;
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+        }
+    }
+
+    block[0] = (unsigned char)base;
+    block[1] = (unsigned char)((bestMultiplier << 4) | bestTable);
+
+    /* The 3-bit indices are stored column by column, the first pixel in the most significant bits. */
+    unsigned long long bits = 0;
+    for (int x = 0; x < 4; x++)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            bits = (bits << 3) | bestIndices[y * 4 + x];
+        }
+    }
+    for (int byte = 0; byte < 6; byte++)
+    {
+        block[2 + byte] = (unsigned char)(bits >> (40 - 8 * byte));
+    }
+}
+
+/*
+ * Build a GL_COMPRESSED_RGBA8_ETC2_EAC texture from the ETC1 colour mipmaps, ETC1 blocks are valid ETC2
+ * blocks, and EAC blocks encoded from the uncompressed alpha levels. Returns false when the driver rejects
+ * the format.
+ */
+static bool loadETC2EACMipmaps(const string &colourBase, const vector<unsigned char> &baseAlpha, int alphaWidth, int alphaHeight, GLuint *textureID)
+{
+    vector<unsigned char> alpha = baseAlpha;
+    vector<unsigned char> nextAlpha;
+    vector<unsigned char> blocks;
+
+    GL_CHECK(glGenTextures(1, textureID));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, *textureID));
+
+    for (int level = 0; ; level++)
+    {
+        stringstream filename;
+        filename << colourBase << level << imageExtension;
+
+        AssetFile file;
+        if (!file.open(filename.str().c_str()) || file.getSize() < 16)
+        {
+            LOGE("Failed to open '%s'\n", filename.str().c_str());
+            return false;
+        }
+        ETCHeader header((unsigned char *)file.getData());
+        const unsigned char *colour = file.getData() + 16;
+
+        if (header.getWidth() != alphaWidth || header.getHeight() != alphaHeight)
+        {
+            LOGE("Alpha level %i is %ix%i, the colour is %ix%i.", level, alphaWidth, alphaHeight, header.getWidth(), header.getHeight());
+            return false;
+        }
+
+        int blocksAcross = header.getPaddedWidth() / 4;
+        int blocksDown = header.getPaddedHeight() / 4;
+        blocks.resize(blocksAcross * blocksDown * 16);
+
+        for (int blockY = 0; blockY < blocksDown; blockY++)
+        {
+            for (int blockX = 0; blockX < blocksAcross; blockX++)
+            {
+                /* Edge pixels are repeated into the padding of levels smaller than a block. */
+                unsigned char blockAlpha[16];
+                for (int y = 0; y < 4; y++)
+                {
+                    for (int x = 0; x < 4; x++)
+                    {
+                        int pixelX = blockX * 4 + x;
+                        int pixelY = blockY * 4 + y;
+                        pixelX = (pixelX < alphaWidth) ? pixelX : alphaWidth - 1;
+                        pixelY = (pixelY < alphaHeight) ? pixelY : alphaHeight - 1;
+                        blockAlpha[y * 4 + x] = alpha[pixelY * alphaWidth + pixelX];
+                    }
+                }
+
+                int block = blockY * blocksAcross + blockX;
+                encodeEACBlock(blockAlpha, &blocks[block * 16]);
+                memcpy(&blocks[block * 16 + 8], colour + block * 8, 8);
+            }
+        }
+
+        /* Not GL_CHECK: an unsupported format is reported to the caller rather than being fatal. */
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RGBA8_ETC2_EAC, alphaWidth, alphaHeight, 0, blocks.size(), &blocks[0]);
+        if (glGetError() != GL_NO_ERROR)
+        {
+            LOGE("GL_COMPRESSED_RGBA8_ETC2_EAC rejected at level %i.", level);
+            return false;
+        }
+
+        if (alphaWidth == 1 && alphaHeight == 1)
+        {
+            return true;
+        }
+        downsampleAlpha(alpha, alphaWidth, alphaHeight, &nextAlpha);
+        alpha.swap(nextAlpha);
+        alphaWidth = (alphaWidth > 1) ? alphaWidth >> 1 : 1;
+        alphaHeight = (alphaHeight > 1) ? alphaHeight >> 1 : 1;
+    }
+}
+
+/* Link a program of already processed shaders and look up what the methods set. */
+static bool createProgram(GLuint vertexShader, GLuint fragmentShader, AlphaMethodResources *method)
+{
+    method->programID = GL_CHECK(glCreateProgram());
+    if (!method->programID)
+    {
+        LOGE("Could not create program.");
+        return false;
+    }
+    GL_CHECK(glAttachShader(method->programID, vertexShader));
+    GL_CHECK(glAttachShader(method->programID, fragmentShader));
+    GL_CHECK(glLinkProgram(method->programID));
+    GL_CHECK(glUseProgram(method->programID));
+
+    /* Vertex positions. */
+    method->iLocPosition = GL_CHECK(glGetAttribLocation(method->programID, "a_v4Position"));
+    if(method->iLocPosition == -1)
+    {
+        LOGE("Error: Attribute not found: \"a_v4Position\"");
+        exit(1);
+    }
+
+    /* Texture coordinates. */
+    method->iLocTexCoord = GL_CHECK(glGetAttribLocation(method->programID, "a_v2TexCoord"));
+    if(method->iLocTexCoord == -1)
+    {
+        LOGD("Warning: Attribute not found: \"a_v2TexCoord\"");
+    }
+
+    /* Set the sampler to point at the 0th texture unit. */
+    GLint iLocSampler = GL_CHECK(glGetUniformLocation(method->programID, "u_s2dTexture"));
+    if(iLocSampler == -1)
+    {
+        LOGD("Warning: Uniform not found: \"u_s2dTexture\"");
+    }
+    else
+    {
+        GL_CHECK(glUniform1i(iLocSampler, 0));
+    }
+
+    /* The alpha sampler, where there is one, points at the 1st texture unit. */
+    GLint iLocAlphaSampler = GL_CHECK(glGetUniformLocation(method->programID, "u_s2dAlpha"));
+    if(iLocAlphaSampler != -1)
+    {
+        GL_CHECK(glUniform1i(iLocAlphaSampler, 1));
+    }
+
+    return true;
+}
 
-GLint iLocAlphaSampler= -1;
+static void setupLayers(void)
+{
+    layerVertices.clear();
+    layerTextureCoordinates.clear();
+    layerIndices.clear();
+
+    for (int layer = 0; layer < numberOfLayers; layer++)
+    {
+        int tiles = 1 << layer;
+        for (int tileY = 0; tileY < tiles; tileY++)
+        {
+            for (int tileX = 0; tileX < tiles; tileX++)
+            {
+                GLfloat left = -1.0f + 2.0f * tileX / tiles;
+                GLfloat right = -1.0f + 2.0f * (tileX + 1) / tiles;
+                GLfloat top = 1.0f - 2.0f * tileY / tiles;
+                GLfloat bottom = 1.0f - 2.0f * (tileY + 1) / tiles;
+                GLushort first = (GLushort)(layerVertices.size() / 2);
+
+                /* Same corner order and texture orientation as the quads of the mipmap strip. */
+                const GLfloat corners[] = { left, top, left, bottom, right, top, right, bottom };
+                const GLfloat coordinates[] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+                layerVertices.insert(layerVertices.end(), corners, corners + 8);
+                layerTextureCoordinates.insert(layerTextureCoordinates.end(), coordinates, coordinates + 8);
+
+                const GLushort quad[] = { first, (GLushort)(first + 1), (GLushort)(first + 2), (GLushort)(first + 2), (GLushort)(first + 1), (GLushort)(first + 3) };
+                layerIndices.insert(layerIndices.end(), quad, quad + 6);
+            }
+        }
+    }
+}
 
 bool setupGraphics(int w, int h)
 {
@@ -78,8 +496,7 @@ bool setupGraphics(int w, int h)
 
     /* Full paths to the shader and texture files */
     string texturePath = resourceDirectory + textureFilename;
-    string vertexShaderPath = resourceDirectory + vertexShaderFilename; 
-    string fragmentShaderPath = resourceDirectory + fragmentShaderFilename;
+    string atlasPath = resourceDirectory + atlasFilename;
 
     /* Initialize OpenGL ES. */
     /* Check which formats are supported. */
@@ -94,68 +511,106 @@ bool setupGraphics(int w, int h)
     /* Should do src * (src alpha) + dest * (1-src alpha). */
     GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 
-    /* Initialize textures using separate files */
-    Texture::loadCompressedMipmaps(texturePath.c_str(), imageExtension.c_str(), &textureID);
-    GL_CHECK(glActiveTexture(GL_TEXTURE1));
-    Texture::loadCompressedMipmaps(texturePath.c_str(), alphaExtension.c_str(), &alphaTextureID);
-
     /* Process shaders. */
-    Shader::processShader(&vertexShaderID, vertexShaderPath.c_str(), GL_VERTEX_SHADER);
+    Shader::processShader(&vertexShaderID, (resourceDirectory + vertexShaderFilename).c_str(), GL_VERTEX_SHADER);
     LOGD("vertexShaderID = %d", vertexShaderID);
-    Shader::processShader(&fragmentShaderID, fragmentShaderPath.c_str(), GL_FRAGMENT_SHADER);
+    Shader::processShader(&fragmentShaderID, (resourceDirectory + fragmentShaderFilename).c_str(), GL_FRAGMENT_SHADER);
     LOGD("fragmentShaderID = %d", fragmentShaderID);
+    Shader::processShader(&singleFragmentShaderID, (resourceDirectory + singleFragmentShaderFilename).c_str(), GL_FRAGMENT_SHADER);
+    Shader::processShader(&atlasVertexShaderID, (resourceDirectory + atlasVertexShaderFilename).c_str(), GL_VERTEX_SHADER);
+    Shader::processShader(&atlasFragmentShaderID, (resourceDirectory + atlasFragmentShaderFilename).c_str(), GL_FRAGMENT_SHADER);
 
-    programID = GL_CHECK(glCreateProgram());
-    if (!programID)
+    memset(methods, 0, sizeof(methods));
+    textureManager.clear();
+    for (int method = 0; method < NUMBER_OF_ALPHA_METHODS; method++)
     {
-        LOGE("Could not create program.");
-        return false;
+        methods[method].textureHandle = -1;
+        methods[method].alphaTextureHandle = -1;
     }
-    GL_CHECK(glAttachShader(programID, vertexShaderID));
-    GL_CHECK(glAttachShader(programID, fragmentShaderID));
-    GL_CHECK(glLinkProgram(programID));
-    GL_CHECK(glUseProgram(programID));
+    int width = 0;
+    int height = 0;
+    getPKMSize(texturePath + "0" + imageExtension, &width, &height);
+    unsigned int colourMemory = getMipmapChainSize(width, height, 4, 8);
 
-    /* Vertex positions. */
-    iLocPosition = GL_CHECK(glGetAttribLocation(programID, "a_v4Position"));
-    if(iLocPosition == -1)
+    /* Initialize textures using separate files */
+    AlphaMethodResources &compressed = methods[ALPHA_METHOD_COMPRESSED];
+    compressed.name = "ETC1 with separate ETC1 alpha";
+    compressed.textureHandle = textureManager.addCompressedMipmaps(texturePath.c_str(), imageExtension.c_str());
+    compressed.alphaTextureHandle = textureManager.addCompressedMipmaps(texturePath.c_str(), alphaExtension.c_str());
+    compressed.textureMemory = 2 * colourMemory;
+    compressed.supported = compressed.textureHandle != -1 && compressed.alphaTextureHandle != -1 &&
+                           createProgram(vertexShaderID, fragmentShaderID, &compressed);
+
+    /* The same colour texture, alpha from an uncompressed image mipmapped by the driver. */
+    AlphaMethodResources &uncompressed = methods[ALPHA_METHOD_UNCOMPRESSED];
+    uncompressed.name = "ETC1 with separate uncompressed alpha";
+    vector<unsigned char> alpha;
+    int alphaWidth = 0;
+    int alphaHeight = 0;
+    if (loadPGM(resourceDirectory + uncompressedAlphaFilename, &alpha, &alphaWidth, &alphaHeight))
     {
-        LOGE("Error: Attribute not found: \"a_v4Position\"");
-        exit(1);
+        uncompressed.textureHandle = compressed.textureHandle;
+        GL_CHECK(glGenTextures(1, &uncompressed.alphaTextureID));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, uncompressed.alphaTextureID));
+        GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, alphaWidth, alphaHeight, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, &alpha[0]));
+        GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
+        uncompressed.alphaTextureHandle = textureManager.addTexture(uncompressed.alphaTextureID, getMipmapChainSize(alphaWidth, alphaHeight, 1, 1));
+        uncompressed.textureMemory = colourMemory + getMipmapChainSize(alphaWidth, alphaHeight, 1, 1);
+        uncompressed.supported = uncompressed.textureHandle != -1 && createProgram(vertexShaderID, fragmentShaderID, &uncompressed);
     }
-    GL_CHECK(glEnableVertexAttribArray(iLocPosition));
 
-    /* Texture coordinates. */
-    iLocTexCoord = GL_CHECK(glGetAttribLocation(programID, "a_v2TexCoord"));
-    if(iLocTexCoord == -1)
+    /* One texture twice the height, the atlas shaders read colour and alpha from its two halves. */
+    AlphaMethodResources &atlas = methods[ALPHA_METHOD_ATLAS];
+    atlas.name = "ETC1 atlas of colour and alpha";
+    atlas.textureHandle = textureManager.addCompressedMipmaps(atlasPath.c_str(), imageExtension.c_str());
+    getPKMSize(atlasPath + "0" + imageExtension, &width, &height);
+    atlas.textureMemory = getMipmapChainSize(width, height, 4, 8);
+    atlas.supported = atlas.textureHandle != -1 && createProgram(atlasVertexShaderID, atlasFragmentShaderID, &atlas);
+
+    /*
+     * ETC2 is core in OpenGL ES 3.0, where drivers may not list it, and the Android view can be given a 3.x
+     * context for the 2.0 it asks for. Otherwise it needs to be listed as a compressed format.
+     */
+    AlphaMethodResources &etc2 = methods[ALPHA_METHOD_ETC2_EAC];
+    etc2.name = "ETC2 RGBA8 with EAC alpha";
+    const char *version = (const char *)GL_CHECK(glGetString(GL_VERSION));
+    bool etc2Supported = TextureFormatSelector::isFormatSupported(GL_COMPRESSED_RGBA8_ETC2_EAC) ||
+                         (version != NULL && strncmp(version, "OpenGL ES 3", 11) == 0);
+    if (!etc2Supported)
     {
-        LOGD("Warning: Attribute not found: \"a_v2TexCoord\"");
+        LOGI("GL_COMPRESSED_RGBA8_ETC2_EAC is not supported, \"%s\" is left out of the benchmark.", etc2.name);
     }
-    else
+    else if (!alpha.empty() && loadETC2EACMipmaps(texturePath, alpha, alphaWidth, alphaHeight, &etc2.textureID))
     {
-        GL_CHECK(glEnableVertexAttribArray(iLocTexCoord));
+        etc2.textureMemory = getMipmapChainSize(alphaWidth, alphaHeight, 4, 16);
+        etc2.textureHandle = textureManager.addTexture(etc2.textureID, etc2.textureMemory);
+        etc2.supported = createProgram(vertexShaderID, singleFragmentShaderID, &etc2);
     }
 
-    /* Set the sampler to point at the 0th texture unit. */
-    iLocSampler = GL_CHECK(glGetUniformLocation(programID, "u_s2dTexture"));
-    if(iLocSampler == -1)
+    /*
+     * All the textures of the sample fit on any device, so rather than the budget of the device the manager gets
+     * the textures it cannot shrink plus the larger of the ETC1 methods. The mipmaps of the method which is not
+     * running are then dropped, and restored when it runs again.
+     */
+    size_t unmanagedMemory = 0;
+    if (uncompressed.alphaTextureHandle != -1)
     {
-        LOGD("Warning: Uniform not found: \"u_s2dTexture\"");
+        unmanagedMemory += uncompressed.textureMemory - colourMemory;
     }
-    else
+    if (etc2.textureHandle != -1)
     {
-        GL_CHECK(glUniform1i(iLocSampler, 0));
+        unmanagedMemory += etc2.textureMemory;
     }
+    textureManager.setBudget(unmanagedMemory + (compressed.textureMemory > atlas.textureMemory ? compressed.textureMemory : atlas.textureMemory));
 
-    /* Set the alpha sampler to point at the 1st texture unit. */
-    iLocAlphaSampler = GL_CHECK(glGetUniformLocation(programID, "u_s2dAlpha"));
-    if(iLocAlphaSampler == -1)
-    {
-        LOGE("Uniform not found at line %i\n", __LINE__);
-        exit(1);
-    }
-    GL_CHECK(glUniform1i(iLocAlphaSampler,1));
+    setupLayers();
 
+    currentMethod = ALPHA_METHOD_COMPRESSED;
+    methodTime = 0.0f;
+    methodReadBytes = 0.0;
+    methodCounterSamples = 0;
+    methodStarted = false;
 
     /* Set clear screen color. */
     GL_CHECK(glClearColor(0.125f, 0.25f, 0.5f, 1.0));
@@ -163,27 +618,111 @@ bool setupGraphics(int w, int h)
     return true;
 }
 
-void renderFrame(void)
+static void drawScene(AlphaMethodResources &method)
 {
-    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    /* The names of the managed textures change as their mipmaps are dropped and restored. */
+    if (method.textureHandle != -1)
+    {
+        method.textureID = textureManager.use(method.textureHandle);
+    }
+    if (method.alphaTextureHandle != -1)
+    {
+        method.alphaTextureID = textureManager.use(method.alphaTextureHandle);
+    }
 
-    GL_CHECK(glUseProgram(programID));
+    GL_CHECK(glUseProgram(method.programID));
 
-    /* Pass the plane vertices to the shader. */
-    GL_CHECK(glVertexAttribPointer(iLocPosition, 3, GL_FLOAT, GL_FALSE, 0, vertices));
+    GL_CHECK(glActiveTexture(GL_TEXTURE1));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, method.alphaTextureID));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, method.textureID));
+
+    GL_CHECK(glEnableVertexAttribArray(method.iLocPosition));
+    if(method.iLocTexCoord != -1)
+    {
+        GL_CHECK(glEnableVertexAttribArray(method.iLocTexCoord));
+    }
 
-    GL_CHECK(glEnableVertexAttribArray(iLocPosition));
+    /* The layers of tiles. */
+    GL_CHECK(glVertexAttribPointer(method.iLocPosition, 2, GL_FLOAT, GL_FALSE, 0, &layerVertices[0]));
+    if(method.iLocTexCoord != -1)
+    {
+        GL_CHECK(glVertexAttribPointer(method.iLocTexCoord, 2, GL_FLOAT, GL_FALSE, 0, &layerTextureCoordinates[0]));
+    }
+    GL_CHECK(glDrawElements(GL_TRIANGLES, layerIndices.size(), GL_UNSIGNED_SHORT, &layerIndices[0]));
 
-    if(iLocTexCoord != -1)
+    /* Pass the plane vertices to the shader. */
+    GL_CHECK(glVertexAttribPointer(method.iLocPosition, 3, GL_FLOAT, GL_FALSE, 0, vertices));
+    if(method.iLocTexCoord != -1)
     {
         /* Pass the texture coordinates to the shader. */
-        GL_CHECK(glVertexAttribPointer(iLocTexCoord, 2, GL_FLOAT, GL_FALSE, 0, textureCoordinates));
-        GL_CHECK(glEnableVertexAttribArray(iLocTexCoord));
+        GL_CHECK(glVertexAttribPointer(method.iLocTexCoord, 2, GL_FLOAT, GL_FALSE, 0, textureCoordinates));
     }
-
     GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, sizeof(indices) / sizeof(GLubyte), GL_UNSIGNED_BYTE, indices));
 }
 
+/* Report the method that has been running and start measuring the next supported one. */
+static void nextMethod(void)
+{
+    const AlphaMethodResources &current = methods[currentMethod];
+
+    LOGI("%s: %u bytes of texture memory", current.name, current.textureMemory);
+    textureManager.logResidency(current.name);
+    if (gpuCounters->isSupported() && methodCounterSamples > 0)
+    {
+        LOGI("%s: %.0f bytes read from external memory per frame", current.name, methodReadBytes / methodCounterSamples);
+    }
+    frameStatistics.log(current.name);
+    frameStatistics.reset();
+
+    for (int step = 1; step <= NUMBER_OF_ALPHA_METHODS; step++)
+    {
+        AlphaMethod method = (AlphaMethod)((currentMethod + step) % NUMBER_OF_ALPHA_METHODS);
+        if (methods[method].supported)
+        {
+            currentMethod = method;
+            break;
+        }
+    }
+
+    methodTime = 0.0f;
+    methodReadBytes = 0.0;
+    methodCounterSamples = 0;
+    methodStarted = false;
+}
+
+void renderFrame(void)
+{
+    if (!methods[currentMethod].supported)
+    {
+        return;
+    }
+
+    float deltaTime = timer.getInterval();
+    frameStatistics.frame();
+    gpuCounters->sample();
+
+    /* The counters read at the start of a method's first frame still belong to the method before. */
+    if (methodStarted)
+    {
+        methodReadBytes += gpuCounters->getExternalReadBytes();
+        methodCounterSamples++;
+    }
+    methodStarted = true;
+
+    textureManager.update();
+
+    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+    drawScene(methods[currentMethod]);
+
+    methodTime += deltaTime;
+    if (methodTime > methodDuration)
+    {
+        nextMethod();
+    }
+}
+
 extern "C"
 {
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_etccompressedalpha_ETCCompressedAlpha_init
@@ -192,10 +731,15 @@ extern "C"
         /* Make sure that all resource files are in place. */
         AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), vertexShaderFilename.c_str());
         AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), fragmentShaderFilename.c_str());
+        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), singleFragmentShaderFilename.c_str());
+        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), atlasVertexShaderFilename.c_str());
+        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), atlasFragmentShaderFilename.c_str());
+        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), uncompressedAlphaFilename.c_str());
 
-        /* Load all image assets and alpha files from 0 to 8 */
+        /* Load all image assets, alpha files and atlas files from 0 to 8 */
         string texturePathFull = textureFilename + "0" + imageExtension;
         string alphaPathFull = textureFilename + "0" + alphaExtension;
+        string atlasPathFull = atlasFilename + "0" + imageExtension;
         int numberOfImages = 9;
         for(int allImages = 0; allImages < numberOfImages; allImages++)
         {
@@ -203,9 +747,19 @@ extern "C"
             imageNumber << allImages;
             texturePathFull.replace(textureFilename.length(), 1, imageNumber.str());
             alphaPathFull.replace(textureFilename.length(), 1, imageNumber.str());
+            atlasPathFull.replace(atlasFilename.length(), 1, imageNumber.str());
             AndroidPlatform::getAndroidAsset(env,  resourceDirectory.c_str(), texturePathFull.c_str());
             AndroidPlatform::getAndroidAsset(env,  resourceDirectory.c_str(), alphaPathFull.c_str());
+            AndroidPlatform::getAndroidAsset(env,  resourceDirectory.c_str(), atlasPathFull.c_str());
+        }
+
+        /* Counting keeps running across a context loss, only start it once. */
+        if (!gpuCounters)
+        {
+            gpuCounters = new GPUCounters;
         }
+        timer.reset();
+        frameStatistics.reset();
 
         setupGraphics(width, height);
     }
@@ -219,6 +773,7 @@ extern "C"
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_etccompressedalpha_ETCCompressedAlpha_uninit
     (JNIEnv *, jclass)
     {
-
+        delete gpuCounters;
+        gpuCounters = NULL;
     }
 }
@@ -26,6 +26,7 @@
  * The sample demonstrates three techniques controlled by 
  * the LOAD_MIPMAPS and DISABLE_MIPMAPS defines: 
  * - loading compressed mipmaps from a file (\#define LOAD_MIPMAPS \#undef DISABLE_MIPMAPS),
+ *   streamed in smallest level first by a CompressedMipmapLoader so the texture shows from the first frame,
  * - loading a compressed base image from a file and using glGenerateMipmap() to generate the mipmap levels (\#undef LOAD_MIPMAPS \#undef DISABLE_MIPMAPS),
  * - loading a compressed base image from a file and disabling mipmaps (\#undef LOAD_MIPMAPS \#define DISABLE_MIPMAPS).
  */
@@ -43,6 +44,7 @@
 #include <android/log.h>
 
 #include "ETCMipmap.h"
+#include "CompressedMipmapLoader.h"
 #include "Shader.h"
 #include "Text.h"
 #include "Texture.h"
@@ -62,6 +64,9 @@ string fragmentShaderFilename = "ETCMipmap_texture.frag";
 
 /* Texture variables. */
 GLuint textureID = 0;
+#ifdef LOAD_MIPMAPS
+CompressedMipmapLoader *textureLoader = NULL;
+#endif /* LOAD_MIPMAPS */
 
 /* Shader variables. */
 GLuint vertexShaderID = 0;
@@ -111,8 +116,14 @@ bool setupGraphics(int w, int h)
      * as Mipmap is on by default.
      */
 #ifdef LOAD_MIPMAPS
-    /* Load all Mipmap levels from files. */
-    Texture::loadCompressedMipmaps(texturePath.c_str(), imageExtension.c_str(), &textureID);
+    /* Load all Mipmap levels from files, the larger levels are read in the background and uploaded by renderFrame(). */
+    delete textureLoader;
+    textureLoader = new CompressedMipmapLoader;
+    if (!textureLoader->start(texturePath, imageExtension))
+    {
+        return false;
+    }
+    textureID = textureLoader->getTexture();
 #else /* LOAD_MIPMAPS */
     /* Load just base level texture data. */
     GL_CHECK(glGenTextures(1, &textureID));
@@ -208,6 +219,13 @@ void renderFrame(void)
 
     /* Ensure the correct texture is bound to texture unit 0. */
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
+#ifdef LOAD_MIPMAPS
+    /* Refine the texture by one Mipmap level while the larger ones are still coming in. */
+    if (textureLoader != NULL && !textureLoader->isComplete() && textureLoader->update())
+    {
+        LOGI("All %s Mipmap levels are in.\n", textureFilename.c_str());
+    }
+#endif /* LOAD_MIPMAPS */
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, textureID));
 
     GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, sizeof(indices) / sizeof(GLubyte), GL_UNSIGNED_BYTE, indices));
@@ -221,19 +239,26 @@ extern "C"
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_etcmipmap_ETCMipmap_init
     (JNIEnv *env, jclass jcls, jint width, jint height)
     {
-        /* Make sure that all resource files are in place. */
-        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), vertexShaderFilename.c_str());
-        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), fragmentShaderFilename.c_str());
-        
-        /* Load all image assets from 0 to 8 */
-        string texturePathFull = textureFilename + "0" + imageExtension;        
-        int numberOfImages = 9;
-        for(int allImages = 0; allImages < numberOfImages; allImages++)
+        /*
+         * Everything is read through AssetFile, so it can stay in the APK.
+         * Hosted by NativeHost there is no JNIEnv, and the host has already set up AssetFile.
+         */
+        if (env != NULL)
         {
-            stringstream imageNumber;
-            imageNumber << allImages;
-            texturePathFull.replace(textureFilename.length(), 1, imageNumber.str());
-            AndroidPlatform::getAndroidAsset(env,  resourceDirectory.c_str(), texturePathFull.c_str());
+            AndroidPlatform::useAPKAssets(env, resourceDirectory.c_str());
+            AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), vertexShaderFilename.c_str());
+            AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), fragmentShaderFilename.c_str());
+        
+            /* Load all image assets from 0 to 8 */
+            string texturePathFull = textureFilename + "0" + imageExtension;        
+            int numberOfImages = 9;
+            for(int allImages = 0; allImages < numberOfImages; allImages++)
+            {
+                stringstream imageNumber;
+                imageNumber << allImages;
+                texturePathFull.replace(textureFilename.length(), 1, imageNumber.str());
+                AndroidPlatform::getAndroidAsset(env,  resourceDirectory.c_str(), texturePathFull.c_str());
+            }
         }
 
         setupGraphics(width, height);
@@ -249,5 +274,9 @@ extern "C"
     (JNIEnv *, jclass)
     {
         delete text;
+#ifdef LOAD_MIPMAPS
+        delete textureLoader;
+        textureLoader = NULL;
+#endif /* LOAD_MIPMAPS */
     }
 }
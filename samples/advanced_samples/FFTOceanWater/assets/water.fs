@@ -24,6 +24,7 @@ precision mediump float;
 
 in highp vec3 vWorld;
 in highp vec4 vGradNormalTex;
+in highp vec4 vCascadeTex;
 
 mediump out vec3 FragColor;
 
@@ -32,10 +33,18 @@ layout(location = 4) uniform highp vec3 uCamPos;
 layout(binding = 1) uniform mediump sampler2D uGradJacobian;
 layout(binding = 2) uniform sampler2D uNormal;
 layout(binding = 3) uniform samplerCube uSkydome;
+layout(binding = 7) uniform mediump sampler2D uCascadeGradJacobian0;
+layout(binding = 8) uniform mediump sampler2D uCascadeGradJacobian1;
 
 void main()
 {
     vec3 vGradJacobian = texture(uGradJacobian, vGradNormalTex.xy).xyz;
+
+    // The detail cascades simulate the shorter waves, so their slopes add up.
+    // Their jacobians stay close to 1, adding how far they are from it approximates the jacobian of the sum.
+    vec3 cascade0 = texture(uCascadeGradJacobian0, vCascadeTex.xy).xyz;
+    vec3 cascade1 = texture(uCascadeGradJacobian1, vCascadeTex.zw).xyz;
+    vGradJacobian += vec3(cascade0.xy + cascade1.xy, cascade0.z + cascade1.z - 2.0);
     vec2 noise_gradient = 0.30 * texture(uNormal, vGradNormalTex.zw).xy;
 
     float jacobian = vGradJacobian.z;
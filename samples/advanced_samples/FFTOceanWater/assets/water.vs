@@ -31,11 +31,21 @@ layout(location = 6) uniform mediump vec2 uInvHeightmapSize;
 layout(binding = 0) uniform mediump sampler2D uHeightmapDisplacement;
 layout(binding = 4) uniform mediump sampler2D uLod;
 
+// Detail cascades of FFTWater, sampled in world space. Must match Mesh::detail_cascades.
+#define DETAIL_CASCADES 2
+// .xy = world space to UV, .zw = texel size in UV.
+layout(location = 16) uniform vec4 uCascadeScale[DETAIL_CASCADES];
+// Mipmap level of the cascades at the heightmap's level 0, from their texel size and the heightmap's.
+layout(location = 18) uniform mediump float uCascadeLodBias[DETAIL_CASCADES];
+layout(binding = 5) uniform mediump sampler2D uCascadeHeightDisplacement0;
+layout(binding = 6) uniform mediump sampler2D uCascadeHeightDisplacement1;
+
 layout(location = 0) in uvec4 aPosition;
 layout(location = 1) in vec4 aLODWeights; 
 
 out highp vec3 vWorld;
 out highp vec4 vGradNormalTex;
+out highp vec4 vCascadeTex;
 
 struct PatchData
 {
@@ -97,6 +107,13 @@ mediump vec3 sample_height_displacement(vec2 uv, vec2 off, mediump vec2 lod)
             lod.y);
 }
 
+// The cascades are filtered down to the vertex spacing with mipmaps, so the shorter waves do not alias.
+mediump vec3 sample_cascade(mediump sampler2D tex, vec2 world, vec4 scale, mediump float level)
+{
+    level = max(level, 0.0);
+    return textureLod(tex, world * scale.xy + 0.5 * exp2(level) * scale.zw, level).xyz;
+}
+
 void main()
 {
     vec2 pos = warp_position();
@@ -112,6 +129,13 @@ void main()
     vGradNormalTex = vec4(tex + 0.5 * uInvHeightmapSize, tex * uScale.zw);
     vec3 height_displacement = sample_height_displacement(tex, off, lod);
 
+    mediump float level = lod.x + lod.y;
+    height_displacement += sample_cascade(uCascadeHeightDisplacement0, pos, uCascadeScale[0], level + uCascadeLodBias[0]);
+    height_displacement += sample_cascade(uCascadeHeightDisplacement1, pos, uCascadeScale[1], level + uCascadeLodBias[1]);
+    vCascadeTex = vec4(
+            pos * uCascadeScale[0].xy + 0.5 * uCascadeScale[0].zw,
+            pos * uCascadeScale[1].xy + 0.5 * uCascadeScale[1].zw);
+
     pos += height_displacement.yz;
     vWorld = vec3(pos.x, height_displacement.x, pos.y);
     gl_Position = uMVP * vec4(vWorld, 1.0);
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <stdexcept>
 #include <numeric>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <assert.h>
@@ -949,9 +950,14 @@ GLuint FFT::compile_compute_shader(const char *src)
         return 0;
     }
 
-    GL_CHECK(GLuint shader = glCreateShader(GL_COMPUTE_SHADER));
-
+    // The sources are generated from the parameters, so a stored binary for the same sources is the same program.
     const char *sources[] = { GLFFT_GLSL_LANG_STRING, src };
+    if (glfft_load_program(program, sources, 2))
+    {
+        return program;
+    }
+
+    GL_CHECK(GLuint shader = glCreateShader(GL_COMPUTE_SHADER));
     GL_CHECK(glShaderSource(shader, 2, sources, NULL));
     GL_CHECK(glCompileShader(shader));
 
@@ -973,6 +979,7 @@ GLuint FFT::compile_compute_shader(const char *src)
     }
 
     GL_CHECK(glAttachShader(program, shader));
+    glfft_prepare_program(program);
     GL_CHECK(glLinkProgram(program));
     GL_CHECK(glDeleteShader(shader));
 
@@ -991,6 +998,7 @@ GLuint FFT::compile_compute_shader(const char *src)
         return 0;
     }
 
+    glfft_store_program(program, sources, 2);
     return program;
 }
 
@@ -1025,154 +1033,218 @@ double FFT::bench(GLuint output, GLuint input,
     return total_time / runs;
 }
 
-void FFT::process(GLuint output, GLuint input, GLuint input_aux)
+void FFT::begin_process(ProcessState &state, GLuint output, GLuint input, GLuint input_aux) const
 {
-    if (passes.empty())
+    state.output = output;
+    state.input = input;
+    state.input_aux = input_aux;
+    state.p = 1;
+    state.buffers[0] = input;
+    state.buffers[1] = passes.size() & 1 ?
+        (passes.back().parameters.output_target != SSBO ? temp_buffer_image.get() : output) :
+        temp_buffer.get();
+}
+
+void FFT::bind_input_aux(GLuint input_aux) const
+{
+    if (passes.front().parameters.input_target != SSBO)
     {
-        return;
+        GL_CHECK(glActiveTexture(GL_TEXTURE1));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, input_aux));
+        GL_CHECK(glBindSampler(1, texture.samplers[1]));
     }
-
-    GLuint buffers[2] = {
-        input,
-        passes.size() & 1 ?
-            (passes.back().parameters.output_target != SSBO ? temp_buffer_image.get() : output) :
-            temp_buffer.get(),
-    };
-
-    if (input_aux != 0)
+    else
     {
-        if (passes.front().parameters.input_target != SSBO)
+        if (ssbo.input_aux.size != 0)
         {
-            GL_CHECK(glActiveTexture(GL_TEXTURE1));
-            GL_CHECK(glBindTexture(GL_TEXTURE_2D, input_aux));
-            GL_CHECK(glBindSampler(1, texture.samplers[1]));
+            GL_CHECK(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, input_aux,
+                    ssbo.input_aux.offset, ssbo.input_aux.size));
         }
         else
         {
-            if (ssbo.input_aux.size != 0)
-            {
-                GL_CHECK(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, input_aux,
-                        ssbo.input_aux.offset, ssbo.input_aux.size));
-            }
-            else
-            {
-                GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, input_aux));
-            }
+            GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, input_aux));
         }
     }
+}
 
-    GLuint current_program = 0;
-    unsigned p = 1;
-    unsigned pass_index = 0;
-    for (auto &pass : passes)
+void FFT::dispatch_pass(ProcessState &state, unsigned pass_index, GLuint &current_program) const
+{
+    auto &pass = passes[pass_index];
+    GLuint *buffers = state.buffers;
+
+    if (pass.program != current_program)
     {
-        if (pass.program != current_program)
+        GL_CHECK(glUseProgram(pass.program));
+        current_program = pass.program;
+    }
+
+    if (pass.parameters.p1)
+    {
+        state.p = 1;
+    }
+    else
+    {
+        glUniform1ui(0, state.p);
+    }
+
+    state.p *= pass.parameters.radix;
+
+    if (pass.parameters.input_target != SSBO)
+    {
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, buffers[0]));
+        GL_CHECK(glBindSampler(0, texture.samplers[0]));
+
+        // If one compute thread reads multiple texels in X dimension, scale this accordingly.
+        float scale_x = texture.scale_x * pass.uv_scale_x;
+        GL_CHECK(glUniform2f(1, texture.offset_x, texture.offset_y));
+        GL_CHECK(glUniform2f(2, scale_x, texture.scale_y));
+    }
+    else
+    {
+        if (buffers[0] == state.input && ssbo.input.size != 0)
         {
-            GL_CHECK(glUseProgram(pass.program));
-            current_program = pass.program;
+            GL_CHECK(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, buffers[0],
+                    ssbo.input.offset, ssbo.input.size));
         }
-
-        if (pass.parameters.p1)
+        else if (buffers[0] == state.output && ssbo.output.size != 0)
         {
-            p = 1;
+            // This can behave weirdly if output is an image and our temp buffers GLuint aliases with
+            // the output texture name, but we shouldn't set ssbo.output.size in this case anyways.
+            GL_CHECK(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, buffers[0],
+                    ssbo.output.offset, ssbo.output.size));
         }
         else
         {
-            glUniform1ui(0, p);
+            GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers[0]));
         }
+    }
 
-        p *= pass.parameters.radix;
+    if (pass.parameters.output_target != SSBO)
+    {
+        GLenum format = 0;
 
-        if (pass.parameters.input_target != SSBO)
+        // TODO: Make this more flexible, would require shader variants per-format though.
+        if (pass.parameters.output_target == ImageReal)
         {
-            GL_CHECK(glActiveTexture(GL_TEXTURE0));
-            GL_CHECK(glBindTexture(GL_TEXTURE_2D, buffers[0]));
-            GL_CHECK(glBindSampler(0, texture.samplers[0]));
-
-            // If one compute thread reads multiple texels in X dimension, scale this accordingly.
-            float scale_x = texture.scale_x * pass.uv_scale_x;
-            GL_CHECK(glUniform2f(1, texture.offset_x, texture.offset_y));
-            GL_CHECK(glUniform2f(2, scale_x, texture.scale_y));
+            format = GL_R32F;
         }
         else
         {
-            if (buffers[0] == input && ssbo.input.size != 0)
-            {
-                GL_CHECK(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, buffers[0],
-                        ssbo.input.offset, ssbo.input.size));
-            }
-            else if (buffers[0] == output && ssbo.output.size != 0)
+            switch (pass.parameters.mode)
             {
-                // This can behave weirdly if output is an image and our temp buffers GLuint aliases with
-                // the output texture name, but we shouldn't set ssbo.output.size in this case anyways.
-                GL_CHECK(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, buffers[0],
-                        ssbo.output.offset, ssbo.output.size));
-            }
-            else
-            {
-                GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers[0]));
+                case VerticalDual:
+                case HorizontalDual:
+                    format = GL_RGBA16F;
+                    break;
+
+                case Vertical:
+                case Horizontal:
+                case ResolveRealToComplex:
+                    format = GL_R32UI;
+                    break;
+
+                default:
+                    break;
             }
         }
-
-        if (pass.parameters.output_target != SSBO)
+        GL_CHECK(glBindImageTexture(0, state.output, 0, GL_FALSE, 0, GL_WRITE_ONLY, format));
+    }
+    else
+    {
+        if (buffers[1] == state.output && ssbo.output.size != 0)
         {
-            GLenum format = 0;
-
-            // TODO: Make this more flexible, would require shader variants per-format though.
-            if (pass.parameters.output_target == ImageReal)
-            {
-                format = GL_R32F;
-            }
-            else
-            {
-                switch (pass.parameters.mode)
-                {
-                    case VerticalDual:
-                    case HorizontalDual:
-                        format = GL_RGBA16F;
-                        break;
-
-                    case Vertical:
-                    case Horizontal:
-                    case ResolveRealToComplex:
-                        format = GL_R32UI;
-                        break;
-
-                    default:
-                        break;
-                }
-            }
-            GL_CHECK(glBindImageTexture(0, output, 0, GL_FALSE, 0, GL_WRITE_ONLY, format));
+            GL_CHECK(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, buffers[1],
+                    ssbo.output.offset, ssbo.output.size));
         }
         else
         {
-            if (buffers[1] == output && ssbo.output.size != 0)
-            {
-                GL_CHECK(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, buffers[1],
-                        ssbo.output.offset, ssbo.output.size));
-            }
-            else
-            {
-                GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffers[1]));
-            }
+            GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffers[1]));
         }
+    }
 
-        GL_CHECK(glDispatchCompute(pass.workgroups_x, pass.workgroups_y, 1));
+    GL_CHECK(glDispatchCompute(pass.workgroups_x, pass.workgroups_y, 1));
+
+    if (pass_index == 0)
+    {
+        buffers[0] = passes.size() & 1 ?
+            temp_buffer.get() :
+            (passes.back().parameters.output_target != SSBO ? temp_buffer_image.get() : state.output);
+    }
 
-        if (pass.barriers != 0)
+    swap(buffers[0], buffers[1]);
+}
+
+void FFT::process(GLuint output, GLuint input, GLuint input_aux)
+{
+    if (passes.empty())
+    {
+        return;
+    }
+
+    ProcessState state;
+    begin_process(state, output, input, input_aux);
+
+    if (input_aux != 0)
+    {
+        bind_input_aux(input_aux);
+    }
+
+    GLuint current_program = 0;
+    for (unsigned pass_index = 0; pass_index < passes.size(); pass_index++)
+    {
+        dispatch_pass(state, pass_index, current_program);
+
+        GLbitfield barriers = passes[pass_index].barriers;
+        if (barriers != 0)
+        {
+            GL_CHECK(glMemoryBarrier(barriers));
+        }
+    }
+}
+
+void FFT::process_batch(const BatchJob *jobs, unsigned count)
+{
+    vector<ProcessState> states(count);
+    unsigned max_passes = 0;
+    for (unsigned i = 0; i < count; i++)
+    {
+        const FFT &fft = *jobs[i].fft;
+        if (jobs[i].input_aux != 0)
         {
-            GL_CHECK(glMemoryBarrier(pass.barriers));
+            throw logic_error("Convolution transforms cannot be batched.");
         }
 
-        if (pass_index == 0)
+        if (fft.passes.empty())
         {
-            buffers[0] = passes.size() & 1 ?
-                temp_buffer.get() :
-                (passes.back().parameters.output_target != SSBO ? temp_buffer_image.get() : output);
+            continue;
+        }
+
+        fft.begin_process(states[i], jobs[i].output, jobs[i].input, 0);
+        max_passes = max<unsigned>(max_passes, fft.passes.size());
+    }
+
+    // Issue pass N of every transform before waiting on any of them.
+    // The transforms only touch their own temporary buffers, so dispatches within a step are independent
+    // and one barrier per step replaces the per-transform barriers process() would have issued.
+    GLuint current_program = 0;
+    for (unsigned pass_index = 0; pass_index < max_passes; pass_index++)
+    {
+        GLbitfield barriers = 0;
+        for (unsigned i = 0; i < count; i++)
+        {
+            const FFT &fft = *jobs[i].fft;
+            if (pass_index < fft.passes.size())
+            {
+                fft.dispatch_pass(states[i], pass_index, current_program);
+                barriers |= fft.passes[pass_index].barriers;
+            }
         }
 
-        swap(buffers[0], buffers[1]);
-        pass_index++;
+        if (barriers != 0)
+        {
+            GL_CHECK(glMemoryBarrier(barriers));
+        }
     }
 }
 
@@ -87,6 +87,27 @@ class FFT
         ///                  the content of input and input_aux will be multiplied together.
         void process(GLuint output, GLuint input, GLuint input_aux = 0);
 
+        /// @brief A single transform to run as part of process_batch().
+        struct BatchJob
+        {
+            FFT *fft;          ///< The FFT to process.
+            GLuint output;     ///< Output buffer or image, as in process().
+            GLuint input;      ///< Input buffer or texture, as in process().
+            GLuint input_aux;  ///< Must be 0, convolution transforms cannot be batched.
+        };
+
+        /// @brief Process several independent FFTs as one interleaved sequence of dispatches.
+        ///
+        /// Pass N of every FFT is dispatched before pass N + 1 of any of them,
+        /// so the GPU can overlap the transforms and a single glMemoryBarrier is issued per pass
+        /// instead of one per pass per FFT.
+        /// The FFTs may have different sizes, types and pass counts.
+        /// Outputs must not alias inputs or outputs of other jobs in the batch.
+        ///
+        /// @param jobs  Array of transforms to run.
+        /// @param count Number of entries in jobs.
+        static void process_batch(const BatchJob *jobs, unsigned count);
+
         /// @brief Run process() multiple times, timing the results.
         ///
         /// Mostly used internally by GLFFT wisdom, glfft_cli's bench, and so on.
@@ -197,6 +218,19 @@ class FFT
 
         GLuint get_program(const Parameters &params);
 
+        struct ProcessState
+        {
+            GLuint buffers[2];
+            GLuint input;
+            GLuint output;
+            GLuint input_aux;
+            unsigned p;
+        };
+
+        void begin_process(ProcessState &state, GLuint output, GLuint input, GLuint input_aux) const;
+        void bind_input_aux(GLuint input_aux) const;
+        void dispatch_pass(ProcessState &state, unsigned pass_index, GLuint &current_program) const;
+
         struct
         {
             float offset_x = 0.0f, offset_y = 0.0f, scale_x = 1.0f, scale_y = 1.0f;
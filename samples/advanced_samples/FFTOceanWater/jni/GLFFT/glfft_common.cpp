@@ -17,6 +17,8 @@
  */
 
 #include "glfft_common.hpp"
+#include "GPUMemory.h"
+#include <stdexcept>
 
 using namespace std;
 using namespace GLFFT;
@@ -25,6 +27,7 @@ Texture::~Texture()
 {
     if (name)
     {
+        GPUMemory::forget(GPUMemory::CATEGORY_TEXTURE, 1, &name);
         GL_CHECK(glDeleteTextures(1, &name));
     }
 }
@@ -38,6 +41,7 @@ void Texture::init(unsigned width, unsigned height, unsigned levels, GLenum inte
 {
     if (name)
     {
+        GPUMemory::forget(GPUMemory::CATEGORY_TEXTURE, 1, &name);
         GL_CHECK(glDeleteTextures(1, &name));
     }
     GL_CHECK(glGenTextures(1, &name));
@@ -48,6 +52,7 @@ void Texture::init(unsigned width, unsigned height, unsigned levels, GLenum inte
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+    GPUMemory::trackTexture(name, GPUMemory::computeTextureSize(internal_format, width, height, 1, levels), internal_format, "GLFFT");
 }
 
 void Texture::upload(const void *data, GLenum format, GLenum type,
@@ -69,7 +74,8 @@ Texture& Texture::operator=(Texture &&texture)
     {
         if (name)
         {
-            GL_CHECK(glDeleteTextures(1, &name));
+            GPUMemory::forget(GPUMemory::CATEGORY_TEXTURE, 1, &name);
+        GL_CHECK(glDeleteTextures(1, &name));
         }
         name = texture.name;
         texture.name = 0;
@@ -86,6 +92,7 @@ Buffer::~Buffer()
 {
     if (name)
     {
+        GPUMemory::forget(GPUMemory::CATEGORY_BUFFER, 1, &name);
         GL_CHECK(glDeleteBuffers(1, &name));
     }
 }
@@ -98,11 +105,13 @@ void Buffer::init(const void *data, size_t size, GLenum access)
 {
     if (name)
     {
+        GPUMemory::forget(GPUMemory::CATEGORY_BUFFER, 1, &name);
         GL_CHECK(glDeleteBuffers(1, &name));
     }
     GL_CHECK(glGenBuffers(1, &name));
     GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, name));
     GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, access));
+    GPUMemory::trackBuffer(name, size, access, "GLFFT");
 }
 
 Buffer& Buffer::operator=(Buffer &&buffer)
@@ -111,7 +120,8 @@ Buffer& Buffer::operator=(Buffer &&buffer)
     {
         if (name)
         {
-            GL_CHECK(glDeleteBuffers(1, &name));
+            GPUMemory::forget(GPUMemory::CATEGORY_BUFFER, 1, &name);
+        GL_CHECK(glDeleteBuffers(1, &name));
         }
         name = buffer.name;
         buffer.name = 0;
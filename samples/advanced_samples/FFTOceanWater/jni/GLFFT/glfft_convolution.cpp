@@ -0,0 +1,108 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "glfft_convolution.hpp"
+#include <stdexcept>
+
+using namespace std;
+using namespace GLFFT;
+
+// The spectra are written by one transform and read by another, so their formats must agree.
+// Kernels are uploaded as FP32, and the normalization is done by the kernel weights.
+static FFTOptions get_transform_options(const FFTOptions &options, bool input_fp16)
+{
+    FFTOptions transform_options = options;
+    transform_options.type.input_fp16 = input_fp16;
+    transform_options.type.normalize = false;
+    return transform_options;
+}
+
+Convolution::Convolution(unsigned Nx, unsigned Ny,
+        std::shared_ptr<ProgramCache> cache, const FFTOptions &options, const FFTWisdom &wisdom)
+    : size_x(Nx), size_y(Ny),
+    spectrum_size((Nx * Ny * 4 * sizeof(float)) >> options.type.output_fp16),
+    forward(Nx, Ny, ComplexToComplexDual, Forward, Image, SSBO,
+            cache, get_transform_options(options, false), wisdom),
+    forward_kernel(Nx, Ny, ComplexToComplexDual, Forward, SSBO, SSBO,
+            cache, get_transform_options(options, false), wisdom),
+    inverse(Nx, Ny, ComplexToComplexDual, InverseConvolve, SSBO, Image,
+            cache, get_transform_options(options, options.type.output_fp16), wisdom)
+{
+    spectrum.init(nullptr, spectrum_size, GL_STREAM_COPY);
+}
+
+unsigned Convolution::add_kernel(const float *kernel, unsigned width, unsigned height)
+{
+    if (width > size_x || height > size_y)
+    {
+        throw logic_error("Convolution kernel is larger than the FFT.");
+    }
+
+    // Move the center of the kernel to the origin, wrapping the rest around the borders,
+    // so the convolution does not shift the image.
+    // A real kernel goes in both complex values of the dual transform, one per pair of channels.
+    // Forward and inverse transforms are both unnormalized, scale by 1 / N once here.
+    const float scale = 1.0f / (size_x * size_y);
+    vector<float> samples(size_x * size_y * 4);
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        unsigned wrapped_y = (y + size_y - height / 2) % size_y;
+        for (unsigned x = 0; x < width; x++)
+        {
+            unsigned wrapped_x = (x + size_x - width / 2) % size_x;
+            float *sample = &samples[4 * (wrapped_y * size_x + wrapped_x)];
+            sample[0] = kernel[y * width + x] * scale;
+            sample[2] = sample[0];
+        }
+    }
+
+    Buffer kernel_buffer;
+    kernel_buffer.init(samples.data(), samples.size() * sizeof(float), GL_STATIC_DRAW);
+
+    Buffer kernel_spectrum;
+    kernel_spectrum.init(nullptr, spectrum_size, GL_STATIC_COPY);
+    forward_kernel.process(kernel_spectrum.get(), kernel_buffer.get());
+
+    // convolve() reads the spectrum from an SSBO.
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+
+    kernel_spectra.push_back(move(kernel_spectrum));
+    return kernel_spectra.size() - 1;
+}
+
+void Convolution::transform_input(GLuint input)
+{
+    forward.process(spectrum.get(), input);
+
+    // convolve() reads the spectrum from an SSBO.
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+}
+
+void Convolution::convolve(GLuint output, unsigned kernel)
+{
+    if (kernel >= kernel_spectra.size())
+    {
+        throw logic_error("Invalid convolution kernel.");
+    }
+
+    // The first pass of the inverse transform multiplies the two spectra.
+    inverse.process(output, spectrum.get(), kernel_spectra[kernel].get());
+}
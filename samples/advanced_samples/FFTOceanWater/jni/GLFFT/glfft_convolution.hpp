@@ -0,0 +1,134 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GLFFT_CONVOLUTION_HPP__
+#define GLFFT_CONVOLUTION_HPP__
+
+#include "glfft.hpp"
+#include <vector>
+
+namespace GLFFT
+{
+
+/// @brief Convolves RGBA images with large kernels in the frequency domain.
+///
+/// The image is transformed once with a forward FFT, multiplied with the cached spectrum of a kernel
+/// and transformed back with an inverse FFT, so the cost is O(N log N) whatever the size of the kernel.
+/// A spatial blur costs O(N * radius) instead, which makes very wide kernels like lens glare impractical.
+///
+/// The convolution is circular: light reaching past one border of the image wraps around to the opposite one.
+/// Pad the image, e.g. with set_texture_offset_scale(), by at least the radius of the kernels to avoid this.
+///
+/// Typical usage:
+/// @code
+/// Convolution convolution(256, 256, cache, options);
+/// unsigned glare = convolution.add_kernel(weights, 129, 129);
+///
+/// convolution.transform_input(source_texture);
+/// convolution.convolve(output_texture, glare);
+/// glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+/// @endcode
+class Convolution
+{
+    public:
+        /// @brief Creates the transforms and the spectrum buffer.
+        ///
+        /// Will throw if invalid parameters are passed, as FFT does.
+        ///
+        /// @param Nx      Number of samples in horizontal dimension, must be POT.
+        /// @param Ny      Number of samples in vertical dimension, must be POT.
+        /// @param cache   A program cache for caching the GLFFT programs created.
+        /// @param options FFT options. The 1 / N normalization is folded into the kernel spectra,
+        ///                options.type.normalize is ignored.
+        /// @param wisdom  GLFFT wisdom which can override performance related options.
+        Convolution(unsigned Nx, unsigned Ny,
+                std::shared_ptr<ProgramCache> cache, const FFTOptions &options,
+                const FFTWisdom &wisdom = FFTWisdom());
+
+        /// @brief Transforms a kernel and caches its spectrum.
+        ///
+        /// The same real kernel is applied to all four channels.
+        /// Kernels are expected to be set up once, this uploads the kernel and runs a forward FFT.
+        ///
+        /// @param kernel Weights of the kernel, width * height values in rows.
+        ///               The center of the kernel is at (width / 2, height / 2).
+        /// @param width  Width of the kernel, at most Nx.
+        /// @param height Height of the kernel, at most Ny.
+        ///
+        /// @returns Index of the kernel to pass to convolve().
+        unsigned add_kernel(const float *kernel, unsigned width, unsigned height);
+
+        /// @brief Transforms the image to convolve.
+        ///
+        /// The spectrum is kept until the next call, so one image can be convolved with several kernels.
+        ///
+        /// @param input RGBA texture, sampled as set by set_texture_offset_scale() and set_sampler().
+        void transform_input(GLuint input);
+
+        /// @brief Convolves the image last passed to transform_input() with a kernel.
+        ///
+        /// As with FFT::process(), barriers for using the output are up to the caller.
+        ///
+        /// @param output Nx by Ny GL_RGBA16F texture, which must be using immutable storage.
+        /// @param kernel Index returned by add_kernel().
+        void convolve(GLuint output, unsigned kernel);
+
+        /// @brief Convolves an image with a kernel, as transform_input() followed by convolve().
+        void process(GLuint output, GLuint input, unsigned kernel)
+        {
+            transform_input(input);
+            convolve(output, kernel);
+        }
+
+        /// @brief Sets which part of the input texture is transformed, see FFT::set_texture_offset_scale().
+        void set_texture_offset_scale(float offset_x, float offset_y, float scale_x, float scale_y)
+        {
+            forward.set_texture_offset_scale(offset_x, offset_y, scale_x, scale_y);
+        }
+
+        /// @brief Sets a sampler object to be used for the input texture, see FFT::set_samplers().
+        void set_sampler(GLuint sampler)
+        {
+            forward.set_samplers(sampler);
+        }
+
+        /// @brief Returns number of kernels added.
+        unsigned get_num_kernels() const { return kernel_spectra.size(); }
+
+        /// @brief Returns Nx.
+        unsigned get_dimension_x() const { return size_x; }
+        /// @brief Returns Ny.
+        unsigned get_dimension_y() const { return size_y; }
+
+    private:
+        unsigned size_x, size_y;
+        size_t spectrum_size;
+
+        FFT forward;
+        FFT forward_kernel;
+        FFT inverse;
+
+        Buffer spectrum;
+        std::vector<Buffer> kernel_spectra;
+};
+
+}
+
+#endif
@@ -0,0 +1,538 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "glfft_cpu.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GLFFT_CPU_NEON 1
+#endif
+
+using namespace std;
+using namespace GLFFT;
+
+// exp(sign * 2 * pi * j * m / n) for the n / 2 first m, interleaved real and imaginary parts.
+static vector<float> build_twiddles(unsigned n, float sign)
+{
+    vector<float> twiddles(max(n, 2u));
+    for (unsigned m = 0; m < n / 2; m++)
+    {
+        double angle = sign * 2.0 * M_PI * m / n;
+        twiddles[2 * m + 0] = float(cos(angle));
+        twiddles[2 * m + 1] = float(sin(angle));
+    }
+    return twiddles;
+}
+
+// a + wb and a - wb for count complex values at a time.
+static void butterfly(float *out0, float *out1, const float *a, const float *b, float w_re, float w_im, unsigned count)
+{
+    unsigned t = 0;
+
+#if GLFFT_CPU_NEON
+    // Two complex values per vector. wb = (b.re * w.re - b.im * w.im, b.im * w.re + b.re * w.im).
+    const float w_im_signs[4] = { -w_im, w_im, -w_im, w_im };
+    const float32x4_t vw_re = vdupq_n_f32(w_re);
+    const float32x4_t vw_im = vld1q_f32(w_im_signs);
+
+    for (; t + 2 <= count; t += 2)
+    {
+        float32x4_t va = vld1q_f32(a + 2 * t);
+        float32x4_t vb = vld1q_f32(b + 2 * t);
+        float32x4_t wb = vmlaq_f32(vmulq_f32(vb, vw_re), vrev64q_f32(vb), vw_im);
+        vst1q_f32(out0 + 2 * t, vaddq_f32(va, wb));
+        vst1q_f32(out1 + 2 * t, vsubq_f32(va, wb));
+    }
+#endif
+
+    for (; t < count; t++)
+    {
+        float wb_re = b[2 * t + 0] * w_re - b[2 * t + 1] * w_im;
+        float wb_im = b[2 * t + 1] * w_re + b[2 * t + 0] * w_im;
+        out0[2 * t + 0] = a[2 * t + 0] + wb_re;
+        out0[2 * t + 1] = a[2 * t + 1] + wb_im;
+        out1[2 * t + 0] = a[2 * t + 0] - wb_re;
+        out1[2 * t + 1] = a[2 * t + 1] - wb_im;
+    }
+}
+
+// Radix-2 Stockham autosort transforms of count sequences of n complex values side by side,
+// element j of sequence t at complex offset j * stride + t. This is the same butterfly the radix-2 GPU shaders do,
+// scratch must hold n * stride complex values.
+static void fft_batched(float *data, float *scratch, unsigned n, unsigned count, unsigned stride, const float *twiddles)
+{
+    float *x = data;
+    float *y = scratch;
+    unsigned half = n / 2;
+
+    for (unsigned p = 1; p < n; p *= 2)
+    {
+        for (unsigned i = 0; i < half; i++)
+        {
+            // exp(-+ pi * j * k / p), from the table of exp(-+ 2 * pi * j * m / n).
+            unsigned k = i & (p - 1);
+            unsigned out = 2 * i - k;
+            const float *w = &twiddles[2 * k * (half / p)];
+
+            butterfly(y + 2 * stride * out, y + 2 * stride * (out + p),
+                    x + 2 * stride * i, x + 2 * stride * (i + half),
+                    w[0], w[1], count);
+        }
+        swap(x, y);
+    }
+
+    if (x != data)
+    {
+        for (unsigned j = 0; j < n; j++)
+        {
+            copy(x + 2 * stride * j, x + 2 * stride * j + 2 * count, data + 2 * stride * j);
+        }
+    }
+}
+
+static inline void cmul(float &out_re, float &out_im, float a_re, float a_im, float b_re, float b_im)
+{
+    out_re = a_re * b_re - a_im * b_im;
+    out_im = a_im * b_re + a_re * b_im;
+}
+
+CPUFFT::CPUFFT(unsigned Nx, unsigned Ny, Type type, Direction direction, const FFTOptions &options)
+    : size_x(Nx), size_y(Ny), type(type), direction(direction), normalize(options.type.normalize)
+{
+    bool real = type == ComplexToReal || type == RealToComplex;
+    transform_x = real ? Nx / 2 : Nx;
+    row_stride = Nx;
+    components = type == ComplexToComplexDual ? 2 : 1;
+
+    // Same sanity checks as FFT.
+    if (!transform_x || !Ny || (transform_x & (transform_x - 1)) || (Ny & (Ny - 1)))
+    {
+        throw logic_error("FFT size is not POT.");
+    }
+
+    if (type == ComplexToReal && direction == Forward)
+    {
+        throw logic_error("ComplexToReal transforms requires inverse transform.");
+    }
+
+    if (type == RealToComplex && direction != Forward)
+    {
+        throw logic_error("RealToComplex transforms requires forward transform.");
+    }
+
+    // Passes in the order FFT dispatches them, the resolve goes between the two directions.
+    Mode horizontal = components == 2 ? HorizontalDual : Horizontal;
+    Mode vertical = components == 2 ? VerticalDual : Vertical;
+
+    if (direction == Forward)
+    {
+        passes.push_back(horizontal);
+        if (type == RealToComplex)
+        {
+            passes.push_back(ResolveRealToComplex);
+        }
+        passes.push_back(vertical);
+    }
+    else
+    {
+        passes.push_back(vertical);
+        if (type == ComplexToReal)
+        {
+            passes.push_back(ResolveComplexToReal);
+        }
+        passes.push_back(horizontal);
+    }
+
+    float sign = direction == Forward ? -1.0f : 1.0f;
+    twiddles_x = build_twiddles(transform_x, sign);
+    twiddles_y = build_twiddles(Ny, sign);
+
+    work.resize(2 * row_stride * Ny * components);
+    transposed.resize(2 * transform_x * Ny * components);
+    scratch.resize(max(work.size(), transposed.size()));
+}
+
+size_t CPUFFT::get_input_size() const
+{
+    return type == RealToComplex ? size_x * size_y : 2 * size_x * size_y * components;
+}
+
+size_t CPUFFT::get_output_size() const
+{
+    return type == ComplexToReal ? size_x * size_y : 2 * size_x * size_y * components;
+}
+
+void CPUFFT::run_horizontal()
+{
+    // Transpose the rows, so the transforms of all rows run side by side as the vertical ones do.
+    unsigned count = size_y * components;
+    unsigned sample_floats = 2 * components;
+
+    for (unsigned y = 0; y < size_y; y++)
+    {
+        for (unsigned x = 0; x < transform_x; x++)
+        {
+            const float *src = &work[sample_floats * (y * row_stride + x)];
+            copy(src, src + sample_floats, &transposed[sample_floats * (x * size_y + y)]);
+        }
+    }
+
+    fft_batched(transposed.data(), scratch.data(), transform_x, count, count, twiddles_x.data());
+
+    for (unsigned y = 0; y < size_y; y++)
+    {
+        for (unsigned x = 0; x < transform_x; x++)
+        {
+            const float *src = &transposed[sample_floats * (x * size_y + y)];
+            copy(src, src + sample_floats, &work[sample_floats * (y * row_stride + x)]);
+        }
+    }
+}
+
+void CPUFFT::run_vertical(unsigned columns)
+{
+    fft_batched(work.data(), scratch.data(), size_y, columns * components, row_stride * components, twiddles_y.data());
+}
+
+void CPUFFT::resolve_real_to_complex()
+{
+    // Same resolve as FFT_real_to_complex() in fft_common.comp.
+    // Values i and N / 2 - i depend on each other, so they are resolved together in place.
+    unsigned half = transform_x;
+
+    for (unsigned y = 0; y < size_y; y++)
+    {
+        float *row = &work[2 * y * row_stride];
+        float x_re = row[0];
+        float x_im = row[1];
+
+        for (unsigned i = 1; i <= half / 2; i++)
+        {
+            unsigned indices[2] = { i, half - i };
+            float a[2][2] = { { row[2 * i], row[2 * i + 1] }, { row[2 * (half - i)], row[2 * (half - i) + 1] } };
+            float out[2][2];
+
+            for (unsigned s = 0; s < 2; s++)
+            {
+                const float *va = a[s];
+                const float *vb = a[1 - s];
+
+                // b is conjugated, the twiddle is j * -exp(-pi * j * i / (N / 2)).
+                float fe_re = va[0] + vb[0];
+                float fe_im = va[1] - vb[1];
+                double angle = -M_PI * indices[s] / half;
+                float w_re = float(-cos(angle));
+                float w_im = float(-sin(angle));
+                float fo_re, fo_im;
+                cmul(fo_re, fo_im, va[0] - vb[0], va[1] + vb[1], -w_im, w_re);
+
+                out[s][0] = 0.5f * (fe_re + fo_re);
+                out[s][1] = 0.5f * (fe_im + fo_im);
+            }
+
+            for (unsigned s = 0; s < 2; s++)
+            {
+                row[2 * indices[s] + 0] = out[s][0];
+                row[2 * indices[s] + 1] = out[s][1];
+            }
+        }
+
+        row[0] = x_re + x_im;
+        row[1] = 0.0f;
+        row[2 * half + 0] = x_re - x_im;
+        row[2 * half + 1] = 0.0f;
+    }
+}
+
+void CPUFFT::resolve_complex_to_real()
+{
+    // Same resolve as FFT_complex_to_real() in fft_common.comp, from N / 2 + 1 values per row to N / 2.
+    unsigned half = transform_x;
+
+    for (unsigned y = 0; y < size_y; y++)
+    {
+        float *row = &work[2 * y * row_stride];
+
+        for (unsigned i = 0; i <= half / 2; i++)
+        {
+            unsigned indices[2] = { i, half - i };
+            float a[2][2] = { { row[2 * i], row[2 * i + 1] }, { row[2 * (half - i)], row[2 * (half - i) + 1] } };
+            float out[2][2];
+
+            for (unsigned s = 0; s < 2; s++)
+            {
+                const float *va = a[s];
+                const float *vb = a[1 - s];
+
+                // b is conjugated, the twiddle is j * exp(pi * j * i / (N / 2)).
+                float even_re = va[0] + vb[0];
+                float even_im = va[1] - vb[1];
+                double angle = M_PI * indices[s] / half;
+                float w_re = float(cos(angle));
+                float w_im = float(sin(angle));
+                float odd_re, odd_im;
+                cmul(odd_re, odd_im, va[0] - vb[0], va[1] + vb[1], -w_im, w_re);
+
+                out[s][0] = even_re + odd_re;
+                out[s][1] = even_im + odd_im;
+            }
+
+            // Value N / 2 is only an input.
+            for (unsigned s = 0; s < 2; s++)
+            {
+                if (indices[s] < half)
+                {
+                    row[2 * indices[s] + 0] = out[s][0];
+                    row[2 * indices[s] + 1] = out[s][1];
+                }
+            }
+        }
+    }
+}
+
+void CPUFFT::process(float *output, const float *input, const float *input_aux)
+{
+    if (type == RealToComplex)
+    {
+        // N real values per row are N / 2 complex values, spread out to rows padded for the resolve.
+        for (unsigned y = 0; y < size_y; y++)
+        {
+            copy(input + 2 * y * transform_x, input + 2 * (y + 1) * transform_x, &work[2 * y * row_stride]);
+        }
+    }
+    else
+    {
+        copy(input, input + work.size(), work.begin());
+    }
+
+    if (direction == InverseConvolve && input_aux)
+    {
+        // Convolution in frequency domain is multiplication.
+        for (size_t i = 0; i < work.size(); i += 2)
+        {
+            cmul(work[i], work[i + 1], input[i], input[i + 1], input_aux[i], input_aux[i + 1]);
+        }
+    }
+
+    // Real transforms only have N / 2 + 1 columns of interest vertically.
+    unsigned columns = type == ComplexToReal || type == RealToComplex ? transform_x + 1 : transform_x;
+
+    for (auto mode : passes)
+    {
+        switch (mode)
+        {
+            case Horizontal:
+            case HorizontalDual:
+                run_horizontal();
+                break;
+
+            case Vertical:
+            case VerticalDual:
+                run_vertical(columns);
+                break;
+
+            case ResolveRealToComplex:
+                resolve_real_to_complex();
+                break;
+
+            case ResolveComplexToReal:
+                resolve_complex_to_real();
+                break;
+        }
+    }
+
+    // As FFT_NORMALIZE, 1 / radix for every pass adds up to 1 / N.
+    float scale = normalize ? 1.0f / (size_x * size_y) : 1.0f;
+
+    if (type == ComplexToReal)
+    {
+        for (unsigned y = 0; y < size_y; y++)
+        {
+            const float *row = &work[2 * y * row_stride];
+            transform(row, row + 2 * transform_x, output + 2 * y * transform_x,
+                    [scale](float v) { return v * scale; });
+        }
+    }
+    else
+    {
+        transform(work.begin(), work.end(), output,
+                [scale](float v) { return v * scale; });
+    }
+}
+
+static uint16_t float_to_half(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint16_t sign = (bits >> 16) & 0x8000;
+    int exponent = int((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    // Denormals are flushed to zero, and large values are clamped to infinity.
+    if (exponent <= 0)
+    {
+        return sign;
+    }
+    else if (exponent >= 31)
+    {
+        return sign | 0x7c00;
+    }
+
+    // Round to nearest, a carry into the exponent is still the right result.
+    uint16_t half = sign | (exponent << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+    {
+        half++;
+    }
+    return half;
+}
+
+static float half_to_float(uint16_t half)
+{
+    uint32_t sign = uint32_t(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    uint32_t bits;
+
+    if (exponent == 0)
+    {
+        float value = ldexp(float(mantissa), -24);
+        return sign ? -value : value;
+    }
+    else if (exponent == 31)
+    {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void upload_buffer(Buffer &buffer, const vector<float> &data, bool fp16)
+{
+    if (fp16)
+    {
+        // Packed as packHalf2x16() does, first value in the low bits.
+        vector<uint32_t> packed(data.size() / 2);
+        for (size_t i = 0; i < packed.size(); i++)
+        {
+            packed[i] = float_to_half(data[2 * i]) | (uint32_t(float_to_half(data[2 * i + 1])) << 16);
+        }
+        buffer.init(packed.data(), packed.size() * sizeof(uint32_t), GL_STATIC_DRAW);
+    }
+    else
+    {
+        buffer.init(data.data(), data.size() * sizeof(float), GL_STATIC_DRAW);
+    }
+}
+
+static vector<float> download_buffer(const Buffer &buffer, size_t count, bool fp16)
+{
+    size_t size = fp16 ? count * sizeof(uint16_t) : count * sizeof(float);
+    vector<float> data(count);
+
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.get()));
+    const void *mapped = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (!mapped)
+    {
+        throw runtime_error("Failed to map FFT output buffer.");
+    }
+
+    if (fp16)
+    {
+        const uint16_t *halfs = static_cast<const uint16_t*>(mapped);
+        transform(halfs, halfs + count, data.begin(), half_to_float);
+    }
+    else
+    {
+        const float *floats = static_cast<const float*>(mapped);
+        copy(floats, floats + count, data.begin());
+    }
+
+    GL_CHECK(glUnmapBuffer(GL_SHADER_STORAGE_BUFFER));
+    return data;
+}
+
+double CPUFFT::validate(unsigned Nx, unsigned Ny, Type type, Direction direction,
+        std::shared_ptr<ProgramCache> cache, const FFTOptions &options, const FFTWisdom &wisdom)
+{
+    CPUFFT cpu(Nx, Ny, type, direction, options);
+    FFT gpu(Nx, Ny, type, direction, SSBO, SSBO, move(cache), options, wisdom);
+
+    // Pseudo-random input in [-1, 1], rounded to what the GPU will read.
+    bool convolve = direction == InverseConvolve;
+    vector<float> input(cpu.get_input_size());
+    vector<float> input_aux(convolve ? input.size() : 0);
+    uint32_t seed = 1;
+
+    auto random_value = [&seed, &options]() {
+        seed = seed * 1664525u + 1013904223u;
+        float value = float(seed >> 8) / float(1 << 23) - 1.0f;
+        return options.type.input_fp16 ? half_to_float(float_to_half(value)) : value;
+    };
+    generate(input.begin(), input.end(), random_value);
+    generate(input_aux.begin(), input_aux.end(), random_value);
+
+    Buffer input_buffer, input_aux_buffer, output_buffer;
+    upload_buffer(input_buffer, input, options.type.input_fp16);
+    if (convolve)
+    {
+        upload_buffer(input_aux_buffer, input_aux, options.type.input_fp16);
+    }
+
+    size_t output_count = cpu.get_output_size();
+    output_buffer.init(nullptr, (output_count * sizeof(float)) >> options.type.output_fp16, GL_STREAM_READ);
+
+    gpu.process(output_buffer.get(), input_buffer.get(), input_aux_buffer.get());
+    GL_CHECK(glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT));
+    vector<float> gpu_output = download_buffer(output_buffer, output_count, options.type.output_fp16);
+
+    vector<float> cpu_output(output_count);
+    cpu.process(cpu_output.data(), input.data(), convolve ? input_aux.data() : nullptr);
+
+    // Real-to-complex rows are padded, only compare the N / 2 + 1 values written.
+    unsigned row_floats = type == ComplexToReal ? Nx : 2 * Nx * cpu.components;
+    unsigned compared_floats = type == RealToComplex ? 2 * (Nx / 2 + 1) : row_floats;
+    double max_difference = 0.0;
+    double max_magnitude = 0.0;
+
+    for (unsigned y = 0; y < Ny; y++)
+    {
+        for (unsigned x = 0; x < compared_floats; x++)
+        {
+            size_t index = size_t(y) * row_floats + x;
+            max_difference = max(max_difference, fabs(double(gpu_output[index]) - cpu_output[index]));
+            max_magnitude = max(max_magnitude, fabs(double(cpu_output[index])));
+        }
+    }
+
+    return max_magnitude > 0.0 ? max_difference / max_magnitude : max_difference;
+}
@@ -0,0 +1,111 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GLFFT_CPU_HPP__
+#define GLFFT_CPU_HPP__
+
+#include "glfft.hpp"
+#include <vector>
+
+namespace GLFFT
+{
+
+/// @brief FFT on the CPU, with the conventions and buffer layouts of FFT.
+///
+/// The transform is split into the same passes FFT builds for the type and direction
+/// (horizontal, vertical and the real-to-complex or complex-to-real resolve, in the same order),
+/// with the same twiddle factor signs and the same normalization,
+/// so its output can be compared with the output of an FFT, or stand in for it where compute shaders are slow or missing.
+/// Each pass is a radix-2 Stockham autosort transform, vectorized with NEON across independent rows or columns.
+///
+/// Buffers are always FP32. The FP16 options of FFTOptions are only used by validate().
+class CPUFFT
+{
+    public:
+        /// @brief Creates the passes and allocates the scratch memory.
+        ///
+        /// Will throw if invalid parameters are passed, as FFT does.
+        ///
+        /// @param Nx        Number of samples in horizontal dimension.
+        /// @param Ny        Number of samples in vertical dimension.
+        /// @param type      The transform type.
+        /// @param direction Forward, inverse or inverse with convolution.
+        /// @param options   Only options.type.normalize is used.
+        CPUFFT(unsigned Nx, unsigned Ny, Type type, Direction direction, const FFTOptions &options = FFTOptions());
+
+        /// @brief Process the FFT.
+        ///
+        /// @param output    get_output_size() floats, laid out as the SSBO output of an FFT.
+        ///                  For real-to-complex, only the N / 2 + 1 first complex values of each row are written.
+        /// @param input     get_input_size() floats, laid out as the SSBO input of an FFT.
+        /// @param input_aux If using convolution transform type,
+        ///                  the content of input and input_aux will be multiplied together.
+        void process(float *output, const float *input, const float *input_aux = nullptr);
+
+        /// @brief Returns number of floats in the input buffer.
+        size_t get_input_size() const;
+        /// @brief Returns number of floats in the output buffer.
+        size_t get_output_size() const;
+
+        /// @brief Checks a GPU plan against the CPU.
+        ///
+        /// Creates an FFT with SSBO input and output from the parameters, and runs it and a CPUFFT on the same pseudo-random input.
+        /// With FP16 input, the input is rounded to FP16 for both transforms.
+        /// This stalls until the GPU is done, it is meant for start-up checks and testing.
+        ///
+        /// @param Nx        Number of samples in horizontal dimension.
+        /// @param Ny        Number of samples in vertical dimension.
+        /// @param type      The transform type.
+        /// @param direction Forward, inverse or inverse with convolution.
+        /// @param cache     A program cache for caching the GLFFT programs created.
+        /// @param options   FFT options such as performance related parameters and types.
+        /// @param wisdom    GLFFT wisdom, as passed to FFT.
+        ///
+        /// @returns Largest difference between the GPU and CPU outputs, relative to the largest magnitude of the CPU output.
+        static double validate(unsigned Nx, unsigned Ny, Type type, Direction direction,
+                std::shared_ptr<ProgramCache> cache, const FFTOptions &options,
+                const FFTWisdom &wisdom = FFTWisdom());
+
+    private:
+        unsigned size_x, size_y;
+        Type type;
+        Direction direction;
+        bool normalize;
+
+        // Complex values of the transform per row, and on each row of the work buffer.
+        // They differ for real transforms, which work on N / 2 complex values in rows padded to N for the resolve.
+        unsigned transform_x;
+        unsigned row_stride;
+        // Complex values per sample, 2 for dual transforms.
+        unsigned components;
+
+        std::vector<Mode> passes;
+        std::vector<float> twiddles_x, twiddles_y;
+        std::vector<float> work, transposed, scratch;
+
+        void run_horizontal();
+        void run_vertical(unsigned columns);
+        void resolve_real_to_complex();
+        void resolve_complex_to_real();
+};
+
+}
+
+#endif
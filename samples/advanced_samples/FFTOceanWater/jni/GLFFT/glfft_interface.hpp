@@ -47,4 +47,25 @@ bool glfft_read_file_string(const char *path, char **out_buf);
 #define glfft_read_file_string GLFFT_READ_FILE_STRING_OVERRIDE
 #endif
 
+// Optional, lets compiled programs persist across runs.
+// glfft_load_program() returns true if the program was linked from a binary stored for the same sources,
+// otherwise glfft_prepare_program() is called before linking from source and glfft_store_program() after.
+#ifndef GLFFT_LOAD_PROGRAM_OVERRIDE
+inline bool glfft_load_program(GLuint, const char * const *, unsigned) { return false; }
+#else
+#define glfft_load_program GLFFT_LOAD_PROGRAM_OVERRIDE
+#endif
+
+#ifndef GLFFT_PREPARE_PROGRAM_OVERRIDE
+inline void glfft_prepare_program(GLuint) {}
+#else
+#define glfft_prepare_program GLFFT_PREPARE_PROGRAM_OVERRIDE
+#endif
+
+#ifndef GLFFT_STORE_PROGRAM_OVERRIDE
+inline void glfft_store_program(GLuint, const char * const *, unsigned) {}
+#else
+#define glfft_store_program GLFFT_STORE_PROGRAM_OVERRIDE
+#endif
+
 #endif
@@ -19,6 +19,7 @@
 #include "glfft_wisdom.hpp"
 #include "glfft.hpp"
 #include <utility>
+#include <sstream>
 
 using namespace std;
 using namespace GLFFT;
@@ -94,8 +95,9 @@ const pair<double, FFTOptions::Performance> FFTWisdom::learn_optimal_options(uns
     }
 }
 
-void FFTWisdom::learn_optimal_options_exhaustive(unsigned Nx, unsigned Ny,
-        Type type, Target input_target, Target output_target, const FFTOptions::Type &fft_type)
+void FFTWisdom::for_each_pass_exhaustive(unsigned Nx, unsigned Ny,
+        Type type, Target input_target, Target output_target, const FFTOptions::Type &fft_type,
+        const PassFunction &func)
 {
     bool learn_resolve = type == ComplexToReal || type == RealToComplex;
     Mode vertical_mode = type == ComplexToComplexDual ? VerticalDual : Vertical;
@@ -112,9 +114,9 @@ void FFTWisdom::learn_optimal_options_exhaustive(unsigned Nx, unsigned Ny,
             // Learn plain transforms.
             if (Ny > 1)
             {
-                learn_optimal_options(Nx >> learn_resolve, Ny, radix, vertical_mode, SSBO, SSBO, fft_type);
+                func(Nx >> learn_resolve, Ny, radix, vertical_mode, SSBO, SSBO, fft_type);
             }
-            learn_optimal_options(Nx >> learn_resolve, Ny, radix, horizontal_mode, SSBO, SSBO, fft_type);
+            func(Nx >> learn_resolve, Ny, radix, horizontal_mode, SSBO, SSBO, fft_type);
 
             // Learn the first/last pass transforms. Can be fairly significant since accessing textures makes more sense with
             // block interleave and larger WG_Y sizes.
@@ -122,18 +124,18 @@ void FFTWisdom::learn_optimal_options_exhaustive(unsigned Nx, unsigned Ny,
             {
                 if (Ny > 1)
                 {
-                    learn_optimal_options(Nx >> learn_resolve, Ny, radix, vertical_mode, input_target, SSBO, fft_type);
+                    func(Nx >> learn_resolve, Ny, radix, vertical_mode, input_target, SSBO, fft_type);
                 }
-                learn_optimal_options(Nx >> learn_resolve, Ny, radix, horizontal_mode, input_target, SSBO, fft_type);
+                func(Nx >> learn_resolve, Ny, radix, horizontal_mode, input_target, SSBO, fft_type);
             }
 
             if (output_target != SSBO)
             {
                 if (Ny > 1)
                 {
-                    learn_optimal_options(Nx >> learn_resolve, Ny, radix, vertical_mode, SSBO, output_target, fft_type);
+                    func(Nx >> learn_resolve, Ny, radix, vertical_mode, SSBO, output_target, fft_type);
                 }
-                learn_optimal_options(Nx >> learn_resolve, Ny, radix, horizontal_mode, SSBO, output_target, fft_type);
+                func(Nx >> learn_resolve, Ny, radix, horizontal_mode, SSBO, output_target, fft_type);
             }
         }
         catch (...)
@@ -163,11 +165,11 @@ void FFTWisdom::learn_optimal_options_exhaustive(unsigned Nx, unsigned Ny,
             // If Ny == 1 and we're doing RealToComplex, this will be the last pass, so use output_target as target.
             if (Ny == 1 && resolve_mode == ResolveRealToComplex)
             {
-                learn_optimal_options(Nx >> learn_resolve, Ny, 2, resolve_mode, resolve_input_target, output_target, resolve_type);
+                func(Nx >> learn_resolve, Ny, 2, resolve_mode, resolve_input_target, output_target, resolve_type);
             }
             else
             {
-                learn_optimal_options(Nx >> learn_resolve, Ny, 2, resolve_mode, resolve_input_target, SSBO, resolve_type);
+                func(Nx >> learn_resolve, Ny, 2, resolve_mode, resolve_input_target, SSBO, resolve_type);
             }
         }
         catch (...)
@@ -178,6 +180,49 @@ void FFTWisdom::learn_optimal_options_exhaustive(unsigned Nx, unsigned Ny,
     }
 }
 
+void FFTWisdom::learn_optimal_options_exhaustive(unsigned Nx, unsigned Ny,
+        Type type, Target input_target, Target output_target, const FFTOptions::Type &fft_type)
+{
+    for_each_pass_exhaustive(Nx, Ny, type, input_target, output_target, fft_type,
+            [this](unsigned Nx, unsigned Ny, unsigned radix, Mode mode,
+                Target input_target, Target output_target, const FFTOptions::Type &type) {
+                learn_optimal_options(Nx, Ny, radix, mode, input_target, output_target, type);
+            });
+}
+
+void FFTWisdom::queue_optimal_options_exhaustive(unsigned Nx, unsigned Ny,
+        Type type, Target input_target, Target output_target, const FFTOptions::Type &fft_type)
+{
+    for_each_pass_exhaustive(Nx, Ny, type, input_target, output_target, fft_type,
+            [this](unsigned Nx, unsigned Ny, unsigned radix, Mode mode,
+                Target input_target, Target output_target, const FFTOptions::Type &type) {
+                Study study;
+                study.pass = {
+                    {
+                        Nx, Ny, radix, mode, input_target, output_target,
+                        type,
+                    },
+                    0.0,
+                };
+                study.type = type;
+
+                if (library.find(study.pass) != end(library))
+                {
+                    return;
+                }
+
+                for (auto &queued : queue)
+                {
+                    if (queued.pass == study.pass)
+                    {
+                        return;
+                    }
+                }
+
+                queue.push_back(move(study));
+            });
+}
+
 double FFTWisdom::bench(GLuint output, GLuint input,
         const WisdomPass &pass, const FFTOptions &options, const shared_ptr<ProgramCache> &cache) const
 {
@@ -203,24 +248,15 @@ static inline unsigned mode_to_size(Mode mode)
     }
 }
 
-std::pair<double, FFTOptions::Performance> FFTWisdom::study(const WisdomPass &pass, FFTOptions::Type type) const
+void FFTWisdom::init_study_target(const WisdomPass &pass, const FFTOptions::Type &type, StudyTarget &target)
 {
-    auto cache = make_shared<ProgramCache>();
-
-    Buffer output;
-    Buffer input;
-    Texture output_tex;
-    Texture input_tex;
-    GLuint output_name = 0;
-    GLuint input_name = 0;
-
     unsigned mode_size = mode_to_size(pass.pass.mode);
     vector<float> tmp(mode_size * pass.pass.Nx * pass.pass.Ny);
 
     if (pass.pass.input_target == SSBO)
     {
-        input.init(tmp.data(), tmp.size() * sizeof(float) >> type.input_fp16, GL_STATIC_COPY);
-        input_name = input.get();
+        target.input.init(tmp.data(), tmp.size() * sizeof(float) >> type.input_fp16, GL_STATIC_COPY);
+        target.input_name = target.input.get();
     }
     else
     {
@@ -253,15 +289,15 @@ std::pair<double, FFTOptions::Performance> FFTWisdom::study(const WisdomPass &pa
                 throw logic_error("Invalid input mode.\n");
         }
 
-        input_tex.init(Nx, Ny, 1, internal_format);
-        input_tex.upload(tmp.data(), format, GL_FLOAT, 0, 0, Nx, Ny);
-        input_name = input_tex.get();
+        target.input_tex.init(Nx, Ny, 1, internal_format);
+        target.input_tex.upload(tmp.data(), format, GL_FLOAT, 0, 0, Nx, Ny);
+        target.input_name = target.input_tex.get();
     }
 
     if (pass.pass.output_target == SSBO)
     {
-        output.init(nullptr, tmp.size() * sizeof(float) >> type.output_fp16, GL_STREAM_COPY);
-        output_name = output.get();
+        target.output.init(nullptr, tmp.size() * sizeof(float) >> type.output_fp16, GL_STREAM_COPY);
+        target.output_name = target.output.get();
     }
     else
     {
@@ -290,14 +326,15 @@ std::pair<double, FFTOptions::Performance> FFTWisdom::study(const WisdomPass &pa
                 throw logic_error("Invalid output mode.\n");
         }
 
-        output_tex.init(Nx, Ny, 1, internal_format);
-        output_name = output_tex.get();
+        target.output_tex.init(Nx, Ny, 1, internal_format);
+        target.output_name = target.output_tex.get();
     }
+}
 
-    // Exhaustive search, look for every sensible combination, and find fastest parameters.
-    // Get initial best cost with defaults.
-    FFTOptions::Performance best_perf;
-    double minimum_cost = bench(output_name, input_name, pass, { best_perf, type }, cache);
+vector<FFTOptions::Performance> FFTWisdom::enumerate_candidates(const WisdomPass &pass, const FFTOptions::Type &type) const
+{
+    // Exhaustive search, look for every sensible combination.
+    vector<FFTOptions::Performance> candidates;
 
     static const FFTStaticWisdom::Tristate shared_banked_values[] = { FFTStaticWisdom::False, FFTStaticWisdom::True };
     static const unsigned vector_size_values[] = { 2, 4, 8 };
@@ -306,7 +343,6 @@ std::pair<double, FFTOptions::Performance> FFTWisdom::study(const WisdomPass &pa
 
     bool test_resolve = pass.pass.mode == ResolveComplexToReal || pass.pass.mode == ResolveRealToComplex;
     bool test_dual = pass.pass.mode == VerticalDual || pass.pass.mode == HorizontalDual;
-    unsigned bench_count = 0;
 
     for (auto shared_banked : shared_banked_values)
     {
@@ -383,44 +419,133 @@ std::pair<double, FFTOptions::Performance> FFTWisdom::study(const WisdomPass &pa
                     perf.vector_size = vector_size;
                     perf.workgroup_size_x = workgroup_size_x;
                     perf.workgroup_size_y = workgroup_size_y;
+                    candidates.push_back(perf);
+                }
+            }
+        }
+    }
 
-                    try
-                    {
-                        // If workgroup sizes are too big for our test, this will throw.
-                        double cost = bench(output_name, input_name, pass, { perf, type }, cache);
-                        bench_count++;
+    return candidates;
+}
+
+std::pair<double, FFTOptions::Performance> FFTWisdom::study(const WisdomPass &pass, FFTOptions::Type type) const
+{
+    auto cache = make_shared<ProgramCache>();
+    StudyTarget target;
+    init_study_target(pass, type, target);
+
+    // Find fastest parameters, get initial best cost with defaults.
+    FFTOptions::Performance best_perf;
+    double minimum_cost = bench(target.output_name, target.input_name, pass, { best_perf, type }, cache);
+    unsigned bench_count = 0;
+
+    for (auto &perf : enumerate_candidates(pass, type))
+    {
+        try
+        {
+            // If workgroup sizes are too big for our test, this will throw.
+            double cost = bench(target.output_name, target.input_name, pass, { perf, type }, cache);
+            bench_count++;
 
 #if 1
-                        glfft_log("\nWisdom run (mode = %u, radix = %u):\n", pass.pass.mode, pass.pass.radix);
-                        glfft_log("  Width:            %4u\n", pass.pass.Nx);
-                        glfft_log("  Height:           %4u\n", pass.pass.Ny);
-                        glfft_log("  Shared banked:     %3s\n", shared_banked ? "yes" : "no");
-                        glfft_log("  Vector size:         %u\n", vector_size);
-                        glfft_log("  Workgroup size: (%u, %u)\n", workgroup_size_x, workgroup_size_y);
-                        glfft_log("  Cost:         %8.3g\n", cost);
+            glfft_log("\nWisdom run (mode = %u, radix = %u):\n", pass.pass.mode, pass.pass.radix);
+            glfft_log("  Width:            %4u\n", pass.pass.Nx);
+            glfft_log("  Height:           %4u\n", pass.pass.Ny);
+            glfft_log("  Shared banked:     %3s\n", perf.shared_banked ? "yes" : "no");
+            glfft_log("  Vector size:         %u\n", perf.vector_size);
+            glfft_log("  Workgroup size: (%u, %u)\n", perf.workgroup_size_x, perf.workgroup_size_y);
+            glfft_log("  Cost:         %8.3g\n", cost);
 #endif
 
-                        if (cost < minimum_cost)
-                        {
+            if (cost < minimum_cost)
+            {
 #if 1
-                            glfft_log("  New optimal solution! (%g -> %g)\n", minimum_cost, cost);
+                glfft_log("  New optimal solution! (%g -> %g)\n", minimum_cost, cost);
 #endif
-                            best_perf = perf;
-                            minimum_cost = cost;
-                        }
-                    }
-                    catch (...)
+                best_perf = perf;
+                minimum_cost = cost;
+            }
+        }
+        catch (...)
+        {
+            // If we pass in bogus parameters,
+            // FFT will throw and we just ignore this.
+        }
+    }
+
+    glfft_log("Tested %u variants!\n", bench_count);
+    return make_pair(minimum_cost, best_perf);
+}
+
+bool FFTWisdom::learn_step(double budget)
+{
+    double start_time = glfft_time();
+    bool learned = false;
+
+    while (!queue.empty())
+    {
+        Study &study = queue.front();
+
+        try
+        {
+            if (!study.target)
+            {
+                // First step of a pass, set it up and get the cost with defaults to beat.
+                study.target = unique_ptr<StudyTarget>(new StudyTarget);
+                init_study_target(study.pass, study.type, *study.target);
+                study.cache = make_shared<ProgramCache>();
+                study.candidates = enumerate_candidates(study.pass, study.type);
+                study.minimum_cost = bench(study.target->output_name, study.target->input_name,
+                        study.pass, { study.best_perf, study.type }, study.cache);
+            }
+            else
+            {
+                auto &perf = study.candidates[study.next_candidate++];
+
+                try
+                {
+                    double cost = bench(study.target->output_name, study.target->input_name,
+                            study.pass, { perf, study.type }, study.cache);
+
+                    if (cost < study.minimum_cost)
                     {
-                        // If we pass in bogus parameters,
-                        // FFT will throw and we just ignore this.
+                        study.best_perf = perf;
+                        study.minimum_cost = cost;
                     }
                 }
+                catch (...)
+                {
+                    // Bogus parameters for this pass, skip them.
+                }
             }
         }
+        catch (...)
+        {
+            // If our default options cannot successfully create the radix pass (i.e. throws),
+            // just ignore it for purpose of creating wisdom.
+            queue.pop_front();
+            continue;
+        }
+
+        if (study.next_candidate == study.candidates.size())
+        {
+            WisdomPass pass = study.pass;
+            pass.cost = study.minimum_cost;
+            library[pass] = study.best_perf;
+            learned = true;
+
+            glfft_log("Learned wisdom (mode = %u, radix = %u, %u x %u), %u passes left.\n",
+                    unsigned(pass.pass.mode), pass.pass.radix, pass.pass.Nx, pass.pass.Ny, unsigned(queue.size() - 1));
+            queue.pop_front();
+        }
+
+        if (glfft_time() - start_time >= budget)
+        {
+            break;
+        }
     }
 
-    glfft_log("Tested %u variants!\n", bench_count);
-    return make_pair(minimum_cost, best_perf);
+    return learned;
 }
 
 const pair<const WisdomPass, FFTOptions::Performance>* FFTWisdom::find_optimal_options(unsigned Nx, unsigned Ny, unsigned radix,
@@ -462,3 +587,86 @@ const FFTOptions::Performance& FFTWisdom::find_optimal_options_or_default(unsign
     return itr != end(library) ? itr->second : base_options.performance;
 }
 
+
+// Text format, one pass per line after the header:
+// Nx Ny radix mode input_target output_target fp16 input_fp16 output_fp16 normalize cost
+// workgroup_size_x workgroup_size_y vector_size shared_banked
+static const char wisdom_archive_magic[] = "GLFFT-wisdom-1";
+
+string FFTWisdom::archive(const string &device) const
+{
+    ostringstream stream;
+    stream.precision(17);
+
+    stream << wisdom_archive_magic << '\n';
+    stream << device << '\n';
+
+    for (auto &entry : library)
+    {
+        auto &pass = entry.first.pass;
+        auto &perf = entry.second;
+
+        stream << pass.Nx << ' ' << pass.Ny << ' ' << pass.radix << ' '
+               << unsigned(pass.mode) << ' ' << unsigned(pass.input_target) << ' ' << unsigned(pass.output_target) << ' '
+               << pass.type.fp16 << ' ' << pass.type.input_fp16 << ' ' << pass.type.output_fp16 << ' ' << pass.type.normalize << ' '
+               << entry.first.cost << ' '
+               << perf.workgroup_size_x << ' ' << perf.workgroup_size_y << ' ' << perf.vector_size << ' ' << perf.shared_banked << '\n';
+    }
+
+    return stream.str();
+}
+
+bool FFTWisdom::import(const string &data, const string &device)
+{
+    istringstream stream(data);
+    string magic;
+    string archived_device;
+
+    if (!getline(stream, magic) || magic != wisdom_archive_magic)
+    {
+        glfft_log("Wisdom data is not in a known format, ignoring.\n");
+        return false;
+    }
+
+    if (!getline(stream, archived_device) || archived_device != device)
+    {
+        glfft_log("Wisdom data was learned on another device or driver, ignoring.\n");
+        return false;
+    }
+
+    unordered_map<WisdomPass, FFTOptions::Performance> imported;
+    string line;
+
+    while (getline(stream, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+
+        istringstream line_stream(line);
+        unsigned mode, input_target, output_target;
+        WisdomPass pass;
+        FFTOptions::Performance perf;
+
+        if (!(line_stream >> pass.pass.Nx >> pass.pass.Ny >> pass.pass.radix
+                          >> mode >> input_target >> output_target
+                          >> pass.pass.type.fp16 >> pass.pass.type.input_fp16 >> pass.pass.type.output_fp16 >> pass.pass.type.normalize
+                          >> pass.cost
+                          >> perf.workgroup_size_x >> perf.workgroup_size_y >> perf.vector_size >> perf.shared_banked))
+        {
+            glfft_log("Wisdom data is corrupt, ignoring.\n");
+            return false;
+        }
+
+        pass.pass.mode = static_cast<Mode>(mode);
+        pass.pass.input_target = static_cast<Target>(input_target);
+        pass.pass.output_target = static_cast<Target>(output_target);
+        imported[pass] = perf;
+    }
+
+    // insert() does not overwrite, so passes learned during this run are kept.
+    library.insert(begin(imported), end(imported));
+    glfft_log("Imported wisdom for %u passes.\n", unsigned(imported.size()));
+    return true;
+}
@@ -22,6 +22,10 @@
 #include <unordered_map>
 #include <utility>
 #include <string>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
 #include "glfft_common.hpp"
 
 namespace GLFFT
@@ -95,12 +99,44 @@ class FFTWisdom
         void learn_optimal_options_exhaustive(unsigned Nx, unsigned Ny,
                 Type type, Target input_target, Target output_target, const FFTOptions::Type &fft_type);
 
+        /// @brief Queues the passes learn_optimal_options_exhaustive() would learn, to be learned by learn_step() instead.
+        ///
+        /// Passes already in the library or already queued are skipped.
+        void queue_optimal_options_exhaustive(unsigned Nx, unsigned Ny,
+                Type type, Target input_target, Target output_target, const FFTOptions::Type &fft_type);
+
+        /// @brief Benchmarks queued candidates until budget seconds have passed, at least one per call.
+        ///
+        /// Call once per frame to tune the FFT over time instead of stalling at start-up.
+        /// Every candidate compiles its own shaders, which counts against the budget.
+        /// set_bench_params() should be given a timeout no larger than the budget.
+        /// @param budget    Time to spend, in seconds. Benchmarks wait for the GPU, so this bounds GPU time as well.
+        /// @returns True if a pass was learned. FFTs created before then can be recreated to use the new wisdom.
+        bool learn_step(double budget);
+
+        /// @brief Returns true while learn_step() has queued passes left.
+        bool is_learning() const { return !queue.empty(); }
+
         const std::pair<const WisdomPass, FFTOptions::Performance>* find_optimal_options(unsigned Nx, unsigned Ny, unsigned radix,
                 Mode mode, Target input_target, Target output_target, const FFTOptions::Type &base_options) const;
 
         const FFTOptions::Performance& find_optimal_options_or_default(unsigned Nx, unsigned Ny, unsigned radix,
                 Mode mode, Target input_target, Target output_target, const FFTOptions &base_options) const;
 
+        /// @brief Serializes the learned options so they can be imported on a later run.
+        ///
+        /// @param device    Identifies the GPU and driver the wisdom was learned on, e.g. GL_RENDERER and GL_VERSION.
+        ///                  Options tuned for one driver are not necessarily good for another one.
+        std::string archive(const std::string &device) const;
+
+        /// @brief Merges options serialized by archive() into the library.
+        ///
+        /// Options already in the library are kept, so learned wisdom always wins over imported wisdom.
+        /// @param data      The output of archive().
+        /// @param device    Must match the device passed to archive(), otherwise nothing is imported.
+        /// @returns True if the data was imported.
+        bool import(const std::string &data, const std::string &device);
+
         void set_static_wisdom(FFTStaticWisdom static_wisdom) { this->static_wisdom = static_wisdom; }
         static FFTStaticWisdom get_static_wisdom_from_renderer(const char *renderer);
 
@@ -116,6 +152,42 @@ class FFTWisdom
     private:
         std::unordered_map<WisdomPass, FFTOptions::Performance> library;
 
+        // Buffers or textures a pass is benchmarked with.
+        struct StudyTarget
+        {
+            Buffer output;
+            Buffer input;
+            Texture output_tex;
+            Texture input_tex;
+            GLuint output_name = 0;
+            GLuint input_name = 0;
+        };
+
+        // A pass being learned by learn_step(), one candidate at a time.
+        struct Study
+        {
+            WisdomPass pass;
+            FFTOptions::Type type;
+            std::vector<FFTOptions::Performance> candidates;
+            size_t next_candidate = 0;
+            FFTOptions::Performance best_perf;
+            double minimum_cost = 0.0;
+            std::shared_ptr<ProgramCache> cache;
+            std::unique_ptr<StudyTarget> target;
+        };
+
+        std::deque<Study> queue;
+
+        typedef std::function<void (unsigned Nx, unsigned Ny, unsigned radix, Mode mode,
+                Target input_target, Target output_target, const FFTOptions::Type &type)> PassFunction;
+
+        void for_each_pass_exhaustive(unsigned Nx, unsigned Ny,
+                Type type, Target input_target, Target output_target, const FFTOptions::Type &fft_type,
+                const PassFunction &func);
+
+        static void init_study_target(const WisdomPass &pass, const FFTOptions::Type &type, StudyTarget &target);
+        std::vector<FFTOptions::Performance> enumerate_candidates(const WisdomPass &pass, const FFTOptions::Type &type) const;
+
         std::pair<double, FFTOptions::Performance> study(const WisdomPass &pass, FFTOptions::Type options) const;
 
         double bench(GLuint output, GLuint input, const WisdomPass &pass, const FFTOptions &options,
@@ -19,6 +19,7 @@
  */
 
 #include "common.hpp"
+#include "ProgramBinaryCache.h"
 #include <stdlib.h>
 #include <string>
 #include <vector>
@@ -74,6 +75,14 @@ static bool check_program(GLuint prog)
 GLuint common_compile_shader(const char *vs_source, const char *fs_source)
 {
     GL_CHECK(GLuint prog = glCreateProgram());
+
+    const char *sources[] = { vs_source, fs_source };
+    unsigned long long key = ProgramBinaryCache::computeKey(sources, 2);
+    if (ProgramBinaryCache::loadProgram(prog, key))
+    {
+        return prog;
+    }
+
     GLuint vs = common_compile(GL_VERTEX_SHADER, vs_source);
     if (!vs)
     {
@@ -91,6 +100,7 @@ GLuint common_compile_shader(const char *vs_source, const char *fs_source)
 
     GL_CHECK(glAttachShader(prog, vs));
     GL_CHECK(glAttachShader(prog, fs));
+    ProgramBinaryCache::prepareProgram(prog);
     GL_CHECK(glLinkProgram(prog));
 
     GL_CHECK(glDeleteShader(vs));
@@ -102,6 +112,7 @@ GLuint common_compile_shader(const char *vs_source, const char *fs_source)
         return 0;
     }
 
+    ProgramBinaryCache::storeProgram(prog, key);
     return prog;
 }
 
@@ -120,6 +131,12 @@ GLuint common_compile_shader(const char *vs_source,
         fs_source,
     };
 
+    unsigned long long key = ProgramBinaryCache::computeKey(sources, 5);
+    if (ProgramBinaryCache::loadProgram(prog, key))
+    {
+        return prog;
+    }
+
     const GLenum stages[] = {
         GL_VERTEX_SHADER,
         GL_TESS_CONTROL_SHADER_EXT,
@@ -147,6 +164,7 @@ GLuint common_compile_shader(const char *vs_source,
             GL_CHECK(glAttachShader(prog, shader));
         }
     }
+    ProgramBinaryCache::prepareProgram(prog);
     GL_CHECK(glLinkProgram(prog));
 
     for (auto shader : shaders)
@@ -163,6 +181,7 @@ GLuint common_compile_shader(const char *vs_source,
         return 0;
     }
 
+    ProgramBinaryCache::storeProgram(prog, key);
     return prog;
 
 error:
@@ -180,6 +199,13 @@ error:
 GLuint common_compile_compute_shader(const char *cs_source)
 {
     GL_CHECK(GLuint prog = glCreateProgram());
+
+    unsigned long long key = ProgramBinaryCache::computeKey(&cs_source, 1);
+    if (ProgramBinaryCache::loadProgram(prog, key))
+    {
+        return prog;
+    }
+
     GLuint cs = common_compile(GL_COMPUTE_SHADER, cs_source);
     if (!cs)
     {
@@ -188,6 +214,7 @@ GLuint common_compile_compute_shader(const char *cs_source)
     }
 
     GL_CHECK(glAttachShader(prog, cs));
+    ProgramBinaryCache::prepareProgram(prog);
     GL_CHECK(glLinkProgram(prog));
 
     GL_CHECK(glDeleteShader(cs));
@@ -198,9 +225,25 @@ GLuint common_compile_compute_shader(const char *cs_source)
         return 0;
     }
 
+    ProgramBinaryCache::storeProgram(prog, key);
     return prog;
 }
 
+bool common_load_program_binary(GLuint prog, const char * const *sources, unsigned num_sources)
+{
+    return ProgramBinaryCache::loadProgram(prog, ProgramBinaryCache::computeKey(sources, num_sources));
+}
+
+void common_prepare_program_binary(GLuint prog)
+{
+    ProgramBinaryCache::prepareProgram(prog);
+}
+
+void common_store_program_binary(GLuint prog, const char * const *sources, unsigned num_sources)
+{
+    ProgramBinaryCache::storeProgram(prog, ProgramBinaryCache::computeKey(sources, num_sources));
+}
+
 bool common_read_file_string(const char *path, char **out_buf)
 {
     FILE *file = common_fopen(path, "rb");
@@ -328,6 +371,24 @@ GLuint common_compile_compute_shader_from_file(const char *cs_source)
     return prog;
 }
 
+GLuint common_compile_compute_shader_from_file(const char *cs_source, const char *defines)
+{
+    LOGI("Compiling compute shader from %s.", cs_source);
+    char *cs_buf = NULL;
+    if (!common_read_file_string(cs_source, &cs_buf))
+    {
+        return 0;
+    }
+
+    // #version must stay the first line.
+    string source = cs_buf;
+    free(cs_buf);
+    size_t version_end = source.find('\n') + 1;
+    source.insert(version_end, defines);
+
+    return common_compile_compute_shader(source.c_str());
+}
+
 static string common_basedir;
 void common_set_basedir(const char *basedir)
 {
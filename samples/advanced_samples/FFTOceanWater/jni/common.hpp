@@ -46,6 +46,8 @@ GLuint common_compile_shader_from_file(const char *vs_source,
         const char *tc_source, const char *te_source, const char *geom_source,
         const char *fs_source);
 GLuint common_compile_compute_shader_from_file(const char *cs_source);
+// Same as above, but inserts defines (e.g. "#define FOO\n") right after the #version line.
+GLuint common_compile_compute_shader_from_file(const char *cs_source, const char *defines);
 
 void common_set_basedir(const char *basedir);
 FILE *common_fopen(const char *path, const char *mode);
@@ -54,6 +56,11 @@ std::string common_get_path(const char *basepath);
 
 bool common_read_file_string(const char *path, char **out_buf);
 
+// Program binary persistence for programs built outside of the common_compile_* functions, through ProgramBinaryCache.
+bool common_load_program_binary(GLuint prog, const char * const *sources, unsigned num_sources);
+void common_prepare_program_binary(GLuint prog);
+void common_store_program_binary(GLuint prog, const char * const *sources, unsigned num_sources);
+
 inline bool common_has_extension(const char *ext)
 {
     GL_CHECK(bool ret = strstr((const char*)glGetString(GL_EXTENSIONS), ext) != nullptr);
@@ -18,28 +18,135 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#define FFT_FP16 1
+// Tune the FFT passes for the GPU in the background on the first run and keep the results in FFT_WISDOM_PATH for later runs.
+#define FFT_WISDOM 1
+#define FFT_WISDOM_PATH "fft_wisdom.txt"
+// Time spent learning each frame, in seconds.
+#define FFT_WISDOM_FRAME_BUDGET 0.002
+// Check the FFT plans against the CPU reference FFT at start-up and log the error.
+#define FFT_VALIDATE 0
+// A finer cascade takes over from the coarser one at waves this many times shorter than its patch.
+// Below that, its frequencies are too far apart to represent the spectrum well.
+#define CASCADE_BAND_WAVES 6.0f
 
 #include "vector_math.h"
 
 #include "fftwater.hpp"
+#include "glfft_cpu.hpp"
+#include "Profiler.h"
 #include <cmath>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 
 using namespace std;
 using namespace GLFFT;
 
+#if FFT_WISDOM
+// Wisdom is only valid for the GPU and driver it was learned on.
+static string get_wisdom_device()
+{
+    return string((const char*)glGetString(GL_RENDERER)) + " / " + (const char*)glGetString(GL_VERSION);
+}
+
+static void load_wisdom(FFTWisdom &wisdom, const string &device)
+{
+    ifstream file(common_get_path(FFT_WISDOM_PATH));
+    if (!file)
+    {
+        LOGI("No FFT wisdom stored yet, FFT passes will be tuned for this device.\n");
+        return;
+    }
+
+    stringstream data;
+    data << file.rdbuf();
+    wisdom.import(data.str(), device);
+}
+
+static void save_wisdom(const FFTWisdom &wisdom, const string &device)
+{
+    string path = common_get_path(FFT_WISDOM_PATH);
+    ofstream file(path);
+    file << wisdom.archive(device);
+
+    if (!file)
+    {
+        LOGE("Failed to store FFT wisdom in %s.\n", path.c_str());
+    }
+}
+#endif
+
+// Round-to-nearest float to half conversion for uploading the distributions in FP16 mode.
+static uint16_t float_to_half(float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+
+    uint16_t sign = (bits >> 16) & 0x8000;
+    int exponent = int((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent >= 31)
+    {
+        // Clamp to the largest finite half, the distributions never hold inf or NaN.
+        return sign | 0x7bff;
+    }
+    else if (exponent <= 0)
+    {
+        // Denormal half, or too small to represent.
+        if (exponent < -10)
+        {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        unsigned shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1)
+        {
+            half++;
+        }
+        return sign | uint16_t(half);
+    }
+
+    uint32_t half = (uint32_t(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+    {
+        // Carries into the exponent naturally.
+        half++;
+    }
+    return sign | uint16_t(min(half, 0x7bffu));
+}
+
+static void init_distribution_buffer(Buffer &buffer, const cfloat *distribution, size_t count, bool fp16)
+{
+    if (!fp16)
+    {
+        buffer.init(distribution, count * sizeof(cfloat), GL_STATIC_COPY);
+        return;
+    }
+
+    // Packed as half2, matching unpackHalf2x16 in the generate shaders.
+    vector<uint32_t> packed(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        packed[i] = float_to_half(distribution[i].real()) | (uint32_t(float_to_half(distribution[i].imag())) << 16);
+    }
+    buffer.init(packed.data(), count * sizeof(uint32_t), GL_STATIC_COPY);
+}
+
 FFTWater::FFTWater(
         float amplitude,
         vec2 wind_velocity,
         uvec2 resolution,
         vec2 size,
-        vec2 normalmap_freq_mod)
+        vec2 normalmap_freq_mod,
+        bool fp16,
+        const vector<CascadeInfo> &detail_cascades)
     :
         wind_velocity(wind_velocity),
         wind_dir(vec_normalize(wind_velocity)),
-        Nx(resolution.x), Nz(resolution.y), size(size), size_normal(size / normalmap_freq_mod)
+        Nx(resolution.x), Nz(resolution.y), size(size), size_normal(size / normalmap_freq_mod),
+        fp16(fp16)
 {
     // Factor in Phillips spectrum.
     L = vec_dot(wind_velocity, wind_velocity) / G;
@@ -47,18 +154,57 @@ FFTWater::FFTWater(
     // Use half-res for displacementmap since it's so low-resolution.
     displacement_downsample = 1;
 
-    distribution.resize(Nx * Nz);
-    distribution_normal.resize(Nx * Nz);
+    cascades.resize(detail_cascades.size() + 1);
+    cascades[0].Nx = Nx;
+    cascades[0].Nz = Nz;
+    cascades[0].size = size;
+    for (unsigned i = 0; i < detail_cascades.size(); i++)
+    {
+        cascades[i + 1].Nx = detail_cascades[i].resolution.x;
+        cascades[i + 1].Nz = detail_cascades[i].resolution.y;
+        cascades[i + 1].size = detail_cascades[i].size;
+    }
+
+    // Split the spectrum between the cascades, so every wave is simulated once.
+    // A cascade never goes past its Nyquist frequency, which leaves a gap rather than aliasing.
+    vector<float> band(cascades.size() + 1, 0.0f);
+    band.back() = INFINITY;
+    for (unsigned i = 1; i < cascades.size(); i++)
+    {
+        const Cascade &coarse = cascades[i - 1];
+        const Cascade &fine = cascades[i];
+        float nyquist = float(M_PI) * min(coarse.Nx / coarse.size.x, coarse.Nz / coarse.size.y);
+        float takeover = 2.0f * float(M_PI) * CASCADE_BAND_WAVES / max(fine.size.x, fine.size.y);
+        band[i] = max(min(takeover, nyquist), band[i - 1]);
+    }
 
     // Normalize amplitude a bit based on the heightmap size.
-    amplitude *= 0.3f / sqrt(size.x * size.y);
+    // This scales with the frequency step, so cascades of any size sample the same spectrum.
+    float area = size.x * size.y;
+    amplitude *= 0.3f / sqrt(area);
+
+    cascades[0].distribution.resize(Nx * Nz);
+    generate_distribution(cascades[0].distribution.data(), Nx, Nz, size, amplitude, 0.02f, band[0], band[1]);
 
-    generate_distribution(distribution.data(), size, amplitude, 0.02f);
-    generate_distribution(distribution_normal.data(), size_normal,
+    // The high-frequency normal map is not part of the band split, it only adds detail to the shading.
+    distribution_normal.resize(Nx * Nz);
+    generate_distribution(distribution_normal.data(), Nx, Nz, size_normal,
             amplitude * sqrt(normalmap_freq_mod.x * normalmap_freq_mod.y), 0.02f);
 
-    distribution_displacement.resize((Nx * Nz) >> (displacement_downsample * 2));
-    downsample_distribution(distribution_displacement.data(), distribution.data(), displacement_downsample);
+    for (unsigned i = 1; i < cascades.size(); i++)
+    {
+        Cascade &cascade = cascades[i];
+        cascade.distribution.resize(cascade.Nx * cascade.Nz);
+        generate_distribution(cascade.distribution.data(), cascade.Nx, cascade.Nz, cascade.size,
+                amplitude * sqrt(area / (cascade.size.x * cascade.size.y)), 0.02f, band[i], band[i + 1]);
+    }
+
+    for (auto &cascade : cascades)
+    {
+        cascade.distribution_displacement.resize((cascade.Nx * cascade.Nz) >> (displacement_downsample * 2));
+        downsample_distribution(cascade.distribution_displacement.data(), cascade.distribution.data(),
+                cascade.Nx, cascade.Nz, displacement_downsample);
+    }
 
     // Check if we can render to FP16, if so, we can do mipmaping of FP16 in fragment instead where appropriate.
     mipmap_fp16 = common_has_extension("GL_EXT_color_buffer_half_float");
@@ -73,7 +219,7 @@ static inline int alias(int x, int N)
     return x;
 }
 
-void FFTWater::downsample_distribution(cfloat *out, const cfloat *in, unsigned rate_log2)
+void FFTWater::downsample_distribution(cfloat *out, const cfloat *in, unsigned Nx, unsigned Nz, unsigned rate_log2)
 {
     // Pick out the lower frequency samples only which is the same as downsampling "perfectly".
     unsigned out_width = Nx >> rate_log2;
@@ -121,7 +267,8 @@ cfloat FFTWater::phillips(vec2 k, float max_l)
         pow(k_len, -4.0f);
 }
 
-void FFTWater::generate_distribution(cfloat *distribution, vec2 size, float amplitude, float max_l)
+void FFTWater::generate_distribution(cfloat *distribution, unsigned Nx, unsigned Nz, vec2 size, float amplitude, float max_l,
+        float min_k, float max_k)
 {
     // Modifier to find spatial frequency.
     vec2 mod = vec2(2.0f * M_PI) / size;
@@ -134,7 +281,14 @@ void FFTWater::generate_distribution(cfloat *distribution, vec2 size, float ampl
             vec2 k = mod * vec2(alias(x, Nx), alias(z, Nz));
 
             // Gaussian distributed noise with unit variance.
+            // Drawn for every frequency, so that the noise does not depend on the band.
             cfloat dist = cfloat(normal_dist(engine), normal_dist(engine));
+            float k_len = vec_length(k);
+            if (k_len < min_k || k_len >= max_k)
+            {
+                v = 0.0f;
+                continue;
+            }
             v = dist * amplitude * sqrt(0.5f * phillips(k, max_l));
         }
     }
@@ -142,25 +296,32 @@ void FFTWater::generate_distribution(cfloat *distribution, vec2 size, float ampl
 
 void FFTWater::update_phase(float time)
 {
-    vec2 mod = vec2(2.0f * M_PI) / size;
     vec2 mod_normal = vec2(2.0f * M_PI) / size_normal;
 
     // Generate new FFTs
     GL_CHECK(glUseProgram(prog_generate_height.get()));
-    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, distribution_buffer.get()));
-    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, freq_height.get()));
-    GL_CHECK(glUniform2f(0, mod.x, mod.y));
     GL_CHECK(glUniform1f(1, time));
-    GL_CHECK(glUniform2ui(2, Nx, Nz));
-    // We only need to generate half the frequencies due to C2R transform.
-    GL_CHECK(glDispatchCompute(Nx / 64, Nz, 1));
+    for (auto &cascade : cascades)
+    {
+        vec2 mod = vec2(2.0f * M_PI) / cascade.size;
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, cascade.distribution_buffer.get()));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cascade.freq_height.get()));
+        GL_CHECK(glUniform2f(0, mod.x, mod.y));
+        GL_CHECK(glUniform2ui(2, cascade.Nx, cascade.Nz));
+        // We only need to generate half the frequencies due to C2R transform.
+        GL_CHECK(glDispatchCompute(cascade.Nx / 64, cascade.Nz, 1));
+    }
 
     GL_CHECK(glUseProgram(prog_generate_displacement.get()));
-    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, distribution_buffer_displacement.get()));
-    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, freq_displacement.get()));
-    GL_CHECK(glUniform2f(0, mod.x, mod.y));
     GL_CHECK(glUniform1f(1, time));
-    GL_CHECK(glDispatchCompute((Nx >> displacement_downsample) / 64, (Nz >> displacement_downsample), 1));
+    for (auto &cascade : cascades)
+    {
+        vec2 mod = vec2(2.0f * M_PI) / cascade.size;
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, cascade.distribution_buffer_displacement.get()));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cascade.freq_displacement.get()));
+        GL_CHECK(glUniform2f(0, mod.x, mod.y));
+        GL_CHECK(glDispatchCompute((cascade.Nx >> displacement_downsample) / 64, (cascade.Nz >> displacement_downsample), 1));
+    }
 
     GL_CHECK(glUseProgram(prog_generate_normal.get()));
     GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, distribution_buffer_normal.get()));
@@ -169,7 +330,7 @@ void FFTWater::update_phase(float time)
     GL_CHECK(glUniform1f(1, time));
     GL_CHECK(glDispatchCompute(Nx / 64, Nz, 1));
 
-    // The three compute jobs above are independent so we only need to barrier here.
+    // The compute jobs above are independent so we only need to barrier here.
     GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
 }
 
@@ -178,9 +339,16 @@ void FFTWater::compute_ifft()
     // Compute the iFFT
     // Ping-pong the textures we use so we can run fragment and compute in parallel without triggering lots of extra driver work.
     texture_index ^= 1;
-    fft_height->process(heightmap[texture_index].get(), freq_height.get());
-    fft_displacement->process(displacementmap[texture_index].get(), freq_displacement.get());
-    fft_normal->process(normalmap[texture_index].get(), freq_normal.get());
+    // The transforms are independent, so interleave their passes and share the barriers between them.
+    batch_jobs.clear();
+    for (auto &cascade : cascades)
+    {
+        batch_jobs.push_back({ cascade.fft_height.get(), cascade.heightmap[texture_index].get(), cascade.freq_height.get(), 0 });
+        batch_jobs.push_back({ cascade.fft_displacement.get(), cascade.displacementmap[texture_index].get(),
+                cascade.freq_displacement.get(), 0 });
+    }
+    batch_jobs.push_back({ fft_normal.get(), normalmap[texture_index].get(), freq_normal.get(), 0 });
+    FFT::process_batch(batch_jobs.data(), batch_jobs.size());
     GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
 }
 
@@ -197,26 +365,52 @@ void FFTWater::generate_mipmaps()
     // if FP16 rendering extension is not supported.
     if (mipmap_fp16)
     {
-        GL_CHECK(glBindTexture(GL_TEXTURE_2D, gradientjacobianmap[texture_index].get()));
-        GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
-        GL_CHECK(glBindTexture(GL_TEXTURE_2D, normalmap[texture_index].get()));
+        for (auto &cascade : cascades)
+        {
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D, cascade.gradientjacobianmap[output_index].get()));
+            GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
+        }
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, get_normal()));
         GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
     }
 
     // Do not output to the two highest mipmap levels.
-    for (unsigned l = 0; (Nx >> l) >= 8 && (Nz >> l) >= 8; l++)
+    // The cascades are independent, so a level of every cascade is computed before each barrier.
+    for (unsigned l = 0; ; l++)
     {
+        bool dispatched = false;
+
         // Fallback path.
-        if (!mipmap_fp16)
+        if (!mipmap_fp16 && (Nx >> l) >= 8 && (Nz >> l) >= 8)
         {
             // There is no rg16f image format, just use R32UI reinterpretation which is the same thing.
-            compute_mipmap(prog_mipmap_normal, normalmap[texture_index], GL_R32UI,
-                    Nx >> l, Nz >> l, l + 1);
-            compute_mipmap(prog_mipmap_gradient_jacobian, gradientjacobianmap[texture_index], GL_RGBA16F,
+            compute_mipmap(prog_mipmap_normal, get_normalmap(), GL_R32UI,
                     Nx >> l, Nz >> l, l + 1);
         }
 
-        compute_mipmap(prog_mipmap_height, heightdisplacementmap[texture_index], GL_RGBA16F, Nx >> l, Nz >> l, l + 1);
+        for (auto &cascade : cascades)
+        {
+            unsigned width = cascade.Nx >> l;
+            unsigned height = cascade.Nz >> l;
+            if (width < 8 || height < 8)
+            {
+                continue;
+            }
+
+            if (!mipmap_fp16)
+            {
+                compute_mipmap(prog_mipmap_gradient_jacobian, cascade.gradientjacobianmap[output_index], GL_RGBA16F,
+                        width, height, l + 1);
+            }
+
+            compute_mipmap(prog_mipmap_height, cascade.heightdisplacementmap[output_index], GL_RGBA16F, width, height, l + 1);
+            dispatched = true;
+        }
+
+        if (!dispatched)
+        {
+            break;
+        }
 
         // Avoid memory barriers for every dispatch since we can compute 3 separate miplevels before flushing load-store caches.
         GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
@@ -225,28 +419,128 @@ void FFTWater::generate_mipmaps()
 
 void FFTWater::update(float time)
 {
-    update_phase(time);
-    compute_ifft();
-    // Generate final textures ready for vertex and fragment shading.
-    bake_height_gradient();
+#if FFT_WISDOM
+    if (wisdom.is_learning())
+    {
+        // Swap in faster FFTs as soon as a pass is learned.
+        if (wisdom.learn_step(FFT_WISDOM_FRAME_BUDGET))
+        {
+            create_ffts();
+        }
+
+        if (!wisdom.is_learning())
+        {
+            LOGI("FFT wisdom learned, storing it for the next runs.\n");
+            save_wisdom(wisdom, wisdom_device);
+#if FFT_VALIDATE
+            validate_ffts();
+#endif
+        }
+    }
+#endif
+
+    if (simulation_period <= 0.0f)
+    {
+        simulate(time);
+        output_index = texture_index;
+        // Generate final textures ready for vertex and fragment shading.
+        {
+            PROFILE_SCOPE("bake");
+            bake_height_gradient();
+        }
+        PROFILE_SCOPE("mipmaps");
+        generate_mipmaps();
+        return;
+    }
+
+    // Keep one simulation step ahead of time, so there are always two steps to blend between.
+    // If we fall more than a step behind (e.g. app was paused), restart instead of catching up.
+    if (!simulation_started || time >= next_simulation_time + simulation_period)
+    {
+        simulate(time);
+        next_simulation_time = time + simulation_period;
+        simulate(next_simulation_time);
+        simulation_started = true;
+    }
+    else if (time >= next_simulation_time)
+    {
+        next_simulation_time += simulation_period;
+        simulate(next_simulation_time);
+    }
+
+    float lerp = 1.0f - (next_simulation_time - time) / simulation_period;
+
+    // Baking and mipmapping are cheap compared to the FFTs, so they still run every update.
+    output_index ^= 1;
+    {
+        PROFILE_SCOPE("bake");
+        bake_height_gradient_lerp(clamp(lerp, 0.0f, 1.0f));
+    }
+    PROFILE_SCOPE("mipmaps");
     generate_mipmaps();
 }
 
-void FFTWater::bake_height_gradient()
+void FFTWater::read_back(vector<vec4> &texels)
 {
-    GL_CHECK(glUseProgram(prog_bake_height_gradient.get()));
+    if (!prog_readback.get())
+    {
+        prog_readback = Program(common_compile_compute_shader_from_file("water_readback.comp"));
+    }
+
+    Buffer buffer;
+    buffer.init(nullptr, 2 * Nx * Nz * sizeof(vec4), GL_STREAM_READ);
 
+    GL_CHECK(glUseProgram(prog_readback.get()));
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, heightmap[texture_index].get()));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, get_height_displacement()));
     GL_CHECK(glActiveTexture(GL_TEXTURE1));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, displacementmap[texture_index].get()));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, get_gradient_jacobian()));
+    GL_CHECK(glActiveTexture(GL_TEXTURE2));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, get_normal()));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer.get()));
+    GL_CHECK(glDispatchCompute(Nx / 8, Nz / 8, 1));
+    GL_CHECK(glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT));
+
+    texels.resize(2 * Nx * Nz);
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.get()));
+    GL_CHECK(const void *ptr = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, texels.size() * sizeof(vec4), GL_MAP_READ_BIT));
+    if (ptr)
+    {
+        memcpy(texels.data(), ptr, texels.size() * sizeof(vec4));
+        GL_CHECK(glUnmapBuffer(GL_SHADER_STORAGE_BUFFER));
+    }
+    else
+    {
+        LOGE("Failed to map readback buffer.\n");
+        fill(begin(texels), end(texels), vec4(0.0f));
+    }
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+}
 
-    // Height and displacement are sampled in vertex shaders only, so stick them together.
-    GL_CHECK(glBindImageTexture(0, heightdisplacementmap[texture_index].get(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F));
+void FFTWater::simulate(float time)
+{
+    PROFILE_SCOPE("simulate");
+    update_phase(time);
+    compute_ifft();
+}
+
+void FFTWater::set_simulation_rate(float rate)
+{
+    simulation_period = rate > 0.0f ? 1.0f / rate : 0.0f;
+    simulation_started = false;
 
-    // Gradients from heightmap and the jacobian are only sampled in fragment, so group them together.
-    GL_CHECK(glBindImageTexture(1, gradientjacobianmap[texture_index].get(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F));
+    if (simulation_period > 0.0f && !blended_normalmap[0].get())
+    {
+        for (auto &tex : blended_normalmap)
+        {
+            init_texture(tex, GL_RG16F, normal_levels - 2, Nx, Nz, GL_LINEAR, GL_LINEAR_MIPMAP_LINEAR);
+        }
+    }
+}
 
+static void set_bake_uniforms(unsigned Nx, unsigned Nz, vec2 size, unsigned displacement_downsample)
+{
     GL_CHECK(glUniform4f(0,
             1.0f / Nx, 1.0f / Nz,
             1.0f / (Nx >> displacement_downsample),
@@ -255,9 +549,70 @@ void FFTWater::bake_height_gradient()
             Nx / size.x, Nz / size.y,
             (Nx >> displacement_downsample) / size.x,
             (Nz >> displacement_downsample) / size.y));
+}
 
-    GL_CHECK(glDispatchCompute(Nx / 8, Nz / 8, 1));
+void FFTWater::bake_height_gradient()
+{
+    GL_CHECK(glUseProgram(prog_bake_height_gradient.get()));
+
+    for (auto &cascade : cascades)
+    {
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, cascade.heightmap[texture_index].get()));
+        GL_CHECK(glActiveTexture(GL_TEXTURE1));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, cascade.displacementmap[texture_index].get()));
+
+        // Height and displacement are sampled in vertex shaders only, so stick them together.
+        GL_CHECK(glBindImageTexture(0, cascade.heightdisplacementmap[texture_index].get(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F));
+
+        // Gradients from heightmap and the jacobian are only sampled in fragment, so group them together.
+        GL_CHECK(glBindImageTexture(1, cascade.gradientjacobianmap[texture_index].get(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F));
+
+        set_bake_uniforms(cascade.Nx, cascade.Nz, cascade.size, displacement_downsample);
+        GL_CHECK(glDispatchCompute(cascade.Nx / 8, cascade.Nz / 8, 1));
+    }
     GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+}
+
+void FFTWater::bake_height_gradient_lerp(float lerp)
+{
+    for (unsigned c = 0; c < cascades.size(); c++)
+    {
+        Cascade &cascade = cascades[c];
+
+        // Only the first cascade has a normal map to blend.
+        GL_CHECK(glUseProgram(c == 0 ? prog_bake_height_gradient_lerp.get() : prog_bake_height_gradient_lerp_cascade.get()));
+
+        const GLuint textures[] = {
+            cascade.heightmap[texture_index].get(),
+            cascade.displacementmap[texture_index].get(),
+            c == 0 ? normalmap[texture_index].get() : 0,
+            cascade.heightmap[texture_index ^ 1].get(),
+            cascade.displacementmap[texture_index ^ 1].get(),
+            c == 0 ? normalmap[texture_index ^ 1].get() : 0,
+        };
+
+        for (unsigned i = 0; i < 6; i++)
+        {
+            GL_CHECK(glActiveTexture(GL_TEXTURE0 + i));
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D, textures[i]));
+        }
+
+        GL_CHECK(glBindImageTexture(0, cascade.heightdisplacementmap[output_index].get(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F));
+        GL_CHECK(glBindImageTexture(1, cascade.gradientjacobianmap[output_index].get(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F));
+        if (c == 0)
+        {
+            GL_CHECK(glBindImageTexture(2, blended_normalmap[output_index].get(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32UI));
+        }
+
+        set_bake_uniforms(cascade.Nx, cascade.Nz, cascade.size, displacement_downsample);
+        GL_CHECK(glUniform1f(2, lerp));
+
+        GL_CHECK(glDispatchCompute(cascade.Nx / 8, cascade.Nz / 8, 1));
+    }
+    GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
 }
 
 void FFTWater::compute_mipmap(const Program &program, const Texture &texture, GLenum format, unsigned Nx, unsigned Nz, unsigned l)
@@ -291,86 +646,154 @@ void FFTWater::init_texture(Texture &tex, GLenum format, unsigned levels, unsign
     tex.init(width, height, levels, format, GL_REPEAT, GL_REPEAT, min_filter, mag_filter);
 }
 
+void FFTWater::create_ffts()
+{
+    // Create FFTs for the heightmap and displacementmap of every cascade, and the high-frequency normals.
+    for (auto &cascade : cascades)
+    {
+        cascade.fft_height = unique_ptr<FFT>(new FFT(cascade.Nx, cascade.Nz,
+                    ComplexToReal, Inverse, SSBO, ImageReal, fft_cache, fft_options, wisdom));
+        cascade.fft_displacement = unique_ptr<FFT>(new FFT(cascade.Nx >> displacement_downsample, cascade.Nz >> displacement_downsample,
+                    ComplexToComplex, Inverse, SSBO, Image, fft_cache, fft_options, wisdom));
+    }
+    fft_normal = unique_ptr<FFT>(new FFT(Nx, Nz,
+                ComplexToComplex, Inverse, SSBO, Image, fft_cache, fft_options, wisdom));
+}
+
+void FFTWater::validate_ffts()
+{
+    // The plans write images, which are not read back, so validate their SSBO twins with the same options and wisdom.
+    double height_error = CPUFFT::validate(Nx, Nz,
+            ComplexToReal, Inverse, fft_cache, fft_options, wisdom);
+    double displacement_error = CPUFFT::validate(Nx >> displacement_downsample, Nz >> displacement_downsample,
+            ComplexToComplex, Inverse, fft_cache, fft_options, wisdom);
+    double normal_error = CPUFFT::validate(Nx, Nz,
+            ComplexToComplex, Inverse, fft_cache, fft_options, wisdom);
+
+    LOGI("FFT relative error against CPU reference: height %g, displacement %g, normal %g.\n",
+            height_error, displacement_error, normal_error);
+
+    for (unsigned i = 1; i < cascades.size(); i++)
+    {
+        const Cascade &cascade = cascades[i];
+        height_error = CPUFFT::validate(cascade.Nx, cascade.Nz,
+                ComplexToReal, Inverse, fft_cache, fft_options, wisdom);
+        displacement_error = CPUFFT::validate(cascade.Nx >> displacement_downsample, cascade.Nz >> displacement_downsample,
+                ComplexToComplex, Inverse, fft_cache, fft_options, wisdom);
+        LOGI("FFT relative error against CPU reference, cascade %u: height %g, displacement %g.\n",
+                i, height_error, displacement_error);
+    }
+}
+
 void FFTWater::init_gl_fft()
 {
     // Compile compute shaders.
-    prog_generate_height = Program(common_compile_compute_shader_from_file("water_generate_height.comp"));
-    prog_generate_displacement = Program(common_compile_compute_shader_from_file("water_generate_displacement.comp"));
-    prog_generate_normal = Program(common_compile_compute_shader_from_file("water_generate_normal.comp"));
+    // Distributions and spectra are stored as half2 in FP16 mode, and as vec2 otherwise.
+    const char *defines = fp16 ? "#define WATER_FP16\n" : "";
+    prog_generate_height = Program(common_compile_compute_shader_from_file("water_generate_height.comp", defines));
+    prog_generate_displacement = Program(common_compile_compute_shader_from_file("water_generate_displacement.comp", defines));
+    prog_generate_normal = Program(common_compile_compute_shader_from_file("water_generate_normal.comp", defines));
 
     prog_bake_height_gradient = Program(common_compile_compute_shader_from_file("bake_height_gradient.comp"));
+    prog_bake_height_gradient_lerp = Program(common_compile_compute_shader_from_file("bake_height_gradient_lerp.comp"));
+    if (cascades.size() > 1)
+    {
+        prog_bake_height_gradient_lerp_cascade = Program(common_compile_compute_shader_from_file("bake_height_gradient_lerp.comp",
+                    "#define DETAIL_CASCADE\n"));
+    }
     prog_mipmap_height = Program(common_compile_compute_shader_from_file("mipmap_height.comp"));
     prog_mipmap_normal = Program(common_compile_compute_shader_from_file("mipmap_normal.comp"));
     prog_mipmap_gradient_jacobian = Program(common_compile_compute_shader_from_file("mipmap_gradjacobian.comp"));
 
-    auto cache = make_shared<ProgramCache>();
+    fft_cache = make_shared<ProgramCache>();
 
     // Use FP16 FFT.
-    FFTOptions options;
-    options.type.fp16 = FFT_FP16;
-    options.type.input_fp16 = FFT_FP16;
-    options.type.output_fp16 = FFT_FP16;
+    fft_options.type.fp16 = fp16;
+    fft_options.type.input_fp16 = fp16;
+    fft_options.type.output_fp16 = fp16;
 
     // Sensible default values for Mali.
-    options.performance.workgroup_size_x = 8;
-    options.performance.workgroup_size_y = 4;
-    options.performance.vector_size = 4;
-    options.performance.shared_banked = false;
-
-    // Create three FFTs for heightmap, displacementmap and high-frequency normals.
-    fft_height = unique_ptr<FFT>(new FFT(Nx, Nz,
-                ComplexToReal, Inverse, SSBO, ImageReal, cache, options));
-    fft_displacement = unique_ptr<FFT>(new FFT(Nx >> displacement_downsample, Nz >> displacement_downsample,
-                ComplexToComplex, Inverse, SSBO, Image, cache, options));
-    fft_normal = unique_ptr<FFT>(new FFT(Nx, Nz,
-                ComplexToComplex, Inverse, SSBO, Image, move(cache), options));
+    fft_options.performance.workgroup_size_x = 8;
+    fft_options.performance.workgroup_size_y = 4;
+    fft_options.performance.vector_size = 4;
+    fft_options.performance.shared_banked = false;
+
+#if FFT_WISDOM
+    // Start with the stored wisdom, or the defaults above, and learn what is missing in update() a little every frame.
+    wisdom_device = get_wisdom_device();
+    wisdom.set_static_wisdom(FFTWisdom::get_static_wisdom_from_renderer((const char*)glGetString(GL_RENDERER)));
+    wisdom.set_bench_params(1, 4, 4, FFT_WISDOM_FRAME_BUDGET);
+    load_wisdom(wisdom, wisdom_device);
+
+    for (auto &cascade : cascades)
+    {
+        wisdom.queue_optimal_options_exhaustive(cascade.Nx, cascade.Nz, ComplexToReal, SSBO, ImageReal, fft_options.type);
+        wisdom.queue_optimal_options_exhaustive(cascade.Nx >> displacement_downsample, cascade.Nz >> displacement_downsample,
+                ComplexToComplex, SSBO, Image, fft_options.type);
+    }
+    wisdom.queue_optimal_options_exhaustive(Nx, Nz, ComplexToComplex, SSBO, Image, fft_options.type);
+#endif
+
+    create_ffts();
+#if FFT_VALIDATE
+    validate_ffts();
+#endif
 
     normal_levels = unsigned(log2(max(float(Nx), float(Nz)))) + 1;
 
     for (unsigned i = 0; i < 2; i++)
     {
-        // R32F since GLES 3.1 does not support r16f format for image load/store.
-        init_texture(heightmap[i],
-                GL_R32F, 1,
-                Nx, Nz,
-                GL_NEAREST,
-                GL_NEAREST);
-
-        init_texture(displacementmap[i],
-                GL_RG16F, 1,
-                Nx >> displacement_downsample, Nz >> displacement_downsample,
-                GL_LINEAR,
-                GL_LINEAR);
-
         // Ignore the two highest mipmap levels, since we would like to avoid micro dispatches that just write 1 texel.
         init_texture(normalmap[i], GL_RG16F, normal_levels - 2, Nx, Nz, GL_LINEAR, GL_LINEAR_MIPMAP_LINEAR);
+    }
 
-        init_texture(heightdisplacementmap[i],
-                GL_RGBA16F, normal_levels - 2,
-                Nx, Nz,
-                GL_LINEAR,
-                GL_LINEAR_MIPMAP_NEAREST);
+    for (auto &cascade : cascades)
+    {
+        unsigned levels = unsigned(log2(max(float(cascade.Nx), float(cascade.Nz)))) + 1;
+        unsigned count = cascade.Nx * cascade.Nz;
 
-        init_texture(gradientjacobianmap[i],
-                GL_RGBA16F, normal_levels - 2,
-                Nx, Nz,
-                GL_LINEAR,
-                GL_LINEAR_MIPMAP_LINEAR);
-    }
+        for (unsigned i = 0; i < 2; i++)
+        {
+            // R32F since GLES 3.1 does not support r16f format for image load/store.
+            init_texture(cascade.heightmap[i],
+                    GL_R32F, 1,
+                    cascade.Nx, cascade.Nz,
+                    GL_NEAREST,
+                    GL_NEAREST);
+
+            init_texture(cascade.displacementmap[i],
+                    GL_RG16F, 1,
+                    cascade.Nx >> displacement_downsample, cascade.Nz >> displacement_downsample,
+                    GL_LINEAR,
+                    GL_LINEAR);
+
+            init_texture(cascade.heightdisplacementmap[i],
+                    GL_RGBA16F, levels - 2,
+                    cascade.Nx, cascade.Nz,
+                    GL_LINEAR,
+                    GL_LINEAR_MIPMAP_NEAREST);
+
+            init_texture(cascade.gradientjacobianmap[i],
+                    GL_RGBA16F, levels - 2,
+                    cascade.Nx, cascade.Nz,
+                    GL_LINEAR,
+                    GL_LINEAR_MIPMAP_LINEAR);
+        }
 
-    distribution_buffer.init(distribution.data(), Nx * Nz * sizeof(cfloat), GL_STATIC_COPY);
-    distribution_buffer_displacement.init(distribution_displacement.data(),
-            (Nx * Nz * sizeof(cfloat)) >> (displacement_downsample * 2),
-            GL_STATIC_COPY);
-    distribution_buffer_normal.init(distribution_normal.data(), Nx * Nz * sizeof(cfloat), GL_STATIC_COPY);
+        init_distribution_buffer(cascade.distribution_buffer, cascade.distribution.data(), count, fp16);
+        init_distribution_buffer(cascade.distribution_buffer_displacement, cascade.distribution_displacement.data(),
+                count >> (displacement_downsample * 2), fp16);
+        cascade.distribution.clear();
+        cascade.distribution_displacement.clear();
 
-    distribution.clear();
-    distribution_displacement.clear();
-    distribution_normal.clear();
+        // Copy distributions to the GPU.
+        cascade.freq_height.init(nullptr, (count * sizeof(cfloat)) >> unsigned(fp16), GL_STREAM_COPY);
+        cascade.freq_displacement.init(nullptr, ((count * sizeof(cfloat)) >> unsigned(fp16)) >> (displacement_downsample * 2),
+                GL_STREAM_COPY);
+    }
 
-    // Copy distributions to the GPU.
-    freq_height.init(nullptr, (Nx * Nz * sizeof(cfloat)) >> FFT_FP16, GL_STREAM_COPY);
-    freq_normal.init(nullptr, (Nx * Nz * sizeof(cfloat)) >> FFT_FP16, GL_STREAM_COPY);
-    freq_displacement.init(nullptr, ((Nx * Nz * sizeof(cfloat)) >> FFT_FP16) >> (displacement_downsample * 2), GL_STREAM_COPY);
+    init_distribution_buffer(distribution_buffer_normal, distribution_normal.data(), Nx * Nz, fp16);
+    distribution_normal.clear();
+    freq_normal.init(nullptr, (Nx * Nz * sizeof(cfloat)) >> unsigned(fp16), GL_STREAM_COPY);
 }
 
@@ -22,6 +22,7 @@
 #define FFTWATER_HPP__
 
 #include "vector_math.h"
+#include <cmath>
 #include <complex>
 #include <random>
 #include <vector>
@@ -33,6 +34,14 @@ using cfloat = std::complex<float>;
 
 class FFTWater
 {
+    public:
+        // A finer cascade simulated on top of the heightmap, over its own patch size and with its own FFT resolution.
+        struct CascadeInfo
+        {
+            uvec2 resolution;
+            vec2 size;
+        };
+
     private:
         cfloat phillips(vec2 k, float max_l);
 
@@ -42,19 +51,20 @@ class FFTWater
         vec2 size, size_normal;
         float L;
 
-        void generate_distribution(cfloat *distribution, vec2 size, float amplitude, float max_l);
+        void generate_distribution(cfloat *distribution, unsigned Nx, unsigned Nz, vec2 size, float amplitude, float max_l,
+                float min_k = 0.0f, float max_k = INFINITY);
 
         void generate_mipmaps();
         void compute_ifft();
         void bake_height_gradient();
+        void bake_height_gradient_lerp(float lerp);
         void update_phase(float time);
+        void simulate(float time);
 
         std::normal_distribution<float> normal_dist{0.0f, 1.0f};
         std::default_random_engine engine;
         constexpr static float G = 9.81f;
 
-        std::vector<cfloat> distribution;
-        std::vector<cfloat> distribution_displacement;
         std::vector<cfloat> distribution_normal;
 
         GLFFT::Program prog_generate_height;
@@ -62,36 +72,67 @@ class FFTWater
         GLFFT::Program prog_generate_displacement;
 
         GLFFT::Program prog_bake_height_gradient;
+        GLFFT::Program prog_bake_height_gradient_lerp;
+        GLFFT::Program prog_bake_height_gradient_lerp_cascade;
         GLFFT::Program prog_mipmap_height;
         GLFFT::Program prog_mipmap_normal;
         GLFFT::Program prog_mipmap_gradient_jacobian;
+        GLFFT::Program prog_readback;
+
+        // Cascade 0 is the heightmap the mesh is built for, the others add finer waves from smaller patches.
+        // Each simulates its own band of the spectrum, so that the cascades add up to a single ocean.
+        struct Cascade
+        {
+            unsigned Nx, Nz;
+            vec2 size;
+
+            std::vector<cfloat> distribution;
+            std::vector<cfloat> distribution_displacement;
+
+            GLFFT::Buffer distribution_buffer;
+            GLFFT::Buffer distribution_buffer_displacement;
+            GLFFT::Buffer freq_height;
+            GLFFT::Buffer freq_displacement;
+            std::unique_ptr<GLFFT::FFT> fft_height;
+            std::unique_ptr<GLFFT::FFT> fft_displacement;
+
+            GLFFT::Texture heightmap[2];
+            GLFFT::Texture displacementmap[2];
+            GLFFT::Texture heightdisplacementmap[2];
+            GLFFT::Texture gradientjacobianmap[2];
+        };
+        std::vector<Cascade> cascades;
 
-        GLFFT::Texture heightmap[2];
-        GLFFT::Texture displacementmap[2];
         GLFFT::Texture normalmap[2];
+        GLFFT::Texture blended_normalmap[2];
 
-        GLFFT::Texture heightdisplacementmap[2];
-        GLFFT::Texture gradientjacobianmap[2];
-
+        // texture_index selects the newest FFT results, output_index the newest baked textures.
+        // They only differ when the simulation runs at a lower rate than update() is called.
         unsigned texture_index = 0;
+        unsigned output_index = 0;
+        float simulation_period = 0.0f;
+        float next_simulation_time = 0.0f;
+        bool simulation_started = false;
         unsigned normal_levels = 0;
         unsigned displacement_downsample = 0;
 
-        GLFFT::Buffer distribution_buffer;
-        GLFFT::Buffer distribution_buffer_displacement;
         GLFFT::Buffer distribution_buffer_normal;
-        GLFFT::Buffer freq_height;
-        GLFFT::Buffer freq_displacement;
         GLFFT::Buffer freq_normal;
-        std::unique_ptr<GLFFT::FFT> fft_height;
-        std::unique_ptr<GLFFT::FFT> fft_displacement;
         std::unique_ptr<GLFFT::FFT> fft_normal;
+        std::shared_ptr<GLFFT::ProgramCache> fft_cache;
+        GLFFT::FFTOptions fft_options;
+        GLFFT::FFTWisdom wisdom;
+        std::string wisdom_device;
+        std::vector<GLFFT::FFT::BatchJob> batch_jobs;
         void init_gl_fft();
-        void downsample_distribution(cfloat *out, const cfloat *in, unsigned rate_log2);
+        void create_ffts();
+        void validate_ffts();
+        void downsample_distribution(cfloat *out, const cfloat *in, unsigned Nx, unsigned Nz, unsigned rate_log2);
         void compute_mipmap(const GLFFT::Program &program, const GLFFT::Texture &texture, GLenum format, unsigned Nx, unsigned Nz, unsigned level);
         void init_texture(GLFFT::Texture &tex, GLenum format, unsigned levels, unsigned width, unsigned height, GLenum mag_filter, GLenum min_filter);
 
         bool mipmap_fp16;
+        bool fp16;
 
     public:
         FFTWater(
@@ -99,13 +140,32 @@ class FFTWater
                 vec2 wind_velocity,
                 uvec2 resolution,
                 vec2 size,
-                vec2 normalmap_freq_mod);
+                vec2 normalmap_freq_mod,
+                bool fp16 = true,
+                const std::vector<CascadeInfo> &detail_cascades = std::vector<CascadeInfo>());
 
         void update(float time);
 
-        GLuint get_height_displacement() const { return heightdisplacementmap[texture_index].get(); }
-        GLuint get_gradient_jacobian() const  { return gradientjacobianmap[texture_index].get(); }
-        GLuint get_normal() const { return normalmap[texture_index].get(); }
+        // Run the spectrum simulation at a fixed rate (in Hz) instead of on every update().
+        // update() then blends the two most recent simulation steps. A rate of 0 simulates every update().
+        void set_simulation_rate(float rate);
+
+        // Read back the top level of the current water textures, two vec4s per texel:
+        // (height, displacement.xy, jacobian) and (gradient.xy, normal.xy). Stalls, so only meant for debugging.
+        void read_back(std::vector<vec4> &texels);
+
+        // Cascade 0 is the heightmap, the detail cascades follow in the order they were given.
+        unsigned get_cascades() const { return cascades.size(); }
+        uvec2 get_cascade_resolution(unsigned cascade) const { return uvec2(cascades[cascade].Nx, cascades[cascade].Nz); }
+        vec2 get_cascade_size(unsigned cascade) const { return cascades[cascade].size; }
+
+        GLuint get_height_displacement(unsigned cascade = 0) const { return cascades[cascade].heightdisplacementmap[output_index].get(); }
+        GLuint get_gradient_jacobian(unsigned cascade = 0) const  { return cascades[cascade].gradientjacobianmap[output_index].get(); }
+        GLuint get_normal() const { return get_normalmap().get(); }
+        const GLFFT::Texture &get_normalmap() const
+        {
+            return simulation_period > 0.0f ? blended_normalmap[output_index] : normalmap[texture_index];
+        }
         unsigned get_displacement_downsample() const { return displacement_downsample; }
 };
 
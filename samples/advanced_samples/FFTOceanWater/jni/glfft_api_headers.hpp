@@ -28,6 +28,9 @@ double app_get_time();
 #define GLFFT_LOG_OVERRIDE LOGI
 #define GLFFT_READ_FILE_STRING_OVERRIDE common_read_file_string
 #define GLFFT_TIME_OVERRIDE app_get_time
+#define GLFFT_LOAD_PROGRAM_OVERRIDE common_load_program_binary
+#define GLFFT_PREPARE_PROGRAM_OVERRIDE common_prepare_program_binary
+#define GLFFT_STORE_PROGRAM_OVERRIDE common_store_program_binary
 #define GLFFT_GLSL_LANG_STRING "#version 310 es\n"
 
 #endif
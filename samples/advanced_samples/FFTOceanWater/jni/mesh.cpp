@@ -21,6 +21,7 @@
 #include "common.hpp"
 #include "vector_math.h"
 #include "mesh.hpp"
+#include "FrustumCulling.h"
 #include <limits.h>
 
 #include <vector>
@@ -29,6 +30,8 @@
 
 using namespace std;
 
+constexpr unsigned Mesh::detail_cascades;
+
 constexpr float TessellatedMesh::patch_size;
 constexpr float TessellatedMesh::lod0_distance; 
 constexpr unsigned TessellatedMesh::blocks_x;
@@ -141,10 +144,30 @@ void Mesh::bind_textures(const RenderInfo &info)
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, info.normal));
     GL_CHECK(glActiveTexture(GL_TEXTURE0 + 3));
     GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, info.skydome));
+
+    // The detail cascades are sampled in world space, and their mipmaps are biased from the heightmap's
+    // by the ratio of texel sizes so that they are filtered to the vertex spacing. Expects prog to be bound.
+    vec4 cascade_scale[detail_cascades];
+    float cascade_lod_bias[detail_cascades];
+    float texel_size = info.tile_extent.x / info.fft_size.x;
+    for (unsigned i = 0; i < detail_cascades; i++)
+    {
+        const RenderInfo::Cascade &cascade = info.cascades[i];
+        GL_CHECK(glActiveTexture(GL_TEXTURE0 + 5 + i));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, cascade.height_displacement));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0 + 5 + detail_cascades + i));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, cascade.gradient_jacobian));
+
+        cascade_scale[i] = vec4(vec2(1.0f) / cascade.tile_extent, vec2(1.0f) / vec2(cascade.fft_size));
+        cascade_lod_bias[i] = log2(texel_size * cascade.fft_size.x / cascade.tile_extent.x);
+    }
+    GL_CHECK(glUniform4fv(16, detail_cascades, value_ptr(cascade_scale[0])));
+    GL_CHECK(glUniform1fv(18, detail_cascades, cascade_lod_bias));
 }
 
-MorphedGeoMipMapMesh::MorphedGeoMipMapMesh()
-    : Mesh("water.vs", "water.fs")
+MorphedGeoMipMapMesh::MorphedGeoMipMapMesh(bool gpu_lods)
+    : Mesh(gpu_lods && supports_gpu_lods() ? "water_indirect.vs" : "water.vs", "water.fs"),
+      gpu_lods(gpu_lods && supports_gpu_lods())
 {
     init();
 }
@@ -155,39 +178,60 @@ static inline float lod_factor(float max_lod, float distance_mod, vec3 dist)
     return clamp(level, 0.0f, max_lod);
 }
 
-void MorphedGeoMipMapMesh::calculate_lods(const RenderInfo &info)
+void MorphedGeoMipMapMesh::calculate_lods_range(unsigned int begin, unsigned int end, void *data)
 {
-    vec2 patch_size_mod = vec2(patch_size) * info.tile_extent / vec2(info.fft_size);
-
-    vec2 scale = info.tile_extent / vec2(info.fft_size);
-    ivec2 block_off = ivec2(vec_round(vec2(info.cam_pos.x, info.cam_pos.z) / patch_size_mod));
-    block_off -= ivec2(blocks_x >> 1, blocks_z >> 1);
-    vec2 block_offset = vec2(patch_size) * vec2(block_off);
+    static_cast<MorphedGeoMipMapMesh*>(data)->calculate_patch_lods(begin, end);
+}
 
-    float distance_mod = 1.0f / ((info.vp_width / 1920.0f) * lod0_distance);
-    vec3 cam_pos = info.cam_pos;
+void MorphedGeoMipMapMesh::calculate_patch_lods(unsigned first_row, unsigned end_row)
+{
+    const LODParameters &params = lod_parameters;
+    const vec2 half_block = params.scale * vec2(0.5f * patch_size);
+    const size_t first = first_row * blocks_x;
+    const size_t end = end_row * blocks_x;
 
-    // Compute LOD and visibility.
-    for (auto &patch : patches)
+    // Compute LOD, and gather bounding spheres so that visibility can be tested in one batch.
+    for (size_t i = first; i < end; i++)
     {
-        const vec2 half_block = scale * vec2(0.5f * patch_size);
+        auto &patch = patches[i];
 
-        vec2 newpos = scale * (patch.pos + block_offset) + half_block;
-        vec3 dist = cam_pos - vec3(newpos.x, 0.0f, newpos.y);
-        patch.lod = lod_factor(lods - 1.0f, distance_mod, dist);
+        vec2 newpos = params.scale * (patch.pos + params.block_offset) + half_block;
+        vec3 dist = params.cam_pos - vec3(newpos.x, 0.0f, newpos.y);
+        patch.lod = lod_factor(lods - 1.0f, params.distance_mod, dist);
 
         BoundingSphere bs(vec3(newpos.x, 0.0f, newpos.y), vec3(10.0f + half_block.x, 20.0f, 10.0f + half_block.y));
-        patch.visible = bs.test_frustum(info.frustum);
+        cull_center_x[i] = bs.center.x;
+        cull_center_y[i] = bs.center.y;
+        cull_center_z[i] = bs.center.z;
+        cull_radius[i] = bs.radius;
     }
 
-    for (unsigned z = 0; z < blocks_z; z++)
+    FrustumCulling::SphereBatch spheres = { &cull_center_x[first], &cull_center_y[first], &cull_center_z[first], &cull_radius[first] };
+    FrustumCulling::testSpheres(params.frustum, spheres, end - first, &cull_visible[first]);
+    for (size_t i = first; i < end; i++)
     {
-        for (unsigned x = 0; x < blocks_x; x++)
-        {
-            float lod = patches[z * blocks_x + x].lod;
-            lod_buffer[z * blocks_x + x] = lod;
-        }
+        patches[i].visible = cull_visible[i] != 0;
+        lod_buffer[i] = patches[i].lod;
     }
+}
+
+void MorphedGeoMipMapMesh::calculate_lods(const RenderInfo &info)
+{
+    vec2 patch_size_mod = vec2(patch_size) * info.tile_extent / vec2(info.fft_size);
+
+    vec2 scale = info.tile_extent / vec2(info.fft_size);
+    ivec2 block_off = ivec2(vec_round(vec2(info.cam_pos.x, info.cam_pos.z) / patch_size_mod));
+    block_off -= ivec2(blocks_x >> 1, blocks_z >> 1);
+    vec2 block_offset = vec2(patch_size) * vec2(block_off);
+
+    lod_parameters.scale = scale;
+    lod_parameters.block_offset = block_offset;
+    lod_parameters.cam_pos = info.cam_pos;
+    lod_parameters.distance_mod = 1.0f / ((info.vp_width / 1920.0f) * lod0_distance);
+    lod_parameters.frustum = info.frustum[0].data;
+
+    // Compute LOD and visibility of every patch, in jobs of a few rows. Rows only touch their own patches.
+    job_scheduler.parallelFor("calculate_lods", blocks_z, 4, calculate_lods_range, this);
 
     // Upload the LOD texture to a PBO first.
     GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo));
@@ -211,17 +255,6 @@ void MorphedGeoMipMapMesh::calculate_lods(const RenderInfo &info)
     for (auto &lod : lod_meshes)
         lod.full.instances = 0;
 
-    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, ubo));
-    GL_CHECK(PatchData *ubo_data = static_cast<PatchData*>(glMapBufferRange(GL_UNIFORM_BUFFER,
-                0, lods * blocks_x * blocks_z * sizeof(PatchData),
-                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)));
-
-    if (!ubo_data)
-    {
-        LOGE("Failed to map buffer!");
-        return;
-    }
-
     // Fill in instancing info for all patches.
     for (unsigned z = 0; z < blocks_z; z++)
     {
@@ -252,28 +285,99 @@ void MorphedGeoMipMapMesh::calculate_lods(const RenderInfo &info)
 
             auto &lod = lod_meshes[center_lod];
 
-            unsigned ubo_offset = center_lod * blocks_x * blocks_z;
+            auto &data = patch_data[center_lod * blocks_x * blocks_z + lod.full.instances];
 
-            ubo_data[ubo_offset + lod.full.instances].Offsets = vec4(
+            data.Offsets = vec4(
                     patches[z * blocks_x + x].pos + block_offset, // Offset to world space.
                     patches[z * blocks_x + x].pos);
-            ubo_data[ubo_offset + lod.full.instances].LODs = vec4(left_lod, top_lod, right_lod, bottom_lod);
-            ubo_data[ubo_offset + lod.full.instances].InnerLOD = vec4(center);
+            data.LODs = vec4(left_lod, top_lod, right_lod, bottom_lod);
+            data.InnerLOD = vec4(center);
 
             lod.full.instances++;
         }
     }
+}
 
-    GL_CHECK(glUnmapBuffer(GL_UNIFORM_BUFFER));
+bool MorphedGeoMipMapMesh::supports_gpu_lods()
+{
+    // Storage buffers in vertex shaders are optional in GLES 3.1.
+    GLint max_vertex_ssbos = 0;
+    GL_CHECK(glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &max_vertex_ssbos));
+    if (max_vertex_ssbos < 1)
+    {
+        LOGI("No SSBO support in vertex shaders, computing patch LODs on the CPU.\n");
+        return false;
+    }
+    return true;
 }
 
-void MorphedGeoMipMapMesh::LODMesh::draw(GLuint ubo, unsigned ubo_offset)
+void MorphedGeoMipMapMesh::calculate_lods_gpu(const RenderInfo &info)
 {
-    // Draw everything with instancing.
+    vec2 patch_size_mod = vec2(patch_size) * info.tile_extent / vec2(info.fft_size);
+
+    vec2 scale = info.tile_extent / vec2(info.fft_size);
+    ivec2 block_off = ivec2(vec_round(vec2(info.cam_pos.x, info.cam_pos.z) / patch_size_mod));
+    block_off -= ivec2(blocks_x >> 1, blocks_z >> 1);
+    vec2 block_offset = vec2(patch_size) * vec2(block_off);
+
+    float distance_mod = 1.0f / ((info.vp_width / 1920.0f) * lod0_distance);
+
+    // Reset the instance counts, the compute shader appends visible patches to them.
+    IndirectCommand commands[lods];
+    for (unsigned i = 0; i < lods; i++)
+    {
+        commands[i].count = lod_meshes[i].full.elems;
+        commands[i].instance_count = 0;
+        commands[i].first_index = lod_meshes[i].full.offset;
+        commands[i].base_vertex = 0;
+        commands[i].reserved_must_be_zero = 0;
+    }
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer));
+    GL_CHECK(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(commands), commands));
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+
+    GL_CHECK(glUseProgram(prog_patch_lod));
+    GL_CHECK(glUniform4fv(0, 6, value_ptr(info.frustum[0])));
+    GL_CHECK(glUniform3fv(6, 1, value_ptr(info.cam_pos)));
+    GL_CHECK(glUniform2fv(7, 1, value_ptr(scale)));
+    GL_CHECK(glUniform2fv(8, 1, value_ptr(block_offset)));
+    GL_CHECK(glUniform1f(9, distance_mod));
+    GL_CHECK(glUniform1f(10, lods - 1.0f));
+    GL_CHECK(glUniform1f(11, float(patch_size)));
+    GL_CHECK(glUniform2ui(12, blocks_x, blocks_z));
+
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, patch_ssbo));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, indirect_buffer));
+    GL_CHECK(glBindImageTexture(0, lod_tex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8));
+
+    GL_CHECK(glDispatchCompute((blocks_x + 7) / 8, (blocks_z + 7) / 8, 1));
+    GL_CHECK(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT));
+}
+
+void MorphedGeoMipMapMesh::LODMesh::upload(UniformBufferRing &ring, const PatchData *data)
+{
+    // Every draw binds a whole block of max_instances, so allocate that much even for a partial batch.
+    ubo_offsets.clear();
     for (unsigned i = 0; i < instances; i += max_instances)
     {
         unsigned to_draw = min(instances - i, max_instances);
-        GL_CHECK(glBindBufferRange(GL_UNIFORM_BUFFER, 0, ubo, i * sizeof(PatchData) + ubo_offset, max_instances * sizeof(PatchData)));
+        GLintptr ubo_offset;
+        void *ptr = ring.allocate(max_instances * sizeof(PatchData), &ubo_offset);
+        if (!ptr)
+            break;
+
+        memcpy(ptr, data + i, to_draw * sizeof(PatchData));
+        ubo_offsets.push_back(ubo_offset);
+    }
+}
+
+void MorphedGeoMipMapMesh::LODMesh::draw(const UniformBufferRing &ring)
+{
+    // Draw everything with instancing.
+    for (unsigned i = 0; i < ubo_offsets.size(); i++)
+    {
+        unsigned to_draw = min(instances - i * max_instances, max_instances);
+        ring.bindRange(0, ubo_offsets[i], max_instances * sizeof(PatchData));
         GL_CHECK(glDrawElementsInstanced(GL_TRIANGLE_STRIP, elems, GL_UNSIGNED_SHORT,
                 reinterpret_cast<const GLvoid*>(uintptr_t(offset * sizeof(GLushort))),
                 to_draw));
@@ -282,11 +386,23 @@ void MorphedGeoMipMapMesh::LODMesh::draw(GLuint ubo, unsigned ubo_offset)
 
 void MorphedGeoMipMapMesh::render(const RenderInfo &info)
 {
+    if (gpu_lods)
+    {
+        calculate_lods_gpu(info);
+    }
+    else
+    {
+        calculate_lods(info);
+
+        patch_ring->beginFrame();
+        for (unsigned i = 0; i < lods; i++)
+            lod_meshes[i].full.upload(*patch_ring, &patch_data[i * blocks_x * blocks_z]);
+        patch_ring->flush();
+    }
+
     GL_CHECK(glUseProgram(prog));
     GL_CHECK(glBindVertexArray(vao));
 
-    calculate_lods(info);
-
     GL_CHECK(glUniformMatrix4fv(0, 1, GL_FALSE, value_ptr(info.mvp)));
     GL_CHECK(glUniform4fv(1, 1, value_ptr(vec4(info.tile_extent / vec2(info.fft_size),
                     info.normal_scale.x, info.normal_scale.y))));
@@ -306,12 +422,29 @@ void MorphedGeoMipMapMesh::render(const RenderInfo &info)
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, lod_tex));
 
     GL_CHECK(glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX));
-    for (unsigned i = 0; i < lods; i++)
-        lod_meshes[i].full.draw(ubo, i * blocks_x * blocks_z * sizeof(PatchData));
+    if (gpu_lods)
+    {
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, patch_ssbo));
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer));
+        for (unsigned i = 0; i < lods; i++)
+        {
+            GL_CHECK(glUniform1ui(7, i * blocks_x * blocks_z));
+            GL_CHECK(glDrawElementsIndirect(GL_TRIANGLE_STRIP, GL_UNSIGNED_SHORT,
+                    reinterpret_cast<const GLvoid*>(uintptr_t(i * sizeof(IndirectCommand)))));
+        }
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+    }
+    else
+    {
+        for (unsigned i = 0; i < lods; i++)
+            lod_meshes[i].full.draw(*patch_ring);
+        patch_ring->endFrame();
+    }
     GL_CHECK(glDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX));
 
     GL_CHECK(glBindVertexArray(0));
     GL_CHECK(glBindBufferBase(GL_UNIFORM_BUFFER, 0, 0));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0));
 }
 
 void MorphedGeoMipMapMesh::build_lod(unsigned lod)
@@ -371,7 +504,8 @@ void MorphedGeoMipMapMesh::init_lod_tex()
 {
     GL_CHECK(glGenTextures(1, &lod_tex));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, lod_tex));
-    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, blocks_x, blocks_z));
+    // The GPU path writes LODs with image stores, and there is no r8 image format.
+    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, gpu_lods ? GL_RGBA8 : GL_R8, blocks_x, blocks_z));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
@@ -384,8 +518,13 @@ void MorphedGeoMipMapMesh::init_lod_tex()
 MorphedGeoMipMapMesh::~MorphedGeoMipMapMesh()
 {
     GL_CHECK(glDeleteTextures(1, &lod_tex));
-    GL_CHECK(glDeleteBuffers(1, &ubo));
     GL_CHECK(glDeleteBuffers(1, &pbo));
+    GL_CHECK(glDeleteBuffers(1, &patch_ssbo));
+    GL_CHECK(glDeleteBuffers(1, &indirect_buffer));
+    if (prog_patch_lod)
+    {
+        GL_CHECK(glDeleteProgram(prog_patch_lod));
+    }
 }
 
 void MorphedGeoMipMapMesh::init()
@@ -400,17 +539,44 @@ void MorphedGeoMipMapMesh::init()
     // Create LOD texture.
     init_lod_tex();
 
-    // Create an UBO large enough to hold PatchData for all LODs.
-    GL_CHECK(glGenBuffers(1, &ubo));
-    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, ubo));
-    GL_CHECK(glBufferData(GL_UNIFORM_BUFFER, lods * blocks_x * blocks_z * sizeof(PatchData), nullptr, GL_STREAM_DRAW));
-    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+    if (gpu_lods)
+    {
+        prog_patch_lod = common_compile_compute_shader_from_file("water_patch_lod.comp");
+        if (!prog_patch_lod)
+        {
+            throw runtime_error("Failed to compile shader.");
+        }
 
-    // Create a PBO for updating LOD texture.
-    GL_CHECK(glGenBuffers(1, &pbo));
-    GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo));
-    GL_CHECK(glBufferData(GL_PIXEL_UNPACK_BUFFER, blocks_x * blocks_z, nullptr, GL_STREAM_DRAW));
-    GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        // Patch data is written and read on the GPU only.
+        GL_CHECK(glGenBuffers(1, &patch_ssbo));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, patch_ssbo));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, lods * blocks_x * blocks_z * sizeof(PatchData), nullptr, GL_DYNAMIC_COPY));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+        GL_CHECK(glGenBuffers(1, &indirect_buffer));
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer));
+        GL_CHECK(glBufferData(GL_DRAW_INDIRECT_BUFFER, lods * sizeof(IndirectCommand), nullptr, GL_DYNAMIC_DRAW));
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+    }
+    else
+    {
+        // Worst case, every LOD ends with a partial batch. Leave room for aligning each batch as well.
+        patch_data.resize(lods * blocks_x * blocks_z);
+        cull_center_x.resize(patches.size());
+        cull_center_y.resize(patches.size());
+        cull_center_z.resize(patches.size());
+        cull_radius.resize(patches.size());
+        cull_visible.resize(patches.size());
+        job_scheduler.initialize(0);
+        unsigned max_batches = (blocks_x * blocks_z) / max_instances + lods;
+        patch_ring.reset(new UniformBufferRing(max_batches * (max_instances * sizeof(PatchData) + 256)));
+
+        // Create a PBO for updating LOD texture.
+        GL_CHECK(glGenBuffers(1, &pbo));
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo));
+        GL_CHECK(glBufferData(GL_PIXEL_UNPACK_BUFFER, blocks_x * blocks_z, nullptr, GL_STREAM_DRAW));
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+    }
 
     // Set up VAO.
     GL_CHECK(glBindVertexArray(vao));
@@ -23,11 +23,17 @@
 
 #include "common.hpp"
 #include "vector_math.h"
+#include "JobScheduler.h"
+#include "UniformBufferRing.h"
 #include <vector>
+#include <memory>
 
 class Mesh
 {
     public:
+        // Number of FFTWater detail cascades the water shaders add to the heightmap.
+        static constexpr unsigned detail_cascades = 2;
+
         struct RenderInfo
         {
             // MVP for rendering.
@@ -66,6 +72,16 @@ class Mesh
 
             // Downsampling factor displacement map.
             unsigned displacement_downsample;
+
+            // Finer waves added to the heightmap, each tiling over its own extent.
+            struct Cascade
+            {
+                GLuint height_displacement;
+                GLuint gradient_jacobian;
+                uvec2 fft_size;
+                vec2 tile_extent;
+            };
+            Cascade cascades[detail_cascades];
         };
 
         virtual ~Mesh();
@@ -85,7 +101,9 @@ class Mesh
 class MorphedGeoMipMapMesh : public Mesh
 {
     public:
-        MorphedGeoMipMapMesh();
+        // With gpu_lods, LOD selection and culling run in a compute shader and patches are drawn with indirect draws.
+        // Falls back to the CPU path if the GPU cannot read storage buffers in vertex shaders.
+        explicit MorphedGeoMipMapMesh(bool gpu_lods = false);
         ~MorphedGeoMipMapMesh();
 
         MorphedGeoMipMapMesh(MorphedGeoMipMapMesh&&) = delete;
@@ -100,6 +118,10 @@ class MorphedGeoMipMapMesh : public Mesh
         void init();
 
         void calculate_lods(const RenderInfo &info);
+        void calculate_patch_lods(unsigned first_row, unsigned end_row);
+        static void calculate_lods_range(unsigned int begin, unsigned int end, void *data);
+        void calculate_lods_gpu(const RenderInfo &info);
+        static bool supports_gpu_lods();
 
         // Per-instance data.
         struct PatchData
@@ -127,7 +149,20 @@ class MorphedGeoMipMapMesh : public Mesh
             unsigned elems;
             // Number of instances to draw this mesh.
             unsigned instances;
-            void draw(GLuint ubo, unsigned ubo_offset);
+            // Where each draw call's PatchData was placed in the ring this frame.
+            std::vector<GLintptr> ubo_offsets;
+            void upload(UniformBufferRing &ring, const PatchData *data);
+            void draw(const UniformBufferRing &ring);
+        };
+
+        // Matches the layout expected by glDrawElementsIndirect.
+        struct IndirectCommand
+        {
+            GLuint count;
+            GLuint instance_count;
+            GLuint first_index;
+            GLint base_vertex;
+            GLuint reserved_must_be_zero;
         };
 
         struct LOD
@@ -145,8 +180,36 @@ class MorphedGeoMipMapMesh : public Mesh
 
         std::vector<LOD> lod_meshes;
         std::vector<Patch> patches;
-        GLuint ubo;
-        GLuint pbo;
+        GLuint pbo = 0;
+
+        // CPU LOD path. PatchData is gathered per LOD, then copied to the uniform ring in one upload per frame.
+        std::vector<PatchData> patch_data;
+        std::unique_ptr<UniformBufferRing> patch_ring;
+
+        // GPU LOD path. Patch data lives in an SSBO, so there is no per-draw instance limit.
+        bool gpu_lods;
+        GLuint prog_patch_lod = 0;
+        GLuint patch_ssbo = 0;
+        GLuint indirect_buffer = 0;
+
+        // Structure-of-arrays bounding spheres for batched frustum culling.
+        std::vector<float> cull_center_x;
+        std::vector<float> cull_center_y;
+        std::vector<float> cull_center_z;
+        std::vector<float> cull_radius;
+        std::vector<unsigned char> cull_visible;
+
+        // The CPU path computes the LOD and visibility of rows of patches in parallel, with the parameters of the frame.
+        MaliSDK::JobScheduler job_scheduler;
+        struct LODParameters
+        {
+            vec2 scale;
+            vec2 block_offset;
+            vec3 cam_pos;
+            float distance_mod;
+            const float *frustum;
+        };
+        LODParameters lod_parameters;
 
         static constexpr unsigned patch_size = 64;
         // Do not use lowest "quad" LOD since it forces popping when switching between lod 5 and 6.
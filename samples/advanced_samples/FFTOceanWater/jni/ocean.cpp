@@ -32,6 +32,9 @@
 #define GLES_VERSION 3
 #include "Timer.h"
 #include "Text.h"
+#include "ProgramBinaryCache.h"
+#include "Profiler.h"
+#include "GPUMemory.h"
 #include <jni.h>
 
 using namespace std;
@@ -45,6 +48,12 @@ using namespace GLFFT;
 #define DIST_X 200.0f
 #define DIST_Z 200.0f
 
+// Two detail cascades add the shorter waves with small FFTs, each tiling over a smaller patch.
+// A single FFT covering the same wavelengths over DIST_X would need to be about 3000 samples wide.
+// The patches shrink by a non-integer factor so that the tiling of the cascades does not line up.
+#define CASCADE_SIZE 128
+#define CASCADE_DIST_DIVIDER 4.7f
+
 // The high-frequency normal map is sampled for much finer waves.
 // Make this non-integer so it does not contribute to making the heightmap tiling more apparent.
 #define NORMALMAP_FREQ_MOD 7.3f
@@ -54,7 +63,27 @@ using namespace GLFFT;
 #define WIND_SPEED_X +26.0f
 #define WIND_SPEED_Z -22.0f
 
+// Rate in Hz at which the wave spectrum is simulated. Rendering blends between simulation steps.
+// Set to e.g. 30.0f to halve the FFT cost on devices rendering at 60 fps. 0 simulates every frame.
+#define SIMULATION_RATE 0.0f
+
+// Select patch LODs and cull patches in a compute shader instead of on the CPU.
+#define GPU_PATCH_LODS 1
+
+// Store the distributions and spectra, and run the FFTs, in FP16.
+#define WATER_FP16 1
+// Compare the water textures against an FP32 simulation at start-up and show the error on screen.
+#define WATER_PRECISION_CHECK 1
+
+// Time both meshes for a few frames at start-up and whenever the surface changes, then keep the faster one,
+// since the winner differs between GPUs. Otherwise alternate between the meshes every 10 seconds.
+#define MESH_AUTO_SELECT 1
+// Frames rendered with each mesh before timing it, for shader compilation and caches to settle, and frames timed.
+#define MESH_BENCHMARK_WARMUP_FRAMES 10
+#define MESH_BENCHMARK_FRAMES 30
+
 static FFTWater *water;
+static vector<FFTWater::CascadeInfo> cascades;
 static Scattering *scatter;
 static Mesh *mesh[2];
 
@@ -63,6 +92,90 @@ static GLuint prog_skydome;
 static GLuint vao_quad;
 static GLuint vbo_quad;
 
+static char precision_readout[128];
+
+// GPU time of each mesh is profiled under its own name, so the two can be compared.
+static const char *mesh_scopes[2] = { "water_render_geomipmap", "water_render_tessellation" };
+
+#if MESH_AUTO_SELECT
+struct MeshBenchmark
+{
+    bool running;
+    unsigned candidate;
+    unsigned frames;
+    float frame_time[2];
+};
+
+static MeshBenchmark mesh_benchmark;
+static unsigned mesh_selected;
+static char mesh_status[128];
+
+static void start_mesh_benchmark()
+{
+    mesh_benchmark = MeshBenchmark();
+    mesh_selected = 0;
+
+    // Nothing to choose from without tessellation.
+    mesh_benchmark.running = mesh[1] != nullptr;
+    sprintf(mesh_status, mesh_benchmark.running ? "timing" : "only mesh supported");
+
+    Profiler::resetScope(mesh_scopes[0]);
+    Profiler::resetScope(mesh_scopes[1]);
+}
+
+// delta_time is the duration of the frame just rendered with mesh_benchmark.candidate.
+static void update_mesh_benchmark(float delta_time)
+{
+    MeshBenchmark &benchmark = mesh_benchmark;
+
+    if (benchmark.frames == MESH_BENCHMARK_WARMUP_FRAMES)
+    {
+        Profiler::resetScope(mesh_scopes[benchmark.candidate]);
+    }
+
+    if (benchmark.frames >= MESH_BENCHMARK_WARMUP_FRAMES)
+    {
+        benchmark.frame_time[benchmark.candidate] += delta_time;
+    }
+
+    if (++benchmark.frames < MESH_BENCHMARK_WARMUP_FRAMES + MESH_BENCHMARK_FRAMES)
+    {
+        return;
+    }
+
+    benchmark.frames = 0;
+    if (benchmark.candidate == 0)
+    {
+        benchmark.candidate = 1;
+        return;
+    }
+
+    benchmark.running = false;
+
+    // GPU time of the meshes alone when timestamps are supported, frame times otherwise.
+    // The GPU results lag a few frames behind, but enough of them are in by now.
+    double gpu_time[2];
+    if (Profiler::getGPUAverage(mesh_scopes[0], &gpu_time[0]) && Profiler::getGPUAverage(mesh_scopes[1], &gpu_time[1]))
+    {
+        mesh_selected = gpu_time[1] < gpu_time[0] ? 1 : 0;
+        sprintf(mesh_status, "selected, GPU %.2f ms vs %.2f ms", gpu_time[mesh_selected], gpu_time[1 - mesh_selected]);
+    }
+    else
+    {
+        float frame_time[2];
+        for (unsigned i = 0; i < 2; i++)
+        {
+            frame_time[i] = 1000.0f * benchmark.frame_time[i] / MESH_BENCHMARK_FRAMES;
+        }
+
+        mesh_selected = frame_time[1] < frame_time[0] ? 1 : 0;
+        sprintf(mesh_status, "selected, frame %.2f ms vs %.2f ms", frame_time[mesh_selected], frame_time[1 - mesh_selected]);
+    }
+
+    LOGI("Mesh %s %s.\n", mesh_scopes[mesh_selected], mesh_status);
+}
+#endif
+
 static vec3 cam_pos = vec3(0.0f, 15.0f, 0.0f);
 static float cam_rot_y = -0.6f, cam_rot_x = -0.1f;
 static vec3 cam_dir;
@@ -143,17 +256,72 @@ static void init_vao()
     GL_CHECK(glBindVertexArray(0));
 }
 
+#if WATER_PRECISION_CHECK
+static float relative_rms_error(const vector<vec4> &texels, const vector<vec4> &reference, unsigned component, unsigned offset)
+{
+    double error = 0.0;
+    double energy = 0.0;
+    for (size_t i = offset; i < texels.size(); i += 2)
+    {
+        double diff = texels[i].data[component] - reference[i].data[component];
+        error += diff * diff;
+        energy += double(reference[i].data[component]) * reference[i].data[component];
+    }
+    return energy > 0.0 ? float(sqrt(error / energy)) : 0.0f;
+}
+
+// Run the same simulation in FP32 and report how far the water textures are from it.
+static void check_precision()
+{
+    FFTWater reference(AMPLITUDE, vec2(WIND_SPEED_X, WIND_SPEED_Z), uvec2(SIZE_X, SIZE_Z), vec2(DIST_X, DIST_Z), vec2(NORMALMAP_FREQ_MOD), false,
+            cascades);
+
+    // Both use the same default-seeded random engine, so they start from identical distributions.
+    const float time = 10.0f;
+    vector<vec4> texels, reference_texels;
+    water->update(time);
+    water->read_back(texels);
+    reference.update(time);
+    reference.read_back(reference_texels);
+
+    float height = relative_rms_error(texels, reference_texels, 0, 0);
+    float displacement = 0.5f * (relative_rms_error(texels, reference_texels, 1, 0) + relative_rms_error(texels, reference_texels, 2, 0));
+    float normal = 0.5f * (relative_rms_error(texels, reference_texels, 2, 1) + relative_rms_error(texels, reference_texels, 3, 1));
+
+    sprintf(precision_readout, "FP16 error: height %.2f%%, displacement %.2f%%, normal %.2f%%",
+            100.0f * height, 100.0f * displacement, 100.0f * normal);
+    LOGI("%s\n", precision_readout);
+}
+#endif
+
 static void app_init()
 {
     init_vao();
 
-    mesh[0] = new MorphedGeoMipMapMesh;
+    mesh[0] = new MorphedGeoMipMapMesh(GPU_PATCH_LODS);
     if (common_has_extension("GL_EXT_tessellation_shader"))
     {
         mesh[1] = new TessellatedMesh;
     }
 
-    water = new FFTWater(AMPLITUDE, vec2(WIND_SPEED_X, WIND_SPEED_Z), uvec2(SIZE_X, SIZE_Z), vec2(DIST_X, DIST_Z), vec2(NORMALMAP_FREQ_MOD));
+    cascades.resize(Mesh::detail_cascades);
+    vec2 cascade_dist = vec2(DIST_X, DIST_Z);
+    for (auto &cascade : cascades)
+    {
+        cascade_dist = cascade_dist / vec2(CASCADE_DIST_DIVIDER);
+        cascade.resolution = uvec2(CASCADE_SIZE);
+        cascade.size = cascade_dist;
+    }
+
+    water = new FFTWater(AMPLITUDE, vec2(WIND_SPEED_X, WIND_SPEED_Z), uvec2(SIZE_X, SIZE_Z), vec2(DIST_X, DIST_Z), vec2(NORMALMAP_FREQ_MOD), WATER_FP16,
+            cascades);
+#if WATER_PRECISION_CHECK
+    if (WATER_FP16)
+    {
+        check_precision();
+    }
+#endif
+    water->set_simulation_rate(SIMULATION_RATE);
     prog_quad = common_compile_shader_from_file("quad.vs", "quad.fs");
     prog_skydome = common_compile_shader_from_file("skydome.vs", "skydome.fs");
 
@@ -180,7 +348,10 @@ static void app_update(float delta_time)
 static void app_render(unsigned width, unsigned height, float total_time, unsigned mesh_index)
 {
     // Update the water textures with FFT.
-    water->update(total_time);
+    {
+        PROFILE_SCOPE("water_update");
+        water->update(total_time);
+    }
 
     auto proj = mat_perspective_fov(60.0f, float(width) / height, 1.0f, 2000.0f);
     auto view = mat_look_at(cam_pos, cam_pos + cam_dir, vec3(0.0f, 1.0f, 0.0f));
@@ -206,14 +377,25 @@ static void app_render(unsigned width, unsigned height, float total_time, unsign
     info.height_displacement = water->get_height_displacement();
     info.gradient_jacobian = water->get_gradient_jacobian();
     info.normal = water->get_normal();
+    for (unsigned i = 0; i < Mesh::detail_cascades; i++)
+    {
+        info.cascades[i].height_displacement = water->get_height_displacement(i + 1);
+        info.cascades[i].gradient_jacobian = water->get_gradient_jacobian(i + 1);
+        info.cascades[i].fft_size = water->get_cascade_resolution(i + 1);
+        info.cascades[i].tile_extent = water->get_cascade_size(i + 1);
+    }
     info.skydome = scatter->get_texture();
     info.vp_width = width;
     info.vp_height = height;
     compute_frustum(info.frustum, info.mvp);
 
-    mesh[mesh_index]->render(info);
+    {
+        PROFILE_SCOPE(mesh_scopes[mesh_index]);
+        mesh[mesh_index]->render(info);
+    }
 
     // Render skydome
+    PROFILE_SCOPE("skydome");
     GL_CHECK(glUseProgram(prog_skydome));
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
     GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, scatter->get_texture()));
@@ -248,7 +430,7 @@ extern "C"
     static unsigned surface_width, surface_height;
     static Text *text;
 
-    static void render_text(Text &text, const char *method, float current_time)
+    static void render_text(Text &text, const char *method, const char *status, float delta_time)
     {
         char method_string[128];
 
@@ -258,8 +440,28 @@ extern "C"
 
         text.clear();
         text.addString(20, surface_height - 20, "Heightmap Method:", 255, 255, 255, 255);
-        sprintf(method_string, "%s (%4.1f / 10.0 s)", method, current_time);
+        sprintf(method_string, "%s (%s)", method, status);
         text.addString(20, surface_height - 40, method_string, 255, 255, 255, 255);
+        if (precision_readout[0])
+        {
+            text.addString(20, surface_height - 60, precision_readout, 255, 255, 255, 255);
+        }
+        // Refreshed once a second, the totals change only when resources are created or deleted.
+        static char memory_string[128];
+        static float memory_timer = 1.0f;
+        memory_timer += delta_time;
+        if (memory_timer >= 1.0f)
+        {
+            GPUMemory::prune();
+            GPUMemory::getSummary(memory_string, sizeof(memory_string));
+            memory_timer = 0.0f;
+        }
+        text.addString(20, surface_height - 100, memory_string, 255, 255, 255, 255);
+#if defined(GL_CALL_COUNTERS)
+        char counters_string[128];
+        GLCallCounters::getLastFrameString(counters_string, sizeof(counters_string));
+        text.addString(20, surface_height - 80, counters_string, 255, 255, 255, 255);
+#endif
 
         text.draw();
         GL_CHECK(glDisable(GL_BLEND));
@@ -269,10 +471,16 @@ extern "C"
         (JNIEnv *, jclass, jint width, jint height)
     {
         common_set_basedir("/data/data/com.arm.malideveloper.openglessdk.ocean/files/");
+        ProgramBinaryCache::setDirectory("/data/data/com.arm.malideveloper.openglessdk.ocean/files/");
 
         try 
         {
             app_init();
+            Profiler::initialize();
+#if MESH_AUTO_SELECT
+            // Also runs again when the surface is resized, as the winner depends on the resolution.
+            start_mesh_benchmark();
+#endif
         }
         catch (const exception &e)
         {
@@ -298,6 +506,18 @@ extern "C"
         total_time += delta_time;
         method_timer += delta_time;
 
+#if MESH_AUTO_SELECT
+        if (mesh_benchmark.running)
+        {
+            // The interval is the frame rendered with the last candidate, there is none on the first step.
+            if (total_time > delta_time)
+            {
+                update_mesh_benchmark(delta_time);
+            }
+        }
+        phase = mesh_benchmark.running ? mesh_benchmark.candidate : mesh_selected;
+#endif
+
         app_update(delta_time);
         app_render(surface_width, surface_height, total_time, phase);
 
@@ -306,12 +526,30 @@ extern "C"
             "Tessellation",
         };
 
-        render_text(*text, methods[phase], method_timer);
-
-        if (method_timer > 10.0f)
+        char status[128];
+#if MESH_AUTO_SELECT
+        sprintf(status, "%s", mesh_status);
+#else
+        sprintf(status, "%4.1f / 10.0 s", method_timer);
+#endif
+        render_text(*text, methods[phase], status, delta_time);
+
+        Profiler::endFrame();
+        GLCallCounters::endFrame();
+
+#if MESH_AUTO_SELECT
+        // Logging resets the averages the benchmark compares.
+        bool can_log = !mesh_benchmark.running;
+#else
+        bool can_log = true;
+#endif
+        if (method_timer > 10.0f && can_log)
         {
+            Profiler::log(methods[phase]);
             method_timer = 0.0f;
+#if !MESH_AUTO_SELECT
             phase = 1 - phase;
+#endif
         }
 
         // Fallback incase we don't support tessellation.
@@ -329,6 +567,7 @@ extern "C"
         (JNIEnv *, jclass)
     {
         app_term();
+        Profiler::terminate();
         delete text;
         text = nullptr;
     }
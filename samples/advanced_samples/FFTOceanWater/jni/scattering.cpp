@@ -20,10 +20,51 @@
 
 #include "scattering.hpp"
 #include <utility>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+
+using namespace std;
+
+// Bump when scattering.comp changes, so stale tables on disk are not loaded.
+static const uint32_t scattering_version = 1;
+
+static const int scattering_steps = 100;
+static const float scattering_start = 6500000.0f;
+static const float scattering_end = 7000000.0f;
+
+// FNV-1a over everything the table depends on.
+static uint32_t hash_bytes(uint32_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static string get_cache_path(unsigned size, vec3 sun_dir)
+{
+    uint32_t hash = 2166136261u;
+    hash = hash_bytes(hash, &scattering_version, sizeof(scattering_version));
+    hash = hash_bytes(hash, &size, sizeof(size));
+    hash = hash_bytes(hash, value_ptr(sun_dir), 3 * sizeof(float));
+    hash = hash_bytes(hash, &scattering_steps, sizeof(scattering_steps));
+    hash = hash_bytes(hash, &scattering_start, sizeof(scattering_start));
+    hash = hash_bytes(hash, &scattering_end, sizeof(scattering_end));
+
+    char name[64];
+    sprintf(name, "scattering_%u_%08x.bin", size, hash);
+    return common_get_path(name);
+}
 
 Scattering::Scattering()
 {
     prog = common_compile_compute_shader_from_file("scattering.comp");
+    mipmap_fp16 = common_has_extension("GL_EXT_color_buffer_half_float");
 }
 
 Scattering::~Scattering()
@@ -33,46 +74,147 @@ Scattering::~Scattering()
         GL_CHECK(glDeleteTextures(1, &tex));
     }
 
+    if (readback != 0)
+    {
+        GL_CHECK(glDeleteBuffers(1, &readback));
+    }
+
     if (prog != 0)
     {
         GL_CHECK(glDeleteProgram(prog));
     }
 }
 
-void Scattering::generate(unsigned size, vec3 sun_dir)
+void Scattering::init_texture(unsigned size)
 {
+    if (tex != 0 && tex_size == size)
+    {
+        return;
+    }
+
     if (tex != 0)
     {
         GL_CHECK(glDeleteTextures(1, &tex));
     }
 
-    bool mipmap_fp16 = common_has_extension("GL_EXT_color_buffer_half_float");
-
     GL_CHECK(glGenTextures(1, &tex));
     GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, tex));
     GL_CHECK(glTexStorage2D(GL_TEXTURE_CUBE_MAP, mipmap_fp16 ? int(log2(float(size))) + 1 : 1, GL_RGBA16F, size, size));
     GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
     GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, mipmap_fp16 ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR));
+    tex_size = size;
+}
+
+// The file holds the six faces as RGBA16F texels, right after the size.
+bool Scattering::load(const string &path, unsigned size)
+{
+    ifstream file(path, ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    uint32_t file_size = 0;
+    file.read(reinterpret_cast<char*>(&file_size), sizeof(file_size));
+    if (!file || file_size != size)
+    {
+        return false;
+    }
+
+    vector<uint16_t> texels(size_t(6) * size * size * 4);
+    file.read(reinterpret_cast<char*>(texels.data()), texels.size() * sizeof(uint16_t));
+    if (!file)
+    {
+        return false;
+    }
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, tex));
+    GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    for (unsigned face = 0; face < 6; face++)
+    {
+        GL_CHECK(glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, 0, 0, size, size,
+                    GL_RGBA, GL_HALF_FLOAT, &texels[size_t(face) * size * size * 4]));
+    }
+    GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+    return true;
+}
+
+void Scattering::save(const string &path, unsigned size)
+{
+    // The compute shader wrote a copy of the table in RGBA16F texel order.
+    size_t bytes = size_t(6) * size * size * 4 * sizeof(uint16_t);
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, readback));
+    const void *texels = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    if (!texels)
+    {
+        LOGE("Failed to read back scattering table.\n");
+        return;
+    }
+
+    ofstream file(path, ios::binary);
+    uint32_t file_size = size;
+    file.write(reinterpret_cast<const char*>(&file_size), sizeof(file_size));
+    file.write(static_cast<const char*>(texels), bytes);
+    GL_CHECK(glUnmapBuffer(GL_SHADER_STORAGE_BUFFER));
+
+    if (!file)
+    {
+        LOGE("Failed to store scattering table in %s.\n", path.c_str());
+    }
+}
+
+void Scattering::generate(unsigned size, vec3 sun_dir)
+{
+    init_texture(size);
+
+    string path;
+    if (disk_cache)
+    {
+        path = get_cache_path(size, sun_dir);
+        if (load(path, size))
+        {
+            LOGI("Loaded scattering table from %s.\n", path.c_str());
+            if (mipmap_fp16)
+            {
+                GL_CHECK(glGenerateMipmap(GL_TEXTURE_CUBE_MAP));
+            }
+            return;
+        }
+    }
 
     GL_CHECK(glUseProgram(prog));
     GL_CHECK(glUniform3fv(0, 1, value_ptr(sun_dir)));
+    GL_CHECK(glUniform1i(1, scattering_steps));
+    GL_CHECK(glUniform1f(2, scattering_start));
+    GL_CHECK(glUniform1f(3, (scattering_end - scattering_start) / scattering_steps));
+    GL_CHECK(glUniform1i(4, disk_cache ? 1 : 0));
 
-    int steps = 100;
-    GL_CHECK(glUniform1i(1, steps));
-
-    float start = 6500000.0f;
-    float end = 7000000.0f;
-    GL_CHECK(glUniform1f(2, start));
-    GL_CHECK(glUniform1f(3, (end - start) / steps));
+    if (disk_cache)
+    {
+        if (readback == 0)
+        {
+            GL_CHECK(glGenBuffers(1, &readback));
+        }
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, readback));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, size_t(6) * size * size * 4 * sizeof(uint16_t), nullptr, GL_STREAM_READ));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, readback));
+    }
 
     GL_CHECK(glBindImageTexture(0, tex, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F));
     GL_CHECK(glDispatchCompute(size / 8, size / 8, 6));
-    GL_CHECK(glMemoryBarrier(GL_ALL_BARRIER_BITS));
+
+    // Only sampling and mipmapping read the table, and the readback for the disk cache.
+    GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT |
+                (disk_cache ? GL_BUFFER_UPDATE_BARRIER_BIT : 0)));
 
     if (mipmap_fp16)
     {
         GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, tex));
         GL_CHECK(glGenerateMipmap(GL_TEXTURE_CUBE_MAP));
     }
-}
 
+    if (disk_cache)
+    {
+        save(path, size);
+    }
+}
@@ -23,6 +23,7 @@
 
 #include "common.hpp"
 #include "vector_math.h"
+#include <string>
 
 class Scattering
 {
@@ -32,12 +33,25 @@ class Scattering
         Scattering(Scattering&&) = delete;
         void operator=(Scattering&&) = delete;
 
+        // Regenerating with the same size reuses the texture, so the sun can be moved every frame.
         void generate(unsigned size, vec3 sun_dir);
         GLuint get_texture() const { return tex; }
 
+        // Store generated tables on disk and load them back for the same size, sun direction and parameters.
+        // Disable it when the sun moves continuously, where every table is different anyway.
+        void set_disk_cache(bool enable) { disk_cache = enable; }
+
     private:
         GLuint tex = 0;
         GLuint prog = 0;
+        GLuint readback = 0;
+        unsigned tex_size = 0;
+        bool mipmap_fp16 = false;
+        bool disk_cache = true;
+
+        void init_texture(unsigned size);
+        bool load(const std::string &path, unsigned size);
+        void save(const std::string &path, unsigned size);
 };
 
 #endif
@@ -30,6 +30,7 @@
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 
+#include <cstdio>
 #include <string>
 
 #include <jni.h>
@@ -40,6 +41,10 @@
 #include "Shader.h"
 #include "Texture.h"
 #include "Matrix.h"
+#include "RenderPass.h"
+#include "FramePacer.h"
+#include "FrameTimeGraph.h"
+#include "Profiler.h"
 #include "AndroidPlatform.h"
 
 using std::string;
@@ -89,6 +94,16 @@ int windowHeight = -1;
 /* A text object to draw text on the screen. */
 Text* text;
 
+/* Attachment traffic estimated by RenderPass over the previous frame. */
+unsigned long long lastBytesTransferred = 0;
+unsigned long long lastBytesSaved = 0;
+
+/* Presents a frame every 1/60 s, the cube rotates by a fixed angle each frame. */
+FramePacer* framePacer = NULL;
+
+/* CPU time, GPU time and present latency of the recent frames, drawn over the cube. */
+FrameTimeGraph* frameTimeGraph = NULL;
+
 bool setupGraphics(int width, int height)
 {
     windowWidth = width;
@@ -116,6 +131,13 @@ bool setupGraphics(int width, int height)
     text = new Text(resourceDirectory.c_str(), windowWidth, windowHeight);
     text->addString(0, 0, "Simple FrameBuffer Object (FBO) Example", 255, 255, 0, 255);
 
+    delete framePacer;
+    framePacer = new FramePacer(60);
+
+    Profiler::initialize();
+    delete frameTimeGraph;
+    frameTimeGraph = new FrameTimeGraph(windowWidth, windowHeight);
+
     /* Initialize FBO texture. */
     GL_CHECK(glGenTextures(1, &iFBOTex));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, iFBOTex));
@@ -233,6 +255,8 @@ bool setupGraphics(int width, int height)
 
 void renderFrame(void)
 {
+    frameTimeGraph->beginFrame();
+
     /* Both main window surface and FBO use the same shader program. */
     GL_CHECK(glUseProgram(programID));
 
@@ -254,15 +278,13 @@ void renderFrame(void)
         GL_CHECK(glVertexAttribPointer(iLocTexCoord, 2, GL_FLOAT, GL_FALSE, 0, cubeTextureCoordinates));
     }
 
-    /* Bind the FrameBuffer Object. */
-    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, iFBO));
-
-    /* Set the viewport according to the FBO's texture. */
-    GL_CHECK(glViewport(0, 0, FBO_WIDTH, FBO_HEIGHT));
+    /* The FBO only has a colour attachment, which is sampled by the main pass so has to be stored. */
+    RenderPass fboPass(iFBO, FBO_WIDTH, FBO_HEIGHT);
+    fboPass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 4);
 
-    /* Clear screen on FBO. */
+    /* Bind the FrameBuffer Object and clear it, with the viewport set according to the FBO's texture. */
     GL_CHECK(glClearColor(0.5f, 0.5f, 0.5f, 1.0));
-    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    fboPass.begin();
 
     /* Create rotation matrix specific to the FBO's cube. */
     rotationX = Matrix::createRotationX(-angleZ);
@@ -287,15 +309,16 @@ void renderFrame(void)
     /* Now draw the colored cube to the FrameBuffer Object. */
     GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, sizeof(cubeIndices) / sizeof(GLubyte), GL_UNSIGNED_BYTE, cubeIndices));
 
-    /* And unbind the FrameBuffer Object so subsequent drawing calls are to the EGL window surface. */
-    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER,0));
+    fboPass.end();
 
-    /* Reset viewport to the EGL window surface's dimensions. */
-    GL_CHECK(glViewport(0, 0, windowWidth, windowHeight));
+    /* The window depth buffer is not needed once the frame is drawn, so never write it out. */
+    RenderPass windowPass(0, windowWidth, windowHeight);
+    windowPass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 4);
+    windowPass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_DONT_CARE, 4);
 
-    /* Clear the screen on the EGL surface. */
+    /* Unbind the FrameBuffer Object so subsequent drawing calls are to the EGL window surface, and clear it. */
     GL_CHECK(glClearColor(0.0f, 0.0f, 1.0f, 1.0));
-    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    windowPass.begin();
 
     /* Construct different rotation for main cube. */
     rotationX = Matrix::createRotationX(angleX);
@@ -324,9 +347,32 @@ void renderFrame(void)
     /* And draw the cube. */
     GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, sizeof(cubeIndices) / sizeof(GLubyte), GL_UNSIGNED_BYTE, cubeIndices));
 
-    /* Draw any text. */
+    /* Draw any text, including the estimated bandwidth of the previous frame. */
+    char bandwidthString[128];
+    sprintf(bandwidthString, "Attachment traffic: %llu KB/frame, saved: %llu KB/frame",
+            lastBytesTransferred / 1024, lastBytesSaved / 1024);
+
+    text->clear();
+    text->addString(0, 0, "Simple FrameBuffer Object (FBO) Example", 255, 255, 0, 255);
+    text->addString(0, 20, bandwidthString, 255, 255, 0, 255);
+    if (framePacer->getAverageLatency() > 0.0f)
+    {
+        char latencyString[64];
+        sprintf(latencyString, "Submit to present: %.1f ms", framePacer->getAverageLatency());
+        text->addString(0, 40, latencyString, 255, 255, 0, 255);
+    }
+    frameTimeGraph->draw();
     text->draw();
 
+    windowPass.end();
+
+    /* The overlay is only updated with the counters on the next frame, as it is drawn inside the pass it measures. */
+    lastBytesTransferred = RenderPass::getBytesTransferred();
+    lastBytesSaved = RenderPass::getBytesSaved();
+    RenderPass::endFrame();
+    framePacer->presentFrame();
+    frameTimeGraph->endFrame(framePacer);
+
     /* Update cube's rotation angles for animating. */
     angleX += 3;
     angleY += 2;
@@ -359,5 +405,10 @@ extern "C"
     (JNIEnv *, jclass)
     {
         delete text;
+        delete framePacer;
+        framePacer = NULL;
+        delete frameTimeGraph;
+        frameTimeGraph = NULL;
+        Profiler::terminate();
     }
 }
@@ -32,6 +32,9 @@ public class HighQualityTextRenderer implements GLSurfaceView.Renderer {
 
     private TextObject theTextObj = new TextObject();
 
+    // Textures of all the text objects
+    private TextTextureCache theTextCache = new TextTextureCache();
+
     private float theViewportHeight = 0.0f;
 
     private boolean mustRebuildText = true;
@@ -78,8 +81,9 @@ public class HighQualityTextRenderer implements GLSurfaceView.Renderer {
           theTextObj.setText(str);
         */
 
-        // Initialize text object
-        theTextObj.init();
+        // Initialize text object, after the cache as its textures were lost with the previous context
+        theTextCache.init();
+        theTextObj.init(theTextCache);
         theTextObj.setText("A high text quality!");
         theTextObj.setPosition(0.0f, 0.0f, -1.0f);
 
@@ -94,7 +98,8 @@ public class HighQualityTextRenderer implements GLSurfaceView.Renderer {
         // Render text object
         theTextObj.render();
 
-        if (mustRebuildText) {
+        // Only a text the cache has dropped is drawn again without a touch
+        if (mustRebuildText || theTextObj.isStale()) {
             theTextObj.update();
             mustRebuildText = false;
         }
@@ -26,14 +26,7 @@ import java.nio.ByteBuffer;
 import java.nio.ByteOrder;
 import java.nio.FloatBuffer;
 
-import android.graphics.Bitmap;
-import android.graphics.Canvas;
-import android.graphics.Color;
-import android.graphics.Paint;
-import android.graphics.PorterDuffXfermode;
-import android.graphics.PorterDuff.Mode;
 import android.opengl.GLES20;
-import android.opengl.GLUtils;
 import android.opengl.Matrix;
 
 public class TextObject {
@@ -47,6 +40,8 @@ public class TextObject {
     private boolean isUpdateNeeded = true;
     private int theViewportWidth = 0;
     private int theViewportHeight = 0;
+    private TextTextureCache theTextCache = null;
+    private TextTextureCache.Entry theEntry = null;
 
     // Constructor initialize all necessary members
     public TextObject() {
@@ -78,8 +73,13 @@ public class TextObject {
             thePosition.z = -4.0f;
     }
 
+    // The cache had to drop the texture of this text, it has to be drawn again
+    boolean isStale() {
+        return theEntry != null && theEntry.isStale();
+    }
+
     void update() {
-        if (isUpdateNeeded == false)
+        if (isUpdateNeeded == false && isStale() == false)
             return;
         /* [Update Text Size] */
         // 1. Calculate bounding box in screen coordinates with current matrices
@@ -102,16 +102,25 @@ public class TextObject {
         textSize = (vl.length3() + vr.length3()) / 2.0f;
         /* [Update Text Size] */
 
-        // 3. Generate texture with the new evaluated font size
-        drawCanvasToTexture(theText, textSize);
+        // 3. Get a texture with the new evaluated font size, only drawn and uploaded if the cache does not have it yet
+        TextTextureCache.Entry entry = theTextCache.get(theText, textSize);
 
-        android.util.Log.i("INFO", "bmpSize[" + bitmapWidth + ", " + bitmapHeight + "]");
+        if (entry != theEntry) {
+            theEntry = entry;
+            bitmapWidth = entry.width;
+            bitmapHeight = entry.height;
+
+            android.util.Log.i("INFO", "bmpSize[" + bitmapWidth + ", " + bitmapHeight + "]");
+        }
 
         isUpdateNeeded = false;
     }
 
-    // Load shaders, create vertices, texture coordinates etc.
-    public void init() {
+    // Load shaders, create vertices, texture coordinates etc. The textures of the text come from aTextCache.
+    public void init(TextTextureCache aTextCache) {
+        theTextCache = aTextCache;
+        theEntry = null;
+
         // Initialize the triangle vertex array
         initShapes();
 
@@ -140,27 +149,11 @@ public class TextObject {
         HighQualityTextRenderer.checkGLError("glGetUniformLocation:uMVPMatrix");
         muTextureHandle = GLES20.glGetUniformLocation(mProgram, "u_s2dTexture");
         HighQualityTextRenderer.checkGLError("glGetUniformLocation:u_s2dTexture");
+        muTexRectHandle = GLES20.glGetUniformLocation(mProgram, "uTexRect");
+        HighQualityTextRenderer.checkGLError("glGetUniformLocation:uTexRect");
 
-        GLES20.glHint(GLES20.GL_GENERATE_MIPMAP_HINT, GLES20.GL_NICEST);
-        HighQualityTextRenderer.checkGLError("glHint");
-        GLES20.glActiveTexture(GLES20.GL_TEXTURE0);
-        HighQualityTextRenderer.checkGLError("glActiveTexture");
-        GLES20.glGenTextures(1, textureId, 0);
-        HighQualityTextRenderer.checkGLError("glGenTextures");
-        //
         GLES20.glUniform1i(muTextureHandle, 0);
         HighQualityTextRenderer.checkGLError("glUniform1i");
-        GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, textureId[0]);
-        HighQualityTextRenderer.checkGLError("glBindTexture");
-        // Setup texture parameters
-        GLES20.glTexParameterf(GLES20.GL_TEXTURE_2D, GLES20.GL_TEXTURE_MAG_FILTER, GLES20.GL_LINEAR);
-        HighQualityTextRenderer.checkGLError("glTexParameterf:GL_TEXTURE_MAG_FILTER");
-        GLES20.glTexParameterf(GLES20.GL_TEXTURE_2D, GLES20.GL_TEXTURE_MIN_FILTER, GLES20.GL_LINEAR_MIPMAP_LINEAR);
-        HighQualityTextRenderer.checkGLError("glTexParameterf:GL_TEXTURE_MIN_FILTER");
-        GLES20.glTexParameterf(GLES20.GL_TEXTURE_2D, GLES20.GL_TEXTURE_WRAP_S, GLES20.GL_CLAMP_TO_EDGE);
-        HighQualityTextRenderer.checkGLError("glTexParameterf:GL_TEXTURE_WRAP_S");
-        GLES20.glTexParameterf(GLES20.GL_TEXTURE_2D, GLES20.GL_TEXTURE_WRAP_T, GLES20.GL_CLAMP_TO_EDGE);
-        HighQualityTextRenderer.checkGLError("glTexParameterf:GL_TEXTURE_WRAP_T");
     }
 
 
@@ -181,6 +174,15 @@ public class TextObject {
 
             GLES20.glUniformMatrix4fv(muMVPMatrixHandle, 1, false, mMVPMatrix, 0);
 
+            // Nothing to draw before the first update(), which needs the matrices above
+            if (theEntry == null)
+                return;
+
+            // The text can be anywhere in a texture shared with other text objects
+            GLES20.glActiveTexture(GLES20.GL_TEXTURE0);
+            GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, theEntry.textureId);
+            GLES20.glUniform4f(muTexRectHandle, theEntry.u, theEntry.v, theEntry.uSize, theEntry.vSize);
+
             // Prepare the triangle data
             GLES20.glVertexAttribPointer(maPositionHandle, 3, GLES20.GL_FLOAT, false, 12, quadVB);
             GLES20.glEnableVertexAttribArray(maPositionHandle);
@@ -209,54 +211,6 @@ public class TextObject {
             isUpdateNeeded = true;
         }
 
-        /* [Draw Canvas To Texture] */
-        private void drawCanvasToTexture(
-                String aText,
-                float aFontSize) {
-
-            if (aFontSize < 8.0f)
-                aFontSize = 8.0f;
-
-            if (aFontSize > 500.0f)
-                aFontSize = 500.0f;
-
-            Paint textPaint = new Paint();
-            textPaint.setTextSize(aFontSize);
-            textPaint.setFakeBoldText(false);
-            textPaint.setAntiAlias(true);
-            textPaint.setARGB(255, 255, 255, 255);
-			// If a hinting is available on the platform you are developing, you should enable it (uncomment the line below).
-            //textPaint.setHinting(Paint.HINTING_ON);
-            textPaint.setSubpixelText(true);
-            textPaint.setXfermode(new PorterDuffXfermode(Mode.SCREEN));
-
-            float realTextWidth = textPaint.measureText(aText);
-
-            // Creates a new mutable bitmap, with 128px of width and height
-            bitmapWidth = (int)(realTextWidth + 2.0f);
-            bitmapHeight = (int)aFontSize + 2;
-
-            Bitmap textBitmap = Bitmap.createBitmap(bitmapWidth, bitmapHeight, Bitmap.Config.ARGB_8888);
-            textBitmap.eraseColor(Color.argb(0, 255, 255, 255));
-            // Creates a new canvas that will draw into a bitmap instead of rendering into the screen
-            Canvas bitmapCanvas = new Canvas(textBitmap);
-            // Set start drawing position to [1, base_line_position]
-            // The base_line_position may vary from one font to another but it usually is equal to 75% of font size (height).
-            bitmapCanvas.drawText(aText, 1, 1.0f + aFontSize * 0.75f, textPaint);
-
-            GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, textureId[0]);
-            HighQualityTextRenderer.checkGLError("glBindTexture");
-            // Assigns the OpenGL texture with the Bitmap
-            GLUtils.texImage2D(GLES20.GL_TEXTURE_2D, 0, GLES20.GL_RGBA, textBitmap, 0);
-            // Free memory resources associated with this texture
-            textBitmap.recycle();
-
-            // After the image has been subloaded to texture, regenerate mipmaps
-            GLES20.glGenerateMipmap(GLES20.GL_TEXTURE_2D);
-            HighQualityTextRenderer.checkGLError("glGenerateMipmap");
-        }
-        /* [Draw Canvas To Texture] */
-
         private void initShapes(){
 
             float quadVerts[] = {
@@ -308,6 +262,7 @@ public class TextObject {
 
     private int muMVPMatrixHandle;
     private int muTextureHandle;
+    private int muTexRectHandle;
     private float[] mMVPMatrix = new float[16];
     private float[] mMMatrix = new float[16];
     private float[] mVMatrix = new float[16];
@@ -317,7 +272,6 @@ public class TextObject {
     private int mProgram;
     private int maPositionHandle;
     private int maTexCoordsHandle;
-    private int[] textureId = new int[1];
     private FloatBuffer quadVB;
     private FloatBuffer quadCB;
 
@@ -325,6 +279,8 @@ public class TextObject {
         // This matrix member variable provides a hook to manipulate
         // the coordinates of the objects that use this vertex shader
         "uniform mat4 uMVPMatrix;   \n" +
+        // Top left corner and size of the text in the texture
+        "uniform vec4 uTexRect;     \n" +
 
         "attribute vec4 vPosition;  \n" +
         "attribute vec4 vTexCoord;  \n" +
@@ -334,7 +290,7 @@ public class TextObject {
         "void main(){               \n" +
 
         // The matrix must be included as a modifier of gl_Position
-        " v_v4TexCoord = vTexCoord; \n" +
+        " v_v4TexCoord = vec4(uTexRect.xy + vTexCoord.xy * uTexRect.zw, 0.0, 1.0); \n" +
         " gl_Position = uMVPMatrix * vPosition; \n" +
 
         "}  \n";
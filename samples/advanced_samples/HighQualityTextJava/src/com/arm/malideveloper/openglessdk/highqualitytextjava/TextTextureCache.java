@@ -0,0 +1,247 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package com.arm.malideveloper.openglessdk.highqualitytextjava;
+
+import com.arm.malideveloper.openglessdk.highqualitytextjava.HighQualityTextRenderer;
+
+import java.util.HashMap;
+import java.util.Iterator;
+
+import android.graphics.Bitmap;
+import android.graphics.Canvas;
+import android.graphics.Color;
+import android.graphics.Paint;
+import android.graphics.PorterDuffXfermode;
+import android.graphics.PorterDuff.Mode;
+import android.opengl.GLES20;
+import android.opengl.GLUtils;
+
+// Rasterized strings, shared by all the text objects of a context.
+// Each string is drawn with the font engine and uploaded once per font size. Strings small enough
+// are packed into rows of one mipmapped atlas texture, so text objects showing them share a texture.
+// Bigger strings get a texture of their own. When the atlas is full it is cleared and every entry
+// is marked stale, so its text object draws it again on its next update.
+public class TextTextureCache {
+
+    // Size of the atlas texture in texels
+    private static final int ATLAS_SIZE = 1024;
+    // Transparent texels around each string, so coarser mipmap levels do not blend neighbouring strings
+    private static final int PADDING = 8;
+
+    // A rasterized string, and where it is
+    public static class Entry {
+        public int textureId;
+        // Texture coordinates of the top left corner, then the size of the string in texture coordinates
+        public float u;
+        public float v;
+        public float uSize;
+        public float vSize;
+        // Size of the string in texels
+        public int width;
+        public int height;
+        private boolean isStale = false;
+        private boolean isInAtlas = false;
+
+        public boolean isStale() {
+            return isStale;
+        }
+    }
+
+    private HashMap<String, Entry> theEntries = new HashMap<String, Entry>();
+    private int[] theAtlasId = new int[1];
+    private int theRowX = 0;
+    private int theRowY = 0;
+    private int theRowHeight = 0;
+
+    // Create the atlas. Must be called with the GL context current, again each time the context is recreated.
+    public void init() {
+        // All the textures of the previous context are gone with it
+        for (Entry entry : theEntries.values())
+            entry.isStale = true;
+        theEntries.clear();
+
+        GLES20.glGenTextures(1, theAtlasId, 0);
+        HighQualityTextRenderer.checkGLError("glGenTextures");
+        clearAtlas();
+    }
+
+    // Get the string at the given font size, rasterizing and uploading it only if it is not cached yet.
+    public Entry get(String aText, float aFontSize) {
+        int fontSize = (int)clampFontSize(aFontSize);
+        String key = fontSize + ":" + aText;
+
+        Entry entry = theEntries.get(key);
+        if (entry != null)
+            return entry;
+
+        Bitmap textBitmap = drawCanvasToBitmap(aText, fontSize);
+        entry = new Entry();
+        entry.width = textBitmap.getWidth();
+        entry.height = textBitmap.getHeight();
+
+        if (!allocateInAtlas(entry)) {
+            // Start over with an empty atlas, the strings still shown get drawn again by their text objects
+            Iterator<Entry> entries = theEntries.values().iterator();
+            while (entries.hasNext()) {
+                Entry staleEntry = entries.next();
+                if (staleEntry.isInAtlas) {
+                    staleEntry.isStale = true;
+                    entries.remove();
+                }
+            }
+            clearAtlas();
+            allocateInAtlas(entry);
+        }
+
+        if (entry.isInAtlas) {
+            GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, theAtlasId[0]);
+            GLUtils.texSubImage2D(GLES20.GL_TEXTURE_2D, 0, (int)(entry.u * ATLAS_SIZE), (int)(entry.v * ATLAS_SIZE), textBitmap);
+            HighQualityTextRenderer.checkGLError("texSubImage2D");
+        } else {
+            int[] textureId = new int[1];
+            GLES20.glGenTextures(1, textureId, 0);
+            entry.textureId = textureId[0];
+            entry.u = 0.0f;
+            entry.v = 0.0f;
+            entry.uSize = 1.0f;
+            entry.vSize = 1.0f;
+
+            GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, entry.textureId);
+            setTextureParameters();
+            GLUtils.texImage2D(GLES20.GL_TEXTURE_2D, 0, GLES20.GL_RGBA, textBitmap, 0);
+            HighQualityTextRenderer.checkGLError("texImage2D");
+        }
+        // Free memory resources associated with this bitmap
+        textBitmap.recycle();
+
+        // After the image has been subloaded to texture, regenerate mipmaps
+        GLES20.glGenerateMipmap(GLES20.GL_TEXTURE_2D);
+        HighQualityTextRenderer.checkGLError("glGenerateMipmap");
+
+        theEntries.put(key, entry);
+        return entry;
+    }
+
+    static float clampFontSize(float aFontSize) {
+        if (aFontSize < 8.0f)
+            aFontSize = 8.0f;
+
+        if (aFontSize > 500.0f)
+            aFontSize = 500.0f;
+
+        return aFontSize;
+    }
+
+    // Place the entry in the current row of the atlas, or in a new row. Returns false when the atlas is full.
+    private boolean allocateInAtlas(Entry aEntry) {
+        int width = aEntry.width + PADDING;
+        int height = aEntry.height + PADDING;
+
+        // The string gets its own texture
+        if (width > ATLAS_SIZE || height > ATLAS_SIZE / 4)
+            return true;
+
+        if (theRowX + width > ATLAS_SIZE) {
+            theRowX = 0;
+            theRowY += theRowHeight;
+            theRowHeight = 0;
+        }
+        if (theRowY + height > ATLAS_SIZE)
+            return false;
+
+        aEntry.textureId = theAtlasId[0];
+        aEntry.u = (float)(theRowX + PADDING / 2) / ATLAS_SIZE;
+        aEntry.v = (float)(theRowY + PADDING / 2) / ATLAS_SIZE;
+        aEntry.uSize = (float)aEntry.width / ATLAS_SIZE;
+        aEntry.vSize = (float)aEntry.height / ATLAS_SIZE;
+        aEntry.isInAtlas = true;
+
+        theRowX += width;
+        theRowHeight = Math.max(theRowHeight, height);
+        return true;
+    }
+
+    // Fill the atlas with transparent white texels, which is what the padding has to be
+    private void clearAtlas() {
+        theRowX = 0;
+        theRowY = 0;
+        theRowHeight = 0;
+
+        Bitmap emptyBitmap = Bitmap.createBitmap(ATLAS_SIZE, ATLAS_SIZE, Bitmap.Config.ARGB_8888);
+        emptyBitmap.eraseColor(Color.argb(0, 255, 255, 255));
+
+        GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, theAtlasId[0]);
+        HighQualityTextRenderer.checkGLError("glBindTexture");
+        setTextureParameters();
+        GLUtils.texImage2D(GLES20.GL_TEXTURE_2D, 0, GLES20.GL_RGBA, emptyBitmap, 0);
+        HighQualityTextRenderer.checkGLError("texImage2D");
+        emptyBitmap.recycle();
+
+        GLES20.glGenerateMipmap(GLES20.GL_TEXTURE_2D);
+        HighQualityTextRenderer.checkGLError("glGenerateMipmap");
+    }
+
+    private static void setTextureParameters() {
+        GLES20.glHint(GLES20.GL_GENERATE_MIPMAP_HINT, GLES20.GL_NICEST);
+        HighQualityTextRenderer.checkGLError("glHint");
+        GLES20.glTexParameterf(GLES20.GL_TEXTURE_2D, GLES20.GL_TEXTURE_MAG_FILTER, GLES20.GL_LINEAR);
+        HighQualityTextRenderer.checkGLError("glTexParameterf:GL_TEXTURE_MAG_FILTER");
+        GLES20.glTexParameterf(GLES20.GL_TEXTURE_2D, GLES20.GL_TEXTURE_MIN_FILTER, GLES20.GL_LINEAR_MIPMAP_LINEAR);
+        HighQualityTextRenderer.checkGLError("glTexParameterf:GL_TEXTURE_MIN_FILTER");
+        GLES20.glTexParameterf(GLES20.GL_TEXTURE_2D, GLES20.GL_TEXTURE_WRAP_S, GLES20.GL_CLAMP_TO_EDGE);
+        HighQualityTextRenderer.checkGLError("glTexParameterf:GL_TEXTURE_WRAP_S");
+        GLES20.glTexParameterf(GLES20.GL_TEXTURE_2D, GLES20.GL_TEXTURE_WRAP_T, GLES20.GL_CLAMP_TO_EDGE);
+        HighQualityTextRenderer.checkGLError("glTexParameterf:GL_TEXTURE_WRAP_T");
+    }
+
+    /* [Draw Canvas To Texture] */
+    private static Bitmap drawCanvasToBitmap(
+            String aText,
+            float aFontSize) {
+
+        Paint textPaint = new Paint();
+        textPaint.setTextSize(aFontSize);
+        textPaint.setFakeBoldText(false);
+        textPaint.setAntiAlias(true);
+        textPaint.setARGB(255, 255, 255, 255);
+        // If a hinting is available on the platform you are developing, you should enable it (uncomment the line below).
+        //textPaint.setHinting(Paint.HINTING_ON);
+        textPaint.setSubpixelText(true);
+        textPaint.setXfermode(new PorterDuffXfermode(Mode.SCREEN));
+
+        float realTextWidth = textPaint.measureText(aText);
+
+        // Creates a new mutable bitmap, just big enough for the text
+        int bitmapWidth = (int)(realTextWidth + 2.0f);
+        int bitmapHeight = (int)aFontSize + 2;
+
+        Bitmap textBitmap = Bitmap.createBitmap(bitmapWidth, bitmapHeight, Bitmap.Config.ARGB_8888);
+        textBitmap.eraseColor(Color.argb(0, 255, 255, 255));
+        // Creates a new canvas that will draw into a bitmap instead of rendering into the screen
+        Canvas bitmapCanvas = new Canvas(textBitmap);
+        // Set start drawing position to [1, base_line_position]
+        // The base_line_position may vary from one font to another but it usually is equal to 75% of font size (height).
+        bitmapCanvas.drawText(aText, 1, 1.0f + aFontSize * 0.75f, textPaint);
+
+        return textBitmap;
+    }
+    /* [Draw Canvas To Texture] */
+}
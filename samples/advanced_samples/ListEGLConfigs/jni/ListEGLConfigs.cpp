@@ -25,9 +25,15 @@
  *
  * Shows how to use eglGetConfigs to view the availiable
  * configurations on a system.
+ *
+ * It then profiles the device into a capability report, capabilities.json, which other samples
+ * can read at startup with DeviceCapabilities::load() to pick their fast paths: the EGL configs,
+ * GL extensions, limits and compressed formats, followed by the results of the micro-benchmarks,
+ * which run one frame at a time once the configs are listed.
  */
 
 #include <EGL/egl.h>
+#include <GLES3/gl3.h>
 #include <cstdlib>
 #include <cstdio>
 
@@ -36,9 +42,22 @@
 
 #include "Platform.h"
 #include "AndroidPlatform.h"
+#include "DeviceCapabilities.h"
+#include "MicroBenchmarks.h"
+
+#include <string>
 
+using std::string;
 using namespace MaliSDK;
 
+/* Where the capability report is written. */
+string resourceDirectory = "/data/data/com.arm.malideveloper.openglessdk.listeglconfigs/";
+string reportFilename = "capabilities.json";
+
+DeviceCapabilities capabilities;
+MicroBenchmarkSuite *suite = NULL;
+bool reportComplete = false;
+
 /* 
  * Function pointer type, taking an EGL token and value
  * returning a textual meaning
@@ -266,9 +285,10 @@ bool listConfigs(void)
 
     fflush(stdout);
 
-    /* Tell EGL we have finished */
-    eglTerminate(display);
-    
+    /*
+     * The display is the one of the context the micro-benchmarks run in,
+     * so it is not terminated here, it is left to GLSurfaceView.
+     */
     return true;
 }
 
@@ -278,17 +298,58 @@ extern "C"
     (JNIEnv *env, jclass jcls, jint width, jint height)
     {
         listConfigs();
+
+        /* [Write the capability report] */
+        /* Write the report without benchmark results first, it is complete but for them. */
+        string path = resourceDirectory + reportFilename;
+        capabilities.probe();
+        capabilities.save(path.c_str());
+
+        LOGI("%s, %s: %d extensions, %d compressed texture formats.\n", capabilities.getRenderer().c_str(),
+             capabilities.getVersion().c_str(), (int)capabilities.getExtensions().size(), (int)capabilities.getCompressedFormats().size());
+        LOGI("Half float rendering %d, ASTC %d, pixel local storage %d, multiview %d.\n",
+             capabilities.supportsHalfFloatRendering(), capabilities.supportsASTC(),
+             capabilities.supportsPixelLocalStorage(), capabilities.supportsMultiview());
+        /* [Write the capability report] */
+
+        delete suite;
+        suite = new MicroBenchmarkSuite();
+        suite->addDefaultBenchmarks();
+        reportComplete = false;
     }
 
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_listeglconfigs_ListEGLConfigs_step
     (JNIEnv *env, jclass jcls)
     {
-        /* We don't need to render frames. */
+        if (suite == NULL)
+        {
+            return;
+        }
+
+        if (!suite->isFinished())
+        {
+            suite->step();
+        }
+        else if (!reportComplete)
+        {
+            string path = resourceDirectory + reportFilename;
+            capabilities.addBenchmarkResults(*suite);
+            if (capabilities.save(path.c_str()))
+            {
+                LOGI("Capability report written to %s.\n", path.c_str());
+            }
+            reportComplete = true;
+        }
+
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        GL_CHECK(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        GL_CHECK(glClear(GL_COLOR_BUFFER_BIT));
     }
 
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_listeglconfigs_ListEGLConfigs_uninit
     (JNIEnv *, jclass)
     {
-    
+        delete suite;
+        suite = NULL;
     }
 }
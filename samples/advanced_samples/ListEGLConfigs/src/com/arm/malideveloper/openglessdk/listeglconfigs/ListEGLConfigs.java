@@ -31,9 +31,9 @@ import com.arm.malideveloper.openglessdk.*;
 
 class ListEGLConfigsView extends MaliSamplesView
 {
-    public ListEGLConfigsView(Context context) 
+    public ListEGLConfigsView(Context context, MaliSamplesView.GlesVersion version) 
     { 
-        super(context);
+        super(context, version);
     }
 	
     @Override protected void setRendererCallback()
@@ -42,13 +42,16 @@ class ListEGLConfigsView extends MaliSamplesView
     }
     
     @Override protected void destroyContextCallback()
-    {    	
+    {
+        ListEGLConfigs.uninit();
     }
 
     protected class Renderer implements GLSurfaceView.Renderer 
     {
         public void onDrawFrame(GL10 gl) 
-        {       	
+        {
+            // Runs the micro-benchmarks of the capability report.
+            ListEGLConfigs.step();
         }
 
         public void onSurfaceChanged(GL10 gl, int width, int height) 
@@ -78,7 +81,7 @@ public class ListEGLConfigs extends MaliSamplesActivity
         getWindow().setFlags(WindowManager.LayoutParams.FLAG_FULLSCREEN,
                              WindowManager.LayoutParams.FLAG_FULLSCREEN);
         
-        mView = new ListEGLConfigsView(getApplication());
+        mView = new ListEGLConfigsView(getApplication(), MaliSamplesView.GlesVersion.GLES3);
         setContentView(mView);
     }
 
@@ -28,6 +28,8 @@
  * Surface triangulation is performed using the Marching Cubes algorithm.
  * The Phong model is used for lighting metaball objects.
  * 3D textures are used to provide access to three dimentional arrays in shaders.
+ * On OpenGL ES 3.1 the Marching Cubes stages run in compute shaders instead, which only
+ * emit triangles for cells the isosurface goes through, so a denser grid can be used.
  *
  * For more information please see documentation.
  */
@@ -38,11 +40,14 @@
 #include <jni.h>
 #include <android/log.h>
 
+#include "DynamicResolution.h"
+#include "ProgramCompileQueue.h"
+#include "SampleParameters.h"
 #include "Shader.h"
 #include "Timer.h"
 #include "Matrix.h"
 
-#include "GLES3/gl3.h"
+#include "GLES3/gl31.h"
 #include "EGL/egl.h"
 #include "EGL/eglext.h"
 
@@ -53,6 +58,16 @@
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
+#define GL_CHECK(x) \
+    x; \
+    { \
+        GLenum glError = glGetError(); \
+        if(glError != GL_NO_ERROR) { \
+            LOGE("glGetError() = %i (0x%.8x) at %s:%i\n", glError, glError, __FILE__, __LINE__); \
+            exit(1); \
+        } \
+    }
+
 using std::string;
 using namespace MaliSDK;
 
@@ -763,100 +778,632 @@ const char* marching_cubes_triangles_frag_shader = "#version 300 es\n"
 "    FragColor = vec4(ambient_lighting + diffuse_reflection + specular_reflection, 1.0);\n"
 "}\n";
 
-/* General metaballs example properties. */
-GLfloat      model_time        = 0.0f;  /**< Time (in seconds), increased each rendering iteration.                                         */
-const GLuint tesselation_level = 32;    /**< Level of details you would like to split model into. Please use values from th range [8..256]. */
-GLfloat      isosurface_level  = 12.0f; /**< Scalar field's isosurface level.                                                               */
-unsigned int window_width      = 256;   /**< Window width resolution (pixels).                                                              */
-unsigned int window_height     = 256;   /**< Window height resolution (pixels).                                                             */
+/**
+ * The compute shader version of the scalar field generation stage (OpenGL ES 3.1).
+ *
+ * The field of each sphere is made to fall to zero at a finite distance, so spheres can be binned into
+ * bricks of 4x4x4 samples. Each work group finds the spheres influencing its brick and each sample only
+ * sums those. Bricks no sphere influences are just cleared, and are skipped by the cell splitting stage.
+ */
+const char* scalar_field_comp_shader             = "#version 310 es\n"
+"\n"
+"precision highp float;\n"
+"precision highp image3D; /**< Specify high precision for image3D type. */\n"
+"\n"
+"/** Precision to avoid division-by-zero errors. */\n"
+"#define EPSILON 0.000001f\n"
+"\n"
+"/** Amount of spheres defining scalar field. This value should be synchronized between all files. */\n"
+"#define N_SPHERES 3\n"
+"\n"
+"/** Each work group evaluates one brick of 4x4x4 samples. */\n"
+"layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;\n"
+"\n"
+"/* Uniforms: */\n"
+"/** Amount of samples taken for each axis of a scalar field. */\n"
+"uniform int samples_per_axis;\n"
+"\n"
+"/** Contribution subtracted from each sphere's field, so it falls to zero at a finite distance. */\n"
+"uniform float field_cutoff;\n"
+"\n"
+"/** Uniform block encapsulating sphere locations. */\n"
+"layout(binding = 0) uniform spheres_uniform_block\n"
+"{\n"
+"    vec4 input_spheres[N_SPHERES];\n"
+"};\n"
+"\n"
+"/** Scalar field, written straight into the 3D texture read by the Marching Cubes stages. */\n"
+"layout(r32f, binding = 0) writeonly uniform image3D scalar_field;\n"
+"\n"
+"/** For each brick, a mask of the spheres which influence it. Zero for bricks the isosurface cannot go through. */\n"
+"layout(std430, binding = 3) writeonly buffer bricks_buffer\n"
+"{\n"
+"    uint brick_spheres[];\n"
+"};\n"
+"\n"
+"/** Mask of the spheres influencing this work group's brick. */\n"
+"shared uint brick_mask;\n"
+"\n"
+"/** Checks whether a sphere influences any sample of a brick, including the samples shared with\n"
+" *  the following bricks, which hold the far corners of the brick's cells.\n"
+" *\n"
+" *  @param sphere    sphere position, weight in w-coordinate\n"
+" *  @param brick_min normalized coordinates of the first sample of the brick\n"
+" *  @param brick_max normalized coordinates of the first sample of the following brick\n"
+" *  @return          true if the sphere's field is not zero somewhere in the brick\n"
+" */\n"
+"bool is_brick_influenced(in vec4 sphere, in vec3 brick_min, in vec3 brick_max)\n"
+"{\n"
+"    /* Squared distance from the sphere center to the closest point of the brick. */\n"
+"    vec3  offset           = max(brick_min - sphere.xyz, vec3(0.0)) + max(sphere.xyz - brick_max, vec3(0.0));\n"
+"    float squared_distance = dot(offset, offset);\n"
+"\n"
+"    /* The sphere's field reaches zero where weight / distance^2 == field_cutoff. */\n"
+"    return squared_distance * field_cutoff < sphere.w;\n"
+"}\n"
+"\n"
+"/** Calculates scalar field at user-defined location, from the spheres influencing the brick.\n"
+" *\n"
+" *  @param position Space position for which scalar field value is calculated\n"
+" *  @param mask     Mask of spheres to take into account\n"
+" *  @return         Scalar field value\n"
+" */\n"
+"float calculate_scalar_field_value(in vec3 position, in uint mask)\n"
+"{\n"
+"    float field_value = 0.0f;\n"
+"\n"
+"    for (int i = 0; i < N_SPHERES; i++)\n"
+"    {\n"
+"        if ((mask & (1u << uint(i))) != 0u)\n"
+"        {\n"
+"            float vertex_sphere_distance = distance(input_spheres[i].xyz, position);\n"
+"\n"
+"            /* Sphere weight (or charge) is stored in w-coordinate. */\n"
+"            field_value += max(0.0, input_spheres[i].w / pow(max(EPSILON, vertex_sphere_distance), 2.0) - field_cutoff);\n"
+"        }\n"
+"    }\n"
+"\n"
+"    return field_value;\n"
+"}\n"
+"\n"
+"/** Shader entry point. */\n"
+"void main()\n"
+"{\n"
+"    ivec3 space_position   = ivec3(gl_GlobalInvocationID);\n"
+"    uint  brick_index      = gl_WorkGroupID.x + gl_NumWorkGroups.x * (gl_WorkGroupID.y + gl_NumWorkGroups.y * gl_WorkGroupID.z);\n"
+"    float samples_distance = 1.0 / float(samples_per_axis - 1);\n"
+"\n"
+"    if (gl_LocalInvocationIndex == 0u)\n"
+"    {\n"
+"        brick_mask = 0u;\n"
+"    }\n"
+"\n"
+"    memoryBarrierShared();\n"
+"    barrier();\n"
+"\n"
+"    /* Bin the spheres: each of the first N_SPHERES invocations tests one sphere against the brick. */\n"
+"    if (gl_LocalInvocationIndex < uint(N_SPHERES))\n"
+"    {\n"
+"        vec3 brick_min = vec3(gl_WorkGroupID * gl_WorkGroupSize)       * samples_distance;\n"
+"        vec3 brick_max = vec3((gl_WorkGroupID + 1u) * gl_WorkGroupSize) * samples_distance;\n"
+"\n"
+"        if (is_brick_influenced(input_spheres[gl_LocalInvocationIndex], brick_min, brick_max))\n"
+"        {\n"
+"            atomicOr(brick_mask, 1u << gl_LocalInvocationIndex);\n"
+"        }\n"
+"    }\n"
+"\n"
+"    memoryBarrierShared();\n"
+"    barrier();\n"
+"\n"
+"    if (gl_LocalInvocationIndex == 0u)\n"
+"    {\n"
+"        brick_spheres[brick_index] = brick_mask;\n"
+"    }\n"
+"\n"
+"    /* The last bricks of each axis may stick out of the field. Samples of empty bricks are only cleared. */\n"
+"    if (all(lessThan(space_position, ivec3(samples_per_axis))))\n"
+"    {\n"
+"        float field_value = 0.0f;\n"
+"\n"
+"        if (brick_mask != 0u)\n"
+"        {\n"
+"            field_value = calculate_scalar_field_value(vec3(space_position) * samples_distance, brick_mask);\n"
+"        }\n"
+"\n"
+"        imageStore(scalar_field, space_position, vec4(field_value));\n"
+"    }\n"
+"}\n";
 
-/* Marching Cubes algorithm-specific constants. */
-const GLuint samples_per_axis      = tesselation_level;                                      /**< Amount of samples we break scalar space into (per each axis). */
-const GLuint samples_in_3d_space   = samples_per_axis * samples_per_axis * samples_per_axis; /**< Amount of samples in 3D space. */
-const GLuint cells_per_axis        = samples_per_axis - 1;                                   /**< Amount of cells per each axis. */
-const GLuint cells_in_3d_space     = cells_per_axis * cells_per_axis * cells_per_axis;       /**< Amount of cells in 3D space. */
-const GLuint vertices_per_triangle = 3;                                                      /**< Amount of vertices that defines one triangle. */
-const GLuint triangles_per_cell    = 5;                                                      /**< Amount of triangles that can be generated for a single cell by the Marching Cubes algorithm. */
-const GLuint mc_vertices_per_cell  = vertices_per_triangle * triangles_per_cell;             /**< Amount of vertices in tri_table representing triangles by vertices for one cell. */
-const GLuint mc_cells_types_count  = 256;                                                    /**< Amount of cell types. */
+/**
+ * The compute shader version of the Marching Cubes cell splitting stage (OpenGL ES 3.1).
+ *
+ * Each invocation classifies one cell. Cells which generate triangles are appended to a compacted
+ * list along with the index of their first vertex, so the following stage only runs for the cells
+ * the isosurface goes through. Appending is done by one atomic per work group, shared by its cells.
+ */
+const char* marching_cubes_cells_comp_shader     = "#version 310 es\n"
+"\n"
+"precision highp float;\n"
+"precision highp isampler2D; /**< Specify high precision for isampler2D type. */\n"
+"precision highp sampler3D;  /**< Specify high precision for sampler3D type. */\n"
+"\n"
+"/** Each work group classifies a brick of 4x4x4 cells, matching the bricks of the scalar field stage. */\n"
+"layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;\n"
+"\n"
+"/* Uniforms: */\n"
+"/** Scalar field is stored in a 3D texture bound to texture unit 1. */\n"
+"layout(binding = 1) uniform sampler3D scalar_field;\n"
+"\n"
+"/** Lookup table (tri_table) bound to texture unit 4: edges of the triangles generated for each cell type. */\n"
+"layout(binding = 4) uniform isampler2D tri_table;\n"
+"\n"
+"/** Amount of cells taken for each axis of a scalar field. */\n"
+"uniform int cells_per_axis;\n"
+"\n"
+"/** Isosurface level. */\n"
+"uniform float iso_level;\n"
+"\n"
+"/** Indirect draw and dispatch commands, followed by the counters the compaction appends with. */\n"
+"layout(std430, binding = 0) buffer indirect_commands\n"
+"{\n"
+"    uint draw_count;               /* glDrawArraysIndirect() command, written by the triangles stage. */\n"
+"    uint draw_instance_count;\n"
+"    uint draw_first;\n"
+"    uint draw_reserved;\n"
+"    uint dispatch_num_groups_x;    /* glDispatchComputeIndirect() command for the triangles stage.   */\n"
+"    uint dispatch_num_groups_y;\n"
+"    uint dispatch_num_groups_z;\n"
+"    uint active_cells_count;       /* Amount of cells appended to active_cells.                      */\n"
+"    uint allocated_vertices_count; /* Amount of vertices reserved by the appended cells.             */\n"
+"};\n"
+"\n"
+"/** Compacted list of cells generating triangles: packed cell position and type, and first vertex index. */\n"
+"layout(std430, binding = 1) writeonly buffer active_cells_buffer\n"
+"{\n"
+"    uvec2 active_cells[];\n"
+"};\n"
+"\n"
+"/** For each brick of 4x4x4 cells, a mask of the spheres which influence it, written by the scalar field stage. */\n"
+"layout(std430, binding = 3) readonly buffer bricks_buffer\n"
+"{\n"
+"    uint brick_spheres[];\n"
+"};\n"
+"\n"
+"/** Amount of active cells and vertices in this work group. */\n"
+"shared uint group_active_cells;\n"
+"shared uint group_vertices;\n"
+"\n"
+"/** Where this work group's active cells and vertices start in the global lists. */\n"
+"shared uint group_active_cells_base;\n"
+"shared uint group_vertices_base;\n"
+"\n"
+"/** Calculates cell type index for provided cell and isosurface level.\n"
+" *\n"
+" *  @param cell_position cell position in space ranged [0 .. cells_per_axis-1]\n"
+" *  @param isolevel      scalar field value which defines isosurface level\n"
+" *  @return              cell type in sense of Marching Cubes algorithm\n"
+" */\n"
+"int get_cell_type_index(in ivec3 cell_position, in float isolevel)\n"
+"{\n"
+"    /* Cell corners in space relatively to cell's base point [0]. */\n"
+"    const ivec3 cell_corners_offsets[8] = ivec3[]\n"
+"    (\n"
+"        ivec3(0, 0, 0),\n"
+"        ivec3(1, 0, 0),\n"
+"        ivec3(1, 0, 1),\n"
+"        ivec3(0, 0, 1),\n"
+"        ivec3(0, 1, 0),\n"
+"        ivec3(1, 1, 0),\n"
+"        ivec3(1, 1, 1),\n"
+"        ivec3(0, 1, 1)\n"
+"    );\n"
+"\n"
+"    int cell_type_index = 0;\n"
+"\n"
+"    /* Iterate through all cell corners. */\n"
+"    for (int i = 0; i < 8; i++)\n"
+"    {\n"
+"        /* If corner is inside isosurface then set bit in cell type index index. */\n"
+"        if (texelFetch(scalar_field, cell_position + cell_corners_offsets[i], 0).r < isolevel)\n"
+"        {\n"
+"            cell_type_index |= (1 << i);\n"
+"        }\n"
+"    }\n"
+"\n"
+"    return cell_type_index;\n"
+"}\n"
+"\n"
+"/** Counts the vertices the Marching Cubes algorithm generates for a cell type.\n"
+" *\n"
+" *  @param cell_type_index cell type index (in Marching Cubes algorthm sense)\n"
+" *  @return                amount of vertices, a multiple of 3\n"
+" */\n"
+"uint get_cell_vertices_count(in int cell_type_index)\n"
+"{\n"
+"    uint vertices_count = 0u;\n"
+"\n"
+"    /* Rows of tri_table are terminated with -1. */\n"
+"    for (int i = 0; i < 15; i++)\n"
+"    {\n"
+"        if (texelFetch(tri_table, ivec2(i, cell_type_index), 0).r == -1)\n"
+"        {\n"
+"            break;\n"
+"        }\n"
+"\n"
+"        vertices_count++;\n"
+"    }\n"
+"\n"
+"    return vertices_count;\n"
+"}\n"
+"\n"
+"/** Shader entry point. */\n"
+"void main()\n"
+"{\n"
+"    ivec3 cell_position  = ivec3(gl_GlobalInvocationID);\n"
+"    uint  brick_index    = gl_WorkGroupID.x + gl_NumWorkGroups.x * (gl_WorkGroupID.y + gl_NumWorkGroups.y * gl_WorkGroupID.z);\n"
+"    int   cell_type      = 0;\n"
+"    uint  vertices_count = 0u;\n"
+"\n"
+"    if (gl_LocalInvocationIndex == 0u)\n"
+"    {\n"
+"        group_active_cells = 0u;\n"
+"        group_vertices     = 0u;\n"
+"    }\n"
+"\n"
+"    memoryBarrierShared();\n"
+"    barrier();\n"
+"\n"
+"    /* The last work groups of each axis may stick out of the grid. The field is zero in all corners\n"
+"     * of the cells of a brick no sphere influences, so these cells cannot generate triangles. */\n"
+"    if (all(lessThan(cell_position, ivec3(cells_per_axis))) && brick_spheres[brick_index] != 0u)\n"
+"    {\n"
+"        cell_type      = get_cell_type_index(cell_position, iso_level);\n"
+"        vertices_count = get_cell_vertices_count(cell_type);\n"
+"    }\n"
+"\n"
+"    /* Reserve a slot for each active cell, and its vertices, within the work group. */\n"
+"    uint local_active_cell = 0u;\n"
+"    uint local_vertex      = 0u;\n"
+"\n"
+"    if (vertices_count != 0u)\n"
+"    {\n"
+"        local_active_cell = atomicAdd(group_active_cells, 1u);\n"
+"        local_vertex      = atomicAdd(group_vertices,     vertices_count);\n"
+"    }\n"
+"\n"
+"    memoryBarrierShared();\n"
+"    barrier();\n"
+"\n"
+"    /* One global allocation per work group keeps contention on the counters low. */\n"
+"    if (gl_LocalInvocationIndex == 0u && group_active_cells != 0u)\n"
+"    {\n"
+"        group_active_cells_base = atomicAdd(active_cells_count,       group_active_cells);\n"
+"        group_vertices_base     = atomicAdd(allocated_vertices_count, group_vertices);\n"
+"\n"
+"        /* The triangles stage runs one invocation per active cell, in work groups of 64. */\n"
+"        atomicMax(dispatch_num_groups_x, (group_active_cells_base + group_active_cells + 63u) / 64u);\n"
+"    }\n"
+"\n"
+"    memoryBarrierShared();\n"
+"    barrier();\n"
+"\n"
+"    if (vertices_count != 0u)\n"
+"    {\n"
+"        uint packed_cell = uint(cell_position.x)\n"
+"                         | (uint(cell_position.y) << 8)\n"
+"                         | (uint(cell_position.z) << 16)\n"
+"                         | (uint(cell_type)       << 24);\n"
+"\n"
+"        active_cells[group_active_cells_base + local_active_cell] = uvec2(packed_cell, group_vertices_base + local_vertex);\n"
+"    }\n"
+"}\n";
 
-/** The array that is used for cell triangularization.
- *  Each row in table represents one cell type. Each cell type contains up to 5 triangles.
- *  Each triangle is defined by 3 sequential vertices.
- *  These vertices are "middle" points of the cell edges specified in this table.
- *  For example cell type 0 (see first line) does not define any triangles,
- *  while cell type 1 (see second line) defines one triangle consisting of "middle" points of edges 0,8 and 3 of a cell.
- *  "Middle" points are base points and can be moved closer to edge beginning point or edge ending point.
- *  Edge numeration is according to the Marching Cubes algorithm.
- *  There are exactly 256 cell types due to each vertex having only 2 states: it can be below isosurface or above.
- *  Thus (having 8 corners for each cubic cell) we have 2^8 = 256 cell types.
+/**
+ * The compute shader version of the Marching Cubes triangle generation stage (OpenGL ES 3.1).
  *
- *  Table data taken from http://paulbourke.net/geometry/polygonise/
+ * Each invocation generates the triangles of one cell appended by the cell splitting compute shader,
+ * and stores their vertices in a buffer which is then drawn with glDrawArraysIndirect().
+ * The vertex count of the draw command is written by this shader too, so nothing is read back by the CPU.
  */
-/* [tri_table chosen part for documentation] */
-const GLint tri_table[mc_cells_types_count * mc_vertices_per_cell] =
-{
-  -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   0,  8,  3,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   0,  1,  9,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   1,  8,  3,     9,  8,  1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-/* [tri_table chosen part for documentation] */
-   1,  2, 10,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   0,  8,  3,     1,  2, 10,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   9,  2, 10,     0,  2,  9,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   2,  8,  3,     2, 10,  8,    10,  9,  8,    -1, -1, -1,    -1, -1, -1,
-   3, 11,  2,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   0, 11,  2,     8, 11,  0,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   1,  9,  0,     2,  3, 11,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   1, 11,  2,     1,  9, 11,     9,  8, 11,    -1, -1, -1,    -1, -1, -1,
-   3, 10,  1,    11, 10,  3,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   0, 10,  1,     0,  8, 10,     8, 11, 10,    -1, -1, -1,    -1, -1, -1,
-   3,  9,  0,     3, 11,  9,    11, 10,  9,    -1, -1, -1,    -1, -1, -1,
-   9,  8, 10,    10,  8, 11,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   4,  7,  8,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   4,  3,  0,     7,  3,  4,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   0,  1,  9,     8,  4,  7,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   4,  1,  9,     4,  7,  1,     7,  3,  1,    -1, -1, -1,    -1, -1, -1,
-   1,  2, 10,     8,  4,  7,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   3,  4,  7,     3,  0,  4,     1,  2, 10,    -1, -1, -1,    -1, -1, -1,
-   9,  2, 10,     9,  0,  2,     8,  4,  7,    -1, -1, -1,    -1, -1, -1,
-   2, 10,  9,     2,  9,  7,     2,  7,  3,     7,  9,  4,    -1, -1, -1,
-   8,  4,  7,     3, 11,  2,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-  11,  4,  7,    11,  2,  4,     2,  0,  4,    -1, -1, -1,    -1, -1, -1,
-   9,  0,  1,     8,  4,  7,     2,  3, 11,    -1, -1, -1,    -1, -1, -1,
-   4,  7, 11,     9,  4, 11,     9, 11,  2,     9,  2,  1,    -1, -1, -1,
-   3, 10,  1,     3, 11, 10,     7,  8,  4,    -1, -1, -1,    -1, -1, -1,
-   1, 11, 10,     1,  4, 11,     1,  0,  4,     7, 11,  4,    -1, -1, -1,
-   4,  7,  8,     9,  0, 11,     9, 11, 10,    11,  0,  3,    -1, -1, -1,
-   4,  7, 11,     4, 11,  9,     9, 11, 10,    -1, -1, -1,    -1, -1, -1,
-   9,  5,  4,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   9,  5,  4,     0,  8,  3,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   0,  5,  4,     1,  5,  0,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   8,  5,  4,     8,  3,  5,     3,  1,  5,    -1, -1, -1,    -1, -1, -1,
-   1,  2, 10,     9,  5,  4,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   3,  0,  8,     1,  2, 10,     4,  9,  5,    -1, -1, -1,    -1, -1, -1,
-   5,  2, 10,     5,  4,  2,     4,  0,  2,    -1, -1, -1,    -1, -1, -1,
-   2, 10,  5,     3,  2,  5,     3,  5,  4,     3,  4,  8,    -1, -1, -1,
-   9,  5,  4,     2,  3, 11,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   0, 11,  2,     0,  8, 11,     4,  9,  5,    -1, -1, -1,    -1, -1, -1,
-   0,  5,  4,     0,  1,  5,     2,  3, 11,    -1, -1, -1,    -1, -1, -1,
-   2,  1,  5,     2,  5,  8,     2,  8, 11,     4,  8,  5,    -1, -1, -1,
-  10,  3, 11,    10,  1,  3,     9,  5,  4,    -1, -1, -1,    -1, -1, -1,
-   4,  9,  5,     0,  8,  1,     8, 10,  1,     8, 11, 10,    -1, -1, -1,
-   5,  4,  0,     5,  0, 11,     5, 11, 10,    11,  0,  3,    -1, -1, -1,
-   5,  4,  8,     5,  8, 10,    10,  8, 11,    -1, -1, -1,    -1, -1, -1,
-   9,  7,  8,     5,  7,  9,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   9,  3,  0,     9,  5,  3,     5,  7,  3,    -1, -1, -1,    -1, -1, -1,
-   0,  7,  8,     0,  1,  7,     1,  5,  7,    -1, -1, -1,    -1, -1, -1,
-   1,  5,  3,     3,  5,  7,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
-   9,  7,  8,     9,  5,  7,    10,  1,  2,    -1, -1, -1,    -1, -1, -1,
-  10,  1,  2,     9,  5,  0,     5,  3,  0,     5,  7,  3,    -1, -1, -1,
-   8,  0,  2,     8,  2,  5,     8,  5,  7,    10,  5,  2,    -1, -1, -1,
-   2, 10,  5,     2,  5,  3,     3,  5,  7,    -1, -1, -1,    -1, -1, -1,
-   7,  9,  5,     7,  8,  9,     3, 11,  2,    -1, -1, -1,    -1, -1, -1,
-   9,  5,  7,     9,  7,  2,     9,  2,  0,     2,  7, 11,    -1, -1, -1,
-   2,  3, 11,     0,  1,  8,     1,  7,  8,     1,  5,  7,    -1, -1, -1,
-  11,  2,  1,    11,  1,  7,     7,  1,  5,    -1, -1, -1,    -1, -1, -1,
+const char* marching_cubes_triangles_comp_shader = "#version 310 es\n"
+"\n"
+"precision highp float;\n"
+"precision highp isampler2D; /**< Specify high precision for isampler2D type. */\n"
+"precision highp sampler3D;  /**< Specify high precision for sampler3D type. */\n"
+"\n"
+"/** Precision to avoid division-by-zero errors. */\n"
+"#define EPSILON 0.000001f\n"
+"\n"
+"/** One invocation generates all triangles of one active cell. */\n"
+"layout(local_size_x = 64) in;\n"
+"\n"
+"/* Uniforms: */\n"
+"/** Scalar field is stored in a 3D texture bound to texture unit 1. */\n"
+"layout(binding = 1) uniform sampler3D scalar_field;\n"
+"\n"
+"/** Lookup table (tri_table) bound to texture unit 4: edges of the triangles generated for each cell type. */\n"
+"layout(binding = 4) uniform isampler2D tri_table;\n"
+"\n"
+"/** Isosurface level. */\n"
+"uniform float iso_level;\n"
+"\n"
+"/** Capacity of the vertex buffer. A multiple of 3, so only whole triangles are dropped when it overflows. */\n"
+"uniform uint max_vertices;\n"
+"\n"
+"/** Amount of samples per axis of the grid in use, which may only cover a corner of the scalar field texture. */\n"
+"uniform int samples_per_axis;\n"
+"\n"
+"/** Indirect draw and dispatch commands, followed by the counters the compaction appends with. */\n"
+"layout(std430, binding = 0) buffer indirect_commands\n"
+"{\n"
+"    uint draw_count;\n"
+"    uint draw_instance_count;\n"
+"    uint draw_first;\n"
+"    uint draw_reserved;\n"
+"    uint dispatch_num_groups_x;\n"
+"    uint dispatch_num_groups_y;\n"
+"    uint dispatch_num_groups_z;\n"
+"    uint active_cells_count;\n"
+"    uint allocated_vertices_count;\n"
+"};\n"
+"\n"
+"/** Compacted list of cells generating triangles: packed cell position and type, and first vertex index. */\n"
+"layout(std430, binding = 1) readonly buffer active_cells_buffer\n"
+"{\n"
+"    uvec2 active_cells[];\n"
+"};\n"
+"\n"
+"/** Generated triangle vertex. */\n"
+"struct vertex\n"
+"{\n"
+"    vec4 position; /* Normalized position in space, w = 1. */\n"
+"    vec4 normal;   /* Normal vector to surface, w = 0.     */\n"
+"};\n"
+"\n"
+"/** Generated triangles, three vertices each. */\n"
+"layout(std430, binding = 2) writeonly buffer vertices_buffer\n"
+"{\n"
+"    vertex vertices[];\n"
+"};\n"
+"\n"
+"/** Fetches a scalar field sample, clamping to the borders of the field.\n"
+" *\n"
+" *  @param sample_position non-normalized sample position in space\n"
+" *  @return                scalar field value\n"
+" */\n"
+"float get_field_value(in ivec3 sample_position)\n"
+"{\n"
+"    ivec3 max_position = ivec3(samples_per_axis - 1);\n"
+"\n"
+"    return texelFetch(scalar_field, clamp(sample_position, ivec3(0), max_position), 0).r;\n"
+"}\n"
+"\n"
+"/** Finds normal in given cell corner vertex as central differences of the neighbour samples.\n"
+" *  Differences are not divided by the sample distance, which is the same along all axes.\n"
+" *\n"
+" *  @param corner sample position of the cell corner\n"
+" *  @return       normal vector to surface in corner\n"
+" */\n"
+"vec3 calc_cell_corner_normal(in ivec3 corner)\n"
+"{\n"
+"    return vec3(get_field_value(corner + ivec3(1, 0, 0)) - get_field_value(corner - ivec3(1, 0, 0)),\n"
+"                get_field_value(corner + ivec3(0, 1, 0)) - get_field_value(corner - ivec3(0, 1, 0)),\n"
+"                get_field_value(corner + ivec3(0, 0, 1)) - get_field_value(corner - ivec3(0, 0, 1)));\n"
+"}\n"
+"\n"
+"/** Shader entry point. */\n"
+"void main()\n"
+"{\n"
+"    /* These two arrays contain vertex indices which define a cell edge specified by index of arrays. */\n"
+"    const int   edge_begins_in_cell_corner[12] = int[] ( 0,1,2,3,4,5,6,7,0,1,2,3 );\n"
+"    const int   edge_ends_in_cell_corner[12]   = int[] ( 1,2,3,0,5,6,7,4,4,5,6,7 );\n"
+"    /* Defines offsets by axes for each of 8 cell corneres. */\n"
+"    const ivec3 cell_corners_offsets[8]        = ivec3[8]\n"
+"    (\n"
+"        ivec3(0, 0, 0),\n"
+"        ivec3(1, 0, 0),\n"
+"        ivec3(1, 0, 1),\n"
+"        ivec3(0, 0, 1),\n"
+"        ivec3(0, 1, 0),\n"
+"        ivec3(1, 1, 0),\n"
+"        ivec3(1, 1, 1),\n"
+"        ivec3(0, 1, 1)\n"
+"    );\n"
+"\n"
+"    uint active_cell_index = gl_GlobalInvocationID.x;\n"
+"\n"
+"    /* All active cells have been appended by now, so the final vertex count can be stored in the draw command. */\n"
+"    if (active_cell_index == 0u)\n"
+"    {\n"
+"        draw_count = min(allocated_vertices_count, max_vertices);\n"
+"    }\n"
+"\n"
+"    if (active_cell_index >= active_cells_count)\n"
+"    {\n"
+"        return;\n"
+"    }\n"
+"\n"
+"    /* Unpack cell position, cell type and the first vertex reserved for the cell. */\n"
+"    uvec2 active_cell     = active_cells[active_cell_index];\n"
+"    ivec3 cell_position   = ivec3(int(active_cell.x         & 0xffu),\n"
+"                                  int((active_cell.x >> 8)  & 0xffu),\n"
+"                                  int((active_cell.x >> 16) & 0xffu));\n"
+"    int   cell_type_index = int(active_cell.x >> 24);\n"
+"    uint  first_vertex    = active_cell.y;\n"
+"\n"
+"    /* Normalizes sample positions to [0.0 .. 1.0] range. */\n"
+"    float samples_normalizer = float(samples_per_axis - 1);\n"
+"\n"
+"    for (int i = 0; i < 15; i++)\n"
+"    {\n"
+"        int  edge_number  = texelFetch(tri_table, ivec2(i, cell_type_index), 0).r;\n"
+"        uint vertex_index = first_vertex + uint(i);\n"
+"\n"
+"        /* Stop at the end of the tri_table row, or when the vertex buffer is full. */\n"
+"        if (edge_number == -1 || vertex_index >= max_vertices)\n"
+"        {\n"
+"            break;\n"
+"        }\n"
+"\n"
+"        /* Calculate start and end edge coordinates. */\n"
+"        ivec3 start_corner      = cell_position + cell_corners_offsets[edge_begins_in_cell_corner[edge_number]];\n"
+"        ivec3 end_corner        = cell_position + cell_corners_offsets[edge_ends_in_cell_corner  [edge_number]];\n"
+"\n"
+"        /* Calculate share of start point of an edge. */\n"
+"        float start_field_value = get_field_value(start_corner);\n"
+"        float end_field_value   = get_field_value(end_corner);\n"
+"        float field_delta       = abs(start_field_value - end_field_value);\n"
+"        float start_portion     = 0.5;\n"
+"\n"
+"        if (field_delta > EPSILON)\n"
+"        {\n"
+"            start_portion = abs(end_field_value - iso_level) / field_delta;\n"
+"        }\n"
+"\n"
+"        /* Calculate ''middle'' edge vertex and the normal to surface in it. */\n"
+"        vec3 edge_middle_vertex = mix(vec3(end_corner), vec3(start_corner), start_portion) / samples_normalizer;\n"
+"        vec3 vertex_normal      = mix(calc_cell_corner_normal(end_corner), calc_cell_corner_normal(start_corner), start_portion);\n"
+"\n"
+"        vertices[vertex_index] = vertex(vec4(edge_middle_vertex, 1.0), vec4(vertex_normal, 0.0));\n"
+"    }\n"
+"}\n";
+
+/**
+ * This vertex shader renders the triangles generated by the compute shaders.
+ * It feeds the same fragment shader as the transform feedback version.
+ */
+const char* marching_cubes_indirect_vert_shader  = "#version 300 es\n"
+"\n"
+"/* Input data: */\n"
+"/** Triangle vertex position generated by the compute shaders, in normalized model space. */\n"
+"layout(location = 0) in vec4 vertex_position;\n"
+"\n"
+"/** Normal vector to surface generated by the compute shaders. */\n"
+"layout(location = 1) in vec4 vertex_normal;\n"
+"\n"
+"/* Uniforms: */\n"
+"/** Combined model view and projection matrices. */\n"
+"uniform mat4 mvp;\n"
+"\n"
+"/* Output data: */\n"
+"/** Position of the vertex (and fragment) in world space. */\n"
+"out vec4 phong_vertex_position;\n"
+"\n"
+"/** Surface normal vector in world space. */\n"
+"out vec3 phong_vertex_normal_vector;\n"
+"\n"
+"/** Color passed to fragment shader. */\n"
+"out vec3 phong_vertex_color;\n"
+"\n"
+"/** Shader entry point. */\n"
+"void main()\n"
+"{\n"
+"    gl_Position                = mvp * vertex_position; /* Transform vertex position with MVP-matrix.        */\n"
+"    phong_vertex_position      = gl_Position;           /* Set vertex position for fragment shader.          */\n"
+"    phong_vertex_normal_vector = vertex_normal.xyz;     /* Set normal vector to surface for fragment shader. */\n"
+"    phong_vertex_color         = vec3(0.7);             /* Set vertex color for fragment shader.             */\n"
+"}\n";
+
+/* General metaballs example properties. */
+GLfloat      model_time        = 0.0f;  /**< Time (in seconds), increased each rendering iteration.                                         */
+GLuint       tesselation_level = 32;    /**< Level of details you would like to split model into. Please use values from th range [8..256]. */
+GLfloat      isosurface_level  = 12.0f; /**< Scalar field's isosurface level.                                                               */
+unsigned int window_width      = 256;   /**< Window width resolution (pixels).                                                              */
+unsigned int window_height     = 256;   /**< Window height resolution (pixels).                                                             */
+
+/* Compute shader Marching Cubes properties. */
+const GLuint compute_tesselation_level      = 64;    /**< Level of details used instead of tesselation_level by the compute shader path. Please use values from th range [8..256]. */
+const GLuint compute_vertices_per_face_cell = 48;    /**< Vertex buffer capacity of the compute shader path, per cell of a grid face. Isosurface area grows with the square of the grid size, not with its volume. */
+bool         use_compute_shaders            = false; /**< True if Marching Cubes runs in compute shaders rather than in transform feedback stages. */
+
+/* Marching Cubes algorithm-specific constants. They follow tesselation_level, see set_tesselation_level(). */
+GLuint       samples_per_axis      = tesselation_level;                                      /**< Amount of samples we break scalar space into (per each axis). */
+GLuint       samples_in_3d_space   = samples_per_axis * samples_per_axis * samples_per_axis; /**< Amount of samples in 3D space. */
+GLuint       cells_per_axis        = samples_per_axis - 1;                                   /**< Amount of cells per each axis. */
+GLuint       cells_in_3d_space     = cells_per_axis * cells_per_axis * cells_per_axis;       /**< Amount of cells in 3D space. */
+const GLuint vertices_per_triangle = 3;                                                      /**< Amount of vertices that defines one triangle. */
+const GLuint triangles_per_cell    = 5;                                                      /**< Amount of triangles that can be generated for a single cell by the Marching Cubes algorithm. */
+const GLuint mc_vertices_per_cell  = vertices_per_triangle * triangles_per_cell;             /**< Amount of vertices in tri_table representing triangles by vertices for one cell. */
+const GLuint mc_cells_types_count  = 256;                                                    /**< Amount of cell types. */
+
+/** The array that is used for cell triangularization.
+ *  Each row in table represents one cell type. Each cell type contains up to 5 triangles.
+ *  Each triangle is defined by 3 sequential vertices.
+ *  These vertices are "middle" points of the cell edges specified in this table.
+ *  For example cell type 0 (see first line) does not define any triangles,
+ *  while cell type 1 (see second line) defines one triangle consisting of "middle" points of edges 0,8 and 3 of a cell.
+ *  "Middle" points are base points and can be moved closer to edge beginning point or edge ending point.
+ *  Edge numeration is according to the Marching Cubes algorithm.
+ *  There are exactly 256 cell types due to each vertex having only 2 states: it can be below isosurface or above.
+ *  Thus (having 8 corners for each cubic cell) we have 2^8 = 256 cell types.
+ *
+ *  Table data taken from http://paulbourke.net/geometry/polygonise/
+ */
+/* [tri_table chosen part for documentation] */
+const GLint tri_table[mc_cells_types_count * mc_vertices_per_cell] =
+{
+  -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   0,  8,  3,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   0,  1,  9,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   1,  8,  3,     9,  8,  1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+/* [tri_table chosen part for documentation] */
+   1,  2, 10,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   0,  8,  3,     1,  2, 10,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   9,  2, 10,     0,  2,  9,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   2,  8,  3,     2, 10,  8,    10,  9,  8,    -1, -1, -1,    -1, -1, -1,
+   3, 11,  2,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   0, 11,  2,     8, 11,  0,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   1,  9,  0,     2,  3, 11,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   1, 11,  2,     1,  9, 11,     9,  8, 11,    -1, -1, -1,    -1, -1, -1,
+   3, 10,  1,    11, 10,  3,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   0, 10,  1,     0,  8, 10,     8, 11, 10,    -1, -1, -1,    -1, -1, -1,
+   3,  9,  0,     3, 11,  9,    11, 10,  9,    -1, -1, -1,    -1, -1, -1,
+   9,  8, 10,    10,  8, 11,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   4,  7,  8,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   4,  3,  0,     7,  3,  4,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   0,  1,  9,     8,  4,  7,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   4,  1,  9,     4,  7,  1,     7,  3,  1,    -1, -1, -1,    -1, -1, -1,
+   1,  2, 10,     8,  4,  7,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   3,  4,  7,     3,  0,  4,     1,  2, 10,    -1, -1, -1,    -1, -1, -1,
+   9,  2, 10,     9,  0,  2,     8,  4,  7,    -1, -1, -1,    -1, -1, -1,
+   2, 10,  9,     2,  9,  7,     2,  7,  3,     7,  9,  4,    -1, -1, -1,
+   8,  4,  7,     3, 11,  2,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+  11,  4,  7,    11,  2,  4,     2,  0,  4,    -1, -1, -1,    -1, -1, -1,
+   9,  0,  1,     8,  4,  7,     2,  3, 11,    -1, -1, -1,    -1, -1, -1,
+   4,  7, 11,     9,  4, 11,     9, 11,  2,     9,  2,  1,    -1, -1, -1,
+   3, 10,  1,     3, 11, 10,     7,  8,  4,    -1, -1, -1,    -1, -1, -1,
+   1, 11, 10,     1,  4, 11,     1,  0,  4,     7, 11,  4,    -1, -1, -1,
+   4,  7,  8,     9,  0, 11,     9, 11, 10,    11,  0,  3,    -1, -1, -1,
+   4,  7, 11,     4, 11,  9,     9, 11, 10,    -1, -1, -1,    -1, -1, -1,
+   9,  5,  4,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   9,  5,  4,     0,  8,  3,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   0,  5,  4,     1,  5,  0,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   8,  5,  4,     8,  3,  5,     3,  1,  5,    -1, -1, -1,    -1, -1, -1,
+   1,  2, 10,     9,  5,  4,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   3,  0,  8,     1,  2, 10,     4,  9,  5,    -1, -1, -1,    -1, -1, -1,
+   5,  2, 10,     5,  4,  2,     4,  0,  2,    -1, -1, -1,    -1, -1, -1,
+   2, 10,  5,     3,  2,  5,     3,  5,  4,     3,  4,  8,    -1, -1, -1,
+   9,  5,  4,     2,  3, 11,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   0, 11,  2,     0,  8, 11,     4,  9,  5,    -1, -1, -1,    -1, -1, -1,
+   0,  5,  4,     0,  1,  5,     2,  3, 11,    -1, -1, -1,    -1, -1, -1,
+   2,  1,  5,     2,  5,  8,     2,  8, 11,     4,  8,  5,    -1, -1, -1,
+  10,  3, 11,    10,  1,  3,     9,  5,  4,    -1, -1, -1,    -1, -1, -1,
+   4,  9,  5,     0,  8,  1,     8, 10,  1,     8, 11, 10,    -1, -1, -1,
+   5,  4,  0,     5,  0, 11,     5, 11, 10,    11,  0,  3,    -1, -1, -1,
+   5,  4,  8,     5,  8, 10,    10,  8, 11,    -1, -1, -1,    -1, -1, -1,
+   9,  7,  8,     5,  7,  9,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   9,  3,  0,     9,  5,  3,     5,  7,  3,    -1, -1, -1,    -1, -1, -1,
+   0,  7,  8,     0,  1,  7,     1,  5,  7,    -1, -1, -1,    -1, -1, -1,
+   1,  5,  3,     3,  5,  7,    -1, -1, -1,    -1, -1, -1,    -1, -1, -1,
+   9,  7,  8,     9,  5,  7,    10,  1,  2,    -1, -1, -1,    -1, -1, -1,
+  10,  1,  2,     9,  5,  0,     5,  3,  0,     5,  7,  3,    -1, -1, -1,
+   8,  0,  2,     8,  2,  5,     8,  5,  7,    10,  5,  2,    -1, -1, -1,
+   2, 10,  5,     2,  5,  3,     3,  5,  7,    -1, -1, -1,    -1, -1, -1,
+   7,  9,  5,     7,  8,  9,     3, 11,  2,    -1, -1, -1,    -1, -1, -1,
+   9,  5,  7,     9,  7,  2,     9,  2,  0,     2,  7, 11,    -1, -1, -1,
+   2,  3, 11,     0,  1,  8,     1,  7,  8,     1,  5,  7,    -1, -1, -1,
+  11,  2,  1,    11,  1,  7,     7,  1,  5,    -1, -1, -1,    -1, -1, -1,
    9,  5,  8,     8,  5,  7,    10,  1,  3,    10,  3, 11,    -1, -1, -1,
    5,  7,  0,     5,  0,  9,     7, 11,  0,     1,  0, 10,    11, 10,  0,
   11, 10,  0,    11,  0,  3,    10,  5,  0,     8,  0,  7,     5,  7,  0,
@@ -1058,6 +1605,12 @@ const GLint tri_table[mc_cells_types_count * mc_vertices_per_cell] =
 /** Instance of a timer to measure time moments. */
 Timer timer;
 
+/** Builds all program objects in the background, so the first frames are not stalled by the shader compiler. */
+ProgramCompileQueue programCompileQueue;
+
+/** True once the program objects have been built and their uniforms initialised. */
+bool programs_ready = false;
+
 /** Amount of spheres defining scalar field. This value should be synchronized between all files. */
 const int n_spheres = 3;
 
@@ -1213,162 +1766,268 @@ GLuint        marching_cubes_triangles_lookup_table_texture_id           = 0;
 GLuint        marching_cubes_triangles_vao_id                            = 0;
 
 
-/** Calculates combined model view and projection matrix.
- *
- *  @param mvp combined mvp matrix
- */
-void calc_mvp(Matrix& mvp)
-{
-    /* Define projection properties. */
-    float degreesToRadiansCoefficient = atanf(1) / 45;                            /* Coefficient to recalculate degrees to radians.      */
-    float frustum_fovy                = 45.0f;                                    /* 45 degrees field of view in the y direction.        */
-    float frustum_aspect              = (float)window_width/(float)window_height; /* Aspect ratio.                                       */
-    float frustum_z_near              = 0.01f;                                    /* How close the viewer is to the near clipping plane. */
-    float frustum_z_far               = 100.0f;                                   /* How far the viewer is from the far clipping plane.  */
-    float camera_distance             = 2.5f;                                     /* Distance from camera to scene center.               */
+/* 3-4. Compute shader Marching Cubes stages variable data. Used instead of stages 3 and 4 on OpenGL ES 3.1. */
+/** Program object id for compute shader scalar field generation stage. */
+GLuint        scalar_field_comp_program_id                               = 0;
+/** Program object id for compute shader cell splitting stage. */
+GLuint        marching_cubes_cells_comp_program_id                       = 0;
+/** Program object id for compute shader triangle generation stage. */
+GLuint        marching_cubes_triangles_comp_program_id                   = 0;
+/** Program object id for rendering the triangles generated by the compute shaders. */
+GLuint        marching_cubes_indirect_program_id                         = 0;
 
-    /* Matrix that stores temporary matrix data for translation transformations. */
-    Matrix mat4_translate  = Matrix::createTranslation(-0.5, -0.5, -0.5);
+/** Name of samples_per_axis uniform. */
+const GLchar* scalar_field_comp_uniform_samples_per_axis_name            = "samples_per_axis";
+/** Location of samples_per_axis uniform. */
+GLuint        scalar_field_comp_uniform_samples_per_axis_id              = 0;
 
-    /* Matrix that stores temporary matrix data for scale transformations. */
-    Matrix mat4_scale      = Matrix::createScaling    ( 2.0,  2.0,  2.0);
+/** Name of field_cutoff uniform. */
+const GLchar* scalar_field_comp_uniform_field_cutoff_name                = "field_cutoff";
+/** Location of field_cutoff uniform. */
+GLuint        scalar_field_comp_uniform_field_cutoff_id                  = 0;
 
-    /* Matrix that transforms the vertices from model space to world space. */
-    /* Translate and scale coordinates from [0..1] to [-1..1] range for full visibility. */
-    Matrix mat4_model_view = mat4_scale * mat4_translate;
+/** Name of cells_per_axis uniform. */
+const GLchar* marching_cubes_cells_comp_uniform_cells_per_axis_name      = "cells_per_axis";
+/** Location of cells_per_axis uniform. */
+GLuint        marching_cubes_cells_comp_uniform_cells_per_axis_id        = 0;
 
-    /* Pull the camera back from the scene center. */
-    mat4_model_view[14] -= float(camera_distance);
+/** Name of iso_level uniform. */
+const GLchar* marching_cubes_cells_comp_uniform_isolevel_name            = "iso_level";
+/** Location of iso_level uniform. */
+GLuint        marching_cubes_cells_comp_uniform_isolevel_id              = 0;
 
-    /* Create the perspective matrix from frustum parameters. */
-    Matrix mat4_perspective = Matrix::matrixPerspective(degreesToRadiansCoefficient * frustum_fovy, frustum_aspect, frustum_z_near, frustum_z_far);
+/** Name of iso_level uniform. */
+const GLchar* marching_cubes_triangles_comp_uniform_isolevel_name        = "iso_level";
+/** Location of iso_level uniform. */
+GLuint        marching_cubes_triangles_comp_uniform_isolevel_id          = 0;
 
-    /* MVP (Model View Perspective) matrix is a result of multiplication of Perspective Matrix by Model View Matrix. */
-    mvp = mat4_perspective * mat4_model_view;
-}
+/** Name of max_vertices uniform. */
+const GLchar* marching_cubes_triangles_comp_uniform_max_vertices_name    = "max_vertices";
+/** Location of max_vertices uniform. */
+GLuint        marching_cubes_triangles_comp_uniform_max_vertices_id      = 0;
 
+/** Name of samples_per_axis uniform. */
+const GLchar* marching_cubes_triangles_comp_uniform_samples_per_axis_name = "samples_per_axis";
+/** Location of samples_per_axis uniform. */
+GLuint        marching_cubes_triangles_comp_uniform_samples_per_axis_id  = 0;
 
-/** Initialises OpenGL ES and model environments.
- *
- *  @param width  window width reported by operating system
- *  @param height window width reported by operating system
- */
-void setupGraphics(int width, int height)
-{
-    /* Store window width and height. */
-    window_width  = width;
-    window_height = height;
+/** Name of mvp uniform. */
+const GLchar* marching_cubes_indirect_uniform_mvp_name                   = "mvp";
+/** Location of mvp uniform. */
+GLuint        marching_cubes_indirect_uniform_mvp_id                     = 0;
 
-    /* Specify one byte alignment for pixels rows in memory for pack and unpack buffers. */
-    GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
-    GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT,   1));
+/** Name of time uniform. */
+const GLchar* marching_cubes_indirect_uniform_time_name                  = "time";
+/** Location of time uniform. */
+GLuint        marching_cubes_indirect_uniform_time_id                    = 0;
 
-    /* 1. Calculate sphere positions stage. */
-    /* Create sphere updater program object. */
-    spheres_updater_program_id = GL_CHECK(glCreateProgram());
+/** Id of a buffer object holding the indirect draw and dispatch commands, and the compaction counters. */
+GLuint        marching_cubes_indirect_buffer_id                          = 0;
+/** Id of a buffer object holding the compacted list of cells which generate triangles. */
+GLuint        marching_cubes_active_cells_buffer_id                      = 0;
+/** Id of a buffer object holding the vertices generated by the compute shaders. */
+GLuint        marching_cubes_vertices_buffer_id                          = 0;
+/** Id of a buffer object holding, for each brick, the mask of spheres influencing it. */
+GLuint        marching_cubes_bricks_buffer_id                            = 0;
 
-    /* Load and compile sphere updater shaders. */
-    Shader::processShader(&spheres_updater_vert_shader_id, spheres_updater_vert_shader, GL_VERTEX_SHADER  );
-    Shader::processShader(&spheres_updater_frag_shader_id, spheres_updater_frag_shader, GL_FRAGMENT_SHADER);
+/** Amount of bricks along each axis of the scalar field. */
+GLuint        marching_cubes_bricks_per_axis                             = 0;
 
-    /* Attach the shaders. */
-    GL_CHECK(glAttachShader(spheres_updater_program_id, spheres_updater_vert_shader_id));
-    GL_CHECK(glAttachShader(spheres_updater_program_id, spheres_updater_frag_shader_id));
+/** Amount of vertices marching_cubes_vertices_buffer_id can hold. A multiple of vertices_per_triangle. */
+GLuint        marching_cubes_max_vertices                                = 0;
 
-    /* [Stage 1 Specifying output variables] */
-    /* Specify shader varyings (output variables) we are interested in capturing. */
-    GL_CHECK(glTransformFeedbackVaryings(spheres_updater_program_id, 1, &sphere_position_varying_name, GL_SEPARATE_ATTRIBS));
+/** Contents of marching_cubes_indirect_buffer_id at the start of each frame:
+ *  an empty glDrawArraysIndirect() command, an empty glDispatchComputeIndirect() command and zeroed counters.
+ */
+const GLuint  marching_cubes_indirect_buffer_reset[]                     =
+{
+    0, 1, 0, 0, /* count, instanceCount, first, reserved */
+    0, 1, 1,    /* num_groups_x, num_groups_y, num_groups_z */
+    0, 0        /* Active cells and allocated vertices counters */
+};
 
-    /* Link the program object. */
-    GL_CHECK(glLinkProgram(spheres_updater_program_id));
-    /* [Stage 1 Specifying output variables] */
+/** Offset of the glDispatchComputeIndirect() command in marching_cubes_indirect_buffer_id. */
+const GLintptr marching_cubes_indirect_dispatch_offset                   = 4 * sizeof(GLuint);
+
+/** Size of the bricks the compute shaders split the field into, along each axis. It is also their work group size. */
+const GLuint  marching_cubes_brick_size                                  = 4;
+
+/** Fraction of the isosurface level each sphere's field is lowered by in the compute shader path. Spheres have no
+ *  influence where their field falls below it, which bounds how many bricks they affect, at the cost of slightly
+ *  smaller metaballs than in the transform feedback path. */
+const GLfloat scalar_field_cutoff_fraction                               = 0.125f;
+
+
+/* Grid resolution and temporal reuse properties. */
+/** GPU time (in milliseconds) the frames evaluating the scalar field are kept around, by lowering the grid resolution. */
+const float   grid_target_frame_time                                     = 12.0f;
+/** The grid resolution never goes below this fraction of the resolution it was allocated for. */
+const float   grid_min_scale                                             = 0.5f;
+/** Cells are not made smaller than this on screen (in pixels), as finer detail would not be visible. */
+const GLfloat grid_min_cell_pixels                                       = 4.0f;
+/** Levels of details are multiples of this, so small changes of the GPU time do not change the grid. */
+const GLuint  grid_level_granularity                                     = 4;
+/** Fraction of a cell the spheres may move by before the scalar field and the surface are updated. */
+const GLfloat sphere_motion_threshold                                    = 0.25f;
+
+/** Level of details the buffers and textures are allocated for, tesselation_level goes below it when the GPU is too slow. */
+GLuint        max_tesselation_level                                      = 0;
+/** True to always use max_tesselation_level, so a benchmark measures the grid it asked for. Set by the fixed_tesselation_level parameter. */
+bool          fixed_tesselation_level                                    = false;
+/** Level of details past which cells would be smaller than grid_min_cell_pixels on screen. */
+GLuint        screen_tesselation_level                                   = 0;
+/** Scales the level of details to keep the GPU time of the frames on target. Only its scale is used. */
+DynamicResolution* grid_resolution                                       = NULL;
+
+/** Time (in seconds) the spheres were at when the scalar field was last evaluated. */
+GLfloat       scalar_field_time                                          = 0.0f;
+/** False until the scalar field has been evaluated at the current level of details. */
+bool          scalar_field_valid                                         = false;
+
+/** Sphere motion, the same as in spheres_updater_vert_shader: center, Lissajou amplitudes, frequencies and phases
+ *  (in degrees). Spheres are moved on the GPU, this copy only tells how far they went between two moments. */
+const GLfloat sphere_motions[n_spheres][4][3]                            =
+{
+    {{0.50f, 0.50f, 0.50f}, {0.20f, 0.25f, 0.25f}, {11.0f, 21.0f, 31.0f}, {30.0f, 45.0f,  90.0f}},
+    {{0.50f, 0.50f, 0.50f}, {0.25f, 0.20f, 0.25f}, {22.0f, 32.0f, 12.0f}, {45.0f, 90.0f, 120.0f}},
+    {{0.50f, 0.50f, 0.50f}, {0.25f, 0.25f, 0.20f}, {33.0f, 13.0f, 23.0f}, {90.0f, 120.0f, 150.0f}}
+};
 
-    /* [Stage 1 Specifying input variables] */
-    /* Get input uniform location. */
-    spheres_updater_uniform_time_id = GL_CHECK(glGetUniformLocation(spheres_updater_program_id, spheres_updater_uniform_time_name));
-    /* [Stage 1 Specifying input variables] */
 
-    /* Activate spheres updater program. */
-    GL_CHECK(glUseProgram(spheres_updater_program_id));
+/** Derives the Marching Cubes grid dimensions from a level of details.
+ *
+ *  @param level amount of samples per axis
+ */
+void set_tesselation_level(GLuint level)
+{
+    tesselation_level   = level;
+    samples_per_axis    = tesselation_level;
+    samples_in_3d_space = samples_per_axis * samples_per_axis * samples_per_axis;
+    cells_per_axis      = samples_per_axis - 1;
+    cells_in_3d_space   = cells_per_axis * cells_per_axis * cells_per_axis;
+}
 
-    /* [Stage 1 Allocate buffer for output values] */
-    /* Generate buffer object id. Define required storage space sufficient to hold sphere positions data. */
-    GL_CHECK(glGenBuffers(1, &spheres_updater_sphere_positions_buffer_object_id));
-    GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, spheres_updater_sphere_positions_buffer_object_id));
-    GL_CHECK(glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, n_spheres * n_sphere_position_components * sizeof(GLfloat), NULL, GL_STATIC_DRAW));
-    GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0));
-    /* [Stage 1 Allocate buffer for output values] */
+/** Finds the level of details past which cells would be smaller than grid_min_cell_pixels on screen.
+ *  The field spans the [0..1] cube of model space, which is projected with the mvp matrix.
+ *
+ *  @param mvp combined mvp matrix
+ *  @return    amount of samples per axis
+ */
+GLuint calc_screen_tesselation_level(Matrix& mvp)
+{
+    float min_x =  1.0f, max_x = -1.0f;
+    float min_y =  1.0f, max_y = -1.0f;
 
-    /* [Stage 1 Transform feedback object initialization] */
-    /* Generate and bind transform feedback object. */
-    GL_CHECK(glGenTransformFeedbacks(1, &spheres_updater_transform_feedback_object_id));
-    GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, spheres_updater_transform_feedback_object_id));
+    for (int corner = 0; corner < 8; corner++)
+    {
+        float position[4] = {float(corner & 1), float((corner >> 1) & 1), float((corner >> 2) & 1), 1.0f};
+        float clip[4]     = {0.0f, 0.0f, 0.0f, 0.0f};
 
-    /* Bind buffers to store calculated sphere positions. */
-    GL_CHECK(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, spheres_updater_sphere_positions_buffer_object_id));
-    GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0));
-    /* [Stage 1 Transform feedback object initialization] */
+        /* Matrix elements are stored by columns. */
+        for (int row = 0; row < 4; row++)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                clip[row] += mvp[column * 4 + row] * position[column];
+            }
+        }
 
-    /* 2. Scalar field generation stage. */
-    /* Create scalar field generator program object. */
-    scalar_field_program_id = GL_CHECK(glCreateProgram());
+        min_x = fminf(min_x, clip[0] / clip[3]);
+        max_x = fmaxf(max_x, clip[0] / clip[3]);
+        min_y = fminf(min_y, clip[1] / clip[3]);
+        max_y = fmaxf(max_y, clip[1] / clip[3]);
+    }
 
-    /* Load and compile scalar field generator shaders. */
-    Shader::processShader(&scalar_field_vert_shader_id, scalar_field_vert_shader, GL_VERTEX_SHADER  );
-    Shader::processShader(&scalar_field_frag_shader_id, scalar_field_frag_shader, GL_FRAGMENT_SHADER);
+    /* Normalized device coordinates span 2 units across the window. */
+    float extent = fmaxf((fminf(max_x, 1.0f) - fmaxf(min_x, -1.0f)) * 0.5f * window_width,
+                         (fminf(max_y, 1.0f) - fmaxf(min_y, -1.0f)) * 0.5f * window_height);
 
-    /* Attach the shaders. */
-    GL_CHECK(glAttachShader(scalar_field_program_id, scalar_field_vert_shader_id));
-    GL_CHECK(glAttachShader(scalar_field_program_id, scalar_field_frag_shader_id));
+    return GLuint(extent / grid_min_cell_pixels) + 1;
+}
 
-    /* Specify shader varyings (output variables) we are interested in capturing. */
-    GL_CHECK(glTransformFeedbackVaryings(scalar_field_program_id, 1, &scalar_field_value_varying_name, GL_SEPARATE_ATTRIBS));
+/** Picks the level of details of the frame from the GPU time of the previous ones and the size of the field on screen.
+ *
+ *  @return amount of samples per axis, at most max_tesselation_level
+ */
+GLuint choose_tesselation_level(void)
+{
+    if (fixed_tesselation_level)
+    {
+        return max_tesselation_level;
+    }
 
-    /* Link the program object. */
-    GL_CHECK(glLinkProgram(scalar_field_program_id));
+    float  level     = fminf(float(max_tesselation_level), float(screen_tesselation_level)) * grid_resolution->getScale();
+    GLuint min_level = GLuint(ceilf(max_tesselation_level * grid_min_scale / grid_level_granularity)) * grid_level_granularity;
+    GLuint new_level = GLuint(level) / grid_level_granularity * grid_level_granularity;
 
-    /* Get input uniform locations. */
-    scalar_field_uniform_samples_per_axis_id = GL_CHECK(glGetUniformLocation  (scalar_field_program_id, scalar_field_uniform_samples_per_axis_name));
-    scalar_field_uniform_spheres_id          = GL_CHECK(glGetUniformBlockIndex(scalar_field_program_id, scalar_field_uniform_spheres_name         ));
+    if (new_level < min_level)
+    {
+        new_level = min_level;
+    }
 
-    /* Activate scalar field generating program. */
-    GL_CHECK(glUseProgram(scalar_field_program_id));
+    return new_level < max_tesselation_level ? new_level : max_tesselation_level;
+}
+
+/** Calculates a sphere position the same way as spheres_updater_vert_shader.
+ *
+ *  @param sphere   index of the sphere
+ *  @param time     time moment (in seconds)
+ *  @param position calculated xyz coordinates of the sphere
+ */
+void calc_sphere_position(int sphere, float time, float position[3])
+{
+    const float degreesToRadiansCoefficient = atanf(1) / 45;
 
-    /* Initialize uniforms constant throughout rendering loop. */
-    GL_CHECK(glUniform1i(scalar_field_uniform_samples_per_axis_id, samples_per_axis));
+    for (int axis = 0; axis < 3; axis++)
+    {
+        position[axis] = sphere_motions[sphere][0][axis]
+                       + sphere_motions[sphere][1][axis]
+                       * sinf(degreesToRadiansCoefficient * (sphere_motions[sphere][2][axis] * time + sphere_motions[sphere][3][axis]));
+    }
+}
 
-    /* Set binding point for uniform block. */
-    GL_CHECK(glUniformBlockBinding(scalar_field_program_id, scalar_field_uniform_spheres_id, 0));
-    GL_CHECK(glBindBufferBase(GL_UNIFORM_BUFFER, 0, spheres_updater_sphere_positions_buffer_object_id));
+/** Measures how far the spheres moved between two time moments.
+ *
+ *  @param from_time first time moment (in seconds)
+ *  @param to_time   second time moment (in seconds)
+ *  @return          largest distance a sphere moved by, in model space
+ */
+float calc_sphere_motion(float from_time, float to_time)
+{
+    float motion = 0.0f;
 
-    /* Generate buffer object id. Define required storage space sufficient to hold scalar field data. */
-    GL_CHECK(glGenBuffers(1, &scalar_field_buffer_object_id));
-    GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, scalar_field_buffer_object_id));
+    for (int sphere = 0; sphere < n_spheres; sphere++)
+    {
+        float from[3];
+        float to[3];
 
-    GL_CHECK(glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, samples_in_3d_space * sizeof(GLfloat), NULL, GL_STATIC_DRAW));
-    GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0));
+        calc_sphere_position(sphere, from_time, from);
+        calc_sphere_position(sphere, to_time,   to  );
 
-    /* Generate and bind transform feedback object. */
-    GL_CHECK(glGenTransformFeedbacks(1, &scalar_field_transform_feedback_object_id));
-    GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, scalar_field_transform_feedback_object_id));
+        float distance = sqrtf((to[0] - from[0]) * (to[0] - from[0]) + (to[1] - from[1]) * (to[1] - from[1]) + (to[2] - from[2]) * (to[2] - from[2]));
 
-    /* Bind buffer to store calculated scalar field values. */
-    GL_CHECK(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, scalar_field_buffer_object_id));
-    GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0));
+        motion = fmaxf(motion, distance);
+    }
 
-    /* [Stage 2 Creating texture] */
-    /* Generate texture object to hold scalar field data. */
-    GL_CHECK(glGenTextures(1, &scalar_field_texture_object_id));
+    return motion;
+}
 
-    /* Scalar field uses GL_TEXTURE_3D target of texture unit 1. */
-    GL_CHECK(glActiveTexture(GL_TEXTURE1));
-    GL_CHECK(glBindTexture(GL_TEXTURE_3D, scalar_field_texture_object_id));
+/** Creates a texture object holding a 3D grid of single component values, set up as a data source.
+ *
+ *  @param texture_unit    texture unit the texture stays bound to
+ *  @param internal_format sized internal format of the texture
+ *  @param size            amount of values along each axis
+ *  @return                texture object id
+ */
+GLuint create_grid_texture(GLenum texture_unit, GLenum internal_format, GLuint size)
+{
+    GLuint texture_object_id = 0;
 
-    /* Prepare texture storage for scalar field values. */
-    GL_CHECK(glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32F, samples_per_axis, samples_per_axis, samples_per_axis));
-    /* [Stage 2 Creating texture] */
+    GL_CHECK(glGenTextures(1, &texture_object_id));
+    GL_CHECK(glActiveTexture(texture_unit));
+    GL_CHECK(glBindTexture(GL_TEXTURE_3D, texture_object_id));
+    GL_CHECK(glTexStorage3D(GL_TEXTURE_3D, 1, internal_format, size, size, size));
 
-    /* Tune texture settings to use it as a data source. */
     GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST      ));
     GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST      ));
     GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0               ));
@@ -1377,115 +2036,455 @@ void setupGraphics(int width, int height)
     GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE));
     GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R,     GL_CLAMP_TO_EDGE));
 
+    return texture_object_id;
+}
+
+/** Switches the Marching Cubes stages to another level of details, without reallocating the buffers.
+ *  The compute shaders only use a corner of the textures, whereas the transform feedback shaders
+ *  normalize coordinates by the size of the textures, which are recreated at the new size.
+ *
+ *  @param level amount of samples per axis, at most max_tesselation_level
+ */
+void apply_tesselation_level(GLuint level)
+{
+    set_tesselation_level(level);
+    scalar_field_valid = false;
+
+    if (use_compute_shaders)
+    {
+        marching_cubes_bricks_per_axis = (samples_per_axis + marching_cubes_brick_size - 1) / marching_cubes_brick_size;
+
+        GL_CHECK(glUseProgram(scalar_field_comp_program_id));
+        GL_CHECK(glUniform1i(scalar_field_comp_uniform_samples_per_axis_id,                samples_per_axis));
+        GL_CHECK(glUseProgram(marching_cubes_cells_comp_program_id));
+        GL_CHECK(glUniform1i(marching_cubes_cells_comp_uniform_cells_per_axis_id,          cells_per_axis  ));
+        GL_CHECK(glUseProgram(marching_cubes_triangles_comp_program_id));
+        GL_CHECK(glUniform1i(marching_cubes_triangles_comp_uniform_samples_per_axis_id,    samples_per_axis));
+    }
+    else
+    {
+        GL_CHECK(glDeleteTextures(1, &scalar_field_texture_object_id              ));
+        GL_CHECK(glDeleteTextures(1, &marching_cubes_cells_types_texture_object_id));
+
+        scalar_field_texture_object_id               = create_grid_texture(GL_TEXTURE1, GL_R32F, samples_per_axis);
+        marching_cubes_cells_types_texture_object_id = create_grid_texture(GL_TEXTURE2, GL_R32I, cells_per_axis  );
+
+        GL_CHECK(glUseProgram(scalar_field_program_id));
+        GL_CHECK(glUniform1i(scalar_field_uniform_samples_per_axis_id,             samples_per_axis));
+        GL_CHECK(glUseProgram(marching_cubes_cells_program_id));
+        GL_CHECK(glUniform1i(marching_cubes_cells_uniform_cells_per_axis_id,       cells_per_axis  ));
+        GL_CHECK(glUseProgram(marching_cubes_triangles_program_id));
+        GL_CHECK(glUniform1i(marching_cubes_triangles_uniform_samples_per_axis_id, samples_per_axis));
+    }
+}
+
+/** Checks whether the context supports compute shaders, i.e. is OpenGL ES 3.1 or newer.
+ *
+ *  @return true if the compute shader Marching Cubes stages can be used
+ */
+bool is_compute_shader_supported(void)
+{
+    GLint major_version = 0;
+    GLint minor_version = 0;
 
-    /* 3. Marching Cubes cell-splitting stage. */
-    /* Create a program object to execute Marching Cubes algorithm cell splitting stage. */
-    marching_cubes_cells_program_id = GL_CHECK(glCreateProgram());
+    GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &major_version));
+    GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minor_version));
 
-    /* Marching cubes algorithm shaders initialisation. */
-    Shader::processShader(&marching_cubes_cells_vert_shader_id, marching_cubes_cells_vert_shader, GL_VERTEX_SHADER  );
-    Shader::processShader(&marching_cubes_cells_frag_shader_id, marching_cubes_cells_frag_shader, GL_FRAGMENT_SHADER);
+    return major_version > 3 || (major_version == 3 && minor_version >= 1);
+}
 
-    /* Attach the shaders. */
-    GL_CHECK(glAttachShader(marching_cubes_cells_program_id, marching_cubes_cells_vert_shader_id));
-    GL_CHECK(glAttachShader(marching_cubes_cells_program_id, marching_cubes_cells_frag_shader_id));
+/** Compiles and links a compute shader program. ProgramCompileQueue only builds vertex and fragment shader programs.
+ *  Errors are logged and terminate the application, as in Shader::processShaderSource().
+ *
+ *  @param compute_shader_source OpenGL ES SL source code of the compute shader
+ *  @return                      program object id
+ */
+GLuint create_compute_program(const char* compute_shader_source)
+{
+    GLuint program_id     = GL_CHECK(glCreateProgram());
+    GLuint shader_id      = 0;
+    GLint  link_status    = GL_FALSE;
 
-    /* Specify shader varyings (output variables) we are interested in capturing. */
-    GL_CHECK(glTransformFeedbackVaryings(marching_cubes_cells_program_id, 1, &marching_cubes_cells_varying_name, GL_SEPARATE_ATTRIBS));
+    Shader::processShaderSource(&shader_id, compute_shader_source, GL_COMPUTE_SHADER);
 
-    /* Link the program object. */
-    GL_CHECK(glLinkProgram(marching_cubes_cells_program_id));
+    GL_CHECK(glAttachShader(program_id, shader_id));
+    GL_CHECK(glLinkProgram (program_id));
+    GL_CHECK(glDeleteShader(shader_id));
 
-    /* Get input uniform locations. */
-    marching_cubes_cells_uniform_cells_per_axis_id       = GL_CHECK(glGetUniformLocation(marching_cubes_cells_program_id, marching_cubes_cells_uniform_cells_per_axis_name));
-    marching_cubes_cells_uniform_scalar_field_sampler_id = GL_CHECK(glGetUniformLocation(marching_cubes_cells_program_id, marching_cubes_cells_uniform_scalar_field_sampler_name));
-    marching_cubes_cells_uniform_isolevel_id             = GL_CHECK(glGetUniformLocation(marching_cubes_cells_program_id, marching_cubes_cells_uniform_isolevel_name));
+    GL_CHECK(glGetProgramiv(program_id, GL_LINK_STATUS, &link_status));
+    if (link_status != GL_TRUE)
+    {
+        GLint length = 0;
 
-    /* Activate cell-splitting program. */
-    GL_CHECK(glUseProgram(marching_cubes_cells_program_id));
+        GL_CHECK(glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &length));
 
-    /* Initialize uniforms constant throughout rendering loop. */
-    GL_CHECK(glUniform1i(marching_cubes_cells_uniform_cells_per_axis_id,       cells_per_axis  ));
-    GL_CHECK(glUniform1f(marching_cubes_cells_uniform_isolevel_id,             isosurface_level));
-    GL_CHECK(glUniform1i(marching_cubes_cells_uniform_scalar_field_sampler_id, 1               ));
+        char* link_log = (char*)malloc(length);
 
-    /* Generate buffer object id and allocate memory to store scalar field values. */
-    GL_CHECK(glGenBuffers(1, &marching_cubes_cells_types_buffer_id));
-    GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, marching_cubes_cells_types_buffer_id));
-    GL_CHECK(glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, cells_in_3d_space * sizeof(GLint), NULL, GL_STATIC_DRAW));
-    GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0));
+        GL_CHECK(glGetProgramInfoLog(program_id, length, NULL, link_log));
+        LOGE("Linking compute program FAILED!\n%s\n", link_log);
 
-    /* Generate and bind transform feedback object. */
-    GL_CHECK(glGenTransformFeedbacks(1, &marching_cubes_cells_transform_feedback_object_id));
-    GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, marching_cubes_cells_transform_feedback_object_id));
+        free(link_log);
+        exit(1);
+    }
 
-    /* Bind buffer to store calculated cell type data. */
-    GL_CHECK(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, marching_cubes_cells_types_buffer_id));
-    GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0));
+    return program_id;
+}
 
-    /* [Stage 3 Creating texture] */
-    /* Generate a texture object to hold cell type data. (We will explain why the texture later). */
-    GL_CHECK(glGenTextures(1, &marching_cubes_cells_types_texture_object_id));
 
-    /* Marching cubes cell type data uses GL_TEXTURE_3D target of texture unit 2. */
-    GL_CHECK(glActiveTexture(GL_TEXTURE2));
-    GL_CHECK(glBindTexture(GL_TEXTURE_3D, marching_cubes_cells_types_texture_object_id));
+/** Calculates combined model view and projection matrix.
+ *
+ *  @param mvp combined mvp matrix
+ */
+void calc_mvp(Matrix& mvp)
+{
+    /* Define projection properties. */
+    float degreesToRadiansCoefficient = atanf(1) / 45;                            /* Coefficient to recalculate degrees to radians.      */
+    float frustum_fovy                = 45.0f;                                    /* 45 degrees field of view in the y direction.        */
+    float frustum_aspect              = (float)window_width/(float)window_height; /* Aspect ratio.                                       */
+    float frustum_z_near              = 0.01f;                                    /* How close the viewer is to the near clipping plane. */
+    float frustum_z_far               = 100.0f;                                   /* How far the viewer is from the far clipping plane.  */
+    float camera_distance             = 2.5f;                                     /* Distance from camera to scene center.               */
 
-    /* Prepare texture storage for marching cube cell type data. */
-    GL_CHECK(glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32I, cells_per_axis, cells_per_axis, cells_per_axis));
-    /* [Stage 3 Creating texture] */
+    /* Matrix that stores temporary matrix data for translation transformations. */
+    Matrix mat4_translate  = Matrix::createTranslation(-0.5, -0.5, -0.5);
 
-    /* Tune texture settings to use it as a data source. */
-    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST      ));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST      ));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0               ));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL,  0               ));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R,     GL_CLAMP_TO_EDGE));
+    /* Matrix that stores temporary matrix data for scale transformations. */
+    Matrix mat4_scale      = Matrix::createScaling    ( 2.0,  2.0,  2.0);
+
+    /* Matrix that transforms the vertices from model space to world space. */
+    /* Translate and scale coordinates from [0..1] to [-1..1] range for full visibility. */
+    Matrix mat4_model_view = mat4_scale * mat4_translate;
 
+    /* Pull the camera back from the scene center. */
+    mat4_model_view[14] -= float(camera_distance);
 
-    /* 4. Marching Cubes algorithm triangle generation and rendering stage. */
-    /* Create a program object that we will use for triangle generation and rendering stage. */
-    marching_cubes_triangles_program_id = GL_CHECK(glCreateProgram());
+    /* Create the perspective matrix from frustum parameters. */
+    Matrix mat4_perspective = Matrix::matrixPerspective(degreesToRadiansCoefficient * frustum_fovy, frustum_aspect, frustum_z_near, frustum_z_far);
 
-    /* Initialize shaders for the triangle generation and rendering stage. */
-    Shader::processShader(&marching_cubes_triangles_vert_shader_id, marching_cubes_triangles_vert_shader, GL_VERTEX_SHADER  );
-    Shader::processShader(&marching_cubes_triangles_frag_shader_id, marching_cubes_triangles_frag_shader, GL_FRAGMENT_SHADER);
+    /* MVP (Model View Perspective) matrix is a result of multiplication of Perspective Matrix by Model View Matrix. */
+    mvp = mat4_perspective * mat4_model_view;
+}
+
+
+/** Retrieves uniform locations and initialises uniforms of the built program objects. */
+void setupPrograms(void)
+{
+    /* [Stage 1 Specifying input variables] */
+    /* Get input uniform location. */
+    spheres_updater_uniform_time_id = GL_CHECK(glGetUniformLocation(spheres_updater_program_id, spheres_updater_uniform_time_name));
+    /* [Stage 1 Specifying input variables] */
 
-    /* Attach the shaders. */
-    GL_CHECK(glAttachShader(marching_cubes_triangles_program_id, marching_cubes_triangles_vert_shader_id));
-    GL_CHECK(glAttachShader(marching_cubes_triangles_program_id, marching_cubes_triangles_frag_shader_id));
+    /* Activate spheres updater program. */
+    GL_CHECK(glUseProgram(spheres_updater_program_id));
 
-    /* Link the program object. */
-    GL_CHECK(glLinkProgram(marching_cubes_triangles_program_id));
+    /* 2. Scalar field generation stage. */
+    if (use_compute_shaders)
+    {
+        /* Get input uniform locations. The uniform block binding point is set in the shader. */
+        scalar_field_comp_uniform_samples_per_axis_id = GL_CHECK(glGetUniformLocation(scalar_field_comp_program_id, scalar_field_comp_uniform_samples_per_axis_name));
+        scalar_field_comp_uniform_field_cutoff_id     = GL_CHECK(glGetUniformLocation(scalar_field_comp_program_id, scalar_field_comp_uniform_field_cutoff_name    ));
 
-    /* Get input uniform locations. */
-    marching_cubes_triangles_uniform_time_id                 = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_time_name                ));
-    marching_cubes_triangles_uniform_samples_per_axis_id     = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_samples_per_axis_name    ));
-    marching_cubes_triangles_uniform_isolevel_id             = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_isolevel_name            ));
-    marching_cubes_triangles_uniform_mvp_id                  = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_mvp_name                 ));
-    marching_cubes_triangles_uniform_cell_types_sampler_id   = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_cell_types_sampler_name  ));
-    marching_cubes_triangles_uniform_tri_table_sampler_id    = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_tri_table_sampler_name   ));
-    marching_cubes_triangles_uniform_scalar_field_sampler_id = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_scalar_field_sampler_name));
-    marching_cubes_triangles_uniform_sphere_positions_id     = GL_CHECK(glGetUniformBlockIndex(marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_sphere_positions_name    ));
+        /* Activate scalar field generating program. */
+        GL_CHECK(glUseProgram(scalar_field_comp_program_id));
 
-    /* Activate triangle generating and rendering program. */
-    GL_CHECK(glUseProgram(marching_cubes_triangles_program_id));
+        /* Initialize uniforms constant throughout rendering loop. */
+        GL_CHECK(glUniform1i(scalar_field_comp_uniform_samples_per_axis_id, samples_per_axis                                ));
+        GL_CHECK(glUniform1f(scalar_field_comp_uniform_field_cutoff_id,     isosurface_level * scalar_field_cutoff_fraction));
+    }
+    else
+    {
+        /* Get input uniform locations. */
+        scalar_field_uniform_samples_per_axis_id = GL_CHECK(glGetUniformLocation  (scalar_field_program_id, scalar_field_uniform_samples_per_axis_name));
+        scalar_field_uniform_spheres_id          = GL_CHECK(glGetUniformBlockIndex(scalar_field_program_id, scalar_field_uniform_spheres_name         ));
+
+        /* Activate scalar field generating program. */
+        GL_CHECK(glUseProgram(scalar_field_program_id));
+
+        /* Initialize uniforms constant throughout rendering loop. */
+        GL_CHECK(glUniform1i(scalar_field_uniform_samples_per_axis_id, samples_per_axis));
+
+        /* Set binding point for uniform block. */
+        GL_CHECK(glUniformBlockBinding(scalar_field_program_id, scalar_field_uniform_spheres_id, 0));
+    }
+
+    GL_CHECK(glBindBufferBase(GL_UNIFORM_BUFFER, 0, spheres_updater_sphere_positions_buffer_object_id));
 
     /* Initialize model view projection matrix. */
     calc_mvp(mvp);
 
-    /* Initialize uniforms constant throughout rendering loop. */
-    GL_CHECK(glUniform1f(marching_cubes_triangles_uniform_isolevel_id,             isosurface_level));
-    GL_CHECK(glUniform1i(marching_cubes_triangles_uniform_samples_per_axis_id,     samples_per_axis));
-    GL_CHECK(glUniform1i(marching_cubes_triangles_uniform_tri_table_sampler_id,    4               ));
-    GL_CHECK(glUniform1i(marching_cubes_triangles_uniform_cell_types_sampler_id,   2               ));
-    GL_CHECK(glUniform1i(marching_cubes_triangles_uniform_scalar_field_sampler_id, 1               ));
-    GL_CHECK(glUniformMatrix4fv(marching_cubes_triangles_uniform_mvp_id, 1, GL_FALSE, mvp.getAsArray()));
+    /* Finer grids than the window resolution shows are not worth their cost. */
+    screen_tesselation_level = calc_screen_tesselation_level(mvp);
+
+    if (use_compute_shaders)
+    {
+        /* 3-4. Compute shader Marching Cubes stages. */
+        /* Get input uniform locations. */
+        marching_cubes_cells_comp_uniform_cells_per_axis_id   = GL_CHECK(glGetUniformLocation(marching_cubes_cells_comp_program_id,     marching_cubes_cells_comp_uniform_cells_per_axis_name  ));
+        marching_cubes_cells_comp_uniform_isolevel_id         = GL_CHECK(glGetUniformLocation(marching_cubes_cells_comp_program_id,     marching_cubes_cells_comp_uniform_isolevel_name        ));
+        marching_cubes_triangles_comp_uniform_isolevel_id     = GL_CHECK(glGetUniformLocation(marching_cubes_triangles_comp_program_id, marching_cubes_triangles_comp_uniform_isolevel_name    ));
+        marching_cubes_triangles_comp_uniform_max_vertices_id = GL_CHECK(glGetUniformLocation(marching_cubes_triangles_comp_program_id, marching_cubes_triangles_comp_uniform_max_vertices_name));
+        marching_cubes_triangles_comp_uniform_samples_per_axis_id = GL_CHECK(glGetUniformLocation(marching_cubes_triangles_comp_program_id, marching_cubes_triangles_comp_uniform_samples_per_axis_name));
+        marching_cubes_indirect_uniform_mvp_id                = GL_CHECK(glGetUniformLocation(marching_cubes_indirect_program_id,       marching_cubes_indirect_uniform_mvp_name               ));
+        marching_cubes_indirect_uniform_time_id               = GL_CHECK(glGetUniformLocation(marching_cubes_indirect_program_id,       marching_cubes_indirect_uniform_time_name              ));
+
+        /* Initialize uniforms constant throughout rendering loop. Samplers and buffers have their bindings set in the shaders. */
+        GL_CHECK(glUseProgram(marching_cubes_cells_comp_program_id));
+        GL_CHECK(glUniform1i(marching_cubes_cells_comp_uniform_cells_per_axis_id,      cells_per_axis             ));
+        GL_CHECK(glUniform1f(marching_cubes_cells_comp_uniform_isolevel_id,            isosurface_level           ));
+
+        GL_CHECK(glUseProgram(marching_cubes_triangles_comp_program_id));
+        GL_CHECK(glUniform1f (marching_cubes_triangles_comp_uniform_isolevel_id,       isosurface_level           ));
+        GL_CHECK(glUniform1ui(marching_cubes_triangles_comp_uniform_max_vertices_id,   marching_cubes_max_vertices));
+        GL_CHECK(glUniform1i (marching_cubes_triangles_comp_uniform_samples_per_axis_id, samples_per_axis         ));
+
+        GL_CHECK(glUseProgram(marching_cubes_indirect_program_id));
+        GL_CHECK(glUniformMatrix4fv(marching_cubes_indirect_uniform_mvp_id, 1, GL_FALSE, mvp.getAsArray()));
+    }
+    else
+    {
+        /* 3. Marching Cubes cell-splitting stage. */
+        /* Get input uniform locations. */
+        marching_cubes_cells_uniform_cells_per_axis_id       = GL_CHECK(glGetUniformLocation(marching_cubes_cells_program_id, marching_cubes_cells_uniform_cells_per_axis_name));
+        marching_cubes_cells_uniform_scalar_field_sampler_id = GL_CHECK(glGetUniformLocation(marching_cubes_cells_program_id, marching_cubes_cells_uniform_scalar_field_sampler_name));
+        marching_cubes_cells_uniform_isolevel_id             = GL_CHECK(glGetUniformLocation(marching_cubes_cells_program_id, marching_cubes_cells_uniform_isolevel_name));
+
+        /* Activate cell-splitting program. */
+        GL_CHECK(glUseProgram(marching_cubes_cells_program_id));
+
+        /* Initialize uniforms constant throughout rendering loop. */
+        GL_CHECK(glUniform1i(marching_cubes_cells_uniform_cells_per_axis_id,       cells_per_axis  ));
+        GL_CHECK(glUniform1f(marching_cubes_cells_uniform_isolevel_id,             isosurface_level));
+        GL_CHECK(glUniform1i(marching_cubes_cells_uniform_scalar_field_sampler_id, 1               ));
+
+        /* 4. Marching Cubes algorithm triangle generation and rendering stage. */
+        /* Get input uniform locations. */
+        marching_cubes_triangles_uniform_time_id                 = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_time_name                ));
+        marching_cubes_triangles_uniform_samples_per_axis_id     = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_samples_per_axis_name    ));
+        marching_cubes_triangles_uniform_isolevel_id             = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_isolevel_name            ));
+        marching_cubes_triangles_uniform_mvp_id                  = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_mvp_name                 ));
+        marching_cubes_triangles_uniform_cell_types_sampler_id   = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_cell_types_sampler_name  ));
+        marching_cubes_triangles_uniform_tri_table_sampler_id    = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_tri_table_sampler_name   ));
+        marching_cubes_triangles_uniform_scalar_field_sampler_id = GL_CHECK(glGetUniformLocation  (marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_scalar_field_sampler_name));
+        marching_cubes_triangles_uniform_sphere_positions_id     = GL_CHECK(glGetUniformBlockIndex(marching_cubes_triangles_program_id, marching_cubes_triangles_uniform_sphere_positions_name    ));
+
+        /* Activate triangle generating and rendering program. */
+        GL_CHECK(glUseProgram(marching_cubes_triangles_program_id));
+
+        /* Initialize uniforms constant throughout rendering loop. */
+        GL_CHECK(glUniform1f(marching_cubes_triangles_uniform_isolevel_id,             isosurface_level));
+        GL_CHECK(glUniform1i(marching_cubes_triangles_uniform_samples_per_axis_id,     samples_per_axis));
+        GL_CHECK(glUniform1i(marching_cubes_triangles_uniform_tri_table_sampler_id,    4               ));
+        GL_CHECK(glUniform1i(marching_cubes_triangles_uniform_cell_types_sampler_id,   2               ));
+        GL_CHECK(glUniform1i(marching_cubes_triangles_uniform_scalar_field_sampler_id, 1               ));
+        GL_CHECK(glUniformMatrix4fv(marching_cubes_triangles_uniform_mvp_id, 1, GL_FALSE, mvp.getAsArray()));
+    }
 
     /* Allocate memory for buffer */
     GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, spheres_updater_sphere_positions_buffer_object_id));
+}
+
+/** Initialises OpenGL ES and model environments.
+ *
+ *  @param width  window width reported by operating system
+ *  @param height window width reported by operating system
+ */
+void setupGraphics(int width, int height)
+{
+    /* Store window width and height. */
+    window_width  = width;
+    window_height = height;
+
+    /* Marching Cubes stages 3 and 4 run in compute shaders when available. They only emit triangles for
+     * cells the isosurface goes through, which keeps a denser grid affordable. */
+    use_compute_shaders = is_compute_shader_supported();
+
+    if (use_compute_shaders)
+    {
+        set_tesselation_level(compute_tesselation_level);
+    }
+
+    /* The tesselation_level parameter overrides the default of the path, to measure how the sample scales without rebuilding it. */
+    SampleParameters::load("/data/data/com.arm.malideveloper.openglessdk.metaballs/");
+    set_tesselation_level(SampleParameters::getInt("tesselation_level", tesselation_level, 8, 256));
+    fixed_tesselation_level = SampleParameters::getInt("fixed_tesselation_level", 0, 0, 1) != 0;
+
+    /* Everything is allocated for the finest grid. The grid in use is picked each frame, see choose_tesselation_level(). */
+    max_tesselation_level = tesselation_level;
+
+    delete grid_resolution;
+    grid_resolution = new DynamicResolution(max_tesselation_level, max_tesselation_level, grid_target_frame_time, grid_min_scale);
+
+    LOGI("Marching Cubes on up to a %u^3 grid, using %s.\n", samples_per_axis, use_compute_shaders ? "compute shaders" : "transform feedback");
+
+    /* Specify one byte alignment for pixels rows in memory for pack and unpack buffers. */
+    GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT,   1));
+
+    /* 1. Calculate sphere positions stage. */
+    /* Create sphere updater program object. Its shaders are compiled and linked by the queue. */
+    spheres_updater_program_id = programCompileQueue.addProgram(spheres_updater_vert_shader, spheres_updater_frag_shader);
+
+    /* [Stage 1 Specifying output variables] */
+    /* Specify shader varyings (output variables) we are interested in capturing. They take effect when the program is linked. */
+    GL_CHECK(glTransformFeedbackVaryings(spheres_updater_program_id, 1, &sphere_position_varying_name, GL_SEPARATE_ATTRIBS));
+    /* [Stage 1 Specifying output variables] */
+
+    /* [Stage 1 Allocate buffer for output values] */
+    /* Generate buffer object id. Define required storage space sufficient to hold sphere positions data. */
+    GL_CHECK(glGenBuffers(1, &spheres_updater_sphere_positions_buffer_object_id));
+    GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, spheres_updater_sphere_positions_buffer_object_id));
+    GL_CHECK(glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, n_spheres * n_sphere_position_components * sizeof(GLfloat), NULL, GL_STATIC_DRAW));
+    GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0));
+    /* [Stage 1 Allocate buffer for output values] */
+
+    /* [Stage 1 Transform feedback object initialization] */
+    /* Generate and bind transform feedback object. */
+    GL_CHECK(glGenTransformFeedbacks(1, &spheres_updater_transform_feedback_object_id));
+    GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, spheres_updater_transform_feedback_object_id));
+
+    /* Bind buffers to store calculated sphere positions. */
+    GL_CHECK(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, spheres_updater_sphere_positions_buffer_object_id));
+    GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0));
+    /* [Stage 1 Transform feedback object initialization] */
+
+    /* 2. Scalar field generation stage. */
+    if (!use_compute_shaders)
+    {
+        /* Create scalar field generator program object. */
+        scalar_field_program_id = programCompileQueue.addProgram(scalar_field_vert_shader, scalar_field_frag_shader);
+
+        /* Specify shader varyings (output variables) we are interested in capturing. */
+        GL_CHECK(glTransformFeedbackVaryings(scalar_field_program_id, 1, &scalar_field_value_varying_name, GL_SEPARATE_ATTRIBS));
+
+        /* Generate buffer object id. Define required storage space sufficient to hold scalar field data. */
+        GL_CHECK(glGenBuffers(1, &scalar_field_buffer_object_id));
+        GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, scalar_field_buffer_object_id));
+
+        GL_CHECK(glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, samples_in_3d_space * sizeof(GLfloat), NULL, GL_STATIC_DRAW));
+        GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0));
+
+        /* Generate and bind transform feedback object. */
+        GL_CHECK(glGenTransformFeedbacks(1, &scalar_field_transform_feedback_object_id));
+        GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, scalar_field_transform_feedback_object_id));
+
+        /* Bind buffer to store calculated scalar field values. */
+        GL_CHECK(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, scalar_field_buffer_object_id));
+        GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0));
+    }
+
+    /* [Stage 2 Creating texture] */
+    /* Generate texture object to hold scalar field data. */
+    GL_CHECK(glGenTextures(1, &scalar_field_texture_object_id));
+
+    /* Scalar field uses GL_TEXTURE_3D target of texture unit 1. */
+    GL_CHECK(glActiveTexture(GL_TEXTURE1));
+    GL_CHECK(glBindTexture(GL_TEXTURE_3D, scalar_field_texture_object_id));
+
+    /* Prepare texture storage for scalar field values. */
+    GL_CHECK(glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32F, samples_per_axis, samples_per_axis, samples_per_axis));
+    /* [Stage 2 Creating texture] */
+
+    /* Tune texture settings to use it as a data source. */
+    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST      ));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST      ));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0               ));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL,  0               ));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R,     GL_CLAMP_TO_EDGE));
+
+
+    if (use_compute_shaders)
+    {
+        /* 3-4. Compute shader Marching Cubes stages. */
+        /* The compute programs are built once the queue has been submitted, the rendering program goes through the queue. */
+        marching_cubes_indirect_program_id = programCompileQueue.addProgram(marching_cubes_indirect_vert_shader, marching_cubes_triangles_frag_shader);
+
+        /* Size the vertex buffer for the isosurface, rather than for the worst case of every cell emitting triangles_per_cell triangles. */
+        marching_cubes_max_vertices = cells_per_axis * cells_per_axis * compute_vertices_per_face_cell;
+
+        /* Generate buffer object for the indirect commands and counters. */
+        GL_CHECK(glGenBuffers(1, &marching_cubes_indirect_buffer_id));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, marching_cubes_indirect_buffer_id));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(marching_cubes_indirect_buffer_reset), marching_cubes_indirect_buffer_reset, GL_DYNAMIC_DRAW));
+
+        /* Generate buffer object for the compacted cell list. In the worst case every cell is active. */
+        GL_CHECK(glGenBuffers(1, &marching_cubes_active_cells_buffer_id));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, marching_cubes_active_cells_buffer_id));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, cells_in_3d_space * 2 * sizeof(GLuint), NULL, GL_DYNAMIC_COPY));
+
+        /* Generate buffer object for the generated vertices: a position and a normal vector per vertex. */
+        GL_CHECK(glGenBuffers(1, &marching_cubes_vertices_buffer_id));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, marching_cubes_vertices_buffer_id));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, marching_cubes_max_vertices * 8 * sizeof(GLfloat), NULL, GL_DYNAMIC_COPY));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+        /* Generate buffer object for the sphere masks of the bricks. */
+        marching_cubes_bricks_per_axis = (samples_per_axis + marching_cubes_brick_size - 1) / marching_cubes_brick_size;
+
+        GL_CHECK(glGenBuffers(1, &marching_cubes_bricks_buffer_id));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, marching_cubes_bricks_buffer_id));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, marching_cubes_bricks_per_axis * marching_cubes_bricks_per_axis * marching_cubes_bricks_per_axis * sizeof(GLuint), NULL, GL_DYNAMIC_COPY));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+        /* The buffers stay bound to the binding points the compute shaders declare. */
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, marching_cubes_indirect_buffer_id    ));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, marching_cubes_active_cells_buffer_id));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, marching_cubes_vertices_buffer_id    ));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, marching_cubes_bricks_buffer_id      ));
+
+        /* The scalar field texture is written as an image by the compute shader scalar field stage. */
+        GL_CHECK(glBindImageTexture(0, scalar_field_texture_object_id, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32F));
+    }
+    else
+    {
+        /* 3. Marching Cubes cell-splitting stage. */
+        /* Create a program object to execute Marching Cubes algorithm cell splitting stage. */
+        marching_cubes_cells_program_id = programCompileQueue.addProgram(marching_cubes_cells_vert_shader, marching_cubes_cells_frag_shader);
+
+        /* Specify shader varyings (output variables) we are interested in capturing. */
+        GL_CHECK(glTransformFeedbackVaryings(marching_cubes_cells_program_id, 1, &marching_cubes_cells_varying_name, GL_SEPARATE_ATTRIBS));
+
+        /* Generate buffer object id and allocate memory to store scalar field values. */
+        GL_CHECK(glGenBuffers(1, &marching_cubes_cells_types_buffer_id));
+        GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, marching_cubes_cells_types_buffer_id));
+        GL_CHECK(glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, cells_in_3d_space * sizeof(GLint), NULL, GL_STATIC_DRAW));
+        GL_CHECK(glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0));
+
+        /* Generate and bind transform feedback object. */
+        GL_CHECK(glGenTransformFeedbacks(1, &marching_cubes_cells_transform_feedback_object_id));
+        GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, marching_cubes_cells_transform_feedback_object_id));
+
+        /* Bind buffer to store calculated cell type data. */
+        GL_CHECK(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, marching_cubes_cells_types_buffer_id));
+        GL_CHECK(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0));
+
+        /* [Stage 3 Creating texture] */
+        /* Generate a texture object to hold cell type data. (We will explain why the texture later). */
+        GL_CHECK(glGenTextures(1, &marching_cubes_cells_types_texture_object_id));
+
+        /* Marching cubes cell type data uses GL_TEXTURE_3D target of texture unit 2. */
+        GL_CHECK(glActiveTexture(GL_TEXTURE2));
+        GL_CHECK(glBindTexture(GL_TEXTURE_3D, marching_cubes_cells_types_texture_object_id));
+
+        /* Prepare texture storage for marching cube cell type data. */
+        GL_CHECK(glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32I, cells_per_axis, cells_per_axis, cells_per_axis));
+        /* [Stage 3 Creating texture] */
+
+        /* Tune texture settings to use it as a data source. */
+        GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST      ));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST      ));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0               ));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL,  0               ));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R,     GL_CLAMP_TO_EDGE));
+
+
+        /* 4. Marching Cubes algorithm triangle generation and rendering stage. */
+        /* Create a program object that we will use for triangle generation and rendering stage. */
+        marching_cubes_triangles_program_id = programCompileQueue.addProgram(marching_cubes_triangles_vert_shader, marching_cubes_triangles_frag_shader);
+    }
 
     /* Generate an Id for a texture object to hold look-up array data (tri_table). */
     GL_CHECK(glGenTextures(1, &marching_cubes_triangles_lookup_table_texture_id));
@@ -1523,27 +2522,114 @@ void setupGraphics(int width, int height)
      */
     GL_CHECK(glBindVertexArray(marching_cubes_triangles_vao_id));
 
+    if (use_compute_shaders)
+    {
+        /* The compute shader path does feed attributes: the vertices it generated. */
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, marching_cubes_vertices_buffer_id));
+        GL_CHECK(glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (const GLvoid*)0                      ));
+        GL_CHECK(glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (const GLvoid*)(4 * sizeof(GLfloat))));
+        GL_CHECK(glEnableVertexAttribArray(0));
+        GL_CHECK(glEnableVertexAttribArray(1));
+
+        /* Indirect draw and dispatch commands are both taken from the same buffer. */
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER,     marching_cubes_indirect_buffer_id));
+        GL_CHECK(glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, marching_cubes_indirect_buffer_id));
+    }
+
     /* Enable facet culling, depth testing and specify front face for polygons. */
     GL_CHECK(glEnable   (GL_DEPTH_TEST));
     GL_CHECK(glEnable   (GL_CULL_FACE ));
     GL_CHECK(glFrontFace(GL_CW        ));
 
-    /* Start counting time. */
-    timer.reset();
+    /* Start building the programs. They are set up by setupPrograms() once the queue is complete. */
+    programCompileQueue.submit();
+
+    if (use_compute_shaders)
+    {
+        /* ProgramCompileQueue does not take compute shaders, so build them while it works on the other programs. */
+        scalar_field_comp_program_id             = create_compute_program(scalar_field_comp_shader            );
+        marching_cubes_cells_comp_program_id     = create_compute_program(marching_cubes_cells_comp_shader    );
+        marching_cubes_triangles_comp_program_id = create_compute_program(marching_cubes_triangles_comp_shader);
+    }
 }
 
-/** Draws one frame. */
-void renderFrame(void)
+/** Draws the surface from the results of the last evaluation of the scalar field. */
+void renderSurface(void)
 {
-    /* Update time. */
-    model_time = timer.getTime();
+    if (use_compute_shaders)
+    {
+        /* The vertices and the draw command generated by the compute shaders are still there. */
+        GL_CHECK(glUseProgram(marching_cubes_indirect_program_id));
+        GL_CHECK(glUniform1f(marching_cubes_indirect_uniform_time_id, model_time));
+        GL_CHECK(glDrawArraysIndirect(GL_TRIANGLES, 0));
+        return;
+    }
 
-    /*
-     * Rendering section
+    /* 4. Marching Cubes algorithm triangle generation stage.
+     *
+     * At this stage, we render exactly (3 vertices * 5 triangles per cell *
+     * amount of cells the scalar field is split to) triangle vertices.
+     * Then render triangularized geometry.
      */
-    /* Clear the buffers that we are going to render to in a moment. */
-    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+
+    /* Activate triangle generating and rendering program. */
+    GL_CHECK(glUseProgram(marching_cubes_triangles_program_id));
+
+    /* Specify input arguments to vertex shader. */
+    GL_CHECK(glUniform1f(marching_cubes_triangles_uniform_time_id, model_time));
+
+    /* [Stage 4 Run triangle generating and rendering program] */
+    /* Run triangle generating and rendering program. */
+    GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, cells_in_3d_space * triangles_per_cell * vertices_per_triangle));
+    /* [Stage 4 Run triangle generating and rendering program] */
+}
+
+/** Runs stages 2 to 4 in compute shaders and draws the generated triangles. Used instead of the transform feedback stages. */
+void renderMarchingCubesCompute(void)
+{
+    /* 2. Scalar field generation stage.
+     *
+     * Bin the spheres into bricks and evaluate the field of each sample from the spheres of its brick only.
+     */
+    GL_CHECK(glUseProgram(scalar_field_comp_program_id));
+    GL_CHECK(glDispatchCompute(marching_cubes_bricks_per_axis, marching_cubes_bricks_per_axis, marching_cubes_bricks_per_axis));
+
+    /* The field is fetched from the texture, and the brick masks read from their buffer, by the following shaders. */
+    GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+
+    /* Start the compaction over: no active cells, no vertices, and empty draw and dispatch commands. */
+    GL_CHECK(glBindBuffer   (GL_SHADER_STORAGE_BUFFER, marching_cubes_indirect_buffer_id));
+    GL_CHECK(glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(marching_cubes_indirect_buffer_reset), marching_cubes_indirect_buffer_reset));
+
+    /* 3. Marching Cubes algorithm cell splitting stage.
+     *
+     * Classify the cells of the bricks influenced by spheres and append the ones generating triangles
+     * to the active cell list, reserving their vertices at the same time. Work groups match the bricks.
+     */
+    GL_CHECK(glUseProgram(marching_cubes_cells_comp_program_id));
+    GL_CHECK(glDispatchCompute(marching_cubes_bricks_per_axis, marching_cubes_bricks_per_axis, marching_cubes_bricks_per_axis));
+
+    /* The active cell list is read by the next shader, and the dispatch command it sized is read by the GL. */
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT));
+
+    /* 4. Marching Cubes algorithm triangle generation stage.
+     *
+     * Generate the triangles of the active cells only. The shader completes the draw command.
+     */
+    GL_CHECK(glUseProgram(marching_cubes_triangles_comp_program_id));
+    GL_CHECK(glDispatchComputeIndirect(marching_cubes_indirect_dispatch_offset));
 
+    /* The vertices are read as attributes, and the draw command by the GL. */
+    GL_CHECK(glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT));
+
+    /* Render the generated triangles, without reading the vertex count back. */
+    renderSurface();
+}
+
+/** Runs all stages for the spheres at model_time, and draws the new surface. */
+void updateSurface(void)
+{
     /* [Stage 1 Calculate sphere positions stage] */
     /* 1. Calculate sphere positions stage.
      *
@@ -1591,6 +2677,12 @@ void renderFrame(void)
     /* [Stage 1 Calculate sphere positions stage] */
 
 
+    if (use_compute_shaders)
+    {
+        renderMarchingCubesCompute();
+        return;
+    }
+
     /* [Stage 2 Scalar field generation stage] */
     /* 2. Scalar field generation stage.
      *
@@ -1644,7 +2736,6 @@ void renderFrame(void)
                             ));
     /* [Stage 2 Scalar field generation stage move data to texture] */
 
-
     /* 3. Marching cube algorithm cell splitting stage.
      *
      * At this stage we analyze isosurface in each cell of space and
@@ -1695,29 +2786,79 @@ void renderFrame(void)
                             ));
 
 
-    /* 4. Marching Cubes algorithm triangle generation stage.
-     *
-     * At this stage, we render exactly (3 vertices * 5 triangles per cell *
-     * amount of cells the scalar field is split to) triangle vertices.
-     * Then render triangularized geometry.
+    renderSurface();
+}
+
+/** Draws one frame. */
+void renderFrame(void)
+{
+    if (!programs_ready)
+    {
+        /* Keep showing empty frames until the shader compiler is done, instead of blocking. */
+        if (!programCompileQueue.isComplete())
+        {
+            GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+            return;
+        }
+
+        programCompileQueue.finish();
+        setupPrograms();
+        programs_ready = true;
+
+        /* Start counting time. */
+        timer.reset();
+    }
+
+    /* Update time. */
+    model_time = timer.getTime();
+
+    /*
+     * Rendering section
      */
-    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    /* Clear the buffers that we are going to render to in a moment. */
+    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
-    /* Activate triangle generating and rendering program. */
-    GL_CHECK(glUseProgram(marching_cubes_triangles_program_id));
+    /* While the spheres have barely moved, draw the surface of the previous frames again rather than evaluating the field. */
+    if (scalar_field_valid && calc_sphere_motion(scalar_field_time, model_time) < sphere_motion_threshold / cells_per_axis)
+    {
+        renderSurface();
+        return;
+    }
 
-    /* Specify input arguments to vertex shader. */
-    GL_CHECK(glUniform1f(marching_cubes_triangles_uniform_time_id, model_time));
+    /* Only the frames updating the surface are timed, which is what the level of details is chosen for. */
+    grid_resolution->beginFrame();
 
-    /* [Stage 4 Run triangle generating and rendering program] */
-    /* Run triangle generating and rendering program. */
-    GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, cells_in_3d_space * triangles_per_cell * vertices_per_triangle));
-    /* [Stage 4 Run triangle generating and rendering program] */
+    GLuint level = choose_tesselation_level();
+    if (level != tesselation_level)
+    {
+        apply_tesselation_level(level);
+    }
+
+    scalar_field_time  = model_time;
+    scalar_field_valid = true;
+
+    updateSurface();
+
+    grid_resolution->endFrame();
 }
 
 /** Deinitialises OpenGL ES environment. */
 void cleanup()
 {
+    /* Programs may still be building, wait for them before they are deleted. */
+    programCompileQueue.finish();
+
+    delete grid_resolution;
+    grid_resolution = NULL;
+
+    GL_CHECK(glDeleteBuffers           (1, &marching_cubes_bricks_buffer_id                  ));
+    GL_CHECK(glDeleteBuffers           (1, &marching_cubes_vertices_buffer_id                ));
+    GL_CHECK(glDeleteBuffers           (1, &marching_cubes_active_cells_buffer_id            ));
+    GL_CHECK(glDeleteBuffers           (1, &marching_cubes_indirect_buffer_id                ));
+    GL_CHECK(glDeleteProgram           (    marching_cubes_indirect_program_id               ));
+    GL_CHECK(glDeleteProgram           (    marching_cubes_triangles_comp_program_id         ));
+    GL_CHECK(glDeleteProgram           (    marching_cubes_cells_comp_program_id             ));
+    GL_CHECK(glDeleteProgram           (    scalar_field_comp_program_id                     ));
     GL_CHECK(glDeleteVertexArrays      (1, &marching_cubes_triangles_vao_id                  ));
     GL_CHECK(glDeleteShader            (    marching_cubes_triangles_frag_shader_id          ));
     GL_CHECK(glDeleteShader            (    marching_cubes_triangles_vert_shader_id          ));
@@ -1,61 +0,0 @@
-/* Copyright (c) 2014-2017, ARM Limited and Contributors
- *
- * SPDX-License-Identifier: MIT
- *
- * Permission is hereby granted, free of charge,
- * to any person obtaining a copy of this software and associated documentation files (the "Software"),
- * to deal in the Software without restriction, including without limitation the rights to
- * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
- * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
- * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
- * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
- * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
- */
-
-#ifndef SHADER_H
-#define SHADER_H
-
-#include <GLES3/gl3.h>
-#include <cstdio>
-#include <cstdlib>
-#include <android/log.h>
-
-#define GL_CHECK(x) \
-    x; \
-    { \
-        GLenum glError = glGetError(); \
-        if(glError != GL_NO_ERROR) { \
-            LOGE("glGetError() = %i (0x%.8x) at %s:%i\n", glError, glError, __FILE__, __LINE__); \
-            exit(1); \
-        } \
-    }
-
-namespace MaliSDK
-{
-    /**
-     * \brief Functions for working with OpenGL ES shaders.
-     */
-    class Shader
-    {
-    public:
-        /**
-         * \brief Create shader, load in source, compile, and dump debug if necessary.
-         *
-         * Creates a shader using with the required shaderType using glCreateShader(shaderType) and then compiles it using glCompileShader.
-         * The output from the compilation is checked for success and a log of the compilation errors is printed in the case of failure.
-         *
-         * \param[out] shaderPtr      The shader ID of the newly compiled shader. Cannot be NULL.
-         * \param[in] shaderSourcePtr Contains OpenGL ES SL source code. Cannot be NULL.
-         * \param[in] shaderType      Passed to glCreateShader to define the type of shader being processed.
-         *                            Must be GL_VERTEX_SHADER or GL_FRAGMENT_SHADER.
-         */
-        static void processShader(GLuint* shaderPtr, const char* shaderSourcePtr, GLint shaderType);
-    };
-}
-#endif /* SHADER_H */
@@ -0,0 +1,168 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \brief Micro-benchmarks of the costs which bound most frames.
+ *
+ * Measures draw calls, changes of program, texture, vertex array and uniform buffer range,
+ * vertex throughput, fill rate per render target format with and without blending,
+ * and sampling rate per texture format. One case runs at a time, one frame per step(),
+ * with results shown on screen, logged, and written to microbenchmarks.json once all cases are done.
+ */
+
+#include <jni.h>
+
+#include "AndroidPlatform.h"
+#include "DeviceCapabilities.h"
+#include "MicroBenchmarks.h"
+#include "Text.h"
+
+#include <cstdio>
+#include <string>
+
+using std::string;
+using namespace MaliSDK;
+
+/* Asset directories and filenames. */
+string resourceDirectory = "/data/data/com.arm.malideveloper.openglessdk.microbenchmarks/";
+string reportFilename = "microbenchmarks.json";
+
+MicroBenchmarkSuite *suite = NULL;
+bool reportWritten = false;
+
+int windowWidth = -1;
+int windowHeight = -1;
+
+/* A text object to draw the results on the screen. */
+Text *text = NULL;
+
+/* The results go with the capabilities of the device, in the report format samples read at startup. */
+static void writeReport(void)
+{
+    DeviceCapabilities capabilities;
+    string path = resourceDirectory + reportFilename;
+
+    capabilities.probe();
+    capabilities.addBenchmarkResults(*suite);
+
+    if (capabilities.save(path.c_str()))
+    {
+        LOGI("Micro-benchmark results written to %s.\n", path.c_str());
+    }
+}
+
+static void drawResults(void)
+{
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GL_CHECK(glViewport(0, 0, windowWidth, windowHeight));
+    GL_CHECK(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
+
+    text->clear();
+
+    int y = windowHeight - 40;
+    text->addString(0, y, "Micro-benchmarks", 255, 255, 0, 255);
+
+    for (size_t i = 0; i < suite->getCount(); i++)
+    {
+        const MicroBenchmark *benchmark = suite->getBenchmark(i);
+        const MicroBenchmarkSuite::Result &result = suite->getResult(i);
+        char line[128];
+
+        y -= 20;
+        if (i == suite->getCurrent())
+        {
+            snprintf(line, sizeof(line), "%s: running", benchmark->getName());
+        }
+        else if (!result.finished)
+        {
+            snprintf(line, sizeof(line), "%s: waiting", benchmark->getName());
+        }
+        else if (!result.supported)
+        {
+            snprintf(line, sizeof(line), "%s: not supported", benchmark->getName());
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "%s: %.1f M%s/s", benchmark->getName(), result.getRate() * 1.0e-6, benchmark->getUnit());
+        }
+
+        text->addString(0, y, line, 255, 255, 255, 255);
+    }
+
+    text->draw();
+}
+
+static void setupGraphics(int width, int height)
+{
+    windowWidth = width;
+    windowHeight = height;
+
+    /* Start the suite over, a new context has none of the objects of the previous one. */
+    delete suite;
+    suite = new MicroBenchmarkSuite();
+    suite->addDefaultBenchmarks();
+    reportWritten = false;
+
+    delete text;
+    text = new Text(resourceDirectory.c_str(), windowWidth, windowHeight);
+
+    LOGI("Running %d micro-benchmarks on %s.\n", (int)suite->getCount(), (const char *)glGetString(GL_RENDERER));
+}
+
+static void renderFrame(void)
+{
+    if (!suite->isFinished())
+    {
+        suite->step();
+    }
+    else if (!reportWritten)
+    {
+        writeReport();
+        reportWritten = true;
+    }
+
+    drawResults();
+}
+
+extern "C"
+{
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_microbenchmarks_MicroBenchmarks_init
+    (JNIEnv *env, jclass jcls, jint width, jint height)
+    {
+        setupGraphics(width, height);
+    }
+
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_microbenchmarks_MicroBenchmarks_step
+    (JNIEnv *env, jclass jcls)
+    {
+        renderFrame();
+    }
+
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_microbenchmarks_MicroBenchmarks_uninit
+    (JNIEnv *, jclass)
+    {
+        delete suite;
+        suite = NULL;
+
+        delete text;
+        text = NULL;
+    }
+}
@@ -43,12 +43,18 @@
  * processing as well as being able to use a custom projection.
  *
  * The demo initially uses the highest supported texture format with the maximum number of samples.
+ *
+ * In the automatic mode, the frame time is measured with each number of samples in turn, starting from
+ * no multisampling, and the highest number of samples which still fits in the frame budget is used.
+ * The frame time keeps being monitored afterwards. When it goes over budget, for example because
+ * thermal throttling lowered the GPU clocks, or periodically when there is headroom, the measurements start over.
+ *
  * The user is able to interact with the demo and change the settings as follows:
  *    Tap on screen: toggle rotation animation
  *    Long-press on screen: cycle through different colors
  *    Pinch-to-zoom gesture: change distance of model
  *    Drag on screen: rotate model
- *    Volume up: switch multisampling level
+ *    Volume up: switch multisampling level, the level after the highest one picks the level automatically
  *    Volume down: switch texture resolution
  *    Long-press on volume up: switch texture format
  *    Long press on volume down: toggle texture filtering on/off
@@ -87,6 +93,8 @@
 #include "AndroidPlatform.h"
 #include "Shader.h"
 #include "Matrix.h"
+#include "RenderPass.h"
+#include "Timer.h"
 
 /* OpenGL ES extension functions. */
 PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEIMGPROC glFramebufferTexture2DMultisampleEXT = NULL;
@@ -136,6 +144,7 @@ const Color backgrounds[] =
 /* Texture format enums and strings. */
 const GLenum textureFormats[] = { GL_RGBA4, GL_RGBA8, GL_RGBA16F, GL_RGBA32F };
 const GLchar* const textureFormatStrings[] = { "GL_RGBA4", "GL_RGBA8", "GL_RGBA16F", "GL_RGBA32F" };
+const int textureFormatBytes[] = { 2, 4, 8, 16 };
 
 /* Texture format supported by device. */
 GLboolean textureFormatSupported[] = { false, false, false, false };
@@ -155,6 +164,7 @@ GLboolean canFilterFloat;
 
 GLuint currentColor = 0;
 GLint currentSamples = 0;
+GLboolean autoSamplesEnabled = false;
 GLuint currentTextureFormat = 0;
 GLuint currentTextureSize = 5;
 GLboolean linearFilteringEnabled = true;
@@ -193,6 +203,27 @@ GLfloat maxY = 0.0f;
 GLfloat maxZ = 0.0f;
 GLfloat maxXYZ = 0.0f;
 
+/* Automatic sample count selection. */
+/* Frame time the selected number of samples has to fit in, 60 FPS with some slack for vsync jitter. */
+const float autoSamplesFrameBudget = 1.0f / 55.0f;
+/* Frames skipped after the FBO is recreated, before the frame time is representative. */
+const int autoSamplesWarmUpFrames = 10;
+/* Frames averaged for each measurement. */
+const int autoSamplesMeasuredFrames = 60;
+/* Seconds between measurements while under budget but not using the maximum number of samples. */
+const float autoSamplesRetryPeriod = 30.0f;
+
+/* Sample counts the automatic mode measures, filled in by startAutoSamples(). */
+GLint autoSamplesCandidates[16];
+int numberOfAutoSamplesCandidates = 0;
+int currentAutoSamplesCandidate = 0;
+int selectedAutoSamplesCandidate = 0;
+bool autoSamplesMeasuring = false;
+int autoSamplesFrameCount = 0;
+float autoSamplesFrameTime = 0.0f;
+Timer frameTimer;
+Timer autoSamplesRetryTimer;
+
 GLfloat rotationDegree1 = 0.0f;
 GLfloat rotationDegree2 = 0.0f;
 GLuint counter = 0;
@@ -303,7 +334,7 @@ void setupText()
 	texFormatStringStream << "Using texture format: " << textureFormatStrings[currentTextureFormat]
 													  << " (" << textureSizes[currentTextureSize] << "x"
 													  << textureSizes[currentTextureSize] << ", "
-													  << currentSamples << " samples, "
+													  << currentSamples << (autoSamplesEnabled ? " samples (auto), " : " samples, ")
 													  << (linearFilteringEnabled ? "GL_LINEAR" : "GL_NEAREST") << " filtering)";
 	descriptionStringStream << "Left: No anti-aliasing. Right: Multisampled anti-aliasing (" << currentSamples << " samples)";
 
@@ -312,13 +343,120 @@ void setupText()
 	text->addString(0, windowHeight - text->textureCharacterHeight, maxSamplesStringStream.str().c_str(), 255, 255, 255, 255);
 	text->addString(0, windowHeight - text->textureCharacterHeight * 2, texFormatStringStream.str().c_str(), 255, 255, 255, 255);
 	text->addString(0, windowHeight - text->textureCharacterHeight * 3, "Tap to screen to toggle animation. Long-press to cycle colors. Pinch-to-zoom, drag to rotate.", 0, 255, 255, 255);
-	text->addString(0, windowHeight - text->textureCharacterHeight * 4, "Volume up: switch multisampling level. Volume down: switch texture resolution.", 0, 255, 255, 255);
+	text->addString(0, windowHeight - text->textureCharacterHeight * 4, "Volume up: switch multisampling level (then auto). Volume down: switch texture resolution.", 0, 255, 255, 255);
 	text->addString(0, windowHeight - text->textureCharacterHeight * 5, "Long press vol up: switch texture format. Long press vol down: toggle texture filtering", 0, 255, 255, 255);
 
 	text->addString(0, text->textureCharacterHeight, descriptionStringStream.str().c_str(), 255, 255, 0, 255);
 	text->addString(0, 0, "Multisampled framebuffer objects.", 0, 255, 255, 255);
 }
 
+/* Recreate the multisampled FBO with a new number of samples. */
+void setMultisampledFBOSamples(GLint samples)
+{
+	currentSamples = samples;
+	setupFBO(&frameBufferMSAA, &texColorBufferMSAA, &depthBufferMSAA, textureSizes[currentTextureSize], textureFormats[currentTextureFormat], currentSamples);
+	setupText();
+
+	/* The frame which recreated the FBO is not representative. */
+	autoSamplesFrameCount = 0;
+	autoSamplesFrameTime = 0.0f;
+}
+
+/* Start measuring every sample count the current texture format supports, from the lowest. */
+void startAutoSamples(void)
+{
+	GLint maxFormatSamples = textureFormatSamples[currentTextureFormat];
+
+	numberOfAutoSamplesCandidates = 0;
+	autoSamplesCandidates[numberOfAutoSamplesCandidates++] = 0;
+	for (GLint samples = 2; samples < maxFormatSamples; samples *= 2)
+	{
+		autoSamplesCandidates[numberOfAutoSamplesCandidates++] = samples;
+	}
+	if (maxFormatSamples > 0)
+	{
+		autoSamplesCandidates[numberOfAutoSamplesCandidates++] = maxFormatSamples;
+	}
+
+	currentAutoSamplesCandidate = 0;
+	selectedAutoSamplesCandidate = 0;
+	autoSamplesMeasuring = true;
+
+	setMultisampledFBOSamples(autoSamplesCandidates[currentAutoSamplesCandidate]);
+}
+
+/*
+ * Called once per frame in the automatic mode with the time the previous frame took.
+ * Frame time is measured between calls rather than with GPU timers, so it includes any vsync wait,
+ * which is what matters for fitting in the budget.
+ */
+void updateAutoSamples(float frameTime)
+{
+	autoSamplesFrameCount++;
+	if (autoSamplesFrameCount <= autoSamplesWarmUpFrames)
+	{
+		return;
+	}
+
+	autoSamplesFrameTime += frameTime;
+	if (autoSamplesFrameCount < autoSamplesWarmUpFrames + autoSamplesMeasuredFrames)
+	{
+		return;
+	}
+
+	float averageFrameTime = autoSamplesFrameTime / autoSamplesMeasuredFrames;
+	bool fitsBudget = averageFrameTime <= autoSamplesFrameBudget;
+
+	autoSamplesFrameCount = autoSamplesWarmUpFrames;
+	autoSamplesFrameTime = 0.0f;
+
+	if (autoSamplesMeasuring)
+	{
+		LOGD("%d samples: %.2f ms per frame.", autoSamplesCandidates[currentAutoSamplesCandidate], averageFrameTime * 1000.0f);
+
+		if (fitsBudget)
+		{
+			selectedAutoSamplesCandidate = currentAutoSamplesCandidate;
+		}
+
+		/* More samples never cost less, so stop at the first count over budget. */
+		if (fitsBudget && currentAutoSamplesCandidate + 1 < numberOfAutoSamplesCandidates)
+		{
+			currentAutoSamplesCandidate++;
+			setMultisampledFBOSamples(autoSamplesCandidates[currentAutoSamplesCandidate]);
+			return;
+		}
+
+		autoSamplesMeasuring = false;
+		autoSamplesRetryTimer.reset();
+		currentAutoSamplesCandidate = selectedAutoSamplesCandidate;
+
+		LOGI("Automatic multisampling selected %d samples.", autoSamplesCandidates[selectedAutoSamplesCandidate]);
+
+		if (currentSamples != autoSamplesCandidates[selectedAutoSamplesCandidate])
+		{
+			setMultisampledFBOSamples(autoSamplesCandidates[selectedAutoSamplesCandidate]);
+		}
+		return;
+	}
+
+	/*
+	 * Going over budget means the clocks or the scene changed, so measure again.
+	 * Headroom is rechecked from time to time too, as clocks go back up once the device cools down.
+	 */
+	bool canUseMoreSamples = selectedAutoSamplesCandidate + 1 < numberOfAutoSamplesCandidates;
+
+	if (!fitsBudget)
+	{
+		LOGI("Frame time went over budget (%.2f ms) with %d samples, measuring again.", averageFrameTime * 1000.0f, currentSamples);
+		startAutoSamples();
+	}
+	else if (canUseMoreSamples && autoSamplesRetryTimer.getTime() > autoSamplesRetryPeriod)
+	{
+		startAutoSamples();
+	}
+}
+
 bool setupGraphics(int width, int height)
 {
 	/* Initialize OpenGL ES. */
@@ -493,14 +631,6 @@ void drawTeapot()
 	Matrix mvpMatrix;
 	Matrix normalMatrix;
 
-	/* Set clear screen color and clear the framebuffer. */
-	Color bg = backgrounds[currentColor];
-	GL_CHECK(glClearColor(bg.r, bg.g, bg.b, 1.0f));
-	GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-
-	/* Set viewport to size of FBO texture. */
-	GL_CHECK(glViewport(0, 0, textureSizes[currentTextureSize], textureSizes[currentTextureSize]));
-
 	/*
 	 *  Use max dimensions of the model to center it.
 	 *  We find the centre of the teapot by averaging the min and max Y coordinates,
@@ -563,6 +693,13 @@ void drawTeapot()
 /* Code to draw one frame. */
 void renderFrame(void)
 {
+	float frameTime = frameTimer.getInterval();
+
+	if (autoSamplesEnabled)
+	{
+		updateAutoSamples(frameTime);
+	}
+
 	/**************************************************************************/
 	/* DRAW TEAPOT                                                            */
 	/**************************************************************************/
@@ -570,13 +707,31 @@ void renderFrame(void)
 	/* Switch to the teapot shader program. */
 	GL_CHECK(glUseProgram(teapotProgramID));
 
+	/*
+	 * Only the (resolved) colour buffers are sampled afterwards. Depth is never written out,
+	 * and the multisampled samples themselves never leave the tile buffer.
+	 */
+	GLsizei textureSize = textureSizes[currentTextureSize];
+	RenderPass noAAPass(frameBufferNoAA, textureSize, textureSize);
+	noAAPass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, textureFormatBytes[currentTextureFormat]);
+	noAAPass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_DONT_CARE, 2);
+	RenderPass msaaPass(frameBufferMSAA, textureSize, textureSize);
+	msaaPass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, textureFormatBytes[currentTextureFormat]);
+	msaaPass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_DONT_CARE, 2);
+
+	/* Set clear screen color for both FBOs. */
+	Color bg = backgrounds[currentColor];
+	GL_CHECK(glClearColor(bg.r, bg.g, bg.b, 1.0f));
+
 	/* Switch to non-antialiased FBO */
-	GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, frameBufferNoAA));
+	noAAPass.begin();
 	drawTeapot();
+	noAAPass.end();
 
 	/* Switch to multisampled FBO */
-	GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, frameBufferMSAA));
+	msaaPass.begin();
 	drawTeapot();
+	msaaPass.end();
 
 	/**************************************************************************/
 	/* DRAW QUADS                                                             */
@@ -585,10 +740,6 @@ void renderFrame(void)
 	/* Switch to the quad shader program. */
 	GL_CHECK(glUseProgram(quadProgramID));
 
-	/* Switch back to default framebuffer. */
-	GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
-	GL_CHECK(glViewport (0, 0, windowWidth, windowHeight));
-
 	/* Enable attributes for position and texture coordinates. */
 	GL_CHECK(glEnableVertexAttribArray(iLocQuadPosition));
 	GL_CHECK(glEnableVertexAttribArray(iLocQuadTexCoord));
@@ -609,9 +760,13 @@ void renderFrame(void)
 
 	GL_CHECK(glUniformMatrix4fv(iLocQuadMVPMatrix, 1, GL_FALSE, mvpMatrix.getAsArray()));
 
-	/* Clear the screen and draw the elements. */
+	/* Switch back to default framebuffer, clear the screen and draw the elements. The window depth buffer is not needed afterwards. */
+	RenderPass windowPass(0, windowWidth, windowHeight);
+	windowPass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 4);
+	windowPass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_DONT_CARE, 4);
+
 	GL_CHECK(glClearColor(0.2f, 0.2f, 0.2f, 1.0f));
-	GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+	windowPass.begin();
 
 	/* Enable texture. */
 	GL_CHECK(glActiveTexture(GL_TEXTURE0));
@@ -628,6 +783,8 @@ void renderFrame(void)
 	GL_CHECK(glEnable(GL_BLEND));
     GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 	text->draw();
+
+	windowPass.end();
 	GL_CHECK(glDisable(GL_BLEND));
 }
 
@@ -669,17 +826,28 @@ extern "C"
 	JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_multisampledfbo_MultisampledFBO_switchSamples
 	(JNIEnv *env, jclass jcls)
 	{
-		/* Switch to next level of multisampling. */
-		if (currentSamples == textureFormatSamples[currentTextureFormat])
+		/* Switch to next level of multisampling, the automatic mode comes after the highest level. */
+		if (autoSamplesEnabled)
+		{
+			autoSamplesEnabled = false;
 			currentSamples = 0;
+		}
+		else if (currentSamples == textureFormatSamples[currentTextureFormat])
+			autoSamplesEnabled = true;
 		else if (currentSamples == 0)
 			currentSamples = 2;
 		else
 			currentSamples *= 2;
 
 		setupFBO(&frameBufferNoAA, &texColorBufferNoAA, &depthBufferNoAA, textureSizes[currentTextureSize], textureFormats[currentTextureFormat], 0);
-		setupFBO(&frameBufferMSAA, &texColorBufferMSAA, &depthBufferMSAA, textureSizes[currentTextureSize], textureFormats[currentTextureFormat], currentSamples);
-		setupText();
+		if (autoSamplesEnabled)
+		{
+			startAutoSamples();
+		}
+		else
+		{
+			setMultisampledFBOSamples(currentSamples);
+		}
 	}
 
 	JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_multisampledfbo_MultisampledFBO_switchTextureFormat
@@ -702,6 +870,12 @@ extern "C"
 		setupFBO(&frameBufferNoAA, &texColorBufferNoAA, &depthBufferNoAA, textureSizes[currentTextureSize], textureFormats[currentTextureFormat], 0);
 		setupFBO(&frameBufferMSAA, &texColorBufferMSAA, &depthBufferMSAA, textureSizes[currentTextureSize], textureFormats[currentTextureFormat], currentSamples);
 		setupText();
+
+		/* The cost of each sample count depends on the format, so measure them again. */
+		if (autoSamplesEnabled)
+		{
+			startAutoSamples();
+		}
 	}
 
 	JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_multisampledfbo_MultisampledFBO_switchTextureSize
@@ -714,6 +888,12 @@ extern "C"
 		setupFBO(&frameBufferNoAA, &texColorBufferNoAA, &depthBufferNoAA, textureSizes[currentTextureSize], textureFormats[currentTextureFormat], 0);
 		setupFBO(&frameBufferMSAA, &texColorBufferMSAA, &depthBufferMSAA, textureSizes[currentTextureSize], textureFormats[currentTextureFormat], currentSamples);
 		setupText();
+
+		/* And on the resolution. */
+		if (autoSamplesEnabled)
+		{
+			startAutoSamples();
+		}
 	}
 
 	JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_multisampledfbo_MultisampledFBO_toggleTextureFiltering
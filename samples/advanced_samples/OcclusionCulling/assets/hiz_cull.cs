@@ -37,6 +37,7 @@
 precision highp float;
 precision highp int;
 precision highp sampler2DShadow;
+precision highp sampler2D;
 
 layout(local_size_x = 64) in;
 
@@ -50,8 +51,33 @@ layout(binding = 0, std140) uniform UBO
 };
 
 layout(location = 0) uniform uint uNumBoundingBoxes;
+#ifdef HIZ_FLOAT
+// The Hi-Z map was built with compute and is a float texture, so there is no shadow compare.
+// Fetch the 2x2 texels a PCF lookup would have compared against, and test against the farthest.
+layout(binding = 0) uniform sampler2D uDepth;
+
+bool hiz_visible(vec2 coord, float depth, float lod)
+{
+    int max_level = int(log2(float(textureSize(uDepth, 0).x)));
+    int level = clamp(int(lod), 0, max_level);
+    ivec2 size = textureSize(uDepth, level);
+
+    ivec2 c0 = clamp(ivec2(floor(coord * vec2(size) - 0.5)), ivec2(0), size - 1);
+    ivec2 c1 = min(c0 + 1, size - 1);
+    float farthest = max(
+            max(texelFetch(uDepth, c0, level).x, texelFetch(uDepth, ivec2(c1.x, c0.y), level).x),
+            max(texelFetch(uDepth, ivec2(c0.x, c1.y), level).x, texelFetch(uDepth, c1, level).x));
+    return depth <= farthest;
+}
+#else
 layout(binding = 0) uniform sampler2DShadow uDepth;
 
+bool hiz_visible(vec2 coord, float depth, float lod)
+{
+    return textureLod(uDepth, vec3(coord, depth), lod) > 0.0;
+}
+#endif
+
 // Atomic counters for each LOD level.
 // The offset for instanceCount is already applied via glBindBufferRange().
 layout(binding = 0, offset = 0) uniform atomic_uint instanceCountLOD0;
@@ -92,6 +118,19 @@ layout(std430, binding = 4) buffer PerInstanceOutputLOD3
     writeonly vec4 data[];
 } output_instance_lod3;
 
+#ifdef TWO_PHASE
+// Two-phase culling. Phase 0 runs before the depth map for this frame is built,
+// and emits instances visible in the previous frame without testing occlusion.
+// Phase 1 tests every instance against the depth map, records the result,
+// and emits the visible instances phase 0 did not emit already.
+layout(location = 1) uniform uint uPhase;
+
+layout(std430, binding = 5) buffer Visibility
+{
+    uint data[];
+} visibility;
+#endif
+
 void append_instance(float minz)
 {
     // Test non-linear depth value and place the instance in the appropriate instance buffer.
@@ -129,6 +168,37 @@ bool frustum_test(vec3 center, float radius)
     return true;
 }
 
+bool occlusion_test_enabled()
+{
+#ifdef TWO_PHASE
+    return uPhase != 0u;
+#else
+    return true;
+#endif
+}
+
+void report_visibility(bool visible, float minz)
+{
+#ifdef TWO_PHASE
+    uint ident = gl_GlobalInvocationID.x;
+    bool was_visible = visibility.data[ident] != 0u;
+    if (uPhase == 0u)
+    {
+        if (visible && was_visible)
+            append_instance(minz);
+    }
+    else
+    {
+        visibility.data[ident] = visible ? 1u : 0u;
+        if (visible && !was_visible)
+            append_instance(minz);
+    }
+#else
+    if (visible)
+        append_instance(minz);
+#endif
+}
+
 void main()
 {
     uint ident = gl_GlobalInvocationID.x;
@@ -141,7 +211,10 @@ void main()
 
     // Test frustum, if outside, return early.
     if (!frustum_test(center, radius))
+    {
+        report_visibility(false, 0.0);
         return;
+    }
 
     // Apply view transform. Camera is pointing down the -Z axis.
     vec3 view_center = (uView * vec4(center, 1.0)).xyz;
@@ -150,7 +223,7 @@ void main()
     // Sphere clips against near plane, just assume visibility.
     if (nearest_z >= -zNearFar.x)
     {
-        append_instance(0.0);
+        report_visibility(true, 0.0);
         return;
     }
 
@@ -202,7 +275,6 @@ void main()
     vec2 mid_pix = 0.5 * (max_xy + min_xy);
 
     // Test visibility.
-    if (textureLod(uDepth, vec3(mid_pix, nearest_z), lod) > 0.0)
-        append_instance(nearest_z);
+    report_visibility(!occlusion_test_enabled() || hiz_visible(mid_pix, nearest_z, lod), nearest_z);
 }
 
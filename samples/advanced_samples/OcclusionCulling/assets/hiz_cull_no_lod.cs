@@ -26,6 +26,7 @@
 precision highp float;
 precision highp int;
 precision highp sampler2DShadow;
+precision highp sampler2D;
 
 layout(local_size_x = 64) in;
 
@@ -39,8 +40,33 @@ layout(binding = 0, std140) uniform UBO
 };
 
 layout(location = 0) uniform uint uNumBoundingBoxes;
+#ifdef HIZ_FLOAT
+// The Hi-Z map was built with compute and is a float texture, so there is no shadow compare.
+// Fetch the 2x2 texels a PCF lookup would have compared against, and test against the farthest.
+layout(binding = 0) uniform sampler2D uDepth;
+
+bool hiz_visible(vec2 coord, float depth, float lod)
+{
+    int max_level = int(log2(float(textureSize(uDepth, 0).x)));
+    int level = clamp(int(lod), 0, max_level);
+    ivec2 size = textureSize(uDepth, level);
+
+    ivec2 c0 = clamp(ivec2(floor(coord * vec2(size) - 0.5)), ivec2(0), size - 1);
+    ivec2 c1 = min(c0 + 1, size - 1);
+    float farthest = max(
+            max(texelFetch(uDepth, c0, level).x, texelFetch(uDepth, ivec2(c1.x, c0.y), level).x),
+            max(texelFetch(uDepth, ivec2(c0.x, c1.y), level).x, texelFetch(uDepth, c1, level).x));
+    return depth <= farthest;
+}
+#else
 layout(binding = 0) uniform sampler2DShadow uDepth;
 
+bool hiz_visible(vec2 coord, float depth, float lod)
+{
+    return textureLod(uDepth, vec3(coord, depth), lod) > 0.0;
+}
+#endif
+
 layout(binding = 0, offset = 0) uniform atomic_uint instanceCountLOD0;
 
 struct SphereInstance
@@ -146,7 +172,7 @@ void main()
     float lod = ceil(log2(max_diff));
     vec2 mid_pix = 0.5 * (max_xy + min_xy);
 
-    if (textureLod(uDepth, vec3(mid_pix, nearest_z), lod) > 0.0)
+    if (hiz_visible(mid_pix, nearest_z, lod))
         append_instance();
 }
 
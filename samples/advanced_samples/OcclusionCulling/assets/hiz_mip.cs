@@ -0,0 +1,141 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Builds up to four miplevels of the Hi-Z depth map in one dispatch.
+//
+// Every invocation reads a 2x2 quad of the source level and writes the farthest depth to the first destination level.
+// The work group then keeps reducing its 16x16 tile in shared memory, writing one more miplevel per step,
+// so a single 16x16 work group covers a 32x32 region of the source level.
+//
+// When uCopySource is set, the source level is also copied to image unit 0 and reduced levels start at image unit 1.
+// This is used for the first dispatch, which reads the depth texture the occluders were rasterized to.
+
+precision highp float;
+precision highp image2D;
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0) uniform sampler2D uSource;
+layout(r32f, binding = 0) uniform writeonly image2D iLevel0;
+layout(r32f, binding = 1) uniform writeonly image2D iLevel1;
+layout(r32f, binding = 2) uniform writeonly image2D iLevel2;
+layout(r32f, binding = 3) uniform writeonly image2D iLevel3;
+
+layout(location = 0) uniform int uSourceLevel;
+layout(location = 1) uniform int uNumLevels; // Number of reduced levels to write.
+layout(location = 2) uniform bool uCopySource;
+
+shared float depths[16][16];
+
+float fetch(ivec2 coord, ivec2 size)
+{
+    // Replicating the edge is conservative for a max reduction.
+    return texelFetch(uSource, min(coord, size - 1), uSourceLevel).x;
+}
+
+// Image uniforms cannot be indexed dynamically.
+void store(int index, ivec2 coord, float depth)
+{
+    if (index == 0)
+        imageStore(iLevel0, coord, vec4(depth));
+    else if (index == 1)
+        imageStore(iLevel1, coord, vec4(depth));
+    else if (index == 2)
+        imageStore(iLevel2, coord, vec4(depth));
+    else
+        imageStore(iLevel3, coord, vec4(depth));
+}
+
+// Reduces the top left (16 >> step)^2 texels of the tile, one step per call.
+// barrier() may only be used directly in main() outside control flow,
+// so every step runs unconditionally, is split around the barriers, and only the stores are guarded.
+float reduce_load(int step)
+{
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    if (any(greaterThanEqual(local, ivec2(16 >> step))))
+        return 0.0;
+
+    ivec2 src = 2 * local;
+    return max(max(depths[src.y][src.x], depths[src.y][src.x + 1]),
+            max(depths[src.y + 1][src.x], depths[src.y + 1][src.x + 1]));
+}
+
+void reduce_store(int step, int first_image, ivec2 size, float depth)
+{
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    int n = 16 >> step;
+    if (any(greaterThanEqual(local, ivec2(n))))
+        return;
+
+    depths[local.y][local.x] = depth;
+
+    ivec2 coord = ivec2(gl_WorkGroupID.xy) * n + local;
+    if (step < uNumLevels && all(lessThan(coord, max(size >> (step + 1), ivec2(1)))))
+        store(first_image + step, coord, depth);
+}
+
+void main()
+{
+    ivec2 size = textureSize(uSource, uSourceLevel);
+    ivec2 dst = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 src = 2 * dst;
+
+    float d00 = fetch(src, size);
+    float d10 = fetch(src + ivec2(1, 0), size);
+    float d01 = fetch(src + ivec2(0, 1), size);
+    float d11 = fetch(src + ivec2(1, 1), size);
+
+    if (uCopySource && all(lessThan(src, size)))
+    {
+        imageStore(iLevel0, src, vec4(d00));
+        imageStore(iLevel0, src + ivec2(1, 0), vec4(d10));
+        imageStore(iLevel0, src + ivec2(0, 1), vec4(d01));
+        imageStore(iLevel0, src + ivec2(1, 1), vec4(d11));
+    }
+
+    int first_image = uCopySource ? 1 : 0;
+    float depth = max(max(d00, d10), max(d01, d11));
+    if (all(lessThan(dst, max(size >> 1, ivec2(1)))))
+        store(first_image, dst, depth);
+
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    depths[local.y][local.x] = depth;
+    memoryBarrierShared();
+    barrier();
+
+    depth = reduce_load(1);
+    barrier();
+    reduce_store(1, first_image, size, depth);
+    memoryBarrierShared();
+    barrier();
+
+    depth = reduce_load(2);
+    barrier();
+    reduce_store(2, first_image, size, depth);
+    memoryBarrierShared();
+    barrier();
+
+    // Last step, nothing reads shared memory after this.
+    depth = reduce_load(3);
+    barrier();
+    reduce_store(3, first_image, size, depth);
+}
@@ -0,0 +1,71 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Reprojects the scene depth buffer of the previous frame into the current view for Hi-Z culling.
+//
+// Every invocation reads a 2x2 quad of the previous depth buffer, takes the farthest depth so the result stays conservative,
+// and scatters it to the Hi-Z texel the quad lands on in the current view.
+// Several quads can land on the same texel, so keep the farthest of them with an atomic max.
+//
+// This assumes the scene is static. Objects which moved since the previous frame occlude where they were, not where they are.
+
+precision highp float;
+precision highp int;
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform sampler2D uPreviousDepth;
+layout(r32ui, binding = 0) uniform highp uimage2D iReprojected;
+
+// Transforms from the previous frame's clip space to the current one.
+layout(location = 0) uniform mat4 uReprojection;
+layout(location = 1) uniform vec2 uInvPreviousSize;
+layout(location = 2) uniform uvec2 uNumQuads;
+
+void main()
+{
+    if (any(greaterThanEqual(gl_GlobalInvocationID.xy, uNumQuads)))
+        return;
+
+    // Sample between the four texels of the quad.
+    vec2 uv = (2.0 * vec2(gl_GlobalInvocationID.xy) + 1.0) * uInvPreviousSize;
+    vec4 depths = textureGather(uPreviousDepth, uv, 0);
+    float depth = max(max(depths.x, depths.y), max(depths.z, depths.w));
+
+    // Nothing was rendered here, which will not occlude anything anyways.
+    if (depth >= 1.0)
+        return;
+
+    vec4 clip = uReprojection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+
+    // Behind the camera now.
+    if (clip.w <= 0.0)
+        return;
+
+    vec3 ndc = clip.xyz / clip.w;
+    if (any(greaterThan(abs(ndc), vec3(1.0))))
+        return;
+
+    vec3 window = 0.5 * ndc + 0.5;
+    ivec2 coord = min(ivec2(window.xy * vec2(imageSize(iReprojected))), imageSize(iReprojected) - 1);
+    imageAtomicMax(iReprojected, coord, floatBitsToUint(window.z));
+}
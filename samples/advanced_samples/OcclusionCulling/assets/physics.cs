@@ -36,10 +36,86 @@ struct SphereInstance
     vec4 velocity;
 };
 
+#ifdef PIPELINED
+// The spheres of the previous step, still read by the frame being drawn, and where to write the next step.
+layout(std430, binding = 4) readonly buffer PreviousSphereInstances
+{
+    SphereInstance instance[];
+} previous;
+
+layout(std430, binding = 0) writeonly buffer SphereInstances
+{
+    SphereInstance instance[];
+} spheres;
+#else
 layout(std430, binding = 0) buffer SphereInstances
 {
     SphereInstance instance[];
 } spheres;
+#endif
+
+#ifdef SPHERE_COLLISIONS
+// The spheres before this step, sorted by grid cell in physics_grid_scatter.cs.
+// GRID_SIZE, GRID_ORIGIN and GRID_CELL_SIZE are defined by the application.
+layout(std430, binding = 1) readonly buffer SortedSpheres
+{
+    SphereInstance instance[];
+} sorted;
+
+layout(std430, binding = 2) readonly buffer CellStart
+{
+    uint data[];
+} cell_start;
+
+layout(std430, binding = 3) readonly buffer BlockSums
+{
+    uint data[];
+} block_sums;
+
+uint cell_begin(uint cell)
+{
+    return cell_start.data[cell] + block_sums.data[cell / 1024u];
+}
+
+// Cells are larger than the spheres, so only the neighbouring cells need to be tested.
+// Impulses are computed against the snapshot and summed, so the result does not depend on thread order.
+void collide_spheres(vec3 pos, float radius, inout vec3 velocity)
+{
+    ivec3 base = clamp(ivec3(floor((pos - GRID_ORIGIN) / GRID_CELL_SIZE)), ivec3(0), GRID_SIZE - 1);
+    ivec3 lo = max(base - 1, ivec3(0));
+    ivec3 hi = min(base + 1, GRID_SIZE - 1);
+    vec3 impulse = vec3(0.0);
+
+    for (int z = lo.z; z <= hi.z; z++)
+    {
+        for (int y = lo.y; y <= hi.y; y++)
+        {
+            // Cells along X are contiguous, so the whole row is one range.
+            uint row = uint((z * GRID_SIZE.y + y) * GRID_SIZE.x);
+            uint end = cell_begin(row + uint(hi.x) + 1u);
+            for (uint i = cell_begin(row + uint(lo.x)); i < end; i++)
+            {
+                SphereInstance other = sorted.instance[i];
+                vec3 dist = pos - other.position.xyz;
+                float dist_sqr = dot(dist, dist);
+                float minimum_distance = radius + other.position.w;
+
+                // dist_sqr is 0 for ourselves.
+                if (dist_sqr > 0.0 && dist_sqr < minimum_distance * minimum_distance)
+                {
+                    // Equal masses, elastic. Only push apart spheres which are heading towards each other.
+                    vec3 normal = dist * inversesqrt(dist_sqr);
+                    float approach = dot(velocity - other.velocity.xyz, normal);
+                    if (approach < 0.0)
+                        impulse -= approach * normal;
+                }
+            }
+        }
+    }
+
+    velocity += impulse;
+}
+#endif
 
 #define RANGE 20.0
 #define RANGE_Y 10.0
@@ -82,7 +158,15 @@ void main()
 
     // Load instance data.
     // position.w is sphere radius.
+#ifdef PIPELINED
+    SphereInstance sphere = previous.instance[ident];
+#else
     SphereInstance sphere = spheres.instance[ident];
+#endif
+
+#ifdef SPHERE_COLLISIONS
+    collide_spheres(sphere.position.xyz, sphere.position.w, sphere.velocity.xyz);
+#endif
 
     // Move the sphere.
     sphere.position.xyz += sphere.velocity.xyz * uDeltaTime;
@@ -0,0 +1,71 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Counting sort of the spheres into a uniform grid, step 1.
+// Counts the spheres in every cell, and remembers the cell of each sphere and its slot in it.
+// GRID_SIZE, GRID_ORIGIN and GRID_CELL_SIZE are defined by the application.
+
+precision highp float;
+precision highp int;
+
+layout(local_size_x = 128) in;
+layout(location = 0) uniform uint uNumSpheres;
+
+struct SphereInstance
+{
+    vec4 position;
+    vec4 velocity;
+};
+
+layout(std430, binding = 0) readonly buffer SphereInstances
+{
+    SphereInstance instance[];
+} spheres;
+
+layout(std430, binding = 1) buffer CellCounts
+{
+    uint data[];
+} cell_counts;
+
+// .x = cell, .y = slot in the cell.
+layout(std430, binding = 2) writeonly buffer SphereCells
+{
+    uvec2 data[];
+} sphere_cells;
+
+// Spheres outside of the grid are put in the border cells.
+uint grid_cell(vec3 pos)
+{
+    ivec3 c = clamp(ivec3(floor((pos - GRID_ORIGIN) / GRID_CELL_SIZE)), ivec3(0), GRID_SIZE - 1);
+    return uint((c.z * GRID_SIZE.y + c.y) * GRID_SIZE.x + c.x);
+}
+
+void main()
+{
+    uint ident = gl_GlobalInvocationID.x;
+    if (ident >= uNumSpheres)
+        return;
+
+    uint cell = grid_cell(spheres.instance[ident].position.xyz);
+    uint slot = atomicAdd(cell_counts.data[cell], 1u);
+    sphere_cells.data[ident] = uvec2(cell, slot);
+}
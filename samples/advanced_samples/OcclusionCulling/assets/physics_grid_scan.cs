@@ -0,0 +1,126 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Counting sort of the spheres into a uniform grid, step 2.
+// Exclusive prefix sum of 1024 values per work group, in place in shared memory (Blelloch).
+// The first dispatch scans the cell counts block by block, clears them for the next frame,
+// and writes the total of every block. A second dispatch of one work group scans the block totals,
+// so the first sphere of a cell is at cell_start[cell] + block_sums[cell / 1024].
+
+precision highp float;
+precision highp int;
+
+layout(local_size_x = 512) in;
+layout(location = 0) uniform uint uCount;
+layout(location = 1) uniform bool uWriteTotal;
+
+layout(std430, binding = 0) buffer Input
+{
+    uint data[];
+} values;
+
+layout(std430, binding = 1) buffer Output
+{
+    uint data[];
+} scanned;
+
+layout(std430, binding = 2) buffer Totals
+{
+    uint data[];
+} totals;
+
+shared uint data[1024];
+
+// barrier() may only be used directly in main() outside control flow, so the sweeps are unrolled.
+#define UP_SWEEP(d, offset) \
+    barrier(); \
+    if (t < d) \
+    { \
+        uint ai = offset * (2u * t + 1u) - 1u; \
+        data[ai + offset] += data[ai]; \
+    }
+
+#define DOWN_SWEEP(d, offset) \
+    barrier(); \
+    if (t < d) \
+    { \
+        uint ai = offset * (2u * t + 1u) - 1u; \
+        uint value = data[ai]; \
+        data[ai] = data[ai + offset]; \
+        data[ai + offset] += value; \
+    }
+
+void main()
+{
+    uint t = gl_LocalInvocationID.x;
+    uint base = gl_WorkGroupID.x * 1024u;
+    uint i0 = base + 2u * t;
+    uint i1 = i0 + 1u;
+
+    data[2u * t] = i0 < uCount ? values.data[i0] : 0u;
+    data[2u * t + 1u] = i1 < uCount ? values.data[i1] : 0u;
+
+    // Ready for the counting pass of the next frame. Block totals are scanned in place instead.
+    if (uWriteTotal)
+    {
+        if (i0 < uCount)
+            values.data[i0] = 0u;
+        if (i1 < uCount)
+            values.data[i1] = 0u;
+    }
+
+    UP_SWEEP(512u, 1u)
+    UP_SWEEP(256u, 2u)
+    UP_SWEEP(128u, 4u)
+    UP_SWEEP(64u, 8u)
+    UP_SWEEP(32u, 16u)
+    UP_SWEEP(16u, 32u)
+    UP_SWEEP(8u, 64u)
+    UP_SWEEP(4u, 128u)
+    UP_SWEEP(2u, 256u)
+    UP_SWEEP(1u, 512u)
+
+    barrier();
+    if (t == 0u)
+    {
+        if (uWriteTotal)
+            totals.data[gl_WorkGroupID.x] = data[1023];
+        data[1023] = 0u;
+    }
+
+    DOWN_SWEEP(1u, 512u)
+    DOWN_SWEEP(2u, 256u)
+    DOWN_SWEEP(4u, 128u)
+    DOWN_SWEEP(8u, 64u)
+    DOWN_SWEEP(16u, 32u)
+    DOWN_SWEEP(32u, 16u)
+    DOWN_SWEEP(64u, 8u)
+    DOWN_SWEEP(128u, 4u)
+    DOWN_SWEEP(256u, 2u)
+    DOWN_SWEEP(512u, 1u)
+
+    barrier();
+    if (i0 < uCount)
+        scanned.data[i0] = data[2u * t];
+    if (i1 < uCount)
+        scanned.data[i1] = data[2u * t + 1u];
+}
@@ -0,0 +1,72 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Counting sort of the spheres into a uniform grid, step 3.
+// Copies every sphere to its slot, so the spheres of a cell are contiguous for the collision pass.
+
+precision highp float;
+precision highp int;
+
+layout(local_size_x = 128) in;
+layout(location = 0) uniform uint uNumSpheres;
+
+struct SphereInstance
+{
+    vec4 position;
+    vec4 velocity;
+};
+
+layout(std430, binding = 0) readonly buffer SphereInstances
+{
+    SphereInstance instance[];
+} spheres;
+
+layout(std430, binding = 1) writeonly buffer SortedSpheres
+{
+    SphereInstance instance[];
+} sorted;
+
+layout(std430, binding = 2) readonly buffer SphereCells
+{
+    uvec2 data[];
+} sphere_cells;
+
+layout(std430, binding = 3) readonly buffer CellStart
+{
+    uint data[];
+} cell_start;
+
+layout(std430, binding = 4) readonly buffer BlockSums
+{
+    uint data[];
+} block_sums;
+
+void main()
+{
+    uint ident = gl_GlobalInvocationID.x;
+    if (ident >= uNumSpheres)
+        return;
+
+    uvec2 cell = sphere_cells.data[ident];
+    uint first = cell_start.data[cell.x] + block_sums.data[cell.x / 1024u];
+    sorted.instance[first + cell.y] = spheres.instance[ident];
+}
@@ -25,15 +25,15 @@
 
 precision mediump float;
 
-layout(location = 1) uniform vec3 uColor;
 layout(location = 2) uniform vec3 uLightDir;
 
 out vec4 FragColor;
 in vec3 vNormal;
+flat in vec3 vColor;
 
 void main()
 {
     vec3 normal = normalize(vNormal);
-    FragColor = vec4(uColor * (dot(uLightDir, normal) * 0.5 + 0.5), 1.0); // Half-lambertian
+    FragColor = vec4(vColor * (dot(uLightDir, normal) * 0.5 + 0.5), 1.0); // Half-lambertian
 }
 
@@ -24,10 +24,13 @@
 
 layout(location = 0) in vec3 aVertex;
 layout(location = 3) in vec4 aOffset; // Instanced arrays
+layout(location = 4) in float aMeshIndex; // LOD level
 
 layout(location = 0) uniform mat4 uVP;
+layout(location = 1) uniform vec3 uColor;
 
 out vec3 vNormal;
+flat out vec3 vColor;
 
 void main()
 {
@@ -35,5 +38,8 @@ void main()
     vec3 world = aOffset.w * aVertex + aOffset.xyz;
     gl_Position = uVP * vec4(world, 1.0);
     vNormal = aVertex;
+
+    // Use different colors for different LOD levels to easily spot them.
+    vColor = uColor * (vec3(0.8, 1.2, 0.8) + vec3(-0.2, -0.2, 0.2) * aMeshIndex);
 }
 
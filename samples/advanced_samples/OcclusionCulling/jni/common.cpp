@@ -19,6 +19,7 @@
  */
 
 #include "common.hpp"
+#include "ProgramBinaryCache.h"
 #include <stdlib.h>
 #include <string>
 #include <vector>
@@ -74,6 +75,14 @@ static bool check_program(GLuint prog)
 GLuint common_compile_shader(const char *vs_source, const char *fs_source)
 {
     GLuint prog = glCreateProgram();
+
+    const char *sources[] = { vs_source, fs_source };
+    unsigned long long key = ProgramBinaryCache::computeKey(sources, 2);
+    if (ProgramBinaryCache::loadProgram(prog, key))
+    {
+        return prog;
+    }
+
     GLuint vs = common_compile(GL_VERTEX_SHADER, vs_source);
     if (!vs)
     {
@@ -91,6 +100,7 @@ GLuint common_compile_shader(const char *vs_source, const char *fs_source)
 
     glAttachShader(prog, vs);
     glAttachShader(prog, fs);
+    ProgramBinaryCache::prepareProgram(prog);
     glLinkProgram(prog);
 
     glDeleteShader(vs);
@@ -102,12 +112,20 @@ GLuint common_compile_shader(const char *vs_source, const char *fs_source)
         return 0;
     }
 
+    ProgramBinaryCache::storeProgram(prog, key);
     return prog;
 }
 
 GLuint common_compile_compute_shader(const char *cs_source)
 {
     GLuint prog = glCreateProgram();
+
+    unsigned long long key = ProgramBinaryCache::computeKey(&cs_source, 1);
+    if (ProgramBinaryCache::loadProgram(prog, key))
+    {
+        return prog;
+    }
+
     GLuint cs = common_compile(GL_COMPUTE_SHADER, cs_source);
     if (!cs)
     {
@@ -116,6 +134,7 @@ GLuint common_compile_compute_shader(const char *cs_source)
     }
 
     glAttachShader(prog, cs);
+    ProgramBinaryCache::prepareProgram(prog);
     glLinkProgram(prog);
 
     glDeleteShader(cs);
@@ -126,6 +145,7 @@ GLuint common_compile_compute_shader(const char *cs_source)
         return 0;
     }
 
+    ProgramBinaryCache::storeProgram(prog, key);
     return prog;
 }
 
@@ -202,6 +222,24 @@ GLuint common_compile_compute_shader_from_file(const char *cs_source)
     return prog;
 }
 
+GLuint common_compile_compute_shader_from_file(const char *cs_source, const char *defines)
+{
+    LOGI("Compiling compute shader from %s.", cs_source);
+    char *cs_buf = NULL;
+    if (!read_file_string(cs_source, &cs_buf))
+    {
+        return 0;
+    }
+
+    // #version must stay the first line.
+    string source = cs_buf;
+    free(cs_buf);
+    size_t version_end = source.find('\n') + 1;
+    source.insert(version_end, defines);
+
+    return common_compile_compute_shader(source.c_str());
+}
+
 static string common_basedir;
 void common_set_basedir(const char *basedir)
 {
@@ -26,6 +26,7 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <string>
+#include <string.h>
 
 #include "EGLRuntime.h"
 #include "Platform.h"
@@ -38,10 +39,25 @@ GLuint common_compile_compute_shader(const char *cs_source);
 
 GLuint common_compile_shader_from_file(const char *vs_source, const char *fs_source);
 GLuint common_compile_compute_shader_from_file(const char *cs_source);
+GLuint common_compile_compute_shader_from_file(const char *cs_source, const char *defines);
 
 void common_set_basedir(const char *basedir);
 FILE *common_fopen(const char *path, const char *mode);
 
 std::string common_get_path(const char *basepath);
 
+inline bool common_has_extension(const char *ext)
+{
+    GL_CHECK(bool ret = strstr((const char*)glGetString(GL_EXTENSIONS), ext) != nullptr);
+    if (ret)
+    {
+        LOGI("Extension %s is supported.\n", ext);
+    }
+    else
+    {
+        LOGI("Extension %s is unsupported.\n", ext);
+    }
+    return ret;
+}
+
 #endif
@@ -23,25 +23,42 @@
 
 #include "common.hpp"
 #include "mesh.hpp"
+#include "gputimer.hpp"
+#include "JobScheduler.h"
 #include <vector>
 #include <stdint.h>
 #include <stddef.h>
 #define SPHERE_LODS 4
 
 // Layout is defined by OpenGL ES 3.1.
-// We don't care about the three last elements in this case.
+// baseInstance must be zero unless GL_EXT_base_instance is supported.
 struct IndirectCommand
 {
     GLuint count;
     GLuint instanceCount;
-    GLuint zero[3];
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Where the instances which pass culling for one LOD are written.
+// Several LODs can share one buffer at different offsets, which must be aligned to GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT.
+struct InstanceRange
+{
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
 };
 
 class CullingInterface
 {
     public:
+        CullingInterface() : timer(NULL) {}
         virtual ~CullingInterface() {}
 
+        // GPU timer to record the culling stages with, or NULL.
+        void set_timer(GPUTimer *gpu_timer) { timer = gpu_timer; }
+
         // Sets up occlusion geometry. This is mostly static and should be done at startup of a scene.
         virtual void setup_occluder_geometry(const std::vector<vec4> &positions, const std::vector<uint32_t> &indices) = 0;
 
@@ -53,17 +70,55 @@ class CullingInterface
 
         // Test bounding boxes in our scene.
         virtual void test_bounding_boxes(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
-                const GLuint *culled_instance_buffer, GLuint instance_data_buffer,
+                const InstanceRange *culled_instances, GLuint instance_data_buffer,
                 unsigned num_instances) = 0;
 
         // Debugging functionality. Verify that the depth map is being rasterized correctly.
         virtual GLuint get_depth_texture() const { return 0; }
 
+        // Culling methods which reuse the scene depth buffer of the previous frame return true here.
+        // The scene then renders to a depth texture, and hands it over with set_previous_depth() before rasterize_occluders().
+        virtual bool needs_scene_depth() const { return false; }
+
+        // The depth texture rendered in the previous frame and the view-projection it was rendered with.
+        // depth_texture is 0 if there is no usable previous frame, e.g. on the first frame.
+        virtual void set_previous_depth(GLuint depth_texture, unsigned width, unsigned height, const mat4 &view_projection) {}
+
+        // Two-phase culling methods return true here. Instead of rasterize_occluders(), each frame then goes:
+        // test_visible_last_frame(), render what it emitted, rasterize_scene_depth() with the resulting depth buffer,
+        // and test_bounding_boxes(), which only emits instances that were not already drawn in the first phase.
+        virtual bool is_two_phase() const { return false; }
+
+        // First phase. Emits the instances which were visible in the previous frame and are inside the frustum.
+        virtual void test_visible_last_frame(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
+                const InstanceRange *culled_instances, GLuint instance_data_buffer,
+                unsigned num_instances) {}
+
+        // Builds the depth map from the scene depth rendered in the first phase.
+        virtual void rasterize_scene_depth(GLuint depth_texture, unsigned width, unsigned height) {}
+
         virtual unsigned get_num_lods() const { return SPHERE_LODS; }
 
+        // Cullers which test on the CPU return true here. The scene then moves the instances on the CPU as well,
+        // and hands them over with set_cpu_instances() before test_bounding_boxes(), so nothing is read back from the GPU.
+        virtual bool needs_cpu_instances() const { return false; }
+
+        // Positions of the instances, with the radius in w, stride bytes apart. Must stay valid until test_bounding_boxes().
+        virtual void set_cpu_instances(const vec4 *positions, size_t stride) {}
+
+        // Number of instances emitted for each LOD by the last test, if the culler knows it on the CPU, otherwise NULL.
+        // Draws of empty LODs can then be skipped altogether.
+        virtual const unsigned *get_cpu_instance_counts() const { return NULL; }
+
     protected:
         // Common functionality for various occlusion culling implementations.
         void compute_frustum_from_view_projection(vec4 *planes, const mat4 &view_projection);
+
+        void begin_timer(GPUTimer::Section section) { if (timer) timer->begin(section); }
+        void end_timer() { if (timer) timer->end(); }
+
+    private:
+        GPUTimer *timer;
 };
 
 #define DEPTH_SIZE 256
@@ -72,7 +127,7 @@ class HiZCulling : public CullingInterface
 {
     public:
         HiZCulling();
-        HiZCulling(const char *program);
+        HiZCulling(const char *program, const char *defines = "");
         ~HiZCulling();
 
         void setup_occluder_geometry(const std::vector<vec4> &positions, const std::vector<uint32_t> &indices);
@@ -80,12 +135,17 @@ class HiZCulling : public CullingInterface
 
         void rasterize_occluders();
         void test_bounding_boxes(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
-                const GLuint *culled_instance_buffer, GLuint instance_data_buffer,
+                const InstanceRange *culled_instances, GLuint instance_data_buffer,
                 unsigned num_instances);
 
-        GLuint get_depth_texture() const { return depth_texture; }
+        GLuint get_depth_texture() const { return compute_mips ? hiz_texture : depth_texture; }
+
+    protected:
+        // Generates the max-depth mip chain from miplevel 0 of depth_texture.
+        void build_depth_mips();
+        void build_depth_mips_compute();
+        void build_depth_mips_fragment();
 
-    private:
         GLuint depth_render_program;
         GLuint depth_mip_program;
         GLuint culling_program;
@@ -102,6 +162,12 @@ class HiZCulling : public CullingInterface
 
         GLuint depth_texture;
         GLuint shadow_sampler;
+
+        // With compute mipmapping, the Hi-Z map is copied from depth_texture into a float texture
+        // which can be written as an image, and culling samples that instead.
+        bool compute_mips;
+        GLuint hiz_texture;
+
         unsigned lod_levels;
         std::vector<GLuint> framebuffers;
 
@@ -116,7 +182,8 @@ class HiZCulling : public CullingInterface
         };
         Uniforms uniforms;
 
-        void init();
+    private:
+        void init(const char *program, const char *defines);
 };
 
 // Variant of HiZRasterizer which only uses a single LOD.
@@ -129,5 +196,137 @@ class HiZCullingNoLOD : public HiZCulling
         unsigned get_num_lods() const { return 1; }
 };
 
+// Variant of HiZCulling which builds the depth map by reprojecting the scene depth of the previous frame.
+// Occluders are only rasterized when there is no previous frame to reproject.
+class HiZCullingReprojection : public HiZCulling
+{
+    public:
+        HiZCullingReprojection();
+        HiZCullingReprojection(const char *culling_defines);
+        ~HiZCullingReprojection();
+
+        bool needs_scene_depth() const { return true; }
+        void set_previous_depth(GLuint depth_texture, unsigned width, unsigned height, const mat4 &view_projection);
+        void rasterize_occluders();
+
+    private:
+        void init_reprojection();
+
+        GLuint reproject_program;
+        GLuint resolve_program;
+
+        // Reprojected depth as uint bits, so it can be scattered with imageAtomicMax.
+        GLuint reprojected_texture;
+        GLuint reprojected_framebuffer;
+
+        struct
+        {
+            GLuint depth_texture;
+            unsigned width;
+            unsigned height;
+            mat4 view_projection;
+        } previous;
+};
+
+// Two-phase variant of HiZCulling which culls against the actual scene depth instead of the occluder proxy geometry.
+// Instances visible in the previous frame are drawn first, the depth map is built from the depth buffer they leave behind,
+// and the rest are tested against it. Building the depth map reuses the reprojection path, with the current view-projection.
+class HiZCullingTwoPhase : public HiZCullingReprojection
+{
+    public:
+        HiZCullingTwoPhase();
+        ~HiZCullingTwoPhase();
+
+        bool needs_scene_depth() const { return false; }
+        bool is_two_phase() const { return true; }
+
+        void test_visible_last_frame(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
+                const InstanceRange *culled_instances, GLuint instance_data_buffer,
+                unsigned num_instances);
+        void rasterize_scene_depth(GLuint depth_texture, unsigned width, unsigned height);
+        void test_bounding_boxes(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
+                const InstanceRange *culled_instances, GLuint instance_data_buffer,
+                unsigned num_instances);
+
+    private:
+        // One uint per instance, non-zero if the instance passed the second phase in the previous frame.
+        GLuint visibility_buffer;
+        unsigned num_visibility_instances;
+        void bind_visibility(unsigned num_instances);
+};
+
+// Culling on the CPU, without a GPU round trip. Worker threads rasterize the occluders into a software depth map,
+// four pixels at a time with NEON, and test the spheres against its max-depth mip chain the same way hiz_cull.cs does.
+// Only the visible instances are uploaded, and the number drawn for each LOD is known when the frame is submitted.
+#define SOFTWARE_DEPTH_BANDS 16
+class SoftwareCulling : public CullingInterface
+{
+    public:
+        SoftwareCulling();
+        ~SoftwareCulling();
+
+        void setup_occluder_geometry(const std::vector<vec4> &positions, const std::vector<uint32_t> &indices);
+        void set_view_projection(const mat4 &projection, const mat4 &view, const vec2 &zNearFar);
+
+        void rasterize_occluders();
+        void test_bounding_boxes(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
+                const InstanceRange *culled_instances, GLuint instance_data_buffer,
+                unsigned num_instances);
+
+        // The depth map is uploaded for the debug view only.
+        GLuint get_depth_texture() const { return depth_texture; }
+
+        bool needs_cpu_instances() const { return true; }
+        void set_cpu_instances(const vec4 *positions, size_t stride);
+        const unsigned *get_cpu_instance_counts() const { return instance_counts; }
+
+    private:
+        // Occluder triangle after clipping against the near plane, in depth map pixels and window depth.
+        // Clipping may split a triangle in two, so there are two of these per occluder triangle.
+        struct ScreenTriangle
+        {
+            float x[3];
+            float y[3];
+            float z[3];
+            bool valid;
+        };
+
+        JobScheduler scheduler;
+
+        std::vector<vec4> occluder_positions;
+        std::vector<uint32_t> occluder_indices;
+        std::vector<vec4> clip_positions;
+        std::vector<ScreenTriangle> screen_triangles;
+
+        // Every level of the max-depth mip chain, from DEPTH_SIZE x DEPTH_SIZE down to 1 x 1.
+        std::vector<float> depth;
+        unsigned level_offsets[DEPTH_SIZE_LOG2 + 1];
+        GLuint depth_texture;
+
+        mat4 view_projection;
+        mat4 view;
+        mat4 projection;
+        vec4 planes[6];
+        vec2 z_near_far;
+
+        const vec4 *instance_positions;
+        size_t instance_stride;
+
+        // LOD + 1 of every instance which passed, 0 for culled ones.
+        std::vector<uint8_t> instance_lods;
+        std::vector<vec4> lod_instances[SPHERE_LODS];
+        unsigned instance_counts[SPHERE_LODS];
+
+        static void transform_vertices(unsigned begin, unsigned end, void *culling);
+        static void setup_triangles(unsigned begin, unsigned end, void *culling);
+        static void rasterize_bands(unsigned begin, unsigned end, void *culling);
+        static void test_instances(unsigned begin, unsigned end, void *culling);
+
+        void setup_triangle(const vec4 &a, const vec4 &b, const vec4 &c, ScreenTriangle &triangle) const;
+        void rasterize_triangle(const ScreenTriangle &triangle, int band_begin, int band_end);
+        void build_depth_mips();
+        unsigned test_instance(const vec4 &sphere) const;
+};
+
 #endif
 
@@ -0,0 +1,194 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gputimer.hpp"
+
+using namespace std;
+
+GPUTimer::GPUTimer()
+{
+    supported = common_has_extension("GL_EXT_disjoint_timer_query");
+    get_query_objectui64v = NULL;
+    if (supported)
+    {
+        get_query_objectui64v = reinterpret_cast<GetQueryObjectui64vFunc>(eglGetProcAddress("glGetQueryObjectui64vEXT"));
+        if (!get_query_objectui64v)
+        {
+            LOGE("Couldn't get function pointer to glGetQueryObjectui64vEXT()!");
+            supported = false;
+        }
+    }
+
+    for (unsigned i = 0; i < GPU_TIMER_FRAMES; i++)
+    {
+        if (supported)
+        {
+            GL_CHECK(glGenQueries(GPU_TIMER_QUERIES_PER_FRAME, frames[i].queries));
+        }
+        frames[i].num_queries = 0;
+    }
+
+    frame_index = 0;
+    active = false;
+
+    reset_averages();
+}
+
+void GPUTimer::reset_averages()
+{
+    memset(history, 0, sizeof(history));
+    history_index = 0;
+    history_count = 0;
+}
+
+void GPUTimer::collect(Frame &frame)
+{
+    if (frame.num_queries == 0)
+    {
+        return;
+    }
+
+    // If the last query is done, all the others of its frame are as well.
+    GLuint available = 0;
+    GL_CHECK(glGetQueryObjectuiv(frame.queries[frame.num_queries - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+    if (!available)
+    {
+        // Still not done after GPU_TIMER_FRAMES frames, drop it rather than stalling.
+        frame.num_queries = 0;
+        return;
+    }
+
+    // Timings are meaningless if something like a frequency change happened while they were recorded.
+    GLint disjoint = 0;
+    GL_CHECK(glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint));
+    if (!disjoint)
+    {
+        float elapsed_ms[NumSections] = {};
+        for (unsigned i = 0; i < frame.num_queries; i++)
+        {
+            uint64_t elapsed = 0;
+            GL_CHECK(get_query_objectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed));
+            elapsed_ms[frame.sections[i]] += elapsed * 1e-6f;
+        }
+
+        for (unsigned i = 0; i < NumSections; i++)
+        {
+            history[i][history_index] = elapsed_ms[i];
+        }
+        history_index = (history_index + 1) % GPU_TIMER_HISTORY;
+        if (history_count < GPU_TIMER_HISTORY)
+        {
+            history_count++;
+        }
+    }
+
+    frame.num_queries = 0;
+}
+
+void GPUTimer::new_frame()
+{
+    if (!supported)
+    {
+        return;
+    }
+
+    // The frame we are about to reuse was recorded GPU_TIMER_FRAMES frames ago.
+    frame_index = (frame_index + 1) % GPU_TIMER_FRAMES;
+    collect(frames[frame_index]);
+}
+
+void GPUTimer::begin(Section section)
+{
+    Frame &frame = frames[frame_index];
+    if (!supported || active || frame.num_queries == GPU_TIMER_QUERIES_PER_FRAME)
+    {
+        return;
+    }
+
+    frame.sections[frame.num_queries] = section;
+    GL_CHECK(glBeginQuery(GL_TIME_ELAPSED_EXT, frame.queries[frame.num_queries]));
+    active = true;
+}
+
+void GPUTimer::end()
+{
+    if (!active)
+    {
+        return;
+    }
+
+    GL_CHECK(glEndQuery(GL_TIME_ELAPSED_EXT));
+    frames[frame_index].num_queries++;
+    active = false;
+}
+
+float GPUTimer::get_average_ms(Section section) const
+{
+    if (history_count == 0)
+    {
+        return 0.0f;
+    }
+
+    float sum = 0.0f;
+    for (unsigned i = 0; i < history_count; i++)
+    {
+        sum += history[section][i];
+    }
+    return sum / history_count;
+}
+
+const char *GPUTimer::get_section_name(Section section)
+{
+    static const char *names[NumSections] = {
+        "Physics",
+        "Occluder rasterization",
+        "Hi-Z mipmapping",
+        "Bounding box tests",
+        "Scene rendering",
+    };
+    return names[section];
+}
+
+void GPUTimer::log_averages(const char *label) const
+{
+    if (!supported)
+    {
+        LOGI("GPU timings for %s: GL_EXT_disjoint_timer_query is not supported.\n", label);
+        return;
+    }
+
+    LOGI("GPU timings for %s, averaged over %u frames:\n", label, history_count);
+    for (unsigned i = 0; i < NumSections; i++)
+    {
+        Section section = static_cast<Section>(i);
+        LOGI("    %-24s %6.3f ms\n", get_section_name(section), get_average_ms(section));
+    }
+}
+
+GPUTimer::~GPUTimer()
+{
+    if (supported)
+    {
+        for (unsigned i = 0; i < GPU_TIMER_FRAMES; i++)
+        {
+            GL_CHECK(glDeleteQueries(GPU_TIMER_QUERIES_PER_FRAME, frames[i].queries));
+        }
+    }
+}
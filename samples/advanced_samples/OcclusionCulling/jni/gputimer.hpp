@@ -0,0 +1,101 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GPUTIMER_HPP__
+#define GPUTIMER_HPP__
+
+#include "common.hpp"
+#include <stdint.h>
+#include <vector>
+
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+// Measures GPU time of the stages of a frame with GL_EXT_disjoint_timer_query.
+// Results are read back a few frames late so the CPU never waits on the GPU,
+// and are averaged over the last GPU_TIMER_HISTORY frames.
+// If the extension is missing, every call is a no-op and all averages stay at zero.
+#define GPU_TIMER_FRAMES 4
+#define GPU_TIMER_HISTORY 32
+#define GPU_TIMER_QUERIES_PER_FRAME 16
+class GPUTimer
+{
+    public:
+        enum Section
+        {
+            Physics = 0,
+            Occluders,
+            DepthMips,
+            BoundingBoxes,
+            Draw,
+            NumSections
+        };
+
+        GPUTimer();
+        ~GPUTimer();
+
+        bool is_supported() const { return supported; }
+
+        // Collects finished results and starts recording a new frame.
+        void new_frame();
+
+        // Time elapsed queries cannot nest, so sections must not overlap.
+        // A section may be timed several times per frame, the times are added up.
+        void begin(Section section);
+        void end();
+
+        // Average GPU time of a section in milliseconds.
+        float get_average_ms(Section section) const;
+        static const char *get_section_name(Section section);
+
+        // Prints the averages of all sections to logcat.
+        void log_averages(const char *label) const;
+
+        // Forgets the averages, e.g. after changing what is being measured.
+        void reset_averages();
+
+    private:
+        bool supported;
+
+        typedef void (GL_APIENTRY *GetQueryObjectui64vFunc)(GLuint id, GLenum pname, uint64_t *params);
+        GetQueryObjectui64vFunc get_query_objectui64v;
+
+        struct Frame
+        {
+            GLuint queries[GPU_TIMER_QUERIES_PER_FRAME];
+            Section sections[GPU_TIMER_QUERIES_PER_FRAME];
+            unsigned num_queries;
+        };
+        Frame frames[GPU_TIMER_FRAMES];
+        unsigned frame_index;
+        bool active;
+
+        void collect(Frame &frame);
+
+        float history[NumSections][GPU_TIMER_HISTORY];
+        unsigned history_index;
+        unsigned history_count;
+};
+
+#endif
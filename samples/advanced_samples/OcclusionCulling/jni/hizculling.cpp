@@ -19,34 +19,68 @@
  */
 
 #include "culling.hpp"
+#include "GLStateCache.h"
+#include "SamplerCache.h"
 #include <string.h>
+#include <algorithm>
 
 using namespace std;
 
 #define GROUP_SIZE_AABB 64
 
+// Build the Hi-Z mip chain with a compute shader which writes several miplevels per dispatch,
+// instead of rendering one miplevel at a time with a framebuffer switch in between.
+#define HIZ_COMPUTE_MIPS 1
+
+// Each work group of hiz_mip.cs reduces a 32x32 region of its source level.
+#define HIZ_MIP_TILE_SIZE 32
+
 HiZCulling::HiZCulling()
 {
-    culling_program = common_compile_compute_shader_from_file("hiz_cull.cs");
-    init();
+    init("hiz_cull.cs", "");
 }
 
-HiZCulling::HiZCulling(const char *program)
+HiZCulling::HiZCulling(const char *program, const char *defines)
 {
-    culling_program = common_compile_compute_shader_from_file(program);
-    init();
+    init(program, defines);
 }
 
-void HiZCulling::init()
+void HiZCulling::init(const char *program, const char *defines)
 {
+    compute_mips = HIZ_COMPUTE_MIPS;
+
     // Blank fragment shader that only renders depth.
     depth_render_program = common_compile_shader_from_file("depth.vs", "depth.fs");
 
-    // Shader for manually mipmapping a depth texture.
-    depth_mip_program = common_compile_shader_from_file("quad.vs", "depth_mip.fs");
-
     lod_levels = DEPTH_SIZE_LOG2 + 1;
 
+    if (compute_mips)
+    {
+        // The culling shader samples a float Hi-Z map since depth textures cannot be written as images.
+        culling_program = common_compile_compute_shader_from_file(program, (string("#define HIZ_FLOAT\n") + defines).c_str());
+        depth_mip_program = common_compile_compute_shader_from_file("hiz_mip.cs");
+
+        GL_CHECK(glGenTextures(1, &hiz_texture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, hiz_texture));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, lod_levels, GL_R32F, DEPTH_SIZE, DEPTH_SIZE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+        // Graytone for debugging, same as the depth texture.
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED));
+    }
+    else
+    {
+        culling_program = common_compile_compute_shader_from_file(program, defines);
+
+        // Shader for manually mipmapping a depth texture.
+        depth_mip_program = common_compile_shader_from_file("quad.vs", "depth_mip.fs");
+        hiz_texture = 0;
+    }
+
     GL_CHECK(glGenTextures(1, &depth_texture));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, depth_texture));
     GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, lod_levels, GL_DEPTH24_STENCIL8,
@@ -67,9 +101,11 @@ void HiZCulling::init()
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
 
     // Create FBO chain for each miplevel.
-    framebuffers.resize(lod_levels);
-    GL_CHECK(glGenFramebuffers(lod_levels, &framebuffers[0]));
-    for (unsigned i = 0; i < lod_levels; i++)
+    // Mipmapping with compute only needs to render to miplevel 0.
+    unsigned num_framebuffers = compute_mips ? 1 : lod_levels;
+    framebuffers.resize(num_framebuffers);
+    GL_CHECK(glGenFramebuffers(num_framebuffers, &framebuffers[0]));
+    for (unsigned i = 0; i < num_framebuffers; i++)
     {
         GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[i]));
         GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
@@ -89,13 +125,7 @@ void HiZCulling::init()
 
     // Sampler object that is used during occlusion culling.
     // We want GL_LINEAR shadow mode (PCF), but no filtering between miplevels as we manually specify the miplevel in the compute shader.
-    GL_CHECK(glGenSamplers(1, &shadow_sampler));
-    GL_CHECK(glSamplerParameteri(shadow_sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST));
-    GL_CHECK(glSamplerParameteri(shadow_sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-    GL_CHECK(glSamplerParameteri(shadow_sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-    GL_CHECK(glSamplerParameteri(shadow_sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-    GL_CHECK(glSamplerParameteri(shadow_sampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE));
-    GL_CHECK(glSamplerParameteri(shadow_sampler, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL));
+    shadow_sampler = SamplerCache::getSampler(SamplerState::depthCompare(GL_LINEAR_MIPMAP_NEAREST, GL_LEQUAL));
 
     GL_CHECK(glGenBuffers(1, &uniform_buffer));
     GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, uniform_buffer));
@@ -103,7 +133,7 @@ void HiZCulling::init()
 }
 
 void HiZCulling::test_bounding_boxes(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
-        const GLuint *culled_instance_buffer, GLuint instance_data_buffer,
+        const InstanceRange *culled_instances, GLuint instance_data_buffer,
         unsigned num_instances)
 {
     GL_CHECK(glUseProgram(culling_program));
@@ -121,19 +151,30 @@ void HiZCulling::test_bounding_boxes(GLuint counter_buffer, const unsigned *coun
     for (unsigned i = 0; i < num_offsets; i++)
     {
         GL_CHECK(glBindBufferRange(GL_ATOMIC_COUNTER_BUFFER, i, counter_buffer, counter_offsets[i], sizeof(uint32_t)));
-        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1 + i, culled_instance_buffer[i]));
+        GL_CHECK(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1 + i, culled_instances[i].buffer,
+                    culled_instances[i].offset, culled_instances[i].size));
     }
 
     // Bind Hi-Z depth map.
+    // The float Hi-Z map is only read with texelFetch(), so it does not need the shadow sampler.
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, depth_texture));
-    GL_CHECK(glBindSampler(0, shadow_sampler));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, compute_mips ? hiz_texture : depth_texture));
+    if (compute_mips)
+    {
+        SamplerCache::unbind(0);
+    }
+    else
+    {
+        GLStateCache::bindSampler(0, shadow_sampler);
+    }
 
     // Dispatch occlusion culling job.
     GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instance_data_buffer));
+    begin_timer(GPUTimer::BoundingBoxes);
     GL_CHECK(glDispatchCompute(aabb_groups, 1, 1));
+    end_timer();
 
-    GL_CHECK(glBindSampler(0, 0));
+    SamplerCache::unbind(0);
 
     // We have updated instance buffer and indirect draw buffer. Memory barrier here to ensure visibility.
     GL_CHECK(glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT));
@@ -171,8 +212,30 @@ void HiZCulling::rasterize_occluders()
     // Render occlusion geometry to miplevel 0.
     GL_CHECK(glBindVertexArray(occluder.vao));
     GL_CHECK(glViewport(0, 0, DEPTH_SIZE, DEPTH_SIZE));
+    begin_timer(GPUTimer::Occluders);
     GL_CHECK(glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
     GL_CHECK(glDrawElements(GL_TRIANGLES, occluder.elements, GL_UNSIGNED_INT, 0));
+    end_timer();
+
+    build_depth_mips();
+}
+
+void HiZCulling::build_depth_mips()
+{
+    begin_timer(GPUTimer::DepthMips);
+    if (compute_mips)
+    {
+        build_depth_mips_compute();
+    }
+    else
+    {
+        build_depth_mips_fragment();
+    }
+    end_timer();
+}
+
+void HiZCulling::build_depth_mips_fragment()
+{
 
     GL_CHECK(glBindVertexArray(quad.get_vertex_array()));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, depth_texture));
@@ -199,6 +262,49 @@ void HiZCulling::rasterize_occluders()
     GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
 }
 
+void HiZCulling::build_depth_mips_compute()
+{
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GL_CHECK(glUseProgram(depth_mip_program));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+
+    // The first dispatch copies miplevel 0 of the depth texture and reduces it into three more levels.
+    // Every following dispatch reads the last level written and reduces it into up to four more levels.
+    unsigned level = 0;
+    bool copy_source = true;
+    while (level + 1 < lod_levels)
+    {
+        unsigned max_outputs = copy_source ? 3 : 4;
+        unsigned outputs = min(max_outputs, lod_levels - 1 - level);
+
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, copy_source ? depth_texture : hiz_texture));
+        GL_CHECK(glProgramUniform1i(depth_mip_program, 0, copy_source ? 0 : level));
+        GL_CHECK(glProgramUniform1i(depth_mip_program, 1, outputs));
+        GL_CHECK(glProgramUniform1i(depth_mip_program, 2, copy_source));
+
+        // Unused image units still need a valid binding, point them at the last level written.
+        unsigned first_output = copy_source ? 0 : level + 1;
+        unsigned last_output = level + outputs;
+        for (unsigned unit = 0; unit < 4; unit++)
+        {
+            GLint target = min(first_output + unit, last_output);
+            GL_CHECK(glBindImageTexture(unit, hiz_texture, target, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F));
+        }
+
+        unsigned source_size = DEPTH_SIZE >> level;
+        unsigned groups = (source_size + HIZ_MIP_TILE_SIZE - 1) / HIZ_MIP_TILE_SIZE;
+        GL_CHECK(glDispatchCompute(groups, groups, 1));
+
+        // The next dispatch and the culling shader read what was just written.
+        GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
+
+        level = last_output;
+        copy_source = false;
+    }
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
 void HiZCulling::set_view_projection(const mat4 &projection, const mat4 &view, const vec2 &zNearFar)
 {
     mat4 view_projection = projection * view;
@@ -216,6 +322,10 @@ void HiZCulling::set_view_projection(const mat4 &projection, const mat4 &view, c
 HiZCulling::~HiZCulling()
 {
     GL_CHECK(glDeleteTextures(1, &depth_texture));
+    if (hiz_texture)
+    {
+        GL_CHECK(glDeleteTextures(1, &hiz_texture));
+    }
     GL_CHECK(glDeleteProgram(depth_render_program));
     GL_CHECK(glDeleteProgram(depth_mip_program));
     GL_CHECK(glDeleteProgram(culling_program));
@@ -226,6 +336,6 @@ HiZCulling::~HiZCulling()
     GL_CHECK(glDeleteBuffers(1, &uniform_buffer));
     GL_CHECK(glDeleteVertexArrays(1, &occluder.vao));
 
-    GL_CHECK(glDeleteSamplers(1, &shadow_sampler));
+    // The shadow sampler belongs to SamplerCache, which may share it with other users.
 }
 
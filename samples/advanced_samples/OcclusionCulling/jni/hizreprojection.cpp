@@ -0,0 +1,123 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "culling.hpp"
+
+using namespace std;
+
+#define GROUP_SIZE_REPROJECT 8
+
+HiZCullingReprojection::HiZCullingReprojection()
+{
+    init_reprojection();
+}
+
+HiZCullingReprojection::HiZCullingReprojection(const char *culling_defines)
+    : HiZCulling("hiz_cull.cs", culling_defines)
+{
+    init_reprojection();
+}
+
+void HiZCullingReprojection::init_reprojection()
+{
+    reproject_program = common_compile_compute_shader_from_file("hiz_reproject.cs");
+    resolve_program = common_compile_shader_from_file("quad.vs", "hiz_reproject_resolve.fs");
+
+    // R32UI since there are no atomics on floating point images.
+    // Depth values are positive, so their bit patterns sort the same way as the values themselves.
+    GL_CHECK(glGenTextures(1, &reprojected_texture));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, reprojected_texture));
+    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, DEPTH_SIZE, DEPTH_SIZE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+    // Only used to clear the reprojection target.
+    GL_CHECK(glGenFramebuffers(1, &reprojected_framebuffer));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, reprojected_framebuffer));
+    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, reprojected_texture, 0));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+    previous.depth_texture = 0;
+    previous.width = 0;
+    previous.height = 0;
+}
+
+void HiZCullingReprojection::set_previous_depth(GLuint depth_texture, unsigned width, unsigned height, const mat4 &view_projection)
+{
+    previous.depth_texture = depth_texture;
+    previous.width = width;
+    previous.height = height;
+    previous.view_projection = view_projection;
+}
+
+void HiZCullingReprojection::rasterize_occluders()
+{
+    if (previous.depth_texture == 0)
+    {
+        HiZCulling::rasterize_occluders();
+        return;
+    }
+
+    begin_timer(GPUTimer::Occluders);
+
+    // Texels nothing reprojects to stay at 0, and resolve to the far plane.
+    static const GLuint clear_value[4] = { 0 };
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, reprojected_framebuffer));
+    GL_CHECK(glClearBufferuiv(GL_COLOR, 0, clear_value));
+
+    // Scatter the previous depth buffer into the current view.
+    // Each invocation takes the farthest depth of a 2x2 quad, so every previous pixel is covered once.
+    GL_CHECK(glUseProgram(reproject_program));
+    mat4 reprojection = uniforms.uVP * mat_inverse(previous.view_projection);
+    GL_CHECK(glUniformMatrix4fv(0, 1, GL_FALSE, value_ptr(reprojection)));
+    GL_CHECK(glUniform2f(1, 1.0f / previous.width, 1.0f / previous.height));
+    GL_CHECK(glUniform2ui(2, previous.width / 2, previous.height / 2));
+
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, previous.depth_texture));
+    GL_CHECK(glBindImageTexture(0, reprojected_texture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI));
+    GL_CHECK(glDispatchCompute(
+                (previous.width / 2 + GROUP_SIZE_REPROJECT - 1) / GROUP_SIZE_REPROJECT,
+                (previous.height / 2 + GROUP_SIZE_REPROJECT - 1) / GROUP_SIZE_REPROJECT, 1));
+    GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
+
+    // Resolve to miplevel 0 of the Hi-Z depth map.
+    GL_CHECK(glEnable(GL_DEPTH_TEST));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[0]));
+    GL_CHECK(glViewport(0, 0, DEPTH_SIZE, DEPTH_SIZE));
+    GL_CHECK(glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
+
+    GL_CHECK(glUseProgram(resolve_program));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, reprojected_texture));
+    GL_CHECK(glBindVertexArray(quad.get_vertex_array()));
+    GL_CHECK(glDrawElements(GL_TRIANGLES, quad.get_num_elements(), GL_UNSIGNED_SHORT, 0));
+    end_timer();
+
+    build_depth_mips();
+}
+
+HiZCullingReprojection::~HiZCullingReprojection()
+{
+    GL_CHECK(glDeleteProgram(reproject_program));
+    GL_CHECK(glDeleteProgram(resolve_program));
+    GL_CHECK(glDeleteTextures(1, &reprojected_texture));
+    GL_CHECK(glDeleteFramebuffers(1, &reprojected_framebuffer));
+}
@@ -0,0 +1,85 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "culling.hpp"
+
+using namespace std;
+
+// Fixed locations and bindings of the two-phase variant of hiz_cull.cs.
+#define UNIFORM_PHASE_LOCATION 1
+#define VISIBILITY_BUFFER_BINDING 5
+
+HiZCullingTwoPhase::HiZCullingTwoPhase()
+    : HiZCullingReprojection("#define TWO_PHASE\n")
+{
+    GL_CHECK(glGenBuffers(1, &visibility_buffer));
+    num_visibility_instances = 0;
+}
+
+void HiZCullingTwoPhase::bind_visibility(unsigned num_instances)
+{
+    // Nothing was visible before the first frame, which makes the first phase emit nothing.
+    if (num_instances != num_visibility_instances)
+    {
+        vector<GLuint> visibility(num_instances);
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibility_buffer));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, num_instances * sizeof(GLuint), &visibility[0], GL_DYNAMIC_COPY));
+        num_visibility_instances = num_instances;
+    }
+
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBILITY_BUFFER_BINDING, visibility_buffer));
+}
+
+void HiZCullingTwoPhase::test_visible_last_frame(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
+        const InstanceRange *culled_instances, GLuint instance_data_buffer,
+        unsigned num_instances)
+{
+    // The depth map is still from the previous frame here, the first phase only does the frustum test.
+    bind_visibility(num_instances);
+    GL_CHECK(glProgramUniform1ui(culling_program, UNIFORM_PHASE_LOCATION, 0));
+    HiZCulling::test_bounding_boxes(counter_buffer, counter_offsets, num_offsets,
+            culled_instances, instance_data_buffer, num_instances);
+}
+
+void HiZCullingTwoPhase::rasterize_scene_depth(GLuint depth_texture, unsigned width, unsigned height)
+{
+    // Reprojecting with the current view-projection just downsamples the scene depth into the depth map.
+    set_previous_depth(depth_texture, width, height, uniforms.uVP);
+    HiZCullingReprojection::rasterize_occluders();
+}
+
+void HiZCullingTwoPhase::test_bounding_boxes(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
+        const InstanceRange *culled_instances, GLuint instance_data_buffer,
+        unsigned num_instances)
+{
+    // Tests every instance, records the result for the next frame, and only emits instances the first phase did not.
+    bind_visibility(num_instances);
+    GL_CHECK(glProgramUniform1ui(culling_program, UNIFORM_PHASE_LOCATION, 1));
+    HiZCulling::test_bounding_boxes(counter_buffer, counter_offsets, num_offsets,
+            culled_instances, instance_data_buffer, num_instances);
+
+    // The visibility buffer is read by the first phase of the next frame.
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+}
+
+HiZCullingTwoPhase::~HiZCullingTwoPhase()
+{
+    GL_CHECK(glDeleteBuffers(1, &visibility_buffer));
+}
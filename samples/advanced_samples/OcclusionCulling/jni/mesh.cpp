@@ -20,6 +20,8 @@
 
 #include "mesh.hpp"
 #include <utility>
+#include <algorithm>
+#include <math.h>
 using namespace std;
 
 GLDrawable::GLDrawable()
@@ -119,6 +121,98 @@ GLuint GLDrawable::get_vertex_array() const
     return vertex_array;
 }
 
+GLDrawableBatch::GLDrawableBatch(const vector<Mesh> &meshes)
+{
+    vector<Vertex> vertices;
+    vector<float> mesh_indices;
+    vector<uint16_t> indices;
+
+    // Indices stay relative to their own mesh, the draws apply base_vertex.
+    for (unsigned i = 0; i < meshes.size(); i++)
+    {
+        Range range;
+        range.num_elements = meshes[i].ibo.size();
+        range.first_index = indices.size();
+        range.base_vertex = vertices.size();
+        ranges.push_back(range);
+
+        vertices.insert(vertices.end(), meshes[i].vbo.begin(), meshes[i].vbo.end());
+        mesh_indices.insert(mesh_indices.end(), meshes[i].vbo.size(), float(i));
+        indices.insert(indices.end(), meshes[i].ibo.begin(), meshes[i].ibo.end());
+    }
+
+    GL_CHECK(glGenVertexArrays(1, &vertex_array));
+    GL_CHECK(glGenBuffers(1, &vertex_buffer));
+    GL_CHECK(glGenBuffers(1, &mesh_index_buffer));
+    GL_CHECK(glGenBuffers(1, &index_buffer));
+
+    GL_CHECK(glBindVertexArray(vertex_array));
+
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer));
+    GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), &indices[0], GL_STATIC_DRAW));
+
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW));
+
+    // Vertex position
+    GL_CHECK(glEnableVertexAttribArray(0));
+    GL_CHECK(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                reinterpret_cast<const GLvoid*>(offsetof(Vertex, position))));
+
+    // Normal
+    GL_CHECK(glEnableVertexAttribArray(1));
+    GL_CHECK(glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                reinterpret_cast<const GLvoid*>(offsetof(Vertex, normal))));
+
+    // Tex coord
+    GL_CHECK(glEnableVertexAttribArray(2));
+    GL_CHECK(glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                reinterpret_cast<const GLvoid*>(offsetof(Vertex, tex))));
+
+    // Mesh index
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, mesh_index_buffer));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, mesh_indices.size() * sizeof(float), &mesh_indices[0], GL_STATIC_DRAW));
+    GL_CHECK(glEnableVertexAttribArray(4));
+    GL_CHECK(glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, 0, 0));
+
+    GL_CHECK(glBindVertexArray(0));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+}
+
+GLDrawableBatch::~GLDrawableBatch()
+{
+    glDeleteVertexArrays(1, &vertex_array);
+    glDeleteBuffers(1, &vertex_buffer);
+    glDeleteBuffers(1, &mesh_index_buffer);
+    glDeleteBuffers(1, &index_buffer);
+}
+
+GLuint GLDrawableBatch::get_vertex_array() const
+{
+    return vertex_array;
+}
+
+unsigned GLDrawableBatch::get_num_meshes() const
+{
+    return ranges.size();
+}
+
+unsigned GLDrawableBatch::get_num_elements(unsigned mesh) const
+{
+    return ranges[mesh].num_elements;
+}
+
+unsigned GLDrawableBatch::get_first_index(unsigned mesh) const
+{
+    return ranges[mesh].first_index;
+}
+
+unsigned GLDrawableBatch::get_base_vertex(unsigned mesh) const
+{
+    return ranges[mesh].base_vertex;
+}
+
 Mesh create_sphere_mesh(float radius, vec3 center, unsigned vertices_per_circumference)
 {
     Mesh mesh;
@@ -274,3 +368,210 @@ Mesh create_box_mesh(const AABB &aabb)
     return mesh;
 }
 
+// Parity of the triangles crossed by a ray from the point. The ray is slightly off the axes,
+// so it does not graze the edges and faces of axis aligned geometry.
+static bool point_inside_mesh(const vec3 &point, const Mesh &mesh)
+{
+    const vec3 dir = vec_normalize(vec3(1.0f, 0.0137f, 0.0291f));
+    unsigned crossings = 0;
+
+    for (size_t i = 0; i + 2 < mesh.ibo.size(); i += 3)
+    {
+        // Moller-Trumbore.
+        const vec3 &v0 = mesh.vbo[mesh.ibo[i + 0]].position;
+        vec3 edge1 = mesh.vbo[mesh.ibo[i + 1]].position - v0;
+        vec3 edge2 = mesh.vbo[mesh.ibo[i + 2]].position - v0;
+
+        vec3 p = vec_cross(dir, edge2);
+        float det = vec_dot(edge1, p);
+        if (fabs(det) < 1e-12f)
+        {
+            continue;
+        }
+
+        float inv_det = 1.0f / det;
+        vec3 s = point - v0;
+        float u = vec_dot(s, p) * inv_det;
+        if (u < 0.0f || u > 1.0f)
+        {
+            continue;
+        }
+
+        vec3 q = vec_cross(s, edge1);
+        float v = vec_dot(dir, q) * inv_det;
+        if (v < 0.0f || u + v > 1.0f)
+        {
+            continue;
+        }
+
+        if (vec_dot(edge2, q) * inv_det > 0.0f)
+        {
+            crossings++;
+        }
+    }
+
+    return (crossings & 1) != 0;
+}
+
+Mesh create_occluder_mesh(const Mesh &mesh, unsigned resolution, unsigned max_triangles)
+{
+    // Bounds of the vertices, the aabb of a mesh may be looser than that.
+    vec3 minpos = mesh.vbo.empty() ? vec3(0.0f) : mesh.vbo[0].position;
+    vec3 maxpos = minpos;
+    for (size_t i = 0; i < mesh.vbo.size(); i++)
+    {
+        for (unsigned axis = 0; axis < 3; axis++)
+        {
+            minpos.data[axis] = min(minpos.data[axis], mesh.vbo[i].position.data[axis]);
+            maxpos.data[axis] = max(maxpos.data[axis], mesh.vbo[i].position.data[axis]);
+        }
+    }
+
+    // Voxels are close to cubes, and the grid spans the bounds exactly.
+    vec3 extent = maxpos - minpos;
+    float voxel_size = max(max(extent.c.x, extent.c.y), extent.c.z) / max(resolution, 1u);
+    unsigned cells[3];
+    for (unsigned axis = 0; axis < 3; axis++)
+    {
+        cells[axis] = voxel_size > 0.0f ? max(unsigned(extent.data[axis] / voxel_size + 0.5f), 1u) : 1u;
+    }
+
+    // Classify the voxel corners. They are moved inwards a little, so corners on the surface count as inside.
+    vec3 inset = vec3(1e-4f * voxel_size);
+    vec3 corner_extent = extent - vec3(2.0f) * inset;
+    unsigned corners_x = cells[0] + 1;
+    unsigned corners_y = cells[1] + 1;
+    unsigned corners_z = cells[2] + 1;
+    vector<uint8_t> inside(corners_x * corners_y * corners_z);
+
+    for (unsigned z = 0; z < corners_z; z++)
+    {
+        for (unsigned y = 0; y < corners_y; y++)
+        {
+            for (unsigned x = 0; x < corners_x; x++)
+            {
+                vec3 t = vec3(float(x) / cells[0], float(y) / cells[1], float(z) / cells[2]);
+                vec3 point = minpos + inset + corner_extent * t;
+                inside[(z * corners_y + y) * corners_x + x] = point_inside_mesh(point, mesh);
+            }
+        }
+    }
+
+    // Voxels with all eight corners inside are solid.
+    unsigned num_cells = cells[0] * cells[1] * cells[2];
+    vector<uint8_t> solid(num_cells);
+    for (unsigned z = 0; z < cells[2]; z++)
+    {
+        for (unsigned y = 0; y < cells[1]; y++)
+        {
+            for (unsigned x = 0; x < cells[0]; x++)
+            {
+                bool all_inside = true;
+                for (unsigned c = 0; c < 8; c++)
+                {
+                    unsigned cx = x + (c & 1);
+                    unsigned cy = y + ((c >> 1) & 1);
+                    unsigned cz = z + ((c >> 2) & 1);
+                    all_inside = all_inside && inside[(cz * corners_y + cy) * corners_x + cx];
+                }
+                solid[(z * cells[1] + y) * cells[0] + x] = all_inside;
+            }
+        }
+    }
+
+    // Greedily take the largest box of solid voxels not covered yet, grown along X, then Y, then Z from every seed.
+    Mesh occluder;
+    occluder.aabb.minpos = vec4(minpos, 0.0f);
+    occluder.aabb.maxpos = vec4(maxpos, 0.0f);
+
+    const unsigned box_triangles = 12;
+    for (unsigned boxes = 0; (boxes + 1) * box_triangles <= max_triangles; boxes++)
+    {
+        unsigned best_volume = 0;
+        unsigned best_begin[3] = { 0, 0, 0 };
+        unsigned best_end[3] = { 0, 0, 0 };
+
+        for (unsigned z = 0; z < cells[2]; z++)
+        {
+            for (unsigned y = 0; y < cells[1]; y++)
+            {
+                for (unsigned x = 0; x < cells[0]; x++)
+                {
+                    if (!solid[(z * cells[1] + y) * cells[0] + x])
+                    {
+                        continue;
+                    }
+
+                    unsigned end_x = x + 1;
+                    while (end_x < cells[0] && solid[(z * cells[1] + y) * cells[0] + end_x])
+                    {
+                        end_x++;
+                    }
+
+                    unsigned end_y = y + 1;
+                    for (bool grows = true; grows && end_y < cells[1]; )
+                    {
+                        for (unsigned i = x; i < end_x && grows; i++)
+                        {
+                            grows = solid[(z * cells[1] + end_y) * cells[0] + i] != 0;
+                        }
+                        end_y += grows ? 1 : 0;
+                    }
+
+                    unsigned end_z = z + 1;
+                    for (bool grows = true; grows && end_z < cells[2]; )
+                    {
+                        for (unsigned j = y; j < end_y && grows; j++)
+                        {
+                            for (unsigned i = x; i < end_x && grows; i++)
+                            {
+                                grows = solid[(end_z * cells[1] + j) * cells[0] + i] != 0;
+                            }
+                        }
+                        end_z += grows ? 1 : 0;
+                    }
+
+                    unsigned volume = (end_x - x) * (end_y - y) * (end_z - z);
+                    if (volume > best_volume)
+                    {
+                        best_volume = volume;
+                        best_begin[0] = x; best_begin[1] = y; best_begin[2] = z;
+                        best_end[0] = end_x; best_end[1] = end_y; best_end[2] = end_z;
+                    }
+                }
+            }
+        }
+
+        if (best_volume == 0)
+        {
+            break;
+        }
+
+        for (unsigned z = best_begin[2]; z < best_end[2]; z++)
+        {
+            for (unsigned y = best_begin[1]; y < best_end[1]; y++)
+            {
+                for (unsigned x = best_begin[0]; x < best_end[0]; x++)
+                {
+                    solid[(z * cells[1] + y) * cells[0] + x] = 0;
+                }
+            }
+        }
+
+        AABB box;
+        vec3 box_min = minpos + extent * vec3(float(best_begin[0]) / cells[0], float(best_begin[1]) / cells[1], float(best_begin[2]) / cells[2]);
+        vec3 box_max = minpos + extent * vec3(float(best_end[0]) / cells[0], float(best_end[1]) / cells[1], float(best_end[2]) / cells[2]);
+        box.minpos = vec4(box_min, 0.0f);
+        box.maxpos = vec4(box_max, 0.0f);
+
+        Mesh box_mesh = create_box_mesh(box);
+        unsigned base_vertex = occluder.vbo.size();
+        occluder.vbo.insert(occluder.vbo.end(), box_mesh.vbo.begin(), box_mesh.vbo.end());
+        for (size_t i = 0; i < box_mesh.ibo.size(); i++)
+        {
+            occluder.ibo.push_back(box_mesh.ibo[i] + base_vertex);
+        }
+    }
+
+    return occluder;
+}
@@ -52,6 +52,12 @@ struct Mesh
 Mesh create_box_mesh(const AABB &aabb);
 Mesh create_sphere_mesh(float radius, vec3 center, unsigned vertices_per_circumference);
 
+// Builds a conservative occluder for a closed mesh out of boxes which lie inside of it.
+// The mesh is voxelized with voxels about 1 / resolution of its longest side, a voxel is solid when all its corners
+// are inside the mesh, and the largest boxes of solid voxels are extracted until max_triangles would be exceeded.
+// Notches in the mesh narrower than a voxel can be missed. Returns an empty mesh if not even one voxel is solid.
+Mesh create_occluder_mesh(const Mesh &mesh, unsigned resolution, unsigned max_triangles);
+
 class GLDrawable
 {
     public:
@@ -73,4 +79,37 @@ class GLDrawable
         AABB aabb;
 };
 
+// Several meshes with the same vertex format packed into one vertex and index buffer,
+// so any mix of them can be drawn from one vertex array, e.g. with a single multi-draw indirect call.
+// Every vertex also carries the index of its mesh in attribute 4,
+// since OpenGL ES has no gl_DrawID for shaders to tell the draws apart.
+class GLDrawableBatch
+{
+    public:
+        GLDrawableBatch(const std::vector<Mesh> &meshes);
+        ~GLDrawableBatch();
+
+        GLuint get_vertex_array() const;
+        unsigned get_num_meshes() const;
+
+        // Parameters for the draw command of a mesh. first_index is in indices, not bytes.
+        unsigned get_num_elements(unsigned mesh) const;
+        unsigned get_first_index(unsigned mesh) const;
+        unsigned get_base_vertex(unsigned mesh) const;
+
+    private:
+        GLuint vertex_array;
+        GLuint vertex_buffer;
+        GLuint mesh_index_buffer;
+        GLuint index_buffer;
+
+        struct Range
+        {
+            unsigned num_elements;
+            unsigned first_index;
+            unsigned base_vertex;
+        };
+        std::vector<Range> ranges;
+};
+
 #endif
@@ -25,37 +25,112 @@
 
 #define GLES_VERSION 3
 #include "Timer.h"
-#include "Text.h"
+#include "FrameStatistics.h"
+#include "FontAtlas.h"
+#include "SDFText.h"
+#include "SampleParameters.h"
+#include "OverlayBatch.h"
+#include "GPUCounters.h"
+#include "ProgramBinaryCache.h"
+#include "SimulationThread.h"
 
 using namespace std;
 
 int surface_width, surface_height;
 
-static void render_text(Text &text, const char *method, float current_time)
+// The whole overlay, text in two sizes, the backdrop and the legend swatches, is a single draw call.
+static void render_text(SDFText &text, OverlayBatch &overlay, const char *method, float current_time,
+        const GPUTimer &gpu_timer, const GPUCounters &gpu_counters)
 {
-    // Enable alpha blending.
-    GL_CHECK(glEnable(GL_BLEND));
-    GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-
     char method_string[128];
     sprintf(method_string, "Method: %s (%4.1f / 10.0 s)", method, current_time);
 
     text.clear();
-    text.addString(300, surface_height - 20, method_string, 255, 255, 255, 255);
+    text.addString(300, surface_height - 24, method_string, 20.0f, 0, 255, 255, 255, 255);
+
+    text.addString(20, surface_height - 40,  "             Legend:", 16.0f, 0, 255, 255, 255, 255);
+    text.addString(20, surface_height - 60,  "Green tinted sphere: LOD 0", 16.0f, 0, 255, 255, 0, 255);
+    text.addString(20, surface_height - 80,  " Blue tinted sphere: LOD 1 - LOD 3", 16.0f, 0, 255, 255, 0, 255);
+    text.addString(20, surface_height - 100, "        Dark sphere: Occluded spheres", 16.0f, 0, 255, 255, 0, 255);
+    float bottom = surface_height - 100;
+
+    // Rolling averages of the GPU time spent in each stage.
+    if (gpu_timer.is_supported())
+    {
+        text.addString(20, surface_height - 140, "          GPU time:", 16.0f, 0, 255, 255, 255, 255);
+        for (unsigned i = 0; i < GPUTimer::NumSections; i++)
+        {
+            GPUTimer::Section section = static_cast<GPUTimer::Section>(i);
+            char timing_string[128];
+            sprintf(timing_string, "%24s: %6.3f ms", GPUTimer::get_section_name(section), gpu_timer.get_average_ms(section));
+            text.addString(20, surface_height - 160 - 20 * i, timing_string, 16.0f, 0, 255, 255, 255, 255);
+        }
+        bottom = surface_height - 160 - 20 * float(GPUTimer::NumSections - 1);
+    }
+
+    // Hardware counters of the previous frame, to back the savings of culling with bandwidth and cycles.
+    if (gpu_counters.isSupported())
+    {
+        float y = surface_height - 180 - 20 * GPUTimer::NumSections;
+        char counter_string[128];
+
+        text.addString(20, y, "                Mali counters:", 16.0f, 0, 255, 255, 255, 255);
+        gpu_counters.getBandwidthString(counter_string, sizeof(counter_string));
+        text.addString(20, y - 20, counter_string, 16.0f, 0, 255, 255, 255, 255);
+        gpu_counters.getUtilisationString(counter_string, sizeof(counter_string));
+        text.addString(20, y - 40, counter_string, 16.0f, 0, 255, 255, 255, 255);
+        bottom = y - 40;
+    }
+
+    overlay.clear();
+    overlay.addRectangle(0, 10, bottom - 8, 520, surface_height - 12 - bottom, 0, 0, 0, 128);
 
-    text.addString(20, surface_height - 40,  "             Legend:", 255, 255, 255, 255);
-    text.addString(20, surface_height - 60,  "Green tinted sphere: LOD 0", 255, 255, 0, 255);
-    text.addString(20, surface_height - 80,  " Blue tinted sphere: LOD 1 - LOD 3", 255, 255, 0, 255);
-    text.addString(20, surface_height - 100, "        Dark sphere: Occluded spheres", 255, 255, 0, 255);
+    // Swatches next to the legend lines. The text is 8 pixels per character at this size.
+    static const int swatch_colors[3][3] = { { 64, 192, 64 }, { 64, 64, 192 }, { 32, 32, 32 } };
+    for (unsigned i = 0; i < 3; i++)
+    {
+        float y = surface_height - 60 - 20 * i;
+        overlay.addRectangle(1, 20 + 8 * 38, y + 2, 12, 12, swatch_colors[i][0], swatch_colors[i][1], swatch_colors[i][2], 255);
+    }
 
-    text.draw();
-    GL_CHECK(glDisable(GL_BLEND));
+    text.submit(overlay, 2);
+    overlay.draw();
 }
 
 Scene *scene = NULL;
-Text *text = NULL;
+FontAtlas *font_atlas = NULL;
+SDFText *text = NULL;
+OverlayBatch *overlay = NULL;
+GPUCounters *gpu_counters = NULL;
+
+// The camera moves on a simulation thread, which hands its rotation over once per step.
+struct CameraSnapshot
+{
+    float rotation_y;
+    float rotation_x;
+};
+
+struct CameraState
+{
+    float rotation_y;
+    float rotation_x;
+};
+
+CameraState camera_state;
+SimulationThread camera_simulation;
+
+static void simulate_camera(float delta_time, void *snapshot, void *user_data)
+{
+    CameraState *state = static_cast<CameraState*>(user_data);
+    Scene::move_camera(state->rotation_y, state->rotation_x, delta_time * 0.1f, 0.0f);
+
+    CameraSnapshot *camera = static_cast<CameraSnapshot*>(snapshot);
+    camera->rotation_y = state->rotation_y;
+    camera->rotation_x = state->rotation_x;
+}
 
 Timer timer;
+FrameStatistics frame_statistics;
 unsigned phase = 0;
 float culling_timer = 0.0f;
 
@@ -65,16 +140,38 @@ extern "C"
     (JNIEnv *env, jclass jcls, jint width, jint height)
     {
       common_set_basedir("/data/data/com.arm.malideveloper.openglessdk.occlusionculling/files/");
+      ProgramBinaryCache::setDirectory("/data/data/com.arm.malideveloper.openglessdk.occlusionculling/files/");
     
+      SampleParameters::load("/data/data/com.arm.malideveloper.openglessdk.occlusionculling/");
+
       delete scene;
       scene = new Scene;
       scene->set_show_redundant(true);
       scene->set_culling_method(Scene::CullHiZ);
 
       delete text;
-      text = new Text("/data/data/com.arm.malideveloper.openglessdk.occlusionculling/files/", width, height);
+      delete font_atlas;
+      font_atlas = new FontAtlas;
+      // font.raw holds 32 by 3 glyphs of 8x16 pixels.
+      font_atlas->addBitmapFont("/data/data/com.arm.malideveloper.openglessdk.occlusionculling/files/font.raw", 256, 48, 8, 16);
+      font_atlas->upload();
+      text = new SDFText(font_atlas, width, height);
+      delete overlay;
+      overlay = new OverlayBatch(width, height);
+
+      // Counting keeps running across a context loss, only start it once.
+      if (!gpu_counters)
+      {
+          gpu_counters = new GPUCounters;
+      }
+
+      camera_simulation.stop();
+      camera_state.rotation_y = 0.0f;
+      camera_state.rotation_x = 0.0f;
+      camera_simulation.start(sizeof(CameraSnapshot), simulate_camera, &camera_state);
 
       timer.reset();
+      frame_statistics.reset();
       surface_width = width;
       surface_height = height;
     }
@@ -83,18 +180,24 @@ extern "C"
     (JNIEnv *env, jclass jcls)
     {
         float delta_time = timer.getInterval();
+        frame_statistics.frame();
+        gpu_counters->sample();
 
-        // Render scene.
-        scene->move_camera(delta_time * 0.1f, 0.0f);
+        // Render scene, from the latest camera the simulation thread has published.
+        const CameraSnapshot *camera = static_cast<const CameraSnapshot*>(camera_simulation.update());
+        scene->set_camera_rotation(camera->rotation_y, camera->rotation_x);
         scene->update(delta_time, surface_width, surface_height);
         scene->render(surface_width, surface_height);
 
         static const char *methods[] = {
             "Hierarchical-Z occlusion culling with level-of-detail",
             "Hierarchical-Z occlusion culling without level-of-detail",
+            "Hierarchical-Z occlusion culling with depth reprojection",
+            "Two-phase hierarchical-Z occlusion culling",
+            "Software occlusion culling on the CPU",
             "No culling"
         };
-        render_text(*text, methods[phase], culling_timer);
+        render_text(*text, *overlay, methods[phase], culling_timer, scene->get_gpu_timer(), *gpu_counters);
 
         // Don't need depth nor stencil buffers anymore. Just discard them so they are not written out to memory on Mali.
         static const GLenum attachments[] = { GL_DEPTH, GL_STENCIL };
@@ -105,7 +208,14 @@ extern "C"
         if (culling_timer > 10.0f)
         {
             culling_timer = 0.0f;
-            phase = (phase + 1) % 3;
+
+            // Dump the GPU and frame timings of the method we are leaving, and start over for the next one.
+            scene->get_gpu_timer().log_averages(methods[phase]);
+            scene->get_gpu_timer().reset_averages();
+            frame_statistics.log(methods[phase]);
+            frame_statistics.reset();
+
+            phase = (phase + 1) % 6;
 
             switch (phase)
             {
@@ -116,6 +226,15 @@ extern "C"
                     scene->set_culling_method(Scene::CullHiZNoLOD);
                     break;
                 case 2:
+                    scene->set_culling_method(Scene::CullHiZReprojection);
+                    break;
+                case 3:
+                    scene->set_culling_method(Scene::CullHiZTwoPhase);
+                    break;
+                case 4:
+                    scene->set_culling_method(Scene::CullSoftware);
+                    break;
+                case 5:
                     scene->set_culling_method(Scene::CullNone);
                     break;
             }
@@ -127,10 +246,17 @@ extern "C"
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_occlusionculling_OcclusionCulling_uninit
     (JNIEnv *, jclass)
     {
+      camera_simulation.stop();
       delete scene;
       scene = NULL;
       delete text;
       text = NULL;
+      delete overlay;
+      overlay = NULL;
+      delete font_atlas;
+      font_atlas = NULL;
+      delete gpu_counters;
+      gpu_counters = NULL;
     }
 }
 
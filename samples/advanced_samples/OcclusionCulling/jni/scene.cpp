@@ -20,21 +20,47 @@
 
 #include "scene.hpp"
 #include "mesh.hpp"
+#include "SampleParameters.h"
 #include <algorithm>
 #include <stdlib.h>
+#include <math.h>
 
 using namespace std;
+using MaliSDK::SampleParameters;
 
 #define PHYSICS_GROUP_SIZE 128
 
-// Spread our spheres out in three dimensions.
-#define SPHERE_INSTANCES_X 24
-#define SPHERE_INSTANCES_Y 24
-#define SPHERE_INSTANCES_Z 24
-#define SPHERE_INSTANCES (SPHERE_INSTANCES_X * SPHERE_INSTANCES_Y * SPHERE_INSTANCES_Z)
+// Sphere-sphere collisions, with a uniform grid over the walls of physics.cs as broadphase.
+// The spheres are counting sorted into the cells every step, so the cost stays linear.
+// Cells must be larger than the largest sphere diameter.
+#define PHYSICS_COLLISIONS 1
+#define PHYSICS_GRID_X 40
+#define PHYSICS_GRID_Y 10
+#define PHYSICS_GRID_Z 40
+#define PHYSICS_GRID_CELLS (PHYSICS_GRID_X * PHYSICS_GRID_Y * PHYSICS_GRID_Z)
+#define PHYSICS_GRID_CELL_SIZE 1.0f
+// physics_grid_scan.cs scans this many cells per work group. One extra cell holds the total.
+#define PHYSICS_SCAN_BLOCK 1024
+#define PHYSICS_SCAN_BLOCKS ((PHYSICS_GRID_CELLS + 1 + PHYSICS_SCAN_BLOCK - 1) / PHYSICS_SCAN_BLOCK)
+
+// Run the physics one frame ahead of the culling and rendering, into a second sphere buffer.
+// A frame culls and draws the spheres moved by the previous frame, so its own physics dispatch has no consumer
+// until the next frame and can overlap the vertex and fragment work instead of being waited on by a barrier.
+// The spheres are shown one physics step late.
+#define PHYSICS_PIPELINED 1
+
+// Spread our spheres out in three dimensions, on a cube of this many positions per axis.
+// The sphere_grid_size parameter changes it, see SampleParameters.h. The spheres are one unit apart,
+// so at most as many as fit between the walls of physics.cs, RANGE below.
+#define SPHERE_GRID_SIZE 24
+#define SPHERE_GRID_SIZE_MAX 40
 
 #define SPHERE_RADIUS 0.30f
 
+// Occluder simplification of each scene mesh, see create_occluder_mesh().
+#define OCCLUDER_VOXEL_RESOLUTION 16
+#define OCCLUDER_TRIANGLE_BUDGET 48
+
 // Defines how densely spheres should be tesselated (offline) at each LOD level.
 #define SPHERE_VERT_PER_CIRC_LOD0 24
 #define SPHERE_VERT_PER_CIRC_LOD1 20
@@ -59,34 +85,127 @@ Scene::Scene()
     occluder_program = common_compile_shader_from_file("scene.vs", "scene.fs");
     sphere_program = common_compile_shader_from_file("scene_sphere.vs", "scene_sphere.fs");
     quad_program = common_compile_shader_from_file("quad.vs", "quad.fs");
-    physics_program = common_compile_compute_shader_from_file("physics.cs");
+    string physics_defines;
+#if PHYSICS_PIPELINED
+    physics_defines += "#define PIPELINED\n";
+#endif
+#if PHYSICS_COLLISIONS
+    char grid_defines[256];
+    sprintf(grid_defines,
+            "#define GRID_SIZE ivec3(%d, %d, %d)\n"
+            "#define GRID_ORIGIN vec3(%.1f, 0.0, %.1f)\n"
+            "#define GRID_CELL_SIZE %.3f\n",
+            PHYSICS_GRID_X, PHYSICS_GRID_Y, PHYSICS_GRID_Z,
+            -0.5f * PHYSICS_GRID_X * PHYSICS_GRID_CELL_SIZE, -0.5f * PHYSICS_GRID_Z * PHYSICS_GRID_CELL_SIZE,
+            PHYSICS_GRID_CELL_SIZE);
+    physics_defines += string("#define SPHERE_COLLISIONS\n") + grid_defines;
+    physics_program = common_compile_compute_shader_from_file("physics.cs", physics_defines.c_str());
+    physics_grid_count_program = common_compile_compute_shader_from_file("physics_grid_count.cs", grid_defines);
+    physics_grid_scan_program = common_compile_compute_shader_from_file("physics_grid_scan.cs");
+    physics_grid_scatter_program = common_compile_compute_shader_from_file("physics_grid_scatter.cs");
+#else
+    physics_program = common_compile_compute_shader_from_file("physics.cs", physics_defines.c_str());
+#endif
 
     // Instantiate our various culling methods.
     culling_implementations.push_back(new HiZCulling);
     culling_implementations.push_back(new HiZCullingNoLOD);
+    culling_implementations.push_back(new HiZCullingReprojection);
+    culling_implementations.push_back(new HiZCullingTwoPhase);
+    culling_implementations.push_back(new SoftwareCulling);
+    for (unsigned i = 0; i < culling_implementations.size(); i++)
+    {
+        culling_implementations[i]->set_timer(&gpu_timer);
+    }
     culling_implementation_index = CullHiZ;
     enable_culling = true;
 
+    sphere_grid_size = SampleParameters::getInt("sphere_grid_size", SPHERE_GRID_SIZE, 1, SPHERE_GRID_SIZE_MAX);
+    num_sphere_instances = sphere_grid_size * sphere_grid_size * sphere_grid_size;
+
     // Set up buffers, etc.
     init_instances();
 
     camera_rotation_y = 0.0f;
     camera_rotation_x = 0.0f;
 
-    num_render_sphere_instances = SPHERE_INSTANCES;
+    num_render_sphere_instances = num_sphere_instances;
     physics_speed = 1.0f;
+    cpu_spheres_valid = false;
+    physics_pending = false;
 
     show_redundant = false;
+
+    scene_target.framebuffer = 0;
+    scene_target.color = 0;
+    scene_target.depth = 0;
+    scene_target.width = 0;
+    scene_target.height = 0;
+    scene_target.valid = false;
+}
+
+void Scene::init_scene_target(unsigned width, unsigned height)
+{
+    destroy_scene_target();
+
+    GL_CHECK(glGenTextures(1, &scene_target.color));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, scene_target.color));
+    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height));
+
+    GL_CHECK(glGenTextures(1, &scene_target.depth));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, scene_target.depth));
+    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, width, height));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+    GL_CHECK(glGenFramebuffers(1, &scene_target.framebuffer));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, scene_target.framebuffer));
+    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, scene_target.color, 0));
+    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, scene_target.depth, 0));
+
+    GL_CHECK(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOGE("Scene framebuffer is incomplete!");
+    }
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+    scene_target.width = width;
+    scene_target.height = height;
+    scene_target.valid = false;
+}
+
+void Scene::destroy_scene_target()
+{
+    if (scene_target.framebuffer)
+    {
+        GL_CHECK(glDeleteFramebuffers(1, &scene_target.framebuffer));
+        GL_CHECK(glDeleteTextures(1, &scene_target.color));
+        GL_CHECK(glDeleteTextures(1, &scene_target.depth));
+    }
+
+    scene_target.framebuffer = 0;
+    scene_target.color = 0;
+    scene_target.depth = 0;
+    scene_target.valid = false;
 }
 
 // Move camera around. The view-projection matrix is recomputed elsewhere.
 void Scene::move_camera(float delta_x, float delta_y)
+{
+    move_camera(camera_rotation_y, camera_rotation_x, delta_x, delta_y);
+}
+
+void Scene::move_camera(float &rotation_y, float &rotation_x, float delta_x, float delta_y)
 {
     // Angles are mapped from [0, 1] => [0, 2pi] radians.
-    camera_rotation_y -= delta_x * 0.25f;
-    camera_rotation_x += delta_y * 0.15f;
-    camera_rotation_x = clamp(camera_rotation_x, -0.20f, 0.20f);
-    camera_rotation_y -= floor(camera_rotation_y);
+    rotation_y -= delta_x * 0.25f;
+    rotation_x += delta_y * 0.15f;
+    rotation_x = clamp(rotation_x, -0.20f, 0.20f);
+    rotation_y -= floor(rotation_y);
 }
 
 // Bake our instanced occluder geometry into a single vertex buffer and index buffer.
@@ -143,10 +262,12 @@ void Scene::init_instances()
     box = new GLDrawable(box_mesh);
 
     // Create meshes for spheres at various LOD levels.
+    vector<Mesh> sphere_meshes;
     for (unsigned i = 0; i < SPHERE_LODS; i++)
     {
-        sphere[i] = new GLDrawable(create_sphere_mesh(1.0f, vec3(0, 0, 0), verts_per_circ[i]));
+        sphere_meshes.push_back(create_sphere_mesh(1.0f, vec3(0, 0, 0), verts_per_circ[i]));
     }
+    sphere = new GLDrawableBatch(sphere_meshes);
 
     // Spread occluder geometry out on a grid on the XZ plane.
     // Skip the center, because we put our camera there.
@@ -174,17 +295,19 @@ void Scene::init_instances()
 
     // Place out spheres with different positions and velocities.
     // The W component contains the sphere radius, which is random.
+    // The cube is centred on the origin, slightly off so the spheres do not all move in straight lines.
     std::vector<SphereInstance> sphere_instances;
-    for (int x = 0; x < SPHERE_INSTANCES_X; x++)
+    const float center = 0.5f * (sphere_grid_size - 1);
+    for (int x = 0; x < int(sphere_grid_size); x++)
     {
-        for (int y = 0; y < SPHERE_INSTANCES_Y; y++)
+        for (int y = 0; y < int(sphere_grid_size); y++)
         {
-            for (int z = 0; z < SPHERE_INSTANCES_Z; z++)
+            for (int z = 0; z < int(sphere_grid_size); z++)
             {
                 SphereInstance instance;
-                instance.position = vec4(1.0f) * vec4(x - 11.35f, y * 0.10f + 0.5f, z - 11.45f, 0);
+                instance.position = vec4(1.0f) * vec4(x - center + 0.15f, y * 0.10f + 0.5f, z - center + 0.05f, 0);
                 instance.position.c.w = SPHERE_RADIUS * (1.0f - 0.5f * rand() / RAND_MAX);
-                instance.velocity = vec4(vec3(4.0) * vec_normalize(vec3(x - 11.35f, 0.5f * y - 11.55f, z - 11.25f)), 0.0f);
+                instance.velocity = vec4(vec3(4.0) * vec_normalize(vec3(x - center + 0.15f, 0.5f * y - center - 0.05f, z - center + 0.25f)), 0.0f);
 
                 sphere_instances.push_back(instance);
             }
@@ -194,21 +317,57 @@ void Scene::init_instances()
     // Upload sphere instance buffer.
     GL_CHECK(glGenBuffers(1, &sphere_instances_buffer));
     GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, sphere_instances_buffer));
-    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, sphere_instances.size() * sizeof(SphereInstance), &sphere_instances[0], GL_STATIC_DRAW));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, sphere_instances.size() * sizeof(SphereInstance), &sphere_instances[0], GL_DYNAMIC_COPY));
+#if PHYSICS_PIPELINED
+    // Written by the physics while the other one is culled and drawn, see swap_sphere_instances().
+    GL_CHECK(glGenBuffers(1, &sphere_instances_next));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, sphere_instances_next));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, sphere_instances.size() * sizeof(SphereInstance), NULL, GL_DYNAMIC_COPY));
+#endif
+
+#if PHYSICS_COLLISIONS
+    // Broadphase grid. The cell counts must start out cleared, the scan clears them after that.
+    std::vector<GLuint> zero_counts(PHYSICS_SCAN_BLOCKS * PHYSICS_SCAN_BLOCK);
+    GL_CHECK(glGenBuffers(1, &physics_grid.counts));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, physics_grid.counts));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, zero_counts.size() * sizeof(GLuint), &zero_counts[0], GL_DYNAMIC_COPY));
+    GL_CHECK(glGenBuffers(1, &physics_grid.starts));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, physics_grid.starts));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, zero_counts.size() * sizeof(GLuint), NULL, GL_DYNAMIC_COPY));
+    GL_CHECK(glGenBuffers(1, &physics_grid.block_sums));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, physics_grid.block_sums));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, PHYSICS_SCAN_BLOCKS * sizeof(GLuint), NULL, GL_DYNAMIC_COPY));
+    GL_CHECK(glGenBuffers(1, &physics_grid.sphere_cells));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, physics_grid.sphere_cells));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, num_sphere_instances * 2 * sizeof(GLuint), NULL, GL_DYNAMIC_COPY));
+    GL_CHECK(glGenBuffers(1, &physics_grid.sorted_spheres));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, physics_grid.sorted_spheres));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, num_sphere_instances * sizeof(SphereInstance), NULL, GL_DYNAMIC_COPY));
+#endif
 
     // Initialize storage for our post-culled instance buffer.
-    // The buffers must be at least as large as the sphere instance buffer (in case we have 100% visibility).
-    GL_CHECK(glGenBuffers(SPHERE_LODS, indirect.instance_buffer));
-    for (unsigned i = 0; i < SPHERE_LODS; i++)
-    {
-        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, indirect.instance_buffer[i]));
-        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sphere_instances.size() * sizeof(vec4), NULL, GL_DYNAMIC_COPY));
-    }
+    // Every LOD must have room for the entire sphere instance buffer (in case we have 100% visibility).
+    // The LODs share one buffer, so they can be drawn with one multi-draw indirect call.
+    GLint alignment;
+    GL_CHECK(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    GLsizeiptr instance_size = sphere_instances.size() * sizeof(vec4);
+    indirect.instance_stride = ((instance_size + alignment - 1) / alignment) * alignment;
+
+    GL_CHECK(glGenBuffers(1, &indirect.instance_buffer));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, indirect.instance_buffer));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, SPHERE_LODS * indirect.instance_stride, NULL, GL_DYNAMIC_COPY));
+    GL_CHECK(glGenBuffers(1, &indirect.late_instance_buffer));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, indirect.late_instance_buffer));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, SPHERE_LODS * indirect.instance_stride, NULL, GL_DYNAMIC_COPY));
 
     // Setup occluder geometry for each implementation.
     vector<vec4> occluder_positions;
     vector<uint32_t> occluder_indices;
-    bake_occluder_geometry(occluder_positions, occluder_indices, box_mesh, &occluder_instances[0], occluder_instances.size());
+    // The occluders are rasterized every frame, so cull with simplified boxes inside of the rendered mesh.
+    Mesh occluder_mesh = create_occluder_mesh(box_mesh, OCCLUDER_VOXEL_RESOLUTION, OCCLUDER_TRIANGLE_BUDGET);
+    LOGI("Occluder mesh: %u triangles, simplified from %u.\n",
+            unsigned(occluder_mesh.ibo.size() / 3), unsigned(box_mesh.ibo.size() / 3));
+    bake_occluder_geometry(occluder_positions, occluder_indices, occluder_mesh, &occluder_instances[0], occluder_instances.size());
 
     for (unsigned i = 0; i < culling_implementations.size(); i++)
     {
@@ -218,12 +377,28 @@ void Scene::init_instances()
     // Initialize our indirect draw buffers.
     // Use a ring buffer of them, since we might want to read back old results to monitor our culling performance without stalling the pipeline.
     GL_CHECK(glGenBuffers(INDIRECT_BUFFERS, indirect.buffer));
+    GL_CHECK(glGenBuffers(INDIRECT_BUFFERS, indirect.late_buffer));
     for (unsigned i = 0; i < SPHERE_LODS; i++)
     {
         GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect.buffer[i]));
         GL_CHECK(glBufferData(GL_DRAW_INDIRECT_BUFFER, SPHERE_LODS * sizeof(IndirectCommand), NULL, GL_DYNAMIC_COPY));
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect.late_buffer[i]));
+        GL_CHECK(glBufferData(GL_DRAW_INDIRECT_BUFFER, SPHERE_LODS * sizeof(IndirectCommand), NULL, GL_DYNAMIC_COPY));
     }
     indirect.buffer_index = 0;
+
+    // Draw all LODs in one call where possible.
+    // Stride is a multiple of sizeof(vec4) since the alignment of SSBO offsets is a power of two.
+    multi_draw_elements_indirect = NULL;
+    if (common_has_extension("GL_EXT_multi_draw_indirect") && common_has_extension("GL_EXT_base_instance"))
+    {
+        multi_draw_elements_indirect = reinterpret_cast<MultiDrawElementsIndirectFunc>(
+                eglGetProcAddress("glMultiDrawElementsIndirectEXT"));
+        if (!multi_draw_elements_indirect)
+        {
+            LOGE("Couldn't get function pointer to glMultiDrawElementsIndirectEXT()!");
+        }
+    }
 }
 
 #define Z_NEAR 1.0f
@@ -262,6 +437,22 @@ void Scene::set_culling_method(CullingMethod method)
     }
 }
 
+#if PHYSICS_PIPELINED
+// Make the spheres moved by the previous frame's physics the ones this frame culls and draws.
+// The barrier is issued before this frame's physics dispatch, so it only waits for the previous one.
+void Scene::swap_sphere_instances()
+{
+    if (!physics_pending)
+    {
+        return;
+    }
+
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT));
+    std::swap(sphere_instances_buffer, sphere_instances_next);
+    physics_pending = false;
+}
+#endif
+
 void Scene::apply_physics(float delta_time)
 {
     if (physics_speed <= 0.0f)
@@ -269,18 +460,160 @@ void Scene::apply_physics(float delta_time)
         return;
     }
 
+    gpu_timer.begin(GPUTimer::Physics);
+#if PHYSICS_COLLISIONS
+    build_physics_grid();
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, physics_grid.sorted_spheres));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, physics_grid.starts));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, physics_grid.block_sums));
+#endif
+
     // Do physics on the spheres, in a compute shader.
     GL_CHECK(glUseProgram(physics_program));
+#if PHYSICS_PIPELINED
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sphere_instances_next));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, sphere_instances_buffer));
+#else
     GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sphere_instances_buffer));
-    GL_CHECK(glProgramUniform1ui(physics_program, 0, SPHERE_INSTANCES));
+#endif
+    GL_CHECK(glProgramUniform1ui(physics_program, 0, num_sphere_instances));
     GL_CHECK(glProgramUniform1f(physics_program, 1, physics_speed * delta_time));
-    GL_CHECK(glDispatchCompute((SPHERE_INSTANCES + PHYSICS_GROUP_SIZE - 1) / PHYSICS_GROUP_SIZE, 1, 1));
+    GL_CHECK(glDispatchCompute((num_sphere_instances + PHYSICS_GROUP_SIZE - 1) / PHYSICS_GROUP_SIZE, 1, 1));
+    gpu_timer.end();
 
+#if PHYSICS_PIPELINED
+    // Nothing reads the result before the next frame, which waits for it in swap_sphere_instances().
+    physics_pending = true;
+#else
     // We don't need data here until bounding box check, so we can let rasterizer and physics run in parallel, avoiding memory barrier here.
+#endif
+}
+
+#if PHYSICS_COLLISIONS
+// Counting sort of the spheres by grid cell, see physics_grid_*.cs.
+void Scene::build_physics_grid()
+{
+    unsigned sphere_groups = (num_sphere_instances + PHYSICS_GROUP_SIZE - 1) / PHYSICS_GROUP_SIZE;
+
+    // Count spheres per cell.
+    GL_CHECK(glUseProgram(physics_grid_count_program));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sphere_instances_buffer));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, physics_grid.counts));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, physics_grid.sphere_cells));
+    GL_CHECK(glProgramUniform1ui(physics_grid_count_program, 0, num_sphere_instances));
+    GL_CHECK(glDispatchCompute(sphere_groups, 1, 1));
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+
+    // Prefix sum of the counts, per block and then over the block totals.
+    GL_CHECK(glUseProgram(physics_grid_scan_program));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, physics_grid.counts));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, physics_grid.starts));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, physics_grid.block_sums));
+    GL_CHECK(glProgramUniform1ui(physics_grid_scan_program, 0, PHYSICS_SCAN_BLOCKS * PHYSICS_SCAN_BLOCK));
+    GL_CHECK(glProgramUniform1i(physics_grid_scan_program, 1, GL_TRUE));
+    GL_CHECK(glDispatchCompute(PHYSICS_SCAN_BLOCKS, 1, 1));
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, physics_grid.block_sums));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, physics_grid.block_sums));
+    GL_CHECK(glProgramUniform1ui(physics_grid_scan_program, 0, PHYSICS_SCAN_BLOCKS));
+    GL_CHECK(glProgramUniform1i(physics_grid_scan_program, 1, GL_FALSE));
+    GL_CHECK(glDispatchCompute(1, 1, 1));
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+
+    // Move every sphere to its slot.
+    GL_CHECK(glUseProgram(physics_grid_scatter_program));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sphere_instances_buffer));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, physics_grid.sorted_spheres));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, physics_grid.sphere_cells));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, physics_grid.starts));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, physics_grid.block_sums));
+    GL_CHECK(glProgramUniform1ui(physics_grid_scatter_program, 0, num_sphere_instances));
+    GL_CHECK(glDispatchCompute(sphere_groups, 1, 1));
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+}
+#endif
+
+// Same motion as physics.cs, without sphere-sphere collisions.
+#define RANGE 20.0f
+#define RANGE_Y 10.0f
+static void move_sphere(vec4 &position, vec4 &velocity, float delta_time)
+{
+    vec3 pos = vec3(position) + vec3(delta_time) * vec3(velocity);
+    vec3 vel = vec3(velocity);
+    float radius = position.c.w;
+
+    vec3 dist = pos - vec3(0.0f, 2.0f, 0.0f);
+    float minimum_distance = 2.0f + radius;
+    if (vec_dot(dist, dist) < minimum_distance * minimum_distance)
+    {
+        // Sphere is heading towards us, "reflect" it away.
+        if (vec_dot(dist, vel) < 0.0f)
+        {
+            vec3 normal = vec_normalize(dist);
+            vel = vel - vec3(2.0f * vec_dot(normal, vel)) * normal;
+        }
+    }
+    else
+    {
+        // If we collide against our invisible walls, reflect the velocity.
+        if (pos.c.x - radius < -RANGE)
+            vel.c.x = fabs(vel.c.x);
+        else if (pos.c.x + radius > RANGE)
+            vel.c.x = -fabs(vel.c.x);
+
+        if (pos.c.y - radius < 0.0f)
+            vel.c.y = fabs(vel.c.y);
+        else if (pos.c.y + radius > RANGE_Y)
+            vel.c.y = -fabs(vel.c.y);
+
+        if (pos.c.z - radius < -RANGE)
+            vel.c.z = fabs(vel.c.z);
+        else if (pos.c.z + radius > RANGE)
+            vel.c.z = -fabs(vel.c.z);
+    }
+
+    position = vec4(pos, radius);
+    velocity = vec4(vel, 0.0f);
+}
+
+void Scene::apply_physics_cpu(float delta_time)
+{
+    // The GPU has moved the spheres until now, so take over from where it left them. This only stalls once.
+    if (!cpu_spheres_valid)
+    {
+        GLsizeiptr size = num_sphere_instances * sizeof(SphereInstance);
+        cpu_spheres.resize(2 * num_sphere_instances);
+
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, sphere_instances_buffer));
+        GL_CHECK(const void *data = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, GL_MAP_READ_BIT));
+        if (data)
+        {
+            memcpy(&cpu_spheres[0], data, size);
+        }
+        GL_CHECK(glUnmapBuffer(GL_SHADER_STORAGE_BUFFER));
+        cpu_spheres_valid = true;
+    }
+
+    if (physics_speed <= 0.0f)
+    {
+        return;
+    }
+
+    for (unsigned i = 0; i < num_sphere_instances; i++)
+    {
+        move_sphere(cpu_spheres[2 * i + 0], cpu_spheres[2 * i + 1], physics_speed * delta_time);
+    }
+
+    // The spheres are still drawn from the GPU buffer.
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, sphere_instances_buffer));
+    GL_CHECK(glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, num_sphere_instances * sizeof(SphereInstance), &cpu_spheres[0]));
 }
 
 void Scene::update(float delta_time, unsigned width, unsigned height)
 {
+    gpu_timer.new_frame();
+
     // Update scene rendering parameters.
     update_camera(camera_rotation_y, camera_rotation_x, width, height);
 
@@ -290,86 +623,177 @@ void Scene::update(float delta_time, unsigned width, unsigned height)
     GL_CHECK(glProgramUniform3fv(sphere_program, UNIFORM_LIGHT_DIR_LOCATION, 1, value_ptr(light_dir)));
 
     // Move spheres around in a compute shader to make it more exciting.
-    apply_physics(delta_time);
+    // Cullers which test on the CPU need the spheres there, so move them on the CPU instead.
+    CullingInterface *culler = culling_implementations[culling_implementation_index];
+    bool cpu_instances = enable_culling && culler->needs_cpu_instances();
+#if PHYSICS_PIPELINED
+    swap_sphere_instances();
+#endif
+    if (cpu_instances)
+    {
+        apply_physics_cpu(delta_time);
+    }
+    else
+    {
+        cpu_spheres_valid = false;
+        apply_physics(delta_time);
+    }
 
     if (enable_culling)
     {
-        CullingInterface *culler = culling_implementations[culling_implementation_index];
         num_sphere_render_lods = culler->get_num_lods();
 
+        // Hand over the scene depth of the previous frame if the culler can make use of it.
+        if (culler->needs_scene_depth())
+        {
+            bool valid = scene_target.valid && scene_target.width == width && scene_target.height == height;
+            culler->set_previous_depth(valid ? scene_target.depth : 0, width, height, scene_target.view_projection);
+        }
+
         // Rasterize occluders to depth map and mipmap it.
+        // Two-phase culling builds its depth map from the scene itself, in the middle of render().
         culler->set_view_projection(projection, view, vec2(Z_NEAR, Z_FAR));
-        culler->rasterize_occluders();
+        if (!culler->is_two_phase())
+        {
+            culler->rasterize_occluders();
+        }
 
+#if !PHYSICS_PIPELINED
         // We need physics results after this.
         GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+#endif
 
-        IndirectCommand indirect_command[SPHERE_LODS];
         unsigned offsets[SPHERE_LODS];
+        InstanceRange instance_ranges[SPHERE_LODS];
+        reset_indirect_buffer(indirect.buffer[indirect.buffer_index], offsets);
+        get_instance_ranges(indirect.instance_buffer, instance_ranges);
 
-        memset(indirect_command, 0, sizeof(indirect_command));
-
-        for (unsigned i = 0; i < SPHERE_LODS; i++)
+        // Test occluders and build indirect commands as well as per-instance buffers for every LOD.
+        if (culler->is_two_phase())
         {
-            indirect_command[i].count = sphere[i]->get_num_elements();
-            offsets[i] = 4 + sizeof(IndirectCommand) * i;
+            culler->test_visible_last_frame(indirect.buffer[indirect.buffer_index], offsets, SPHERE_LODS,
+                    instance_ranges, sphere_instances_buffer,
+                    num_render_sphere_instances);
+        }
+        else
+        {
+            if (cpu_instances)
+            {
+                culler->set_cpu_instances(&cpu_spheres[0], sizeof(SphereInstance));
+            }
+            culler->test_bounding_boxes(indirect.buffer[indirect.buffer_index], offsets, SPHERE_LODS,
+                    instance_ranges, sphere_instances_buffer,
+                    num_render_sphere_instances);
         }
-
-        // Clear out our indirect draw buffer.
-        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect.buffer[indirect.buffer_index]));
-        GL_CHECK(glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(indirect_command), indirect_command, GL_STREAM_DRAW));
-
-        // Test occluders and build indirect commands as well as per-instance buffers for every LOD.
-        culler->test_bounding_boxes(indirect.buffer[indirect.buffer_index], offsets, SPHERE_LODS,
-                indirect.instance_buffer, sphere_instances_buffer,
-                num_render_sphere_instances);
     }
     else
     {
+#if !PHYSICS_PIPELINED
         // If we don't do culling, we need to make sure we call the memory barrier for physics.
         GL_CHECK(glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT));
+#endif
         num_sphere_render_lods = 1;
     }
 }
 
-void Scene::render_spheres(vec3 color_mod)
+void Scene::reset_indirect_buffer(GLuint indirect_buffer, unsigned *offsets)
 {
-    if (enable_culling)
-    {
-        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect.buffer[indirect.buffer_index]));
+    IndirectCommand indirect_command[SPHERE_LODS];
+    memset(indirect_command, 0, sizeof(indirect_command));
 
-        for (unsigned i = 0; i < num_sphere_render_lods; i++)
+    for (unsigned i = 0; i < SPHERE_LODS; i++)
+    {
+        indirect_command[i].count = sphere->get_num_elements(i);
+        indirect_command[i].firstIndex = sphere->get_first_index(i);
+        indirect_command[i].baseVertex = sphere->get_base_vertex(i);
+        if (multi_draw_elements_indirect)
         {
-            // Use different colors for different LOD levels to easily spot them.
-            GL_CHECK(glProgramUniform3fv(sphere_program, UNIFORM_COLOR_LOCATION, 1,
-                        value_ptr(color_mod * vec3(0.8f - 0.2f * i, 1.2f - 0.2f * i, 0.8f + 0.2f * i))));
+            indirect_command[i].baseInstance = i * (indirect.instance_stride / sizeof(vec4));
+        }
+        offsets[i] = 4 + sizeof(IndirectCommand) * i;
+    }
 
-            // Use different meshes for different LOD levels.
-            GL_CHECK(glBindVertexArray(sphere[i]->get_vertex_array()));
+    // Clear out our indirect draw buffer.
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer));
+    GL_CHECK(glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(indirect_command), indirect_command, GL_STREAM_DRAW));
+}
 
-            GL_CHECK(glEnableVertexAttribArray(3));
-            GL_CHECK(glVertexAttribDivisor(3, 1));
-            GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, indirect.instance_buffer[i]));
-            GL_CHECK(glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), 0));
+void Scene::get_instance_ranges(GLuint instance_buffer, InstanceRange *ranges) const
+{
+    for (unsigned i = 0; i < SPHERE_LODS; i++)
+    {
+        ranges[i].buffer = instance_buffer;
+        ranges[i].offset = i * indirect.instance_stride;
+        ranges[i].size = indirect.instance_stride;
+    }
+}
+
+void Scene::render_spheres(vec3 color_mod, GLuint indirect_buffer, GLuint instance_buffer)
+{
+    // The vertex shader picks a different color for each LOD level to easily spot them.
+    GL_CHECK(glProgramUniform3fv(sphere_program, UNIFORM_COLOR_LOCATION, 1, value_ptr(color_mod)));
+    GL_CHECK(glBindVertexArray(sphere->get_vertex_array()));
+    GL_CHECK(glEnableVertexAttribArray(3));
+    GL_CHECK(glVertexAttribDivisor(3, 1));
+
+    if (enable_culling)
+    {
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, instance_buffer));
 
-            GL_CHECK(glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT,
-                        reinterpret_cast<const void*>(i * sizeof(IndirectCommand))));
+        if (multi_draw_elements_indirect)
+        {
+            // baseInstance selects where each LOD starts in the instance buffer.
+            GL_CHECK(glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), 0));
+            GL_CHECK(multi_draw_elements_indirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0,
+                        num_sphere_render_lods, sizeof(IndirectCommand)));
+        }
+        else
+        {
+            // Cullers which know the results on the CPU let us skip the empty LODs without submitting anything.
+            const unsigned *cpu_counts = culling_implementations[culling_implementation_index]->get_cpu_instance_counts();
+            for (unsigned i = 0; i < num_sphere_render_lods; i++)
+            {
+                if (cpu_counts && cpu_counts[i] == 0)
+                {
+                    continue;
+                }
+
+                GL_CHECK(glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(vec4),
+                            reinterpret_cast<const void*>(i * indirect.instance_stride)));
+                GL_CHECK(glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT,
+                            reinterpret_cast<const void*>(i * sizeof(IndirectCommand))));
+            }
         }
     }
     else
     {
-        // Unconditionally draw every instance of LOD0.
-        GL_CHECK(glProgramUniform3fv(sphere_program, UNIFORM_COLOR_LOCATION, 1, value_ptr(color_mod * vec3(0.8f, 1.2f, 0.8f))));
-        GL_CHECK(glBindVertexArray(sphere[0]->get_vertex_array()));
-        GL_CHECK(glEnableVertexAttribArray(3));
-        GL_CHECK(glVertexAttribDivisor(3, 1));
+        // Unconditionally draw every instance of LOD0, which is first in the batch.
         GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, sphere_instances_buffer));
         GL_CHECK(glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 2 * sizeof(vec4), 0));
-        GL_CHECK(glDrawElementsInstanced(GL_TRIANGLES, sphere[0]->get_num_elements(),
+        GL_CHECK(glDrawElementsInstanced(GL_TRIANGLES, sphere->get_num_elements(0),
                     GL_UNSIGNED_SHORT, NULL, num_render_sphere_instances));
     }
 }
 
+void Scene::render_sphere_pass(GLuint indirect_buffer, GLuint instance_buffer)
+{
+    GL_CHECK(glUseProgram(sphere_program));
+    if (show_redundant)
+    {
+        // Draw false-positive meshes in a dark color.
+        // False-positives will fail the depth test (pass with GL_GREATER).
+        // We don't want to update the depth buffer, so the false-positives will be rendered in a "glitchy"
+        // way due to the random ordering that occlusion culling introduces.
+        GL_CHECK(glDepthFunc(GL_GREATER));
+        GL_CHECK(glDepthMask(GL_FALSE));
+        render_spheres(vec3(0.25f), indirect_buffer, instance_buffer);
+        GL_CHECK(glDepthMask(GL_TRUE));
+        GL_CHECK(glDepthFunc(GL_LESS));
+    }
+    render_spheres(vec3(1.0f), indirect_buffer, instance_buffer);
+}
+
 void Scene::render(unsigned width, unsigned height)
 {
     if (enable_culling)
@@ -385,7 +809,25 @@ void Scene::render(unsigned width, unsigned height)
     GL_CHECK(glEnable(GL_DEPTH_TEST));
     GL_CHECK(glEnable(GL_CULL_FACE));
 
-    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    // Render to a texture if the culler wants to reuse our depth buffer, either next frame or between the two culling phases.
+    CullingInterface *culler = culling_implementations[culling_implementation_index];
+    bool two_phase = enable_culling && culler->is_two_phase();
+    bool offscreen = enable_culling && (culler->needs_scene_depth() || two_phase);
+    if (offscreen)
+    {
+        if (scene_target.width != width || scene_target.height != height || !scene_target.framebuffer)
+        {
+            init_scene_target(width, height);
+        }
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, scene_target.framebuffer));
+    }
+    else
+    {
+        scene_target.valid = false;
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    }
+
+    gpu_timer.begin(GPUTimer::Draw);
     GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
     GL_CHECK(glViewport(0, 0, width, height));
 
@@ -399,20 +841,42 @@ void Scene::render(unsigned width, unsigned height)
     GL_CHECK(glVertexAttribDivisor(3, 1));
     GL_CHECK(glDrawElementsInstanced(GL_TRIANGLES, box->get_num_elements(), GL_UNSIGNED_SHORT, 0, num_occluder_instances));
 
-    GL_CHECK(glUseProgram(sphere_program));
-    if (show_redundant)
+    render_sphere_pass(indirect.buffer[indirect.buffer_index], indirect.instance_buffer);
+    gpu_timer.end();
+
+    if (two_phase)
     {
-        // Draw false-positive meshes in a dark color.
-        // False-positives will fail the depth test (pass with GL_GREATER).
-        // We don't want to update the depth buffer, so the false-positives will be rendered in a "glitchy"
-        // way due to the random ordering that occlusion culling introduces.
-        GL_CHECK(glDepthFunc(GL_GREATER));
-        GL_CHECK(glDepthMask(GL_FALSE));
-        render_spheres(vec3(0.25f));
-        GL_CHECK(glDepthMask(GL_TRUE));
-        GL_CHECK(glDepthFunc(GL_LESS));
+        // Build the depth map from what we have drawn so far and test everything against it.
+        GLuint late_buffer = indirect.late_buffer[indirect.buffer_index];
+        unsigned offsets[SPHERE_LODS];
+        InstanceRange instance_ranges[SPHERE_LODS];
+        culler->rasterize_scene_depth(scene_target.depth, width, height);
+        reset_indirect_buffer(late_buffer, offsets);
+        get_instance_ranges(indirect.late_instance_buffer, instance_ranges);
+        culler->test_bounding_boxes(late_buffer, offsets, SPHERE_LODS,
+                instance_ranges, sphere_instances_buffer,
+                num_render_sphere_instances);
+
+        // Draw the instances which just became visible on top.
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, scene_target.framebuffer));
+        GL_CHECK(glViewport(0, 0, width, height));
+        GL_CHECK(glEnable(GL_DEPTH_TEST));
+        gpu_timer.begin(GPUTimer::Draw);
+        render_sphere_pass(late_buffer, indirect.late_instance_buffer);
+        gpu_timer.end();
+    }
+
+    if (offscreen)
+    {
+        // Present and remember how the depth buffer was rendered.
+        GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, scene_target.framebuffer));
+        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
+        GL_CHECK(glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+        scene_target.view_projection = projection * view;
+        scene_target.valid = true;
     }
-    render_spheres(vec3(1.0f));
 
     if (enable_culling)
     {
@@ -452,10 +916,7 @@ Scene::~Scene()
 {
     delete box;
 
-    for (unsigned i = 0; i < SPHERE_LODS; i++)
-    {
-        delete sphere[i];
-    }
+    delete sphere;
 
     for (unsigned i = 0; i < culling_implementations.size(); i++)
     {
@@ -464,12 +925,29 @@ Scene::~Scene()
 
     GL_CHECK(glDeleteBuffers(1, &occluder_instances_buffer));
     GL_CHECK(glDeleteBuffers(1, &sphere_instances_buffer));
+#if PHYSICS_PIPELINED
+    GL_CHECK(glDeleteBuffers(1, &sphere_instances_next));
+#endif
     GL_CHECK(glDeleteProgram(occluder_program));
     GL_CHECK(glDeleteProgram(quad_program));
     GL_CHECK(glDeleteProgram(physics_program));
+#if PHYSICS_COLLISIONS
+    GL_CHECK(glDeleteProgram(physics_grid_count_program));
+    GL_CHECK(glDeleteProgram(physics_grid_scan_program));
+    GL_CHECK(glDeleteProgram(physics_grid_scatter_program));
+    GL_CHECK(glDeleteBuffers(1, &physics_grid.counts));
+    GL_CHECK(glDeleteBuffers(1, &physics_grid.starts));
+    GL_CHECK(glDeleteBuffers(1, &physics_grid.block_sums));
+    GL_CHECK(glDeleteBuffers(1, &physics_grid.sphere_cells));
+    GL_CHECK(glDeleteBuffers(1, &physics_grid.sorted_spheres));
+#endif
     GL_CHECK(glDeleteProgram(sphere_program));
 
+    destroy_scene_target();
+
     GL_CHECK(glDeleteBuffers(INDIRECT_BUFFERS, indirect.buffer));
-    GL_CHECK(glDeleteBuffers(SPHERE_LODS, indirect.instance_buffer));
+    GL_CHECK(glDeleteBuffers(1, &indirect.instance_buffer));
+    GL_CHECK(glDeleteBuffers(INDIRECT_BUFFERS, indirect.late_buffer));
+    GL_CHECK(glDeleteBuffers(1, &indirect.late_instance_buffer));
 }
 
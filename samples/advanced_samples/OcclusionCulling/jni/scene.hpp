@@ -35,10 +35,16 @@ class Scene
         void update(float delta_time, unsigned width, unsigned height);
         void render(unsigned width, unsigned height);
         void move_camera(float delta_x, float delta_y);
+        // The same motion on a rotation kept outside of the scene, e.g. by a SimulationThread.
+        static void move_camera(float &rotation_y, float &rotation_x, float delta_x, float delta_y);
+        void set_camera_rotation(float rotation_y, float rotation_x) { camera_rotation_y = rotation_y; camera_rotation_x = rotation_x; }
 
         enum CullingMethod {
             CullHiZ = 0,
             CullHiZNoLOD = 1,
+            CullHiZReprojection = 2,
+            CullHiZTwoPhase = 3,
+            CullSoftware = 4,
             CullNone = -1
         };
         void set_culling_method(CullingMethod method);
@@ -48,9 +54,13 @@ class Scene
         void set_show_redundant(bool enable) { show_redundant = enable; }
         bool get_show_redundant() const { return show_redundant; }
 
+        // GPU time spent in each stage of the frame.
+        GPUTimer &get_gpu_timer() { return gpu_timer; }
+
     private:
         GLDrawable *box;
-        GLDrawable *sphere[SPHERE_LODS];
+        // All sphere LODs in one vertex array, so every LOD can be drawn with one multi-draw indirect call.
+        GLDrawableBatch *sphere;
         std::vector<CullingInterface*> culling_implementations;
 
         unsigned culling_implementation_index;
@@ -58,7 +68,18 @@ class Scene
         bool show_redundant;
         bool enable_culling;
 
-        void render_spheres(vec3 color_mod);
+        GPUTimer gpu_timer;
+
+        void render_spheres(vec3 color_mod, GLuint indirect_buffer, GLuint instance_buffer);
+        void render_sphere_pass(GLuint indirect_buffer, GLuint instance_buffer);
+        void reset_indirect_buffer(GLuint indirect_buffer, unsigned *offsets);
+        void get_instance_ranges(GLuint instance_buffer, InstanceRange *ranges) const;
+
+        // GL_EXT_multi_draw_indirect together with GL_EXT_base_instance, which is needed
+        // to point each draw at its own part of the instance buffer.
+        typedef void (GL_APIENTRY *MultiDrawElementsIndirectFunc)(GLenum mode, GLenum type,
+                const void *indirect, GLsizei drawcount, GLsizei stride);
+        MultiDrawElementsIndirectFunc multi_draw_elements_indirect;
 
         void bake_occluder_geometry(std::vector<vec4> &occluder_positions,
                 std::vector<uint32_t> &occluder_indices,
@@ -76,22 +97,71 @@ class Scene
         {
             GLuint buffer[INDIRECT_BUFFERS];
             unsigned buffer_index;
-            GLuint instance_buffer[SPHERE_LODS];
+
+            // Culled instances for all LODs, each LOD in its own instance_stride sized part.
+            GLuint instance_buffer;
+            GLsizeiptr instance_stride;
+
+            // Second phase of two-phase culling, only drawn on top of the first phase.
+            GLuint late_buffer[INDIRECT_BUFFERS];
+            GLuint late_instance_buffer;
         } indirect;
 
         void init_instances();
         GLuint physics_program;
         GLuint occluder_instances_buffer;
+        // The spheres culled and drawn this frame. With PHYSICS_PIPELINED, the physics moves them into
+        // sphere_instances_next, which takes over at the start of the next frame.
         GLuint sphere_instances_buffer;
+        GLuint sphere_instances_next;
+        bool physics_pending;
+        void swap_sphere_instances();
         unsigned num_occluder_instances;
         unsigned num_sphere_render_lods;
         unsigned num_render_sphere_instances;
+        // The spheres are placed on a cube of sphere_grid_size^3 positions, see init_instances().
+        unsigned sphere_grid_size;
+        unsigned num_sphere_instances;
 
         void apply_physics(float delta_time);
         float physics_speed;
 
+        // Uniform grid broadphase for sphere-sphere collisions, rebuilt every physics step.
+        GLuint physics_grid_count_program;
+        GLuint physics_grid_scan_program;
+        GLuint physics_grid_scatter_program;
+        struct
+        {
+            GLuint counts;
+            GLuint starts;
+            GLuint block_sums;
+            GLuint sphere_cells;
+            GLuint sorted_spheres;
+        } physics_grid;
+        void build_physics_grid();
+
+        // Position and velocity of every sphere, for cullers which test on the CPU.
+        // Only kept up to date while such a culler is active, the GPU owns the spheres otherwise.
+        std::vector<vec4> cpu_spheres;
+        bool cpu_spheres_valid;
+        void apply_physics_cpu(float delta_time);
+
         void render_depth_map();
 
+        // Offscreen target for culling methods which reuse the scene depth buffer.
+        struct
+        {
+            GLuint framebuffer;
+            GLuint color;
+            GLuint depth;
+            unsigned width;
+            unsigned height;
+            bool valid;
+            mat4 view_projection;
+        } scene_target;
+        void init_scene_target(unsigned width, unsigned height);
+        void destroy_scene_target();
+
         mat4 projection;
         mat4 view;
 
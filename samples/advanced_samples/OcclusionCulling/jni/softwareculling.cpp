@@ -0,0 +1,481 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "culling.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SOFTWARE_CULLING_NEON 1
+#endif
+
+using namespace std;
+
+// Instances tested per job.
+#define SOFTWARE_TEST_GRAIN 512
+// Vertices and triangles set up per job.
+#define SOFTWARE_SETUP_GRAIN 256
+
+SoftwareCulling::SoftwareCulling()
+{
+    scheduler.initialize(0);
+
+    unsigned offset = 0;
+    for (unsigned level = 0; level <= DEPTH_SIZE_LOG2; level++)
+    {
+        level_offsets[level] = offset;
+        offset += (DEPTH_SIZE >> level) * (DEPTH_SIZE >> level);
+    }
+    depth.resize(offset);
+
+    GL_CHECK(glGenTextures(1, &depth_texture));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, depth_texture));
+    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, DEPTH_SIZE_LOG2 + 1, GL_R32F, DEPTH_SIZE, DEPTH_SIZE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+    // Graytone for debugging, same as the Hi-Z maps.
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED));
+
+    instance_positions = NULL;
+    instance_stride = 0;
+    memset(instance_counts, 0, sizeof(instance_counts));
+}
+
+SoftwareCulling::~SoftwareCulling()
+{
+    scheduler.terminate();
+    GL_CHECK(glDeleteTextures(1, &depth_texture));
+}
+
+void SoftwareCulling::setup_occluder_geometry(const vector<vec4> &positions, const vector<uint32_t> &indices)
+{
+    occluder_positions = positions;
+    occluder_indices = indices;
+    clip_positions.resize(positions.size());
+    screen_triangles.resize(2 * (indices.size() / 3));
+}
+
+void SoftwareCulling::set_view_projection(const mat4 &proj, const mat4 &view_matrix, const vec2 &zNearFar)
+{
+    projection = proj;
+    view = view_matrix;
+    view_projection = proj * view_matrix;
+    z_near_far = zNearFar;
+    compute_frustum_from_view_projection(planes, view_projection);
+}
+
+void SoftwareCulling::set_cpu_instances(const vec4 *positions, size_t stride)
+{
+    instance_positions = positions;
+    instance_stride = stride;
+}
+
+void SoftwareCulling::transform_vertices(unsigned begin, unsigned end, void *culling)
+{
+    SoftwareCulling *self = static_cast<SoftwareCulling*>(culling);
+    for (unsigned i = begin; i < end; i++)
+    {
+        self->clip_positions[i] = self->view_projection * self->occluder_positions[i];
+    }
+}
+
+void SoftwareCulling::setup_triangle(const vec4 &a, const vec4 &b, const vec4 &c, ScreenTriangle &triangle) const
+{
+    const vec4 *vertices[3] = { &a, &b, &c };
+    for (unsigned i = 0; i < 3; i++)
+    {
+        const vec4 &v = *vertices[i];
+        float inv_w = 1.0f / v.c.w;
+        triangle.x[i] = (0.5f * v.c.x * inv_w + 0.5f) * DEPTH_SIZE;
+        triangle.y[i] = (0.5f * v.c.y * inv_w + 0.5f) * DEPTH_SIZE;
+        triangle.z[i] = 0.5f * v.c.z * inv_w + 0.5f;
+    }
+
+    // The occluders are closed boxes, so their back faces are always hidden behind the front faces.
+    float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) -
+        (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+
+    float min_x = min(min(triangle.x[0], triangle.x[1]), triangle.x[2]);
+    float max_x = max(max(triangle.x[0], triangle.x[1]), triangle.x[2]);
+    float min_y = min(min(triangle.y[0], triangle.y[1]), triangle.y[2]);
+    float max_y = max(max(triangle.y[0], triangle.y[1]), triangle.y[2]);
+
+    triangle.valid = area > 0.0f &&
+        max_x >= 0.0f && min_x < float(DEPTH_SIZE) &&
+        max_y >= 0.0f && min_y < float(DEPTH_SIZE);
+}
+
+void SoftwareCulling::setup_triangles(unsigned begin, unsigned end, void *culling)
+{
+    SoftwareCulling *self = static_cast<SoftwareCulling*>(culling);
+
+    for (unsigned t = begin; t < end; t++)
+    {
+        ScreenTriangle *out = &self->screen_triangles[2 * t];
+        out[0].valid = false;
+        out[1].valid = false;
+
+        const vec4 input[3] = {
+            self->clip_positions[self->occluder_indices[3 * t + 0]],
+            self->clip_positions[self->occluder_indices[3 * t + 1]],
+            self->clip_positions[self->occluder_indices[3 * t + 2]],
+        };
+
+        // Clip against the near plane, z >= -w. The other planes are handled by clamping to the depth map.
+        vec4 polygon[4];
+        unsigned count = 0;
+        for (unsigned i = 0; i < 3; i++)
+        {
+            const vec4 &a = input[i];
+            const vec4 &b = input[(i + 1) % 3];
+            float distance_a = a.c.z + a.c.w;
+            float distance_b = b.c.z + b.c.w;
+
+            if (distance_a >= 0.0f)
+            {
+                polygon[count++] = a;
+            }
+
+            if ((distance_a >= 0.0f) != (distance_b >= 0.0f))
+            {
+                float t = distance_a / (distance_a - distance_b);
+                polygon[count++] = a + vec4(t) * (b - a);
+            }
+        }
+
+        if (count >= 3)
+        {
+            self->setup_triangle(polygon[0], polygon[1], polygon[2], out[0]);
+        }
+
+        if (count == 4)
+        {
+            self->setup_triangle(polygon[0], polygon[2], polygon[3], out[1]);
+        }
+    }
+}
+
+// Keeps the nearest depth of any occluder in each pixel. Edge functions are evaluated at pixel centers.
+void SoftwareCulling::rasterize_triangle(const ScreenTriangle &triangle, int band_begin, int band_end)
+{
+    int min_x = max(int(floor(min(min(triangle.x[0], triangle.x[1]), triangle.x[2]))), 0);
+    int max_x = min(int(ceil(max(max(triangle.x[0], triangle.x[1]), triangle.x[2]))), DEPTH_SIZE - 1);
+    int min_y = max(int(floor(min(min(triangle.y[0], triangle.y[1]), triangle.y[2]))), band_begin);
+    int max_y = min(int(ceil(max(max(triangle.y[0], triangle.y[1]), triangle.y[2]))), band_end - 1);
+
+    if (min_x > max_x || min_y > max_y)
+    {
+        return;
+    }
+
+    // Pixels are processed in groups of four, the rows are a multiple of four wide.
+    // Lanes outside of the bounding box are outside of the triangle as well.
+    min_x &= ~3;
+
+    // Edge i is opposite to vertex i, and is positive inside the counter-clockwise triangle.
+    float edge_a[3], edge_b[3], edge_c[3];
+    for (unsigned i = 0; i < 3; i++)
+    {
+        unsigned v0 = (i + 1) % 3;
+        unsigned v1 = (i + 2) % 3;
+        edge_a[i] = triangle.y[v0] - triangle.y[v1];
+        edge_b[i] = triangle.x[v1] - triangle.x[v0];
+        edge_c[i] = -(edge_a[i] * triangle.x[v0] + edge_b[i] * triangle.y[v0]);
+    }
+
+    // Depth is affine in screen space, the edge functions are the barycentrics scaled by the area.
+    float area = edge_a[0] * triangle.x[0] + edge_b[0] * triangle.y[0] + edge_c[0];
+    float inv_area = 1.0f / area;
+    float depth_a = (edge_a[0] * triangle.z[0] + edge_a[1] * triangle.z[1] + edge_a[2] * triangle.z[2]) * inv_area;
+    float depth_b = (edge_b[0] * triangle.z[0] + edge_b[1] * triangle.z[1] + edge_b[2] * triangle.z[2]) * inv_area;
+    float depth_c = (edge_c[0] * triangle.z[0] + edge_c[1] * triangle.z[1] + edge_c[2] * triangle.z[2]) * inv_area;
+
+#if SOFTWARE_CULLING_NEON
+    static const float lane_offsets[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+    const float32x4_t offsets = vld1q_f32(lane_offsets);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+#endif
+
+    for (int y = min_y; y <= max_y; y++)
+    {
+        float py = y + 0.5f;
+        float *row = &depth[y * DEPTH_SIZE];
+
+        float row_edge[3];
+        for (unsigned i = 0; i < 3; i++)
+        {
+            row_edge[i] = edge_b[i] * py + edge_c[i];
+        }
+        float row_depth = depth_b * py + depth_c;
+
+        for (int x = min_x; x <= max_x; x += 4)
+        {
+#if SOFTWARE_CULLING_NEON
+            float32x4_t px = vaddq_f32(vdupq_n_f32(float(x)), offsets);
+            float32x4_t e0 = vmlaq_f32(vdupq_n_f32(row_edge[0]), px, vdupq_n_f32(edge_a[0]));
+            float32x4_t e1 = vmlaq_f32(vdupq_n_f32(row_edge[1]), px, vdupq_n_f32(edge_a[1]));
+            float32x4_t e2 = vmlaq_f32(vdupq_n_f32(row_edge[2]), px, vdupq_n_f32(edge_a[2]));
+            uint32x4_t inside = vandq_u32(vandq_u32(vcgeq_f32(e0, zero), vcgeq_f32(e1, zero)), vcgeq_f32(e2, zero));
+
+            float32x4_t z = vmlaq_f32(vdupq_n_f32(row_depth), px, vdupq_n_f32(depth_a));
+            float32x4_t current = vld1q_f32(row + x);
+            vst1q_f32(row + x, vbslq_f32(inside, vminq_f32(current, z), current));
+#else
+            for (int lane = 0; lane < 4; lane++)
+            {
+                float px = x + lane + 0.5f;
+                if (edge_a[0] * px + row_edge[0] >= 0.0f &&
+                    edge_a[1] * px + row_edge[1] >= 0.0f &&
+                    edge_a[2] * px + row_edge[2] >= 0.0f)
+                {
+                    row[x + lane] = min(row[x + lane], depth_a * px + row_depth);
+                }
+            }
+#endif
+        }
+    }
+}
+
+// Every job owns whole bands of rows, so no two threads ever write the same pixel.
+void SoftwareCulling::rasterize_bands(unsigned begin, unsigned end, void *culling)
+{
+    SoftwareCulling *self = static_cast<SoftwareCulling*>(culling);
+    const int band_rows = DEPTH_SIZE / SOFTWARE_DEPTH_BANDS;
+
+    for (unsigned band = begin; band < end; band++)
+    {
+        int band_begin = band * band_rows;
+        int band_end = band_begin + band_rows;
+        fill(self->depth.begin() + band_begin * DEPTH_SIZE, self->depth.begin() + band_end * DEPTH_SIZE, 1.0f);
+
+        for (size_t t = 0; t < self->screen_triangles.size(); t++)
+        {
+            if (self->screen_triangles[t].valid)
+            {
+                self->rasterize_triangle(self->screen_triangles[t], band_begin, band_end);
+            }
+        }
+    }
+}
+
+void SoftwareCulling::build_depth_mips()
+{
+    for (unsigned level = 1; level <= DEPTH_SIZE_LOG2; level++)
+    {
+        unsigned size = DEPTH_SIZE >> level;
+        const float *src = &depth[level_offsets[level - 1]];
+        float *dst = &depth[level_offsets[level]];
+
+        for (unsigned y = 0; y < size; y++)
+        {
+            const float *row0 = src + (2 * y) * (2 * size);
+            const float *row1 = row0 + 2 * size;
+            for (unsigned x = 0; x < size; x++)
+            {
+                dst[y * size + x] = max(max(row0[2 * x], row0[2 * x + 1]), max(row1[2 * x], row1[2 * x + 1]));
+            }
+        }
+    }
+}
+
+void SoftwareCulling::rasterize_occluders()
+{
+    scheduler.parallelFor("occluder_transform", clip_positions.size(), SOFTWARE_SETUP_GRAIN, transform_vertices, this);
+    scheduler.parallelFor("occluder_setup", occluder_indices.size() / 3, SOFTWARE_SETUP_GRAIN, setup_triangles, this);
+    scheduler.parallelFor("occluder_raster", SOFTWARE_DEPTH_BANDS, 1, rasterize_bands, this);
+    build_depth_mips();
+
+    // For the debug view.
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, depth_texture));
+    GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+    for (unsigned level = 0; level <= DEPTH_SIZE_LOG2; level++)
+    {
+        unsigned size = DEPTH_SIZE >> level;
+        GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, size, size, GL_RED, GL_FLOAT, &depth[level_offsets[level]]));
+    }
+}
+
+// Same test as hiz_cull.cs. Returns the LOD + 1 to draw the sphere with, or 0 if it is culled.
+unsigned SoftwareCulling::test_instance(const vec4 &sphere) const
+{
+    vec4 center = vec4(sphere.c.x, sphere.c.y, sphere.c.z, 1.0f);
+    float radius = sphere.c.w;
+
+    for (unsigned f = 0; f < 6; f++)
+    {
+        if (vec_dot(planes[f], center) < -radius)
+        {
+            return 0;
+        }
+    }
+
+    // Camera is pointing down the -Z axis.
+    vec4 view_center = view * center;
+    float vx = view_center.c.x;
+    float vy = view_center.c.y;
+    float vz = view_center.c.z;
+    float nearest_z = vz + radius;
+
+    float horiz_length = sqrt(vx * vx + vz * vz);
+    float vert_length = sqrt(vy * vy + vz * vz);
+
+    // Sphere clips against near plane, or the camera is inside its projections, just assume visibility.
+    if (nearest_z >= -z_near_far.c.x || horiz_length <= radius || vert_length <= radius)
+    {
+        return 1;
+    }
+
+    // Tangent points from the camera to the sphere projected to the horizontal and vertical planes.
+    float horiz_norm_x = vx / horiz_length;
+    float horiz_norm_y = vz / horiz_length;
+    float vert_norm_x = vy / vert_length;
+    float vert_norm_y = vz / vert_length;
+
+    float tx = sqrt(horiz_length * horiz_length - radius * radius);
+    float ty = sqrt(vert_length * vert_length - radius * radius);
+    float cos_x = tx / horiz_length;
+    float cos_y = ty / vert_length;
+    float sin_x = radius / horiz_length;
+    float sin_y = radius / vert_length;
+
+    float horiz0_x = tx * (horiz_norm_x * cos_x - horiz_norm_y * sin_x);
+    float horiz0_y = tx * (horiz_norm_y * cos_x + horiz_norm_x * sin_x);
+    float horiz1_x = tx * (horiz_norm_x * cos_x + horiz_norm_y * sin_x);
+    float horiz1_y = tx * (horiz_norm_y * cos_x - horiz_norm_x * sin_x);
+    float vert0_x = ty * (vert_norm_x * cos_y - vert_norm_y * sin_y);
+    float vert0_y = ty * (vert_norm_y * cos_y + vert_norm_x * sin_y);
+    float vert1_x = ty * (vert_norm_x * cos_y + vert_norm_y * sin_y);
+    float vert1_y = ty * (vert_norm_y * cos_y - vert_norm_x * sin_y);
+
+    // This assumes the projection matrix doesn't do translations or any other transforms first.
+    float max_x = -0.5f * projection.data[0] * horiz0_x / horiz0_y + 0.5f;
+    float min_x = -0.5f * projection.data[0] * horiz1_x / horiz1_y + 0.5f;
+    float max_y = -0.5f * projection.data[5] * vert0_x / vert0_y + 0.5f;
+    float min_y = -0.5f * projection.data[5] * vert1_x / vert1_y + 0.5f;
+
+    // Project our nearest Z value in view space.
+    float z = projection.data[10] * nearest_z + projection.data[14];
+    float w = projection.data[11] * nearest_z + projection.data[15];
+    nearest_z = 0.5f * z / w + 0.5f;
+
+    // Pick the level where the bounding box covers at most 2x2 texels.
+    float max_diff = max(max((max_x - min_x) * DEPTH_SIZE, (max_y - min_y) * DEPTH_SIZE), 1.0f);
+    int level = clamp(int(ceil(log2(max_diff))), 0, DEPTH_SIZE_LOG2);
+    int size = DEPTH_SIZE >> level;
+    const float *texels = &depth[level_offsets[level]];
+
+    int x0 = clamp(int(floor(0.5f * (min_x + max_x) * size - 0.5f)), 0, size - 1);
+    int y0 = clamp(int(floor(0.5f * (min_y + max_y) * size - 0.5f)), 0, size - 1);
+    int x1 = min(x0 + 1, size - 1);
+    int y1 = min(y0 + 1, size - 1);
+    float farthest = max(max(texels[y0 * size + x0], texels[y0 * size + x1]),
+            max(texels[y1 * size + x0], texels[y1 * size + x1]));
+
+    if (nearest_z > farthest)
+    {
+        return 0;
+    }
+
+    // Pick the LOD from the non-linear depth value.
+    if (nearest_z < 0.8f)
+    {
+        return 1;
+    }
+    else if (nearest_z < 0.9f)
+    {
+        return 2;
+    }
+    else if (nearest_z < 0.95f)
+    {
+        return 3;
+    }
+    else
+    {
+        return 4;
+    }
+}
+
+void SoftwareCulling::test_instances(unsigned begin, unsigned end, void *culling)
+{
+    SoftwareCulling *self = static_cast<SoftwareCulling*>(culling);
+    const char *positions = reinterpret_cast<const char*>(self->instance_positions);
+
+    for (unsigned i = begin; i < end; i++)
+    {
+        const vec4 &sphere = *reinterpret_cast<const vec4*>(positions + i * self->instance_stride);
+        self->instance_lods[i] = self->test_instance(sphere);
+    }
+}
+
+void SoftwareCulling::test_bounding_boxes(GLuint counter_buffer, const unsigned *counter_offsets, unsigned num_offsets,
+        const InstanceRange *culled_instances, GLuint,
+        unsigned num_instances)
+{
+    memset(instance_counts, 0, sizeof(instance_counts));
+    if (!instance_positions)
+    {
+        LOGE("SoftwareCulling needs the instances on the CPU, see set_cpu_instances().\n");
+        return;
+    }
+
+    instance_lods.resize(num_instances);
+    scheduler.parallelFor("sphere_test", num_instances, SOFTWARE_TEST_GRAIN, test_instances, this);
+
+    // Gathered in order on this thread, so the instances are drawn in the same order every frame.
+    const char *positions = reinterpret_cast<const char*>(instance_positions);
+    for (unsigned lod = 0; lod < SPHERE_LODS; lod++)
+    {
+        lod_instances[lod].clear();
+    }
+
+    for (unsigned i = 0; i < num_instances; i++)
+    {
+        if (instance_lods[i])
+        {
+            lod_instances[instance_lods[i] - 1].push_back(*reinterpret_cast<const vec4*>(positions + i * instance_stride));
+        }
+    }
+
+    // Upload the instances and patch instanceCount into the indirect commands.
+    unsigned lods = min(num_offsets, unsigned(SPHERE_LODS));
+    for (unsigned lod = 0; lod < lods; lod++)
+    {
+        const vector<vec4> &instances = lod_instances[lod];
+        instance_counts[lod] = instances.size();
+
+        if (!instances.empty())
+        {
+            GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, culled_instances[lod].buffer));
+            GL_CHECK(glBufferSubData(GL_COPY_WRITE_BUFFER, culled_instances[lod].offset,
+                        instances.size() * sizeof(vec4), &instances[0]));
+        }
+
+        GLuint count = instance_counts[lod];
+        GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, counter_buffer));
+        GL_CHECK(glBufferSubData(GL_COPY_WRITE_BUFFER, counter_offsets[lod], sizeof(count), &count));
+    }
+
+    instance_positions = NULL;
+}
@@ -26,10 +26,21 @@ layout (local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
 layout (binding = 0, r32f) uniform readonly image3D inSurface;
 layout (binding = 1, rgba8) uniform writeonly image3D outCentroid;
 
-layout (binding = 2) uniform atomic_uint outCount;
-layout (binding = 3, std430) buffer IndexBuffer {
+// Each work group updates one dirty brick of cells, given by its
+// linear index in the grid of bricks. The surface cells of a brick
+// are written to the brick's own slot in a persistent pool, so the
+// bricks that did not change keep their indices from earlier frames.
+layout (binding = 1, std430) writeonly buffer BrickPool {
     uint outIndices[];
 };
+layout (binding = 2, std430) writeonly buffer BrickCounts {
+    uint outCounts[];
+};
+layout (binding = 3, std430) readonly buffer BrickList {
+    uint inBricks[];
+};
+
+shared uint brickCount;
 
 uniform float voxel_mode;
 
@@ -168,23 +179,44 @@ vec4 ComputeCentroid(ivec3 texel)
     // If we don't offset the vertices we get a voxel-type mesh
     offset *= 1.0 - voxel_mode;
 
-    // Finally, since we were on the surface, we write out this
-    // cell's index to the index buffer.
-    ivec3 size = imageSize(outCentroid);
-    uint unique = atomicCounterIncrement(outCount);
-    int index = texel.z * size.x * size.y + texel.y * size.x + texel.x;
-    outIndices[unique] = uint(index);
-
     return vec4(offset, 1.0);
 }
 
 void main()
 {
-    ivec3 texel = ivec3(gl_GlobalInvocationID.xyz);
+    ivec3 size = imageSize(outCentroid);
+    ivec3 brick_size = ivec3(gl_WorkGroupSize);
+    ivec3 bricks = size / brick_size;
+    uint brick = inBricks[gl_WorkGroupID.x];
+    ivec3 brick_pos = ivec3(int(brick) % bricks.x,
+                            (int(brick) / bricks.x) % bricks.y,
+                            int(brick) / (bricks.x * bricks.y));
+    ivec3 texel = brick_pos * brick_size + ivec3(gl_LocalInvocationID);
+
+    if (gl_LocalInvocationIndex == 0u)
+        brickCount = 0u;
+    memoryBarrierShared();
+    barrier();
+
     vec4 v = ComputeCentroid(texel);
 
+    // Since we were on the surface, we write out this cell's
+    // index to the brick's slot in the pool.
+    if (v.w > 0.0)
+    {
+        uint slot = brick * gl_WorkGroupSize.x * gl_WorkGroupSize.y * gl_WorkGroupSize.z;
+        uint unique = atomicAdd(brickCount, 1u);
+        int index = texel.z * size.x * size.y + texel.y * size.x + texel.x;
+        outIndices[slot + unique] = uint(index);
+    }
+
     // Remap to fit into 8-bit
     vec3 offset = vec3(0.5) + 0.5 * v.xyz;
 
     imageStore(outCentroid, texel, vec4(offset, v.w));
+
+    memoryBarrierShared();
+    barrier();
+    if (gl_LocalInvocationIndex == 0u)
+        outCounts[brick] = brickCount;
 }
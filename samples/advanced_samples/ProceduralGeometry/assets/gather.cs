@@ -0,0 +1,64 @@
+#version 310 es
+
+/* Copyright (c) 2015-2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+precision highp float;
+layout (local_size_x = 64) in;
+
+// The indirect draw command, whose count is cleared before the dispatch.
+layout (binding = 0, std430) buffer DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int  baseVertex;
+    uint reserved;
+};
+layout (binding = 1, std430) readonly buffer BrickPool {
+    uint inIndices[];
+};
+layout (binding = 2, std430) readonly buffer BrickCounts {
+    uint inCounts[];
+};
+layout (binding = 3, std430) writeonly buffer IndexBuffer {
+    uint outIndices[];
+};
+
+uniform uint brick_cells;
+
+// One invocation per brick concatenates the brick's slot in the
+// pool into the index buffer used for the indirect draw. This is
+// much cheaper than extracting the surface again, and lets clean
+// bricks be drawn without being regenerated.
+void main()
+{
+    uint brick = gl_GlobalInvocationID.x;
+    if (brick >= uint(inCounts.length()))
+        return;
+
+    uint n = inCounts[brick];
+    if (n == 0u)
+        return;
+
+    uint first = atomicAdd(count, n);
+    uint slot = brick * brick_cells;
+    for (uint i = 0u; i < n; i++)
+        outIndices[first + i] = inIndices[slot + i];
+}
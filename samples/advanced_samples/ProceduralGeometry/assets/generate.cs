@@ -24,6 +24,12 @@ precision highp float;
 layout (local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
 layout (binding = 0, r32f) writeonly highp uniform image3D outSurface;
 
+// Each work group regenerates one dirty brick of the volume,
+// given by its linear index in the grid of bricks.
+layout (binding = 0, std430) readonly buffer BrickList {
+    uint inBricks[];
+};
+
 uniform vec3 sphere_pos;
 uniform float sphere_radius;
 uniform int dimension;
@@ -74,27 +80,40 @@ float Scene(vec3 p)
 
 void main()
 {
-    ivec3 texel = ivec3(gl_GlobalInvocationID.xyz);
     ivec3 size = imageSize(outSurface);
-
-    // Don't write outside texture
-    // (Needed for this texture, since we invoke more
-    // work units than the size of the texture).
-    if (texel.x >= size.x ||
-        texel.y >= size.y ||
-        texel.z >= size.z)
-        return;
-
-    // Make sure that we sample the correct position in space here!
-    // Let's say our (1D) cell complex has a grid size of N=4, like so:
-    //      | o | o | o | o |
-    //      +---+---+---+---+---> x
-    //     -1  -.5  0  .5   1
-    // The world space position of the centroids are -.75, -.25, .25, and .75.
-    // Each cell must sample its 2 adjacent edges. I.e. the first cell
-    // should sample the function at -1.0 and -0.5.
-    vec3 p = vec3(-1.0) + 2.0 * vec3(texel) / float(dimension - 1);
-    imageStore(outSurface, texel, vec4(Scene(p)));
+    ivec3 brick_size = ivec3(gl_WorkGroupSize);
+    ivec3 bricks = (size - ivec3(1)) / brick_size;
+    int brick = int(inBricks[gl_WorkGroupID.x]);
+    ivec3 brick_pos = ivec3(brick % bricks.x,
+                            (brick / bricks.x) % bricks.y,
+                            brick / (bricks.x * bricks.y));
+    ivec3 texel = brick_pos * brick_size + ivec3(gl_LocalInvocationID);
+
+    // Each brick owns the samples at its own cells' lower corners.
+    // The surface texture is one sample larger than the centroid
+    // texture, so the bricks along the far faces also own the last
+    // layer of samples, which makes every sample belong to exactly
+    // one brick. A brick can then be regenerated without touching
+    // the samples of its (possibly unchanged) neighbours.
+    ivec3 extra = ivec3(equal(texel, size - ivec3(2)));
+
+    for (int dz = 0; dz <= extra.z; dz++)
+    for (int dy = 0; dy <= extra.y; dy++)
+    for (int dx = 0; dx <= extra.x; dx++)
+    {
+        ivec3 t = texel + ivec3(dx, dy, dz);
+
+        // Make sure that we sample the correct position in space here!
+        // Let's say our (1D) cell complex has a grid size of N=4, like so:
+        //      | o | o | o | o |
+        //      +---+---+---+---+---> x
+        //     -1  -.5  0  .5   1
+        // The world space position of the centroids are -.75, -.25, .25, and .75.
+        // Each cell must sample its 2 adjacent edges. I.e. the first cell
+        // should sample the function at -1.0 and -0.5.
+        vec3 p = vec3(-1.0) + 2.0 * vec3(t) / float(dimension - 1);
+        imageStore(outSurface, t, vec4(Scene(p)));
+    }
 }
 
 // Description : Array and textureless GLSL 2D/3D/4D simplex
@@ -24,6 +24,11 @@
 // The size of one grid side length
 #define N 64
 
+// The volume is updated in bricks of 4x4x4 cells, which
+// matches the local size of the generate and centroid shaders.
+#define BRICK 4
+#define BRICKS (N / BRICK)
+
 Volume make_surface_volume()
 {
     // This should be one more than the dimensions of
@@ -127,23 +132,117 @@ void clear_indirect_buffer(App *app)
 
     DrawElementsIndirectCommand cmd = {};
     cmd.instanceCount = 1;
-    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, app->indirect_buffer);
-    glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(cmd), &cmd, GL_STREAM_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, app->indirect_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(cmd), &cmd, GL_STREAM_DRAW);
+}
+
+// World space coordinate of a surface sample along one axis.
+// This must match the mapping in generate.cs.
+float sample_to_world(int t)
+{
+    return -1.0f + 2.0f * t / float(N - 1);
+}
+
+// Each brick owns the samples at its cells' lower corners,
+// and the last brick also owns the final sample (see generate.cs).
+void brick_bounds(int b, float *lo, float *hi)
+{
+    int first = b * BRICK;
+    int last = (b == BRICKS - 1) ? N : first + BRICK - 1;
+    *lo = sample_to_world(first);
+    *hi = sample_to_world(last);
+}
+
+// The floor noise and the clouds in generate.cs are animated over
+// time, so the rows of bricks covering them change every frame.
+bool is_animated_row(int by)
+{
+    float lo, hi;
+    brick_bounds(by, &lo, &hi);
+    const float margin = 0.01f;
+    bool floor = lo < 0.1f + margin && hi > -0.1f - margin;
+    bool clouds = hi > 0.5f - margin;
+    return floor || clouds;
+}
+
+// The sculpting sphere is combined as max(f, r2 - d^2), which
+// also changes the potential outside the sphere. Only values
+// close to the zero level affect the extracted surface, so we
+// bound the region where it matters with a generous margin.
+bool sphere_touches_brick(vec3 center, float r2, int bx, int by, int bz)
+{
+    float lo[3], hi[3];
+    brick_bounds(bx, &lo[0], &hi[0]);
+    brick_bounds(by, &lo[1], &hi[1]);
+    brick_bounds(bz, &lo[2], &hi[2]);
+    float c[3] = { center.x, center.y, center.z };
+    float d2 = 0.0f;
+    for (int i = 0; i < 3; i++)
+    {
+        float d = 0.0f;
+        if (c[i] < lo[i]) d = lo[i] - c[i];
+        if (c[i] > hi[i]) d = c[i] - hi[i];
+        d2 += d * d;
+    }
+    const float zero_level_margin = 0.25f;
+    return d2 < r2 + zero_level_margin;
+}
+
+// Find the bricks whose surface samples must be generated again,
+// and the bricks whose cells must be extracted again. A cell reads
+// the samples at both ends of its edges, so a brick has to be
+// extracted if any of the bricks at its far corner were generated.
+void find_dirty_bricks(App *app, std::vector<GLuint> &surface_bricks, std::vector<GLuint> &centroid_bricks)
+{
+    bool sphere_changed =
+        app->sphere_radius != app->last_sphere_radius ||
+        app->sphere_pos.x != app->last_sphere_pos.x ||
+        app->sphere_pos.y != app->last_sphere_pos.y ||
+        app->sphere_pos.z != app->last_sphere_pos.z;
+
+    bool animated[BRICKS];
+    for (int by = 0; by < BRICKS; by++)
+        animated[by] = is_animated_row(by);
+
+    std::vector<bool> dirty_centroid(BRICKS * BRICKS * BRICKS, app->full_update || app->voxel_mode != app->last_voxel_mode);
+    for (int bz = 0; bz < BRICKS; bz++)
+    for (int by = 0; by < BRICKS; by++)
+    for (int bx = 0; bx < BRICKS; bx++)
+    {
+        bool dirty = app->full_update || animated[by] ||
+            (sphere_changed &&
+            (sphere_touches_brick(app->sphere_pos, app->sphere_radius, bx, by, bz) ||
+             sphere_touches_brick(app->last_sphere_pos, app->last_sphere_radius, bx, by, bz)));
+        if (!dirty)
+            continue;
+
+        surface_bricks.push_back(bz * BRICKS * BRICKS + by * BRICKS + bx);
+        for (int dz = 0; dz <= 1 && dz <= bz; dz++)
+        for (int dy = 0; dy <= 1 && dy <= by; dy++)
+        for (int dx = 0; dx <= 1 && dx <= bx; dx++)
+            dirty_centroid[(bz - dz) * BRICKS * BRICKS + (by - dy) * BRICKS + (bx - dx)] = true;
+    }
+
+    for (int i = 0; i < BRICKS * BRICKS * BRICKS; i++)
+    {
+        if (dirty_centroid[i])
+            centroid_bricks.push_back(i);
+    }
+
+    app->full_update = false;
+    app->last_sphere_pos = app->sphere_pos;
+    app->last_sphere_radius = app->sphere_radius;
+    app->last_voxel_mode = app->voxel_mode;
 }
 
-void update_surface(App *app)
+void update_surface(App *app, const std::vector<GLuint> &bricks)
 {
-    int local_size_x = 4;
-    int local_size_y = 4;
-    int local_size_z = 4;
-
-    // Since the surface volume texture has a resolution
-    // one higher than the centroid texture, we cannot divide
-    // it evenly to work groups of size larger than one. To
-    // accommodate this, we add one work group for the edge.
-    int work_groups_x = 1 + (app->tex_surface.x - 1) / local_size_x;
-    int work_groups_y = 1 + (app->tex_surface.y - 1) / local_size_y;
-    int work_groups_z = 1 + (app->tex_surface.z - 1) / local_size_z;
+    if (bricks.empty())
+        return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, app->surface_brick_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, bricks.size() * sizeof(GLuint), bricks.data(), GL_STREAM_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, app->surface_brick_buffer);
 
     glUseProgram(app->program_generate);
     uniform1f(generate,  time,          app->elapsed_time);
@@ -151,42 +250,80 @@ void update_surface(App *app)
     uniform3fv(generate, sphere_pos,    app->sphere_pos);
     uniform1f(generate,  sphere_radius, app->sphere_radius);
     glBindImageTexture(0, app->tex_surface.tex, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32F);
-    glDispatchCompute(work_groups_x, work_groups_y, work_groups_z);
+
+    // One work group per dirty brick. The bricks along the far
+    // faces also write the extra layer of the surface texture.
+    glDispatchCompute(bricks.size(), 1, 1);
 
     // Ensure that the surface texture is properly updated
     // before it is sampled in the centroid shader (using imageLoad)
     glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 }
 
-void update_centroid(App *app)
+// Concatenate the surface cells of every brick in the pool
+// into the index buffer, and count them for the indirect draw.
+void gather_bricks(App *app)
 {
-    int local_size_x = 4;
-    int local_size_y = 4;
-    int local_size_z = 4;
-
-    int work_groups_x = app->tex_centroid.x / local_size_x;
-    int work_groups_y = app->tex_centroid.y / local_size_y;
-    int work_groups_z = app->tex_centroid.z / local_size_z;
+    int local_size_x = 64;
+    int work_groups_x = (BRICKS * BRICKS * BRICKS + local_size_x - 1) / local_size_x;
 
     clear_indirect_buffer(app);
 
-    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 2, app->indirect_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, app->indirect_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, app->brick_pool_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, app->brick_count_buffer);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, app->index_buffer);
 
+    glUseProgram(app->program_gather);
+    uniform1ui(gather, brick_cells, BRICK * BRICK * BRICK);
+    glDispatchCompute(work_groups_x, 1, 1);
+
+    // Ensure that the indirect draw buffer and the index buffer
+    // is properly written before we attempt to use it for drawing.
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+    glMemoryBarrier(GL_ELEMENT_ARRAY_BARRIER_BIT);
+}
+
+void update_centroid(App *app, const std::vector<GLuint> &bricks)
+{
+    // Nothing changed, so the pool, the index buffer and
+    // the indirect draw buffer are all still valid.
+    if (bricks.empty())
+        return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, app->centroid_brick_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, bricks.size() * sizeof(GLuint), bricks.data(), GL_STREAM_DRAW);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, app->brick_pool_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, app->brick_count_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, app->centroid_brick_buffer);
+
     glUseProgram(app->program_centroid);
     uniform1f(centroid, voxel_mode, app->voxel_mode);
     glBindImageTexture(0, app->tex_surface.tex, 0, GL_TRUE, 0, GL_READ_ONLY, GL_R32F);
     glBindImageTexture(1, app->tex_centroid.tex, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
-    glDispatchCompute(work_groups_x, work_groups_y, work_groups_z);
+    glDispatchCompute(bricks.size(), 1, 1);
 
     // Ensure that the centroid offsets are properly written
     // before we attempt to read them in the geometry shader.
     glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
 
-    // Ensure that the indirect draw buffer and the index buffer
-    // is properly written before we attempt to use it for drawing.
-    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
-    glMemoryBarrier(GL_ELEMENT_ARRAY_BARRIER_BIT);
+    // Ensure that the pool is written before it is gathered.
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    gather_bricks(app);
+}
+
+// Only the parts of the volume that changed since the last
+// frame are generated and extracted again. The rest of the
+// surface stays in the pool from earlier frames.
+void update_volume(App *app)
+{
+    std::vector<GLuint> surface_bricks;
+    std::vector<GLuint> centroid_bricks;
+    find_dirty_bricks(app, surface_bricks, centroid_bricks);
+    update_surface(app, surface_bricks);
+    update_centroid(app, centroid_bricks);
 }
 
 void update_sphere(App *app, mat4 mat_view)
@@ -285,19 +422,32 @@ void app_initialize(App *app)
 
     get_uniform_location(centroid, voxel_mode);
 
+    get_uniform_location(gather, brick_cells);
+
     glGenBuffers(1, &app->indirect_buffer);
     glGenBuffers(1, &app->index_buffer);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, app->index_buffer);
     glBufferData(GL_SHADER_STORAGE_BUFFER, N*N*N*sizeof(GLuint), 0, GL_STREAM_DRAW);
 
-    update_surface(app);
-    update_centroid(app);
+    // Every brick has a fixed slot in the pool, large
+    // enough to hold all of its cells.
+    std::vector<GLuint> counts(BRICKS*BRICKS*BRICKS, 0);
+    glGenBuffers(1, &app->surface_brick_buffer);
+    glGenBuffers(1, &app->centroid_brick_buffer);
+    glGenBuffers(1, &app->brick_pool_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, app->brick_pool_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, N*N*N*sizeof(GLuint), 0, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &app->brick_count_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, app->brick_count_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, counts.size() * sizeof(GLuint), counts.data(), GL_DYNAMIC_DRAW);
+
+    app->full_update = true;
+    update_volume(app);
 }
 
 void app_update_and_render(App *app)
 {
-    update_surface(app);
-    update_centroid(app);
+    update_volume(app);
 
     float aspect_ratio = app->window_width / (float)app->window_height;
     mat4 mat_projection = perspective(app->fov, aspect_ratio, app->z_near, app->z_far);
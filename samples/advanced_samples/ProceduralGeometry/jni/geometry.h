@@ -76,6 +76,10 @@ struct App
     GLuint u_generate_dimension;
     GLuint u_generate_time;
 
+    // Brick pool gathering shader
+    GLuint program_gather;
+    GLuint u_gather_brick_cells;
+
     // Geometry
     GLuint vao;
     GLuint vbo_point;
@@ -88,6 +92,18 @@ struct App
     GLuint indirect_buffer;
     GLuint index_buffer;
 
+    // Dirty brick tracking. Only the bricks whose part
+    // of the volume changed since the last frame are
+    // extracted again, into their slot of the pool.
+    GLuint surface_brick_buffer;
+    GLuint centroid_brick_buffer;
+    GLuint brick_pool_buffer;
+    GLuint brick_count_buffer;
+    bool full_update;
+    vec3 last_sphere_pos;
+    float last_sphere_radius;
+    float last_voxel_mode;
+
     // 2D textures
     GLuint tex_material;
 
@@ -129,6 +145,7 @@ void app_update_and_render(App *app);
 #define uniform2f(prog, name, x, y)   glUniform2f(app->u_##prog##_##name, x, y);
 #define uniform3fv(prog, name, value) glUniform3fv(app->u_##prog##_##name, 1, &value[0]);
 #define uniform1i(prog, name, value)  glUniform1i(app->u_##prog##_##name, value);
+#define uniform1ui(prog, name, value) glUniform1ui(app->u_##prog##_##name, value);
 #define uniformm4(prog, name, value)  glUniformMatrix4fv(app->u_##prog##_##name, 1, GL_FALSE, value.value_ptr());
 
 #endif
@@ -20,13 +20,60 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "ProgramBinaryCache.h"
+#include "AssetFile.h"
+#include "ImageUploadQueue.h"
+#include "JobScheduler.h"
 
-GLuint load_texture(const char *filename)
+// A texture whose image is decoded on a worker, see load_texture.
+struct PendingTexture
 {
+    const char *filename;
+    GLuint texture;
+    int width;
+    int height;
+};
+
+// Decode straight into the mapped pixel unpack buffer. stb_image
+// only decodes into memory it allocates, so this is the one copy
+// of the pixels, made on the worker.
+bool decode_texture(void *destination, size_t size, void *user_data)
+{
+    PendingTexture *pending = (PendingTexture*)user_data;
     int width, height, channels;
-    unsigned char *pixels = stbi_load(filename, &width, &height, &channels, 4);
-
+    unsigned char *pixels = stbi_load(pending->filename, &width, &height, &channels, 4);
     if (!pixels)
+        return false;
+
+    bool matches = width == pending->width && height == pending->height;
+    if (matches)
+        memcpy(destination, pixels, size);
+    stbi_image_free(pixels);
+    return matches;
+}
+
+void upload_texture(const void *pixels, bool decoded, void *user_data)
+{
+    PendingTexture *pending = (PendingTexture*)user_data;
+    if (!decoded)
+    {
+        LOGE("Failed to load texture %s\n", pending->filename);
+        exit(1);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, pending->texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, pending->width, pending->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Create an RGBA8 texture for an image. Only the header of the
+// image is read here: the pixels are decoded on a worker and
+// uploaded by uploads->finish(), which pending has to outlive.
+GLuint load_texture(const char *filename, MaliSDK::ImageUploadQueue *uploads, PendingTexture *pending)
+{
+    int width, height, channels;
+
+    if (!stbi_info(filename, &width, &height, &channels))
     {
         LOGE("Failed to load texture %s\n", filename);
         exit(1);
@@ -35,57 +82,34 @@ GLuint load_texture(const char *filename)
     GLuint result = 0;
     glGenTextures(1, &result);
     glBindTexture(GL_TEXTURE_2D, result);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glBindTexture(GL_TEXTURE_2D, 0);
-    stbi_image_free(pixels);
-    return result;
-}
 
-char *read_file(const char *filename)
-{
-    FILE *file = fopen(filename, "rb");
-    if (!file)
-    {
-        LOGE("Failed to open file %s\n", filename);
-        exit (1);
-    }
-    fseek(file, 0, SEEK_END);
-    long length = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    char *data = (char *)calloc(length + 1, sizeof(char));
-    if (!data)
-    {
-        LOGE("Failed to allocate memory for file data %s\n", filename);
-        exit(1);
-    }
-    size_t read = fread(data, sizeof(char), length, file);
-    if (read != length)
-    {
-        LOGE("Failed to read whole file %s\n", filename);
-        exit(1);
-    }
-    data[length] = '\0';
-    fclose(file);
-    return data;
+    pending->filename = filename;
+    pending->texture = result;
+    pending->width = width;
+    pending->height = height;
+    uploads->add((size_t)width * height * 4, decode_texture, upload_texture, pending);
+    return result;
 }
 
-GLuint compile_shader(const char *source, GLenum type)
+GLuint compile_shader(const char *source, GLint length, GLenum type)
 {
     GLuint result = glCreateShader(type);
-    glShaderSource(result, 1, (const GLchar**)&source, NULL);
+    glShaderSource(result, 1, (const GLchar**)&source, &length);
     glCompileShader(result);
     GLint status;
     glGetShaderiv(result, GL_COMPILE_STATUS, &status);
     if (status == GL_FALSE) {
-        GLint length;
-        glGetShaderiv(result, GL_INFO_LOG_LENGTH, &length);
-        GLchar *info = new GLchar[length];
-        glGetShaderInfoLog(result, length, NULL, info);
-        LOGE("[COMPILE] %s\n%s\n", source, info);
+        GLint logLength;
+        glGetShaderiv(result, GL_INFO_LOG_LENGTH, &logLength);
+        GLchar *info = new GLchar[logLength];
+        glGetShaderInfoLog(result, logLength, NULL, info);
+        LOGE("[COMPILE] %.*s\n%s\n", (int)length, source, info);
         delete[] info;
         exit(1);
     }
@@ -98,6 +122,7 @@ GLuint link_program(GLuint *shaders, int count)
     for (int i = 0; i < count; ++i)
         glAttachShader(program, shaders[i]);
 
+    MaliSDK::ProgramBinaryCache::prepareProgram(program);
     glLinkProgram(program);
 
     for (int i = 0; i < count; ++i)
@@ -117,67 +142,95 @@ GLuint link_program(GLuint *shaders, int count)
     return program;
 }
 
-void load_backdrop_shader(App *app)
+
+// Compiles and links a program from the given shader files, unless a binary
+// from a previous run of the same sources on the same driver is cached.
+// The sources are used straight from the mapped files, without a copy.
+GLuint load_program(const char **paths, const GLenum *types, int count)
 {
-    char *vs_src = read_file(SHADER_PATH("backdrop.vs"));
-    char *fs_src = read_file(SHADER_PATH("backdrop.fs"));
+    MaliSDK::AssetFile files[5];
+    const char *sources[5];
+    size_t lengths[5];
+    for (int i = 0; i < count; ++i)
+    {
+        if (!files[i].open(paths[i]))
+        {
+            LOGE("Failed to open file %s\n", paths[i]);
+            exit(1);
+        }
+        sources[i] = (const char *)files[i].getData();
+        lengths[i] = files[i].getSize();
+    }
 
-    GLuint shaders[2];
-    shaders[0] = compile_shader(vs_src, GL_VERTEX_SHADER);
-    shaders[1] = compile_shader(fs_src, GL_FRAGMENT_SHADER);
-    app->program_backdrop = link_program(shaders, 2);
+    unsigned long long key = MaliSDK::ProgramBinaryCache::computeKey(sources, lengths, count);
+    GLuint program = glCreateProgram();
+    if (MaliSDK::ProgramBinaryCache::loadProgram(program, key))
+        return program;
+    glDeleteProgram(program);
 
-    LOGD("%s\n", vs_src);
-    LOGD("%s\n", fs_src);
+    GLuint shaders[5];
+    for (int i = 0; i < count; ++i)
+        shaders[i] = compile_shader(sources[i], (GLint)lengths[i], types[i]);
+
+    program = link_program(shaders, count);
 
-    free(vs_src);
-    free(fs_src);
+    for (int i = 0; i < count; ++i)
+        glDeleteShader(shaders[i]);
+
+    MaliSDK::ProgramBinaryCache::storeProgram(program, key);
+    return program;
+}
+
+void load_backdrop_shader(App *app)
+{
+    const char *paths[] = { SHADER_PATH("backdrop.vs"), SHADER_PATH("backdrop.fs") };
+    const GLenum types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+    app->program_backdrop = load_program(paths, types, 2);
 }
 
 void load_geometry_shader(App *app)
 {
-    char *vs_src = read_file(SHADER_PATH("geometry.vs"));
-    char *fs_src = read_file(SHADER_PATH("geometry.fs"));
-    char *gs_src = read_file(SHADER_PATH("geometry.gs"));
-
-    GLuint shaders[] = {
-        compile_shader(vs_src, GL_VERTEX_SHADER),
-        compile_shader(fs_src, GL_FRAGMENT_SHADER),
-        compile_shader(gs_src, GL_GEOMETRY_SHADER)
-    };
-    app->program_geometry = link_program(shaders, 3);
-
-    free(vs_src);
-    free(fs_src);
-    free(gs_src);
+    const char *paths[] = { SHADER_PATH("geometry.vs"), SHADER_PATH("geometry.fs"), SHADER_PATH("geometry.gs") };
+    const GLenum types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+    app->program_geometry = load_program(paths, types, 3);
 }
 
 void load_centroid_shader(App *app)
 {
-    char *cs_src = read_file(SHADER_PATH("centroid.cs"));
-
-    GLuint shaders[] = { compile_shader(cs_src, GL_COMPUTE_SHADER) };
-    app->program_centroid = link_program(shaders, 1);
-
-    free(cs_src);
+    const char *paths[] = { SHADER_PATH("centroid.cs") };
+    const GLenum types[] = { GL_COMPUTE_SHADER };
+    app->program_centroid = load_program(paths, types, 1);
 }
 
 void load_generate_shader(App *app)
 {
-    char *cs_src = read_file(SHADER_PATH("generate.cs"));
-
-    GLuint shaders[] = { compile_shader(cs_src, GL_COMPUTE_SHADER) };
-    app->program_generate = link_program(shaders, 1);
+    const char *paths[] = { SHADER_PATH("generate.cs") };
+    const GLenum types[] = { GL_COMPUTE_SHADER };
+    app->program_generate = load_program(paths, types, 1);
+}
 
-    free(cs_src);
+void load_gather_shader(App *app)
+{
+    const char *paths[] = { SHADER_PATH("gather.cs") };
+    const GLenum types[] = { GL_COMPUTE_SHADER };
+    app->program_gather = load_program(paths, types, 1);
 }
 
 void load_assets(App *app)
 {
+    // The texture is decoded on a worker while the shaders compile.
+    MaliSDK::JobScheduler scheduler;
+    scheduler.initialize(1);
+    MaliSDK::ImageUploadQueue uploads(&scheduler);
+    PendingTexture material;
+
+    app->tex_material = load_texture(TEXTURE_PATH("texture11.jpg"), &uploads, &material);
+
     load_geometry_shader(app);
     load_centroid_shader(app);
     load_generate_shader(app);
+    load_gather_shader(app);
     load_backdrop_shader(app);
 
-    app->tex_material = load_texture(TEXTURE_PATH("texture11.jpg"));
+    uploads.finish();
 }
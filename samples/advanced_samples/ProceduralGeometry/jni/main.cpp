@@ -79,6 +79,7 @@ extern "C"
         start_time.tv_usec = 0;
         gettimeofday(&start_time, NULL);
 
+        MaliSDK::ProgramBinaryCache::setDirectory(BASE_ASSET_PATH);
         LOGD("Load assets\n");
         load_assets(&app);
         app_initialize(&app);
@@ -50,6 +50,7 @@ public class ProceduralGeometry extends Activity {
 
         extractAsset("generate.cs");
         extractAsset("centroid.cs");
+        extractAsset("gather.cs");
 
         extractAsset("geometry.vs");
         extractAsset("geometry.gs");
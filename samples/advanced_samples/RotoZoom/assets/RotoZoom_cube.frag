@@ -18,15 +18,16 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#version 100
+#version 300 es
 precision mediump float;
 
 uniform sampler2D u_s2dTexture;
 
-varying vec2 v_v2TexCoord;
+in vec2 v_v2TexCoord;
+
+out vec4 fragColor;
 
 void main()
 {
-    vec4 v4Texel = texture2D(u_s2dTexture, v_v2TexCoord);
-    gl_FragColor = v4Texel;
+    fragColor = texture(u_s2dTexture, v_v2TexCoord);
 }
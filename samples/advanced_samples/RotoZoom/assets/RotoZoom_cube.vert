@@ -18,17 +18,30 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#version 100
+#version 300 es
 
-attribute vec4 a_v4Position;
-attribute vec2 a_v2TexCoord;
+in vec4 a_v4Position;
+in vec2 a_v2TexCoord;
 
-uniform mat4 u_m4Texture;
+/* Written once a frame through a ring of uniform buffers, the texture matrix is built here from it. */
+layout(std140) uniform RotoZoom
+{
+    /* Angle of the texture and angle of its offset from the centre, in radians, then the zoom. */
+    vec4 u_v4Animation;
+    /* Scale from the quad to the texture at a zoom of 1, one texel per pixel. */
+    vec4 u_v4Scale;
+};
 
-varying vec2 v_v2TexCoord;
+out vec2 v_v2TexCoord;
 
 void main()
 {
-    v_v2TexCoord = vec2(u_m4Texture * vec4(a_v2TexCoord, 0.0, 1.0));;
+    /* The same as translating, zooming, offsetting then rotating about the centre of the texture. */
+    vec2 offset = vec2(-sin(u_v4Animation.y), cos(u_v4Animation.y));
+    float cosine = cos(u_v4Animation.x);
+    float sine = sin(u_v4Animation.x);
+    mat2 rotation = mat2(cosine, sine, -sine, cosine);
+
+    v_v2TexCoord = vec2(0.5) + rotation * (offset + u_v4Animation.z * u_v4Scale.xy * (a_v2TexCoord - vec2(0.5)));
     gl_Position = a_v4Position;
 }
@@ -0,0 +1,50 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#version 300 es
+precision highp float;
+
+/* See VirtualTexture.h. */
+uniform vec4 u_vtParameters;
+uniform float u_vtLodBias;
+
+in vec2 v_v2TexCoord;
+
+out vec4 fragColour;
+
+float virtualTextureLevel(vec2 uv)
+{
+    vec2 texels = uv * u_vtParameters.x * u_vtParameters.y;
+    vec2 dx = dFdx(texels);
+    vec2 dy = dFdy(texels);
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + u_vtLodBias;
+
+    return clamp(floor(lod), 0.0, log2(u_vtParameters.x));
+}
+
+/* The page and level RotoZoom_virtual.frag samples here, for VirtualTexture to stream in. */
+void main()
+{
+    float level = virtualTextureLevel(v_v2TexCoord);
+    float levelPages = u_vtParameters.x / exp2(level);
+    vec2 page = floor(min(fract(v_v2TexCoord) * levelPages, levelPages - 1.0));
+
+    fragColour = vec4(page, level, 255.0) / 255.0;
+}
@@ -0,0 +1,61 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#version 300 es
+precision highp float;
+
+/* See VirtualTexture.h. */
+uniform highp sampler2D u_vtIndirection;
+uniform highp sampler2D u_vtPhysical;
+uniform vec4 u_vtParameters;
+uniform float u_vtLodBias;
+
+in vec2 v_v2TexCoord;
+
+out vec4 fragColour;
+
+/* The level the hardware would have picked, from the derivatives of the coordinates before they wrap. */
+float virtualTextureLevel(vec2 uv)
+{
+    vec2 texels = uv * u_vtParameters.x * u_vtParameters.y;
+    vec2 dx = dFdx(texels);
+    vec2 dy = dFdy(texels);
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + u_vtLodBias;
+
+    return clamp(floor(lod), 0.0, log2(u_vtParameters.x));
+}
+
+void main()
+{
+    float level = virtualTextureLevel(v_v2TexCoord);
+    vec2 uv = fract(v_v2TexCoord);
+
+    /* The page wanted, which points to itself or to the resident ancestor standing in for it. */
+    float levelPages = u_vtParameters.x / exp2(level);
+    ivec2 page = ivec2(min(uv * levelPages, levelPages - 1.0));
+    vec4 entry = texelFetch(u_vtIndirection, page, int(level)) * 255.0;
+
+    /* Where uv lands in the resident page, past its border. */
+    float residentPages = u_vtParameters.x / exp2(entry.z);
+    vec2 texel = entry.xy * (u_vtParameters.y + 2.0 * u_vtParameters.z) + u_vtParameters.z
+               + fract(uv * residentPages) * u_vtParameters.y;
+
+    fragColour = textureLod(u_vtPhysical, texel / u_vtParameters.w, 0.0);
+}
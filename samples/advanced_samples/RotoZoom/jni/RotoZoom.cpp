@@ -19,13 +19,15 @@
  */
 
  
-#include <GLES2/gl2.h>
-#include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
 
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
 #include <string>
+#include <vector>
 
 #include <jni.h>
 #include <android/log.h>
@@ -38,31 +40,73 @@
 #include "Matrix.h"
 #include "Platform.h"
 #include "Mathematics.h"
+#include "AssetFile.h"
+#include "JobScheduler.h"
+#include "VirtualTexture.h"
+#include "VirtualTextureWriter.h"
+#include "TextureFormatSelector.h"
+#include "UniformBufferRing.h"
+#include "SamplerCache.h"
+#include "StartupProfiler.h"
 
 using std::string;
 using namespace MaliSDK;
 
 /* Asset directories and filenames. */
 string resourceDirectory = "/data/data/com.arm.malideveloper.openglessdk.rotozoom/";
-string textureFilename = "RotoZoom.raw";
+string textureFilename = "RotoZoom.ktx";
+string textureBaseName = "RotoZoom";
 string vertexShaderFilename = "RotoZoom_cube.vert";
 string fragmentShaderFilename = "RotoZoom_cube.frag";
+string virtualVertexShaderFilename = "RotoZoom_virtual.vert";
+string virtualFragmentShaderFilename = "RotoZoom_virtual.frag";
+string feedbackFragmentShaderFilename = "RotoZoom_feedback.frag";
+string virtualTextureFilename = "RotoZoom.vt";
 
 /* Texture variables. */
 GLuint textureID = 0;
+KTXTextureInfo textureInfo;
+TextureFormatSelector::Family textureFamily = TextureFormatSelector::FAMILY_UNCOMPRESSED;
 
 /* Shader variables. */
 GLuint programID = 0;
-GLint iLocTextureMatrix = -1;
 GLint iLocPosition = -1;
-GLint iLocTextureMix = -1;
 GLint iLocTexture = -1;
 GLint iLocTexCoord = -1;
 
+/* The animation of the plain texture, the only uniforms of its program, as laid out by std140. */
+struct RotoZoomConstants
+{
+    float animation[4];
+    float scale[4];
+};
+
+/* Each frame writes its constants to a new region, so the GPU can still read those of the frames before. */
+UniformBufferRing *uniformRing = NULL;
+
 /* Animation variables. */
 Matrix translation;
-Matrix scale;
+float textureScale[2];
 Matrix negativeTranslation;
+float framesPerSecond = 0.0f;
+
+/*
+ * The sample cycles through what it draws, a few seconds each, so the frame rates can be compared:
+ * the virtual texture once baked, then the cached texture with trilinear and with anisotropic filtering.
+ */
+enum DrawMode
+{
+    DRAW_VIRTUAL_TEXTURE,
+    DRAW_TRILINEAR,
+    DRAW_ANISOTROPIC,
+    NUMBER_OF_DRAW_MODES
+};
+#define DRAW_MODE_SECONDS 10.0f
+#define ANISOTROPY 16.0f
+bool anisotropySupported = false;
+int drawMode = DRAW_TRILINEAR;
+Timer timer;
+float drawModeStart = 0.0f;
 
 int windowWidth = -1;
 int windowHeight = -1;
@@ -70,6 +114,235 @@ int windowHeight = -1;
 /* A text object to draw text on the screen. */
 Text* text;
 
+/*
+ * A mosaic of 15 by 15 tinted copies of the texture, 3840 texels square, streamed in 120 texel pages into
+ * 16 by 16 slots of 128 texels: 2 MB of ETC2 for the 11 MB of the whole mip chain. There is no room for it in
+ * the APK, so it is baked on a job the first time the sample runs, and the plain texture is drawn until then.
+ */
+#define VIRTUAL_TEXTURE_PAGE_SIZE 120
+#define VIRTUAL_TEXTURE_BORDER 4
+#define VIRTUAL_TEXTURE_LEVELS 6
+#define MOSAIC_TILES 15
+VirtualTexture virtualTexture;
+JobScheduler jobScheduler;
+JobScheduler::Job *bakeJob = NULL;
+std::atomic<bool> bakeFinished(false);
+
+GLuint virtualProgramID = 0;
+GLuint feedbackProgramID = 0;
+unsigned int virtualFrames = 0;
+
+/* The RotoZoom texture and its mip levels as RGB, which the levels of the mosaic are made of. */
+struct Mosaic
+{
+    std::vector<unsigned char> levels[VIRTUAL_TEXTURE_LEVELS];
+    unsigned char tints[MOSAIC_TILES][MOSAIC_TILES][3];
+};
+
+/* Mip levels of the mosaic are mip levels of the texture, as the tiles are aligned to every level. */
+static void getMosaicRegion(int level, int x, int y, int width, int height, unsigned char *rgb, void *userData)
+{
+    const Mosaic *mosaic = (const Mosaic *)userData;
+    int tileSize = 256 >> level;
+    const unsigned char *tile = &mosaic->levels[level][0];
+
+    for (int row = 0; row < height; row++)
+    {
+        for (int column = 0; column < width; column++)
+        {
+            int texelX = x + column;
+            int texelY = y + row;
+            const unsigned char *texel = tile + ((texelY % tileSize) * tileSize + texelX % tileSize) * 3;
+            const unsigned char *tint = mosaic->tints[texelY / tileSize][texelX / tileSize];
+
+            for (int channel = 0; channel < 3; channel++)
+            {
+                *rgb++ = (unsigned char)(texel[channel] * tint[channel] / 255);
+            }
+        }
+    }
+}
+
+/* Bake job, the file is the same on every run so it is only written once. */
+static void bakeVirtualTexture(void *userData)
+{
+    AssetFile source;
+    Mosaic *mosaic = new Mosaic;
+
+    /* The texels of the universal source of the texture, after the 64 bytes of its header and the size of its base level. */
+    const size_t texelsOffset = 64 + 4;
+
+    if (source.open((resourceDirectory + textureFilename).c_str()) && source.getSize() >= texelsOffset + 256 * 256 * 4)
+    {
+        mosaic->levels[0].resize(256 * 256 * 3);
+        for (int texel = 0; texel < 256 * 256; texel++)
+        {
+            memcpy(&mosaic->levels[0][texel * 3], source.getData() + texelsOffset + texel * 4, 3);
+        }
+
+        for (int level = 1; level < VIRTUAL_TEXTURE_LEVELS; level++)
+        {
+            int size = 256 >> level;
+            const unsigned char *finer = &mosaic->levels[level - 1][0];
+
+            mosaic->levels[level].resize(size * size * 3);
+            for (int y = 0; y < size; y++)
+            {
+                for (int x = 0; x < size; x++)
+                {
+                    for (int channel = 0; channel < 3; channel++)
+                    {
+                        int sum = finer[((2 * y) * size * 2 + 2 * x) * 3 + channel] + finer[((2 * y) * size * 2 + 2 * x + 1) * 3 + channel]
+                                + finer[((2 * y + 1) * size * 2 + 2 * x) * 3 + channel] + finer[((2 * y + 1) * size * 2 + 2 * x + 1) * 3 + channel];
+                        mosaic->levels[level][(y * size + x) * 3 + channel] = (unsigned char)((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+
+        for (int tileY = 0; tileY < MOSAIC_TILES; tileY++)
+        {
+            for (int tileX = 0; tileX < MOSAIC_TILES; tileX++)
+            {
+                mosaic->tints[tileY][tileX][0] = (unsigned char)(160 + 95 * sinf(tileX * 0.9f));
+                mosaic->tints[tileY][tileX][1] = (unsigned char)(160 + 95 * sinf(tileY * 0.7f + 1.0f));
+                mosaic->tints[tileY][tileX][2] = (unsigned char)(160 + 95 * sinf((tileX + tileY) * 0.5f + 2.0f));
+            }
+        }
+
+        VirtualTextureWriter::write((resourceDirectory + virtualTextureFilename).c_str(), VIRTUAL_TEXTURE_PAGE_SIZE,
+                                    VIRTUAL_TEXTURE_BORDER, VIRTUAL_TEXTURE_LEVELS, true, getMosaicRegion, mosaic);
+    }
+
+    delete mosaic;
+    bakeFinished.store(true);
+}
+
+static GLuint createProgram(const string &vertexShaderPath, const string &fragmentShaderPath)
+{
+    GLuint vertexShaderID = 0;
+    GLuint fragmentShaderID = 0;
+    Shader::processShader(&vertexShaderID, vertexShaderPath.c_str(), GL_VERTEX_SHADER);
+    Shader::processShader(&fragmentShaderID, fragmentShaderPath.c_str(), GL_FRAGMENT_SHADER);
+
+    GLuint program = GL_CHECK(glCreateProgram());
+    GL_CHECK(glAttachShader(program, vertexShaderID));
+    GL_CHECK(glAttachShader(program, fragmentShaderID));
+    /* Both programs draw the same quad with the same attributes. */
+    GL_CHECK(glBindAttribLocation(program, 0, "a_v4Position"));
+    GL_CHECK(glBindAttribLocation(program, 1, "a_v2TexCoord"));
+    GL_CHECK(glLinkProgram(program));
+
+    return program;
+}
+
+/* Draw the quad through the virtual texture, after drawing it into the feedback of the pages it needs. */
+static void drawVirtualTexture(Matrix &textureMovement)
+{
+    virtualTexture.update();
+
+    GL_CHECK(glEnableVertexAttribArray(0));
+    GL_CHECK(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, quadVertices));
+    GL_CHECK(glEnableVertexAttribArray(1));
+    GL_CHECK(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, quadTextureCoordinates));
+
+    /* [Feedback pass.] */
+    virtualTexture.bindFeedbackFramebuffer(windowWidth, windowHeight);
+    GL_CHECK(glUseProgram(feedbackProgramID));
+    virtualTexture.setUniforms(feedbackProgramID, true);
+    GL_CHECK(glUniformMatrix4fv(glGetUniformLocation(feedbackProgramID, "u_m4Texture"), 1, GL_FALSE, textureMovement.getAsArray()));
+    GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, sizeof(quadIndices) / sizeof(GLubyte), GL_UNSIGNED_BYTE, quadIndices));
+    virtualTexture.readFeedback();
+    /* [Feedback pass.] */
+
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GL_CHECK(glViewport(0, 0, windowWidth, windowHeight));
+    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+    /* [Draw through the virtual texture.] */
+    GL_CHECK(glUseProgram(virtualProgramID));
+    virtualTexture.bind();
+    virtualTexture.setUniforms(virtualProgramID, false);
+    GL_CHECK(glUniformMatrix4fv(glGetUniformLocation(virtualProgramID, "u_m4Texture"), 1, GL_FALSE, textureMovement.getAsArray()));
+    GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, sizeof(quadIndices) / sizeof(GLubyte), GL_UNSIGNED_BYTE, quadIndices));
+    /* [Draw through the virtual texture.] */
+
+    /* Show how much of the texture is in GPU memory, once a second or so. */
+    if (virtualFrames++ % 60 == 0)
+    {
+        char status[128];
+        sprintf(status, "%d pages resident, %u streamed: %.1f fps", virtualTexture.getNumberOfResidentPages(), virtualTexture.getNumberOfPagesLoaded(), framesPerSecond);
+        text->clear();
+        text->addString(0, 0, "Virtual texture RotoZoom Example", 255, 255, 255, 255);
+        text->addString(0, 16, status, 255, 255, 255, 255);
+    }
+}
+
+/* Draw the quad with the cached texture, the vertex shader computing the animation from the constants in the ring. */
+static void drawCachedTexture(float angleZTexture, float angleZOffset, float angleZoom)
+{
+    /* [Write the constants of the frame.] */
+    uniformRing->beginFrame();
+    GLintptr constantsOffset = 0;
+    RotoZoomConstants *constants = static_cast<RotoZoomConstants *>(uniformRing->allocate(sizeof(RotoZoomConstants), &constantsOffset));
+    constants->animation[0] = degreesToRadians(angleZTexture);
+    constants->animation[1] = degreesToRadians(angleZOffset);
+    constants->animation[2] = sinf(degreesToRadians(angleZoom)) * 0.75f + 1.25f;
+    constants->animation[3] = 0.0f;
+    constants->scale[0] = textureScale[0];
+    constants->scale[1] = textureScale[1];
+    constants->scale[2] = 0.0f;
+    constants->scale[3] = 0.0f;
+    uniformRing->flush();
+    uniformRing->bindRange(0, constantsOffset, sizeof(RotoZoomConstants));
+    /* [Write the constants of the frame.] */
+
+    /* Select our shader program. */
+    GL_CHECK(glUseProgram(programID));
+
+    /* Set up vertex positions. */
+    GL_CHECK(glEnableVertexAttribArray(iLocPosition));
+    GL_CHECK(glVertexAttribPointer(iLocPosition, 3, GL_FLOAT, GL_FALSE, 0, quadVertices));
+
+    /* And texture coordinate data. */
+    if(iLocTexCoord != -1)
+    {
+        GL_CHECK(glEnableVertexAttribArray(iLocTexCoord));
+        GL_CHECK(glVertexAttribPointer(iLocTexCoord, 2, GL_FLOAT, GL_FALSE, 0, quadTextureCoordinates));
+    }
+
+    /* Reset viewport to the EGL window surface's dimensions. */
+    GL_CHECK(glViewport(0, 0, windowWidth, windowHeight));
+
+    /* Clear the screen on the EGL surface. */
+    GL_CHECK(glClearColor(1.0f, 1.0f, 0.0f, 1.0));
+    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+    /* Ensure the correct texture is bound to texture unit 0, sampled through the mip levels of the file. */
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, textureID));
+    SamplerCache::bind(0, SamplerState::trilinear(GL_REPEAT, drawMode == DRAW_ANISOTROPIC ? ANISOTROPY : 1.0f));
+
+    /* And draw. */
+    GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, sizeof(quadIndices) / sizeof(GLubyte), GL_UNSIGNED_BYTE, quadIndices));
+
+    /* The virtual texture sets the filtering of its own textures. */
+    SamplerCache::unbind(0);
+    uniformRing->endFrame();
+
+    /* Show what is drawn and how fast, once a second or so. */
+    static unsigned int cachedFrames = 0;
+    if (cachedFrames++ % 60 == 0)
+    {
+        char status[128];
+        sprintf(status, "%s %dx%d, %s: %.1f fps", textureFamily == TextureFormatSelector::FAMILY_UNCOMPRESSED ? "RGBA8" : "Compressed",
+                textureInfo.width, textureInfo.height, drawMode == DRAW_ANISOTROPIC ? "anisotropic" : "trilinear", framesPerSecond);
+        text->clear();
+        text->addString(0, 0, "Simple RotoZoom Example", 255, 255, 255, 255);
+        text->addString(0, 16, status, 255, 255, 255, 255);
+    }
+}
+
 bool setupGraphics(int width, int height)
 {
     /* Height and width of the texture being used. */
@@ -80,14 +353,15 @@ bool setupGraphics(int width, int height)
     windowHeight = height;
     
     /* Full paths to the shader and texture files */
-    string texturePath = resourceDirectory + textureFilename;   
+    string textureBasePath = resourceDirectory + textureBaseName;
     string vertexShaderPath = resourceDirectory + vertexShaderFilename; 
     string fragmentShaderPath = resourceDirectory + fragmentShaderFilename;
 
     /* Initialize matrices. */
     /* Make scale matrix to centre texture on screen. */
     translation = Matrix::createTranslation(0.5f, 0.5f, 0.0f);
-    scale = Matrix::createScaling(width / (float)textureWidth, height / (float)textureHeight, 1.0f); /* 2.0 makes it smaller, 0.5 makes it bigger. */
+    textureScale[0] = width / (float)textureWidth; /* 2.0 makes it smaller, 0.5 makes it bigger. */
+    textureScale[1] = height / (float)textureHeight;
     negativeTranslation = Matrix::createTranslation(-0.5f, -0.5f, 0.0f);
 
     /* Initialize OpenGL ES. */
@@ -102,20 +376,21 @@ bool setupGraphics(int width, int height)
     text = new Text(resourceDirectory.c_str(), windowWidth, windowHeight);
     text->addString(0, 0, "Simple RotoZoom Example", 255, 255, 255, 255);
 
-    /* Load just base level texture data. */
-    GL_CHECK(glGenTextures(1, &textureID));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, textureID));
-    unsigned char *textureData = NULL;
-    Texture::loadData(texturePath.c_str(), &textureData);
-        
-    GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 256, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData));        
-
-    /* Set texture mode. */
-    GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR)); /* Default anyway. */
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+    /*
+     * [Load the cached texture.]
+     * The first run encodes the texture and its box filtered mip levels to ETC2, a quarter of the bandwidth of
+     * RGBA8, and stores them next to the source, so later runs only load the compressed file.
+     */
+    TextureFormatSelector::setCacheDirectory(resourceDirectory.c_str());
+    if (!TextureFormatSelector::loadTexture(textureBasePath.c_str(), &textureID, &textureInfo, &textureFamily))
+    {
+        return false;
+    }
+    /* [Load the cached texture.] */
+
+    /* Filtering and wrapping come from the sampler bound to the unit when drawing. */
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    anisotropySupported = extensions != NULL && strstr(extensions, "GL_EXT_texture_filter_anisotropic") != NULL;
 
     /* Process shaders. */
     GLuint vertexShaderID = 0;
@@ -161,16 +436,36 @@ bool setupGraphics(int width, int height)
         GL_CHECK(glEnableVertexAttribArray(iLocTexCoord));
     }
 
-    /* Texture matrix. */
-    iLocTextureMatrix = GL_CHECK(glGetUniformLocation(programID, "u_m4Texture"));
-    if(iLocTextureMatrix == -1)
+    /* Animation, from the uniform buffers of the ring bound to binding point 0. */
+    GLuint blockIndex = GL_CHECK(glGetUniformBlockIndex(programID, "RotoZoom"));
+    if(blockIndex == GL_INVALID_INDEX)
     {
-        LOGD("Warning: Uniform not found at %s:%i\n", __FILE__, __LINE__);
+        LOGE("Uniform block not found at %s:%i\n", __FILE__, __LINE__);
+        return false;
     }
-    else
+    GL_CHECK(glUniformBlockBinding(programID, blockIndex, 0));
+
+    delete uniformRing;
+    /* Double buffered: the constants of a frame are written while the GPU may still draw the previous one. */
+    uniformRing = new UniformBufferRing(sizeof(RotoZoomConstants), 2);
+
+    /* [Set up the virtual texture.] */
+    virtualProgramID = createProgram(resourceDirectory + virtualVertexShaderFilename, resourceDirectory + virtualFragmentShaderFilename);
+    feedbackProgramID = createProgram(resourceDirectory + virtualVertexShaderFilename, resourceDirectory + feedbackFragmentShaderFilename);
+
+    if (bakeJob == NULL && !virtualTexture.initialize((resourceDirectory + virtualTextureFilename).c_str(), 16, 8, &jobScheduler))
     {
-        GL_CHECK(glUniformMatrix4fv(iLocTextureMatrix, 1, GL_FALSE, scale.getAsArray()));
+        /* The first run, bake the file without holding up the first frames. */
+        if (jobScheduler.getNumberOfWorkers() == 0)
+        {
+            jobScheduler.initialize(1);
+        }
+
+        bakeFinished.store(false);
+        bakeJob = jobScheduler.create("bake_virtual_texture", bakeVirtualTexture, NULL);
+        jobScheduler.submit(bakeJob);
     }
+    /* [Set up the virtual texture.] */
     
     return true;
 }
@@ -182,56 +477,60 @@ void renderFrame(void)
     static float angleZoom = 0.0f;
     static Vec4f radius = {0.0f, 1.0f, 0.0f, 1.0f};
 
-    /* Select our shader program. */
-    GL_CHECK(glUseProgram(programID));
-
-    /* Set up vertex positions. */
-    GL_CHECK(glEnableVertexAttribArray(iLocPosition));
-    GL_CHECK(glVertexAttribPointer(iLocPosition, 3, GL_FLOAT, GL_FALSE, 0, quadVertices));
+    /* Counts the frames, so call it every frame. */
+    framesPerSecond = timer.getFPS();
 
-    /* And texture coordinate data. */
-    if(iLocTexCoord != -1)
+    if (bakeJob != NULL && bakeFinished.load())
     {
-        GL_CHECK(glEnableVertexAttribArray(iLocTexCoord));
-        GL_CHECK(glVertexAttribPointer(iLocTexCoord, 2, GL_FLOAT, GL_FALSE, 0, quadTextureCoordinates));
+        jobScheduler.wait(bakeJob);
+        bakeJob = NULL;
+        virtualTexture.initialize((resourceDirectory + virtualTextureFilename).c_str(), 16, 8, &jobScheduler);
     }
 
-    /* Reset viewport to the EGL window surface's dimensions. */
-    GL_CHECK(glViewport(0, 0, windowWidth, windowHeight));
-
-    /* Clear the screen on the EGL surface. */
-    GL_CHECK(glClearColor(1.0f, 1.0f, 0.0f, 1.0));
-    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-
-    /* Construct a rotation matrix for rotating the texture about its centre. */
-    Matrix rotateTextureZ = Matrix::createRotationZ(angleZTexture);
-
-    Matrix rotateOffsetZ = Matrix::createRotationZ(angleZOffset);
-
-    Vec4f offset = Matrix::vertexTransform(&radius, &rotateOffsetZ);
-
-    /* Construct offset translation. */
-    Matrix translateTexture = Matrix::createTranslation(offset.x, offset.y, offset.z);
-
-    /* Construct zoom matrix. */
-    Matrix zoom = Matrix::createScaling(sinf(degreesToRadians(angleZoom)) * 0.75f + 1.25f, sinf(degreesToRadians(angleZoom)) * 0.75f + 1.25f, 1.0f);
-
-    /* Create texture matrix. Operations happen bottom-up order. */
-    Matrix textureMovement = Matrix::identityMatrix * translation; /* Translate texture back to original position. */
-    textureMovement = textureMovement * rotateTextureZ;            /* Rotate texture about origin. */
-    textureMovement = textureMovement * translateTexture;          /* Translate texture away from origin. */
-    textureMovement = textureMovement * zoom;                      /* Zoom the texture. */
-    textureMovement = textureMovement * scale;                     /* Scale texture down in size from fullscreen to 1:1. */
-    textureMovement = textureMovement * negativeTranslation;       /* Translate texture to be centred on origin. */
-
-    GL_CHECK(glUniformMatrix4fv(iLocTextureMatrix, 1, GL_FALSE, textureMovement.getAsArray()));
-
-    /* Ensure the correct texture is bound to texture unit 0. */
-    GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, textureID));
+    /* Move on to the next draw mode every few seconds, skipping the ones the device or the bake are not ready for. */
+    float time = timer.getTime();
+    if (time - drawModeStart > DRAW_MODE_SECONDS)
+    {
+        drawModeStart = time;
+        do
+        {
+            drawMode = (drawMode + 1) % NUMBER_OF_DRAW_MODES;
+        }
+        while ((drawMode == DRAW_VIRTUAL_TEXTURE && !virtualTexture.isInitialized()) ||
+               (drawMode == DRAW_ANISOTROPIC && !anisotropySupported));
+    }
 
-    /* And draw. */
-    GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, sizeof(quadIndices) / sizeof(GLubyte), GL_UNSIGNED_BYTE, quadIndices));
+    if (drawMode == DRAW_VIRTUAL_TEXTURE && virtualTexture.isInitialized())
+    {
+        /* Construct a rotation matrix for rotating the texture about its centre. */
+        Matrix rotateTextureZ = Matrix::createRotationZ(angleZTexture);
+
+        Matrix rotateOffsetZ = Matrix::createRotationZ(angleZOffset);
+
+        Vec4f offset = Matrix::vertexTransform(&radius, &rotateOffsetZ);
+
+        /* Construct offset translation. */
+        Matrix translateTexture = Matrix::createTranslation(offset.x, offset.y, offset.z);
+
+        /*
+         * The same movement over the mosaic, zooming from one texel per pixel out to the whole mosaic on screen,
+         * so the levels streamed in change all the time.
+         */
+        float virtualZoom = powf(2.0f, sinf(degreesToRadians(angleZoom)) + 1.0f);
+        Matrix virtualScale = Matrix::createScaling(windowWidth * virtualZoom / virtualTexture.getSize(),
+                                                    windowHeight * virtualZoom / virtualTexture.getSize(), 1.0f);
+        Matrix virtualMovement = Matrix::identityMatrix * translation;
+        virtualMovement = virtualMovement * rotateTextureZ;
+        virtualMovement = virtualMovement * translateTexture;
+        virtualMovement = virtualMovement * virtualScale;
+        virtualMovement = virtualMovement * negativeTranslation;
+
+        drawVirtualTexture(virtualMovement);
+    }
+    else
+    {
+        drawCachedTexture(angleZTexture, angleZOffset, angleZoom);
+    }
 
     /* Draw any text. */
     text->draw();
@@ -256,23 +555,43 @@ extern "C"
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_rotozoom_RotoZoom_init
     (JNIEnv *env, jclass jcls, jint width, jint height)
     {
+        /* Cold start breakdown, logged after the first frame. */
+        StartupProfiler::start();
+
         /* Make sure that all resource files are in place. */
+        StartupProfiler::beginPhase(StartupProfiler::PHASE_ASSET_IO);
         AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), vertexShaderFilename.c_str());
         AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), fragmentShaderFilename.c_str());
         AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), textureFilename.c_str());
+        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), virtualVertexShaderFilename.c_str());
+        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), virtualFragmentShaderFilename.c_str());
+        AndroidPlatform::getAndroidAsset(env, resourceDirectory.c_str(), feedbackFragmentShaderFilename.c_str());
+        StartupProfiler::endPhase();
 
         setupGraphics(width, height);
+        StartupProfiler::endInit();
     }
 
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_rotozoom_RotoZoom_step
     (JNIEnv *env, jclass jcls)
     {
         renderFrame();
+        StartupProfiler::endFrame();
     }
 
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_rotozoom_RotoZoom_uninit
     (JNIEnv *, jclass)
     {
+        /* A bake interrupted here leaves no file behind, it starts over on the next run. */
+        if (bakeJob != NULL)
+        {
+            jobScheduler.wait(bakeJob);
+            bakeJob = NULL;
+        }
+        virtualTexture.terminate();
+        SamplerCache::clear();
+        delete uniformRing;
+        uniformRing = NULL;
         delete text;
     }
 }
@@ -21,9 +21,9 @@
 #ifndef ROTOZOOM_H
 #define ROTOZOOM_H
 
-#define GLES_VERSION 2 
+#define GLES_VERSION 3
 
-#include <GLES2/gl2.h>
+#include <GLES3/gl3.h>
 
 /* These indices describe the quad triangle strip. */
 static const GLubyte quadIndices[] =
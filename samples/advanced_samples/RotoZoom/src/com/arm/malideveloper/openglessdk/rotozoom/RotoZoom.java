@@ -33,7 +33,7 @@ class RotoZoomDemoView extends MaliSamplesView
 {   
     public RotoZoomDemoView(Context context) 
     {
-        super(context);
+        super(context, GlesVersion.GLES3);
     }
 	
     @Override protected void setRendererCallback()
@@ -25,14 +25,17 @@
 #include "Skybox.h"
 #include "Image.h"
 
-/* Please see the header for specification. */
-ImageFile load_ppm_file(const char* ppm_file_name)
+/**
+ * \brief Reads the header of a .ppm file and leaves the file positioned at the pixel data.
+ *
+ * \param pFile  File opened for reading in binary mode.
+ * \param width  Deref will be used to store the width of the image.
+ * \param height Deref will be used to store the height of the image.
+ */
+static void read_ppm_header(FILE* pFile, int* width, int* height)
 {
-    ImageFile image = { 0, 0, NULL };
-
     /* Constant numbers. */
     int max_color_value        = 255;
-    int num_of_bytes_per_pixel = 3;
     int read_buffer_length     = 256;
 
     /* Constant strings. */
@@ -40,22 +43,9 @@ ImageFile load_ppm_file(const char* ppm_file_name)
     const char pixmap_mark[] = "P6\n";
 
     int   id_255          = 0;
-    int   height          = 0;
     char* line_str        = NULL;
-    int   n_loaded_pixels = 0;
-    char* pixels          = NULL;
     char* returned_str    = NULL;
     int   returned_value  = 0;
-    int   width           = 0;
-
-    FILE* pFile = fopen(ppm_file_name, "rb");
-
-    if (pFile == NULL)
-    {
-        LOGF("Error opening .ppm file.");
-
-        exit(EXIT_FAILURE);
-    }
 
     MALLOC_CHECK(char*, line_str, read_buffer_length);
 
@@ -95,7 +85,7 @@ ImageFile load_ppm_file(const char* ppm_file_name)
     }
 
     /* Read the pixmap dimensions. */
-    returned_value = sscanf(line_str, "%d %d", &width, &height);
+    returned_value = sscanf(line_str, "%d %d", width, height);
 
     /* Make sure both width and height have been read correctly. */
     if (returned_value != 2)
@@ -117,6 +107,50 @@ ImageFile load_ppm_file(const char* ppm_file_name)
 
     fseek(pFile, 1, SEEK_CUR);
 
+    FREE_CHECK(line_str);
+}
+
+/* Please see the header for specification. */
+void get_ppm_file_size(const char* ppm_file_name, int* width, int* height)
+{
+    FILE* pFile = fopen(ppm_file_name, "rb");
+
+    if (pFile == NULL)
+    {
+        LOGF("Error opening .ppm file.");
+
+        exit(EXIT_FAILURE);
+    }
+
+    read_ppm_header(pFile, width, height);
+
+    fclose(pFile);
+}
+
+/* Please see the header for specification. */
+ImageFile load_ppm_file(const char* ppm_file_name)
+{
+    ImageFile image = { 0, 0, NULL };
+
+    /* Constant numbers. */
+    int num_of_bytes_per_pixel = 3;
+
+    int   height          = 0;
+    int   n_loaded_pixels = 0;
+    char* pixels          = NULL;
+    int   width           = 0;
+
+    FILE* pFile = fopen(ppm_file_name, "rb");
+
+    if (pFile == NULL)
+    {
+        LOGF("Error opening .ppm file.");
+
+        exit(EXIT_FAILURE);
+    }
+
+    read_ppm_header(pFile, &width, &height);
+
     /* Each pixel consists of 3 bytes for GL_RGB storage. */
     pixels = (char*) calloc(width * height, num_of_bytes_per_pixel);
 
@@ -142,7 +176,7 @@ ImageFile load_ppm_file(const char* ppm_file_name)
     image.height = height;
     image.pixels = pixels;
 
-    FREE_CHECK(line_str);
+    fclose(pFile);
 
     return image;
 }
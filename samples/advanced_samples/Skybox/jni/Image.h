@@ -41,4 +41,12 @@
      */
     ImageFile load_ppm_file(const char* ppm_file_name);
 
+    /** Reads only the header of the pixmap file, to find the size of the image without loading it.
+     *
+     *  @param ppm_file_name Path to the .ppm file.
+     *  @param width         Deref will be used to store the width of the image.
+     *  @param height        Deref will be used to store the height of the image.
+     */
+    void get_ppm_file_size(const char* ppm_file_name, int* width, int* height);
+
 #endif /* PIXMAP_H */
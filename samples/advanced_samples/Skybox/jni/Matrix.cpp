@@ -1,84 +0,0 @@
-/* Copyright (c) 2014-2017, ARM Limited and Contributors
- *
- * SPDX-License-Identifier: MIT
- *
- * Permission is hereby granted, free of charge,
- * to any person obtaining a copy of this software and associated documentation files (the "Software"),
- * to deal in the Software without restriction, including without limitation the rights to
- * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
- * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
- * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
- * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
- * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
- */
-
-#include "Skybox.h"
-#include "Matrix.h"
-
-#include <cmath>
-#include <cstdlib>
-#include <cstring>
-
-namespace Skybox
-{
-    /* Identity matrix. */
-    const float Matrix::identityArray[16] =
-    {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-
-    /* Please see header for specification. */
-    Matrix::Matrix(const float* array)
-    {
-        memcpy(elements, array, 16 * sizeof(float));
-    }
-
-    /* Please see header for specification. */
-    Matrix Matrix::identityMatrix = Matrix(identityArray);
-
-    /* Please see header for specification. */
-    Matrix::Matrix(void){}
-
-    /* Please see header for specification. */
-    float* Matrix::getAsArray(void)
-    {
-        return elements;
-    }
-
-    /* Please see header for specification. */
-    Matrix& Matrix::operator=(const Matrix &another)
-    {
-        if(this != &another)
-        {
-            memcpy(this->elements, another.elements, 16 * sizeof(float));
-        }
-
-        return *this;
-    }
-
-    /* Please see header for specification. */
-    Matrix Matrix::matrixOrthographic(float left, float right, float bottom, float top, float zNear, float zFar)
-    {
-        Matrix result = identityMatrix;
-
-        result.elements[0]  = 2.0f / (right - left);
-        result.elements[12] = -(right + left) / (right - left);
-
-        result.elements[5]  = 2.0f / (top - bottom);
-        result.elements[13] = -(top + bottom) / (top - bottom);
-
-        result.elements[10] = -2.0f / (zFar - zNear);
-        result.elements[14] = -(zFar + zNear) / (zFar - zNear);
-
-        return result;
-    }
-}
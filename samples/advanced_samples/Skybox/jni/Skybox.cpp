@@ -23,11 +23,19 @@
 #include "Text.h"
 #include "Skybox.h"
 
+#define GLES_VERSION 3
+#include "EnvironmentProbe.h"
+#include "GLWorkerPool.h"
+#include "TextureFormatSelector.h"
+#include "Timer.h"
+
 #include <jni.h>
 #include <GLES3/gl3.h>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <string>
+#include <vector>
 
 /* Window resolution. */
 unsigned int window_width  = 0;
@@ -41,6 +49,15 @@ GLint location_viewMat = 0;
 /* ID of a program object. */
 GLuint program_id = 0;
 
+/* Program of the sphere lit by the skybox, 0 when there is no environment probe. */
+GLuint sphere_program_id = 0;
+
+/* Location of the 'viewMat' uniform variable of the sphere program. */
+GLint location_sphere_viewMat = 0;
+
+/* Diffuse and specular lighting made from the cubemap. */
+MaliSDK::EnvironmentProbe* environment_probe = NULL;
+
 /* Quaternions representing rotations around X, Y and Z axes. */
 Quaternion Q_X = { 0.0f, 0.0f, 0.0f, 0.0f };
 Quaternion Q_Y = { 0.0f, 0.0f, 0.0f, 0.0f };
@@ -50,8 +67,16 @@ Quaternion Q_Z = { 0.0f, 0.0f, 0.0f, 0.0f };
 Quaternion Q_XY  = { 0.0f, 0.0f, 0.0f, 0.0f };
 Quaternion Q_XYZ = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-/* Used to hold cube-map texture face data when initializing skybox cube-map texture. */
-ImageFile cubemap_image = { 0, 0, NULL };
+/**
+ * \brief A cube-map face to be decoded and uploaded by a worker thread.
+ */
+struct CubemapFaceJob
+{
+    /** Path to the .ppm file of the face. */
+    char file_name[128];
+    /** Texture cubemap target of the face. */
+    GLenum target;
+};
 
 /* Instance of text renderer. */
 Text* text = NULL;
@@ -154,17 +179,62 @@ GLuint create_program(const char* vertex_source, const char* fragment_source)
     return program;
 }
 
-void setup_graphics(int width, int height)
+/**
+ * \brief Decodes one .ppm cube-map face and uploads it, run by a worker thread.
+ *
+ * \param user_data The CubemapFaceJob describing the face.
+ */
+static void load_cubemap_face(void* user_data)
 {
-    window_width = width;
-    window_height = height;
+    CubemapFaceJob* job = (CubemapFaceJob*) user_data;
 
-    /* Path to resource directory. */
-    const char resource_directory[] = "/data/data/com.arm.malideveloper.openglessdk.skybox/files/";
+    ImageFile cubemap_image = load_ppm_file(job->file_name);
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap_texture));
+    GL_CHECK(glTexSubImage2D(job->target,                            /* Texture target. */
+                             0,                                      /* Level-of-detail number. */
+                             0,                                      /* Texel offset in the x direction. */
+                             0,                                      /* Texel offset in the y direction. */
+                             cubemap_image.width,                    /* Width of the texture image. */
+                             cubemap_image.height,                   /* Height of the texture image. */
+                             GL_RGB,                                 /* Format of the pixel data. */
+                             GL_UNSIGNED_BYTE,                       /* Type of the pixel data. */
+                             (const GLvoid*) cubemap_image.pixels)); /* Pointer to the image data. */
+
+    FREE_CHECK(cubemap_image.pixels);
+}
+
+/**
+ * \brief Provides a face of the cubemap to be compressed, see TextureFormatSelector::CubemapFaceSource.
+ */
+static bool read_cubemap_face(int face, std::vector<unsigned char>* pixels, int* size, void* user_data)
+{
+    char file_name[128];
+
+    sprintf(file_name, "/data/data/com.arm.malideveloper.openglessdk.skybox/files/greenhouse_skybox-%d.ppm", face);
+
+    ImageFile cubemap_image = load_ppm_file(file_name);
 
-    /* Path to cubemap texture. */
-    char file_name[] = "/data/data/com.arm.malideveloper.openglessdk.skybox/files/greenhouse_skybox-0.ppm";
+    if (cubemap_image.width != cubemap_image.height)
+    {
+        FREE_CHECK(cubemap_image.pixels);
+
+        return false;
+    }
 
+    pixels->assign(cubemap_image.pixels, cubemap_image.pixels + cubemap_image.width * cubemap_image.height * 3);
+    *size = cubemap_image.width;
+
+    FREE_CHECK(cubemap_image.pixels);
+
+    return true;
+}
+
+/**
+ * \brief Loads the uncompressed .ppm faces into cubemap_texture, used when no compressed cubemap can be loaded.
+ */
+static void load_uncompressed_cubemap(void)
+{
     /* Texture cubemap targets. */
     GLenum cubemap_faces[] =
     {
@@ -180,43 +250,118 @@ void setup_graphics(int width, int height)
     GL_CHECK(glGenTextures(1, &cubemap_texture));
     GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap_texture));
 
-    /* Set up texture parameters. */
-    GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    /* There is a single level. */
     GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE));
 
-    /* Load cubemap texture. */
-    cubemap_image = load_ppm_file(file_name);
+    /* The faces are decoded and uploaded concurrently by worker threads with shared contexts. */
+    MaliSDK::GLWorkerPool worker_pool;
+    worker_pool.initialize(0);
+
+    const int n_faces = sizeof(cubemap_faces) / sizeof(cubemap_faces[0]);
+    CubemapFaceJob face_jobs[n_faces];
+
+    for (int n_face = 0; n_face < n_faces; n_face++)
+    {
+        sprintf(face_jobs[n_face].file_name, "/data/data/com.arm.malideveloper.openglessdk.skybox/files/greenhouse_skybox-%d.ppm", n_face);
+        face_jobs[n_face].target = cubemap_faces[n_face];
+    }
+
+    /* Only the header is needed to specify the storage, all faces must have the same size. */
+    int cubemap_width  = 0;
+    int cubemap_height = 0;
+
+    get_ppm_file_size(face_jobs[0].file_name, &cubemap_width, &cubemap_height);
 
     /* Specify storage for all levels of a cubemap texture. */
     GL_CHECK(glTexStorage2D(GL_TEXTURE_CUBE_MAP,    /* Texture target */
                             1,                      /* Number of texture levels */
                             GL_RGB8,                /* Internal format for texture storage */
-                            cubemap_image.width,    /* Width of the texture image */
-                            cubemap_image.height)); /* Height of the texture image */
+                            cubemap_width,          /* Width of the texture image */
+                            cubemap_height));       /* Height of the texture image */
 
-    for (int n_face = 0; n_face < sizeof(cubemap_faces) / sizeof(cubemap_faces[0]); n_face++)
+    /* The storage has to reach the server before the workers upload into it. */
+    GL_CHECK(glFlush());
+
+    for (int n_face = 0; n_face < n_faces; n_face++)
     {
-        if (n_face != 0)
-        {
-            sprintf(file_name, "/data/data/com.arm.malideveloper.openglessdk.skybox/files/greenhouse_skybox-%d.ppm", n_face);
+        worker_pool.submit(load_cubemap_face, &face_jobs[n_face]);
+    }
 
-            cubemap_image = load_ppm_file(file_name);
-        }
+    worker_pool.waitAll();
 
-        GL_CHECK(glTexSubImage2D(cubemap_faces[n_face],                  /* Texture target. */
-                                 0,                                      /* Level-of-detail number. */
-                                 0,                                      /* Texel offset in the x direction. */
-                                 0,                                      /* Texel offset in the y direction. */
-                                 cubemap_image.width,                    /* Width of the texture image. */
-                                 cubemap_image.height,                   /* Height of the texture image. */
-                                 GL_RGB,                                 /* Format of the pixel data. */
-                                 GL_UNSIGNED_BYTE,                       /* Type of the pixel data. */
-                                 (const GLvoid*) cubemap_image.pixels)); /* Pointer to the image data. */
+    LOGI("Skybox cubemap faces loaded by %u worker threads.\n", worker_pool.getNumberOfWorkers());
 
-        FREE_CHECK(cubemap_image.pixels);
+    worker_pool.terminate();
+}
+
+void setup_graphics(int width, int height)
+{
+    window_width = width;
+    window_height = height;
+
+    /* Path to resource directory. */
+    const char resource_directory[] = "/data/data/com.arm.malideveloper.openglessdk.skybox/files/";
+
+    MaliSDK::Timer load_timer(MaliSDK::Timer::RealClock);
+
+    /* Prefer a compressed cubemap with mip levels. It is encoded from the .ppm faces on the first run and cached. */
+    MaliSDK::TextureFormatSelector::setCacheDirectory(resource_directory);
+
+    if (MaliSDK::TextureFormatSelector::loadCubemap("/data/data/com.arm.malideveloper.openglessdk.skybox/files/greenhouse_skybox",
+                                                    read_cubemap_face, NULL, &cubemap_texture))
+    {
+        LOGI("Skybox compressed cubemap loaded in %.1f ms.\n", load_timer.getTime() * 1000.0f);
+    }
+    else
+    {
+        load_uncompressed_cubemap();
+
+        LOGI("Skybox uncompressed cubemap loaded in %.1f ms.\n", load_timer.getTime() * 1000.0f);
+    }
+
+    /* Set up texture parameters. */
+    GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE));
+
+    /* Made from the cubemap with compute shaders on the first run and cached, the sphere is left out without them. */
+    MaliSDK::Timer probe_timer(MaliSDK::Timer::RealClock);
+    std::string probe_path = std::string(resource_directory) + "greenhouse_skybox.probe";
+
+    environment_probe = new MaliSDK::EnvironmentProbe();
+
+    if (environment_probe->generate(cubemap_texture, probe_path.c_str()))
+    {
+        LOGI("Skybox environment probe ready in %.1f ms.\n", probe_timer.getTime() * 1000.0f);
+
+        std::string sphere_fragment_shader_source = std::string(sphere_fragment_shader_header) +
+                                                    MaliSDK::EnvironmentProbe::getShaderSource() +
+                                                    sphere_fragment_shader_body;
+
+        sphere_program_id = create_program(sphere_vertex_shader_source, sphere_fragment_shader_source.c_str());
+
+        GL_CHECK(glUseProgram(sphere_program_id));
+
+        location_sphere_viewMat = GL_CHECK(glGetUniformLocation(sphere_program_id, "viewMat"));
+
+        /* Keep the sphere round whatever the shape of the window. */
+        float shortest_side = (float) (window_width < window_height ? window_width : window_height);
+
+        GL_CHECK(glUniform2f(glGetUniformLocation(sphere_program_id, "scale"), window_width / shortest_side, window_height / shortest_side));
+
+        /* The probe is read from texture unit 1, the skybox from unit 0. */
+        environment_probe->setUniforms(sphere_program_id, 1);
+
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap_texture));
+    }
+    else
+    {
+        LOGI("Compute shaders are not supported, the sphere lit by the skybox is not drawn.\n");
+
+        delete environment_probe;
+        environment_probe = NULL;
     }
 
     /* Create a program object that we will attach the fragment and vertex shader to. */
@@ -310,6 +455,14 @@ void render_frame(void)
        Note that the actual content of the quad is drawn within the fragment shader. */
     GL_CHECK(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
 
+    /* The sphere is drawn over the skybox the same way, pixels which miss it being discarded. */
+    if (sphere_program_id != 0)
+    {
+        GL_CHECK(glUseProgram(sphere_program_id));
+        GL_CHECK(glUniformMatrix4fv(location_sphere_viewMat, 1, GL_FALSE, (const GLfloat*) model_view_matrix));
+        GL_CHECK(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+    }
+
     text->draw();
 }
 
@@ -324,6 +477,15 @@ void cleanup_graphics(void)
     /* Release shaders. */
     GL_CHECK(glUseProgram(0));
     GL_CHECK(glDeleteProgram(program_id));
+
+    if (sphere_program_id != 0)
+    {
+        GL_CHECK(glDeleteProgram(sphere_program_id));
+        sphere_program_id = 0;
+    }
+
+    delete environment_probe;
+    environment_probe = NULL;
 }
 
 extern "C"
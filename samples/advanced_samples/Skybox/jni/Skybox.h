@@ -96,6 +96,55 @@ const char skybox_fragment_shader_source[] =
     "}\n"
 };
 
+/* Vertex shader of the sphere, a full-screen quad passing on its position. */
+const char sphere_vertex_shader_source[] =
+{
+    "#version 300 es\n"
+    "out     vec2 position;\n"
+    "void main(void) {\n"
+    "     const vec2 vertices[4] = vec2[4](vec2(-1.0f, -1.0f),\n"
+    "                                      vec2( 1.0f, -1.0f),\n"
+    "                                      vec2(-1.0f,  1.0f),\n"
+    "                                      vec2( 1.0f,  1.0f));\n"
+    "    position = vertices[gl_VertexID];\n"
+    "    gl_Position = vec4(vertices[gl_VertexID], 0.0f, 1.0f);\n"
+    "}\n"
+};
+
+/* Start of the fragment shader of the sphere, followed by MaliSDK::EnvironmentProbe::getShaderSource(). */
+const char sphere_fragment_shader_header[] =
+{
+    "#version 300 es\n"
+    "precision mediump float;\n"
+};
+
+/* Rest of the fragment shader of the sphere. The ray through the pixel is intersected with a sphere of radius 1,
+   3 units in front of the eye, which is lit by the environment probe: rough at the bottom, a mirror at the top. */
+const char sphere_fragment_shader_body[] =
+{
+    "in      vec2 position;\n"
+    "out     vec4 color;\n"
+    "uniform mat4 viewMat;\n"
+    "uniform vec2 scale;\n"
+    "void main(void) {\n"
+    "    highp vec3 direction = normalize(vec3(position * scale, 1.0f));\n"
+    "    highp vec3 centre = vec3(0.0f, 0.0f, 3.0f);\n"
+    "    highp float b = dot(direction, centre);\n"
+    "    highp float discriminant = b * b - dot(centre, centre) + 1.0f;\n"
+    "    if (discriminant < 0.0f) {\n"
+    "        discard;\n"
+    "    }\n"
+    "    highp vec3 normal = direction * (b - sqrt(discriminant)) - centre;\n"
+    "    highp vec3 reflection = reflect(direction, normal);\n"
+    "    float roughness = 0.5f - 0.5f * normal.y;\n"
+    "    float fresnel = 0.25f + 0.75f * pow(1.0f - max(dot(-direction, normal), 0.0f), 5.0f);\n"
+    "    mat3 to_cubemap = mat3(viewMat);\n"
+    "    vec3 diffuse = vec3(0.8f) * probeIrradiance(to_cubemap * normal);\n"
+    "    vec3 specular = probeSpecular(to_cubemap * reflection, roughness);\n"
+    "    color = vec4(mix(diffuse, specular, fresnel), 1.0f);\n"
+    "}\n"
+};
+
 /**
  * \brief Create shader object and compile its source code.
  *
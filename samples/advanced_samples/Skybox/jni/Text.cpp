@@ -111,7 +111,7 @@ namespace Skybox
         textIndex              = NULL;
 
         /* Create an orthographic projection. */
-        projectionMatrix = Matrix::matrixOrthographic(0, (float)windowWidth, 0, (float)windowHeight, 0, 1);
+        projectionMatrix = MaliSDK::Matrix::matrixOrthographic(0, (float)windowWidth, 0, (float)windowHeight, 0, 1);
 
         /* Set up shaders. */
         programID = create_program(fontVertexShaderSource, fontFragmentShaderSource);
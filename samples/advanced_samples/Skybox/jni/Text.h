@@ -119,7 +119,7 @@ namespace Skybox
              */
             static const float scale;
 
-            Matrix projectionMatrix;
+            MaliSDK::Matrix projectionMatrix;
             int numberOfCharacters;
             float* textVertex;
             float* textTextureCoordinates;
@@ -43,3 +43,37 @@ vec3 AABB::corner(unsigned int index) const
 
     return ret;
 }
+
+void AABBBatch::push_back(const AABB& aabb)
+{
+    vec3 lo = aabb.corner(0);
+    vec3 hi = aabb.corner(7);
+    min_x.push_back(lo.c.x);
+    min_y.push_back(lo.c.y);
+    min_z.push_back(lo.c.z);
+    max_x.push_back(hi.c.x);
+    max_y.push_back(hi.c.y);
+    max_z.push_back(hi.c.z);
+}
+
+void AABBBatch::clear()
+{
+    min_x.clear();
+    min_y.clear();
+    min_z.clear();
+    max_x.clear();
+    max_y.clear();
+    max_z.clear();
+}
+
+MaliSDK::FrustumCulling::AABBBatch AABBBatch::get_arrays() const
+{
+    MaliSDK::FrustumCulling::AABBBatch arrays;
+    arrays.minX = min_x.empty() ? NULL : &min_x[0];
+    arrays.minY = min_y.empty() ? NULL : &min_y[0];
+    arrays.minZ = min_z.empty() ? NULL : &min_z[0];
+    arrays.maxX = max_x.empty() ? NULL : &max_x[0];
+    arrays.maxY = max_y.empty() ? NULL : &max_y[0];
+    arrays.maxZ = max_z.empty() ? NULL : &max_z[0];
+    return arrays;
+}
@@ -22,6 +22,8 @@
 #define AABB_H__
 
 #include "vector_math.h"
+#include "FrustumCulling.h"
+#include <vector>
 
 // Axis-aligned bounding box. Used for frustum-culling.
 // Represents a box with corners base and base + offset which encapsulate an entire mesh.
@@ -39,4 +41,20 @@ private:
     vec3 offset;
 };
 
+// Structure-of-arrays storage for many AABBs, so they can be tested against a frustum in one batch.
+class AABBBatch
+{
+public:
+    void push_back(const AABB& aabb);
+    void clear();
+    unsigned int size() const { return min_x.size(); }
+
+    // Only valid until the batch is modified.
+    MaliSDK::FrustumCulling::AABBBatch get_arrays() const;
+
+private:
+    std::vector<float> min_x, min_y, min_z;
+    std::vector<float> max_x, max_y, max_z;
+};
+
 #endif
@@ -19,7 +19,7 @@
  */
 
 #include "ClipmapApplication.h"
-#include "shaders.h"
+#include "embedded_shaders.h"
 #include "Platform.h"
 #include <cstdio>
 
@@ -27,35 +27,151 @@ using namespace MaliSDK;
 using namespace std;
 
 ClipmapApplication::ClipmapApplication(unsigned int size, unsigned int levels, float clip_scale)
-    : mesh(size, levels, clip_scale), heightmap(size * 4 - 1, levels), frame(0)
+    : mesh(size, levels, clip_scale), heightmap(size * 4 - 1, levels),
+    occlusion_culling(false), scene_framebuffer(0), scene_color(0), scene_depth(0), scene_width(0), scene_height(0),
+    frame(0), update_budget(0), level_size(size * 4 - 1)
 {
-    // Compile shaders and grab uniform locations for later use.
-    program = compile_program(vertex_shader_source, fragment_shader_source);
-    GL_CHECK(glUseProgram(program));
-    GL_CHECK(glUniformBlockBinding(program, glGetUniformBlockIndex(program, "InstanceData"), 0));
-
-    GL_CHECK(mvp_loc = glGetUniformLocation(program, "uViewProjection"));
-    GL_CHECK(camera_pos_loc = glGetUniformLocation(program, "uCameraPos"));
-
-    GL_CHECK(GLint heightmap_loc = glGetUniformLocation(program, "sHeightmap"));
-    GL_CHECK(glUniform1i(heightmap_loc, 0));
-
-    vector<GLfloat> inv_level_size;
-    float inv_size = 1.0f / (clip_scale * (size * 4 - 1));
+    float inv_size = 1.0f / (clip_scale * level_size);
     for (unsigned int i = 0; i < levels; i++)
     {
         inv_level_size.push_back(inv_size);
         inv_size *= 0.5f;
     }
 
-    GL_CHECK(GLint inv_level_size_loc = glGetUniformLocation(program, "uInvLevelSize"));
+    // The baked variant is only compiled if it is used, see set_baked_vertices().
+    baked_program.program = 0;
+    setup_program(program, terrain_vert, terrain_frag);
+}
+
+void ClipmapApplication::setup_program(TerrainProgram& terrain, const char *vertex_shader, const char *fragment_shader)
+{
+    // Compile shaders and grab uniform locations for later use.
+    terrain.program = compile_program(vertex_shader, fragment_shader);
+    GL_CHECK(glUseProgram(terrain.program));
+    GL_CHECK(glUniformBlockBinding(terrain.program, glGetUniformBlockIndex(terrain.program, "InstanceData"), 0));
+
+    GL_CHECK(terrain.mvp_loc = glGetUniformLocation(terrain.program, "uViewProjection"));
+    GL_CHECK(terrain.camera_pos_loc = glGetUniformLocation(terrain.program, "uCameraPos"));
+    GL_CHECK(terrain.resident_texels_loc = glGetUniformLocation(terrain.program, "uResidentTexels"));
+
+    // Only one of these is used by each variant, the other location is -1 and ignored.
+    GL_CHECK(GLint heightmap_loc = glGetUniformLocation(terrain.program, "sHeightmap"));
+    GL_CHECK(glUniform1i(heightmap_loc, 0));
+    GL_CHECK(GLint baked_stride_loc = glGetUniformLocation(terrain.program, "uBakedStride"));
+    GL_CHECK(glUniform1i(baked_stride_loc, level_size));
+
+    GL_CHECK(GLint inv_level_size_loc = glGetUniformLocation(terrain.program, "uInvLevelSize"));
     GL_CHECK(glUniform1fv(inv_level_size_loc, inv_level_size.size(), &inv_level_size[0]));
     GL_CHECK(glUseProgram(0));
 }
 
+bool ClipmapApplication::load_heightfield(const char *path)
+{
+    return heightmap.load_heightfield(path);
+}
+
+void ClipmapApplication::set_compute_heightmap(bool enable)
+{
+    if (!heightmap.set_compute_generation(enable))
+        LOGI("Falling back to CPU heightmap generation.\n");
+}
+
+void ClipmapApplication::set_gpu_culling(bool enable)
+{
+    if (!mesh.set_gpu_culling(enable))
+        LOGI("Falling back to CPU culling.\n");
+}
+
+void ClipmapApplication::set_baked_vertices(bool enable)
+{
+    if (!mesh.set_baked_vertices(enable))
+    {
+        LOGI("Falling back to sampling the heightmap in the vertex shader.\n");
+        return;
+    }
+
+    if (mesh.get_baked_vertices() && !baked_program.program)
+        setup_program(baked_program, terrain_vert_baked, terrain_frag);
+}
+
+void ClipmapApplication::set_update_budget(unsigned int texels)
+{
+    update_budget = texels;
+}
+
+void ClipmapApplication::set_occlusion_culling(bool enable)
+{
+    if (enable && (!mesh.get_gpu_culling() || mesh.get_baked_vertices()))
+    {
+        LOGI("Occlusion culling requires GPU culling, only frustum culling the blocks.\n");
+        enable = false;
+    }
+    else if (enable && !depth_pyramid.init())
+    {
+        LOGI("Falling back to frustum culling only.\n");
+        enable = false;
+    }
+
+    occlusion_culling = enable;
+    depth_pyramid.invalidate();
+    if (!enable)
+        delete_scene_target();
+}
+
+void ClipmapApplication::setup_scene_target(unsigned int width, unsigned int height)
+{
+    if (scene_framebuffer && width == scene_width && height == scene_height)
+        return;
+
+    // Resizing keeps the pyramid, it is in normalized coordinates and holds its own view-projection.
+    delete_scene_target();
+    scene_width = width;
+    scene_height = height;
+
+    GL_CHECK(glGenRenderbuffers(1, &scene_color));
+    GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, scene_color));
+    GL_CHECK(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+    GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+    // Depth textures can't be filtered, and only texelFetch is used on it anyways.
+    GL_CHECK(glGenTextures(1, &scene_depth));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, scene_depth));
+    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, width, height));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+    GL_CHECK(glGenFramebuffers(1, &scene_framebuffer));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, scene_framebuffer));
+    GL_CHECK(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, scene_color));
+    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, scene_depth, 0));
+    GL_CHECK(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        LOGE("Scene framebuffer is incomplete (0x%x).\n", status);
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void ClipmapApplication::delete_scene_target()
+{
+    if (!scene_framebuffer)
+        return;
+
+    GL_CHECK(glDeleteFramebuffers(1, &scene_framebuffer));
+    GL_CHECK(glDeleteRenderbuffers(1, &scene_color));
+    GL_CHECK(glDeleteTextures(1, &scene_depth));
+    scene_framebuffer = 0;
+    scene_color = 0;
+    scene_depth = 0;
+}
+
 ClipmapApplication::~ClipmapApplication()
 {
-    GL_CHECK(glDeleteProgram(program));
+    delete_scene_target();
+    GL_CHECK(glDeleteProgram(program.program));
+    if (baked_program.program)
+    {
+        GL_CHECK(glDeleteProgram(baked_program.program));
+    }
 }
 
 GLuint ClipmapApplication::compile_program(const char *vertex_shader, const char *fragment_shader)
@@ -119,6 +235,16 @@ GLuint ClipmapApplication::compile_shader(GLenum type, const char *source)
 
 void ClipmapApplication::render(unsigned int width, unsigned int height)
 {
+    // The mesh can leave the GPU culling path after occlusion culling was enabled.
+    bool occlusion = occlusion_culling && mesh.get_gpu_culling() && !mesh.get_baked_vertices();
+    if (occlusion)
+    {
+        setup_scene_target(width, height);
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, scene_framebuffer));
+    }
+    else
+        depth_pyramid.invalidate();
+
     GL_CHECK(glClearColor(0.5f, 0.5f, 0.5f, 1.0f));
     GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
     GL_CHECK(glEnable(GL_DEPTH_TEST));
@@ -126,7 +252,8 @@ void ClipmapApplication::render(unsigned int width, unsigned int height)
     GL_CHECK(glViewport(0, 0, width, height));
 
     // Rebind program every frame for clarity.
-    GL_CHECK(glUseProgram(program));
+    const TerrainProgram& terrain = mesh.get_baked_vertices() ? baked_program : program;
+    GL_CHECK(glUseProgram(terrain.program));
 
     // Non-interactive camera that just moves in one direction.
     frame++;
@@ -137,7 +264,7 @@ void ClipmapApplication::render(unsigned int width, unsigned int height)
     mat4 proj = mat_perspective_fov(45.0f, float(width) / float(height), 1.0f, 1000.0f);
     mat4 vp = proj * view;
 
-    GL_CHECK(glUniformMatrix4fv(mvp_loc, 1, GL_FALSE, vp.data));
+    GL_CHECK(glUniformMatrix4fv(terrain.mvp_loc, 1, GL_FALSE, vp.data));
 
     // Used for frustum culling.
     mesh.set_frustum(Frustum(vp));
@@ -145,14 +272,53 @@ void ClipmapApplication::render(unsigned int width, unsigned int height)
     // The clipmap moves along with the camera.
     mesh.update_level_offsets(camera_pos);
 
-    GL_CHECK(glUniform3fv(camera_pos_loc, 1, world_camera_pos.data));
+    GL_CHECK(glUniform3fv(terrain.camera_pos_loc, 1, world_camera_pos.data));
 
     // As we move around, the heightmap textures are updated incrementally, allowing for an "endless" terrain.
+    // Cross several level boundaries at once and the budget spreads the updates over the next frames.
+    heightmap.set_update_budget(mesh.get_baked_vertices() ? 0 : update_budget);
     heightmap.update_heightmap(mesh.get_level_offsets());
+    GL_CHECK(glUseProgram(terrain.program)); // The compute path binds its own program.
+
+    // Where a level is stale, the vertex shader morphs to the next one. The coarsest has none and is always current.
+    resident_texels.resize(inv_level_size.size());
+    for (unsigned int i = 0; i < resident_texels.size(); i++)
+        resident_texels[i] = heightmap.get_resident_texels(i);
+    resident_texels.back() = vec4(-1e9f, -1e9f, 1e9f, 1e9f);
+    GL_CHECK(glUniform4fv(terrain.resident_texels_loc, resident_texels.size(), resident_texels[0].data));
+
+    if (frame % 600 == 0)
+    {
+        const Heightmap::UploadStats& stats = heightmap.get_upload_stats();
+        LOGI("Heightmap uploads (%s): %u updates, %u regions, %.1f KiB, %u stalls, %u deferred levels.\n",
+            heightmap.get_compute_generation() ? "compute" : "PBO", stats.updates, stats.regions, stats.bytes / 1024.0, stats.stalls,
+            stats.deferred);
+
+        const TiledHeightfield& heightfield = heightmap.get_heightfield();
+        if (heightfield.is_open())
+        {
+            const TiledHeightfield::Stats& tiles = heightfield.get_stats();
+            LOGI("Heightfield tiles: %u decoded from %.1f KiB, %u resident.\n",
+                tiles.decoded_tiles, tiles.coded_bytes / 1024.0, tiles.resident_tiles);
+        }
+    }
 
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, heightmap.get_texture()));
+    mesh.set_occlusion(occlusion ? &depth_pyramid : NULL);
     mesh.render();
 
     GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+
+    if (occlusion)
+    {
+        GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, scene_framebuffer));
+        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
+        GL_CHECK(glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+        // The next frame culls against the blocks drawn in this one. It lags by a frame where the terrain disoccludes,
+        // as the blocks which come into view are culled against where the camera was.
+        depth_pyramid.build(scene_depth, vp);
+    }
 }
@@ -23,7 +23,9 @@
 
 #include <GLES3/gl3.h>
 #include <string>
+#include <vector>
 
+#include "DepthPyramid.h"
 #include "GroundMesh.h"
 #include "Heightmap.h"
 #include "vector_math.h"
@@ -35,8 +37,40 @@ public:
     ~ClipmapApplication();
     void render(unsigned int viewport_width, unsigned int viewport_height);
 
+    // Generate heightmap updates with a compute shader instead of on the CPU. Requires GLES 3.1.
+    void set_compute_heightmap(bool enable);
+
+    // Frustum cull the clipmap blocks with a compute shader and draw them indirectly. Requires GLES 3.1.
+    void set_gpu_culling(bool enable);
+
+    // Bake the heights into vertex buffers with a compute shader as the clipmap moves instead of sampling the
+    // heightmap in the vertex shader. Requires GLES 3.1, and takes precedence over GPU culling.
+    void set_baked_vertices(bool enable);
+
+    // Also cull the blocks hidden by the terrain in the previous frame, see DepthPyramid.h.
+    // The terrain is then rendered to an offscreen target and blitted, as the default depth buffer can't be sampled.
+    // Only the GPU culling path supports it, the baked and CPU paths keep frustum culling.
+    void set_occlusion_culling(bool enable);
+
+    // Regenerate at most this many heightmap texels per frame, 0 for no limit, see Heightmap::set_update_budget().
+    // The baked vertices would keep the stale heights, so the budget is ignored when they are used.
+    void set_update_budget(unsigned int texels);
+
+    // Render a tiled heightfield streamed from disk instead of the generated terrain, see TiledHeightfield.h.
+    bool load_heightfield(const char *path);
+
 private:
-    GLuint program;
+    // The regular and the baked variant of terrain.vert, with the uniforms which are updated every frame.
+    struct TerrainProgram
+    {
+        GLuint program;
+        GLint mvp_loc;
+        GLint camera_pos_loc;
+        GLint resident_texels_loc;
+    };
+    TerrainProgram program, baked_program;
+    void setup_program(TerrainProgram& terrain, const char *vertex_shader_source, const char *fragment_shader_source);
+
     GLuint compile_program(const char *vertex_shader_source, const char *fragment_shader_source);
     GLuint compile_shader(GLenum type, const char *source);
     std::string load_shader_string(const char *path);
@@ -44,9 +78,22 @@ private:
     GroundMesh mesh;
     Heightmap heightmap;
 
-    GLint mvp_loc;
-    GLint camera_pos_loc;
+    bool occlusion_culling;
+    DepthPyramid depth_pyramid;
+
+    // Offscreen target for the terrain when occlusion culling, the depth attachment is what the pyramid is built from.
+    GLuint scene_framebuffer, scene_color, scene_depth;
+    unsigned int scene_width, scene_height;
+    void setup_scene_target(unsigned int width, unsigned int height);
+    void delete_scene_target();
+
     int frame;
+
+    unsigned int update_budget;
+    std::vector<vec4> resident_texels;
+
+    unsigned int level_size;
+    std::vector<GLfloat> inv_level_size;
 };
 
 #endif
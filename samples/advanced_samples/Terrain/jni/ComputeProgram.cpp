@@ -0,0 +1,71 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ComputeProgram.h"
+#include "Platform.h"
+#include <vector>
+
+using namespace MaliSDK;
+using namespace std;
+
+GLuint compile_compute_program(const char *source)
+{
+    GL_CHECK(GLuint shader = glCreateShader(GL_COMPUTE_SHADER));
+    GL_CHECK(glShaderSource(shader, 1, &source, NULL));
+    GL_CHECK(glCompileShader(shader));
+
+    GLint status = 0;
+    GL_CHECK(glGetShaderiv(shader, GL_COMPILE_STATUS, &status));
+    if (!status)
+    {
+        GLint info_len = 0;
+        GL_CHECK(glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &info_len));
+        if (info_len)
+        {
+            vector<char> buffer(info_len);
+            GL_CHECK(glGetShaderInfoLog(shader, info_len, NULL, &buffer[0]));
+            LOGE("Shader error: %s.\n", &buffer[0]);
+        }
+        GL_CHECK(glDeleteShader(shader));
+        return 0;
+    }
+
+    GL_CHECK(GLuint prog = glCreateProgram());
+    GL_CHECK(glAttachShader(prog, shader));
+    GL_CHECK(glLinkProgram(prog));
+    GL_CHECK(glDeleteShader(shader));
+
+    GL_CHECK(glGetProgramiv(prog, GL_LINK_STATUS, &status));
+    if (!status)
+    {
+        GLint info_len = 0;
+        GL_CHECK(glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &info_len));
+        if (info_len)
+        {
+            vector<char> buffer(info_len);
+            GL_CHECK(glGetProgramInfoLog(prog, info_len, NULL, &buffer[0]));
+            LOGE("Program link error: %s.\n", &buffer[0]);
+        }
+        GL_CHECK(glDeleteProgram(prog));
+        return 0;
+    }
+
+    return prog;
+}
@@ -0,0 +1,104 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "DepthPyramid.h"
+#include "ComputeProgram.h"
+#include "Platform.h"
+#include "embedded_shaders.h"
+
+using namespace MaliSDK;
+
+// Same size as the Hi-Z depth map of the OcclusionCulling sample.
+#define DEPTH_PYRAMID_SIZE 256
+
+// Must match the compute shader.
+#define DEPTH_PYRAMID_GROUP_SIZE 8
+
+DepthPyramid::DepthPyramid()
+    : program(0), texture(0), source_level_loc(-1), levels(0), valid(false)
+{
+}
+
+DepthPyramid::~DepthPyramid()
+{
+    if (program)
+    {
+        GL_CHECK(glDeleteProgram(program));
+        GL_CHECK(glDeleteTextures(1, &texture));
+    }
+}
+
+bool DepthPyramid::init()
+{
+    if (program)
+        return true;
+
+    program = compile_compute_program(depth_pyramid_comp);
+    if (!program)
+        return false;
+
+    GL_CHECK(glUseProgram(program));
+    GL_CHECK(glUniform1i(glGetUniformLocation(program, "sSource"), 0));
+    GL_CHECK(source_level_loc = glGetUniformLocation(program, "uSourceLevel"));
+    GL_CHECK(glUseProgram(0));
+
+    levels = 1;
+    while ((DEPTH_PYRAMID_SIZE >> levels) > 0)
+        levels++;
+
+    // R32F since depth textures can't be written as images. Nearest filtering, the texels are fetched directly.
+    GL_CHECK(glGenTextures(1, &texture));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, levels, GL_R32F, DEPTH_PYRAMID_SIZE, DEPTH_PYRAMID_SIZE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+    return true;
+}
+
+void DepthPyramid::build(GLuint depth_texture, const mat4& view_projection)
+{
+    GLint current_program = 0;
+    GL_CHECK(glGetIntegerv(GL_CURRENT_PROGRAM, &current_program));
+    GL_CHECK(glUseProgram(program));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+
+    // The first dispatch reduces the depth buffer into level 0, every following one halves the previous level.
+    // One level per dispatch, since the depth buffer is rarely a power of two and HiZCulling's 32x32 tiles need one.
+    for (unsigned int level = 0; level < levels; level++)
+    {
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, level ? texture : depth_texture));
+        GL_CHECK(glUniform1i(source_level_loc, level ? level - 1 : 0));
+        GL_CHECK(glBindImageTexture(0, texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F));
+
+        unsigned int size = DEPTH_PYRAMID_SIZE >> level;
+        unsigned int groups = (size + DEPTH_PYRAMID_GROUP_SIZE - 1) / DEPTH_PYRAMID_GROUP_SIZE;
+        GL_CHECK(glDispatchCompute(groups, groups, 1));
+
+        // The next dispatch and the culling shader read what was just written.
+        GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
+    }
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+    GL_CHECK(glUseProgram(current_program));
+
+    this->view_projection = view_projection;
+    valid = true;
+}
@@ -0,0 +1,62 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DEPTH_PYRAMID_H__
+#define DEPTH_PYRAMID_H__
+
+#include <GLES3/gl31.h>
+#include "vector_math.h"
+
+// Max-depth mip chain of the scene depth buffer, which GroundMesh occlusion culls the next frame against.
+// Same idea as HiZCulling in the OcclusionCulling sample, but reduced from the depth buffer the terrain left behind
+// instead of rasterized occluder proxies. Every texel holds the farthest depth of the screen region it covers,
+// so a box nearer than that everywhere it projects to is hidden.
+// The pyramid is square and a power of two whatever the viewport is. Level 0 takes the farthest of every
+// depth buffer pixel it overlaps, which keeps it conservative when the sizes don't divide.
+class DepthPyramid
+{
+public:
+    DepthPyramid();
+    ~DepthPyramid();
+
+    // Compiles the reduction shader and allocates the pyramid. Requires GLES 3.1.
+    bool init();
+
+    // Reduces miplevel 0 of depth_texture into the pyramid, view_projection being the matrix it was rendered with.
+    void build(GLuint depth_texture, const mat4& view_projection);
+
+    // Forgets the depth buffer, for when the next frame can't use it.
+    void invalidate() { valid = false; }
+    bool is_valid() const { return valid; }
+
+    GLuint get_texture() const { return texture; }
+    unsigned int get_levels() const { return levels; }
+    const mat4& get_view_projection() const { return view_projection; }
+
+private:
+    GLuint program;
+    GLuint texture;
+    GLint source_level_loc;
+    unsigned int levels;
+    mat4 view_projection;
+    bool valid;
+};
+
+#endif
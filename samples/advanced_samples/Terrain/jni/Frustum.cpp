@@ -20,6 +20,9 @@
 
 #include "Frustum.h"
 #include "AABB.h"
+#include "FrustumCulling.h"
+
+using namespace MaliSDK;
 
 Frustum::Frustum() {}
 
@@ -114,3 +117,9 @@ bool Frustum::intersects_aabb(const AABB& aabb) const
     return true;
 }
 //! [Test for intersection]
+
+// The planes are stored as consecutive vec4s, which is the layout FrustumCulling expects.
+unsigned int Frustum::intersects_aabbs(const AABBBatch& aabbs, unsigned char *visible) const
+{
+    return FrustumCulling::testAABBs(planes[0].data, aabbs.get_arrays(), aabbs.size(), visible);
+}
@@ -26,6 +26,7 @@
 // Representation of a frustum using 6 plane equations.
 
 class AABB;
+class AABBBatch;
 class Frustum
 {
 public:
@@ -33,6 +34,12 @@ public:
     Frustum(const mat4& view_projection);
     bool intersects_aabb(const AABB& aabb) const;
 
+    // Batched version of intersects_aabb(). Writes 1 or 0 per AABB to visible, and returns the number of visible AABBs.
+    unsigned int intersects_aabbs(const AABBBatch& aabbs, unsigned char *visible) const;
+
+    // Near, far, left, right, top, bottom.
+    const vec4& get_plane(unsigned int index) const { return planes[index]; }
+
 private:
     vec4 planes[6];
 };
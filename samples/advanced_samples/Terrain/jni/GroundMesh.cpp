@@ -29,7 +29,9 @@ using namespace MaliSDK;
 using namespace std;
 
 GroundMesh::GroundMesh(unsigned int size, unsigned int levels, float clip_scale)
-    : size(size), level_size(4 * size - 1), levels(levels), clipmap_scale(clip_scale)
+    : size(size), level_size(4 * size - 1), levels(levels), clipmap_scale(clip_scale),
+    gpu_culling(false), cull_program(0), candidate_buffer(0), draw_command_buffer(0), instance_buffer(0), num_candidates(0), occlusion(NULL),
+    baked_vertices(false), bake_program(0), baked_buffer(0), baked_index_buffer(0), baked_vertex_array(0), dirty_levels(levels, true)
 {
     setup_vertex_buffer(size);
     setup_index_buffer(size);
@@ -48,6 +50,22 @@ GroundMesh::~GroundMesh()
     GL_CHECK(glDeleteBuffers(1, &index_buffer));
     GL_CHECK(glDeleteBuffers(1, &uniform_buffer));
     GL_CHECK(glDeleteVertexArrays(1, &vertex_array));
+
+    if (cull_program)
+    {
+        GL_CHECK(glDeleteProgram(cull_program));
+        GL_CHECK(glDeleteBuffers(1, &candidate_buffer));
+        GL_CHECK(glDeleteBuffers(1, &draw_command_buffer));
+        GL_CHECK(glDeleteBuffers(1, &instance_buffer));
+    }
+
+    if (bake_program)
+    {
+        GL_CHECK(glDeleteProgram(bake_program));
+        GL_CHECK(glDeleteBuffers(1, &baked_buffer));
+        GL_CHECK(glDeleteBuffers(1, &baked_index_buffer));
+        GL_CHECK(glDeleteVertexArrays(1, &baked_vertex_array));
+    }
 }
 
 //! [Snapping clipmap level to a grid]
@@ -80,9 +98,16 @@ vec2 GroundMesh::get_offset_level(const vec2& camera_pos, unsigned int level)
 
 void GroundMesh::update_level_offsets(const vec2& camera_pos)
 {
-    level_offsets.resize(levels);
+    level_offsets.resize(levels, vec2(0.0f));
     for (unsigned int i = 0; i < levels; i++)
-        level_offsets[i] = get_offset_level(camera_pos, i);
+    {
+        vec2 offset = get_offset_level(camera_pos, i);
+
+        // The baked vertices of a level only have to be redone when it moves.
+        if (offset.c.x != level_offsets[i].c.x || offset.c.y != level_offsets[i].c.y)
+            dirty_levels[i] = true;
+        level_offsets[i] = offset;
+    }
 }
 
 // Since we use instanced drawing, all the different instances of various block types
@@ -132,12 +157,8 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_horiz_fixup(InstanceData *instanc
         instance.texture_offset = vec_fract((instance.offset / vec2(1 << i)) * instance.texture_scale);
         instance.offset *= vec2(clipmap_scale);
 
-        // Only add the instance if it's visible.
-        if (intersects_frustum(instance.offset, horizontal.range, i))
-        {
-            *instances++ = instance;
-            info.instances++;
-        }
+        // Only keeps the instance if it's visible, see cull_instances().
+        add_instance(instances, info, instance, horizontal.range, i);
 
         // Right side horizontal fixup region.
         instance.offset = level_offsets[i];
@@ -145,12 +166,8 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_horiz_fixup(InstanceData *instanc
         instance.texture_offset = vec_fract((instance.offset / vec2(1 << i)) * instance.texture_scale);
         instance.offset *= vec2(clipmap_scale);
 
-        // Only add the instance if it's visible.
-        if (intersects_frustum(instance.offset, horizontal.range, i))
-        {
-            *instances++ = instance;
-            info.instances++;
-        }
+        // Only keeps the instance if it's visible, see cull_instances().
+        add_instance(instances, info, instance, horizontal.range, i);
     }
 
     return info;
@@ -179,11 +196,7 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_vert_fixup(InstanceData *instance
         instance.texture_offset = vec_fract((instance.offset / vec2(1 << i)) * instance.texture_scale);
         instance.offset *= vec2(clipmap_scale);
 
-        if (intersects_frustum(instance.offset, vertical.range, i))
-        {
-            *instances++ = instance;
-            info.instances++;
-        }
+        add_instance(instances, info, instance, vertical.range, i);
 
         // Bottom region
         instance.offset = level_offsets[i];
@@ -191,11 +204,7 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_vert_fixup(InstanceData *instance
         instance.texture_offset = vec_fract((instance.offset / vec2(1 << i)) * instance.texture_scale);
         instance.offset *= vec2(clipmap_scale);
 
-        if (intersects_frustum(instance.offset, vertical.range, i))
-        {
-            *instances++ = instance;
-            info.instances++;
-        }
+        add_instance(instances, info, instance, vertical.range, i);
     }
 
     return info;
@@ -227,11 +236,7 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_degenerate(InstanceData *instance
         instance.offset *= vec2(clipmap_scale);
         instance.scale = clipmap_scale * float(1 << i);
 
-        if (intersects_frustum(instance.offset, block.range, i))
-        {
-            *instances++ = instance;
-            info.instances++;
-        }
+        add_instance(instances, info, instance, block.range, i);
     }
 
     return info;
@@ -275,11 +280,7 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_trim_full(InstanceData *instances
     instance.offset *= vec2(clipmap_scale);
     instance.scale = clipmap_scale * float(1 << 1);
 
-    if (intersects_frustum(instance.offset, trim_full.range, 1))
-    {
-        *instances = instance;
-        info.instances++;
-    }
+    add_instance(instances, info, instance, trim_full.range, 1);
 
     return info;
 }
@@ -315,11 +316,7 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_trim(InstanceData *instances, con
         instance.offset *= vec2(clipmap_scale);
         instance.scale = clipmap_scale * float(1 << i);
 
-        if (intersects_frustum(instance.offset, block.range, i))
-        {
-            *instances++ = instance;
-            info.instances++;
-        }
+        add_instance(instances, info, instance, block.range, i);
     }
 
     return info;
@@ -390,11 +387,7 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_blocks(InstanceData *instances)
             instance.texture_offset = vec_fract(instance.offset * instance.texture_scale);
             instance.offset *= vec2(clipmap_scale);
 
-            if (intersects_frustum(instance.offset, block.range, 0))
-            {
-                *instances++ = instance;
-                info.instances++;
-            }
+            add_instance(instances, info, instance, block.range, 0);
         }
     }
 
@@ -429,11 +422,7 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_blocks(InstanceData *instances)
                 instance.texture_offset = vec_fract((instance.offset / vec2(1 << i)) * instance.texture_scale);
                 instance.offset *= vec2(clipmap_scale);
 
-                if (intersects_frustum(instance.offset, block.range, i))
-                {
-                    *instances++ = instance;
-                    info.instances++;
-                }
+                add_instance(instances, info, instance, block.range, i);
             }
         }
     }
@@ -441,7 +430,9 @@ GroundMesh::DrawInfo GroundMesh::get_draw_info_blocks(InstanceData *instances)
     return info;
 }
 
-bool GroundMesh::intersects_frustum(const vec2& offset, const vec2& range, unsigned int level)
+// All the get_draw_info_* calls generate every possible instance.
+// The bounding boxes are queued up here and tested in one batch by cull_instances().
+void GroundMesh::add_instance(InstanceData *&instances, DrawInfo& info, const InstanceData& instance, const vec2& range, unsigned int level)
 {
     // These depend on the heightmap itself. These should be as small as possible to be able to cull more blocks.
     // We know the range of the block in the XZ-plane, but not in Y as it depends on the heightmap texture.
@@ -451,10 +442,12 @@ bool GroundMesh::intersects_frustum(const vec2& offset, const vec2& range, unsig
 
     // Create an axis-aligned bounding box.
     // Add a twiddle factor to account for potential precision issues.
-    AABB aabb(vec3(offset.c.x, y_min, offset.c.y) + vec3(-0.01f),
+    AABB aabb(vec3(instance.offset.c.x, y_min, instance.offset.c.y) + vec3(-0.01f),
         vec3(range.c.x, 0.0f, range.c.y) * vec3(float(1 << level)) * vec3(clipmap_scale) + vec3(0, y_max - y_min, 0) + vec3(0.02f));
+    culling_boxes.push_back(aabb);
 
-    return view_proj_frustum.intersects_aabb(aabb);
+    *instances++ = instance;
+    info.instances++;
 }
 
 // Helper template to keep the ugly pointer casting to one place.
@@ -464,24 +457,19 @@ static inline T *buffer_offset(T *buffer, size_t offset)
     return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(buffer) + offset);
 }
 
-// Round up to nearest aligned offset.
-static inline unsigned int realign_offset(size_t offset, size_t align)
-{
-    return (offset + align - 1) & ~(align - 1);
-}
-
-void GroundMesh::update_draw_list(DrawInfo& info, size_t& uniform_buffer_offset)
+void GroundMesh::update_draw_list(DrawInfo& info, size_t& first_instance)
 {
-    info.uniform_buffer_offset = uniform_buffer_offset;
+    info.first_instance = first_instance;
     draw_list.push_back(info);
-
-    // Have to ensure that the uniform buffer is always bound at aligned offsets.
-    uniform_buffer_offset = realign_offset(uniform_buffer_offset + info.instances * sizeof(InstanceData), uniform_buffer_align);
+    first_instance += info.instances;
 }
 
-void GroundMesh::update_draw_list()
+// Frustum cull all the instances generated by the get_draw_info_* calls at once,
+// and write the survivors of every draw to the uniform buffer.
+void GroundMesh::cull_instances()
 {
-    draw_list.clear();
+    culling_visible.resize(culling_boxes.size());
+    view_proj_frustum.intersects_aabbs(culling_boxes, &culling_visible[0]);
 
     GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, uniform_buffer));
 
@@ -492,64 +480,93 @@ void GroundMesh::update_draw_list()
     if (!data)
     {
         LOGE("Failed to map uniform buffer.\n");
+        draw_list.clear();
         return;
     }
 
-    DrawInfo info;
     size_t uniform_buffer_offset = 0;
+    for (vector<DrawInfo>::iterator itr = draw_list.begin(); itr != draw_list.end(); ++itr)
+    {
+        InstanceData *instances = buffer_offset(data, uniform_buffer_offset);
+        unsigned int visible = 0;
+        for (unsigned int i = 0; i < itr->instances; i++)
+            if (culling_visible[itr->first_instance + i])
+                instances[visible++] = candidate_instances[itr->first_instance + i];
+
+        itr->instances = visible;
+        itr->uniform_buffer_offset = uniform_buffer_offset;
+
+        // Have to ensure that the uniform buffer is always bound at aligned offsets.
+        uniform_buffer_offset = realign_offset(uniform_buffer_offset + visible * sizeof(InstanceData), uniform_buffer_align);
+    }
+
+    GL_CHECK(glUnmapBuffer(GL_UNIFORM_BUFFER));
+}
+
+void GroundMesh::update_draw_list()
+{
+    draw_list.clear();
+    culling_boxes.clear();
+
+    // Upper bound of the number of instances, see setup_uniform_buffer().
+    candidate_instances.resize(uniform_buffer_size / sizeof(InstanceData));
+    InstanceData *data = &candidate_instances[0];
+
+    DrawInfo info;
+    size_t first_instance = 0;
 
     // Create a draw list. The number of draw calls is equal to the different types
     // of blocks. The blocks are instanced as necessary in the get_draw_info* calls.
 
     // Main blocks
-    info = get_draw_info_blocks(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_blocks(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Vertical ring fixups
-    info = get_draw_info_vert_fixup(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_vert_fixup(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Horizontal ring fixups
-    info = get_draw_info_horiz_fixup(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_horiz_fixup(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Left-side degenerates
-    info = get_draw_info_degenerate_left(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_degenerate_left(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Right-side degenerates
-    info = get_draw_info_degenerate_right(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_degenerate_right(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Top-side degenerates
-    info = get_draw_info_degenerate_top(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_degenerate_top(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Bottom-side degenerates
-    info = get_draw_info_degenerate_bottom(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_degenerate_bottom(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Full trim
-    info = get_draw_info_trim_full(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_trim_full(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Top-right trim
-    info = get_draw_info_trim_top_right(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_trim_top_right(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Top-left trim
-    info = get_draw_info_trim_top_left(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_trim_top_left(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Bottom-right trim
-    info = get_draw_info_trim_bottom_right(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_trim_bottom_right(data + first_instance);
+    update_draw_list(info, first_instance);
 
     // Bottom-left trim
-    info = get_draw_info_trim_bottom_left(buffer_offset(data, uniform_buffer_offset));
-    update_draw_list(info, uniform_buffer_offset);
+    info = get_draw_info_trim_bottom_left(data + first_instance);
+    update_draw_list(info, first_instance);
 
-    GL_CHECK(glUnmapBuffer(GL_UNIFORM_BUFFER));
+    cull_instances();
 }
 
 //! [Rendering the entire terrain]
@@ -574,12 +591,23 @@ void GroundMesh::render_draw_list()
 //! [Render scene]
 void GroundMesh::render()
 {
-    // Create a draw-list.
-    update_draw_list();
+    // Create a draw-list. The baked path draws the blocks of the CPU draw list one by one.
+    if (gpu_culling && !baked_vertices)
+        update_draw_commands();
+    else
+        update_draw_list();
+
+    if (baked_vertices)
+        bake_levels();
 
     // Explicitly bind and unbind GL state to ensure clarity.
-    GL_CHECK(glBindVertexArray(vertex_array));
-    render_draw_list();
+    GL_CHECK(glBindVertexArray(baked_vertices ? baked_vertex_array : vertex_array));
+    if (baked_vertices)
+        render_baked_draw_list();
+    else if (gpu_culling)
+        render_draw_commands();
+    else
+        render_draw_list();
     GL_CHECK(glBindVertexArray(0));
     GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
     GL_CHECK(glBindBufferBase(GL_UNIFORM_BUFFER, 0, 0));
@@ -22,10 +22,18 @@
 #define GROUND_MESH_H__
 
 #include <vector>
-#include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
 #include <stddef.h>
 #include "vector_math.h"
 #include "Frustum.h"
+#include "AABB.h"
+#include "DepthPyramid.h"
+
+// Round up to nearest aligned offset, align must be a power of two.
+static inline size_t realign_offset(size_t offset, size_t align)
+{
+    return (offset + align - 1) & ~(align - 1);
+}
 
 class GroundMesh
 {
@@ -39,6 +47,22 @@ public:
 
     void render();
 
+    // Cull and build the draw list with a compute shader and render with glDrawElementsIndirect.
+    // Returns false if this was requested but the context is older than GLES 3.1.
+    bool set_gpu_culling(bool enable);
+    bool get_gpu_culling() const { return gpu_culling; }
+
+    // Occlusion cull the blocks against the depth of the previous frame as well, NULL to only frustum cull.
+    // Only the GPU culling path uses it.
+    void set_occlusion(const DepthPyramid *pyramid) { occlusion = pyramid; }
+
+    // Bake heights and normals into a vertex buffer with a compute shader whenever a clipmap level moves, so the
+    // vertex shader built with BAKED_VERTICES doesn't sample the heightmap. Blocks are culled on the CPU in this mode.
+    // The heightmap must be bound to texture unit 0 when rendering, as for the regular path.
+    // Returns false if this was requested but the context is older than GLES 3.1.
+    bool set_baked_vertices(bool enable);
+    bool get_baked_vertices() const { return baked_vertices; }
+
 private:
     GLuint vertex_buffer, index_buffer, vertex_array, uniform_buffer;
     unsigned int size;
@@ -85,11 +109,13 @@ private:
     void setup_vertex_array();
 
     void update_draw_list();
+    void cull_instances();
     void render_draw_list();
     struct DrawInfo
     {
         size_t index_buffer_offset;
         size_t uniform_buffer_offset;
+        size_t first_instance; // Index of the first candidate instance before culling.
         unsigned int indices;
         unsigned int instances;
     };
@@ -101,7 +127,7 @@ private:
     typedef bool (*TrimConditional)(const vec2& offset);
 
     vec2 get_offset_level(const vec2& camera_pos, unsigned int level);
-    void update_draw_list(DrawInfo& info, size_t& ubo_offset);
+    void update_draw_list(DrawInfo& info, size_t& first_instance);
     DrawInfo get_draw_info_blocks(InstanceData *instance_data);
     DrawInfo get_draw_info_vert_fixup(InstanceData *instance_data);
     DrawInfo get_draw_info_horiz_fixup(InstanceData *instance_data);
@@ -117,9 +143,96 @@ private:
     DrawInfo get_draw_info_trim_bottom_right(InstanceData *instance_data);
     DrawInfo get_draw_info_trim_bottom_left(InstanceData *instance_data);
 
-    bool intersects_frustum(const vec2& offset, const vec2& range, unsigned int level);
+    void add_instance(InstanceData *&instances, DrawInfo& info, const InstanceData& instance, const vec2& range, unsigned int level);
+    std::vector<InstanceData> candidate_instances;
+    AABBBatch culling_boxes;
+    std::vector<unsigned char> culling_visible;
 
     Frustum view_proj_frustum;
+
+    // GPU-driven path. The draws are issued in the same order as update_draw_list() does.
+    enum DrawType
+    {
+        DRAW_BLOCKS,
+        DRAW_VERT_FIXUP,
+        DRAW_HORIZ_FIXUP,
+        DRAW_DEGENERATE_LEFT,
+        DRAW_DEGENERATE_RIGHT,
+        DRAW_DEGENERATE_TOP,
+        DRAW_DEGENERATE_BOTTOM,
+        DRAW_TRIM_FULL,
+        DRAW_TRIM_TOP_RIGHT,
+        DRAW_TRIM_TOP_LEFT,
+        DRAW_TRIM_BOTTOM_RIGHT,
+        DRAW_TRIM_BOTTOM_LEFT,
+        NUM_DRAW_TYPES
+    };
+
+    // Must match the compute shader (std430).
+    struct Candidate
+    {
+        vec2 offset; // Relative to the level offset, in texels of that level.
+        vec2 range;
+        GLuint draw;
+        GLuint level;
+        GLuint trim;
+        GLuint padding;
+    };
+
+    // Layout mandated by glDrawElementsIndirect.
+    struct DrawCommand
+    {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint reserved;
+    };
+
+    bool gpu_culling;
+    GLuint cull_program;
+    GLuint candidate_buffer, draw_command_buffer, instance_buffer;
+    unsigned int num_candidates;
+    GLint level_offsets_loc;
+    GLint frustum_loc;
+    GLint occlusion_loc;
+    GLint previous_view_proj_loc;
+    GLint depth_pyramid_levels_loc;
+    const DepthPyramid *occlusion;
+
+    DrawCommand draw_commands[NUM_DRAW_TYPES]; // Instance counts are zero, reuploaded every frame.
+    size_t instance_buffer_offset[NUM_DRAW_TYPES];
+    unsigned int instance_capacity[NUM_DRAW_TYPES];
+
+    void setup_gpu_culling();
+    void add_candidate(std::vector<Candidate>& candidates, DrawType draw, const Block& block,
+        const vec2& offset, unsigned int level, unsigned int trim = 0);
+    void update_draw_commands();
+    void render_draw_commands();
+
+    // Baked path, see GroundMeshBaked.cpp. Every level has a level_size-by-level_size grid of vertices,
+    // which the blocks index with a stride of level_size rather than into the shared vertex buffer.
+    struct BakedVertex
+    {
+        GLfloat heights[2]; // Same as the RG channels of the heightmap.
+        GLbyte normal[4]; // Packed by the compute shader, W is unused.
+    };
+
+    bool baked_vertices;
+    GLuint bake_program;
+    GLuint baked_buffer, baked_index_buffer, baked_vertex_array;
+    GLint bake_origin_loc, bake_level_loc, bake_first_vertex_loc, bake_spacing_loc;
+
+    // Copies of the shared vertex and index buffers, used to build baked_index_buffer.
+    std::vector<GLubyte> grid_vertices;
+    std::vector<GLushort> grid_indices;
+
+    // Levels which moved since they were last baked, set in update_level_offsets().
+    std::vector<bool> dirty_levels;
+
+    void setup_baked_vertices();
+    void bake_levels();
+    void render_baked_draw_list();
 };
 
 #endif
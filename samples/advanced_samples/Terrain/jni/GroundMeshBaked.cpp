@@ -0,0 +1,204 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GroundMesh.h"
+#include "ComputeProgram.h"
+#include "Platform.h"
+#include "embedded_shaders.h"
+#include <cmath>
+#include <cstdint>
+
+using namespace MaliSDK;
+using namespace std;
+
+// Alternative to sampling the heightmap in the vertex shader for every vertex, every frame.
+// A level only moves every few frames, so its heights are baked into a vertex buffer by a compute shader when it does,
+// along with a normal, and the vertex shader just reads them as attributes. This costs a level_size-by-level_size
+// grid of vertices per level, which is 12 bytes * 255 * 255, about 760 KiB, for each level with the default size.
+//
+// The grid of a level starts at the top-left vertex of the level. Blocks are laid out relative to that vertex
+// (see get_draw_info_*), so a block whose top-left vertex is at (x, z) in the level reads the grid starting at
+// vertex z * level_size + x. The blocks are indexed with a stride of level_size, and each block is drawn by itself
+// with the attributes pointing at its first vertex, since GLES has no base vertex for instanced draws.
+
+// Must match the compute shader.
+#define BAKE_GROUP_SIZE 8
+
+// Already defined in the shader.
+#define LOCATION_HEIGHTS 1
+#define LOCATION_NORMAL 2
+#define LOCATION_INSTANCE 3
+
+void GroundMesh::setup_baked_vertices()
+{
+    // Remap every index into the shared vertex buffer to the vertex with the same coordinates in the level grid.
+    // The coordinates are within a block, so block placement is left to the attribute offsets.
+    vector<GLushort> indices(grid_indices.size());
+    for (size_t i = 0; i < grid_indices.size(); i++)
+    {
+        const GLubyte *vertex = &grid_vertices[2 * grid_indices[i]];
+        indices[i] = vertex[1] * level_size + vertex[0];
+    }
+
+    GL_CHECK(glGenBuffers(1, &baked_index_buffer));
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, baked_index_buffer));
+    GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), &indices[0], GL_STATIC_DRAW));
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+
+    GL_CHECK(glGenBuffers(1, &baked_buffer));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, baked_buffer));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, levels * level_size * level_size * sizeof(BakedVertex), NULL, GL_DYNAMIC_COPY));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+    // The attribute pointers are set for every block, see render_baked_draw_list().
+    // The instance is a constant attribute, and isn't part of the vertex array state.
+    GL_CHECK(glGenVertexArrays(1, &baked_vertex_array));
+    GL_CHECK(glBindVertexArray(baked_vertex_array));
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, baked_index_buffer));
+    GL_CHECK(glEnableVertexAttribArray(LOCATION_HEIGHTS));
+    GL_CHECK(glEnableVertexAttribArray(LOCATION_NORMAL));
+    GL_CHECK(glBindVertexArray(0));
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+
+    GL_CHECK(glUseProgram(bake_program));
+    GL_CHECK(glUniform1i(glGetUniformLocation(bake_program, "uSize"), level_size));
+    GL_CHECK(bake_origin_loc = glGetUniformLocation(bake_program, "uOrigin"));
+    GL_CHECK(bake_level_loc = glGetUniformLocation(bake_program, "uLevel"));
+    GL_CHECK(bake_first_vertex_loc = glGetUniformLocation(bake_program, "uFirstVertex"));
+    GL_CHECK(bake_spacing_loc = glGetUniformLocation(bake_program, "uSpacing"));
+    GL_CHECK(glUseProgram(0));
+}
+
+bool GroundMesh::set_baked_vertices(bool enable)
+{
+    // Levels are not tracked while disabled, so bake everything again.
+    dirty_levels.assign(levels, true);
+
+    if (!enable || bake_program)
+    {
+        baked_vertices = enable && bake_program;
+        return true;
+    }
+
+    GLint major = 0, minor = 0;
+    GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &major));
+    GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minor));
+    if (major < 3 || (major == 3 && minor < 1))
+    {
+        LOGI("Baked vertices require GLES 3.1, sampling the heightmap in the vertex shader.\n");
+        return false;
+    }
+
+    bake_program = compile_compute_program(ground_mesh_bake_comp);
+    if (!bake_program)
+        return false;
+
+    setup_baked_vertices();
+    baked_vertices = true;
+    return true;
+}
+
+void GroundMesh::bake_levels()
+{
+    // The terrain program is already bound by the caller, restore it afterwards.
+    GLint current_program = 0;
+    GL_CHECK(glGetIntegerv(GL_CURRENT_PROGRAM, &current_program));
+
+    GL_CHECK(glUseProgram(bake_program));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, baked_buffer));
+
+    bool baked = false;
+    for (unsigned int i = 0; i < levels; i++)
+    {
+        if (!dirty_levels[i])
+            continue;
+
+        // Level offsets are in multiples of the texel size of the level, see get_offset_level().
+        // Wrap the top-left texel to the heightmap, like GL_REPEAT does in the vertex shader.
+        int origin_x = int(floor(level_offsets[i].c.x / float(1 << i) + 0.5f)) % int(level_size);
+        int origin_z = int(floor(level_offsets[i].c.y / float(1 << i) + 0.5f)) % int(level_size);
+        if (origin_x < 0)
+            origin_x += level_size;
+        if (origin_z < 0)
+            origin_z += level_size;
+
+        GL_CHECK(glUniform2i(bake_origin_loc, origin_x, origin_z));
+        GL_CHECK(glUniform1i(bake_level_loc, i));
+        GL_CHECK(glUniform1ui(bake_first_vertex_loc, i * level_size * level_size));
+        GL_CHECK(glUniform1f(bake_spacing_loc, clipmap_scale * float(1 << i)));
+
+        unsigned int groups = (level_size + BAKE_GROUP_SIZE - 1) / BAKE_GROUP_SIZE;
+        GL_CHECK(glDispatchCompute(groups, groups, 1));
+
+        dirty_levels[i] = false;
+        baked = true;
+    }
+
+    // The baked vertices are sourced as vertex attributes.
+    if (baked)
+    {
+        GL_CHECK(glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT));
+    }
+
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0));
+    GL_CHECK(glUseProgram(current_program));
+}
+
+// Same as render_draw_list(), except that every block is a draw call of its own.
+void GroundMesh::render_baked_draw_list()
+{
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, baked_buffer));
+
+    for (vector<DrawInfo>::const_iterator itr = draw_list.begin(); itr != draw_list.end(); ++itr)
+    {
+        if (!itr->instances)
+            continue;
+
+        GL_CHECK(glBindBufferRange(GL_UNIFORM_BUFFER, 0, uniform_buffer,
+                    itr->uniform_buffer_offset, realign_offset(itr->instances * sizeof(InstanceData), uniform_buffer_align)));
+
+        // The instances in the uniform buffer are the visible candidates, in the same order, see cull_instances().
+        size_t candidate = itr->first_instance;
+        for (unsigned int i = 0; i < itr->instances; i++, candidate++)
+        {
+            while (!culling_visible[candidate])
+                candidate++;
+
+            // Recover the top-left vertex of the block within its level from the instance.
+            const InstanceData& instance = candidate_instances[candidate];
+            unsigned int level = unsigned(instance.level);
+            vec2 origin = instance.offset / vec2(instance.scale) - level_offsets[level] / vec2(1 << level);
+            size_t first_vertex = (level * level_size + unsigned(floor(origin.c.y + 0.5f))) * level_size +
+                unsigned(floor(origin.c.x + 0.5f));
+
+            const GLubyte *vertex = reinterpret_cast<const GLubyte*>(first_vertex * sizeof(BakedVertex));
+            GL_CHECK(glVertexAttribPointer(LOCATION_HEIGHTS, 2, GL_FLOAT, GL_FALSE, sizeof(BakedVertex),
+                vertex + offsetof(BakedVertex, heights)));
+            GL_CHECK(glVertexAttribPointer(LOCATION_NORMAL, 4, GL_BYTE, GL_TRUE, sizeof(BakedVertex),
+                vertex + offsetof(BakedVertex, normal)));
+            GL_CHECK(glVertexAttribI4i(LOCATION_INSTANCE, i, 0, 0, 0));
+
+            GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, itr->indices, GL_UNSIGNED_SHORT,
+                reinterpret_cast<const GLvoid*>(itr->index_buffer_offset * sizeof(GLushort))));
+        }
+    }
+
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
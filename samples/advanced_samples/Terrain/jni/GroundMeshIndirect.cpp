@@ -0,0 +1,293 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GroundMesh.h"
+#include "ComputeProgram.h"
+#include "Platform.h"
+#include "embedded_shaders.h"
+#include <algorithm>
+#include <cstdint>
+
+using namespace MaliSDK;
+using namespace std;
+
+// GPU-driven variant of update_draw_list() and render_draw_list().
+// All the possible block placements are static relative to their clipmap level, so they are uploaded once as candidates.
+// Every frame, a compute shader places, culls and appends the visible candidates to the instance buffer,
+// bumping the instance count of the matching indirect draw command. The CPU only uploads the level offsets and
+// frustum planes, and issues one indirect draw per block type, regardless of the number of clipmap levels.
+// The blocks can also be occlusion culled against a DepthPyramid of the previous frame, in the same dispatch.
+
+// Must match the compute shader.
+#define CULL_MAX_LEVELS 16
+#define CULL_GROUP_SIZE 64
+
+// Size of the InstanceData array in the vertex shader.
+#define MAX_INSTANCES_PER_DRAW 256
+
+enum TrimType
+{
+    TRIM_NONE = 0,
+    TRIM_TOP_RIGHT,
+    TRIM_TOP_LEFT,
+    TRIM_BOTTOM_RIGHT,
+    TRIM_BOTTOM_LEFT
+};
+
+void GroundMesh::add_candidate(vector<Candidate>& candidates, DrawType draw, const Block& block,
+        const vec2& offset, unsigned int level, unsigned int trim)
+{
+    Candidate candidate;
+    candidate.offset = offset;
+    candidate.range = block.range;
+    candidate.draw = draw;
+    candidate.level = level;
+    candidate.trim = trim;
+    candidate.padding = 0;
+    candidates.push_back(candidate);
+}
+
+void GroundMesh::setup_gpu_culling()
+{
+    // Same placements as the get_draw_info_* calls, see those for details.
+    vector<Candidate> candidates;
+
+    for (unsigned int z = 0; z < 4; z++)
+        for (unsigned int x = 0; x < 4; x++)
+            add_candidate(candidates, DRAW_BLOCKS, block, vec2(x, z) * vec2(size - 1), 0);
+
+    for (unsigned int i = 1; i < levels; i++)
+    {
+        for (unsigned int z = 0; z < 4; z++)
+        {
+            for (unsigned int x = 0; x < 4; x++)
+            {
+                if (z != 0 && z != 3 && x != 0 && x != 3)
+                    continue;
+
+                vec2 offset = vec2(x, z) * vec2(size - 1);
+                if (x >= 2)
+                    offset.c.x += 2;
+                if (z >= 2)
+                    offset.c.y += 2;
+                add_candidate(candidates, DRAW_BLOCKS, block, offset, i);
+            }
+        }
+    }
+
+    for (unsigned int i = 1; i < levels; i++)
+    {
+        add_candidate(candidates, DRAW_VERT_FIXUP, vertical, vec2(2 * (size - 1), 0), i);
+        add_candidate(candidates, DRAW_VERT_FIXUP, vertical, vec2(2 * (size - 1), 3 * (size - 1) + 2), i);
+    }
+
+    for (unsigned int i = 1; i < levels; i++)
+    {
+        add_candidate(candidates, DRAW_HORIZ_FIXUP, horizontal, vec2(0, 2 * (size - 1)), i);
+        add_candidate(candidates, DRAW_HORIZ_FIXUP, horizontal, vec2(3 * (size - 1) + 2, 2 * (size - 1)), i);
+    }
+
+    for (unsigned int i = 0; i + 1 < levels; i++)
+    {
+        vec2 ring = i > 0 ? vec2(2.0f) : vec2(0.0f);
+        add_candidate(candidates, DRAW_DEGENERATE_LEFT, degenerate_left, vec2(0.0f), i);
+        add_candidate(candidates, DRAW_DEGENERATE_RIGHT, degenerate_right, vec2(4 * (size - 1) + ring.c.x, 0.0f), i);
+        add_candidate(candidates, DRAW_DEGENERATE_TOP, degenerate_top, vec2(0.0f), i);
+        add_candidate(candidates, DRAW_DEGENERATE_BOTTOM, degenerate_bottom, vec2(0.0f, 4 * (size - 1) + 2 + ring.c.y), i);
+    }
+
+    if (levels > 1)
+        add_candidate(candidates, DRAW_TRIM_FULL, trim_full, vec2(size - 1), 1);
+
+    // Only one of the four trims is visible per level, the compute shader checks the snapping condition.
+    for (unsigned int i = 2; i < levels; i++)
+    {
+        add_candidate(candidates, DRAW_TRIM_TOP_RIGHT, trim_top_right, vec2(size - 1), i, TRIM_TOP_RIGHT);
+        add_candidate(candidates, DRAW_TRIM_TOP_LEFT, trim_top_left, vec2(size - 1), i, TRIM_TOP_LEFT);
+        add_candidate(candidates, DRAW_TRIM_BOTTOM_RIGHT, trim_bottom_right, vec2(size - 1), i, TRIM_BOTTOM_RIGHT);
+        add_candidate(candidates, DRAW_TRIM_BOTTOM_LEFT, trim_bottom_left, vec2(size - 1), i, TRIM_BOTTOM_LEFT);
+    }
+
+    num_candidates = candidates.size();
+
+    // Template for the indirect draws. The instance counts are filled in by the compute shader.
+    const Block *blocks[NUM_DRAW_TYPES] = {
+        &block, &vertical, &horizontal,
+        &degenerate_left, &degenerate_right, &degenerate_top, &degenerate_bottom,
+        &trim_full, &trim_top_right, &trim_top_left, &trim_bottom_right, &trim_bottom_left,
+    };
+
+    for (unsigned int i = 0; i < NUM_DRAW_TYPES; i++)
+    {
+        draw_commands[i].count = blocks[i]->count;
+        draw_commands[i].instance_count = 0;
+        draw_commands[i].first_index = blocks[i]->offset;
+        draw_commands[i].base_vertex = 0;
+        draw_commands[i].reserved = 0;
+        instance_capacity[i] = 0;
+    }
+
+    for (vector<Candidate>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+        instance_capacity[itr->draw]++;
+
+    // Every draw type gets its own, worst case sized, slice of the instance buffer.
+    // The slices are bound as uniform buffers, so they must be aligned for that as well as being a whole number of instances.
+    size_t align = max(size_t(uniform_buffer_align), sizeof(InstanceData));
+    size_t instance_buffer_size = 0;
+    GLuint instance_base[NUM_DRAW_TYPES];
+    for (unsigned int i = 0; i < NUM_DRAW_TYPES; i++)
+    {
+        instance_buffer_offset[i] = instance_buffer_size;
+        instance_base[i] = instance_buffer_size / sizeof(InstanceData);
+        instance_buffer_size = realign_offset(instance_buffer_size + instance_capacity[i] * sizeof(InstanceData), align);
+    }
+
+    GL_CHECK(glGenBuffers(1, &candidate_buffer));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, candidate_buffer));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, candidates.size() * sizeof(Candidate), &candidates[0], GL_STATIC_DRAW));
+
+    GL_CHECK(glGenBuffers(1, &instance_buffer));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, instance_buffer));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, instance_buffer_size, NULL, GL_DYNAMIC_COPY));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+    GL_CHECK(glGenBuffers(1, &draw_command_buffer));
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, draw_command_buffer));
+    GL_CHECK(glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(draw_commands), draw_commands, GL_DYNAMIC_DRAW));
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+
+    // Everything except the level offsets, the frustum and the occlusion state is constant.
+    GL_CHECK(glUseProgram(cull_program));
+    GL_CHECK(glUniform1ui(glGetUniformLocation(cull_program, "uNumCandidates"), num_candidates));
+    GL_CHECK(glUniform1uiv(glGetUniformLocation(cull_program, "uInstanceBase"), NUM_DRAW_TYPES, instance_base));
+    GL_CHECK(glUniform1f(glGetUniformLocation(cull_program, "uClipmapScale"), clipmap_scale));
+    GL_CHECK(glUniform1f(glGetUniformLocation(cull_program, "uTextureScale"), 1.0f / level_size));
+    GL_CHECK(glUniform1f(glGetUniformLocation(cull_program, "uTrimOffset"), float(size - 1)));
+    GL_CHECK(level_offsets_loc = glGetUniformLocation(cull_program, "uLevelOffsets"));
+    GL_CHECK(frustum_loc = glGetUniformLocation(cull_program, "uFrustum"));
+    GL_CHECK(occlusion_loc = glGetUniformLocation(cull_program, "uOcclusion"));
+    GL_CHECK(previous_view_proj_loc = glGetUniformLocation(cull_program, "uPreviousViewProjection"));
+    GL_CHECK(depth_pyramid_levels_loc = glGetUniformLocation(cull_program, "uDepthPyramidLevels"));
+
+    // Unit 0 is the heightmap, which the vertex shader samples.
+    GL_CHECK(glUniform1i(glGetUniformLocation(cull_program, "sDepthPyramid"), 1));
+    GL_CHECK(glUseProgram(0));
+}
+
+bool GroundMesh::set_gpu_culling(bool enable)
+{
+    if (!enable || cull_program)
+    {
+        gpu_culling = enable && cull_program;
+        return true;
+    }
+
+    GLint major = 0, minor = 0;
+    GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &major));
+    GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minor));
+    if (major < 3 || (major == 3 && minor < 1))
+    {
+        LOGI("GPU culling requires GLES 3.1, staying on the CPU path.\n");
+        return false;
+    }
+
+    // Per level we can draw 12 regular blocks, that must fit in a single uniform block in the vertex shader.
+    if (levels > CULL_MAX_LEVELS || 16 + 12 * (levels - 1) > MAX_INSTANCES_PER_DRAW)
+    {
+        LOGE("Too many clipmap levels (%u) for GPU culling.\n", levels);
+        return false;
+    }
+
+    cull_program = compile_compute_program(ground_mesh_cull_comp);
+    if (!cull_program)
+        return false;
+
+    setup_gpu_culling();
+    gpu_culling = true;
+    return true;
+}
+
+void GroundMesh::update_draw_commands()
+{
+    // The terrain program is already bound by the caller, restore it afterwards.
+    GLint current_program = 0;
+    GL_CHECK(glGetIntegerv(GL_CURRENT_PROGRAM, &current_program));
+
+    // Reset the instance counts.
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, draw_command_buffer));
+    GL_CHECK(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(draw_commands), draw_commands));
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+
+    vec4 planes[6];
+    for (unsigned int i = 0; i < 6; i++)
+        planes[i] = view_proj_frustum.get_plane(i);
+
+    GL_CHECK(glUseProgram(cull_program));
+    GL_CHECK(glUniform2fv(level_offsets_loc, levels, level_offsets[0].data));
+    GL_CHECK(glUniform4fv(frustum_loc, 6, planes[0].data));
+
+    bool occlusion_culling = occlusion && occlusion->is_valid();
+    GL_CHECK(glUniform1i(occlusion_loc, occlusion_culling));
+    if (occlusion_culling)
+    {
+        GL_CHECK(glUniformMatrix4fv(previous_view_proj_loc, 1, GL_FALSE, occlusion->get_view_projection().data));
+        GL_CHECK(glUniform1i(depth_pyramid_levels_loc, occlusion->get_levels()));
+        GL_CHECK(glActiveTexture(GL_TEXTURE1));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, occlusion->get_texture()));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    }
+
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, candidate_buffer));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, draw_command_buffer));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, instance_buffer));
+    GL_CHECK(glDispatchCompute((num_candidates + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1));
+
+    // The draw commands are sourced as indirect arguments, and the instances as uniform buffers.
+    GL_CHECK(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_UNIFORM_BARRIER_BIT));
+
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0));
+    if (occlusion_culling)
+    {
+        GL_CHECK(glActiveTexture(GL_TEXTURE1));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    }
+    GL_CHECK(glUseProgram(current_program));
+}
+
+void GroundMesh::render_draw_commands()
+{
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, draw_command_buffer));
+    for (unsigned int i = 0; i < NUM_DRAW_TYPES; i++)
+    {
+        if (!instance_capacity[i])
+            continue;
+
+        // We don't know how many instances survived culling, so bind the whole slice.
+        GL_CHECK(glBindBufferRange(GL_UNIFORM_BUFFER, 0, instance_buffer,
+                    instance_buffer_offset[i], realign_offset(instance_capacity[i] * sizeof(InstanceData), uniform_buffer_align)));
+
+        GL_CHECK(glDrawElementsIndirect(GL_TRIANGLE_STRIP, GL_UNSIGNED_SHORT,
+            reinterpret_cast<const GLvoid*>(i * sizeof(DrawCommand))));
+    }
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+}
@@ -182,6 +182,8 @@ void GroundMesh::setup_vertex_buffer(unsigned int size)
     GL_CHECK(glBufferData(GL_ARRAY_BUFFER, 2 * num_vertices * sizeof(GLubyte), vertices, GL_STATIC_DRAW));
     GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
 
+    // The baked path remaps the indices into its own vertex layout, see setup_baked_vertices().
+    grid_vertices.assign(vertices, vertices + 2 * num_vertices);
     delete[] vertices;
 }
 
@@ -399,6 +401,7 @@ void GroundMesh::setup_index_buffer(unsigned int size)
     GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, num_indices * sizeof(GLushort), indices, GL_STATIC_DRAW));
     GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 
+    grid_indices.assign(indices, indices + num_indices);
     delete[] indices;
 }
 
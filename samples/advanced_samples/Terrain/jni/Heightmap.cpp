@@ -20,6 +20,9 @@
 
 #include "Heightmap.h"
 #include "Platform.h"
+#include "embedded_shaders.h"
+#include "ComputeProgram.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
@@ -29,55 +32,85 @@ using namespace MaliSDK;
 using namespace std;
 
 Heightmap::Heightmap(unsigned int size, unsigned int levels)
-    : size(size), levels(levels)
+    : compute_generation(false), compute_program(0), lut_texture(0), size(size), levels(levels), update_budget(0)
 {
-    //! [Initializing texture array]
-    GL_CHECK(glGenTextures(1, &texture));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, texture));
-
     // Use half-float as we don't need full float precision.
     // GL_RG16UI would work as well as we don't need texture filtering.
     // 8-bit does not give sufficient precision except for low-detail heightmaps.
     // Use two components to allow storing current level's height as well as the height of the next level.
-    GL_CHECK(glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RG16F, size, size, levels));
-
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    init_texture(GL_RG16F);
 
-    // The repeat is crucial here. This allows us to update small sections of the texture when moving the camera.
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT));
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT));
+    // One worker per big core, the rendering thread is the last one.
+    job_scheduler.initialize(0);
 
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
-    //! [Initializing texture array]
-
-    // Upload to alternating PBOs for better pipelining.
-    GL_CHECK(glGenBuffers(2, pixel_buffer));
+    // Upload through a ring of PBOs for better pipelining.
+    GL_CHECK(glGenBuffers(PIXEL_BUFFER_RING_SIZE, pixel_buffer));
     pixel_buffer_index = 0;
-    for (unsigned int i = 0; i < 2; i++)
+    pixel_buffer_size = levels * size * size * sizeof(vec2);
+    pixel_buffer_size *= 2; // Double because in worst case we update same region twice.
+    for (unsigned int i = 0; i < PIXEL_BUFFER_RING_SIZE; i++)
     {
         GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer[i]));
-        pixel_buffer_size = levels * size * size * sizeof(vec2);
-        pixel_buffer_size *= 2; // Double because in worst case we update same region twice.
         GL_CHECK(glBufferData(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_size, NULL, GL_STREAM_DRAW));
+        pixel_buffer_fence[i] = NULL;
     }
     GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
 
     reset();
 }
 
+// Texture storage is immutable, so switching to a different format means creating a new texture.
+void Heightmap::init_texture(GLenum format)
+{
+    //! [Initializing texture array]
+    GL_CHECK(glGenTextures(1, &texture));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, texture));
+    GL_CHECK(glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, format, size, size, levels));
+
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+
+    // The repeat is crucial here. This allows us to update small sections of the texture when moving the camera.
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT));
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+    //! [Initializing texture array]
+}
+
 void Heightmap::reset()
 {
     init_heightmap();
     level_info.resize(levels);
     for (unsigned int i = 0; i < levels; i++)
         level_info[i].cleared = true;
+
+    upload_stats.updates = 0;
+    upload_stats.regions = 0;
+    upload_stats.bytes = 0;
+    upload_stats.stalls = 0;
+    upload_stats.deferred = 0;
 }
 
 Heightmap::~Heightmap()
 {
     GL_CHECK(glDeleteTextures(1, &texture));
-    GL_CHECK(glDeleteBuffers(2, pixel_buffer));
+    if (lut_texture)
+    {
+        GL_CHECK(glDeleteTextures(1, &lut_texture));
+    }
+    if (compute_program)
+    {
+        GL_CHECK(glDeleteProgram(compute_program));
+    }
+    for (unsigned int i = 0; i < PIXEL_BUFFER_RING_SIZE; i++)
+    {
+        if (pixel_buffer_fence[i])
+        {
+            GL_CHECK(glDeleteSync(pixel_buffer_fence[i]));
+        }
+    }
+    GL_CHECK(glDeleteBuffers(PIXEL_BUFFER_RING_SIZE, pixel_buffer));
 }
 
 // Divides, but always rounds down.
@@ -183,10 +216,14 @@ void Heightmap::init_heightmap()
 // Two common applications are pre-computed terrains and procedural generation.
 // Sampling like this without appropriate low-pass filtering adds aliasing
 // which can cause the heightmap to "pop" in as LOD levels decrease.
-float Heightmap::sample_heightmap(int x, int y)
+// A tiled heightfield is pre-filtered, each of its levels matching a clipmap level.
+float Heightmap::sample_heightmap(int x, int y, int level)
 {
-    x &= heightmap_size - 1;
-    y &= heightmap_size - 1;
+    if (heightfield.is_open())
+        return heightfield.sample(level, x, y);
+
+    x = (x << level) & (heightmap_size - 1);
+    y = (y << level) & (heightmap_size - 1);
     return heightmap[y * heightmap_size + x];
 }
 
@@ -196,11 +233,11 @@ float Heightmap::sample_heightmap(int x, int y)
 // This avoids an extra texture lookup in vertex shader, avoids complex offsetting and having to use GL_LINEAR.
 vec2 Heightmap::compute_heightmap(int x, int y, int level)
 {
-    float height = sample_heightmap(x << level, y << level);
+    float height = sample_heightmap(x, y, level);
     float heights[2][2];
     for (int j = 0; j < 2; j++)
         for (int i = 0; i < 2; i++)
-            heights[j][i] = sample_heightmap(((x + i) & ~1) << level, ((y + j) & ~1) << level);
+            heights[j][i] = sample_heightmap(((x + i) & ~1) >> 1, ((y + j) & ~1) >> 1, level + 1);
 
     return vec2(
         height,
@@ -209,7 +246,7 @@ vec2 Heightmap::compute_heightmap(int x, int y, int level)
 //! [Compute heightmap]
 
 //! [Update region]
-void Heightmap::update_region(vec2 *buffer, unsigned int& pixel_offset, int tex_x, int tex_y,
+void Heightmap::update_region(unsigned int& pixel_offset, int tex_x, int tex_y,
                               int width, int height,
                               int start_x, int start_y,
                               int level)
@@ -218,11 +255,7 @@ void Heightmap::update_region(vec2 *buffer, unsigned int& pixel_offset, int tex_
         return;
 
     // Here we could either stream a "real" heightmap, or generate it procedurally on the GPU by rendering to these regions.
-
-    buffer += pixel_offset;
-    for (int y = 0; y < height; y++)
-        for (int x = 0; x < width; x++)
-            buffer[y * width + x] = compute_heightmap(start_x + x, start_y + y, level);
+    // We only reserve space in the PBO here. The texels are filled in by generate_regions() once all levels are known.
 
     UploadInfo info;
     info.x = tex_x;
@@ -231,13 +264,75 @@ void Heightmap::update_region(vec2 *buffer, unsigned int& pixel_offset, int tex_
     info.height = height;
     info.level = level;
     info.offset = pixel_offset * sizeof(vec2);
+    info.start_x = start_x;
+    info.start_y = start_y;
     upload_info.push_back(info);
 
     pixel_offset += width * height;
 }
 //! [Update region]
 
-void Heightmap::update_level(vec2 *buffer, unsigned int& pixel_offset, const vec2& offset, unsigned int level)
+void Heightmap::generate_rows(const GenerateJob& job)
+{
+    const UploadInfo& info = *job.region;
+    vec2 *buffer = job.buffer + job.first_row * info.width;
+    for (int y = job.first_row; y < job.first_row + job.rows; y++, buffer += info.width)
+        for (int x = 0; x < info.width; x++)
+            buffer[x] = compute_heightmap(info.start_x + x, info.start_y + y, info.level);
+}
+
+void Heightmap::generate_job_range(unsigned int begin, unsigned int end, void *data)
+{
+    Heightmap *heightmap = static_cast<Heightmap*>(data);
+    for (unsigned int i = begin; i < end; i++)
+        heightmap->generate_rows(heightmap->generate_jobs[i]);
+}
+
+// Fill every region reserved by update_region() directly into the mapped PBO.
+// Regions are sliced into bands of rows so that a full level refresh spreads across all cores,
+// while one-texel-wide scrolling updates don't pay for more jobs than they need.
+void Heightmap::generate_regions(vec2 *buffer)
+{
+    static const int texels_per_job = 4096;
+
+    request_tiles();
+
+    generate_jobs.clear();
+    for (vector<UploadInfo>::const_iterator itr = upload_info.begin(); itr != upload_info.end(); ++itr)
+    {
+        int rows_per_job = max(texels_per_job / itr->width, 1);
+        for (int row = 0; row < itr->height; row += rows_per_job)
+        {
+            GenerateJob job;
+            job.region = &*itr;
+            job.buffer = buffer + itr->offset / sizeof(vec2);
+            job.first_row = row;
+            job.rows = min(rows_per_job, itr->height - row);
+            generate_jobs.push_back(job);
+        }
+    }
+
+    // compute_heightmap() only reads the LUT or tiles decoded beforehand, so the jobs can run in any order.
+    // The bands are already sized for a job each.
+    job_scheduler.parallelFor("generate_regions", generate_jobs.size(), 1, generate_job_range, this);
+}
+
+// Decodes the heightfield tiles under every region reserved by update_region(), including the samples of the
+// coarser level compute_heightmap() blends towards, before the jobs start sampling them.
+void Heightmap::request_tiles()
+{
+    if (!heightfield.is_open())
+        return;
+
+    for (vector<UploadInfo>::const_iterator itr = upload_info.begin(); itr != upload_info.end(); ++itr)
+    {
+        heightfield.request_region(itr->level, itr->start_x, itr->start_y, itr->width, itr->height);
+        heightfield.request_region(itr->level + 1, idiv(itr->start_x, 2), idiv(itr->start_y, 2), itr->width / 2 + 2, itr->height / 2 + 2);
+    }
+    heightfield.load_requested(job_scheduler);
+}
+
+void Heightmap::update_level(unsigned int& pixel_offset, const vec2& offset, unsigned int level)
 {
     LevelInfo& info = level_info[level];
     int start_x = int(offset.c.x) >> level;
@@ -261,19 +356,19 @@ void Heightmap::update_level(vec2 *buffer, unsigned int& pixel_offset, const vec
         int wrapped_x = start_x - base_x;
         int wrapped_y = start_y - base_y;
 
-        update_region(buffer, pixel_offset,
+        update_region(pixel_offset,
             0, 0, wrapped_x, wrapped_y,
             base_x + size, base_y + size, level);
 
-        update_region(buffer, pixel_offset,
+        update_region(pixel_offset,
             wrapped_x, 0, size - wrapped_x, wrapped_y,
             start_x, base_y + size, level);
 
-        update_region(buffer, pixel_offset,
+        update_region(pixel_offset,
             0, wrapped_y, wrapped_x, size - wrapped_y,
             base_x + size, start_y, level);
 
-        update_region(buffer, pixel_offset,
+        update_region(pixel_offset,
             wrapped_x, wrapped_y, size - wrapped_x, size - wrapped_y,
             start_x, start_y, level);
 
@@ -295,114 +390,114 @@ void Heightmap::update_level(vec2 *buffer, unsigned int& pixel_offset, const vec
         // Do this in two steps. First update as we're moving in X, then  move in Y.
         if (wrap_delta_x >= 0 && delta_x >= 0) // One update region for X, simple case. Have to update both Y regions however.
         {
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 old_wrapped_x, 0, wrap_delta_x, old_wrapped_y,
                 info.x + size, old_base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 old_wrapped_x, old_wrapped_y, wrap_delta_x, size - old_wrapped_y,
                 info.x + size, info.y, level);
         }
         else if (wrap_delta_x < 0 && delta_x < 0) // One update region for X, simple case. Have to update both Y regions however.
         {
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, 0, -wrap_delta_x, old_wrapped_y,
                 start_x, old_base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, old_wrapped_y, -wrap_delta_x, size - old_wrapped_y,
                 start_x, info.y, level);
         }
         else if (wrap_delta_x < 0 && delta_x >= 0) // Two update regions in X, and also have to update both Y regions.
         {
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, 0, wrapped_x, old_wrapped_y,
                 base_x + size, old_base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 old_wrapped_x, 0, size - old_wrapped_x, old_wrapped_y,
                 base_x + old_wrapped_x, old_base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, old_wrapped_y, wrapped_x, size - old_wrapped_y,
                 base_x + size, info.y, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 old_wrapped_x, old_wrapped_y, size - old_wrapped_x, size - old_wrapped_y,
                 base_x + old_wrapped_x, info.y, level);
         }
         else if (wrap_delta_x >= 0 && delta_x < 0) // Two update regions in X, and also have to update both Y regions.
         {
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, 0, old_wrapped_x, old_wrapped_y,
                 base_x + size, old_base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, 0, size - wrapped_x, old_wrapped_y,
                 start_x, old_base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, old_wrapped_y, old_wrapped_x, size - old_wrapped_y,
                 base_x + size, info.y, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, old_wrapped_y, size - wrapped_x, size - old_wrapped_y,
                 start_x, info.y, level);
         }
 
         if (wrap_delta_y >= 0 && delta_y >= 0)
         {
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, old_wrapped_y, wrapped_x, wrap_delta_y,
                 base_x + size, info.y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, old_wrapped_y, size - wrapped_x, wrap_delta_y,
                 start_x, info.y + size, level);
         }
         else if (wrap_delta_y < 0 && delta_y < 0)
         {
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, wrapped_y, wrapped_x, -wrap_delta_y,
                 base_x + size, start_y, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, wrapped_y, size - wrapped_x, -wrap_delta_y,
                 start_x, start_y, level);
         }
         else if (wrap_delta_y < 0 && delta_y >= 0)
         {
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, 0, wrapped_x, wrapped_y,
                 base_x + size, base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, old_wrapped_y, wrapped_x, size - old_wrapped_y,
                 base_x + size, base_y + old_wrapped_y, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, 0, size - wrapped_x, wrapped_y,
                 start_x, base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, old_wrapped_y, size - wrapped_x, size - old_wrapped_y,
                 start_x, base_y + old_wrapped_y, level);
         }
         else if (wrap_delta_y >= 0 && delta_y < 0)
         {
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, 0, wrapped_x, old_wrapped_y,
                 base_x + size, base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 0, wrapped_y, wrapped_x, size - wrapped_y,
                 base_x + size, start_y, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, 0, size - wrapped_x, old_wrapped_y,
                 start_x, base_y + size, level);
 
-            update_region(buffer, pixel_offset,
+            update_region(pixel_offset,
                 wrapped_x, wrapped_y, size - wrapped_x, size - wrapped_y,
                 start_x, start_y, level);
         }
@@ -412,26 +507,219 @@ void Heightmap::update_level(vec2 *buffer, unsigned int& pixel_offset, const vec
     info.y = start_y;
 }
 
+// Texels update_level() would regenerate, overlaps ignored as they are there.
+unsigned int Heightmap::get_update_cost(const vec2& offset, unsigned int level, bool& forced) const
+{
+    const LevelInfo& info = level_info[level];
+    int delta_x = abs((int(offset.c.x) >> level) - info.x);
+    int delta_y = abs((int(offset.c.y) >> level) - info.y);
+
+    if (info.cleared || delta_x >= int(size) || delta_y >= int(size))
+    {
+        forced = true;
+        return size * size;
+    }
+
+    forced = delta_x >= MAX_DEFERRED_TEXELS || delta_y >= MAX_DEFERRED_TEXELS;
+    return (delta_x + delta_y) * size;
+}
+
+// When several levels cross a boundary in the same frame, the budget spreads their updates over the next frames.
+// The coarser levels go first: a finer level hides its stale texels by morphing to them in terrain.vert.
+void Heightmap::update_levels(unsigned int& pixel_offset, const vector<vec2>& level_offsets)
+{
+    unsigned int spent = 0;
+    for (unsigned int i = levels; i-- > 0; )
+    {
+        bool forced = false;
+        unsigned int cost = get_update_cost(level_offsets[i], i, forced);
+        if (cost == 0)
+            continue;
+
+        // The coarsest level has nothing to morph to.
+        if (update_budget && !forced && i + 1 < levels && spent > 0 && spent + cost > update_budget)
+        {
+            upload_stats.deferred++;
+            continue;
+        }
+
+        update_level(pixel_offset, level_offsets[i], i);
+        spent += cost;
+    }
+}
+
+vec4 Heightmap::get_resident_texels(unsigned int level) const
+{
+    const LevelInfo& info = level_info[level];
+    if (info.cleared)
+        return vec4(0.0f);
+
+    return vec4(float(info.x), float(info.y), float(info.x + int(size)), float(info.y + int(size)));
+}
+
+// Lazily sets up the GLES 3.1 path. The LUT generated by init_heightmap() is mirrored into an R32F texture
+// so that the compute shader samples exactly the same data as compute_heightmap().
+void Heightmap::init_compute()
+{
+    compute_program = compile_compute_program(heightmap_comp);
+    if (!compute_program)
+        return;
+
+    GL_CHECK(tex_offset_loc = glGetUniformLocation(compute_program, "uTexOffset"));
+    GL_CHECK(start_loc = glGetUniformLocation(compute_program, "uStart"));
+    GL_CHECK(size_loc = glGetUniformLocation(compute_program, "uSize"));
+    GL_CHECK(level_loc = glGetUniformLocation(compute_program, "uLevel"));
+
+    GL_CHECK(glGenTextures(1, &lut_texture));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, lut_texture));
+    GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, heightmap_size, heightmap_size));
+    GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, heightmap_size, heightmap_size, GL_RED, GL_FLOAT, &heightmap[0]));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+bool Heightmap::set_compute_generation(bool enable)
+{
+    if (enable == compute_generation)
+        return true;
+
+    if (enable)
+    {
+        GLint major = 0, minor = 0;
+        GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &major));
+        GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minor));
+        if (major < 3 || (major == 3 && minor < 1))
+        {
+            LOGI("Compute heightmap generation requires GLES 3.1, staying on the CPU path.\n");
+            return false;
+        }
+
+        if (heightfield.is_open())
+        {
+            LOGI("The tiled heightfield is decoded on the CPU, staying on the PBO path.\n");
+            return false;
+        }
+
+        if (!compute_program)
+            init_compute();
+        if (!compute_program)
+            return false;
+    }
+
+    // RG16F can't be bound as an image, so the compute path needs a different texture format.
+    GL_CHECK(glDeleteTextures(1, &texture));
+    init_texture(enable ? GL_RGBA16F : GL_RG16F);
+    compute_generation = enable;
+
+    // The new texture is undefined, so everything must be regenerated.
+    for (unsigned int i = 0; i < levels; i++)
+        level_info[i].cleared = true;
+
+    return true;
+}
+
+bool Heightmap::load_heightfield(const char *path)
+{
+    if (!heightfield.open(path))
+        return false;
+
+    set_compute_generation(false);
+    for (unsigned int i = 0; i < levels; i++)
+        level_info[i].cleared = true;
+    return true;
+}
+
+// Generates every region reserved by update_region() on the GPU. Nothing goes through the PBOs.
+void Heightmap::dispatch_regions()
+{
+    if (upload_info.empty())
+        return;
+
+    GL_CHECK(glUseProgram(compute_program));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, lut_texture));
+    GL_CHECK(glBindImageTexture(0, texture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F));
+
+    for (vector<UploadInfo>::const_iterator itr = upload_info.begin(); itr != upload_info.end(); ++itr)
+    {
+        GL_CHECK(glUniform2i(tex_offset_loc, itr->x, itr->y));
+        GL_CHECK(glUniform2i(start_loc, itr->start_x, itr->start_y));
+        GL_CHECK(glUniform2i(size_loc, itr->width, itr->height));
+        GL_CHECK(glUniform1i(level_loc, itr->level));
+        GL_CHECK(glDispatchCompute((itr->width + 7) / 8, (itr->height + 7) / 8, 1));
+    }
+
+    // The vertex shader samples the heightmap right after this.
+    GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
+
+    GL_CHECK(glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+    GL_CHECK(glUseProgram(0));
+
+    upload_stats.updates++;
+    upload_stats.regions += upload_info.size();
+}
+
+// Blocks until the GPU has finished sourcing texels from the PBO in the given ring slot.
+void Heightmap::wait_pixel_buffer(unsigned int index)
+{
+    GLsync fence = pixel_buffer_fence[index];
+    if (!fence)
+        return;
+
+    // Poll first, so we only count the cases where we actually have to wait.
+    GL_CHECK(GLenum status = glClientWaitSync(fence, 0, 0));
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        upload_stats.stalls++;
+        do
+        {
+            GL_CHECK(status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull));
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+
+    GL_CHECK(glDeleteSync(fence));
+    pixel_buffer_fence[index] = NULL;
+}
+
 void Heightmap::update_heightmap(const vector<vec2>& level_offsets)
 {
     upload_info.clear();
 
-    GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer[pixel_buffer_index]));
-    pixel_buffer_index ^= 1; // Alternate which PBO we upload to.
+    if (compute_generation)
+    {
+        unsigned int pixel_offset = 0;
+        update_levels(pixel_offset, level_offsets);
+        dispatch_regions();
+        return;
+    }
+
+    unsigned int index = pixel_buffer_index;
+    pixel_buffer_index = (pixel_buffer_index + 1) % PIXEL_BUFFER_RING_SIZE; // Cycle through the ring.
+    wait_pixel_buffer(index);
+
+    // The fence guarantees the GPU is done with this slot, so we can skip the driver's own synchronization.
+    GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer[index]));
     GL_CHECK(vec2 *buffer = reinterpret_cast<vec2*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
-                    pixel_buffer_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)));
+                    pixel_buffer_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT)));
     if (!buffer)
     {
         LOGE("Failed to map heightmap PBO.\n");
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
         return;
     }
 
     unsigned int pixel_offset = 0;
-    for (unsigned int i = 0; i < levels; i++)
-        update_level(buffer, pixel_offset, level_offsets[i], i);
+    update_levels(pixel_offset, level_offsets);
+    generate_regions(buffer);
 
     GL_CHECK(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
 
+    upload_stats.updates++;
+    upload_stats.regions += upload_info.size();
+    upload_stats.bytes += pixel_offset * sizeof(vec2);
+
     GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, texture));
     for (vector<UploadInfo>::const_iterator itr = upload_info.begin(); itr != upload_info.end(); ++itr)
     {
@@ -442,4 +730,10 @@ void Heightmap::update_heightmap(const vector<vec2>& level_offsets)
     }
     GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
     GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+    // Nothing was sourced from the PBO, so the slot can be reused right away.
+    if (!upload_info.empty())
+    {
+        GL_CHECK(pixel_buffer_fence[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    }
 }
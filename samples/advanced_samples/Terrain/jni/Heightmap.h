@@ -21,8 +21,10 @@
 #ifndef HEIGHTMAP_H__
 #define HEIGHTMAP_H__
 
-#include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
 #include "vector_math.h"
+#include "JobScheduler.h"
+#include "TiledHeightfield.h"
 #include <vector>
 
 class Heightmap
@@ -35,9 +37,57 @@ public:
     void reset();
     GLuint get_texture() const { return texture; }
 
+    struct UploadStats
+    {
+        unsigned int updates; // Number of calls to update_heightmap().
+        unsigned int regions; // Number of glTexSubImage3D() calls issued.
+        uintptr_t bytes;      // Texel data written to PBOs.
+        unsigned int stalls;  // Times a ring slot was still in use by the GPU when we wanted to reuse it.
+        unsigned int deferred; // Level updates postponed to a later frame by the update budget.
+    };
+    const UploadStats& get_upload_stats() const { return upload_stats; }
+
+    // Switches between CPU generation + PBO upload and GPU generation with a compute shader.
+    // Returns false if the compute path was requested but the context is older than GLES 3.1.
+    bool set_compute_generation(bool enable);
+    bool get_compute_generation() const { return compute_generation; }
+
+    // Streams the heights from a tiled heightfield file instead of the generated heightmap.
+    // The tiles are decoded on the CPU, so this switches to the PBO path. Returns false if the file can't be opened.
+    bool load_heightfield(const char *path);
+    const TiledHeightfield& get_heightfield() const { return heightfield; }
+
+    // Caps the texels regenerated per update_heightmap() call, 0 (the default) updating every level which moved.
+    // Levels are updated coarsest first, and the finer ones which don't fit keep their old texels for a later frame.
+    // terrain.vert morphs them to the next coarser level where they are stale, see get_resident_texels().
+    // At least one level is updated per call, and the coarsest level, cleared levels and levels which lag too far
+    // behind always are.
+    void set_update_budget(unsigned int texels) { update_budget = texels; }
+    unsigned int get_update_budget() const { return update_budget; }
+
+    // The texels a level holds, in texels of that level: xy is the first one, zw one past the last.
+    vec4 get_resident_texels(unsigned int level) const;
+
 private:
+    // Number of PBOs we cycle through. Each slot is protected by a fence,
+    // so the GPU can be several frames behind before we have to wait.
+    enum { PIXEL_BUFFER_RING_SIZE = 4 };
+
     GLuint texture;
-    GLuint pixel_buffer[2];
+    void init_texture(GLenum format);
+
+    bool compute_generation;
+    GLuint compute_program;
+    GLuint lut_texture;
+    GLint tex_offset_loc;
+    GLint start_loc;
+    GLint size_loc;
+    GLint level_loc;
+    void init_compute();
+    void dispatch_regions();
+
+    GLuint pixel_buffer[PIXEL_BUFFER_RING_SIZE];
+    GLsync pixel_buffer_fence[PIXEL_BUFFER_RING_SIZE];
     unsigned int pixel_buffer_index;
     unsigned int pixel_buffer_size;
     unsigned int size;
@@ -51,6 +101,14 @@ private:
     };
     std::vector<LevelInfo> level_info;
 
+    // A level which lags this many texels behind is updated whatever the budget. Beyond this, its stale texels
+    // are no longer at the outer edge where terrain.vert blends to the coarser level anyway.
+    enum { MAX_DEFERRED_TEXELS = 8 };
+
+    unsigned int update_budget;
+    void update_levels(unsigned int& pixel_offset, const std::vector<vec2>& level_offsets);
+    unsigned int get_update_cost(const vec2& level_offset, unsigned int level, bool& forced) const;
+
     struct UploadInfo
     {
         int x;
@@ -59,13 +117,32 @@ private:
         int height;
         int level;
         uintptr_t offset;
+        int start_x; // Heightmap coord of the top-left texel for this level.
+        int start_y;
     };
     std::vector<UploadInfo> upload_info;
 
-    void update_level(vec2 *buffer, unsigned int& pixel_offset, const vec2& level_offset, unsigned level);
+    // A horizontal slice of an upload region, generated by one worker.
+    struct GenerateJob
+    {
+        const UploadInfo *region;
+        vec2 *buffer;
+        int first_row;
+        int rows;
+    };
+    std::vector<GenerateJob> generate_jobs;
+    MaliSDK::JobScheduler job_scheduler;
+    void generate_regions(vec2 *buffer);
+    void generate_rows(const GenerateJob& job);
+    static void generate_job_range(unsigned int begin, unsigned int end, void *data);
+    UploadStats upload_stats;
+
+    void wait_pixel_buffer(unsigned int index);
+
+    void update_level(unsigned int& pixel_offset, const vec2& level_offset, unsigned level);
     vec2 compute_heightmap(int x, int y, int level);
-    float sample_heightmap(int x, int y);
-    void update_region(vec2 *buffer, unsigned int& pixel_offset, int x, int y,
+    float sample_heightmap(int x, int y, int level);
+    void update_region(unsigned int& pixel_offset, int x, int y,
         int width, int height,
         int start_x, int start_y,
         int level);
@@ -73,6 +150,9 @@ private:
     std::vector<float> heightmap;
     unsigned int heightmap_size;
     void init_heightmap();
+
+    TiledHeightfield heightfield;
+    void request_tiles();
 };
 
 #endif
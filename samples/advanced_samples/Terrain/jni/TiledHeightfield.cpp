@@ -0,0 +1,473 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TiledHeightfield.h"
+#include "Platform.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace MaliSDK;
+using namespace std;
+
+enum
+{
+    ROW_DELTAS_8 = 1,
+    ROW_DELTAS_16 = 2
+};
+
+// Predicts a sample from its neighbours to the left and above, exact on planes.
+static inline uint16_t predict(const uint16_t *samples, int x, int y, int tile_size)
+{
+    if (x > 0 && y > 0)
+        return uint16_t(samples[y * tile_size + x - 1] + samples[(y - 1) * tile_size + x] - samples[(y - 1) * tile_size + x - 1]);
+    else if (x > 0)
+        return samples[x - 1];
+    else if (y > 0)
+        return samples[(y - 1) * tile_size];
+    else
+        return 0;
+}
+
+TiledHeightfield::TiledHeightfield(unsigned int max_resident_tiles)
+    : tiles(NULL), max_resident_tiles(max_resident_tiles), batch(0)
+{
+    memset(&header, 0, sizeof(header));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void TiledHeightfield::close()
+{
+    file.close();
+    tiles = NULL;
+    levels.clear();
+    tile_slots.clear();
+    slots.clear();
+    pending.clear();
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool TiledHeightfield::open(const char *path)
+{
+    close();
+    if (!file.open(path))
+        return false;
+
+    const unsigned char *data = file.getData();
+    size_t size = file.getSize();
+    if (size < sizeof(header))
+    {
+        LOGE("%s is not a tiled heightfield.\n", path);
+        file.close();
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != TILED_HEIGHTFIELD_MAGIC || header.version != TILED_HEIGHTFIELD_VERSION ||
+        header.width == 0 || header.height == 0 || header.tile_size == 0 || header.tile_size > 4096 ||
+        header.levels == 0 || header.levels > 32)
+    {
+        LOGE("%s is not a tiled heightfield of version %u.\n", path, TILED_HEIGHTFIELD_VERSION);
+        file.close();
+        return false;
+    }
+
+    int tile_count = 0;
+    for (unsigned int l = 0; l < header.levels; l++)
+    {
+        Level level;
+        level.width = max(int(header.width >> l), 1);
+        level.height = max(int(header.height >> l), 1);
+        level.tiles_x = (level.width + header.tile_size - 1) / header.tile_size;
+        level.tiles_y = (level.height + header.tile_size - 1) / header.tile_size;
+        level.first_tile = tile_count;
+        tile_count += level.tiles_x * level.tiles_y;
+        levels.push_back(level);
+    }
+
+    if (size < sizeof(header) + tile_count * sizeof(TiledHeightfieldTile))
+    {
+        LOGE("%s is truncated.\n", path);
+        close();
+        return false;
+    }
+
+    // The header is 32 bytes, so the tile table is aligned for 64-bit reads.
+    tiles = reinterpret_cast<const TiledHeightfieldTile*>(data + sizeof(header));
+    tile_slots.assign(tile_count, -1);
+
+    LOGI("Tiled heightfield %s: %u x %u samples, %u levels of %u x %u tiles, %.1f MiB.\n",
+        path, header.width, header.height, header.levels, header.tile_size, header.tile_size, size / (1024.0 * 1024.0));
+    return true;
+}
+
+void TiledHeightfield::map_sample(int level, int x, int y, const Level*& info, int& sx, int& sy) const
+{
+    int last = int(levels.size()) - 1;
+    int shift = 0;
+    if (level > last)
+    {
+        shift = level - last;
+        level = last;
+    }
+
+    info = &levels[level];
+    sx = min(max(x * (1 << shift) + info->width / 2, 0), info->width - 1);
+    sy = min(max(y * (1 << shift) + info->height / 2, 0), info->height - 1);
+}
+
+// Takes a free slot, or the least recently used one not needed by the current batch.
+int TiledHeightfield::acquire_slot()
+{
+    if (slots.size() < max_resident_tiles)
+    {
+        slots.push_back(Slot());
+        slots.back().samples.resize(header.tile_size * header.tile_size);
+        return int(slots.size()) - 1;
+    }
+
+    int oldest = -1;
+    for (unsigned int i = 0; i < slots.size(); i++)
+        if (slots[i].last_used != batch && (oldest < 0 || slots[i].last_used < slots[oldest].last_used))
+            oldest = int(i);
+
+    // Everything resident is needed right now, so go over the budget rather than fail.
+    if (oldest < 0)
+    {
+        slots.push_back(Slot());
+        slots.back().samples.resize(header.tile_size * header.tile_size);
+        return int(slots.size()) - 1;
+    }
+
+    tile_slots[slots[oldest].tile] = -1;
+    return oldest;
+}
+
+void TiledHeightfield::request_region(int level, int x, int y, int width, int height)
+{
+    if (!is_open() || width <= 0 || height <= 0)
+        return;
+
+    const Level *info;
+    int x0, y0, x1, y1;
+    map_sample(level, x, y, info, x0, y0);
+    map_sample(level, x + width - 1, y + height - 1, info, x1, y1);
+
+    int tile_size = header.tile_size;
+    for (int ty = y0 / tile_size; ty <= y1 / tile_size; ty++)
+    {
+        for (int tx = x0 / tile_size; tx <= x1 / tile_size; tx++)
+        {
+            int tile = info->first_tile + ty * info->tiles_x + tx;
+            int slot = tile_slots[tile];
+            if (slot < 0)
+            {
+                slot = acquire_slot();
+                slots[slot].tile = tile;
+                tile_slots[tile] = slot;
+                pending.push_back(slot);
+            }
+            slots[slot].last_used = batch;
+        }
+    }
+}
+
+void TiledHeightfield::decode(Slot& slot)
+{
+    const TiledHeightfieldTile& entry = tiles[slot.tile];
+    int tile_size = header.tile_size;
+    uint16_t *samples = &slot.samples[0];
+
+    const unsigned char *data = file.getData();
+    size_t size = file.getSize();
+    const unsigned char *coded = data + entry.offset;
+    const unsigned char *end = coded + entry.size;
+    if (entry.offset > size || entry.size > size - entry.offset)
+        end = coded = data;
+
+    for (int y = 0; y < tile_size; y++)
+    {
+        int mode = coded < end ? *coded++ : 0;
+        int row_bytes = mode == ROW_DELTAS_8 ? tile_size + 1 : 2 * tile_size;
+        if ((mode != ROW_DELTAS_8 && mode != ROW_DELTAS_16) || end - coded < row_bytes)
+        {
+            // A damaged tile is flat rather than garbage.
+            LOGE("Tiled heightfield: tile %d is damaged.\n", slot.tile);
+            memset(samples, 0, tile_size * tile_size * sizeof(uint16_t));
+            return;
+        }
+
+        for (int x = 0; x < tile_size; x++)
+        {
+            uint16_t delta;
+            if (mode == ROW_DELTAS_16 || x == 0)
+            {
+                delta = uint16_t(coded[0] | (coded[1] << 8));
+                coded += 2;
+            }
+            else
+                delta = uint16_t(int8_t(*coded++));
+
+            samples[y * tile_size + x] = uint16_t(predict(samples, x, y, tile_size) + delta);
+        }
+    }
+}
+
+void TiledHeightfield::decode_range(unsigned int begin, unsigned int end, void *data)
+{
+    TiledHeightfield *heightfield = static_cast<TiledHeightfield*>(data);
+    for (unsigned int i = begin; i < end; i++)
+        heightfield->decode(heightfield->slots[heightfield->pending[i]]);
+}
+
+void TiledHeightfield::load_requested(JobScheduler& scheduler)
+{
+    if (!pending.empty())
+    {
+        for (vector<int>::const_iterator itr = pending.begin(); itr != pending.end(); ++itr)
+            stats.coded_bytes += tiles[slots[*itr].tile].size;
+        stats.decoded_tiles += pending.size();
+
+        // Each tile faults in its pages of the file, so the reads are spread over the workers as well.
+        scheduler.parallelFor("decode_tiles", pending.size(), 1, decode_range, this);
+        pending.clear();
+    }
+
+    stats.resident_tiles = slots.size();
+    batch++;
+}
+
+float TiledHeightfield::sample(int level, int x, int y) const
+{
+    const Level *info;
+    int sx, sy;
+    map_sample(level, x, y, info, sx, sy);
+
+    int tile_size = header.tile_size;
+    int tile = info->first_tile + (sy / tile_size) * info->tiles_x + sx / tile_size;
+    int slot = tile_slots[tile];
+    if (slot < 0)
+        return header.height_offset;
+
+    uint16_t q = slots[slot].samples[(sy % tile_size) * tile_size + sx % tile_size];
+    return header.height_offset + header.height_scale * q;
+}
+
+// Collects tile_size rows of a level, codes them as a row of tiles, and averages pairs of rows for the next level.
+struct LevelWriter
+{
+    int width;
+    int height;
+    vector<float> strip; // tile_size rows.
+    int strip_rows;
+    int rows_written;
+    vector<float> pending_row;
+    bool has_pending_row;
+    int first_tile;
+};
+
+struct HeightfieldWriter
+{
+    FILE *file;
+    uint64_t offset;
+    int tile_size;
+    float min_height;
+    float scale;
+    vector<LevelWriter> levels;
+    vector<TiledHeightfieldTile> table;
+    vector<uint16_t> samples;
+    vector<unsigned char> coded;
+    bool failed;
+
+    void write_tiles(LevelWriter& level, int tile_row)
+    {
+        int tiles_x = (level.width + tile_size - 1) / tile_size;
+        for (int tx = 0; tx < tiles_x; tx++)
+        {
+            for (int y = 0; y < tile_size; y++)
+            {
+                const float *row = &level.strip[min(y, level.strip_rows - 1) * level.width];
+                for (int x = 0; x < tile_size; x++)
+                {
+                    float h = row[min(tx * tile_size + x, level.width - 1)];
+                    float q = floorf((h - min_height) / scale + 0.5f);
+                    samples[y * tile_size + x] = uint16_t(min(max(q, 0.0f), 65535.0f));
+                }
+            }
+
+            coded.clear();
+            for (int y = 0; y < tile_size; y++)
+            {
+                bool small = true;
+                for (int x = 1; x < tile_size && small; x++)
+                {
+                    int16_t delta = int16_t(uint16_t(samples[y * tile_size + x] - predict(&samples[0], x, y, tile_size)));
+                    small = delta >= -128 && delta <= 127;
+                }
+
+                coded.push_back(small ? ROW_DELTAS_8 : ROW_DELTAS_16);
+                for (int x = 0; x < tile_size; x++)
+                {
+                    uint16_t delta = uint16_t(samples[y * tile_size + x] - predict(&samples[0], x, y, tile_size));
+                    if (!small || x == 0)
+                    {
+                        coded.push_back(delta & 0xff);
+                        coded.push_back(delta >> 8);
+                    }
+                    else
+                        coded.push_back(delta & 0xff);
+                }
+            }
+
+            TiledHeightfieldTile& entry = table[level.first_tile + tile_row * tiles_x + tx];
+            entry.offset = offset;
+            entry.size = coded.size();
+            entry.reserved = 0;
+            if (fwrite(&coded[0], 1, coded.size(), file) != coded.size())
+                failed = true;
+            offset += coded.size();
+        }
+    }
+
+    void push_row(int l, const float *row)
+    {
+        LevelWriter& level = levels[l];
+        int y = level.rows_written++;
+
+        memcpy(&level.strip[level.strip_rows * level.width], row, level.width * sizeof(float));
+        if (++level.strip_rows == tile_size || y == level.height - 1)
+        {
+            write_tiles(level, y / tile_size);
+            level.strip_rows = 0;
+        }
+
+        if (l + 1 >= int(levels.size()))
+            return;
+
+        // Rows are averaged in pairs. A level 1 sample high is averaged with itself.
+        const float *above = row;
+        if (level.height > 1)
+        {
+            if (!level.has_pending_row)
+            {
+                level.pending_row.assign(row, row + level.width);
+                level.has_pending_row = true;
+                return;
+            }
+            above = &level.pending_row[0];
+            level.has_pending_row = false;
+        }
+
+        LevelWriter& next = levels[l + 1];
+        vector<float> down(next.width);
+        for (int x = 0; x < next.width; x++)
+        {
+            int x0 = min(2 * x, level.width - 1);
+            int x1 = min(2 * x + 1, level.width - 1);
+            down[x] = 0.25f * (above[x0] + above[x1] + row[x0] + row[x1]);
+        }
+        push_row(l + 1, &down[0]);
+    }
+};
+
+bool TiledHeightfield::write(const char *path, unsigned int width, unsigned int height, unsigned int tile_size,
+    float min_height, float max_height, RowSource source, void *user_data)
+{
+    if (width == 0 || height == 0 || tile_size == 0 || tile_size > 4096 || !(max_height >= min_height))
+    {
+        LOGE("Invalid tiled heightfield parameters.\n");
+        return false;
+    }
+
+    string temporary_path = string(path) + ".tmp";
+    FILE *file = fopen(temporary_path.c_str(), "wb");
+    if (!file)
+    {
+        LOGE("Cannot create %s.\n", temporary_path.c_str());
+        return false;
+    }
+
+    HeightfieldWriter writer;
+    writer.file = file;
+    writer.tile_size = tile_size;
+    writer.min_height = min_height;
+    writer.scale = max_height > min_height ? (max_height - min_height) / 65535.0f : 1.0f;
+    writer.samples.resize(tile_size * tile_size);
+    writer.failed = false;
+
+    // Levels down to the first one which fits a single tile.
+    int tile_count = 0;
+    for (unsigned int l = 0; ; l++)
+    {
+        LevelWriter level;
+        level.width = max(int(width >> l), 1);
+        level.height = max(int(height >> l), 1);
+        level.strip.resize(tile_size * level.width);
+        level.strip_rows = 0;
+        level.rows_written = 0;
+        level.has_pending_row = false;
+        level.first_tile = tile_count;
+        tile_count += ((level.width + tile_size - 1) / tile_size) * ((level.height + tile_size - 1) / tile_size);
+        writer.levels.push_back(level);
+
+        if (level.width <= int(tile_size) && level.height <= int(tile_size))
+            break;
+    }
+    writer.table.resize(tile_count);
+
+    TiledHeightfieldHeader header;
+    header.magic = TILED_HEIGHTFIELD_MAGIC;
+    header.version = TILED_HEIGHTFIELD_VERSION;
+    header.width = width;
+    header.height = height;
+    header.tile_size = tile_size;
+    header.levels = writer.levels.size();
+    header.height_offset = min_height;
+    header.height_scale = writer.scale;
+
+    // The tile table is only known at the end, so its space is reserved and it is written last.
+    writer.offset = sizeof(header) + tile_count * sizeof(TiledHeightfieldTile);
+    if (fseek(file, long(writer.offset), SEEK_SET) != 0)
+        writer.failed = true;
+
+    vector<float> row(width);
+    for (unsigned int y = 0; y < height && !writer.failed; y++)
+    {
+        source(y, &row[0], user_data);
+        writer.push_row(0, &row[0]);
+    }
+
+    if (!writer.failed)
+    {
+        writer.failed = fseek(file, 0, SEEK_SET) != 0 ||
+            fwrite(&header, sizeof(header), 1, file) != 1 ||
+            fwrite(&writer.table[0], sizeof(TiledHeightfieldTile), tile_count, file) != size_t(tile_count);
+    }
+
+    if (fclose(file) != 0 || writer.failed || rename(temporary_path.c_str(), path) != 0)
+    {
+        LOGE("Failed to write %s.\n", path);
+        remove(temporary_path.c_str());
+        return false;
+    }
+    return true;
+}
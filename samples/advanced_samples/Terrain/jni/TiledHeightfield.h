@@ -0,0 +1,139 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TILED_HEIGHTFIELD_H__
+#define TILED_HEIGHTFIELD_H__
+
+#include "AssetFile.h"
+#include "JobScheduler.h"
+#include <stdint.h>
+#include <vector>
+
+// File layout of a tiled heightfield, everything little endian:
+//   TiledHeightfieldHeader
+//   TiledHeightfieldTile for every tile, level 0 first, each level row by row
+//   the tiles, in any order
+//
+// Level l is max(width >> l, 1) by max(height >> l, 1) samples, each one the average of 2x2 samples of level l - 1.
+// The last level fits a single tile. Tiles are tile_size x tile_size samples, those on the right and bottom edges
+// repeat the last column and row of the level.
+//
+// Heights are quantized to 16 bits, height = height_offset + height_scale * q. A tile stores the difference between
+// q and its prediction from the samples to the left and above, row by row. Each row starts with a mode byte:
+//   1: the first difference as 16 bits, the others as signed 8-bit values.
+//   2: every difference as 16 bits.
+// Differences are modulo 65536, so decoding is exact whatever the prediction.
+#define TILED_HEIGHTFIELD_MAGIC 0x444c4648 // "HFLD"
+#define TILED_HEIGHTFIELD_VERSION 1
+
+struct TiledHeightfieldHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width; // Samples of level 0.
+    uint32_t height;
+    uint32_t tile_size;
+    uint32_t levels;
+    float height_offset;
+    float height_scale;
+};
+
+struct TiledHeightfieldTile
+{
+    uint64_t offset; // From the start of the file.
+    uint32_t size;   // Bytes of coded rows.
+    uint32_t reserved;
+};
+
+// Reads a tiled heightfield mapped from disk, decoding only the tiles the clipmap needs.
+// Decoded tiles stay resident while they are used and the least recently used ones are replaced,
+// so datasets much larger than memory can be rendered.
+//
+// Coordinates are relative to the centre of the heightfield. Samples outside of it repeat the edges.
+// Levels past the last one read the last level sparsely.
+class TiledHeightfield
+{
+public:
+    TiledHeightfield(unsigned int max_resident_tiles = 256);
+
+    bool open(const char *path);
+    void close();
+    bool is_open() const { return tiles != NULL; }
+
+    // Marks the tiles covering a region of a level as needed. Decoding happens in load_requested().
+    void request_region(int level, int x, int y, int width, int height);
+
+    // Decodes the requested tiles which are not resident yet, on the workers of the scheduler.
+    void load_requested(MaliSDK::JobScheduler& scheduler);
+
+    // The height of a sample in a requested region. Only reads, so any number of jobs can sample at once.
+    float sample(int level, int x, int y) const;
+
+    struct Stats
+    {
+        unsigned int decoded_tiles; // Tiles decoded since open().
+        uintptr_t coded_bytes;      // Bytes of the file they were decoded from.
+        unsigned int resident_tiles;
+    };
+    const Stats& get_stats() const { return stats; }
+
+    // Provides row y of level 0, width samples.
+    typedef void (*RowSource)(int y, float *row, void *user_data);
+
+    // Writes a heightfield, asking the source for one row at a time, so it does not need to fit in memory.
+    // Heights are clamped to [min_height, max_height]. The file is written under a temporary name and renamed once complete.
+    static bool write(const char *path, unsigned int width, unsigned int height, unsigned int tile_size,
+        float min_height, float max_height, RowSource source, void *user_data);
+
+private:
+    struct Level
+    {
+        int width;
+        int height;
+        int tiles_x;
+        int tiles_y;
+        int first_tile;
+    };
+
+    struct Slot
+    {
+        std::vector<uint16_t> samples;
+        int tile;
+        unsigned int last_used;
+    };
+
+    MaliSDK::AssetFile file;
+    TiledHeightfieldHeader header;
+    const TiledHeightfieldTile *tiles;
+    std::vector<Level> levels;
+    std::vector<int> tile_slots; // Slot of every tile, -1 if it is not resident.
+    std::vector<Slot> slots;
+    std::vector<int> pending;    // Slots to decode in load_requested().
+    unsigned int max_resident_tiles;
+    unsigned int batch;
+    Stats stats;
+
+    void map_sample(int level, int x, int y, const Level*& info, int& sx, int& sy) const;
+    int acquire_slot();
+    void decode(Slot& slot);
+    static void decode_range(unsigned int begin, unsigned int end, void *data);
+};
+
+#endif
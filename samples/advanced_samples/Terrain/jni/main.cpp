@@ -44,6 +44,28 @@ using namespace MaliSDK;
 // Distance between vertices.
 #define CLIPMAP_SCALE 0.25f
 
+// Generate the heightmap with a compute shader rather than on the CPU where GLES 3.1 is available.
+// Set to false to use the CPU path with PBO uploads.
+static bool compute_heightmap = true;
+
+// Tiled heightfield to render, see TiledHeightfield.h. The generated terrain is used when the file doesn't exist.
+// Tiles are decoded on the CPU, so the heightmap is then uploaded through PBOs whatever compute_heightmap says.
+static const char *heightfield_path = "/data/data/com.arm.malideveloper.openglessdk.terrain/files/heightfield.hfld";
+
+// Cull the clipmap blocks and build the draw calls on the GPU where GLES 3.1 is available.
+static bool gpu_culling = true;
+
+// Bake the heights into vertex buffers with a compute shader when the clipmap levels move, rather than sampling
+// the heightmap in the vertex shader. Draws one call per block with CPU culling, so GPU culling is not used then.
+static bool baked_vertices = false;
+
+// Also cull the blocks hidden behind the terrain in the previous frame. Only used with GPU culling.
+static bool occlusion_culling = true;
+
+// Heightmap texels regenerated per frame at most. A level moving one texel costs a row or column of 255 texels,
+// so this is about eight; the levels which don't fit are deferred to the next frames. 0 removes the limit.
+static unsigned int heightmap_update_budget = 2048;
+
 ClipmapApplication* app = NULL;
 int surface_width, surface_height;
 
@@ -54,6 +76,13 @@ extern "C"
     {
       delete app;
       app = new ClipmapApplication(CLIPMAP_SIZE, CLIPMAP_LEVELS, CLIPMAP_SCALE);
+      if (!app->load_heightfield(heightfield_path))
+        LOGI("No heightfield at %s, generating the terrain.\n", heightfield_path);
+      app->set_compute_heightmap(compute_heightmap);
+      app->set_gpu_culling(gpu_culling);
+      app->set_baked_vertices(baked_vertices);
+      app->set_occlusion_culling(occlusion_culling);
+      app->set_update_budget(heightmap_update_budget);
       surface_width = width;
       surface_height = height;
     }
@@ -0,0 +1,33 @@
+/* Copyright (c) 2014-2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Shared by terrain.vert and ground_mesh_cull.comp, which writes the instances the vertex shader draws.
+
+#define HEIGHTMAP_MIN -20.0 // Depends on the heightmap.
+#define HEIGHTMAP_MAX 20.0
+
+struct PerInstanceData
+{
+  vec2 offset; // World-space offset in XZ plane.
+  vec2 texture_scale;
+  vec2 texture_offset; // Same as for world-space offset/scale, just for texture coordinates
+  float scale; // Scaling factor for vertex offsets (per-instance)
+  float level; // LOD-level to use when sampling heightmap
+};
@@ -1,3 +1,5 @@
+#version 300 es
+
 /* Copyright (c) 2014-2017, ARM Limited and Contributors
  *
  * SPDX-License-Identifier: MIT
@@ -18,58 +20,25 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifndef TIMER_H
-#define TIMER_H
-
-#include <cstdio>
+layout(std140) uniform;
+precision highp float;
 
-#if defined(_WIN32)
-#else
-#include <sys/time.h>
-#endif
+out vec4 FragColor;
+in float vHeight;
+in vec2 vLod;
+in float vFog;
 
-namespace MaliSDK
+// Compress (-inf, +inf) to (0, 1).
+float map_height(float h)
 {
-    /**
-     * \brief Provides a platform independent high resolution timer.
-     * \note The timer measures real time, not CPU time.
-     */
-    class Timer
-    {
-    private:
-        int frameCount;
-        float fps;
-        float lastTime;
-
-    #if defined(_WIN32)
-        double resetStamp;
-        double invFreq;
-        float  lastInterval;
-        float  lastFpsUpdate;
-    #else
-        timeval startTime;
-        timeval currentTime;
-        float   lastIntervalTime;
-        float   fpsTime;
-    #endif
+  return 1.0 / (1.0 + exp(-h / 20.0));
+}
 
-    public:
-        /**
-         * \brief Default Constructor
-         */
-        Timer();
-        
-        /**
-         * \brief Resets the timer to 0.0f.
-         */
-        void reset();
+// Make the heightmap look somewhat cloudy and fluffy.
 
-        /**
-         * \brief Returns the time passed since object creation or since reset() was last called.
-         *
-         * \return Float containing the current time.
-         */
-        float getTime();
-    };
+void main()
+{
+  vec3 color = vec3(1.2, 1.2, 1.0) * vec3(map_height(vHeight) + (vLod.x + vLod.y) * 0.1);
+  vec3 final_color = mix(color, vec3(0.5), vFog);
+  FragColor = vec4(final_color, 1.0);
 }
-#endif /* TIMER_H */
\ No newline at end of file
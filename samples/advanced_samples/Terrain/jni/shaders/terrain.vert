@@ -0,0 +1,120 @@
+#version 300 es
+
+/* Copyright (c) 2014-2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// A heightmap like this would also have a corresponding normal map.
+// For simplicitly, this is ignored here.
+// Normals could be computed on-the-fly by sampling neighboring vertices as well in the vertex shader.
+
+layout(std140) uniform;
+
+uniform mat4 uViewProjection;
+uniform vec3 uCameraPos;
+uniform float uInvLevelSize[10]; // GL doesn't allow unsized array when accessed from non-constant.
+
+#include "instance_data.glsl"
+
+uniform InstanceData
+{
+  PerInstanceData instance[256];
+};
+
+#define LOCATION_VERTEX 0
+#define LOCATION_HEIGHTS 1
+#define LOCATION_NORMAL 2
+#define LOCATION_INSTANCE 3
+
+#ifdef BAKED_VERTICES
+// The heights (and normals) are baked into the vertex buffer by ground_mesh_bake.comp whenever a clipmap level moves.
+// Blocks are drawn one at a time from a grid the size of the level, so the vertex coordinates within the block
+// are recovered from the index, and the instance comes from a constant attribute. See GroundMeshBaked.cpp.
+uniform int uBakedStride;
+layout(location = LOCATION_HEIGHTS) in vec2 aHeights;
+layout(location = LOCATION_INSTANCE) in int aInstance;
+#define INSTANCE aInstance
+#else
+uniform mediump sampler2DArray sHeightmap;
+// Texels of each level which are up to date, as min.xy, max.zw (exclusive), see Heightmap::get_resident_texels().
+uniform vec4 uResidentTexels[10];
+layout(location = LOCATION_VERTEX) in vec2 aVertex;
+#define INSTANCE gl_InstanceID
+#endif
+
+out float vHeight;
+out vec2 vLod;
+out float vFog;
+
+void main()
+{
+#ifdef BAKED_VERTICES
+  vec2 vertex = vec2(float(gl_VertexID % uBakedStride), float(gl_VertexID / uBakedStride));
+#else
+  vec2 vertex = aVertex;
+#endif
+
+  vec2 local_offset = vertex * instance[INSTANCE].scale;
+  vec2 pos = instance[INSTANCE].offset + local_offset;
+
+  float level = instance[INSTANCE].level;
+
+#ifdef BAKED_VERTICES
+  vec2 heights = aHeights;
+#else
+  vec2 tex_offset = (vertex + 0.5) * instance[INSTANCE].texture_scale; // 0.5 offset to sample mid-texel.
+  vec2 texcoord = instance[INSTANCE].texture_offset + tex_offset;
+
+  vec2 heights = texture(sHeightmap, vec3(texcoord, level)).rg;
+
+  // A level whose update was deferred by the budget morphs to the next level over the last 4 texels of its window,
+  // so the stale texels are not seen. The coarser texels are interpolated as the G channel of compute_heightmap().
+  vec2 texel = floor(pos / instance[INSTANCE].scale + 0.5);
+  vec4 resident = uResidentTexels[int(level)];
+  vec2 inside = min(texel - resident.xy, resident.zw - 1.0 - texel);
+  float resident_factor = clamp(min(inside.x, inside.y) * 0.25, 0.0, 1.0);
+  if (resident_factor < 1.0)
+  {
+    vec2 c0 = (floor(texel * 0.5) + 0.5) * instance[INSTANCE].texture_scale;
+    vec2 c1 = (floor((texel + 1.0) * 0.5) + 0.5) * instance[INSTANCE].texture_scale;
+    float coarse = 0.25 * (texture(sHeightmap, vec3(fract(c0), level + 1.0)).r +
+        texture(sHeightmap, vec3(fract(vec2(c1.x, c0.y)), level + 1.0)).r +
+        texture(sHeightmap, vec3(fract(vec2(c0.x, c1.y)), level + 1.0)).r +
+        texture(sHeightmap, vec3(fract(c1), level + 1.0)).r);
+    heights = mix(vec2(coarse), heights, resident_factor);
+  }
+#endif
+
+  // Find blending factors for heightmap. The detail level must not have any discontinuities or it shows as 'artifacts'.
+  vec2 dist = abs(pos - uCameraPos.xz) * uInvLevelSize[int(level)];
+  vec2 a = clamp((dist - 0.325) * 8.0, 0.0, 1.0);
+  float lod_factor = max(a.x, a.y);
+  float height = mix(heights.x, heights.y, lod_factor);
+
+  height = clamp(height, HEIGHTMAP_MIN, HEIGHTMAP_MAX); // To ensure frustum culling assumptions are met.
+
+  vec4 vert = vec4(pos.x, height, pos.y, 1.0);
+
+  gl_Position = uViewProjection * vert;
+  vHeight = height;
+  vLod = vec2(level, lod_factor);
+
+  vec3 dist_camera = uCameraPos - vert.xyz;
+  vFog = clamp(dot(dist_camera, dist_camera) / 250000.0, 0.0, 1.0); // Simple per-vertex fog.
+}
@@ -26,12 +26,89 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
-
-GLuint load_packed_cubemap(const char *filename)
+#include "ProgramBinaryCache.h"
+#include "AssetFile.h"
+#include "TextureFormatSelector.h"
+#include "ImageUploadQueue.h"
+#include "JobScheduler.h"
+#include <string>
+
+// Position of each face in the packed image, in units of faces,
+// in the order GL_TEXTURE_CUBE_MAP_POSITIVE_X to NEGATIVE_Z.
+static const int packed_face_offsets[6][2] = {
+    { 2, 2 }, { 0, 2 }, { 1, 1 }, { 1, 3 }, { 1, 2 }, { 3, 2 }
+};
+
+// A cubemap whose packed image is decoded on a worker,
+// see load_packed_cubemap.
+struct PendingCubemap
+{
+    const char *filename;
+    GLuint texture;
+    int size;
+};
+
+// Cut the faces out of the packed image straight into the
+// mapped pixel unpack buffer, one after the other. stb_image
+// only decodes into memory it allocates, so this is the one
+// copy of the pixels, made on the worker.
+bool decode_packed_cubemap(void *destination, size_t size, void *user_data)
 {
+    PendingCubemap *pending = (PendingCubemap*)user_data;
     int width, height, channels;
-    unsigned char *pixels = stbi_load(filename, &width, &height, &channels, 4);
+    unsigned char *pixels = stbi_load(pending->filename, &width, &height, &channels, 4);
     if (!pixels)
+        return false;
+
+    int s = pending->size;
+    if (width != s * 4 || height != width)
+    {
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    unsigned char *face_data = (unsigned char*)destination;
+    for (int face = 0; face < 6; face++)
+    {
+        for (int y = 0; y < s; y++)
+        {
+            const unsigned char *row = pixels +
+                ((packed_face_offsets[face][1] * s + y) * width + packed_face_offsets[face][0] * s) * 4;
+            memcpy(face_data, row, s * 4);
+            face_data += s * 4;
+        }
+    }
+
+    stbi_image_free(pixels);
+    return true;
+}
+
+void upload_packed_cubemap(const void *pixels, bool decoded, void *user_data)
+{
+    PendingCubemap *pending = (PendingCubemap*)user_data;
+    if (!decoded)
+    {
+        LOGE("Failed to load texture %s\n", pending->filename);
+        exit(1);
+    }
+
+    int s = pending->size;
+    glBindTexture(GL_TEXTURE_CUBE_MAP, pending->texture);
+    for (int face = 0; face < 6; face++)
+    {
+        glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, 0, 0, s, s, GL_RGBA, GL_UNSIGNED_BYTE,
+                        (const unsigned char*)pixels + face * s * s * 4);
+    }
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+}
+
+// Create an RGBA8 cubemap for a packed image. Only the header
+// of the image is read here: the pixels are decoded on a worker
+// and uploaded by uploads->finish(), which pending has to outlive.
+GLuint load_packed_cubemap(const char *filename, MaliSDK::ImageUploadQueue *uploads, PendingCubemap *pending)
+{
+    int width, height, channels;
+    if (!stbi_info(filename, &width, &height, &channels))
     {
         LOGE("Failed to load texture %s\n", filename);
         exit(1);
@@ -51,88 +128,148 @@ GLuint load_packed_cubemap(const char *filename)
     //  . -Y  .  .
 
     int s = width / 4;
+    int levels = 1;
+    while ((s >> levels) > 0)
+        levels++;
+
     GLuint texture = 0;
     glActiveTexture(GL_TEXTURE0);
     glGenTextures(1, &texture);
     glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, levels, GL_RGBA8, s, s);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
-
-    glPixelStorei(GL_UNPACK_SKIP_PIXELS, s*0);
-    glPixelStorei(GL_UNPACK_SKIP_ROWS, s*2);
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, 0, GL_RGBA8, s, s, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    pending->filename = filename;
+    pending->texture = texture;
+    pending->size = s;
+    uploads->add((size_t)s * s * 4 * 6, decode_packed_cubemap, upload_packed_cubemap, pending);
+    return texture;
+}
 
-    glPixelStorei(GL_UNPACK_SKIP_PIXELS, s*2);
-    glPixelStorei(GL_UNPACK_SKIP_ROWS, s*2);
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_RGBA8, s, s, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+struct PackedCubemap
+{
+    const char *filename;
+    unsigned char *pixels;
+    int width;
+};
+
+// Cut one face out of the packed image, which is only
+// decoded if the compressed cubemap has to be encoded.
+bool read_packed_face(int face, std::vector<unsigned char> *pixels, int *size, void *user_data)
+{
+    PackedCubemap *packed = (PackedCubemap*)user_data;
+    if (!packed->pixels)
+    {
+        int height, channels;
+        packed->pixels = stbi_load(packed->filename, &packed->width, &height, &channels, 3);
+        if (!packed->pixels || packed->width != height)
+            return false;
+    }
 
-    glPixelStorei(GL_UNPACK_SKIP_PIXELS, s*1);
-    glPixelStorei(GL_UNPACK_SKIP_ROWS, s*3);
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, 0, GL_RGBA8, s, s, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    int s = packed->width / 4;
+    pixels->resize(s * s * 3);
+    for (int y = 0; y < s; y++)
+    {
+        const unsigned char *row = packed->pixels +
+            ((packed_face_offsets[face][1] * s + y) * packed->width + packed_face_offsets[face][0] * s) * 3;
+        memcpy(&(*pixels)[y * s * 3], row, s * 3);
+    }
+    *size = s;
+    return true;
+}
 
-    glPixelStorei(GL_UNPACK_SKIP_PIXELS, s*1);
-    glPixelStorei(GL_UNPACK_SKIP_ROWS, s*1);
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, 0, GL_RGBA8, s, s, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+// Load a packed cubemap as a compressed cubemap with all its
+// mip levels. It is encoded from the packed image on the first
+// run and cached, or uploaded uncompressed if that fails.
+GLuint load_compressed_packed_cubemap(const char *filename, MaliSDK::ImageUploadQueue *uploads, PendingCubemap *pending)
+{
+    std::string base = filename;
+    base = base.substr(0, base.rfind('.'));
 
-    glPixelStorei(GL_UNPACK_SKIP_PIXELS, s*3);
-    glPixelStorei(GL_UNPACK_SKIP_ROWS, s*2);
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, 0, GL_RGBA8, s, s, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    PackedCubemap packed = { filename, NULL, 0 };
+    GLuint texture = 0;
+    glActiveTexture(GL_TEXTURE0);
+    bool loaded = MaliSDK::TextureFormatSelector::loadCubemap(base.c_str(), read_packed_face, &packed, &texture);
+    if (packed.pixels)
+        stbi_image_free(packed.pixels);
 
-    glPixelStorei(GL_UNPACK_SKIP_PIXELS, s*1);
-    glPixelStorei(GL_UNPACK_SKIP_ROWS, s*2);
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, 0, GL_RGBA8, s, s, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    if (!loaded)
+        return load_packed_cubemap(filename, uploads, pending);
 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
-
-    stbi_image_free(pixels);
     return texture;
 }
 
-char *read_file(const char *filename)
+// Cut the red channel of one face out of a packed heightmap,
+// widened to 16 bits so that the mip levels are averaged without
+// rounding them back to 8 bits.
+bool read_packed_height_face(int face, std::vector<unsigned short> *heights, int *size, void *user_data)
 {
-    FILE *file = fopen(filename, "rb");
-    if (!file)
-    {
-        LOGE("Failed to open file %s\n", filename);
-        exit (1);
-    }
-    fseek(file, 0, SEEK_END);
-    long length = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    char *data = (char *)calloc(length + 1, sizeof(char));
-    if (!data)
+    PackedCubemap *packed = (PackedCubemap*)user_data;
+    if (!packed->pixels)
     {
-        LOGE("Failed to allocate memory for file data %s\n", filename);
-        exit(1);
+        int height, channels;
+        packed->pixels = stbi_load(packed->filename, &packed->width, &height, &channels, 4);
+        if (!packed->pixels || packed->width != height)
+            return false;
     }
-    size_t read = fread(data, sizeof(char), length, file);
-    if (read != length)
+
+    int s = packed->width / 4;
+    heights->resize(s * s);
+    for (int y = 0; y < s; y++)
     {
-        LOGE("Failed to read whole file %s\n", filename);
-        exit(1);
+        const unsigned char *row = packed->pixels +
+            ((packed_face_offsets[face][1] * s + y) * packed->width + packed_face_offsets[face][0] * s) * 4;
+        for (int x = 0; x < s; x++)
+            (*heights)[y * s + x] = row[x * 4] * 257;
     }
-    data[length] = '\0';
-    fclose(file);
-    return data;
+    *size = s;
+    return true;
 }
 
-GLuint compile_shader(const char *source, GLenum type)
+// Load a packed heightmap as a single channel R11 EAC cubemap
+// with all its mip levels, an eighth of the size of the RGBA8
+// one and 11 bits deep. It is encoded on the first run
+// and cached, or uploaded uncompressed if that fails.
+GLuint load_height_packed_cubemap(const char *filename, MaliSDK::ImageUploadQueue *uploads, PendingCubemap *pending)
+{
+    std::string base = filename;
+    base = base.substr(0, base.rfind('.'));
+
+    PackedCubemap packed = { filename, NULL, 0 };
+    GLuint texture = 0;
+    glActiveTexture(GL_TEXTURE0);
+    bool loaded = MaliSDK::TextureFormatSelector::loadHeightCubemap(base.c_str(), read_packed_height_face, &packed, &texture);
+    if (packed.pixels)
+        stbi_image_free(packed.pixels);
+
+    if (!loaded)
+        return load_packed_cubemap(filename, uploads, pending);
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+GLuint compile_shader(const char *source, GLint length, GLenum type)
 {
     GLuint result = glCreateShader(type);
-    glShaderSource(result, 1, (const GLchar**)&source, NULL);
+    glShaderSource(result, 1, (const GLchar**)&source, &length);
     glCompileShader(result);
     GLint status;
     glGetShaderiv(result, GL_COMPILE_STATUS, &status);
     if (status == GL_FALSE) {
-        GLint length;
-        glGetShaderiv(result, GL_INFO_LOG_LENGTH, &length);
-        GLchar *info = new GLchar[length];
-        glGetShaderInfoLog(result, length, NULL, info);
+        GLint logLength;
+        glGetShaderiv(result, GL_INFO_LOG_LENGTH, &logLength);
+        GLchar *info = new GLchar[logLength];
+        glGetShaderInfoLog(result, logLength, NULL, info);
         LOGE("[COMPILE] %s\n", info);
         delete[] info;
         exit(1);
@@ -146,6 +283,7 @@ GLuint link_program(GLuint *shaders, int count)
     for (int i = 0; i < count; ++i)
         glAttachShader(program, shaders[i]);
 
+    MaliSDK::ProgramBinaryCache::prepareProgram(program);
     glLinkProgram(program);
 
     for (int i = 0; i < count; ++i)
@@ -165,47 +303,76 @@ GLuint link_program(GLuint *shaders, int count)
     return program;
 }
 
+
+// Compiles and links a program from the given shader files, unless a binary
+// from a previous run of the same sources on the same driver is cached.
+// The sources are used straight from the mapped files, without a copy.
+GLuint load_program(const char **paths, const GLenum *types, int count)
+{
+    MaliSDK::AssetFile files[5];
+    const char *sources[5];
+    size_t lengths[5];
+    for (int i = 0; i < count; ++i)
+    {
+        if (!files[i].open(paths[i]))
+        {
+            LOGE("Failed to open file %s\n", paths[i]);
+            exit(1);
+        }
+        sources[i] = (const char *)files[i].getData();
+        lengths[i] = files[i].getSize();
+    }
+
+    unsigned long long key = MaliSDK::ProgramBinaryCache::computeKey(sources, lengths, count);
+    GLuint program = glCreateProgram();
+    if (MaliSDK::ProgramBinaryCache::loadProgram(program, key))
+        return program;
+    glDeleteProgram(program);
+
+    GLuint shaders[5];
+    for (int i = 0; i < count; ++i)
+        shaders[i] = compile_shader(sources[i], (GLint)lengths[i], types[i]);
+
+    program = link_program(shaders, count);
+
+    for (int i = 0; i < count; ++i)
+        glDeleteShader(shaders[i]);
+
+    MaliSDK::ProgramBinaryCache::storeProgram(program, key);
+    return program;
+}
+
 void load_mapping_shader(App *app)
 {
-    char *vs_src = read_file(SHADER_PATH("shader.vs"));
-    char *fs_src = read_file(SHADER_PATH("shader.fs"));
-    char *tc_src = read_file(SHADER_PATH("shader.tcs"));
-    char *te_src = read_file(SHADER_PATH("shader.tes"));
-
-    GLuint shaders[4];
-    shaders[0] = compile_shader(vs_src, GL_VERTEX_SHADER);
-    shaders[1] = compile_shader(fs_src, GL_FRAGMENT_SHADER);
-    shaders[2] = compile_shader(tc_src, GL_TESS_CONTROL_SHADER);
-    shaders[3] = compile_shader(te_src, GL_TESS_EVALUATION_SHADER);
-    app->program_mapping = link_program(shaders, 4);
-
-    free(vs_src);
-    free(fs_src);
-    free(tc_src);
-    free(te_src);
+    const char *paths[] = { SHADER_PATH("shader.vs"), SHADER_PATH("shader.fs"), SHADER_PATH("shader.tcs"), SHADER_PATH("shader.tes") };
+    const GLenum types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER };
+    app->program_mapping = load_program(paths, types, 4);
 }
 
 void load_backdrop_shader(App *app)
 {
-    char *vs_src = read_file(SHADER_PATH("backdrop.vs"));
-    char *fs_src = read_file(SHADER_PATH("backdrop.fs"));
-
-    GLuint shaders[2];
-    shaders[0] = compile_shader(vs_src, GL_VERTEX_SHADER);
-    shaders[1] = compile_shader(fs_src, GL_FRAGMENT_SHADER);
-    app->program_backdrop = link_program(shaders, 2);
-
-    free(vs_src);
-    free(fs_src);
+    const char *paths[] = { SHADER_PATH("backdrop.vs"), SHADER_PATH("backdrop.fs") };
+    const GLenum types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+    app->program_backdrop = load_program(paths, types, 2);
 }
 
 void load_assets(App *app)
 {
-    load_mapping_shader(app);
-    load_backdrop_shader(app);
-
-    app->scenes[0].heightmap = load_packed_cubemap(HEIGHTMAP_PATH("magicmoon"));
-    app->scenes[0].diffusemap = load_packed_cubemap(DIFFUSEMAP_PATH("magicmoon"));
+    // The diffuse maps are compressed to ETC. The heightmaps drive the
+    // displacement, where ETC's per-block colour quantization shows up
+    // as steps in the surface, so they are single channel R11 EAC
+    // instead, which keeps 11 bits of the height.
+    MaliSDK::TextureFormatSelector::setCacheDirectory(BASE_ASSET_PATH);
+
+    // Textures that are not compressed are decoded on the big cores,
+    // while the shaders compile, and uploaded at the end.
+    MaliSDK::JobScheduler scheduler;
+    scheduler.initialize(0);
+    MaliSDK::ImageUploadQueue uploads(&scheduler);
+    PendingCubemap pending[NUM_SCENES * 2];
+
+    app->scenes[0].heightmap = load_height_packed_cubemap(HEIGHTMAP_PATH("magicmoon"), &uploads, &pending[0]);
+    app->scenes[0].diffusemap = load_compressed_packed_cubemap(DIFFUSEMAP_PATH("magicmoon"), &uploads, &pending[1]);
     app->scenes[0].sun_dir = normalize(vec3(1.0f, 1.0f, -0.5f));
     app->scenes[0].use_mip = true;
     app->scenes[0].max_lod_coverage = 150.0f;
@@ -214,8 +381,8 @@ void load_assets(App *app)
     app->scenes[0].z_near = 0.1f;
     app->scenes[0].z_far = 16.0f;
 
-    app->scenes[1].heightmap = load_packed_cubemap(HEIGHTMAP_PATH("swirly"));
-    app->scenes[1].diffusemap = load_packed_cubemap(DIFFUSEMAP_PATH("swirly"));
+    app->scenes[1].heightmap = load_height_packed_cubemap(HEIGHTMAP_PATH("swirly"), &uploads, &pending[2]);
+    app->scenes[1].diffusemap = load_compressed_packed_cubemap(DIFFUSEMAP_PATH("swirly"), &uploads, &pending[3]);
     app->scenes[1].sun_dir = normalize(vec3(0.5f, 0.2f, -0.2f));
     app->scenes[1].use_mip = true;
     app->scenes[1].max_lod_coverage = 150.0f;
@@ -224,8 +391,8 @@ void load_assets(App *app)
     app->scenes[1].z_near = 0.1f;
     app->scenes[1].z_far = 16.0f;
 
-    app->scenes[2].heightmap = load_packed_cubemap(HEIGHTMAP_PATH("voronoi_env"));
-    app->scenes[2].diffusemap = load_packed_cubemap(DIFFUSEMAP_PATH("voronoi_env"));
+    app->scenes[2].heightmap = load_height_packed_cubemap(HEIGHTMAP_PATH("voronoi_env"), &uploads, &pending[4]);
+    app->scenes[2].diffusemap = load_compressed_packed_cubemap(DIFFUSEMAP_PATH("voronoi_env"), &uploads, &pending[5]);
     app->scenes[2].sun_dir = normalize(vec3(0.8f, 0.2f, -0.2f));
     app->scenes[2].use_mip = true;
     app->scenes[2].max_lod_coverage = 350.0f;
@@ -234,8 +401,8 @@ void load_assets(App *app)
     app->scenes[2].z_near = 0.1f;
     app->scenes[2].z_far = 16.0f;
 
-    app->scenes[3].heightmap = load_packed_cubemap(HEIGHTMAP_PATH("voronoi_sharp"));
-    app->scenes[3].diffusemap = load_packed_cubemap(DIFFUSEMAP_PATH("voronoi_sharp"));
+    app->scenes[3].heightmap = load_height_packed_cubemap(HEIGHTMAP_PATH("voronoi_sharp"), &uploads, &pending[6]);
+    app->scenes[3].diffusemap = load_compressed_packed_cubemap(DIFFUSEMAP_PATH("voronoi_sharp"), &uploads, &pending[7]);
     app->scenes[3].sun_dir = normalize(vec3(0.3f, 1.0f, 0.3f));
     app->scenes[3].use_mip = true;
     app->scenes[3].max_lod_coverage = 250.0f;
@@ -244,8 +411,8 @@ void load_assets(App *app)
     app->scenes[3].z_near = 0.1f;
     app->scenes[3].z_far = 16.0f;
 
-    app->scenes[4].heightmap = load_packed_cubemap(HEIGHTMAP_PATH("wavey"));
-    app->scenes[4].diffusemap = load_packed_cubemap(DIFFUSEMAP_PATH("wavey"));
+    app->scenes[4].heightmap = load_height_packed_cubemap(HEIGHTMAP_PATH("wavey"), &uploads, &pending[8]);
+    app->scenes[4].diffusemap = load_compressed_packed_cubemap(DIFFUSEMAP_PATH("wavey"), &uploads, &pending[9]);
     app->scenes[4].sun_dir = normalize(vec3(0.8f, 0.2f, -0.2f));
     app->scenes[4].use_mip = true;
     app->scenes[4].max_lod_coverage = 115.0f;
@@ -253,4 +420,9 @@ void load_assets(App *app)
     app->scenes[4].fov = PI / 4.0f;
     app->scenes[4].z_near = 0.1f;
     app->scenes[4].z_far = 16.0f;
+
+    load_mapping_shader(app);
+    load_backdrop_shader(app);
+
+    uploads.finish();
 }
@@ -35,6 +35,8 @@
 #define GL_TESS_CONTROL_SHADER GL_TESS_CONTROL_SHADER_EXT
 #define GL_TESS_EVALUATION_SHADER GL_TESS_EVALUATION_SHADER_EXT
 #define glPatchParameteri glPatchParameteriEXT
+#define GL_PRIMITIVES_GENERATED GL_PRIMITIVES_GENERATED_EXT
+#include <string.h>
 #include "tessellation.cpp"
 
 #include <jni.h>
@@ -43,6 +45,9 @@
 
 #include "EGLRuntime.h"
 #include "Platform.h"
+#include "FontAtlas.h"
+#include "SDFText.h"
+#include "OverlayBatch.h"
 using namespace MaliSDK;
 
 #define BASE_ASSET_PATH         "/data/data/com.arm.malideveloper.openglessdk.tessellation/files/"
@@ -53,6 +58,42 @@ using namespace MaliSDK;
 
 static timeval start_time;
 static App app;
+static FontAtlas *font_atlas = NULL;
+static SDFText *overlay = NULL;
+static OverlayBatch *overlay_batch = NULL;
+static float last_frame_time = 0.0f;
+static float average_frame_time = 0.0f;
+
+// Tessellated triangles per frame and per second. The count is
+// that of a frame a few frames back, so it lags slightly.
+void render_overlay()
+{
+    if (!overlay || !overlay_batch)
+    {
+        return;
+    }
+
+    char line[128];
+    overlay->clear();
+    if (app.primitive_queries_supported)
+    {
+        float triangles_per_second = average_frame_time > 0.0f ? app.tessellated_triangles / average_frame_time : 0.0f;
+        sprintf(line, "Tessellated triangles: %7u per frame, %6.1f M/s", app.tessellated_triangles, triangles_per_second * 1e-6f);
+    }
+    else
+    {
+        sprintf(line, "Tessellated triangles: GL_PRIMITIVES_GENERATED not supported");
+    }
+    overlay->addString(20, app.window_height - 40, line, 20.0f, 0, 255, 255, 255, 255);
+
+    // A dark strip under the line keeps it readable over the terrain, and is drawn in the same call as the text.
+    overlay_batch->clear();
+    overlay_batch->addRectangle(0, 10.0f, app.window_height - 48.0f, 20.0f + strlen(line) * 10.0f, 36.0f, 0, 0, 0, 160);
+    overlay->submit(*overlay_batch, 1);
+
+    glDisable(GL_CULL_FACE);
+    overlay_batch->draw();
+}
 
 const char *get_gl_error_msg(GLenum code)
 {
@@ -89,9 +130,16 @@ extern "C"
         start_time.tv_usec = 0;
         gettimeofday(&start_time, NULL);
 
+        MaliSDK::ProgramBinaryCache::setDirectory(BASE_ASSET_PATH);
         LOGD("Loading assets");
         load_assets(&app);
         app_initialize(&app);
+
+        delete font_atlas;
+        font_atlas = new FontAtlas;
+        // font.raw holds 32 by 3 glyphs of 8x16 pixels.
+        font_atlas->addBitmapFont(BASE_ASSET_PATH "font.raw", 256, 48, 8, 16);
+        font_atlas->upload();
         LOGD("App successfully initialized");
     }
 
@@ -101,6 +149,11 @@ extern "C"
         app.window_width = width;
         app.window_height = height;
         glViewport(0, 0, width, height);
+
+        delete overlay;
+        overlay = new SDFText(font_atlas, width, height);
+        delete overlay_batch;
+        overlay_batch = new OverlayBatch(width, height);
         LOGD("Resizing %d %d\n", width, height);
     }
 
@@ -113,9 +166,15 @@ extern "C"
         float milliseconds = (float(now.tv_usec - start_time.tv_usec)) / 1000000.0f;
         app.elapsed_time = seconds + milliseconds;
 
+        // Smooth the frame time so the rate in the overlay is readable.
+        float frame_time = app.elapsed_time - last_frame_time;
+        last_frame_time = app.elapsed_time;
+        average_frame_time = average_frame_time > 0.0f ? 0.95f * average_frame_time + 0.05f * frame_time : frame_time;
+
         glClearColor(1.0f, 0.3f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
         app_update_and_render(&app);
+        render_overlay();
         gl_check_error();
     }
 }
@@ -18,8 +18,8 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifndef MATRIX_H
-#define MATRIX_H
+#ifndef TESSELLATION_MATRIX_H
+#define TESSELLATION_MATRIX_H
 #ifndef PI
 #define PI 3.141592653f
 #endif
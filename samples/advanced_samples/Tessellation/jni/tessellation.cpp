@@ -19,6 +19,8 @@
  */
 
 #include "tessellation.h"
+// shader.tes assumes 16x16 patches per side of the cube
+// when it picks the level of the heightmap to sample.
 #define QUAD_RES_X 16
 #define QUAD_RES_Y 16
 #define SIDES_IN_A_CUBE 6
@@ -165,6 +167,45 @@ void app_initialize(App *app)
     get_uniform_location(backdrop, view);
 
     app->current_scene = 0;
+
+    // GL_PRIMITIVES_GENERATED comes with geometry shaders, which
+    // are not required by the sample.
+    const char *version = (const char*)glGetString(GL_VERSION);
+    const char *extensions = (const char*)glGetString(GL_EXTENSIONS);
+    app->primitive_queries_supported =
+        (version && strstr(version, "OpenGL ES 3.2")) ||
+        (extensions && strstr(extensions, "GL_EXT_geometry_shader"));
+
+    if (app->primitive_queries_supported)
+    {
+        glGenQueries(NUM_PRIMITIVE_QUERIES, app->primitive_queries);
+    }
+    for (int i = 0; i < NUM_PRIMITIVE_QUERIES; i++)
+    {
+        app->primitive_query_pending[i] = false;
+    }
+    app->primitive_query_index = 0;
+    app->tessellated_triangles = 0;
+}
+
+// Collect the count of the oldest query, if the GPU is done with it,
+// and returns the query to issue this frame's count into.
+GLuint next_primitive_query(App *app)
+{
+    int index = app->primitive_query_index;
+    GLuint query = app->primitive_queries[index];
+    if (app->primitive_query_pending[index])
+    {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            glGetQueryObjectuiv(query, GL_QUERY_RESULT, &app->tessellated_triangles);
+        }
+    }
+    app->primitive_query_pending[index] = true;
+    app->primitive_query_index = (index + 1) % NUM_PRIMITIVE_QUERIES;
+    return query;
 }
 
 float animate_model_scale(float t)
@@ -257,5 +298,16 @@ void app_update_and_render(App *app)
     uniformm4(mapping, view,                mat_view);
     uniformm4(mapping, projection,          mat_projection);
     glPatchParameteri(GL_PATCH_VERTICES, VERTICES_PER_PATCH);
+
+    // Count what the tessellator emits, to see the effect of the
+    // screen-space levels and of the culled patches.
+    if (app->primitive_queries_supported)
+    {
+        glBeginQuery(GL_PRIMITIVES_GENERATED, next_primitive_query(app));
+    }
     glDrawArrays(GL_PATCHES, 0, NUM_PATCHES * VERTICES_PER_PATCH);
+    if (app->primitive_queries_supported)
+    {
+        glEndQuery(GL_PRIMITIVES_GENERATED);
+    }
 }
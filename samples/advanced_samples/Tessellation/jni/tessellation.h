@@ -24,6 +24,10 @@
 #include "matrix.h"
 
 #define NUM_SCENES 5
+
+// Results are read this many frames after they were issued,
+// by when they are available without waiting for the GPU.
+#define NUM_PRIMITIVE_QUERIES 4
 struct Scene
 {
     GLuint heightmap;
@@ -71,6 +75,13 @@ struct App
     GLuint vao;
     GLuint vbo_cube;
     GLuint vbo_quad;
+
+    // Triangles produced by the tessellator for the sphere
+    bool primitive_queries_supported;
+    GLuint primitive_queries[NUM_PRIMITIVE_QUERIES];
+    bool primitive_query_pending[NUM_PRIMITIVE_QUERIES];
+    int primitive_query_index;
+    GLuint tessellated_triangles;
 };
 
 void app_initialize(App *app);
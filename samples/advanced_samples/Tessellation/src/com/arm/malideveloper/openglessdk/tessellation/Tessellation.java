@@ -78,6 +78,7 @@ public class Tessellation extends Activity
         extractAsset("shader.tcs");
         extractAsset("shader.tes");
         extractAsset("shader.fs");
+        extractAsset("font.raw");
 
         extractAsset("magicmoon_heightmap.png");
         extractAsset("magicmoon_diffusemap.png");
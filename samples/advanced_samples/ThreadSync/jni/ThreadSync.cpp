@@ -35,6 +35,25 @@
 /* Fencing state. */
 static bool useFence = true;
 
+/*
+ * Texture upload mode.
+ * UPLOAD_TEX_IMAGE re-specifies the single shared texture with glTexImage2D, synchronised according to useFence.
+ * UPLOAD_STREAMING writes into a ring of PBOs and updates one of three immutable textures with glTexSubImage2D.
+ * Finished textures are handed over to the main thread together with a fence, so neither thread ever waits on the CPU.
+ * UPLOAD_HARDWARE_BUFFER writes straight into one of three AHardwareBuffers the textures sample from, so nothing is copied.
+ * The hand over uses native fences, and the secondary thread only waits while the GPU is still reading the buffer.
+ * UPLOAD_NATIVE_FENCE updates one of three immutable textures handed over through a NativeFenceQueue. The fences are
+ * file descriptors rather than sync objects of the shared contexts, so the producer could as well be another process.
+ */
+enum UploadMode
+{
+    UPLOAD_TEX_IMAGE,
+    UPLOAD_STREAMING,
+    UPLOAD_HARDWARE_BUFFER,
+    UPLOAD_NATIVE_FENCE
+};
+static UploadMode uploadMode = UPLOAD_TEX_IMAGE;
+
 #include <string>
 #include <jni.h>
 #include <android/log.h>
@@ -43,10 +62,15 @@ static bool useFence = true;
 #include <pthread.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #include "Text.h"
 #include "Shader.h"
 #include "Matrix.h"
+#include "HardwareBufferTexture.h"
+#include "NativeFenceQueue.h"
+#include "EGLContextOptions.h"
 
 using std::string;
 using namespace MaliSDK;
@@ -105,6 +129,48 @@ GLsync secondThreadSyncObj = NULL;
 GLsync mainThreadSyncObj = NULL;
 GLuint64 timeout = GL_TIMEOUT_IGNORED;
 
+/* Streaming uploads. */
+#define NUMBER_OF_STREAMING_TEXTURES 3
+#define NUMBER_OF_STREAMING_PBOS 3
+GLuint streamingTextures[NUMBER_OF_STREAMING_TEXTURES] = { 0 };
+GLuint streamingPBOs[NUMBER_OF_STREAMING_PBOS] = { 0 };
+/* Signalled when the GPU has finished copying out of a PBO. Only used by the secondary thread. */
+GLsync streamingPBOSyncObjs[NUMBER_OF_STREAMING_PBOS] = { NULL };
+int streamingPBOIndex = 0;
+
+/* The state below is shared between the threads and protected by streamingMutex. */
+pthread_mutex_t streamingMutex = PTHREAD_MUTEX_INITIALIZER;
+/* Texture the main thread is drawing with. */
+int displayedTexture = 0;
+/* Most recently completed texture not yet picked up by the main thread, or -1. */
+int readyTexture = -1;
+/* Signalled when the upload to readyTexture has completed. */
+GLsync readyTextureSyncObj = NULL;
+/* Texture the main thread has stopped displaying but has not yet fenced, or -1. */
+int releasingTexture = -1;
+/* Signalled when the main thread's draws using a texture have completed, so it can be overwritten. */
+GLsync releasedTextureSyncObjs[NUMBER_OF_STREAMING_TEXTURES] = { NULL };
+
+/* Zero-copy uploads, only when HardwareBufferTexture::isSupported(). The state below is protected by streamingMutex too. */
+bool hardwareBuffersSupported = false;
+HardwareBufferTexture *hardwareBufferTextures[NUMBER_OF_STREAMING_TEXTURES] = { NULL };
+int displayedHardwareBuffer = 0;
+int readyHardwareBuffer = -1;
+int releasingHardwareBuffer = -1;
+
+/* Native fence hand over, only when NativeFenceQueue::isSupported(). The queue does its own locking. */
+bool nativeFencesSupported = false;
+NativeFenceQueue *nativeFenceQueue = NULL;
+GLuint nativeFenceTextures[NUMBER_OF_STREAMING_TEXTURES] = { 0 };
+/* Slot the main thread is drawing with, or -1 before the first one is picked up. Only used by the main thread. */
+int displayedNativeFenceSlot = -1;
+
+/* Upload latency, measured in the secondary thread from the start of the upload until its fence has been created. */
+pthread_mutex_t statisticsMutex = PTHREAD_MUTEX_INITIALIZER;
+double uploadTimeTotal = 0.0;
+int uploadCount = 0;
+double lastStatisticsTime = 0.0;
+
 /* Texture generation. */
 unsigned char *textureData = NULL;
 int swapStripes = -1;
@@ -133,30 +199,148 @@ void touchMove (int x, int y)
     /* Empty. */
 }
 
+/* Monotonic time in seconds. */
+static double getSeconds(void)
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/* Text describing the current upload and fencing mode. */
+static string getModeString(void)
+{
+    if(uploadMode == UPLOAD_NATIVE_FENCE)
+    {
+        return baseString + "Native fence queue.";
+    }
+    else if(uploadMode == UPLOAD_HARDWARE_BUFFER)
+    {
+        return baseString + "Zero-copy hardware buffers.";
+    }
+    else if(uploadMode == UPLOAD_STREAMING)
+    {
+        return baseString + "PBO streaming.";
+    }
+    else if(useFence)
+    {
+        return baseString + "Fencing enabled.";
+    }
+    else
+    {
+        return baseString + "Fencing disabled.";
+    }
+}
+
+static void recordUploadTime(double seconds)
+{
+    pthread_mutex_lock(&statisticsMutex);
+    uploadTimeTotal += seconds;
+    uploadCount++;
+    pthread_mutex_unlock(&statisticsMutex);
+}
+
+/* Once a second, show the average upload latency of the current mode. */
+static void updateStatistics(void)
+{
+    double now = getSeconds();
+    if(now - lastStatisticsTime < 1.0)
+    {
+        return;
+    }
+    lastStatisticsTime = now;
+
+    pthread_mutex_lock(&statisticsMutex);
+    double averageTime = uploadCount ? uploadTimeTotal / uploadCount : 0.0;
+    int count = uploadCount;
+    uploadTimeTotal = 0.0;
+    uploadCount = 0;
+    pthread_mutex_unlock(&statisticsMutex);
+
+    char statisticsString[96];
+    snprintf(statisticsString, sizeof(statisticsString), " Upload: %.2f ms (%d/s).", averageTime * 1000.0, count);
+    LOGI("%s%s\n", getModeString().c_str(), statisticsString);
+
+    /* The hand over latency of the frames picked up in the last second, p50 shown and all percentiles logged. */
+    if(uploadMode == UPLOAD_NATIVE_FENCE)
+    {
+        FrameStatistics &latencyStatistics = nativeFenceQueue->getLatencyStatistics();
+        latencyStatistics.log("Native fence hand over");
+
+        size_t length = strlen(statisticsString);
+        snprintf(statisticsString + length, sizeof(statisticsString) - length, " Latency: %.2f ms, %d dropped.",
+                 latencyStatistics.getPercentile(0.5f), nativeFenceQueue->getNumberOfDroppedFrames());
+        latencyStatistics.reset();
+    }
+
+    text->clear();
+    textString = getModeString() + statisticsString;
+    text->addString(0, 0, textString.c_str(), 255, 255, 0, 255);
+}
+
+/*
+ * Touching cycles through fencing enabled, fencing disabled, PBO streaming, and zero-copy hardware buffers
+ * and the native fence queue if supported.
+ */
 void touchEnd(int x, int y)
 {
     if(touchStarted)
     {
-        useFence = !useFence;
         touchStarted = false;
 
-        text->clear();
-        if(useFence)
+        if(uploadMode == UPLOAD_NATIVE_FENCE)
         {
-            textString = baseString + "Fencing enabled.";
-            LOGI("Changed fencing from disabled to enabled.");
+            uploadMode = UPLOAD_TEX_IMAGE;
+            useFence = true;
+            LOGI("Changed from native fence queue to fencing enabled.");
         }
-        else
+        else if(uploadMode == UPLOAD_HARDWARE_BUFFER && nativeFencesSupported)
         {
-            textString = baseString + "Fencing disabled.";
+            uploadMode = UPLOAD_NATIVE_FENCE;
+            LOGI("Changed from zero-copy hardware buffers to native fence queue.");
+        }
+        else if(uploadMode == UPLOAD_HARDWARE_BUFFER)
+        {
+            uploadMode = UPLOAD_TEX_IMAGE;
+            useFence = true;
+            LOGI("Changed from zero-copy hardware buffers to fencing enabled.");
+        }
+        else if(uploadMode == UPLOAD_STREAMING && hardwareBuffersSupported)
+        {
+            uploadMode = UPLOAD_HARDWARE_BUFFER;
+            LOGI("Changed from PBO streaming to zero-copy hardware buffers.");
+        }
+        else if(uploadMode == UPLOAD_STREAMING && nativeFencesSupported)
+        {
+            uploadMode = UPLOAD_NATIVE_FENCE;
+            LOGI("Changed from PBO streaming to native fence queue.");
+        }
+        else if(uploadMode == UPLOAD_STREAMING)
+        {
+            uploadMode = UPLOAD_TEX_IMAGE;
+            useFence = true;
+            LOGI("Changed from PBO streaming to fencing enabled.");
+        }
+        else if(useFence)
+        {
+            useFence = false;
             LOGI("Changed fencing from enabled to disabled.")
         }
+        else
+        {
+            uploadMode = UPLOAD_STREAMING;
+            LOGI("Changed from fencing disabled to PBO streaming.");
+        }
+
+        text->clear();
+        textString = getModeString();
         text->addString(0, 0, textString.c_str(), 255, 255, 0, 255);
     }
 }
 
-/* Modify the texture. */
-void animateTexture()
+/* Modify the texture. Rows start rowStride pixels apart. */
+void animateTexture(unsigned char *textureData, int rowStride)
 {
     static int col = 0;
     static int col1 = 1;
@@ -180,6 +364,8 @@ void animateTexture()
 
     for(int y = 0; y < texHeight; y++)
     {
+        offset = y * rowStride * 4;
+
         for(int x = 0; x < texWidth; x++)
         {
             /* Squared distance from pixel to centre. */
@@ -253,7 +439,7 @@ void initTexture(void)
     }
 
     /* Fill texture buffer with data. Circles with different colours. */
-    animateTexture();
+    animateTexture(textureData, texWidth);
 
     /* Initialise texture. */
     GL_CHECK(glGenTextures(1, &iCubeTex));
@@ -265,6 +451,337 @@ void initTexture(void)
     /* Set filtering. */
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+
+    /* Immutable textures for the streaming mode. Storage is allocated once, and only the contents change after this. */
+    GL_CHECK(glGenTextures(NUMBER_OF_STREAMING_TEXTURES, streamingTextures));
+    for(int i = 0; i < NUMBER_OF_STREAMING_TEXTURES; i++)
+    {
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, streamingTextures[i]));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, texWidth, texHeight));
+        GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texWidth, texHeight, GL_RGBA, GL_UNSIGNED_BYTE, textureData));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        releasedTextureSyncObjs[i] = NULL;
+    }
+
+    GL_CHECK(glGenBuffers(NUMBER_OF_STREAMING_PBOS, streamingPBOs));
+    for(int i = 0; i < NUMBER_OF_STREAMING_PBOS; i++)
+    {
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamingPBOs[i]));
+        GL_CHECK(glBufferData(GL_PIXEL_UNPACK_BUFFER, numBytes, NULL, GL_STREAM_DRAW));
+        streamingPBOSyncObjs[i] = NULL;
+    }
+    GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+    displayedTexture = 0;
+    readyTexture = -1;
+    readyTextureSyncObj = NULL;
+    releasingTexture = -1;
+    streamingPBOIndex = 0;
+
+    /* Textures backed by hardware buffers for the zero-copy mode. Their contents are written in place. */
+    hardwareBuffersSupported = HardwareBufferTexture::isSupported();
+    if(hardwareBuffersSupported)
+    {
+        for(int i = 0; i < NUMBER_OF_STREAMING_TEXTURES; i++)
+        {
+            hardwareBufferTextures[i] = new HardwareBufferTexture(texWidth, texHeight);
+
+            int rowStride = 0;
+            unsigned char *pixels = hardwareBufferTextures[i]->lock(&rowStride);
+            if(pixels != NULL)
+            {
+                animateTexture(pixels, rowStride);
+                hardwareBufferTextures[i]->unlock();
+            }
+            hardwareBufferTextures[i]->acquire();
+        }
+    }
+    else
+    {
+        LOGI("Zero-copy hardware buffers not supported.\n");
+    }
+
+    displayedHardwareBuffer = 0;
+    readyHardwareBuffer = -1;
+    releasingHardwareBuffer = -1;
+
+    /* Immutable textures for the native fence mode, one per slot of the queue. */
+    nativeFencesSupported = NativeFenceQueue::isSupported();
+    if(nativeFencesSupported)
+    {
+        GL_CHECK(glGenTextures(NUMBER_OF_STREAMING_TEXTURES, nativeFenceTextures));
+        for(int i = 0; i < NUMBER_OF_STREAMING_TEXTURES; i++)
+        {
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D, nativeFenceTextures[i]));
+            GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, texWidth, texHeight));
+            GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texWidth, texHeight, GL_RGBA, GL_UNSIGNED_BYTE, textureData));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        }
+        nativeFenceQueue = new NativeFenceQueue(NUMBER_OF_STREAMING_TEXTURES);
+    }
+    else
+    {
+        LOGI("Native fences not supported.\n");
+    }
+
+    displayedNativeFenceSlot = -1;
+}
+
+/*
+ * Streaming upload, run in the secondary thread.
+ * The texture data is generated straight into a PBO, and glTexSubImage2D copies it into a texture
+ * which is neither displayed nor waiting to be displayed. The main thread picks it up through readyTexture.
+ */
+static void streamTexture(void)
+{
+    double startTime = getSeconds();
+
+    /*
+     * Pick a texture the main thread is not using and will not switch to.
+     * If the only candidate is the one waiting to be picked up, take that back instead.
+     * Our earlier upload to it is already ordered before this one as both run in this context.
+     */
+    pthread_mutex_lock(&streamingMutex);
+    int textureIndex = -1;
+    for(int i = 0; i < NUMBER_OF_STREAMING_TEXTURES && textureIndex < 0; i++)
+    {
+        if(i != displayedTexture && i != releasingTexture && i != readyTexture)
+        {
+            textureIndex = i;
+        }
+    }
+    GLsync revokedSyncObj = NULL;
+    if(textureIndex < 0)
+    {
+        textureIndex = readyTexture;
+        revokedSyncObj = readyTextureSyncObj;
+        readyTexture = -1;
+        readyTextureSyncObj = NULL;
+    }
+    GLsync releasedSyncObj = releasedTextureSyncObjs[textureIndex];
+    releasedTextureSyncObjs[textureIndex] = NULL;
+    pthread_mutex_unlock(&streamingMutex);
+
+    if(revokedSyncObj != NULL)
+    {
+        GL_CHECK(glDeleteSync(revokedSyncObj));
+    }
+
+    /* Reuse the PBO only after the GPU has finished the previous copy out of it. With a ring of three this rarely blocks. */
+    GLsync pboSyncObj = streamingPBOSyncObjs[streamingPBOIndex];
+    if(pboSyncObj != NULL)
+    {
+        GL_CHECK(glClientWaitSync(pboSyncObj, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED));
+        GL_CHECK(glDeleteSync(pboSyncObj));
+        streamingPBOSyncObjs[streamingPBOIndex] = NULL;
+    }
+
+    int numBytes = texWidth * texHeight * 4;
+    GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamingPBOs[streamingPBOIndex]));
+    GL_CHECK(unsigned char *pixels = (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, numBytes,
+                                                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    if(pixels == NULL)
+    {
+        LOGE("Failed to map streaming PBO.\n");
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        if(releasedSyncObj != NULL)
+        {
+            pthread_mutex_lock(&streamingMutex);
+            releasedTextureSyncObjs[textureIndex] = releasedSyncObj;
+            pthread_mutex_unlock(&streamingMutex);
+        }
+        return;
+    }
+
+    /* Generate directly into the PBO, instead of into textureData followed by a copy. */
+    animateTexture(pixels, texWidth);
+    GL_CHECK(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+    /* The main thread must be done drawing with the texture before we overwrite it. This is a GPU-side wait only. */
+    if(releasedSyncObj != NULL)
+    {
+        GL_CHECK(glWaitSync(releasedSyncObj, 0, GL_TIMEOUT_IGNORED));
+        GL_CHECK(glDeleteSync(releasedSyncObj));
+    }
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, streamingTextures[textureIndex]));
+    GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texWidth, texHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+    GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+    GL_CHECK(streamingPBOSyncObjs[streamingPBOIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    GL_CHECK(GLsync uploadSyncObj = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    streamingPBOIndex = (streamingPBOIndex + 1) % NUMBER_OF_STREAMING_PBOS;
+
+    /* The fence must be flushed before another context can wait on it. */
+    GL_CHECK(glFlush());
+
+    recordUploadTime(getSeconds() - startTime);
+
+    /* Hand over the texture. If the main thread never picked up the previous one, that one is simply dropped. */
+    pthread_mutex_lock(&streamingMutex);
+    GLsync droppedSyncObj = readyTextureSyncObj;
+    readyTexture = textureIndex;
+    readyTextureSyncObj = uploadSyncObj;
+    pthread_mutex_unlock(&streamingMutex);
+
+    if(droppedSyncObj != NULL)
+    {
+        GL_CHECK(glDeleteSync(droppedSyncObj));
+    }
+}
+
+/*
+ * Called by the main thread at the start of a frame in streaming mode.
+ * Switches to the latest completed texture, if any, and returns the index of the texture to draw with.
+ * previousTexture is set to the texture that was displayed before, or -1 if it did not change.
+ */
+static int acquireStreamingTexture(int *previousTexture)
+{
+    pthread_mutex_lock(&streamingMutex);
+    GLsync syncObj = readyTextureSyncObj;
+    *previousTexture = -1;
+    if(readyTexture >= 0)
+    {
+        *previousTexture = displayedTexture;
+        releasingTexture = displayedTexture;
+        displayedTexture = readyTexture;
+        readyTexture = -1;
+        readyTextureSyncObj = NULL;
+    }
+    int textureIndex = displayedTexture;
+    pthread_mutex_unlock(&streamingMutex);
+
+    /* Make the GPU wait for the upload to complete. The CPU carries on. */
+    if(syncObj != NULL)
+    {
+        GL_CHECK(glWaitSync(syncObj, 0, GL_TIMEOUT_IGNORED));
+        GL_CHECK(glDeleteSync(syncObj));
+    }
+
+    return textureIndex;
+}
+
+/* Called by the main thread after its last draw using a texture it is no longer going to display. */
+static void releaseStreamingTexture(int textureIndex)
+{
+    GL_CHECK(GLsync syncObj = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    GL_CHECK(glFlush());
+
+    pthread_mutex_lock(&streamingMutex);
+    GLsync oldSyncObj = releasedTextureSyncObjs[textureIndex];
+    releasedTextureSyncObjs[textureIndex] = syncObj;
+    releasingTexture = -1;
+    pthread_mutex_unlock(&streamingMutex);
+
+    if(oldSyncObj != NULL)
+    {
+        GL_CHECK(glDeleteSync(oldSyncObj));
+    }
+}
+
+/*
+ * Zero-copy upload, run in the secondary thread.
+ * The texture data is generated straight into a hardware buffer which is neither displayed nor being released.
+ * The main thread picks it up through readyHardwareBuffer. No context is needed, only the buffer is locked.
+ */
+static void writeHardwareBuffer(void)
+{
+    double startTime = getSeconds();
+
+    /* Same choice as streamTexture(), without sync objects: the fences are kept by the buffers themselves. */
+    pthread_mutex_lock(&streamingMutex);
+    int bufferIndex = -1;
+    for(int i = 0; i < NUMBER_OF_STREAMING_TEXTURES && bufferIndex < 0; i++)
+    {
+        if(i != displayedHardwareBuffer && i != releasingHardwareBuffer && i != readyHardwareBuffer)
+        {
+            bufferIndex = i;
+        }
+    }
+    if(bufferIndex < 0)
+    {
+        bufferIndex = readyHardwareBuffer;
+        readyHardwareBuffer = -1;
+    }
+    pthread_mutex_unlock(&streamingMutex);
+
+    /* Waits for the GPU to finish the draws which read this buffer last time it was displayed. */
+    int rowStride = 0;
+    unsigned char *pixels = hardwareBufferTextures[bufferIndex]->lock(&rowStride);
+    if(pixels == NULL)
+    {
+        return;
+    }
+
+    animateTexture(pixels, rowStride);
+    hardwareBufferTextures[bufferIndex]->unlock();
+
+    recordUploadTime(getSeconds() - startTime);
+
+    pthread_mutex_lock(&streamingMutex);
+    readyHardwareBuffer = bufferIndex;
+    pthread_mutex_unlock(&streamingMutex);
+}
+
+/*
+ * Called by the main thread at the start of a frame in zero-copy mode, like acquireStreamingTexture().
+ * The GPU waits for the writes to a newly picked up buffer, the CPU carries on.
+ */
+static int acquireHardwareBuffer(int *previousBuffer)
+{
+    pthread_mutex_lock(&streamingMutex);
+    bool pickedUp = readyHardwareBuffer >= 0;
+    *previousBuffer = -1;
+    if(pickedUp)
+    {
+        *previousBuffer = displayedHardwareBuffer;
+        releasingHardwareBuffer = displayedHardwareBuffer;
+        displayedHardwareBuffer = readyHardwareBuffer;
+        readyHardwareBuffer = -1;
+    }
+    int bufferIndex = displayedHardwareBuffer;
+    pthread_mutex_unlock(&streamingMutex);
+
+    if(pickedUp)
+    {
+        hardwareBufferTextures[bufferIndex]->acquire();
+    }
+
+    return bufferIndex;
+}
+
+/* Called by the main thread after its last draw using a buffer it is no longer going to display. */
+static void releaseHardwareBuffer(int bufferIndex)
+{
+    hardwareBufferTextures[bufferIndex]->release();
+
+    pthread_mutex_lock(&streamingMutex);
+    releasingHardwareBuffer = -1;
+    pthread_mutex_unlock(&streamingMutex);
+}
+
+/*
+ * Native fence upload, run in the secondary thread.
+ * dequeue() makes the GPU wait until the main thread is done drawing with the texture, and queue() fences the upload.
+ */
+static void uploadThroughNativeFenceQueue(void)
+{
+    double startTime = getSeconds();
+
+    int slot = nativeFenceQueue->dequeue();
+    if(slot < 0)
+    {
+        return;
+    }
+
+    animateTexture(textureData, texWidth);
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, nativeFenceTextures[slot]));
+    GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texWidth, texHeight, GL_RGBA, GL_UNSIGNED_BYTE, textureData));
+    nativeFenceQueue->queue(slot);
+
+    recordUploadTime(getSeconds() - startTime);
 }
 
 /* [workingFunction 1] */
@@ -290,8 +807,14 @@ static void *workingFunction(void *arg)
     eglBindAPI(EGL_OPENGL_ES_API);
 
     /* [Creating rendering context] */
-    /* Sharing OpenGL ES objects with main thread's rendering context. */
-    pBufferContext = eglCreateContext(mainDisplay, config, mainContext, contextAttributes);
+    /*
+     * Sharing OpenGL ES objects with main thread's rendering context.
+     * The uploads are low priority so they never hold up the frames of the main context.
+     * GLSurfaceView creates the main context with error checking, so this one has to keep it too.
+     */
+    EGLContextOptions pBufferContextOptions = EGLContextOptions::forWorker();
+    pBufferContextOptions.noError = false;
+    pBufferContext = pBufferContextOptions.createContext(mainDisplay, config, mainContext, contextAttributes[1]);
     /* [Creating rendering context] */
     if(pBufferContext == EGL_NO_CONTEXT)
     {
@@ -318,8 +841,27 @@ static void *workingFunction(void *arg)
         /* Set texture change frequency to 60 frames/s. */
         usleep(1000000 / 60);
 
+        if(uploadMode == UPLOAD_STREAMING)
+        {
+            streamTexture();
+            continue;
+        }
+
+        if(uploadMode == UPLOAD_HARDWARE_BUFFER)
+        {
+            writeHardwareBuffer();
+            continue;
+        }
+
+        if(uploadMode == UPLOAD_NATIVE_FENCE)
+        {
+            uploadThroughNativeFenceQueue();
+            continue;
+        }
+
         /* Change texture. */
-        animateTexture();
+        animateTexture(textureData, texWidth);
+        double startTime = getSeconds();
 
         if(useFence)
         {
@@ -351,6 +893,8 @@ static void *workingFunction(void *arg)
             GL_CHECK(glBindTexture(GL_TEXTURE_2D, iCubeTex));
             GL_CHECK(glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, texWidth, texHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData));
         }
+
+        recordUploadTime(getSeconds() - startTime);
     }
 
     LOGI("Exiting secondary thread.\n");
@@ -392,14 +936,7 @@ bool setupGraphics(int width, int height)
     /* Initialise the Text object and add some text. */
     text = new Text(resourceDirectory.c_str(), windowWidth, windowHeight);
 
-    if(useFence)
-    {
-        textString = baseString + "Fencing enabled.";
-    }
-    else
-    {
-        textString = baseString + "Fencing disabled.";
-    }
+    textString = getModeString();
     text->addString(0, 0, textString.c_str(), 255, 255, 0, 255);
 
     /* Initialisation of some global variables needed in the case the application
@@ -529,8 +1066,34 @@ bool setupGraphics(int width, int height)
 void renderFrame(void)
 {
     GLbitfield flags = 0;
-
-    if(useFence)
+    bool streaming = uploadMode == UPLOAD_STREAMING;
+    bool zeroCopy = uploadMode == UPLOAD_HARDWARE_BUFFER;
+    bool nativeFence = uploadMode == UPLOAD_NATIVE_FENCE;
+    int streamingTexture = 0;
+    int previousStreamingTexture = -1;
+    int hardwareBuffer = 0;
+    int previousHardwareBuffer = -1;
+    int previousNativeFenceSlot = -1;
+
+    if(streaming)
+    {
+        streamingTexture = acquireStreamingTexture(&previousStreamingTexture);
+    }
+    else if(zeroCopy)
+    {
+        hardwareBuffer = acquireHardwareBuffer(&previousHardwareBuffer);
+    }
+    else if(nativeFence)
+    {
+        /* The GPU waits for the upload of a newly picked up slot, the CPU carries on. */
+        int acquiredSlot = nativeFenceQueue->acquire();
+        if(acquiredSlot >= 0)
+        {
+            previousNativeFenceSlot = displayedNativeFenceSlot;
+            displayedNativeFenceSlot = acquiredSlot;
+        }
+    }
+    else if(useFence)
     {
         if (secondThreadSyncObj != NULL)
         {
@@ -595,7 +1158,20 @@ void renderFrame(void)
     /* [renderFrame 3] */
     /* Ensure the correct texture is bound to texture unit 0. */
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, iCubeTex));
+    GLuint cubeTexture = iCubeTex;
+    if(streaming)
+    {
+        cubeTexture = streamingTextures[streamingTexture];
+    }
+    else if(zeroCopy)
+    {
+        cubeTexture = hardwareBufferTextures[hardwareBuffer]->getTexture();
+    }
+    else if(nativeFence && displayedNativeFenceSlot >= 0)
+    {
+        cubeTexture = nativeFenceTextures[displayedNativeFenceSlot];
+    }
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, cubeTexture));
 
     /* Set the sampler to point at the 0th texture unit. */
     GL_CHECK(glUniform1i(iLocTexture, 0));
@@ -604,8 +1180,23 @@ void renderFrame(void)
     GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, sizeof(cubeIndices) / sizeof(GLubyte), GL_UNSIGNED_BYTE, cubeIndices));
     /* [renderFrame 3] */
     /* Draw any text. */
+    updateStatistics();
     text->draw();
 
+    /* The previous streaming texture was last used by the previous frame, and has now been replaced. */
+    if(previousStreamingTexture >= 0)
+    {
+        releaseStreamingTexture(previousStreamingTexture);
+    }
+    if(previousHardwareBuffer >= 0)
+    {
+        releaseHardwareBuffer(previousHardwareBuffer);
+    }
+    if(previousNativeFenceSlot >= 0)
+    {
+        nativeFenceQueue->release(previousNativeFenceSlot);
+    }
+
     /* Update cube's rotation angles for animating. */
     angleX += 0.75;
     angleY += 0.5;
@@ -621,7 +1212,7 @@ void renderFrame(void)
      * This fence creates a sync object which is signalled when the fence
      * command reaches the end of the graphic pipeline.
      */
-    if(useFence)
+    if(useFence && !streaming && !zeroCopy && !nativeFence)
     {
         if(mainThreadSyncObj == NULL)
         {
@@ -663,6 +1254,15 @@ extern "C"
             free(textureData);
         }
 
+        for(int i = 0; i < NUMBER_OF_STREAMING_TEXTURES; i++)
+        {
+            delete hardwareBufferTextures[i];
+            hardwareBufferTextures[i] = NULL;
+        }
+
+        delete nativeFenceQueue;
+        nativeFenceQueue = NULL;
+
         delete text;
     }
 
@@ -26,6 +26,7 @@
 #include "common.h"
 #include "primitives.h"
 #include "meshloader.h"
+#include "TemporalUpscaler.h"
 #include <fstream>
 
 #ifndef GL_EXT_shader_pixel_local_storage
@@ -37,16 +38,21 @@
 
 int 
     window_width,
-    window_height;
+    window_height,
+    render_width,
+    render_height;
 
 Shader
     shader_prepass,
     shader_thickness,
     shader_scattering,
     shader_resolve,
-    shader_opaque;
+    shader_opaque,
+    shader_single_pass,
+    shader_single_pass_resolve;
 
 mat4 
+    mat_base_projection,
     mat_projection,
     mat_view;
 
@@ -85,16 +91,101 @@ static float rot_y = 0.0f;
 static float delta_x = 0.0f;
 static float delta_y = 0.0f;
 
+// The sample alternates between the multi-pass path and the single-pass
+// path every mode_duration seconds, and logs the average frame time of
+// each, so the two can be compared on a device or by the benchmark harness.
+// Both paths then run again at a lower resolution, upscaled temporally.
+enum RenderMode
+{
+    RENDER_MODE_MULTI_PASS,
+    RENDER_MODE_SINGLE_PASS,
+    RENDER_MODE_MULTI_PASS_UPSCALED,
+    RENDER_MODE_SINGLE_PASS_UPSCALED,
+    NUM_RENDER_MODES
+};
+
+static const char *render_mode_names[NUM_RENDER_MODES] = {
+    "multi-pass",
+    "single-pass",
+    "multi-pass, upscaled",
+    "single-pass, upscaled"
+};
+
+static RenderMode render_mode = RENDER_MODE_MULTI_PASS;
+static float mode_duration = 10.0f;
+static float mode_time = 0.0f;
+static int mode_frames = 0;
+
 // Perspective projection parameters
 static float z_near = 0.1f;
 static float z_far = 15.0f;
 static float fov_y = PI / 4.0f;
 static float aspect_ratio = 1.0f;
 
+// The shading is per pixel and fill rate bound, so the upscaled modes
+// render this fraction of the window in each dimension, to the corner of
+// an offscreen target, and accumulate the jittered frames to full size.
+static float upscale_factor = 0.6f;
+static MaliSDK::TemporalUpscaler *upscaler = NULL;
+static GLuint upscale_color = 0;
+static GLuint upscale_depth_stencil = 0;
+static GLuint upscale_framebuffer = 0;
+
+static GLuint create_target(GLenum internal_format, GLenum filter)
+{
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, internal_format, window_width, window_height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+static bool init_upscaling()
+{
+    // Allocated at the window size, so the factor can change without
+    // reallocating. The upscaler reads the depth to reproject its history.
+    upscale_color = create_target(GL_RGBA8, GL_LINEAR);
+    upscale_depth_stencil = create_target(GL_DEPTH24_STENCIL8, GL_NEAREST);
+
+    glGenFramebuffers(1, &upscale_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, upscale_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, upscale_color, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, upscale_depth_stencil, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOGD("Upscaling framebuffer is incomplete (0x%x)", status);
+        return false;
+    }
+
+    upscaler = new MaliSDK::TemporalUpscaler(window_width, window_height, window_width, window_height);
+    return true;
+}
+
+static void free_upscaling()
+{
+    delete upscaler;
+    upscaler = NULL;
+    glDeleteFramebuffers(1, &upscale_framebuffer);
+    glDeleteTextures(1, &upscale_color);
+    glDeleteTextures(1, &upscale_depth_stencil);
+    upscale_framebuffer = 0;
+    upscale_color = 0;
+    upscale_depth_stencil = 0;
+}
+
 bool init_app(int width, int height)
 {
     window_width  = width;
     window_height = height;
+    render_width  = width;
+    render_height = height;
     aspect_ratio = float(width) / height;
 
     // Check if we have support for pixel local storage
@@ -106,14 +197,18 @@ bool init_app(int width, int height)
         !shader_thickness.load_from_file(res + "thickness.vs", res + "thickness.fs") ||
         !shader_resolve.load_from_file(res + "resolve.vs", res + "resolve.fs") ||
         !shader_scattering.load_from_file(res + "scattering.vs", res + "scattering.fs") ||
-        !shader_opaque.load_from_file(res + "opaque.vs", res + "opaque.fs"))
+        !shader_opaque.load_from_file(res + "opaque.vs", res + "opaque.fs") ||
+        !shader_single_pass.load_from_file(res + "prepass.vs", res + "single_pass.fs") ||
+        !shader_single_pass_resolve.load_from_file(res + "resolve.vs", res + "single_pass_resolve.fs"))
         return false;
 
     if (!shader_prepass.link() ||
         !shader_thickness.link() ||
         !shader_resolve.link() ||
         !shader_scattering.link() ||
-        !shader_opaque.link())
+        !shader_opaque.link() ||
+        !shader_single_pass.link() ||
+        !shader_single_pass_resolve.link())
         return false;
 
     sphere = gen_normal_sphere(24, 24);
@@ -123,7 +218,15 @@ bool init_app(int width, int height)
     if (!load_mesh_binary(teapot, res + "teapot.bin"))
         return false;
 
-    mat_projection = perspective(fov_y, aspect_ratio, z_near, z_far);
+    mat_base_projection = perspective(fov_y, aspect_ratio, z_near, z_far);
+    mat_projection = mat_base_projection;
+
+    if (!init_upscaling())
+        return false;
+
+    render_mode = RENDER_MODE_MULTI_PASS;
+    mode_time = 0.0f;
+    mode_frames = 0;
 
     return true;
 }
@@ -135,6 +238,9 @@ void free_app()
     shader_prepass.dispose();
     shader_scattering.dispose();
     shader_opaque.dispose();
+    shader_single_pass.dispose();
+    shader_single_pass_resolve.dispose();
+    free_upscaling();
 }
 
 void update_app(float dt)
@@ -153,6 +259,19 @@ void update_app(float dt)
     float t = get_elapsed_time();
     light_intensity[0] = smoothstep(0.5f, 1.0f, t);
     light_intensity[1] = smoothstep(1.5f, 2.0f, t);
+
+    // Switch the render path, and report how the one we leave did
+    mode_time += dt;
+    mode_frames++;
+    if (mode_time > mode_duration)
+    {
+        LOGD("Translucency %s: %d frames, %.3f ms per frame",
+             render_mode_names[render_mode], mode_frames, 1000.0f * mode_time / mode_frames);
+        render_mode = RenderMode((render_mode + 1) % NUM_RENDER_MODES);
+        upscaler->reset();
+        mode_time = 0.0f;
+        mode_frames = 0;
+    }
 }
 void render_teapot(mat4 model, bool normal = true)
 {
@@ -218,7 +337,7 @@ void render_pass_shading()
     uniform("zFar", z_far);
     uniform("top", z_near * tan(fov_y / 2.0f));
     uniform("right", aspect_ratio * z_near * tan(fov_y / 2.0f));
-    uniform("invResolution", vec2(1.0f / window_width, 1.0f / window_height));
+    uniform("invResolution", vec2(1.0f / render_width, 1.0f / render_height));
     uniform("ambient", s_ambient);
     uniform("distortion", s_distortion);
     uniform("sharpness", s_sharpness);
@@ -259,7 +378,64 @@ void render_pass_resolve()
     glDrawElements(GL_TRIANGLES, quad.num_indices, GL_UNSIGNED_INT, 0);
 }
 
-void render_app(float dt)
+void render_pass_single_pass_resolve()
+{
+    // Shade translucent objects with both lights and write back all the
+    // pixels, in one fullscreen pass
+    use_shader(shader_single_pass_resolve);
+    uniform("zNear", z_near);
+    uniform("zFar", z_far);
+    uniform("top", z_near * tan(fov_y / 2.0f));
+    uniform("right", aspect_ratio * z_near * tan(fov_y / 2.0f));
+    uniform("invResolution", vec2(1.0f / render_width, 1.0f / render_height));
+    uniform("ambient", s_ambient);
+    uniform("distortion", s_distortion);
+    uniform("sharpness", s_sharpness);
+    uniform("scale", s_scale);
+    uniform("lightPos0", (mat_view * vec4(light_pos[0], 1.0f)).xyz());
+    uniform("lightPos1", (mat_view * vec4(light_pos[1], 1.0f)).xyz());
+    uniform("lightColor0", light_color[0]);
+    uniform("lightColor1", light_color[1]);
+    uniform("lightIntensity0", light_intensity[0]);
+    uniform("lightIntensity1", light_intensity[1]);
+    uniform("lightRadius0", light_radius[0]);
+    uniform("lightRadius1", light_radius[1]);
+
+    quad.bind();
+    attribfv("position", 3, 3, 0);
+    glDrawElements(GL_TRIANGLES, quad.num_indices, GL_UNSIGNED_INT, 0);
+}
+
+void render_single_pass()
+{
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_SHADER_PIXEL_LOCAL_STORAGE_EXT);
+    glDepthMask(GL_TRUE);
+    glClearDepthf(1.0f);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Opaque geometry is lit as in the multi-pass path. No stencil is
+    // needed, the translucent pass leaves its mark in the local storage.
+    depth_write(true);
+    depth_test(true, GL_LEQUAL);
+    cull(true);
+    render_pass_opaque();
+
+    // Every translucent fragment in front of the opaque geometry keeps
+    // the material of the nearest one and the farthest depth, whatever
+    // order they come in, so one pass replaces the two thickness passes.
+    cull(false);
+    depth_write(false);
+    use_shader(shader_single_pass);
+    render_pass_thickness(false);
+
+    depth_test(false);
+    render_pass_single_pass_resolve();
+    glDisable(GL_SHADER_PIXEL_LOCAL_STORAGE_EXT);
+}
+
+void render_multi_pass()
 {
     // Clearing all buffers at the beginning can lead to better performance
     glEnable(GL_DEPTH_TEST);
@@ -309,6 +485,46 @@ void render_app(float dt)
     render_pass_resolve();
     glDisable(GL_STENCIL_TEST);
     glDisable(GL_SHADER_PIXEL_LOCAL_STORAGE_EXT);
+}
+
+void render_app(float dt)
+{
+    bool upscaled = render_mode == RENDER_MODE_MULTI_PASS_UPSCALED ||
+                    render_mode == RENDER_MODE_SINGLE_PASS_UPSCALED;
+
+    // Render to the corner of the offscreen target, with the projection
+    // moved by a different sub-pixel offset every frame.
+    mat_projection = mat_base_projection;
+    if (upscaled)
+    {
+        render_width = int(window_width * upscale_factor);
+        render_height = int(window_height * upscale_factor);
+        upscaler->beginFrame(render_width, render_height);
+        upscaler->jitterProjection(mat_projection.value_ptr());
+        glBindFramebuffer(GL_FRAMEBUFFER, upscale_framebuffer);
+    }
+    else
+    {
+        render_width = window_width;
+        render_height = window_height;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    glViewport(0, 0, render_width, render_height);
+
+    if (render_mode == RENDER_MODE_SINGLE_PASS || render_mode == RENDER_MODE_SINGLE_PASS_UPSCALED)
+        render_single_pass();
+    else
+        render_multi_pass();
+
+    if (upscaled)
+    {
+        // The upscaler reprojects with the depth, only the stencil can go
+        GLenum stencil[] = { GL_STENCIL_ATTACHMENT };
+        glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, stencil);
+
+        mat4 view_projection = mat_base_projection * mat_view;
+        upscaler->resolve(upscale_color, upscale_depth_stencil, view_projection.value_ptr(), 0);
+    }
 
     // These are no longer needed, so we don't bother writing back to framebuffer.
     GLenum to_invalidate[] = { GL_DEPTH, GL_STENCIL };
@@ -85,6 +85,9 @@ public class Translucency extends Activity
         extractAsset("opaque.vs");
         extractAsset("opaque.fs");
 
+        extractAsset("single_pass.fs");
+        extractAsset("single_pass_resolve.fs");
+
         extractAsset("teapot.bin");
     }
 
@@ -23,6 +23,7 @@ package com.arm.malideveloper.openglessdk;
 import java.io.File;
 import java.io.IOException;
 import java.io.InputStream;
+import java.io.PrintWriter;
 import java.io.RandomAccessFile;
 import android.os.Bundle;
 import android.util.Log;
@@ -46,6 +47,43 @@ public abstract class MaliSamplesActivity extends Activity
         extractAssetToRes("font.png");
         extractAssetToRes("font.raw");
         extractAssetToRes("font.vert");
+
+        writeIntentParameters();
+    }
+
+    /*
+     * Hand the extras of the launching intent, as given by am start -e name value, to SampleParameters on the
+     * native side. Without extras the file is removed, so the values of an earlier launch do not stay.
+     */
+    private void writeIntentParameters()
+    {
+        File file = new File("/data/data/" + this.getPackageName() + "/intent_parameters.txt");
+        Bundle extras = getIntent().getExtras();
+
+        if (extras == null || extras.isEmpty())
+        {
+            file.delete();
+            return;
+        }
+
+        try
+        {
+            file.getParentFile().mkdirs();
+            PrintWriter out = new PrintWriter(file);
+            for (String key : extras.keySet())
+            {
+                Object value = extras.get(key);
+                if (value != null)
+                {
+                    out.println(key + "=" + value);
+                }
+            }
+            out.close();
+        }
+        catch(IOException e)
+        {
+            Log.e(LOG_TAG, "MaliSamples.writeIntentParameters(): " + e.toString());
+        }
     }
 
     private void extractAssetToRes(String filename)
@@ -54,6 +92,16 @@ public abstract class MaliSamplesActivity extends Activity
         extractAsset(res, filename);
     }
 
+    /* Used by AndroidPlatform::useAPKAssets() to read assets in place instead of extracting them. */
+    public static AssetManager getAssetManager()
+    {
+        if ( null == mAppContext )
+        {
+            return null;
+        }
+        return mAppContext.getResources().getAssets();
+    }
+
     public static int[] openAsset( String path )
     {
         AssetFileDescriptor ad = null;
@@ -54,6 +54,8 @@ public abstract class MaliSamplesView extends GLSurfaceView
     protected int alphaSize = 0;
     protected int numberOfSamples = 4;
     protected int depthSize = 16;
+    /* EGL_CONTEXT_PRIORITY_HIGH_IMG, used when EGL_IMG_context_priority is supported */
+    protected int contextPriority = 0x3101;
 
     protected GlesVersion glesVersion;
 
@@ -113,10 +115,30 @@ public abstract class MaliSamplesView extends GLSurfaceView
                 Log.e(LOG_TAG, String.format("Before TheEGLContextFactory.createContext(): EGL error: 0x%x", error));
             }
 
+            final int EGL_CONTEXT_PRIORITY_LEVEL_IMG = 0x3100;
+
             /* Use the value of glesVersion */
             int[] attribs = {EGL_CONTEXT_CLIENT_VERSION, glesVersion.getValue(), EGL10.EGL_NONE };
 
-            EGLContext context = egl.eglCreateContext(display, config, EGL10.EGL_NO_CONTEXT, attribs);
+            /*
+             * Ask for a high priority context so the frames are not held up by other work on the GPU.
+             * The priority is only a hint, the implementation is free to grant a lower one.
+             */
+            EGLContext context = EGL10.EGL_NO_CONTEXT;
+            if (isExtensionSupported(egl, display, "EGL_IMG_context_priority"))
+            {
+                int[] priorityAttribs = {EGL_CONTEXT_CLIENT_VERSION, glesVersion.getValue(),
+                                         EGL_CONTEXT_PRIORITY_LEVEL_IMG, contextPriority, EGL10.EGL_NONE };
+
+                context = egl.eglCreateContext(display, config, EGL10.EGL_NO_CONTEXT, priorityAttribs);
+            }
+
+            /* Retry without the priority if it was refused */
+            if (context == EGL10.EGL_NO_CONTEXT)
+            {
+                egl.eglGetError();
+                context = egl.eglCreateContext(display, config, EGL10.EGL_NO_CONTEXT, attribs);
+            }
 
             while ((error = egl.eglGetError()) != EGL10.EGL_SUCCESS)
             {
@@ -126,6 +148,24 @@ public abstract class MaliSamplesView extends GLSurfaceView
             return context;
         }
 
+        private boolean isExtensionSupported(EGL10 egl, EGLDisplay display, String extension)
+        {
+            String extensions = egl.eglQueryString(display, EGL10.EGL_EXTENSIONS);
+            if (extensions == null)
+            {
+                return false;
+            }
+
+            for (String name : extensions.split(" "))
+            {
+                if (name.equals(extension))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
         public void destroyContext(EGL10 egl, EGLDisplay display, EGLContext context) 
         {
             /* Allow the derived classes to destroy their resources*/
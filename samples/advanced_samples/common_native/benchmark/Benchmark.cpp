@@ -0,0 +1,1031 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Runs a sample without its Java activity, for automated performance regression runs.
+ *
+ * The sample library is loaded with dlopen() and driven through its JNI entry points, the init(), step() and
+ * uninit() the Java side would call, with a NULL JNIEnv. Rendering goes to a pbuffer of the requested size,
+ * and the Timer of the sample steps by a fixed amount each frame, so every run draws the same frames.
+ *
+ * Each frame is finished with glFinish(), which keeps the frames from overlapping so each one can be timed on
+ * its own. The CPU time of step(), the time until the GPU is done and, with GL_EXT_disjoint_timer_query,
+ * the GPU time between the start and the end of the frame are written to a JSON report.
+ *
+ * Built as <sample>-benchmark next to the sample library. Assets are not extracted from an APK, so install and
+ * run the sample once, then run the harness in its sandbox where they have been extracted to:
+ *     adb push Cube-benchmark libNative.so /data/local/tmp
+ *     adb shell run-as com.arm.malideveloper.openglessdk.cube /data/local/tmp/Cube-benchmark \
+ *         --library /data/local/tmp/libNative.so --output files/benchmark.json
+ *
+ * With a sample built with GL_CAPTURE, --capture records the calls of the first measured frames to a file, after
+ * the init() and the warmup frames as the setup (see GLCapture.h). --replay then benchmarks these frames alone,
+ * played again and again by GLReplay instead of loading a sample, which leaves the CPU time of the sample out of
+ * the measurements:
+ *     Cube-benchmark --library libNative.so --capture files/cube.glcp --capture-frames 10
+ *     Cube-benchmark --replay files/cube.glcp --output files/replay.json
+ *
+ * In OpenGL ES 3.0 builds, --reference checks the rendering against reference images during the run. Every
+ * --check-interval measured frames the pbuffer is copied to a pixel pack buffer by AsyncReadback, after the frame
+ * is timed, and the pixels are compared by ImageComparison once the copy is done. The times are thus the same as
+ * those of a run without checks. A missing reference is written instead, so the first run on a known good build
+ * records them. A frame failing the comparison is saved next to its reference for inspection, with an image of
+ * the differences, and the harness exits with a failure:
+ *     Cube-benchmark --library libNative.so --reference files/references --check-interval 100
+ *
+ * A ThermalMonitor samples the CPU and GPU frequencies, temperatures and thermal status during the whole run,
+ * every --thermal-interval seconds. The report lists the samples with the mean time of the frames finished since
+ * the previous one, whether and when the device throttled, and the mean frame time of the first and last tenth of
+ * the measured frames. On a long run the last tenth is the sustained performance, the first the burst:
+ *     Cube-benchmark --library libNative.so --frames 36000 --thermal-interval 5
+ *
+ * The startup is timed as well: EGL initialization by the harness, the init() of the sample and its first frame,
+ * up to the end of its swap. With a sample using the common code, StartupProfiler breaks init() and the first
+ * frame down into asset I/O, decoding, shaders, uploads and other work (see StartupProfiler.h).
+ *
+ * Workload sizes of a sample using SampleParameters are set with --parameter, which can be given several times.
+ * The values are set in the library before init(), and listed in the report, so a sweep of runs gives scaling curves:
+ *     Cube-benchmark --library libNative.so --parameter number_of_cubes=1000 --output files/cubes-1000.json
+ *
+ * After the measured frames, the report has the peak resident size of the process and, with a sample using the
+ * common code, the GPU memory recorded by GPUMemory. The time of every measured frame is listed too, so that
+ * BenchmarkCompare can tell a regression from noise (see BenchmarkCompare.cpp).
+ */
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include "EGLConfigSelector.h"
+#include "FrameStatistics.h"
+#include "GLExtensions.h"
+#include "GLReplay.h"
+#include "ImageComparison.h"
+#include "Platform.h"
+#include "StartupProfiler.h"
+#include "ThermalMonitor.h"
+#include "Timer.h"
+
+#if GLES_VERSION == 3
+#include "AsyncReadback.h"
+#endif
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <jni.h>
+
+#include <dlfcn.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/* GL_EXT_disjoint_timer_query, not part of the core headers. */
+#ifndef GL_QUERY_COUNTER_BITS_EXT
+#define GL_QUERY_COUNTER_BITS_EXT 0x8864
+#endif
+#ifndef GL_QUERY_RESULT_EXT
+#define GL_QUERY_RESULT_EXT 0x8866
+#endif
+#ifndef GL_TIMESTAMP_EXT
+#define GL_TIMESTAMP_EXT 0x8E28
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+#ifndef EGL_OPENGL_ES3_BIT_KHR
+#define EGL_OPENGL_ES3_BIT_KHR 0x00000040
+#endif
+
+#ifndef BENCHMARK_JNI_PREFIX
+#define BENCHMARK_JNI_PREFIX ""
+#endif
+
+using namespace MaliSDK;
+
+typedef void (GL_APIENTRYP PFNGLGENQUERIESEXTPROC_LOCAL)(GLsizei n, GLuint *ids);
+typedef void (GL_APIENTRYP PFNGLDELETEQUERIESEXTPROC_LOCAL)(GLsizei n, const GLuint *ids);
+typedef void (GL_APIENTRYP PFNGLQUERYCOUNTEREXTPROC_LOCAL)(GLuint id, GLenum target);
+typedef void (GL_APIENTRYP PFNGLGETQUERYIVEXTPROC_LOCAL)(GLenum target, GLenum pname, GLint *params);
+typedef void (GL_APIENTRYP PFNGLGETQUERYOBJECTUI64VEXTPROC_LOCAL)(GLuint id, GLenum pname, khronos_uint64_t *params);
+
+typedef void (*SetFixedTimeStepFunction)(float seconds);
+typedef void (*AdvanceFixedTimeFunction)(void);
+typedef int (*CaptureStartFunction)(const char *path, int width, int height, unsigned int frames);
+typedef void (*CaptureFunction)(void);
+typedef void (*StartupFunction)(void);
+typedef int (*StartupBreakdownFunction)(double *milliseconds, int numberOfPhases);
+typedef unsigned int (*ReportLeaksFunction)(void);
+typedef unsigned long long (*GPUMemoryTotalFunction)(void);
+typedef void (*SetParameterFunction)(const char *name, const char *value);
+
+/* Most samples take the surface size in init(), the others ignore the extra arguments. */
+typedef void (JNICALL *SampleInitFunction)(JNIEnv *env, jclass cls, jint width, jint height);
+typedef void (JNICALL *SampleStepFunction)(JNIEnv *env, jclass cls);
+
+struct Options
+{
+    std::string library;
+    std::string prefix;
+    std::string output;
+    std::string capture;
+    std::string replay;
+    std::string reference;
+    int width;
+    int height;
+    int frames;
+    int warmupFrames;
+    int captureFrames;
+    int checkInterval;
+    int maximumDifferentPixels;
+    float timeStep;
+    float threshold;
+    float thermalInterval;
+    /* The --parameter options, as name and value. */
+    std::vector<std::pair<std::string, std::string> > parameters;
+};
+
+/* Times of the startup, and its breakdown by the StartupProfiler of the sample if it has one. */
+struct Startup
+{
+    double eglMilliseconds;
+    double initMilliseconds;
+    double firstFrameMilliseconds;
+    int numberOfPhases;
+    double phaseMilliseconds[StartupProfiler::NUMBER_OF_PHASES];
+};
+
+/* Memory used at the end of the measured frames, -1 when unknown. */
+struct Memory
+{
+    long long peakResidentKilobytes;
+    long long gpuBytes;
+};
+
+/* Outcome of the comparisons with the reference images. */
+struct ImageChecks
+{
+    unsigned int checked;
+    unsigned int failed;
+    unsigned int written;
+    unsigned int dropped;
+    float maximumDifference;
+};
+
+/* VmHWM, the most the process has had resident, from its status file. */
+static long long readPeakResidentSize(void)
+{
+    FILE *file = fopen("/proc/self/status", "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    long long kilobytes = -1;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (sscanf(line, "VmHWM: %lld kB", &kilobytes) == 1)
+        {
+            break;
+        }
+    }
+    fclose(file);
+
+    return kilobytes;
+}
+
+static void printUsage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --library <path>    Sample library to run (default ./libNative.so)\n"
+            "  --prefix <name>     JNI prefix of the entry points, Java_<package>_<class> (default %s)\n"
+            "  --frames <n>        Frames to measure (default 1000)\n"
+            "  --warmup <n>        Frames to run before measuring (default 60)\n"
+            "  --time-step <s>     Animation time step per frame in seconds (default 1/60)\n"
+            "  --width <pixels>    Surface width (default 1920)\n"
+            "  --height <pixels>   Surface height (default 1080)\n"
+            "  --output <path>     JSON report (default benchmark.json)\n"
+            "  --capture <path>    Capture the OpenGL ES calls of the sample, which has to be built with GL_CAPTURE\n"
+            "  --capture-frames <n> Measured frames to capture (default 1)\n"
+            "  --replay <path>     Benchmark the frames of a capture instead of a sample\n"
+            "  --reference <dir>   Compare frames with the reference images in <dir>, writing the missing ones (OpenGL ES 3.0)\n"
+            "  --check-interval <n> Measured frames between two image checks (default 100)\n"
+            "  --threshold <f>     Perceived difference from 0 to 1 above which a pixel differs (default 0.1)\n"
+            "  --max-different <n> Different pixels allowed in an image (default 0)\n"
+            "  --thermal-interval <s> Seconds between two thermal samples, 0 to disable (default 1)\n"
+            "  --parameter <name>=<value> Set a SampleParameters value of the sample, can be repeated\n",
+            program, BENCHMARK_JNI_PREFIX);
+}
+
+static bool parseOptions(int argc, char **argv, Options &options)
+{
+    options.library = "./libNative.so";
+    options.prefix = BENCHMARK_JNI_PREFIX;
+    options.output = "benchmark.json";
+    options.width = 1920;
+    options.height = 1080;
+    options.frames = 1000;
+    options.warmupFrames = 60;
+    options.captureFrames = 1;
+    options.checkInterval = 100;
+    options.maximumDifferentPixels = 0;
+    options.timeStep = 1.0f / 60.0f;
+    options.threshold = 0.1f;
+    options.thermalInterval = 1.0f;
+
+    for (int argument = 1; argument < argc; argument++)
+    {
+        const char *name = argv[argument];
+        if (argument + 1 >= argc)
+        {
+            fprintf(stderr, "Missing value for %s.\n", name);
+            return false;
+        }
+        const char *value = argv[++argument];
+
+        if (strcmp(name, "--library") == 0)
+        {
+            options.library = value;
+        }
+        else if (strcmp(name, "--prefix") == 0)
+        {
+            options.prefix = value;
+        }
+        else if (strcmp(name, "--output") == 0)
+        {
+            options.output = value;
+        }
+        else if (strcmp(name, "--frames") == 0)
+        {
+            options.frames = atoi(value);
+        }
+        else if (strcmp(name, "--warmup") == 0)
+        {
+            options.warmupFrames = atoi(value);
+        }
+        else if (strcmp(name, "--time-step") == 0)
+        {
+            options.timeStep = (float)atof(value);
+        }
+        else if (strcmp(name, "--capture") == 0)
+        {
+            options.capture = value;
+        }
+        else if (strcmp(name, "--capture-frames") == 0)
+        {
+            options.captureFrames = atoi(value);
+        }
+        else if (strcmp(name, "--replay") == 0)
+        {
+            options.replay = value;
+        }
+        else if (strcmp(name, "--reference") == 0)
+        {
+            options.reference = value;
+        }
+        else if (strcmp(name, "--check-interval") == 0)
+        {
+            options.checkInterval = atoi(value);
+        }
+        else if (strcmp(name, "--threshold") == 0)
+        {
+            options.threshold = (float)atof(value);
+        }
+        else if (strcmp(name, "--max-different") == 0)
+        {
+            options.maximumDifferentPixels = atoi(value);
+        }
+        else if (strcmp(name, "--thermal-interval") == 0)
+        {
+            options.thermalInterval = (float)atof(value);
+        }
+        else if (strcmp(name, "--width") == 0)
+        {
+            options.width = atoi(value);
+        }
+        else if (strcmp(name, "--height") == 0)
+        {
+            options.height = atoi(value);
+        }
+        else if (strcmp(name, "--parameter") == 0)
+        {
+            /* Written to the report as they are, so they must not need escaping. */
+            const char *separator = strchr(value, '=');
+            if (separator == NULL || separator == value || strpbrk(value, "\"\\") != NULL)
+            {
+                fprintf(stderr, "Invalid parameter %s, expected name=value.\n", value);
+                return false;
+            }
+            options.parameters.push_back(std::make_pair(std::string(value, separator), std::string(separator + 1)));
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s.\n", name);
+            return false;
+        }
+    }
+
+    if (options.prefix.empty() || options.frames <= 0 || options.warmupFrames < 0 ||
+        options.width <= 0 || options.height <= 0 || options.timeStep <= 0.0f ||
+        options.captureFrames <= 0 || options.captureFrames > options.frames ||
+        (!options.capture.empty() && !options.replay.empty()) || (!options.parameters.empty() && !options.replay.empty()) ||
+        options.checkInterval <= 0 || options.threshold < 0.0f || options.threshold > 1.0f || options.maximumDifferentPixels < 0 ||
+        options.thermalInterval < 0.0f)
+    {
+        fprintf(stderr, "Invalid options.\n");
+        return false;
+    }
+
+#if GLES_VERSION == 2
+    /* Reading back without waiting needs pixel pack buffers and fences. */
+    if (!options.reference.empty())
+    {
+        fprintf(stderr, "Image checks need a harness built for OpenGL ES 3.0.\n");
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+static void writeStatistics(FILE *file, const char *name, const FrameStatistics &statistics)
+{
+    fprintf(file, "  \"%s\": { \"p50\": %.3f, \"p90\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"janky_frames\": %u },\n",
+            name, statistics.getPercentile(0.5f), statistics.getPercentile(0.9f), statistics.getPercentile(0.95f),
+            statistics.getPercentile(0.99f), statistics.getPercentile(1.0f), (unsigned int)statistics.getNumberOfJankyFrames());
+}
+
+#if GLES_VERSION == 3
+/* Compare a frame read back with its reference, or make it the reference if there is none yet. */
+static void checkImage(const Options &options, unsigned int frame, const std::vector<unsigned char> &pixels, ImageChecks &checks)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/frame_%u", frame);
+    std::string base = options.reference + path;
+
+    std::vector<unsigned char> image;
+    ImageComparison::convertFramebuffer(&pixels[0], options.width, options.height, image);
+
+    std::vector<unsigned char> reference;
+    int referenceWidth = 0;
+    int referenceHeight = 0;
+    if (!ImageComparison::loadPPM((base + ".ppm").c_str(), reference, &referenceWidth, &referenceHeight))
+    {
+        if (ImageComparison::savePPM((base + ".ppm").c_str(), &image[0], options.width, options.height))
+        {
+            LOGI("Wrote the reference image %s.ppm.\n", base.c_str());
+            checks.written++;
+        }
+        return;
+    }
+
+    checks.checked++;
+    if (referenceWidth != options.width || referenceHeight != options.height)
+    {
+        LOGE("%s.ppm is %dx%d, the frames are %dx%d.\n", base.c_str(), referenceWidth, referenceHeight, options.width, options.height);
+        checks.failed++;
+        return;
+    }
+
+    std::vector<unsigned char> difference;
+    ImageComparison::Result result = ImageComparison::compare(&image[0], &reference[0], options.width, options.height,
+                                                              options.threshold, &difference);
+    if (result.maximumDifference > checks.maximumDifference)
+    {
+        checks.maximumDifference = result.maximumDifference;
+    }
+
+    if (result.differentPixels > (unsigned int)options.maximumDifferentPixels)
+    {
+        LOGE("Frame %u differs from its reference in %u pixels, largest difference %.3f.\n", frame, result.differentPixels, result.maximumDifference);
+        ImageComparison::savePPM((base + ".actual.ppm").c_str(), &image[0], options.width, options.height);
+        ImageComparison::savePPM((base + ".diff.ppm").c_str(), &difference[0], options.width, options.height);
+        checks.failed++;
+    }
+}
+
+/* Check every frame the GPU has finished copying, or all the pending ones at the end of the run. */
+static void collectImages(const Options &options, AsyncReadback &readback, bool wait, ImageChecks &checks)
+{
+    std::vector<unsigned char> pixels;
+    unsigned int frame = 0;
+
+    while (readback.getNumberOfPendingReads() > 0)
+    {
+        if (readback.collect(&frame, pixels, wait))
+        {
+            checkImage(options, frame, pixels, checks);
+        }
+        else if (!wait)
+        {
+            break;
+        }
+    }
+}
+#endif
+
+/* Mean of the frame times in [begin, end), 0 if the range is empty. */
+static float meanFrameTime(const std::vector<float> &times, size_t begin, size_t end)
+{
+    double total = 0.0;
+    for (size_t frame = begin; frame < end; frame++)
+    {
+        total += times[frame];
+    }
+
+    return end > begin ? (float)(total / (end - begin)) : 0.0f;
+}
+
+/*
+ * The thermal samples, each with the mean time of the measured frames which finished since the previous sample, then
+ * the burst and sustained frame times. Frame and sample times are both on the clock of the monitor.
+ */
+static void writeThermal(FILE *file, const ThermalMonitor &monitor, const std::vector<float> &frameEnds, const std::vector<float> &frameTimes)
+{
+    std::vector<ThermalMonitor::Sample> samples = monitor.getSamples();
+    size_t frame = 0;
+
+    fprintf(file, "  \"thermal_samples\": [\n");
+    for (size_t sampleIndex = 0; sampleIndex < samples.size(); sampleIndex++)
+    {
+        const ThermalMonitor::Sample &sample = samples[sampleIndex];
+
+        size_t firstFrame = frame;
+        while (frame < frameEnds.size() && frameEnds[frame] <= sample.time)
+        {
+            frame++;
+        }
+
+        fprintf(file, "    { \"time_s\": %.3f, \"cpu_mhz\": %.0f, \"cpu_limit\": %.3f, \"gpu_mhz\": %.0f, \"gpu_limit\": %.3f, "
+                "\"temperature_c\": %.1f, \"thermal_status\": %d, \"throttled\": %s, \"frames\": %u, \"mean_frame_ms\": %.3f }%s\n",
+                sample.time, sample.cpuFrequency, sample.cpuLimit, sample.gpuFrequency, sample.gpuLimit, sample.temperature,
+                sample.thermalStatus, sample.throttled ? "true" : "false", (unsigned int)(frame - firstFrame),
+                meanFrameTime(frameTimes, firstFrame, frame), sampleIndex + 1 < samples.size() ? "," : "");
+    }
+    fprintf(file, "  ],\n");
+
+    float firstThrottledTime = -1.0f;
+    bool throttled = monitor.hasThrottled(&firstThrottledTime);
+    fprintf(file, "  \"throttled\": %s,\n", throttled ? "true" : "false");
+    if (throttled)
+    {
+        fprintf(file, "  \"first_throttled_s\": %.3f,\n", firstThrottledTime);
+    }
+
+    size_t tenth = frameTimes.size() / 10 > 0 ? frameTimes.size() / 10 : frameTimes.size();
+    float burst = meanFrameTime(frameTimes, 0, tenth);
+    float sustained = meanFrameTime(frameTimes, frameTimes.size() - tenth, frameTimes.size());
+    fprintf(file, "  \"burst_frame_ms\": %.3f,\n", burst);
+    fprintf(file, "  \"sustained_frame_ms\": %.3f,\n", sustained);
+    fprintf(file, "  \"sustained_ratio\": %.3f,\n", sustained > 0.0f ? burst / sustained : 0.0f);
+}
+
+static void writeStartup(FILE *file, const Startup &startup)
+{
+    fprintf(file, "  \"startup_egl_ms\": %.3f,\n", startup.eglMilliseconds);
+    fprintf(file, "  \"startup_init_ms\": %.3f,\n", startup.initMilliseconds);
+    fprintf(file, "  \"startup_first_frame_ms\": %.3f,\n", startup.firstFrameMilliseconds);
+
+    if (startup.numberOfPhases > 0)
+    {
+        fprintf(file, "  \"startup_phases_ms\": {");
+        for (int phase = 0; phase < startup.numberOfPhases; phase++)
+        {
+            fprintf(file, "%s \"%s\": %.3f", phase > 0 ? "," : "", StartupProfiler::getPhaseName((StartupProfiler::Phase)phase),
+                    startup.phaseMilliseconds[phase]);
+        }
+        fprintf(file, " },\n");
+    }
+}
+
+static void writeMemory(FILE *file, const Memory &memory)
+{
+    if (memory.peakResidentKilobytes >= 0)
+    {
+        fprintf(file, "  \"memory_peak_rss_kb\": %lld,\n", memory.peakResidentKilobytes);
+    }
+    if (memory.gpuBytes >= 0)
+    {
+        fprintf(file, "  \"memory_gpu_bytes\": %lld,\n", memory.gpuBytes);
+    }
+}
+
+static void writeFrameTimes(FILE *file, const std::vector<float> &measuredFrameTimes)
+{
+    fprintf(file, "  \"frame_times_ms\": [");
+    for (size_t frame = 0; frame < measuredFrameTimes.size(); frame++)
+    {
+        fprintf(file, "%s%s%.3f", frame > 0 ? "," : "", frame % 16 == 0 ? "\n    " : " ", measuredFrameTimes[frame]);
+    }
+    fprintf(file, "\n  ],\n");
+}
+
+static bool writeReport(const Options &options, const FrameStatistics &cpuTimes, const FrameStatistics &frameTimes,
+                        const FrameStatistics &gpuTimes, double totalMilliseconds, const Startup &startup, const Memory &memory,
+                        const ImageChecks *checks, const ThermalMonitor *monitor, const std::vector<float> &frameEnds,
+                        const std::vector<float> &measuredFrameTimes)
+{
+    FILE *file = fopen(options.output.c_str(), "w");
+    if (file == NULL)
+    {
+        LOGE("Cannot write the report to '%s'.\n", options.output.c_str());
+        return false;
+    }
+
+    /* None of the strings contain quotes or backslashes, so they need no escaping. */
+    fprintf(file, "{\n");
+    fprintf(file, "  \"sample\": \"%s\",\n", options.replay.empty() ? options.prefix.c_str() : options.replay.c_str());
+    fprintf(file, "  \"renderer\": \"%s\",\n", (const char *)glGetString(GL_RENDERER));
+    fprintf(file, "  \"gl_version\": \"%s\",\n", (const char *)glGetString(GL_VERSION));
+    fprintf(file, "  \"width\": %d,\n", options.width);
+    fprintf(file, "  \"height\": %d,\n", options.height);
+    fprintf(file, "  \"frames\": %d,\n", options.frames);
+    fprintf(file, "  \"warmup_frames\": %d,\n", options.warmupFrames);
+    fprintf(file, "  \"time_step\": %f,\n", options.timeStep);
+    fprintf(file, "  \"mean_frame_ms\": %.3f,\n", totalMilliseconds / options.frames);
+    fprintf(file, "  \"parameters\": {");
+    for (size_t parameter = 0; parameter < options.parameters.size(); parameter++)
+    {
+        fprintf(file, "%s \"%s\": \"%s\"", parameter > 0 ? "," : "", options.parameters[parameter].first.c_str(),
+                options.parameters[parameter].second.c_str());
+    }
+    fprintf(file, " },\n");
+
+    writeStartup(file, startup);
+    writeMemory(file, memory);
+    writeStatistics(file, "cpu_ms", cpuTimes);
+    writeStatistics(file, "frame_ms", frameTimes);
+    if (gpuTimes.getNumberOfFrames() > 0)
+    {
+        writeStatistics(file, "gpu_ms", gpuTimes);
+    }
+    if (checks != NULL)
+    {
+        fprintf(file, "  \"image_checks\": %u,\n", checks->checked);
+        fprintf(file, "  \"image_failures\": %u,\n", checks->failed);
+        fprintf(file, "  \"references_written\": %u,\n", checks->written);
+        fprintf(file, "  \"dropped_readbacks\": %u,\n", checks->dropped);
+        fprintf(file, "  \"max_image_difference\": %.3f,\n", checks->maximumDifference);
+    }
+    if (monitor != NULL)
+    {
+        writeThermal(file, *monitor, frameEnds, measuredFrameTimes);
+    }
+    writeFrameTimes(file, measuredFrameTimes);
+    fprintf(file, "  \"gpu_frames\": %u\n", (unsigned int)gpuTimes.getNumberOfFrames());
+    fprintf(file, "}\n");
+
+    bool written = !ferror(file);
+    fclose(file);
+
+    return written;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    void *library = NULL;
+    SampleInitFunction sampleInit = NULL;
+    SampleStepFunction sampleStep = NULL;
+    SampleStepFunction sampleUninit = NULL;
+    SetFixedTimeStepFunction setFixedTimeStep = NULL;
+    AdvanceFixedTimeFunction advanceFixedTime = NULL;
+    CaptureStartFunction captureStart = NULL;
+    CaptureFunction captureEndSetup = NULL;
+    CaptureFunction captureEndFrame = NULL;
+    StartupFunction startupStart = NULL;
+    StartupFunction startupEndInit = NULL;
+    StartupFunction startupEndFrame = NULL;
+    StartupBreakdownFunction startupBreakdown = NULL;
+    ReportLeaksFunction reportLeaks = NULL;
+    GPUMemoryTotalFunction gpuMemoryTotal = NULL;
+    SetParameterFunction setParameter = NULL;
+    GLReplay replay;
+    bool replaying = !options.replay.empty();
+
+    if (replaying)
+    {
+        /* Frames are replayed at the size they were captured at. */
+        if (!replay.load(options.replay.c_str()))
+        {
+            return EXIT_FAILURE;
+        }
+        options.width = replay.getWidth();
+        options.height = replay.getHeight();
+    }
+    else
+    {
+        library = dlopen(options.library.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (library == NULL)
+        {
+            LOGE("Cannot load %s: %s\n", options.library.c_str(), dlerror());
+            return EXIT_FAILURE;
+        }
+
+        sampleInit = (SampleInitFunction)dlsym(library, (options.prefix + "_init").c_str());
+        sampleStep = (SampleStepFunction)dlsym(library, (options.prefix + "_step").c_str());
+        sampleUninit = (SampleStepFunction)dlsym(library, (options.prefix + "_uninit").c_str());
+        if (sampleInit == NULL || sampleStep == NULL)
+        {
+            LOGE("%s has no %s_init() and %s_step().\n", options.library.c_str(), options.prefix.c_str(), options.prefix.c_str());
+            return EXIT_FAILURE;
+        }
+
+        /* Only present if the sample uses Timer, others animate with the real clock. */
+        setFixedTimeStep = (SetFixedTimeStepFunction)dlsym(library, "MaliSDK_Timer_setFixedTimeStep");
+        advanceFixedTime = (AdvanceFixedTimeFunction)dlsym(library, "MaliSDK_Timer_advanceFixedTime");
+        if (setFixedTimeStep == NULL || advanceFixedTime == NULL)
+        {
+            LOGI("%s does not use Timer, frames are not deterministic.\n", options.library.c_str());
+            setFixedTimeStep = NULL;
+            advanceFixedTime = NULL;
+        }
+
+        /* Absent from samples which do not use the common code, the startup is then only timed as a whole. */
+        startupStart = (StartupFunction)dlsym(library, "MaliSDK_StartupProfiler_start");
+        startupEndInit = (StartupFunction)dlsym(library, "MaliSDK_StartupProfiler_endInit");
+        startupEndFrame = (StartupFunction)dlsym(library, "MaliSDK_StartupProfiler_endFrame");
+        startupBreakdown = (StartupBreakdownFunction)dlsym(library, "MaliSDK_StartupProfiler_getBreakdown");
+        if (startupStart == NULL || startupEndInit == NULL || startupEndFrame == NULL || startupBreakdown == NULL)
+        {
+            startupStart = NULL;
+            startupEndInit = NULL;
+            startupEndFrame = NULL;
+            startupBreakdown = NULL;
+        }
+
+        /* The harness owns the context, so the sample never reaches EGLRuntime::terminateEGL to report its leaks. */
+        reportLeaks = (ReportLeaksFunction)dlsym(library, "MaliSDK_GPUMemory_reportLeaks");
+        gpuMemoryTotal = (GPUMemoryTotalFunction)dlsym(library, "MaliSDK_GPUMemory_getTotal");
+
+        /* Set now, the sample reads them in init(). A sample without SampleParameters would silently ignore them. */
+        if (!options.parameters.empty())
+        {
+            setParameter = (SetParameterFunction)dlsym(library, "MaliSDK_SampleParameters_set");
+            if (setParameter == NULL)
+            {
+                LOGE("%s does not use SampleParameters.\n", options.library.c_str());
+                return EXIT_FAILURE;
+            }
+            for (size_t parameter = 0; parameter < options.parameters.size(); parameter++)
+            {
+                setParameter(options.parameters[parameter].first.c_str(), options.parameters[parameter].second.c_str());
+            }
+        }
+
+        /* The calls are recorded by the GLCapture linked into the sample, not by the one of the harness. */
+        if (!options.capture.empty())
+        {
+            captureStart = (CaptureStartFunction)dlsym(library, "MaliSDK_GLCapture_start");
+            captureEndSetup = (CaptureFunction)dlsym(library, "MaliSDK_GLCapture_endSetup");
+            captureEndFrame = (CaptureFunction)dlsym(library, "MaliSDK_GLCapture_endFrame");
+            if (captureStart == NULL || captureEndSetup == NULL || captureEndFrame == NULL)
+            {
+                LOGE("%s was not built with GL_CAPTURE.\n", options.library.c_str());
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    Startup startup;
+    memset(&startup, 0, sizeof(startup));
+    Timer startupTimer(Timer::RealClock);
+
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+    {
+        LOGE("Cannot initialize EGL.\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Like the window configs of the samples, with stencil as some of them use it. */
+    EGLConfigSelector::Requirements requirements;
+    requirements.depthSize = 24;
+    requirements.stencilSize = 8;
+    requirements.surfaceType = EGL_PBUFFER_BIT;
+    requirements.renderableType = GLES_VERSION == 3 ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_ES2_BIT;
+
+    EGLConfig config = EGLConfigSelector::chooseConfig(display, requirements);
+    if (config == NULL)
+    {
+        LOGE("No pbuffer config for OpenGL ES %d.\n", GLES_VERSION);
+        eglTerminate(display);
+        return EXIT_FAILURE;
+    }
+
+    const EGLint surfaceAttributes[] = { EGL_WIDTH, options.width, EGL_HEIGHT, options.height, EGL_NONE };
+    const EGLint contextAttributes[] = { EGL_CONTEXT_CLIENT_VERSION, GLES_VERSION, EGL_NONE };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context))
+    {
+        LOGE("Cannot create a %dx%d pbuffer and context: 0x%x.\n", options.width, options.height, eglGetError());
+        eglTerminate(display);
+        return EXIT_FAILURE;
+    }
+
+    startup.eglMilliseconds = startupTimer.getTimeNanoseconds() / 1000000.0;
+
+    /* GPU time is taken with a timestamp at both ends of the frame, which does not get in the way of the sample's own queries. */
+    PFNGLGENQUERIESEXTPROC_LOCAL genQueries = NULL;
+    PFNGLDELETEQUERIESEXTPROC_LOCAL deleteQueries = NULL;
+    PFNGLQUERYCOUNTEREXTPROC_LOCAL queryCounter = NULL;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC_LOCAL getQueryObjectui64v = NULL;
+    bool gpuTiming = false;
+    GLuint queries[2] = { 0, 0 };
+
+    if (GLExtensions::isSupported("GL_EXT_disjoint_timer_query"))
+    {
+        PFNGLGETQUERYIVEXTPROC_LOCAL getQueryiv = (PFNGLGETQUERYIVEXTPROC_LOCAL)eglGetProcAddress("glGetQueryivEXT");
+
+        genQueries = (PFNGLGENQUERIESEXTPROC_LOCAL)eglGetProcAddress("glGenQueriesEXT");
+        deleteQueries = (PFNGLDELETEQUERIESEXTPROC_LOCAL)eglGetProcAddress("glDeleteQueriesEXT");
+        queryCounter = (PFNGLQUERYCOUNTEREXTPROC_LOCAL)eglGetProcAddress("glQueryCounterEXT");
+        getQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC_LOCAL)eglGetProcAddress("glGetQueryObjectui64vEXT");
+
+        GLint timestampBits = 0;
+        if (getQueryiv != NULL)
+        {
+            getQueryiv(GL_TIMESTAMP_EXT, GL_QUERY_COUNTER_BITS_EXT, &timestampBits);
+        }
+
+        gpuTiming = timestampBits > 0 && genQueries != NULL && deleteQueries != NULL && queryCounter != NULL && getQueryObjectui64v != NULL;
+        if (gpuTiming)
+        {
+            genQueries(2, queries);
+        }
+    }
+
+    LOGI("Benchmarking %s at %dx%d on %s, GPU timing %s.\n", replaying ? options.replay.c_str() : options.prefix.c_str(),
+         options.width, options.height, (const char *)glGetString(GL_RENDERER), gpuTiming ? "enabled" : "not supported");
+
+    ImageChecks checks = { 0, 0, 0, 0, 0.0f };
+#if GLES_VERSION == 3
+    AsyncReadback *readback = NULL;
+    if (!options.reference.empty())
+    {
+        if (!replaying && advanceFixedTime == NULL)
+        {
+            LOGI("The frames are not deterministic, they may not match the reference images.\n");
+        }
+        readback = new AsyncReadback(options.width, options.height);
+    }
+#endif
+
+    bool played = true;
+    long long initBegin = startupTimer.getTimeNanoseconds();
+    if (replaying)
+    {
+        played = replay.playSetup();
+    }
+    else
+    {
+        /* Switch before init(), so the timers the sample resets there start on the simulated clock. */
+        if (setFixedTimeStep != NULL)
+        {
+            setFixedTimeStep(options.timeStep);
+        }
+
+        /* Everything the sample creates in init() is part of the capture. */
+        if (captureStart != NULL && !captureStart(options.capture.c_str(), options.width, options.height, options.captureFrames))
+        {
+            captureStart = NULL;
+            captureEndSetup = NULL;
+            captureEndFrame = NULL;
+        }
+        if (startupStart != NULL)
+        {
+            startupStart();
+        }
+        sampleInit(NULL, NULL, options.width, options.height);
+        if (startupEndInit != NULL)
+        {
+            startupEndInit();
+        }
+    }
+    startup.initMilliseconds = (startupTimer.getTimeNanoseconds() - initBegin) / 1000000.0;
+
+    FrameStatistics cpuTimes(options.frames);
+    FrameStatistics frameTimes(options.frames);
+    FrameStatistics gpuTimes(options.frames);
+    Timer timer(Timer::RealClock);
+    double totalMilliseconds = 0.0;
+
+    /* How long each measured frame took, and when it finished on the clock of the monitor. */
+    ThermalMonitor *monitor = NULL;
+    std::vector<float> frameEnds;
+    std::vector<float> measuredFrameTimes;
+    measuredFrameTimes.reserve(options.frames);
+    if (options.thermalInterval > 0.0f)
+    {
+        monitor = new ThermalMonitor();
+        monitor->start(1.0f / options.thermalInterval);
+        frameEnds.reserve(options.frames);
+    }
+
+    for (int frame = 0; played && frame < options.warmupFrames + options.frames; frame++)
+    {
+        bool measured = frame >= options.warmupFrames;
+
+        /* The measured frames are the ones captured, their times include the recording. */
+        if (captureEndSetup != NULL && frame == options.warmupFrames)
+        {
+            captureEndSetup();
+        }
+
+        if (advanceFixedTime != NULL)
+        {
+            advanceFixedTime();
+        }
+
+        if (gpuTiming)
+        {
+            /* Reading the flag clears it, so only disjoint operations during this frame are seen afterwards. */
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+            queryCounter(queries[0], GL_TIMESTAMP_EXT);
+        }
+
+        long long begin = timer.getTimeNanoseconds();
+        if (replaying)
+        {
+            played = replay.playFrame(frame % replay.getNumberOfFrames());
+        }
+        else
+        {
+            sampleStep(NULL, NULL);
+        }
+        long long submitted = timer.getTimeNanoseconds();
+
+        if (gpuTiming)
+        {
+            queryCounter(queries[1], GL_TIMESTAMP_EXT);
+        }
+        eglSwapBuffers(display, surface);
+        glFinish();
+        long long finished = timer.getTimeNanoseconds();
+
+        /* The first frame is part of the startup up to the end of its swap, which is where it would be shown. */
+        if (frame == 0)
+        {
+            startup.firstFrameMilliseconds = (finished - begin) / 1000000.0;
+            if (startupEndFrame != NULL)
+            {
+                startupEndFrame();
+                startup.numberOfPhases = startupBreakdown(startup.phaseMilliseconds, StartupProfiler::NUMBER_OF_PHASES);
+            }
+        }
+
+        if (captureEndFrame != NULL)
+        {
+            captureEndFrame();
+        }
+
+        if (!measured)
+        {
+            continue;
+        }
+
+        cpuTimes.addFrameTime((submitted - begin) / 1000000.0f);
+        frameTimes.addFrameTime((finished - begin) / 1000000.0f);
+        totalMilliseconds += (finished - begin) / 1000000.0;
+        measuredFrameTimes.push_back((finished - begin) / 1000000.0f);
+        if (monitor != NULL)
+        {
+            frameEnds.push_back(monitor->getTime());
+        }
+
+        if (gpuTiming)
+        {
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+            /* The frame is finished, so the results are available without waiting. */
+            if (!disjoint)
+            {
+                khronos_uint64_t gpuBegin = 0;
+                khronos_uint64_t gpuEnd = 0;
+
+                getQueryObjectui64v(queries[0], GL_QUERY_RESULT_EXT, &gpuBegin);
+                getQueryObjectui64v(queries[1], GL_QUERY_RESULT_EXT, &gpuEnd);
+                gpuTimes.addFrameTime((gpuEnd - gpuBegin) / 1000000.0f);
+            }
+        }
+
+#if GLES_VERSION == 3
+        /* The copy runs on the GPU while the CPU compares the frames read before, both outside the timed part. */
+        if (readback != NULL)
+        {
+            int measuredFrame = frame - options.warmupFrames;
+            if (measuredFrame % options.checkInterval == 0)
+            {
+                readback->read((unsigned int)measuredFrame);
+            }
+            collectImages(options, *readback, false, checks);
+        }
+#endif
+    }
+
+#if GLES_VERSION == 3
+    if (readback != NULL)
+    {
+        collectImages(options, *readback, true, checks);
+        checks.dropped = readback->getDroppedReads();
+        LOGI("%u images checked, %u failed, %u references written.\n", checks.checked, checks.failed, checks.written);
+    }
+#endif
+
+    if (monitor != NULL)
+    {
+        monitor->stop();
+
+        float firstThrottledTime = 0.0f;
+        if (monitor->hasThrottled(&firstThrottledTime))
+        {
+            LOGI("Throttled after %.1f s.\n", firstThrottledTime);
+        }
+    }
+
+    LOGI("Startup: EGL %.1f ms, init %.1f ms, first frame %.1f ms.\n", startup.eglMilliseconds, startup.initMilliseconds,
+         startup.firstFrameMilliseconds);
+    cpuTimes.log("CPU");
+    frameTimes.log("Frame");
+    if (gpuTiming)
+    {
+        gpuTimes.log("GPU");
+    }
+
+    /* Before uninit(), while the sample still holds everything it renders with. */
+    Memory memory;
+    memory.peakResidentKilobytes = readPeakResidentSize();
+    memory.gpuBytes = gpuMemoryTotal != NULL ? (long long)gpuMemoryTotal() : -1;
+
+    bool written = played && writeReport(options, cpuTimes, frameTimes, gpuTimes, totalMilliseconds, startup, memory,
+                                         options.reference.empty() ? NULL : &checks, monitor, frameEnds, measuredFrameTimes);
+    delete monitor;
+
+    if (sampleUninit != NULL)
+    {
+        sampleUninit(NULL, NULL);
+    }
+
+    if (reportLeaks != NULL)
+    {
+        unsigned int leaks = reportLeaks();
+        if (leaks > 0)
+        {
+            LOGE("%s did not delete %u GPU resources.\n", options.library.c_str(), leaks);
+        }
+    }
+
+    if (gpuTiming)
+    {
+        deleteQueries(2, queries);
+    }
+
+#if GLES_VERSION == 3
+    delete readback;
+#endif
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglDestroySurface(display, surface);
+    eglTerminate(display);
+    if (library != NULL)
+    {
+        dlclose(library);
+    }
+
+    return written && checks.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
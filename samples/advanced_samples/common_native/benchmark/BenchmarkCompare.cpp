@@ -0,0 +1,415 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares the JSON report of a benchmark run with the report of a baseline run, and fails when the sample regressed.
+ *
+ * The p95 frame time is compared with a moving block bootstrap of the frame times listed in both reports: runs of
+ * 16 consecutive frames are drawn at random until each run is rebuilt, and the p95 of the rebuilt runs compared, a
+ * few thousand times. Blocks keep the frames that slow down together, after a thermal or frequency change, in the
+ * same resample. The p95 has regressed when it is more than --threshold slower and the bootstrap is confident, at
+ * --confidence, that it is slower at all. Reports without frame times, from older harnesses, only get the threshold.
+ *
+ * The startup times and phases are single measurements, so they get a wider --startup-threshold and changes under
+ * --startup-min-ms are ignored. The peak resident size and the GPU memory recorded by GPUMemory do not vary from
+ * run to run and get --memory-threshold. The CPU and GPU p95 are shown but never fail.
+ *
+ * Prints a table of every metric found in both reports, and exits with 1 if any regressed, 2 if a report cannot be
+ * read. The per-sample regression targets of Sample.cmake run it on the device after the harness:
+ *     benchmark-compare --baseline baseline.json --current benchmark.json --threshold 0.05
+ */
+
+#include "FrameStatistics.h"
+#include "JsonValue.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace MaliSDK;
+
+struct Options
+{
+    std::string baseline;
+    std::string current;
+    float threshold;
+    float confidence;
+    float startupThreshold;
+    float startupMinimumMilliseconds;
+    float memoryThreshold;
+    int resamples;
+};
+
+/*
+ * The numbers of a report by path, "frame_ms.p95" or "startup_phases_ms.shaders", and its arrays of numbers.
+ * Strings are skipped, true and false read as 1 and 0, elements of other arrays are named by their index.
+ */
+struct Report
+{
+    std::map<std::string, double> numbers;
+    std::map<std::string, std::vector<float> > arrays;
+    std::string sample;
+};
+
+/* Flatten a parsed report into the numbers and arrays of numbers of Report, naming each by its path. */
+static void flattenReport(const JsonValue &value, const std::string &path, Report &report)
+{
+    switch (value.type)
+    {
+        case JsonValue::Object:
+            for (size_t index = 0; index < value.items.size(); index++)
+            {
+                flattenReport(value.items[index], path.empty() ? value.keys[index] : path + "." + value.keys[index], report);
+            }
+            break;
+        case JsonValue::Array:
+        {
+            bool onlyNumbers = true;
+            for (size_t index = 0; index < value.items.size() && onlyNumbers; index++)
+            {
+                onlyNumbers = value.items[index].type == JsonValue::Number;
+            }
+            if (onlyNumbers)
+            {
+                std::vector<float> &numbers = report.arrays[path];
+                for (size_t index = 0; index < value.items.size(); index++)
+                {
+                    numbers.push_back((float)value.items[index].number);
+                }
+                break;
+            }
+            for (size_t index = 0; index < value.items.size(); index++)
+            {
+                char name[16];
+                snprintf(name, sizeof(name), ".%d", (int)index);
+                flattenReport(value.items[index], path + name, report);
+            }
+            break;
+        }
+        case JsonValue::String:
+            if (path == "sample")
+            {
+                report.sample = value.text;
+            }
+            break;
+        case JsonValue::Boolean:
+            report.numbers[path] = value.boolean ? 1.0 : 0.0;
+            break;
+        case JsonValue::Number:
+            report.numbers[path] = value.number;
+            break;
+        case JsonValue::Null:
+            break;
+    }
+}
+
+static bool loadReport(const std::string &path, Report &report)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot open the report %s.\n", path.c_str());
+        return false;
+    }
+
+    std::string text;
+    char buffer[4096];
+    size_t read = 0;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        text.append(buffer, read);
+    }
+    fclose(file);
+
+    JsonValue root;
+    if (!JsonValue::parse(text.c_str(), root))
+    {
+        fprintf(stderr, "%s is not a benchmark report.\n", path.c_str());
+        return false;
+    }
+
+    flattenReport(root, "", report);
+
+    return true;
+}
+
+/* xorshift32, seeded the same way every time so a comparison gives the same answer when it is run again. */
+static unsigned int nextRandom(unsigned int &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/* p95 of a run rebuilt from random blocks of consecutive frames. */
+static float resampleP95(const std::vector<float> &times, unsigned int &state)
+{
+    static const size_t blockLength = 16;
+    size_t length = times.size() < blockLength ? times.size() : blockLength;
+    FrameStatistics statistics(times.size());
+
+    while (statistics.getNumberOfFrames() < times.size())
+    {
+        size_t start = nextRandom(state) % (times.size() - length + 1);
+        for (size_t frame = start; frame < start + length && statistics.getNumberOfFrames() < times.size(); frame++)
+        {
+            statistics.addFrameTime(times[frame]);
+        }
+    }
+
+    return statistics.getPercentile(0.95f);
+}
+
+/* The ratio of current to baseline p95 which the bootstrap is confident the true ratio is above. */
+static double bootstrapLowerBound(const Options &options, const std::vector<float> &baseline, const std::vector<float> &current)
+{
+    unsigned int state = 0x9e3779b9u;
+    std::vector<float> ratios;
+
+    ratios.reserve(options.resamples);
+    for (int resample = 0; resample < options.resamples; resample++)
+    {
+        float baselineP95 = resampleP95(baseline, state);
+        float currentP95 = resampleP95(current, state);
+        if (baselineP95 > 0.0f)
+        {
+            ratios.push_back(currentP95 / baselineP95);
+        }
+    }
+    if (ratios.empty())
+    {
+        return 0.0;
+    }
+
+    FrameStatistics sorted(ratios.size());
+    for (size_t index = 0; index < ratios.size(); index++)
+    {
+        sorted.addFrameTime(ratios[index]);
+    }
+
+    return sorted.getPercentile(1.0f - options.confidence);
+}
+
+enum Check
+{
+    /* Shown only. */
+    CHECK_NONE,
+    /* Fails above the threshold, and when the bootstrap is confident. */
+    CHECK_FRAMES,
+    CHECK_STARTUP,
+    CHECK_MEMORY
+};
+
+/* Print a row of the table, returns whether the metric regressed. */
+static bool compareMetric(const Options &options, const Report &baseline, const Report &current, const std::string &name, Check check)
+{
+    std::map<std::string, double>::const_iterator baselineValue = baseline.numbers.find(name);
+    std::map<std::string, double>::const_iterator currentValue = current.numbers.find(name);
+    if (baselineValue == baseline.numbers.end() || currentValue == current.numbers.end())
+    {
+        return false;
+    }
+
+    double before = baselineValue->second;
+    double after = currentValue->second;
+    double change = before > 0.0 ? after / before - 1.0 : 0.0;
+    bool regressed = false;
+    char detail[64] = "";
+
+    switch (check)
+    {
+        case CHECK_NONE:
+            strcpy(detail, "not checked");
+            break;
+        case CHECK_FRAMES:
+        {
+            regressed = change > options.threshold;
+
+            std::map<std::string, std::vector<float> >::const_iterator baselineTimes = baseline.arrays.find("frame_times_ms");
+            std::map<std::string, std::vector<float> >::const_iterator currentTimes = current.arrays.find("frame_times_ms");
+            if (baselineTimes != baseline.arrays.end() && currentTimes != current.arrays.end() &&
+                !baselineTimes->second.empty() && !currentTimes->second.empty())
+            {
+                double lowerBound = bootstrapLowerBound(options, baselineTimes->second, currentTimes->second);
+                regressed = regressed && lowerBound > 1.0;
+                snprintf(detail, sizeof(detail), "%.0f%% lower bound %+.1f%%", options.confidence * 100.0f, (lowerBound - 1.0) * 100.0);
+            }
+            else
+            {
+                strcpy(detail, "no frame times, threshold only");
+            }
+            break;
+        }
+        case CHECK_STARTUP:
+            regressed = change > options.startupThreshold && after - before > options.startupMinimumMilliseconds;
+            break;
+        case CHECK_MEMORY:
+            regressed = change > options.memoryThreshold;
+            break;
+    }
+
+    printf("%-36s %14.3f %14.3f %+8.1f%%  %-9s %s\n", name.c_str(), before, after, change * 100.0,
+           check == CHECK_NONE ? "-" : regressed ? "REGRESSED" : "ok", detail);
+
+    return regressed;
+}
+
+static void printUsage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s --baseline <report> --current <report> [options]\n"
+            "  --threshold <f>         Slowdown of the p95 frame time which fails, 0.05 for 5%% (default 0.05)\n"
+            "  --confidence <f>        Confidence the bootstrap needs that the p95 is slower (default 0.95)\n"
+            "  --resamples <n>         Bootstrap resamples (default 2000)\n"
+            "  --startup-threshold <f> Slowdown of a startup time or phase which fails (default 0.2)\n"
+            "  --startup-min-ms <ms>   Startup changes smaller than this never fail (default 2)\n"
+            "  --memory-threshold <f>  Growth of the memory which fails (default 0.05)\n",
+            program);
+}
+
+static bool parseOptions(int argc, char **argv, Options &options)
+{
+    options.threshold = 0.05f;
+    options.confidence = 0.95f;
+    options.startupThreshold = 0.2f;
+    options.startupMinimumMilliseconds = 2.0f;
+    options.memoryThreshold = 0.05f;
+    options.resamples = 2000;
+
+    for (int argument = 1; argument < argc; argument++)
+    {
+        const char *name = argv[argument];
+        if (argument + 1 >= argc)
+        {
+            fprintf(stderr, "Missing value for %s.\n", name);
+            return false;
+        }
+        const char *value = argv[++argument];
+
+        if (strcmp(name, "--baseline") == 0)
+        {
+            options.baseline = value;
+        }
+        else if (strcmp(name, "--current") == 0)
+        {
+            options.current = value;
+        }
+        else if (strcmp(name, "--threshold") == 0)
+        {
+            options.threshold = (float)atof(value);
+        }
+        else if (strcmp(name, "--confidence") == 0)
+        {
+            options.confidence = (float)atof(value);
+        }
+        else if (strcmp(name, "--resamples") == 0)
+        {
+            options.resamples = atoi(value);
+        }
+        else if (strcmp(name, "--startup-threshold") == 0)
+        {
+            options.startupThreshold = (float)atof(value);
+        }
+        else if (strcmp(name, "--startup-min-ms") == 0)
+        {
+            options.startupMinimumMilliseconds = (float)atof(value);
+        }
+        else if (strcmp(name, "--memory-threshold") == 0)
+        {
+            options.memoryThreshold = (float)atof(value);
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s.\n", name);
+            return false;
+        }
+    }
+
+    if (options.baseline.empty() || options.current.empty() || options.threshold < 0.0f ||
+        options.confidence <= 0.0f || options.confidence >= 1.0f || options.resamples <= 0 ||
+        options.startupThreshold < 0.0f || options.startupMinimumMilliseconds < 0.0f || options.memoryThreshold < 0.0f)
+    {
+        fprintf(stderr, "Invalid options.\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    Report baseline;
+    Report current;
+    if (!loadReport(options.baseline, baseline) || !loadReport(options.current, current))
+    {
+        return 2;
+    }
+
+    if (baseline.sample != current.sample)
+    {
+        fprintf(stderr, "The baseline is a report of %s, not %s.\n", baseline.sample.c_str(), current.sample.c_str());
+        return 2;
+    }
+
+    printf("%s\n", current.sample.c_str());
+    printf("%-36s %14s %14s %9s  %s\n", "metric", "baseline", "current", "change", "status");
+
+    int regressions = 0;
+    regressions += compareMetric(options, baseline, current, "frame_ms.p95", CHECK_FRAMES);
+    regressions += compareMetric(options, baseline, current, "frame_ms.p50", CHECK_NONE);
+    regressions += compareMetric(options, baseline, current, "cpu_ms.p95", CHECK_NONE);
+    regressions += compareMetric(options, baseline, current, "gpu_ms.p95", CHECK_NONE);
+    regressions += compareMetric(options, baseline, current, "startup_egl_ms", CHECK_STARTUP);
+    regressions += compareMetric(options, baseline, current, "startup_init_ms", CHECK_STARTUP);
+    regressions += compareMetric(options, baseline, current, "startup_first_frame_ms", CHECK_STARTUP);
+
+    /* The phases are whatever StartupProfiler of the sample reported, in the order of the baseline. */
+    for (std::map<std::string, double>::const_iterator number = baseline.numbers.begin(); number != baseline.numbers.end(); ++number)
+    {
+        if (number->first.compare(0, 18, "startup_phases_ms.") == 0)
+        {
+            regressions += compareMetric(options, baseline, current, number->first, CHECK_STARTUP);
+        }
+    }
+
+    regressions += compareMetric(options, baseline, current, "memory_peak_rss_kb", CHECK_MEMORY);
+    regressions += compareMetric(options, baseline, current, "memory_gpu_bytes", CHECK_MEMORY);
+
+    if (regressions > 0)
+    {
+        printf("%d regressions.\n", regressions);
+        return 1;
+    }
+
+    printf("No regressions.\n");
+    return 0;
+}
@@ -0,0 +1,515 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Hosts a sample in an android.app.NativeActivity instead of a GLSurfaceView.
+ *
+ * The window, the EGL surface and the context are owned here, on a render thread of our own, and the sample is
+ * driven through the same JNI entry points, init(), step() and uninit(), the Java side would call. As in the
+ * benchmark harness they get a NULL JNIEnv, so no frame crosses into Java and nothing on the Java heap is allocated
+ * per frame for the garbage collector to stop the render thread for.
+ *
+ * Frames are started by AChoreographer frame callbacks on the render thread's looper, which is woken on vsync,
+ * so a frame starts as the display flips rather than whenever the previous swap returned. AChoreographer is
+ * looked up at run time as it needs Android 7.0, before that the thread renders back to back and the swap
+ * interval of 1 paces it.
+ *
+ * Assets are read straight from the APK through AssetFile, in /data/data/<package>/ or NATIVE_HOST_ASSET_DIRECTORY,
+ * so samples have to read them through AssetFile or the helpers built on it; there is no Java side to extract them.
+ * Input events are consumed and ignored.
+ *
+ * Built into the sample library when the sample is added with the NATIVE_HOST option of Sample.cmake. The manifest
+ * then declares android.app.NativeActivity as the activity, with android.app.lib_name set to "Native".
+ */
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include "AssetFile.h"
+#include "EGLConfigSelector.h"
+#include "EGLContextOptions.h"
+#include "Platform.h"
+
+#include <EGL/egl.h>
+#include <android/input.h>
+#include <android/looper.h>
+#include <android/native_activity.h>
+#include <android/native_window.h>
+#include <jni.h>
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <string>
+
+#ifndef NATIVE_HOST_JNI_PREFIX
+#error "NATIVE_HOST_JNI_PREFIX must be defined as the Java_<package>_<class> prefix of the sample's entry points"
+#endif
+
+#ifndef EGL_OPENGL_ES3_BIT_KHR
+#define EGL_OPENGL_ES3_BIT_KHR 0x00000040
+#endif
+
+using namespace MaliSDK;
+
+/* Most samples take the surface size in init(), the others ignore the extra arguments. */
+typedef void (JNICALL *SampleInitFunction)(JNIEnv *env, jclass cls, jint width, jint height);
+typedef void (JNICALL *SampleStepFunction)(JNIEnv *env, jclass cls);
+
+/* From android/choreographer.h, which needs API level 24 to be included. */
+struct AChoreographer;
+typedef void (*AChoreographerFrameCallback)(long frameTimeNanos, void *data);
+typedef AChoreographer *(*AChoreographerGetInstanceFunction)(void);
+typedef void (*AChoreographerPostFrameCallbackFunction)(AChoreographer *choreographer, AChoreographerFrameCallback callback, void *data);
+
+/* The looper identifier of the input queue, the frame callbacks and wake-ups do not need one. */
+static const int inputLooperIdentifier = 1;
+
+struct NativeHost
+{
+    ANativeActivity *activity;
+    std::string assetDirectory;
+
+    SampleInitFunction sampleInit;
+    SampleStepFunction sampleStep;
+    SampleStepFunction sampleUninit;
+
+    pthread_t renderThread;
+    pthread_mutex_t mutex;
+    /* Signalled by the render thread when it has started and when it has taken on a change. */
+    pthread_cond_t changeDone;
+
+    /* Shared with the render thread, under mutex. */
+    ALooper *looper;
+    ANativeWindow *requestedWindow;
+    AInputQueue *requestedInputQueue;
+    bool changeRequested;
+    bool resumed;
+    bool destroyRequested;
+
+    /* Render thread only. */
+    ANativeWindow *window;
+    AInputQueue *inputQueue;
+    EGLDisplay display;
+    EGLConfig config;
+    EGLSurface surface;
+    EGLContext context;
+    EGLint width;
+    EGLint height;
+    bool rendering;
+    bool framePosted;
+    AChoreographer *choreographer;
+    AChoreographerPostFrameCallbackFunction postFrameCallback;
+};
+
+/* Look up the sample's entry points by name, in the library this file is built into. */
+static void *findEntryPoint(const char *name)
+{
+    Dl_info info;
+    if (!dladdr((void *)&findEntryPoint, &info) || info.dli_fname == NULL)
+    {
+        return NULL;
+    }
+
+    void *library = dlopen(info.dli_fname, RTLD_NOW | RTLD_NOLOAD);
+    if (library == NULL)
+    {
+        return NULL;
+    }
+
+    void *function = dlsym(library, (std::string(NATIVE_HOST_JNI_PREFIX) + name).c_str());
+    dlclose(library);
+
+    return function;
+}
+
+static int consumeInput(int fd, int events, void *data)
+{
+    AInputQueue *queue = (AInputQueue *)data;
+    AInputEvent *event = NULL;
+
+    while (AInputQueue_getEvent(queue, &event) >= 0)
+    {
+        /* Events taken by an IME are finished by it. */
+        if (AInputQueue_preDispatchEvent(queue, event) == 0)
+        {
+            AInputQueue_finishEvent(queue, event, 0);
+        }
+    }
+
+    return 1;
+}
+
+/* Release the surface and the context, telling the sample first, as GLSurfaceView does when it loses its surface. */
+static void destroySurface(NativeHost *host)
+{
+    if (host->surface == EGL_NO_SURFACE)
+    {
+        return;
+    }
+
+    if (host->rendering && host->sampleUninit != NULL)
+    {
+        host->sampleUninit(NULL, NULL);
+    }
+    host->rendering = false;
+
+    eglMakeCurrent(host->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(host->display, host->surface);
+    eglDestroyContext(host->display, host->context);
+    host->surface = EGL_NO_SURFACE;
+    host->context = EGL_NO_CONTEXT;
+}
+
+static bool createSurface(NativeHost *host)
+{
+    if (host->config == NULL)
+    {
+        /* Like the configs MaliSamplesView chooses: no alpha, a 16-bit depth buffer and 4x multisampling. */
+        EGLConfigSelector::Requirements requirements;
+        requirements.samples = 4;
+        requirements.renderableType = GLES_VERSION == 3 ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_ES2_BIT;
+
+        host->config = EGLConfigSelector::chooseConfig(host->display, requirements);
+        if (host->config == NULL)
+        {
+            LOGE("NativeHost: no window config for OpenGL ES %d.\n", GLES_VERSION);
+            return false;
+        }
+    }
+
+    /* The frames the user sees come first, ahead of any worker contexts of the sample. */
+    host->surface = eglCreateWindowSurface(host->display, host->config, host->window, NULL);
+    host->context = EGLContextOptions::forRendering().createContext(host->display, host->config, EGL_NO_CONTEXT, GLES_VERSION);
+    if (host->surface == EGL_NO_SURFACE || host->context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(host->display, host->surface, host->surface, host->context))
+    {
+        LOGE("NativeHost: cannot create a window surface and context: 0x%x.\n", eglGetError());
+        if (host->context != EGL_NO_CONTEXT)
+        {
+            eglDestroyContext(host->display, host->context);
+            host->context = EGL_NO_CONTEXT;
+        }
+        if (host->surface != EGL_NO_SURFACE)
+        {
+            eglDestroySurface(host->display, host->surface);
+            host->surface = EGL_NO_SURFACE;
+        }
+        return false;
+    }
+
+    eglSwapInterval(host->display, 1);
+    host->width = 0;
+    host->height = 0;
+
+    return true;
+}
+
+static void renderFrame(NativeHost *host)
+{
+    EGLint width = 0;
+    EGLint height = 0;
+    eglQuerySurface(host->display, host->surface, EGL_WIDTH, &width);
+    eglQuerySurface(host->display, host->surface, EGL_HEIGHT, &height);
+
+    /* A new size is init() again, as in GLSurfaceView.Renderer.onSurfaceChanged() of the Java host. */
+    if (width != host->width || height != host->height)
+    {
+        host->width = width;
+        host->height = height;
+        host->sampleInit(NULL, NULL, width, height);
+        host->rendering = true;
+    }
+
+    host->sampleStep(NULL, NULL);
+
+    if (!eglSwapBuffers(host->display, host->surface))
+    {
+        LOGE("NativeHost: eglSwapBuffers() failed: 0x%x.\n", eglGetError());
+    }
+}
+
+static void onFrame(long frameTimeNanos, void *data)
+{
+    NativeHost *host = (NativeHost *)data;
+
+    host->framePosted = false;
+    if (host->surface != EGL_NO_SURFACE)
+    {
+        renderFrame(host);
+    }
+}
+
+/* Take on the window, input queue and pause state the activity asked for. Returns false once the thread has to stop. */
+static bool applyChanges(NativeHost *host)
+{
+    pthread_mutex_lock(&host->mutex);
+
+    bool resumed = host->resumed;
+    bool running = !host->destroyRequested;
+
+    if (host->changeRequested)
+    {
+        if (host->requestedWindow != host->window)
+        {
+            destroySurface(host);
+            host->window = host->requestedWindow;
+            if (host->window != NULL)
+            {
+                createSurface(host);
+            }
+        }
+
+        if (host->requestedInputQueue != host->inputQueue)
+        {
+            if (host->inputQueue != NULL)
+            {
+                AInputQueue_detachLooper(host->inputQueue);
+            }
+            host->inputQueue = host->requestedInputQueue;
+            if (host->inputQueue != NULL)
+            {
+                AInputQueue_attachLooper(host->inputQueue, host->looper, inputLooperIdentifier, consumeInput, host->inputQueue);
+            }
+        }
+
+        host->changeRequested = false;
+        pthread_cond_broadcast(&host->changeDone);
+    }
+
+    pthread_mutex_unlock(&host->mutex);
+
+    if (!running)
+    {
+        return false;
+    }
+
+    bool canRender = resumed && host->surface != EGL_NO_SURFACE;
+    if (canRender && host->choreographer != NULL)
+    {
+        if (!host->framePosted)
+        {
+            host->postFrameCallback(host->choreographer, onFrame, host);
+            host->framePosted = true;
+        }
+    }
+    else if (canRender)
+    {
+        /* Without AChoreographer, the swap interval paces the frames. */
+        renderFrame(host);
+        ALooper_wake(host->looper);
+    }
+
+    return true;
+}
+
+static void *renderThreadFunction(void *data)
+{
+    NativeHost *host = (NativeHost *)data;
+
+    host->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (host->display == EGL_NO_DISPLAY || !eglInitialize(host->display, NULL, NULL))
+    {
+        LOGE("NativeHost: cannot initialize EGL.\n");
+    }
+
+    /* The choreographer instance belongs to the looper of the calling thread, so prepare it first. */
+    ALooper *looper = ALooper_prepare(0);
+
+    void *library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+    if (library != NULL)
+    {
+        AChoreographerGetInstanceFunction getInstance = (AChoreographerGetInstanceFunction)dlsym(library, "AChoreographer_getInstance");
+        host->postFrameCallback = (AChoreographerPostFrameCallbackFunction)dlsym(library, "AChoreographer_postFrameCallback");
+        if (getInstance != NULL && host->postFrameCallback != NULL)
+        {
+            host->choreographer = getInstance();
+        }
+    }
+    if (host->choreographer == NULL)
+    {
+        LOGI("NativeHost: AChoreographer is not available, frames are paced by the swap interval.\n");
+    }
+
+    pthread_mutex_lock(&host->mutex);
+    host->looper = looper;
+    pthread_cond_broadcast(&host->changeDone);
+    pthread_mutex_unlock(&host->mutex);
+
+    while (applyChanges(host))
+    {
+        ALooper_pollOnce(-1, NULL, NULL, NULL);
+    }
+
+    destroySurface(host);
+    if (host->inputQueue != NULL)
+    {
+        AInputQueue_detachLooper(host->inputQueue);
+    }
+    eglTerminate(host->display);
+    if (library != NULL)
+    {
+        dlclose(library);
+    }
+
+    return NULL;
+}
+
+/* Hand a change over to the render thread and wait until it has been taken on, so a window is never used after it is gone. */
+static void requestChange(NativeHost *host, ANativeWindow *window, AInputQueue *inputQueue)
+{
+    pthread_mutex_lock(&host->mutex);
+    host->requestedWindow = window;
+    host->requestedInputQueue = inputQueue;
+    host->changeRequested = true;
+    ALooper_wake(host->looper);
+    while (host->changeRequested)
+    {
+        pthread_cond_wait(&host->changeDone, &host->mutex);
+    }
+    pthread_mutex_unlock(&host->mutex);
+}
+
+static void setResumed(NativeHost *host, bool resumed)
+{
+    pthread_mutex_lock(&host->mutex);
+    host->resumed = resumed;
+    ALooper_wake(host->looper);
+    pthread_mutex_unlock(&host->mutex);
+}
+
+static void onResume(ANativeActivity *activity)
+{
+    setResumed((NativeHost *)activity->instance, true);
+}
+
+static void onPause(ANativeActivity *activity)
+{
+    setResumed((NativeHost *)activity->instance, false);
+}
+
+static void onNativeWindowCreated(ANativeActivity *activity, ANativeWindow *window)
+{
+    NativeHost *host = (NativeHost *)activity->instance;
+    requestChange(host, window, host->requestedInputQueue);
+}
+
+static void onNativeWindowDestroyed(ANativeActivity *activity, ANativeWindow *window)
+{
+    NativeHost *host = (NativeHost *)activity->instance;
+    requestChange(host, NULL, host->requestedInputQueue);
+}
+
+static void onInputQueueCreated(ANativeActivity *activity, AInputQueue *queue)
+{
+    NativeHost *host = (NativeHost *)activity->instance;
+    requestChange(host, host->requestedWindow, queue);
+}
+
+static void onInputQueueDestroyed(ANativeActivity *activity, AInputQueue *queue)
+{
+    NativeHost *host = (NativeHost *)activity->instance;
+    requestChange(host, host->requestedWindow, NULL);
+}
+
+static void onDestroy(ANativeActivity *activity)
+{
+    NativeHost *host = (NativeHost *)activity->instance;
+
+    pthread_mutex_lock(&host->mutex);
+    host->destroyRequested = true;
+    ALooper_wake(host->looper);
+    pthread_mutex_unlock(&host->mutex);
+
+    pthread_join(host->renderThread, NULL);
+    pthread_cond_destroy(&host->changeDone);
+    pthread_mutex_destroy(&host->mutex);
+
+    activity->instance = NULL;
+    delete host;
+}
+
+/* The samples name their files in the directory the Java side would extract to, /data/data/<package>/. */
+static std::string getAssetDirectory(const ANativeActivity *activity)
+{
+#ifdef NATIVE_HOST_ASSET_DIRECTORY
+    return NATIVE_HOST_ASSET_DIRECTORY;
+#else
+    /* internalDataPath is <data directory>/<package>/files. */
+    std::string path = (activity->internalDataPath != NULL) ? activity->internalDataPath : "";
+    size_t filesStart = path.rfind('/');
+    size_t packageStart = (filesStart != std::string::npos && filesStart > 0) ? path.rfind('/', filesStart - 1) : std::string::npos;
+    if (packageStart == std::string::npos)
+    {
+        return "";
+    }
+
+    return "/data/data/" + path.substr(packageStart + 1, filesStart - packageStart - 1) + "/";
+#endif
+}
+
+extern "C" JNIEXPORT void ANativeActivity_onCreate(ANativeActivity *activity, void *savedState, size_t savedStateSize)
+{
+    NativeHost *host = new NativeHost();
+
+    host->activity = activity;
+    host->sampleInit = (SampleInitFunction)findEntryPoint("_init");
+    host->sampleStep = (SampleStepFunction)findEntryPoint("_step");
+    host->sampleUninit = (SampleStepFunction)findEntryPoint("_uninit");
+    if (host->sampleInit == NULL || host->sampleStep == NULL)
+    {
+        LOGE("NativeHost: the library has no %s_init() and %s_step().\n", NATIVE_HOST_JNI_PREFIX, NATIVE_HOST_JNI_PREFIX);
+        delete host;
+        ANativeActivity_finish(activity);
+        return;
+    }
+
+    host->assetDirectory = getAssetDirectory(activity);
+    AssetFile::setAssetManager(activity->assetManager, host->assetDirectory.c_str());
+    EGLConfigSelector::setCacheDirectory((host->assetDirectory + "files/").c_str());
+
+    host->display = EGL_NO_DISPLAY;
+    host->surface = EGL_NO_SURFACE;
+    host->context = EGL_NO_CONTEXT;
+    pthread_mutex_init(&host->mutex, NULL);
+    pthread_cond_init(&host->changeDone, NULL);
+
+    activity->instance = host;
+    activity->callbacks->onResume = onResume;
+    activity->callbacks->onPause = onPause;
+    activity->callbacks->onDestroy = onDestroy;
+    activity->callbacks->onNativeWindowCreated = onNativeWindowCreated;
+    activity->callbacks->onNativeWindowDestroyed = onNativeWindowDestroyed;
+    activity->callbacks->onInputQueueCreated = onInputQueueCreated;
+    activity->callbacks->onInputQueueDestroyed = onInputQueueDestroyed;
+
+    /* The callbacks wake the render thread's looper, so wait until it has one. */
+    pthread_mutex_lock(&host->mutex);
+    pthread_create(&host->renderThread, NULL, renderThreadFunction, host);
+    while (host->looper == NULL)
+    {
+        pthread_cond_wait(&host->changeDone, &host->mutex);
+    }
+    pthread_mutex_unlock(&host->mutex);
+}
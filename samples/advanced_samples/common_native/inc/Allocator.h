@@ -1,4 +1,4 @@
-/* Copyright (c) 2014-2017, ARM Limited and Contributors
+/* Copyright (c) 2017, ARM Limited and Contributors
  *
  * SPDX-License-Identifier: MIT
  *
@@ -18,58 +18,41 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifndef TIMER_H
-#define TIMER_H
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
 
-#include <cstdio>
-
-#if defined(_WIN32)
-#else
-#include <sys/time.h>
-#endif
+#include <cstddef>
 
 namespace MaliSDK
 {
     /**
-     * \brief Provides a platform independent high resolution timer.
-     * \note The timer measures real time, not CPU time.
+     * \brief Interface for the allocators that generators of transient vertex and index data can write into.
+     *
+     * Functions that take an Allocator use malloc() when it is NULL, and the caller frees the result with free().
+     * Otherwise the memory belongs to the allocator and is released through it.
      */
-    class Timer
+    class Allocator
     {
-    private:
-        int frameCount;
-        float fps;
-        float lastTime;
-
-    #if defined(_WIN32)
-        double resetStamp;
-        double invFreq;
-        float  lastInterval;
-        float  lastFpsUpdate;
-    #else
-        timeval startTime;
-        timeval currentTime;
-        float   lastIntervalTime;
-        float   fpsTime;
-    #endif
-
     public:
         /**
-         * \brief Default Constructor
+         * \brief Default alignment of allocations, enough for any vector type the samples upload.
          */
-        Timer();
-        
+        static const size_t defaultAlignment = 16;
+
+        virtual ~Allocator(void) {}
+
         /**
-         * \brief Resets the timer to 0.0f.
+         * \brief Allocate memory.
+         * \param[in] size Bytes to allocate.
+         * \param[in] alignment Alignment of the returned pointer, a power of two.
+         * \return NULL if the memory cannot be allocated.
          */
-        void reset();
+        virtual void *allocate(size_t size, size_t alignment = defaultAlignment) = 0;
 
         /**
-         * \brief Returns the time passed since object creation or since reset() was last called.
-         *
-         * \return Float containing the current time.
+         * \brief Give back memory returned by allocate(). Allocators that release everything at once may ignore it.
          */
-        float getTime();
+        virtual void deallocate(void *pointer) = 0;
     };
 }
-#endif /* TIMER_H */
\ No newline at end of file
+#endif /* ALLOCATOR_H */
@@ -21,6 +21,9 @@
 #ifndef ANDROIDPLATFORM_H
 #define ANDROIDPLATFORM_H
 
+#include "GLCallCounters.h"
+#include "GLCapture.h"
+
 #include <jni.h>
 #include <android/log.h>
 
@@ -50,12 +53,36 @@ namespace MaliSDK
          * \param[in] JNIEnvironment  A pointer to the JNI environment which allows interfacing with the Java Virtual Machine (JVM).
          *                            Allows extensive interaction with the JVM including accessing Java classes, fields and methods.
          *                            This pointer is provided as part of a JNI call from Java to C++.
+         *                            May be NULL if the file is known to be in destinationDirectory already.
          * \param[in] destinationDirectory The destination directory where the file should be placed.
          * \param[in] filename Name of the file to extract from the APK. Can be any file placed inside the "assets" directory of the Android project when the APK is built.
          * \return Returns true if the file is avaliable in the destinationDirectory.
          */
         static bool getAndroidAsset(JNIEnv* JNIEnvironment, const char destinationDirectory[], const char filename[]);
 
+        /**
+         * \brief Read assets straight from the APK instead of extracting them.
+         *
+         * Hands the asset manager to AssetFile::setAssetManager(). From then on getAndroidAsset() leaves the files of
+         * directory in the APK, so the first run copies nothing and they take no space in the application directory.
+         * Only use it when every file of the directory is read through AssetFile, or helpers built on it such as
+         * Shader::processShader(), Texture::loadCompressedMipmaps() and KTXLoader; fopen() will not find them.
+         * \param[in] JNIEnvironment The JNI environment of the calling thread. If NULL, as in the benchmark harness,
+         *                           nothing changes and the files have to be in directory.
+         * \param[in] assetManager The android.content.res.AssetManager of the application. A global reference is kept.
+         * \param[in] directory The directory the assets would otherwise be extracted to.
+         * \return True if assets are read from the APK from now on.
+         */
+        static bool useAPKAssets(JNIEnv* JNIEnvironment, jobject assetManager, const char directory[]);
+
+        /**
+         * \brief Read assets straight from the APK, with the asset manager of MaliSamplesActivity.
+         * \param[in] JNIEnvironment The JNI environment of the calling thread. May be NULL, see above.
+         * \param[in] directory The directory the assets would otherwise be extracted to.
+         * \return True if assets are read from the APK from now on.
+         */
+        static bool useAPKAssets(JNIEnv* JNIEnvironment, const char directory[]);
+
         /**
          * \brief Checks if OpenGL ES has reported any errors.
          * \param[in] operation The OpenGL ES function that has been called.
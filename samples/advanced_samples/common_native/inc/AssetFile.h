@@ -0,0 +1,122 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ASSETFILE_H
+#define ASSETFILE_H
+
+#include <android/asset_manager.h>
+
+#include <cstddef>
+#include <string>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Read-only view of a whole file, without copying it into a heap buffer.
+     *
+     * Files are normally extracted from the APK by the Java side and read from the application directory.
+     * If setAssetManager() has been called, files in that directory are instead opened straight from the APK
+     * with AAsset_getBuffer(), which maps assets stored uncompressed. Anything else is mapped with mmap().
+     * Either way getData() can be passed directly to glShaderSource(), glTexImage2D() and the like.
+     *
+     * Typical usage:
+     * \code
+     * AssetFile file;
+     * if (file.open(filename))
+     * {
+     *     GL_CHECK(glCompressedTexImage2D(..., (GLsizei)file.getSize(), file.getData()));
+     * }
+     * \endcode
+     *
+     * The data is not null-terminated: pass getSize() along with it.
+     */
+    class AssetFile
+    {
+    private:
+        static AAssetManager *assetManager;
+        static std::string assetDirectory;
+
+        const unsigned char *data;
+        size_t size;
+        AAsset *asset;
+        void *mapping;
+        size_t mappingSize;
+
+        /* Copying would unmap the file twice. */
+        AssetFile(const AssetFile &);
+        AssetFile &operator=(const AssetFile &);
+
+        /**
+         * \brief Try to open a file from the APK instead of the file system.
+         * \param[in] filename Path of the file as extracted by the Java side.
+         * \return True if the file is an asset of the APK.
+         */
+        bool openAsset(const char *filename);
+    public:
+        /**
+         * \brief Open files from the APK instead of the directories they are extracted to.
+         * \param[in] manager The asset manager of the application, from AAssetManager_fromJava(). Pass NULL to only use the file system.
+         * \param[in] directory The directory the Java side extracts assets to, e.g. "/data/data/com.arm.malideveloper.openglessdk.cube/".
+         */
+        static void setAssetManager(AAssetManager *manager, const char *directory);
+
+        /**
+         * \brief Check whether a file would be opened from the APK, without opening it.
+         * \param[in] filename Path of the file as extracted by the Java side.
+         * \return True if setAssetManager() covers the directory of the file and the APK holds it.
+         */
+        static bool isAsset(const char *filename);
+
+        /**
+         * \brief Create an object with no file open.
+         */
+        AssetFile(void);
+
+        /**
+         * \brief Calls close().
+         */
+        ~AssetFile(void);
+
+        /**
+         * \brief Map a file, closing the previously open one.
+         * \param[in] filename Path of the file.
+         * \return False if the file does not exist or cannot be mapped.
+         */
+        bool open(const char *filename);
+
+        /**
+         * \brief Unmap the file. Pointers returned by getData() become invalid.
+         */
+        void close(void);
+
+        /**
+         * \brief Get the contents of the file.
+         * \return A pointer valid until close() is called, or NULL if no file is open.
+         */
+        const unsigned char *getData(void) const;
+
+        /**
+         * \brief Get the size of the file.
+         * \return The size in bytes, 0 if no file is open.
+         */
+        size_t getSize(void) const;
+    };
+}
+#endif /* ASSETFILE_H */
@@ -0,0 +1,126 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ASYNCREADBACK_H
+#define ASYNCREADBACK_H
+
+#include <GLES3/gl3.h>
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Reads a framebuffer, the default one unless told otherwise, back to the CPU without stalling the pipeline.
+     *
+     * read() copies the framebuffer into one of a ring of pixel pack buffers with glReadPixels() and puts a fence
+     * after the copy. Nothing waits for the GPU there: collect() maps a buffer only once its fence has signalled,
+     * usually a few frames later. When every buffer is still in flight, read() drops the request instead of
+     * waiting, so checking images costs the frames being timed no more than the copy itself.
+     *
+     * Typical usage, once per frame:
+     * \code
+     * if (frame % interval == 0)
+     * {
+     *     readback.read(frame);
+     * }
+     * unsigned int tag;
+     * while (readback.collect(&tag, pixels))
+     * {
+     *     ... pixels holds the frame tagged with tag ...
+     * }
+     * \endcode
+     */
+    class AsyncReadback
+    {
+    private:
+        struct Slot
+        {
+            GLuint buffer;
+            GLsync fence;
+            unsigned int tag;
+        };
+
+        GLsizei width;
+        GLsizei height;
+        std::vector<Slot> slots;
+        unsigned int written;
+        unsigned int collected;
+        unsigned int droppedReads;
+
+        AsyncReadback(const AsyncReadback &);
+        AsyncReadback &operator=(const AsyncReadback &);
+
+    public:
+        /**
+         * \brief Create the pixel pack buffers. Needs a current context.
+         * \param[in] width Width of the area read, from the bottom left corner of the framebuffer.
+         * \param[in] height Height of the area read.
+         * \param[in] numberOfBuffers Reads which can be in flight at once, thus frames the pixels may lag behind.
+         */
+        AsyncReadback(GLsizei width, GLsizei height, unsigned int numberOfBuffers = 3);
+
+        /**
+         * \brief Delete the buffers and the pending fences. Needs the context the buffers were created in.
+         */
+        ~AsyncReadback(void);
+
+        /**
+         * \brief Start reading a framebuffer into the next free buffer.
+         *
+         * The read framebuffer, pixel pack buffer and pack alignment are restored afterwards.
+         * \param[in] tag Returned by collect() with the pixels, to tell which frame they belong to.
+         * \param[in] framebuffer Framebuffer read, from its first colour attachment. The default one if 0.
+         * \return False if every buffer is still in flight and nothing was read.
+         */
+        bool read(unsigned int tag, GLuint framebuffer = 0);
+
+        /**
+         * \brief Get the pixels of the oldest read, if the GPU has finished it.
+         * \param[out] tag The tag given to read().
+         * \param[out] pixels Resized to width * height RGBA pixels, bottom row first as glReadPixels() returns them.
+         * \param[in] wait Wait for the GPU if the read is not finished yet, to get the last reads at the end of a run.
+         * \return False if no read is pending, if the oldest one is not finished and wait is false, or if its buffer
+         * could not be mapped, in which case the read is dropped.
+         */
+        bool collect(unsigned int *tag, std::vector<unsigned char> &pixels, bool wait = false);
+
+        /**
+         * \brief Number of reads not collected yet.
+         */
+        unsigned int getNumberOfPendingReads(void) const;
+
+        /**
+         * \brief Number of times read() found every buffer in flight and dropped the request.
+         */
+        unsigned int getDroppedReads(void) const;
+
+        /**
+         * \brief Width of the area read.
+         */
+        GLsizei getWidth(void) const;
+
+        /**
+         * \brief Height of the area read.
+         */
+        GLsizei getHeight(void) const;
+    };
+}
+#endif /* ASYNCREADBACK_H */
@@ -0,0 +1,95 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ATLASMIPMAPBUILDER_H
+#define ATLASMIPMAPBUILDER_H
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Builds the mip levels of a texture atlas one sub-image at a time, so no level mixes two sub-images.
+     *
+     * Filtering the atlas as one image averages the texels on both sides of every boundary between sub-images,
+     * more of them at every level, and the texels of the other sub-image show through at a distance. Here every
+     * level of a sub-image is the 2 by 2 average of the same sub-image in the level above, its edge texels being
+     * repeated where the filter would read past it. The texels in no sub-image are filtered over the whole level
+     * above. The filter is integer-only and rounds, so the levels are the same on every device.
+     *
+     * Bilinear filtering at the edge of a sub-image also reads the texels next to it. With padding, the texels
+     * around every sub-image which are in no other repeat its edge, up to that many texels away at every level.
+     *
+     * A block compressor such as TextureFormatSelector::encodeETC1() keeps the sub-images apart as long as they
+     * are made of whole blocks. Rectangles which stay multiples of the block size at a level do, and
+     * getNumberOfSafeLevels() counts the levels for which all of them do. The levels below it may share blocks
+     * between neighbouring sub-images: clamp the level of detail to the safe levels where the API allows it.
+     *
+     * Needs no context, so it can run offline or on a job.
+     */
+    class AtlasMipmapBuilder
+    {
+    public:
+        /**
+         * \brief Where a sub-image is in level 0 of the atlas, in texels.
+         */
+        struct SubImage
+        {
+            int x;
+            int y;
+            int width;
+            int height;
+        };
+
+        /**
+         * \brief Get the number of levels of a full mip chain, down to 1 by 1.
+         * \param[in] width Width of level 0.
+         * \param[in] height Height of level 0.
+         */
+        static int getNumberOfLevels(int width, int height);
+
+        /**
+         * \brief Get the number of levels in which every sub-image is still made of whole blocks.
+         * \param[in] width Width of level 0 of the atlas.
+         * \param[in] height Height of level 0 of the atlas.
+         * \param[in] subImages The sub-images.
+         * \param[in] blockSize Width and height of a block of the compressed format, 4 for ETC and EAC.
+         * \return 0 if level 0 itself is not aligned, up to getNumberOfLevels().
+         */
+        static int getNumberOfSafeLevels(int width, int height, const std::vector<SubImage> &subImages, int blockSize = 4);
+
+        /**
+         * \brief Build the levels of an atlas.
+         * \param[in] image Level 0, tightly packed 8-bit rows.
+         * \param[in] width Width of level 0.
+         * \param[in] height Height of level 0.
+         * \param[in] channels Number of channels of a texel.
+         * \param[in] subImages The sub-images, which must be inside level 0 and must not overlap.
+         * \param[in] padding Texels around every sub-image which repeat its edge, at every level. 0 leaves them as filtered.
+         * \param[in] numberOfLevels Number of levels to build, level 0 included, up to getNumberOfLevels().
+         * \param[out] levels Used to store the levels, tightly packed like image. Level 0 is a copy of image, padded.
+         * \return False if the parameters are invalid.
+         */
+        static bool build(const unsigned char *image, int width, int height, int channels,
+                          const std::vector<SubImage> &subImages, int padding, int numberOfLevels,
+                          std::vector<std::vector<unsigned char> > *levels);
+    };
+}
+#endif /* ATLASMIPMAPBUILDER_H */
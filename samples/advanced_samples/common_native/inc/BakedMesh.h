@@ -0,0 +1,146 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BAKEDMESH_H
+#define BAKEDMESH_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include "AssetFile.h"
+#include "BakedMeshFormat.h"
+
+namespace MaliSDK
+{
+    /**
+     * \brief Loads a mesh baked offline by tools/MeshBaker, see BakedMeshFormat.h.
+     *
+     * Nothing is parsed or converted at load time: the file is mapped with AssetFile, straight from the APK when
+     * the asset is stored uncompressed, and the vertex and index sections are passed to glBufferData() from the
+     * mapping. The level of detail and meshlet tables are read from the mapping too, which stays open until close().
+     *
+     * \code
+     * BakedMesh mesh;
+     * if (mesh.load("/data/data/com.arm.malideveloper.openglessdk.sample/model.mesh"))
+     * {
+     *     GL_CHECK(glUniform3fv(positionScaleLocation, 1, mesh.getHeader()->positionScale));
+     *     GL_CHECK(glUniform3fv(positionBiasLocation, 1, mesh.getHeader()->positionBias));
+     *     mesh.enableAttributes(positionLocation, normalLocation, -1);
+     *     mesh.draw(mesh.selectLevel(pixelsPerUnit));
+     * }
+     * \endcode
+     *
+     * Store the files uncompressed in the APK (aaptOptions { noCompress 'mesh' }), or the asset manager inflates
+     * them into a heap copy first.
+     */
+    class BakedMesh
+    {
+    private:
+        AssetFile file;
+        const BakedMeshHeader *header;
+        GLuint vertexBuffer;
+        GLuint indexBuffer;
+
+        /* Copying would delete the buffers twice. */
+        BakedMesh(const BakedMesh &);
+        BakedMesh &operator=(const BakedMesh &);
+
+        /**
+         * \brief Check that the sections the header points to are inside the file.
+         * \return False if the file is truncated or the header is corrupt.
+         */
+        bool validate(void) const;
+    public:
+        /**
+         * \brief Create an object with no mesh.
+         */
+        BakedMesh(void);
+
+        /**
+         * \brief Calls close().
+         */
+        ~BakedMesh(void);
+
+        /**
+         * \brief Map a baked mesh and upload its vertices and indices, closing the previous one.
+         *
+         * Must be called with a current context. Leaves GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER unbound.
+         * \param[in] filename Path of the file.
+         * \return False if the file cannot be opened, is of another version or is corrupt.
+         */
+        bool load(const char *filename);
+
+        /**
+         * \brief Delete the buffers and unmap the file.
+         */
+        void close(void);
+
+        /**
+         * \brief Get the header of the mesh.
+         * \return NULL if no mesh is loaded.
+         */
+        const BakedMeshHeader *getHeader(void) const;
+
+        /**
+         * \brief Get a level of detail.
+         * \param[in] level 0 to getHeader()->numberOfLevels - 1.
+         */
+        const BakedMeshLevel &getLevel(unsigned int level) const;
+
+        /**
+         * \brief Get a meshlet of level 0.
+         * \param[in] meshlet 0 to getHeader()->numberOfMeshlets - 1.
+         */
+        const BakedMeshlet &getMeshlet(unsigned int meshlet) const;
+
+        /**
+         * \brief Pick the coarsest level of detail whose error is under a pixel.
+         * \param[in] pixelsPerUnit Size on screen of one model unit at the distance of the mesh, in pixels.
+         * \return The index of the level.
+         */
+        unsigned int selectLevel(float pixelsPerUnit) const;
+
+        /**
+         * \brief Bind the vertex buffer and point the attributes of a program at it.
+         * \param[in] positionLocation Location of the vec4 position, which still has to be scaled and offset.
+         * \param[in] normalLocation Location of the vec2 octahedral normal, or -1 to leave it.
+         * \param[in] uvLocation Location of the vec2 texture coordinates, which still have to be scaled and offset, or -1.
+         */
+        void enableAttributes(GLint positionLocation, GLint normalLocation, GLint uvLocation) const;
+
+        /**
+         * \brief Draw a level of detail with glDrawElements(), binding the index buffer.
+         * \param[in] level Index of the level.
+         */
+        void draw(unsigned int level) const;
+
+        /**
+         * \brief Draw a meshlet of level 0 with glDrawElements(), binding the index buffer.
+         * \param[in] meshlet Index of the meshlet.
+         */
+        void drawMeshlet(unsigned int meshlet) const;
+    };
+}
+#endif /* BAKEDMESH_H */
@@ -0,0 +1,108 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BAKEDMESHFORMAT_H
+#define BAKEDMESHFORMAT_H
+
+#include <stdint.h>
+
+namespace MaliSDK
+{
+    /*
+     * The file layout of a baked mesh, written offline by tools/MeshBaker and read by BakedMesh.
+     *
+     * A file is a BakedMeshHeader followed by the sections it points to, each aligned to 16 bytes so they can be
+     * handed to glBufferData() straight from a mapping of the file:
+     * - the vertices, interleaved, vertexStride bytes each:
+     *   - the position as four normalized GL_SHORT, x, y and z to be scaled by positionScale and offset by positionBias,
+     *     w being 32767 so it reads as 1,
+     *   - with BAKED_MESH_NORMALS, the normal octahedrally encoded in two normalized GL_BYTE (see VertexPacking)
+     *     followed by two bytes of padding,
+     *   - with BAKED_MESH_UVS, the texture coordinates as two normalized GL_UNSIGNED_SHORT, to be scaled by uvScale
+     *     and offset by uvBias,
+     * - the GL_UNSIGNED_SHORT indices of all levels of detail, level 0 ordered for the post-transform cache,
+     * - a BakedMeshLevel per level of detail, from the most detailed to the coarsest,
+     * - a BakedMeshlet per meshlet of level 0.
+     *
+     * Everything is little endian, as on every Android ABI. Files of another version are rejected, not converted.
+     */
+
+    /** "BMSH" read as a little endian word. */
+    const uint32_t BAKED_MESH_MAGIC = 0x48534d42;
+    const uint32_t BAKED_MESH_VERSION = 1;
+
+    /** \brief Flags of BakedMeshHeader::attributes. The position is always there. */
+    const uint32_t BAKED_MESH_NORMALS = 1 << 0;
+    const uint32_t BAKED_MESH_UVS = 1 << 1;
+
+    /** \brief Largest number of vertices and triangles of a meshlet. */
+    const uint32_t BAKED_MESH_MESHLET_VERTICES = 64;
+    const uint32_t BAKED_MESH_MESHLET_TRIANGLES = 124;
+
+    struct BakedMeshHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t attributes;
+        uint32_t vertexStride;
+        uint32_t numberOfVertices;
+        uint32_t numberOfIndices;
+        uint32_t numberOfLevels;
+        uint32_t numberOfMeshlets;
+        /* Byte offsets of the sections from the start of the file. */
+        uint32_t vertexOffset;
+        uint32_t indexOffset;
+        uint32_t levelOffset;
+        uint32_t meshletOffset;
+        float positionScale[3];
+        float positionBias[3];
+        float uvScale[2];
+        float uvBias[2];
+        /* Bounding sphere of the whole mesh. */
+        float center[3];
+        float radius;
+    };
+
+    /**
+     * \brief A level of detail: a range of the index buffer drawing the whole mesh.
+     *
+     * Coarser levels reuse the vertices of level 0. error is the largest distance, in model units, a vertex may
+     * have moved by, so a level is good enough once error projects to less than a pixel.
+     */
+    struct BakedMeshLevel
+    {
+        uint32_t firstIndex;
+        uint32_t numberOfIndices;
+        float error;
+    };
+
+    /**
+     * \brief A cluster of up to BAKED_MESH_MESHLET_TRIANGLES neighbouring triangles of level 0 using at most
+     * BAKED_MESH_MESHLET_VERTICES vertices, with a bounding sphere for culling.
+     */
+    struct BakedMeshlet
+    {
+        uint32_t firstIndex;
+        uint32_t numberOfIndices;
+        float center[3];
+        float radius;
+    };
+}
+#endif /* BAKEDMESHFORMAT_H */
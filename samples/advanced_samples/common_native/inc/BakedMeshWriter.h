@@ -0,0 +1,84 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BAKEDMESHWRITER_H
+#define BAKEDMESHWRITER_H
+
+#include "BakedMeshFormat.h"
+#include "MeshOptimizer.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Bakes an IndexedModel into the file format of BakedMesh, see BakedMeshFormat.h.
+     *
+     * Used offline by tools/MeshBaker, so all the work the loader does not do happens here:
+     * - vertices are quantized to positions of 16 bits per component relative to their bounding box, octahedral
+     *   normals of 8 bits and texture coordinates of 16 bits,
+     * - coarser levels of detail are made by vertex clustering: vertices are snapped to a grid, each cell keeps the
+     *   vertex closest to the average of its vertices, and triangles which collapse are dropped. The grid halves its
+     *   resolution from one level to the next,
+     * - level 0 is split into meshlets in the order of its triangles.
+     *
+     * The model should already have been passed to MeshOptimizer::optimize(), the writer keeps its order.
+     */
+    class BakedMeshWriter
+    {
+    private:
+        /**
+         * \brief Make a coarser level of detail of the triangles of level 0.
+         * \param[in] model The model.
+         * \param[in] gridSize Number of cells of the grid along the longest side of the bounding box.
+         * \param[out] indices Receives the triangles of the level.
+         * \return The error of the level, the diagonal of a cell.
+         */
+        static float simplify(const IndexedModel &model, int gridSize, std::vector<unsigned short> *indices);
+
+        /**
+         * \brief Split the triangles of level 0 into meshlets.
+         * \param[in] model The model.
+         * \param[out] meshlets Receives the meshlets.
+         */
+        static void buildMeshlets(const IndexedModel &model, std::vector<BakedMeshlet> *meshlets);
+
+        /**
+         * \brief Compute a bounding sphere of some vertices, centred on their bounding box.
+         * \param[in] model The model.
+         * \param[in] indices Indices of the vertices.
+         * \param[in] numberOfIndices Number of indices.
+         * \param[out] center Receives the centre.
+         * \param[out] radius Receives the radius.
+         */
+        static void computeSphere(const IndexedModel &model, const unsigned short *indices, size_t numberOfIndices, float *center, float *radius);
+    public:
+        /**
+         * \brief Bake a model and write it to a file.
+         * \param[in] model The model, with positionOffset set and normalOffset and uvOffset set or -1.
+         * \param[in] filename Path of the file to write.
+         * \param[in] maximumLevels Number of levels of detail to make at most, including level 0.
+         * \return False if the file cannot be written.
+         */
+        static bool write(const IndexedModel &model, const char *filename, unsigned int maximumLevels = 4);
+    };
+}
+#endif /* BAKEDMESHWRITER_H */
@@ -0,0 +1,223 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef COMMANDLIST_H
+#define COMMANDLIST_H
+
+#include <GLES3/gl3.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Records draw, bind and uniform commands on any thread, to be replayed later by the rendering thread.
+     *
+     * OpenGL ES only takes commands from the thread its context is current on, so the CPU work of building a frame,
+     * such as culling and choosing what to bind and set, would all run there. Recording needs no context: each worker
+     * fills a CommandList of its own, in parallel with the others, and the rendering thread calls execute() on them
+     * in the order they have to run. A list is a compact array of commands plus the uniform values they set.
+     *
+     * execute() filters out the redundant state changes: programs, vertex arrays, textures and capabilities go
+     * through GLStateCache, and a uniform is only set when its value differs from the one this execute() set last.
+     * Samples binding state directly rather than through GLStateCache must call GLStateCache::invalidate() first.
+     *
+     * Typical usage, with a list per pass recorded by a JobScheduler:
+     * \code
+     * static void recordPass(unsigned int begin, unsigned int end, void *userData)
+     * {
+     *     for (unsigned int pass = begin; pass < end; pass++)
+     *     {
+     *         CommandList &list = lists[pass];
+     *         list.reset();
+     *         list.useProgram(program);
+     *         list.bindVertexArray(vertexArray);
+     *         for (each visible object)
+     *         {
+     *             list.uniformMatrix4fv(modelLocation, 1, matrix);
+     *             list.drawArrays(GL_TRIANGLES, 0, numberOfVertices);
+     *         }
+     *     }
+     * }
+     *
+     * scheduler.parallelFor("record_passes", numberOfPasses, 1, recordPass, NULL);
+     * for (each pass)
+     * {
+     *     lists[pass].execute();
+     * }
+     * \endcode
+     *
+     * Recording never calls OpenGL ES. A list must not be recorded by two threads at once, nor recorded while it is
+     * executed. reset() keeps the memory, so lists recorded every frame stop allocating once they have reached
+     * their largest size.
+     */
+    class CommandList
+    {
+    private:
+        enum CommandType
+        {
+            COMMAND_USE_PROGRAM,
+            COMMAND_BIND_VERTEX_ARRAY,
+            COMMAND_BIND_TEXTURE,
+            COMMAND_BIND_BUFFER_BASE,
+            COMMAND_SET_ENABLED,
+            COMMAND_UNIFORM_INT,
+            COMMAND_UNIFORM_FLOATS,
+            COMMAND_DRAW_ARRAYS,
+            COMMAND_DRAW_ELEMENTS
+        };
+
+        /*
+         * target is the texture or buffer target, the capability, the primitive mode or the uniform type (GL_INT,
+         * GL_FLOAT, GL_FLOAT_VEC4, GL_FLOAT_MAT4...). The arguments follow the corresponding OpenGL ES call,
+         * see execute(). Uniform floats are stored in values, a command has their offset and how many there are.
+         */
+        struct Command
+        {
+            CommandType type;
+            GLenum target;
+            GLint arguments[4];
+        };
+
+        /* A uniform set by execute(), with the offset of its current value in values. */
+        struct UniformState
+        {
+            GLuint program;
+            GLint location;
+            GLenum type;
+            GLsizei count;
+            size_t offset;
+            GLint integer;
+        };
+
+        std::vector<Command> commands;
+        std::vector<GLfloat> values;
+        std::vector<UniformState> uniforms;
+
+        unsigned int filteredUniforms;
+
+        CommandList(const CommandList &);
+        CommandList &operator=(const CommandList &);
+
+        void push(CommandType type, GLenum target, GLint argument0 = 0, GLint argument1 = 0, GLint argument2 = 0, GLint argument3 = 0);
+
+        void pushFloats(GLenum type, GLint location, GLsizei count, GLsizei floatsPerElement, const GLfloat *data);
+
+        /**
+         * \brief Whether a uniform already has a value in this execute(), and remember it otherwise.
+         * \return True if the call can be skipped.
+         */
+        bool isUniformSet(GLuint program, const Command &command);
+
+    public:
+        /**
+         * \brief Create an empty list.
+         * \param[in] reservedCommands Number of commands to make room for up front.
+         */
+        CommandList(unsigned int reservedCommands = 256);
+
+        /**
+         * \brief Empty the list, keeping its memory.
+         */
+        void reset(void);
+
+        /**
+         * \brief glUseProgram().
+         */
+        void useProgram(GLuint program);
+
+        /**
+         * \brief glBindVertexArray().
+         */
+        void bindVertexArray(GLuint vertexArray);
+
+        /**
+         * \brief glActiveTexture() and glBindTexture().
+         * \param[in] unit The unit, from 0, not GL_TEXTURE0.
+         * \param[in] target The target, e.g. GL_TEXTURE_2D.
+         * \param[in] texture The texture.
+         */
+        void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+        /**
+         * \brief glBindBufferBase(), for GL_UNIFORM_BUFFER or GL_TRANSFORM_FEEDBACK_BUFFER.
+         */
+        void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+        /**
+         * \brief glEnable() or glDisable().
+         */
+        void setEnabled(GLenum capability, bool enabled);
+
+        /**
+         * \brief glUniform1i(), also for samplers and booleans.
+         */
+        void uniform1i(GLint location, GLint value);
+
+        /**
+         * \brief glUniform1f().
+         */
+        void uniform1f(GLint location, GLfloat value);
+
+        /**
+         * \brief glUniform3fv(). The values are copied.
+         */
+        void uniform3fv(GLint location, GLsizei count, const GLfloat *value);
+
+        /**
+         * \brief glUniform4fv(). The values are copied.
+         */
+        void uniform4fv(GLint location, GLsizei count, const GLfloat *value);
+
+        /**
+         * \brief glUniformMatrix4fv(), not transposed. The values are copied.
+         */
+        void uniformMatrix4fv(GLint location, GLsizei count, const GLfloat *value);
+
+        /**
+         * \brief glDrawArrays(), or glDrawArraysInstanced() if more than one instance.
+         */
+        void drawArrays(GLenum mode, GLint first, GLsizei count, GLsizei instances = 1);
+
+        /**
+         * \brief glDrawElements(), or glDrawElementsInstanced() if more than one instance.
+         * \param[in] offset Byte offset in the element array buffer of the bound vertex array.
+         */
+        void drawElements(GLenum mode, GLsizei count, GLenum type, GLintptr offset, GLsizei instances = 1);
+
+        /**
+         * \brief Make the recorded calls, in order. Needs a current context. The list is left as it is,
+         *        so it can be executed again.
+         */
+        void execute(void);
+
+        /**
+         * \brief Number of commands recorded since the last reset().
+         */
+        unsigned int getNumberOfCommands(void) const;
+
+        /**
+         * \brief Number of uniform commands the last execute() skipped, as they would not have changed anything.
+         */
+        unsigned int getNumberOfFilteredUniforms(void) const;
+    };
+}
+#endif /* COMMANDLIST_H */
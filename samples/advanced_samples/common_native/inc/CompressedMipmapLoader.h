@@ -0,0 +1,174 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef COMPRESSEDMIPMAPLOADER_H
+#define COMPRESSEDMIPMAPLOADER_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Streams the PKM mipmap levels read by Texture::loadCompressedMipmaps() into a texture, smallest level first.
+     *
+     * start() reads and uploads the smallest level itself, so the texture can be sampled straight away.
+     * A worker thread then reads the larger levels, and update(), called once per frame, uploads the next one
+     * that has been read. The texture never samples a level that is not in yet:
+     * - In OpenGL ES 3.0 the whole chain is allocated up front and GL_TEXTURE_BASE_LEVEL follows the largest level uploaded.
+     * - In OpenGL ES 2.0, which has no base level, the levels in so far are specified again one level down,
+     *   so level 0 is always the largest level uploaded. As each level is a quarter of the one above,
+     *   this uploads about a third more data than loading the whole chain at once.
+     *
+     * Typical usage:
+     * \code
+     * loader.start("/data/data/com.arm.malideveloper.openglessdk.sample/texture_", ".pkm");
+     *
+     * // In the render loop:
+     * loader.update();
+     * GL_CHECK(glBindTexture(GL_TEXTURE_2D, loader.getTexture()));
+     * \endcode
+     *
+     * The levels are loaded as GL_ETC1_RGB8_OES in OpenGL ES 2.0, and as GL_COMPRESSED_RGB8_ETC2, of which ETC1 is a subset,
+     * in OpenGL ES 3.0.
+     */
+    class CompressedMipmapLoader
+    {
+    private:
+        std::string filenameBase;
+        std::string filenameSuffix;
+        int width;
+        int height;
+        int numberOfLevels;
+        GLuint texture;
+
+        /* The largest level in the texture, numberOfLevels until start() has uploaded the smallest one. */
+        int uploadedLevel;
+
+        /*
+         * Compressed data of each level, without the PKM header. The worker fills in levels from the smallest up
+         * and only then lowers readLevel, the rendering thread only touches the levels from readLevel up.
+         */
+        std::vector<std::vector<unsigned char> > levelData;
+
+        /* Set once a failed read has been reported, the texture then keeps the levels it has. */
+        bool stopped;
+
+        /* Worker thread state, readLevel and failed are shared with the worker. */
+        bool workerStarted;
+        bool cancelled;
+        bool failed;
+        int readLevel;
+        pthread_t workerThread;
+        pthread_mutex_t mutex;
+
+        /* Copying would leave two owners of the worker thread. */
+        CompressedMipmapLoader(const CompressedMipmapLoader &);
+        CompressedMipmapLoader &operator=(const CompressedMipmapLoader &);
+
+        /**
+         * \brief Read a level from its PKM file into levelData.
+         * \param[in] level The mipmap level to read.
+         * \return False if the file cannot be opened or is not the size of the level.
+         */
+        bool readLevelData(int level);
+
+        /**
+         * \brief Make level the largest level of the texture.
+         * \param[in] level A level that has been read, one below uploadedLevel.
+         */
+        void uploadLevel(int level);
+
+        /**
+         * \brief Working function of the worker thread.
+         * \param[in] loader The CompressedMipmapLoader that started the thread.
+         * \return Always NULL.
+         */
+        static void *workerFunction(void *loader);
+
+        /**
+         * \brief Wait for the worker thread, if there is one.
+         */
+        void joinWorker(void);
+    public:
+        /**
+         * \brief Create an idle loader.
+         */
+        CompressedMipmapLoader(void);
+
+        /**
+         * \brief Stop the worker thread and delete the texture, if any.
+         *
+         * Must be called with the context that called start() current.
+         */
+        ~CompressedMipmapLoader(void);
+
+        /**
+         * \brief Start loading the mipmap levels.
+         *
+         * Must be called with a current context, which is then used by update().
+         * Changes the GL_TEXTURE_2D binding of the active texture unit.
+         * \param[in] filenameBase The base filename of the levels, the level number is appended to it.
+         * \param[in] filenameSuffix Appended to the filenames after the level number, most commonly ".pkm".
+         * \return False if the base level or the smallest level cannot be read.
+         */
+        bool start(const std::string &filenameBase, const std::string &filenameSuffix);
+
+        /**
+         * \brief Upload the next larger level if the worker has read it.
+         *
+         * At most one level is uploaded per call, so a frame never pays for more than one of them.
+         * Changes the GL_TEXTURE_2D binding of the active texture unit when a level is uploaded.
+         * \return True once every level is in the texture.
+         */
+        bool update(void);
+
+        /**
+         * \brief Check whether every level has been uploaded, without uploading anything.
+         * \return True if the texture has its full resolution.
+         */
+        bool isComplete(void) const;
+
+        /**
+         * \brief Get the level the texture samples as its base level.
+         * \return The mipmap level of the PKM files, 0 once the texture is complete.
+         */
+        int getUploadedLevel(void) const;
+
+        /**
+         * \brief Get the texture the levels are loaded into.
+         *
+         * The texture holds the smallest level from start() on, and is refined by update().
+         * \return The texture ID, or 0 if start() has not succeeded.
+         */
+        GLuint getTexture(void) const;
+    };
+}
+#endif /* COMPRESSEDMIPMAPLOADER_H */
@@ -0,0 +1,223 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DEPTHPREPASS_H
+#define DEPTHPREPASS_H
+
+#include "AsyncReadback.h"
+
+#include <GLES3/gl3.h>
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Depth pre-pass, which lays down the depth of the scene before its expensive fragments are shaded.
+     *
+     * Early depth testing only rejects the fragments hidden by what was drawn before them. When the scene can't
+     * be sorted front to back, each pixel may be shaded several times over. The pre-pass draws the positions of
+     * the scene first, with colour writes off and a program of its own with an empty fragment shader. The shading
+     * pass then tests against the final depth with GL_LEQUAL and depth writes off, so every pixel is shaded once.
+     * It costs a second pass over the vertices and a second rasterization, which only pays off with enough overdraw.
+     *
+     * MODE_AUTOMATIC measures the overdraw every few frames: the positions are drawn without depth test into a small
+     * GL_R8 target with additive blending, each fragment adding one, and AsyncReadback brings the counts back a few
+     * frames later. The average count of the covered pixels is the number of times each of them is rasterized
+     * without a pre-pass, in the worst order. The pre-pass is turned on above the threshold, and off again below 80%
+     * of it, so a scene hovering around the threshold doesn't switch every measurement.
+     *
+     * The positions are read from attribute POSITION_ATTRIBUTE, from vertex arrays which only enable that stream,
+     * see createVertexArray(). Reading them alone keeps the vertex fetch of both extra passes small. The shading pass
+     * has to compute exactly the same depth: declare gl_Position invariant in its vertex shader, and compute it as
+     * the model-view-projection matrix times the position, as the pre-pass does.
+     *
+     * Typical usage, per frame:
+     * \code
+     * bool usePrePass = depthPrePass.beginFrame();
+     * if (depthPrePass.beginMeasurement())
+     * {
+     *     // For each object: depthPrePass.setModelViewProjection(matrix); draw its position-only vertex array.
+     *     depthPrePass.endMeasurement();
+     * }
+     * // Bind and clear the framebuffer of the frame.
+     * if (usePrePass)
+     * {
+     *     depthPrePass.beginDepthPass();
+     *     // For each object: depthPrePass.setModelViewProjection(matrix); draw its position-only vertex array.
+     *     depthPrePass.beginShadingPass();
+     * }
+     * // Bind the shading program and draw the scene as usual.
+     * depthPrePass.endFrame();
+     * \endcode
+     *
+     * Only available in OpenGL ES 3.0 builds.
+     */
+    class DepthPrePass
+    {
+    public:
+        /**
+         * \brief When the pre-pass is used.
+         */
+        enum Mode
+        {
+            MODE_OFF,       /**< Never, the shading pass tests and writes depth as usual. */
+            MODE_ON,        /**< Every frame. */
+            MODE_AUTOMATIC  /**< When the measured overdraw is above the threshold. */
+        };
+
+        /**
+         * \brief Attribute location the positions are read from by the programs of the pre-pass.
+         */
+        static const GLuint POSITION_ATTRIBUTE = 0;
+
+    private:
+        Mode mode;
+        float overdrawThreshold;
+        unsigned int measurementInterval;
+
+        GLuint depthProgram;
+        GLuint countProgram;
+        GLint depthMatrixLocation;
+        GLint countMatrixLocation;
+        GLint currentMatrixLocation;
+
+        GLsizei countWidth;
+        GLsizei countHeight;
+        GLuint countTexture;
+        GLuint countFramebuffer;
+        AsyncReadback *readback;
+        std::vector<unsigned char> counts;
+
+        unsigned int frame;
+        bool measuring;
+        bool enabled;
+        float overdraw;
+
+        GLint previousFramebuffer;
+        GLint previousViewport[4];
+
+        /* Copying would leave two owners of the GL objects. */
+        DepthPrePass(const DepthPrePass &);
+        DepthPrePass &operator=(const DepthPrePass &);
+    public:
+        /**
+         * \brief Create the programs of the pre-pass and the target of the measurements. Needs a current context.
+         * \param[in] width Width of the framebuffer the scene is drawn into.
+         * \param[in] height Height of the framebuffer the scene is drawn into.
+         * \param[in] mode When the pre-pass is used.
+         * \param[in] overdrawThreshold Average number of fragments per covered pixel above which MODE_AUTOMATIC
+         *                              turns the pre-pass on.
+         * \param[in] measurementInterval Frames between two measurements in MODE_AUTOMATIC.
+         */
+        DepthPrePass(GLsizei width, GLsizei height, Mode mode = MODE_AUTOMATIC, float overdrawThreshold = 2.0f,
+                     unsigned int measurementInterval = 60);
+
+        /**
+         * \brief Delete the programs, the measurement target and the readback buffers.
+         */
+        ~DepthPrePass(void);
+
+        /**
+         * \brief Create a vertex array which only reads positions, into POSITION_ATTRIBUTE.
+         *
+         * Leaves vertex array 0 bound. The caller deletes the vertex array.
+         * \param[in] positionBuffer Buffer holding the positions, usually the one the scene is drawn with.
+         * \param[in] size Number of components of each position, 2 to 4.
+         * \param[in] type Type of the components.
+         * \param[in] stride Bytes between two positions, 0 if they are tightly packed.
+         * \param[in] offset Offset of the first position in the buffer.
+         * \param[in] indexBuffer Element array buffer to bind to the vertex array, 0 for none.
+         */
+        static GLuint createVertexArray(GLuint positionBuffer, GLint size, GLenum type, GLsizei stride, GLintptr offset,
+                                        GLuint indexBuffer = 0);
+
+        /**
+         * \brief Change when the pre-pass is used. Switching to MODE_AUTOMATIC measures at the next frame.
+         */
+        void setMode(Mode mode);
+
+        /**
+         * \brief When the pre-pass is used.
+         */
+        Mode getMode(void) const;
+
+        /**
+         * \brief Pick up the finished measurements and decide whether the pre-pass is used in this frame.
+         * \return True if the scene has to go through beginDepthPass() and beginShadingPass() in this frame.
+         */
+        bool beginFrame(void);
+
+        /**
+         * \brief Start measuring the overdraw, if one is due in this frame.
+         *
+         * Binds the measurement target and the counting program, and sets the state of the measurement. The culling
+         * of the caller stays in effect, as the faces it culls are never shaded either.
+         * Call it before drawing into the framebuffer of the frame: switching away from it midway makes tile-based
+         * GPUs write its tiles out and load them back.
+         * \return True if the positions of the scene have to be drawn, followed by endMeasurement().
+         */
+        bool beginMeasurement(void);
+
+        /**
+         * \brief Start reading the counts back, and restore the framebuffer and the viewport.
+         *
+         * Leaves blending off, depth testing on, and colour and depth writes on.
+         */
+        void endMeasurement(void);
+
+        /**
+         * \brief Bind the program of the pre-pass and turn colour writes off. Call it after clearing the depth.
+         */
+        void beginDepthPass(void);
+
+        /**
+         * \brief Set the model-view-projection matrix of the next object, in the pre-pass or a measurement.
+         * \param[in] matrix Column-major 4 by 4 matrix.
+         */
+        void setModelViewProjection(const float *matrix);
+
+        /**
+         * \brief Turn colour writes back on, and depth writes off with the GL_LEQUAL test against the pre-pass.
+         *
+         * The program of the pre-pass stays bound, bind the shading program before drawing.
+         */
+        void beginShadingPass(void);
+
+        /**
+         * \brief Restore the depth writes and the GL_LESS test, and invalidate the depth of the bound framebuffer.
+         *
+         * Nothing reads the depth after the frame, so it is never written back to memory. Call it after the last
+         * draw into the framebuffer, whether the pre-pass was used or not.
+         */
+        void endFrame(void);
+
+        /**
+         * \brief Whether the pre-pass is used in this frame, as returned by beginFrame().
+         */
+        bool isEnabled(void) const;
+
+        /**
+         * \brief Average number of fragments per covered pixel at the last measurement, 0 before the first one.
+         */
+        float getOverdraw(void) const;
+    };
+}
+#endif /* DEPTHPREPASS_H */
@@ -0,0 +1,93 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DEPTHSORTER_H
+#define DEPTHSORTER_H
+
+#include "Matrix.h"
+#include "VectorTypes.h"
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Orders objects front to back or back to front by their view space depth.
+     *
+     * The depth of every object is computed once per sort into a key array. The order found by the previous sort is
+     * the starting point of an insertion sort, which is linear when the camera moves a little between frames. When
+     * the objects are too far out of order, for example on the first frame, a radix sort on the keys runs instead,
+     * so a sort is always O(N).
+     */
+    class DepthSorter
+    {
+    public:
+        enum Order
+        {
+            FrontToBack,
+            BackToFront
+        };
+
+    private:
+        std::vector<float> depths;
+        std::vector<unsigned int> keys;
+        std::vector<int> order;
+        std::vector<int> scratch;
+
+        bool insertionSort(void);
+        void radixSort(void);
+
+    public:
+        /**
+         * \brief Sort objects by their position.
+         * \param[in] positions Centres of the objects in world space.
+         * \param[in] count Number of objects.
+         * \param[in] viewMatrix Transforms world to view space, looking down negative z.
+         * \param[in] order Whether the nearest or the farthest object comes first.
+         */
+        void sort(const Vec3f *positions, int count, const Matrix *viewMatrix, Order order);
+
+        /**
+         * \brief Sort objects by depths computed elsewhere, smallest first.
+         * \param[in] values One depth per object.
+         * \param[in] count Number of objects.
+         */
+        void sortByDepth(const float *values, int count);
+
+        /**
+         * \brief Indices of the objects in sorted order, getCount() of them.
+         */
+        const int *getOrder(void) const;
+
+        /**
+         * \brief Number of objects sorted last.
+         */
+        int getCount(void) const;
+
+        /**
+         * \brief Make the identity order the starting point of the next sort.
+         *
+         * Call after rearranging the objects themselves in the sorted order, so that object i is the one sorted
+         * to position i.
+         */
+        void resetOrder(void);
+    };
+}
+#endif /* DEPTHSORTER_H */
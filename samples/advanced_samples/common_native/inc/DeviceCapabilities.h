@@ -0,0 +1,197 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DEVICECAPABILITIES_H
+#define DEVICECAPABILITIES_H
+
+#include <GLES3/gl3.h>
+
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    class MicroBenchmarkSuite;
+
+    /**
+     * \brief What the device and driver support, and how fast they are, kept in a JSON report.
+     *
+     * probe() records the EGL configs, the GL strings, extensions, implementation limits including the compute
+     * limits of OpenGL ES 3.1, and the compressed texture formats of the current context. Micro-benchmark results,
+     * which take seconds to measure, are added with addBenchmarkResults(). ListEGLConfigs writes the full report.
+     *
+     * Samples read a report at startup to pick their fast paths without probing again:
+     * \code
+     * DeviceCapabilities capabilities;
+     * capabilities.loadOrProbe("/data/data/<package>/files/capabilities.json");
+     * bool useHalfFloat = capabilities.supportsHalfFloatRendering();
+     * \endcode
+     * A report is only loaded if it was written with the same GL_RENDERER and GL_VERSION as the current context,
+     * so a driver update or another GPU never picks up stale capabilities, as with ProgramBinaryCache.
+     */
+    class DeviceCapabilities
+    {
+    public:
+        /**
+         * \brief One implementation limit. Limits such as GL_MAX_COMPUTE_WORK_GROUP_SIZE have several values.
+         */
+        struct Limit
+        {
+            std::string name;
+            std::vector<long long> values;
+        };
+
+        /**
+         * \brief The attributes of an EGLConfig which matter to choosing one.
+         */
+        struct Config
+        {
+            int id;
+            int red;
+            int green;
+            int blue;
+            int alpha;
+            int depth;
+            int stencil;
+            int samples;
+            int surfaceType;
+            int renderableType;
+            int caveat;
+        };
+
+        /**
+         * \brief The rate a micro-benchmark measured.
+         */
+        struct BenchmarkResult
+        {
+            std::string name;
+            std::string unit;
+            bool supported;
+            double perSecond;
+        };
+
+        DeviceCapabilities(void);
+
+        /**
+         * \brief Record the capabilities of the current context and its display.
+         *
+         * Needs an OpenGL ES 3.0 context, compute limits are recorded from OpenGL ES 3.1.
+         * Only queries state, and keeps the benchmark results which have been added already.
+         */
+        void probe(void);
+
+        /**
+         * \brief Record the results of a suite, replacing earlier results of the same cases.
+         *
+         * Cases which have not finished are skipped.
+         */
+        void addBenchmarkResults(const MicroBenchmarkSuite &suite);
+
+        /**
+         * \brief Write the report.
+         * \param[in] filename Path of the JSON file.
+         * \return True if the file was written.
+         */
+        bool save(const char *filename) const;
+
+        /**
+         * \brief Read a report written by save().
+         *
+         * Needs a current context to check the report against.
+         * \param[in] filename Path of the JSON file.
+         * \return False, leaving the capabilities as they were, if the file is missing, cannot be parsed,
+         *         or comes from another renderer or driver version.
+         */
+        bool load(const char *filename);
+
+        /**
+         * \brief Read a report, or probe() and write one if it cannot be loaded.
+         * \param[in] filename Path of the JSON file.
+         * \return True if the report was loaded, false if the capabilities have just been probed.
+         */
+        bool loadOrProbe(const char *filename);
+
+        const std::string &getRenderer(void) const;
+        const std::string &getVersion(void) const;
+
+        /**
+         * \return True if the extension is supported, matching whole names only.
+         */
+        bool hasExtension(const char *extension) const;
+
+        /**
+         * \param[in] name  Name of the limit, e.g. "GL_MAX_TEXTURE_SIZE".
+         * \param[in] index Which value of the limit, for limits with several.
+         * \return The value, 0 if the limit was not recorded.
+         */
+        long long getLimit(const char *name, int index = 0) const;
+
+        /**
+         * \return True if the format is one of GL_COMPRESSED_TEXTURE_FORMATS.
+         */
+        bool isCompressedFormatSupported(GLenum internalFormat) const;
+
+        /**
+         * \param[in] name Name of the micro-benchmark, e.g. "fill_rgba16f_opaque".
+         * \return Its units of work per second, 0 if it was not measured or is not supported.
+         */
+        double getBenchmarkRate(const char *name) const;
+
+        /**
+         * \return True if GL_RGBA16F is colour-renderable.
+         */
+        bool supportsHalfFloatRendering(void) const;
+
+        /**
+         * \return True if ASTC LDR textures are supported.
+         */
+        bool supportsASTC(void) const;
+
+        /**
+         * \return True if GL_EXT_shader_pixel_local_storage is supported.
+         */
+        bool supportsPixelLocalStorage(void) const;
+
+        /**
+         * \return True if GL_OVR_multiview is supported.
+         */
+        bool supportsMultiview(void) const;
+
+        const std::vector<Config> &getConfigs(void) const;
+        const std::vector<std::string> &getExtensions(void) const;
+        const std::vector<Limit> &getLimits(void) const;
+        const std::vector<GLint> &getCompressedFormats(void) const;
+        const std::vector<BenchmarkResult> &getBenchmarkResults(void) const;
+
+    private:
+        std::string renderer;
+        std::string vendor;
+        std::string version;
+        std::string shadingLanguageVersion;
+        std::string eglVendor;
+        std::string eglVersion;
+        std::vector<Config> configs;
+        std::vector<std::string> extensions;
+        std::vector<Limit> limits;
+        std::vector<GLint> compressedFormats;
+        std::vector<BenchmarkResult> benchmarkResults;
+    };
+}
+#endif /* DEVICECAPABILITIES_H */
@@ -0,0 +1,163 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DRAWQUEUE_H
+#define DRAWQUEUE_H
+
+#include "StreamingBuffer.h"
+
+#include <GLES3/gl3.h>
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Collects the draws of a frame, sorts them by state and merges identical ones into instanced draws.
+     *
+     * Every submission carries a 64-bit sort key made by makeKey() from the pass, program, texture, vertex array
+     * and depth, most significant first. flush() radix sorts the keys, so all draws of a pass run together, then
+     * all draws of a program, and so on, and each state changes as few times as possible. Within the same state
+     * the draws go in depth order, front to back if the depths passed are distances from the camera.
+     *
+     * Draws with the same state and the same range of the same mesh end up next to each other, and are merged
+     * into a single glDraw*Instanced call. What differs between them, such as the model matrix and the colour,
+     * is passed as instance data: a fixed number of vec4s per draw which flush() writes into a StreamingBuffer,
+     * and binds to consecutive attribute locations with a divisor of one. The vertex shader declares them, e.g.
+     * \code
+     * layout(location = 2) in mat4 instanceModel;
+     * layout(location = 6) in vec4 instanceColor;
+     * \endcode
+     * for a queue created with instanceLocation = 2 and vec4sPerInstance = 5. The queue sets these attributes
+     * in the vertex arrays of the draws, the other attributes have to be set up by the caller beforehand.
+     *
+     * Uniforms are not part of the state, set them on each program before flush().
+     */
+    class DrawQueue
+    {
+    public:
+        /**
+         * \brief The state and the vertex range of one draw.
+         */
+        struct Draw
+        {
+            /** \brief Program to draw with. */
+            GLuint program;
+            /** \brief Bound to GL_TEXTURE_2D of texture unit 0 if not 0. */
+            GLuint texture;
+            /** \brief Vertex array holding the per-vertex attributes and the element buffer. */
+            GLuint vertexArray;
+            /** \brief Primitive type, such as GL_TRIANGLES. */
+            GLenum mode;
+            /** \brief GL_UNSIGNED_SHORT or GL_UNSIGNED_INT for indexed draws, 0 for glDrawArrays. */
+            GLenum indexType;
+            /** \brief Number of indices, or of vertices for non-indexed draws. */
+            GLsizei count;
+            /** \brief Byte offset in the element buffer, or first vertex for non-indexed draws. */
+            GLintptr first;
+        };
+
+    private:
+        struct Submission
+        {
+            unsigned long long key;
+            Draw draw;
+        };
+
+        GLuint instanceLocation;
+        unsigned int vec4sPerInstance;
+        unsigned int maxDraws;
+
+        std::vector<Submission> submissions;
+        std::vector<float> instanceData;
+        std::vector<unsigned int> order;
+        std::vector<unsigned int> scratch;
+
+        StreamingBuffer instanceStream;
+
+        unsigned int submittedDraws;
+        unsigned int drawCalls;
+        unsigned int stateChanges;
+
+        DrawQueue(const DrawQueue &);
+        DrawQueue &operator=(const DrawQueue &);
+
+        /**
+         * \brief Sort order by the keys of the submissions, one byte at a time.
+         */
+        void radixSort(void);
+
+    public:
+        /**
+         * \brief Create the instance data stream. Needs a current context.
+         * \param[in] instanceLocation First attribute location of the instance data.
+         * \param[in] vec4sPerInstance Number of vec4s of instance data for each draw.
+         * \param[in] maxDraws Number of draws one flush() can take.
+         * \param[in] flushesInFlight Number of flushes the GPU may lag behind, usually frames in flight times
+         *                            the number of flushes in a frame.
+         */
+        DrawQueue(GLuint instanceLocation, unsigned int vec4sPerInstance, unsigned int maxDraws, unsigned int flushesInFlight = 3);
+
+        /**
+         * \brief Build a sort key.
+         *
+         * Bits 60 to 63 hold the pass, then 12 bits each for the program, texture and vertex array names,
+         * and the lowest 24 bits the depth. Names above 4095 share bits with others, which only costs sorting
+         * quality, never correctness, as the merging compares the full state.
+         * \param[in] pass Order of the pass, from 0 to 15. Opaque geometry usually comes before translucent.
+         * \param[in] program Program of the draw.
+         * \param[in] texture Texture of the draw, or 0.
+         * \param[in] vertexArray Vertex array of the draw.
+         * \param[in] depth From 0 to 1, smallest first. Pass 1 - depth to sort back to front.
+         */
+        static unsigned long long makeKey(unsigned int pass, GLuint program, GLuint texture, GLuint vertexArray, float depth);
+
+        /**
+         * \brief Queue a draw until the next flush().
+         * \param[in] key Sort key made by makeKey().
+         * \param[in] draw State and vertex range of the draw.
+         * \param[in] instance vec4sPerInstance vec4s for the instance attributes.
+         */
+        void submit(unsigned long long key, const Draw &draw, const float *instance);
+
+        /**
+         * \brief Sort, merge and draw everything submitted since the previous flush, and empty the queue.
+         *
+         * Leaves the last program, texture and vertex array bound, then binds vertex array 0.
+         */
+        void flush(void);
+
+        /**
+         * \brief Number of draws given to the last flush().
+         */
+        unsigned int getSubmittedDraws(void) const;
+
+        /**
+         * \brief Number of draw calls the last flush() made from them.
+         */
+        unsigned int getDrawCalls(void) const;
+
+        /**
+         * \brief Number of program, texture and vertex array changes of the last flush().
+         */
+        unsigned int getStateChanges(void) const;
+    };
+}
+#endif /* DRAWQUEUE_H */
@@ -0,0 +1,130 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+
+#include <GLES3/gl3.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Scales the resolution of an offscreen render target to keep the GPU time of a frame on target.
+     *
+     * The GPU time between beginFrame() and endFrame() is measured with GL_EXT_disjoint_timer_query.
+     * Results are read back a few frames late so the CPU never waits on the GPU. Each result moves the
+     * scale towards the one that would have hit the target, assuming the cost is proportional to the
+     * number of pixels. Going down is fast so throttled devices recover within a few frames, going
+     * back up is slow so the resolution doesn't oscillate.
+     *
+     * The render target is allocated once at the maximum size. Each frame renders to the
+     * getWidth() by getHeight() corner of it, and the pass that upscales it to the screen multiplies its
+     * texture coordinates by getTexCoordScaleX() and getTexCoordScaleY(), so changing the scale never reallocates anything.
+     *
+     * If GL_EXT_disjoint_timer_query is not supported the scale stays at 1.
+     * Timer queries cannot nest, so nothing else may time the GPU between beginFrame() and endFrame().
+     */
+    class DynamicResolution
+    {
+    private:
+        /**
+         * \brief Number of frames of queries in flight.
+         */
+        static const int numberOfQueries = 4;
+
+        typedef void (GL_APIENTRYP GetQueryObjectui64vFunction)(GLuint id, GLenum pname, GLuint64 *params);
+
+        bool supported;
+        GetQueryObjectui64vFunction getQueryObjectui64v;
+        GLuint queries[numberOfQueries];
+        bool queryPending[numberOfQueries];
+        int queryIndex;
+
+        GLsizei maxWidth;
+        GLsizei maxHeight;
+        float targetFrameTime;
+        float minScale;
+        float scale;
+        float averageFrameTime;
+
+        /**
+         * \brief Read back a finished query and update the scale from it.
+         * \param[in] index The query to read back.
+         */
+        void collect(int index);
+    public:
+        /**
+         * \brief Create the timer queries. Must be called with a current context.
+         * \param[in] maxWidth Width of the render target, used at a scale of 1.
+         * \param[in] maxHeight Height of the render target, used at a scale of 1.
+         * \param[in] targetFrameTime GPU time to aim for between beginFrame() and endFrame(), in milliseconds.
+         * \param[in] minScale The scale never goes below this, in each dimension.
+         */
+        DynamicResolution(GLsizei maxWidth, GLsizei maxHeight, float targetFrameTime, float minScale = 0.5f);
+
+        /**
+         * \brief Delete the timer queries.
+         */
+        ~DynamicResolution(void);
+
+        /**
+         * \brief Collect an old result, which may change the size, then start timing the frame.
+         *
+         * Call before using getWidth() and getHeight() for the frame.
+         */
+        void beginFrame(void);
+
+        /**
+         * \brief Stop timing the frame.
+         */
+        void endFrame(void);
+
+        /**
+         * \brief Scale currently applied to each dimension, between the minimum scale and 1.
+         */
+        float getScale(void) const;
+
+        /**
+         * \brief Width to render at this frame, a multiple of 16 pixels unless it is the maximum width.
+         */
+        GLsizei getWidth(void) const;
+
+        /**
+         * \brief Height to render at this frame, a multiple of 16 pixels unless it is the maximum height.
+         */
+        GLsizei getHeight(void) const;
+
+        /**
+         * \brief Factor which maps texture coordinates of the whole render target to the rendered area horizontally.
+         */
+        float getTexCoordScaleX(void) const;
+
+        /**
+         * \brief Factor which maps texture coordinates of the whole render target to the rendered area vertically.
+         */
+        float getTexCoordScaleY(void) const;
+
+        /**
+         * \brief Smoothed GPU time of recent frames in milliseconds, 0 until a result is available.
+         */
+        float getAverageFrameTime(void) const;
+    };
+}
+#endif /* DYNAMICRESOLUTION_H */
@@ -0,0 +1,121 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef EGLCONFIGSELECTOR_H
+#define EGLCONFIGSELECTOR_H
+
+#include <EGL/egl.h>
+
+#include <string>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Picks the best EGL config for a set of requirements, and remembers it per device.
+     *
+     * eglChooseConfig() sorts configs by rules which favour more colour and depth bits than requested,
+     * which costs bandwidth for nothing. Instead every config is scored here: configs missing a requirement
+     * are rejected, and among the others the closest to the requirements wins. That means no alpha unless
+     * it is asked for, the smallest depth and stencil buffers which are big enough, and exactly the requested
+     * number of samples when there is such a config.
+     *
+     * The EGL_CONFIG_ID of the chosen config is stored in a small file keyed on the EGL vendor,
+     * EGL version and the requirements, so later runs skip the search.
+     * The cache is disabled until setCacheDirectory() has been called.
+     */
+    class EGLConfigSelector
+    {
+    public:
+        /**
+         * \brief What a config has to provide.
+         */
+        struct Requirements
+        {
+            /** Colour sizes. With exactColor set, configs with more bits are rejected. */
+            EGLint redSize;
+            EGLint greenSize;
+            EGLint blueSize;
+            EGLint alphaSize;
+            EGLint depthSize;
+            EGLint stencilSize;
+            /** Preferred number of samples, others are only used if there is no exact match. */
+            EGLint samples;
+            /** Bits which have to be set in EGL_RENDERABLE_TYPE. */
+            EGLint renderableType;
+            /** Bits which have to be set in EGL_SURFACE_TYPE. */
+            EGLint surfaceType;
+            /** Whether EGL_RECORDABLE_ANDROID is required, for surfaces which are also video encoder inputs. */
+            bool recordable;
+            /** Whether the colour sizes have to match exactly, to avoid colour conversion when presenting. */
+            bool exactColor;
+
+            /**
+             * \brief RGB888 window configs with a 16-bit depth buffer, no alpha, stencil nor multisampling, for OpenGL ES 2.0 and later.
+             */
+            Requirements(void);
+        };
+
+    private:
+        /**
+         * \brief Directory the cache file is stored in, empty if the cache is disabled.
+         */
+        static std::string cacheDirectory;
+
+        /**
+         * \brief Compute the cache key for a display and set of requirements.
+         */
+        static unsigned long long computeKey(EGLDisplay display, const Requirements &requirements);
+
+        /**
+         * \brief Look up a config in the cache.
+         * \return The cached config, or NULL if it is not cached or not usable any more.
+         */
+        static EGLConfig loadConfig(EGLDisplay display, const Requirements &requirements, unsigned long long key);
+
+        /**
+         * \brief Store the EGL_CONFIG_ID of a config in the cache.
+         */
+        static void storeConfig(EGLDisplay display, EGLConfig config, unsigned long long key);
+    public:
+        /**
+         * \brief Enable the cache and set the directory where it is stored.
+         * \param[in] directory A writable directory, ending in a path separator. Pass NULL to disable the cache.
+         */
+        static void setCacheDirectory(const char *directory);
+
+        /**
+         * \brief Score how well a config fits the requirements.
+         * \param[in] display The display the config belongs to.
+         * \param[in] config The config to score.
+         * \param[in] requirements What the config has to provide.
+         * \return A higher value for a better fit, or -1 if the config does not meet the requirements.
+         */
+        static int scoreConfig(EGLDisplay display, EGLConfig config, const Requirements &requirements);
+
+        /**
+         * \brief Find the best config for the requirements, from the cache if possible.
+         * \param[in] display An initialized display.
+         * \param[in] requirements What the config has to provide.
+         * \return The best scoring config, or NULL if no config meets the requirements.
+         */
+        static EGLConfig chooseConfig(EGLDisplay display, const Requirements &requirements);
+    };
+}
+#endif /* EGLCONFIGSELECTOR_H */
@@ -0,0 +1,94 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef EGLCONTEXTOPTIONS_H
+#define EGLCONTEXTOPTIONS_H
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+/* EGL_IMG_context_priority and EGL_KHR_create_context_no_error, not part of older headers. */
+#ifndef EGL_CONTEXT_PRIORITY_LEVEL_IMG
+#define EGL_CONTEXT_PRIORITY_LEVEL_IMG  0x3100
+#define EGL_CONTEXT_PRIORITY_HIGH_IMG   0x3101
+#define EGL_CONTEXT_PRIORITY_MEDIUM_IMG 0x3102
+#define EGL_CONTEXT_PRIORITY_LOW_IMG    0x3103
+#endif
+#ifndef EGL_CONTEXT_OPENGL_NO_ERROR_KHR
+#define EGL_CONTEXT_OPENGL_NO_ERROR_KHR 0x31B3
+#endif
+
+namespace MaliSDK
+{
+    /**
+     * \brief Options of the contexts the samples create, beyond the client version.
+     *
+     * With EGL_IMG_context_priority the rendering context asks for high priority and worker contexts for low,
+     * so uploads and compiles on workers do not hold up frames when the GPU is contended.
+     * With EGL_KHR_create_context_no_error, release builds (NDEBUG) skip the validation of every GL call.
+     * glGetError() then always returns GL_NO_ERROR, so GL_CHECK only reports errors in debug builds,
+     * and a call which would have raised an error has undefined results.
+     *
+     * Options the display does not support are left out. A priority is a hint the driver may lower,
+     * which is logged. Contexts sharing objects must agree on no-error, so if a context cannot be created
+     * as no-error, for instance because its share context was created by GLSurfaceView,
+     * it is created again without it.
+     */
+    class EGLContextOptions
+    {
+    public:
+        /**
+         * \brief EGL_CONTEXT_PRIORITY_HIGH_IMG, EGL_CONTEXT_PRIORITY_MEDIUM_IMG or EGL_CONTEXT_PRIORITY_LOW_IMG.
+         * 0 leaves the priority to the driver.
+         */
+        EGLint priority;
+
+        /**
+         * \brief Whether to ask for a context without error checking.
+         */
+        bool noError;
+
+        /**
+         * \brief The driver's default priority, with error checking.
+         */
+        EGLContextOptions(void);
+
+        /**
+         * \brief High priority, and no error checking in release builds.
+         */
+        static EGLContextOptions forRendering(void);
+
+        /**
+         * \brief Low priority, and no error checking in release builds.
+         */
+        static EGLContextOptions forWorker(void);
+
+        /**
+         * \brief Create a context with these options, leaving out those which cannot be applied.
+         * \param[in] display       The display to create the context on.
+         * \param[in] config        The config of the context, EGL_NO_CONFIG_KHR with EGL_KHR_no_config_context.
+         * \param[in] shareContext  The context to share objects with, or EGL_NO_CONTEXT.
+         * \param[in] clientVersion The value of EGL_CONTEXT_CLIENT_VERSION.
+         * \return The new context, EGL_NO_CONTEXT if it cannot be created even without the options.
+         */
+        EGLContext createContext(EGLDisplay display, EGLConfig config, EGLContext shareContext, EGLint clientVersion) const;
+    };
+}
+#endif /* EGLCONTEXTOPTIONS_H */
@@ -21,6 +21,8 @@
 #ifndef EGLRUNTIME_H
 #define EGLRUNTIME_H
 
+#include "EGLContextOptions.h"
+
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 #define EGL_CHECK(x) \
@@ -45,9 +47,12 @@ namespace MaliSDK
     private:
         /**
          * \brief Search for an EGL config with the attributes set in configAttributes.
-         * \param[in] strictMatch If true, will attempt to match exactly the attributes set in configAttributes.
-         * Otherwise, the first config found which meets 'at least' the required attributes (as determined by the EGL specification)
-         * will be returned.
+         *
+         * Configs are scored by EGLConfigSelector, so the closest config to the attributes is returned
+         * rather than the first one in eglChooseConfig() order, and the choice is cached once
+         * EGLConfigSelector::setCacheDirectory() has been called.
+         * \param[in] strictMatch If true, only configs with exactly the color sizes set in configAttributes are considered.
+         * Otherwise, any config which meets 'at least' the required attributes can be returned.
          * \return An EGL config with the required attributes.
          */
         static EGLConfig findConfig(bool strictMatch);
@@ -62,7 +67,7 @@ namespace MaliSDK
         /**
          * \brief Used to specify the EGL attributes we require from a context.
          * 
-         * Passed to eglCreateContext() in order to get the correct context type.
+         * Holds the client version, which is passed to EGLContextOptions::createContext() with contextOptions.
          */
         static EGLint contextAttributes [];
 
@@ -72,6 +77,16 @@ namespace MaliSDK
          * Passed to eglCreateWindowSurface() to get the required window surface type.
          */
         static EGLint windowAttributes [];
+
+        /**
+         * \brief Whether the config has to support EGL_RECORDABLE_ANDROID, see setRecordable().
+         */
+        static bool recordable;
+
+        /**
+         * \brief Priority and error checking of the context, see setContextOptions().
+         */
+        static EGLContextOptions contextOptions;
         
      
     public:
@@ -82,11 +97,29 @@ namespace MaliSDK
          *
          * \param[in] requiredEGLSamples The Level of AntiAliasing required.
          * \note It is not guaranteed that a config with the required level of AnitAliasing will be found.
-         * If it is not possible to find a matching config with the requested level, EGL_SAMPLES will be set to zero 
-         * and the search for a config will start again.
+         * If it is not possible to find a matching config with the requested level, the config with the closest
+         * level is used, preferring more samples to fewer.
          */
         static void setEGLSamples(EGLint requiredEGLSamples);
 
+        /**
+         * \brief Require a config which can feed a video encoder (EGL_RECORDABLE_ANDROID).
+         *
+         * Used when initializeEGL() is called. Off by default, as recordable configs may be more restricted.
+         * \param[in] requireRecordable True to require EGL_RECORDABLE_ANDROID.
+         */
+        static void setRecordable(bool requireRecordable);
+
+        /**
+         * \brief Set the priority and error checking of the context.
+         *
+         * Used when initializeEGL() is called. Defaults to EGLContextOptions::forRendering(): high priority,
+         * so background GPU work such as uploads on worker contexts does not delay frames,
+         * and no error checking in release builds.
+         * \param[in] options The options, those the display does not support are left out.
+         */
+        static void setContextOptions(const EGLContextOptions &options);
+
         /**
          * \brief An enum to define OpenGL ES versions.
          */
@@ -0,0 +1,60 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef EGLWORKERCONTEXT_H
+#define EGLWORKERCONTEXT_H
+
+#include "EGLContextOptions.h"
+
+#include <EGL/egl.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Creates the contexts of worker threads, sharing objects with a rendering context.
+     *
+     * Workers never draw to a surface, so with EGL_KHR_surfaceless_context no surface is created
+     * and the context is made current with EGL_NO_SURFACE. Without the extension a 1x1 pbuffer is created instead.
+     * With EGL_KHR_no_config_context as well, the context is created without a config, which spares the
+     * driver from setting up state for a framebuffer the worker never uses.
+     * Worker contexts are low priority by default, see EGLContextOptions.
+     */
+    class EGLWorkerContext
+    {
+    public:
+        /**
+         * \brief Create a context sharing objects with another one, and the surface to make it current with.
+         * \param[in] display The display of shareContext.
+         * \param[in] shareContext The context to share objects with, its config and client version are reused.
+         * \param[out] surface The surface to pass to eglMakeCurrent(), EGL_NO_SURFACE if surfaceless contexts are supported.
+         * \param[out] context The new context.
+         * \param[in] options Priority and error checking of the new context.
+         * \return True if both were created. On failure nothing is left to destroy.
+         */
+        static bool create(EGLDisplay display, EGLContext shareContext, EGLSurface *surface, EGLContext *context,
+                           const EGLContextOptions &options = EGLContextOptions::forWorker());
+
+        /**
+         * \brief Destroy a context and surface returned by create().
+         */
+        static void destroy(EGLDisplay display, EGLSurface surface, EGLContext context);
+    };
+}
+#endif /* EGLWORKERCONTEXT_H */
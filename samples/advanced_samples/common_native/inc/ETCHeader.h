@@ -98,7 +98,7 @@ namespace MaliSDK
         /**
          * \brief The size of the compressed texture with the padding added.
          * 
-         * The size is computed as padded width multiplied by padded height.
+         * The size is computed as padded width multiplied by padded height, halved for the formats with 4 bits per pixel.
          * \param[in] internalFormat The internal format of the compressed texture.
          * \return The size of the compressed texture with padding included.
          */
@@ -0,0 +1,149 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ENVIRONMENTPROBE_H
+#define ENVIRONMENTPROBE_H
+
+#include <GLES3/gl31.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Image based lighting from a cube map: diffuse irradiance as spherical harmonics and a prefiltered
+     *        specular cube map.
+     *
+     * Compute shaders project every texel of the cube map on the 9 spherical harmonics of the first 3 bands, and
+     * build a mip chain of a GL_RGBA8 cube map whose levels are the environment filtered by GGX with rising
+     * roughness, importance sampled as in the split sum approximation. Shading a pixel then takes a polynomial in
+     * the normal for the diffuse light and one textureLod() for the specular, see getShaderSource().
+     *
+     * Both are slow to make, so they are made once: generate() writes them to a cache file and loads them from it
+     * on the next runs. The cache is not checked against the cube map, delete the file when it changes.
+     *
+     * Texels are taken as they are sampled, so sRGB textures are decoded by the hardware and others are used as
+     * they are. Levels of the cube map below the base one make the rough levels less noisy, but are not required.
+     *
+     * Typical usage:
+     * \code
+     * EnvironmentProbe probe;
+     *
+     * if (probe.isSupported() && probe.generate(cubemap, "/data/data/.../files/sky.probe"))
+     * {
+     *     // In the fragment shader, after the precision statements: EnvironmentProbe::getShaderSource(), then
+     *     // color = albedo * probeIrradiance(normal) + specularColor * probeSpecular(reflection, roughness);
+     *     glUseProgram(program);
+     *     probe.setUniforms(program, 1);
+     * }
+     * \endcode
+     *
+     * Only available in OpenGL ES 3.0 builds, and needs OpenGL ES 3.1 at run time. Must be created and used with a
+     * current context.
+     */
+    class EnvironmentProbe
+    {
+    private:
+        bool computeSupported;
+        GLuint specularTexture;
+        GLsizei specularSize;
+        GLint specularLevels;
+
+        /* Radiance projected on the harmonics, scaled so that they evaluate to the irradiance divided by pi. */
+        GLfloat irradianceCoefficients[9 * 3];
+
+        void project(GLuint cubemap, GLsizei cubemapSize);
+        void prefilter(GLuint cubemap, GLsizei cubemapSize);
+
+        bool load(const char *cachePath, GLsizei cubemapSize);
+        void store(const char *cachePath, GLsizei cubemapSize) const;
+
+        /* Copying would leave two owners of the texture. */
+        EnvironmentProbe(const EnvironmentProbe &);
+        EnvironmentProbe &operator=(const EnvironmentProbe &);
+    public:
+        /**
+         * \brief Check the OpenGL ES version. Must be called with a current context.
+         */
+        EnvironmentProbe(void);
+
+        /**
+         * \brief Delete the specular cube map.
+         */
+        ~EnvironmentProbe(void);
+
+        /**
+         * \brief Whether the context has compute shaders, which generate() needs.
+         */
+        bool isSupported(void) const;
+
+        /**
+         * \brief Load the probe from a cache file, or make it from a cube map and write the file.
+         *
+         * Making it reads the coefficients back, which waits for the GPU, and writing the cache reads every
+         * level of the specular cube map too. Changes the current program, the shader storage buffer and image
+         * bindings 0 and the cube map bound to texture unit 0, and leaves unit 0 active.
+         *
+         * \param[in] cubemap A complete cube map with square faces.
+         * \param[in] cachePath The cache file, or NULL to always make the probe.
+         * \param[in] size Faces of the specular cube map, a power of two. Its last level is 8 texels wide and has
+         *                 a roughness of 1.
+         * \return false if the context has no compute shaders or the cube map cannot be read.
+         */
+        bool generate(GLuint cubemap, const char *cachePath, GLsizei size = 128);
+
+        /**
+         * \brief The prefiltered cube map, level roughness * (getSpecularLevels() - 1) being filtered by GGX with
+         *        that roughness. 0 until generate() succeeds.
+         */
+        GLuint getSpecularTexture(void) const;
+
+        /**
+         * \brief Number of levels of the specular cube map.
+         */
+        GLint getSpecularLevels(void) const;
+
+        /**
+         * \brief 9 RGB coefficients in the order of probeIrradiance(), already weighted by the cosine lobe.
+         */
+        const GLfloat *getIrradianceCoefficients(void) const;
+
+        /**
+         * \brief Bind the specular cube map and set the uniforms declared by getShaderSource().
+         *
+         * The program has to be current. Binds the cube map to texture unit textureUnit and leaves it active.
+         *
+         * \param[in] program The program including getShaderSource().
+         * \param[in] textureUnit The unit the probeSpecularTexture sampler reads.
+         */
+        void setUniforms(GLuint program, GLint textureUnit) const;
+
+        /**
+         * \brief GLSL to paste in fragment shaders after the precision statements.
+         *
+         * Declares the uniforms set by setUniforms(), and
+         * - vec3 probeIrradiance(vec3 normal): the light reaching a surface facing normal, divided by pi so that
+         *   multiplying it by the albedo gives the diffuse colour.
+         * - vec3 probeSpecular(vec3 reflection, float roughness): the environment around the reflected view
+         *   vector, roughness going from 0 for a mirror to 1.
+         * Both take world space vectors, in the space of the cube map, which need not be normalized.
+         */
+        static const char *getShaderSource(void);
+    };
+}
+#endif /* ENVIRONMENTPROBE_H */
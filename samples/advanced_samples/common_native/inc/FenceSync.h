@@ -1,4 +1,4 @@
-/* Copyright (c) 2014-2017, ARM Limited and Contributors
+/* Copyright (c) 2017, ARM Limited and Contributors
  *
  * SPDX-License-Identifier: MIT
  *
@@ -18,58 +18,34 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifndef TIMER_H
-#define TIMER_H
+#ifndef FENCESYNC_H
+#define FENCESYNC_H
 
-#include <cstdio>
-
-#if defined(_WIN32)
-#else
-#include <sys/time.h>
-#endif
+#include <GLES3/gl3.h>
 
 namespace MaliSDK
 {
     /**
-     * \brief Provides a platform independent high resolution timer.
-     * \note The timer measures real time, not CPU time.
+     * \brief Waits on the GL fence syncs which guard buffer regions reused across frames.
+     *
+     * A single glClientWaitSync() can time out however long its timeout is, so a blocking wait retries
+     * until the fence is signalled. Only the first call flushes, later ones would only add driver overhead.
      */
-    class Timer
+    class FenceSync
     {
     private:
-        int frameCount;
-        float fps;
-        float lastTime;
-
-    #if defined(_WIN32)
-        double resetStamp;
-        double invFreq;
-        float  lastInterval;
-        float  lastFpsUpdate;
-    #else
-        timeval startTime;
-        timeval currentTime;
-        float   lastIntervalTime;
-        float   fpsTime;
-    #endif
+        FenceSync(void);
 
     public:
         /**
-         * \brief Default Constructor
-         */
-        Timer();
-        
-        /**
-         * \brief Resets the timer to 0.0f.
-         */
-        void reset();
-
-        /**
-         * \brief Returns the time passed since object creation or since reset() was last called.
-         *
-         * \return Float containing the current time.
+         * \brief Wait for a fence to become signalled.
+         * \param[in] fence The fence to wait on.
+         * \param[in] block Whether to wait until the fence is signalled, or only check its status.
+         * \param[in] name What the fence guards, reported if the wait fails.
+         * \return True if the fence is signalled, or the wait failed so waiting longer will not help.
+         * False if block is false and the GPU has not reached the fence yet.
          */
-        float getTime();
+        static bool wait(GLsync fence, bool block, const char *name);
     };
 }
-#endif /* TIMER_H */
\ No newline at end of file
+#endif /* FENCESYNC_H */
@@ -0,0 +1,147 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef FILTERABLESHADOWMAP_H
+#define FILTERABLESHADOWMAP_H
+
+#include "MipmapGenerator.h"
+
+#include <GLES3/gl3.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Exponential variance shadow map (EVSM), which can be filtered like a colour texture.
+     *
+     * A depth shadow map can only be compared, one depth at a time, so soft edges cost a comparison per
+     * percentage closer filtering tap in every fragment. update() turns the depth map into two exponentially
+     * warped depths and their squares, blurs them once with a separable Gaussian and builds their mipmaps, so
+     * a single trilinear lookup returns the mean and variance of the occluders around the fragment. Chebyshev's
+     * inequality then bounds how much of the filter footprint is lit. The positive and the negative warp each
+     * give a bound, and their minimum hides most of the light bleeding of plain variance shadow maps.
+     *
+     * Perspective depth is linearized between the near and far planes of the light first, so the precision of
+     * the half float moments is spread over the whole light frustum. The fragment shader of the receivers
+     * samples the moments with the same depth as the comparison it replaces:
+     * \code
+     * uniform sampler2D shadowMoments;
+     * uniform vec2      shadowDepthRange; // Near and far plane of the light projection.
+     *
+     * float chebyshevUpperBound(vec2 moments, float mean, float minimumVariance)
+     * {
+     *     float variance   = max(moments.y - moments.x * moments.x, minimumVariance);
+     *     float difference = mean - moments.x;
+     *     // Cut off the tail of the bound, which is where light bleeds through overlapping occluders.
+     *     float bound      = clamp((variance / (variance + difference * difference) - 0.2) / 0.8, 0.0, 1.0);
+     *
+     *     return mean <= moments.x ? 1.0 : bound;
+     * }
+     *
+     * // positionInShadowMap is the position in texture space after the perspective division.
+     * float getShadowVisibility(vec3 positionInShadowMap)
+     * {
+     *     float near        = shadowDepthRange.x;
+     *     float far         = shadowDepthRange.y;
+     *     float distance    = near * far / (far - positionInShadowMap.z * (far - near));
+     *     float depth       = 2.0 * (distance - near) / (far - near) - 1.0;
+     *     vec2  warpedDepth = vec2(exp(5.0 * depth), -exp(-5.0 * depth));
+     *     vec2  minimumVariance = 2.5e-5 * warpedDepth * warpedDepth;
+     *     vec4  moments     = texture(shadowMoments, positionInShadowMap.xy);
+     *
+     *     return min(chebyshevUpperBound(moments.xy, warpedDepth.x, minimumVariance.x),
+     *                chebyshevUpperBound(moments.zw, warpedDepth.y, minimumVariance.y));
+     * }
+     * \endcode
+     * The exponent of 5 keeps the squared moments below 65504, the largest half float.
+     *
+     * Typical usage:
+     * \code
+     * // Draw the shadow casters into the depth texture, as before.
+     * shadowMap.update(depthTexture);
+     * glActiveTexture(GL_TEXTURE2);
+     * glBindTexture(GL_TEXTURE_2D, shadowMap.getTexture());
+     * // Draw the receivers.
+     * \endcode
+     *
+     * Requires GL_EXT_color_buffer_half_float or GL_EXT_color_buffer_float, see isSupported().
+     * Only available in OpenGL ES 3.0 builds.
+     */
+    class FilterableShadowMap
+    {
+    private:
+        GLsizei width;
+        GLsizei height;
+        float nearPlane;
+        float farPlane;
+
+        GLuint momentsTexture;
+        GLuint blurTexture;
+        GLuint momentsFramebuffer;
+        GLuint blurFramebuffer;
+        GLuint depthSampler;
+
+        GLuint horizontalProgram;
+        GLuint verticalProgram;
+        GLuint vertexArray;
+
+        MipmapGenerator mipmapGenerator;
+
+        /* Copying would leave two owners of the GL objects. */
+        FilterableShadowMap(const FilterableShadowMap &);
+        FilterableShadowMap &operator=(const FilterableShadowMap &);
+    public:
+        /**
+         * \brief Check that half float targets can be rendered to. Must be called with a current context.
+         */
+        static bool isSupported(void);
+
+        /**
+         * \brief Create the moments texture and the programs filling it. Must be called with a current context.
+         * \param[in] width Width of the moments texture. Half the width of the depth texture is usually enough,
+         *                  the blur hides the lower resolution.
+         * \param[in] height Height of the moments texture.
+         * \param[in] nearPlane Near plane of the perspective projection the depth was rendered with.
+         * \param[in] farPlane Far plane of the perspective projection the depth was rendered with.
+         */
+        FilterableShadowMap(GLsizei width, GLsizei height, float nearPlane, float farPlane);
+
+        /**
+         * \brief Delete the moments texture and the programs.
+         */
+        ~FilterableShadowMap(void);
+
+        /**
+         * \brief Convert a depth texture to blurred moments and rebuild their mipmaps.
+         *
+         * The depth texture is read through a sampler object of its own, so it keeps its comparison mode for the
+         * samples which still use it directly. The mipmaps are averaged by MipmapGenerator. Leaves framebuffer 0 bound,
+         * depth testing, culling and blending off, colour writes on, and texture unit 0 active with the moments texture
+         * bound to it. On OpenGL ES 3.0, where the levels are drawn, the scissor test is also left off.
+         * \param[in] depthTexture Depth texture of the shadow casters.
+         */
+        void update(GLuint depthTexture);
+
+        /**
+         * \brief The moments texture, RGBA16F with mipmaps, filtered trilinearly.
+         */
+        GLuint getTexture(void) const;
+    };
+}
+#endif /* FILTERABLESHADOWMAP_H */
@@ -0,0 +1,164 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef FONTATLAS_H
+#define FONTATLAS_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief A texture of signed distance fields of the glyphs of one or more bitmap fonts.
+     *
+     * Each glyph is upscaled and stored as the distance to its outline, 0.5 being on the outline and larger
+     * values inside, saturating spread texels away from it. Unlike the bitmap itself the field can be magnified
+     * or minified with linear filtering and still give a crisp edge, so one atlas serves every text size.
+     *
+     * Fonts are raw RGBA images in the layout of font.raw: glyphs on a grid, starting at the space character,
+     * with the glyph shape in the alpha channel and the first row at the top.
+     * All fonts are added before upload(), and then share a single texture so text in different fonts can be drawn together.
+     */
+    class FontAtlas
+    {
+    public:
+        /**
+         * \brief Where a glyph is in the atlas, including the padding of its distance field.
+         */
+        struct Glyph
+        {
+            float left;
+            float right;
+            float top;
+            float bottom;
+        };
+
+    private:
+        struct Font
+        {
+            int characterWidth;
+            int characterHeight;
+            int numberOfGlyphs;
+
+            /**
+             * \brief Row of the atlas the font starts at.
+             */
+            int firstRow;
+
+            /**
+             * \brief Distance field of the font, getCellWidth() * glyphsPerRow texels wide.
+             */
+            std::vector<unsigned char> field;
+        };
+
+        int upscale;
+        int spread;
+        int atlasWidth;
+        int atlasHeight;
+        std::vector<Font> fonts;
+        GLuint textureID;
+
+        /**
+         * \brief Columns of glyphs in each font, as in font.raw.
+         */
+        static const int glyphsPerRow = 32;
+
+        /**
+         * \brief Size of a padded glyph cell in atlas texels.
+         */
+        int getCellWidth(const Font &font) const;
+        int getCellHeight(const Font &font) const;
+
+    public:
+        /**
+         * \brief Create an empty atlas.
+         * \param[in] upscale Atlas texels per bitmap pixel in each dimension.
+         * \param[in] spread Distance in atlas texels at which the field saturates, the widest outline or glow possible.
+         */
+        FontAtlas(int upscale = 4, int spread = 4);
+
+        /**
+         * \brief Default destructor.
+         */
+        virtual ~FontAtlas(void);
+
+        /**
+         * \brief Generate the distance field of a bitmap font and add it to the atlas.
+         * \param[in] filename Path of the raw RGBA image.
+         * \param[in] width Width of the image in pixels.
+         * \param[in] height Height of the image in pixels.
+         * \param[in] characterWidth Width of a glyph in pixels.
+         * \param[in] characterHeight Height of a glyph in pixels.
+         * \return The index of the font, to pass to getGlyph().
+         */
+        int addBitmapFont(const char *filename, int width, int height, int characterWidth, int characterHeight);
+
+        /**
+         * \brief Create the texture from the fonts added so far. Must be called with a current context.
+         */
+        void upload(void);
+
+        /**
+         * \brief Look up where a character of a font is in the atlas.
+         * \param[in] font Index returned by addBitmapFont().
+         * \param[in] character Character to look up, characters the font has no glyph for give a space.
+         */
+        Glyph getGlyph(int font, char character) const;
+
+        /**
+         * \brief Width of a glyph over its height, not counting the padding.
+         */
+        float getAspectRatio(int font) const;
+
+        /**
+         * \brief Padding added on each side of a glyph, relative to the glyph height.
+         */
+        float getPadding(int font) const;
+
+        /**
+         * \brief Height of a glyph in atlas texels, not counting the padding.
+         */
+        int getGlyphHeight(int font) const;
+
+        /**
+         * \brief The spread given to the constructor.
+         */
+        int getSpread(void) const;
+
+        /**
+         * \brief Number of fonts added.
+         */
+        int getNumberOfFonts(void) const;
+
+        /**
+         * \brief The texture ID, 0 until upload() is called. The distance is in the alpha channel.
+         */
+        GLuint getTexture(void) const;
+    };
+}
+#endif /* FONTATLAS_H */
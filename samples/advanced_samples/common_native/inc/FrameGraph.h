@@ -0,0 +1,187 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef FRAMEGRAPH_H
+#define FRAMEGRAPH_H
+
+#include <GLES3/gl3.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Allocates the transient render targets of a frame, sharing textures between targets which are never needed at the same time.
+     *
+     * A sample declares its passes in the order it runs them, the targets they render to with write() and the ones
+     * they sample with read(). A target lives from the first pass using it to the last one, and compile() gives
+     * targets of the same size, format and filter whose lifetimes do not overlap the same texture, like a compiler
+     * giving variables the same register. Targets no pass uses get no texture at all, so the targets of the code paths
+     * a sample does not take are never allocated.
+     *
+     * The textures are kept in a pool when the graph is declared again, with clear() then the same calls, so a
+     * graph rebuilt every frame or every time a setting changes reuses them instead of reallocating. Textures no
+     * target of the last compile() uses stay in the pool until releaseUnusedTextures().
+     *
+     * Only transient targets belong in the graph: the first pass writing a target finds whatever another target left
+     * in its texture, and nothing past the last pass may read it. Textures read in later frames are created by the
+     * sample as usual. Typical usage:
+     * \code
+     * frameGraph.clear();
+     * int horizontal = frameGraph.addTarget("horizontal blur", width, height, GL_RGBA8, GL_LINEAR);
+     * int blurX = frameGraph.addPass("blur x");
+     * int blurY = frameGraph.addPass("blur y");
+     *
+     * frameGraph.write(blurX, horizontal);
+     * frameGraph.read(blurY, horizontal);
+     * frameGraph.compile();
+     *
+     * // Attach frameGraph.getTexture(horizontal) in blur x, sample it in blur y.
+     * \endcode
+     *
+     * The textures have a single level and clamp to their edges. They are recorded by GPUMemory under the owner
+     * tag, and deleted with the graph, which must happen with the context still current.
+     */
+    class FrameGraph
+    {
+    public:
+        /**
+         * \brief Create an empty graph.
+         * \param[in] owner Tag the textures are recorded under in GPUMemory. Must stay valid, a string literal typically.
+         */
+        FrameGraph(const char *owner);
+
+        /**
+         * \brief Delete all the textures of the pool.
+         */
+        ~FrameGraph(void);
+
+        /**
+         * \brief Forget the passes and targets, to declare the graph again. The textures stay in the pool.
+         */
+        void clear(void);
+
+        /**
+         * \brief Declare a transient render target.
+         * \param[in] name Name shown by log(). Must stay valid until the next clear().
+         * \param[in] width Width of the target.
+         * \param[in] height Height of the target.
+         * \param[in] internalFormat Sized internal format, colour or depth.
+         * \param[in] filter Minification and magnification filter, GL_LINEAR or GL_NEAREST.
+         * \return The handle of the target.
+         */
+        int addTarget(const char *name, GLsizei width, GLsizei height, GLenum internalFormat, GLenum filter);
+
+        /**
+         * \brief Declare the next pass. Passes run in the order they are added.
+         * \param[in] name Name shown in the error messages. Must stay valid until the next clear().
+         * \return The handle of the pass.
+         */
+        int addPass(const char *name);
+
+        /**
+         * \brief Declare that a pass renders to a target, as an attachment or an image.
+         */
+        void write(int pass, int target);
+
+        /**
+         * \brief Declare that a pass samples a target.
+         */
+        void read(int pass, int target);
+
+        /**
+         * \brief Give every used target a texture from the pool, creating the ones the pool is missing.
+         * \return False if a pass reads a target no earlier pass writes, or a handle is invalid. No texture is given then.
+         */
+        bool compile(void);
+
+        /**
+         * \brief Get the texture of a target, valid until the next compile().
+         * \return 0 if the target is not used by any pass, or the graph is not compiled.
+         */
+        GLuint getTexture(int target) const;
+
+        /**
+         * \brief Delete the textures of the pool which no target of the last compile() uses.
+         *
+         * They must not be attached to any framebuffer, or the framebuffer keeps them alive.
+         */
+        void releaseUnusedTextures(void);
+
+        /**
+         * \brief Bytes the used targets would take with a texture each.
+         */
+        size_t getDeclaredBytes(void) const;
+
+        /**
+         * \brief Bytes of all the textures of the pool.
+         */
+        size_t getAllocatedBytes(void) const;
+
+        /**
+         * \brief Print the texture of every target and the totals with LOGI.
+         */
+        void log(void) const;
+
+    private:
+        struct Target
+        {
+            const char *name;
+            GLsizei width;
+            GLsizei height;
+            GLenum internalFormat;
+            GLenum filter;
+            /* First and last pass using the target, -1 if none. */
+            int firstPass;
+            int lastPass;
+            /* First pass writing the target, -1 if none. */
+            int firstWrite;
+            int texture;
+        };
+
+        struct Texture
+        {
+            GLuint id;
+            GLsizei width;
+            GLsizei height;
+            GLenum internalFormat;
+            GLenum filter;
+            /* Last pass of the targets given the texture by the current compile(), -1 if none. */
+            int lastPass;
+        };
+
+        const char *owner;
+        std::vector<const char *> passes;
+        std::vector<Target> targets;
+        std::vector<Texture> pool;
+        bool compiled;
+        bool valid;
+
+        /**
+         * \brief Extend the lifetime of a target to a pass, checking the handles.
+         */
+        void use(int pass, int target, bool isWrite);
+
+        FrameGraph(const FrameGraph &);
+        FrameGraph &operator=(const FrameGraph &);
+    };
+}
+#endif /* FRAMEGRAPH_H */
@@ -0,0 +1,123 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <EGL/egl.h>
+#include <KHR/khrplatform.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Presents frames at a steady rate and measures how long they take to reach the display.
+     *
+     * On Android the swap is done by GLSurfaceView after each step, so the pacer works on the current
+     * display and draw surface: presentFrame() is called last in the frame and tells the compositor
+     * when the coming swap should be shown, using EGL_ANDROID_presentation_time. Frames are spaced a whole
+     * number of target periods apart, so a frame which is late is held for the next slot rather than shown
+     * as soon as it is ready, which trades a dropped frame for the judder of an uneven one.
+     * The swap interval is kept at 1 so the driver never blocks longer than one vsync on top of that.
+     *
+     * Without EGL_ANDROID_presentation_time the swap interval alone divides the display refresh rate.
+     *
+     * With EGL_ANDROID_get_frame_timestamps the time from presentFrame() to the frame being shown
+     * is read back a few frames later, so getLatency() reports submit to present latency.
+     */
+    class FramePacer
+    {
+    private:
+        /**
+         * \brief Number of frames whose timestamps can be waited on at once.
+         */
+        static const int numberOfPendingFrames = 8;
+
+        typedef khronos_int64_t Nanoseconds;
+        typedef khronos_uint64_t FrameId;
+        typedef EGLBoolean (EGLAPIENTRYP PresentationTimeFunction)(EGLDisplay display, EGLSurface surface, Nanoseconds time);
+        typedef EGLBoolean (EGLAPIENTRYP GetNextFrameIdFunction)(EGLDisplay display, EGLSurface surface, FrameId *frameId);
+        typedef EGLBoolean (EGLAPIENTRYP GetFrameTimestampsFunction)(EGLDisplay display, EGLSurface surface, FrameId frameId,
+                                                                     EGLint numberOfTimestamps, const EGLint *timestamps, Nanoseconds *values);
+
+        struct PendingFrame
+        {
+            FrameId id;
+            Nanoseconds submitTime;
+        };
+
+        EGLDisplay display;
+        EGLSurface surface;
+        PresentationTimeFunction presentationTime;
+        GetNextFrameIdFunction getNextFrameId;
+        GetFrameTimestampsFunction getFrameTimestamps;
+
+        int displayRefreshRate;
+        int targetRefreshRate;
+        Nanoseconds targetPeriod;
+        Nanoseconds lastPresentTime;
+
+        PendingFrame pendingFrames[numberOfPendingFrames];
+        int firstPendingFrame;
+        int numberOfPending;
+        float lastLatency;
+        float averageLatency;
+
+        /**
+         * \brief Read back the timestamps of the frames which have been shown since the last call.
+         */
+        void collectTimestamps(void);
+    public:
+        /**
+         * \brief Look up the extensions of the current display and set up pacing. Must be called with a current context.
+         * \param[in] targetRefreshRate Rate to present frames at, typically 30, 60, 90 or 120.
+         * \param[in] displayRefreshRate Refresh rate of the display, only used to pick a swap interval
+         *            when presentation times are not supported.
+         */
+        FramePacer(int targetRefreshRate, int displayRefreshRate = 60);
+
+        /**
+         * \brief Change the rate frames are presented at.
+         * \param[in] targetRefreshRate Rate to present frames at, clamped to the display refresh rate without presentation times.
+         */
+        void setTargetRefreshRate(int targetRefreshRate);
+
+        /**
+         * \brief Schedule the coming swap of the current surface. Call after the last draw of the frame.
+         */
+        void presentFrame(void);
+
+        /**
+         * \brief Whether presentation times are honoured, if not the pacing relies on the swap interval only.
+         */
+        bool isPresentationTimeSupported(void) const;
+
+        /**
+         * \brief Submit to present latency of the most recent frame which reached the display, in milliseconds.
+         * \return 0 until a frame is measured, or if EGL_ANDROID_get_frame_timestamps is not supported.
+         */
+        float getLatency(void) const;
+
+        /**
+         * \brief Smoothed submit to present latency of recent frames, in milliseconds.
+         */
+        float getAverageLatency(void) const;
+    };
+}
+#endif /* FRAMEPACER_H */
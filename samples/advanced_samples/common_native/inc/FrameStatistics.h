@@ -0,0 +1,119 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef FRAMESTATISTICS_H
+#define FRAMESTATISTICS_H
+
+#include "Timer.h"
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Records the time of each frame and reports percentiles, which show the stutters an average hides.
+     *
+     * The times of the most recent frames are kept in a ring buffer. A frame counts as janky when it takes
+     * more than twice the median; on a 60 Hz display such a frame is at least one missed vsync.
+     *
+     * Typical usage, once per frame:
+     * \code
+     * frameStatistics.frame();
+     * if (timer.isTimePassed(10.0f))
+     * {
+     *     frameStatistics.log("Scene");
+     * }
+     * \endcode
+     */
+    class FrameStatistics
+    {
+    private:
+        Timer timer;
+        long long lastFrameTime;
+        bool started;
+
+        std::vector<float> frameTimes;
+        size_t nextFrame;
+        size_t numberOfFrames;
+
+        /**
+         * \brief Copy of the recorded frame times, sorted.
+         */
+        void getSortedFrameTimes(std::vector<float> &sorted) const;
+
+        static float percentile(const std::vector<float> &sorted, float fraction);
+
+    public:
+        /**
+         * \brief Create an empty record.
+         * \param[in] capacity Number of most recent frames the statistics are computed over.
+         */
+        FrameStatistics(size_t capacity = 1024);
+
+        /**
+         * \brief Mark the end of a frame, recording the time since the previous call.
+         *
+         * The first call only starts the measurement.
+         */
+        void frame(void);
+
+        /**
+         * \brief Record the time of a frame measured elsewhere.
+         * \param[in] milliseconds The frame time in milliseconds.
+         */
+        void addFrameTime(float milliseconds);
+
+        /**
+         * \brief Forget the recorded frames, the next frame() starts a new measurement.
+         */
+        void reset(void);
+
+        /**
+         * \brief Number of frames the statistics are computed over.
+         */
+        size_t getNumberOfFrames(void) const;
+
+        /**
+         * \brief Frame time below which the given fraction of the recorded frames are, in milliseconds.
+         * \param[in] fraction 0.5 gives the median, 0.99 the 99th percentile.
+         * \return 0 if no frame is recorded.
+         */
+        float getPercentile(float fraction) const;
+
+        /**
+         * \brief Number of recorded frames longer than twice the median.
+         */
+        size_t getNumberOfJankyFrames(void) const;
+
+        /**
+         * \brief Print frame count, mean, p50, p95, p99, maximum and janky frames with LOGI.
+         * \param[in] name Printed at the start of the line, to tell several outputs apart.
+         */
+        void log(const char *name) const;
+
+        /**
+         * \brief Write the recorded frame times, oldest first, as CSV with a header line.
+         * \param[in] filename Path of the file, it is overwritten.
+         * \return False if the file cannot be written.
+         */
+        bool writeCSV(const char *filename) const;
+    };
+}
+#endif /* FRAMESTATISTICS_H */
@@ -0,0 +1,170 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef FRAMETIMEGRAPH_H
+#define FRAMETIMEGRAPH_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include "FramePacer.h"
+#include "Timer.h"
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Draws a rolling graph of the CPU time, GPU time and present latency of the most recent frames.
+     *
+     * Each line holds one point per frame, the newest on the right. Lines at 16.7 ms and 33.3 ms mark the
+     * 60 Hz and 30 Hz budgets. The whole graph is rebuilt every frame into one dynamic vertex buffer and
+     * drawn with a single glDrawArrays() call, so it costs the same whatever the sample draws.
+     *
+     * The CPU time is the time between beginFrame() and endFrame(). The GPU time comes from a Profiler scope
+     * around the same commands, so it is only measured once Profiler::initialize() has been called and
+     * GL_EXT_disjoint_timer_query supports timestamps; it reaches the graph a few frames late.
+     * The present latency is read from a FramePacer with EGL_ANDROID_get_frame_timestamps.
+     * Lines without results are not drawn.
+     *
+     * Typical usage:
+     * \code
+     * frameTimeGraph.beginFrame();
+     * ...
+     * frameTimeGraph.draw();
+     * text->draw();
+     * frameTimeGraph.endFrame(framePacer);
+     * \endcode
+     */
+    class FrameTimeGraph
+    {
+    public:
+        /**
+         * \brief The lines of the graph.
+         */
+        enum Line
+        {
+            LINE_CPU,
+            LINE_GPU,
+            LINE_PRESENT,
+            NUMBER_OF_LINES
+        };
+
+    private:
+        struct Vertex
+        {
+            GLfloat position[2];
+            GLubyte color[4];
+        };
+
+        int windowWidth;
+        int windowHeight;
+        int left;
+        int bottom;
+        int width;
+        int height;
+        float maximumMilliseconds;
+
+        Timer timer;
+        long long frameBegin;
+        bool frameOpen;
+
+        /**
+         * \brief Ring buffer of the times of each line, negative where there is no result.
+         */
+        std::vector<float> times[NUMBER_OF_LINES];
+        int numberOfFrames;
+        int nextFrame;
+        int recordedFrames;
+        float lastGPUTime;
+
+        std::vector<Vertex> vertices;
+        GLuint programID;
+        GLint iLocPosition;
+        GLint iLocColor;
+        GLuint vertexBuffer;
+
+        /**
+         * \brief Add a line from one point to another, in pixels.
+         */
+        void addLine(float x0, float y0, float x1, float y1, const GLubyte color[4]);
+
+    public:
+        /**
+         * \brief Build the shaders and buffer. Must be called with a current context.
+         * \param[in] windowWidth The width of the window in pixels.
+         * \param[in] windowHeight The height of the window in pixels.
+         * \param[in] numberOfFrames Number of frames shown across the graph.
+         * \param[in] maximumMilliseconds Time at the top of the graph, longer frames are clamped to it.
+         */
+        FrameTimeGraph(int windowWidth, int windowHeight, int numberOfFrames = 120, float maximumMilliseconds = 50.0f);
+
+        /**
+         * \brief Delete the shaders and buffer. Must be called with the context current.
+         */
+        virtual ~FrameTimeGraph(void);
+
+        /**
+         * \brief Move the graph. By default it covers the width of the window and a fifth of its height, at the top.
+         * \param[in] x The X position (in pixels) of the left of the graph.
+         * \param[in] y The Y position (in pixels) of the bottom of the graph, measured from the bottom of the screen.
+         * \param[in] width The width of the graph in pixels.
+         * \param[in] height The height of the graph in pixels.
+         */
+        void setRectangle(int x, int y, int width, int height);
+
+        /**
+         * \brief Start measuring a frame. Call before the first command of the frame.
+         */
+        void beginFrame(void);
+
+        /**
+         * \brief Stop measuring the frame and add its point to the lines. Call after the last command of the frame.
+         *
+         * Also calls Profiler::endFrame(), so the GPU time is collected even if the sample does not use the Profiler.
+         * \param[in] framePacer If not NULL, its latency is added to the present line.
+         */
+        void endFrame(const FramePacer *framePacer = NULL);
+
+        /**
+         * \brief Add the point of a frame measured elsewhere, instead of beginFrame() and endFrame().
+         * \param[in] cpuMilliseconds CPU time of the frame, negative if unknown.
+         * \param[in] gpuMilliseconds GPU time of the frame, negative if unknown.
+         * \param[in] presentMilliseconds Submit to present latency of the frame, negative if unknown.
+         */
+        void addFrame(float cpuMilliseconds, float gpuMilliseconds, float presentMilliseconds);
+
+        /**
+         * \brief Most recent time of a line in milliseconds, negative if there is no result yet.
+         */
+        float getLatest(Line line) const;
+
+        /**
+         * \brief Draw the graph over what has been drawn, without depth test. Leaves GL_ARRAY_BUFFER unbound.
+         */
+        void draw(void);
+    };
+}
+#endif /* FRAMETIMEGRAPH_H */
@@ -0,0 +1,85 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef FRUSTUMCULLING_H
+#define FRUSTUMCULLING_H
+
+namespace MaliSDK
+{
+    /**
+     * \brief Batched frustum tests for bounding volumes stored as structures of arrays.
+     *
+     * The planes are six (a, b, c, d) equations laid out as 24 consecutive floats, oriented so that
+     * a*x + b*y + c*z + d is positive on the inside of the frustum. The order of the planes does not matter.
+     * On NEON builds four volumes are tested per iteration, and a group stops testing planes as soon as all four are culled.
+     */
+    class FrustumCulling
+    {
+    public:
+        /**
+         * \brief Axis-aligned bounding boxes, one array per coordinate.
+         */
+        struct AABBBatch
+        {
+            const float *minX;
+            const float *minY;
+            const float *minZ;
+            const float *maxX;
+            const float *maxY;
+            const float *maxZ;
+        };
+
+        /**
+         * \brief Bounding spheres, one array per coordinate and one for the radius.
+         */
+        struct SphereBatch
+        {
+            const float *centerX;
+            const float *centerY;
+            const float *centerZ;
+            const float *radius;
+        };
+
+        /**
+         * \brief Test boxes against a frustum.
+         *
+         * A box is visible unless all eight corners are on or behind the same plane.
+         * \param[in] planes The six frustum planes.
+         * \param[in] boxes The boxes to test.
+         * \param[in] count Number of boxes.
+         * \param[out] visible Receives 1 for every box that intersects the frustum and 0 for every box that does not.
+         * \return The number of visible boxes.
+         */
+        static unsigned int testAABBs(const float *planes, const AABBBatch &boxes, unsigned int count, unsigned char *visible);
+
+        /**
+         * \brief Test spheres against a frustum.
+         *
+         * A sphere is visible unless its center is further than its radius behind one of the planes.
+         * \param[in] planes The six frustum planes, normalized so that the plane equation gives the distance.
+         * \param[in] spheres The spheres to test.
+         * \param[in] count Number of spheres.
+         * \param[out] visible Receives 1 for every sphere that intersects the frustum and 0 for every sphere that does not.
+         * \return The number of visible spheres.
+         */
+        static unsigned int testSpheres(const float *planes, const SphereBatch &spheres, unsigned int count, unsigned char *visible);
+    };
+}
+#endif /* FRUSTUMCULLING_H */
@@ -0,0 +1,261 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GLCALLCOUNTERS_H
+#define GLCALLCOUNTERS_H
+
+#include <cstddef>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Counts the OpenGL ES calls made each frame, to spot redundant driver work without a GPU debugger.
+     *
+     * Building with GL_CALL_COUNTERS defined (the GL_CALL_COUNTERS CMake option) replaces the draw, bind, uniform,
+     * state and upload entry points with macros which count the call before making it. Any call is counted,
+     * with GL_CHECK() or without. Call endFrame() once per frame, and show getLastFrame() or getLastFrameString()
+     * in the overlay. Without GL_CALL_COUNTERS nothing is counted and all counts stay 0.
+     *
+     * Only the thread rendering the frames is meant to make counted calls.
+     */
+    class GLCallCounters
+    {
+    public:
+        /**
+         * \brief Calls made during one frame.
+         */
+        struct Counts
+        {
+            /** glDraw*() calls. */
+            unsigned int drawCalls;
+            /** glDispatchCompute*() calls. */
+            unsigned int dispatches;
+            /** glBind*() and glUseProgram() calls. */
+            unsigned int binds;
+            /** glUniform*() and glProgramUniform*() calls. */
+            unsigned int uniforms;
+            /** Fixed function, vertex attribute and texture parameter changes. */
+            unsigned int stateChanges;
+            /** glBufferData() and glBufferSubData() calls. */
+            unsigned int bufferUploads;
+            /** Bytes passed to glBufferData() and glBufferSubData(). */
+            unsigned long long bufferUploadBytes;
+            /** glTexImage*() and glCompressedTexImage*() calls, sub images included. */
+            unsigned int textureUploads;
+        };
+
+        /**
+         * \brief Counts of the frame being recorded, the counting macros add to them.
+         */
+        static Counts current;
+
+        /**
+         * \brief Finish the frame being recorded, its counts become the last frame's.
+         */
+        static void endFrame(void);
+
+        /**
+         * \brief Counts of the frame finished by the last call to endFrame().
+         */
+        static const Counts &getLastFrame(void);
+
+        /**
+         * \brief The last frame's counts on one line, short enough for the Text overlay.
+         * \param[out] buffer The line is written here, always terminated.
+         * \param[in] size Size of buffer.
+         */
+        static void getLastFrameString(char *buffer, size_t size);
+
+    private:
+        static Counts lastFrame;
+    };
+}
+
+#if defined(GL_CALL_COUNTERS)
+
+/*
+ * The macros would also rename the prototypes of the headers included after them,
+ * so every header declaring the counted functions is included first.
+ */
+#include <GLES2/gl2.h>
+#if defined(ANDROID) || GLES_VERSION == 3
+#include <GLES3/gl31.h>
+#endif
+
+namespace MaliSDK
+{
+    /* Defined before the macros, so these make the real calls. Arguments are only evaluated once. */
+    inline void countedBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+    {
+        GLCallCounters::current.bufferUploads++;
+        GLCallCounters::current.bufferUploadBytes += size;
+        glBufferData(target, size, data, usage);
+    }
+
+    inline void countedBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+    {
+        GLCallCounters::current.bufferUploads++;
+        GLCallCounters::current.bufferUploadBytes += size;
+        glBufferSubData(target, offset, size, data);
+    }
+}
+
+/* By the rules of the preprocessor the call in the expansion of a macro is not expanded again, so it reaches the real function. */
+#define GL_CALL_COUNTERS_COUNT(counter, call) (MaliSDK::GLCallCounters::current.counter++, call)
+
+#define glBufferData(...) MaliSDK::countedBufferData(__VA_ARGS__)
+#define glBufferSubData(...) MaliSDK::countedBufferSubData(__VA_ARGS__)
+
+#define glDrawArrays(...) GL_CALL_COUNTERS_COUNT(drawCalls, glDrawArrays(__VA_ARGS__))
+#define glDrawElements(...) GL_CALL_COUNTERS_COUNT(drawCalls, glDrawElements(__VA_ARGS__))
+#define glBindBuffer(...) GL_CALL_COUNTERS_COUNT(binds, glBindBuffer(__VA_ARGS__))
+#define glBindTexture(...) GL_CALL_COUNTERS_COUNT(binds, glBindTexture(__VA_ARGS__))
+#define glBindFramebuffer(...) GL_CALL_COUNTERS_COUNT(binds, glBindFramebuffer(__VA_ARGS__))
+#define glBindRenderbuffer(...) GL_CALL_COUNTERS_COUNT(binds, glBindRenderbuffer(__VA_ARGS__))
+#define glUseProgram(...) GL_CALL_COUNTERS_COUNT(binds, glUseProgram(__VA_ARGS__))
+#define glUniform1f(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform1f(__VA_ARGS__))
+#define glUniform2f(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform2f(__VA_ARGS__))
+#define glUniform3f(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform3f(__VA_ARGS__))
+#define glUniform4f(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform4f(__VA_ARGS__))
+#define glUniform1i(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform1i(__VA_ARGS__))
+#define glUniform2i(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform2i(__VA_ARGS__))
+#define glUniform3i(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform3i(__VA_ARGS__))
+#define glUniform4i(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform4i(__VA_ARGS__))
+#define glUniform1fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform1fv(__VA_ARGS__))
+#define glUniform2fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform2fv(__VA_ARGS__))
+#define glUniform3fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform3fv(__VA_ARGS__))
+#define glUniform4fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform4fv(__VA_ARGS__))
+#define glUniform1iv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform1iv(__VA_ARGS__))
+#define glUniform2iv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform2iv(__VA_ARGS__))
+#define glUniform3iv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform3iv(__VA_ARGS__))
+#define glUniform4iv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform4iv(__VA_ARGS__))
+#define glUniformMatrix2fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniformMatrix2fv(__VA_ARGS__))
+#define glUniformMatrix3fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniformMatrix3fv(__VA_ARGS__))
+#define glUniformMatrix4fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniformMatrix4fv(__VA_ARGS__))
+#define glEnable(...) GL_CALL_COUNTERS_COUNT(stateChanges, glEnable(__VA_ARGS__))
+#define glDisable(...) GL_CALL_COUNTERS_COUNT(stateChanges, glDisable(__VA_ARGS__))
+#define glBlendFunc(...) GL_CALL_COUNTERS_COUNT(stateChanges, glBlendFunc(__VA_ARGS__))
+#define glBlendFuncSeparate(...) GL_CALL_COUNTERS_COUNT(stateChanges, glBlendFuncSeparate(__VA_ARGS__))
+#define glBlendEquation(...) GL_CALL_COUNTERS_COUNT(stateChanges, glBlendEquation(__VA_ARGS__))
+#define glBlendEquationSeparate(...) GL_CALL_COUNTERS_COUNT(stateChanges, glBlendEquationSeparate(__VA_ARGS__))
+#define glBlendColor(...) GL_CALL_COUNTERS_COUNT(stateChanges, glBlendColor(__VA_ARGS__))
+#define glColorMask(...) GL_CALL_COUNTERS_COUNT(stateChanges, glColorMask(__VA_ARGS__))
+#define glDepthFunc(...) GL_CALL_COUNTERS_COUNT(stateChanges, glDepthFunc(__VA_ARGS__))
+#define glDepthMask(...) GL_CALL_COUNTERS_COUNT(stateChanges, glDepthMask(__VA_ARGS__))
+#define glDepthRangef(...) GL_CALL_COUNTERS_COUNT(stateChanges, glDepthRangef(__VA_ARGS__))
+#define glCullFace(...) GL_CALL_COUNTERS_COUNT(stateChanges, glCullFace(__VA_ARGS__))
+#define glFrontFace(...) GL_CALL_COUNTERS_COUNT(stateChanges, glFrontFace(__VA_ARGS__))
+#define glPolygonOffset(...) GL_CALL_COUNTERS_COUNT(stateChanges, glPolygonOffset(__VA_ARGS__))
+#define glLineWidth(...) GL_CALL_COUNTERS_COUNT(stateChanges, glLineWidth(__VA_ARGS__))
+#define glScissor(...) GL_CALL_COUNTERS_COUNT(stateChanges, glScissor(__VA_ARGS__))
+#define glViewport(...) GL_CALL_COUNTERS_COUNT(stateChanges, glViewport(__VA_ARGS__))
+#define glStencilFunc(...) GL_CALL_COUNTERS_COUNT(stateChanges, glStencilFunc(__VA_ARGS__))
+#define glStencilFuncSeparate(...) GL_CALL_COUNTERS_COUNT(stateChanges, glStencilFuncSeparate(__VA_ARGS__))
+#define glStencilOp(...) GL_CALL_COUNTERS_COUNT(stateChanges, glStencilOp(__VA_ARGS__))
+#define glStencilOpSeparate(...) GL_CALL_COUNTERS_COUNT(stateChanges, glStencilOpSeparate(__VA_ARGS__))
+#define glStencilMask(...) GL_CALL_COUNTERS_COUNT(stateChanges, glStencilMask(__VA_ARGS__))
+#define glStencilMaskSeparate(...) GL_CALL_COUNTERS_COUNT(stateChanges, glStencilMaskSeparate(__VA_ARGS__))
+#define glClearColor(...) GL_CALL_COUNTERS_COUNT(stateChanges, glClearColor(__VA_ARGS__))
+#define glClearDepthf(...) GL_CALL_COUNTERS_COUNT(stateChanges, glClearDepthf(__VA_ARGS__))
+#define glClearStencil(...) GL_CALL_COUNTERS_COUNT(stateChanges, glClearStencil(__VA_ARGS__))
+#define glActiveTexture(...) GL_CALL_COUNTERS_COUNT(stateChanges, glActiveTexture(__VA_ARGS__))
+#define glPixelStorei(...) GL_CALL_COUNTERS_COUNT(stateChanges, glPixelStorei(__VA_ARGS__))
+#define glVertexAttribPointer(...) GL_CALL_COUNTERS_COUNT(stateChanges, glVertexAttribPointer(__VA_ARGS__))
+#define glEnableVertexAttribArray(...) GL_CALL_COUNTERS_COUNT(stateChanges, glEnableVertexAttribArray(__VA_ARGS__))
+#define glDisableVertexAttribArray(...) GL_CALL_COUNTERS_COUNT(stateChanges, glDisableVertexAttribArray(__VA_ARGS__))
+#define glTexParameteri(...) GL_CALL_COUNTERS_COUNT(stateChanges, glTexParameteri(__VA_ARGS__))
+#define glTexParameterf(...) GL_CALL_COUNTERS_COUNT(stateChanges, glTexParameterf(__VA_ARGS__))
+#define glTexImage2D(...) GL_CALL_COUNTERS_COUNT(textureUploads, glTexImage2D(__VA_ARGS__))
+#define glTexSubImage2D(...) GL_CALL_COUNTERS_COUNT(textureUploads, glTexSubImage2D(__VA_ARGS__))
+#define glCompressedTexImage2D(...) GL_CALL_COUNTERS_COUNT(textureUploads, glCompressedTexImage2D(__VA_ARGS__))
+#define glCompressedTexSubImage2D(...) GL_CALL_COUNTERS_COUNT(textureUploads, glCompressedTexSubImage2D(__VA_ARGS__))
+
+#if defined(ANDROID) || GLES_VERSION == 3
+#define glDrawArraysInstanced(...) GL_CALL_COUNTERS_COUNT(drawCalls, glDrawArraysInstanced(__VA_ARGS__))
+#define glDrawElementsInstanced(...) GL_CALL_COUNTERS_COUNT(drawCalls, glDrawElementsInstanced(__VA_ARGS__))
+#define glDrawRangeElements(...) GL_CALL_COUNTERS_COUNT(drawCalls, glDrawRangeElements(__VA_ARGS__))
+#define glDrawArraysIndirect(...) GL_CALL_COUNTERS_COUNT(drawCalls, glDrawArraysIndirect(__VA_ARGS__))
+#define glDrawElementsIndirect(...) GL_CALL_COUNTERS_COUNT(drawCalls, glDrawElementsIndirect(__VA_ARGS__))
+#define glDispatchCompute(...) GL_CALL_COUNTERS_COUNT(dispatches, glDispatchCompute(__VA_ARGS__))
+#define glDispatchComputeIndirect(...) GL_CALL_COUNTERS_COUNT(dispatches, glDispatchComputeIndirect(__VA_ARGS__))
+#define glBindBufferBase(...) GL_CALL_COUNTERS_COUNT(binds, glBindBufferBase(__VA_ARGS__))
+#define glBindBufferRange(...) GL_CALL_COUNTERS_COUNT(binds, glBindBufferRange(__VA_ARGS__))
+#define glBindVertexArray(...) GL_CALL_COUNTERS_COUNT(binds, glBindVertexArray(__VA_ARGS__))
+#define glBindSampler(...) GL_CALL_COUNTERS_COUNT(binds, glBindSampler(__VA_ARGS__))
+#define glBindTransformFeedback(...) GL_CALL_COUNTERS_COUNT(binds, glBindTransformFeedback(__VA_ARGS__))
+#define glBindImageTexture(...) GL_CALL_COUNTERS_COUNT(binds, glBindImageTexture(__VA_ARGS__))
+#define glBindProgramPipeline(...) GL_CALL_COUNTERS_COUNT(binds, glBindProgramPipeline(__VA_ARGS__))
+#define glUniform1ui(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform1ui(__VA_ARGS__))
+#define glUniform2ui(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform2ui(__VA_ARGS__))
+#define glUniform3ui(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform3ui(__VA_ARGS__))
+#define glUniform4ui(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform4ui(__VA_ARGS__))
+#define glUniform1uiv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform1uiv(__VA_ARGS__))
+#define glUniform2uiv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform2uiv(__VA_ARGS__))
+#define glUniform3uiv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform3uiv(__VA_ARGS__))
+#define glUniform4uiv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniform4uiv(__VA_ARGS__))
+#define glUniformMatrix2x3fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniformMatrix2x3fv(__VA_ARGS__))
+#define glUniformMatrix3x2fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniformMatrix3x2fv(__VA_ARGS__))
+#define glUniformMatrix2x4fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniformMatrix2x4fv(__VA_ARGS__))
+#define glUniformMatrix4x2fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniformMatrix4x2fv(__VA_ARGS__))
+#define glUniformMatrix3x4fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniformMatrix3x4fv(__VA_ARGS__))
+#define glUniformMatrix4x3fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glUniformMatrix4x3fv(__VA_ARGS__))
+#define glProgramUniform1f(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform1f(__VA_ARGS__))
+#define glProgramUniform2f(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform2f(__VA_ARGS__))
+#define glProgramUniform3f(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform3f(__VA_ARGS__))
+#define glProgramUniform4f(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform4f(__VA_ARGS__))
+#define glProgramUniform1i(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform1i(__VA_ARGS__))
+#define glProgramUniform2i(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform2i(__VA_ARGS__))
+#define glProgramUniform3i(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform3i(__VA_ARGS__))
+#define glProgramUniform4i(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform4i(__VA_ARGS__))
+#define glProgramUniform1ui(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform1ui(__VA_ARGS__))
+#define glProgramUniform2ui(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform2ui(__VA_ARGS__))
+#define glProgramUniform3ui(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform3ui(__VA_ARGS__))
+#define glProgramUniform4ui(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform4ui(__VA_ARGS__))
+#define glProgramUniform1fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform1fv(__VA_ARGS__))
+#define glProgramUniform2fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform2fv(__VA_ARGS__))
+#define glProgramUniform3fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform3fv(__VA_ARGS__))
+#define glProgramUniform4fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform4fv(__VA_ARGS__))
+#define glProgramUniform1iv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform1iv(__VA_ARGS__))
+#define glProgramUniform2iv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform2iv(__VA_ARGS__))
+#define glProgramUniform3iv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform3iv(__VA_ARGS__))
+#define glProgramUniform4iv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform4iv(__VA_ARGS__))
+#define glProgramUniform1uiv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform1uiv(__VA_ARGS__))
+#define glProgramUniform2uiv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform2uiv(__VA_ARGS__))
+#define glProgramUniform3uiv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform3uiv(__VA_ARGS__))
+#define glProgramUniform4uiv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniform4uiv(__VA_ARGS__))
+#define glProgramUniformMatrix2fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniformMatrix2fv(__VA_ARGS__))
+#define glProgramUniformMatrix3fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniformMatrix3fv(__VA_ARGS__))
+#define glProgramUniformMatrix4fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniformMatrix4fv(__VA_ARGS__))
+#define glProgramUniformMatrix2x3fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniformMatrix2x3fv(__VA_ARGS__))
+#define glProgramUniformMatrix3x2fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniformMatrix3x2fv(__VA_ARGS__))
+#define glProgramUniformMatrix2x4fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniformMatrix2x4fv(__VA_ARGS__))
+#define glProgramUniformMatrix4x2fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniformMatrix4x2fv(__VA_ARGS__))
+#define glProgramUniformMatrix3x4fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniformMatrix3x4fv(__VA_ARGS__))
+#define glProgramUniformMatrix4x3fv(...) GL_CALL_COUNTERS_COUNT(uniforms, glProgramUniformMatrix4x3fv(__VA_ARGS__))
+#define glVertexAttribIPointer(...) GL_CALL_COUNTERS_COUNT(stateChanges, glVertexAttribIPointer(__VA_ARGS__))
+#define glVertexAttribDivisor(...) GL_CALL_COUNTERS_COUNT(stateChanges, glVertexAttribDivisor(__VA_ARGS__))
+#define glTexImage3D(...) GL_CALL_COUNTERS_COUNT(textureUploads, glTexImage3D(__VA_ARGS__))
+#define glTexSubImage3D(...) GL_CALL_COUNTERS_COUNT(textureUploads, glTexSubImage3D(__VA_ARGS__))
+#define glCompressedTexImage3D(...) GL_CALL_COUNTERS_COUNT(textureUploads, glCompressedTexImage3D(__VA_ARGS__))
+#define glCompressedTexSubImage3D(...) GL_CALL_COUNTERS_COUNT(textureUploads, glCompressedTexSubImage3D(__VA_ARGS__))
+#endif
+
+#endif /* defined(GL_CALL_COUNTERS) */
+#endif /* GLCALLCOUNTERS_H */
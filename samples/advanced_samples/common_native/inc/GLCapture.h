@@ -0,0 +1,699 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GLCAPTURE_H
+#define GLCAPTURE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#if defined(GL_CAPTURE) && defined(GL_CALL_COUNTERS)
+#error "GL_CAPTURE and GL_CALL_COUNTERS both replace the OpenGL ES entry points, enable only one of them"
+#endif
+
+namespace MaliSDK
+{
+    /**
+     * \brief Records the OpenGL ES calls of a few frames to a file, so GLReplay can play them back without the sample.
+     *
+     * Building with GL_CAPTURE defined (the GL_CAPTURE CMake option) replaces the object, upload, shader, uniform,
+     * state, draw and compute entry points with macros which record the call before making it, like
+     * GLCallCounters does for counting. Whatever the sample computes on the CPU is gone from the file:
+     * only the commands and the contents of the buffers and textures are kept, so replaying measures
+     * the driver and the GPU alone, the same way on every run.
+     *
+     * Everything recorded from start() until endSetup() is the setup, the frames come after it. Start
+     * before the sample creates its objects, they are not read back from the context. Once the
+     * requested number of frames has ended the capture stops and the file is complete.
+     *
+     * Only the thread which called start() is recorded, and only calls made through the macros, that is
+     * from files including Platform.h or GLCapture.h. Entry points loaded with eglGetProcAddress() are not
+     * recorded, nor are client side vertex arrays, which are reported when used. Buffers written through
+     * glMapBufferRange() are recorded as glBufferSubData() of the mapped range when they are unmapped.
+     */
+    class GLCapture
+    {
+    public:
+        /**
+         * \brief Commands in a capture file.
+         *
+         * The file starts with a Header, followed by the commands. Each is a 32 bit Command and the
+         * 32 bit size of its arguments in bytes, then the arguments. Scalars are 32 bits, offsets, sizes
+         * and sync objects 64 bits, in the byte order of the device. Data is a 64 bit size followed
+         * by the bytes, padded to 4 bytes.
+         */
+        enum Command
+        {
+            CommandEndSetup = 1,
+            CommandEndFrame,
+
+            CommandGenBuffers,
+            CommandDeleteBuffers,
+            CommandGenTextures,
+            CommandDeleteTextures,
+            CommandGenFramebuffers,
+            CommandDeleteFramebuffers,
+            CommandGenRenderbuffers,
+            CommandDeleteRenderbuffers,
+            CommandGenVertexArrays,
+            CommandDeleteVertexArrays,
+            CommandGenSamplers,
+            CommandDeleteSamplers,
+
+            CommandBindBuffer,
+            CommandBindTexture,
+            CommandBindFramebuffer,
+            CommandBindRenderbuffer,
+            CommandBindVertexArray,
+            CommandBindSampler,
+            CommandBindBufferBase,
+            CommandBindBufferRange,
+            CommandBindImageTexture,
+
+            CommandBufferData,
+            CommandBufferSubData,
+            CommandCopyBufferSubData,
+            CommandTexImage2D,
+            CommandTexSubImage2D,
+            CommandCompressedTexImage2D,
+            CommandCompressedTexSubImage2D,
+            CommandTexImage3D,
+            CommandTexSubImage3D,
+            CommandCompressedTexImage3D,
+            CommandCompressedTexSubImage3D,
+            CommandTexStorage2D,
+            CommandTexStorage3D,
+            CommandGenerateMipmap,
+            CommandPixelStorei,
+            CommandTexParameteri,
+            CommandTexParameterf,
+            CommandSamplerParameteri,
+            CommandSamplerParameterf,
+
+            CommandFramebufferTexture2D,
+            CommandFramebufferTextureLayer,
+            CommandFramebufferRenderbuffer,
+            CommandRenderbufferStorage,
+            CommandRenderbufferStorageMultisample,
+            CommandDrawBuffers,
+            CommandReadBuffer,
+            CommandInvalidateFramebuffer,
+            CommandBlitFramebuffer,
+
+            CommandCreateShader,
+            CommandShaderSource,
+            CommandCompileShader,
+            CommandDeleteShader,
+            CommandCreateProgram,
+            CommandAttachShader,
+            CommandDetachShader,
+            CommandBindAttribLocation,
+            CommandLinkProgram,
+            CommandUseProgram,
+            CommandDeleteProgram,
+            CommandProgramParameteri,
+            CommandProgramBinary,
+            CommandGetUniformLocation,
+            CommandGetUniformBlockIndex,
+            CommandUniformBlockBinding,
+            CommandUniform,
+
+            CommandEnable,
+            CommandDisable,
+            CommandBlendFunc,
+            CommandBlendFuncSeparate,
+            CommandBlendEquation,
+            CommandBlendEquationSeparate,
+            CommandBlendColor,
+            CommandColorMask,
+            CommandDepthFunc,
+            CommandDepthMask,
+            CommandDepthRangef,
+            CommandCullFace,
+            CommandFrontFace,
+            CommandPolygonOffset,
+            CommandLineWidth,
+            CommandScissor,
+            CommandViewport,
+            CommandStencilFunc,
+            CommandStencilFuncSeparate,
+            CommandStencilOp,
+            CommandStencilOpSeparate,
+            CommandStencilMask,
+            CommandStencilMaskSeparate,
+            CommandClearColor,
+            CommandClearDepthf,
+            CommandClearStencil,
+            CommandActiveTexture,
+
+            CommandVertexAttribPointer,
+            CommandVertexAttribIPointer,
+            CommandEnableVertexAttribArray,
+            CommandDisableVertexAttribArray,
+            CommandVertexAttribDivisor,
+
+            CommandClear,
+            CommandClearBufferfv,
+            CommandClearBufferiv,
+            CommandClearBufferuiv,
+            CommandDrawArrays,
+            CommandDrawArraysInstanced,
+            CommandDrawElements,
+            CommandDrawElementsInstanced,
+            CommandDrawRangeElements,
+            CommandDrawArraysIndirect,
+            CommandDrawElementsIndirect,
+            CommandDispatchCompute,
+            CommandDispatchComputeIndirect,
+            CommandMemoryBarrier,
+
+            CommandFenceSync,
+            CommandDeleteSync,
+            CommandWaitSync,
+            CommandClientWaitSync,
+            CommandFlush,
+            CommandFinish
+        };
+
+        /**
+         * \brief Values of CommandUniform, which records every glUniform*() and glProgramUniform*() call.
+         */
+        enum UniformType
+        {
+            UniformFloat,
+            UniformInt,
+            UniformUnsignedInt
+        };
+
+        /**
+         * \brief How the data of a command which can read from a buffer object is stored.
+         *
+         * Pixels with a GL_PIXEL_UNPACK_BUFFER bound, indices with a GL_ELEMENT_ARRAY_BUFFER bound,
+         * are an offset into the buffer. Otherwise the data itself is in the file.
+         */
+        enum Source
+        {
+            SourceNone,
+            SourceData,
+            SourceOffset
+        };
+
+        /**
+         * \brief Start of a capture file.
+         */
+        struct Header
+        {
+            /** "GLCP". */
+            char magic[4];
+            /** version of the file format. */
+            unsigned int version;
+            /** Size of the surface the frames were drawn to. */
+            unsigned int width;
+            unsigned int height;
+            /** GLES_VERSION the sample was built for. */
+            unsigned int glesVersion;
+        };
+
+        /**
+         * \brief The version written to new files.
+         */
+        static const unsigned int version = 1;
+
+        /**
+         * \brief Start recording the calls of the current thread.
+         *
+         * \param[in] path The capture file to write.
+         * \param[in] width Width of the surface, for the replay.
+         * \param[in] height Height of the surface, for the replay.
+         * \param[in] frames Number of frames to record after endSetup().
+         * \return False if already capturing, if the file could not be opened or if the build has no GL_CAPTURE.
+         */
+        static bool start(const char *path, int width, int height, unsigned int frames);
+
+        /**
+         * \brief End the setup, the calls made from now on belong to the first frame.
+         */
+        static void endSetup(void);
+
+        /**
+         * \brief End the frame being recorded. Does nothing during the setup.
+         *
+         * The capture stops after the last frame.
+         */
+        static void endFrame(void);
+
+        /**
+         * \brief Finish the file and stop recording.
+         */
+        static void stop(void);
+
+        /**
+         * \brief Whether the calls of the current thread are being recorded.
+         */
+        static bool isCapturing(void);
+
+        /* Used by the recording functions. A command is written to the file at end(). */
+        static void begin(Command command);
+        static void writeUint(unsigned int value);
+        static void writeInt(int value);
+        static void writeFloat(float value);
+        static void writeUint64(unsigned long long value);
+        static void writeData(const void *data, size_t size);
+        static void end(void);
+
+    private:
+        static void writeBytes(const void *data, size_t size);
+
+        static FILE *file;
+        static bool capturing;
+        static bool inSetup;
+        static unsigned int remainingFrames;
+        static std::vector<unsigned char> command;
+    };
+}
+
+#if defined(GL_CAPTURE)
+
+/*
+ * The macros would also rename the prototypes of the headers included after them,
+ * so every header declaring the recorded functions is included first.
+ */
+#include <GLES2/gl2.h>
+#if GLES_VERSION == 3
+#include <GLES3/gl31.h>
+#endif
+
+namespace MaliSDK
+{
+    /**
+     * \brief Record the call if GLCapture is capturing, then make it.
+     *
+     * Declared before the macros, GLCapture.cpp defines them with GL_CAPTURE_IMPLEMENTATION so the macros are left out.
+     */
+    namespace GLCaptured
+    {
+        void glGenBuffers(GLsizei n, GLuint *buffers);
+        void glDeleteBuffers(GLsizei n, const GLuint *buffers);
+        void glGenTextures(GLsizei n, GLuint *textures);
+        void glDeleteTextures(GLsizei n, const GLuint *textures);
+        void glGenFramebuffers(GLsizei n, GLuint *framebuffers);
+        void glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers);
+        void glGenRenderbuffers(GLsizei n, GLuint *renderbuffers);
+        void glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers);
+        void glBindBuffer(GLenum target, GLuint buffer);
+        void glBindTexture(GLenum target, GLuint texture);
+        void glBindFramebuffer(GLenum target, GLuint framebuffer);
+        void glBindRenderbuffer(GLenum target, GLuint renderbuffer);
+        void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+        void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
+        void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels);
+        void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels);
+        void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data);
+        void glCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void *data);
+        void glGenerateMipmap(GLenum target);
+        void glPixelStorei(GLenum pname, GLint param);
+        void glTexParameteri(GLenum target, GLenum pname, GLint param);
+        void glTexParameterf(GLenum target, GLenum pname, GLfloat param);
+        void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+        void glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+        void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+        GLuint glCreateShader(GLenum type);
+        void glShaderSource(GLuint shader, GLsizei count, const GLchar *const*string, const GLint *length);
+        void glCompileShader(GLuint shader);
+        void glDeleteShader(GLuint shader);
+        GLuint glCreateProgram(void);
+        void glAttachShader(GLuint program, GLuint shader);
+        void glDetachShader(GLuint program, GLuint shader);
+        void glBindAttribLocation(GLuint program, GLuint index, const GLchar *name);
+        void glLinkProgram(GLuint program);
+        void glUseProgram(GLuint program);
+        void glDeleteProgram(GLuint program);
+        GLint glGetUniformLocation(GLuint program, const GLchar *name);
+        void glUniform1f(GLint location, GLfloat v0);
+        void glUniform2f(GLint location, GLfloat v0, GLfloat v1);
+        void glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+        void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+        void glUniform1i(GLint location, GLint v0);
+        void glUniform2i(GLint location, GLint v0, GLint v1);
+        void glUniform3i(GLint location, GLint v0, GLint v1, GLint v2);
+        void glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3);
+        void glUniform1fv(GLint location, GLsizei count, const GLfloat *value);
+        void glUniform2fv(GLint location, GLsizei count, const GLfloat *value);
+        void glUniform3fv(GLint location, GLsizei count, const GLfloat *value);
+        void glUniform4fv(GLint location, GLsizei count, const GLfloat *value);
+        void glUniform1iv(GLint location, GLsizei count, const GLint *value);
+        void glUniform2iv(GLint location, GLsizei count, const GLint *value);
+        void glUniform3iv(GLint location, GLsizei count, const GLint *value);
+        void glUniform4iv(GLint location, GLsizei count, const GLint *value);
+        void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glEnable(GLenum cap);
+        void glDisable(GLenum cap);
+        void glBlendFunc(GLenum sfactor, GLenum dfactor);
+        void glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha);
+        void glBlendEquation(GLenum mode);
+        void glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha);
+        void glBlendColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+        void glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+        void glDepthFunc(GLenum func);
+        void glDepthMask(GLboolean flag);
+        void glDepthRangef(GLfloat n, GLfloat f);
+        void glCullFace(GLenum mode);
+        void glFrontFace(GLenum mode);
+        void glPolygonOffset(GLfloat factor, GLfloat units);
+        void glLineWidth(GLfloat width);
+        void glScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+        void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+        void glStencilFunc(GLenum func, GLint ref, GLuint mask);
+        void glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask);
+        void glStencilOp(GLenum fail, GLenum zfail, GLenum zpass);
+        void glStencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass);
+        void glStencilMask(GLuint mask);
+        void glStencilMaskSeparate(GLenum face, GLuint mask);
+        void glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+        void glClearDepthf(GLfloat d);
+        void glClearStencil(GLint s);
+        void glActiveTexture(GLenum texture);
+        void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer);
+        void glEnableVertexAttribArray(GLuint index);
+        void glDisableVertexAttribArray(GLuint index);
+        void glClear(GLbitfield mask);
+        void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+        void glDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices);
+        void glFlush(void);
+        void glFinish(void);
+#if GLES_VERSION == 3
+        void glGenVertexArrays(GLsizei n, GLuint *arrays);
+        void glDeleteVertexArrays(GLsizei n, const GLuint *arrays);
+        void glGenSamplers(GLsizei count, GLuint *samplers);
+        void glDeleteSamplers(GLsizei count, const GLuint *samplers);
+        void glBindVertexArray(GLuint array);
+        void glBindSampler(GLuint unit, GLuint sampler);
+        void glBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+        void glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+        void glBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+        void glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+        void * glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+        GLboolean glUnmapBuffer(GLenum target);
+        void glTexImage3D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void *pixels);
+        void glTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels);
+        void glCompressedTexImage3D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const void *data);
+        void glCompressedTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const void *data);
+        void glTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+        void glTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+        void glSamplerParameteri(GLuint sampler, GLenum pname, GLint param);
+        void glSamplerParameterf(GLuint sampler, GLenum pname, GLfloat param);
+        void glFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer);
+        void glRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
+        void glDrawBuffers(GLsizei n, const GLenum *bufs);
+        void glReadBuffer(GLenum src);
+        void glInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments);
+        void glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+        GLuint glGetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName);
+        void glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+        void glProgramParameteri(GLuint program, GLenum pname, GLint value);
+        void glProgramBinary(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+        void glUniform1ui(GLint location, GLuint v0);
+        void glUniform2ui(GLint location, GLuint v0, GLuint v1);
+        void glUniform3ui(GLint location, GLuint v0, GLuint v1, GLuint v2);
+        void glUniform4ui(GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3);
+        void glUniform1uiv(GLint location, GLsizei count, const GLuint *value);
+        void glUniform2uiv(GLint location, GLsizei count, const GLuint *value);
+        void glUniform3uiv(GLint location, GLsizei count, const GLuint *value);
+        void glUniform4uiv(GLint location, GLsizei count, const GLuint *value);
+        void glUniformMatrix2x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glUniformMatrix3x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glUniformMatrix2x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glUniformMatrix4x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glUniformMatrix3x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glProgramUniform1f(GLuint program, GLint location, GLfloat v0);
+        void glProgramUniform2f(GLuint program, GLint location, GLfloat v0, GLfloat v1);
+        void glProgramUniform3f(GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+        void glProgramUniform4f(GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+        void glProgramUniform1i(GLuint program, GLint location, GLint v0);
+        void glProgramUniform2i(GLuint program, GLint location, GLint v0, GLint v1);
+        void glProgramUniform3i(GLuint program, GLint location, GLint v0, GLint v1, GLint v2);
+        void glProgramUniform4i(GLuint program, GLint location, GLint v0, GLint v1, GLint v2, GLint v3);
+        void glProgramUniform1ui(GLuint program, GLint location, GLuint v0);
+        void glProgramUniform2ui(GLuint program, GLint location, GLuint v0, GLuint v1);
+        void glProgramUniform3ui(GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2);
+        void glProgramUniform4ui(GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3);
+        void glProgramUniform1fv(GLuint program, GLint location, GLsizei count, const GLfloat *value);
+        void glProgramUniform2fv(GLuint program, GLint location, GLsizei count, const GLfloat *value);
+        void glProgramUniform3fv(GLuint program, GLint location, GLsizei count, const GLfloat *value);
+        void glProgramUniform4fv(GLuint program, GLint location, GLsizei count, const GLfloat *value);
+        void glProgramUniform1iv(GLuint program, GLint location, GLsizei count, const GLint *value);
+        void glProgramUniform2iv(GLuint program, GLint location, GLsizei count, const GLint *value);
+        void glProgramUniform3iv(GLuint program, GLint location, GLsizei count, const GLint *value);
+        void glProgramUniform4iv(GLuint program, GLint location, GLsizei count, const GLint *value);
+        void glProgramUniform1uiv(GLuint program, GLint location, GLsizei count, const GLuint *value);
+        void glProgramUniform2uiv(GLuint program, GLint location, GLsizei count, const GLuint *value);
+        void glProgramUniform3uiv(GLuint program, GLint location, GLsizei count, const GLuint *value);
+        void glProgramUniform4uiv(GLuint program, GLint location, GLsizei count, const GLuint *value);
+        void glProgramUniformMatrix2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glProgramUniformMatrix3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glProgramUniformMatrix4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glProgramUniformMatrix2x3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glProgramUniformMatrix3x2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glProgramUniformMatrix2x4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glProgramUniformMatrix4x2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glProgramUniformMatrix3x4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glProgramUniformMatrix4x3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer);
+        void glVertexAttribDivisor(GLuint index, GLuint divisor);
+        void glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat *value);
+        void glClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint *value);
+        void glClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint *value);
+        void glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+        void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount);
+        void glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices);
+        void glDrawArraysIndirect(GLenum mode, const void *indirect);
+        void glDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect);
+        void glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+        void glDispatchComputeIndirect(GLintptr indirect);
+        void glMemoryBarrier(GLbitfield barriers);
+        GLsync glFenceSync(GLenum condition, GLbitfield flags);
+        void glDeleteSync(GLsync sync);
+        void glWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+        GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+#endif
+    }
+}
+
+#if !defined(GL_CAPTURE_IMPLEMENTATION)
+
+/* By the rules of the preprocessor the name in the expansion of a macro is not expanded again. */
+#define glGenBuffers(...) MaliSDK::GLCaptured::glGenBuffers(__VA_ARGS__)
+#define glDeleteBuffers(...) MaliSDK::GLCaptured::glDeleteBuffers(__VA_ARGS__)
+#define glGenTextures(...) MaliSDK::GLCaptured::glGenTextures(__VA_ARGS__)
+#define glDeleteTextures(...) MaliSDK::GLCaptured::glDeleteTextures(__VA_ARGS__)
+#define glGenFramebuffers(...) MaliSDK::GLCaptured::glGenFramebuffers(__VA_ARGS__)
+#define glDeleteFramebuffers(...) MaliSDK::GLCaptured::glDeleteFramebuffers(__VA_ARGS__)
+#define glGenRenderbuffers(...) MaliSDK::GLCaptured::glGenRenderbuffers(__VA_ARGS__)
+#define glDeleteRenderbuffers(...) MaliSDK::GLCaptured::glDeleteRenderbuffers(__VA_ARGS__)
+#define glBindBuffer(...) MaliSDK::GLCaptured::glBindBuffer(__VA_ARGS__)
+#define glBindTexture(...) MaliSDK::GLCaptured::glBindTexture(__VA_ARGS__)
+#define glBindFramebuffer(...) MaliSDK::GLCaptured::glBindFramebuffer(__VA_ARGS__)
+#define glBindRenderbuffer(...) MaliSDK::GLCaptured::glBindRenderbuffer(__VA_ARGS__)
+#define glBufferData(...) MaliSDK::GLCaptured::glBufferData(__VA_ARGS__)
+#define glBufferSubData(...) MaliSDK::GLCaptured::glBufferSubData(__VA_ARGS__)
+#define glTexImage2D(...) MaliSDK::GLCaptured::glTexImage2D(__VA_ARGS__)
+#define glTexSubImage2D(...) MaliSDK::GLCaptured::glTexSubImage2D(__VA_ARGS__)
+#define glCompressedTexImage2D(...) MaliSDK::GLCaptured::glCompressedTexImage2D(__VA_ARGS__)
+#define glCompressedTexSubImage2D(...) MaliSDK::GLCaptured::glCompressedTexSubImage2D(__VA_ARGS__)
+#define glGenerateMipmap(...) MaliSDK::GLCaptured::glGenerateMipmap(__VA_ARGS__)
+#define glPixelStorei(...) MaliSDK::GLCaptured::glPixelStorei(__VA_ARGS__)
+#define glTexParameteri(...) MaliSDK::GLCaptured::glTexParameteri(__VA_ARGS__)
+#define glTexParameterf(...) MaliSDK::GLCaptured::glTexParameterf(__VA_ARGS__)
+#define glFramebufferTexture2D(...) MaliSDK::GLCaptured::glFramebufferTexture2D(__VA_ARGS__)
+#define glFramebufferRenderbuffer(...) MaliSDK::GLCaptured::glFramebufferRenderbuffer(__VA_ARGS__)
+#define glRenderbufferStorage(...) MaliSDK::GLCaptured::glRenderbufferStorage(__VA_ARGS__)
+#define glCreateShader(...) MaliSDK::GLCaptured::glCreateShader(__VA_ARGS__)
+#define glShaderSource(...) MaliSDK::GLCaptured::glShaderSource(__VA_ARGS__)
+#define glCompileShader(...) MaliSDK::GLCaptured::glCompileShader(__VA_ARGS__)
+#define glDeleteShader(...) MaliSDK::GLCaptured::glDeleteShader(__VA_ARGS__)
+#define glCreateProgram(...) MaliSDK::GLCaptured::glCreateProgram(__VA_ARGS__)
+#define glAttachShader(...) MaliSDK::GLCaptured::glAttachShader(__VA_ARGS__)
+#define glDetachShader(...) MaliSDK::GLCaptured::glDetachShader(__VA_ARGS__)
+#define glBindAttribLocation(...) MaliSDK::GLCaptured::glBindAttribLocation(__VA_ARGS__)
+#define glLinkProgram(...) MaliSDK::GLCaptured::glLinkProgram(__VA_ARGS__)
+#define glUseProgram(...) MaliSDK::GLCaptured::glUseProgram(__VA_ARGS__)
+#define glDeleteProgram(...) MaliSDK::GLCaptured::glDeleteProgram(__VA_ARGS__)
+#define glGetUniformLocation(...) MaliSDK::GLCaptured::glGetUniformLocation(__VA_ARGS__)
+#define glUniform1f(...) MaliSDK::GLCaptured::glUniform1f(__VA_ARGS__)
+#define glUniform2f(...) MaliSDK::GLCaptured::glUniform2f(__VA_ARGS__)
+#define glUniform3f(...) MaliSDK::GLCaptured::glUniform3f(__VA_ARGS__)
+#define glUniform4f(...) MaliSDK::GLCaptured::glUniform4f(__VA_ARGS__)
+#define glUniform1i(...) MaliSDK::GLCaptured::glUniform1i(__VA_ARGS__)
+#define glUniform2i(...) MaliSDK::GLCaptured::glUniform2i(__VA_ARGS__)
+#define glUniform3i(...) MaliSDK::GLCaptured::glUniform3i(__VA_ARGS__)
+#define glUniform4i(...) MaliSDK::GLCaptured::glUniform4i(__VA_ARGS__)
+#define glUniform1fv(...) MaliSDK::GLCaptured::glUniform1fv(__VA_ARGS__)
+#define glUniform2fv(...) MaliSDK::GLCaptured::glUniform2fv(__VA_ARGS__)
+#define glUniform3fv(...) MaliSDK::GLCaptured::glUniform3fv(__VA_ARGS__)
+#define glUniform4fv(...) MaliSDK::GLCaptured::glUniform4fv(__VA_ARGS__)
+#define glUniform1iv(...) MaliSDK::GLCaptured::glUniform1iv(__VA_ARGS__)
+#define glUniform2iv(...) MaliSDK::GLCaptured::glUniform2iv(__VA_ARGS__)
+#define glUniform3iv(...) MaliSDK::GLCaptured::glUniform3iv(__VA_ARGS__)
+#define glUniform4iv(...) MaliSDK::GLCaptured::glUniform4iv(__VA_ARGS__)
+#define glUniformMatrix2fv(...) MaliSDK::GLCaptured::glUniformMatrix2fv(__VA_ARGS__)
+#define glUniformMatrix3fv(...) MaliSDK::GLCaptured::glUniformMatrix3fv(__VA_ARGS__)
+#define glUniformMatrix4fv(...) MaliSDK::GLCaptured::glUniformMatrix4fv(__VA_ARGS__)
+#define glEnable(...) MaliSDK::GLCaptured::glEnable(__VA_ARGS__)
+#define glDisable(...) MaliSDK::GLCaptured::glDisable(__VA_ARGS__)
+#define glBlendFunc(...) MaliSDK::GLCaptured::glBlendFunc(__VA_ARGS__)
+#define glBlendFuncSeparate(...) MaliSDK::GLCaptured::glBlendFuncSeparate(__VA_ARGS__)
+#define glBlendEquation(...) MaliSDK::GLCaptured::glBlendEquation(__VA_ARGS__)
+#define glBlendEquationSeparate(...) MaliSDK::GLCaptured::glBlendEquationSeparate(__VA_ARGS__)
+#define glBlendColor(...) MaliSDK::GLCaptured::glBlendColor(__VA_ARGS__)
+#define glColorMask(...) MaliSDK::GLCaptured::glColorMask(__VA_ARGS__)
+#define glDepthFunc(...) MaliSDK::GLCaptured::glDepthFunc(__VA_ARGS__)
+#define glDepthMask(...) MaliSDK::GLCaptured::glDepthMask(__VA_ARGS__)
+#define glDepthRangef(...) MaliSDK::GLCaptured::glDepthRangef(__VA_ARGS__)
+#define glCullFace(...) MaliSDK::GLCaptured::glCullFace(__VA_ARGS__)
+#define glFrontFace(...) MaliSDK::GLCaptured::glFrontFace(__VA_ARGS__)
+#define glPolygonOffset(...) MaliSDK::GLCaptured::glPolygonOffset(__VA_ARGS__)
+#define glLineWidth(...) MaliSDK::GLCaptured::glLineWidth(__VA_ARGS__)
+#define glScissor(...) MaliSDK::GLCaptured::glScissor(__VA_ARGS__)
+#define glViewport(...) MaliSDK::GLCaptured::glViewport(__VA_ARGS__)
+#define glStencilFunc(...) MaliSDK::GLCaptured::glStencilFunc(__VA_ARGS__)
+#define glStencilFuncSeparate(...) MaliSDK::GLCaptured::glStencilFuncSeparate(__VA_ARGS__)
+#define glStencilOp(...) MaliSDK::GLCaptured::glStencilOp(__VA_ARGS__)
+#define glStencilOpSeparate(...) MaliSDK::GLCaptured::glStencilOpSeparate(__VA_ARGS__)
+#define glStencilMask(...) MaliSDK::GLCaptured::glStencilMask(__VA_ARGS__)
+#define glStencilMaskSeparate(...) MaliSDK::GLCaptured::glStencilMaskSeparate(__VA_ARGS__)
+#define glClearColor(...) MaliSDK::GLCaptured::glClearColor(__VA_ARGS__)
+#define glClearDepthf(...) MaliSDK::GLCaptured::glClearDepthf(__VA_ARGS__)
+#define glClearStencil(...) MaliSDK::GLCaptured::glClearStencil(__VA_ARGS__)
+#define glActiveTexture(...) MaliSDK::GLCaptured::glActiveTexture(__VA_ARGS__)
+#define glVertexAttribPointer(...) MaliSDK::GLCaptured::glVertexAttribPointer(__VA_ARGS__)
+#define glEnableVertexAttribArray(...) MaliSDK::GLCaptured::glEnableVertexAttribArray(__VA_ARGS__)
+#define glDisableVertexAttribArray(...) MaliSDK::GLCaptured::glDisableVertexAttribArray(__VA_ARGS__)
+#define glClear(...) MaliSDK::GLCaptured::glClear(__VA_ARGS__)
+#define glDrawArrays(...) MaliSDK::GLCaptured::glDrawArrays(__VA_ARGS__)
+#define glDrawElements(...) MaliSDK::GLCaptured::glDrawElements(__VA_ARGS__)
+#define glFlush(...) MaliSDK::GLCaptured::glFlush(__VA_ARGS__)
+#define glFinish(...) MaliSDK::GLCaptured::glFinish(__VA_ARGS__)
+
+#if GLES_VERSION == 3
+#define glGenVertexArrays(...) MaliSDK::GLCaptured::glGenVertexArrays(__VA_ARGS__)
+#define glDeleteVertexArrays(...) MaliSDK::GLCaptured::glDeleteVertexArrays(__VA_ARGS__)
+#define glGenSamplers(...) MaliSDK::GLCaptured::glGenSamplers(__VA_ARGS__)
+#define glDeleteSamplers(...) MaliSDK::GLCaptured::glDeleteSamplers(__VA_ARGS__)
+#define glBindVertexArray(...) MaliSDK::GLCaptured::glBindVertexArray(__VA_ARGS__)
+#define glBindSampler(...) MaliSDK::GLCaptured::glBindSampler(__VA_ARGS__)
+#define glBindBufferBase(...) MaliSDK::GLCaptured::glBindBufferBase(__VA_ARGS__)
+#define glBindBufferRange(...) MaliSDK::GLCaptured::glBindBufferRange(__VA_ARGS__)
+#define glBindImageTexture(...) MaliSDK::GLCaptured::glBindImageTexture(__VA_ARGS__)
+#define glCopyBufferSubData(...) MaliSDK::GLCaptured::glCopyBufferSubData(__VA_ARGS__)
+#define glMapBufferRange(...) MaliSDK::GLCaptured::glMapBufferRange(__VA_ARGS__)
+#define glUnmapBuffer(...) MaliSDK::GLCaptured::glUnmapBuffer(__VA_ARGS__)
+#define glTexImage3D(...) MaliSDK::GLCaptured::glTexImage3D(__VA_ARGS__)
+#define glTexSubImage3D(...) MaliSDK::GLCaptured::glTexSubImage3D(__VA_ARGS__)
+#define glCompressedTexImage3D(...) MaliSDK::GLCaptured::glCompressedTexImage3D(__VA_ARGS__)
+#define glCompressedTexSubImage3D(...) MaliSDK::GLCaptured::glCompressedTexSubImage3D(__VA_ARGS__)
+#define glTexStorage2D(...) MaliSDK::GLCaptured::glTexStorage2D(__VA_ARGS__)
+#define glTexStorage3D(...) MaliSDK::GLCaptured::glTexStorage3D(__VA_ARGS__)
+#define glSamplerParameteri(...) MaliSDK::GLCaptured::glSamplerParameteri(__VA_ARGS__)
+#define glSamplerParameterf(...) MaliSDK::GLCaptured::glSamplerParameterf(__VA_ARGS__)
+#define glFramebufferTextureLayer(...) MaliSDK::GLCaptured::glFramebufferTextureLayer(__VA_ARGS__)
+#define glRenderbufferStorageMultisample(...) MaliSDK::GLCaptured::glRenderbufferStorageMultisample(__VA_ARGS__)
+#define glDrawBuffers(...) MaliSDK::GLCaptured::glDrawBuffers(__VA_ARGS__)
+#define glReadBuffer(...) MaliSDK::GLCaptured::glReadBuffer(__VA_ARGS__)
+#define glInvalidateFramebuffer(...) MaliSDK::GLCaptured::glInvalidateFramebuffer(__VA_ARGS__)
+#define glBlitFramebuffer(...) MaliSDK::GLCaptured::glBlitFramebuffer(__VA_ARGS__)
+#define glGetUniformBlockIndex(...) MaliSDK::GLCaptured::glGetUniformBlockIndex(__VA_ARGS__)
+#define glUniformBlockBinding(...) MaliSDK::GLCaptured::glUniformBlockBinding(__VA_ARGS__)
+#define glProgramParameteri(...) MaliSDK::GLCaptured::glProgramParameteri(__VA_ARGS__)
+#define glProgramBinary(...) MaliSDK::GLCaptured::glProgramBinary(__VA_ARGS__)
+#define glUniform1ui(...) MaliSDK::GLCaptured::glUniform1ui(__VA_ARGS__)
+#define glUniform2ui(...) MaliSDK::GLCaptured::glUniform2ui(__VA_ARGS__)
+#define glUniform3ui(...) MaliSDK::GLCaptured::glUniform3ui(__VA_ARGS__)
+#define glUniform4ui(...) MaliSDK::GLCaptured::glUniform4ui(__VA_ARGS__)
+#define glUniform1uiv(...) MaliSDK::GLCaptured::glUniform1uiv(__VA_ARGS__)
+#define glUniform2uiv(...) MaliSDK::GLCaptured::glUniform2uiv(__VA_ARGS__)
+#define glUniform3uiv(...) MaliSDK::GLCaptured::glUniform3uiv(__VA_ARGS__)
+#define glUniform4uiv(...) MaliSDK::GLCaptured::glUniform4uiv(__VA_ARGS__)
+#define glUniformMatrix2x3fv(...) MaliSDK::GLCaptured::glUniformMatrix2x3fv(__VA_ARGS__)
+#define glUniformMatrix3x2fv(...) MaliSDK::GLCaptured::glUniformMatrix3x2fv(__VA_ARGS__)
+#define glUniformMatrix2x4fv(...) MaliSDK::GLCaptured::glUniformMatrix2x4fv(__VA_ARGS__)
+#define glUniformMatrix4x2fv(...) MaliSDK::GLCaptured::glUniformMatrix4x2fv(__VA_ARGS__)
+#define glUniformMatrix3x4fv(...) MaliSDK::GLCaptured::glUniformMatrix3x4fv(__VA_ARGS__)
+#define glUniformMatrix4x3fv(...) MaliSDK::GLCaptured::glUniformMatrix4x3fv(__VA_ARGS__)
+#define glProgramUniform1f(...) MaliSDK::GLCaptured::glProgramUniform1f(__VA_ARGS__)
+#define glProgramUniform2f(...) MaliSDK::GLCaptured::glProgramUniform2f(__VA_ARGS__)
+#define glProgramUniform3f(...) MaliSDK::GLCaptured::glProgramUniform3f(__VA_ARGS__)
+#define glProgramUniform4f(...) MaliSDK::GLCaptured::glProgramUniform4f(__VA_ARGS__)
+#define glProgramUniform1i(...) MaliSDK::GLCaptured::glProgramUniform1i(__VA_ARGS__)
+#define glProgramUniform2i(...) MaliSDK::GLCaptured::glProgramUniform2i(__VA_ARGS__)
+#define glProgramUniform3i(...) MaliSDK::GLCaptured::glProgramUniform3i(__VA_ARGS__)
+#define glProgramUniform4i(...) MaliSDK::GLCaptured::glProgramUniform4i(__VA_ARGS__)
+#define glProgramUniform1ui(...) MaliSDK::GLCaptured::glProgramUniform1ui(__VA_ARGS__)
+#define glProgramUniform2ui(...) MaliSDK::GLCaptured::glProgramUniform2ui(__VA_ARGS__)
+#define glProgramUniform3ui(...) MaliSDK::GLCaptured::glProgramUniform3ui(__VA_ARGS__)
+#define glProgramUniform4ui(...) MaliSDK::GLCaptured::glProgramUniform4ui(__VA_ARGS__)
+#define glProgramUniform1fv(...) MaliSDK::GLCaptured::glProgramUniform1fv(__VA_ARGS__)
+#define glProgramUniform2fv(...) MaliSDK::GLCaptured::glProgramUniform2fv(__VA_ARGS__)
+#define glProgramUniform3fv(...) MaliSDK::GLCaptured::glProgramUniform3fv(__VA_ARGS__)
+#define glProgramUniform4fv(...) MaliSDK::GLCaptured::glProgramUniform4fv(__VA_ARGS__)
+#define glProgramUniform1iv(...) MaliSDK::GLCaptured::glProgramUniform1iv(__VA_ARGS__)
+#define glProgramUniform2iv(...) MaliSDK::GLCaptured::glProgramUniform2iv(__VA_ARGS__)
+#define glProgramUniform3iv(...) MaliSDK::GLCaptured::glProgramUniform3iv(__VA_ARGS__)
+#define glProgramUniform4iv(...) MaliSDK::GLCaptured::glProgramUniform4iv(__VA_ARGS__)
+#define glProgramUniform1uiv(...) MaliSDK::GLCaptured::glProgramUniform1uiv(__VA_ARGS__)
+#define glProgramUniform2uiv(...) MaliSDK::GLCaptured::glProgramUniform2uiv(__VA_ARGS__)
+#define glProgramUniform3uiv(...) MaliSDK::GLCaptured::glProgramUniform3uiv(__VA_ARGS__)
+#define glProgramUniform4uiv(...) MaliSDK::GLCaptured::glProgramUniform4uiv(__VA_ARGS__)
+#define glProgramUniformMatrix2fv(...) MaliSDK::GLCaptured::glProgramUniformMatrix2fv(__VA_ARGS__)
+#define glProgramUniformMatrix3fv(...) MaliSDK::GLCaptured::glProgramUniformMatrix3fv(__VA_ARGS__)
+#define glProgramUniformMatrix4fv(...) MaliSDK::GLCaptured::glProgramUniformMatrix4fv(__VA_ARGS__)
+#define glProgramUniformMatrix2x3fv(...) MaliSDK::GLCaptured::glProgramUniformMatrix2x3fv(__VA_ARGS__)
+#define glProgramUniformMatrix3x2fv(...) MaliSDK::GLCaptured::glProgramUniformMatrix3x2fv(__VA_ARGS__)
+#define glProgramUniformMatrix2x4fv(...) MaliSDK::GLCaptured::glProgramUniformMatrix2x4fv(__VA_ARGS__)
+#define glProgramUniformMatrix4x2fv(...) MaliSDK::GLCaptured::glProgramUniformMatrix4x2fv(__VA_ARGS__)
+#define glProgramUniformMatrix3x4fv(...) MaliSDK::GLCaptured::glProgramUniformMatrix3x4fv(__VA_ARGS__)
+#define glProgramUniformMatrix4x3fv(...) MaliSDK::GLCaptured::glProgramUniformMatrix4x3fv(__VA_ARGS__)
+#define glVertexAttribIPointer(...) MaliSDK::GLCaptured::glVertexAttribIPointer(__VA_ARGS__)
+#define glVertexAttribDivisor(...) MaliSDK::GLCaptured::glVertexAttribDivisor(__VA_ARGS__)
+#define glClearBufferfv(...) MaliSDK::GLCaptured::glClearBufferfv(__VA_ARGS__)
+#define glClearBufferiv(...) MaliSDK::GLCaptured::glClearBufferiv(__VA_ARGS__)
+#define glClearBufferuiv(...) MaliSDK::GLCaptured::glClearBufferuiv(__VA_ARGS__)
+#define glDrawArraysInstanced(...) MaliSDK::GLCaptured::glDrawArraysInstanced(__VA_ARGS__)
+#define glDrawElementsInstanced(...) MaliSDK::GLCaptured::glDrawElementsInstanced(__VA_ARGS__)
+#define glDrawRangeElements(...) MaliSDK::GLCaptured::glDrawRangeElements(__VA_ARGS__)
+#define glDrawArraysIndirect(...) MaliSDK::GLCaptured::glDrawArraysIndirect(__VA_ARGS__)
+#define glDrawElementsIndirect(...) MaliSDK::GLCaptured::glDrawElementsIndirect(__VA_ARGS__)
+#define glDispatchCompute(...) MaliSDK::GLCaptured::glDispatchCompute(__VA_ARGS__)
+#define glDispatchComputeIndirect(...) MaliSDK::GLCaptured::glDispatchComputeIndirect(__VA_ARGS__)
+#define glMemoryBarrier(...) MaliSDK::GLCaptured::glMemoryBarrier(__VA_ARGS__)
+#define glFenceSync(...) MaliSDK::GLCaptured::glFenceSync(__VA_ARGS__)
+#define glDeleteSync(...) MaliSDK::GLCaptured::glDeleteSync(__VA_ARGS__)
+#define glWaitSync(...) MaliSDK::GLCaptured::glWaitSync(__VA_ARGS__)
+#define glClientWaitSync(...) MaliSDK::GLCaptured::glClientWaitSync(__VA_ARGS__)
+#endif
+
+#endif /* !defined(GL_CAPTURE_IMPLEMENTATION) */
+
+#endif /* defined(GL_CAPTURE) */
+
+#endif /* GLCAPTURE_H */
@@ -1,4 +1,4 @@
-/* Copyright (c) 2014-2017, ARM Limited and Contributors
+/* Copyright (c) 2017, ARM Limited and Contributors
  *
  * SPDX-License-Identifier: MIT
  *
@@ -18,58 +18,49 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifndef TIMER_H
-#define TIMER_H
+#ifndef GLEXTENSIONS_H
+#define GLEXTENSIONS_H
 
-#include <cstdio>
-
-#if defined(_WIN32)
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
 #else
-#include <sys/time.h>
+#error "GLES_VERSION must be defined as either 2 or 3"
 #endif
 
+#include <EGL/egl.h>
+
 namespace MaliSDK
 {
     /**
-     * \brief Provides a platform independent high resolution timer.
-     * \note The timer measures real time, not CPU time.
+     * \brief Looks up OpenGL ES and EGL extensions by name.
+     *
+     * Extension strings are space separated names, some of which are prefixes of others, so a plain strstr()
+     * would find GL_EXT_foo in a string only listing GL_EXT_foo_bar. These functions match whole names only.
      */
-    class Timer
+    class GLExtensions
     {
     private:
-        int frameCount;
-        float fps;
-        float lastTime;
-
-    #if defined(_WIN32)
-        double resetStamp;
-        double invFreq;
-        float  lastInterval;
-        float  lastFpsUpdate;
-    #else
-        timeval startTime;
-        timeval currentTime;
-        float   lastIntervalTime;
-        float   fpsTime;
-    #endif
+        GLExtensions(void);
 
     public:
         /**
-         * \brief Default Constructor
+         * \brief Whether a space separated list of extensions contains an extension.
+         * \param[in] extensions The list, may be NULL.
+         * \param[in] extension The name to look for.
          */
-        Timer();
-        
+        static bool isInList(const char *extensions, const char *extension);
+
         /**
-         * \brief Resets the timer to 0.0f.
+         * \brief Whether the current context supports an OpenGL ES extension.
          */
-        void reset();
+        static bool isSupported(const char *extension);
 
         /**
-         * \brief Returns the time passed since object creation or since reset() was last called.
-         *
-         * \return Float containing the current time.
+         * \brief Whether a display supports an EGL extension.
          */
-        float getTime();
+        static bool isEGLSupported(EGLDisplay display, const char *extension);
     };
 }
-#endif /* TIMER_H */
\ No newline at end of file
+#endif /* GLEXTENSIONS_H */
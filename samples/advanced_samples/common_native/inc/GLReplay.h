@@ -0,0 +1,124 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GLREPLAY_H
+#define GLREPLAY_H
+
+#include "GLCapture.h"
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl31.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Plays back the OpenGL ES commands recorded by GLCapture.
+     *
+     * The whole file is loaded into memory, so playing a frame costs nothing but the calls, and the frames can be
+     * played again and again to benchmark them. Objects are created under new names, the names of the capture are
+     * translated, as are uniform locations, uniform block indices and sync objects.
+     *
+     * Play the setup once, then the frames in order. A frame can be played again after the last one, as long as
+     * the frames leave the objects as they found them, which they do if the sample draws the same way every frame.
+     * The objects are not deleted, destroy the context when done.
+     */
+    class GLReplay
+    {
+    public:
+        GLReplay(void);
+
+        /**
+         * \brief Load a capture file.
+         *
+         * \param[in] path The file written by GLCapture.
+         * \return False if the file cannot be read, is not a capture or needs a newer OpenGL ES than this build.
+         */
+        bool load(const char *path);
+
+        /**
+         * \brief Width of the surface the frames were captured on.
+         */
+        unsigned int getWidth(void) const;
+
+        /**
+         * \brief Height of the surface the frames were captured on.
+         */
+        unsigned int getHeight(void) const;
+
+        /**
+         * \brief Number of frames after the setup.
+         */
+        unsigned int getNumberOfFrames(void) const;
+
+        /**
+         * \brief Play the commands before the first frame, in the current context.
+         *
+         * \return False if a command is damaged or not supported.
+         */
+        bool playSetup(void);
+
+        /**
+         * \brief Play the commands of a frame, in the current context.
+         *
+         * \param[in] frame Index of the frame, less than getNumberOfFrames().
+         * \return False if a command is damaged or not supported.
+         */
+        bool playFrame(unsigned int frame);
+
+    private:
+        bool play(size_t begin, size_t end);
+        bool execute(unsigned int command, const unsigned char *arguments, size_t size);
+
+        GLint getUniformLocation(GLuint program, GLint location) const;
+
+        std::vector<unsigned char> data;
+        GLCapture::Header header;
+
+        /* Offsets of the commands, the setup ends where the first frame begins. */
+        size_t setupBegin;
+        std::vector<size_t> frameBegins;
+        size_t framesEnd;
+
+        std::map<GLuint, GLuint> buffers;
+        std::map<GLuint, GLuint> textures;
+        std::map<GLuint, GLuint> framebuffers;
+        std::map<GLuint, GLuint> renderbuffers;
+        std::map<GLuint, GLuint> vertexArrays;
+        std::map<GLuint, GLuint> samplers;
+        /* Shaders and programs share their names. */
+        std::map<GLuint, GLuint> programs;
+        std::map<std::pair<GLuint, GLint>, GLint> uniformLocations;
+        std::map<std::pair<GLuint, GLuint>, GLuint> uniformBlockIndices;
+        std::map<unsigned long long, GLsync> syncs;
+
+        /* Program of the capture in use, for glUniform*(). */
+        GLuint currentProgram;
+    };
+}
+#endif /* GLREPLAY_H */
@@ -0,0 +1,224 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GLSTATECACHE_H
+#define GLSTATECACHE_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+namespace MaliSDK
+{
+    /**
+     * \brief Shadow copy of the most often changed OpenGL ES state, filtering out calls which would not change anything.
+     *
+     * Drivers validate state on every call, even when it sets the value already set, which adds up
+     * in code binding its program, textures and blend state for every draw. Going through this class
+     * instead, such calls never reach the driver.
+     *
+     * Cached: the current program, texture bindings of the 2D and cube map targets (and 3D and 2D array in
+     * OpenGL ES 3.0) of the first 32 units, the sampler object bindings of the same units (OpenGL ES 3.0),
+     * the GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER bindings, the vertex array
+     * object, the capabilities passed to setEnabled(), and the blend, depth and culling functions.
+     * Anything else passes through unchanged.
+     *
+     * The cache only stays correct if all changes to this state go through it. Call invalidate() after code
+     * making the GL calls directly, and whenever a new context is made current. Deleting a bound buffer or texture
+     * unbinds it, so delete them with deleteBuffers(), deleteTextures() and deleteSamplers().
+     * Only the thread rendering the frames is meant to use it.
+     *
+     * setBypass() turns the filtering off, to compare its effect.
+     */
+    class GLStateCache
+    {
+    private:
+        /**
+         * \brief Number of texture units whose bindings are cached.
+         */
+        static const int maxTextureUnits = 32;
+
+        /**
+         * \brief Number of cached texture targets.
+         */
+        static const int numberOfTextureTargets = 4;
+
+        /**
+         * \brief Set when the cached value is not known, so the next call is always made.
+         */
+        static const GLuint unknown = 0xFFFFFFFFu;
+
+        static bool bypass;
+
+        static GLuint program;
+        static GLuint activeTextureUnit;
+        static GLuint textures[maxTextureUnits][numberOfTextureTargets];
+        static GLuint arrayBuffer;
+        static GLuint elementArrayBuffer;
+        static GLuint vertexArray;
+#if GLES_VERSION == 3
+        static GLuint samplers[maxTextureUnits];
+#endif
+
+        static signed char blendEnabled;
+        static signed char cullFaceEnabled;
+        static signed char depthTestEnabled;
+        static signed char stencilTestEnabled;
+        static signed char scissorTestEnabled;
+        static signed char polygonOffsetFillEnabled;
+
+        static GLenum blendSourceRGB;
+        static GLenum blendDestinationRGB;
+        static GLenum blendSourceAlpha;
+        static GLenum blendDestinationAlpha;
+        static GLenum blendEquationRGB;
+        static GLenum blendEquationAlpha;
+        static GLenum depthFunction;
+        static GLuint depthWriteMask;
+        static GLenum cullFaceMode;
+        static GLenum frontFaceMode;
+
+        /**
+         * \brief Index of a texture target in the cached bindings of a unit, -1 if the target is not cached.
+         */
+        static int getTextureTargetIndex(GLenum target);
+
+        /**
+         * \brief Cached state of a capability, NULL if the capability is not cached.
+         */
+        static signed char *getCapability(GLenum capability);
+
+    public:
+        /**
+         * \brief Turn the filtering off or on. While bypassed every call is made.
+         * \param[in] bypassCache True to make every call.
+         */
+        static void setBypass(bool bypassCache);
+
+        /**
+         * \brief Whether the filtering is turned off.
+         */
+        static bool isBypassed(void);
+
+        /**
+         * \brief Forget the cached state, the next call of every kind is made.
+         */
+        static void invalidate(void);
+
+        /**
+         * \brief glUseProgram().
+         */
+        static void useProgram(GLuint newProgram);
+
+        /**
+         * \brief glActiveTexture().
+         * \param[in] unit The unit, GL_TEXTURE0 and up.
+         */
+        static void activeTexture(GLenum unit);
+
+        /**
+         * \brief glBindTexture() on the active texture unit.
+         */
+        static void bindTexture(GLenum target, GLuint texture);
+
+        /**
+         * \brief glBindBuffer().
+         */
+        static void bindBuffer(GLenum target, GLuint buffer);
+
+#if GLES_VERSION == 3
+        /**
+         * \brief glBindVertexArray(). The element array buffer binding belongs to the vertex array, so it is forgotten.
+         */
+        static void bindVertexArray(GLuint array);
+
+        /**
+         * \brief glBindSampler().
+         * \param[in] unit The unit, from 0, not GL_TEXTURE0.
+         * \param[in] sampler The sampler object, 0 to use the parameters of the texture.
+         */
+        static void bindSampler(GLuint unit, GLuint sampler);
+#endif
+
+        /**
+         * \brief glEnable() or glDisable().
+         * \param[in] capability The capability, e.g. GL_BLEND.
+         * \param[in] enabled True to enable it.
+         */
+        static void setEnabled(GLenum capability, bool enabled);
+
+        /**
+         * \brief glBlendFunc().
+         */
+        static void blendFunc(GLenum source, GLenum destination);
+
+        /**
+         * \brief glBlendFuncSeparate().
+         */
+        static void blendFuncSeparate(GLenum sourceRGB, GLenum destinationRGB, GLenum sourceAlpha, GLenum destinationAlpha);
+
+        /**
+         * \brief glBlendEquation().
+         */
+        static void blendEquation(GLenum mode);
+
+        /**
+         * \brief glDepthFunc().
+         */
+        static void depthFunc(GLenum function);
+
+        /**
+         * \brief glDepthMask().
+         */
+        static void depthMask(GLboolean writeMask);
+
+        /**
+         * \brief glCullFace().
+         */
+        static void cullFace(GLenum mode);
+
+        /**
+         * \brief glFrontFace().
+         */
+        static void frontFace(GLenum mode);
+
+        /**
+         * \brief glDeleteBuffers(), also forgetting the bindings of the buffers.
+         */
+        static void deleteBuffers(GLsizei count, const GLuint *buffers);
+
+        /**
+         * \brief glDeleteTextures(), also forgetting the bindings of the textures.
+         */
+        static void deleteTextures(GLsizei count, const GLuint *texturesToDelete);
+
+#if GLES_VERSION == 3
+        /**
+         * \brief glDeleteSamplers(), also forgetting the bindings of the samplers.
+         */
+        static void deleteSamplers(GLsizei count, const GLuint *samplersToDelete);
+#endif
+    };
+}
+#endif /* GLSTATECACHE_H */
@@ -0,0 +1,197 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GLWORKERPOOL_H
+#define GLWORKERPOOL_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else 
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <EGL/egl.h>
+#include <pthread.h>
+
+#include <deque>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief A pool of worker threads, each with its own context sharing objects with the rendering context.
+     *
+     * This is the setup of the ThreadSync sample made reusable: every worker owns a context created with
+     * the rendering context as its share context (see EGLWorkerContext), so jobs can upload textures, fill buffers
+     * or compile shaders without stalling the rendering thread.
+     * When a job has run, the worker inserts a fence (OpenGL ES 3.0) or calls glFinish() (OpenGL ES 2.0)
+     * and the job handle becomes complete. wait() then makes the rendering context wait for the fence
+     * before it uses the objects written by the job.
+     *
+     * Typical usage:
+     * \code
+     * pool.initialize(2);
+     * GLWorkerPool::Job *job = pool.submit(uploadTexture, &textureData);
+     *
+     * // In the render loop:
+     * if (job != NULL && pool.isComplete(job))
+     * {
+     *     pool.wait(job);
+     *     job = NULL;
+     *     // The texture can be used from now on.
+     * }
+     * \endcode
+     *
+     * Objects created by a job are shared, but container objects (vertex arrays, framebuffers, transform feedback
+     * objects) are not, so jobs should only create buffers, textures, renderbuffers, shaders and programs.
+     * Apart from the jobs themselves, all methods must be called from the rendering thread.
+     */
+    class GLWorkerPool
+    {
+    public:
+        /**
+         * \brief Function run by a worker thread, with the worker context current.
+         * \param[in] userData The pointer passed to submit().
+         */
+        typedef void (*JobFunction)(void *userData);
+
+        /**
+         * \brief Completion handle of a submitted job.
+         */
+        struct Job
+        {
+            JobFunction function;
+            void *userData;
+            bool done;
+#if GLES_VERSION == 3
+            GLsync fence;
+#endif
+        };
+
+    private:
+        /**
+         * \brief A worker thread and the EGL objects it renders with.
+         */
+        struct Worker
+        {
+            GLWorkerPool *pool;
+            pthread_t thread;
+            EGLSurface surface;
+            EGLContext context;
+        };
+
+        EGLDisplay display;
+        std::vector<Worker> workers;
+        std::deque<Job *> pendingJobs;
+        std::vector<Job *> submittedJobs;
+        bool stopping;
+
+        pthread_mutex_t mutex;
+        /* Signalled when a job is queued or the pool is stopping. */
+        pthread_cond_t jobQueued;
+        /* Signalled when a worker has completed a job. */
+        pthread_cond_t jobDone;
+
+        /* Copying would leave two owners of the worker threads. */
+        GLWorkerPool(const GLWorkerPool &);
+        GLWorkerPool &operator=(const GLWorkerPool &);
+
+        /**
+         * \brief Forget a job handle and release its fence.
+         * \param[in] job The job to release. Must be complete.
+         */
+        void releaseJob(Job *job);
+
+        /**
+         * \brief Working function of every worker thread.
+         * \param[in] worker The Worker the thread belongs to.
+         * \return Always NULL.
+         */
+        static void *workerFunction(void *worker);
+    public:
+        /**
+         * \brief Create an empty pool. No threads are started until initialize() is called.
+         */
+        GLWorkerPool(void);
+
+        /**
+         * \brief Calls terminate().
+         */
+        ~GLWorkerPool(void);
+
+        /**
+         * \brief Start the worker threads.
+         *
+         * Must be called with the rendering context current, the worker contexts use its config and client version.
+         * \param[in] numberOfWorkers Number of threads to start. 0 starts one per core, minus the rendering thread.
+         * \return True if at least one worker context could be created. If not, submit() runs jobs on the calling thread.
+         */
+        bool initialize(unsigned int numberOfWorkers);
+
+        /**
+         * \brief Run the jobs still queued, stop the worker threads and destroy their contexts.
+         *
+         * Handles that have not been passed to wait() are released.
+         */
+        void terminate(void);
+
+        /**
+         * \brief Get the number of worker threads.
+         * \return 0 if initialize() has not been called or could not create any context.
+         */
+        unsigned int getNumberOfWorkers(void) const;
+
+        /**
+         * \brief Queue a job to be run by the next free worker.
+         *
+         * Jobs may run in any order and concurrently with each other. The caller has to make sure any objects a job
+         * refers to have been flushed to the server (e.g. by calling glFlush()) before the job is submitted.
+         * \param[in] function The function to run.
+         * \param[in] userData Passed to the function.
+         * \return The completion handle, to be passed to wait() exactly once.
+         */
+        Job *submit(JobFunction function, void *userData);
+
+        /**
+         * \brief Check whether a job has finished, without blocking.
+         * \param[in] job A handle returned by submit().
+         * \return True if the job has run and the GPU has processed its commands.
+         */
+        bool isComplete(Job *job);
+
+        /**
+         * \brief Wait until a job has run, and make the current context wait for its commands.
+         *
+         * Blocks the calling thread only until the worker has issued the commands.
+         * On OpenGL ES 3.0 the GPU wait is queued with glWaitSync(), so it does not block the calling thread.
+         * The handle is released and must not be used afterwards.
+         * \param[in] job A handle returned by submit().
+         */
+        void wait(Job *job);
+
+        /**
+         * \brief Wait for all submitted jobs which have not been passed to wait() yet, and release them.
+         */
+        void waitAll(void);
+    };
+}
+#endif /* GLWORKERPOOL_H */
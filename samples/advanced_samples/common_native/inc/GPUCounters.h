@@ -0,0 +1,120 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GPUCOUNTERS_H
+#define GPUCOUNTERS_H
+
+#include <cstddef>
+
+namespace hwcpipe
+{
+    class HWCPipe;
+}
+
+namespace MaliSDK
+{
+    /**
+     * \brief Per frame Mali GPU hardware counters, sampled with HWCPipe.
+     *
+     * Optional: HWCPipe is only used when the build is configured with HWCPIPE_DIR pointing at a checkout
+     * of it, which defines HAVE_HWCPIPE. Otherwise, and on GPUs or kernels without counter access,
+     * isSupported() returns false and every value is 0. Reading the counters needs a kernel driver which
+     * gives applications access to them, which production devices do not always allow.
+     *
+     * Call sample() once per frame, after eglSwapBuffers() or at the start of step() for Java driven samples.
+     * The values are those of the frame since the previous call.
+     */
+    class GPUCounters
+    {
+    private:
+        hwcpipe::HWCPipe *pipe;
+        bool supported;
+
+        double gpuCycles;
+        double fragmentCycles;
+        double shaderCycles;
+        double externalReadBytes;
+        double externalWriteBytes;
+        double tiles;
+
+    public:
+        /**
+         * \brief Start counting. Does nothing if the counters are not available.
+         */
+        GPUCounters(void);
+
+        ~GPUCounters(void);
+
+        /**
+         * \brief Whether the counters can be read on this device and build.
+         */
+        bool isSupported(void) const;
+
+        /**
+         * \brief Read the counters of the frame since the previous call.
+         */
+        void sample(void);
+
+        /**
+         * \brief Cycles the GPU was active for.
+         */
+        double getGPUCycles(void) const;
+
+        /**
+         * \brief Cycles the fragment queue was active for.
+         */
+        double getFragmentCycles(void) const;
+
+        /**
+         * \brief Bytes read from external memory by the GPU.
+         */
+        double getExternalReadBytes(void) const;
+
+        /**
+         * \brief Bytes written to external memory by the GPU.
+         */
+        double getExternalWriteBytes(void) const;
+
+        /**
+         * \brief Number of tiles rendered.
+         */
+        double getTiles(void) const;
+
+        /**
+         * \brief Fraction of the GPU active cycles the shader cores were busy, from 0 to 1.
+         */
+        double getShaderCoreUtilisation(void) const;
+
+        /**
+         * \brief Bandwidth of the last frame on one line for the Text overlay, e.g. "Read 12.3 MB Write 4.5 MB".
+         * \param[out] buffer The line is written here, always terminated.
+         * \param[in] size Size of buffer.
+         */
+        void getBandwidthString(char *buffer, size_t size) const;
+
+        /**
+         * \brief Cycles, tiles and shader core utilisation of the last frame on one line for the Text overlay.
+         * \param[out] buffer The line is written here, always terminated.
+         * \param[in] size Size of buffer.
+         */
+        void getUtilisationString(char *buffer, size_t size) const;
+    };
+}
+#endif /* GPUCOUNTERS_H */
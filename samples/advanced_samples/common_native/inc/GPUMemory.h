@@ -0,0 +1,159 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GPUMEMORY_H
+#define GPUMEMORY_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <cstddef>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Registry of the GPU memory held by textures, buffers and renderbuffers, with the owner of each.
+     *
+     * Code creating a resource records its size, format and owner tag; the common texture loaders, GLFFT and the
+     * glutil helpers of the samples do so. Resources are forgotten when they are deleted through
+     * GLStateCache or forget(), and the ones deleted with plain glDelete* calls are found by prune(), which asks the
+     * context whether each name still exists. Recording a name again replaces its previous size, as glBufferData()
+     * and glTexImage2D() replace the storage.
+     *
+     * The sizes are those of the data as allocated by the API: drivers add alignment, mipmap tails and compression
+     * metadata, so the totals are a lower bound of what the process uses, and the trend is what to watch.
+     *
+     * Use log() to print the totals per owner, getSummary() for an overlay line, and reportLeaks() once everything
+     * should have been deleted; EGLRuntime::terminateEGL() and the benchmark harness call it.
+     * Safe to call from several threads, such as the loaders of GLWorkerPool with their shared contexts.
+     */
+    class GPUMemory
+    {
+    public:
+        /**
+         * \brief Kinds of resources, the totals are kept per kind.
+         */
+        enum Category
+        {
+            CATEGORY_TEXTURE,
+            CATEGORY_BUFFER,
+            CATEGORY_RENDERBUFFER,
+            NUMBER_OF_CATEGORIES
+        };
+
+        /**
+         * \brief Record a texture.
+         * \param[in] texture Name of the texture.
+         * \param[in] bytes Size of all its levels, layers and faces, computeTextureSize() gives it from its dimensions.
+         * \param[in] internalFormat Internal format of the texture.
+         * \param[in] owner Tag of the code owning it, shown in the log. Must stay valid, a string literal typically.
+         */
+        static void trackTexture(GLuint texture, size_t bytes, GLenum internalFormat, const char *owner);
+
+        /**
+         * \brief Record a buffer.
+         * \param[in] buffer Name of the buffer.
+         * \param[in] bytes Size of the data store.
+         * \param[in] usage Usage the data store was created with, such as GL_STATIC_DRAW.
+         * \param[in] owner Tag of the code owning it.
+         */
+        static void trackBuffer(GLuint buffer, size_t bytes, GLenum usage, const char *owner);
+
+        /**
+         * \brief Record a renderbuffer.
+         * \param[in] renderbuffer Name of the renderbuffer.
+         * \param[in] bytes Size of the storage, including all samples.
+         * \param[in] internalFormat Internal format of the renderbuffer.
+         * \param[in] owner Tag of the code owning it.
+         */
+        static void trackRenderbuffer(GLuint renderbuffer, size_t bytes, GLenum internalFormat, const char *owner);
+
+        /**
+         * \brief Forget resources which have been deleted.
+         * \param[in] category Kind of the resources.
+         * \param[in] count Number of names.
+         * \param[in] names The names, as passed to glDelete*. Names which are not recorded are ignored.
+         */
+        static void forget(Category category, GLsizei count, const GLuint *names);
+
+        /**
+         * \brief Forget the recorded resources which no longer exist. Must be called with a context of the share group current.
+         */
+        static void prune(void);
+
+        /**
+         * \brief Total size of the recorded resources of a kind, in bytes.
+         */
+        static size_t getTotal(Category category);
+
+        /**
+         * \brief Number of recorded resources of a kind.
+         */
+        static size_t getCount(Category category);
+
+        /**
+         * \brief One line with the total and count of each kind, for an overlay, e.g. "GPU memory: textures 12.5 MB (8), ...".
+         * \param[out] string Where to write the line.
+         * \param[in] size Size of the string, including the terminating zero.
+         */
+        static void getSummary(char *string, size_t size);
+
+        /**
+         * \brief Print the totals of each kind and owner with LOGI.
+         */
+        static void log(void);
+
+        /**
+         * \brief Print every resource still recorded with LOGE, forget them, and return how many there were.
+         *
+         * Call after the sample has deleted its resources, with its context still current, so deleted ones are pruned.
+         * \return The number of leaked resources, 0 if everything was deleted.
+         */
+        static unsigned int reportLeaks(void);
+
+        /**
+         * \brief Size of the storage of a texture.
+         * \param[in] internalFormat Sized, unsized or compressed internal format. Unknown formats count as 4 bytes per texel.
+         * \param[in] width Width of the base level.
+         * \param[in] height Height of the base level.
+         * \param[in] depth Depth of the base level, or number of layers of an array, or 6 for a cube map. 1 otherwise.
+         * \param[in] levels Number of mipmap levels.
+         * \return The size in bytes.
+         */
+        static size_t computeTextureSize(GLenum internalFormat, int width, int height, int depth, int levels);
+    };
+}
+
+/*
+ * C entry point of GPUMemory::reportLeaks(). Every sample library has its own copy of the registry, so the benchmark
+ * harness looks this up in the library with dlsym().
+ */
+extern "C" unsigned int MaliSDK_GPUMemory_reportLeaks(void);
+
+/*
+ * Total size of every kind of recorded resource in bytes, for the memory the harness reports along with the times.
+ */
+extern "C" unsigned long long MaliSDK_GPUMemory_getTotal(void);
+#endif /* GPUMEMORY_H */
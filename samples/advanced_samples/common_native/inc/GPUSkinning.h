@@ -0,0 +1,156 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GPUSKINNING_H
+#define GPUSKINNING_H
+
+#include <GLES3/gl31.h>
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Skins a mesh once per frame into a vertex buffer, which every pass drawing the mesh then reads.
+     *
+     * Skinning in the vertex shader of each pass repeats the same work for the shadow map, the main pass and every
+     * view. Here a compute shader blends the bone matrices of each vertex once, and writes the skinned positions and
+     * normals to a buffer the passes bind as a plain vertex buffer, with getVertexBuffer() and VERTEX_STRIDE.
+     *
+     * Each vertex has up to 4 bones. The palette holds one 3x4 matrix per bone, row major as three vec4 rows,
+     * transforming from the bind pose to the current pose in model space.
+     *
+     * Typical usage:
+     * \code
+     * skinning.initialize(positions, normals, boneIndices, boneWeights, numberOfVertices, numberOfBones);
+     *
+     * // Once per frame, before the passes:
+     * skinning.update(palette);
+     * glBindBuffer(GL_ARRAY_BUFFER, skinning.getVertexBuffer());
+     * glVertexAttribPointer(positionLocation, 4, GL_FLOAT, GL_FALSE, GPUSkinning::VERTEX_STRIDE, (void *)GPUSkinning::POSITION_OFFSET);
+     * glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, GPUSkinning::VERTEX_STRIDE, (void *)GPUSkinning::NORMAL_OFFSET);
+     * \endcode
+     *
+     * Compute shaders need OpenGL ES 3.1. On an OpenGL ES 3.0 context the vertices are skinned on the CPU
+     * into the same buffer instead, so the passes do not change. Only available in OpenGL ES 3.0 builds.
+     */
+    class GPUSkinning
+    {
+    public:
+        /** \brief Distance in bytes between two skinned vertices. */
+        static const GLsizei VERTEX_STRIDE = 32;
+        /** \brief Offset of the position, a vec4 with w = 1, in a skinned vertex. */
+        static const GLsizei POSITION_OFFSET = 0;
+        /** \brief Offset of the normal, a vec3 padded to a vec4, in a skinned vertex. */
+        static const GLsizei NORMAL_OFFSET = 16;
+
+    private:
+        /**
+         * \brief A vertex in the bind pose, laid out as the std430 structure the compute shader reads.
+         */
+        struct BindPoseVertex
+        {
+            float position[4];
+            float normal[4];
+            GLuint bones[4];
+            float weights[4];
+        };
+
+        unsigned int numberOfVertices;
+        unsigned int numberOfBones;
+        bool computeSupported;
+
+        GLuint skinningProgram;
+        GLint numberOfVerticesLocation;
+        GLuint bindPoseBuffer;
+        GLuint paletteBuffer;
+        GLuint vertexBuffer;
+
+        /* Kept for skinning on the CPU only. */
+        std::vector<BindPoseVertex> bindPose;
+        std::vector<float> skinnedVertices;
+
+        /* Copying would leave two owners of the buffers. */
+        GPUSkinning(const GPUSkinning &);
+        GPUSkinning &operator=(const GPUSkinning &);
+
+        /**
+         * \brief Skin the vertices on the CPU and upload them, when there are no compute shaders.
+         * \param[in] palette The palette passed to update().
+         */
+        void skinOnCPU(const float *palette);
+    public:
+        /**
+         * \brief Create an empty instance. No GL objects are created until initialize() is called.
+         */
+        GPUSkinning(void);
+
+        /**
+         * \brief Calls terminate().
+         */
+        ~GPUSkinning(void);
+
+        /**
+         * \brief Upload the bind pose and create the skinned vertex buffer. Must be called with a current context.
+         * \param[in] positions 3 floats per vertex.
+         * \param[in] normals 3 floats per vertex.
+         * \param[in] boneIndices 4 per vertex, less than numberOfBones.
+         * \param[in] boneWeights 4 per vertex, adding up to 1. Unused bones have a weight of 0.
+         * \param[in] numberOfVertices Number of vertices of the mesh.
+         * \param[in] numberOfBones Number of matrices in the palettes passed to update().
+         * \return True if the vertices are skinned by a compute shader, false if they are skinned on the CPU.
+         */
+        bool initialize(const float *positions, const float *normals, const unsigned int *boneIndices, const float *boneWeights,
+                        unsigned int numberOfVertices, unsigned int numberOfBones);
+
+        /**
+         * \brief Delete the buffers and the program.
+         */
+        void terminate(void);
+
+        /**
+         * \brief Skin the mesh with a new palette.
+         *
+         * On OpenGL ES 3.1 this dispatches the compute shader and issues the barrier making its results visible
+         * to vertex fetching, so the buffer can be drawn from straight after.
+         * \param[in] palette 12 floats per bone, the three rows of each 3x4 matrix.
+         */
+        void update(const float *palette);
+
+        /**
+         * \brief Get the buffer holding the skinned vertices, see VERTEX_STRIDE.
+         * \return The buffer name, 0 before initialize().
+         */
+        GLuint getVertexBuffer(void) const;
+
+        /**
+         * \brief Get the number of vertices of the mesh.
+         * \return The number passed to initialize().
+         */
+        unsigned int getNumberOfVertices(void) const;
+
+        /**
+         * \brief Check whether the vertices are skinned by a compute shader.
+         * \return False if they are skinned on the CPU.
+         */
+        bool isComputeSupported(void) const;
+    };
+}
+#endif /* GPUSKINNING_H */
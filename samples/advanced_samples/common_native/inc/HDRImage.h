@@ -21,18 +21,46 @@
 #ifndef HDR_IMAGE_LOADER_H
 #define HDR_IMAGE_LOADER_H
 
+#include <cstddef>
+#include <string>
+
 namespace MaliSDK
 {
+    class AssetFile;
+
     /**
      * \brief Class to load an manage HDR images.
      *
      * This class implements a loader for the Picture Radiance format.
      * Will only load HDR images with FORMAT=32-bit_rle_rgbe and coordinates specified in -Y +X.
      * See http://radsite.lbl.gov/radiance/refer/filefmts.pdf for more information.
+     *
+     * The file is mapped rather than read, and the pixels can be kept in a smaller format than 32-bit floats:
+     * half floats, RGB9_E5, or the RGBE bytes of the file for the shader to decode.
      */
     class HDRImage
     {
         public:
+            /**
+             * \brief Layout of the decoded pixels.
+             */
+            enum Format
+            {
+                /** Three floats per pixel in rgbData, to be uploaded as GL_RGB32F or GL_RGB16F with GL_FLOAT. */
+                FORMAT_RGB32F,
+                /** Three half floats per pixel in packedData, to be uploaded as GL_RGB16F with GL_HALF_FLOAT. */
+                FORMAT_RGB16F,
+                /** Four half floats per pixel with alpha set to 1.0, to be uploaded as GL_RGBA16F, which can be rendered to. */
+                FORMAT_RGBA16F,
+                /** One GL_UNSIGNED_INT_5_9_9_9_REV value per pixel in packedData, to be uploaded as GL_RGB9_E5. */
+                FORMAT_RGB9_E5,
+                /**
+                 * The four RGBE bytes of every pixel in packedData, to be uploaded as GL_RGBA8 and decoded in the shader with
+                 * rgb = texel.rgb * (255.0 / 127.0) * exp2(texel.a * 255.0 - 128.0). Must be sampled with GL_NEAREST.
+                 */
+                FORMAT_RGBE8
+            };
+
             /**
              * \brief Default constructor.
              */
@@ -42,8 +70,9 @@ namespace MaliSDK
              * \brief Constructor which loads a HDR image from a file.
              *
              * \param[in] filePath The path to the HDR image to load.
+             * \param[in] format The format to decode the pixels to.
              */
-            HDRImage(const std::string& filePath);
+            HDRImage(const std::string& filePath, Format format = FORMAT_RGB32F);
 
             /**
              * \brief Copy constructor to copy the contents of one HDRImage to another.
@@ -60,9 +89,44 @@ namespace MaliSDK
             /**
              * \brief Load a HDRImage from a file.
              *
+             * On failure an error is logged and the image is left empty.
+             * \param[in] filePath The path to the HDR image to load.
+             * \param[in] format The format to decode the pixels to.
+             */
+            void loadFromFile(const std::string& filePath, Format format = FORMAT_RGB32F);
+
+            /**
+             * \brief Start decoding a HDRImage from a file a few rows at a time.
+             *
+             * Reads the header and allocates the data, then decodeRows() fills it in from the top row down.
+             * loadFromFile() is open() followed by decodeRows(height) and close().
+             * On failure an error is logged and the image is left empty.
              * \param[in] filePath The path to the HDR image to load.
+             * \param[in] format The format to decode the pixels to.
+             * \return True if width and height are known and the data has been allocated.
+             */
+            bool open(const std::string& filePath, Format format = FORMAT_RGB32F);
+
+            /**
+             * \brief Decode the next rows of an image opened with open().
+             *
+             * Only touches the rows it decodes, so rows decoded earlier can be read by another thread meanwhile.
+             * \param[in] numberOfRows The maximum number of rows to decode.
+             * \return The number of rows decoded, 0 when all rows are done, -1 if the file is not encoded correctly.
+             */
+            int decodeRows(int numberOfRows);
+
+            /**
+             * \brief Get the number of rows decoded so far.
+             *
+             * \return The number of rows, from the top, that hold valid data.
+             */
+            int getDecodedRows(void) const;
+
+            /**
+             * \brief Unmap the file once decoding has finished. The decoded data is kept.
              */
-            void loadFromFile(const std::string& filePath);
+            void close(void);
           
             /**
              * \brief Overloading assignment operater to do deep copy of the HDRImage data.
@@ -71,14 +135,35 @@ namespace MaliSDK
              */
             HDRImage& operator=(const HDRImage &another);
 
+            /**
+             * \brief Get the size of one pixel in a format.
+             *
+             * \param[in] format The format.
+             * \return The size in bytes.
+             */
+            static size_t getBytesPerPixel(Format format);
+
             /**
              * \brief The HDR image data.
              *
              * Data is stored a floating point RBG values for all the pixels.
              * Total size is width * height * 3 floating point values.
+             * NULL unless the image was loaded as FORMAT_RGB32F.
              */
             float* rgbData;
 
+            /**
+             * \brief The HDR image data for the formats other than FORMAT_RGB32F.
+             *
+             * Total size is width * height * getBytesPerPixel(format) bytes.
+             */
+            unsigned char* packedData;
+
+            /**
+             * \brief The format of the loaded data.
+             */
+            Format format;
+
             /**
              * \brief The width of the HDR image.
              */
@@ -90,23 +175,39 @@ namespace MaliSDK
             int height;
 
         private:
+            /* Decoding state between open() and close(). */
+            AssetFile* file;
+            const unsigned char* cursor;
+            const unsigned char* end;
+            unsigned char* planes;
+            int decodedRows;
 
-            struct RGBEPixel
-            {
-                unsigned char r;
-                unsigned char g;
-                unsigned char b;
-                unsigned char e;
-            };
-
-            static void convertRGBEPixel(const RGBEPixel& pixel, float* rgbData);
-
-            static float convertSingleComponent(unsigned char value, int exponent);
+            /**
+             * \brief Free the pixels and reset the size to 0.
+             */
+            void release(void);
 
-            static bool decodeLine(FILE* file, int lineLength, RGBEPixel* scanLine);
+            /**
+             * \brief Decode the run-length encoded channels of a scanline.
+             *
+             * \param[in,out] cursor Start of the scanline, moved to the start of the next.
+             * \param[in] end End of the file data.
+             * \param[in] lineLength Number of pixels in the scanline.
+             * \param[out] planes lineLength red values, followed by lineLength green, blue and exponent values.
+             * \return False if the scanline is not encoded correctly.
+             */
+            static bool decodeLine(const unsigned char** cursor, const unsigned char* end, int lineLength, unsigned char* planes);
 
-            static void writeDecodedComponent(int componentIndicator, unsigned char value, RGBEPixel* pixel);
+            /**
+             * \brief Convert a decoded scanline to a format.
+             *
+             * \param[in] planes The scanline as returned by decodeLine().
+             * \param[in] lineLength Number of pixels in the scanline.
+             * \param[in] format The format to convert to.
+             * \param[out] destination lineLength pixels in the format.
+             */
+            static void convertLine(const unsigned char* planes, int lineLength, Format format, void* destination);
     };
 
 }
-#endif /* HDR_IMAGE_LOADER_H */
\ No newline at end of file
+#endif /* HDR_IMAGE_LOADER_H */
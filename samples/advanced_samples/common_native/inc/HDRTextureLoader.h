@@ -0,0 +1,159 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HDRTEXTURELOADER_H
+#define HDRTEXTURELOADER_H
+
+#include "HDRImage.h"
+
+#include <GLES3/gl3.h>
+#include <pthread.h>
+
+#include <string>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Loads a HDR image into a mipmapped texture without blocking the rendering thread.
+     *
+     * start() only reads the header and allocates the texture. A worker thread then decodes the image
+     * a strip of rows at a time, and update(), called once per frame, uploads the strips decoded since the last call.
+     * Once the last strip is in, the mip levels are generated on the GPU with a prefilter pass, a [1 3 3 1] binomial
+     * filter which is smoother than the box filter of glGenerateMipmap() and better suited to environment lookups.
+     *
+     * The texture is GL_RGBA16F. Rendering to it for the prefilter pass needs GL_EXT_color_buffer_half_float
+     * or GL_EXT_color_buffer_float; without them the texture only has its base level.
+     * Rows are stored from the top of the image down, so the image is upside down in texture coordinates.
+     *
+     * Typical usage:
+     * \code
+     * loader.start("/data/data/com.arm.malideveloper.openglessdk.sample/environment.hdr");
+     *
+     * // In the render loop:
+     * if (loader.update())
+     * {
+     *     GL_CHECK(glBindTexture(GL_TEXTURE_2D, loader.getTexture()));
+     * }
+     * \endcode
+     *
+     * Only available in OpenGL ES 3.0 builds.
+     */
+    class HDRTextureLoader
+    {
+    private:
+        HDRImage image;
+        std::string filePath;
+        int stripHeight;
+        int uploadedRows;
+        int numberOfLevels;
+        GLuint texture;
+        bool complete;
+
+        GLuint prefilterProgram;
+        GLint sourceTexelSizeLocation;
+
+        /* Worker thread state, decodedRows and failed are shared with the worker. */
+        bool workerStarted;
+        bool cancelled;
+        bool failed;
+        int decodedRows;
+        pthread_t workerThread;
+        pthread_mutex_t mutex;
+
+        /* Copying would leave two owners of the worker thread. */
+        HDRTextureLoader(const HDRTextureLoader &);
+        HDRTextureLoader &operator=(const HDRTextureLoader &);
+
+        /**
+         * \brief Working function of the worker thread.
+         * \param[in] loader The HDRTextureLoader that started the thread.
+         * \return Always NULL.
+         */
+        static void *workerFunction(void *loader);
+
+        /**
+         * \brief Wait for the worker thread, if there is one.
+         */
+        void joinWorker(void);
+
+        /**
+         * \brief Render each mip level from the previous one with the prefilter program.
+         */
+        void generateMipmaps(void);
+    public:
+        /**
+         * \brief Create an idle loader.
+         */
+        HDRTextureLoader(void);
+
+        /**
+         * \brief Stop the worker thread and delete the texture and program, if any.
+         *
+         * Must be called with the context that called start() current.
+         */
+        ~HDRTextureLoader(void);
+
+        /**
+         * \brief Start loading a HDR image.
+         *
+         * Must be called with a current context, which is then used by update().
+         * \param[in] filePath Path of the Radiance HDR file.
+         * \param[in] stripHeight Number of rows decoded and uploaded at a time.
+         * \return False if the file cannot be opened or is not a supported HDR image.
+         */
+        bool start(const std::string &filePath, int stripHeight = 32);
+
+        /**
+         * \brief Upload the rows decoded since the last call, and generate the mip levels once they are all in.
+         *
+         * Changes the GL_TEXTURE_2D binding of the active texture unit, and of unit 0 when generating the mip levels.
+         * Mip generation also uses the framebuffer, vertex array, viewport and program bindings, which are restored afterwards.
+         * \return True once the texture is complete.
+         */
+        bool update(void);
+
+        /**
+         * \brief Check whether the whole image has been uploaded and filtered, without uploading anything.
+         * \return True if the texture is ready to be used.
+         */
+        bool isComplete(void) const;
+
+        /**
+         * \brief Get the texture the image is loaded into.
+         *
+         * The texture exists from start() on, and is filled in by update().
+         * \return The texture ID, or 0 if start() has not succeeded.
+         */
+        GLuint getTexture(void) const;
+
+        /**
+         * \brief Get the width of the image.
+         * \return The width in pixels.
+         */
+        int getWidth(void) const;
+
+        /**
+         * \brief Get the height of the image.
+         * \return The height in pixels.
+         */
+        int getHeight(void) const;
+    };
+}
+#endif /* HDRTEXTURELOADER_H */
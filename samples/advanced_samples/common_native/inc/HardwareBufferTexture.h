@@ -0,0 +1,148 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HARDWAREBUFFERTEXTURE_H
+#define HARDWAREBUFFERTEXTURE_H
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+
+struct AHardwareBuffer;
+
+namespace MaliSDK
+{
+    /**
+     * \brief An RGBA8 texture whose storage is an AHardwareBuffer, so threads without a context write its texels
+     * straight into the memory the GPU samples from.
+     *
+     * The buffer is wrapped in an EGLImage with EGL_ANDROID_get_native_client_buffer and bound to the texture with
+     * GL_OES_EGL_image, so nothing is ever copied or uploaded: lock() maps the buffer for writing and unlock()
+     * hands it back. The hand over is done with native fences of EGL_ANDROID_native_fence_sync in both directions:
+     * - release() puts a fence after the draws sampling the texture. The next lock() passes it to AHardwareBuffer_lock(),
+     *   so the CPU only waits while the GPU is still reading.
+     * - unlock() keeps the fence returned by AHardwareBuffer_unlock(), and acquire() makes the GPU wait for it with
+     *   eglWaitSyncKHR() before the texture is sampled, so the CPU never waits for that.
+     *
+     * Typical usage, with the buffer handed between the threads under a lock of the caller:
+     * \code
+     * // Writer thread, which can be a camera or decoder callback without a context.
+     * int stride = 0;
+     * unsigned char *pixels = texture->lock(&stride);
+     * // Write the rows, stride pixels apart.
+     * texture->unlock();
+     *
+     * // Rendering thread.
+     * texture->acquire();
+     * // Draws sampling texture->getTexture().
+     * texture->release();
+     * \endcode
+     *
+     * AHardwareBuffer is looked up at run time as it was added in API level 26.
+     * Only available in OpenGL ES 3.0 builds.
+     */
+    class HardwareBufferTexture
+    {
+    private:
+        EGLDisplay display;
+        int width;
+        int height;
+        int stride;
+        AHardwareBuffer *buffer;
+        EGLImageKHR image;
+        GLuint textureID;
+
+        /**
+         * \brief Native fence of AHardwareBuffer_unlock() the GPU has not waited for yet, or -1.
+         */
+        int acquireFence;
+
+        /**
+         * \brief Native fence signalled when the draws before release() are done, or -1.
+         */
+        int releaseFence;
+
+        /* Prevent copying, the buffer, the image and the texture are owned. */
+        HardwareBufferTexture(const HardwareBufferTexture &);
+        HardwareBufferTexture &operator=(const HardwareBufferTexture &);
+    public:
+        /**
+         * \brief Whether the buffer can be allocated and sampled. Must be called with a current context.
+         */
+        static bool isSupported(void);
+
+        /**
+         * \brief Allocate the buffer and bind it to a texture. Must be called with a current context in which isSupported().
+         * \param[in] width Width of the texture in pixels.
+         * \param[in] height Height of the texture in pixels.
+         */
+        HardwareBufferTexture(int width, int height);
+
+        /**
+         * \brief Delete the texture and free the buffer. Must be called with a context which shares the texture current.
+         */
+        ~HardwareBufferTexture(void);
+
+        /**
+         * \brief Map the buffer for writing. Can be called from any thread.
+         *
+         * Waits until the GPU is done with the draws before the last release(). Anything written before and
+         * not acquired since is dropped, as it never reached the GPU.
+         * \param[out] rowStride Distance between the starts of two rows, in pixels. Can be wider than the texture.
+         * \return RGBA8 pixels, top row first, or NULL if the buffer could not be mapped.
+         */
+        unsigned char *lock(int *rowStride);
+
+        /**
+         * \brief Unmap the buffer after lock(). Can be called from any thread.
+         */
+        void unlock(void);
+
+        /**
+         * \brief Make the GPU wait for the writes of the last unlock() before sampling the texture.
+         *
+         * Call on the rendering thread before the first draw sampling the texture after an unlock().
+         */
+        void acquire(void);
+
+        /**
+         * \brief Fence the draws sampling the texture so far, so the next lock() does not overwrite texels they read.
+         *
+         * Call on the rendering thread after the last draw sampling the texture, before handing it to the writer.
+         */
+        void release(void);
+
+        /**
+         * \brief The GL_TEXTURE_2D texture bound to the buffer.
+         */
+        GLuint getTexture(void) const;
+
+        /**
+         * \brief Width of the texture in pixels.
+         */
+        int getWidth(void) const;
+
+        /**
+         * \brief Height of the texture in pixels.
+         */
+        int getHeight(void) const;
+    };
+}
+#endif /* HARDWAREBUFFERTEXTURE_H */
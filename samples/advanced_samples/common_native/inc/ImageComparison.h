@@ -0,0 +1,101 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef IMAGECOMPARISON_H
+#define IMAGECOMPARISON_H
+
+#include <cstddef>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Compares rendered images with reference images, for automated correctness checks.
+     *
+     * Pixels are compared by their perceived difference rather than channel by channel: the colours are
+     * converted to YIQ and the delta weighs brightness over chroma, as the eye does. A pixel differs when the
+     * delta goes over a threshold, so dithering and rounding differences between GPUs pass while a wrong colour
+     * does not. Pixels on an anti-aliased edge in either image are counted apart, as the coverage of edges
+     * changes from one GPU to another.
+     *
+     * Images are 8 bit RGB, top row first. References are kept as binary PPM files, which any image viewer opens.
+     */
+    class ImageComparison
+    {
+    public:
+        /**
+         * \brief Outcome of a comparison.
+         */
+        struct Result
+        {
+            /** Pixels over the threshold, excluding the anti-aliased ones. */
+            unsigned int differentPixels;
+            /** Pixels over the threshold found on an anti-aliased edge. */
+            unsigned int antialiasedPixels;
+            /** Largest perceived difference of a pixel, from 0 for equal colours to 1 for black against white. */
+            float maximumDifference;
+        };
+
+        /**
+         * \brief Compare two images of the same size.
+         *
+         * \param[in] image The image to check, width * height RGB pixels.
+         * \param[in] reference The expected image, same layout.
+         * \param[in] width Width of both images.
+         * \param[in] height Height of both images.
+         * \param[in] threshold Perceived difference from 0 to 1 above which a pixel differs. 0.1 passes differences
+         *                      hardly visible side by side.
+         * \param[out] difference If not NULL, filled with width * height RGB pixels showing the image faded to grey,
+         *                        with the different pixels in red and the anti-aliased ones in yellow.
+         * \return The number of different pixels and the largest difference.
+         */
+        static Result compare(const unsigned char *image, const unsigned char *reference, int width, int height,
+                              float threshold = 0.1f, std::vector<unsigned char> *difference = NULL);
+
+        /**
+         * \brief Convert pixels read by glReadPixels() to the layout of the comparison.
+         *
+         * \param[in] pixels width * height RGBA pixels, bottom row first.
+         * \param[in] width Width of the image.
+         * \param[in] height Height of the image.
+         * \param[out] image Resized to width * height RGB pixels, top row first.
+         */
+        static void convertFramebuffer(const unsigned char *pixels, int width, int height, std::vector<unsigned char> &image);
+
+        /**
+         * \brief Load a binary PPM (P6) file with 8 bit channels.
+         *
+         * \param[in] filename The file to load. Cannot be NULL.
+         * \param[out] image Resized to the RGB pixels of the file.
+         * \param[out] width Used to store the width of the image. Cannot be NULL.
+         * \param[out] height Used to store the height of the image. Cannot be NULL.
+         * \return False if the file cannot be opened or is not a PPM file with 8 bit channels.
+         */
+        static bool loadPPM(const char *filename, std::vector<unsigned char> &image, int *width, int *height);
+
+        /**
+         * \brief Save RGB pixels, top row first, as a binary PPM (P6) file.
+         *
+         * \return False if the file cannot be written.
+         */
+        static bool savePPM(const char *filename, const unsigned char *image, int width, int height);
+    };
+}
+#endif /* IMAGECOMPARISON_H */
@@ -0,0 +1,138 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef IMAGEUPLOADQUEUE_H
+#define IMAGEUPLOADQUEUE_H
+
+#include "JobScheduler.h"
+
+#include <GLES3/gl3.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Decodes images on the workers of a JobScheduler straight into pixel unpack buffers, and uploads them from there.
+     *
+     * add() maps a buffer of the decoded size on the rendering thread and submits a job which decodes the image into it.
+     * The rendering thread never touches the pixels: finish() only unmaps the buffers and calls the upload functions,
+     * which issue the glTexSubImage* calls reading from the bound buffer. Images added one after the other decode in
+     * parallel, and while the rendering thread goes on with other work such as compiling shaders.
+     *
+     * Typical usage:
+     * \code
+     * ImageUploadQueue uploads(&scheduler);
+     *
+     * // Allocate the texture storage, then:
+     * uploads.add(width * height * 4, decodeImage, uploadImage, &image);
+     *
+     * // Compile shaders...
+     * uploads.finish();
+     * \endcode
+     *
+     * More images can be added after finish(). Only available in OpenGL ES 3.0 builds.
+     */
+    class ImageUploadQueue
+    {
+    public:
+        /**
+         * \brief Function decoding an image, run by a job.
+         *
+         * Must not call OpenGL ES. The destination is usually mapped with write access only, and may be uncached:
+         * it must be written in order and never read back.
+         * \param[out] destination The size bytes the application passed to add().
+         * \param[in] size The size of the destination.
+         * \param[in] userData The pointer passed to add().
+         * \return False if the image cannot be decoded.
+         */
+        typedef bool (*DecodeFunction)(void *destination, size_t size, void *userData);
+
+        /**
+         * \brief Function uploading a decoded image, called by finish() on the rendering thread.
+         * \param[in] pixels The data pointer to pass to glTexSubImage*: an offset into the buffer bound to
+         *                   GL_PIXEL_UNPACK_BUFFER, or the decoded data itself if the buffer could not be mapped.
+         * \param[in] decoded The value returned by the DecodeFunction. Nothing is uploaded when it is false.
+         * \param[in] userData The pointer passed to add().
+         */
+        typedef void (*UploadFunction)(const void *pixels, bool decoded, void *userData);
+
+    private:
+        struct Upload
+        {
+            GLuint buffer;
+            /* The mapped buffer, or a copy in memory if it could not be mapped. */
+            void *destination;
+            std::vector<unsigned char> fallback;
+            size_t size;
+            DecodeFunction decode;
+            UploadFunction upload;
+            void *userData;
+            bool decoded;
+            JobScheduler::Job *job;
+        };
+
+        JobScheduler *scheduler;
+        /* In the order they were added, so they are uploaded in that order. */
+        std::vector<Upload *> uploads;
+
+        /* Copying would leave two owners of the jobs and buffers. */
+        ImageUploadQueue(const ImageUploadQueue &);
+        ImageUploadQueue &operator=(const ImageUploadQueue &);
+
+        /**
+         * \brief Run the DecodeFunction of an upload.
+         * \param[in] upload The Upload to decode.
+         */
+        static void decodeJob(void *upload);
+    public:
+        /**
+         * \brief Create an empty queue.
+         * \param[in] scheduler Runs the decoding. If it has no workers, wait() runs the jobs, so finish() decodes everything.
+         */
+        explicit ImageUploadQueue(JobScheduler *scheduler);
+
+        /**
+         * \brief Calls finish().
+         */
+        ~ImageUploadQueue(void);
+
+        /**
+         * \brief Map a pixel unpack buffer and start decoding an image into it.
+         *
+         * Must be called with a current context. The GL_PIXEL_UNPACK_BUFFER binding is reset to 0.
+         * \param[in] size Number of bytes of the decoded image, as uploaded.
+         * \param[in] decode Fills the buffer, on a worker.
+         * \param[in] upload Uploads it, from finish().
+         * \param[in] userData Passed to both functions. Must stay valid until finish() has returned.
+         */
+        void add(size_t size, DecodeFunction decode, UploadFunction upload, void *userData);
+
+        /**
+         * \brief Wait for every image added so far, helping to decode them, and upload them in order.
+         *
+         * Must be called with the context that called add() current. The buffers are deleted once the uploads
+         * are queued, the driver keeps their data until the copies are done. The GL_PIXEL_UNPACK_BUFFER binding is reset to 0.
+         */
+        void finish(void);
+    };
+}
+#endif /* IMAGEUPLOADQUEUE_H */
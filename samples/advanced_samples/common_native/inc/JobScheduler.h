@@ -0,0 +1,233 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <pthread.h>
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief A work-stealing pool of threads for the CPU work of a frame.
+     *
+     * Every worker has a queue of its own. Jobs submitted from a worker go to its queue, jobs submitted from any
+     * other thread go to a shared queue. A worker takes the jobs it queued last first, as their data is most likely
+     * still in its cache, and when its queue is empty it steals the oldest jobs from the others.
+     *
+     * Jobs can depend on other jobs, and only become runnable once all of them have finished, so a frame can be
+     * described as a graph. Threads waiting for a job run other jobs in the meantime, including the rendering thread
+     * in wait() and parallelFor(), so it helps instead of idling. Every job is an ATrace section named after it.
+     *
+     * Typical usage:
+     * \code
+     * scheduler.initialize(0);
+     *
+     * JobScheduler::Job *cull = scheduler.create("cull", cullObjects, &scene);
+     * JobScheduler::Job *sort = scheduler.create("sort", sortObjects, &scene);
+     * scheduler.addDependency(sort, cull);
+     * scheduler.submit(cull);
+     * scheduler.submit(sort);
+     *
+     * scheduler.parallelFor("animate", numberOfObjects, 64, animateObjects, &scene);
+     * scheduler.wait(cull);
+     * scheduler.wait(sort);
+     * \endcode
+     *
+     * Jobs must not call OpenGL ES, the workers have no context. They may create, submit and wait for other jobs.
+     */
+    class JobScheduler
+    {
+    public:
+        /**
+         * \brief Function run by a job.
+         * \param[in] userData The pointer passed to create().
+         */
+        typedef void (*JobFunction)(void *userData);
+
+        /**
+         * \brief Function run by each job of parallelFor(), on a range of indices.
+         * \param[in] begin First index of the range.
+         * \param[in] end One past the last index of the range.
+         * \param[in] userData The pointer passed to parallelFor().
+         */
+        typedef void (*RangeFunction)(unsigned int begin, unsigned int end, void *userData);
+
+        /**
+         * \brief Handle of a job.
+         */
+        struct Job
+        {
+            const char *name;
+            JobFunction function;
+            void *userData;
+            /* Dependencies which have not finished yet, plus one until the job is submitted. */
+            std::atomic<int> blockers;
+            /* The rest is protected by the mutex of the scheduler. */
+            std::vector<Job *> dependents;
+            bool finished;
+        };
+
+    private:
+        /**
+         * \brief Jobs ready to run, queued by one thread and stolen by the others.
+         */
+        struct Queue
+        {
+            pthread_mutex_t mutex;
+            std::deque<Job *> jobs;
+        };
+
+        struct Worker
+        {
+            JobScheduler *scheduler;
+            unsigned int index;
+            pthread_t thread;
+        };
+
+        /* One queue per worker, then the queue shared by all other threads. */
+        std::vector<Queue *> queues;
+        std::vector<Worker> workers;
+        std::atomic<int> queuedJobs;
+        bool stopping;
+
+        pthread_mutex_t mutex;
+        /* Signalled when a job is queued or finishes, or the scheduler is stopping. */
+        pthread_cond_t changed;
+
+        /* Copying would leave two owners of the worker threads. */
+        JobScheduler(const JobScheduler &);
+        JobScheduler &operator=(const JobScheduler &);
+
+        /**
+         * \brief Get the queue of the calling thread.
+         * \return The index of the worker's queue on a worker of this scheduler, otherwise the shared queue.
+         */
+        unsigned int getQueueIndex(void) const;
+
+        /**
+         * \brief Queue a job which has no unfinished dependencies and wake a thread to run it.
+         * \param[in] job The job to queue.
+         */
+        void enqueue(Job *job);
+
+        /**
+         * \brief Take a job from the given queue, or steal one from the others.
+         * \param[in] queueIndex Queue of the calling thread.
+         * \return NULL if all queues are empty.
+         */
+        Job *findJob(unsigned int queueIndex);
+
+        /**
+         * \brief Run a job, mark it finished and queue the dependents it was the last dependency of.
+         * \param[in] job The job to run.
+         */
+        void run(Job *job);
+
+        /**
+         * \brief Working function of every worker thread.
+         * \param[in] worker The Worker the thread belongs to.
+         * \return Always NULL.
+         */
+        static void *workerFunction(void *worker);
+    public:
+        /**
+         * \brief Create a scheduler with no threads. Until initialize() is called, waiting runs the jobs on the calling thread.
+         */
+        JobScheduler(void);
+
+        /**
+         * \brief Calls terminate().
+         */
+        ~JobScheduler(void);
+
+        /**
+         * \brief Count the big cores, those whose maximum frequency is above the lowest maximum of all cores.
+         * \return The number of big cores, or of all cores if they all run at the same speed.
+         */
+        static unsigned int getNumberOfBigCores(void);
+
+        /**
+         * \brief Start the worker threads.
+         * \param[in] numberOfWorkers Number of threads to start. 0 starts one per big core, minus the calling thread,
+         *                            as little cores are often slower than the rendering thread they would hold up.
+         * \return The number of threads started.
+         */
+        unsigned int initialize(unsigned int numberOfWorkers);
+
+        /**
+         * \brief Stop the worker threads, once they have run the jobs still queued.
+         *
+         * Every job which has been created must have been passed to wait() first.
+         */
+        void terminate(void);
+
+        /**
+         * \brief Get the number of worker threads.
+         * \return 0 if initialize() has not been called or could not start any thread.
+         */
+        unsigned int getNumberOfWorkers(void) const;
+
+        /**
+         * \brief Create a job. It does not run until it is passed to submit().
+         * \param[in] name Name of the job's ATrace section. Must stay valid until the job has run, a string literal typically.
+         * \param[in] function The function to run.
+         * \param[in] userData Passed to the function.
+         * \return The handle, to be passed to submit() and then wait() exactly once.
+         */
+        Job *create(const char *name, JobFunction function, void *userData);
+
+        /**
+         * \brief Make a job wait for another one to finish before it runs.
+         * \param[in] job A job which has not been submitted yet.
+         * \param[in] dependency A job which has not been passed to wait() yet.
+         */
+        void addDependency(Job *job, Job *dependency);
+
+        /**
+         * \brief Let a job run, as soon as its dependencies have finished.
+         * \param[in] job A handle returned by create().
+         */
+        void submit(Job *job);
+
+        /**
+         * \brief Run other jobs until a job has finished.
+         *
+         * The handle is released and must not be used afterwards.
+         * \param[in] job A submitted job.
+         */
+        void wait(Job *job);
+
+        /**
+         * \brief Run a function on a range of indices split into jobs, and wait for all of them.
+         * \param[in] name Name of the jobs' ATrace sections.
+         * \param[in] count Number of indices, the function is called on ranges of [0, count).
+         * \param[in] grainSize Number of indices per job. 0 splits the range into a few jobs per thread.
+         * \param[in] function The function to run on each range.
+         * \param[in] userData Passed to the function.
+         */
+        void parallelFor(const char *name, unsigned int count, unsigned int grainSize, RangeFunction function, void *userData);
+    };
+}
+#endif /* JOBSCHEDULER_H */
@@ -0,0 +1,80 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef JSONVALUE_H
+#define JSONVALUE_H
+
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief A parsed JSON value, for reading back the reports the samples and tools write.
+     *
+     * Object members are kept in order, their keys in keys and their values in items. Array elements are in items.
+     */
+    struct JsonValue
+    {
+        enum Type
+        {
+            Null,
+            Boolean,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        Type type;
+        bool boolean;
+        double number;
+        std::string text;
+        std::vector<std::string> keys;
+        std::vector<JsonValue> items;
+
+        JsonValue(void);
+
+        /**
+         * \brief The member of an object called key.
+         * \return NULL if there is no such member, or if this is not an object.
+         */
+        const JsonValue *get(const char *key) const;
+
+        /**
+         * \brief The string member called key, or an empty string if it is missing or not a string.
+         */
+        std::string getString(const char *key) const;
+
+        /**
+         * \brief The number member called key, or 0 if it is missing or not a number.
+         */
+        double getNumber(const char *key) const;
+
+        /**
+         * \brief Parse a whole JSON document.
+         * \param[in] text Null terminated JSON text.
+         * \param[out] value The root value.
+         * \return False if the text is not valid JSON, or has anything but spaces after the root value.
+         */
+        static bool parse(const char *text, JsonValue &value);
+    };
+}
+#endif /* JSONVALUE_H */
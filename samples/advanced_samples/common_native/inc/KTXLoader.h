@@ -0,0 +1,118 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef KTXLOADER_H
+#define KTXLOADER_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else 
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <cstddef>
+
+namespace MaliSDK
+{
+    /**
+     * \brief What was loaded from a KTX file, and how long it took.
+     */
+    struct KTXTextureInfo
+    {
+        /** GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP or GL_TEXTURE_2D_ARRAY. */
+        GLenum target;
+        /** Internal format of the texture, e.g. GL_COMPRESSED_RGBA_ASTC_4x4_KHR. */
+        GLenum internalFormat;
+        int width;
+        int height;
+        /** 0 if the texture is not an array texture. */
+        int numberOfLayers;
+        int numberOfFaces;
+        int numberOfLevels;
+        /** Total size of the image data uploaded, in bytes. */
+        size_t dataSize;
+        /** Time spent in the upload calls, in milliseconds. This is driver time on the CPU, not GPU time. */
+        float uploadTime;
+    };
+
+    /**
+     * \brief Loads textures with all their mip levels, faces and array layers from a single KTX file.
+     *
+     * Both KTX 1.1 and KTX 2.0 files are supported. The file is mapped once and every image is passed
+     * to glCompressedTexImage2D() or glCompressedTexImage3D() straight from the mapping.
+     * KTX 1.1 files can hold any format the driver accepts, compressed or not. KTX 2.0 files must hold
+     * ETC1, ETC2, EAC or ASTC data without supercompression.
+     * Array textures need OpenGL ES 3.0.
+     */
+    class KTXLoader
+    {
+    private:
+        /**
+         * \brief Load a KTX 1.1 file.
+         * \param[in] data The contents of the file.
+         * \param[in] size The size of the file.
+         * \param[in] texture The texture to bind and upload to.
+         * \param[out] info The description of the texture, filled in as the file is parsed.
+         * \return False if the file is not a valid KTX 1.1 file.
+         */
+        static bool loadKTX1(const unsigned char *data, size_t size, GLuint texture, KTXTextureInfo *info);
+
+        /**
+         * \brief Load a KTX 2.0 file.
+         * \param[in] data The contents of the file.
+         * \param[in] size The size of the file.
+         * \param[in] texture The texture to bind and upload to.
+         * \param[out] info The description of the texture, filled in as the file is parsed.
+         * \return False if the file is not a valid KTX 2.0 file or uses a format this loader does not know.
+         */
+        static bool loadKTX2(const unsigned char *data, size_t size, GLuint texture, KTXTextureInfo *info);
+
+        /**
+         * \brief Upload one mip level of the texture bound to info->target.
+         * \param[in] info The description of the texture.
+         * \param[in] level The mip level.
+         * \param[in] face The cube map face, 0 if not a cube map.
+         * \param[in] width Width of the level.
+         * \param[in] height Height of the level.
+         * \param[in] format Pixel format of the data, 0 for compressed data.
+         * \param[in] type Pixel type of the data, 0 for compressed data.
+         * \param[in] imageSize Size of the data. For array textures it covers all layers.
+         * \param[in] data The image data.
+         * \return False if the driver rejected the image, typically because it does not support the format.
+         */
+        static bool uploadLevel(const KTXTextureInfo *info, int level, int face, int width, int height,
+                               GLenum format, GLenum type, size_t imageSize, const unsigned char *data);
+    public:
+        /**
+         * \brief Create a texture from a KTX file.
+         *
+         * The texture is left bound to its target on the active texture unit, with mipmapped filtering if the file has mip levels.
+         * The upload time is logged.
+         * \param[in] filename Path of the KTX file.
+         * \param[out] textureID The texture ID of the new texture, 0 on failure.
+         * \param[out] info If not NULL, used to store what was loaded.
+         * \return False if the file cannot be read, is not a valid KTX file, or holds something the driver rejects.
+         */
+        static bool load(const char *filename, GLuint *textureID, KTXTextureInfo *info = NULL);
+    };
+}
+#endif /* KTXLOADER_H */
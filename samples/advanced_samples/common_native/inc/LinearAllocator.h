@@ -0,0 +1,87 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef LINEARALLOCATOR_H
+#define LINEARALLOCATOR_H
+
+#include "Allocator.h"
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Frame-scoped arena. Allocations bump a pointer through one block and are all released by reset().
+     *
+     * deallocate() does nothing. When the block is full, allocations fall back to the heap so nothing fails, and
+     * the next reset() grows the block to the peak usage so that steady-state frames never touch the heap.
+     *
+     * Typical usage, once per frame:
+     * \code
+     * frameAllocator.reset();
+     * float *vertices = static_cast<float *>(frameAllocator.allocate(numberOfVertices * 4 * sizeof(float)));
+     * ...
+     * glBufferSubData(GL_ARRAY_BUFFER, 0, numberOfVertices * 4 * sizeof(float), vertices);
+     * \endcode
+     */
+    class LinearAllocator : public Allocator
+    {
+    private:
+        unsigned char *memory;
+        size_t capacity;
+        size_t offset;
+
+        /* Heap allocations made while the block was full, and the bytes they would have needed in the block. */
+        std::vector<void *> overflow;
+        size_t overflowSize;
+
+        LinearAllocator(const LinearAllocator &);
+        LinearAllocator &operator=(const LinearAllocator &);
+
+    public:
+        /**
+         * \brief Create the arena.
+         * \param[in] capacity Initial size of the block in bytes.
+         */
+        LinearAllocator(size_t capacity = 64 * 1024);
+
+        ~LinearAllocator(void);
+
+        void *allocate(size_t size, size_t alignment = defaultAlignment);
+
+        void deallocate(void *pointer);
+
+        /**
+         * \brief Release everything allocated since the previous reset. Pointers returned before become invalid.
+         */
+        void reset(void);
+
+        /**
+         * \brief Bytes allocated since the previous reset, including alignment padding and heap fallbacks.
+         */
+        size_t getUsedSize(void) const;
+
+        /**
+         * \brief Size of the block in bytes.
+         */
+        size_t getCapacity(void) const;
+    };
+}
+#endif /* LINEARALLOCATOR_H */
@@ -44,7 +44,7 @@ namespace MaliSDK
          * \param[in] right Second matrix to multiply.
          * \return The result of left * right 
          */
-        static Matrix multiply(Matrix *left, Matrix *right);
+        static Matrix multiply(const Matrix *left, const Matrix *right);
     public:       
         /**
          * \brief Get the matrix elements as a column major order array.
@@ -69,18 +69,25 @@ namespace MaliSDK
          * \param[in] right The matrix to post multiply by.
          * \return The result of matrix * right.
          */
-        Matrix operator* (Matrix right);
-
-        /**
-         * \brief Overloading assingment operater to do deep copy of the Matrix elements.
-         */
-        Matrix& operator=(const Matrix &another);
+        Matrix operator* (const Matrix &right) const;
 
         /**
          * \brief Constructor from element array.
          * \param[in] array A column major order array to use as the matrix elements.
          */
         Matrix(const float* array);
+
+        /**
+         * \brief Constructor from a VectorMath.h matrix.
+         * \param[in] matrix The matrix to copy the elements of.
+         */
+        Matrix(const math::mat4 &matrix);
+
+        /**
+         * \brief Get the matrix as a VectorMath.h matrix, for maths in a loop which should be inlined.
+         * \return A copy of the matrix elements.
+         */
+        math::mat4 getAsMat4(void) const;
         
         /**
          * \brief The identity matrix.
@@ -89,13 +96,21 @@ namespace MaliSDK
          */
         static Matrix identityMatrix;
 
+        /**
+         * \brief The bias matrix.
+         *
+         * Maps clip space coordinates in the range [-1, 1] to texture coordinates in the range [0, 1].
+         * Typically used when sampling shadow maps or projected textures.
+         */
+        static Matrix biasMatrix;
+
         /**
          * \brief Transform a 4D vertex by a matrix.
          * \param[in] vector The 4D vector to be transformed.
          * \param[in] matrix The transformation matrix.
          * \return The result of matrix x vector
          */
-        static Vec4f vertexTransform(Vec4f *vector, Matrix *matrix);
+        static Vec4f vertexTransform(const Vec4f *vector, const Matrix *matrix);
 
         /**
          * \brief Transform a 3D vertex by a matrix.
@@ -103,7 +118,29 @@ namespace MaliSDK
          * \param[in] matrix The transformation matrix.
          * \return The result of matrix x vector
          */
-        static Vec3f vertexTransform(Vec3f *vector, Matrix *matrix);
+        static Vec3f vertexTransform(const Vec3f *vector, const Matrix *matrix);
+
+        /**
+         * \brief Transform an array of 4D vertices by a matrix.
+         *
+         * Cheaper than calling vertexTransform() per vertex as the matrix is only loaded once.
+         * \param[in] vertices The 4D vectors to be transformed.
+         * \param[out] results Array of at least count elements to receive matrix x vertices[i]. May be the same array as vertices.
+         * \param[in] count The number of vertices to transform.
+         * \param[in] matrix The transformation matrix.
+         */
+        static void vertexTransformArray(const Vec4f *vertices, Vec4f *results, int count, const Matrix *matrix);
+
+        /**
+         * \brief Transform an array of 3D vertices by a matrix.
+         *
+         * The vertices are treated as points (w = 1.0f). No perspective divide is performed.
+         * \param[in] vertices The 3D vectors to be transformed.
+         * \param[out] results Array of at least count elements to receive matrix x vertices[i]. May be the same array as vertices.
+         * \param[in] count The number of vertices to transform.
+         * \param[in] matrix The transformation matrix.
+         */
+        static void vertexTransformArray(const Vec3f *vertices, Vec3f *results, int count, const Matrix *matrix);
 
         /**
          * \brief Transpose a matrix in-place.
@@ -176,6 +213,18 @@ namespace MaliSDK
 		 */
 		static Matrix matrixCameraLookAt(Vec3f eye, Vec3f center, Vec3f up); 
 
+        /**
+         * \brief Create and return a look at matrix.
+         *
+         * Differs from matrixCameraLookAt() in the translation, which is built from the dot products
+         * of the camera axes and the eye position rather than from the negated eye position.
+         * \param[in] eye Point vector which determines the camera position.
+         * \param[in] center Point vector which determines where camera is looking at.
+         * \param[in] up Vector which determines the orientation of the "head".
+         * \return A look at matrix.
+         */
+        static Matrix matrixLookAt(Vec3f eye, Vec3f center, Vec3f up);
+
         /**
          * \brief Create and return an orthographic projection matrix. 
          *
@@ -195,7 +244,7 @@ namespace MaliSDK
          * \param[in] matrix The matrix to invert.
          * \return The inverse matrix of matrix.
          */
-        static Matrix matrixInvert(Matrix *matrix);
+        static Matrix matrixInvert(const Matrix *matrix);
 
         /**
          * \brief Calculate determinant of supplied 3x3 matrix.
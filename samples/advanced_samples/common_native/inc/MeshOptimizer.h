@@ -0,0 +1,99 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief An indexed triangle list with interleaved float vertices.
+     *
+     * Offsets are in floats from the start of a vertex, -1 when the attribute is absent.
+     */
+    struct IndexedModel
+    {
+        int floatsPerVertex;
+        int positionOffset;
+        int positionComponents;
+        int normalOffset;
+        int uvOffset;
+        /** Tangent and handedness, four floats, see TangentFrames. */
+        int tangentOffset;
+
+        std::vector<float> vertices;
+        std::vector<unsigned short> indices;
+
+        IndexedModel(void)
+            : floatsPerVertex(0), positionOffset(-1), positionComponents(0), normalOffset(-1), uvOffset(-1), tangentOffset(-1)
+        {
+        }
+
+        int getNumberOfVertices(void) const
+        {
+            return floatsPerVertex > 0 ? (int)vertices.size() / floatsPerVertex : 0;
+        }
+    };
+
+    /**
+     * \brief Turns flat triangle lists into indexed models and orders them for the GPU.
+     *
+     * optimize() runs, in order:
+     * - Tipsify (Sander et al. 2007) to reorder triangles for the post-transform vertex cache,
+     * - overdraw ordering, which sorts the clusters Tipsify produced so that triangles facing away from the centre
+     *   of the model are drawn first and occlude the rest, then
+     * - reordering of the vertices by first use, so vertex fetches walk the buffer linearly.
+     */
+    class MeshOptimizer
+    {
+    private:
+        static void optimizeVertexCache(std::vector<unsigned short> &indices, int numberOfVertices, int cacheSize, std::vector<int> *clusters);
+        static void optimizeOverdraw(IndexedModel *model, const std::vector<int> &clusters);
+        static void optimizeVertexFetch(IndexedModel *model);
+
+    public:
+        /**
+         * \brief Interleave vertex streams of a flat triangle list and merge identical vertices.
+         *
+         * \param[in] streams One array per attribute, each holding numberOfVertices vertices.
+         * \param[in] components Number of floats per vertex of each stream.
+         * \param[in] numberOfStreams Number of streams. The first one is the position.
+         * \param[in] numberOfVertices Number of vertices in the triangle list, a multiple of 3.
+         * \param[out] model Receives the vertices and indices. The attribute offsets are left for the caller.
+         * \return False if more than 65536 unique vertices remain, which 16-bit indices cannot address.
+         */
+        static bool index(const float *const *streams, const int *components, int numberOfStreams, int numberOfVertices, IndexedModel *model);
+
+        /**
+         * \brief Reorder the triangles and vertices of a model, see the class description.
+         * \param[in, out] model The model. Its positionOffset must be set.
+         * \param[in] cacheSize Number of entries of the post-transform cache to optimize for.
+         */
+        static void optimize(IndexedModel *model, int cacheSize = 16);
+
+        /**
+         * \brief Average number of vertices transformed per triangle with a FIFO cache, between 0.5 and 3.
+         */
+        static float getACMR(const std::vector<unsigned short> &indices, int numberOfVertices, int cacheSize = 16);
+    };
+}
+#endif /* MESHOPTIMIZER_H */
@@ -0,0 +1,303 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MICROBENCHMARKS_H
+#define MICROBENCHMARKS_H
+
+#include <GLES3/gl3.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief One measurement of the suite.
+     *
+     * The suite sets a case up, renders warm-up frames, then times a fixed number of frames from the first GL call
+     * to the end of glFinish() and reports the units of work renderFrame() issued per second.
+     * Cases render to framebuffers of their own, so the results do not depend on the size of the window.
+     */
+    class MicroBenchmark
+    {
+    public:
+        virtual ~MicroBenchmark(void) {}
+
+        /**
+         * \brief Name of the case in the log and the report, e.g. "fill_rgba8_blend".
+         */
+        virtual const char *getName(void) const = 0;
+
+        /**
+         * \brief What renderFrame() counts, e.g. "draws".
+         */
+        virtual const char *getUnit(void) const = 0;
+
+        /**
+         * \brief Create the objects the case needs.
+         * \return false if the device cannot run the case, which is then reported as unsupported.
+         */
+        virtual bool setUp(void) = 0;
+
+        /**
+         * \brief Issue one frame of work.
+         * \return The number of units issued.
+         */
+        virtual double renderFrame(void) = 0;
+
+        /**
+         * \brief Delete everything setUp() created.
+         */
+        virtual void tearDown(void) = 0;
+    };
+
+    /**
+     * \brief Draw calls and state changes.
+     *
+     * Thousands of tiny triangles are drawn into a small framebuffer, so the GPU has next to nothing to do and
+     * the driver's cost per draw call dominates. Each variant changes one piece of state before every draw.
+     * The objects it switches between are distinct but equivalent, so nothing can be skipped as redundant.
+     */
+    class DrawCallBenchmark : public MicroBenchmark
+    {
+    public:
+        enum StateChange
+        {
+            NoChange,
+            ProgramChange,
+            TextureChange,
+            VertexArrayChange,
+            UniformBufferRangeChange
+        };
+
+        DrawCallBenchmark(StateChange change);
+
+        virtual const char *getName(void) const;
+        virtual const char *getUnit(void) const;
+        virtual bool setUp(void);
+        virtual double renderFrame(void);
+        virtual void tearDown(void);
+
+    private:
+        static const int drawsPerFrame = 2000;
+        static const int objectCount = 8;
+
+        StateChange change;
+        GLuint framebuffer;
+        GLuint colorTexture;
+        GLuint programs[2];
+        GLuint textures[objectCount];
+        GLuint vertexArrays[objectCount];
+        GLuint vertexBuffers[objectCount];
+        GLuint uniformBuffer;
+        GLint uniformRangeStride;
+        int uniformRangeCount;
+    };
+
+    /**
+     * \brief Vertex shading throughput.
+     *
+     * A large vertex buffer is drawn as triangles which all have zero area, so every vertex is fetched and
+     * transformed but nothing is rasterised.
+     */
+    class VertexThroughputBenchmark : public MicroBenchmark
+    {
+    public:
+        VertexThroughputBenchmark(void);
+
+        virtual const char *getName(void) const;
+        virtual const char *getUnit(void) const;
+        virtual bool setUp(void);
+        virtual double renderFrame(void);
+        virtual void tearDown(void);
+
+    private:
+        static const int vertexCount = 1 << 20;
+        static const int drawsPerFrame = 4;
+
+        GLuint framebuffer;
+        GLuint colorTexture;
+        GLuint program;
+        GLuint vertexArray;
+        GLuint vertexBuffer;
+        GLint transformLocation;
+    };
+
+    /**
+     * \brief Fill rate for one render target format, with or without blending.
+     *
+     * Full screen triangles with a trivial fragment shader are drawn on top of each other.
+     * The shader can discard, as far as the GPU knows, so hidden surface removal cannot skip the layers
+     * further down and every layer is shaded and written.
+     */
+    class FillRateBenchmark : public MicroBenchmark
+    {
+    public:
+        /**
+         * \param[in] internalFormat Sized format of the render target.
+         * \param[in] formatName     Short name of the format for the name of the case.
+         * \param[in] blend          Whether to blend each layer over the previous one.
+         */
+        FillRateBenchmark(GLenum internalFormat, const char *formatName, bool blend);
+
+        virtual const char *getName(void) const;
+        virtual const char *getUnit(void) const;
+        virtual bool setUp(void);
+        virtual double renderFrame(void);
+        virtual void tearDown(void);
+
+    private:
+        static const int targetSize = 1024;
+        static const int layersPerFrame = 16;
+
+        GLenum internalFormat;
+        bool blend;
+        char name[64];
+        GLuint framebuffer;
+        GLuint colorTexture;
+        GLuint program;
+        GLuint vertexArray;
+    };
+
+    /**
+     * \brief Texture sampling rate for one texture format.
+     *
+     * Full screen triangles sample a texture of random content four times per fragment, close to one texel
+     * per pixel, with bilinear filtering. Compressed textures are encoded on the CPU so no assets are needed.
+     */
+    class TextureSamplingBenchmark : public MicroBenchmark
+    {
+    public:
+        /**
+         * \param[in] internalFormat GL_RGBA8, or one of the ETC2, EAC or ASTC LDR compressed formats.
+         * \param[in] formatName     Short name of the format for the name of the case.
+         */
+        TextureSamplingBenchmark(GLenum internalFormat, const char *formatName);
+
+        virtual const char *getName(void) const;
+        virtual const char *getUnit(void) const;
+        virtual bool setUp(void);
+        virtual double renderFrame(void);
+        virtual void tearDown(void);
+
+    private:
+        static const int targetSize = 1024;
+        static const int textureSize = 1024;
+        static const int layersPerFrame = 8;
+        static const int samplesPerFragment = 4;
+
+        GLenum internalFormat;
+        char name[64];
+        GLuint framebuffer;
+        GLuint colorTexture;
+        GLuint program;
+        GLuint vertexArray;
+        GLuint texture;
+    };
+
+    /**
+     * \brief Runs micro-benchmarks one after another, one frame per step().
+     *
+     * Each case is set up, renders warm-up frames, for clocks to ramp up and caches to fill, then measured frames,
+     * each timed from its first GL call to the end of glFinish(), and is torn down. Running a frame per step() keeps
+     * the application responsive, and whatever it draws between steps is not counted.
+     * Times follow the real clock, even when a fixed time step is set for the animation clock.
+     */
+    class MicroBenchmarkSuite
+    {
+    public:
+        /**
+         * \brief What has been measured of a case.
+         */
+        struct Result
+        {
+            /** False until the case has been set up, and if the device cannot run it. */
+            bool supported;
+            /** True once all frames of the case have been measured, or it turned out to be unsupported. */
+            bool finished;
+            int frames;
+            double units;
+            double seconds;
+
+            /**
+             * \return The units of work per second, 0 if nothing has been measured.
+             */
+            double getRate(void) const;
+        };
+
+        /**
+         * \param[in] warmupFrames   Frames rendered before measuring each case.
+         * \param[in] measuredFrames Frames measured of each case.
+         */
+        MicroBenchmarkSuite(int warmupFrames = 10, int measuredFrames = 50);
+
+        /**
+         * \brief Deletes the cases, tearing down the one which is running.
+         */
+        ~MicroBenchmarkSuite(void);
+
+        /**
+         * \brief Add a case, the suite deletes it.
+         */
+        void add(MicroBenchmark *benchmark);
+
+        /**
+         * \brief Add every case: draw calls, state changes, vertex throughput,
+         * fill rate per format opaque and blended, and sampling rate per texture format.
+         */
+        void addDefaultBenchmarks(void);
+
+        /**
+         * \brief Render one frame of the current case, moving on to the next one when it is done.
+         *
+         * Leaves the framebuffer of the case bound.
+         */
+        void step(void);
+
+        /**
+         * \return True once every case has finished.
+         */
+        bool isFinished(void) const;
+
+        /**
+         * \return Index of the case step() runs next, getCount() once finished.
+         */
+        size_t getCurrent(void) const;
+
+        size_t getCount(void) const;
+        const MicroBenchmark *getBenchmark(size_t index) const;
+        const Result &getResult(size_t index) const;
+
+        int getWarmupFrames(void) const;
+        int getMeasuredFrames(void) const;
+
+    private:
+        MicroBenchmarkSuite(const MicroBenchmarkSuite &);
+        MicroBenchmarkSuite &operator=(const MicroBenchmarkSuite &);
+
+        int warmupFrames;
+        int measuredFrames;
+        std::vector<MicroBenchmark *> benchmarks;
+        std::vector<Result> results;
+        size_t current;
+        int frame;
+    };
+}
+#endif /* MICROBENCHMARKS_H */
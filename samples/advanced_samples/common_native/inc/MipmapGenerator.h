@@ -0,0 +1,146 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIPMAPGENERATOR_H
+#define MIPMAPGENERATOR_H
+
+#include <GLES3/gl31.h>
+
+#include <map>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Builds the mipmap levels of 2D textures on the GPU, with a known filter and in linear space.
+     *
+     * glGenerateMipmap() leaves the filter, and whether sRGB texels are decoded first, to the driver, and some
+     * drivers build the levels on the CPU. Here every level is the average of the level above it, or a Kaiser
+     * windowed sinc over 6 by 6 of its texels, which keeps minified detail sharper. Colours are filtered in linear
+     * space: sRGB textures are decoded and encoded by the hardware, and sRGB images stored as GL_RGBA8 can ask for it.
+     *
+     * The levels are made in one of three ways, see Path:
+     * - with compute shaders on OpenGL ES 3.1, for immutable GL_RGBA8, GL_RGBA8_SNORM, GL_RGBA16F, GL_RGBA32F and
+     *   GL_R32F textures. A box filter makes 4 levels per dispatch, the group reducing its tile in shared memory,
+     *   so a 1024 by 1024 texture takes 3 dispatches. Kaiser needs the neighbouring tiles and does one level per
+     *   dispatch.
+     * - drawing each level from the one above it, for the other immutable textures which can be rendered to,
+     *   GL_SRGB8_ALPHA8 among them, and for every immutable texture on OpenGL ES 3.0.
+     * - with glGenerateMipmap(), for textures allocated with glTexImage2D(), whose levels may not exist yet, and
+     *   formats which cannot be rendered to.
+     *
+     * Nothing is read back, so generating the levels does not wait for the GPU. Programs are compiled the first
+     * time a combination of format, filter and colour space needs them.
+     *
+     * Typical usage:
+     * \code
+     * MipmapGenerator mipmapGenerator;
+     *
+     * glTexStorage2D(GL_TEXTURE_2D, levels, GL_SRGB8_ALPHA8, width, height);
+     * glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+     * mipmapGenerator.generate(texture, GL_SRGB8_ALPHA8, width, height, MipmapGenerator::Kaiser);
+     * \endcode
+     *
+     * Only available in OpenGL ES 3.0 builds. Must be created and used with a current context.
+     */
+    class MipmapGenerator
+    {
+    public:
+        enum Filter
+        {
+            /** Average of 2 by 2 texels, as glGenerateMipmap() usually does. */
+            Box,
+            /** Kaiser windowed sinc, 3 texels of the new level wide. Sharper, may ring a little on hard edges. */
+            Kaiser
+        };
+
+        enum Path
+        {
+            /** Compute shaders writing the levels as images. */
+            Compute,
+            /** A triangle drawn into every level. */
+            Fragment,
+            /** glGenerateMipmap(). */
+            Driver
+        };
+
+    private:
+        /**
+         * \brief A compiled program and the locations of the uniforms set for every level.
+         */
+        struct Program
+        {
+            GLuint program;
+            GLint sourceSizeLocation;
+            GLint sourceLevelLocation;
+        };
+
+        /* Keyed by filter, colour space, format and number of levels, see getComputeProgram() and getFragmentProgram(). */
+        std::map<unsigned int, Program> computePrograms;
+        std::map<unsigned int, Program> fragmentPrograms;
+
+        bool computeSupported;
+        GLuint framebuffer;
+        GLuint vertexArray;
+
+        /* Weights of the 6 taps of the Kaiser filter along an axis, nearest first. The other 3 mirror them. */
+        float kaiserWeights[3];
+
+        const Program &getComputeProgram(Filter filter, GLenum internalFormat, bool srgb, int levels);
+        const Program &getFragmentProgram(Filter filter, bool srgb);
+        Program linkProgram(GLuint program, Filter filter);
+
+        void generateWithCompute(GLuint texture, GLenum internalFormat, GLsizei width, GLsizei height, GLint levels, Filter filter, bool srgb);
+        bool generateWithFragment(GLuint texture, GLsizei width, GLsizei height, GLint levels, Filter filter, bool srgb);
+
+        /* Copying would leave two owners of the GL objects. */
+        MipmapGenerator(const MipmapGenerator &);
+        MipmapGenerator &operator=(const MipmapGenerator &);
+    public:
+        /**
+         * \brief Check the OpenGL ES version. Must be called with a current context.
+         */
+        MipmapGenerator(void);
+
+        /**
+         * \brief Delete the programs.
+         */
+        ~MipmapGenerator(void);
+
+        /**
+         * \brief Rebuild every level of a 2D texture below level 0 from level 0.
+         *
+         * Deeper levels of immutable textures are made as far as GL_TEXTURE_IMMUTABLE_LEVELS allows. Changes the
+         * current program and vertex array, binds framebuffer 0 and leaves depth testing, blending and the scissor
+         * test off when levels are drawn, and leaves texture unit 0 active with the texture bound to it.
+         * GL_TEXTURE_BASE_LEVEL and GL_TEXTURE_MAX_LEVEL of the texture are restored.
+         *
+         * \param[in] texture The texture, level 0 filled.
+         * \param[in] internalFormat Its internal format, which OpenGL ES 3.0 cannot query.
+         * \param[in] width Width of level 0.
+         * \param[in] height Height of level 0.
+         * \param[in] filter How the texels of a level are filtered to make the next one.
+         * \param[in] srgb Whether a GL_RGBA8 texture holds sRGB colours, to filter them in linear space. Textures with
+         *                 an sRGB internal format always are.
+         * \return How the levels were made.
+         */
+        Path generate(GLuint texture, GLenum internalFormat, GLsizei width, GLsizei height, Filter filter = Box, bool srgb = false);
+    };
+}
+#endif /* MIPMAPGENERATOR_H */
@@ -0,0 +1,196 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NATIVEFENCEQUEUE_H
+#define NATIVEFENCEQUEUE_H
+
+#include "FrameStatistics.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <pthread.h>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Hands frames from a producer to a consumer with native fences of EGL_ANDROID_native_fence_sync, so
+     * neither side waits on the CPU for the GPU work of the other.
+     *
+     * The queue has a fixed number of slots, which the caller maps to its own resources, a texture each for instance.
+     * Every slot carries a native fence file descriptor, signalled once the last side which touched the slot is done:
+     * - The producer calls dequeue() to get a slot nobody uses, renders or uploads into its resource and calls queue().
+     *   queue() fences the work of its current context, or takes over a fence the producer already has.
+     * - The consumer calls acquire() at the start of a frame, to pick up the latest queued slot, and release() with the
+     *   slot it displayed before once the draws reading it have been submitted.
+     * Both dequeue() and acquire() make the GPU of the current context wait for the fence with eglWaitSyncKHR(), so the
+     * CPU carries on. Unlike a GLsync, a native fence is a file descriptor, so the two sides do not need shared
+     * contexts: the producer can be a worker context, a decoder or camera callback without a context, or another
+     * process receiving the fences over a socket, and handing its own fences in through queue().
+     *
+     * As TripleBuffer, the queue is a mailbox: frames the consumer has not picked up are dropped for newer ones, and
+     * dequeue() takes the oldest queued slot back when no slot is free, so the producer never waits for the consumer.
+     *
+     * Typical usage, with one texture per slot:
+     * \code
+     * // Producing thread, with a context current.
+     * int slot = queue->dequeue();
+     * // Upload to textures[slot].
+     * queue->queue(slot);
+     *
+     * // Rendering thread.
+     * int previous = displayed;
+     * int acquired = queue->acquire();
+     * if (acquired >= 0)
+     * {
+     *     displayed = acquired;
+     * }
+     * // Draws sampling textures[displayed].
+     * if (acquired >= 0 && previous >= 0)
+     * {
+     *     queue->release(previous);
+     * }
+     * \endcode
+     *
+     * The time from queue() to acquire() of every frame picked up is recorded, see getLatencyStatistics().
+     * Only one thread may produce and one consume. Only available in OpenGL ES 3.0 builds.
+     */
+    class NativeFenceQueue
+    {
+    private:
+        enum SlotState
+        {
+            SLOT_FREE,
+            SLOT_DEQUEUED,
+            SLOT_QUEUED,
+            SLOT_ACQUIRED
+        };
+
+        struct Slot
+        {
+            SlotState state;
+            /* Signalled when the side which had the slot last is done with it, or -1. */
+            int fence;
+            /* When the slot was queued, in nanoseconds. Orders the queued slots. */
+            long long queueTime;
+        };
+
+        EGLDisplay display;
+        pthread_mutex_t mutex;
+        std::vector<Slot> slots;
+        int droppedFrames;
+
+        /* Only touched by the consumer. */
+        FrameStatistics latencyStatistics;
+
+        /* Prevent copying, the fences are owned. */
+        NativeFenceQueue(const NativeFenceQueue &);
+        NativeFenceQueue &operator=(const NativeFenceQueue &);
+    public:
+        /**
+         * \brief Whether native fences can be created and waited for. Must be called with a current context.
+         */
+        static bool isSupported(void);
+
+        /**
+         * \brief Create a native fence signalled when the commands submitted so far in the current context are done.
+         *
+         * Flushes the context, as the fence only gets a file descriptor once flushed.
+         * \return The file descriptor, owned by the caller, or -1 if no fence could be created. The commands are
+         * then finished with glFinish(), so they are done as if the fence had been signalled.
+         */
+        static int createFence(void);
+
+        /**
+         * \brief Make the GPU of the current context wait for a native fence before the commands submitted after this.
+         *
+         * Waits on the CPU instead if the fence cannot be imported.
+         * \param[in] fence File descriptor taken over and closed by the call. Nothing is done for -1.
+         */
+        static void waitFence(int fence);
+
+        /**
+         * \brief Create a queue with all slots free. Must be called with a current context in which isSupported().
+         * \param[in] numberOfSlots Number of resources handed around, three lets both sides always have one.
+         */
+        NativeFenceQueue(int numberOfSlots = 3);
+
+        /**
+         * \brief Close the fences. The resources of the slots belong to the caller.
+         */
+        ~NativeFenceQueue(void);
+
+        /**
+         * \brief Get a slot neither queued nor used by the consumer. Producing thread only.
+         *
+         * A free slot is taken first. Without one, the oldest queued slot is taken back and its frame dropped.
+         * \param[out] releaseFence If not NULL, receives the fence of the slot, owned by the caller, or -1. A producer
+         * without a context waits for it itself, or passes it on. If NULL, the current context waits for it.
+         * \return The slot, or -1 if the consumer holds every slot.
+         */
+        int dequeue(int *releaseFence = NULL);
+
+        /**
+         * \brief Hand a slot returned by dequeue() over to the consumer. Producing thread only.
+         * \param[in] slot The slot.
+         * \param[in] acquireFence Fence signalled when the producer is done with the slot, taken over by the queue.
+         * If -1, the work submitted so far in the current context is fenced with createFence().
+         */
+        void queue(int slot, int acquireFence = -1);
+
+        /**
+         * \brief Pick up the latest queued slot, if any. Consuming thread only.
+         *
+         * Older queued slots are dropped and become free. The current context waits for the fence of the slot
+         * returned, and the time since it was queued is recorded.
+         * \return The slot, which the consumer has until release(), or -1 if nothing was queued since the last call.
+         */
+        int acquire(void);
+
+        /**
+         * \brief Give a slot returned by acquire() back to the producer. Consuming thread only.
+         *
+         * Call after the last draw reading the resource of the slot.
+         * \param[in] slot The slot.
+         * \param[in] releaseFence Fence signalled when the consumer is done with the slot, taken over by the queue.
+         * If -1, the work submitted so far in the current context is fenced with createFence().
+         */
+        void release(int slot, int releaseFence = -1);
+
+        /**
+         * \brief Number of slots of the queue.
+         */
+        int getNumberOfSlots(void) const;
+
+        /**
+         * \brief Number of queued frames dropped because a newer one was queued before the consumer picked them up.
+         */
+        int getNumberOfDroppedFrames(void);
+
+        /**
+         * \brief Time from queue() to acquire() of the frames picked up, in milliseconds. Consuming thread only.
+         *
+         * This is how long a frame waits before the consumer starts using it, the GPU work of the producer
+         * still running after that is waited for by the GPU of the consumer.
+         */
+        FrameStatistics &getLatencyStatistics(void);
+    };
+}
+#endif /* NATIVEFENCEQUEUE_H */
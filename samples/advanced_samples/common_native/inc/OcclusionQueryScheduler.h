@@ -0,0 +1,148 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef OCCLUSIONQUERYSCHEDULER_H
+#define OCCLUSIONQUERYSCHEDULER_H
+
+#include <GLES3/gl3.h>
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Issues GL_ANY_SAMPLES_PASSED queries for a set of objects and collects their results without ever blocking.
+     *
+     * Reading a query result in the frame that issued it waits for the GPU to render that far, which serializes the
+     * CPU and the GPU. Here a query is only polled once it is at least latency frames old, and only through
+     * GL_QUERY_RESULT_AVAILABLE, so its result is read when the GPU has long finished with it. Until then the object
+     * keeps its last known visibility; objects never tested count as visible, so nothing disappears while waiting.
+     *
+     * Query objects come from a pool that grows on demand and are recycled once their result is read. An object has
+     * at most latency queries in flight, canQuery() tells whether another one can be issued this frame.
+     *
+     * The draw inside a query should be a conservative proxy, such as the bounding box of the object. Objects can
+     * also stand for a group, for instance the bounding box of a cell of a grid: when the group is occluded,
+     * none of its members need to be drawn or tested.
+     *
+     * Per frame:
+     * \code
+     * scheduler.beginFrame();
+     * for (each object, front to back)
+     * {
+     *     if (scheduler.canQuery(object))
+     *     {
+     *         scheduler.beginQuery(object);
+     *         drawBoundingBox(object);
+     *         scheduler.endQuery();
+     *     }
+     * }
+     * for (each object)
+     * {
+     *     if (scheduler.isVisible(object))
+     *     {
+     *         draw(object);
+     *     }
+     * }
+     * \endcode
+     */
+    class OcclusionQueryScheduler
+    {
+    private:
+        struct PendingQuery
+        {
+            GLuint query;
+            unsigned int frame;
+        };
+
+        struct Object
+        {
+            /* Oldest first. */
+            std::vector<PendingQuery> pending;
+            bool visible;
+        };
+
+        std::vector<Object> objects;
+        std::vector<GLuint> freeQueries;
+        std::vector<GLuint> allQueries;
+        unsigned int latency;
+        unsigned int frame;
+        int activeObject;
+
+        GLuint acquireQuery(void);
+
+        OcclusionQueryScheduler(const OcclusionQueryScheduler &);
+        OcclusionQueryScheduler &operator=(const OcclusionQueryScheduler &);
+
+    public:
+        /**
+         * \brief Create a scheduler. Query objects are only generated when first needed.
+         * \param[in] numberOfObjects Number of objects to track, they are identified by 0 to numberOfObjects - 1.
+         * \param[in] latency Age in frames a query must reach before its result is polled.
+         */
+        OcclusionQueryScheduler(int numberOfObjects, unsigned int latency = 3);
+
+        /**
+         * \brief Delete all query objects. Needs the context the scheduler was used with.
+         */
+        ~OcclusionQueryScheduler(void);
+
+        /**
+         * \brief Start a frame, collecting the results that are available and old enough.
+         */
+        void beginFrame(void);
+
+        /**
+         * \brief Whether a new query for an object can be issued this frame.
+         */
+        bool canQuery(int object) const;
+
+        /**
+         * \brief Start an occlusion query for an object. Queries cannot nest.
+         */
+        void beginQuery(int object);
+
+        /**
+         * \brief End the query started by beginQuery().
+         */
+        void endQuery(void);
+
+        /**
+         * \brief Whether the latest collected result of an object saw any sample pass. True if none was collected yet.
+         */
+        bool isVisible(int object) const;
+
+        /**
+         * \brief Forget all results, every object becomes visible. Queries in flight are dropped.
+         */
+        void reset(void);
+
+        /**
+         * \brief Number of queries issued and not collected yet.
+         */
+        int getNumberOfPendingQueries(void) const;
+
+        /**
+         * \brief Number of query objects generated, in use or not.
+         */
+        int getPoolSize(void) const;
+    };
+}
+#endif /* OCCLUSIONQUERYSCHEDULER_H */
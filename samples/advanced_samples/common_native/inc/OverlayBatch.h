@@ -0,0 +1,222 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef OVERLAYBATCH_H
+#define OVERLAYBATCH_H
+
+#include "Matrix.h"
+#include "StreamingBuffer.h"
+#include "TextureAtlas.h"
+
+#include <GLES3/gl3.h>
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Collects the 2D overlays of a frame, sprites and glyphs alike, and draws them in as few draw calls as possible.
+     *
+     * Each overlay submits quads to the batch instead of drawing itself: Text::submit() and SDFText::submit()
+     * add their characters, and addRectangle() and addSprite() add solid and textured rectangles.
+     * draw() sorts everything by layer, writes it into one StreamingBuffer and draws it with one program.
+     * Every quad says how it is shaded, so bitmap glyphs, distance field glyphs, sprites from a 2D texture,
+     * sprites from a TextureAtlas array texture and plain rectangles all go in the same draw. A new draw is only
+     * started when the next quad needs a different 2D texture or array texture than the one bound,
+     * so a HUD made of one font and one sprite atlas takes a single draw call.
+     *
+     * Lower layers are drawn first. Within a layer quads are grouped by texture, so quads which overlap and must be
+     * drawn in a given order go in different layers. Positions are in pixels from the bottom left of the window.
+     *
+     * Typical usage:
+     * \code
+     * batch.clear();
+     * text->submit(batch, 1);
+     * batch.addRectangle(0, 0.0f, 0.0f, 200.0f, 40.0f, 0, 0, 0, 128);
+     * batch.addSprite(1, atlas.getTexture(), atlas.getRegion(icon), 8.0f, 8.0f, 24.0f, 24.0f);
+     * batch.draw();
+     * \endcode
+     */
+    class OverlayBatch
+    {
+    public:
+        /**
+         * \brief How the fragment colour of a quad is computed.
+         */
+        enum Shading
+        {
+            /** The vertex colour. */
+            SHADING_SOLID,
+            /** The vertex colour times a 2D texture. */
+            SHADING_TEXTURE,
+            /** The vertex colour times a layer of an array texture. */
+            SHADING_ARRAY_TEXTURE,
+            /** The vertex colour with the coverage of the distance field in the alpha channel of a 2D texture, as SDFText. */
+            SHADING_DISTANCE_FIELD
+        };
+
+        /**
+         * \brief One corner of a quad, as written to the vertex buffer.
+         */
+        struct Vertex
+        {
+            GLfloat position[2];
+            /** Texture coordinates. The third is the layer of an array texture. */
+            GLfloat texCoord[3];
+            GLubyte color[4];
+            /** The Shading of the quad, as a float so it interpolates to itself. */
+            GLfloat shading;
+            /** Half the width of the distance field edge, for SHADING_DISTANCE_FIELD. */
+            GLfloat smoothing;
+        };
+
+    private:
+        /**
+         * \brief A quad waiting for draw(), its corners in triangle strip order.
+         */
+        struct Quad
+        {
+            int layer;
+            GLuint texture;
+            GLuint arrayTexture;
+            Vertex vertices[4];
+        };
+
+        /**
+         * \brief What quads are sorted by. index keeps the order of submission within a layer and texture.
+         */
+        struct SortKey
+        {
+            int layer;
+            GLuint texture;
+            GLuint arrayTexture;
+            unsigned int index;
+
+            bool operator<(const SortKey &other) const;
+        };
+
+        Matrix projectionMatrix;
+        int maximumNumberOfQuads;
+
+        std::vector<Quad> quads;
+        std::vector<SortKey> keys;
+
+        StreamingBuffer vertexBuffer;
+        GLuint indexBuffer;
+        GLuint vertexArray;
+        GLuint programID;
+        GLint iLocProjection;
+
+        int numberOfDrawCalls;
+        int droppedQuads;
+
+        /* Copying would leave two owners of the buffers. */
+        OverlayBatch(const OverlayBatch &);
+        OverlayBatch &operator=(const OverlayBatch &);
+
+        /**
+         * \brief Bind the buffers to the vertex array, writing the attribute pointers for the given offset.
+         */
+        void setVertexOffset(GLintptr offset);
+
+    public:
+        /**
+         * \brief Build the program and buffers. Must be called with a current context.
+         * \param[in] windowWidth The width of the window in pixels.
+         * \param[in] windowHeight The height of the window in pixels.
+         * \param[in] maximumNumberOfQuads Quads draw() can draw in one frame, at most 16384 as the indices are 16 bit.
+         * Quads added past it are dropped.
+         */
+        OverlayBatch(int windowWidth, int windowHeight, int maximumNumberOfQuads = 4096);
+
+        /**
+         * \brief Delete the program and buffers. Must be called with the context current.
+         */
+        ~OverlayBatch(void);
+
+        /**
+         * \brief Remove all quads, to add the ones of the next frame.
+         */
+        void clear(void);
+
+        /**
+         * \brief Add a quad with the given corners.
+         * \param[in] layer Lower layers are drawn first.
+         * \param[in] texture The 2D texture of SHADING_TEXTURE and SHADING_DISTANCE_FIELD, 0 otherwise.
+         * \param[in] arrayTexture The array texture of SHADING_ARRAY_TEXTURE, 0 otherwise.
+         * \param[in] vertices The corners in triangle strip order: bottom left, bottom right, top left and top right.
+         */
+        void addQuad(int layer, GLuint texture, GLuint arrayTexture, const Vertex vertices[4]);
+
+        /**
+         * \brief Add a rectangle of a single colour.
+         * \param[in] layer Lower layers are drawn first.
+         * \param[in] x The X position (in pixels) of the left of the rectangle.
+         * \param[in] y The Y position (in pixels) of the bottom of the rectangle, measured from the bottom of the screen.
+         * \param[in] width The width of the rectangle in pixels.
+         * \param[in] height The height of the rectangle in pixels.
+         * \param[in] red The red component of the colour (accepts values 0-255).
+         * \param[in] green The green component of the colour (accepts values 0-255).
+         * \param[in] blue The blue component of the colour (accepts values 0-255).
+         * \param[in] alpha The alpha component of the colour (accepts values 0-255).
+         */
+        void addRectangle(int layer, float x, float y, float width, float height, int red, int green, int blue, int alpha);
+
+        /**
+         * \brief Add a rectangle showing part of a 2D texture, tinted by a colour.
+         * \param[in] texture The texture to sample.
+         * \param[in] uMin, vMin Texture coordinates at the bottom left of the rectangle.
+         * \param[in] uMax, vMax Texture coordinates at the top right of the rectangle.
+         * \see addRectangle() for the other parameters.
+         */
+        void addSprite(int layer, GLuint texture, float uMin, float vMin, float uMax, float vMax,
+                       float x, float y, float width, float height,
+                       int red = 255, int green = 255, int blue = 255, int alpha = 255);
+
+        /**
+         * \brief Add a rectangle showing an image of a TextureAtlas, tinted by a colour.
+         * \param[in] arrayTexture The array texture of the atlas, from TextureAtlas::getTexture().
+         * \param[in] region Where the image is in the atlas. Its top left corner goes to the top left of the rectangle.
+         * \see addRectangle() for the other parameters.
+         */
+        void addSprite(int layer, GLuint arrayTexture, const TextureAtlas::Region &region,
+                       float x, float y, float width, float height,
+                       int red = 255, int green = 255, int blue = 255, int alpha = 255);
+
+        /**
+         * \brief Draw all the quads with alpha blending, without depth test. Blending is left disabled.
+         *
+         * Call it once per frame, each call writes the next region of the streaming buffer.
+         * Leaves GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER unbound, and no vertex array bound.
+         */
+        void draw(void);
+
+        /**
+         * \brief Number of draw calls the last draw() issued.
+         */
+        int getNumberOfDrawCalls(void) const;
+
+        /**
+         * \brief Number of quads dropped since the batch was created, because there were more than maximumNumberOfQuads.
+         */
+        int getDroppedQuads(void) const;
+    };
+}
+#endif /* OVERLAYBATCH_H */
@@ -0,0 +1,114 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PARTIALUPDATE_H
+#define PARTIALUPDATE_H
+
+#include <EGL/egl.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Redraws and writes out only the parts of a window surface which change.
+     *
+     * EGL_BUFFER_PRESERVED keeps the whole previous frame, which on a tiler means reading every tile back
+     * in before drawing. With EGL_KHR_partial_update the buffer age tells which older frame the back buffer
+     * still holds, so only the areas damaged since then are redrawn, and eglSetDamageRegionKHR()
+     * tells the driver that the other tiles are neither loaded nor written.
+     *
+     * Each frame:
+     * - addDamage() the rectangles which change this frame,
+     * - call beginFrame() before the first draw call, and restrict drawing (typically with glScissor())
+     * to the rectangle it returns,
+     * - swap with swapBuffers() if the sample owns the swap, so EGL_KHR_swap_buffers_with_damage
+     * lets the compositor update only the damaged area. On Android GLSurfaceView swaps after each step,
+     * which still saves the tile traffic.
+     *
+     * Without EGL_KHR_partial_update beginFrame() always returns the whole surface.
+     * Rectangles are in window coordinates with the origin at the bottom left, as for glScissor().
+     */
+    class PartialUpdate
+    {
+    private:
+        /**
+         * \brief Number of frames of damage kept, older back buffers are redrawn completely.
+         */
+        static const int maximumBufferAge = 4;
+
+        typedef EGLBoolean (EGLAPIENTRYP SetDamageRegionFunction)(EGLDisplay display, EGLSurface surface, EGLint *rects, EGLint numberOfRects);
+        typedef EGLBoolean (EGLAPIENTRYP SwapBuffersWithDamageFunction)(EGLDisplay display, EGLSurface surface, EGLint *rects, EGLint numberOfRects);
+
+        EGLDisplay display;
+        EGLSurface surface;
+        SetDamageRegionFunction setDamageRegion;
+        SwapBuffersWithDamageFunction swapBuffersWithDamage;
+
+        EGLint surfaceWidth;
+        EGLint surfaceHeight;
+
+        /**
+         * \brief Bounding rectangle (x, y, width, height) of the damage of this frame and the previous ones, 0 is this frame.
+         */
+        EGLint damage[maximumBufferAge][4];
+
+        /**
+         * \brief Rectangle passed to eglSetDamageRegionKHR() this frame.
+         */
+        EGLint region[4];
+    public:
+        /**
+         * \brief Look up the extensions for the current draw surface. Must be called with a current context.
+         */
+        PartialUpdate(void);
+
+        /**
+         * \brief Whether EGL_KHR_partial_update is supported, if not every frame is redrawn completely.
+         */
+        bool isSupported(void) const;
+
+        /**
+         * \brief Mark an area which changes in the coming frame.
+         */
+        void addDamage(EGLint x, EGLint y, EGLint width, EGLint height);
+
+        /**
+         * \brief Mark the whole surface as changed, for instance after a resize.
+         */
+        void addFullDamage(void);
+
+        /**
+         * \brief Set the damage region for the frame from the buffer age and return the area to redraw.
+         *
+         * Must be called once per frame, before any draw call.
+         * \param[out] x Left edge of the area to redraw.
+         * \param[out] y Bottom edge of the area to redraw.
+         * \param[out] width Width of the area to redraw, 0 if nothing has to be drawn.
+         * \param[out] height Height of the area to redraw, 0 if nothing has to be drawn.
+         */
+        void beginFrame(EGLint *x, EGLint *y, EGLint *width, EGLint *height);
+
+        /**
+         * \brief Swap, passing the damage of this frame to EGL_KHR_swap_buffers_with_damage when supported.
+         * \return The result of the swap.
+         */
+        EGLBoolean swapBuffers(void);
+    };
+}
+#endif /* PARTIALUPDATE_H */
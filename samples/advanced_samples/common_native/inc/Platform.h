@@ -24,6 +24,8 @@
 #if !defined(ANDROID)
 
 #include "EGLRuntime.h"
+#include "GLCallCounters.h"
+#include "GLCapture.h"
 #include "VectorTypes.h"
 
 #include <cstdio>
@@ -0,0 +1,83 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+
+#include "Allocator.h"
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Hands out blocks of one size from large chunks, recycling freed blocks through a free list.
+     *
+     * Suits data rebuilt over and over with a bounded size, such as a model regenerated when its tessellation
+     * changes: the blocks are reused instead of going back to the heap, so long sessions do not fragment it.
+     * Chunks are only released when the pool is destroyed.
+     */
+    class PoolAllocator : public Allocator
+    {
+    private:
+        size_t blockSize;
+        size_t blocksPerChunk;
+        std::vector<unsigned char *> chunks;
+        void *freeList;
+        size_t numberOfAllocatedBlocks;
+
+        void addChunk(void);
+
+        PoolAllocator(const PoolAllocator &);
+        PoolAllocator &operator=(const PoolAllocator &);
+
+    public:
+        /**
+         * \brief Create an empty pool, chunks are allocated on demand.
+         * \param[in] blockSize Largest allocation the pool serves, in bytes. Rounded up to defaultAlignment.
+         * \param[in] blocksPerChunk Number of blocks allocated from the heap at once.
+         */
+        PoolAllocator(size_t blockSize, size_t blocksPerChunk = 16);
+
+        ~PoolAllocator(void);
+
+        /**
+         * \brief Take a block from the pool.
+         * \return NULL if size is larger than the block size or alignment larger than defaultAlignment.
+         */
+        void *allocate(size_t size, size_t alignment = defaultAlignment);
+
+        /**
+         * \brief Return a block to the pool. NULL is ignored.
+         */
+        void deallocate(void *pointer);
+
+        /**
+         * \brief Size of the blocks in bytes.
+         */
+        size_t getBlockSize(void) const;
+
+        /**
+         * \brief Number of blocks currently handed out.
+         */
+        size_t getNumberOfAllocatedBlocks(void) const;
+    };
+}
+#endif /* POOLALLOCATOR_H */
@@ -0,0 +1,177 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Named CPU and GPU timing scopes, visible in systrace and Perfetto.
+     *
+     * Each scope is an ATrace section on the CPU, so it shows up on the thread's track when tracing
+     * with the "app" category (or `atrace --app=<package>`). GL_EXT_disjoint_timer_query timestamps
+     * are written at both ends of the scope. Unlike time elapsed queries these can nest.
+     * The results come back a few frames later and are published as ATrace counters named
+     * "GPU <scope>", holding the GPU time of the scope in nanoseconds, so GPU and CPU time line up in one trace.
+     *
+     * Averages of both are kept per scope name and can be printed with log().
+     * Scopes must only be opened on the thread which owns the context, and be closed in the order they were opened.
+     * Use PROFILE_SCOPE() to do both:
+     * \code
+     * {
+     *     PROFILE_SCOPE("hiz_mips");
+     *     ...
+     * }
+     * \endcode
+     * Without initialize() only the CPU side is recorded.
+     */
+    class Profiler
+    {
+    private:
+        struct Statistic
+        {
+            double cpuTotal;
+            double gpuTotal;
+            unsigned int cpuCount;
+            unsigned int gpuCount;
+        };
+
+        struct OpenScope
+        {
+            const char *name;
+            long long cpuBegin;
+            GLuint gpuBegin;
+        };
+
+        struct PendingScope
+        {
+            const char *name;
+            GLuint gpuBegin;
+            GLuint gpuEnd;
+        };
+
+        static bool gpuSupported;
+        static std::vector<OpenScope> openScopes;
+        static std::vector<PendingScope> pendingScopes;
+        static std::vector<GLuint> freeQueries;
+        static std::map<std::string, Statistic> statistics;
+
+        static GLuint getQuery(void);
+        static void collectGPUResults(void);
+
+    public:
+        /**
+         * \brief Enable the GPU side if GL_EXT_disjoint_timer_query supports timestamps. Must be called with a current context.
+         */
+        static void initialize(void);
+
+        /**
+         * \brief Delete the queries and forget the statistics.
+         */
+        static void terminate(void);
+
+        /**
+         * \brief Open a scope.
+         * \param[in] name Name of the scope. Must stay valid until the GPU result is collected, a string literal typically.
+         */
+        static void beginScope(const char *name);
+
+        /**
+         * \brief Close the most recently opened scope.
+         */
+        static void endScope(void);
+
+        /**
+         * \brief Open an ATrace section, without timing it. Unlike scopes, sections can be opened on any thread.
+         * \param[in] name Name of the section.
+         */
+        static void beginTraceSection(const char *name);
+
+        /**
+         * \brief Close the most recently opened section of the calling thread.
+         */
+        static void endTraceSection(void);
+
+        /**
+         * \brief Collect the GPU results which are available. Call once per frame.
+         */
+        static void endFrame(void);
+
+        /**
+         * \brief Print the average CPU and GPU time of each scope with LOGI, then reset the averages.
+         * \param[in] label Printed before the scopes.
+         */
+        static void log(const char *label);
+
+        /**
+         * \brief Get the average GPU time of a scope since it was last reset, to pick between code paths at run time.
+         * \param[in] name Name of the scope.
+         * \param[out] milliseconds Average GPU time of the scope.
+         * \return Number of GPU results averaged. 0 until the first result is collected, or without GPU timestamps.
+         */
+        static unsigned int getGPUAverage(const char *name, double *milliseconds);
+
+        /**
+         * \brief Reset the averages of one scope. Results still in flight count towards the new average.
+         * \param[in] name Name of the scope.
+         */
+        static void resetScope(const char *name);
+    };
+
+    /**
+     * \brief Opens a Profiler scope for its lifetime.
+     */
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char *name)
+        {
+            Profiler::beginScope(name);
+        }
+
+        ~ProfileScope(void)
+        {
+            Profiler::endScope();
+        }
+    };
+}
+
+#define PROFILE_SCOPE_CONCATENATE_(a, b) a##b
+#define PROFILE_SCOPE_CONCATENATE(a, b) PROFILE_SCOPE_CONCATENATE_(a, b)
+
+/**
+ * \brief Profile the rest of the enclosing block under the given name.
+ */
+#define PROFILE_SCOPE(name) MaliSDK::ProfileScope PROFILE_SCOPE_CONCATENATE(profileScope, __LINE__)(name)
+
+#endif /* PROFILER_H */
@@ -0,0 +1,131 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PROGRAMBINARYCACHE_H
+#define PROGRAMBINARYCACHE_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else 
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <string>
+
+namespace MaliSDK
+{
+    /**
+     * \brief On-disk cache of linked program binaries.
+     *
+     * Programs are keyed on a hash of their shader sources combined with GL_RENDERER and GL_VERSION,
+     * so a driver update or a different GPU never picks up a stale binary.
+     * The cache is disabled until setDirectory() has been called, and is always disabled
+     * in OpenGL ES 2.0 builds as glGetProgramBinary() is not part of the core API.
+     *
+     * Typical usage:
+     * \code
+     * GLuint program = glCreateProgram();
+     * unsigned long long key = ProgramBinaryCache::computeKey(sources, numberOfSources);
+     * if (!ProgramBinaryCache::loadProgram(program, key))
+     * {
+     *     ProgramBinaryCache::prepareProgram(program);
+     *     // Attach shaders and link as usual.
+     *     ProgramBinaryCache::storeProgram(program, key);
+     * }
+     * \endcode
+     */
+    class ProgramBinaryCache
+    {
+    private:
+        /**
+         * \brief Directory the binaries are stored in, empty if the cache is disabled.
+         */
+        static std::string directory;
+
+        /**
+         * \brief Build the path of the cache file for a key.
+         * \param[in] key The key returned by computeKey().
+         * \return The full path of the cache file.
+         */
+        static std::string getPath(unsigned long long key);
+
+        /**
+         * \brief Check that the cache is enabled and the driver supports at least one binary format.
+         * \return True if binaries can be loaded and stored.
+         */
+        static bool isAvailable(void);
+    public:
+        /**
+         * \brief Enable the cache and set the directory where binaries are stored.
+         * \param[in] cacheDirectory A writable directory, ending in a path separator. Pass NULL to disable the cache.
+         */
+        static void setDirectory(const char *cacheDirectory);
+
+        /**
+         * \brief Compute the cache key of a program.
+         *
+         * Must be called with a current context, as the key includes GL_RENDERER and GL_VERSION.
+         * \param[in] sources The source strings of every shader attached to the program, in attachment order.
+         * \param[in] numberOfSources The number of strings in sources.
+         * \return The cache key.
+         */
+        static unsigned long long computeKey(const char * const *sources, int numberOfSources);
+
+        /**
+         * \brief Compute the cache key of a program from sources that are not null-terminated, such as mapped files.
+         *
+         * Gives the same key as computeKey(sources, numberOfSources) for the same contents.
+         * \param[in] sources The source strings of every shader attached to the program, in attachment order.
+         * \param[in] lengths The length in bytes of each string.
+         * \param[in] numberOfSources The number of strings in sources.
+         * \return The cache key.
+         */
+        static unsigned long long computeKey(const char * const *sources, const size_t *lengths, int numberOfSources);
+
+        /**
+         * \brief Try to load a previously stored binary into a program.
+         *
+         * If the binary is missing or rejected by the driver, the program is left unlinked
+         * so the caller can compile and link it from source as usual. Rejected binaries are removed from the cache.
+         * \param[in] program The program object to load the binary into.
+         * \param[in] key The key returned by computeKey().
+         * \return True if the program is now successfully linked.
+         */
+        static bool loadProgram(GLuint program, unsigned long long key);
+
+        /**
+         * \brief Hint to the driver that the binary of a program will be retrieved.
+         *
+         * Should be called before glLinkProgram() on programs that will be passed to storeProgram().
+         * \param[in] program The program object that is about to be linked.
+         */
+        static void prepareProgram(GLuint program);
+
+        /**
+         * \brief Store the binary of a successfully linked program.
+         * \param[in] program The linked program object.
+         * \param[in] key The key returned by computeKey().
+         */
+        static void storeProgram(GLuint program, unsigned long long key);
+    };
+}
+#endif /* PROGRAMBINARYCACHE_H */
@@ -0,0 +1,169 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PROGRAMCOMPILEQUEUE_H
+#define PROGRAMCOMPILEQUEUE_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else 
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <EGL/egl.h>
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Compiles and links a batch of programs without blocking the rendering thread.
+     *
+     * All programs are queued with addProgram() and handed to the driver at once by submit().
+     * If GL_KHR_parallel_shader_compile is supported, the driver compiles them on its own threads
+     * and completion is polled with GL_COMPLETION_STATUS_KHR. Otherwise they are compiled and linked
+     * by a worker thread using a context shared with the current one.
+     * Either way the application keeps rendering (e.g. a loading frame) until isComplete() returns true,
+     * and then calls finish() before using the programs.
+     * Programs found in the ProgramBinaryCache are loaded straight away and never reach the compiler.
+     *
+     * Typical usage:
+     * \code
+     * GLuint program = queue.addProgram(vertexShaderSource, fragmentShaderSource);
+     * queue.submit();
+     *
+     * // In the render loop:
+     * if (!queue.isComplete())
+     * {
+     *     // Render a loading frame.
+     *     return;
+     * }
+     * queue.finish();
+     * \endcode
+     */
+    class ProgramCompileQueue
+    {
+    private:
+        /**
+         * \brief A queued program and the shaders it is built from.
+         */
+        struct Entry
+        {
+            GLuint program;
+            GLuint vertexShader;
+            GLuint fragmentShader;
+            std::string vertexShaderSource;
+            std::string fragmentShaderSource;
+            unsigned long long key;
+            bool complete;
+        };
+
+        std::vector<Entry> entries;
+
+        bool submitted;
+        bool useParallelCompile;
+
+        /* Worker thread fallback. */
+        bool workerStarted;
+        bool workerDone;
+        pthread_t workerThread;
+        pthread_mutex_t workerMutex;
+        EGLDisplay workerDisplay;
+        EGLSurface workerSurface;
+        EGLContext workerContext;
+
+        /* Copying would leave two owners of the worker thread. */
+        ProgramCompileQueue(const ProgramCompileQueue &);
+        ProgramCompileQueue &operator=(const ProgramCompileQueue &);
+
+        /**
+         * \brief Issue the compile and link commands of an entry, without waiting for their results.
+         * \param[in] entry The entry to build.
+         */
+        static void compileAndLink(Entry *entry);
+
+        /**
+         * \brief Check the result of building an entry, dump debug as necessary and store the binary.
+         * \param[in] entry The entry to check.
+         */
+        static void checkEntry(Entry *entry);
+
+        /**
+         * \brief Create a context sharing objects with the current context, see EGLWorkerContext.
+         * \return True if the worker thread can make the new context current.
+         */
+        bool createWorkerContext(void);
+
+        /**
+         * \brief Working function of the worker thread.
+         * \param[in] queue The queue that started the thread.
+         * \return Always NULL.
+         */
+        static void *workerFunction(void *queue);
+    public:
+        /**
+         * \brief Create an empty queue.
+         */
+        ProgramCompileQueue(void);
+
+        /**
+         * \brief Wait for the worker thread, if any. Programs are not deleted.
+         */
+        ~ProgramCompileQueue(void);
+
+        /**
+         * \brief Queue a program to be built from a vertex and a fragment shader.
+         *
+         * The sources are copied, and the program object is created straight away, so state that affects
+         * linking (glBindAttribLocation(), glTransformFeedbackVaryings()) can be set on it before submit().
+         * Must be called with a current context, and before submit().
+         * \param[in] vertexShaderSource OpenGL ES SL source code of the vertex shader.
+         * \param[in] fragmentShaderSource OpenGL ES SL source code of the fragment shader.
+         * \return The program object ID. It must not be used for rendering until finish() has been called.
+         */
+        GLuint addProgram(const char *vertexShaderSource, const char *fragmentShaderSource);
+
+        /**
+         * \brief Start building all queued programs.
+         *
+         * Returns without waiting for the compiler.
+         */
+        void submit(void);
+
+        /**
+         * \brief Check whether all programs have been built, without blocking.
+         * \return True if finish() will not block on the compiler.
+         */
+        bool isComplete(void);
+
+        /**
+         * \brief Wait for all programs to be built and check the results.
+         *
+         * Compilation and link errors are logged and terminate the application, as in Shader::processShader().
+         * After this returns, all programs are linked and ready to be used.
+         */
+        void finish(void);
+    };
+}
+#endif /* PROGRAMCOMPILEQUEUE_H */
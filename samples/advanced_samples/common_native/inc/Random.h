@@ -0,0 +1,100 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Xorshift128 random numbers, generated four at a time.
+     *
+     * Four independent xorshift128 generators run side by side, one per lane of a 128-bit NEON register, so filling
+     * the initial data of a million particles takes a few milliseconds where rand() takes tens of them. Without NEON
+     * the lanes are plain loops, which compilers vectorize for SSE2. The values come out interleaved, lane 0 first,
+     * and next() hands out the same sequence one value at a time, so the two can be mixed freely.
+     *
+     * Not suitable for cryptography. The period of each lane is 2^128 - 1.
+     *
+     * Typical usage:
+     * \code
+     * Random random(seed);
+     * std::vector<float> positions(4 * numberOfParticles);
+     * random.fill(&positions[0], positions.size(), -1.0f, 1.0f);
+     * \endcode
+     */
+    class Random
+    {
+    private:
+        uint32_t x[4];
+        uint32_t y[4];
+        uint32_t z[4];
+        uint32_t w[4];
+
+        /* Values of the last step not handed out by next() yet, from buffered[4 - numberOfBufferedValues] on. */
+        uint32_t buffered[4];
+        unsigned int numberOfBufferedValues;
+
+        /* Advance every lane numberOfSteps times, writing four values per step. */
+        void step(uint32_t *values, size_t numberOfSteps);
+    public:
+        /**
+         * \brief Seed the four generators from one value, see setSeed().
+         */
+        explicit Random(uint32_t seed = 123456789);
+
+        /**
+         * \brief Restart the sequence. The same seed always gives the same sequence.
+         */
+        void setSeed(uint32_t seed);
+
+        /**
+         * \brief The next value of the sequence.
+         */
+        uint32_t next(void);
+
+        /**
+         * \brief The next value of the sequence, in [0.0, 1.0).
+         *
+         * The top 24 bits are used, so every value is exact and 1.0 is never returned.
+         */
+        float nextFloat(void);
+
+        /**
+         * \brief Write the next values of the sequence.
+         * \param[out] values Where to write them.
+         * \param[in] count Number of values.
+         */
+        void fill(uint32_t *values, size_t count);
+
+        /**
+         * \brief Write the next values of the sequence, uniformly distributed in [minimum, maximum).
+         * \param[out] values Where to write them.
+         * \param[in] count Number of values.
+         * \param[in] minimum Smallest value.
+         * \param[in] maximum Bound of the largest value.
+         */
+        void fill(float *values, size_t count, float minimum = 0.0f, float maximum = 1.0f);
+    };
+}
+#endif /* RANDOM_H */
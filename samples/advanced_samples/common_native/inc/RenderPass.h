@@ -0,0 +1,217 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef RENDERPASS_H
+#define RENDERPASS_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else 
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+namespace MaliSDK
+{
+    /**
+     * \brief Declares what happens to each attachment of a framebuffer at the start and end of a pass.
+     *
+     * On tile-based GPUs, attachments whose previous contents are not needed don't have to be read into
+     * tile memory, and attachments that are not needed afterwards don't have to be written back.
+     * begin() and end() turn the declared intent into glClear() and glInvalidateFramebuffer() calls
+     * (glDiscardFramebufferEXT() in OpenGL ES 2.0 builds, when GL_EXT_discard_framebuffer is supported).
+     *
+     * The framebuffer is only rebound when it is not bound already, so consecutive passes on the same
+     * framebuffer don't split the GPU work, and the number of actual framebuffer switches is counted.
+     * The bytes each pass moves and avoids moving are estimated from the declared attachments,
+     * and accumulated over all passes so samples can display them.
+     *
+     * Typical usage:
+     * \code
+     * RenderPass pass(0, windowWidth, windowHeight);
+     * pass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 4);
+     * pass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_DONT_CARE, 2);
+     *
+     * pass.begin();
+     * // Draw.
+     * pass.end();
+     *
+     * RenderPass::endFrame();
+     * \endcode
+     */
+    class RenderPass
+    {
+    public:
+        /**
+         * \brief The attachments a pass can declare.
+         *
+         * The colour operations apply to every colour attachment, see setNumberOfColorAttachments().
+         */
+        enum Attachment
+        {
+            ATTACHMENT_COLOR,
+            ATTACHMENT_DEPTH,
+            ATTACHMENT_STENCIL,
+            ATTACHMENT_COUNT
+        };
+
+        /**
+         * \brief What happens to an attachment at the start of the pass.
+         */
+        enum LoadOp
+        {
+            /** The previous contents are read back in. */
+            LOAD_OP_LOAD,
+            /** The attachment is cleared with the clear value set on the pass, or the current one if none was set. */
+            LOAD_OP_CLEAR,
+            /** The previous contents are invalidated, every pixel will be overwritten. */
+            LOAD_OP_DONT_CARE
+        };
+
+        /**
+         * \brief What happens to an attachment at the end of the pass.
+         */
+        enum StoreOp
+        {
+            /** The contents are written back to memory. */
+            STORE_OP_STORE,
+            /** The contents are invalidated and never leave the GPU. */
+            STORE_OP_DONT_CARE
+        };
+
+    private:
+        /**
+         * \brief The most colour attachments a pass can invalidate.
+         */
+        static const int maxColorAttachments = 4;
+
+        struct AttachmentState
+        {
+            bool used;
+            LoadOp load;
+            StoreOp store;
+            int bytesPerPixel;
+        };
+
+        GLuint framebuffer;
+        GLsizei width;
+        GLsizei height;
+        AttachmentState attachments[ATTACHMENT_COUNT];
+        int numberOfColorAttachments;
+
+        bool hasClearColor;
+        bool hasClearDepth;
+        bool hasClearStencil;
+        GLfloat clearColor[4];
+        GLfloat clearDepth;
+        GLint clearStencil;
+
+        static unsigned long long bytesTransferred;
+        static unsigned long long bytesSaved;
+        static int framebufferSwitches;
+        static int lastLoggedFramebufferSwitches;
+
+        /**
+         * \brief Invalidate every used attachment that matches a load or store operation.
+         * \param[in] atBegin True to match loadOp, false to match storeOp.
+         */
+        void invalidate(bool atBegin);
+    public:
+        /**
+         * \brief Create a pass with no attachments declared.
+         * \param[in] framebuffer The framebuffer object to render to, 0 for the window surface.
+         * \param[in] width The width the viewport is set to.
+         * \param[in] height The height the viewport is set to.
+         */
+        RenderPass(GLuint framebuffer, GLsizei width, GLsizei height);
+
+        /**
+         * \brief Declare how an attachment is used.
+         * \param[in] attachment The attachment.
+         * \param[in] load What happens to its contents at begin().
+         * \param[in] store What happens to its contents at end().
+         * \param[in] bytesPerPixel Only used for the bandwidth estimates, including any multisampling.
+         */
+        void setAttachment(Attachment attachment, LoadOp load, StoreOp store, int bytesPerPixel);
+
+        /**
+         * \brief Set how many colour attachments the colour operations apply to, for multiple render targets.
+         * \param[in] count Number of colour attachments, starting at GL_COLOR_ATTACHMENT0. Defaults to 1, at most 4.
+         */
+        void setNumberOfColorAttachments(int count);
+
+        /**
+         * \brief Set the colour begin() clears colour attachments to, instead of the current clear colour.
+         */
+        void setClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+        /**
+         * \brief Set the depth begin() clears the depth attachment to, instead of the current clear depth.
+         */
+        void setClearDepth(GLfloat depth);
+
+        /**
+         * \brief Set the value begin() clears the stencil attachment to, instead of the current clear stencil value.
+         */
+        void setClearStencil(GLint stencil);
+
+        /**
+         * \brief Bind the framebuffer if needed, set the viewport, then invalidate or clear attachments as declared.
+         *
+         * No clear is issued at all if no attachment is cleared. Clears respect the current write masks
+         * and scissor, so must be called with them enabled. Clear values set on the pass are left current.
+         */
+        void begin(void);
+
+        /**
+         * \brief Invalidate the attachments that are not stored and account for the pass in the estimates.
+         *
+         * Must be called with the pass framebuffer still bound.
+         */
+        void end(void);
+
+        /**
+         * \brief Estimated bytes loaded and stored by all passes since the last resetCounters().
+         */
+        static unsigned long long getBytesTransferred(void);
+
+        /**
+         * \brief Estimated bytes that loading and storing every attachment would have added since the last resetCounters().
+         */
+        static unsigned long long getBytesSaved(void);
+
+        /**
+         * \brief Number of times begin() had to bind a different framebuffer since the last resetCounters().
+         */
+        static int getFramebufferSwitches(void);
+
+        /**
+         * \brief Reset the estimates and the framebuffer switch count, typically once per frame.
+         */
+        static void resetCounters(void);
+
+        /**
+         * \brief Log the number of framebuffer switches of the frame if it changed since the last log, then reset the counters.
+         */
+        static void endFrame(void);
+    };
+}
+#endif /* RENDERPASS_H */
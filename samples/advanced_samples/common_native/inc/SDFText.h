@@ -0,0 +1,127 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SDFTEXT_H
+#define SDFTEXT_H
+
+#include "Matrix.h"
+#include "FontAtlas.h"
+
+namespace MaliSDK
+{
+#if GLES_VERSION == 3
+    class OverlayBatch;
+#endif
+
+    /**
+     * \brief Draws text of any size and in several fonts from a FontAtlas, in a single draw call.
+     *
+     * Several overlays can add their strings to the same SDFText. Everything added since clear()
+     * is drawn by draw() with one glDrawElements() call, as all fonts share the atlas texture.
+     * As in Text, the vertices are kept across clear() and only the glyphs which changed are uploaded.
+     *
+     * The shaders are built in, so samples don't need font shader assets.
+     */
+    class SDFText
+    {
+    private:
+        /**
+         * \brief Floats per vertex: position (2), texture coordinates (2), colour (4) and edge smoothing (1).
+         */
+        static const int floatsPerVertex = 9;
+        static const int floatsPerCharacter = 4 * floatsPerVertex;
+
+        const FontAtlas *atlas;
+        Matrix projectionMatrix;
+
+        GLuint programID;
+        GLint iLocPosition;
+        GLint iLocTexCoord;
+        GLint iLocFontColor;
+        GLint iLocSmoothing;
+        GLint iLocProjection;
+
+        int numberOfCharacters;
+        float *vertexData;
+        int characterCapacity;
+
+        GLuint vertexBuffer;
+        GLuint indexBuffer;
+        int bufferCapacity;
+        int uploadedCharacters;
+        int dirtyBegin;
+        int dirtyEnd;
+
+        /**
+         * \brief Grow vertexData to hold at least the given number of characters.
+         */
+        void reserveCharacters(int count);
+
+    public:
+        /**
+         * \brief Build the shaders and buffers. Must be called with a current context.
+         * \param[in] atlas Fonts to draw with, upload() must have been called. Must outlive the SDFText.
+         * \param[in] windowWidth The width of the window in pixels.
+         * \param[in] windowHeight The height of the window in pixels.
+         */
+        SDFText(const FontAtlas *atlas, int windowWidth, int windowHeight);
+
+        /**
+         * \brief Default destructor.
+         */
+        virtual ~SDFText(void);
+
+        /**
+         * \brief Remove all strings, to add the ones of the next frame.
+         */
+        void clear(void);
+
+        /**
+         * \brief Add a string to be drawn.
+         * \param[in] xPosition The X position (in pixels) of the left of the string.
+         * \param[in] yPosition The Y position (in pixels) of the bottom of the string, measured from the bottom of the screen.
+         * \param[in] string The string to draw.
+         * \param[in] height Height of the characters in pixels, any size can be used.
+         * \param[in] font Index of the font in the atlas.
+         * \param[in] red The red component of the text colour (accepts values 0-255).
+         * \param[in] green The green component of the text colour (accepts values 0-255).
+         * \param[in] blue The blue component of the text colour (accepts values 0-255).
+         * \param[in] alpha The alpha component of the text colour (accepts values 0-255).
+         * \return The X position following the last character, to continue the line.
+         */
+        float addString(float xPosition, float yPosition, const char *string, float height, int font,
+                        int red, int green, int blue, int alpha);
+
+        /**
+         * \brief Draw all strings with alpha blending. Leaves GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER unbound.
+         */
+        void draw(void);
+
+#if GLES_VERSION == 3
+        /**
+         * \brief Add the characters to an OverlayBatch instead of drawing them, to draw them with the other overlays.
+         * \param[in] batch The batch to add to. Its window size should match the one given to the constructor.
+         * \param[in] layer The layer of the characters in the batch.
+         */
+        void submit(OverlayBatch &batch, int layer) const;
+#endif
+    };
+}
+#endif /* SDFTEXT_H */
@@ -0,0 +1,103 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SAMPLEPARAMETERS_H
+#define SAMPLEPARAMETERS_H
+
+#include <string>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Named values read at run time, so workload sizes can be changed without rebuilding a sample.
+     *
+     * A value comes from the first of these which has it:
+     * - set(), which the benchmark harness calls for each of its --parameter name=value options before init().
+     * - intent_parameters.txt in the resource directory, which MaliSamplesActivity writes from the extras of the
+     *   launching intent, as given by adb shell am start -e name value. It is removed when there are none.
+     * - parameters.txt in the resource directory, pushed there beforehand for samples without MaliSamplesActivity.
+     * - The default of the sample.
+     *
+     * The files have a name=value per line, blank lines and lines starting with # are skipped. Typical usage in init():
+     * \code
+     * SampleParameters::load(resourceDirectory.c_str());
+     * int numberOfCubes = SampleParameters::getInt("number_of_cubes", 10, 1, 10000);
+     * \endcode
+     * Each value read is logged with LOGI, so the log of a run tells which workload it measured.
+     * Not thread safe: values are set and read while the sample initializes.
+     */
+    class SampleParameters
+    {
+    private:
+        /**
+         * \brief Read a file of name=value lines. Names which already have a value keep it.
+         * \return False if the file cannot be opened.
+         */
+        static bool loadFile(const std::string &path);
+
+        /**
+         * \brief The value of a parameter, or NULL if it has none.
+         */
+        static const char *find(const char *name);
+
+    public:
+        /**
+         * \brief Give a parameter a value, replacing the one it had.
+         */
+        static void set(const char *name, const char *value);
+
+        /**
+         * \brief Read intent_parameters.txt and parameters.txt from a directory, missing files are skipped.
+         * \param[in] resourceDirectory The directory of the sample, ending with a slash.
+         */
+        static void load(const char *resourceDirectory);
+
+        /**
+         * \brief Forget all values.
+         */
+        static void clear(void);
+
+        /**
+         * \brief Whether a parameter has a value.
+         */
+        static bool has(const char *name);
+
+        /**
+         * \brief An integer parameter, clamped to a range.
+         * \param[in] name The name of the parameter.
+         * \param[in] defaultValue Returned when the parameter has no value or is not a number.
+         * \param[in] minimum The lowest value returned.
+         * \param[in] maximum The highest value returned.
+         */
+        static int getInt(const char *name, int defaultValue, int minimum, int maximum);
+
+        /**
+         * \brief A floating point parameter, clamped to a range, as getInt().
+         */
+        static float getFloat(const char *name, float defaultValue, float minimum, float maximum);
+    };
+}
+
+/*
+ * C entry point of SampleParameters::set(). Every sample library has its own copy of the parameters, so the
+ * benchmark harness looks this up in the library with dlsym().
+ */
+extern "C" void MaliSDK_SampleParameters_set(const char *name, const char *value);
+#endif /* SAMPLEPARAMETERS_H */
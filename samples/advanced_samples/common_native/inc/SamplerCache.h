@@ -0,0 +1,139 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SAMPLERCACHE_H
+#define SAMPLERCACHE_H
+
+#include <GLES3/gl3.h>
+
+#include <map>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Sampling parameters of a texture unit, as set on a sampler object.
+     *
+     * The constructor sets the OpenGL ES defaults. The static functions make the usual combinations.
+     */
+    struct SamplerState
+    {
+        GLenum minFilter;
+        GLenum magFilter;
+        GLenum wrapS;
+        GLenum wrapT;
+        GLenum wrapR;
+        /** GL_NONE, or GL_COMPARE_REF_TO_TEXTURE for depth textures sampled by shadow samplers. */
+        GLenum compareMode;
+        GLenum compareFunction;
+        /** Anisotropy with GL_EXT_texture_filter_anisotropic, clamped to what the GPU supports. 1 turns it off. */
+        GLfloat maxAnisotropy;
+        GLfloat minLod;
+        GLfloat maxLod;
+
+        SamplerState(void);
+
+        /**
+         * \brief Point sampling of the base level.
+         */
+        static SamplerState nearest(GLenum wrap = GL_CLAMP_TO_EDGE);
+
+        /**
+         * \brief Bilinear filtering of the base level.
+         */
+        static SamplerState linear(GLenum wrap = GL_CLAMP_TO_EDGE);
+
+        /**
+         * \brief Trilinear filtering between mipmap levels, optionally anisotropic.
+         */
+        static SamplerState trilinear(GLenum wrap = GL_REPEAT, GLfloat maxAnisotropy = 1.0f);
+
+        /**
+         * \brief Depth comparison with bilinear filtering, for PCF lookups in shadow maps.
+         * \param[in] minFilter GL_LINEAR, or a mipmap filter to compare against a depth pyramid.
+         * \param[in] compareFunction How the reference is compared with the depth.
+         */
+        static SamplerState depthCompare(GLenum minFilter = GL_LINEAR, GLenum compareFunction = GL_LEQUAL);
+
+        bool operator<(const SamplerState &other) const;
+    };
+
+    /**
+     * \brief One sampler object for every distinct SamplerState, bound with a single call per texture unit.
+     *
+     * Setting filtering and wrapping on every texture with glTexParameteri() repeats the same few combinations
+     * again and again, and changing them on a bound texture makes the driver validate it again. Samplers
+     * override the parameters of whatever texture is bound to their unit, so the few combinations a sample uses
+     * are created once, the first time they are asked for, and only bound afterwards. Bindings go through
+     * GLStateCache, so binding the sampler a unit already has costs nothing.
+     *
+     * Typical usage:
+     * \code
+     * GLStateCache::activeTexture(GL_TEXTURE0);
+     * GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+     * SamplerCache::bind(0, SamplerState::trilinear(GL_REPEAT, 4.0f));
+     * \endcode
+     *
+     * Sampler objects are shared by the contexts of a share group. Only the rendering thread is meant
+     * to use the cache.
+     */
+    class SamplerCache
+    {
+    private:
+        static std::map<SamplerState, GLuint> samplers;
+
+        /**
+         * \brief Largest anisotropy supported, 1 without GL_EXT_texture_filter_anisotropic, 0 until checked.
+         */
+        static GLfloat maxSupportedAnisotropy;
+
+    public:
+        /**
+         * \brief Get the sampler object of a state, creating it the first time.
+         */
+        static GLuint getSampler(const SamplerState &state);
+
+        /**
+         * \brief Bind the sampler object of a state to a texture unit.
+         * \param[in] unit The unit, from 0, not GL_TEXTURE0.
+         * \param[in] state The sampling parameters.
+         */
+        static void bind(GLuint unit, const SamplerState &state);
+
+        /**
+         * \brief Unbind the sampler of a texture unit, so the parameters of the texture apply again.
+         * \param[in] unit The unit, from 0, not GL_TEXTURE0.
+         */
+        static void unbind(GLuint unit);
+
+        /**
+         * \brief Number of sampler objects created.
+         */
+        static unsigned int getNumberOfSamplers(void);
+
+        /**
+         * \brief Delete all the sampler objects. Needs the context they were created in, or one sharing with it.
+         *
+         * When the context has been lost, pass false to only forget them.
+         * \param[in] deleteObjects Whether to delete the objects.
+         */
+        static void clear(bool deleteObjects = true);
+    };
+}
+#endif /* SAMPLERCACHE_H */
@@ -29,8 +29,12 @@
 #error "GLES_VERSION must be defined as either 2 or 3"
 #endif
 
+#include <cstddef>
+
 namespace MaliSDK
 {
+    class AssetFile;
+
     /**
      * \brief Functions for working with OpenGL ES shaders.
      */
@@ -38,11 +42,30 @@ namespace MaliSDK
     {
     private:
         /**
-         * \brief Load shader source from a file into memory.
+         * \brief Map shader source from a file into memory.
          * \param[in] filename File name of the shader to load.
-         * \return A character array containing the contents of the shader source file. 
+         * \param[out] file Holds the contents of the shader source file, which are not null-terminated.
+         */
+        static void loadShader(const char *filename, AssetFile *file);
+
+        /**
+         * \brief Create shader, compile it from source, and dump debug as necessary.
+         * \param[out] shader The shader ID of the newly compiled shader.
+         * \param[in] source OpenGL ES SL source code.
+         * \param[in] length Length of source in bytes.
+         * \param[in] shaderType Passed to glCreateShader to define the type of shader being processed.
+         * \param[in] defines Lines inserted after the #version line of the source, or NULL.
+         */
+        static void compileShader(GLuint *shader, const char *source, GLint length, GLint shaderType, const char *defines = NULL);
+
+        /**
+         * \brief Create a linked program from shader sources, through the ProgramBinaryCache.
+         * \param[out] program The program ID of the newly linked program.
+         * \param[in] sources Vertex and fragment shader sources.
+         * \param[in] lengths Lengths of the sources in bytes.
+         * \param[in] name Name to report if linking fails.
          */
-        static char *loadShader(const char *filename);
+        static void linkProgram(GLuint *program, const char * const sources[2], const size_t lengths[2], const char *name);
     public:
         /**
          * \brief Create shader, load in source, compile, and dump debug as necessary.
@@ -52,9 +75,66 @@ namespace MaliSDK
          * The output from the compilation is checked for success and a log of the compilation errors is printed in the case of failure.
          * \param[out] shader The shader ID of the newly compiled shader.
          * \param[in] filename Filename of a file containing OpenGL ES SL source code.
-         * \param[in] shaderType Passed to glCreateShader to define the type of shader being processed. Must be GL_VERTEX_SHADER or GL_FRAGMENT_SHADER.
+         * \param[in] shaderType Passed to glCreateShader to define the type of shader being processed.
+         * \param[in] defines Lines such as "#define NUMBER_OF_CUBES 10\n" inserted after the #version line of the source, or NULL.
          */
-        static void processShader(GLuint *shader, const char *filename, GLint shaderType);
+        static void processShader(GLuint *shader, const char *filename, GLint shaderType, const char *defines = NULL);
+
+        /**
+         * \brief Create a shader and compile it from source held in memory, and dump debug as necessary.
+         *
+         * Works as processShader(), for shaders which are part of the code rather than assets.
+         * \param[out] shader The shader ID of the newly compiled shader.
+         * \param[in] source Null-terminated OpenGL ES SL source code.
+         * \param[in] shaderType Passed to glCreateShader to define the type of shader being processed.
+         */
+        static void processShaderSource(GLuint *shader, const char *source, GLint shaderType);
+
+        /**
+         * \brief Create a linked program from a vertex and a fragment shader file.
+         *
+         * The linked binary is kept in the ProgramBinaryCache, so later runs skip compiling and linking
+         * as long as the sources and the driver are unchanged. Falls back to compiling from source
+         * if there is no cached binary or the driver rejects it.
+         * The cache is only used after ProgramBinaryCache::setDirectory() has been called.
+         * \param[out] program The program ID of the newly linked program.
+         * \param[in] vertexShaderFilename Filename of a file containing the vertex shader source.
+         * \param[in] fragmentShaderFilename Filename of a file containing the fragment shader source.
+         */
+        static void processProgram(GLuint *program, const char *vertexShaderFilename, const char *fragmentShaderFilename);
+
+        /**
+         * \brief Create a linked program from vertex and fragment shader sources held in memory.
+         *
+         * Works as processProgram(), for shaders which are part of the code rather than assets.
+         * \param[out] program The program ID of the newly linked program.
+         * \param[in] vertexShaderSource Null-terminated vertex shader source.
+         * \param[in] fragmentShaderSource Null-terminated fragment shader source.
+         */
+        static void processProgramSource(GLuint *program, const char *vertexShaderSource, const char *fragmentShaderSource);
+
+        /**
+         * \brief Print the source and the info log of a shader which failed to compile.
+         * \param[in] shader The shader ID to report on.
+         */
+        static void dumpShaderLog(GLuint shader);
+
+        /**
+         * \brief Print the info log of a program which failed to link.
+         * \param[in] program The program ID to report on.
+         */
+        static void dumpProgramLog(GLuint program);
+
+#if GLES_VERSION == 3
+        /**
+         * \brief Create a linked program from a compute shader source held in memory.
+         *
+         * Needs an OpenGL ES 3.1 context. The program is not kept in the ProgramBinaryCache.
+         * \param[out] program The program ID of the newly linked program.
+         * \param[in] computeShaderSource Null-terminated compute shader source.
+         */
+        static void processComputeProgramSource(GLuint *program, const char *computeShaderSource);
+#endif
     };
 }
 #endif /* SHADER_H */
\ No newline at end of file
@@ -0,0 +1,193 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include "GLWorkerPool.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Specialised programs built from one source, each compiled the first time it is asked for.
+     *
+     * The source declares feature bits with addFeature(). A variant is one combination of features, a bitmask,
+     * and is built from the source with a "#define FEATURE 1" line after #version for each bit set, so the
+     * shader tests them with #if or #ifdef. Nothing is compiled up front: request() starts building a variant
+     * in the background and tryGetProgram() returns it once it is ready, so a sample can ship a fast path for
+     * every case and only pay for the ones it uses.
+     *
+     * Variants are built with GL_KHR_parallel_shader_compile if the driver has it, on a GLWorkerPool if one is
+     * set, and on the calling thread otherwise. Variants found in the ProgramBinaryCache are loaded straight
+     * away and never reach the compiler.
+     *
+     * Typical usage:
+     * \code
+     * ShaderVariants variants(vertexShaderSource, fragmentShaderSource);
+     * unsigned int fog = variants.addFeature("FOG");
+     * unsigned int shadows = variants.addFeature("SHADOWS");
+     * variants.request(fog); // Prewarm the variants likely to be needed soon.
+     *
+     * // In the render loop:
+     * GLuint program = variants.tryGetProgram(fog | shadows);
+     * if (program == 0)
+     * {
+     *     program = variants.getProgram(0); // The generic variant, until the specialised one is ready.
+     * }
+     * \endcode
+     *
+     * All methods must be called from the rendering thread, with a current context.
+     */
+    class ShaderVariants
+    {
+    private:
+        /**
+         * \brief A variant and the state of its build.
+         */
+        struct Variant
+        {
+            const ShaderVariants *owner;
+            GLuint program;
+            GLuint shaders[2];
+            std::string sources[2];
+            unsigned long long key;
+            /* Linked and checked, ready to be used. */
+            bool ready;
+            GLWorkerPool::Job *job;
+        };
+
+        GLenum shaderTypes[2];
+        std::string baseSources[2];
+        int numberOfShaders;
+        std::vector<std::string> features;
+        std::map<unsigned int, Variant> variants;
+        GLWorkerPool *workerPool;
+        bool useParallelCompile;
+        bool checkedExtensions;
+
+        ShaderVariants(const ShaderVariants &);
+        ShaderVariants &operator=(const ShaderVariants &);
+
+        /**
+         * \brief Get the variant of a feature mask, creating it and starting its build if needed.
+         */
+        Variant &startVariant(unsigned int featureMask);
+
+        /**
+         * \brief Issue the compile and link commands of a variant, without waiting for their results.
+         */
+        static void compileAndLink(Variant *variant);
+
+        /**
+         * \brief Check whether the build of a variant has finished.
+         * \param[in] variant The variant to check.
+         * \param[in] wait Block until it has.
+         * \return True once the variant is ready.
+         */
+        bool finishVariant(Variant &variant, bool wait);
+
+        /**
+         * \brief Job building a variant on a worker of the pool.
+         * \param[in] userData The Variant to build.
+         */
+        static void buildJob(void *userData);
+
+    public:
+        /**
+         * \brief Declare a program built from a vertex and a fragment shader.
+         *
+         * The sources are copied. They have to start with a #version line.
+         * \param[in] vertexShaderSource OpenGL ES SL source code of the vertex shader.
+         * \param[in] fragmentShaderSource OpenGL ES SL source code of the fragment shader.
+         */
+        ShaderVariants(const char *vertexShaderSource, const char *fragmentShaderSource);
+
+#if GLES_VERSION == 3
+        /**
+         * \brief Declare a program built from a compute shader. Needs an OpenGL ES 3.1 context.
+         * \param[in] computeShaderSource OpenGL ES SL source code of the compute shader.
+         */
+        explicit ShaderVariants(const char *computeShaderSource);
+#endif
+
+        /**
+         * \brief Wait for the builds in flight and delete all the programs.
+         */
+        ~ShaderVariants(void);
+
+        /**
+         * \brief Declare a feature, before any variant is requested.
+         * \param[in] define Name defined to 1 in the variants which have the feature.
+         * \return The bit of the feature in the masks, or 0 if the 32 bits are already taken.
+         */
+        unsigned int addFeature(const char *define);
+
+        /**
+         * \brief Build variants on the workers of a pool when GL_KHR_parallel_shader_compile is not supported.
+         * \param[in] pool An initialized pool, which has to outlive the variants. NULL builds on the calling thread.
+         */
+        void setWorkerPool(GLWorkerPool *pool);
+
+        /**
+         * \brief Start building a variant, without waiting for it.
+         * \param[in] featureMask The features of the variant, bits returned by addFeature().
+         */
+        void request(unsigned int featureMask);
+
+        /**
+         * \brief Get a variant if it is ready, starting its build otherwise.
+         * \param[in] featureMask The features of the variant.
+         * \return The program, or 0 if it is still being built.
+         */
+        GLuint tryGetProgram(unsigned int featureMask);
+
+        /**
+         * \brief Get a variant, building it or waiting for its build if needed.
+         *
+         * Compilation and link errors are logged and terminate the application, as in Shader::processShader().
+         * \param[in] featureMask The features of the variant.
+         * \return The linked program.
+         */
+        GLuint getProgram(unsigned int featureMask);
+
+        /**
+         * \brief Whether a variant is ready, without starting its build.
+         */
+        bool isReady(unsigned int featureMask);
+
+        /**
+         * \brief Number of variants requested so far.
+         */
+        unsigned int getNumberOfVariants(void) const;
+    };
+}
+#endif /* SHADERVARIANTS_H */
@@ -0,0 +1,141 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+#include "Timer.h"
+#include "TripleBuffer.h"
+
+#include <pthread.h>
+
+#include <atomic>
+#include <cstddef>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Runs the simulation of a sample (physics, camera, animation) on a thread of its own.
+     *
+     * The step function is called at a fixed rate and writes a snapshot of everything the rendering thread needs
+     * for a frame, which is handed over through a TripleBuffer. The rendering thread then only reads the latest
+     * snapshot in update(), so the CPU work of the simulation overlaps with the submission of the frames instead of
+     * adding to it, and neither thread waits for the other.
+     *
+     * Typical usage:
+     * \code
+     * static void simulate(float deltaTime, void *snapshot, void *userData)
+     * {
+     *     World *world = (World *)userData;
+     *     world->step(deltaTime);
+     *     world->getSnapshot((WorldSnapshot *)snapshot);
+     * }
+     *
+     * simulation.start(sizeof(WorldSnapshot), simulate, &world);
+     *
+     * // In the render loop:
+     * const WorldSnapshot *snapshot = (const WorldSnapshot *)simulation.update();
+     * \endcode
+     *
+     * The step function runs concurrently with the rendering thread: it must not call OpenGL ES and must only share
+     * data with the rendering thread through the snapshot. The simulation state itself stays with the step function,
+     * the snapshot handed to it is not the previous one and has to be written in full.
+     *
+     * If no thread can be started, or Timer::setFixedTimeStep() is in use so that benchmark runs draw the same frames,
+     * update() runs one step on the rendering thread every frame instead.
+     */
+    class SimulationThread
+    {
+    public:
+        /**
+         * \brief Function advancing the simulation.
+         * \param[in] deltaTime Seconds since the previous step.
+         * \param[out] snapshot Where to write the state of the simulation after the step.
+         * \param[in] userData The pointer passed to start().
+         */
+        typedef void (*StepFunction)(float deltaTime, void *snapshot, void *userData);
+
+    private:
+        TripleBuffer snapshots;
+        StepFunction stepFunction;
+        void *userData;
+        long long stepInterval;
+        Timer timer;
+
+        bool threadStarted;
+        std::atomic<bool> stopping;
+        pthread_t thread;
+
+        /* Copying would leave two owners of the thread. */
+        SimulationThread(const SimulationThread &);
+        SimulationThread &operator=(const SimulationThread &);
+
+        /**
+         * \brief Run one step and publish its snapshot.
+         */
+        void step(void);
+
+        /**
+         * \brief Working function of the simulation thread.
+         * \param[in] simulation The SimulationThread that started the thread.
+         * \return Always NULL.
+         */
+        static void *threadFunction(void *simulation);
+    public:
+        /**
+         * \brief Create an idle simulation.
+         */
+        SimulationThread(void);
+
+        /**
+         * \brief Calls stop().
+         */
+        ~SimulationThread(void);
+
+        /**
+         * \brief Run a first step on the calling thread, then start the simulation thread.
+         * \param[in] snapshotSize Size of a snapshot in bytes. Snapshots are copied as raw memory.
+         * \param[in] stepFunction The function advancing the simulation.
+         * \param[in] userData Passed to the step function.
+         * \param[in] stepsPerSecond Rate of the simulation. The thread sleeps between steps.
+         */
+        void start(size_t snapshotSize, StepFunction stepFunction, void *userData, float stepsPerSecond = 60.0f);
+
+        /**
+         * \brief Stop the simulation thread, waiting for the step it is running.
+         */
+        void stop(void);
+
+        /**
+         * \brief Get the latest snapshot. Rendering thread only.
+         *
+         * Without a simulation thread, runs a step first.
+         * \return The latest snapshot, valid until the next call of update() or stop(). NULL if start() has not been called.
+         */
+        const void *update(void);
+
+        /**
+         * \brief Check whether the simulation runs on its own thread.
+         * \return False if update() runs the steps on the rendering thread.
+         */
+        bool isThreaded(void) const;
+    };
+}
+#endif /* SIMULATIONTHREAD_H */
@@ -0,0 +1,192 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <pthread.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Breaks the cold start of a sample down into phases: EGL, asset I/O, decoding, shaders, uploads and the first frame.
+     *
+     * The common code marks its own work: EGLRuntime::initializeEGL() as EGL, AssetFile::open() and the BMP reader
+     * as asset I/O, TextureFormatSelector transcoding and HDR decoding as decoding, Shader compiling and linking as
+     * shaders, KTXLoader uploads as uploads. Samples mark the rest with STARTUP_PHASE(), typically their buffer uploads.
+     * Phases nest, and the time of a phase excludes the phases opened inside it, so the phases add up to the total.
+     * Time outside any phase is counted as other work until endInit(), and as the first frame between endInit() and
+     * the first endFrame().
+     *
+     * On Android the EGL context is created by the Java side before init(), so it is not one of the native phases,
+     * but it is part of the time from the start of the process to start(), which is reported as well.
+     * Files are mapped rather than read, the time of reading them goes to whichever phase first touches the data.
+     *
+     * Only the first startup of the process is measured, on the thread which called start(); phases on other
+     * threads overlap the startup rather than adding to it and are ignored. Typical usage:
+     * \code
+     * // At the top of init():
+     * StartupProfiler::start();
+     * ...
+     * StartupProfiler::endInit();
+     *
+     * // At the end of every frame, logs the breakdown with LOGI after the first one:
+     * StartupProfiler::endFrame();
+     * \endcode
+     * The benchmark harness calls start(), endInit() and endFrame() around the sample itself, and writes the breakdown
+     * to its report.
+     */
+    class StartupProfiler
+    {
+    public:
+        /**
+         * \brief The phases of the startup.
+         */
+        enum Phase
+        {
+            PHASE_EGL,
+            PHASE_ASSET_IO,
+            PHASE_DECODE,
+            PHASE_SHADERS,
+            PHASE_UPLOAD,
+            PHASE_FIRST_FRAME,
+            PHASE_OTHER,
+            NUMBER_OF_PHASES
+        };
+
+    private:
+        static const int maximumDepth = 16;
+
+        enum State
+        {
+            STATE_IDLE,
+            STATE_INIT,
+            STATE_FIRST_FRAME,
+            STATE_FINISHED
+        };
+
+        static State state;
+        static pthread_t thread;
+        static long long lastTime;
+        static double phaseTimes[NUMBER_OF_PHASES];
+        static double launchTime;
+        static Phase openPhases[maximumDepth];
+        static int depth;
+
+        /**
+         * \brief Whether phases are recorded on the calling thread.
+         */
+        static bool isRecording(void);
+
+        /**
+         * \brief Add the time since the last change to the innermost open phase, or to the default one of the state.
+         */
+        static void accumulate(void);
+
+    public:
+        /**
+         * \brief Start measuring on the calling thread. Does nothing if a startup has been measured or is being measured.
+         */
+        static void start(void);
+
+        /**
+         * \brief Open a phase. Does nothing outside start() and the first endFrame(), or on another thread.
+         * \param[in] phase The phase the following work belongs to.
+         */
+        static void beginPhase(Phase phase);
+
+        /**
+         * \brief Close the most recently opened phase.
+         */
+        static void endPhase(void);
+
+        /**
+         * \brief Mark the end of the initialization, work that follows belongs to the first frame.
+         */
+        static void endInit(void);
+
+        /**
+         * \brief Mark the end of a frame. The first call after start() finishes the measurement and logs it.
+         */
+        static void endFrame(void);
+
+        /**
+         * \brief Whether the first frame has ended, so the breakdown is complete.
+         */
+        static bool isFinished(void);
+
+        /**
+         * \brief Time spent in a phase, in milliseconds.
+         * \param[in] phase The phase, or NUMBER_OF_PHASES for the total from start() to the first endFrame().
+         */
+        static double getMilliseconds(Phase phase);
+
+        /**
+         * \brief Time from the start of the process to start(), in milliseconds. 0 if unknown.
+         */
+        static double getLaunchMilliseconds(void);
+
+        /**
+         * \brief Name of a phase, as used in the log and the benchmark report.
+         */
+        static const char *getPhaseName(Phase phase);
+
+        /**
+         * \brief Print the breakdown with LOGI.
+         */
+        static void log(void);
+    };
+
+    /**
+     * \brief Opens a StartupProfiler phase for its lifetime.
+     */
+    class StartupPhaseScope
+    {
+    public:
+        explicit StartupPhaseScope(StartupProfiler::Phase phase)
+        {
+            StartupProfiler::beginPhase(phase);
+        }
+
+        ~StartupPhaseScope(void)
+        {
+            StartupProfiler::endPhase();
+        }
+    };
+}
+
+#define STARTUP_PHASE_CONCATENATE_(a, b) a##b
+#define STARTUP_PHASE_CONCATENATE(a, b) STARTUP_PHASE_CONCATENATE_(a, b)
+
+/**
+ * \brief Count the rest of the enclosing block in the given StartupProfiler phase.
+ */
+#define STARTUP_PHASE(phase) MaliSDK::StartupPhaseScope STARTUP_PHASE_CONCATENATE(startupPhase, __LINE__)(MaliSDK::StartupProfiler::phase)
+
+/*
+ * C entry points of StartupProfiler. Every sample library has its own copy, so the benchmark harness looks these up
+ * in the library with dlsym(). MaliSDK_StartupProfiler_getBreakdown() writes the time of each phase, in the order of
+ * StartupProfiler::Phase, and returns the number written, 0 until the first frame has ended.
+ */
+extern "C" void MaliSDK_StartupProfiler_start(void);
+extern "C" void MaliSDK_StartupProfiler_endInit(void);
+extern "C" void MaliSDK_StartupProfiler_endFrame(void);
+extern "C" int MaliSDK_StartupProfiler_getBreakdown(double *milliseconds, int numberOfPhases);
+#endif /* STARTUPPROFILER_H */
@@ -0,0 +1,156 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef STREAMINGBUFFER_H
+#define STREAMINGBUFFER_H
+
+#include <GLES3/gl3.h>
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief A buffer for vertex data rewritten every frame, written in place instead of copied by glBufferSubData.
+     *
+     * The buffer is split in one region per frame in flight, and beginFrame() moves to the next one. With
+     * GL_EXT_buffer_storage the whole buffer stays mapped, persistent and coherent, for its whole life: map()
+     * only returns a pointer into it, so the data is written straight into memory the GPU reads. beginFrame()
+     * waits on the fence of the frame which last used the region, so the CPU never overwrites data still in use.
+     *
+     * Without the extension, map() maps the allocation unsynchronized and unmap() unmaps it, as a buffer cannot
+     * be drawn from while it is mapped. If the GPU still uses the region, beginFrame() orphans the buffer with
+     * glBufferData instead of waiting, so the driver gives it new storage and the CPU never stalls.
+     *
+     * Typical usage:
+     * \code
+     * stream.beginFrame();
+     * GLintptr offset;
+     * Vertex *vertices = static_cast<Vertex*>(stream.map(numberOfVertices * sizeof(Vertex), &offset));
+     * ...
+     * stream.unmap();
+     * glBindBuffer(GL_ARRAY_BUFFER, stream.getBuffer());
+     * glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)offset);
+     * glDraw...
+     * stream.endFrame();
+     * \endcode
+     */
+    class StreamingBuffer
+    {
+    private:
+        typedef void (GL_APIENTRYP BufferStorageFunction)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+        GLenum target;
+        GLuint buffer;
+        bool persistent;
+        unsigned char *persistentData;
+
+        GLsizeiptr regionSize;
+        unsigned int numberOfRegions;
+        std::vector<GLsync> fences;
+        unsigned int region;
+        GLsizeiptr head;
+        bool mapped;
+
+        GLsizeiptr uploadedBytes;
+        unsigned long long totalUploadedBytes;
+        unsigned int stalls;
+        unsigned int orphans;
+
+        StreamingBuffer(const StreamingBuffer &);
+        StreamingBuffer &operator=(const StreamingBuffer &);
+
+        /**
+         * \brief Delete the fences of all regions.
+         */
+        void deleteFences(void);
+
+    public:
+        /**
+         * \brief Create the buffer, and map it if GL_EXT_buffer_storage is supported. Needs a current context.
+         * \param[in] target The binding point the buffer is mapped through, usually GL_ARRAY_BUFFER.
+         * \param[in] frameSize Bytes available to the allocations of one frame.
+         * \param[in] framesInFlight Number of frames the GPU may lag behind the CPU.
+         */
+        StreamingBuffer(GLenum target, GLsizeiptr frameSize, unsigned int framesInFlight = 3);
+
+        /**
+         * \brief Delete the buffer and the pending fences. Needs the context the buffer was created in.
+         */
+        ~StreamingBuffer(void);
+
+        /**
+         * \brief Start allocating from the next region, waiting for the GPU or orphaning the buffer if needed.
+         */
+        void beginFrame(void);
+
+        /**
+         * \brief Reserve memory in the current region and get a pointer to write it.
+         * \param[in] size Bytes to allocate.
+         * \param[out] offset Offset of the allocation in the buffer, to pass to glVertexAttribPointer.
+         * \param[in] alignment Alignment of the offset in bytes. The default suits any vertex attribute.
+         * \return Where to write the data, valid until unmap(). NULL if the region is full.
+         */
+        void *map(GLsizeiptr size, GLintptr *offset, GLsizeiptr alignment = 16);
+
+        /**
+         * \brief Finish writing the last allocation. Call before drawing with it.
+         *
+         * Nothing to do for a persistent coherent mapping. Leaves the target unbound otherwise.
+         */
+        void unmap(void);
+
+        /**
+         * \brief Fence the current region, so a later beginFrame() knows when it can reuse it.
+         */
+        void endFrame(void);
+
+        /**
+         * \brief The buffer object.
+         */
+        GLuint getBuffer(void) const;
+
+        /**
+         * \brief Whether the buffer is persistently mapped, with GL_EXT_buffer_storage.
+         */
+        bool isPersistent(void) const;
+
+        /**
+         * \brief Bytes written through map() in the current frame, without the alignment padding.
+         */
+        GLsizeiptr getUploadedBytes(void) const;
+
+        /**
+         * \brief Bytes written through map() since the buffer was created.
+         */
+        unsigned long long getTotalUploadedBytes(void) const;
+
+        /**
+         * \brief Number of times beginFrame() had to wait for the GPU.
+         */
+        unsigned int getStalls(void) const;
+
+        /**
+         * \brief Number of times beginFrame() orphaned the buffer instead of waiting.
+         */
+        unsigned int getOrphans(void) const;
+    };
+}
+#endif /* STREAMINGBUFFER_H */
@@ -0,0 +1,76 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TANGENTFRAMES_H
+#define TANGENTFRAMES_H
+
+#include "MeshOptimizer.h"
+
+#include <cstddef>
+
+namespace MaliSDK
+{
+    class JobScheduler;
+
+    /**
+     * \brief Generates the tangent frames normal mapping needs, and encodes them as quaternions.
+     *
+     * Tangents follow the conventions of MikkTSpace, so normal maps baked by tools using it shade without seams:
+     * - the tangent of each triangle comes from its texture coordinates and is projected onto the plane of the
+     *   vertex normal before it is accumulated, weighted by the angle of the triangle at the vertex,
+     * - the handedness is stored separately, and the bitangent is rebuilt as handedness * cross(normal, tangent),
+     * - a vertex shared by triangles of opposite handedness, where the texture is mirrored, is split in two.
+     *
+     * A tangent frame fits in one quaternion of four normalized GL_SHORT, 8 bytes instead of the 36 of a normal,
+     * a tangent and a bitangent in floats. The handedness is the sign of w, which is never encoded as 0.
+     * The vertex shader decodes it with:
+     * \code
+     * vec3 rotate(vec4 q, vec3 v) { return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v); }
+     * vec3 normal = rotate(q, vec3(0.0, 0.0, 1.0));
+     * vec3 tangent = rotate(q, vec3(1.0, 0.0, 0.0));
+     * vec3 bitangent = cross(normal, tangent) * (q.w < 0.0 ? -1.0 : 1.0);
+     * \endcode
+     */
+    class TangentFrames
+    {
+    public:
+        /**
+         * \brief Add a tangent to every vertex of a model.
+         *
+         * Four floats are appended to each vertex, the tangent and its handedness, 1 or -1, and tangentOffset
+         * points at them. Vertices may be added at the end and indices changed to split mirrored vertices.
+         * Given a JobScheduler, the tangents of the vertices are accumulated in parallel.
+         *
+         * \param[in, out] model The model, with positionOffset, normalOffset and uvOffset set.
+         * \param[in] scheduler Optional scheduler to spread the work over.
+         * \return False if the model has no normals or texture coordinates, or would need more than 65536 vertices.
+         */
+        static bool generate(IndexedModel *model, JobScheduler *scheduler = NULL);
+
+        /**
+         * \brief Encode a tangent frame as a quaternion.
+         * \param[in] normal The x, y and z of the unit normal.
+         * \param[in] tangent The x, y and z of the tangent, which is made orthogonal to the normal, and the handedness.
+         * \param[out] encoded Receives x, y, z and w as normalized shorts.
+         */
+        static void encodeQuaternion(const float *normal, const float *tangent, short *encoded);
+    };
+}
+#endif /* TANGENTFRAMES_H */
@@ -0,0 +1,145 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TEMPORALUPSCALER_H
+#define TEMPORALUPSCALER_H
+
+#include <GLES3/gl3.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Upsamples frames rendered at a lower resolution by accumulating them over time, for fill rate bound samples.
+     *
+     * Each frame is rendered with its projection offset by a different sub-pixel jitter, see jitterProjection(),
+     * so over a few frames the low resolution samples land all over every output pixel. resolve() reprojects the
+     * output of the previous frame with the depth and the camera matrices, clamps it to the colours around the
+     * pixel in the current frame so what changed since is not kept, and blends in the current sample by how close
+     * it landed to the centre of the output pixel. Pixels which were not on screen in the previous frame take the
+     * bilinearly upscaled current frame instead.
+     *
+     * Only the camera motion is reprojected. Moving objects rely on the neighbourhood clamp, which keeps them from
+     * leaving trails but makes them softer than the static scene.
+     *
+     * The input is rendered to the bottom left corner of its textures, so the render size can change every
+     * frame without reallocating anything, for example following DynamicResolution::getWidth() and getHeight().
+     *
+     * Typical usage:
+     * \code
+     * upscaler.beginFrame(renderWidth, renderHeight);
+     * upscaler.jitterProjection(projection);
+     * // Render to the renderWidth by renderHeight corner of the input framebuffer, with the jittered projection.
+     * upscaler.resolve(colorTexture, depthTexture, viewProjection, 0);
+     * \endcode
+     *
+     * The colour texture must be bilinearly filtered. Matrices are column major, like OpenGL ES uniforms.
+     * Only available in OpenGL ES 3.0 builds.
+     */
+    class TemporalUpscaler
+    {
+    private:
+        /**
+         * \brief Number of frames of the Halton (2, 3) jitter sequence. Enough for a scale of 0.25 in each dimension.
+         */
+        static const unsigned int jitterSequenceLength = 16;
+
+        GLsizei outputWidth;
+        GLsizei outputHeight;
+        GLsizei inputWidth;
+        GLsizei inputHeight;
+        GLsizei renderWidth;
+        GLsizei renderHeight;
+
+        unsigned int frameIndex;
+        float jitterX;
+        float jitterY;
+
+        GLuint historyTextures[2];
+        GLuint historyFramebuffers[2];
+        int currentHistory;
+        bool historyValid;
+        float previousViewProjection[16];
+
+        GLuint resolveProgram;
+        GLuint resolveVertexArray;
+        GLint reprojectionLocation;
+        GLint renderSizeLocation;
+        GLint jitterLocation;
+        GLint historyValidLocation;
+
+        /* Copying would leave two owners of the GL objects. */
+        TemporalUpscaler(const TemporalUpscaler &);
+        TemporalUpscaler &operator=(const TemporalUpscaler &);
+    public:
+        /**
+         * \brief Create the history and the resolve program. Must be called with a current context.
+         * \param[in] outputWidth Width of the framebuffer resolved to.
+         * \param[in] outputHeight Height of the framebuffer resolved to.
+         * \param[in] inputWidth Width the colour and depth textures are allocated with, the largest render width.
+         * \param[in] inputHeight Height the colour and depth textures are allocated with, the largest render height.
+         */
+        TemporalUpscaler(GLsizei outputWidth, GLsizei outputHeight, GLsizei inputWidth, GLsizei inputHeight);
+
+        /**
+         * \brief Delete the history and the resolve program.
+         */
+        ~TemporalUpscaler(void);
+
+        /**
+         * \brief Move on to the next jitter, for a frame rendered at the given size.
+         * \param[in] renderWidth Width rendered to this frame, at most the input width.
+         * \param[in] renderHeight Height rendered to this frame, at most the input height.
+         */
+        void beginFrame(GLsizei renderWidth, GLsizei renderHeight);
+
+        /**
+         * \brief Offset a projection matrix by the jitter of this frame. Every draw of the frame must use it.
+         * \param[in, out] projection Column major projection matrix, modified in place.
+         */
+        void jitterProjection(float *projection) const;
+
+        /**
+         * \brief Jitter of this frame horizontally, in rendered pixels, between -0.5 and 0.5.
+         */
+        float getJitterX(void) const;
+
+        /**
+         * \brief Jitter of this frame vertically, in rendered pixels, between -0.5 and 0.5.
+         */
+        float getJitterY(void) const;
+
+        /**
+         * \brief Forget the history, for a camera cut. The next frame is only upscaled bilinearly.
+         */
+        void reset(void);
+
+        /**
+         * \brief Accumulate the frame into the history and copy the result to a framebuffer.
+         *
+         * Leaves the target framebuffer bound, depth testing and blending off, and texture unit 0 active.
+         * \param[in] colorTexture The frame, rendered in the bottom left corner.
+         * \param[in] depthTexture Depth of the frame, a depth or depth stencil texture.
+         * \param[in] viewProjection Column major view projection matrix of the frame, without the jitter.
+         * \param[in] targetFramebuffer Framebuffer of the output size to copy the result to, 0 for the window.
+         */
+        void resolve(GLuint colorTexture, GLuint depthTexture, const float *viewProjection, GLuint targetFramebuffer);
+    };
+}
+#endif /* TEMPORALUPSCALER_H */
@@ -35,6 +35,10 @@
 
 namespace MaliSDK
 {
+#if GLES_VERSION == 3
+    class OverlayBatch;
+#endif
+
     /**
      * \brief Functions for drawing text in OpenGL ES
      *
@@ -55,15 +59,43 @@ namespace MaliSDK
          * Range 0.75-3.0 seems to work reasonably.
          */
         static const float scale;
-        
 
-        
+        /**
+         * \brief Floats per vertex in the interleaved vertex data: position (3), texture coordinates (2) and colour (4).
+         */
+        static const int floatsPerVertex = 9;
+
+        /**
+         * \brief Floats per character, each character is a quad of 4 vertices.
+         */
+        static const int floatsPerCharacter = 4 * floatsPerVertex;
+
         Matrix projectionMatrix;
         int numberOfCharacters;
-        float *textVertex;
-        float *textTextureCoordinates;
-        float *color;
-        GLshort *textIndex;
+
+        /**
+         * \brief Interleaved vertices of the characters, kept across clear() so unchanged text is not uploaded again.
+         */
+        float *vertexData;
+        int characterCapacity;
+
+        /**
+         * \brief Buffers holding the vertices and the triangle strip indices of bufferCapacity characters.
+         */
+        GLuint vertexBuffer;
+        GLuint indexBuffer;
+        int bufferCapacity;
+
+        /**
+         * \brief Number of characters at the start of vertexBuffer which match vertexData.
+         */
+        int uploadedCharacters;
+
+        /**
+         * \brief Range of characters changed since the last upload, empty if dirtyBegin >= dirtyEnd.
+         */
+        int dirtyBegin;
+        int dirtyEnd;
         int m_iLocPosition;
         int m_iLocProjection;
         int m_iLocTextColor;
@@ -74,6 +106,16 @@ namespace MaliSDK
         GLuint programID;
         GLuint textureID;
 
+        /**
+         * \brief Grow vertexData to hold at least the given number of characters.
+         */
+        void reserveCharacters(int count);
+
+        /**
+         * \brief Fill the index buffer with the triangle strip of bufferCapacity characters, joined by degenerate triangles.
+         */
+        void fillIndexBuffer(void);
+
     public: 
 
         /**
@@ -104,6 +146,7 @@ namespace MaliSDK
          * \brief Removes the current string from the class.
          *
          * Should be called before adding a new string to render using addString().
+         * The vertex data is kept, so re-adding the same strings in the same order costs no upload in draw().
          */
         void clear(void);
 
@@ -123,8 +166,19 @@ namespace MaliSDK
          * \brief Draw the text to the screen.
          * 
          * Should be called each time through the render loop so that the text is drawn every frame.
+         * Only the characters which changed since the last draw are uploaded.
+         * Leaves GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER unbound.
          */
         void draw(void);
+
+#if GLES_VERSION == 3
+        /**
+         * \brief Add the characters to an OverlayBatch instead of drawing them, to draw them with the other overlays.
+         * \param[in] batch The batch to add to. Its window size should match the one given to the constructor.
+         * \param[in] layer The layer of the characters in the batch.
+         */
+        void submit(OverlayBatch &batch, int layer) const;
+#endif
     };
 }
 #endif /* TEXT_H */
\ No newline at end of file
@@ -23,6 +23,8 @@
 
 #include "ETCHeader.h"
 
+#include <cstdio>
+
 #if GLES_VERSION == 2
 #include <GLES2/gl2.h>
 #elif GLES_VERSION == 3
@@ -33,6 +35,36 @@
 
 namespace MaliSDK
 {
+    /**
+     * \brief Layout of the file header at the start of a BMP file.
+     */
+    struct tagBITMAPFILEHEADER
+    {
+        short bfType;
+        int   bfSize;
+        short bfReserved1;
+        short bfReserved2;
+        int   bfOffBits;
+    };
+
+    /**
+     * \brief Layout of the info header following the file header of a BMP file.
+     */
+    struct tagBITMAPINFOHEADER
+    {
+        int   biSize;
+        int   biWidth;
+        int   biHeight;
+        short biPlanes;
+        short biBitCount;
+        int   biCompression;
+        int   biSizeImage;
+        int   biXPelsPerMeter;
+        int   biYPelsPerMeter;
+        int   biClrUsed;
+        int   biClrImportant;
+    };
+
     /** 
      * \brief Functions for working with textures.
      */
@@ -47,6 +79,22 @@ namespace MaliSDK
          * \param[out] numberOfTextureFormats Pointer to the number of compressed texture formats.
          */
         static void getCompressedTextureFormats(GLint **textureFormats, int* numberOfTextureFormats);
+
+        /**
+         * \brief Read BMP file header.
+         *
+         * \param[in] file The file to read the header from. Cannot be NULL.
+         * \param[out] bitmapFileHeader Used to store the loaded header. Cannot be NULL.
+         */
+        static void readBitmapFileHeader(FILE* file, tagBITMAPFILEHEADER* bitmapFileHeader);
+
+        /**
+         * \brief Read BMP info header.
+         *
+         * \param[in] file The file to read the header from. Cannot be NULL.
+         * \param[out] bitmapInfoHeader Used to store the loaded header. Cannot be NULL.
+         */
+        static void readBitmapInfoHeader(FILE* file, tagBITMAPINFOHEADER* bitmapInfoHeader);
     public:
         /**
          * \brief Reports whether or not ETC (Ericsson Texture Compression) is supported.
@@ -86,6 +134,41 @@ namespace MaliSDK
          */
         static void createTexture(unsigned int width, unsigned int height, short red, short **textureData);
 
+#if GLES_VERSION == 3
+        /**
+         * \brief Fill layers of a texture with a single colour on the GPU.
+         *
+         * Each layer is attached to a temporary framebuffer and cleared, so nothing is allocated or uploaded
+         * from the CPU. Use it instead of createTexture for placeholder and uniform textures.
+         * The internal format of the texture has to be colour-renderable. Clears are affected by the
+         * scissor test and the colour mask, as with glClearBuffer. The framebuffer binding is restored.
+         *
+         * \param[in] target      GL_TEXTURE_2D, GL_TEXTURE_3D or GL_TEXTURE_2D_ARRAY.
+         * \param[in] textureID   The texture to fill. Its storage has to be allocated already.
+         * \param[in] level       Mipmap level to fill.
+         * \param[in] firstLayer  First layer to fill. Has to be 0 for GL_TEXTURE_2D.
+         * \param[in] layersCount Number of layers to fill. Has to be 1 for GL_TEXTURE_2D.
+         * \param[in] color       RGBA colour, for normalized and floating point formats.
+         */
+        static void fillTexture(GLenum target, GLuint textureID, GLint level, GLint firstLayer, GLint layersCount, const GLfloat color[4]);
+
+        /**
+         * \brief Fill layers of a signed integer texture with a single value on the GPU.
+         *
+         * \param[in] color RGBA value, for signed integer formats such as GL_R16I.
+         * \see fillTexture(GLenum, GLuint, GLint, GLint, GLint, const GLfloat*)
+         */
+        static void fillTexture(GLenum target, GLuint textureID, GLint level, GLint firstLayer, GLint layersCount, const GLint color[4]);
+
+        /**
+         * \brief Fill layers of an unsigned integer texture with a single value on the GPU.
+         *
+         * \param[in] color RGBA value, for unsigned integer formats such as GL_R8UI.
+         * \see fillTexture(GLenum, GLuint, GLint, GLint, GLint, const GLfloat*)
+         */
+        static void fillTexture(GLenum target, GLuint textureID, GLint level, GLint firstLayer, GLint layersCount, const GLuint color[4]);
+#endif
+
         /**
          * \brief Deletes previously created texture.
          * 
@@ -93,9 +176,21 @@ namespace MaliSDK
          */
         static void deleteTextureData(GLvoid **textureData);
 
+        /**
+         * \brief Size of a mipmap level along one dimension.
+         *
+         * \param[in] size Size of the base level.
+         * \param[in] level The mipmap level.
+         * \return The size halved level times, but at least 1.
+         */
+        static int getLevelSize(int size, int level);
+
         /**
          * \brief Load texture data from a file into memory.
          *
+         * Rows are kept in file order, top row first, so the data can be uploaded without another pass over it.
+         * Samplers see the image upside down: flip the V texture coordinate instead of the rows.
+         *
          * \param[in] filename The filename of the texture to load.
          * \param[out] textureData Pointer to the texture that has been loaded.
          */
@@ -110,6 +205,17 @@ namespace MaliSDK
          */
         static void loadPKMData(const char *filename, ETCHeader* etcHeader, unsigned char **textureData);
 
+        /**
+         * \brief Load 24 bit BMP image data from a file into memory.
+         *
+         * The BGR data stored in the file is converted to RGB.
+         * \param[in] filename The filename of the image to load. Cannot be NULL.
+         * \param[out] imageWidth If not NULL, used to store the width of the image.
+         * \param[out] imageHeight If not NULL, used to store the height of the image.
+         * \param[out] textureData Pointer to the image data that has been loaded. Release with free(). Cannot be NULL.
+         */
+        static void loadBmpImageData(const char *filename, int *imageWidth, int *imageHeight, unsigned char **textureData);
+
         /**
          * \brief Load compressed mipmaps into memory
          *
@@ -121,18 +227,11 @@ namespace MaliSDK
          * \param[in] filenameSuffix Any suffix to the mipmap filenames. Most commonly used for file extensions.
          * For example, if filenameSuffix = ".pkm", this method will append ".pkm" to all the files it tries to load.
          * \param[out] textureID The texture ID of the texture that has been loaded.
+         * \note KTXLoader loads all the levels from a single file instead.
+         * \note All levels are read and uploaded before this returns, largest first. CompressedMipmapLoader streams
+         * the same files in smallest first, reading them on a worker thread.
          */
         static void loadCompressedMipmaps(const char *filenameBase, const char *filenameSuffix, GLuint *textureID);
-
-        /**
-         * \brief Copies float pixel data of one line of the image from source to
-         * destination in the reverse direction.
-         *
-         * \param[out] destination Place in memory where the reversed data will be copied to. Cannot be NULL.
-         * \param[in] source Place from which the copying should start from. Cannot be NULL.
-         * \param[in] lineWidth Number of RGB pixels that will be copied.
-         */
-        static void reversePixelLine(float* destination, const float* source, int lineWidth);
     };
 }
 #endif /* TEXTURE_H */
\ No newline at end of file
@@ -0,0 +1,176 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <GLES3/gl3.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Packs many small compressed textures into the layers of one array texture.
+     *
+     * Binding one array texture for all the sprites of a scene lets them be drawn in a few batched draw calls,
+     * instead of one draw call and one texture bind per sprite. Images are added with their mip levels,
+     * build() packs them into as few layers as possible and uploads them with glCompressedTexSubImage3D(),
+     * and getRegion() returns where each image ended up, to remap the sprite's texture coordinates:
+     * \code
+     * atlasCoordinates = mix(region.uvMin, region.uvMax, spriteCoordinates);
+     * texture(atlas, vec3(atlasCoordinates, region.layer));
+     * \endcode
+     *
+     * Images are placed on a grid aligned to the block size of the format times 2 ^ (levels - 1), so that every
+     * mip level of every image starts on a block boundary, and their sizes must be multiples of this alignment.
+     * ETC1, ETC2, EAC and ASTC formats are supported. Images touch each other, so bilinear filtering at the edge
+     * of a region picks up the neighbour, unless the images have a transparent or repeated border.
+     */
+    class TextureAtlas
+    {
+    public:
+        /**
+         * \brief Where an image is in the atlas.
+         */
+        struct Region
+        {
+            /** Texture coordinates of the top left corner of the image. */
+            float uMin, vMin;
+            /** Texture coordinates of the bottom right corner of the image. */
+            float uMax, vMax;
+            /** Layer of the array texture holding the image. */
+            int layer;
+        };
+
+    private:
+        /**
+         * \brief An image waiting to be uploaded, with its place in the atlas once packed.
+         */
+        struct Image
+        {
+            int width;
+            int height;
+            /* All levels, one after the other. */
+            std::vector<unsigned char> data;
+            std::vector<size_t> levelOffsets;
+            std::vector<size_t> levelSizes;
+            int x;
+            int y;
+            int layer;
+        };
+
+        GLenum internalFormat;
+        int layerWidth;
+        int layerHeight;
+        int numberOfLevels;
+        int alignmentX;
+        int alignmentY;
+
+        std::vector<Image> images;
+        std::vector<Region> regions;
+        int numberOfLayers;
+        GLuint texture;
+
+        /* Copying would leave two owners of the texture. */
+        TextureAtlas(const TextureAtlas &);
+        TextureAtlas &operator=(const TextureAtlas &);
+
+        /**
+         * \brief Place every image with a shelf packer, tallest first.
+         * \return False if an image is larger than a layer.
+         */
+        bool pack(void);
+
+    public:
+        /**
+         * \brief Get the block size of a compressed format.
+         * \param[in] internalFormat The compressed internal format.
+         * \param[out] blockWidth Used to store the width of a block in texels.
+         * \param[out] blockHeight Used to store the height of a block in texels.
+         * \return False if the format is not an ETC, EAC or ASTC format.
+         */
+        static bool getBlockSize(GLenum internalFormat, int *blockWidth, int *blockHeight);
+
+        /**
+         * \brief Create an empty atlas. No OpenGL ES objects are created until build() is called.
+         * \param[in] internalFormat Compressed format of all the images.
+         * \param[in] layerWidth Width of each layer of the array texture.
+         * \param[in] layerHeight Height of each layer of the array texture.
+         * \param[in] numberOfLevels Number of mip levels of the atlas, every image must provide them all.
+         */
+        TextureAtlas(GLenum internalFormat, int layerWidth, int layerHeight, int numberOfLevels = 1);
+
+        /**
+         * \brief Deletes the array texture.
+         */
+        ~TextureAtlas(void);
+
+        /**
+         * \brief Queue an image to be packed. The data is copied.
+         * \param[in] width Width of the image, a multiple of the alignment.
+         * \param[in] height Height of the image, a multiple of the alignment.
+         * \param[in] levels Compressed data of each mip level.
+         * \param[in] levelSizes Size in bytes of each mip level.
+         * \return The index of the image, to be passed to getRegion(), or -1 if the image cannot be placed on the grid.
+         */
+        int addImage(int width, int height, const unsigned char *const *levels, const size_t *levelSizes);
+
+        /**
+         * \brief Queue an image stored as one PKM file per mip level, as used by Texture::loadCompressedMipmaps().
+         * \param[in] filenameBase Path of the files up to the level number.
+         * \param[in] filenameSuffix The rest of the path after the level number, e.g. ".pkm".
+         * \return The index of the image, or -1 if a file is missing or the image cannot be placed on the grid.
+         */
+        int addPKMImage(const char *filenameBase, const char *filenameSuffix);
+
+        /**
+         * \brief Pack the queued images and upload them into a new array texture.
+         *
+         * Must be called with a current context, and only once. The texture is left bound to GL_TEXTURE_2D_ARRAY,
+         * and the copies of the image data are released.
+         * \return False if an image does not fit in a layer or the driver rejected the format.
+         */
+        bool build(void);
+
+        /**
+         * \brief Get the array texture, 0 until build() succeeded.
+         */
+        GLuint getTexture(void) const;
+
+        /**
+         * \brief Get the number of layers build() needed.
+         */
+        int getNumberOfLayers(void) const;
+
+        /**
+         * \brief Get the number of images added.
+         */
+        int getNumberOfImages(void) const;
+
+        /**
+         * \brief Get where an image is in the atlas, valid once build() succeeded.
+         * \param[in] image The index returned when the image was added.
+         */
+        const Region &getRegion(int image) const;
+    };
+}
+#endif /* TEXTUREATLAS_H */
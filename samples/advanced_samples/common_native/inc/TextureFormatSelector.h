@@ -0,0 +1,288 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TEXTUREFORMATSELECTOR_H
+#define TEXTUREFORMATSELECTOR_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else 
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include "KTXLoader.h"
+
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Picks the compressed variant of a texture asset that suits the device best.
+     *
+     * An asset is shipped as a set of KTX files sharing a base path, each one optional:
+     * - basePath + ".astc.ktx", ASTC, preferred as its block size can be picked per asset for the lowest bandwidth,
+     * - basePath + ".etc2.ktx", ETC2 or EAC, supported by every OpenGL ES 3.0 device,
+     * - basePath + ".etc1.ktx", ETC1, supported by nearly every OpenGL ES 2.0 device,
+     * - basePath + ".ktx", uncompressed 8-bit RGB or RGBA, the universal source.
+     *
+     * loadTexture() uses the first variant, in that order, that exists and that the device supports.
+     * If only the universal source is usable and a cache directory has been set, the source is transcoded
+     * to ETC2 (or ETC1 on OpenGL ES 2.0) once and the result is stored in the cache for the next runs.
+     * Sources with an alpha channel are transcoded to GL_COMPRESSED_RGBA8_ETC2_EAC, and uploaded uncompressed
+     * where only ETC1 is available.
+     *
+     * Typical usage:
+     * \code
+     * TextureFormatSelector::setCacheDirectory("/data/data/com.arm.malideveloper.openglessdk.sample/cache/");
+     * TextureFormatSelector::loadTexture("/data/data/com.arm.malideveloper.openglessdk.sample/rock", &textureID);
+     * \endcode
+     */
+    class TextureFormatSelector
+    {
+    public:
+        /**
+         * \brief The compressed texture format families, from the most to the least preferred.
+         */
+        enum Family
+        {
+            FAMILY_ASTC,
+            FAMILY_ETC2,
+            FAMILY_ETC1,
+            FAMILY_UNCOMPRESSED
+        };
+
+        /**
+         * \brief Provides the uncompressed faces of a cube map to loadCubemap().
+         * \param[in] face The face, in the order GL_TEXTURE_CUBE_MAP_POSITIVE_X to GL_TEXTURE_CUBE_MAP_NEGATIVE_Z.
+         * \param[out] pixels Used to store the face as tightly packed 8-bit RGB rows.
+         * \param[out] size Used to store the width and height of the face.
+         * \param[in] userData The pointer passed to loadCubemap().
+         * \return False if the face cannot be read.
+         */
+        typedef bool (*CubemapFaceSource)(int face, std::vector<unsigned char> *pixels, int *size, void *userData);
+
+        /**
+         * \brief Provides the faces of a single channel cube map, such as a displacement map, to loadHeightCubemap().
+         * \param[in] face The face, in the order GL_TEXTURE_CUBE_MAP_POSITIVE_X to GL_TEXTURE_CUBE_MAP_NEGATIVE_Z.
+         * \param[out] heights Used to store the face as tightly packed 16-bit rows, 0 to 65535 for 0.0 to 1.0.
+         * \param[out] size Used to store the width and height of the face.
+         * \param[in] userData The pointer passed to loadHeightCubemap().
+         * \return False if the face cannot be read.
+         */
+        typedef bool (*CubemapHeightSource)(int face, std::vector<unsigned short> *heights, int *size, void *userData);
+
+    private:
+        /**
+         * \brief Formats listed by GL_COMPRESSED_TEXTURE_FORMATS, queried once.
+         */
+        static std::vector<GLint> compressedFormats;
+
+        /**
+         * \brief Whether the ASTC LDR extension is exposed. Some drivers support ASTC without listing it.
+         */
+        static bool astcExtension;
+
+        /**
+         * \brief Whether compressedFormats and astcExtension are valid.
+         */
+        static bool formatsQueried;
+
+        /**
+         * \brief Directory transcoded textures are stored in, empty if transcoding is disabled.
+         */
+        static std::string cacheDirectory;
+
+        /**
+         * \brief Query the formats supported by the current context, the first time only.
+         */
+        static void queryFormats(void);
+
+        /**
+         * \brief Get the file name suffix of a family.
+         * \param[in] family The family.
+         * \return The suffix appended to the base path.
+         */
+        static const char *getSuffix(Family family);
+
+        /**
+         * \brief Encode an uncompressed KTX file to ETC1 blocks and store it as a KTX file.
+         * \param[in] sourcePath Path of the uncompressed KTX file.
+         * \param[in] internalFormat GL_ETC1_RGB8_OES or GL_COMPRESSED_RGB8_ETC2, both hold the same blocks.
+         *            GL_COMPRESSED_RGB8_ETC2 becomes GL_COMPRESSED_RGBA8_ETC2_EAC for RGBA sources, which ETC1 cannot hold.
+         * \param[out] cachePath Path of the transcoded file, in the cache directory.
+         * \return False if the source cannot be transcoded or the result cannot be written.
+         */
+        static bool transcode(const std::string &sourcePath, GLenum internalFormat, std::string *cachePath);
+
+        /**
+         * \brief Encode the faces of a cube map to ETC1 blocks, with a full mip chain, and store it as a KTX file.
+         * \param[in] source Provides the faces.
+         * \param[in] userData Passed to source.
+         * \param[in] internalFormat GL_ETC1_RGB8_OES or GL_COMPRESSED_RGB8_ETC2, both hold the same blocks.
+         * \param[in] cachePath Path of the file to write.
+         * \return False if a face cannot be read, the faces differ in size, or the result cannot be written.
+         */
+        static bool encodeCubemap(CubemapFaceSource source, void *userData, GLenum internalFormat, const std::string &cachePath);
+
+        /**
+         * \brief Encode the faces of a single channel cube map to R11 EAC blocks, with a full mip chain, and store it as a KTX file.
+         * \param[in] source Provides the faces.
+         * \param[in] userData Passed to source.
+         * \param[in] cachePath Path of the file to write.
+         * \return False if a face cannot be read, the faces differ in size, or the result cannot be written.
+         */
+        static bool encodeHeightCubemap(CubemapHeightSource source, void *userData, const std::string &cachePath);
+
+        /**
+         * \brief Load the first prebuilt compressed variant of an asset the device supports.
+         * \param[in] basePath Path of the asset, without the family suffix.
+         * \param[out] textureID The texture ID of the new texture.
+         * \param[out] info If not NULL, used to store what was loaded.
+         * \param[out] family If not NULL, used to store the family of the variant that was loaded.
+         * \return False if no compressed variant could be loaded.
+         */
+        static bool loadPrebuilt(const std::string &basePath, GLuint *textureID, KTXTextureInfo *info, Family *family);
+    public:
+        /**
+         * \brief Enable transcoding of universal source textures.
+         * \param[in] directory A writable directory, ending in a path separator. Pass NULL to disable transcoding.
+         */
+        static void setCacheDirectory(const char *directory);
+
+        /**
+         * \brief Encode an image to ETC1 blocks, which are also valid GL_COMPRESSED_RGB8_ETC2 data.
+         *
+         * The encoder used for transcoding, needs no context.
+         * \param[in] image Tightly packed 8-bit RGB rows.
+         * \param[in] width Width of the image. Edge pixels are replicated into the blocks it only partly covers.
+         * \param[in] height Height of the image.
+         * \param[out] output The blocks are appended to it, row by row.
+         */
+        static void encodeETC1(const unsigned char *image, int width, int height, std::vector<unsigned char> *output);
+
+        /**
+         * \brief Decode ETC1 blocks, to process a compressed image again, such as to build its mipmaps.
+         *
+         * Needs no context, like encodeETC1().
+         * \param[in] blocks The blocks, row by row, with no header.
+         * \param[in] width Width of the image, the blocks past it are dropped.
+         * \param[in] height Height of the image.
+         * \param[out] image Used to store the tightly packed 8-bit RGB rows.
+         */
+        static void decodeETC1(const unsigned char *blocks, int width, int height, std::vector<unsigned char> *image);
+
+        /**
+         * \brief Encode the first two channels of an image as GL_COMPRESSED_SIGNED_RG11_EAC blocks.
+         *
+         * Meant for normal maps: 0 to 255 become -1.0 to 1.0, and the shader reconstructs Z from X and Y.
+         * At 8 bits per pixel this is half the size of 8-bit RGBA, with 11 bits of precision per channel.
+         * Needs no context, like encodeETC1().
+         * \param[in] image Tightly packed 8-bit rows.
+         * \param[in] width Width of the image. Edge pixels are replicated into the blocks it only partly covers.
+         * \param[in] height Height of the image.
+         * \param[in] channels Number of channels of the image, at least 2.
+         * \param[out] output The blocks are appended to it, row by row.
+         */
+        static void encodeSignedRG11(const unsigned char *image, int width, int height, int channels, std::vector<unsigned char> *output);
+
+        /**
+         * \brief Encode a single channel image as GL_COMPRESSED_R11_EAC blocks.
+         *
+         * Meant for heights and displacement: 4 bits per pixel with 11 bits of precision, an eighth of the size
+         * of 8-bit RGBA. Needs no context, like encodeETC1().
+         * \param[in] image Tightly packed 16-bit rows, 0 to 65535 for 0.0 to 1.0.
+         * \param[in] width Width of the image. Edge pixels are replicated into the blocks it only partly covers.
+         * \param[in] height Height of the image.
+         * \param[out] output The blocks are appended to it, row by row.
+         */
+        static void encodeR11(const unsigned short *image, int width, int height, std::vector<unsigned char> *output);
+
+        /**
+         * \brief Check whether the current context supports a compressed internal format.
+         *
+         * Must be called with a current context.
+         * \param[in] internalFormat The compressed internal format.
+         * \return True if the format is listed by GL_COMPRESSED_TEXTURE_FORMATS, or is ASTC LDR and the extension is exposed.
+         */
+        static bool isFormatSupported(GLenum internalFormat);
+
+        /**
+         * \brief Check whether the current context supports a family of formats.
+         *
+         * Must be called with a current context.
+         * \param[in] family The family.
+         * \return True if textures of the family can be uploaded.
+         */
+        static bool isFamilySupported(Family family);
+
+        /**
+         * \brief Load the best variant of a texture asset.
+         *
+         * Must be called with a current context. The choice is logged.
+         * \param[in] basePath Path of the asset, without the family suffix.
+         * \param[out] textureID The texture ID of the new texture, 0 on failure.
+         * \param[out] info If not NULL, used to store what was loaded.
+         * \param[out] family If not NULL, used to store the family of the variant that was loaded.
+         * \return False if no variant could be loaded.
+         */
+        static bool loadTexture(const char *basePath, GLuint *textureID, KTXTextureInfo *info = NULL, Family *family = NULL);
+
+        /**
+         * \brief Load a compressed cube map with all its mip levels.
+         *
+         * Must be called with a current context. The prebuilt variants are tried first, as in loadTexture().
+         * If none is usable and a cache directory has been set, the faces are requested from source, encoded
+         * to ETC2 (or ETC1 on OpenGL ES 2.0) with a full mip chain, and stored in the cache, so that later runs
+         * load the compressed file directly. The cache entry is named after basePath, it has to be deleted
+         * when the faces change.
+         * There is no uncompressed fallback, if this fails the caller uploads the faces itself.
+         * \param[in] basePath Path of the asset, without the family suffix.
+         * \param[in] source Provides the faces, only called when the cube map has to be encoded.
+         * \param[in] userData Passed to source.
+         * \param[out] textureID The texture ID of the new texture, 0 on failure.
+         * \param[out] info If not NULL, used to store what was loaded.
+         * \param[out] family If not NULL, used to store the family of the variant that was loaded.
+         * \return False if no compressed cube map could be loaded or encoded.
+         */
+        static bool loadCubemap(const char *basePath, CubemapFaceSource source, void *userData, GLuint *textureID,
+                                KTXTextureInfo *info = NULL, Family *family = NULL);
+
+        /**
+         * \brief Load a single channel cube map, such as a displacement map, as GL_COMPRESSED_R11_EAC with all its mip levels.
+         *
+         * Must be called with a current OpenGL ES 3.0 context and a cache directory. On the first run the faces are
+         * requested from source, encoded with a full mip chain averaged at 16 bits, and stored in the cache like
+         * the cube maps of loadCubemap(). Shaders read the height from the red channel.
+         * There is no uncompressed fallback, if this fails the caller uploads the faces itself.
+         * \param[in] basePath Path of the asset, used to name the cache entry.
+         * \param[in] source Provides the faces, only called when the cube map has to be encoded.
+         * \param[in] userData Passed to source.
+         * \param[out] textureID The texture ID of the new texture, 0 on failure.
+         * \param[out] info If not NULL, used to store what was loaded.
+         * \return False if the cube map could not be loaded or encoded.
+         */
+        static bool loadHeightCubemap(const char *basePath, CubemapHeightSource source, void *userData, GLuint *textureID,
+                                      KTXTextureInfo *info = NULL);
+    };
+}
+#endif /* TEXTUREFORMATSELECTOR_H */
@@ -0,0 +1,223 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TEXTUREMANAGER_H
+#define TEXTUREMANAGER_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Keeps the textures of an application within a GPU memory budget.
+     *
+     * Textures loaded with Texture::loadCompressedMipmaps() stay resident until they are deleted, however long ago
+     * they were last drawn, and on devices with 2 or 3 GB the low memory killer counts them against the application.
+     * The manager loads the same PKM mipmap chains, counts the bytes of every level with ETCHeader::getSize(), and
+     * once per frame, while the resident textures are over budget, shrinks the least recently used ones:
+     * first by dropping their largest level, down to minimumSize, then by deleting them altogether.
+     * Textures used in the last frame are never shrunk.
+     *
+     * A texture which was shrunk or deleted comes back on its own: use() reloads a deleted texture from its
+     * smallest levels straight away, so there is always something to draw, and update() restores one level
+     * of one texture per frame while there is room for it.
+     *
+     * Typical usage:
+     * \code
+     * manager.setBudget(TextureManager::getDeviceBudget());
+     * TextureManager::Handle rock = manager.addCompressedMipmaps("/data/data/com.arm.malideveloper.openglessdk.sample/rock_", ".pkm");
+     *
+     * // Once per frame:
+     * manager.update();
+     * GL_CHECK(glBindTexture(GL_TEXTURE_2D, manager.use(rock)));
+     * \endcode
+     *
+     * Dropping or restoring a level creates a new texture, so the name returned by use() must not be kept across frames,
+     * and texture parameters set on it are lost: the textures keep the default sampler state, as with Texture::loadCompressedMipmaps().
+     */
+    class TextureManager
+    {
+    public:
+        /**
+         * \brief Identifies a texture of the manager.
+         */
+        typedef int Handle;
+
+    private:
+        struct ManagedTexture
+        {
+            /* Empty for a texture added with addTexture(), which is counted but never shrunk. */
+            std::string filenameBase;
+            std::string filenameSuffix;
+            int width;
+            int height;
+            int numberOfLevels;
+            /* Bytes of each level, counted with ETCHeader::getSize(). */
+            std::vector<size_t> levelBytes;
+            GLuint texture;
+            /* The largest level in the texture, numberOfLevels when it is not resident. */
+            int firstLevel;
+            /* The smallest of the first levels the texture can be shrunk to. */
+            int lastDroppableLevel;
+            unsigned int lastUsed;
+            size_t residentBytes;
+        };
+
+        std::vector<ManagedTexture> textures;
+        size_t budget;
+        size_t residentBytes;
+        int minimumSize;
+        unsigned int frame;
+        bool overBudgetReported;
+
+        /* Copying would leave two owners of the textures. */
+        TextureManager(const TextureManager &);
+        TextureManager &operator=(const TextureManager &);
+
+        /**
+         * \brief Replace the texture with a new one, from a given level down to the smallest.
+         * \param[in] managed The texture.
+         * \param[in] firstLevel The level which becomes level 0.
+         * \return False if a level cannot be read, the texture is then left as it was.
+         */
+        bool load(ManagedTexture &managed, int firstLevel);
+
+        /**
+         * \brief Delete the texture, the bytes it held are no longer counted.
+         * \param[in] managed The texture.
+         */
+        void unload(ManagedTexture &managed);
+
+        /**
+         * \brief Count the bytes of the levels from a given level down to the smallest.
+         * \param[in] managed The texture.
+         * \param[in] firstLevel The largest level counted.
+         * \return The number of bytes.
+         */
+        static size_t getBytes(const ManagedTexture &managed, int firstLevel);
+    public:
+        /**
+         * \brief Create a manager with no textures and the budget of getDeviceBudget().
+         */
+        TextureManager(void);
+
+        /**
+         * \brief Calls clear().
+         */
+        ~TextureManager(void);
+
+        /**
+         * \brief Pick a budget for this device, a sixteenth of its memory but at least 32 MB.
+         *
+         * A 2 GB device then gets 128 MB, which leaves room for the rest of the application below the point
+         * where Android starts killing it in the background.
+         * \return The budget in bytes.
+         */
+        static size_t getDeviceBudget(void);
+
+        /**
+         * \brief Set the number of bytes the resident textures may use, enforced from the next update().
+         * \param[in] bytes The budget in bytes.
+         */
+        void setBudget(size_t bytes);
+
+        /**
+         * \brief Set the size under which levels are no longer dropped, and the texture is deleted instead.
+         * \param[in] size Width or height in texels, 32 by default.
+         */
+        void setMinimumSize(int size);
+
+        /**
+         * \brief Load a chain of PKM mipmap levels, named as for Texture::loadCompressedMipmaps().
+         *
+         * Must be called with a current context. Every level is loaded, even over budget: update() shrinks the
+         * textures which are not used.
+         * \param[in] filenameBase The base filename of the levels, the level number is appended to it.
+         * \param[in] filenameSuffix Appended to the filenames after the level number, most commonly ".pkm".
+         * \return The handle of the texture, or -1 if a level cannot be read.
+         */
+        Handle addCompressedMipmaps(const char *filenameBase, const char *filenameSuffix);
+
+        /**
+         * \brief Count a texture the application loaded itself against the budget. It is never shrunk.
+         * \param[in] texture The texture name, which the application still owns.
+         * \param[in] bytes The bytes of all its levels.
+         * \return The handle of the texture.
+         */
+        Handle addTexture(GLuint texture, size_t bytes);
+
+        /**
+         * \brief Mark a texture as used in this frame, and get its current name.
+         *
+         * Must be called with a current context. A texture which is not resident is reloaded from its smallest levels.
+         * \param[in] handle The texture.
+         * \return The texture name, 0 if it cannot be reloaded.
+         */
+        GLuint use(Handle handle);
+
+        /**
+         * \brief Shrink the least recently used textures until they fit the budget, or restore a level of a texture in use.
+         *
+         * Call once per frame, before the textures are used, with a current context.
+         */
+        void update(void);
+
+        /**
+         * \brief Delete every texture the manager loaded, and forget those it did not.
+         */
+        void clear(void);
+
+        /**
+         * \brief Get the number of bytes of the resident textures.
+         * \return The bytes counted against the budget.
+         */
+        size_t getResidentBytes(void) const;
+
+        /**
+         * \brief Get the budget.
+         * \return The budget in bytes.
+         */
+        size_t getBudget(void) const;
+
+        /**
+         * \brief Get the number of levels a texture is missing.
+         * \param[in] handle The texture.
+         * \return 0 for a texture with all its levels, its number of levels when it is not resident.
+         */
+        int getDroppedLevels(Handle handle) const;
+
+        /**
+         * \brief Log the bytes resident, and how many textures are shrunk or not resident.
+         * \param[in] label Printed at the start of the line, e.g. the name of the scene.
+         */
+        void logResidency(const char *label) const;
+    };
+}
+#endif /* TEXTUREMANAGER_H */
@@ -0,0 +1,176 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef THERMALMONITOR_H
+#define THERMALMONITOR_H
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Samples CPU and GPU frequencies, temperatures and the thermal status on a thread of its own.
+     *
+     * Long runs are limited by heat rather than by how fast the first frames are: once the device warms up, the
+     * governors cap the clocks and the frame times grow. The monitor records, at a fixed rate:
+     * - the highest current CPU frequency and how far the thermal limit of the CPUs is below their
+     *   maximum, from /sys/devices/system/cpu/cpu<n>/cpufreq,
+     * - the same for the GPU, from the devfreq device in /sys/class/devfreq whose name mentions the GPU,
+     * - the temperature of the hottest zone in /sys/class/thermal,
+     * - the thermal status PowerManager reports to applications, through AThermal_getCurrentThermalStatus()
+     *   of the NDK (Android 11), so it needs no Java and works in the benchmark harness.
+     *
+     * A sample counts as throttled when the thermal status is at least moderate, or when the CPU or GPU cannot
+     * reach 95 % of its maximum frequency. Files which cannot be read, as SELinux hides some of them from
+     * applications, leave their values unknown and do not count as throttling.
+     *
+     * The thread only reads small files, about a millisecond of work per sample, and sleeps in between.
+     */
+    class ThermalMonitor
+    {
+    public:
+        /**
+         * \brief Thermal status, the values of AThermalStatus and PowerManager.THERMAL_STATUS_*.
+         */
+        enum ThermalStatus
+        {
+            STATUS_UNKNOWN = -1,
+            STATUS_NONE = 0,
+            STATUS_LIGHT = 1,
+            STATUS_MODERATE = 2,
+            STATUS_SEVERE = 3,
+            STATUS_CRITICAL = 4,
+            STATUS_EMERGENCY = 5,
+            STATUS_SHUTDOWN = 6
+        };
+
+        /**
+         * \brief One reading of the counters. Frequencies in MHz and temperatures in degrees Celsius, negative if unknown.
+         */
+        struct Sample
+        {
+            /** Seconds since start(). */
+            float time;
+            /** Highest current frequency of the CPUs. */
+            float cpuFrequency;
+            /** Lowest ratio of the frequency limit of a CPU to its maximum, 1 when no CPU is capped. */
+            float cpuLimit;
+            /** Current frequency of the GPU. */
+            float gpuFrequency;
+            /** Ratio of the frequency limit of the GPU to its maximum. */
+            float gpuLimit;
+            /** Temperature of the hottest thermal zone. */
+            float temperature;
+            /** One of the ThermalStatus values. */
+            int thermalStatus;
+            /** Whether the status or the frequency limits show throttling. */
+            bool throttled;
+        };
+
+    private:
+        struct CPU
+        {
+            std::string currentFrequencyPath;
+            std::string limitPath;
+            long long maximumFrequency;
+        };
+
+        std::vector<CPU> cpus;
+        std::string gpuPath;
+        long long gpuMaximumFrequency;
+        std::vector<std::string> thermalZonePaths;
+
+        void *thermalManager;
+
+        long long startTime;
+        long long interval;
+        std::vector<Sample> samples;
+        mutable pthread_mutex_t mutex;
+        pthread_cond_t wakeUp;
+        bool stopping;
+        bool threadStarted;
+        pthread_t thread;
+
+        /* Copying would leave two owners of the thread. */
+        ThermalMonitor(const ThermalMonitor &);
+        ThermalMonitor &operator=(const ThermalMonitor &);
+
+        /**
+         * \brief Find the CPU, GPU and thermal zone files which can be read.
+         */
+        void findSources(void);
+
+        /**
+         * \brief Read all the counters once.
+         */
+        Sample read(void);
+
+        /**
+         * \brief Working function of the sampling thread.
+         * \param[in] monitor The ThermalMonitor that started the thread.
+         * \return Always NULL.
+         */
+        static void *threadFunction(void *monitor);
+    public:
+        /**
+         * \brief Create an idle monitor.
+         */
+        ThermalMonitor(void);
+
+        /**
+         * \brief Calls stop().
+         */
+        ~ThermalMonitor(void);
+
+        /**
+         * \brief Take a first sample on the calling thread, then start sampling on a thread of its own.
+         *
+         * Forgets the samples of a previous run.
+         * \param[in] samplesPerSecond Rate of the samples.
+         * \return False if the thread cannot be started, only the first sample is recorded then.
+         */
+        bool start(float samplesPerSecond = 1.0f);
+
+        /**
+         * \brief Stop the sampling thread, waiting for the sample it is taking. The samples are kept.
+         */
+        void stop(void);
+
+        /**
+         * \brief Copy of the samples recorded since start(), oldest first.
+         */
+        std::vector<Sample> getSamples(void) const;
+
+        /**
+         * \brief Whether any sample recorded since start() is throttled.
+         * \param[out] firstThrottledTime If not NULL and throttling was seen, the time of the first throttled sample in seconds.
+         */
+        bool hasThrottled(float *firstThrottledTime = NULL) const;
+
+        /**
+         * \brief Seconds since start(), on the clock of the sample times. Can be called from any thread.
+         */
+        float getTime(void) const;
+    };
+}
+#endif /* THERMALMONITOR_H */
@@ -25,37 +25,60 @@
 
 #if defined(_WIN32)
 #else
-#include <sys/time.h>
+#include <time.h>
 #endif
 
 namespace MaliSDK
 {
     /**
      * \brief Provides a platform independent high resolution timer.
-     * \note The timer measures real time, not CPU time.
+     * \note The timer measures real time, not CPU time. It is monotonic: changes of the
+     * wall clock (network time updates, time zones) do not make it jump.
+     *
+     * For deterministic runs, such as benchmarks, animation timers can be switched to a simulated clock with
+     * setFixedTimeStep(), which only moves when advanceFixedTime() is called. Timers measuring how long
+     * work takes are created with RealClock so they keep measuring real time.
      */
     class Timer
     {
+    public:
+        /**
+         * \brief Which clock a timer follows while a fixed time step is set.
+         */
+        enum Clock
+        {
+            /** The simulated clock, for animation. */
+            AnimationClock,
+            /** Always the real clock, for measurements. */
+            RealClock
+        };
+
     private:
+        Clock clock;
         int frameCount;
         float fps;
         float lastTime;
+        long long fixedStartTime;
+
+        static long long fixedTimeStep;
+        static long long fixedTime;
     #if defined(_WIN32)
         double resetStamp;
         double invFreq;
         float lastInterval;
         float lastFpsUpdate;
     #else
-        timeval startTime;
-        timeval currentTime;
+        timespec startTime;
+        timespec currentTime;
         float lastIntervalTime;
         float fpsTime;
     #endif
     public:
         /**
          * \brief Default Constructor
+         * \param[in] clock Whether the timer follows the simulated clock set with setFixedTimeStep().
          */
-        Timer();
+        Timer(Clock clock = AnimationClock);
         
         /**
          * \brief Resets the timer to 0.0f.
@@ -68,6 +91,14 @@ namespace MaliSDK
          */
         float getTime();
 
+        /**
+         * \brief Returns the time passed since object creation or since reset() was last called, in nanoseconds.
+         *
+         * Unlike getTime() it keeps full resolution however long the timer runs.
+         * \return The time in nanoseconds.
+         */
+        long long getTimeNanoseconds();
+
         /**
          * \brief Returns the time passed since getInterval() was last called.
          *
@@ -91,6 +122,32 @@ namespace MaliSDK
          * \return bool true if a 'seconds' seconds are passed and false otherwise.
         */
         bool isTimePassed(float seconds = 1.0f);
+
+        /**
+         * \brief Drive every timer from a simulated clock instead of the real one.
+         *
+         * Timers reset while the simulated clock is used start from its current time.
+         * \param[in] seconds Time the simulated clock moves on each advanceFixedTime(). 0 returns to the real clock.
+         */
+        static void setFixedTimeStep(float seconds);
+
+        /**
+         * \brief Move the simulated clock on by one time step. Call once per frame.
+         */
+        static void advanceFixedTime(void);
+
+        /**
+         * \brief Check whether animation timers follow the simulated clock.
+         * \return True if setFixedTimeStep() has been called with a time step greater than 0.
+         */
+        static bool isFixedTimeStep(void);
     };
 }
+
+/*
+ * C entry points of Timer::setFixedTimeStep() and Timer::advanceFixedTime(). Every sample library has its own
+ * copy of the timers, so the benchmark harness looks these up in the library with dlsym().
+ */
+extern "C" void MaliSDK_Timer_setFixedTimeStep(float seconds);
+extern "C" void MaliSDK_Timer_advanceFixedTime(void);
 #endif /* TIMER_H */
\ No newline at end of file
@@ -0,0 +1,145 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TRANSFORMHIERARCHY_H
+#define TRANSFORMHIERARCHY_H
+
+#include <cstddef>
+#include <vector>
+
+namespace MaliSDK
+{
+    class JobScheduler;
+
+    /**
+     * \brief Local and world matrices of a tree of scene nodes, kept in flat arrays and only recomputed when they change.
+     *
+     * Each node has a parent index and a local matrix, relative to its parent. The world matrix of a node is the world
+     * matrix of its parent times its local matrix, or its local matrix for a root. setLocal() only marks the node
+     * dirty, and update() recomputes the world matrices of the dirty nodes and of everything below them, once per
+     * frame however many times the locals were set. Nodes which did not move cost nothing.
+     *
+     * Parents are added before their children, so the nodes are in an order where every parent comes first and one
+     * pass over the arrays propagates the dirty flags. The matrices are stored contiguously, 16 floats each and
+     * column major, so they can be uploaded as they are. getChangedNodes() lists the nodes update() recomputed, to
+     * upload only those.
+     *
+     * Given a JobScheduler, update() works through the tree a depth at a time, spreading the nodes of each depth
+     * over the workers, as the children need the world matrices of their parents.
+     *
+     * Typical usage:
+     * \code
+     * unsigned int body = hierarchy.addNode(-1, bodyMatrix);
+     * unsigned int arm = hierarchy.addNode(body, armMatrix);
+     *
+     * // Every frame:
+     * hierarchy.setLocal(body, newBodyMatrix);
+     * hierarchy.update(&scheduler);
+     * glUniformMatrix4fv(modelLocation, 1, GL_FALSE, hierarchy.getWorld(arm));
+     * \endcode
+     */
+    class TransformHierarchy
+    {
+    private:
+        std::vector<int> parents;
+        std::vector<unsigned int> depths;
+        std::vector<float> locals;
+        std::vector<float> worlds;
+        std::vector<unsigned char> dirty;
+
+        /* Dirty nodes of each depth, rebuilt by every update(). */
+        std::vector<std::vector<unsigned int> > levels;
+        std::vector<unsigned int> changedNodes;
+
+        /**
+         * \brief Recompute the world matrices of a range of the nodes of one depth.
+         * \param[in] begin First index in the list of nodes.
+         * \param[in] end One past the last index in the list of nodes.
+         * \param[in] userData The UpdateRange describing the list.
+         */
+        static void updateRange(unsigned int begin, unsigned int end, void *userData);
+
+        /**
+         * \brief Recompute the world matrix of a node, whose parent is up to date.
+         */
+        void updateNode(unsigned int node);
+
+    public:
+        /**
+         * \brief Add a node.
+         * \param[in] parent Index of the parent node, returned by an earlier addNode(), or -1 for a root.
+         * \param[in] local Column major local matrix, 16 floats. NULL for the identity.
+         * \return The index of the node.
+         */
+        unsigned int addNode(int parent, const float *local);
+
+        /**
+         * \brief Remove all nodes.
+         */
+        void clear(void);
+
+        /**
+         * \brief Replace the local matrix of a node, its world matrix and those below it are updated by update().
+         * \param[in] node Index of the node.
+         * \param[in] local Column major local matrix, 16 floats.
+         */
+        void setLocal(unsigned int node, const float *local);
+
+        /**
+         * \brief Recompute the world matrices of the nodes whose local matrix, or one of their parents', was set.
+         * \param[in] scheduler Spreads the work over its workers if not NULL.
+         */
+        void update(JobScheduler *scheduler = NULL);
+
+        /**
+         * \brief Get the local matrix of a node.
+         * \return 16 floats, column major.
+         */
+        const float *getLocal(unsigned int node) const;
+
+        /**
+         * \brief Get the world matrix of a node, as of the last update().
+         * \return 16 floats, column major.
+         */
+        const float *getWorld(unsigned int node) const;
+
+        /**
+         * \brief Get the world matrices of all nodes, 16 floats each in node order.
+         */
+        const float *getWorldMatrices(void) const;
+
+        /**
+         * \brief Get the parent of a node.
+         * \return -1 for a root.
+         */
+        int getParent(unsigned int node) const;
+
+        /**
+         * \brief Get the number of nodes.
+         */
+        unsigned int getCount(void) const;
+
+        /**
+         * \brief Get the nodes whose world matrix the last update() recomputed, parents first.
+         */
+        const std::vector<unsigned int> &getChangedNodes(void) const;
+    };
+}
+#endif /* TRANSFORMHIERARCHY_H */
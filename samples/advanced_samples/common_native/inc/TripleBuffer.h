@@ -0,0 +1,119 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Hands snapshots of state from one thread to another without either of them ever waiting.
+     *
+     * There are three copies of the state: the writer fills one, the reader reads another, and the third holds
+     * the latest snapshot published. publish() swaps the written copy with the third one, and acquire() swaps
+     * the third one with the copy being read if something new has been published since. Both swaps are a single
+     * atomic exchange, so a slow reader never holds up the writer or the other way round: the writer just
+     * overwrites snapshots the reader has not picked up, and the reader keeps the one it has until there is a newer one.
+     *
+     * Typical usage:
+     * \code
+     * buffer.initialize(sizeof(State));
+     *
+     * // On the writing thread:
+     * State *state = (State *)buffer.getWriteBuffer();
+     * ...
+     * buffer.publish();
+     *
+     * // On the reading thread:
+     * const State *state = (const State *)buffer.acquire();
+     * \endcode
+     *
+     * The state is copied around as raw memory, so it has to be plain data. Only one thread may write and one read.
+     */
+    class TripleBuffer
+    {
+    private:
+        /* Set in the shared index when the copy it names has been published and not acquired yet. */
+        static const unsigned int freshBit = 4;
+
+        unsigned char *data;
+        size_t stateSize;
+        /* The copy held between the two threads, and freshBit. */
+        std::atomic<unsigned int> sharedIndex;
+        unsigned int writeIndex;
+        unsigned int readIndex;
+
+        /* Copying would leave two owners of the copies. */
+        TripleBuffer(const TripleBuffer &);
+        TripleBuffer &operator=(const TripleBuffer &);
+    public:
+        /**
+         * \brief Create a buffer with no state.
+         */
+        TripleBuffer(void);
+
+        /**
+         * \brief Calls terminate().
+         */
+        ~TripleBuffer(void);
+
+        /**
+         * \brief Allocate the three copies, cleared to zero.
+         *
+         * Must not be called while either thread uses the buffer.
+         * \param[in] stateSize Size of a snapshot in bytes.
+         */
+        void initialize(size_t stateSize);
+
+        /**
+         * \brief Free the copies.
+         */
+        void terminate(void);
+
+        /**
+         * \brief Get the copy the writer fills in. Writing thread only.
+         *
+         * The copy is not cleared: it holds whatever snapshot it held before, not necessarily the last one published.
+         * \return The copy to write the next snapshot to.
+         */
+        void *getWriteBuffer(void);
+
+        /**
+         * \brief Make the copy returned by getWriteBuffer() the latest snapshot. Writing thread only.
+         */
+        void publish(void);
+
+        /**
+         * \brief Pick up the latest snapshot, if one has been published since the last call. Reading thread only.
+         * \return The latest snapshot, which stays valid and unchanged until the next call.
+         */
+        const void *acquire(void);
+
+        /**
+         * \brief Check whether a snapshot has been published which acquire() has not picked up yet.
+         * \return True if acquire() would return a newer snapshot.
+         */
+        bool isFresh(void) const;
+    };
+}
+#endif /* TRIPLEBUFFER_H */
@@ -0,0 +1,136 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef UNIFORMBUFFERRING_H
+#define UNIFORMBUFFERRING_H
+
+#include <GLES3/gl3.h>
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief One uniform buffer shared by all per-frame constants, sub-allocated linearly and reused in a ring.
+     *
+     * The buffer is split in one region per frame in flight. beginFrame() moves to the next region, waiting on the
+     * fence inserted by the endFrame() that last used it, so the CPU never overwrites data the GPU still reads and
+     * the uploads can map the buffer unsynchronized. Allocations are aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+     * so they can be bound with glBindBufferRange.
+     *
+     * A buffer cannot be used by a draw while it is mapped, so allocate() returns memory in a CPU-side copy of the
+     * region and flush() uploads everything allocated since the previous flush with a single map. Typical usage:
+     * \code
+     * ring.beginFrame();
+     * for (each object)
+     * {
+     *     GLintptr offset;
+     *     ObjectConstants *constants = static_cast<ObjectConstants*>(ring.allocate(sizeof(ObjectConstants), &offset));
+     *     ...
+     * }
+     * ring.flush();
+     * for (each object)
+     * {
+     *     ring.bindRange(0, offset, sizeof(ObjectConstants));
+     *     glDraw...
+     * }
+     * ring.endFrame();
+     * \endcode
+     */
+    class UniformBufferRing
+    {
+    private:
+        GLuint buffer;
+        GLint alignment;
+        GLint maxBlockSize;
+
+        GLsizeiptr regionSize;
+        unsigned int numberOfRegions;
+        std::vector<GLsync> fences;
+        unsigned int region;
+
+        std::vector<unsigned char> staging;
+        GLsizeiptr head;
+        GLsizeiptr flushedHead;
+
+        UniformBufferRing(const UniformBufferRing &);
+        UniformBufferRing &operator=(const UniformBufferRing &);
+
+    public:
+        /**
+         * \brief Create the buffer. Needs a current context.
+         * \param[in] frameSize Bytes available to the allocations of one frame.
+         * \param[in] framesInFlight Number of frames the GPU may lag behind the CPU.
+         */
+        UniformBufferRing(GLsizeiptr frameSize, unsigned int framesInFlight = 3);
+
+        /**
+         * \brief Delete the buffer and the pending fences. Needs the context the ring was created in.
+         */
+        ~UniformBufferRing(void);
+
+        /**
+         * \brief Start allocating from the next region, waiting for the GPU to finish with it if needed.
+         */
+        void beginFrame(void);
+
+        /**
+         * \brief Reserve memory for constants in the current region.
+         * \param[in] size Bytes to allocate. Must not exceed GL_MAX_UNIFORM_BLOCK_SIZE.
+         * \param[out] offset Offset of the allocation in the buffer, to pass to bindRange().
+         * \return Where to write the constants, valid until the next flush(). NULL if the region is full.
+         */
+        void *allocate(GLsizeiptr size, GLintptr *offset);
+
+        /**
+         * \brief Copy the allocations made since the previous flush to the buffer. Call before drawing with them.
+         */
+        void flush(void);
+
+        /**
+         * \brief Bind an allocation to a uniform block binding point.
+         * \param[in] index The binding point.
+         * \param[in] offset The offset returned by allocate().
+         * \param[in] size Bytes to bind, at least the size of the uniform block.
+         */
+        void bindRange(GLuint index, GLintptr offset, GLsizeiptr size) const;
+
+        /**
+         * \brief Flush and fence the current region, so a later beginFrame() knows when it can reuse it.
+         */
+        void endFrame(void);
+
+        /**
+         * \brief The uniform buffer object.
+         */
+        GLuint getBuffer(void) const;
+
+        /**
+         * \brief Alignment of the allocations in bytes.
+         */
+        GLint getAlignment(void) const;
+
+        /**
+         * \brief Bytes allocated in the current frame, including the alignment padding.
+         */
+        GLsizeiptr getUsedSize(void) const;
+    };
+}
+#endif /* UNIFORMBUFFERRING_H */
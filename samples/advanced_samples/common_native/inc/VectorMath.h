@@ -0,0 +1,485 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VECTORMATH_H
+#define VECTORMATH_H
+
+#include <cmath>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VECTORMATH_USE_NEON 1
+#else
+#define VECTORMATH_USE_NEON 0
+#endif
+
+/**
+ * \file samples/advanced_samples/common_native/inc/VectorMath.h
+ * \brief Fixed size vector and matrix templates, defined inline so per frame maths compiles down to a few instructions.
+ *
+ * vec<T, N> holds N components named x, y, z and w, without padding, so arrays of vectors can be uploaded to
+ * vertex and uniform buffers as they are. The vectors are aggregates, \code vec3 up = {0.0f, 1.0f, 0.0f}; \endcode
+ * and their arithmetic is constexpr, so constant vectors are folded at compile time.
+ *
+ * mat<T, N> is column major like OpenGL ES uniforms. mat4 is 16 byte aligned, and its products use NEON when the
+ * compiler targets it (always on arm64-v8a, and on armeabi-v7a when built with -mfpu=neon). The Matrix class
+ * converts to and from mat4, see Matrix::getAsMat4().
+ *
+ * Everything is in the MaliSDK::math namespace, so its short, GLSL like names don't clash with the samples'
+ * own after a using namespace MaliSDK. The operators are found through the argument types, without a using.
+ * The VectorTypes.h classes are the vec<T, N> of the same size, so both can be mixed freely.
+ */
+
+namespace MaliSDK
+{
+    namespace math
+    {
+        /**
+         * \brief Vector of N components of type T. Only N = 2, 3 and 4 are defined.
+         */
+        template <typename T, int N>
+        struct vec;
+
+        /**
+         * \brief A 2D vector.
+         */
+        template <typename T>
+        struct vec<T, 2>
+        {
+            T x, y;
+
+            T &operator[](int index)
+            {
+                return (&x)[index];
+            }
+
+            const T &operator[](int index) const
+            {
+                return (&x)[index];
+            }
+        };
+
+        /**
+         * \brief A 3D vector.
+         */
+        template <typename T>
+        struct vec<T, 3>
+        {
+            T x, y, z;
+
+            T &operator[](int index)
+            {
+                return (&x)[index];
+            }
+
+            const T &operator[](int index) const
+            {
+                return (&x)[index];
+            }
+
+            /**
+             * \brief Calculate dot product between two 3D vectors.
+             *
+             * \param[in] vector1 First vector that will be used to compute product.
+             * \param[in] vector2 Second vector that will be used to compute product.
+             *
+             * \return Value that is a result of dot product of vector1 and vector2.
+             */
+            static constexpr T dot(const vec &vector1, const vec &vector2)
+            {
+                return vector1.x * vector2.x + vector1.y * vector2.y + vector1.z * vector2.z;
+            }
+
+            /**
+             * \brief Calculate cross product between two 3D vectors.
+             *
+             * \param[in] vector1 First vector that will be used to compute cross product.
+             * \param[in] vector2 Second vector that will be used to compute cross product.
+             *
+             * \return Vector that is a result of cross product of vector1 and vector2.
+             */
+            static constexpr vec cross(const vec &vector1, const vec &vector2)
+            {
+                return vec{vector1.y * vector2.z - vector1.z * vector2.y,
+                           vector1.z * vector2.x - vector1.x * vector2.z,
+                           vector1.x * vector2.y - vector1.y * vector2.x};
+            }
+
+            /**
+             * \brief Normalize the vector in place.
+             */
+            void normalize(void)
+            {
+                T length = std::sqrt(x * x + y * y + z * z);
+
+                x /= length;
+                y /= length;
+                z /= length;
+            }
+        };
+
+        /**
+         * \brief A 4D vector.
+         */
+        template <typename T>
+        struct vec<T, 4>
+        {
+            T x, y, z, w;
+
+            T &operator[](int index)
+            {
+                return (&x)[index];
+            }
+
+            const T &operator[](int index) const
+            {
+                return (&x)[index];
+            }
+
+            /**
+             * \brief Normalize the vector in place, all four components.
+             */
+            void normalize(void)
+            {
+                T length = std::sqrt(x * x + y * y + z * z + w * w);
+
+                x /= length;
+                y /= length;
+                z /= length;
+                w /= length;
+            }
+        };
+
+        typedef vec<float, 2> vec2;
+        typedef vec<float, 3> vec3;
+        typedef vec<float, 4> vec4;
+        typedef vec<int, 2>   ivec2;
+        typedef vec<int, 3>   ivec3;
+        typedef vec<int, 4>   ivec4;
+
+        /*
+         * Component-wise operators, for vectors and for a vector and a scalar on either side. C++11 constexpr
+         * functions are a single return statement, so every size is spelled out.
+         */
+#define VECTORMATH_DEFINE_OPERATOR(op, assignmentOp)                                                                        \
+        template <typename T>                                                                                               \
+        constexpr vec<T, 2> operator op(const vec<T, 2> &left, const vec<T, 2> &right)                                      \
+        {                                                                                                                   \
+            return vec<T, 2>{left.x op right.x, left.y op right.y};                                                         \
+        }                                                                                                                   \
+        template <typename T>                                                                                               \
+        constexpr vec<T, 3> operator op(const vec<T, 3> &left, const vec<T, 3> &right)                                      \
+        {                                                                                                                   \
+            return vec<T, 3>{left.x op right.x, left.y op right.y, left.z op right.z};                                      \
+        }                                                                                                                   \
+        template <typename T>                                                                                               \
+        constexpr vec<T, 4> operator op(const vec<T, 4> &left, const vec<T, 4> &right)                                      \
+        {                                                                                                                   \
+            return vec<T, 4>{left.x op right.x, left.y op right.y, left.z op right.z, left.w op right.w};                   \
+        }                                                                                                                   \
+        template <typename T>                                                                                               \
+        constexpr vec<T, 2> operator op(const vec<T, 2> &left, T right)                                                     \
+        {                                                                                                                   \
+            return vec<T, 2>{left.x op right, left.y op right};                                                             \
+        }                                                                                                                   \
+        template <typename T>                                                                                               \
+        constexpr vec<T, 3> operator op(const vec<T, 3> &left, T right)                                                     \
+        {                                                                                                                   \
+            return vec<T, 3>{left.x op right, left.y op right, left.z op right};                                            \
+        }                                                                                                                   \
+        template <typename T>                                                                                               \
+        constexpr vec<T, 4> operator op(const vec<T, 4> &left, T right)                                                     \
+        {                                                                                                                   \
+            return vec<T, 4>{left.x op right, left.y op right, left.z op right, left.w op right};                           \
+        }                                                                                                                   \
+        template <typename T>                                                                                               \
+        constexpr vec<T, 2> operator op(T left, const vec<T, 2> &right)                                                     \
+        {                                                                                                                   \
+            return vec<T, 2>{left op right.x, left op right.y};                                                             \
+        }                                                                                                                   \
+        template <typename T>                                                                                               \
+        constexpr vec<T, 3> operator op(T left, const vec<T, 3> &right)                                                     \
+        {                                                                                                                   \
+            return vec<T, 3>{left op right.x, left op right.y, left op right.z};                                            \
+        }                                                                                                                   \
+        template <typename T>                                                                                               \
+        constexpr vec<T, 4> operator op(T left, const vec<T, 4> &right)                                                     \
+        {                                                                                                                   \
+            return vec<T, 4>{left op right.x, left op right.y, left op right.z, left op right.w};                           \
+        }                                                                                                                   \
+        template <typename T, int N>                                                                                        \
+        vec<T, N> &operator assignmentOp(vec<T, N> &left, const vec<T, N> &right)                                           \
+        {                                                                                                                   \
+            return left = left op right;                                                                                    \
+        }                                                                                                                   \
+        template <typename T, int N>                                                                                        \
+        vec<T, N> &operator assignmentOp(vec<T, N> &left, T right)                                                          \
+        {                                                                                                                   \
+            return left = left op right;                                                                                    \
+        }
+
+        VECTORMATH_DEFINE_OPERATOR(+, +=)
+        VECTORMATH_DEFINE_OPERATOR(-, -=)
+        VECTORMATH_DEFINE_OPERATOR(*, *=)
+        VECTORMATH_DEFINE_OPERATOR(/, /=)
+
+#undef VECTORMATH_DEFINE_OPERATOR
+
+        template <typename T>
+        constexpr vec<T, 2> operator-(const vec<T, 2> &vector)
+        {
+            return vec<T, 2>{-vector.x, -vector.y};
+        }
+
+        template <typename T>
+        constexpr vec<T, 3> operator-(const vec<T, 3> &vector)
+        {
+            return vec<T, 3>{-vector.x, -vector.y, -vector.z};
+        }
+
+        template <typename T>
+        constexpr vec<T, 4> operator-(const vec<T, 4> &vector)
+        {
+            return vec<T, 4>{-vector.x, -vector.y, -vector.z, -vector.w};
+        }
+
+        template <typename T>
+        constexpr T dot(const vec<T, 2> &left, const vec<T, 2> &right)
+        {
+            return left.x * right.x + left.y * right.y;
+        }
+
+        template <typename T>
+        constexpr T dot(const vec<T, 3> &left, const vec<T, 3> &right)
+        {
+            return left.x * right.x + left.y * right.y + left.z * right.z;
+        }
+
+        template <typename T>
+        constexpr T dot(const vec<T, 4> &left, const vec<T, 4> &right)
+        {
+            return left.x * right.x + left.y * right.y + left.z * right.z + left.w * right.w;
+        }
+
+        template <typename T>
+        constexpr vec<T, 3> cross(const vec<T, 3> &left, const vec<T, 3> &right)
+        {
+            return vec<T, 3>::cross(left, right);
+        }
+
+        template <typename T, int N>
+        T length(const vec<T, N> &vector)
+        {
+            return std::sqrt(dot(vector, vector));
+        }
+
+        /**
+         * \brief Return the vector scaled to unit length. Unlike vec::normalize(), the argument is left as it is.
+         */
+        template <typename T, int N>
+        vec<T, N> normalize(const vec<T, N> &vector)
+        {
+            return vector * (T(1) / length(vector));
+        }
+
+        /**
+         * \brief Square matrix of N by N components of type T, stored column major. mat4 is 16 byte aligned.
+         */
+        template <typename T, int N>
+        struct alignas((sizeof(T) * N * N) % 16 == 0 ? 16 : alignof(T)) mat
+        {
+            vec<T, N> columns[N];
+
+            vec<T, N> &operator[](int column)
+            {
+                return columns[column];
+            }
+
+            const vec<T, N> &operator[](int column) const
+            {
+                return columns[column];
+            }
+
+            /**
+             * \brief The elements as a column major array, e.g. for glUniformMatrix4fv().
+             */
+            T *data(void)
+            {
+                return &columns[0].x;
+            }
+
+            const T *data(void) const
+            {
+                return &columns[0].x;
+            }
+
+            static mat identity(void)
+            {
+                mat result;
+
+                for (int column = 0; column < N; column++)
+                {
+                    for (int row = 0; row < N; row++)
+                    {
+                        result.columns[column][row] = column == row ? T(1) : T(0);
+                    }
+                }
+
+                return result;
+            }
+
+            /**
+             * \brief Load a column major array of N * N elements.
+             */
+            static mat fromArray(const T *elements)
+            {
+                mat result;
+
+                for (int column = 0; column < N; column++)
+                {
+                    for (int row = 0; row < N; row++)
+                    {
+                        result.columns[column][row] = elements[column * N + row];
+                    }
+                }
+
+                return result;
+            }
+        };
+
+        typedef mat<float, 3> mat3;
+        typedef mat<float, 4> mat4;
+
+        template <typename T, int N>
+        inline vec<T, N> operator*(const mat<T, N> &matrix, const vec<T, N> &vector)
+        {
+            vec<T, N> result = matrix.columns[0] * vector[0];
+
+            for (int column = 1; column < N; column++)
+            {
+                result += matrix.columns[column] * vector[column];
+            }
+
+            return result;
+        }
+
+        template <typename T, int N>
+        inline mat<T, N> operator*(const mat<T, N> &left, const mat<T, N> &right)
+        {
+            mat<T, N> result;
+
+            for (int column = 0; column < N; column++)
+            {
+                result.columns[column] = left * right.columns[column];
+            }
+
+            return result;
+        }
+
+        template <typename T, int N>
+        inline mat<T, N> transpose(const mat<T, N> &matrix)
+        {
+            mat<T, N> result;
+
+            for (int column = 0; column < N; column++)
+            {
+                for (int row = 0; row < N; row++)
+                {
+                    result.columns[column][row] = matrix.columns[row][column];
+                }
+            }
+
+            return result;
+        }
+
+#if VECTORMATH_USE_NEON
+        /* More specialized than the templates above, so picked for mat4 whenever NEON is available. */
+        inline vec4 operator*(const mat4 &matrix, const vec4 &vector)
+        {
+            float32x4_t result = vmulq_n_f32(vld1q_f32(&matrix.columns[0].x), vector.x);
+
+            result = vmlaq_n_f32(result, vld1q_f32(&matrix.columns[1].x), vector.y);
+            result = vmlaq_n_f32(result, vld1q_f32(&matrix.columns[2].x), vector.z);
+            result = vmlaq_n_f32(result, vld1q_f32(&matrix.columns[3].x), vector.w);
+
+            vec4 stored;
+            vst1q_f32(&stored.x, result);
+
+            return stored;
+        }
+
+        inline mat4 operator*(const mat4 &left, const mat4 &right)
+        {
+            float32x4_t column0 = vld1q_f32(&left.columns[0].x);
+            float32x4_t column1 = vld1q_f32(&left.columns[1].x);
+            float32x4_t column2 = vld1q_f32(&left.columns[2].x);
+            float32x4_t column3 = vld1q_f32(&left.columns[3].x);
+            mat4 result;
+
+            for (int column = 0; column < 4; column++)
+            {
+                const vec4 &rightColumn = right.columns[column];
+                float32x4_t accumulator = vmulq_n_f32(column0, rightColumn.x);
+
+                accumulator = vmlaq_n_f32(accumulator, column1, rightColumn.y);
+                accumulator = vmlaq_n_f32(accumulator, column2, rightColumn.z);
+                accumulator = vmlaq_n_f32(accumulator, column3, rightColumn.w);
+
+                vst1q_f32(&result.columns[column].x, accumulator);
+            }
+
+            return result;
+        }
+#endif
+
+        /**
+         * \brief Transform a point, w = 1. No perspective division is performed.
+         */
+        inline vec3 transformPoint(const mat4 &matrix, const vec3 &point)
+        {
+            vec4 result = matrix * vec4{point.x, point.y, point.z, 1.0f};
+
+            return vec3{result.x, result.y, result.z};
+        }
+
+        /**
+         * \brief Transform a direction, w = 0, so the translation of the matrix is ignored.
+         */
+        inline vec3 transformDirection(const mat4 &matrix, const vec3 &direction)
+        {
+            vec4 result = matrix * vec4{direction.x, direction.y, direction.z, 0.0f};
+
+            return vec3{result.x, result.y, result.z};
+        }
+
+        /**
+         * \brief Create a translation matrix.
+         */
+        inline mat4 translation(const vec3 &offset)
+        {
+            mat4 result = mat4::identity();
+
+            result.columns[3] = vec4{offset.x, offset.y, offset.z, 1.0f};
+
+            return result;
+        }
+    }
+}
+#endif /* VECTORMATH_H */
@@ -0,0 +1,137 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VERTEXLAYOUT_H
+#define VERTEXLAYOUT_H
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2.h>
+#elif GLES_VERSION == 3
+#include <GLES3/gl3.h>
+#else
+#error "GLES_VERSION must be defined as either 2 or 3"
+#endif
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Describes interleaved vertices with quantized attributes, packs float data into them and sets up glVertexAttribPointer.
+     *
+     * Every attribute starts on a 4 byte boundary, as vertex fetch requires on most GPUs. A 3 component position should
+     * therefore use HalfFloat with 4 components: it takes 8 bytes instead of 12. Integer formats are normalized, so
+     * shaders read them as floats in [-1, 1] or [0, 1].
+     *
+     * With OpenGL ES 2.0, HalfFloat needs OES_vertex_half_float and Int2101010Rev is not available.
+     *
+     * \code
+     * VertexLayout layout;
+     * int position = layout.add(4, VertexLayout::HalfFloat);
+     * int normal = layout.add(4, VertexLayout::Int2101010Rev);
+     * std::vector<unsigned char> vertices(layout.getStride() * numberOfVertices);
+     * layout.pack(position, positions, 3, numberOfVertices, &vertices[0]);
+     * layout.pack(normal, normals, 3, numberOfVertices, &vertices[0]);
+     * ...
+     * layout.enable(position, positionLocation);
+     * layout.enable(normal, normalLocation);
+     * \endcode
+     */
+    class VertexLayout
+    {
+    public:
+        /**
+         * \brief Storage of one component. Integer formats other than Float and HalfFloat are normalized.
+         */
+        enum Format
+        {
+            Float,
+            HalfFloat,
+            Short,
+            UnsignedShort,
+            Byte,
+            UnsignedByte,
+            /* Signed 10 bits for x, y and z and 2 bits for w, packed in one 32-bit word. Needs 4 components. */
+            Int2101010Rev
+        };
+
+    private:
+        struct Attribute
+        {
+            GLint components;
+            Format format;
+            GLsizei offset;
+        };
+
+        std::vector<Attribute> attributes;
+        GLsizei stride;
+
+        static GLenum getType(Format format);
+        static GLsizei getSize(GLint components, Format format);
+
+    public:
+        VertexLayout(void);
+
+        /**
+         * \brief Append an attribute to the vertex.
+         * \param[in] components Number of components, 1 to 4. Must be 4 for Int2101010Rev.
+         * \param[in] format Storage of the components.
+         * \return Index of the attribute, to pass to pack() and enable().
+         */
+        int add(GLint components, Format format);
+
+        /**
+         * \brief Size of a vertex in bytes.
+         */
+        GLsizei getStride(void) const;
+
+        /**
+         * \brief Offset of an attribute from the start of the vertex, in bytes.
+         */
+        GLsizei getOffset(int attribute) const;
+
+        /**
+         * \brief Convert float data to the format of an attribute and write it into interleaved vertices.
+         *
+         * Components the source does not have are written as 0, except a missing w which is 1.
+         *
+         * \param[in] attribute Index returned by add().
+         * \param[in] values numberOfVertices times valueComponents floats.
+         * \param[in] valueComponents Number of floats per vertex in values.
+         * \param[in] numberOfVertices Number of vertices to write.
+         * \param[out] vertices The interleaved vertices, at least getStride() * numberOfVertices bytes.
+         */
+        void pack(int attribute, const float *values, int valueComponents, int numberOfVertices, void *vertices) const;
+
+        /**
+         * \brief Enable a vertex attribute array and point it at an attribute of the bound GL_ARRAY_BUFFER.
+         * \param[in] attribute Index returned by add().
+         * \param[in] location Location of the attribute in the program.
+         * \param[in] firstVertex Offset of the first vertex in the buffer, in vertices.
+         */
+        void enable(int attribute, GLuint location, GLsizei firstVertex = 0) const;
+
+        /**
+         * \brief Disable the vertex attribute array of a location.
+         */
+        void disable(GLuint location) const;
+    };
+}
+#endif /* VERTEXLAYOUT_H */
@@ -0,0 +1,83 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VERTEXPACKING_H
+#define VERTEXPACKING_H
+
+#include "MeshOptimizer.h"
+
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Compresses the vertices of an IndexedModel to 12 to 20 bytes instead of 32 to 52.
+     *
+     * A packed vertex holds:
+     * - the position as four half floats, w being 1 (GL_HALF_FLOAT, or GL_HALF_FLOAT_OES with OES_vertex_half_float),
+     * - the normal octahedrally encoded in two normalized GL_BYTE, followed by two bytes of padding,
+     * - the texture coordinates as two half floats, if the model has them,
+     * - instead of the normal, the tangent frame as a quaternion of four normalized GL_SHORT if the model has tangents,
+     *   see TangentFrames.
+     *
+     * The vertex shader decodes the normal with:
+     * \code
+     * vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+     * if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+     * n = normalize(n);
+     * \endcode
+     */
+    class VertexPacking
+    {
+    public:
+        /**
+         * \brief Byte offsets of the attributes in a packed vertex, -1 when absent.
+         */
+        struct Layout
+        {
+            int stride;
+            int positionOffset;
+            int normalOffset;
+            int uvOffset;
+            int tangentFrameOffset;
+        };
+
+        /**
+         * \brief Convert to IEEE half precision, rounding to nearest. Out of range values become infinity.
+         */
+        static unsigned short floatToHalf(float value);
+
+        /**
+         * \brief Encode a unit vector in two signed bytes.
+         * \param[in] normal The x, y and z of the vector.
+         * \param[out] encoded Receives the two bytes.
+         */
+        static void encodeOctahedral(const float *normal, signed char *encoded);
+
+        /**
+         * \brief Pack all vertices of a model.
+         * \param[in] model The model, with positionOffset set.
+         * \param[out] packed Receives the packed vertices, in the same order.
+         * \return Where the attributes are in a packed vertex.
+         */
+        static Layout pack(const IndexedModel &model, std::vector<unsigned char> *packed);
+    };
+}
+#endif /* VERTEXPACKING_H */
@@ -0,0 +1,270 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VIRTUALTEXTURE_H
+#define VIRTUALTEXTURE_H
+
+#include "AssetFile.h"
+#include "JobScheduler.h"
+#include "VirtualTextureFormat.h"
+
+#include <GLES3/gl3.h>
+
+#include <atomic>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Streams the pages of a virtual texture, see VirtualTextureFormat.h, into a physical texture of fixed size.
+     *
+     * Only the pages the camera can see are kept in GPU memory, so the texture can be far larger than the budget:
+     * - a feedback pass draws the scene at a fraction of the resolution, writing the page and level each pixel samples,
+     * - the feedback is read back through pixel pack buffers guarded by fences, and only looked at frames later,
+     *   once the GPU is done with it, so reading it back never stalls,
+     * - pages which are missing are copied out of the file by a job, and uploaded to a free or least recently used
+     *   slot of the physical texture by a later update(),
+     * - an indirection texture, with one texel per page and a mip level per level, tells the shaders where each page
+     *   is. A page which is not resident points to its nearest resident ancestor, the single page of the coarsest
+     *   level never leaving the physical texture, so there is always something to draw while pages stream in.
+     *
+     * Shaders sample the texture through three uniforms set by setUniforms():
+     * \code
+     * uniform highp sampler2D u_vtIndirection;  // texture unit 1, RGBA8 texels: slot x, slot y, level, 255
+     * uniform highp sampler2D u_vtPhysical;     // texture unit 0
+     * uniform highp vec4 u_vtParameters;        // pages per side of level 0, page size, border, physical size in texels
+     * uniform highp float u_vtLodBias;          // 0, or -log2 of the feedback divisor in the feedback pass
+     * \endcode
+     * Page coordinates are stored in 8 bits, so level 0 has at most VIRTUAL_TEXTURE_MAX_PAGES pages per side.
+     *
+     * Typical usage:
+     * \code
+     * virtualTexture.initialize(path, 16, 8, &scheduler);
+     *
+     * // Once per frame:
+     * virtualTexture.update();
+     * virtualTexture.bindFeedbackFramebuffer(windowWidth, windowHeight);
+     * virtualTexture.setUniforms(feedbackProgram, true);
+     * // Draw the scene with the feedback program.
+     * virtualTexture.readFeedback();
+     *
+     * GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+     * virtualTexture.bind();
+     * virtualTexture.setUniforms(program, false);
+     * // Draw the scene.
+     * \endcode
+     *
+     * Only available in OpenGL ES 3.0 builds.
+     */
+    class VirtualTexture
+    {
+    private:
+        /**
+         * \brief A slot of the physical texture.
+         */
+        struct Slot
+        {
+            /* Index of the page it holds in the file, -1 if it is free. */
+            int page;
+            /* Frame the page was last seen in the feedback. */
+            unsigned int lastUsed;
+        };
+
+        /**
+         * \brief A pixel pack buffer the feedback is read into.
+         */
+        struct Readback
+        {
+            GLuint buffer;
+            GLsync fence;
+        };
+
+        AssetFile file;
+        VirtualTextureHeader header;
+        int pagesPerSide;
+
+        /* First page of each level in the file. */
+        std::vector<int> levelFirstPage;
+        /* Per page of the file: its slot, or -1 if it is not resident. */
+        std::vector<int> pageSlots;
+        /* Per page of the file: the last frame it was requested in, so each one is only considered once per frame. */
+        std::vector<unsigned int> pageRequested;
+        /* Per page of the file: true while a job is loading it. */
+        std::vector<bool> pageLoading;
+
+        int physicalPagesPerSide;
+        std::vector<Slot> slots;
+        GLuint physicalTexture;
+
+        /* One RGBA8 word per page, level by level, as uploaded to the indirection texture. */
+        std::vector<unsigned int> indirection;
+        GLuint indirectionTexture;
+        int dirtyLevels;
+
+        int feedbackDivisor;
+        int feedbackWidth;
+        int feedbackHeight;
+        GLuint feedbackFramebuffer;
+        GLuint feedbackColour;
+        GLuint feedbackDepth;
+        std::vector<Readback> readbacks;
+        unsigned int readbackWritten;
+        unsigned int readbackProcessed;
+
+        /* Pages missing from the latest feedback, coarsest first. */
+        std::vector<int> requestedPages;
+
+        JobScheduler *scheduler;
+        JobScheduler::Job *loadJob;
+        std::atomic<bool> loadFinished;
+        /* The batch of pages the job copies, shared with it until it has finished. */
+        std::vector<int> loadPages;
+        std::vector<unsigned char> loadData;
+
+        unsigned int frame;
+        /* Frame the latest feedback was processed in. Pages it did not touch can be evicted. */
+        unsigned int lastFeedbackFrame;
+        int maximumLoadsPerFrame;
+        unsigned int pagesLoaded;
+
+        /* Copying would leave two owners of the textures and of the job. */
+        VirtualTexture(const VirtualTexture &);
+        VirtualTexture &operator=(const VirtualTexture &);
+
+        /**
+         * \brief Copy the pages of the batch out of the file. Run by the load job.
+         * \param[in] virtualTexture The VirtualTexture.
+         */
+        static void loadPagesJob(void *virtualTexture);
+
+        /**
+         * \brief Get the level of a page of the file.
+         * \param[in] page Index of the page.
+         * \return The level, 0 being the most detailed.
+         */
+        int getLevel(int page) const;
+
+        /**
+         * \brief Map the oldest feedback the GPU is done with, and queue the missing pages it asks for.
+         */
+        void processFeedback(void);
+
+        /**
+         * \brief Upload the pages copied by the last job, and start a job for the next batch of requested pages.
+         */
+        void streamPages(void);
+
+        /**
+         * \brief Upload a page to the physical texture, evicting the least recently used page if needed.
+         * \param[in] page Index of the page.
+         * \param[in] data Its pageBytes bytes.
+         * \return False if every slot holds a page which was used this frame.
+         */
+        bool uploadPage(int page, const unsigned char *data);
+
+        /**
+         * \brief Point every page to itself or its nearest resident ancestor, and upload the levels which changed.
+         */
+        void updateIndirection(void);
+    public:
+        /**
+         * \brief Create an empty instance. No file is opened and no OpenGL ES objects are created until initialize().
+         */
+        VirtualTexture(void);
+
+        /**
+         * \brief Calls terminate().
+         */
+        ~VirtualTexture(void);
+
+        /**
+         * \brief Open a virtual texture and create the physical, indirection and feedback textures.
+         *
+         * Must be called with a current context. The coarsest level is loaded before returning.
+         * \param[in] filename Path of the file.
+         * \param[in] physicalPagesPerSide The physical texture holds this many pages per side, which sets the memory budget.
+         * \param[in] feedbackDivisor The feedback pass is this many times smaller than the window on each side.
+         * \param[in] scheduler Loads pages on its workers. If NULL, pages are loaded by update() itself.
+         * \return False if the file is missing or invalid, or its format is not supported.
+         */
+        bool initialize(const char *filename, int physicalPagesPerSide, int feedbackDivisor, JobScheduler *scheduler);
+
+        /**
+         * \brief Wait for the load job, and delete the textures, buffers and framebuffer.
+         */
+        void terminate(void);
+
+        /**
+         * \brief Check whether initialize() succeeded.
+         * \return True if the texture can be drawn.
+         */
+        bool isInitialized(void) const;
+
+        /**
+         * \brief Read the completed feedback, upload the pages loaded since the last call and queue the next ones.
+         *
+         * Call once per frame, before the feedback pass.
+         */
+        void update(void);
+
+        /**
+         * \brief Bind and clear the feedback framebuffer, and set the viewport to it.
+         * \param[in] windowWidth Width of the window the scene is drawn to.
+         * \param[in] windowHeight Height of the window.
+         */
+        void bindFeedbackFramebuffer(int windowWidth, int windowHeight);
+
+        /**
+         * \brief Start reading the feedback back, once the scene has been drawn into the feedback framebuffer.
+         */
+        void readFeedback(void);
+
+        /**
+         * \brief Bind the physical texture to texture unit 0 and the indirection texture to texture unit 1.
+         */
+        void bind(void) const;
+
+        /**
+         * \brief Set the uniforms of a program sampling the texture. The program must be in use.
+         * \param[in] program The program.
+         * \param[in] feedback True for the program of the feedback pass.
+         */
+        void setUniforms(GLuint program, bool feedback) const;
+
+        /**
+         * \brief Get the width and height of level 0.
+         * \return The size in texels.
+         */
+        int getSize(void) const;
+
+        /**
+         * \brief Count the pages in the physical texture.
+         * \return The number of slots in use.
+         */
+        int getNumberOfResidentPages(void) const;
+
+        /**
+         * \brief Count the pages uploaded since initialize().
+         * \return The number of pages.
+         */
+        unsigned int getNumberOfPagesLoaded(void) const;
+    };
+}
+#endif /* VIRTUALTEXTURE_H */
@@ -0,0 +1,66 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VIRTUALTEXTUREFORMAT_H
+#define VIRTUALTEXTUREFORMAT_H
+
+#include <stdint.h>
+
+namespace MaliSDK
+{
+    /*
+     * The file layout of a virtual texture, written by VirtualTextureWriter and streamed by VirtualTexture.
+     *
+     * A virtual texture is square, pageSize * 2 ^ (numberOfLevels - 1) texels wide, with a full mip chain down to a
+     * single page. Each level is cut into pages of pageSize by pageSize texels, so level l has
+     * 2 ^ (numberOfLevels - 1 - l) pages per side. A page is stored with border texels of its neighbours on every
+     * side, so it can be filtered bilinearly on its own wherever it lands in the physical texture.
+     *
+     * A file is a VirtualTextureHeader followed, from dataOffset, by every page, pageBytes each: all pages of level 0
+     * row by row, then level 1 and so on. A page is (pageSize + 2 * border) texels square, as ETC2 blocks row by row
+     * for GL_COMPRESSED_RGB8_ETC2 or tightly packed 8-bit RGB for GL_RGB8. As every page has the same size, there
+     * is no page table: page n starts at dataOffset + n * pageBytes.
+     *
+     * Everything is little endian, as on every Android ABI. Files of another version are rejected, not converted.
+     */
+
+    /** "VTEX" read as a little endian word. */
+    const uint32_t VIRTUAL_TEXTURE_MAGIC = 0x58455456;
+    const uint32_t VIRTUAL_TEXTURE_VERSION = 1;
+
+    /** \brief Largest number of pages per side of level 0, so page coordinates fit the 8 bits of the feedback. */
+    const uint32_t VIRTUAL_TEXTURE_MAX_PAGES = 256;
+
+    struct VirtualTextureHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        /* GL_COMPRESSED_RGB8_ETC2 or GL_RGB8. */
+        uint32_t internalFormat;
+        /* Width and height of level 0 in texels. */
+        uint32_t size;
+        uint32_t pageSize;
+        uint32_t border;
+        uint32_t numberOfLevels;
+        uint32_t pageBytes;
+        uint32_t dataOffset;
+    };
+}
+#endif /* VIRTUALTEXTUREFORMAT_H */
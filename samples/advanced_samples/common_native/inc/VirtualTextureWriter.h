@@ -0,0 +1,70 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VIRTUALTEXTUREWRITER_H
+#define VIRTUALTEXTUREWRITER_H
+
+#include "VirtualTextureFormat.h"
+
+#include <GLES3/gl3.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Cuts an image into the pages of a virtual texture and writes them to a file, see VirtualTextureFormat.h.
+     *
+     * The image is never held whole: the source is asked for the texels of one page at a time, at the level of that
+     * page, so it can be far larger than memory. Every level comes from the source, which makes it responsible for
+     * filtering the coarser ones, e.g. by sampling a mip chain of its own or evaluating a procedural pattern.
+     *
+     * Needs no context, so it can run offline or on a job. The file is written under a temporary name and renamed
+     * once complete, so a write which is interrupted never leaves a truncated file behind.
+     */
+    class VirtualTextureWriter
+    {
+    public:
+        /**
+         * \brief Provides the texels of a region of one level of the image.
+         * \param[in] level The mip level, 0 being the most detailed.
+         * \param[in] x Left side of the region, in texels of the level.
+         * \param[in] y Top side of the region, in texels of the level.
+         * \param[in] width Width of the region, which is always inside the level.
+         * \param[in] height Height of the region.
+         * \param[out] rgb Used to store the region as tightly packed 8-bit RGB rows.
+         * \param[in] userData The pointer passed to write().
+         */
+        typedef void (*RegionSource)(int level, int x, int y, int width, int height, unsigned char *rgb, void *userData);
+
+        /**
+         * \brief Write a virtual texture.
+         * \param[in] filename Path of the file to write.
+         * \param[in] pageSize Width and height of a page, without its border. A multiple of 4 when compressing.
+         * \param[in] border Texels of the neighbouring pages stored around each page. A multiple of 4 when compressing.
+         * \param[in] numberOfLevels Number of mip levels, the last one being a single page.
+         * \param[in] compress True to store the pages as GL_COMPRESSED_RGB8_ETC2, false for GL_RGB8.
+         * \param[in] source Provides the texels.
+         * \param[in] userData Passed to source.
+         * \return False if the parameters are invalid or the file cannot be written.
+         */
+        static bool write(const char *filename, int pageSize, int border, int numberOfLevels, bool compress,
+                          RegionSource source, void *userData);
+    };
+}
+#endif /* VIRTUALTEXTUREWRITER_H */
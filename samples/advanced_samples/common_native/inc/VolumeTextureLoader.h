@@ -0,0 +1,243 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLUMETEXTURELOADER_H
+#define VOLUMETEXTURELOADER_H
+
+#include <GLES3/gl3.h>
+#include <pthread.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Streams the slices of a volume from files into a 3D or array texture without blocking the rendering thread.
+     *
+     * Every file holds the texel data of one or more consecutive layers, with no header. A ring of pixel unpack buffers
+     * is mapped by update(), filled straight from the files by a worker thread, and unmapped and copied to the texture
+     * by a later update(), once per frame. A fence guards every buffer, so one is only mapped again once the copy
+     * out of it is done. No slice is ever copied through an intermediate allocation, and at most the ring is in memory.
+     * The exception is a FileCallback: the mapped buffers are write only, so the worker then reads a file into its own
+     * scratch copy, hands it to the callback, and copies it into the buffer.
+     *
+     * Uncompressed formats are uploaded with glTexSubImage3D(). When VolumeLayout::format is GL_NONE, the files hold
+     * compressed blocks for VolumeLayout::internalFormat, uploaded with glCompressedTexSubImage3D(): slices of a
+     * GL_TEXTURE_2D_ARRAY for ETC2, or groups of layersPerFile slices of a GL_TEXTURE_3D for a 3D ASTC format.
+     *
+     * The files are read in order, so the layers fill in from the first one, which lets the application render
+     * the part of the volume loaded so far, see getLoadedLayers().
+     *
+     * Typical usage:
+     * \code
+     * loader.start(texture, layout, firstLayer, filePaths);
+     *
+     * // In the render loop:
+     * loader.update();
+     * GL_CHECK(glUniform1i(loadedLayersLocation, loader.getLoadedLayers()));
+     * \endcode
+     *
+     * Only available in OpenGL ES 3.0 builds.
+     */
+    class VolumeTextureLoader
+    {
+    public:
+        /**
+         * \brief Description of the texture and of the data in each file.
+         */
+        struct VolumeLayout
+        {
+            /** GL_TEXTURE_3D or GL_TEXTURE_2D_ARRAY. */
+            GLenum target;
+            /** Internal format of the texture, used as the format of compressed uploads. */
+            GLenum internalFormat;
+            /** Format of uncompressed data, or GL_NONE if the files hold compressed blocks. */
+            GLenum format;
+            /** Type of uncompressed data. Ignored for compressed data. */
+            GLenum type;
+            /** Width of a layer in texels. */
+            int width;
+            /** Height of a layer in texels. */
+            int height;
+            /** Number of layers in a file: 1, or the block depth of a 3D compressed format. */
+            int layersPerFile;
+            /** Size of a file in bytes. */
+            size_t bytesPerFile;
+        };
+
+        /**
+         * \brief Function called on the worker thread with the data of every file that was read.
+         *
+         * Writes made by the callback are visible to the rendering thread once update() has uploaded the file,
+         * i.e. for the layers counted by getLoadedLayers().
+         * \param[in] fileIndex Index of the file in the paths given to start().
+         * \param[in] data The bytesPerFile bytes of the file.
+         * \param[in] userData The pointer given to setFileCallback().
+         */
+        typedef void (*FileCallback)(int fileIndex, const void *data, void *userData);
+
+    private:
+        enum SlotState
+        {
+            /* The buffer is unmapped, its previous copy may still be running on the GPU. */
+            SLOT_IDLE,
+            /* The buffer is mapped and waits for the worker. */
+            SLOT_MAPPED,
+            /* The worker is reading a file into the buffer. */
+            SLOT_FILLING,
+            /* The buffer holds the data of fileIndex and can be copied to the texture. */
+            SLOT_FILLED
+        };
+
+        struct Slot
+        {
+            GLuint buffer;
+            GLsync fence;
+            void *mappedData;
+            SlotState state;
+            int fileIndex;
+            bool readFailed;
+        };
+
+        VolumeLayout layout;
+        GLuint texture;
+        int firstLayer;
+        std::vector<std::string> filePaths;
+        std::vector<Slot> slots;
+        std::vector<bool> uploadedFiles;
+        int loadedFiles;
+        int uploadedFileCount;
+        bool complete;
+        FileCallback fileCallback;
+        void *fileCallbackData;
+
+        /* Worker thread state, the slot states, mappedData and readFailed are shared with the worker. */
+        bool workerStarted;
+        bool cancelled;
+        int nextFileIndex;
+        pthread_t workerThread;
+        pthread_mutex_t mutex;
+        pthread_cond_t slotMapped;
+
+        /* Copying would leave two owners of the worker thread. */
+        VolumeTextureLoader(const VolumeTextureLoader &);
+        VolumeTextureLoader &operator=(const VolumeTextureLoader &);
+
+        /**
+         * \brief Working function of the worker thread.
+         * \param[in] loader The VolumeTextureLoader that started the thread.
+         * \return Always NULL.
+         */
+        static void *workerFunction(void *loader);
+
+        /**
+         * \brief Read a file into a mapped buffer.
+         * \param[in] filePath Path of the file.
+         * \param[out] destination Mapped buffer of bytesPerFile bytes.
+         * \return False if the file cannot be opened or is shorter than bytesPerFile.
+         */
+        bool readFile(const std::string &filePath, void *destination) const;
+
+        /**
+         * \brief Read a file into a mapped buffer, passing it through the FileCallback if there is one.
+         * \param[in] fileIndex Index of the file.
+         * \param[out] destination Mapped buffer of bytesPerFile bytes.
+         * \param[in,out] scratch Copy of the file handed to the callback, kept by the caller between files.
+         * \return False if the file cannot be read.
+         */
+        bool fillBuffer(int fileIndex, void *destination, std::vector<unsigned char> &scratch) const;
+
+        /**
+         * \brief Copy a filled buffer to the texture.
+         * \param[in] slot The slot to upload, with its buffer bound to GL_PIXEL_UNPACK_BUFFER and unmapped.
+         */
+        void uploadSlot(const Slot &slot);
+
+        /**
+         * \brief Stop the worker thread, unmap and delete the buffers.
+         */
+        void release(void);
+    public:
+        /**
+         * \brief Create an idle loader.
+         */
+        VolumeTextureLoader(void);
+
+        /**
+         * \brief Stop the worker thread and delete the buffers and fences. The texture is left to its owner.
+         *
+         * Must be called with the context that called start() current.
+         */
+        ~VolumeTextureLoader(void);
+
+        /**
+         * \brief Set a function to be called with the data of every file, e.g. to build statistics of the volume.
+         *
+         * Must be called before start().
+         * \param[in] callback The function, or NULL for none.
+         * \param[in] userData Passed to the function.
+         */
+        void setFileCallback(FileCallback callback, void *userData);
+
+        /**
+         * \brief Start streaming files into layers of a texture.
+         *
+         * Must be called with a current context, which is then used by update().
+         * \param[in] texture Texture with immutable storage large enough for the layers of all the files.
+         * \param[in] layout Format of the texture and of the files.
+         * \param[in] firstLayer Layer the first file is uploaded to.
+         * \param[in] filePaths Paths of the files, in layer order.
+         * \param[in] ringSize Number of pixel unpack buffers the files are read into.
+         * \return False if there is nothing to load.
+         */
+        bool start(GLuint texture, const VolumeLayout &layout, int firstLayer, const std::vector<std::string> &filePaths, int ringSize = 4);
+
+        /**
+         * \brief Stop loading and delete the buffers and fences. The loader can be started again afterwards.
+         *
+         * Must be called with the context that called start() current, e.g. before the texture is deleted.
+         */
+        void stop(void);
+
+        /**
+         * \brief Upload the files read since the last call, and hand free buffers to the worker.
+         *
+         * Changes the GL_PIXEL_UNPACK_BUFFER binding, which is reset to 0, and the binding of layout.target
+         * on the active texture unit.
+         * \return True once all the files are in the texture.
+         */
+        bool update(void);
+
+        /**
+         * \brief Check whether all the files have been uploaded.
+         * \return True if the texture is complete.
+         */
+        bool isComplete(void) const;
+
+        /**
+         * \brief Get the number of layers, from firstLayer on, that are all in the texture.
+         * \return As per description.
+         */
+        int getLoadedLayers(void) const;
+    };
+}
+#endif /* VOLUMETEXTURELOADER_H */
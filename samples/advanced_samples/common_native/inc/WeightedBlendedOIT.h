@@ -0,0 +1,120 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WEIGHTEDBLENDEDOIT_H
+#define WEIGHTEDBLENDEDOIT_H
+
+#include <GLES3/gl3.h>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Weighted blended order-independent transparency, for transparent geometry that cannot be sorted cheaply.
+     *
+     * Transparent fragments are blended into two half float targets, in any order. The first holds the sum of the
+     * premultiplied colours times a weight in RGB, and the product of (1 - alpha), the revealage, in A. The second
+     * holds the sum of alpha times the weight. resolve() divides the two sums and composites the average over the
+     * opaque image. Both targets use the same blend state, RGB added and A multiplied by (1 - source alpha), so
+     * this works without per draw buffer blending.
+     *
+     * The weight should decrease with distance, so near fragments dominate where they overlap. The fragment shader
+     * of the transparent geometry writes:
+     * \code
+     * layout(location = 0) out vec4 accumulation;
+     * layout(location = 1) out vec4 weight;
+     *
+     * // color is premultiplied by alpha, z is the view space distance, e.g. 1.0 / gl_FragCoord.w.
+     * float w = clamp(1.0 / (1e-5 + pow(z / 5.0, 2.0) + pow(z / 200.0, 6.0)), 1e-2, 3e3);
+     * accumulation = vec4(color.rgb * w, color.a);
+     * weight = vec4(color.a * w);
+     * \endcode
+     * Keep the weights small: the sums are half floats, which overflow above 65504.
+     *
+     * Typical usage:
+     * \code
+     * oit.beginOccluders();
+     * // Draw the depth of the opaque geometry.
+     * oit.beginAccumulation();
+     * // Draw the transparent geometry with depth testing.
+     * oit.resolve(0, windowWidth, windowHeight);
+     * \endcode
+     *
+     * Requires GL_EXT_color_buffer_half_float or GL_EXT_color_buffer_float, see isSupported().
+     * Only available in OpenGL ES 3.0 builds.
+     */
+    class WeightedBlendedOIT
+    {
+    private:
+        GLsizei width;
+        GLsizei height;
+
+        GLuint accumulationTexture;
+        GLuint weightTexture;
+        GLuint depthRenderbuffer;
+        GLuint framebuffer;
+        GLuint resolveProgram;
+        GLuint resolveVertexArray;
+
+        /* Copying would leave two owners of the GL objects. */
+        WeightedBlendedOIT(const WeightedBlendedOIT &);
+        WeightedBlendedOIT &operator=(const WeightedBlendedOIT &);
+    public:
+        /**
+         * \brief Check that half float targets can be rendered to and blended. Must be called with a current context.
+         * \return True if the extensions are supported.
+         */
+        static bool isSupported(void);
+
+        /**
+         * \brief Create the targets and the resolve program. Must be called with a current context.
+         * \param[in] width Width of the targets, the same as the framebuffer resolved to.
+         * \param[in] height Height of the targets, the same as the framebuffer resolved to.
+         */
+        WeightedBlendedOIT(GLsizei width, GLsizei height);
+
+        /**
+         * \brief Delete the targets and the resolve program.
+         */
+        ~WeightedBlendedOIT(void);
+
+        /**
+         * \brief Bind the targets and clear them, with colour writes off so opaque geometry can fill the depth buffer.
+         *
+         * The transparent geometry is depth tested against what is drawn until beginAccumulation(). Sets the viewport.
+         */
+        void beginOccluders(void);
+
+        /**
+         * \brief Turn colour writes on, depth writes off and set the accumulation blend state.
+         */
+        void beginAccumulation(void);
+
+        /**
+         * \brief Composite the transparent geometry over a framebuffer.
+         *
+         * Leaves the framebuffer bound, blending on with source alpha over, and depth testing off.
+         * \param[in] targetFramebuffer Framebuffer holding the opaque image, 0 for the window.
+         * \param[in] targetWidth Width of the viewport of the framebuffer.
+         * \param[in] targetHeight Height of the viewport of the framebuffer.
+         */
+        void resolve(GLuint targetFramebuffer, GLsizei targetWidth, GLsizei targetHeight);
+    };
+}
+#endif /* WEIGHTEDBLENDEDOIT_H */
@@ -22,6 +22,8 @@
 #define CUBE_MODEL_H
 
 #include "VectorTypes.h"
+#include "MeshOptimizer.h"
+#include "Allocator.h"
 
 namespace MaliSDK
 {
@@ -37,16 +39,26 @@ namespace MaliSDK
          * \param[in] scalingFactor Scaling factor indicating size of a cube.
          * \param[out] numberOfCoordinates  Number of generated coordinates.
          * \param[out] coordinates Deref will be used to store generated coordinates. Cannot be null.
+         * \param[in] allocator Allocates the result, malloc() if NULL. Then the caller frees it with free().
          */
-        static void getTriangleRepresentation(float scalingFactor, int* numberOfCoordinates, float** coordinates);
+        static void getTriangleRepresentation(float scalingFactor, int* numberOfCoordinates, float** coordinates, Allocator* allocator = NULL);
 
         /** 
          * \brief Create normals for a cube which was created with getTriangleRepresentation() function.
          *
          * \param[out] numberOfCoordinates Number of generated coordinates.
          * \param[out] normals Deref will be used to store generated coordinates. Cannot be null.
+         * \param[in] allocator Allocates the result, malloc() if NULL. Then the caller frees it with free().
          */
-        static void getNormals(int* numberOfCoordinates, float** normals);
+        static void getNormals(int* numberOfCoordinates, float** normals, Allocator* allocator = NULL);
+
+        /**
+         * \brief Create an indexed cube without duplicated vertices, ordered for the vertex cache and overdraw by MeshOptimizer.
+         *
+         * \param[in] scalingFactor Scaling factor indicating size of a cube.
+         * \param[out] model Receives 6 floats per vertex, the position followed by the normal. Cannot be null.
+         */
+        static void getIndexedRepresentation(float scalingFactor, IndexedModel* model);
     };
 }
 #endif /* CUBE_MODEL_H */
\ No newline at end of file
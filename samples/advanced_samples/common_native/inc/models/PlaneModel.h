@@ -22,6 +22,8 @@
 #define PLANE_MODEL_H
 
 #include "VectorTypes.h"
+#include "MeshOptimizer.h"
+#include "Allocator.h"
 #include "Matrix.h"
 
 namespace MaliSDK
@@ -39,24 +41,34 @@ namespace MaliSDK
          *
          * \param[out] numberOfCoordinates Number of generated coordinates.
          * \param[out] coordinates Deref will be used to store generated coordinates. Cannot be null.
+         * \param[in] allocator Allocates the result, malloc() if NULL. Then the caller frees it with free().
          */
-        static void getTriangleRepresentation(int* numberOfCoordinates, float** coordinates);
+        static void getTriangleRepresentation(int* numberOfCoordinates, float** coordinates, Allocator* allocator = NULL);
 
         /**
          * \brief Get U/V 2D texture coordinates that can be mapped onto a plane generated from this class.
          *
          * \param[out] numberOfCoordinates Number of generated coordinates.
          * \param[out] uvCoordinates Deref will be used to store generated coordinates. Cannot be null.
+         * \param[in] allocator Allocates the result, malloc() if NULL. Then the caller frees it with free().
          */
-        static void getTriangleRepresentationUVCoordinates(int* numberOfCoordinates, float** uvCoordinates);
+        static void getTriangleRepresentationUVCoordinates(int* numberOfCoordinates, float** uvCoordinates, Allocator* allocator = NULL);
 
         /** 
          * \brief Get normals for plane placed in XZ space.
          *
          * \param[out] numberOfCoordinates Number of generated coordinates.
          * \param[out] normals Deref will be used to store generated normals. Cannot be null.
+         * \param[in] allocator Allocates the result, malloc() if NULL. Then the caller frees it with free().
          */
-        static void getNormals(int* numberOfCoordinates, float** normals);
+        static void getNormals(int* numberOfCoordinates, float** normals, Allocator* allocator = NULL);
+
+        /**
+         * \brief Create an indexed plane without duplicated vertices, ordered for the vertex cache and overdraw by MeshOptimizer.
+         *
+         * \param[out] model Receives 9 floats per vertex, the 4 component position, the normal and the U/V coordinates. Cannot be null.
+         */
+        static void getIndexedRepresentation(IndexedModel* model);
 
         /**
          * \brief Transform a plane by a matrix.
@@ -22,6 +22,8 @@
 #define SPHERE_MODEL_H
 
 #include "VectorTypes.h"
+#include "MeshOptimizer.h"
+#include "Allocator.h"
 
 namespace MaliSDK
 {
@@ -38,8 +40,9 @@ namespace MaliSDK
          * \param[in] numberOfSamples Sphere consists of numberOfSamples circles and numberOfSamples points lying on one circle. Has to be greater than zero.
          * \param[out] numberOfCoordinates Number of generated coordinates.
          * \param[out] coordinates Deref will be used to store generated coordinates. Cannot be null.
+         * \param[in] allocator Allocates the result, malloc() if NULL. Then the caller frees it with free().
          */
-        static void getPointRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, float** coordinates);
+        static void getPointRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, float** coordinates, Allocator* allocator = NULL);
     public:
         /** 
          * \brief Create triangular representation of a sphere. 
@@ -67,8 +70,18 @@ namespace MaliSDK
          * \param[in] numberOfSamples A sphere consists of numberOfSamples circles and numberOfSamples points lying on one circle. Has to be greater than zero.
          * \param[out] numberOfCoordinates Number of generated coordinates. 
          * \param[out] coordinates Deref will be used to store generated coordinates. Cannot be null.
+         * \param[in] allocator Allocates the result, malloc() if NULL. Then the caller frees it with free().
          */
-        static void getTriangleRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, float** coordinates);
+        static void getTriangleRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, float** coordinates, Allocator* allocator = NULL);
+
+        /**
+         * \brief Create an indexed sphere without duplicated vertices, ordered for the vertex cache and overdraw by MeshOptimizer.
+         *
+         * \param[in] radius Radius of a sphere. Has to be greater than zero.
+         * \param[in] numberOfSamples A sphere consists of numberOfSamples circles and numberOfSamples points lying on one circle. Has to be greater than zero.
+         * \param[out] model Receives 6 floats per vertex, the position followed by the normal. Cannot be null.
+         */
+        static void getIndexedRepresentation(const float radius, const int numberOfSamples, IndexedModel* model);
     };
 }
 #endif /* SPHERE_MODEL_H */
\ No newline at end of file
@@ -22,6 +22,7 @@
 #define SUPER_ELLIPSOID_MODEL_H
 
 #include "VectorTypes.h"
+#include "MeshOptimizer.h"
 
 namespace MaliSDK
 {
@@ -100,6 +101,17 @@ namespace MaliSDK
          * \param[out] numberOfNormals Number of generated normal vectors.
          */
         static void create(int samples, float n1, float n2, float scale, float** roundedCubeCoordinates, float** roundedCubeNormalVectors, int* numberOfVertices, int* numberOfCoordinates, int* numberOfNormals);
+
+        /**
+         * \brief Create an indexed super ellipsoid without duplicated vertices, ordered for the vertex cache and overdraw by MeshOptimizer.
+         *
+         * \param[in] samples The number of triangles that will create super ellipsoid.
+         * \param[in] n1 The "squareness" of our figure - property that tells how rounded the geometry will be in XZ space.
+         * \param[in] n2 The "squareness" of our figure - property that tells how rounded the geometry will be in XY space.
+         * \param[in] scale Scale factor applied to the object.
+         * \param[out] model Receives 7 floats per vertex, the 4 component position followed by the normal. Cannot be null.
+         */
+        static void createIndexed(int samples, float n1, float n2, float scale, IndexedModel* model);
     };
 }
 #endif /* SUPER_ELLIPSOID_MODEL_H */
\ No newline at end of file
@@ -25,8 +25,11 @@
 #include <GLES2/gl2.h>
 
 #include "AndroidPlatform.h"
+#include "AssetFile.h"
 #include "JavaClass.h"
 
+#include <android/asset_manager_jni.h>
+
 #include <unistd.h>
 
 using std::string;
@@ -102,7 +105,7 @@ namespace MaliSDK
 
     bool AndroidPlatform::getAndroidAsset(JNIEnv* JNIEnvironment, const char destinationDirectory[], const char filename[])
     {   
-        if (JNIEnvironment == NULL || destinationDirectory == NULL || filename == NULL)
+        if (destinationDirectory == NULL || filename == NULL)
         {
             LOGE("getAndroidAsset(): NULL argument is not acceptable.\n");
             return false;
@@ -111,6 +114,12 @@ namespace MaliSDK
         /* Create the full path to where we want the file to be found. */
         string resourceFilePath = string(destinationDirectory) + string(filename);
 
+        /* Files read from the APK do not need to be extracted. */
+        if (AssetFile::isAsset(resourceFilePath.c_str()))
+        {
+            return true;
+        }
+
         /* Try and find the file in the file system. */
         FILE * file = NULL;
         file = fopen(resourceFilePath.c_str(), "r");
@@ -126,6 +135,13 @@ namespace MaliSDK
         {
             /* The file does not exist and needs to be extracted from the APK package */
             
+            /* Without a JVM, as in the benchmark harness, the files have to be pushed beforehand. */
+            if (JNIEnvironment == NULL)
+            {
+                LOGE("getAndroidAsset(): %s is missing and cannot be extracted without a JNI environment.\n", resourceFilePath.c_str());
+                return false;
+            }
+
             /* Use the MaliSamplesActivity.extractAsset() Java method to extract the file */
             JavaClass javaClass(JNIEnvironment, "com/arm/malideveloper/openglessdk/MaliSamplesActivity");
 
@@ -138,4 +154,60 @@ namespace MaliSDK
         }
         return true;
     }
-}
\ No newline at end of file
+
+    bool AndroidPlatform::useAPKAssets(JNIEnv* JNIEnvironment, jobject assetManager, const char directory[])
+    {
+        /* The native asset manager is only valid while the Java one is, which the global reference makes sure of. */
+        static jobject assetManagerReference = NULL;
+
+        if (JNIEnvironment == NULL || assetManager == NULL || directory == NULL)
+        {
+            return false;
+        }
+
+        jobject reference = JNIEnvironment->NewGlobalRef(assetManager);
+        AAssetManager *manager = AAssetManager_fromJava(JNIEnvironment, reference);
+        if (manager == NULL)
+        {
+            LOGE("useAPKAssets(): AAssetManager_fromJava() failed, assets will be extracted.\n");
+            JNIEnvironment->DeleteGlobalRef(reference);
+            return false;
+        }
+
+        AssetFile::setAssetManager(manager, directory);
+
+        if (assetManagerReference != NULL)
+        {
+            JNIEnvironment->DeleteGlobalRef(assetManagerReference);
+        }
+        assetManagerReference = reference;
+
+        return true;
+    }
+
+    bool AndroidPlatform::useAPKAssets(JNIEnv* JNIEnvironment, const char directory[])
+    {
+        if (JNIEnvironment == NULL)
+        {
+            return false;
+        }
+
+        jclass activityClass = JNIEnvironment->FindClass("com/arm/malideveloper/openglessdk/MaliSamplesActivity");
+        jmethodID getAssetManager = (activityClass != NULL) ?
+            JNIEnvironment->GetStaticMethodID(activityClass, "getAssetManager", "()Landroid/content/res/AssetManager;") : NULL;
+        if (getAssetManager == NULL)
+        {
+            LOGE("useAPKAssets(): MaliSamplesActivity.getAssetManager() not found, assets will be extracted.\n");
+            JNIEnvironment->ExceptionClear();
+            return false;
+        }
+
+        jobject assetManager = JNIEnvironment->CallStaticObjectMethod(activityClass, getAssetManager);
+        bool used = useAPKAssets(JNIEnvironment, assetManager, directory);
+
+        JNIEnvironment->DeleteLocalRef(assetManager);
+        JNIEnvironment->DeleteLocalRef(activityClass);
+
+        return used;
+    }
+}
@@ -0,0 +1,192 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "AssetFile.h"
+#include "Platform.h"
+#include "StartupProfiler.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::string;
+
+namespace MaliSDK
+{
+    AAssetManager *AssetFile::assetManager = NULL;
+    string AssetFile::assetDirectory;
+
+    void AssetFile::setAssetManager(AAssetManager *manager, const char *directory)
+    {
+        assetManager = manager;
+        assetDirectory = (directory != NULL) ? directory : "";
+
+        if (!assetDirectory.empty() && assetDirectory[assetDirectory.length() - 1] != '/')
+        {
+            assetDirectory += '/';
+        }
+    }
+
+    bool AssetFile::isAsset(const char *filename)
+    {
+        if (assetManager == NULL || strncmp(filename, assetDirectory.c_str(), assetDirectory.length()) != 0)
+        {
+            return false;
+        }
+
+        /* Opening an asset does not read it, AASSET_MODE_UNKNOWN leaves the data alone. */
+        AAsset *openedAsset = AAssetManager_open(assetManager, filename + assetDirectory.length(), AASSET_MODE_UNKNOWN);
+        if (openedAsset == NULL)
+        {
+            return false;
+        }
+
+        AAsset_close(openedAsset);
+
+        return true;
+    }
+
+    AssetFile::AssetFile(void)
+        : data(NULL),
+          size(0),
+          asset(NULL),
+          mapping(NULL),
+          mappingSize(0)
+    {
+    }
+
+    AssetFile::~AssetFile(void)
+    {
+        close();
+    }
+
+    bool AssetFile::openAsset(const char *filename)
+    {
+        if (assetManager == NULL || strncmp(filename, assetDirectory.c_str(), assetDirectory.length()) != 0)
+        {
+            return false;
+        }
+
+        /* Assets are named relative to the assets/ directory of the APK, which is what the Java side extracts. */
+        AAsset *openedAsset = AAssetManager_open(assetManager, filename + assetDirectory.length(), AASSET_MODE_BUFFER);
+        if (openedAsset == NULL)
+        {
+            return false;
+        }
+
+        /* Stored assets are mapped from the APK, compressed ones are inflated once by the asset manager. */
+        const void *buffer = AAsset_getBuffer(openedAsset);
+        if (buffer == NULL)
+        {
+            AAsset_close(openedAsset);
+            return false;
+        }
+
+        asset = openedAsset;
+        data = (const unsigned char *)buffer;
+        size = (size_t)AAsset_getLength(openedAsset);
+
+        return true;
+    }
+
+    bool AssetFile::open(const char *filename)
+    {
+        STARTUP_PHASE(PHASE_ASSET_IO);
+        close();
+
+        if (openAsset(filename))
+        {
+            return true;
+        }
+
+        int file = ::open(filename, O_RDONLY);
+        if (file < 0)
+        {
+            return false;
+        }
+
+        struct stat fileStatus;
+        if (fstat(file, &fileStatus) != 0)
+        {
+            ::close(file);
+            return false;
+        }
+
+        size = (size_t)fileStatus.st_size;
+
+        /* mmap() of 0 bytes fails, but an empty file is still a valid file. */
+        if (size == 0)
+        {
+            static const unsigned char empty = 0;
+
+            ::close(file);
+            data = &empty;
+            return true;
+        }
+
+        void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+        /* The mapping keeps its own reference to the file. */
+        ::close(file);
+
+        if (mapped == MAP_FAILED)
+        {
+            size = 0;
+            return false;
+        }
+
+        mapping = mapped;
+        mappingSize = size;
+        data = (const unsigned char *)mapped;
+
+        return true;
+    }
+
+    void AssetFile::close(void)
+    {
+        if (asset != NULL)
+        {
+            AAsset_close(asset);
+            asset = NULL;
+        }
+
+        if (mapping != NULL)
+        {
+            munmap(mapping, mappingSize);
+            mapping = NULL;
+            mappingSize = 0;
+        }
+
+        data = NULL;
+        size = 0;
+    }
+
+    const unsigned char *AssetFile::getData(void) const
+    {
+        return data;
+    }
+
+    size_t AssetFile::getSize(void) const
+    {
+        return size;
+    }
+}
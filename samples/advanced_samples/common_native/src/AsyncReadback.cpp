@@ -0,0 +1,162 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "AsyncReadback.h"
+#include "FenceSync.h"
+#include "Platform.h"
+
+#include <cstring>
+
+namespace MaliSDK
+{
+    AsyncReadback::AsyncReadback(GLsizei width, GLsizei height, unsigned int numberOfBuffers)
+        : width(width),
+          height(height),
+          slots(numberOfBuffers > 0 ? numberOfBuffers : 1),
+          written(0),
+          collected(0),
+          droppedReads(0)
+    {
+        GLint previousBuffer = 0;
+        GL_CHECK(glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &previousBuffer));
+
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            GL_CHECK(glGenBuffers(1, &slots[i].buffer));
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[i].buffer));
+            GL_CHECK(glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ));
+            slots[i].fence = NULL;
+            slots[i].tag = 0;
+        }
+
+        GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)previousBuffer));
+    }
+
+    AsyncReadback::~AsyncReadback(void)
+    {
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            if (slots[i].fence)
+            {
+                GL_CHECK(glDeleteSync(slots[i].fence));
+            }
+            GL_CHECK(glDeleteBuffers(1, &slots[i].buffer));
+        }
+    }
+
+    bool AsyncReadback::read(unsigned int tag, GLuint framebuffer)
+    {
+        /* Every buffer still waits for the GPU, skip this read rather than stall. */
+        if (written - collected == slots.size())
+        {
+            droppedReads++;
+            return false;
+        }
+
+        Slot &slot = slots[written % slots.size()];
+
+        /* The sample may have left its own framebuffer or buffer bound, or changed the alignment. */
+        GLint previousFramebuffer = 0;
+        GLint previousBuffer = 0;
+        GLint previousAlignment = 4;
+        GL_CHECK(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousFramebuffer));
+        GL_CHECK(glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &previousBuffer));
+        GL_CHECK(glGetIntegerv(GL_PACK_ALIGNMENT, &previousAlignment));
+
+        GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer));
+        GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+        GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+        GL_CHECK(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+        slot.fence = GL_CHECK(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        slot.tag = tag;
+        written++;
+
+        GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT, previousAlignment));
+        GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)previousBuffer));
+        GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)previousFramebuffer));
+
+        /* Start the copy now, it has to be done by the time collect() looks at the fence. */
+        GL_CHECK(glFlush());
+
+        return true;
+    }
+
+    bool AsyncReadback::collect(unsigned int *tag, std::vector<unsigned char> &pixels, bool wait)
+    {
+        if (written == collected)
+        {
+            return false;
+        }
+
+        Slot &slot = slots[collected % slots.size()];
+
+        if (!FenceSync::wait(slot.fence, wait, "readback"))
+        {
+            return false;
+        }
+
+        GL_CHECK(glDeleteSync(slot.fence));
+        slot.fence = NULL;
+        collected++;
+
+        GLsizeiptr size = (GLsizeiptr)width * height * 4;
+        GLint previousBuffer = 0;
+        GL_CHECK(glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &previousBuffer));
+        GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+
+        const void *data = GL_CHECK(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+        bool mapped = data != NULL;
+        if (mapped)
+        {
+            pixels.resize(size);
+            memcpy(&pixels[0], data, size);
+            GL_CHECK(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+        }
+        else
+        {
+            LOGE("Cannot map the readback buffer.");
+        }
+
+        GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)previousBuffer));
+
+        *tag = slot.tag;
+        return mapped;
+    }
+
+    unsigned int AsyncReadback::getNumberOfPendingReads(void) const
+    {
+        return written - collected;
+    }
+
+    unsigned int AsyncReadback::getDroppedReads(void) const
+    {
+        return droppedReads;
+    }
+
+    GLsizei AsyncReadback::getWidth(void) const
+    {
+        return width;
+    }
+
+    GLsizei AsyncReadback::getHeight(void) const
+    {
+        return height;
+    }
+}
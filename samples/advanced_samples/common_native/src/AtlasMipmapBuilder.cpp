@@ -0,0 +1,256 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "AtlasMipmapBuilder.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <vector>
+
+using std::max;
+using std::min;
+using std::vector;
+
+namespace MaliSDK
+{
+    /**
+     * \brief The texels of a sub-image in one level, [x0, x1) by [y0, y1). Never less than one texel.
+     */
+    struct LevelRect
+    {
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+    };
+
+    static LevelRect getLevelRect(const AtlasMipmapBuilder::SubImage &subImage, int level)
+    {
+        LevelRect rect;
+
+        rect.x0 = subImage.x >> level;
+        rect.y0 = subImage.y >> level;
+        rect.x1 = max(rect.x0 + 1, (subImage.x + subImage.width) >> level);
+        rect.y1 = max(rect.y0 + 1, (subImage.y + subImage.height) >> level);
+
+        return rect;
+    }
+
+    static int clampInt(int value, int low, int high)
+    {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    /**
+     * \brief Fill a rectangle of a level with the rounded 2 by 2 average of a rectangle of the level above.
+     *
+     * Only texels of the source rectangle are read, the ones past its edges repeat the edge.
+     */
+    static void filterRect(const vector<unsigned char> &source, int sourceWidth, const LevelRect &sourceRect,
+                           vector<unsigned char> *destination, int destinationWidth, const LevelRect &destinationRect, int channels)
+    {
+        for (int y = destinationRect.y0; y < destinationRect.y1; y++)
+        {
+            int y0 = clampInt(2 * y, sourceRect.y0, sourceRect.y1 - 1);
+            int y1 = clampInt(2 * y + 1, sourceRect.y0, sourceRect.y1 - 1);
+
+            for (int x = destinationRect.x0; x < destinationRect.x1; x++)
+            {
+                int x0 = clampInt(2 * x, sourceRect.x0, sourceRect.x1 - 1);
+                int x1 = clampInt(2 * x + 1, sourceRect.x0, sourceRect.x1 - 1);
+
+                for (int channel = 0; channel < channels; channel++)
+                {
+                    int sum = source[(y0 * sourceWidth + x0) * channels + channel] + source[(y0 * sourceWidth + x1) * channels + channel] +
+                              source[(y1 * sourceWidth + x0) * channels + channel] + source[(y1 * sourceWidth + x1) * channels + channel];
+
+                    (*destination)[(y * destinationWidth + x) * channels + channel] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+    }
+
+    /**
+     * \brief Repeat the edge of every sub-image over the texels up to padding away from it which are in no sub-image.
+     *
+     * Where the padding of two sub-images meets, every texel takes the edge of the nearest one.
+     */
+    static void padRects(vector<unsigned char> *texels, int width, int height, int channels, const vector<LevelRect> &rects, int padding)
+    {
+        if (padding == 0)
+        {
+            return;
+        }
+
+        /* Chebyshev distance to the sub-image each texel was last copied from, 0 inside the sub-images. */
+        vector<int> distances(width * height, INT_MAX);
+
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            for (int y = rects[i].y0; y < rects[i].y1; y++)
+            {
+                std::fill(distances.begin() + y * width + rects[i].x0, distances.begin() + y * width + rects[i].x1, 0);
+            }
+        }
+
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            const LevelRect &rect = rects[i];
+
+            for (int y = max(0, rect.y0 - padding); y < min(height, rect.y1 + padding); y++)
+            {
+                int edgeY = clampInt(y, rect.y0, rect.y1 - 1);
+
+                for (int x = max(0, rect.x0 - padding); x < min(width, rect.x1 + padding); x++)
+                {
+                    int edgeX = clampInt(x, rect.x0, rect.x1 - 1);
+                    int distance = max(abs(x - edgeX), abs(y - edgeY));
+
+                    if (distance >= distances[y * width + x])
+                    {
+                        continue;
+                    }
+
+                    distances[y * width + x] = distance;
+                    std::copy(texels->begin() + (edgeY * width + edgeX) * channels,
+                              texels->begin() + (edgeY * width + edgeX + 1) * channels,
+                              texels->begin() + (y * width + x) * channels);
+                }
+            }
+        }
+    }
+
+    int AtlasMipmapBuilder::getNumberOfLevels(int width, int height)
+    {
+        int levels = 1;
+
+        while (width > 1 || height > 1)
+        {
+            width = max(1, width / 2);
+            height = max(1, height / 2);
+            levels++;
+        }
+
+        return levels;
+    }
+
+    int AtlasMipmapBuilder::getNumberOfSafeLevels(int width, int height, const vector<SubImage> &subImages, int blockSize)
+    {
+        int numberOfLevels = getNumberOfLevels(width, height);
+
+        for (int level = 0; level < numberOfLevels; level++)
+        {
+            /* Whole blocks at this level are whole multiples of the block size scaled back to level 0. */
+            int alignment = blockSize << level;
+
+            for (size_t i = 0; i < subImages.size(); i++)
+            {
+                const SubImage &subImage = subImages[i];
+
+                if (subImage.x % alignment != 0 || subImage.y % alignment != 0
+                    || subImage.width % alignment != 0 || subImage.height % alignment != 0)
+                {
+                    return level;
+                }
+            }
+        }
+
+        return numberOfLevels;
+    }
+
+    bool AtlasMipmapBuilder::build(const unsigned char *image, int width, int height, int channels,
+                                   const vector<SubImage> &subImages, int padding, int numberOfLevels,
+                                   vector<vector<unsigned char> > *levels)
+    {
+        if (image == NULL || levels == NULL || width < 1 || height < 1 || channels < 1 || padding < 0
+            || numberOfLevels < 1 || numberOfLevels > getNumberOfLevels(width, height))
+        {
+            LOGE("AtlasMipmapBuilder: invalid parameters\n");
+            return false;
+        }
+
+        for (size_t i = 0; i < subImages.size(); i++)
+        {
+            const SubImage &subImage = subImages[i];
+
+            if (subImage.width < 1 || subImage.height < 1 || subImage.x < 0 || subImage.y < 0
+                || subImage.x + subImage.width > width || subImage.y + subImage.height > height)
+            {
+                LOGE("AtlasMipmapBuilder: sub-image %d is outside the atlas\n", (int)i);
+                return false;
+            }
+
+            for (size_t j = 0; j < i; j++)
+            {
+                const SubImage &other = subImages[j];
+
+                if (subImage.x < other.x + other.width && other.x < subImage.x + subImage.width
+                    && subImage.y < other.y + other.height && other.y < subImage.y + subImage.height)
+                {
+                    LOGE("AtlasMipmapBuilder: sub-images %d and %d overlap\n", (int)j, (int)i);
+                    return false;
+                }
+            }
+        }
+
+        vector<LevelRect> rects(subImages.size());
+
+        levels->assign(numberOfLevels, vector<unsigned char>());
+        (*levels)[0].assign(image, image + width * height * channels);
+
+        for (size_t i = 0; i < subImages.size(); i++)
+        {
+            rects[i] = getLevelRect(subImages[i], 0);
+        }
+
+        padRects(&(*levels)[0], width, height, channels, rects, padding);
+
+        for (int level = 1; level < numberOfLevels; level++)
+        {
+            const vector<unsigned char> &source = (*levels)[level - 1];
+            vector<unsigned char> &destination = (*levels)[level];
+            int sourceWidth = max(1, width >> (level - 1));
+            int sourceHeight = max(1, height >> (level - 1));
+            int destinationWidth = max(1, width >> level);
+            int destinationHeight = max(1, height >> level);
+
+            destination.resize(destinationWidth * destinationHeight * channels);
+
+            /* The texels in no sub-image first, then every sub-image from itself only. */
+            LevelRect sourceLevel = { 0, 0, sourceWidth, sourceHeight };
+            LevelRect destinationLevel = { 0, 0, destinationWidth, destinationHeight };
+
+            filterRect(source, sourceWidth, sourceLevel, &destination, destinationWidth, destinationLevel, channels);
+
+            for (size_t i = 0; i < subImages.size(); i++)
+            {
+                rects[i] = getLevelRect(subImages[i], level);
+                filterRect(source, sourceWidth, getLevelRect(subImages[i], level - 1),
+                           &destination, destinationWidth, rects[i], channels);
+            }
+
+            padRects(&destination, destinationWidth, destinationHeight, channels, rects, padding);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,211 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "BakedMesh.h"
+#include "Platform.h"
+
+#include <cstdlib>
+
+namespace MaliSDK
+{
+    BakedMesh::BakedMesh(void)
+        : header(NULL),
+          vertexBuffer(0),
+          indexBuffer(0)
+    {
+    }
+
+    BakedMesh::~BakedMesh(void)
+    {
+        close();
+    }
+
+    bool BakedMesh::validate(void) const
+    {
+        size_t size = file.getSize();
+        uint32_t numberOfAttributes = 1 + ((header->attributes & BAKED_MESH_NORMALS) ? 1 : 0) + ((header->attributes & BAKED_MESH_UVS) ? 1 : 0);
+
+        /* 64-bit sums, so a corrupt count cannot wrap around the size of the file. */
+        unsigned long long vertexEnd = header->vertexOffset + (unsigned long long)header->numberOfVertices * header->vertexStride;
+        unsigned long long indexEnd = header->indexOffset + (unsigned long long)header->numberOfIndices * sizeof(uint16_t);
+        unsigned long long levelEnd = header->levelOffset + (unsigned long long)header->numberOfLevels * sizeof(BakedMeshLevel);
+        unsigned long long meshletEnd = header->meshletOffset + (unsigned long long)header->numberOfMeshlets * sizeof(BakedMeshlet);
+
+        if (vertexEnd > size || indexEnd > size || levelEnd > size || meshletEnd > size ||
+            header->vertexStride != numberOfAttributes * 4 + 4 || header->numberOfLevels == 0 || header->numberOfVertices > 65536)
+        {
+            return false;
+        }
+
+        const BakedMeshLevel *levels = (const BakedMeshLevel *)(file.getData() + header->levelOffset);
+        for (uint32_t level = 0; level < header->numberOfLevels; level++)
+        {
+            if ((unsigned long long)levels[level].firstIndex + levels[level].numberOfIndices > header->numberOfIndices)
+            {
+                return false;
+            }
+        }
+
+        const BakedMeshlet *meshlets = (const BakedMeshlet *)(file.getData() + header->meshletOffset);
+        for (uint32_t meshlet = 0; meshlet < header->numberOfMeshlets; meshlet++)
+        {
+            if ((unsigned long long)meshlets[meshlet].firstIndex + meshlets[meshlet].numberOfIndices > header->numberOfIndices)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool BakedMesh::load(const char *filename)
+    {
+        close();
+
+        if (!file.open(filename))
+        {
+            LOGE("BakedMesh: cannot open '%s'.\n", filename);
+            return false;
+        }
+
+        header = (const BakedMeshHeader *)file.getData();
+        if (file.getSize() < sizeof(BakedMeshHeader) || header->magic != BAKED_MESH_MAGIC)
+        {
+            LOGE("BakedMesh: '%s' is not a baked mesh.\n", filename);
+            close();
+            return false;
+        }
+        if (header->version != BAKED_MESH_VERSION)
+        {
+            LOGE("BakedMesh: '%s' is version %u, not %u. Bake it again with MeshBaker.\n", filename, header->version, BAKED_MESH_VERSION);
+            close();
+            return false;
+        }
+        if (!validate())
+        {
+            LOGE("BakedMesh: '%s' is truncated or corrupt.\n", filename);
+            close();
+            return false;
+        }
+
+        /* Straight from the mapping, there is no copy on the heap. */
+        GL_CHECK(glGenBuffers(1, &vertexBuffer));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)header->numberOfVertices * header->vertexStride,
+                              file.getData() + header->vertexOffset, GL_STATIC_DRAW));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+        GL_CHECK(glGenBuffers(1, &indexBuffer));
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+        GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)header->numberOfIndices * sizeof(uint16_t),
+                              file.getData() + header->indexOffset, GL_STATIC_DRAW));
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+
+        return true;
+    }
+
+    void BakedMesh::close(void)
+    {
+        if (vertexBuffer != 0)
+        {
+            GL_CHECK(glDeleteBuffers(1, &vertexBuffer));
+            vertexBuffer = 0;
+        }
+        if (indexBuffer != 0)
+        {
+            GL_CHECK(glDeleteBuffers(1, &indexBuffer));
+            indexBuffer = 0;
+        }
+
+        header = NULL;
+        file.close();
+    }
+
+    const BakedMeshHeader *BakedMesh::getHeader(void) const
+    {
+        return header;
+    }
+
+    const BakedMeshLevel &BakedMesh::getLevel(unsigned int level) const
+    {
+        return ((const BakedMeshLevel *)(file.getData() + header->levelOffset))[level];
+    }
+
+    const BakedMeshlet &BakedMesh::getMeshlet(unsigned int meshlet) const
+    {
+        return ((const BakedMeshlet *)(file.getData() + header->meshletOffset))[meshlet];
+    }
+
+    unsigned int BakedMesh::selectLevel(float pixelsPerUnit) const
+    {
+        /* The levels get coarser, stop at the first one which is visibly off. */
+        unsigned int level = 0;
+        while (level + 1 < header->numberOfLevels && getLevel(level + 1).error * pixelsPerUnit < 1.0f)
+        {
+            level++;
+        }
+
+        return level;
+    }
+
+    void BakedMesh::enableAttributes(GLint positionLocation, GLint normalLocation, GLint uvLocation) const
+    {
+        GLsizei stride = (GLsizei)header->vertexStride;
+        size_t offset = 8;
+
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+        GL_CHECK(glVertexAttribPointer(positionLocation, 4, GL_SHORT, GL_TRUE, stride, 0));
+        GL_CHECK(glEnableVertexAttribArray(positionLocation));
+
+        if (header->attributes & BAKED_MESH_NORMALS)
+        {
+            if (normalLocation >= 0)
+            {
+                GL_CHECK(glVertexAttribPointer(normalLocation, 2, GL_BYTE, GL_TRUE, stride, (const GLvoid *)offset));
+                GL_CHECK(glEnableVertexAttribArray(normalLocation));
+            }
+            offset += 4;
+        }
+
+        if ((header->attributes & BAKED_MESH_UVS) && uvLocation >= 0)
+        {
+            GL_CHECK(glVertexAttribPointer(uvLocation, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, (const GLvoid *)offset));
+            GL_CHECK(glEnableVertexAttribArray(uvLocation));
+        }
+    }
+
+    void BakedMesh::draw(unsigned int level) const
+    {
+        const BakedMeshLevel &range = getLevel(level);
+
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+        GL_CHECK(glDrawElements(GL_TRIANGLES, (GLsizei)range.numberOfIndices, GL_UNSIGNED_SHORT,
+                                (const GLvoid *)(range.firstIndex * sizeof(uint16_t))));
+    }
+
+    void BakedMesh::drawMeshlet(unsigned int meshlet) const
+    {
+        const BakedMeshlet &range = getMeshlet(meshlet);
+
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+        GL_CHECK(glDrawElements(GL_TRIANGLES, (GLsizei)range.numberOfIndices, GL_UNSIGNED_SHORT,
+                                (const GLvoid *)(range.firstIndex * sizeof(uint16_t))));
+    }
+}
@@ -0,0 +1,371 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "BakedMeshWriter.h"
+#include "Platform.h"
+#include "VertexPacking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* Sections start on 16 byte boundaries. */
+    static uint32_t alignSection(size_t offset)
+    {
+        return (uint32_t)((offset + 15) & ~(size_t)15);
+    }
+
+    static void getBounds(const IndexedModel &model, int offset, int components, float *minimum, float *maximum)
+    {
+        for (int c = 0; c < components; c++)
+        {
+            minimum[c] = model.vertices[offset + c];
+            maximum[c] = model.vertices[offset + c];
+        }
+
+        for (int v = 1; v < model.getNumberOfVertices(); v++)
+        {
+            const float *value = &model.vertices[v * model.floatsPerVertex + offset];
+            for (int c = 0; c < components; c++)
+            {
+                minimum[c] = std::min(minimum[c], value[c]);
+                maximum[c] = std::max(maximum[c], value[c]);
+            }
+        }
+    }
+
+    void BakedMeshWriter::computeSphere(const IndexedModel &model, const unsigned short *indices, size_t numberOfIndices, float *center, float *radius)
+    {
+        float minimum[3] = { INFINITY, INFINITY, INFINITY };
+        float maximum[3] = { -INFINITY, -INFINITY, -INFINITY };
+
+        for (size_t i = 0; i < numberOfIndices; i++)
+        {
+            const float *position = &model.vertices[indices[i] * model.floatsPerVertex + model.positionOffset];
+            for (int c = 0; c < 3; c++)
+            {
+                minimum[c] = std::min(minimum[c], position[c]);
+                maximum[c] = std::max(maximum[c], position[c]);
+            }
+        }
+
+        float squaredRadius = 0.0f;
+        for (int c = 0; c < 3; c++)
+        {
+            center[c] = (minimum[c] + maximum[c]) * 0.5f;
+        }
+        for (size_t i = 0; i < numberOfIndices; i++)
+        {
+            const float *position = &model.vertices[indices[i] * model.floatsPerVertex + model.positionOffset];
+            float dx = position[0] - center[0];
+            float dy = position[1] - center[1];
+            float dz = position[2] - center[2];
+            squaredRadius = std::max(squaredRadius, dx * dx + dy * dy + dz * dz);
+        }
+
+        *radius = sqrtf(squaredRadius);
+    }
+
+    float BakedMeshWriter::simplify(const IndexedModel &model, int gridSize, std::vector<unsigned short> *indices)
+    {
+        int numberOfVertices = model.getNumberOfVertices();
+        float minimum[3];
+        float maximum[3];
+        getBounds(model, model.positionOffset, 3, minimum, maximum);
+
+        float extent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+        float cellSize = extent > 0.0f ? extent / gridSize : 1.0f;
+
+        /* Cell of each vertex, and the average position of each cell. */
+        std::vector<long long> vertexCells(numberOfVertices);
+        std::vector<std::pair<long long, int> > sortedCells(numberOfVertices);
+        for (int v = 0; v < numberOfVertices; v++)
+        {
+            const float *position = &model.vertices[v * model.floatsPerVertex + model.positionOffset];
+            long long x = std::min((long long)((position[0] - minimum[0]) / cellSize), (long long)gridSize - 1);
+            long long y = std::min((long long)((position[1] - minimum[1]) / cellSize), (long long)gridSize - 1);
+            long long z = std::min((long long)((position[2] - minimum[2]) / cellSize), (long long)gridSize - 1);
+
+            vertexCells[v] = (z * gridSize + y) * gridSize + x;
+            sortedCells[v] = std::make_pair(vertexCells[v], v);
+        }
+        std::sort(sortedCells.begin(), sortedCells.end());
+
+        /* Each cell keeps the vertex closest to the average of the vertices in it. */
+        std::vector<unsigned short> representatives(numberOfVertices);
+        for (size_t first = 0; first < sortedCells.size(); )
+        {
+            size_t last = first;
+            float average[3] = { 0.0f, 0.0f, 0.0f };
+            while (last < sortedCells.size() && sortedCells[last].first == sortedCells[first].first)
+            {
+                const float *position = &model.vertices[sortedCells[last].second * model.floatsPerVertex + model.positionOffset];
+                average[0] += position[0];
+                average[1] += position[1];
+                average[2] += position[2];
+                last++;
+            }
+            for (int c = 0; c < 3; c++)
+            {
+                average[c] /= (float)(last - first);
+            }
+
+            int best = sortedCells[first].second;
+            float bestDistance = INFINITY;
+            for (size_t cell = first; cell < last; cell++)
+            {
+                const float *position = &model.vertices[sortedCells[cell].second * model.floatsPerVertex + model.positionOffset];
+                float dx = position[0] - average[0];
+                float dy = position[1] - average[1];
+                float dz = position[2] - average[2];
+                float distance = dx * dx + dy * dy + dz * dz;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = sortedCells[cell].second;
+                }
+            }
+            for (size_t cell = first; cell < last; cell++)
+            {
+                representatives[sortedCells[cell].second] = (unsigned short)best;
+            }
+
+            first = last;
+        }
+
+        /* Keep the triangles whose corners are still in three different cells, once each, in the order of level 0. */
+        std::vector<unsigned long long> seenTriangles;
+        indices->clear();
+        for (size_t i = 0; i + 2 < model.indices.size(); i += 3)
+        {
+            unsigned short a = representatives[model.indices[i]];
+            unsigned short b = representatives[model.indices[i + 1]];
+            unsigned short c = representatives[model.indices[i + 2]];
+            if (a == b || b == c || a == c)
+            {
+                continue;
+            }
+
+            /* The same triangle in any rotation, flipped ones are kept as they face the other way. */
+            unsigned short first = std::min(a, std::min(b, c));
+            unsigned short second = (first == a) ? b : (first == b) ? c : a;
+            unsigned short third = (first == a) ? c : (first == b) ? a : b;
+            unsigned long long key = ((unsigned long long)first << 32) | ((unsigned long long)second << 16) | third;
+
+            std::vector<unsigned long long>::iterator found = std::lower_bound(seenTriangles.begin(), seenTriangles.end(), key);
+            if (found != seenTriangles.end() && *found == key)
+            {
+                continue;
+            }
+            seenTriangles.insert(found, key);
+
+            indices->push_back(a);
+            indices->push_back(b);
+            indices->push_back(c);
+        }
+
+        /* A vertex moves at most to the far corner of its cell. */
+        return cellSize * sqrtf(3.0f);
+    }
+
+    void BakedMeshWriter::buildMeshlets(const IndexedModel &model, std::vector<BakedMeshlet> *meshlets)
+    {
+        std::vector<unsigned short> vertices;
+        size_t first = 0;
+
+        meshlets->clear();
+        for (size_t i = 0; i <= model.indices.size(); i += 3)
+        {
+            /* Vertices of the next triangle which are not in the meshlet yet. */
+            unsigned int newVertices = 0;
+            for (size_t corner = 0; i < model.indices.size() && corner < 3; corner++)
+            {
+                if (std::find(vertices.begin(), vertices.end(), model.indices[i + corner]) == vertices.end())
+                {
+                    newVertices++;
+                }
+            }
+
+            bool full = vertices.size() + newVertices > BAKED_MESH_MESHLET_VERTICES || (i - first) / 3 == BAKED_MESH_MESHLET_TRIANGLES;
+            if (i > first && (full || i == model.indices.size()))
+            {
+                BakedMeshlet meshlet;
+                meshlet.firstIndex = (uint32_t)first;
+                meshlet.numberOfIndices = (uint32_t)(i - first);
+                computeSphere(model, &model.indices[first], i - first, meshlet.center, &meshlet.radius);
+                meshlets->push_back(meshlet);
+
+                vertices.clear();
+                first = i;
+            }
+
+            for (size_t corner = 0; i < model.indices.size() && corner < 3; corner++)
+            {
+                if (std::find(vertices.begin(), vertices.end(), model.indices[i + corner]) == vertices.end())
+                {
+                    vertices.push_back(model.indices[i + corner]);
+                }
+            }
+        }
+    }
+
+    bool BakedMeshWriter::write(const IndexedModel &model, const char *filename, unsigned int maximumLevels)
+    {
+        int numberOfVertices = model.getNumberOfVertices();
+        if (model.positionOffset < 0 || numberOfVertices == 0 || model.indices.empty())
+        {
+            LOGE("BakedMeshWriter: the model has no positions or no triangles.\n");
+            return false;
+        }
+
+        BakedMeshHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = BAKED_MESH_MAGIC;
+        header.version = BAKED_MESH_VERSION;
+        header.attributes = (model.normalOffset >= 0 ? BAKED_MESH_NORMALS : 0) | (model.uvOffset >= 0 ? BAKED_MESH_UVS : 0);
+        header.vertexStride = 8 + (model.normalOffset >= 0 ? 4 : 0) + (model.uvOffset >= 0 ? 4 : 0);
+        header.numberOfVertices = (uint32_t)numberOfVertices;
+
+        /* Positions map their bounding box to [-1, 1], texture coordinates theirs to [0, 1]. */
+        float minimum[3];
+        float maximum[3];
+        getBounds(model, model.positionOffset, 3, minimum, maximum);
+        for (int c = 0; c < 3; c++)
+        {
+            header.positionBias[c] = (minimum[c] + maximum[c]) * 0.5f;
+            header.positionScale[c] = maximum[c] > minimum[c] ? (maximum[c] - minimum[c]) * 0.5f : 1.0f;
+        }
+        if (model.uvOffset >= 0)
+        {
+            getBounds(model, model.uvOffset, 2, minimum, maximum);
+            for (int c = 0; c < 2; c++)
+            {
+                header.uvBias[c] = minimum[c];
+                header.uvScale[c] = maximum[c] > minimum[c] ? maximum[c] - minimum[c] : 1.0f;
+            }
+        }
+        computeSphere(model, &model.indices[0], model.indices.size(), header.center, &header.radius);
+
+        std::vector<unsigned char> vertices(numberOfVertices * header.vertexStride);
+        for (int v = 0; v < numberOfVertices; v++)
+        {
+            const float *vertex = &model.vertices[v * model.floatsPerVertex];
+            unsigned char *packed = &vertices[v * header.vertexStride];
+
+            int16_t position[4];
+            for (int c = 0; c < 3; c++)
+            {
+                float normalized = (vertex[model.positionOffset + c] - header.positionBias[c]) / header.positionScale[c];
+                position[c] = (int16_t)floorf(std::max(-1.0f, std::min(1.0f, normalized)) * 32767.0f + 0.5f);
+            }
+            position[3] = 32767;
+            memcpy(packed, position, sizeof(position));
+            packed += sizeof(position);
+
+            if (model.normalOffset >= 0)
+            {
+                signed char normal[4] = { 0, 0, 0, 0 };
+                VertexPacking::encodeOctahedral(&vertex[model.normalOffset], normal);
+                memcpy(packed, normal, sizeof(normal));
+                packed += sizeof(normal);
+            }
+
+            if (model.uvOffset >= 0)
+            {
+                uint16_t uv[2];
+                for (int c = 0; c < 2; c++)
+                {
+                    float normalized = (vertex[model.uvOffset + c] - header.uvBias[c]) / header.uvScale[c];
+                    uv[c] = (uint16_t)floorf(std::max(0.0f, std::min(1.0f, normalized)) * 65535.0f + 0.5f);
+                }
+                memcpy(packed, uv, sizeof(uv));
+            }
+        }
+
+        /* Level 0 as it is, then coarser grids until the triangle count stops dropping much. */
+        std::vector<unsigned short> indices(model.indices);
+        std::vector<BakedMeshLevel> levels;
+        BakedMeshLevel level = { 0, (uint32_t)model.indices.size(), 0.0f };
+        levels.push_back(level);
+
+        for (int gridSize = 64; levels.size() < maximumLevels && gridSize >= 2; gridSize /= 2)
+        {
+            std::vector<unsigned short> levelIndices;
+            float error = simplify(model, gridSize, &levelIndices);
+            if (levelIndices.empty() || levelIndices.size() * 4 > levels.back().numberOfIndices * 3)
+            {
+                continue;
+            }
+
+            level.firstIndex = (uint32_t)indices.size();
+            level.numberOfIndices = (uint32_t)levelIndices.size();
+            level.error = error;
+            levels.push_back(level);
+            indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+        }
+
+        std::vector<BakedMeshlet> meshlets;
+        buildMeshlets(model, &meshlets);
+
+        header.numberOfIndices = (uint32_t)indices.size();
+        header.numberOfLevels = (uint32_t)levels.size();
+        header.numberOfMeshlets = (uint32_t)meshlets.size();
+        header.vertexOffset = alignSection(sizeof(header));
+        header.indexOffset = alignSection(header.vertexOffset + vertices.size());
+        header.levelOffset = alignSection(header.indexOffset + indices.size() * sizeof(uint16_t));
+        header.meshletOffset = alignSection(header.levelOffset + levels.size() * sizeof(BakedMeshLevel));
+
+        std::vector<unsigned char> data(header.meshletOffset + meshlets.size() * sizeof(BakedMeshlet), 0);
+        memcpy(&data[0], &header, sizeof(header));
+        memcpy(&data[header.vertexOffset], &vertices[0], vertices.size());
+        memcpy(&data[header.indexOffset], &indices[0], indices.size() * sizeof(uint16_t));
+        memcpy(&data[header.levelOffset], &levels[0], levels.size() * sizeof(BakedMeshLevel));
+        if (!meshlets.empty())
+        {
+            memcpy(&data[header.meshletOffset], &meshlets[0], meshlets.size() * sizeof(BakedMeshlet));
+        }
+
+        FILE *file = fopen(filename, "wb");
+        if (file == NULL)
+        {
+            LOGE("BakedMeshWriter: cannot create '%s'.\n", filename);
+            return false;
+        }
+        bool written = fwrite(&data[0], 1, data.size(), file) == data.size();
+        written = (fclose(file) == 0) && written;
+        if (!written)
+        {
+            LOGE("BakedMeshWriter: cannot write '%s'.\n", filename);
+            return false;
+        }
+
+        LOGI("BakedMeshWriter: %s: %d vertices, %u levels of detail, %u meshlets, %u bytes.\n", filename, numberOfVertices,
+             header.numberOfLevels, header.numberOfMeshlets, (unsigned int)data.size());
+        for (size_t l = 0; l < levels.size(); l++)
+        {
+            LOGI("    level %u: %u triangles, error %f\n", (unsigned int)l, levels[l].numberOfIndices / 3, levels[l].error);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,296 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "CommandList.h"
+#include "GLStateCache.h"
+#include "Platform.h"
+
+#include <cstring>
+
+namespace MaliSDK
+{
+    CommandList::CommandList(unsigned int reservedCommands)
+        : filteredUniforms(0)
+    {
+        commands.reserve(reservedCommands);
+        values.reserve(reservedCommands * 4);
+    }
+
+    void CommandList::reset(void)
+    {
+        commands.clear();
+        values.clear();
+    }
+
+    void CommandList::push(CommandType type, GLenum target, GLint argument0, GLint argument1, GLint argument2, GLint argument3)
+    {
+        Command command;
+
+        command.type = type;
+        command.target = target;
+        command.arguments[0] = argument0;
+        command.arguments[1] = argument1;
+        command.arguments[2] = argument2;
+        command.arguments[3] = argument3;
+        commands.push_back(command);
+    }
+
+    void CommandList::pushFloats(GLenum type, GLint location, GLsizei count, GLsizei floatsPerElement, const GLfloat *data)
+    {
+        if (location < 0 || count <= 0)
+        {
+            return;
+        }
+
+        push(COMMAND_UNIFORM_FLOATS, type, location, count, (GLint)values.size());
+        values.insert(values.end(), data, data + count * floatsPerElement);
+    }
+
+    void CommandList::useProgram(GLuint program)
+    {
+        push(COMMAND_USE_PROGRAM, 0, (GLint)program);
+    }
+
+    void CommandList::bindVertexArray(GLuint vertexArray)
+    {
+        push(COMMAND_BIND_VERTEX_ARRAY, 0, (GLint)vertexArray);
+    }
+
+    void CommandList::bindTexture(GLuint unit, GLenum target, GLuint texture)
+    {
+        push(COMMAND_BIND_TEXTURE, target, (GLint)unit, (GLint)texture);
+    }
+
+    void CommandList::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        push(COMMAND_BIND_BUFFER_BASE, target, (GLint)index, (GLint)buffer);
+    }
+
+    void CommandList::setEnabled(GLenum capability, bool enabled)
+    {
+        push(COMMAND_SET_ENABLED, capability, enabled ? 1 : 0);
+    }
+
+    void CommandList::uniform1i(GLint location, GLint value)
+    {
+        if (location >= 0)
+        {
+            push(COMMAND_UNIFORM_INT, GL_INT, location, value);
+        }
+    }
+
+    void CommandList::uniform1f(GLint location, GLfloat value)
+    {
+        pushFloats(GL_FLOAT, location, 1, 1, &value);
+    }
+
+    void CommandList::uniform3fv(GLint location, GLsizei count, const GLfloat *value)
+    {
+        pushFloats(GL_FLOAT_VEC3, location, count, 3, value);
+    }
+
+    void CommandList::uniform4fv(GLint location, GLsizei count, const GLfloat *value)
+    {
+        pushFloats(GL_FLOAT_VEC4, location, count, 4, value);
+    }
+
+    void CommandList::uniformMatrix4fv(GLint location, GLsizei count, const GLfloat *value)
+    {
+        pushFloats(GL_FLOAT_MAT4, location, count, 16, value);
+    }
+
+    void CommandList::drawArrays(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+    {
+        if (count > 0 && instances > 0)
+        {
+            push(COMMAND_DRAW_ARRAYS, mode, first, count, instances);
+        }
+    }
+
+    void CommandList::drawElements(GLenum mode, GLsizei count, GLenum type, GLintptr offset, GLsizei instances)
+    {
+        if (count > 0 && instances > 0)
+        {
+            push(COMMAND_DRAW_ELEMENTS, mode, count, (GLint)type, (GLint)offset, instances);
+        }
+    }
+
+    static GLsizei getFloatsPerElement(GLenum type)
+    {
+        switch (type)
+        {
+            case GL_FLOAT_VEC3:
+                return 3;
+            case GL_FLOAT_VEC4:
+                return 4;
+            case GL_FLOAT_MAT4:
+                return 16;
+            default:
+                return 1;
+        }
+    }
+
+    bool CommandList::isUniformSet(GLuint program, const Command &command)
+    {
+        const GLint location = command.arguments[0];
+        const bool isInteger = command.type == COMMAND_UNIFORM_INT;
+        const GLsizei count = isInteger ? 1 : command.arguments[1];
+        const size_t offset = isInteger ? 0 : (size_t)command.arguments[2];
+
+        /* Passes set a handful of uniforms, a linear search is cheaper than a map. */
+        for (size_t i = 0; i < uniforms.size(); i++)
+        {
+            UniformState &uniform = uniforms[i];
+
+            if (uniform.program != program || uniform.location != location)
+            {
+                continue;
+            }
+
+            bool same = uniform.type == command.target && uniform.count == count;
+            if (same && isInteger)
+            {
+                same = uniform.integer == command.arguments[1];
+            }
+            else if (same)
+            {
+                same = memcmp(&values[uniform.offset], &values[offset], count * getFloatsPerElement(command.target) * sizeof(GLfloat)) == 0;
+            }
+
+            uniform.type = command.target;
+            uniform.count = count;
+            uniform.offset = offset;
+            uniform.integer = isInteger ? command.arguments[1] : 0;
+            return same;
+        }
+
+        UniformState uniform;
+        uniform.program = program;
+        uniform.location = location;
+        uniform.type = command.target;
+        uniform.count = count;
+        uniform.offset = offset;
+        uniform.integer = isInteger ? command.arguments[1] : 0;
+        uniforms.push_back(uniform);
+        return false;
+    }
+
+    void CommandList::execute(void)
+    {
+        /* Uniforms belong to programs, which may have been changed since the last execute(). */
+        GLuint program = 0;
+        uniforms.clear();
+        filteredUniforms = 0;
+
+        for (size_t i = 0; i < commands.size(); i++)
+        {
+            const Command &command = commands[i];
+            const GLint *arguments = command.arguments;
+
+            switch (command.type)
+            {
+                case COMMAND_USE_PROGRAM:
+                    program = (GLuint)arguments[0];
+                    GLStateCache::useProgram(program);
+                    break;
+                case COMMAND_BIND_VERTEX_ARRAY:
+                    GLStateCache::bindVertexArray((GLuint)arguments[0]);
+                    break;
+                case COMMAND_BIND_TEXTURE:
+                    GLStateCache::activeTexture(GL_TEXTURE0 + (GLenum)arguments[0]);
+                    GLStateCache::bindTexture(command.target, (GLuint)arguments[1]);
+                    break;
+                case COMMAND_BIND_BUFFER_BASE:
+                    GL_CHECK(glBindBufferBase(command.target, (GLuint)arguments[0], (GLuint)arguments[1]));
+                    break;
+                case COMMAND_SET_ENABLED:
+                    GLStateCache::setEnabled(command.target, arguments[0] != 0);
+                    break;
+                case COMMAND_UNIFORM_INT:
+                    if (isUniformSet(program, command))
+                    {
+                        filteredUniforms++;
+                        break;
+                    }
+                    GL_CHECK(glUniform1i(arguments[0], arguments[1]));
+                    break;
+                case COMMAND_UNIFORM_FLOATS:
+                {
+                    if (isUniformSet(program, command))
+                    {
+                        filteredUniforms++;
+                        break;
+                    }
+
+                    const GLfloat *data = &values[(size_t)arguments[2]];
+                    switch (command.target)
+                    {
+                        case GL_FLOAT_VEC3:
+                            GL_CHECK(glUniform3fv(arguments[0], arguments[1], data));
+                            break;
+                        case GL_FLOAT_VEC4:
+                            GL_CHECK(glUniform4fv(arguments[0], arguments[1], data));
+                            break;
+                        case GL_FLOAT_MAT4:
+                            GL_CHECK(glUniformMatrix4fv(arguments[0], arguments[1], GL_FALSE, data));
+                            break;
+                        default:
+                            GL_CHECK(glUniform1fv(arguments[0], arguments[1], data));
+                            break;
+                    }
+                    break;
+                }
+                case COMMAND_DRAW_ARRAYS:
+                    if (arguments[2] > 1)
+                    {
+                        GL_CHECK(glDrawArraysInstanced(command.target, arguments[0], arguments[1], arguments[2]));
+                    }
+                    else
+                    {
+                        GL_CHECK(glDrawArrays(command.target, arguments[0], arguments[1]));
+                    }
+                    break;
+                case COMMAND_DRAW_ELEMENTS:
+                {
+                    const GLvoid *offset = (const GLvoid *)(GLintptr)arguments[2];
+                    if (arguments[3] > 1)
+                    {
+                        GL_CHECK(glDrawElementsInstanced(command.target, arguments[0], (GLenum)arguments[1], offset, arguments[3]));
+                    }
+                    else
+                    {
+                        GL_CHECK(glDrawElements(command.target, arguments[0], (GLenum)arguments[1], offset));
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    unsigned int CommandList::getNumberOfCommands(void) const
+    {
+        return (unsigned int)commands.size();
+    }
+
+    unsigned int CommandList::getNumberOfFilteredUniforms(void) const
+    {
+        return filteredUniforms;
+    }
+}
@@ -0,0 +1,277 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "CompressedMipmapLoader.h"
+#include "AssetFile.h"
+#include "ETCHeader.h"
+#include "Platform.h"
+#include "Texture.h"
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2ext.h>
+#endif
+
+#include <cstdlib>
+#include <sstream>
+
+namespace MaliSDK
+{
+    /* The PKM header is always there, even if the image data is not. */
+    static const size_t sizeOfETCHeader = 16;
+
+    CompressedMipmapLoader::CompressedMipmapLoader(void)
+        : width(0),
+          height(0),
+          numberOfLevels(0),
+          texture(0),
+          uploadedLevel(0),
+          stopped(false),
+          workerStarted(false),
+          cancelled(false),
+          failed(false),
+          readLevel(0)
+    {
+        pthread_mutex_init(&mutex, NULL);
+    }
+
+    CompressedMipmapLoader::~CompressedMipmapLoader(void)
+    {
+        pthread_mutex_lock(&mutex);
+        cancelled = true;
+        pthread_mutex_unlock(&mutex);
+
+        joinWorker();
+
+        if (texture != 0)
+        {
+            GL_CHECK(glDeleteTextures(1, &texture));
+        }
+
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void CompressedMipmapLoader::joinWorker(void)
+    {
+        if (workerStarted)
+        {
+            pthread_join(workerThread, NULL);
+            workerStarted = false;
+        }
+    }
+
+    bool CompressedMipmapLoader::readLevelData(int level)
+    {
+        std::stringstream filename;
+        filename << filenameBase << level << filenameSuffix;
+
+        AssetFile file;
+        if (!file.open(filename.str().c_str()) || file.getSize() < sizeOfETCHeader)
+        {
+            LOGE("CompressedMipmapLoader: cannot open %s.\n", filename.str().c_str());
+            return false;
+        }
+
+        ETCHeader header((unsigned char *)file.getData());
+        size_t dataSize = (header.getPaddedWidth() * header.getPaddedHeight()) >> 1;
+
+        if (header.getWidth() != Texture::getLevelSize(width, level) || header.getHeight() != Texture::getLevelSize(height, level) ||
+            file.getSize() < sizeOfETCHeader + dataSize)
+        {
+            LOGE("CompressedMipmapLoader: %s is not mipmap level %d of a %dx%d texture.\n", filename.str().c_str(), level, width, height);
+            return false;
+        }
+
+        levelData[level].assign(file.getData() + sizeOfETCHeader, file.getData() + sizeOfETCHeader + dataSize);
+
+        return true;
+    }
+
+    void CompressedMipmapLoader::uploadLevel(int level)
+    {
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+
+#if GLES_VERSION == 3
+        GL_CHECK(glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, Texture::getLevelSize(width, level), Texture::getLevelSize(height, level),
+                                           GL_COMPRESSED_RGB8_ETC2, levelData[level].size(), &levelData[level][0]));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level));
+
+        /* The level stays in the texture, only OpenGL ES 2.0 specifies it again. */
+        std::vector<unsigned char>().swap(levelData[level]);
+#else
+        /* Every level in so far moves one level down, behind the new level 0. */
+        for (int source = level; source < numberOfLevels; source++)
+        {
+            GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, source - level, GL_ETC1_RGB8_OES, Texture::getLevelSize(width, source), Texture::getLevelSize(height, source),
+                                            0, levelData[source].size(), &levelData[source][0]));
+        }
+#endif
+
+        uploadedLevel = level;
+    }
+
+    void *CompressedMipmapLoader::workerFunction(void *loader)
+    {
+        CompressedMipmapLoader *self = (CompressedMipmapLoader *)loader;
+
+        /* start() has read the smallest level. */
+        for (int level = self->numberOfLevels - 2; level >= 0; level--)
+        {
+            pthread_mutex_lock(&self->mutex);
+            bool stop = self->cancelled;
+            pthread_mutex_unlock(&self->mutex);
+
+            if (stop)
+            {
+                break;
+            }
+
+            bool read = self->readLevelData(level);
+
+            pthread_mutex_lock(&self->mutex);
+            if (read)
+            {
+                self->readLevel = level;
+            }
+            else
+            {
+                self->failed = true;
+            }
+            pthread_mutex_unlock(&self->mutex);
+
+            if (!read)
+            {
+                break;
+            }
+        }
+
+        return NULL;
+    }
+
+    bool CompressedMipmapLoader::start(const std::string &filenameBase, const std::string &filenameSuffix)
+    {
+        if (workerStarted || texture != 0)
+        {
+            LOGE("CompressedMipmapLoader::start() called twice.\n");
+            exit(1);
+        }
+
+        this->filenameBase = filenameBase;
+        this->filenameSuffix = filenameSuffix;
+
+        /* Only the header of the base level is needed to know the size of every level. */
+        std::string baseFilename = filenameBase + "0" + filenameSuffix;
+        AssetFile baseFile;
+        if (!baseFile.open(baseFilename.c_str()) || baseFile.getSize() < sizeOfETCHeader)
+        {
+            LOGE("CompressedMipmapLoader: cannot open %s.\n", baseFilename.c_str());
+            return false;
+        }
+
+        ETCHeader baseHeader((unsigned char *)baseFile.getData());
+        width = baseHeader.getWidth();
+        height = baseHeader.getHeight();
+        baseFile.close();
+
+        numberOfLevels = 1;
+        for (int size = width > height ? width : height; size > 1; size >>= 1)
+        {
+            numberOfLevels++;
+        }
+
+        levelData.assign(numberOfLevels, std::vector<unsigned char>());
+        uploadedLevel = numberOfLevels;
+        readLevel = numberOfLevels - 1;
+        stopped = false;
+        failed = false;
+        cancelled = false;
+
+        if (!readLevelData(numberOfLevels - 1))
+        {
+            return false;
+        }
+
+        GL_CHECK(glGenTextures(1, &texture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+#if GLES_VERSION == 3
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, numberOfLevels, GL_COMPRESSED_RGB8_ETC2, width, height));
+#endif
+        uploadLevel(numberOfLevels - 1);
+
+        if (pthread_create(&workerThread, NULL, &workerFunction, this) != 0)
+        {
+            /* No thread, read everything now so update() still works. */
+            LOGI("CompressedMipmapLoader: cannot start a worker thread, reading %s on the rendering thread.\n", baseFilename.c_str());
+            workerFunction(this);
+        }
+        else
+        {
+            workerStarted = true;
+        }
+
+        return true;
+    }
+
+    bool CompressedMipmapLoader::update(void)
+    {
+        if (texture == 0 || uploadedLevel == 0 || stopped)
+        {
+            return isComplete();
+        }
+
+        pthread_mutex_lock(&mutex);
+        int availableLevel = readLevel;
+        bool readingFailed = failed;
+        pthread_mutex_unlock(&mutex);
+
+        if (availableLevel < uploadedLevel)
+        {
+            uploadLevel(uploadedLevel - 1);
+        }
+        else if (readingFailed)
+        {
+            /* The levels in so far make a complete texture of a lower resolution. */
+            LOGE("CompressedMipmapLoader: %s%d%s cannot be read, the texture stops at level %d.\n",
+                 filenameBase.c_str(), uploadedLevel - 1, filenameSuffix.c_str(), uploadedLevel);
+            stopped = true;
+        }
+
+        if (uploadedLevel == 0 || stopped)
+        {
+            joinWorker();
+        }
+
+        return isComplete();
+    }
+
+    bool CompressedMipmapLoader::isComplete(void) const
+    {
+        return texture != 0 && uploadedLevel == 0;
+    }
+
+    int CompressedMipmapLoader::getUploadedLevel(void) const
+    {
+        return uploadedLevel;
+    }
+
+    GLuint CompressedMipmapLoader::getTexture(void) const
+    {
+        return texture;
+    }
+}
@@ -0,0 +1,261 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "DepthPrePass.h"
+#include "Platform.h"
+#include "Shader.h"
+
+namespace MaliSDK
+{
+    const GLuint DepthPrePass::POSITION_ATTRIBUTE;
+
+    /* Invariant, so the shading pass computes the same depth from the same matrix and position. */
+    static const char *vertexShaderSource =
+        "#version 300 es\n"
+        "layout(location = 0) in vec4 position;\n"
+        "uniform mat4 modelViewProjection;\n"
+        "invariant gl_Position;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_Position = modelViewProjection * position;\n"
+        "}\n";
+
+    static const char *depthFragmentShaderSource =
+        "#version 300 es\n"
+        "void main()\n"
+        "{\n"
+        "}\n";
+
+    /* Every fragment adds one to the 8 bit count, which saturates after 255 layers. */
+    static const char *countFragmentShaderSource =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "out vec4 count;\n"
+        "void main()\n"
+        "{\n"
+        "    count = vec4(1.0 / 255.0, 0.0, 0.0, 0.0);\n"
+        "}\n";
+
+    /* The overdraw is a ratio, a sixteenth of the pixels is enough to estimate it. */
+    static const GLsizei countDivisor = 4;
+
+    DepthPrePass::DepthPrePass(GLsizei width, GLsizei height, Mode mode, float overdrawThreshold, unsigned int measurementInterval)
+        : mode(mode),
+          overdrawThreshold(overdrawThreshold),
+          measurementInterval(measurementInterval > 0 ? measurementInterval : 1),
+          depthProgram(0),
+          countProgram(0),
+          currentMatrixLocation(-1),
+          countWidth(width / countDivisor > 0 ? width / countDivisor : 1),
+          countHeight(height / countDivisor > 0 ? height / countDivisor : 1),
+          frame(0),
+          measuring(false),
+          enabled(mode == MODE_ON),
+          overdraw(0.0f),
+          previousFramebuffer(0)
+    {
+        Shader::processProgramSource(&depthProgram, vertexShaderSource, depthFragmentShaderSource);
+        Shader::processProgramSource(&countProgram, vertexShaderSource, countFragmentShaderSource);
+        depthMatrixLocation = GL_CHECK(glGetUniformLocation(depthProgram, "modelViewProjection"));
+        countMatrixLocation = GL_CHECK(glGetUniformLocation(countProgram, "modelViewProjection"));
+
+        GL_CHECK(glGenTextures(1, &countTexture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, countTexture));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, countWidth, countHeight));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+        GL_CHECK(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer));
+        GL_CHECK(glGenFramebuffers(1, &countFramebuffer));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, countFramebuffer));
+        GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, countTexture, 0));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer));
+
+        /* Two reads in flight are plenty with a measurement every few frames. */
+        readback = new AsyncReadback(countWidth, countHeight, 2);
+
+        previousViewport[0] = 0;
+        previousViewport[1] = 0;
+        previousViewport[2] = width;
+        previousViewport[3] = height;
+    }
+
+    DepthPrePass::~DepthPrePass(void)
+    {
+        delete readback;
+        GL_CHECK(glDeleteFramebuffers(1, &countFramebuffer));
+        GL_CHECK(glDeleteTextures(1, &countTexture));
+        GL_CHECK(glDeleteProgram(countProgram));
+        GL_CHECK(glDeleteProgram(depthProgram));
+    }
+
+    GLuint DepthPrePass::createVertexArray(GLuint positionBuffer, GLint size, GLenum type, GLsizei stride, GLintptr offset,
+                                           GLuint indexBuffer)
+    {
+        GLuint vertexArray = 0;
+        GLint previousBuffer = 0;
+        GL_CHECK(glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer));
+
+        GL_CHECK(glGenVertexArrays(1, &vertexArray));
+        GL_CHECK(glBindVertexArray(vertexArray));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, positionBuffer));
+        GL_CHECK(glVertexAttribPointer(POSITION_ATTRIBUTE, size, type, GL_FALSE, stride, (const GLvoid *)offset));
+        GL_CHECK(glEnableVertexAttribArray(POSITION_ATTRIBUTE));
+        if (indexBuffer != 0)
+        {
+            GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+        }
+        GL_CHECK(glBindVertexArray(0));
+
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, (GLuint)previousBuffer));
+
+        return vertexArray;
+    }
+
+    void DepthPrePass::setMode(Mode mode)
+    {
+        this->mode = mode;
+        frame = 0;
+        enabled = mode == MODE_ON;
+    }
+
+    DepthPrePass::Mode DepthPrePass::getMode(void) const
+    {
+        return mode;
+    }
+
+    bool DepthPrePass::beginFrame(void)
+    {
+        unsigned int tag = 0;
+        while (readback->collect(&tag, counts))
+        {
+            unsigned int fragments = 0;
+            unsigned int coveredPixels = 0;
+            for (size_t pixel = 0; pixel < counts.size(); pixel += 4)
+            {
+                fragments += counts[pixel];
+                coveredPixels += counts[pixel] > 0 ? 1 : 0;
+            }
+            overdraw = coveredPixels > 0 ? (float)fragments / coveredPixels : 0.0f;
+
+            /* Measurements queued before a switch to another mode are still collected, but decide nothing. */
+            if (mode == MODE_AUTOMATIC)
+            {
+                bool wasEnabled = enabled;
+                enabled = enabled ? overdraw > 0.8f * overdrawThreshold : overdraw > overdrawThreshold;
+                if (enabled != wasEnabled)
+                {
+                    LOGI("DepthPrePass: overdraw %.2f, pre-pass %s.\n", overdraw, enabled ? "on" : "off");
+                }
+            }
+        }
+
+        measuring = mode == MODE_AUTOMATIC && frame % measurementInterval == 0;
+        frame++;
+
+        return enabled;
+    }
+
+    bool DepthPrePass::beginMeasurement(void)
+    {
+        static const GLfloat zero[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        static const GLenum colorAttachment[] = { GL_COLOR_ATTACHMENT0 };
+
+        if (!measuring)
+        {
+            return false;
+        }
+
+        GL_CHECK(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer));
+        GL_CHECK(glGetIntegerv(GL_VIEWPORT, previousViewport));
+
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, countFramebuffer));
+        GL_CHECK(glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, colorAttachment));
+        GL_CHECK(glViewport(0, 0, countWidth, countHeight));
+        GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+        GL_CHECK(glClearBufferfv(GL_COLOR, 0, zero));
+
+        GL_CHECK(glDisable(GL_DEPTH_TEST));
+        GL_CHECK(glEnable(GL_BLEND));
+        GL_CHECK(glBlendEquation(GL_FUNC_ADD));
+        GL_CHECK(glBlendFunc(GL_ONE, GL_ONE));
+
+        GL_CHECK(glUseProgram(countProgram));
+        currentMatrixLocation = countMatrixLocation;
+
+        return true;
+    }
+
+    void DepthPrePass::endMeasurement(void)
+    {
+        /* Dropped if both reads are still in flight, the next measurement gets another chance. */
+        readback->read(frame, countFramebuffer);
+        measuring = false;
+
+        GL_CHECK(glDisable(GL_BLEND));
+        GL_CHECK(glEnable(GL_DEPTH_TEST));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer));
+        GL_CHECK(glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]));
+    }
+
+    void DepthPrePass::beginDepthPass(void)
+    {
+        GL_CHECK(glEnable(GL_DEPTH_TEST));
+        GL_CHECK(glDepthFunc(GL_LESS));
+        GL_CHECK(glDepthMask(GL_TRUE));
+        GL_CHECK(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+
+        GL_CHECK(glUseProgram(depthProgram));
+        currentMatrixLocation = depthMatrixLocation;
+    }
+
+    void DepthPrePass::setModelViewProjection(const float *matrix)
+    {
+        GL_CHECK(glUniformMatrix4fv(currentMatrixLocation, 1, GL_FALSE, matrix));
+    }
+
+    void DepthPrePass::beginShadingPass(void)
+    {
+        GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+        GL_CHECK(glDepthMask(GL_FALSE));
+        GL_CHECK(glDepthFunc(GL_LEQUAL));
+    }
+
+    void DepthPrePass::endFrame(void)
+    {
+        GL_CHECK(glDepthMask(GL_TRUE));
+        GL_CHECK(glDepthFunc(GL_LESS));
+
+        /* The default framebuffer names its buffers differently from framebuffer objects. */
+        GLint framebuffer = 0;
+        GL_CHECK(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer));
+        const GLenum depthAttachment = framebuffer == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+        GL_CHECK(glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, 1, &depthAttachment));
+    }
+
+    bool DepthPrePass::isEnabled(void) const
+    {
+        return enabled;
+    }
+
+    float DepthPrePass::getOverdraw(void) const
+    {
+        return overdraw;
+    }
+}
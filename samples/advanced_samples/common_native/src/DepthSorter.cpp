@@ -0,0 +1,162 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "DepthSorter.h"
+
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* More element moves than this per object and the insertion sort gives up for the radix sort. */
+    static const int maxMovesPerObject = 4;
+
+    /* Map a float to an unsigned integer which compares in the same order. */
+    static unsigned int floatToKey(float value)
+    {
+        unsigned int bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    void DepthSorter::sort(const Vec3f *positions, int count, const Matrix *viewMatrix, Order sortOrder)
+    {
+        Matrix view = *viewMatrix;
+        const float *elements = view.getAsArray();
+
+        /* Only the z row of the view matrix is needed. In front of the camera z is negative, so -z is the distance. */
+        float sign = sortOrder == FrontToBack ? -1.0f : 1.0f;
+        depths.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            depths[i] = sign * (elements[2] * positions[i].x + elements[6] * positions[i].y + elements[10] * positions[i].z + elements[14]);
+        }
+
+        sortByDepth(depths.empty() ? NULL : &depths[0], count);
+    }
+
+    void DepthSorter::sortByDepth(const float *values, int count)
+    {
+        keys.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            keys[i] = floatToKey(values[i]);
+        }
+
+        if ((int)order.size() != count)
+        {
+            resetOrder();
+        }
+
+        if (!insertionSort())
+        {
+            radixSort();
+        }
+    }
+
+    bool DepthSorter::insertionSort(void)
+    {
+        int count = (int)order.size();
+        long long moves = 0;
+        long long maxMoves = (long long)count * maxMovesPerObject;
+
+        /* Work on a copy so a give-up leaves the previous order for the radix sort, which does not care. */
+        scratch = order;
+        for (int i = 1; i < count; i++)
+        {
+            int object = scratch[i];
+            unsigned int key = keys[object];
+            int j = i - 1;
+            while (j >= 0 && keys[scratch[j]] > key)
+            {
+                scratch[j + 1] = scratch[j];
+                j--;
+                if (++moves > maxMoves)
+                {
+                    return false;
+                }
+            }
+            scratch[j + 1] = object;
+        }
+
+        order.swap(scratch);
+        return true;
+    }
+
+    void DepthSorter::radixSort(void)
+    {
+        int count = (int)order.size();
+        for (int i = 0; i < count; i++)
+        {
+            order[i] = i;
+        }
+        scratch.resize(count);
+
+        /* Least significant digit first, 8 bits per pass. Each pass is stable, so the result is sorted on all 32 bits. */
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            int histogram[257] = { 0 };
+            for (int i = 0; i < count; i++)
+            {
+                histogram[((keys[order[i]] >> shift) & 0xff) + 1]++;
+            }
+
+            /* Skip passes where every key has the same digit, common for the high bits of nearby depths. */
+            bool trivial = false;
+            for (int digit = 1; digit <= 256; digit++)
+            {
+                if (histogram[digit] == count)
+                {
+                    trivial = true;
+                }
+                histogram[digit] += histogram[digit - 1];
+            }
+            if (trivial)
+            {
+                continue;
+            }
+
+            for (int i = 0; i < count; i++)
+            {
+                scratch[histogram[(keys[order[i]] >> shift) & 0xff]++] = order[i];
+            }
+            order.swap(scratch);
+        }
+    }
+
+    const int *DepthSorter::getOrder(void) const
+    {
+        return order.empty() ? NULL : &order[0];
+    }
+
+    int DepthSorter::getCount(void) const
+    {
+        return (int)order.size();
+    }
+
+    void DepthSorter::resetOrder(void)
+    {
+        int count = (int)keys.size();
+        order.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            order[i] = i;
+        }
+    }
+}
@@ -0,0 +1,567 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "DeviceCapabilities.h"
+#include "JsonValue.h"
+#include "MicroBenchmarks.h"
+#include "Platform.h"
+
+#include <EGL/egl.h>
+#include <GLES3/gl31.h>
+
+#include <cstdio>
+
+using std::string;
+using std::vector;
+
+namespace MaliSDK
+{
+    /* An implementation limit, with how many values it has and whether they are read one index at a time. */
+    struct LimitQuery
+    {
+        const char *name;
+        GLenum parameter;
+        int count;
+        bool indexed;
+    };
+
+    static const LimitQuery limits30[] =
+    {
+        { "GL_MAX_TEXTURE_SIZE", GL_MAX_TEXTURE_SIZE, 1, false },
+        { "GL_MAX_3D_TEXTURE_SIZE", GL_MAX_3D_TEXTURE_SIZE, 1, false },
+        { "GL_MAX_ARRAY_TEXTURE_LAYERS", GL_MAX_ARRAY_TEXTURE_LAYERS, 1, false },
+        { "GL_MAX_CUBE_MAP_TEXTURE_SIZE", GL_MAX_CUBE_MAP_TEXTURE_SIZE, 1, false },
+        { "GL_MAX_RENDERBUFFER_SIZE", GL_MAX_RENDERBUFFER_SIZE, 1, false },
+        { "GL_MAX_VIEWPORT_DIMS", GL_MAX_VIEWPORT_DIMS, 2, false },
+        { "GL_MAX_SAMPLES", GL_MAX_SAMPLES, 1, false },
+        { "GL_MAX_COLOR_ATTACHMENTS", GL_MAX_COLOR_ATTACHMENTS, 1, false },
+        { "GL_MAX_DRAW_BUFFERS", GL_MAX_DRAW_BUFFERS, 1, false },
+        { "GL_MAX_VERTEX_ATTRIBS", GL_MAX_VERTEX_ATTRIBS, 1, false },
+        { "GL_MAX_VERTEX_UNIFORM_VECTORS", GL_MAX_VERTEX_UNIFORM_VECTORS, 1, false },
+        { "GL_MAX_FRAGMENT_UNIFORM_VECTORS", GL_MAX_FRAGMENT_UNIFORM_VECTORS, 1, false },
+        { "GL_MAX_VARYING_VECTORS", GL_MAX_VARYING_VECTORS, 1, false },
+        { "GL_MAX_TEXTURE_IMAGE_UNITS", GL_MAX_TEXTURE_IMAGE_UNITS, 1, false },
+        { "GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS", GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, 1, false },
+        { "GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS", GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, 1, false },
+        { "GL_MAX_UNIFORM_BLOCK_SIZE", GL_MAX_UNIFORM_BLOCK_SIZE, 1, false },
+        { "GL_MAX_UNIFORM_BUFFER_BINDINGS", GL_MAX_UNIFORM_BUFFER_BINDINGS, 1, false },
+        { "GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT", GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, 1, false },
+        { "GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS", GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS, 1, false },
+        { "GL_MAX_ELEMENTS_VERTICES", GL_MAX_ELEMENTS_VERTICES, 1, false },
+        { "GL_MAX_ELEMENTS_INDICES", GL_MAX_ELEMENTS_INDICES, 1, false },
+        { "GL_MAX_SERVER_WAIT_TIMEOUT", GL_MAX_SERVER_WAIT_TIMEOUT, 1, false },
+    };
+
+    static const LimitQuery limits31[] =
+    {
+        { "GL_MAX_COMPUTE_WORK_GROUP_COUNT", GL_MAX_COMPUTE_WORK_GROUP_COUNT, 3, true },
+        { "GL_MAX_COMPUTE_WORK_GROUP_SIZE", GL_MAX_COMPUTE_WORK_GROUP_SIZE, 3, true },
+        { "GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS", GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, 1, false },
+        { "GL_MAX_COMPUTE_SHARED_MEMORY_SIZE", GL_MAX_COMPUTE_SHARED_MEMORY_SIZE, 1, false },
+        { "GL_MAX_COMPUTE_UNIFORM_COMPONENTS", GL_MAX_COMPUTE_UNIFORM_COMPONENTS, 1, false },
+        { "GL_MAX_COMPUTE_SHADER_STORAGE_BLOCKS", GL_MAX_COMPUTE_SHADER_STORAGE_BLOCKS, 1, false },
+        { "GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS", GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, 1, false },
+        { "GL_MAX_SHADER_STORAGE_BLOCK_SIZE", GL_MAX_SHADER_STORAGE_BLOCK_SIZE, 1, false },
+        { "GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT", GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, 1, false },
+        { "GL_MAX_IMAGE_UNITS", GL_MAX_IMAGE_UNITS, 1, false },
+        { "GL_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS", GL_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS, 1, false },
+        { "GL_MAX_FRAMEBUFFER_WIDTH", GL_MAX_FRAMEBUFFER_WIDTH, 1, false },
+        { "GL_MAX_FRAMEBUFFER_HEIGHT", GL_MAX_FRAMEBUFFER_HEIGHT, 1, false },
+        { "GL_MAX_FRAMEBUFFER_SAMPLES", GL_MAX_FRAMEBUFFER_SAMPLES, 1, false },
+        { "GL_MAX_SAMPLE_MASK_WORDS", GL_MAX_SAMPLE_MASK_WORDS, 1, false },
+    };
+
+    static void queryLimits(const LimitQuery *queries, size_t count, vector<DeviceCapabilities::Limit> &limits)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            DeviceCapabilities::Limit limit;
+            GLint64 values[3] = { 0, 0, 0 };
+
+            if (queries[i].indexed)
+            {
+                for (int index = 0; index < queries[i].count; index++)
+                {
+                    GL_CHECK(glGetInteger64i_v(queries[i].parameter, index, &values[index]));
+                }
+            }
+            else
+            {
+                GL_CHECK(glGetInteger64v(queries[i].parameter, values));
+            }
+
+            limit.name = queries[i].name;
+            limit.values.assign(values, values + queries[i].count);
+            limits.push_back(limit);
+        }
+    }
+
+    static string getGLString(GLenum name)
+    {
+        const char *value = (const char *)glGetString(name);
+
+        return value != NULL ? value : "";
+    }
+
+    static void writeString(FILE *file, const string &text)
+    {
+        fputc('"', file);
+
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            unsigned char character = (unsigned char)text[i];
+
+            if (character == '"' || character == '\\')
+            {
+                fprintf(file, "\\%c", character);
+            }
+            else if (character < 0x20)
+            {
+                fprintf(file, "\\u%04x", character);
+            }
+            else
+            {
+                fputc(character, file);
+            }
+        }
+
+        fputc('"', file);
+    }
+
+    DeviceCapabilities::DeviceCapabilities(void)
+    {
+    }
+
+    void DeviceCapabilities::probe(void)
+    {
+        renderer = getGLString(GL_RENDERER);
+        vendor = getGLString(GL_VENDOR);
+        version = getGLString(GL_VERSION);
+        shadingLanguageVersion = getGLString(GL_SHADING_LANGUAGE_VERSION);
+
+        /* [Probe EGL configs] */
+        EGLDisplay display = eglGetCurrentDisplay();
+        configs.clear();
+        eglVendor.clear();
+        eglVersion.clear();
+
+        if (display != EGL_NO_DISPLAY)
+        {
+            const char *value = eglQueryString(display, EGL_VENDOR);
+            eglVendor = value != NULL ? value : "";
+            value = eglQueryString(display, EGL_VERSION);
+            eglVersion = value != NULL ? value : "";
+
+            EGLint numberOfConfigs = 0;
+            eglGetConfigs(display, NULL, 0, &numberOfConfigs);
+
+            vector<EGLConfig> eglConfigs(numberOfConfigs > 0 ? numberOfConfigs : 1);
+            if (eglGetConfigs(display, &eglConfigs[0], numberOfConfigs, &numberOfConfigs) == EGL_FALSE)
+            {
+                numberOfConfigs = 0;
+            }
+
+            for (EGLint i = 0; i < numberOfConfigs; i++)
+            {
+                static const EGLint attributes[] =
+                {
+                    EGL_CONFIG_ID, EGL_RED_SIZE, EGL_GREEN_SIZE, EGL_BLUE_SIZE, EGL_ALPHA_SIZE, EGL_DEPTH_SIZE,
+                    EGL_STENCIL_SIZE, EGL_SAMPLES, EGL_SURFACE_TYPE, EGL_RENDERABLE_TYPE, EGL_CONFIG_CAVEAT
+                };
+                EGLint values[sizeof(attributes) / sizeof(attributes[0])];
+
+                for (size_t attribute = 0; attribute < sizeof(attributes) / sizeof(attributes[0]); attribute++)
+                {
+                    values[attribute] = 0;
+                    eglGetConfigAttrib(display, eglConfigs[i], attributes[attribute], &values[attribute]);
+                }
+
+                Config config =
+                {
+                    values[0], values[1], values[2], values[3], values[4], values[5],
+                    values[6], values[7], values[8], values[9], values[10]
+                };
+                configs.push_back(config);
+            }
+        }
+        /* [Probe EGL configs] */
+
+        /* [Probe extensions and limits] */
+        GLint numberOfExtensions = 0;
+        GL_CHECK(glGetIntegerv(GL_NUM_EXTENSIONS, &numberOfExtensions));
+        extensions.clear();
+        for (GLint i = 0; i < numberOfExtensions; i++)
+        {
+            const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+            if (extension != NULL)
+            {
+                extensions.push_back(extension);
+            }
+        }
+
+        GLint major = 0;
+        GLint minor = 0;
+        GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &major));
+        GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minor));
+
+        limits.clear();
+        queryLimits(limits30, sizeof(limits30) / sizeof(limits30[0]), limits);
+        if (major > 3 || (major == 3 && minor >= 1))
+        {
+            queryLimits(limits31, sizeof(limits31) / sizeof(limits31[0]), limits);
+        }
+
+        GLint numberOfFormats = 0;
+        GL_CHECK(glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &numberOfFormats));
+        compressedFormats.assign(numberOfFormats, 0);
+        if (numberOfFormats > 0)
+        {
+            GL_CHECK(glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, &compressedFormats[0]));
+        }
+        /* [Probe extensions and limits] */
+    }
+
+    void DeviceCapabilities::addBenchmarkResults(const MicroBenchmarkSuite &suite)
+    {
+        for (size_t i = 0; i < suite.getCount(); i++)
+        {
+            const MicroBenchmarkSuite::Result &result = suite.getResult(i);
+            if (!result.finished)
+            {
+                continue;
+            }
+
+            BenchmarkResult benchmarkResult;
+            benchmarkResult.name = suite.getBenchmark(i)->getName();
+            benchmarkResult.unit = suite.getBenchmark(i)->getUnit();
+            benchmarkResult.supported = result.supported;
+            benchmarkResult.perSecond = result.getRate();
+
+            size_t existing = 0;
+            while (existing < benchmarkResults.size() && benchmarkResults[existing].name != benchmarkResult.name)
+            {
+                existing++;
+            }
+
+            if (existing < benchmarkResults.size())
+            {
+                benchmarkResults[existing] = benchmarkResult;
+            }
+            else
+            {
+                benchmarkResults.push_back(benchmarkResult);
+            }
+        }
+    }
+
+    bool DeviceCapabilities::save(const char *filename) const
+    {
+        FILE *file = fopen(filename, "w");
+        if (file == NULL)
+        {
+            LOGE("Could not open %s for writing.\n", filename);
+            return false;
+        }
+
+        fprintf(file, "{\n  \"renderer\": ");
+        writeString(file, renderer);
+        fprintf(file, ",\n  \"vendor\": ");
+        writeString(file, vendor);
+        fprintf(file, ",\n  \"gl_version\": ");
+        writeString(file, version);
+        fprintf(file, ",\n  \"glsl_version\": ");
+        writeString(file, shadingLanguageVersion);
+        fprintf(file, ",\n  \"egl_vendor\": ");
+        writeString(file, eglVendor);
+        fprintf(file, ",\n  \"egl_version\": ");
+        writeString(file, eglVersion);
+
+        fprintf(file, ",\n  \"egl_configs\": [");
+        for (size_t i = 0; i < configs.size(); i++)
+        {
+            const Config &config = configs[i];
+            fprintf(file, "%s\n    { \"id\": %d, \"red\": %d, \"green\": %d, \"blue\": %d, \"alpha\": %d, \"depth\": %d, \"stencil\": %d, "
+                    "\"samples\": %d, \"surface_type\": %d, \"renderable_type\": %d, \"caveat\": %d }",
+                    i > 0 ? "," : "", config.id, config.red, config.green, config.blue, config.alpha, config.depth, config.stencil,
+                    config.samples, config.surfaceType, config.renderableType, config.caveat);
+        }
+
+        fprintf(file, "\n  ],\n  \"extensions\": [");
+        for (size_t i = 0; i < extensions.size(); i++)
+        {
+            fprintf(file, "%s\n    ", i > 0 ? "," : "");
+            writeString(file, extensions[i]);
+        }
+
+        fprintf(file, "\n  ],\n  \"limits\": {");
+        for (size_t i = 0; i < limits.size(); i++)
+        {
+            fprintf(file, "%s\n    ", i > 0 ? "," : "");
+            writeString(file, limits[i].name);
+            fprintf(file, ": [");
+            for (size_t value = 0; value < limits[i].values.size(); value++)
+            {
+                fprintf(file, "%s%lld", value > 0 ? ", " : "", limits[i].values[value]);
+            }
+            fprintf(file, "]");
+        }
+
+        fprintf(file, "\n  },\n  \"compressed_formats\": [");
+        for (size_t i = 0; i < compressedFormats.size(); i++)
+        {
+            fprintf(file, "%s%d", i > 0 ? ", " : "", compressedFormats[i]);
+        }
+
+        fprintf(file, "],\n  \"benchmarks\": {");
+        for (size_t i = 0; i < benchmarkResults.size(); i++)
+        {
+            const BenchmarkResult &result = benchmarkResults[i];
+
+            fprintf(file, "%s\n    ", i > 0 ? "," : "");
+            writeString(file, result.name);
+            fprintf(file, ": { \"unit\": ");
+            writeString(file, result.unit);
+            fprintf(file, ", \"supported\": %s, \"per_second\": %.1f }", result.supported ? "true" : "false", result.perSecond);
+        }
+        fprintf(file, "\n  }\n}\n");
+
+        bool written = (ferror(file) == 0);
+        fclose(file);
+
+        return written;
+    }
+
+    bool DeviceCapabilities::load(const char *filename)
+    {
+        FILE *file = fopen(filename, "rb");
+        if (file == NULL)
+        {
+            return false;
+        }
+
+        string contents;
+        char buffer[4096];
+        size_t length;
+        while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            contents.append(buffer, length);
+        }
+        fclose(file);
+
+        JsonValue root;
+        if (!JsonValue::parse(contents.c_str(), root) || root.type != JsonValue::Object)
+        {
+            LOGE("Could not parse the capabilities in %s.\n", filename);
+            return false;
+        }
+
+        /* [Check the report against the driver] */
+        if (root.getString("renderer") != getGLString(GL_RENDERER) || root.getString("gl_version") != getGLString(GL_VERSION))
+        {
+            LOGI("The capabilities in %s were recorded with another renderer or driver version.\n", filename);
+            return false;
+        }
+        /* [Check the report against the driver] */
+
+        DeviceCapabilities loaded;
+        loaded.renderer = root.getString("renderer");
+        loaded.vendor = root.getString("vendor");
+        loaded.version = root.getString("gl_version");
+        loaded.shadingLanguageVersion = root.getString("glsl_version");
+        loaded.eglVendor = root.getString("egl_vendor");
+        loaded.eglVersion = root.getString("egl_version");
+
+        const JsonValue *value = root.get("egl_configs");
+        for (size_t i = 0; value != NULL && i < value->items.size(); i++)
+        {
+            const JsonValue &item = value->items[i];
+            Config config =
+            {
+                (int)item.getNumber("id"), (int)item.getNumber("red"), (int)item.getNumber("green"),
+                (int)item.getNumber("blue"), (int)item.getNumber("alpha"), (int)item.getNumber("depth"),
+                (int)item.getNumber("stencil"), (int)item.getNumber("samples"), (int)item.getNumber("surface_type"),
+                (int)item.getNumber("renderable_type"), (int)item.getNumber("caveat")
+            };
+            loaded.configs.push_back(config);
+        }
+
+        value = root.get("extensions");
+        for (size_t i = 0; value != NULL && i < value->items.size(); i++)
+        {
+            loaded.extensions.push_back(value->items[i].text);
+        }
+
+        value = root.get("limits");
+        for (size_t i = 0; value != NULL && i < value->items.size(); i++)
+        {
+            Limit limit;
+            limit.name = value->keys[i];
+            for (size_t item = 0; item < value->items[i].items.size(); item++)
+            {
+                limit.values.push_back((long long)value->items[i].items[item].number);
+            }
+            loaded.limits.push_back(limit);
+        }
+
+        value = root.get("compressed_formats");
+        for (size_t i = 0; value != NULL && i < value->items.size(); i++)
+        {
+            loaded.compressedFormats.push_back((GLint)value->items[i].number);
+        }
+
+        value = root.get("benchmarks");
+        for (size_t i = 0; value != NULL && i < value->items.size(); i++)
+        {
+            const JsonValue &item = value->items[i];
+            const JsonValue *supported = item.get("supported");
+            BenchmarkResult result;
+
+            result.name = value->keys[i];
+            result.unit = item.getString("unit");
+            result.supported = supported != NULL && supported->boolean;
+            result.perSecond = item.getNumber("per_second");
+            loaded.benchmarkResults.push_back(result);
+        }
+
+        *this = loaded;
+
+        return true;
+    }
+
+    bool DeviceCapabilities::loadOrProbe(const char *filename)
+    {
+        if (load(filename))
+        {
+            return true;
+        }
+
+        probe();
+        save(filename);
+
+        return false;
+    }
+
+    const string &DeviceCapabilities::getRenderer(void) const
+    {
+        return renderer;
+    }
+
+    const string &DeviceCapabilities::getVersion(void) const
+    {
+        return version;
+    }
+
+    bool DeviceCapabilities::hasExtension(const char *extension) const
+    {
+        for (size_t i = 0; i < extensions.size(); i++)
+        {
+            if (extensions[i] == extension)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    long long DeviceCapabilities::getLimit(const char *name, int index) const
+    {
+        for (size_t i = 0; i < limits.size(); i++)
+        {
+            if (limits[i].name == name)
+            {
+                return index >= 0 && (size_t)index < limits[i].values.size() ? limits[i].values[index] : 0;
+            }
+        }
+
+        return 0;
+    }
+
+    bool DeviceCapabilities::isCompressedFormatSupported(GLenum internalFormat) const
+    {
+        for (size_t i = 0; i < compressedFormats.size(); i++)
+        {
+            if ((GLenum)compressedFormats[i] == internalFormat)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    double DeviceCapabilities::getBenchmarkRate(const char *name) const
+    {
+        for (size_t i = 0; i < benchmarkResults.size(); i++)
+        {
+            if (benchmarkResults[i].name == name)
+            {
+                return benchmarkResults[i].supported ? benchmarkResults[i].perSecond : 0.0;
+            }
+        }
+
+        return 0.0;
+    }
+
+    bool DeviceCapabilities::supportsHalfFloatRendering(void) const
+    {
+        return hasExtension("GL_EXT_color_buffer_half_float") || hasExtension("GL_EXT_color_buffer_float");
+    }
+
+    bool DeviceCapabilities::supportsASTC(void) const
+    {
+        return hasExtension("GL_KHR_texture_compression_astc_ldr");
+    }
+
+    bool DeviceCapabilities::supportsPixelLocalStorage(void) const
+    {
+        return hasExtension("GL_EXT_shader_pixel_local_storage");
+    }
+
+    bool DeviceCapabilities::supportsMultiview(void) const
+    {
+        return hasExtension("GL_OVR_multiview");
+    }
+
+    const vector<DeviceCapabilities::Config> &DeviceCapabilities::getConfigs(void) const
+    {
+        return configs;
+    }
+
+    const vector<string> &DeviceCapabilities::getExtensions(void) const
+    {
+        return extensions;
+    }
+
+    const vector<DeviceCapabilities::Limit> &DeviceCapabilities::getLimits(void) const
+    {
+        return limits;
+    }
+
+    const vector<GLint> &DeviceCapabilities::getCompressedFormats(void) const
+    {
+        return compressedFormats;
+    }
+
+    const vector<DeviceCapabilities::BenchmarkResult> &DeviceCapabilities::getBenchmarkResults(void) const
+    {
+        return benchmarkResults;
+    }
+}
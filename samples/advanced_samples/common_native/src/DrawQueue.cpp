@@ -0,0 +1,228 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "DrawQueue.h"
+#include "Platform.h"
+
+#include <cstring>
+
+namespace MaliSDK
+{
+    static const unsigned long long depthBits = 24;
+    static const unsigned long long nameBits = 12;
+
+    static bool isSameDraw(const DrawQueue::Draw &a, const DrawQueue::Draw &b)
+    {
+        return a.program == b.program && a.texture == b.texture && a.vertexArray == b.vertexArray &&
+               a.mode == b.mode && a.indexType == b.indexType && a.count == b.count && a.first == b.first;
+    }
+
+    DrawQueue::DrawQueue(GLuint instanceLocation, unsigned int vec4sPerInstance, unsigned int maxDraws, unsigned int flushesInFlight)
+        : instanceLocation(instanceLocation),
+          vec4sPerInstance(vec4sPerInstance),
+          maxDraws(maxDraws),
+          instanceStream(GL_ARRAY_BUFFER, maxDraws * vec4sPerInstance * 4 * sizeof(float), flushesInFlight),
+          submittedDraws(0),
+          drawCalls(0),
+          stateChanges(0)
+    {
+        submissions.reserve(maxDraws);
+        instanceData.reserve(maxDraws * vec4sPerInstance * 4);
+        order.reserve(maxDraws);
+        scratch.reserve(maxDraws);
+    }
+
+    unsigned long long DrawQueue::makeKey(unsigned int pass, GLuint program, GLuint texture, GLuint vertexArray, float depth)
+    {
+        const unsigned long long nameMask = (1ull << nameBits) - 1;
+        const unsigned long long depthMax = (1ull << depthBits) - 1;
+
+        depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+
+        return ((unsigned long long)(pass & 0xF) << 60) |
+               ((program & nameMask) << (depthBits + 2 * nameBits)) |
+               ((texture & nameMask) << (depthBits + nameBits)) |
+               ((vertexArray & nameMask) << depthBits) |
+               (unsigned long long)(depth * depthMax);
+    }
+
+    void DrawQueue::submit(unsigned long long key, const Draw &draw, const float *instance)
+    {
+        if (submissions.size() >= maxDraws)
+        {
+            LOGE("Draw queue is full, %u draws were submitted since the last flush.", maxDraws);
+            return;
+        }
+
+        Submission submission = { key, draw };
+        submissions.push_back(submission);
+        instanceData.insert(instanceData.end(), instance, instance + vec4sPerInstance * 4);
+    }
+
+    void DrawQueue::radixSort(void)
+    {
+        unsigned int count = submissions.size();
+        scratch.resize(count);
+
+        /* Least significant byte first, stable, so the order of draws with the same key is kept. */
+        for (unsigned int shift = 0; shift < 64; shift += 8)
+        {
+            unsigned int histogram[257] = { 0 };
+
+            for (unsigned int i = 0; i < count; i++)
+            {
+                histogram[((submissions[i].key >> shift) & 0xFF) + 1]++;
+            }
+
+            /* Nothing to do if every key has the same byte, as is usual for the pass and the high name bits. */
+            if (histogram[((submissions[0].key >> shift) & 0xFF) + 1] == count)
+            {
+                continue;
+            }
+
+            for (unsigned int digit = 1; digit < 257; digit++)
+            {
+                histogram[digit] += histogram[digit - 1];
+            }
+            for (unsigned int i = 0; i < count; i++)
+            {
+                unsigned int index = order[i];
+                scratch[histogram[(submissions[index].key >> shift) & 0xFF]++] = index;
+            }
+            order.swap(scratch);
+        }
+    }
+
+    void DrawQueue::flush(void)
+    {
+        unsigned int count = submissions.size();
+        const unsigned int floatsPerInstance = vec4sPerInstance * 4;
+        const GLsizei stride = floatsPerInstance * sizeof(float);
+
+        submittedDraws = count;
+        drawCalls = 0;
+        stateChanges = 0;
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        order.resize(count);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            order[i] = i;
+        }
+        radixSort();
+
+        /* The instance data goes to the stream in sorted order, so every merged run is contiguous. */
+        instanceStream.beginFrame();
+        GLintptr streamOffset = 0;
+        float *instances = static_cast<float*>(instanceStream.map(count * stride, &streamOffset));
+        if (instances == NULL)
+        {
+            submissions.clear();
+            instanceData.clear();
+            return;
+        }
+        for (unsigned int i = 0; i < count; i++)
+        {
+            memcpy(instances + i * floatsPerInstance, &instanceData[order[i] * floatsPerInstance], stride);
+        }
+        instanceStream.unmap();
+
+        const Draw *current = NULL;
+        unsigned int first = 0;
+        while (first < count)
+        {
+            const Draw &draw = submissions[order[first]].draw;
+            unsigned int last = first + 1;
+            while (last < count && isSameDraw(submissions[order[last]].draw, draw))
+            {
+                last++;
+            }
+
+            if (current == NULL || current->program != draw.program)
+            {
+                GL_CHECK(glUseProgram(draw.program));
+                stateChanges++;
+            }
+            if (draw.texture != 0 && (current == NULL || current->texture != draw.texture))
+            {
+                GL_CHECK(glActiveTexture(GL_TEXTURE0));
+                GL_CHECK(glBindTexture(GL_TEXTURE_2D, draw.texture));
+                stateChanges++;
+            }
+            if (current == NULL || current->vertexArray != draw.vertexArray)
+            {
+                GL_CHECK(glBindVertexArray(draw.vertexArray));
+                stateChanges++;
+            }
+            current = &draw;
+
+            /* The instance attributes point at the first instance of the run. */
+            GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, instanceStream.getBuffer()));
+            for (unsigned int column = 0; column < vec4sPerInstance; column++)
+            {
+                GLuint location = instanceLocation + column;
+                const GLintptr offset = streamOffset + first * stride + column * 4 * sizeof(float);
+
+                GL_CHECK(glEnableVertexAttribArray(location));
+                GL_CHECK(glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (const void *)offset));
+                GL_CHECK(glVertexAttribDivisor(location, 1));
+            }
+            GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+            GLsizei instanceCount = last - first;
+            if (draw.indexType != 0)
+            {
+                GL_CHECK(glDrawElementsInstanced(draw.mode, draw.count, draw.indexType, (const void *)draw.first, instanceCount));
+            }
+            else
+            {
+                GL_CHECK(glDrawArraysInstanced(draw.mode, (GLint)draw.first, draw.count, instanceCount));
+            }
+            drawCalls++;
+
+            first = last;
+        }
+
+        GL_CHECK(glBindVertexArray(0));
+        instanceStream.endFrame();
+
+        submissions.clear();
+        instanceData.clear();
+    }
+
+    unsigned int DrawQueue::getSubmittedDraws(void) const
+    {
+        return submittedDraws;
+    }
+
+    unsigned int DrawQueue::getDrawCalls(void) const
+    {
+        return drawCalls;
+    }
+
+    unsigned int DrawQueue::getStateChanges(void) const
+    {
+        return stateChanges;
+    }
+}
@@ -0,0 +1,193 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "DynamicResolution.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+
+#include <EGL/egl.h>
+#include <cmath>
+#include <cstring>
+
+/* GL_EXT_disjoint_timer_query, not part of the core headers. */
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+namespace MaliSDK
+{
+    /* Render sizes are rounded to whole tiles, so a small change of scale does not change the size every frame. */
+    static const GLsizei sizeGranularity = 16;
+
+    static GLsizei scaleSize(GLsizei maxSize, float scale)
+    {
+        GLsizei size = (GLsizei)(maxSize * scale) / sizeGranularity * sizeGranularity;
+
+        if (size < sizeGranularity)
+        {
+            size = sizeGranularity;
+        }
+
+        return size < maxSize ? size : maxSize;
+    }
+
+    DynamicResolution::DynamicResolution(GLsizei maxWidth, GLsizei maxHeight, float targetFrameTime, float minScale)
+        : supported(false),
+          getQueryObjectui64v(NULL),
+          queryIndex(0),
+          maxWidth(maxWidth),
+          maxHeight(maxHeight),
+          targetFrameTime(targetFrameTime),
+          minScale(minScale),
+          scale(1.0f),
+          averageFrameTime(0.0f)
+    {
+        if (GLExtensions::isSupported("GL_EXT_disjoint_timer_query"))
+        {
+            getQueryObjectui64v = (GetQueryObjectui64vFunction)eglGetProcAddress("glGetQueryObjectui64vEXT");
+            supported = (getQueryObjectui64v != NULL);
+        }
+
+        if (!supported)
+        {
+            LOGI("GL_EXT_disjoint_timer_query is not supported, dynamic resolution is disabled.\n");
+        }
+        else
+        {
+            GL_CHECK(glGenQueries(numberOfQueries, queries));
+        }
+
+        for (int index = 0; index < numberOfQueries; index++)
+        {
+            queryPending[index] = false;
+        }
+    }
+
+    DynamicResolution::~DynamicResolution(void)
+    {
+        if (supported)
+        {
+            GL_CHECK(glDeleteQueries(numberOfQueries, queries));
+        }
+    }
+
+    void DynamicResolution::collect(int index)
+    {
+        if (!queryPending[index])
+        {
+            return;
+        }
+
+        queryPending[index] = false;
+
+        /* Still not done after numberOfQueries frames, drop it rather than stalling. */
+        GLuint available = 0;
+        GL_CHECK(glGetQueryObjectuiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available));
+        if (!available)
+        {
+            return;
+        }
+
+        /* The result is meaningless if something like a frequency change happened while it was recorded. */
+        GLint disjoint = 0;
+        GL_CHECK(glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint));
+        if (disjoint)
+        {
+            return;
+        }
+
+        GLuint64 elapsed = 0;
+        GL_CHECK(getQueryObjectui64v(queries[index], GL_QUERY_RESULT, &elapsed));
+
+        /* The time was measured at the scale in use when it was recorded, which may be a few frames old. That is close enough as the scale changes slowly. */
+        float frameTime = elapsed * 1e-6f;
+        averageFrameTime = (averageFrameTime == 0.0f) ? frameTime : averageFrameTime * 0.9f + frameTime * 0.1f;
+
+        if (frameTime <= 0.0f)
+        {
+            return;
+        }
+
+        /* Cost is proportional to the number of pixels, so to the square of the scale. */
+        float idealScale = scale * sqrtf(targetFrameTime / frameTime);
+        float rate = (idealScale < scale) ? 0.5f : 0.05f;
+
+        scale += (idealScale - scale) * rate;
+        scale = (scale < minScale) ? minScale : (scale > 1.0f ? 1.0f : scale);
+    }
+
+    void DynamicResolution::beginFrame(void)
+    {
+        if (!supported)
+        {
+            return;
+        }
+
+        /* The query about to be reused was issued numberOfQueries frames ago. */
+        queryIndex = (queryIndex + 1) % numberOfQueries;
+        collect(queryIndex);
+
+        GL_CHECK(glBeginQuery(GL_TIME_ELAPSED_EXT, queries[queryIndex]));
+    }
+
+    void DynamicResolution::endFrame(void)
+    {
+        if (!supported)
+        {
+            return;
+        }
+
+        GL_CHECK(glEndQuery(GL_TIME_ELAPSED_EXT));
+        queryPending[queryIndex] = true;
+    }
+
+    float DynamicResolution::getScale(void) const
+    {
+        return scale;
+    }
+
+    GLsizei DynamicResolution::getWidth(void) const
+    {
+        return scaleSize(maxWidth, scale);
+    }
+
+    GLsizei DynamicResolution::getHeight(void) const
+    {
+        return scaleSize(maxHeight, scale);
+    }
+
+    float DynamicResolution::getTexCoordScaleX(void) const
+    {
+        return (float)getWidth() / maxWidth;
+    }
+
+    float DynamicResolution::getTexCoordScaleY(void) const
+    {
+        return (float)getHeight() / maxHeight;
+    }
+
+    float DynamicResolution::getAverageFrameTime(void) const
+    {
+        return averageFrameTime;
+    }
+}
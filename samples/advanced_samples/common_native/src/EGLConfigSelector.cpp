@@ -0,0 +1,291 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "EGLConfigSelector.h"
+#include "Platform.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/* EGL_ANDROID_recordable, not part of the core headers. */
+#ifndef EGL_RECORDABLE_ANDROID
+#define EGL_RECORDABLE_ANDROID 0x3142
+#endif
+
+using std::string;
+using std::vector;
+
+namespace MaliSDK
+{
+    string EGLConfigSelector::cacheDirectory;
+
+    /* Identifies the cache file layout: magic, key, config ID. */
+    static const unsigned int cacheFileMagic = 0x43474543; /* "CEGC" */
+
+    /* 64-bit FNV-1a, as used by ProgramBinaryCache. */
+    static unsigned long long hashBytes(unsigned long long hash, const void *data, size_t length)
+    {
+        const unsigned char *bytes = (const unsigned char *)data;
+
+        for (size_t index = 0; index < length; index++)
+        {
+            hash ^= bytes[index];
+            hash *= 0x100000001b3ULL;
+        }
+
+        return hash;
+    }
+
+    static EGLint getAttribute(EGLDisplay display, EGLConfig config, EGLint attribute)
+    {
+        EGLint value = 0;
+
+        if (!eglGetConfigAttrib(display, config, attribute, &value))
+        {
+            return 0;
+        }
+
+        return value;
+    }
+
+    EGLConfigSelector::Requirements::Requirements(void)
+        : redSize(8),
+          greenSize(8),
+          blueSize(8),
+          alphaSize(0),
+          depthSize(16),
+          stencilSize(0),
+          samples(0),
+          renderableType(EGL_OPENGL_ES2_BIT),
+          surfaceType(EGL_WINDOW_BIT),
+          recordable(false),
+          exactColor(true)
+    {
+    }
+
+    void EGLConfigSelector::setCacheDirectory(const char *directory)
+    {
+        cacheDirectory = (directory != NULL) ? directory : "";
+    }
+
+    int EGLConfigSelector::scoreConfig(EGLDisplay display, EGLConfig config, const Requirements &requirements)
+    {
+        EGLint redSize = getAttribute(display, config, EGL_RED_SIZE);
+        EGLint greenSize = getAttribute(display, config, EGL_GREEN_SIZE);
+        EGLint blueSize = getAttribute(display, config, EGL_BLUE_SIZE);
+        EGLint alphaSize = getAttribute(display, config, EGL_ALPHA_SIZE);
+        EGLint depthSize = getAttribute(display, config, EGL_DEPTH_SIZE);
+        EGLint stencilSize = getAttribute(display, config, EGL_STENCIL_SIZE);
+        EGLint samples = getAttribute(display, config, EGL_SAMPLES);
+        EGLint renderableType = getAttribute(display, config, EGL_RENDERABLE_TYPE);
+        EGLint surfaceType = getAttribute(display, config, EGL_SURFACE_TYPE);
+        EGLint caveat = getAttribute(display, config, EGL_CONFIG_CAVEAT);
+
+        /* Hard requirements. */
+        if ((renderableType & requirements.renderableType) != requirements.renderableType ||
+            (surfaceType & requirements.surfaceType) != requirements.surfaceType ||
+            getAttribute(display, config, EGL_COLOR_BUFFER_TYPE) != EGL_RGB_BUFFER ||
+            redSize < requirements.redSize || greenSize < requirements.greenSize || blueSize < requirements.blueSize ||
+            alphaSize < requirements.alphaSize || depthSize < requirements.depthSize || stencilSize < requirements.stencilSize)
+        {
+            return -1;
+        }
+
+        if (requirements.exactColor &&
+            (redSize != requirements.redSize || greenSize != requirements.greenSize || blueSize != requirements.blueSize))
+        {
+            return -1;
+        }
+
+        /* An extension attribute, unknown attributes make eglGetConfigAttrib() fail, which reads as not recordable. */
+        if (requirements.recordable && getAttribute(display, config, EGL_RECORDABLE_ANDROID) != EGL_TRUE)
+        {
+            return -1;
+        }
+
+        /* Every unrequested bit costs bandwidth, depending on how often the buffer is touched. */
+        int score = 1000;
+
+        score -= 10 * ((redSize - requirements.redSize) + (greenSize - requirements.greenSize) + (blueSize - requirements.blueSize));
+        score -= 10 * (alphaSize - requirements.alphaSize);
+        score -= 5 * (depthSize - requirements.depthSize);
+        score -= 5 * (stencilSize - requirements.stencilSize);
+
+        /* Exactly the requested samples, otherwise the closest, more being better than fewer. */
+        if (samples != requirements.samples)
+        {
+            score -= (samples > requirements.samples) ? 100 + 10 * (samples - requirements.samples) : 200 + 20 * (requirements.samples - samples);
+        }
+
+        if (caveat == EGL_SLOW_CONFIG)
+        {
+            score -= 500;
+        }
+        else if (caveat == EGL_NON_CONFORMANT_CONFIG)
+        {
+            score -= 250;
+        }
+
+        /* Keep valid configs above the rejection value. */
+        return score > 0 ? score : 0;
+    }
+
+    unsigned long long EGLConfigSelector::computeKey(EGLDisplay display, const Requirements &requirements)
+    {
+        unsigned long long hash = 0xcbf29ce484222325ULL;
+        const char *strings[] = { eglQueryString(display, EGL_VENDOR), eglQueryString(display, EGL_VERSION) };
+
+        for (int stringIndex = 0; stringIndex < 2; stringIndex++)
+        {
+            const char *string = strings[stringIndex] != NULL ? strings[stringIndex] : "";
+
+            /* Include the terminator so the two strings can't shift into each other. */
+            hash = hashBytes(hash, string, strlen(string) + 1);
+        }
+
+        const EGLint values[] =
+        {
+            requirements.redSize, requirements.greenSize, requirements.blueSize, requirements.alphaSize,
+            requirements.depthSize, requirements.stencilSize, requirements.samples,
+            requirements.renderableType, requirements.surfaceType,
+            requirements.recordable ? 1 : 0, requirements.exactColor ? 1 : 0
+        };
+
+        return hashBytes(hash, values, sizeof(values));
+    }
+
+    EGLConfig EGLConfigSelector::loadConfig(EGLDisplay display, const Requirements &requirements, unsigned long long key)
+    {
+        if (cacheDirectory.empty())
+        {
+            return NULL;
+        }
+
+        string path = cacheDirectory + "eglconfig.cache";
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == NULL)
+        {
+            return NULL;
+        }
+
+        unsigned int magic = 0;
+        unsigned long long storedKey = 0;
+        EGLint configId = 0;
+        bool valid = fread(&magic, sizeof(magic), 1, file) == 1 &&
+                     fread(&storedKey, sizeof(storedKey), 1, file) == 1 &&
+                     fread(&configId, sizeof(configId), 1, file) == 1 &&
+                     magic == cacheFileMagic && storedKey == key;
+        fclose(file);
+
+        if (!valid)
+        {
+            return NULL;
+        }
+
+        const EGLint attributes[] = { EGL_CONFIG_ID, configId, EGL_NONE };
+        EGLConfig config = NULL;
+        EGLint numberOfConfigs = 0;
+
+        /* The key covers the driver version, but make sure the config still qualifies anyway. */
+        if (!eglChooseConfig(display, attributes, &config, 1, &numberOfConfigs) || numberOfConfigs != 1 ||
+            scoreConfig(display, config, requirements) < 0)
+        {
+            return NULL;
+        }
+
+        return config;
+    }
+
+    void EGLConfigSelector::storeConfig(EGLDisplay display, EGLConfig config, unsigned long long key)
+    {
+        if (cacheDirectory.empty())
+        {
+            return;
+        }
+
+        string path = cacheDirectory + "eglconfig.cache";
+        FILE *file = fopen(path.c_str(), "wb");
+        if (file == NULL)
+        {
+            LOGI("Could not write the EGL config cache %s.\n", path.c_str());
+            return;
+        }
+
+        EGLint configId = getAttribute(display, config, EGL_CONFIG_ID);
+        bool written = fwrite(&cacheFileMagic, sizeof(cacheFileMagic), 1, file) == 1 &&
+                       fwrite(&key, sizeof(key), 1, file) == 1 &&
+                       fwrite(&configId, sizeof(configId), 1, file) == 1;
+
+        fclose(file);
+
+        /* A partial file would never load, but don't leave it around. */
+        if (!written)
+        {
+            remove(path.c_str());
+        }
+    }
+
+    EGLConfig EGLConfigSelector::chooseConfig(EGLDisplay display, const Requirements &requirements)
+    {
+        unsigned long long key = computeKey(display, requirements);
+        EGLConfig bestConfig = loadConfig(display, requirements, key);
+
+        if (bestConfig != NULL)
+        {
+            LOGD("Using cached EGL config %d.\n", getAttribute(display, bestConfig, EGL_CONFIG_ID));
+            return bestConfig;
+        }
+
+        EGLint numberOfConfigs = 0;
+        if (!eglGetConfigs(display, NULL, 0, &numberOfConfigs) || numberOfConfigs == 0)
+        {
+            return NULL;
+        }
+
+        vector<EGLConfig> configs(numberOfConfigs);
+        if (!eglGetConfigs(display, &configs[0], numberOfConfigs, &numberOfConfigs))
+        {
+            return NULL;
+        }
+
+        int bestScore = -1;
+
+        for (int configIndex = 0; configIndex < numberOfConfigs; configIndex++)
+        {
+            int score = scoreConfig(display, configs[configIndex], requirements);
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestConfig = configs[configIndex];
+            }
+        }
+
+        if (bestConfig != NULL)
+        {
+            LOGD("Chose EGL config %d out of %d, score %d.\n", getAttribute(display, bestConfig, EGL_CONFIG_ID), numberOfConfigs, bestScore);
+            storeConfig(display, bestConfig, key);
+        }
+
+        return bestConfig;
+    }
+}
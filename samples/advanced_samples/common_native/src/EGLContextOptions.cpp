@@ -0,0 +1,117 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "EGLContextOptions.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+
+#include <cstring>
+
+namespace MaliSDK
+{
+#if defined(NDEBUG)
+    static const bool noErrorInThisBuild = true;
+#else
+    static const bool noErrorInThisBuild = false;
+#endif
+
+    EGLContextOptions::EGLContextOptions(void)
+        : priority(0)
+        , noError(false)
+    {
+    }
+
+    EGLContextOptions EGLContextOptions::forRendering(void)
+    {
+        EGLContextOptions options;
+        options.priority = EGL_CONTEXT_PRIORITY_HIGH_IMG;
+        options.noError = noErrorInThisBuild;
+
+        return options;
+    }
+
+    EGLContextOptions EGLContextOptions::forWorker(void)
+    {
+        EGLContextOptions options;
+        options.priority = EGL_CONTEXT_PRIORITY_LOW_IMG;
+        options.noError = noErrorInThisBuild;
+
+        return options;
+    }
+
+    EGLContext EGLContextOptions::createContext(EGLDisplay display, EGLConfig config, EGLContext shareContext, EGLint clientVersion) const
+    {
+        bool usePriority = priority != 0 && GLExtensions::isEGLSupported(display, "EGL_IMG_context_priority");
+        bool useNoError = noError && GLExtensions::isEGLSupported(display, "EGL_KHR_create_context_no_error");
+        EGLContext context = EGL_NO_CONTEXT;
+
+        while (true)
+        {
+            EGLint attributes[7];
+            int count = 0;
+
+            attributes[count++] = EGL_CONTEXT_CLIENT_VERSION;
+            attributes[count++] = clientVersion;
+            if (usePriority)
+            {
+                attributes[count++] = EGL_CONTEXT_PRIORITY_LEVEL_IMG;
+                attributes[count++] = priority;
+            }
+            if (useNoError)
+            {
+                attributes[count++] = EGL_CONTEXT_OPENGL_NO_ERROR_KHR;
+                attributes[count++] = EGL_TRUE;
+            }
+            attributes[count] = EGL_NONE;
+
+            context = eglCreateContext(display, config, shareContext, attributes);
+            if (context != EGL_NO_CONTEXT)
+            {
+                break;
+            }
+
+            /* No-error has to match the share context, try that first, then without the priority. */
+            if (useNoError)
+            {
+                useNoError = false;
+            }
+            else if (usePriority)
+            {
+                usePriority = false;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if (context != EGL_NO_CONTEXT && usePriority)
+        {
+            EGLint grantedPriority = priority;
+            eglQueryContext(display, context, EGL_CONTEXT_PRIORITY_LEVEL_IMG, &grantedPriority);
+            if (grantedPriority != priority)
+            {
+                LOGD("Asked for context priority 0x%x, got 0x%x.\n", (unsigned int)priority, (unsigned int)grantedPriority);
+            }
+        }
+
+        return context;
+    }
+}
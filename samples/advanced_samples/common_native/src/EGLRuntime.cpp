@@ -20,6 +20,9 @@
 
 #include "EGLRuntime.h"
 #include "Platform.h"
+#include "EGLConfigSelector.h"
+#include "GPUMemory.h"
+#include "StartupProfiler.h"
 
 #include <cstdlib>
 
@@ -31,6 +34,8 @@ namespace MaliSDK
     EGLContext EGLRuntime::context;
     EGLSurface EGLRuntime::surface;
     EGLConfig EGLRuntime::config;
+    bool EGLRuntime::recordable = false;
+    EGLContextOptions EGLRuntime::contextOptions = EGLContextOptions::forRendering();
 
     EGLint EGLRuntime::configAttributes[] =
     {
@@ -84,144 +89,47 @@ namespace MaliSDK
 
     EGLConfig EGLRuntime::findConfig(bool strictMatch)
     {
-        EGLConfig *configsArray = NULL;
-        EGLint numberOfConfigs = 0;
-        EGLBoolean success = EGL_FALSE;
-
-        /* Enumerate available EGL configurations which match or exceed our required attribute list. */
-        success = eglChooseConfig(display, configAttributes, NULL, 0, &numberOfConfigs);
-        if(success != EGL_TRUE)
-        {
-            EGLint error = eglGetError();
-            LOGE("eglGetError(): %i (0x%.4x)\n", (int)error, (int)error);
-            LOGE("Failed to enumerate EGL configs at %s:%i\n", __FILE__, __LINE__);
-            exit(1);
-        }
+        EGLConfigSelector::Requirements requirements;
+
+        requirements.samples = (configAttributes[1] == EGL_DONT_CARE) ? 0 : configAttributes[1];
+        requirements.alphaSize = configAttributes[3];
+        requirements.redSize = configAttributes[5];
+        requirements.greenSize = configAttributes[7];
+        requirements.blueSize = configAttributes[9];
+        requirements.stencilSize = configAttributes[13];
+        requirements.renderableType = configAttributes[15];
+        requirements.surfaceType = configAttributes[17];
+        requirements.depthSize = configAttributes[19];
+        requirements.recordable = recordable;
 
-        LOGD("Number of configs found is %d\n", numberOfConfigs);
-
-        if (numberOfConfigs == 0)
-        {
-            LOGD("Disabling AntiAliasing to try and find a config.\n");
-            configAttributes[1] = EGL_DONT_CARE;
-            success = eglChooseConfig(display, configAttributes, NULL, 0, &numberOfConfigs);
-            if(success != EGL_TRUE)
-            {
-                EGLint error = eglGetError();
-                LOGE("eglGetError(): %i (0x%.4x)\n", (int)error, (int)error);
-                LOGE("Failed to enumerate EGL configs at %s:%i\n", __FILE__, __LINE__);
-                exit(1);
-            }
-
-            if (numberOfConfigs == 0)
-            {
-                LOGE("No configs found with the requested attributes.\n");
-                exit(1);
-            }
-            else
-            {
-                LOGD("Configs found when antialiasing disabled.\n ");
-            }
-        }
+        /*
+         * A strict match requires the exact color depth.
+         * Note: This is necessary, since EGL considers a higher color depth than requested to be 'better'
+         * even though this may force the driver to use a slow color conversion blitting routine.
+         * The number of samples is only a preference, a config with the closest number is used if none matches.
+         */
+        requirements.exactColor = strictMatch;
 
-        /* Allocate space for all EGL configs available and get them. */
-        configsArray = (EGLConfig *)calloc(numberOfConfigs, sizeof(EGLConfig));
-        if(configsArray == NULL)
-        {
-            LOGE("Out of memory at %s:%i\n", __FILE__, __LINE__);
-            exit(1);
-        }
-        success = eglChooseConfig(display, configAttributes, configsArray, numberOfConfigs, &numberOfConfigs);
-        if(success != EGL_TRUE)
+        EGLConfig configToReturn = EGLConfigSelector::chooseConfig(display, requirements);
+        if (configToReturn == NULL)
         {
-            EGLint error = eglGetError();
-            LOGE("eglGetError(): %i (0x%.4x)\n", (int)error, (int)error);
-            LOGE("Failed to enumerate EGL configs at %s:%i\n", __FILE__, __LINE__);
+            LOGE("Failed to find matching EGL config at %s:%i\n", __FILE__, __LINE__);
             exit(1);
         }
 
-        bool matchFound = false;
-        int matchingConfig = -1;
-
-        if (strictMatch)
-        {
-            /*
-             * Loop through the EGL configs to find a color depth match.
-             * Note: This is necessary, since EGL considers a higher color depth than requested to be 'better'
-             * even though this may force the driver to use a slow color conversion blitting routine. 
-             */
-            EGLint redSize = configAttributes[5];
-            EGLint greenSize = configAttributes[7];
-            EGLint blueSize = configAttributes[9];
-
-            for(int configsIndex = 0; (configsIndex < numberOfConfigs) && !matchFound; configsIndex++)
-            {
-                EGLint attributeValue = 0;
-
-                success = eglGetConfigAttrib(display, configsArray[configsIndex], EGL_RED_SIZE, &attributeValue);
-                if(success != EGL_TRUE)
-                {
-                    EGLint error = eglGetError();
-                    LOGE("eglGetError(): %i (0x%.4x)\n", (int)error, (int)error);
-                    LOGE("Failed to get EGL attribute at %s:%i\n", __FILE__, __LINE__);
-                    exit(1);
-                }
-
-                if(attributeValue == redSize)
-                {
-                    success = eglGetConfigAttrib(display, configsArray[configsIndex], EGL_GREEN_SIZE, &attributeValue);
-                    if(success != EGL_TRUE)
-                    {
-                        EGLint error = eglGetError();
-                        LOGE("eglGetError(): %i (0x%.4x)\n", (int)error, (int)error);
-                        LOGE("Failed to get EGL attribute at %s:%i\n", __FILE__, __LINE__);
-                        exit(1);
-                    }
-
-                    if(attributeValue == greenSize)
-                    {
-                        success = eglGetConfigAttrib(display, configsArray[configsIndex], EGL_BLUE_SIZE, &attributeValue);
-                        if(success != EGL_TRUE)
-                        {
-                            EGLint error = eglGetError();
-                            LOGE("eglGetError(): %i (0x%.4x)\n", (int)error, (int)error);
-                            LOGE("Failed to get EGL attribute at %s:%i\n", __FILE__, __LINE__);
-                            exit(1);
-                        }
-
-                        if(attributeValue == blueSize) 
-                        {
-                            matchFound = true;
-                            matchingConfig = configsIndex;
-                        }
-                    }
-                }
-            }
-        }
-        else
-        {
-            /* If not strict we can use any matching config. */
-            matchingConfig = 0;
-            matchFound = true;
-        }
-
-        if(!matchFound)
+        EGLint samples = 0;
+        eglGetConfigAttrib(display, configToReturn, EGL_SAMPLES, &samples);
+        if (samples != requirements.samples)
         {
-            LOGE("Failed to find matching EGL config at %s:%i\n", __FILE__, __LINE__);
-            exit(1);
+            LOGD("No config with %d samples, using %d.\n", requirements.samples, samples);
         }
 
-        /* Return the matching config. */
-        EGLConfig configToReturn = configsArray[matchingConfig];
-
-        free(configsArray);
-        configsArray = NULL;
-
         return configToReturn;
     }
 
     void EGLRuntime::initializeEGL(OpenGLESVersion requestedAPIVersion)
     {
+        STARTUP_PHASE(PHASE_EGL);
         EGLBoolean success = EGL_FALSE;
 
 #if defined(_WIN32)
@@ -306,7 +214,7 @@ namespace MaliSDK
         /* Unconditionally bind to OpenGL ES API as we exit this function, since it's the default. */
         eglBindAPI(EGL_OPENGL_ES_API);
 
-        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        context = contextOptions.createContext(display, config, EGL_NO_CONTEXT, contextAttributes[1]);
         if(context == EGL_NO_CONTEXT)
         {
             EGLint error = eglGetError();
@@ -321,11 +229,29 @@ namespace MaliSDK
         configAttributes[1] = requiredEGLSamples;
     }
 
+    void EGLRuntime::setRecordable(bool requireRecordable)
+    {
+        recordable = requireRecordable;
+    }
+
+    void EGLRuntime::setContextOptions(const EGLContextOptions &options)
+    {
+        contextOptions = options;
+    }
+
     void EGLRuntime::terminateEGL(void)
     {
         /* Shut down EGL. */
         eglBindAPI(EGL_OPENGL_ES_API);
         eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+
+        /* Whatever is still alive now was never deleted by the sample. */
+        unsigned int leaks = GPUMemory::reportLeaks();
+        if (leaks > 0)
+        {
+            LOGE("%u GPU resources were not deleted before terminating EGL.\n", leaks);
+        }
+
         eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
         eglDestroyContext(display, context);
         eglDestroySurface(display, surface);
@@ -0,0 +1,103 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "EGLWorkerContext.h"
+#include "GLExtensions.h"
+
+/* EGL_KHR_no_config_context, not part of older headers. */
+#ifndef EGL_NO_CONFIG_KHR
+#define EGL_NO_CONFIG_KHR ((EGLConfig)0)
+#endif
+
+namespace MaliSDK
+{
+    bool EGLWorkerContext::create(EGLDisplay display, EGLContext shareContext, EGLSurface *surface, EGLContext *context,
+                                  const EGLContextOptions &options)
+    {
+        EGLint configId = 0;
+        EGLint clientVersion = 0;
+
+        *surface = EGL_NO_SURFACE;
+        *context = EGL_NO_CONTEXT;
+
+        if (shareContext == EGL_NO_CONTEXT ||
+            !eglQueryContext(display, shareContext, EGL_CONFIG_ID, &configId) ||
+            !eglQueryContext(display, shareContext, EGL_CONTEXT_CLIENT_VERSION, &clientVersion))
+        {
+            return false;
+        }
+
+        bool surfaceless = GLExtensions::isEGLSupported(display, "EGL_KHR_surfaceless_context");
+
+        /* A context without a config can only be made current without a surface. */
+        if (surfaceless && GLExtensions::isEGLSupported(display, "EGL_KHR_no_config_context"))
+        {
+            *context = options.createContext(display, EGL_NO_CONFIG_KHR, shareContext, clientVersion);
+            if (*context != EGL_NO_CONTEXT)
+            {
+                return true;
+            }
+        }
+
+        /* Use the same config as the share context so they can share objects. */
+        const EGLint configAttributes[] = { EGL_CONFIG_ID, configId, EGL_NONE };
+        EGLConfig config;
+        EGLint numberOfConfigs = 0;
+
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &numberOfConfigs) || numberOfConfigs != 1)
+        {
+            return false;
+        }
+
+        if (!surfaceless)
+        {
+            const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+
+            *surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+            if (*surface == EGL_NO_SURFACE)
+            {
+                return false;
+            }
+        }
+
+        *context = options.createContext(display, config, shareContext, clientVersion);
+        if (*context == EGL_NO_CONTEXT)
+        {
+            destroy(display, *surface, EGL_NO_CONTEXT);
+            *surface = EGL_NO_SURFACE;
+            return false;
+        }
+
+        return true;
+    }
+
+    void EGLWorkerContext::destroy(EGLDisplay display, EGLSurface surface, EGLContext context)
+    {
+        if (context != EGL_NO_CONTEXT)
+        {
+            eglDestroyContext(display, context);
+        }
+
+        if (surface != EGL_NO_SURFACE)
+        {
+            eglDestroySurface(display, surface);
+        }
+    }
+}
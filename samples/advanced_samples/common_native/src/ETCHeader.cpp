@@ -68,7 +68,8 @@ namespace MaliSDK
 #if GLES_VERSION == 2
     GLsizei ETCHeader::getSize(GLenum internalFormat)
     {
-        return (getPaddedWidth() * getPaddedHeight());
+        /* ETC1 has 4 bits per pixel. */
+        return (getPaddedWidth() * getPaddedHeight()) >> 1;
     }
 #elif GLES_VERSION == 3
     GLsizei ETCHeader::getSize(GLenum internalFormat)
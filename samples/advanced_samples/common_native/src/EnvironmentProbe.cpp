@@ -0,0 +1,519 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "EnvironmentProbe.h"
+#include "Platform.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace MaliSDK
+{
+    /* Identifies a cache file and its layout: magic, cube map size, specular size and levels, coefficients, texels. */
+    static const unsigned int cacheFileMagic = 0x42525045; /* "EPRB" */
+
+    /* Faces of the last level of the specular cube map. */
+    static const int smallestSpecularSize = 8;
+
+    /* Invocations of a projection work group, each summing every 64th texel of the rows of its group. */
+    static const int projectionGroupSize = 64;
+
+    /* Work groups per face, each summing every 16th row. */
+    static const int projectionRowGroups = 16;
+
+    /* Texels of the specular cube map along a side of the tile a prefilter work group makes. */
+    static const int prefilterGroupSize = 8;
+
+    /*
+     * Direction of a texel centre st, from -1 to 1 with t going down the rows, on a face in the order of
+     * GL_TEXTURE_CUBE_MAP_POSITIVE_X and the layers of a cube map image. Not normalized: its squared length is
+     * 1 + dot(st, st).
+     */
+    static const char *faceDirectionSource =
+        "vec3 faceDirection(int face, vec2 st)\n"
+        "{\n"
+        "    if (face == 0) return vec3(1.0, -st.y, -st.x);\n"
+        "    if (face == 1) return vec3(-1.0, -st.y, st.x);\n"
+        "    if (face == 2) return vec3(st.x, 1.0, st.y);\n"
+        "    if (face == 3) return vec3(st.x, -1.0, -st.y);\n"
+        "    if (face == 4) return vec3(st.x, -st.y, 1.0);\n"
+        "    return vec3(-st.x, -st.y, -1.0);\n"
+        "}\n";
+
+    /*
+     * Every invocation sums the radiance of its texels times their solid angle and the harmonics, then the group
+     * adds up its sums in shared memory and writes 9 of them. The constants of the harmonics are applied here,
+     * the cosine lobe on the CPU.
+     */
+    static const char *projectionSource =
+        "layout(local_size_x = GROUP_SIZE) in;\n"
+        "uniform highp samplerCube source;\n"
+        "uniform int sourceSize;\n"
+        "layout(std430, binding = 0) writeonly buffer Coefficients\n"
+        "{\n"
+        "    vec4 coefficients[];\n"
+        "};\n"
+        "shared vec3 partialSums[GROUP_SIZE * 9];\n"
+        "void main()\n"
+        "{\n"
+        "    int face = int(gl_WorkGroupID.z);\n"
+        "    int lane = int(gl_LocalInvocationIndex);\n"
+        "    float texelSize = 2.0 / float(sourceSize);\n"
+        "    vec3 sums[9];\n"
+        "    for (int k = 0; k < 9; k++)\n"
+        "    {\n"
+        "        sums[k] = vec3(0.0);\n"
+        "    }\n"
+        "    for (int y = int(gl_WorkGroupID.x); y < sourceSize; y += int(gl_NumWorkGroups.x))\n"
+        "    {\n"
+        "        for (int x = lane; x < sourceSize; x += GROUP_SIZE)\n"
+        "        {\n"
+        "            vec3 direction = faceDirection(face, (vec2(x, y) + 0.5) * texelSize - 1.0);\n"
+        "            float lengthSquared = dot(direction, direction);\n"
+        "            vec3 n = direction * inversesqrt(lengthSquared);\n"
+        "            float solidAngle = texelSize * texelSize / (lengthSquared * sqrt(lengthSquared));\n"
+        "            vec3 radiance = textureLod(source, direction, 0.0).rgb * solidAngle;\n"
+        "            sums[0] += radiance * 0.282095;\n"
+        "            sums[1] += radiance * (0.488603 * n.y);\n"
+        "            sums[2] += radiance * (0.488603 * n.z);\n"
+        "            sums[3] += radiance * (0.488603 * n.x);\n"
+        "            sums[4] += radiance * (1.092548 * n.x * n.y);\n"
+        "            sums[5] += radiance * (1.092548 * n.y * n.z);\n"
+        "            sums[6] += radiance * (0.315392 * (3.0 * n.z * n.z - 1.0));\n"
+        "            sums[7] += radiance * (1.092548 * n.x * n.z);\n"
+        "            sums[8] += radiance * (0.546274 * (n.x * n.x - n.y * n.y));\n"
+        "        }\n"
+        "    }\n"
+        "    for (int k = 0; k < 9; k++)\n"
+        "    {\n"
+        "        partialSums[lane * 9 + k] = sums[k];\n"
+        "    }\n"
+        "    memoryBarrierShared();\n"
+        "    barrier();\n"
+        "    for (int stride = GROUP_SIZE / 2; stride > 0; stride /= 2)\n"
+        "    {\n"
+        "        if (lane < stride)\n"
+        "        {\n"
+        "            for (int k = 0; k < 9; k++)\n"
+        "            {\n"
+        "                partialSums[lane * 9 + k] += partialSums[(lane + stride) * 9 + k];\n"
+        "            }\n"
+        "        }\n"
+        "        memoryBarrierShared();\n"
+        "        barrier();\n"
+        "    }\n"
+        "    if (lane < 9)\n"
+        "    {\n"
+        "        int group = face * int(gl_NumWorkGroups.x) + int(gl_WorkGroupID.x);\n"
+        "        coefficients[group * 9 + lane] = vec4(partialSums[lane], 0.0);\n"
+        "    }\n"
+        "}\n";
+
+    /*
+     * GGX importance sampling with the view, normal and reflection vectors taken to be the same. Each sample
+     * reads the level of the source whose texels cover about the solid angle of the sample, which removes most of
+     * the noise a fixed number of samples would leave. A roughness of 0 only resamples the source.
+     */
+    static const char *prefilterSource =
+        "layout(local_size_x = GROUP_SIZE, local_size_y = GROUP_SIZE) in;\n"
+        "uniform highp samplerCube source;\n"
+        "uniform int size;\n"
+        "uniform float roughness;\n"
+        "uniform float mirrorLevel;\n"
+        "uniform float sourceTexelSolidAngle;\n"
+        "layout(rgba8, binding = 0) writeonly uniform highp imageCube destination;\n"
+        "const uint sampleCount = 128u;\n"
+        "const float pi = 3.14159265;\n"
+        "void main()\n"
+        "{\n"
+        "    ivec3 texel = ivec3(gl_GlobalInvocationID);\n"
+        "    if (texel.x >= size || texel.y >= size)\n"
+        "    {\n"
+        "        return;\n"
+        "    }\n"
+        "    vec3 n = normalize(faceDirection(texel.z, (vec2(texel.xy) + 0.5) * (2.0 / float(size)) - 1.0));\n"
+        "    if (roughness == 0.0)\n"
+        "    {\n"
+        "        imageStore(destination, texel, vec4(textureLod(source, n, mirrorLevel).rgb, 1.0));\n"
+        "        return;\n"
+        "    }\n"
+        "    vec3 tangent = normalize(cross(abs(n.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0), n));\n"
+        "    vec3 bitangent = cross(n, tangent);\n"
+        "    float alpha = roughness * roughness;\n"
+        "    float alphaSquared = alpha * alpha;\n"
+        "    vec3 sum = vec3(0.0);\n"
+        "    float weight = 0.0;\n"
+        "    for (uint i = 0u; i < sampleCount; i++)\n"
+        "    {\n"
+        "        /* Hammersley point, mapped on a half vector distributed as GGX. */\n"
+        "        vec2 xi = vec2(float(i) / float(sampleCount), float(bitfieldReverse(i)) * 2.3283064e-10);\n"
+        "        float cosTheta = sqrt((1.0 - xi.y) / (1.0 + (alphaSquared - 1.0) * xi.y));\n"
+        "        float sinTheta = sqrt(1.0 - cosTheta * cosTheta);\n"
+        "        float phi = 2.0 * pi * xi.x;\n"
+        "        vec3 h = (tangent * cos(phi) + bitangent * sin(phi)) * sinTheta + n * cosTheta;\n"
+        "        vec3 l = 2.0 * cosTheta * h - n;\n"
+        "        float nDotL = dot(n, l);\n"
+        "        if (nDotL > 0.0)\n"
+        "        {\n"
+        "            /* The density of l is D(h) * dot(n, h) / (4 * dot(v, h)), dot(v, h) being dot(n, h) here. */\n"
+        "            float denominator = cosTheta * cosTheta * (alphaSquared - 1.0) + 1.0;\n"
+        "            float density = alphaSquared / (4.0 * pi * denominator * denominator);\n"
+        "            float sampleSolidAngle = 1.0 / (float(sampleCount) * density);\n"
+        "            float level = max(0.5 * log2(sampleSolidAngle / sourceTexelSolidAngle) + 1.0, 0.0);\n"
+        "            sum += textureLod(source, l, level).rgb * nDotL;\n"
+        "            weight += nDotL;\n"
+        "        }\n"
+        "    }\n"
+        "    imageStore(destination, texel, vec4(sum / max(weight, 0.0001), 1.0));\n"
+        "}\n";
+
+    /* A polynomial of the first 3 bands, see EnvironmentProbe::project() for the coefficients. */
+    static const char *shaderSource =
+        "uniform highp vec3 probeIrradianceCoefficients[9];\n"
+        "uniform mediump samplerCube probeSpecularTexture;\n"
+        "uniform highp float probeSpecularMaxLevel;\n"
+        "highp vec3 probeIrradiance(highp vec3 normal)\n"
+        "{\n"
+        "    highp vec3 n = normalize(normal);\n"
+        "    highp vec3 irradiance = probeIrradianceCoefficients[0];\n"
+        "    irradiance += probeIrradianceCoefficients[1] * n.y;\n"
+        "    irradiance += probeIrradianceCoefficients[2] * n.z;\n"
+        "    irradiance += probeIrradianceCoefficients[3] * n.x;\n"
+        "    irradiance += probeIrradianceCoefficients[4] * (n.x * n.y);\n"
+        "    irradiance += probeIrradianceCoefficients[5] * (n.y * n.z);\n"
+        "    irradiance += probeIrradianceCoefficients[6] * (3.0 * n.z * n.z - 1.0);\n"
+        "    irradiance += probeIrradianceCoefficients[7] * (n.x * n.z);\n"
+        "    irradiance += probeIrradianceCoefficients[8] * (n.x * n.x - n.y * n.y);\n"
+        "    return max(irradiance, vec3(0.0));\n"
+        "}\n"
+        "mediump vec3 probeSpecular(highp vec3 reflection, mediump float roughness)\n"
+        "{\n"
+        "    return textureLod(probeSpecularTexture, reflection, clamp(roughness, 0.0, 1.0) * probeSpecularMaxLevel).rgb;\n"
+        "}\n";
+
+    static std::string getComputeSource(const char *source, int groupSize)
+    {
+        char define[64];
+        sprintf(define, "#define GROUP_SIZE %d\n", groupSize);
+
+        return std::string("#version 310 es\n") + define +
+               "precision highp float;\n"
+               "precision highp int;\n" +
+               faceDirectionSource + source;
+    }
+
+    EnvironmentProbe::EnvironmentProbe(void)
+        : computeSupported(false),
+          specularTexture(0),
+          specularSize(0),
+          specularLevels(0)
+    {
+        GLint majorVersion = 0;
+        GLint minorVersion = 0;
+
+        glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+        glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+        glGetError();
+        computeSupported = majorVersion > 3 || (majorVersion == 3 && minorVersion >= 1);
+
+        for (int index = 0; index < 9 * 3; index++)
+        {
+            irradianceCoefficients[index] = 0.0f;
+        }
+    }
+
+    EnvironmentProbe::~EnvironmentProbe(void)
+    {
+        if (specularTexture != 0)
+        {
+            GL_CHECK(glDeleteTextures(1, &specularTexture));
+        }
+    }
+
+    bool EnvironmentProbe::isSupported(void) const
+    {
+        return computeSupported;
+    }
+
+    bool EnvironmentProbe::generate(GLuint cubemap, const char *cachePath, GLsizei size)
+    {
+        if (!computeSupported || size < smallestSpecularSize || (size & (size - 1)) != 0)
+        {
+            return false;
+        }
+
+        GLint cubemapSize = 0;
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap));
+        GL_CHECK(glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_WIDTH, &cubemapSize));
+        if (cubemapSize <= 0)
+        {
+            return false;
+        }
+
+        if (specularTexture != 0)
+        {
+            GL_CHECK(glDeleteTextures(1, &specularTexture));
+        }
+
+        specularSize = size;
+        specularLevels = 1;
+        while ((specularSize >> (specularLevels - 1)) > smallestSpecularSize)
+        {
+            specularLevels++;
+        }
+
+        GL_CHECK(glGenTextures(1, &specularTexture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, specularTexture));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_CUBE_MAP, specularLevels, GL_RGBA8, specularSize, specularSize));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE));
+
+        if (cachePath != NULL && load(cachePath, cubemapSize))
+        {
+            LOGI("Environment probe loaded from %s\n", cachePath);
+            return true;
+        }
+
+        project(cubemap, cubemapSize);
+        prefilter(cubemap, cubemapSize);
+
+        if (cachePath != NULL)
+        {
+            store(cachePath, cubemapSize);
+        }
+
+        return true;
+    }
+
+    void EnvironmentProbe::project(GLuint cubemap, GLsizei cubemapSize)
+    {
+        static const int groups = projectionRowGroups * 6;
+
+        GLuint program = 0;
+        Shader::processComputeProgramSource(&program, getComputeSource(projectionSource, projectionGroupSize).c_str());
+
+        GLuint buffer = 0;
+        GL_CHECK(glGenBuffers(1, &buffer));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, groups * 9 * 4 * sizeof(GLfloat), NULL, GL_STREAM_READ));
+
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap));
+        GL_CHECK(glUseProgram(program));
+        GL_CHECK(glUniform1i(glGetUniformLocation(program, "source"), 0));
+        GL_CHECK(glUniform1i(glGetUniformLocation(program, "sourceSize"), cubemapSize));
+        GL_CHECK(glDispatchCompute(projectionRowGroups, 1, 6));
+        GL_CHECK(glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT));
+
+        /* Sum the groups in double precision, reading them back waits for the dispatch. */
+        double radiance[9 * 3] = {0.0};
+        const GLfloat *sums = (const GLfloat *)GL_CHECK(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, groups * 9 * 4 * sizeof(GLfloat), GL_MAP_READ_BIT));
+        if (sums != NULL)
+        {
+            for (int group = 0; group < groups; group++)
+            {
+                for (int index = 0; index < 9 * 3; index++)
+                {
+                    radiance[index] += sums[(group * 9 + index / 3) * 4 + index % 3];
+                }
+            }
+        }
+        GL_CHECK(glUnmapBuffer(GL_SHADER_STORAGE_BUFFER));
+
+        /*
+         * Convolving with the clamped cosine scales band l by pi, 2 pi / 3 and pi / 4, divided by pi here for the
+         * albedo. probeIrradiance() leaves out the constants of the harmonics, so they are applied again.
+         */
+        static const double bandScales[9] = {1.0, 2.0 / 3.0, 2.0 / 3.0, 2.0 / 3.0, 0.25, 0.25, 0.25, 0.25, 0.25};
+        static const double harmonicConstants[9] = {0.282095, 0.488603, 0.488603, 0.488603, 1.092548, 1.092548, 0.315392, 1.092548, 0.546274};
+        for (int index = 0; index < 9 * 3; index++)
+        {
+            irradianceCoefficients[index] = (GLfloat)(radiance[index] * bandScales[index / 3] * harmonicConstants[index / 3]);
+        }
+
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0));
+        GL_CHECK(glDeleteBuffers(1, &buffer));
+        GL_CHECK(glUseProgram(0));
+        GL_CHECK(glDeleteProgram(program));
+    }
+
+    void EnvironmentProbe::prefilter(GLuint cubemap, GLsizei cubemapSize)
+    {
+        const double pi = 3.14159265358979323846;
+
+        GLuint program = 0;
+        Shader::processComputeProgramSource(&program, getComputeSource(prefilterSource, prefilterGroupSize).c_str());
+
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap));
+        GL_CHECK(glUseProgram(program));
+        GL_CHECK(glUniform1i(glGetUniformLocation(program, "source"), 0));
+        GL_CHECK(glUniform1f(glGetUniformLocation(program, "sourceTexelSolidAngle"), (GLfloat)(4.0 * pi / (6.0 * cubemapSize * cubemapSize))));
+
+        /* The level of the source whose texels are the size of the texels of level 0. */
+        GL_CHECK(glUniform1f(glGetUniformLocation(program, "mirrorLevel"), (GLfloat)std::max(0.0, log(double(cubemapSize) / specularSize) / log(2.0))));
+
+        GLint sizeLocation = GL_CHECK(glGetUniformLocation(program, "size"));
+        GLint roughnessLocation = GL_CHECK(glGetUniformLocation(program, "roughness"));
+
+        for (GLint level = 0; level < specularLevels; level++)
+        {
+            GLsizei levelSize = specularSize >> level;
+            GLuint groups = (levelSize + prefilterGroupSize - 1) / prefilterGroupSize;
+
+            GL_CHECK(glUniform1i(sizeLocation, levelSize));
+            GL_CHECK(glUniform1f(roughnessLocation, specularLevels > 1 ? (GLfloat)level / (specularLevels - 1) : 0.0f));
+            GL_CHECK(glBindImageTexture(0, specularTexture, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8));
+            GL_CHECK(glDispatchCompute(groups, groups, 6));
+        }
+
+        GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT));
+        GL_CHECK(glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8));
+        GL_CHECK(glUseProgram(0));
+        GL_CHECK(glDeleteProgram(program));
+
+        GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, specularTexture));
+    }
+
+    bool EnvironmentProbe::load(const char *cachePath, GLsizei cubemapSize)
+    {
+        FILE *file = fopen(cachePath, "rb");
+        if (file == NULL)
+        {
+            return false;
+        }
+
+        unsigned int magic = 0;
+        GLsizei header[3] = {0, 0, 0};
+        bool valid = fread(&magic, sizeof(magic), 1, file) == 1 && magic == cacheFileMagic &&
+                     fread(header, sizeof(header), 1, file) == 1 &&
+                     header[0] == cubemapSize && header[1] == specularSize && header[2] == specularLevels &&
+                     fread(irradianceCoefficients, sizeof(irradianceCoefficients), 1, file) == 1;
+
+        /* The texels are read a face at a time into the texture allocated by generate(), which is still bound. */
+        std::vector<unsigned char> texels(specularSize * specularSize * 4);
+        for (GLint level = 0; valid && level < specularLevels; level++)
+        {
+            GLsizei levelSize = specularSize >> level;
+            for (int face = 0; valid && face < 6; face++)
+            {
+                valid = fread(&texels[0], levelSize * levelSize * 4, 1, file) == 1;
+                if (valid)
+                {
+                    GL_CHECK(glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, 0, 0, levelSize, levelSize, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0]));
+                }
+            }
+        }
+        fclose(file);
+
+        if (!valid)
+        {
+            LOGE("Environment probe cache file %s does not match, regenerating it.\n", cachePath);
+        }
+
+        return valid;
+    }
+
+    void EnvironmentProbe::store(const char *cachePath, GLsizei cubemapSize) const
+    {
+        FILE *file = fopen(cachePath, "wb");
+        if (file == NULL)
+        {
+            LOGE("Cannot write environment probe cache file %s\n", cachePath);
+            return;
+        }
+
+        GLint readFramebufferBinding = 0;
+        GLint packAlignment = 0;
+        GL_CHECK(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebufferBinding));
+        GL_CHECK(glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment));
+
+        GLuint framebuffer = 0;
+        GL_CHECK(glGenFramebuffers(1, &framebuffer));
+        GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer));
+        GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+
+        GLsizei header[3] = {cubemapSize, specularSize, specularLevels};
+        bool written = fwrite(&cacheFileMagic, sizeof(cacheFileMagic), 1, file) == 1 &&
+                       fwrite(header, sizeof(header), 1, file) == 1 &&
+                       fwrite(irradianceCoefficients, sizeof(irradianceCoefficients), 1, file) == 1;
+
+        std::vector<unsigned char> texels(specularSize * specularSize * 4);
+        for (GLint level = 0; written && level < specularLevels; level++)
+        {
+            GLsizei levelSize = specularSize >> level;
+            for (int face = 0; written && face < 6; face++)
+            {
+                GL_CHECK(glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, specularTexture, level));
+                GL_CHECK(glReadPixels(0, 0, levelSize, levelSize, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0]));
+                written = fwrite(&texels[0], levelSize * levelSize * 4, 1, file) == 1;
+            }
+        }
+        fclose(file);
+
+        GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT, packAlignment));
+        GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebufferBinding));
+        GL_CHECK(glDeleteFramebuffers(1, &framebuffer));
+
+        /* Never leave a partial file behind, it would only be rejected on the next run. */
+        if (!written)
+        {
+            LOGE("Failed to write environment probe cache file %s\n", cachePath);
+            remove(cachePath);
+        }
+    }
+
+    GLuint EnvironmentProbe::getSpecularTexture(void) const
+    {
+        return specularTexture;
+    }
+
+    GLint EnvironmentProbe::getSpecularLevels(void) const
+    {
+        return specularLevels;
+    }
+
+    const GLfloat *EnvironmentProbe::getIrradianceCoefficients(void) const
+    {
+        return irradianceCoefficients;
+    }
+
+    void EnvironmentProbe::setUniforms(GLuint program, GLint textureUnit) const
+    {
+        GL_CHECK(glActiveTexture(GL_TEXTURE0 + textureUnit));
+        GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, specularTexture));
+        GL_CHECK(glUniform1i(glGetUniformLocation(program, "probeSpecularTexture"), textureUnit));
+        GL_CHECK(glUniform1f(glGetUniformLocation(program, "probeSpecularMaxLevel"), (GLfloat)(specularLevels - 1)));
+        GL_CHECK(glUniform3fv(glGetUniformLocation(program, "probeIrradianceCoefficients"), 9, irradianceCoefficients));
+    }
+
+    const char *EnvironmentProbe::getShaderSource(void)
+    {
+        return shaderSource;
+    }
+}
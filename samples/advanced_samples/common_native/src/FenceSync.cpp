@@ -0,0 +1,47 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FenceSync.h"
+#include "Platform.h"
+
+namespace MaliSDK
+{
+    /* How long one glClientWaitSync() waits before the wait is retried, in nanoseconds. */
+    static const GLuint64 fenceTimeout = 100000000;
+
+    bool FenceSync::wait(GLsync fence, bool block, const char *name)
+    {
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, block ? fenceTimeout : 0);
+        if (result == GL_TIMEOUT_EXPIRED && !block)
+        {
+            return false;
+        }
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            result = glClientWaitSync(fence, 0, fenceTimeout);
+        }
+        if (result == GL_WAIT_FAILED)
+        {
+            LOGE("Waiting for the %s fence failed.", name);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,222 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FilterableShadowMap.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+#include "Shader.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* A triangle covering the viewport, without vertex buffers. */
+    static const char *blurVertexShaderSource =
+        "#version 300 es\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 position = vec2(float((gl_VertexID & 1) * 4 - 1), float((gl_VertexID & 2) * 2 - 1));\n"
+        "    gl_Position = vec4(position, 0.0, 1.0);\n"
+        "}\n";
+
+    /*
+     * Depth can't be filtered before it is warped, so the horizontal pass computes the moments of every tap
+     * itself. The taps are a texel of the moments texture apart, which also downsamples the depth texture.
+     */
+    static const char *horizontalFragmentShaderSource =
+        "#version 300 es\n"
+        "precision highp float;\n"
+        "precision highp sampler2D;\n"
+        "#define EXPONENT 5.0\n"
+        "uniform sampler2D depthTexture;\n"
+        "uniform vec2 momentsSize;\n"
+        "uniform vec2 depthRange;\n"
+        "out vec4 moments;\n"
+        "vec4 getMoments(float depth)\n"
+        "{\n"
+        "    float near = depthRange.x;\n"
+        "    float far = depthRange.y;\n"
+        "    float distance = near * far / (far - depth * (far - near));\n"
+        "    float linearDepth = 2.0 * (distance - near) / (far - near) - 1.0;\n"
+        "    float positive = exp(EXPONENT * linearDepth);\n"
+        "    float negative = -exp(-EXPONENT * linearDepth);\n"
+        "    return vec4(positive, positive * positive, negative, negative * negative);\n"
+        "}\n"
+        "void main()\n"
+        "{\n"
+        "    const float weights[4] = float[4](20.0 / 64.0, 15.0 / 64.0, 6.0 / 64.0, 1.0 / 64.0);\n"
+        "    vec2 uv = gl_FragCoord.xy / momentsSize;\n"
+        "    float step = 1.0 / momentsSize.x;\n"
+        "    moments = weights[0] * getMoments(texture(depthTexture, uv).r);\n"
+        "    for (int i = 1; i < 4; i++)\n"
+        "    {\n"
+        "        moments += weights[i] * getMoments(texture(depthTexture, uv - vec2(float(i) * step, 0.0)).r);\n"
+        "        moments += weights[i] * getMoments(texture(depthTexture, uv + vec2(float(i) * step, 0.0)).r);\n"
+        "    }\n"
+        "}\n";
+
+    static const char *verticalFragmentShaderSource =
+        "#version 300 es\n"
+        "precision highp float;\n"
+        "precision highp sampler2D;\n"
+        "uniform sampler2D blurTexture;\n"
+        "out vec4 moments;\n"
+        "void main()\n"
+        "{\n"
+        "    const float weights[4] = float[4](20.0 / 64.0, 15.0 / 64.0, 6.0 / 64.0, 1.0 / 64.0);\n"
+        "    ivec2 texel = ivec2(gl_FragCoord.xy);\n"
+        "    int lastRow = textureSize(blurTexture, 0).y - 1;\n"
+        "    moments = weights[0] * texelFetch(blurTexture, texel, 0);\n"
+        "    for (int i = 1; i < 4; i++)\n"
+        "    {\n"
+        "        moments += weights[i] * texelFetch(blurTexture, ivec2(texel.x, max(texel.y - i, 0)), 0);\n"
+        "        moments += weights[i] * texelFetch(blurTexture, ivec2(texel.x, min(texel.y + i, lastRow)), 0);\n"
+        "    }\n"
+        "}\n";
+
+    static GLuint createTarget(GLsizei levels, GLsizei width, GLsizei height, GLuint *framebuffer)
+    {
+        GLuint texture = 0;
+
+        GL_CHECK(glGenTextures(1, &texture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA16F, width, height));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, levels > 1 ? GL_LINEAR : GL_NEAREST));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+        GL_CHECK(glGenFramebuffers(1, framebuffer));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, *framebuffer));
+        GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0));
+
+        GLenum status = GL_CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER));
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            LOGE("FilterableShadowMap: framebuffer incomplete (0x%x), half float targets are not renderable.\n", status);
+            exit(1);
+        }
+
+        return texture;
+    }
+
+    bool FilterableShadowMap::isSupported(void)
+    {
+        return GLExtensions::isSupported("GL_EXT_color_buffer_half_float") || GLExtensions::isSupported("GL_EXT_color_buffer_float");
+    }
+
+    FilterableShadowMap::FilterableShadowMap(GLsizei width, GLsizei height, float nearPlane, float farPlane)
+        : width(width),
+          height(height),
+          nearPlane(nearPlane),
+          farPlane(farPlane),
+          horizontalProgram(0),
+          verticalProgram(0)
+    {
+        /* A full mipmap chain, down to 1 by 1. */
+        GLsizei levels = 1;
+        for (GLsizei size = width > height ? width : height; size > 1; size /= 2)
+        {
+            levels++;
+        }
+
+        momentsTexture = createTarget(levels, width, height, &momentsFramebuffer);
+        blurTexture = createTarget(1, width, height, &blurFramebuffer);
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+        /* Overrides the filtering and comparison of the depth texture while it is converted. */
+        GL_CHECK(glGenSamplers(1, &depthSampler));
+        GL_CHECK(glSamplerParameteri(depthSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+        GL_CHECK(glSamplerParameteri(depthSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        GL_CHECK(glSamplerParameteri(depthSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glSamplerParameteri(depthSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glSamplerParameteri(depthSampler, GL_TEXTURE_COMPARE_MODE, GL_NONE));
+
+        Shader::processProgramSource(&horizontalProgram, blurVertexShaderSource, horizontalFragmentShaderSource);
+        Shader::processProgramSource(&verticalProgram, blurVertexShaderSource, verticalFragmentShaderSource);
+
+        GL_CHECK(glUseProgram(horizontalProgram));
+        GL_CHECK(glUniform1i(glGetUniformLocation(horizontalProgram, "depthTexture"), 0));
+        GL_CHECK(glUniform2f(glGetUniformLocation(horizontalProgram, "momentsSize"), (float)width, (float)height));
+        GL_CHECK(glUniform2f(glGetUniformLocation(horizontalProgram, "depthRange"), nearPlane, farPlane));
+        GL_CHECK(glUseProgram(verticalProgram));
+        GL_CHECK(glUniform1i(glGetUniformLocation(verticalProgram, "blurTexture"), 0));
+        GL_CHECK(glUseProgram(0));
+
+        /* No attributes, but a vertex array of its own keeps the sample's enabled arrays out of the blur. */
+        GL_CHECK(glGenVertexArrays(1, &vertexArray));
+    }
+
+    FilterableShadowMap::~FilterableShadowMap(void)
+    {
+        GL_CHECK(glDeleteVertexArrays(1, &vertexArray));
+        GL_CHECK(glDeleteProgram(verticalProgram));
+        GL_CHECK(glDeleteProgram(horizontalProgram));
+        GL_CHECK(glDeleteSamplers(1, &depthSampler));
+        GL_CHECK(glDeleteFramebuffers(1, &blurFramebuffer));
+        GL_CHECK(glDeleteFramebuffers(1, &momentsFramebuffer));
+        GL_CHECK(glDeleteTextures(1, &blurTexture));
+        GL_CHECK(glDeleteTextures(1, &momentsTexture));
+    }
+
+    void FilterableShadowMap::update(GLuint depthTexture)
+    {
+        /* Every texel of both targets is written, their previous contents don't need to be loaded. */
+        static const GLenum colorAttachment[] = { GL_COLOR_ATTACHMENT0 };
+
+        GL_CHECK(glDisable(GL_DEPTH_TEST));
+        GL_CHECK(glDisable(GL_CULL_FACE));
+        GL_CHECK(glDisable(GL_BLEND));
+        GL_CHECK(glDisable(GL_POLYGON_OFFSET_FILL));
+        GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+        GL_CHECK(glViewport(0, 0, width, height));
+        GL_CHECK(glBindVertexArray(vertexArray));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+
+        /* Warp the depth and blur it horizontally. */
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, blurFramebuffer));
+        GL_CHECK(glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, colorAttachment));
+        GL_CHECK(glUseProgram(horizontalProgram));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, depthTexture));
+        GL_CHECK(glBindSampler(0, depthSampler));
+        GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+        GL_CHECK(glBindSampler(0, 0));
+
+        /* Blur vertically into the top level of the moments. */
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, momentsFramebuffer));
+        GL_CHECK(glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, colorAttachment));
+        GL_CHECK(glUseProgram(verticalProgram));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, blurTexture));
+        GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+
+        GL_CHECK(glBindVertexArray(0));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+        /* Moments average linearly, so a box filter is right. Sharper filters could make the variance negative. */
+        mipmapGenerator.generate(momentsTexture, GL_RGBA16F, width, height, MipmapGenerator::Box);
+    }
+
+    GLuint FilterableShadowMap::getTexture(void) const
+    {
+        return momentsTexture;
+    }
+}
@@ -0,0 +1,254 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FontAtlas.h"
+#include "Texture.h"
+#include "Platform.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace MaliSDK
+{
+    /* Bitmap glyphs are drawn with an alpha of 0 or 255. */
+    static const unsigned char insideThreshold = 128;
+
+    FontAtlas::FontAtlas(int upscale, int spread)
+        : upscale(upscale > 0 ? upscale : 1),
+          spread(spread > 0 ? spread : 1),
+          atlasWidth(0),
+          atlasHeight(0),
+          textureID(0)
+    {
+    }
+
+    FontAtlas::~FontAtlas(void)
+    {
+        /* As for Text, the texture goes with the context. */
+    }
+
+    int FontAtlas::getCellWidth(const Font &font) const
+    {
+        return font.characterWidth * upscale + 2 * spread;
+    }
+
+    int FontAtlas::getCellHeight(const Font &font) const
+    {
+        return font.characterHeight * upscale + 2 * spread;
+    }
+
+    int FontAtlas::addBitmapFont(const char *filename, int width, int height, int characterWidth, int characterHeight)
+    {
+        unsigned char *bitmap = NULL;
+        Texture::loadData(filename, &bitmap);
+
+        Font font;
+        font.characterWidth = characterWidth;
+        font.characterHeight = characterHeight;
+        font.numberOfGlyphs = (width / characterWidth) * (height / characterHeight);
+        font.firstRow = atlasHeight;
+
+        const int cellWidth = getCellWidth(font);
+        const int cellHeight = getCellHeight(font);
+        const int fieldWidth = cellWidth * glyphsPerRow;
+        const int numberOfRows = (font.numberOfGlyphs + glyphsPerRow - 1) / glyphsPerRow;
+        const int bitmapColumns = width / characterWidth;
+        std::vector<unsigned char> inside(cellWidth * cellHeight);
+
+        font.field.resize(fieldWidth * numberOfRows * cellHeight);
+
+        LOGD("FontAtlas: generating the distance field of %s...\n", filename);
+
+        for (int glyph = 0; glyph < font.numberOfGlyphs; glyph++)
+        {
+            const int bitmapX = (glyph % bitmapColumns) * characterWidth;
+            const int bitmapY = (glyph / bitmapColumns) * characterHeight;
+            const int cellX = (glyph % glyphsPerRow) * cellWidth;
+            const int cellY = (glyph / glyphsPerRow) * cellHeight;
+
+            /* Upscale the glyph with nearest filtering, the padding is outside. */
+            for (int y = 0; y < cellHeight; y++)
+            {
+                for (int x = 0; x < cellWidth; x++)
+                {
+                    int pixelX = x - spread;
+                    int pixelY = y - spread;
+                    bool isInside = false;
+
+                    if (pixelX >= 0 && pixelY >= 0 && pixelX < characterWidth * upscale && pixelY < characterHeight * upscale)
+                    {
+                        int sourceX = bitmapX + pixelX / upscale;
+                        int sourceY = bitmapY + pixelY / upscale;
+
+                        isInside = bitmap[(sourceY * width + sourceX) * 4 + 3] >= insideThreshold;
+                    }
+
+                    inside[y * cellWidth + x] = isInside ? 1 : 0;
+                }
+            }
+
+            /* Distance to the nearest texel on the other side of the outline, searched within the spread only. */
+            for (int y = 0; y < cellHeight; y++)
+            {
+                for (int x = 0; x < cellWidth; x++)
+                {
+                    const unsigned char state = inside[y * cellWidth + x];
+                    float nearest = (float)spread;
+
+                    for (int dy = -spread; dy <= spread; dy++)
+                    {
+                        for (int dx = -spread; dx <= spread; dx++)
+                        {
+                            int otherX = x + dx;
+                            int otherY = y + dy;
+
+                            /* Texels beyond the cell are outside. */
+                            unsigned char otherState = 0;
+                            if (otherX >= 0 && otherY >= 0 && otherX < cellWidth && otherY < cellHeight)
+                            {
+                                otherState = inside[otherY * cellWidth + otherX];
+                            }
+
+                            if (otherState != state)
+                            {
+                                /* The outline is half way between the two texel centres. */
+                                float distance = sqrtf((float)(dx * dx + dy * dy)) - 0.5f;
+
+                                if (distance < nearest)
+                                {
+                                    nearest = distance;
+                                }
+                            }
+                        }
+                    }
+
+                    float signedDistance = state ? nearest : -nearest;
+                    float value = 0.5f + signedDistance / (2.0f * spread);
+
+                    value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+                    font.field[(cellY + y) * fieldWidth + cellX + x] = (unsigned char)(value * 255.0f + 0.5f);
+                }
+            }
+        }
+
+        free(bitmap);
+
+        atlasWidth = fieldWidth > atlasWidth ? fieldWidth : atlasWidth;
+        atlasHeight += numberOfRows * cellHeight;
+        fonts.push_back(font);
+
+        LOGD("FontAtlas: %d glyphs added, atlas is %dx%d.\n", font.numberOfGlyphs, atlasWidth, atlasHeight);
+
+        return (int)fonts.size() - 1;
+    }
+
+    void FontAtlas::upload(void)
+    {
+        if (fonts.empty())
+        {
+            LOGE("FontAtlas::upload() called without fonts.\n");
+            exit(1);
+        }
+
+        std::vector<unsigned char> atlas(atlasWidth * atlasHeight, 0);
+
+        for (size_t fontIndex = 0; fontIndex < fonts.size(); fontIndex++)
+        {
+            const Font &font = fonts[fontIndex];
+            const int fieldWidth = getCellWidth(font) * glyphsPerRow;
+            const int fieldHeight = (int)font.field.size() / fieldWidth;
+
+            for (int y = 0; y < fieldHeight; y++)
+            {
+                for (int x = 0; x < fieldWidth; x++)
+                {
+                    atlas[(font.firstRow + y) * atlasWidth + x] = font.field[y * fieldWidth + x];
+                }
+            }
+        }
+
+        GL_CHECK(glGenTextures(1, &textureID));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, textureID));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+        /* Rows of single bytes are not 4 byte aligned in general. */
+        GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlasWidth, atlasHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, &atlas[0]));
+        GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+    }
+
+    FontAtlas::Glyph FontAtlas::getGlyph(int font, char character) const
+    {
+        const Font &glyphFont = fonts[font];
+        int glyph = (unsigned char)character - 32;
+
+        if (glyph < 0 || glyph >= glyphFont.numberOfGlyphs)
+        {
+            glyph = 0;
+        }
+
+        const int cellWidth = getCellWidth(glyphFont);
+        const int cellHeight = getCellHeight(glyphFont);
+        const int cellX = (glyph % glyphsPerRow) * cellWidth;
+        const int cellY = glyphFont.firstRow + (glyph / glyphsPerRow) * cellHeight;
+
+        /* The first row of a glyph is its top. */
+        Glyph result;
+        result.left = cellX / (float)atlasWidth;
+        result.right = (cellX + cellWidth) / (float)atlasWidth;
+        result.top = cellY / (float)atlasHeight;
+        result.bottom = (cellY + cellHeight) / (float)atlasHeight;
+
+        return result;
+    }
+
+    float FontAtlas::getAspectRatio(int font) const
+    {
+        return fonts[font].characterWidth / (float)fonts[font].characterHeight;
+    }
+
+    float FontAtlas::getPadding(int font) const
+    {
+        return spread / (float)(fonts[font].characterHeight * upscale);
+    }
+
+    int FontAtlas::getGlyphHeight(int font) const
+    {
+        return fonts[font].characterHeight * upscale;
+    }
+
+    int FontAtlas::getSpread(void) const
+    {
+        return spread;
+    }
+
+    int FontAtlas::getNumberOfFonts(void) const
+    {
+        return (int)fonts.size();
+    }
+
+    GLuint FontAtlas::getTexture(void) const
+    {
+        return textureID;
+    }
+}
@@ -0,0 +1,316 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FrameGraph.h"
+#include "GPUMemory.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <vector>
+
+using std::vector;
+
+namespace MaliSDK
+{
+    /**
+     * \brief Orders targets by the first pass using them, the order compile() hands out the textures in.
+     */
+    struct FirstPassOrder
+    {
+        const vector<int> *firstPasses;
+
+        bool operator()(int first, int second) const
+        {
+            return (*firstPasses)[first] < (*firstPasses)[second];
+        }
+    };
+
+    FrameGraph::FrameGraph(const char *owner)
+        : owner(owner),
+          compiled(false),
+          valid(true)
+    {
+    }
+
+    FrameGraph::~FrameGraph(void)
+    {
+        for (size_t i = 0; i < pool.size(); i++)
+        {
+            GPUMemory::forget(GPUMemory::CATEGORY_TEXTURE, 1, &pool[i].id);
+            GL_CHECK(glDeleteTextures(1, &pool[i].id));
+        }
+    }
+
+    void FrameGraph::clear(void)
+    {
+        passes.clear();
+        targets.clear();
+        compiled = false;
+        valid = true;
+    }
+
+    int FrameGraph::addTarget(const char *name, GLsizei width, GLsizei height, GLenum internalFormat, GLenum filter)
+    {
+        Target target;
+
+        target.name = name;
+        target.width = width;
+        target.height = height;
+        target.internalFormat = internalFormat;
+        target.filter = filter;
+        target.firstPass = -1;
+        target.lastPass = -1;
+        target.firstWrite = -1;
+        target.texture = -1;
+
+        targets.push_back(target);
+        compiled = false;
+
+        return (int)targets.size() - 1;
+    }
+
+    int FrameGraph::addPass(const char *name)
+    {
+        passes.push_back(name);
+        compiled = false;
+
+        return (int)passes.size() - 1;
+    }
+
+    void FrameGraph::use(int pass, int target, bool isWrite)
+    {
+        if (pass < 0 || pass >= (int)passes.size() || target < 0 || target >= (int)targets.size())
+        {
+            LOGE("FrameGraph %s: invalid pass %d or target %d\n", owner, pass, target);
+            valid = false;
+            return;
+        }
+
+        Target &used = targets[target];
+
+        if (used.firstPass == -1 || pass < used.firstPass)
+        {
+            used.firstPass = pass;
+        }
+
+        if (pass > used.lastPass)
+        {
+            used.lastPass = pass;
+        }
+
+        if (isWrite && (used.firstWrite == -1 || pass < used.firstWrite))
+        {
+            used.firstWrite = pass;
+        }
+
+        compiled = false;
+    }
+
+    void FrameGraph::write(int pass, int target)
+    {
+        use(pass, target, true);
+    }
+
+    void FrameGraph::read(int pass, int target)
+    {
+        use(pass, target, false);
+    }
+
+    bool FrameGraph::compile(void)
+    {
+        compiled = false;
+
+        if (!valid)
+        {
+            return false;
+        }
+
+        vector<int> order;
+        vector<int> firstPasses(targets.size());
+
+        for (size_t i = 0; i < targets.size(); i++)
+        {
+            Target &target = targets[i];
+
+            target.texture = -1;
+            firstPasses[i] = target.firstPass;
+
+            if (target.firstPass == -1)
+            {
+                continue;
+            }
+
+            /* A pass writing a target it also reads, such as with blending, does not need an earlier one. */
+            if (target.firstWrite == -1 || target.firstWrite > target.firstPass)
+            {
+                LOGE("FrameGraph %s: pass %s reads %s before any pass writes it\n", owner, passes[target.firstPass], target.name);
+                return false;
+            }
+
+            order.push_back((int)i);
+        }
+
+        FirstPassOrder firstPassOrder = { &firstPasses };
+
+        std::stable_sort(order.begin(), order.end(), firstPassOrder);
+
+        for (size_t i = 0; i < pool.size(); i++)
+        {
+            pool[i].lastPass = -1;
+        }
+
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            Target &target = targets[order[i]];
+            int chosen = -1;
+
+            /*
+             * A texture already given to a target which is dead by now is preferred over one of the pool nothing uses
+             * yet, so the unused ones can be released.
+             */
+            for (size_t j = 0; j < pool.size(); j++)
+            {
+                const Texture &texture = pool[j];
+
+                if (texture.width != target.width || texture.height != target.height
+                    || texture.internalFormat != target.internalFormat || texture.filter != target.filter
+                    || texture.lastPass >= target.firstPass)
+                {
+                    continue;
+                }
+
+                if (chosen == -1 || (pool[chosen].lastPass == -1 && texture.lastPass != -1))
+                {
+                    chosen = (int)j;
+                }
+            }
+
+            if (chosen == -1)
+            {
+                Texture texture;
+
+                texture.width = target.width;
+                texture.height = target.height;
+                texture.internalFormat = target.internalFormat;
+                texture.filter = target.filter;
+                texture.lastPass = -1;
+
+                GL_CHECK(glGenTextures(1, &texture.id));
+                GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture.id));
+                GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, texture.internalFormat, texture.width, texture.height));
+                GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.filter));
+                GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture.filter));
+                GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+                GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+                GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+                GPUMemory::trackTexture(texture.id, GPUMemory::computeTextureSize(texture.internalFormat, texture.width, texture.height, 1, 1),
+                                        texture.internalFormat, owner);
+
+                pool.push_back(texture);
+                chosen = (int)pool.size() - 1;
+            }
+
+            pool[chosen].lastPass = target.lastPass;
+            target.texture = chosen;
+        }
+
+        compiled = true;
+
+        return true;
+    }
+
+    GLuint FrameGraph::getTexture(int target) const
+    {
+        if (!compiled || target < 0 || target >= (int)targets.size() || targets[target].texture == -1)
+        {
+            return 0;
+        }
+
+        return pool[targets[target].texture].id;
+    }
+
+    void FrameGraph::releaseUnusedTextures(void)
+    {
+        vector<int> remap(pool.size(), -1);
+        vector<Texture> kept;
+
+        for (size_t i = 0; i < pool.size(); i++)
+        {
+            if (compiled && pool[i].lastPass != -1)
+            {
+                remap[i] = (int)kept.size();
+                kept.push_back(pool[i]);
+                continue;
+            }
+
+            GPUMemory::forget(GPUMemory::CATEGORY_TEXTURE, 1, &pool[i].id);
+            GL_CHECK(glDeleteTextures(1, &pool[i].id));
+        }
+
+        for (size_t i = 0; i < targets.size(); i++)
+        {
+            if (targets[i].texture != -1)
+            {
+                targets[i].texture = remap[targets[i].texture];
+            }
+        }
+
+        pool.swap(kept);
+    }
+
+    size_t FrameGraph::getDeclaredBytes(void) const
+    {
+        size_t bytes = 0;
+
+        for (size_t i = 0; i < targets.size(); i++)
+        {
+            if (targets[i].firstPass != -1)
+            {
+                bytes += GPUMemory::computeTextureSize(targets[i].internalFormat, targets[i].width, targets[i].height, 1, 1);
+            }
+        }
+
+        return bytes;
+    }
+
+    size_t FrameGraph::getAllocatedBytes(void) const
+    {
+        size_t bytes = 0;
+
+        for (size_t i = 0; i < pool.size(); i++)
+        {
+            bytes += GPUMemory::computeTextureSize(pool[i].internalFormat, pool[i].width, pool[i].height, 1, 1);
+        }
+
+        return bytes;
+    }
+
+    void FrameGraph::log(void) const
+    {
+        for (size_t i = 0; i < targets.size(); i++)
+        {
+            LOGI("FrameGraph %s: %s %dx%d, texture %u\n", owner, targets[i].name, (int)targets[i].width, (int)targets[i].height, getTexture((int)i));
+        }
+
+        LOGI("FrameGraph %s: %u KB of targets in %u KB of textures (%d textures)\n", owner,
+             (unsigned int)(getDeclaredBytes() / 1024), (unsigned int)(getAllocatedBytes() / 1024), (int)pool.size());
+    }
+}
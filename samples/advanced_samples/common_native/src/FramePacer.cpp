@@ -0,0 +1,210 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FramePacer.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+
+#include <cstring>
+#include <time.h>
+
+/* EGL_ANDROID_get_frame_timestamps, not part of older headers. */
+#ifndef EGL_TIMESTAMPS_ANDROID
+#define EGL_TIMESTAMPS_ANDROID 0x3430
+#endif
+#ifndef EGL_DISPLAY_PRESENT_TIME_ANDROID
+#define EGL_DISPLAY_PRESENT_TIME_ANDROID 0x343A
+#endif
+
+namespace MaliSDK
+{
+    static const khronos_int64_t nanosecondsPerSecond = 1000000000LL;
+
+    /* Weight of the newest frame in the average latency. */
+    static const float latencySmoothing = 0.1f;
+
+    /* Timestamps which are negative are still pending (-2) or will never be available (-1). */
+    static const khronos_int64_t timestampPending = -2;
+
+    /* Presentation times are on the CLOCK_MONOTONIC timebase. */
+    static khronos_int64_t getMonotonicTime(void)
+    {
+        timespec now;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        return (khronos_int64_t)now.tv_sec * nanosecondsPerSecond + now.tv_nsec;
+    }
+
+    FramePacer::FramePacer(int targetRefreshRate, int displayRefreshRate)
+        : display(eglGetCurrentDisplay()),
+          surface(eglGetCurrentSurface(EGL_DRAW)),
+          presentationTime(NULL),
+          getNextFrameId(NULL),
+          getFrameTimestamps(NULL),
+          displayRefreshRate(displayRefreshRate > 0 ? displayRefreshRate : 60),
+          targetRefreshRate(0),
+          targetPeriod(0),
+          lastPresentTime(0),
+          firstPendingFrame(0),
+          numberOfPending(0),
+          lastLatency(0.0f),
+          averageLatency(0.0f)
+    {
+        if (GLExtensions::isEGLSupported(display, "EGL_ANDROID_presentation_time"))
+        {
+            presentationTime = (PresentationTimeFunction)eglGetProcAddress("eglPresentationTimeANDROID");
+        }
+
+        if (GLExtensions::isEGLSupported(display, "EGL_ANDROID_get_frame_timestamps") &&
+            eglSurfaceAttrib(display, surface, EGL_TIMESTAMPS_ANDROID, EGL_TRUE))
+        {
+            getNextFrameId = (GetNextFrameIdFunction)eglGetProcAddress("eglGetNextFrameIdANDROID");
+            getFrameTimestamps = (GetFrameTimestampsFunction)eglGetProcAddress("eglGetFrameTimestampsANDROID");
+
+            if (getNextFrameId == NULL || getFrameTimestamps == NULL)
+            {
+                getNextFrameId = NULL;
+                getFrameTimestamps = NULL;
+            }
+        }
+
+        LOGI("FramePacer: presentation time %s, frame timestamps %s.\n",
+             presentationTime != NULL ? "supported" : "not supported",
+             getFrameTimestamps != NULL ? "supported" : "not supported");
+
+        setTargetRefreshRate(targetRefreshRate);
+    }
+
+    void FramePacer::setTargetRefreshRate(int targetRefreshRate)
+    {
+        if (targetRefreshRate <= 0)
+        {
+            targetRefreshRate = displayRefreshRate;
+        }
+
+        this->targetRefreshRate = targetRefreshRate;
+        targetPeriod = nanosecondsPerSecond / targetRefreshRate;
+        lastPresentTime = 0;
+
+        EGLint swapInterval = 1;
+
+        /* Without presentation times, only whole divisions of the display refresh rate can be reached. */
+        if (presentationTime == NULL)
+        {
+            swapInterval = (displayRefreshRate + targetRefreshRate / 2) / targetRefreshRate;
+
+            if (swapInterval < 1)
+            {
+                swapInterval = 1;
+            }
+        }
+
+        eglSwapInterval(display, swapInterval);
+    }
+
+    void FramePacer::presentFrame(void)
+    {
+        Nanoseconds now = getMonotonicTime();
+
+        if (presentationTime != NULL)
+        {
+            Nanoseconds presentTime = lastPresentTime + targetPeriod;
+
+            /* A late frame goes to the next slot on the same grid, so later frames stay evenly spaced. */
+            if (lastPresentTime == 0 || presentTime - now > 4 * targetPeriod)
+            {
+                presentTime = now + targetPeriod;
+            }
+            else if (presentTime < now)
+            {
+                presentTime += ((now - presentTime) / targetPeriod + 1) * targetPeriod;
+            }
+
+            presentationTime(display, surface, presentTime);
+            lastPresentTime = presentTime;
+        }
+
+        if (getFrameTimestamps != NULL)
+        {
+            collectTimestamps();
+
+            FrameId frameId;
+
+            /* If too many frames are pending the oldest is dropped, its timestamps are no longer kept. */
+            if (getNextFrameId(display, surface, &frameId))
+            {
+                if (numberOfPending == numberOfPendingFrames)
+                {
+                    firstPendingFrame = (firstPendingFrame + 1) % numberOfPendingFrames;
+                    numberOfPending--;
+                }
+
+                PendingFrame &frame = pendingFrames[(firstPendingFrame + numberOfPending) % numberOfPendingFrames];
+
+                frame.id = frameId;
+                frame.submitTime = now;
+                numberOfPending++;
+            }
+        }
+    }
+
+    void FramePacer::collectTimestamps(void)
+    {
+        const EGLint timestamps[] = { EGL_DISPLAY_PRESENT_TIME_ANDROID };
+
+        while (numberOfPending > 0)
+        {
+            const PendingFrame &frame = pendingFrames[firstPendingFrame];
+            Nanoseconds displayPresentTime = timestampPending;
+
+            /* Frames are shown in order, so stop at the first one which is not shown yet. */
+            if (getFrameTimestamps(display, surface, frame.id, 1, timestamps, &displayPresentTime) &&
+                displayPresentTime == timestampPending)
+            {
+                break;
+            }
+
+            if (displayPresentTime > 0)
+            {
+                lastLatency = (displayPresentTime - frame.submitTime) / 1000000.0f;
+                averageLatency = averageLatency == 0.0f ? lastLatency : averageLatency + (lastLatency - averageLatency) * latencySmoothing;
+            }
+
+            firstPendingFrame = (firstPendingFrame + 1) % numberOfPendingFrames;
+            numberOfPending--;
+        }
+    }
+
+    bool FramePacer::isPresentationTimeSupported(void) const
+    {
+        return presentationTime != NULL;
+    }
+
+    float FramePacer::getLatency(void) const
+    {
+        return lastLatency;
+    }
+
+    float FramePacer::getAverageLatency(void) const
+    {
+        return averageLatency;
+    }
+}
@@ -0,0 +1,165 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FrameStatistics.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace MaliSDK
+{
+    FrameStatistics::FrameStatistics(size_t capacity)
+        : timer(Timer::RealClock),
+          lastFrameTime(0),
+          started(false),
+          frameTimes(capacity > 0 ? capacity : 1, 0.0f),
+          nextFrame(0),
+          numberOfFrames(0)
+    {
+    }
+
+    void FrameStatistics::frame(void)
+    {
+        long long now = timer.getTimeNanoseconds();
+
+        if (started)
+        {
+            addFrameTime((now - lastFrameTime) / 1000000.0f);
+        }
+
+        lastFrameTime = now;
+        started = true;
+    }
+
+    void FrameStatistics::addFrameTime(float milliseconds)
+    {
+        frameTimes[nextFrame] = milliseconds;
+        nextFrame = (nextFrame + 1) % frameTimes.size();
+
+        if (numberOfFrames < frameTimes.size())
+        {
+            numberOfFrames++;
+        }
+    }
+
+    void FrameStatistics::reset(void)
+    {
+        started = false;
+        nextFrame = 0;
+        numberOfFrames = 0;
+    }
+
+    size_t FrameStatistics::getNumberOfFrames(void) const
+    {
+        return numberOfFrames;
+    }
+
+    void FrameStatistics::getSortedFrameTimes(std::vector<float> &sorted) const
+    {
+        sorted.assign(frameTimes.begin(), frameTimes.begin() + numberOfFrames);
+        std::sort(sorted.begin(), sorted.end());
+    }
+
+    float FrameStatistics::percentile(const std::vector<float> &sorted, float fraction)
+    {
+        if (sorted.empty())
+        {
+            return 0.0f;
+        }
+
+        /* Nearest rank, so the result is always a frame time which really happened. */
+        size_t rank = (size_t)(fraction * sorted.size() + 0.5f);
+        rank = rank > 0 ? rank - 1 : 0;
+
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    float FrameStatistics::getPercentile(float fraction) const
+    {
+        std::vector<float> sorted;
+
+        getSortedFrameTimes(sorted);
+
+        return percentile(sorted, fraction);
+    }
+
+    size_t FrameStatistics::getNumberOfJankyFrames(void) const
+    {
+        std::vector<float> sorted;
+
+        getSortedFrameTimes(sorted);
+
+        float threshold = 2.0f * percentile(sorted, 0.5f);
+
+        return sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), threshold);
+    }
+
+    void FrameStatistics::log(const char *name) const
+    {
+        std::vector<float> sorted;
+
+        getSortedFrameTimes(sorted);
+
+        if (sorted.empty())
+        {
+            LOGI("%s: no frames recorded.\n", name);
+            return;
+        }
+
+        double total = 0.0;
+        for (size_t frameIndex = 0; frameIndex < sorted.size(); frameIndex++)
+        {
+            total += sorted[frameIndex];
+        }
+
+        float median = percentile(sorted, 0.5f);
+        size_t jankyFrames = sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), 2.0f * median);
+
+        LOGI("%s: %u frames, mean %.2f ms, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms, %u janky.\n",
+             name, (unsigned int)sorted.size(), (float)(total / sorted.size()), median,
+             percentile(sorted, 0.95f), percentile(sorted, 0.99f), sorted.back(), (unsigned int)jankyFrames);
+    }
+
+    bool FrameStatistics::writeCSV(const char *filename) const
+    {
+        FILE *file = fopen(filename, "w");
+
+        if (file == NULL)
+        {
+            LOGE("Cannot write frame times to '%s'.\n", filename);
+            return false;
+        }
+
+        fprintf(file, "frame,milliseconds\n");
+
+        /* The oldest frame is the one about to be overwritten once the ring buffer is full. */
+        size_t oldest = numberOfFrames < frameTimes.size() ? 0 : nextFrame;
+        for (size_t frameIndex = 0; frameIndex < numberOfFrames; frameIndex++)
+        {
+            fprintf(file, "%u,%.3f\n", (unsigned int)frameIndex, frameTimes[(oldest + frameIndex) % frameTimes.size()]);
+        }
+
+        bool written = !ferror(file);
+        fclose(file);
+
+        return written;
+    }
+}
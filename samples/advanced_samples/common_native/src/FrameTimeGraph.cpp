@@ -0,0 +1,274 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FrameTimeGraph.h"
+#include "Profiler.h"
+#include "Shader.h"
+#include "Platform.h"
+
+namespace MaliSDK
+{
+    static const char *vertexShaderSource =
+        "#version 100\n"
+        "attribute vec2 a_v2Position;\n"
+        "attribute vec4 a_v4Color;\n"
+        "varying vec4 v_v4Color;\n"
+        "void main()\n"
+        "{\n"
+        "    v_v4Color = a_v4Color;\n"
+        "    gl_Position = vec4(a_v2Position, 0.0, 1.0);\n"
+        "}\n";
+
+    static const char *fragmentShaderSource =
+        "#version 100\n"
+        "precision mediump float;\n"
+        "varying vec4 v_v4Color;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_FragColor = v_v4Color;\n"
+        "}\n";
+
+    /* Name of the Profiler scope measuring the GPU time of the frame. */
+    static const char *frameScopeName = "FrameTimeGraph";
+
+    /* CPU in green, GPU in red and present latency in cyan, then the budget lines and the border. */
+    static const GLubyte lineColors[FrameTimeGraph::NUMBER_OF_LINES][4] =
+    {
+        {  64, 255,  64, 255 },
+        { 255,  64,  64, 255 },
+        {  64, 224, 255, 255 }
+    };
+    static const GLubyte budgetColor[4] = { 160, 160, 160, 255 };
+    static const GLubyte borderColor[4] = { 255, 255, 255, 255 };
+
+    static const float budgets[] = { 1000.0f / 60.0f, 1000.0f / 30.0f };
+
+    FrameTimeGraph::FrameTimeGraph(int windowWidth, int windowHeight, int numberOfFrames, float maximumMilliseconds)
+        : windowWidth(windowWidth),
+          windowHeight(windowHeight),
+          maximumMilliseconds(maximumMilliseconds),
+          timer(Timer::RealClock),
+          frameBegin(0),
+          frameOpen(false),
+          numberOfFrames(numberOfFrames > 2 ? numberOfFrames : 2),
+          nextFrame(0),
+          recordedFrames(0),
+          lastGPUTime(-1.0f),
+          vertexBuffer(0)
+    {
+        setRectangle(0, windowHeight - windowHeight / 5, windowWidth, windowHeight / 5);
+
+        for (int line = 0; line < NUMBER_OF_LINES; line++)
+        {
+            times[line].assign(this->numberOfFrames, -1.0f);
+        }
+
+        /* One segment between each pair of frames per line, the budget lines and the four sides of the border. */
+        vertices.reserve((NUMBER_OF_LINES * (this->numberOfFrames - 1) + sizeof(budgets) / sizeof(budgets[0]) + 4) * 2);
+
+        Shader::processProgramSource(&programID, vertexShaderSource, fragmentShaderSource);
+        iLocPosition = GL_CHECK(glGetAttribLocation(programID, "a_v2Position"));
+        iLocColor = GL_CHECK(glGetAttribLocation(programID, "a_v4Color"));
+
+        GL_CHECK(glGenBuffers(1, &vertexBuffer));
+    }
+
+    FrameTimeGraph::~FrameTimeGraph(void)
+    {
+        GL_CHECK(glDeleteBuffers(1, &vertexBuffer));
+        GL_CHECK(glDeleteProgram(programID));
+        Profiler::resetScope(frameScopeName);
+    }
+
+    void FrameTimeGraph::setRectangle(int x, int y, int width, int height)
+    {
+        left = x;
+        bottom = y;
+        this->width = width;
+        this->height = height;
+    }
+
+    void FrameTimeGraph::beginFrame(void)
+    {
+        if (frameOpen)
+        {
+            LOGE("FrameTimeGraph::beginFrame() called twice without endFrame().\n");
+            return;
+        }
+
+        Profiler::beginScope(frameScopeName);
+        frameBegin = timer.getTimeNanoseconds();
+        frameOpen = true;
+    }
+
+    void FrameTimeGraph::endFrame(const FramePacer *framePacer)
+    {
+        if (!frameOpen)
+        {
+            LOGE("FrameTimeGraph::endFrame() called without beginFrame().\n");
+            return;
+        }
+
+        float cpuTime = (timer.getTimeNanoseconds() - frameBegin) / 1000000.0f;
+        Profiler::endScope();
+        Profiler::endFrame();
+        frameOpen = false;
+
+        /*
+         * The results collected this frame are averaged, usually one. Until the next one arrives
+         * the previous result is repeated, so the line has no gaps while the GPU is a frame behind.
+         */
+        double gpuTime = 0.0;
+        if (Profiler::getGPUAverage(frameScopeName, &gpuTime) > 0)
+        {
+            lastGPUTime = (float)gpuTime;
+            Profiler::resetScope(frameScopeName);
+        }
+
+        float presentTime = -1.0f;
+        if (framePacer != NULL && framePacer->getLatency() > 0.0f)
+        {
+            presentTime = framePacer->getLatency();
+        }
+
+        addFrame(cpuTime, lastGPUTime, presentTime);
+    }
+
+    void FrameTimeGraph::addFrame(float cpuMilliseconds, float gpuMilliseconds, float presentMilliseconds)
+    {
+        times[LINE_CPU][nextFrame] = cpuMilliseconds;
+        times[LINE_GPU][nextFrame] = gpuMilliseconds;
+        times[LINE_PRESENT][nextFrame] = presentMilliseconds;
+
+        nextFrame = (nextFrame + 1) % numberOfFrames;
+        if (recordedFrames < numberOfFrames)
+        {
+            recordedFrames++;
+        }
+    }
+
+    float FrameTimeGraph::getLatest(Line line) const
+    {
+        if (recordedFrames == 0)
+        {
+            return -1.0f;
+        }
+
+        return times[line][(nextFrame + numberOfFrames - 1) % numberOfFrames];
+    }
+
+    void FrameTimeGraph::addLine(float x0, float y0, float x1, float y1, const GLubyte color[4])
+    {
+        Vertex vertex;
+
+        for (int component = 0; component < 4; component++)
+        {
+            vertex.color[component] = color[component];
+        }
+
+        /* Pixel centres to normalized device coordinates. */
+        vertex.position[0] = (x0 + 0.5f) * 2.0f / windowWidth - 1.0f;
+        vertex.position[1] = (y0 + 0.5f) * 2.0f / windowHeight - 1.0f;
+        vertices.push_back(vertex);
+
+        vertex.position[0] = (x1 + 0.5f) * 2.0f / windowWidth - 1.0f;
+        vertex.position[1] = (y1 + 0.5f) * 2.0f / windowHeight - 1.0f;
+        vertices.push_back(vertex);
+    }
+
+    void FrameTimeGraph::draw(void)
+    {
+        vertices.clear();
+
+        float right = (float)(left + width - 1);
+        float top = (float)(bottom + height - 1);
+        float pixelsPerFrame = (width - 1) / (float)(numberOfFrames - 1);
+        float pixelsPerMillisecond = (height - 1) / maximumMilliseconds;
+
+        for (unsigned int budget = 0; budget < sizeof(budgets) / sizeof(budgets[0]); budget++)
+        {
+            if (budgets[budget] < maximumMilliseconds)
+            {
+                float y = bottom + budgets[budget] * pixelsPerMillisecond;
+                addLine((float)left, y, right, y, budgetColor);
+            }
+        }
+
+        addLine((float)left, (float)bottom, right, (float)bottom, borderColor);
+        addLine(right, (float)bottom, right, top, borderColor);
+        addLine(right, top, (float)left, top, borderColor);
+        addLine((float)left, top, (float)left, (float)bottom, borderColor);
+
+        /* The oldest recorded frame is drawn recordedFrames points from the right edge. */
+        int oldestFrame = (nextFrame + numberOfFrames - recordedFrames) % numberOfFrames;
+        int firstColumn = numberOfFrames - recordedFrames;
+
+        for (int line = 0; line < NUMBER_OF_LINES; line++)
+        {
+            for (int point = 1; point < recordedFrames; point++)
+            {
+                float previous = times[line][(oldestFrame + point - 1) % numberOfFrames];
+                float current = times[line][(oldestFrame + point) % numberOfFrames];
+
+                if (previous < 0.0f || current < 0.0f)
+                {
+                    continue;
+                }
+
+                previous = previous < maximumMilliseconds ? previous : maximumMilliseconds;
+                current = current < maximumMilliseconds ? current : maximumMilliseconds;
+
+                addLine(left + (firstColumn + point - 1) * pixelsPerFrame, bottom + previous * pixelsPerMillisecond,
+                        left + (firstColumn + point) * pixelsPerFrame, bottom + current * pixelsPerMillisecond,
+                        lineColors[line]);
+            }
+        }
+
+#if GLES_VERSION == 3
+        GL_CHECK(glBindVertexArray(0));
+#endif
+        /* Orphan the storage of the previous frame, so the driver never waits for the GPU to finish with it. */
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, vertices.capacity() * sizeof(Vertex), NULL, GL_STREAM_DRAW));
+        GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), &vertices[0]));
+
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        GL_CHECK(glDisable(GL_DEPTH_TEST));
+
+        GL_CHECK(glUseProgram(programID));
+        GL_CHECK(glEnableVertexAttribArray(iLocPosition));
+        GL_CHECK(glVertexAttribPointer(iLocPosition, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void *)0));
+        GL_CHECK(glEnableVertexAttribArray(iLocColor));
+        GL_CHECK(glVertexAttribPointer(iLocColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (const void *)(2 * sizeof(GLfloat))));
+
+        GL_CHECK(glDrawArrays(GL_LINES, 0, (GLsizei)vertices.size()));
+
+        GL_CHECK(glDisableVertexAttribArray(iLocColor));
+        GL_CHECK(glDisableVertexAttribArray(iLocPosition));
+
+        if (depthTest)
+        {
+            GL_CHECK(glEnable(GL_DEPTH_TEST));
+        }
+
+        /* Samples draw with client side arrays after the graph, leave no buffer bound. */
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+}
@@ -0,0 +1,180 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FrustumCulling.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FRUSTUM_CULLING_USE_NEON 1
+#else
+#define FRUSTUM_CULLING_USE_NEON 0
+#endif
+
+namespace MaliSDK
+{
+    namespace
+    {
+        const unsigned int numberOfPlanes = 6;
+
+        /*
+         * The scalar versions are used for the remainder of a batch on NEON builds, and for everything otherwise.
+         * They evaluate the plane equations in the same order as the NEON versions, so both give identical results.
+         */
+        inline bool testAABB(const float *planes, const FrustumCulling::AABBBatch &boxes, unsigned int index)
+        {
+            for (unsigned int p = 0; p < numberOfPlanes; p++)
+            {
+                const float *plane = planes + 4 * p;
+
+                /* The corner furthest along the plane normal. If it is not inside, no corner is. */
+                float x = plane[0] >= 0.0f ? boxes.maxX[index] : boxes.minX[index];
+                float y = plane[1] >= 0.0f ? boxes.maxY[index] : boxes.minY[index];
+                float z = plane[2] >= 0.0f ? boxes.maxZ[index] : boxes.minZ[index];
+
+                if (plane[3] + x * plane[0] + y * plane[1] + z * plane[2] <= 0.0f)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        inline bool testSphere(const float *planes, const FrustumCulling::SphereBatch &spheres, unsigned int index)
+        {
+            for (unsigned int p = 0; p < numberOfPlanes; p++)
+            {
+                const float *plane = planes + 4 * p;
+                float distance = plane[3] + spheres.centerX[index] * plane[0] + spheres.centerY[index] * plane[1] + spheres.centerZ[index] * plane[2];
+
+                if (distance < -spheres.radius[index])
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+#if FRUSTUM_CULLING_USE_NEON
+        inline bool anyLaneSet(uint32x4_t mask)
+        {
+            uint32x2_t halves = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+
+            return (vget_lane_u32(halves, 0) | vget_lane_u32(halves, 1)) != 0;
+        }
+
+        /* Writes one byte per lane and returns the number of lanes set. */
+        inline unsigned int storeMask(uint32x4_t mask, unsigned char *visible)
+        {
+            visible[0] = vgetq_lane_u32(mask, 0) ? 1 : 0;
+            visible[1] = vgetq_lane_u32(mask, 1) ? 1 : 0;
+            visible[2] = vgetq_lane_u32(mask, 2) ? 1 : 0;
+            visible[3] = vgetq_lane_u32(mask, 3) ? 1 : 0;
+
+            return visible[0] + visible[1] + visible[2] + visible[3];
+        }
+
+        inline float32x4_t planeDistance(const float *plane, float32x4_t x, float32x4_t y, float32x4_t z)
+        {
+            float32x4_t distance = vdupq_n_f32(plane[3]);
+            distance = vmlaq_n_f32(distance, x, plane[0]);
+            distance = vmlaq_n_f32(distance, y, plane[1]);
+            distance = vmlaq_n_f32(distance, z, plane[2]);
+
+            return distance;
+        }
+#endif
+    }
+
+    unsigned int FrustumCulling::testAABBs(const float *planes, const AABBBatch &boxes, unsigned int count, unsigned char *visible)
+    {
+        unsigned int numberOfVisible = 0;
+        unsigned int index = 0;
+
+#if FRUSTUM_CULLING_USE_NEON
+        for (; index + 4 <= count; index += 4)
+        {
+            float32x4_t minX = vld1q_f32(boxes.minX + index);
+            float32x4_t minY = vld1q_f32(boxes.minY + index);
+            float32x4_t minZ = vld1q_f32(boxes.minZ + index);
+            float32x4_t maxX = vld1q_f32(boxes.maxX + index);
+            float32x4_t maxY = vld1q_f32(boxes.maxY + index);
+            float32x4_t maxZ = vld1q_f32(boxes.maxZ + index);
+            uint32x4_t inside = vdupq_n_u32(0xffffffffu);
+
+            for (unsigned int p = 0; p < numberOfPlanes && anyLaneSet(inside); p++)
+            {
+                const float *plane = planes + 4 * p;
+                float32x4_t distance = planeDistance(plane,
+                                                     plane[0] >= 0.0f ? maxX : minX,
+                                                     plane[1] >= 0.0f ? maxY : minY,
+                                                     plane[2] >= 0.0f ? maxZ : minZ);
+
+                inside = vandq_u32(inside, vcgtq_f32(distance, vdupq_n_f32(0.0f)));
+            }
+
+            numberOfVisible += storeMask(inside, visible + index);
+        }
+#endif
+
+        for (; index < count; index++)
+        {
+            visible[index] = testAABB(planes, boxes, index) ? 1 : 0;
+            numberOfVisible += visible[index];
+        }
+
+        return numberOfVisible;
+    }
+
+    unsigned int FrustumCulling::testSpheres(const float *planes, const SphereBatch &spheres, unsigned int count, unsigned char *visible)
+    {
+        unsigned int numberOfVisible = 0;
+        unsigned int index = 0;
+
+#if FRUSTUM_CULLING_USE_NEON
+        for (; index + 4 <= count; index += 4)
+        {
+            float32x4_t x = vld1q_f32(spheres.centerX + index);
+            float32x4_t y = vld1q_f32(spheres.centerY + index);
+            float32x4_t z = vld1q_f32(spheres.centerZ + index);
+            float32x4_t negativeRadius = vnegq_f32(vld1q_f32(spheres.radius + index));
+            uint32x4_t inside = vdupq_n_u32(0xffffffffu);
+
+            for (unsigned int p = 0; p < numberOfPlanes && anyLaneSet(inside); p++)
+            {
+                float32x4_t distance = planeDistance(planes + 4 * p, x, y, z);
+
+                inside = vandq_u32(inside, vcgeq_f32(distance, negativeRadius));
+            }
+
+            numberOfVisible += storeMask(inside, visible + index);
+        }
+#endif
+
+        for (; index < count; index++)
+        {
+            visible[index] = testSphere(planes, spheres, index) ? 1 : 0;
+            numberOfVisible += visible[index];
+        }
+
+        return numberOfVisible;
+    }
+}
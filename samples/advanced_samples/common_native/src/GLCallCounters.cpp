@@ -0,0 +1,47 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GLCallCounters.h"
+
+#include <cstdio>
+
+namespace MaliSDK
+{
+    GLCallCounters::Counts GLCallCounters::current = GLCallCounters::Counts();
+    GLCallCounters::Counts GLCallCounters::lastFrame = GLCallCounters::Counts();
+
+    void GLCallCounters::endFrame(void)
+    {
+        lastFrame = current;
+        current = Counts();
+    }
+
+    const GLCallCounters::Counts &GLCallCounters::getLastFrame(void)
+    {
+        return lastFrame;
+    }
+
+    void GLCallCounters::getLastFrameString(char *buffer, size_t size)
+    {
+        snprintf(buffer, size, "Draws %u Dispatches %u Binds %u Uniforms %u State %u Uploads %u (%.1f KB) Textures %u",
+                 lastFrame.drawCalls, lastFrame.dispatches, lastFrame.binds, lastFrame.uniforms, lastFrame.stateChanges,
+                 lastFrame.bufferUploads, lastFrame.bufferUploadBytes / 1024.0, lastFrame.textureUploads);
+    }
+}
@@ -0,0 +1,2439 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* The functions below make the real calls, the macros must not replace them here. */
+#define GL_CAPTURE_IMPLEMENTATION
+
+#include "GLCapture.h"
+#include "Platform.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <cstring>
+#include <string>
+
+namespace MaliSDK
+{
+    FILE *GLCapture::file = NULL;
+    bool GLCapture::capturing = false;
+    bool GLCapture::inSetup = false;
+    unsigned int GLCapture::remainingFrames = 0;
+    std::vector<unsigned char> GLCapture::command;
+
+    static pthread_t captureThread;
+
+    bool GLCapture::start(const char *path, int width, int height, unsigned int frames)
+    {
+#if defined(GL_CAPTURE)
+        if (file != NULL)
+        {
+            LOGE("A capture is already being recorded.\n");
+            return false;
+        }
+
+        file = fopen(path, "wb");
+        if (file == NULL)
+        {
+            LOGE("Cannot write the capture to '%s'.\n", path);
+            return false;
+        }
+
+        Header header;
+        memcpy(header.magic, "GLCP", 4);
+        header.version = version;
+        header.width = width;
+        header.height = height;
+        header.glesVersion = GLES_VERSION;
+        fwrite(&header, sizeof(header), 1, file);
+
+        captureThread = pthread_self();
+        capturing = true;
+        inSetup = true;
+        remainingFrames = frames;
+
+        LOGI("Capturing the setup and %u frames to %s.\n", frames, path);
+        return true;
+#else
+        (void)path;
+        (void)width;
+        (void)height;
+        (void)frames;
+        LOGE("Build with GL_CAPTURE to capture OpenGL ES calls.\n");
+        return false;
+#endif
+    }
+
+    void GLCapture::endSetup(void)
+    {
+        if (!isCapturing() || !inSetup)
+        {
+            return;
+        }
+
+        begin(CommandEndSetup);
+        end();
+        inSetup = false;
+
+        if (remainingFrames == 0)
+        {
+            stop();
+        }
+    }
+
+    void GLCapture::endFrame(void)
+    {
+        if (!isCapturing() || inSetup)
+        {
+            return;
+        }
+
+        begin(CommandEndFrame);
+        end();
+
+        if (--remainingFrames == 0)
+        {
+            stop();
+        }
+    }
+
+    void GLCapture::stop(void)
+    {
+        if (file == NULL)
+        {
+            return;
+        }
+
+        bool written = !ferror(file);
+        if (fclose(file) != 0)
+        {
+            written = false;
+        }
+        file = NULL;
+        capturing = false;
+
+        if (written)
+        {
+            LOGI("Capture finished.\n");
+        }
+        else
+        {
+            LOGE("Failed to write the capture.\n");
+        }
+    }
+
+    bool GLCapture::isCapturing(void)
+    {
+        return capturing && pthread_equal(pthread_self(), captureThread);
+    }
+
+    void GLCapture::begin(Command command)
+    {
+        GLCapture::command.clear();
+        writeUint(command);
+        /* Size of the arguments, filled in by end(). */
+        writeUint(0);
+    }
+
+    void GLCapture::writeUint(unsigned int value)
+    {
+        writeBytes(&value, sizeof(value));
+    }
+
+    void GLCapture::writeInt(int value)
+    {
+        writeBytes(&value, sizeof(value));
+    }
+
+    void GLCapture::writeFloat(float value)
+    {
+        writeBytes(&value, sizeof(value));
+    }
+
+    void GLCapture::writeUint64(unsigned long long value)
+    {
+        writeBytes(&value, sizeof(value));
+    }
+
+    void GLCapture::writeData(const void *data, size_t size)
+    {
+        static const unsigned char padding[3] = { 0, 0, 0 };
+
+        writeUint64(size);
+        writeBytes(data, size);
+        writeBytes(padding, (4 - size % 4) % 4);
+    }
+
+    void GLCapture::end(void)
+    {
+        unsigned int size = command.size() - 2 * sizeof(unsigned int);
+        memcpy(&command[sizeof(unsigned int)], &size, sizeof(size));
+        fwrite(&command[0], command.size(), 1, file);
+    }
+
+    void GLCapture::writeBytes(const void *data, size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        command.insert(command.end(), bytes, bytes + size);
+    }
+}
+
+extern "C" int MaliSDK_GLCapture_start(const char *path, int width, int height, unsigned int frames)
+{
+    return MaliSDK::GLCapture::start(path, width, height, frames) ? 1 : 0;
+}
+
+extern "C" void MaliSDK_GLCapture_endSetup(void)
+{
+    MaliSDK::GLCapture::endSetup();
+}
+
+extern "C" void MaliSDK_GLCapture_endFrame(void)
+{
+    MaliSDK::GLCapture::endFrame();
+}
+
+#if defined(GL_CAPTURE)
+
+namespace MaliSDK
+{
+    namespace
+    {
+        /* Commands with up to four 32 bit arguments, most of the state. */
+        void record(GLCapture::Command command, GLuint a)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(command);
+                GLCapture::writeUint(a);
+                GLCapture::end();
+            }
+        }
+
+        void record(GLCapture::Command command, GLuint a, GLuint b)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(command);
+                GLCapture::writeUint(a);
+                GLCapture::writeUint(b);
+                GLCapture::end();
+            }
+        }
+
+        void record(GLCapture::Command command, GLuint a, GLuint b, GLuint c)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(command);
+                GLCapture::writeUint(a);
+                GLCapture::writeUint(b);
+                GLCapture::writeUint(c);
+                GLCapture::end();
+            }
+        }
+
+        void record(GLCapture::Command command, GLuint a, GLuint b, GLuint c, GLuint d)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(command);
+                GLCapture::writeUint(a);
+                GLCapture::writeUint(b);
+                GLCapture::writeUint(c);
+                GLCapture::writeUint(d);
+                GLCapture::end();
+            }
+        }
+
+        void recordFloats(GLCapture::Command command, unsigned int count, GLfloat a, GLfloat b = 0.0f, GLfloat c = 0.0f, GLfloat d = 0.0f)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLfloat values[] = { a, b, c, d };
+
+                GLCapture::begin(command);
+                for (unsigned int i = 0; i < count; i++)
+                {
+                    GLCapture::writeFloat(values[i]);
+                }
+                GLCapture::end();
+            }
+        }
+
+        void recordNames(GLCapture::Command command, GLsizei n, const GLuint *names)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(command);
+                GLCapture::writeInt(n);
+                for (GLsizei i = 0; i < n; i++)
+                {
+                    GLCapture::writeUint(names[i]);
+                }
+                GLCapture::end();
+            }
+        }
+
+        void recordUniform(GLuint program, GLCapture::UniformType type, unsigned int columns, unsigned int rows,
+                           GLint location, GLsizei count, GLboolean transpose, const void *values)
+        {
+            GLCapture::begin(GLCapture::CommandUniform);
+            GLCapture::writeUint(program);
+            GLCapture::writeUint(type);
+            GLCapture::writeUint(columns);
+            GLCapture::writeUint(rows);
+            GLCapture::writeInt(location);
+            GLCapture::writeInt(count);
+            GLCapture::writeUint(transpose);
+            /* All the component types are 32 bits. */
+            GLCapture::writeData(values, count * columns * rows * 4);
+            GLCapture::end();
+        }
+
+        void writeSource(const void *data, size_t size, GLenum binding)
+        {
+            GLint buffer = 0;
+            glGetIntegerv(binding, &buffer);
+
+            if (buffer != 0)
+            {
+                GLCapture::writeUint(GLCapture::SourceOffset);
+                GLCapture::writeUint64((uintptr_t)data);
+            }
+            else if (data == NULL)
+            {
+                GLCapture::writeUint(GLCapture::SourceNone);
+            }
+            else
+            {
+                GLCapture::writeUint(GLCapture::SourceData);
+                GLCapture::writeData(data, size);
+            }
+        }
+
+        void writePixels(const void *pixels, size_t size)
+        {
+#if GLES_VERSION == 3
+            writeSource(pixels, size, GL_PIXEL_UNPACK_BUFFER_BINDING);
+#else
+            if (pixels == NULL)
+            {
+                GLCapture::writeUint(GLCapture::SourceNone);
+            }
+            else
+            {
+                GLCapture::writeUint(GLCapture::SourceData);
+                GLCapture::writeData(pixels, size);
+            }
+#endif
+        }
+
+        size_t getTypeSize(GLenum type)
+        {
+            switch (type)
+            {
+                case GL_UNSIGNED_BYTE:
+                case GL_BYTE:
+                    return 1;
+                case GL_UNSIGNED_SHORT:
+                case GL_SHORT:
+                    return 2;
+                case GL_UNSIGNED_INT:
+                case GL_INT:
+                case GL_FLOAT:
+                case GL_FIXED:
+                    return 4;
+#if GLES_VERSION == 3
+                case GL_HALF_FLOAT:
+                    return 2;
+#endif
+                default:
+                    return 0;
+            }
+        }
+
+        /* Bytes of pixels glTexImage*() reads, following the unpack state. */
+        size_t getImageSize(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type)
+        {
+            if (width == 0 || height == 0 || depth == 0)
+            {
+                return 0;
+            }
+
+            size_t components = 4;
+            switch (format)
+            {
+                case GL_ALPHA:
+                case GL_LUMINANCE:
+                case GL_DEPTH_COMPONENT:
+#if GLES_VERSION == 3
+                case GL_RED:
+                case GL_RED_INTEGER:
+#endif
+                    components = 1;
+                    break;
+                case GL_LUMINANCE_ALPHA:
+#if GLES_VERSION == 3
+                case GL_RG:
+                case GL_RG_INTEGER:
+                case GL_DEPTH_STENCIL:
+#endif
+                    components = 2;
+                    break;
+                case GL_RGB:
+#if GLES_VERSION == 3
+                case GL_RGB_INTEGER:
+#endif
+                    components = 3;
+                    break;
+            }
+
+            size_t pixelSize = components * getTypeSize(type);
+            switch (type)
+            {
+                case GL_UNSIGNED_SHORT_5_6_5:
+                case GL_UNSIGNED_SHORT_4_4_4_4:
+                case GL_UNSIGNED_SHORT_5_5_5_1:
+                    pixelSize = 2;
+                    break;
+#if GLES_VERSION == 3
+                case GL_UNSIGNED_INT_2_10_10_10_REV:
+                case GL_UNSIGNED_INT_10F_11F_11F_REV:
+                case GL_UNSIGNED_INT_5_9_9_9_REV:
+                case GL_UNSIGNED_INT_24_8:
+                    pixelSize = 4;
+                    break;
+                case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+                    pixelSize = 8;
+                    break;
+#endif
+            }
+
+            GLint alignment = 4;
+            GLint rowLength = 0;
+            GLint imageHeight = 0;
+            GLint skipPixels = 0;
+            GLint skipRows = 0;
+            GLint skipImages = 0;
+            glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+#if GLES_VERSION == 3
+            glGetIntegerv(GL_UNPACK_ROW_LENGTH, &rowLength);
+            glGetIntegerv(GL_UNPACK_IMAGE_HEIGHT, &imageHeight);
+            glGetIntegerv(GL_UNPACK_SKIP_PIXELS, &skipPixels);
+            glGetIntegerv(GL_UNPACK_SKIP_ROWS, &skipRows);
+            glGetIntegerv(GL_UNPACK_SKIP_IMAGES, &skipImages);
+#endif
+
+            size_t rowSize = (rowLength > 0 ? rowLength : width) * pixelSize;
+            rowSize = (rowSize + alignment - 1) / alignment * alignment;
+            size_t imageSize = rowSize * (imageHeight > 0 ? imageHeight : height);
+
+            return (skipImages + depth - 1) * imageSize + (skipRows + height - 1) * rowSize + (skipPixels + width) * pixelSize;
+        }
+
+        /* Bound buffer of a glMapBufferRange() with write access, recorded at glUnmapBuffer(). */
+        struct Mapping
+        {
+            GLenum target;
+            GLintptr offset;
+            GLsizeiptr length;
+            const void *data;
+        };
+
+        std::vector<Mapping> mappings;
+
+        /*
+         * Vertex attributes read from client memory. The pointer alone tells nothing about how much will be read,
+         * so the vertices are recorded at the draws, where the number of vertices is known.
+         */
+        struct ClientArray
+        {
+            bool enabled;
+            bool integer;
+            GLint size;
+            GLenum type;
+            GLboolean normalized;
+            GLsizei stride;
+            const void *pointer;
+        };
+
+        std::vector<ClientArray> clientArrays;
+
+        bool isDefaultVertexArrayBound(void)
+        {
+#if GLES_VERSION == 3
+            GLint vertexArray = 0;
+            glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+
+            return vertexArray == 0;
+#else
+            return true;
+#endif
+        }
+
+        void setClientArray(GLuint index, bool integer, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+        {
+            if (!isDefaultVertexArrayBound())
+            {
+                return;
+            }
+
+            if (clientArrays.size() <= index)
+            {
+                clientArrays.resize(index + 1, ClientArray());
+            }
+
+            ClientArray &array = clientArrays[index];
+            array.integer = integer;
+            array.size = size;
+            array.type = type;
+            array.normalized = normalized;
+            array.stride = stride;
+            array.pointer = pointer;
+        }
+
+        void setClientArrayEnabled(GLuint index, bool enabled)
+        {
+            if (!GLCapture::isCapturing() || !isDefaultVertexArrayBound())
+            {
+                return;
+            }
+
+            if (clientArrays.size() <= index)
+            {
+                clientArrays.resize(index + 1, ClientArray());
+            }
+            clientArrays[index].enabled = enabled;
+        }
+
+        /* Record the first vertices of the enabled client arrays, before a draw reading them. */
+        void recordClientArrays(GLuint vertices)
+        {
+            if (clientArrays.empty() || vertices == 0 || !isDefaultVertexArrayBound())
+            {
+                return;
+            }
+
+            for (size_t index = 0; index < clientArrays.size(); index++)
+            {
+                const ClientArray &array = clientArrays[index];
+                if (!array.enabled || array.pointer == NULL)
+                {
+                    continue;
+                }
+
+                size_t elementSize = array.size * getTypeSize(array.type);
+#if GLES_VERSION == 3
+                if (array.type == GL_INT_2_10_10_10_REV || array.type == GL_UNSIGNED_INT_2_10_10_10_REV)
+                {
+                    elementSize = 4;
+                }
+#endif
+                size_t stride = array.stride != 0 ? array.stride : elementSize;
+
+                GLCapture::begin(GLCapture::CommandVertexAttribPointer);
+                GLCapture::writeUint(index);
+                GLCapture::writeUint(array.integer);
+                GLCapture::writeInt(array.size);
+                GLCapture::writeUint(array.type);
+                GLCapture::writeUint(array.normalized);
+                GLCapture::writeInt(array.stride);
+                GLCapture::writeUint(GLCapture::SourceData);
+                GLCapture::writeData(array.pointer, (vertices - 1) * stride + elementSize);
+                GLCapture::end();
+            }
+        }
+
+        /* Vertices a glDrawElements() reads, with the indices in client memory. Returns 0 for an element array buffer. */
+        GLuint getClientIndexedVertices(GLsizei count, GLenum type, const void *indices)
+        {
+            GLint elementBuffer = 0;
+            glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elementBuffer);
+
+            if (elementBuffer != 0 || indices == NULL)
+            {
+                bool clientArrayEnabled = false;
+                for (size_t index = 0; index < clientArrays.size(); index++)
+                {
+                    clientArrayEnabled = clientArrayEnabled || (clientArrays[index].enabled && clientArrays[index].pointer != NULL);
+                }
+
+                static bool reported = false;
+                if (clientArrayEnabled && !reported && isDefaultVertexArrayBound())
+                {
+                    LOGE("GLCapture: client side vertex arrays drawn with an element array buffer are not captured.\n");
+                    reported = true;
+                }
+                return 0;
+            }
+
+            GLuint maximum = 0;
+            for (GLsizei i = 0; i < count; i++)
+            {
+                GLuint index = 0;
+                switch (type)
+                {
+                    case GL_UNSIGNED_BYTE:
+                        index = static_cast<const GLubyte *>(indices)[i];
+                        break;
+                    case GL_UNSIGNED_SHORT:
+                        index = static_cast<const GLushort *>(indices)[i];
+                        break;
+                    default:
+                        index = static_cast<const GLuint *>(indices)[i];
+                        break;
+                }
+                maximum = index > maximum ? index : maximum;
+            }
+
+            return count > 0 ? maximum + 1 : 0;
+        }
+
+        void writeIndices(GLsizei count, GLenum type, const void *indices)
+        {
+            writeSource(indices, count * getTypeSize(type), GL_ELEMENT_ARRAY_BUFFER_BINDING);
+        }
+    }
+
+    namespace GLCaptured
+    {
+        void glGenBuffers(GLsizei n, GLuint *buffers)
+        {
+            ::glGenBuffers(n, buffers);
+            recordNames(GLCapture::CommandGenBuffers, n, buffers);
+        }
+
+        void glDeleteBuffers(GLsizei n, const GLuint *buffers)
+        {
+            recordNames(GLCapture::CommandDeleteBuffers, n, buffers);
+            ::glDeleteBuffers(n, buffers);
+        }
+
+        void glGenTextures(GLsizei n, GLuint *textures)
+        {
+            ::glGenTextures(n, textures);
+            recordNames(GLCapture::CommandGenTextures, n, textures);
+        }
+
+        void glDeleteTextures(GLsizei n, const GLuint *textures)
+        {
+            recordNames(GLCapture::CommandDeleteTextures, n, textures);
+            ::glDeleteTextures(n, textures);
+        }
+
+        void glGenFramebuffers(GLsizei n, GLuint *framebuffers)
+        {
+            ::glGenFramebuffers(n, framebuffers);
+            recordNames(GLCapture::CommandGenFramebuffers, n, framebuffers);
+        }
+
+        void glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
+        {
+            recordNames(GLCapture::CommandDeleteFramebuffers, n, framebuffers);
+            ::glDeleteFramebuffers(n, framebuffers);
+        }
+
+        void glGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
+        {
+            ::glGenRenderbuffers(n, renderbuffers);
+            recordNames(GLCapture::CommandGenRenderbuffers, n, renderbuffers);
+        }
+
+        void glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
+        {
+            recordNames(GLCapture::CommandDeleteRenderbuffers, n, renderbuffers);
+            ::glDeleteRenderbuffers(n, renderbuffers);
+        }
+
+        void glBindBuffer(GLenum target, GLuint buffer)
+        {
+            record(GLCapture::CommandBindBuffer, target, buffer);
+            ::glBindBuffer(target, buffer);
+        }
+
+        void glBindTexture(GLenum target, GLuint texture)
+        {
+            record(GLCapture::CommandBindTexture, target, texture);
+            ::glBindTexture(target, texture);
+        }
+
+        void glBindFramebuffer(GLenum target, GLuint framebuffer)
+        {
+            record(GLCapture::CommandBindFramebuffer, target, framebuffer);
+            ::glBindFramebuffer(target, framebuffer);
+        }
+
+        void glBindRenderbuffer(GLenum target, GLuint renderbuffer)
+        {
+            record(GLCapture::CommandBindRenderbuffer, target, renderbuffer);
+            ::glBindRenderbuffer(target, renderbuffer);
+        }
+
+        void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandBufferData);
+                GLCapture::writeUint(target);
+                GLCapture::writeUint64(size);
+                GLCapture::writeUint(usage);
+                GLCapture::writeUint(data != NULL ? GLCapture::SourceData : GLCapture::SourceNone);
+                if (data != NULL)
+                {
+                    GLCapture::writeData(data, size);
+                }
+                GLCapture::end();
+            }
+            ::glBufferData(target, size, data, usage);
+        }
+
+        void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandBufferSubData);
+                GLCapture::writeUint(target);
+                GLCapture::writeUint64(offset);
+                GLCapture::writeData(data, size);
+                GLCapture::end();
+            }
+            ::glBufferSubData(target, offset, size, data);
+        }
+
+        void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandTexImage2D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(level);
+                GLCapture::writeInt(internalformat);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::writeInt(border);
+                GLCapture::writeUint(format);
+                GLCapture::writeUint(type);
+                writePixels(pixels, getImageSize(width, height, 1, format, type));
+                GLCapture::end();
+            }
+            ::glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+        }
+
+        void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandTexSubImage2D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(level);
+                GLCapture::writeInt(xoffset);
+                GLCapture::writeInt(yoffset);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::writeUint(format);
+                GLCapture::writeUint(type);
+                writePixels(pixels, getImageSize(width, height, 1, format, type));
+                GLCapture::end();
+            }
+            ::glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+        }
+
+        void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandCompressedTexImage2D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(level);
+                GLCapture::writeUint(internalformat);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::writeInt(border);
+                GLCapture::writeInt(imageSize);
+                writePixels(data, imageSize);
+                GLCapture::end();
+            }
+            ::glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+        }
+
+        void glCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void *data)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandCompressedTexSubImage2D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(level);
+                GLCapture::writeInt(xoffset);
+                GLCapture::writeInt(yoffset);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::writeUint(format);
+                GLCapture::writeInt(imageSize);
+                writePixels(data, imageSize);
+                GLCapture::end();
+            }
+            ::glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, data);
+        }
+
+        void glGenerateMipmap(GLenum target)
+        {
+            record(GLCapture::CommandGenerateMipmap, target);
+            ::glGenerateMipmap(target);
+        }
+
+        void glPixelStorei(GLenum pname, GLint param)
+        {
+            record(GLCapture::CommandPixelStorei, pname, param);
+            ::glPixelStorei(pname, param);
+        }
+
+        void glTexParameteri(GLenum target, GLenum pname, GLint param)
+        {
+            record(GLCapture::CommandTexParameteri, target, pname, param);
+            ::glTexParameteri(target, pname, param);
+        }
+
+        void glTexParameterf(GLenum target, GLenum pname, GLfloat param)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandTexParameterf);
+                GLCapture::writeUint(target);
+                GLCapture::writeUint(pname);
+                GLCapture::writeFloat(param);
+                GLCapture::end();
+            }
+            ::glTexParameterf(target, pname, param);
+        }
+
+        void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandFramebufferTexture2D);
+                GLCapture::writeUint(target);
+                GLCapture::writeUint(attachment);
+                GLCapture::writeUint(textarget);
+                GLCapture::writeUint(texture);
+                GLCapture::writeInt(level);
+                GLCapture::end();
+            }
+            ::glFramebufferTexture2D(target, attachment, textarget, texture, level);
+        }
+
+        void glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+        {
+            record(GLCapture::CommandFramebufferRenderbuffer, target, attachment, renderbuffertarget, renderbuffer);
+            ::glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+        }
+
+        void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+        {
+            record(GLCapture::CommandRenderbufferStorage, target, internalformat, width, height);
+            ::glRenderbufferStorage(target, internalformat, width, height);
+        }
+
+        GLuint glCreateShader(GLenum type)
+        {
+            GLuint shader = ::glCreateShader(type);
+            record(GLCapture::CommandCreateShader, type, shader);
+            return shader;
+        }
+
+        void glShaderSource(GLuint shader, GLsizei count, const GLchar *const*string, const GLint *length)
+        {
+            if (GLCapture::isCapturing())
+            {
+                /* The strings are joined, the replay has a single one. */
+                std::string source;
+                for (GLsizei i = 0; i < count; i++)
+                {
+                    if (length != NULL && length[i] >= 0)
+                    {
+                        source.append(string[i], length[i]);
+                    }
+                    else
+                    {
+                        source.append(string[i]);
+                    }
+                }
+
+                GLCapture::begin(GLCapture::CommandShaderSource);
+                GLCapture::writeUint(shader);
+                GLCapture::writeData(source.data(), source.size());
+                GLCapture::end();
+            }
+            ::glShaderSource(shader, count, string, length);
+        }
+
+        void glCompileShader(GLuint shader)
+        {
+            record(GLCapture::CommandCompileShader, shader);
+            ::glCompileShader(shader);
+        }
+
+        void glDeleteShader(GLuint shader)
+        {
+            record(GLCapture::CommandDeleteShader, shader);
+            ::glDeleteShader(shader);
+        }
+
+        GLuint glCreateProgram(void)
+        {
+            GLuint program = ::glCreateProgram();
+            record(GLCapture::CommandCreateProgram, program);
+            return program;
+        }
+
+        void glAttachShader(GLuint program, GLuint shader)
+        {
+            record(GLCapture::CommandAttachShader, program, shader);
+            ::glAttachShader(program, shader);
+        }
+
+        void glDetachShader(GLuint program, GLuint shader)
+        {
+            record(GLCapture::CommandDetachShader, program, shader);
+            ::glDetachShader(program, shader);
+        }
+
+        void glBindAttribLocation(GLuint program, GLuint index, const GLchar *name)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandBindAttribLocation);
+                GLCapture::writeUint(program);
+                GLCapture::writeUint(index);
+                GLCapture::writeData(name, strlen(name));
+                GLCapture::end();
+            }
+            ::glBindAttribLocation(program, index, name);
+        }
+
+        void glLinkProgram(GLuint program)
+        {
+            record(GLCapture::CommandLinkProgram, program);
+            ::glLinkProgram(program);
+        }
+
+        void glUseProgram(GLuint program)
+        {
+            record(GLCapture::CommandUseProgram, program);
+            ::glUseProgram(program);
+        }
+
+        void glDeleteProgram(GLuint program)
+        {
+            record(GLCapture::CommandDeleteProgram, program);
+            ::glDeleteProgram(program);
+        }
+
+        GLint glGetUniformLocation(GLuint program, const GLchar *name)
+        {
+            GLint location = ::glGetUniformLocation(program, name);
+
+            /* Locations may differ between runs, the replay looks the name up again. */
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandGetUniformLocation);
+                GLCapture::writeUint(program);
+                GLCapture::writeInt(location);
+                GLCapture::writeData(name, strlen(name));
+                GLCapture::end();
+            }
+            return location;
+        }
+
+        void glUniform1f(GLint location, GLfloat v0)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLfloat values[] = { v0 };
+                recordUniform(0, GLCapture::UniformFloat, 1, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform1f(location, v0);
+        }
+
+        void glUniform2f(GLint location, GLfloat v0, GLfloat v1)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLfloat values[] = { v0, v1 };
+                recordUniform(0, GLCapture::UniformFloat, 2, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform2f(location, v0, v1);
+        }
+
+        void glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLfloat values[] = { v0, v1, v2 };
+                recordUniform(0, GLCapture::UniformFloat, 3, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform3f(location, v0, v1, v2);
+        }
+
+        void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLfloat values[] = { v0, v1, v2, v3 };
+                recordUniform(0, GLCapture::UniformFloat, 4, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform4f(location, v0, v1, v2, v3);
+        }
+
+        void glUniform1i(GLint location, GLint v0)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLint values[] = { v0 };
+                recordUniform(0, GLCapture::UniformInt, 1, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform1i(location, v0);
+        }
+
+        void glUniform2i(GLint location, GLint v0, GLint v1)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLint values[] = { v0, v1 };
+                recordUniform(0, GLCapture::UniformInt, 2, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform2i(location, v0, v1);
+        }
+
+        void glUniform3i(GLint location, GLint v0, GLint v1, GLint v2)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLint values[] = { v0, v1, v2 };
+                recordUniform(0, GLCapture::UniformInt, 3, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform3i(location, v0, v1, v2);
+        }
+
+        void glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLint values[] = { v0, v1, v2, v3 };
+                recordUniform(0, GLCapture::UniformInt, 4, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform4i(location, v0, v1, v2, v3);
+        }
+
+        void glUniform1fv(GLint location, GLsizei count, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 1, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform1fv(location, count, value);
+        }
+
+        void glUniform2fv(GLint location, GLsizei count, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 2, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform2fv(location, count, value);
+        }
+
+        void glUniform3fv(GLint location, GLsizei count, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 3, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform3fv(location, count, value);
+        }
+
+        void glUniform4fv(GLint location, GLsizei count, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 4, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform4fv(location, count, value);
+        }
+
+        void glUniform1iv(GLint location, GLsizei count, const GLint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformInt, 1, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform1iv(location, count, value);
+        }
+
+        void glUniform2iv(GLint location, GLsizei count, const GLint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformInt, 2, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform2iv(location, count, value);
+        }
+
+        void glUniform3iv(GLint location, GLsizei count, const GLint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformInt, 3, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform3iv(location, count, value);
+        }
+
+        void glUniform4iv(GLint location, GLsizei count, const GLint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformInt, 4, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform4iv(location, count, value);
+        }
+
+        void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 2, 2, location, count, transpose, value);
+            }
+            ::glUniformMatrix2fv(location, count, transpose, value);
+        }
+
+        void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 3, 3, location, count, transpose, value);
+            }
+            ::glUniformMatrix3fv(location, count, transpose, value);
+        }
+
+        void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 4, 4, location, count, transpose, value);
+            }
+            ::glUniformMatrix4fv(location, count, transpose, value);
+        }
+
+#if GLES_VERSION == 3
+        void glUniform1ui(GLint location, GLuint v0)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLuint values[] = { v0 };
+                recordUniform(0, GLCapture::UniformUnsignedInt, 1, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform1ui(location, v0);
+        }
+
+        void glUniform2ui(GLint location, GLuint v0, GLuint v1)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLuint values[] = { v0, v1 };
+                recordUniform(0, GLCapture::UniformUnsignedInt, 2, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform2ui(location, v0, v1);
+        }
+
+        void glUniform3ui(GLint location, GLuint v0, GLuint v1, GLuint v2)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLuint values[] = { v0, v1, v2 };
+                recordUniform(0, GLCapture::UniformUnsignedInt, 3, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform3ui(location, v0, v1, v2);
+        }
+
+        void glUniform4ui(GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLuint values[] = { v0, v1, v2, v3 };
+                recordUniform(0, GLCapture::UniformUnsignedInt, 4, 1, location, 1, GL_FALSE, values);
+            }
+            ::glUniform4ui(location, v0, v1, v2, v3);
+        }
+
+        void glUniform1uiv(GLint location, GLsizei count, const GLuint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformUnsignedInt, 1, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform1uiv(location, count, value);
+        }
+
+        void glUniform2uiv(GLint location, GLsizei count, const GLuint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformUnsignedInt, 2, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform2uiv(location, count, value);
+        }
+
+        void glUniform3uiv(GLint location, GLsizei count, const GLuint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformUnsignedInt, 3, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform3uiv(location, count, value);
+        }
+
+        void glUniform4uiv(GLint location, GLsizei count, const GLuint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformUnsignedInt, 4, 1, location, count, GL_FALSE, value);
+            }
+            ::glUniform4uiv(location, count, value);
+        }
+
+        void glUniformMatrix2x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 2, 3, location, count, transpose, value);
+            }
+            ::glUniformMatrix2x3fv(location, count, transpose, value);
+        }
+
+        void glUniformMatrix3x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 3, 2, location, count, transpose, value);
+            }
+            ::glUniformMatrix3x2fv(location, count, transpose, value);
+        }
+
+        void glUniformMatrix2x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 2, 4, location, count, transpose, value);
+            }
+            ::glUniformMatrix2x4fv(location, count, transpose, value);
+        }
+
+        void glUniformMatrix4x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 4, 2, location, count, transpose, value);
+            }
+            ::glUniformMatrix4x2fv(location, count, transpose, value);
+        }
+
+        void glUniformMatrix3x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 3, 4, location, count, transpose, value);
+            }
+            ::glUniformMatrix3x4fv(location, count, transpose, value);
+        }
+
+        void glUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(0, GLCapture::UniformFloat, 4, 3, location, count, transpose, value);
+            }
+            ::glUniformMatrix4x3fv(location, count, transpose, value);
+        }
+
+        void glProgramUniform1f(GLuint program, GLint location, GLfloat v0)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLfloat values[] = { v0 };
+                recordUniform(program, GLCapture::UniformFloat, 1, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform1f(program, location, v0);
+        }
+
+        void glProgramUniform2f(GLuint program, GLint location, GLfloat v0, GLfloat v1)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLfloat values[] = { v0, v1 };
+                recordUniform(program, GLCapture::UniformFloat, 2, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform2f(program, location, v0, v1);
+        }
+
+        void glProgramUniform3f(GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLfloat values[] = { v0, v1, v2 };
+                recordUniform(program, GLCapture::UniformFloat, 3, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform3f(program, location, v0, v1, v2);
+        }
+
+        void glProgramUniform4f(GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLfloat values[] = { v0, v1, v2, v3 };
+                recordUniform(program, GLCapture::UniformFloat, 4, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform4f(program, location, v0, v1, v2, v3);
+        }
+
+        void glProgramUniform1i(GLuint program, GLint location, GLint v0)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLint values[] = { v0 };
+                recordUniform(program, GLCapture::UniformInt, 1, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform1i(program, location, v0);
+        }
+
+        void glProgramUniform2i(GLuint program, GLint location, GLint v0, GLint v1)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLint values[] = { v0, v1 };
+                recordUniform(program, GLCapture::UniformInt, 2, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform2i(program, location, v0, v1);
+        }
+
+        void glProgramUniform3i(GLuint program, GLint location, GLint v0, GLint v1, GLint v2)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLint values[] = { v0, v1, v2 };
+                recordUniform(program, GLCapture::UniformInt, 3, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform3i(program, location, v0, v1, v2);
+        }
+
+        void glProgramUniform4i(GLuint program, GLint location, GLint v0, GLint v1, GLint v2, GLint v3)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLint values[] = { v0, v1, v2, v3 };
+                recordUniform(program, GLCapture::UniformInt, 4, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform4i(program, location, v0, v1, v2, v3);
+        }
+
+        void glProgramUniform1ui(GLuint program, GLint location, GLuint v0)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLuint values[] = { v0 };
+                recordUniform(program, GLCapture::UniformUnsignedInt, 1, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform1ui(program, location, v0);
+        }
+
+        void glProgramUniform2ui(GLuint program, GLint location, GLuint v0, GLuint v1)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLuint values[] = { v0, v1 };
+                recordUniform(program, GLCapture::UniformUnsignedInt, 2, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform2ui(program, location, v0, v1);
+        }
+
+        void glProgramUniform3ui(GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLuint values[] = { v0, v1, v2 };
+                recordUniform(program, GLCapture::UniformUnsignedInt, 3, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform3ui(program, location, v0, v1, v2);
+        }
+
+        void glProgramUniform4ui(GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLuint values[] = { v0, v1, v2, v3 };
+                recordUniform(program, GLCapture::UniformUnsignedInt, 4, 1, location, 1, GL_FALSE, values);
+            }
+            ::glProgramUniform4ui(program, location, v0, v1, v2, v3);
+        }
+
+        void glProgramUniform1fv(GLuint program, GLint location, GLsizei count, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 1, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform1fv(program, location, count, value);
+        }
+
+        void glProgramUniform2fv(GLuint program, GLint location, GLsizei count, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 2, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform2fv(program, location, count, value);
+        }
+
+        void glProgramUniform3fv(GLuint program, GLint location, GLsizei count, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 3, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform3fv(program, location, count, value);
+        }
+
+        void glProgramUniform4fv(GLuint program, GLint location, GLsizei count, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 4, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform4fv(program, location, count, value);
+        }
+
+        void glProgramUniform1iv(GLuint program, GLint location, GLsizei count, const GLint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformInt, 1, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform1iv(program, location, count, value);
+        }
+
+        void glProgramUniform2iv(GLuint program, GLint location, GLsizei count, const GLint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformInt, 2, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform2iv(program, location, count, value);
+        }
+
+        void glProgramUniform3iv(GLuint program, GLint location, GLsizei count, const GLint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformInt, 3, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform3iv(program, location, count, value);
+        }
+
+        void glProgramUniform4iv(GLuint program, GLint location, GLsizei count, const GLint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformInt, 4, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform4iv(program, location, count, value);
+        }
+
+        void glProgramUniform1uiv(GLuint program, GLint location, GLsizei count, const GLuint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformUnsignedInt, 1, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform1uiv(program, location, count, value);
+        }
+
+        void glProgramUniform2uiv(GLuint program, GLint location, GLsizei count, const GLuint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformUnsignedInt, 2, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform2uiv(program, location, count, value);
+        }
+
+        void glProgramUniform3uiv(GLuint program, GLint location, GLsizei count, const GLuint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformUnsignedInt, 3, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform3uiv(program, location, count, value);
+        }
+
+        void glProgramUniform4uiv(GLuint program, GLint location, GLsizei count, const GLuint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformUnsignedInt, 4, 1, location, count, GL_FALSE, value);
+            }
+            ::glProgramUniform4uiv(program, location, count, value);
+        }
+
+        void glProgramUniformMatrix2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 2, 2, location, count, transpose, value);
+            }
+            ::glProgramUniformMatrix2fv(program, location, count, transpose, value);
+        }
+
+        void glProgramUniformMatrix3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 3, 3, location, count, transpose, value);
+            }
+            ::glProgramUniformMatrix3fv(program, location, count, transpose, value);
+        }
+
+        void glProgramUniformMatrix4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 4, 4, location, count, transpose, value);
+            }
+            ::glProgramUniformMatrix4fv(program, location, count, transpose, value);
+        }
+
+        void glProgramUniformMatrix2x3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 2, 3, location, count, transpose, value);
+            }
+            ::glProgramUniformMatrix2x3fv(program, location, count, transpose, value);
+        }
+
+        void glProgramUniformMatrix3x2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 3, 2, location, count, transpose, value);
+            }
+            ::glProgramUniformMatrix3x2fv(program, location, count, transpose, value);
+        }
+
+        void glProgramUniformMatrix2x4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 2, 4, location, count, transpose, value);
+            }
+            ::glProgramUniformMatrix2x4fv(program, location, count, transpose, value);
+        }
+
+        void glProgramUniformMatrix4x2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 4, 2, location, count, transpose, value);
+            }
+            ::glProgramUniformMatrix4x2fv(program, location, count, transpose, value);
+        }
+
+        void glProgramUniformMatrix3x4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 3, 4, location, count, transpose, value);
+            }
+            ::glProgramUniformMatrix3x4fv(program, location, count, transpose, value);
+        }
+
+        void glProgramUniformMatrix4x3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordUniform(program, GLCapture::UniformFloat, 4, 3, location, count, transpose, value);
+            }
+            ::glProgramUniformMatrix4x3fv(program, location, count, transpose, value);
+        }
+
+#endif
+        void glEnable(GLenum cap)
+        {
+            record(GLCapture::CommandEnable, cap);
+            ::glEnable(cap);
+        }
+
+        void glDisable(GLenum cap)
+        {
+            record(GLCapture::CommandDisable, cap);
+            ::glDisable(cap);
+        }
+
+        void glBlendFunc(GLenum sfactor, GLenum dfactor)
+        {
+            record(GLCapture::CommandBlendFunc, sfactor, dfactor);
+            ::glBlendFunc(sfactor, dfactor);
+        }
+
+        void glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha)
+        {
+            record(GLCapture::CommandBlendFuncSeparate, sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+            ::glBlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+        }
+
+        void glBlendEquation(GLenum mode)
+        {
+            record(GLCapture::CommandBlendEquation, mode);
+            ::glBlendEquation(mode);
+        }
+
+        void glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
+        {
+            record(GLCapture::CommandBlendEquationSeparate, modeRGB, modeAlpha);
+            ::glBlendEquationSeparate(modeRGB, modeAlpha);
+        }
+
+        void glBlendColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+        {
+            recordFloats(GLCapture::CommandBlendColor, 4, red, green, blue, alpha);
+            ::glBlendColor(red, green, blue, alpha);
+        }
+
+        void glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+        {
+            record(GLCapture::CommandColorMask, red, green, blue, alpha);
+            ::glColorMask(red, green, blue, alpha);
+        }
+
+        void glDepthFunc(GLenum func)
+        {
+            record(GLCapture::CommandDepthFunc, func);
+            ::glDepthFunc(func);
+        }
+
+        void glDepthMask(GLboolean flag)
+        {
+            record(GLCapture::CommandDepthMask, flag);
+            ::glDepthMask(flag);
+        }
+
+        void glDepthRangef(GLfloat n, GLfloat f)
+        {
+            recordFloats(GLCapture::CommandDepthRangef, 2, n, f);
+            ::glDepthRangef(n, f);
+        }
+
+        void glCullFace(GLenum mode)
+        {
+            record(GLCapture::CommandCullFace, mode);
+            ::glCullFace(mode);
+        }
+
+        void glFrontFace(GLenum mode)
+        {
+            record(GLCapture::CommandFrontFace, mode);
+            ::glFrontFace(mode);
+        }
+
+        void glPolygonOffset(GLfloat factor, GLfloat units)
+        {
+            recordFloats(GLCapture::CommandPolygonOffset, 2, factor, units);
+            ::glPolygonOffset(factor, units);
+        }
+
+        void glLineWidth(GLfloat width)
+        {
+            recordFloats(GLCapture::CommandLineWidth, 1, width);
+            ::glLineWidth(width);
+        }
+
+        void glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+        {
+            record(GLCapture::CommandScissor, x, y, width, height);
+            ::glScissor(x, y, width, height);
+        }
+
+        void glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+        {
+            record(GLCapture::CommandViewport, x, y, width, height);
+            ::glViewport(x, y, width, height);
+        }
+
+        void glStencilFunc(GLenum func, GLint ref, GLuint mask)
+        {
+            record(GLCapture::CommandStencilFunc, func, ref, mask);
+            ::glStencilFunc(func, ref, mask);
+        }
+
+        void glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask)
+        {
+            record(GLCapture::CommandStencilFuncSeparate, face, func, ref, mask);
+            ::glStencilFuncSeparate(face, func, ref, mask);
+        }
+
+        void glStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
+        {
+            record(GLCapture::CommandStencilOp, fail, zfail, zpass);
+            ::glStencilOp(fail, zfail, zpass);
+        }
+
+        void glStencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+        {
+            record(GLCapture::CommandStencilOpSeparate, face, sfail, dpfail, dppass);
+            ::glStencilOpSeparate(face, sfail, dpfail, dppass);
+        }
+
+        void glStencilMask(GLuint mask)
+        {
+            record(GLCapture::CommandStencilMask, mask);
+            ::glStencilMask(mask);
+        }
+
+        void glStencilMaskSeparate(GLenum face, GLuint mask)
+        {
+            record(GLCapture::CommandStencilMaskSeparate, face, mask);
+            ::glStencilMaskSeparate(face, mask);
+        }
+
+        void glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+        {
+            recordFloats(GLCapture::CommandClearColor, 4, red, green, blue, alpha);
+            ::glClearColor(red, green, blue, alpha);
+        }
+
+        void glClearDepthf(GLfloat d)
+        {
+            recordFloats(GLCapture::CommandClearDepthf, 1, d);
+            ::glClearDepthf(d);
+        }
+
+        void glClearStencil(GLint s)
+        {
+            record(GLCapture::CommandClearStencil, s);
+            ::glClearStencil(s);
+        }
+
+        void glActiveTexture(GLenum texture)
+        {
+            record(GLCapture::CommandActiveTexture, texture);
+            ::glActiveTexture(texture);
+        }
+
+        void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLint arrayBuffer = 0;
+                glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+
+                if (arrayBuffer == 0)
+                {
+                    setClientArray(index, false, size, type, normalized, stride, pointer);
+                }
+                else
+                {
+                    setClientArray(index, false, size, type, normalized, stride, NULL);
+
+                    GLCapture::begin(GLCapture::CommandVertexAttribPointer);
+                    GLCapture::writeUint(index);
+                    GLCapture::writeUint(false);
+                    GLCapture::writeInt(size);
+                    GLCapture::writeUint(type);
+                    GLCapture::writeUint(normalized);
+                    GLCapture::writeInt(stride);
+                    GLCapture::writeUint(GLCapture::SourceOffset);
+                    GLCapture::writeUint64((uintptr_t)pointer);
+                    GLCapture::end();
+                }
+            }
+            ::glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+        }
+
+        void glEnableVertexAttribArray(GLuint index)
+        {
+            setClientArrayEnabled(index, true);
+            record(GLCapture::CommandEnableVertexAttribArray, index);
+            ::glEnableVertexAttribArray(index);
+        }
+
+        void glDisableVertexAttribArray(GLuint index)
+        {
+            setClientArrayEnabled(index, false);
+            record(GLCapture::CommandDisableVertexAttribArray, index);
+            ::glDisableVertexAttribArray(index);
+        }
+
+        void glClear(GLbitfield mask)
+        {
+            record(GLCapture::CommandClear, mask);
+            ::glClear(mask);
+        }
+
+        void glDrawArrays(GLenum mode, GLint first, GLsizei count)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordClientArrays(first + count);
+                record(GLCapture::CommandDrawArrays, mode, first, count);
+            }
+            ::glDrawArrays(mode, first, count);
+        }
+
+        void glDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordClientArrays(getClientIndexedVertices(count, type, indices));
+
+                GLCapture::begin(GLCapture::CommandDrawElements);
+                GLCapture::writeUint(mode);
+                GLCapture::writeInt(count);
+                GLCapture::writeUint(type);
+                writeIndices(count, type, indices);
+                GLCapture::end();
+            }
+            ::glDrawElements(mode, count, type, indices);
+        }
+
+        void glFlush(void)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandFlush);
+                GLCapture::end();
+            }
+            ::glFlush();
+        }
+
+        void glFinish(void)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandFinish);
+                GLCapture::end();
+            }
+            ::glFinish();
+        }
+
+#if GLES_VERSION == 3
+        void glGenVertexArrays(GLsizei n, GLuint *arrays)
+        {
+            ::glGenVertexArrays(n, arrays);
+            recordNames(GLCapture::CommandGenVertexArrays, n, arrays);
+        }
+
+        void glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
+        {
+            recordNames(GLCapture::CommandDeleteVertexArrays, n, arrays);
+            ::glDeleteVertexArrays(n, arrays);
+        }
+
+        void glGenSamplers(GLsizei count, GLuint *samplers)
+        {
+            ::glGenSamplers(count, samplers);
+            recordNames(GLCapture::CommandGenSamplers, count, samplers);
+        }
+
+        void glDeleteSamplers(GLsizei count, const GLuint *samplers)
+        {
+            recordNames(GLCapture::CommandDeleteSamplers, count, samplers);
+            ::glDeleteSamplers(count, samplers);
+        }
+
+        void glBindVertexArray(GLuint array)
+        {
+            record(GLCapture::CommandBindVertexArray, array);
+            ::glBindVertexArray(array);
+        }
+
+        void glBindSampler(GLuint unit, GLuint sampler)
+        {
+            record(GLCapture::CommandBindSampler, unit, sampler);
+            ::glBindSampler(unit, sampler);
+        }
+
+        void glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+        {
+            record(GLCapture::CommandBindBufferBase, target, index, buffer);
+            ::glBindBufferBase(target, index, buffer);
+        }
+
+        void glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandBindBufferRange);
+                GLCapture::writeUint(target);
+                GLCapture::writeUint(index);
+                GLCapture::writeUint(buffer);
+                GLCapture::writeUint64(offset);
+                GLCapture::writeUint64(size);
+                GLCapture::end();
+            }
+            ::glBindBufferRange(target, index, buffer, offset, size);
+        }
+
+        void glBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandBindImageTexture);
+                GLCapture::writeUint(unit);
+                GLCapture::writeUint(texture);
+                GLCapture::writeInt(level);
+                GLCapture::writeUint(layered);
+                GLCapture::writeInt(layer);
+                GLCapture::writeUint(access);
+                GLCapture::writeUint(format);
+                GLCapture::end();
+            }
+            ::glBindImageTexture(unit, texture, level, layered, layer, access, format);
+        }
+
+        void glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandCopyBufferSubData);
+                GLCapture::writeUint(readTarget);
+                GLCapture::writeUint(writeTarget);
+                GLCapture::writeUint64(readOffset);
+                GLCapture::writeUint64(writeOffset);
+                GLCapture::writeUint64(size);
+                GLCapture::end();
+            }
+            ::glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+        }
+
+        void *glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+        {
+            void *data = ::glMapBufferRange(target, offset, length, access);
+
+            if (data != NULL && (access & GL_MAP_WRITE_BIT) != 0 && GLCapture::isCapturing())
+            {
+                Mapping mapping = { target, offset, length, data };
+                mappings.push_back(mapping);
+            }
+            return data;
+        }
+
+        GLboolean glUnmapBuffer(GLenum target)
+        {
+            /* Whatever was written to the mapping is in it now, record it before it goes away. */
+            for (size_t i = 0; i < mappings.size(); i++)
+            {
+                if (mappings[i].target != target)
+                {
+                    continue;
+                }
+
+                if (GLCapture::isCapturing())
+                {
+                    GLCapture::begin(GLCapture::CommandBufferSubData);
+                    GLCapture::writeUint(target);
+                    GLCapture::writeUint64(mappings[i].offset);
+                    GLCapture::writeData(mappings[i].data, mappings[i].length);
+                    GLCapture::end();
+                }
+                mappings.erase(mappings.begin() + i);
+                break;
+            }
+            return ::glUnmapBuffer(target);
+        }
+
+        void glTexImage3D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void *pixels)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandTexImage3D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(level);
+                GLCapture::writeInt(internalformat);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::writeInt(depth);
+                GLCapture::writeInt(border);
+                GLCapture::writeUint(format);
+                GLCapture::writeUint(type);
+                writePixels(pixels, getImageSize(width, height, depth, format, type));
+                GLCapture::end();
+            }
+            ::glTexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+        }
+
+        void glTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandTexSubImage3D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(level);
+                GLCapture::writeInt(xoffset);
+                GLCapture::writeInt(yoffset);
+                GLCapture::writeInt(zoffset);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::writeInt(depth);
+                GLCapture::writeUint(format);
+                GLCapture::writeUint(type);
+                writePixels(pixels, getImageSize(width, height, depth, format, type));
+                GLCapture::end();
+            }
+            ::glTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+        }
+
+        void glCompressedTexImage3D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const void *data)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandCompressedTexImage3D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(level);
+                GLCapture::writeUint(internalformat);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::writeInt(depth);
+                GLCapture::writeInt(border);
+                GLCapture::writeInt(imageSize);
+                writePixels(data, imageSize);
+                GLCapture::end();
+            }
+            ::glCompressedTexImage3D(target, level, internalformat, width, height, depth, border, imageSize, data);
+        }
+
+        void glCompressedTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const void *data)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandCompressedTexSubImage3D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(level);
+                GLCapture::writeInt(xoffset);
+                GLCapture::writeInt(yoffset);
+                GLCapture::writeInt(zoffset);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::writeInt(depth);
+                GLCapture::writeUint(format);
+                GLCapture::writeInt(imageSize);
+                writePixels(data, imageSize);
+                GLCapture::end();
+            }
+            ::glCompressedTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, imageSize, data);
+        }
+
+        void glTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandTexStorage2D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(levels);
+                GLCapture::writeUint(internalformat);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::end();
+            }
+            ::glTexStorage2D(target, levels, internalformat, width, height);
+        }
+
+        void glTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandTexStorage3D);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(levels);
+                GLCapture::writeUint(internalformat);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::writeInt(depth);
+                GLCapture::end();
+            }
+            ::glTexStorage3D(target, levels, internalformat, width, height, depth);
+        }
+
+        void glSamplerParameteri(GLuint sampler, GLenum pname, GLint param)
+        {
+            record(GLCapture::CommandSamplerParameteri, sampler, pname, param);
+            ::glSamplerParameteri(sampler, pname, param);
+        }
+
+        void glSamplerParameterf(GLuint sampler, GLenum pname, GLfloat param)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandSamplerParameterf);
+                GLCapture::writeUint(sampler);
+                GLCapture::writeUint(pname);
+                GLCapture::writeFloat(param);
+                GLCapture::end();
+            }
+            ::glSamplerParameterf(sampler, pname, param);
+        }
+
+        void glFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandFramebufferTextureLayer);
+                GLCapture::writeUint(target);
+                GLCapture::writeUint(attachment);
+                GLCapture::writeUint(texture);
+                GLCapture::writeInt(level);
+                GLCapture::writeInt(layer);
+                GLCapture::end();
+            }
+            ::glFramebufferTextureLayer(target, attachment, texture, level, layer);
+        }
+
+        void glRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandRenderbufferStorageMultisample);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(samples);
+                GLCapture::writeUint(internalformat);
+                GLCapture::writeInt(width);
+                GLCapture::writeInt(height);
+                GLCapture::end();
+            }
+            ::glRenderbufferStorageMultisample(target, samples, internalformat, width, height);
+        }
+
+        void glDrawBuffers(GLsizei n, const GLenum *bufs)
+        {
+            recordNames(GLCapture::CommandDrawBuffers, n, bufs);
+            ::glDrawBuffers(n, bufs);
+        }
+
+        void glReadBuffer(GLenum src)
+        {
+            record(GLCapture::CommandReadBuffer, src);
+            ::glReadBuffer(src);
+        }
+
+        void glInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandInvalidateFramebuffer);
+                GLCapture::writeUint(target);
+                GLCapture::writeInt(numAttachments);
+                for (GLsizei i = 0; i < numAttachments; i++)
+                {
+                    GLCapture::writeUint(attachments[i]);
+                }
+                GLCapture::end();
+            }
+            ::glInvalidateFramebuffer(target, numAttachments, attachments);
+        }
+
+        void glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+        {
+            if (GLCapture::isCapturing())
+            {
+                const GLint values[] = { srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1 };
+
+                GLCapture::begin(GLCapture::CommandBlitFramebuffer);
+                for (unsigned int i = 0; i < 8; i++)
+                {
+                    GLCapture::writeInt(values[i]);
+                }
+                GLCapture::writeUint(mask);
+                GLCapture::writeUint(filter);
+                GLCapture::end();
+            }
+            ::glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+        }
+
+        GLuint glGetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName)
+        {
+            GLuint index = ::glGetUniformBlockIndex(program, uniformBlockName);
+
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandGetUniformBlockIndex);
+                GLCapture::writeUint(program);
+                GLCapture::writeUint(index);
+                GLCapture::writeData(uniformBlockName, strlen(uniformBlockName));
+                GLCapture::end();
+            }
+            return index;
+        }
+
+        void glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+        {
+            record(GLCapture::CommandUniformBlockBinding, program, uniformBlockIndex, uniformBlockBinding);
+            ::glUniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
+        }
+
+        void glProgramParameteri(GLuint program, GLenum pname, GLint value)
+        {
+            record(GLCapture::CommandProgramParameteri, program, pname, value);
+            ::glProgramParameteri(program, pname, value);
+        }
+
+        void glProgramBinary(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandProgramBinary);
+                GLCapture::writeUint(program);
+                GLCapture::writeUint(binaryFormat);
+                GLCapture::writeData(binary, length);
+                GLCapture::end();
+            }
+            ::glProgramBinary(program, binaryFormat, binary, length);
+        }
+
+        void glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLint arrayBuffer = 0;
+                glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+
+                if (arrayBuffer == 0)
+                {
+                    setClientArray(index, true, size, type, GL_FALSE, stride, pointer);
+                }
+                else
+                {
+                    setClientArray(index, true, size, type, GL_FALSE, stride, NULL);
+
+                    GLCapture::begin(GLCapture::CommandVertexAttribPointer);
+                    GLCapture::writeUint(index);
+                    GLCapture::writeUint(true);
+                    GLCapture::writeInt(size);
+                    GLCapture::writeUint(type);
+                    GLCapture::writeUint(GL_FALSE);
+                    GLCapture::writeInt(stride);
+                    GLCapture::writeUint(GLCapture::SourceOffset);
+                    GLCapture::writeUint64((uintptr_t)pointer);
+                    GLCapture::end();
+                }
+            }
+            ::glVertexAttribIPointer(index, size, type, stride, pointer);
+        }
+
+        void glVertexAttribDivisor(GLuint index, GLuint divisor)
+        {
+            record(GLCapture::CommandVertexAttribDivisor, index, divisor);
+            ::glVertexAttribDivisor(index, divisor);
+        }
+
+        void glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandClearBufferfv);
+                GLCapture::writeUint(buffer);
+                GLCapture::writeInt(drawbuffer);
+                GLCapture::writeData(value, (buffer == GL_COLOR ? 4 : 1) * sizeof(GLfloat));
+                GLCapture::end();
+            }
+            ::glClearBufferfv(buffer, drawbuffer, value);
+        }
+
+        void glClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandClearBufferiv);
+                GLCapture::writeUint(buffer);
+                GLCapture::writeInt(drawbuffer);
+                GLCapture::writeData(value, (buffer == GL_COLOR ? 4 : 1) * sizeof(GLint));
+                GLCapture::end();
+            }
+            ::glClearBufferiv(buffer, drawbuffer, value);
+        }
+
+        void glClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint *value)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandClearBufferuiv);
+                GLCapture::writeUint(buffer);
+                GLCapture::writeInt(drawbuffer);
+                GLCapture::writeData(value, 4 * sizeof(GLuint));
+                GLCapture::end();
+            }
+            ::glClearBufferuiv(buffer, drawbuffer, value);
+        }
+
+        void glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordClientArrays(first + count);
+                record(GLCapture::CommandDrawArraysInstanced, mode, first, count, instancecount);
+            }
+            ::glDrawArraysInstanced(mode, first, count, instancecount);
+        }
+
+        void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordClientArrays(getClientIndexedVertices(count, type, indices));
+
+                GLCapture::begin(GLCapture::CommandDrawElementsInstanced);
+                GLCapture::writeUint(mode);
+                GLCapture::writeInt(count);
+                GLCapture::writeUint(type);
+                GLCapture::writeInt(instancecount);
+                writeIndices(count, type, indices);
+                GLCapture::end();
+            }
+            ::glDrawElementsInstanced(mode, count, type, indices, instancecount);
+        }
+
+        void glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices)
+        {
+            if (GLCapture::isCapturing())
+            {
+                recordClientArrays(getClientIndexedVertices(count, type, indices));
+
+                GLCapture::begin(GLCapture::CommandDrawRangeElements);
+                GLCapture::writeUint(mode);
+                GLCapture::writeUint(start);
+                GLCapture::writeUint(end);
+                GLCapture::writeInt(count);
+                GLCapture::writeUint(type);
+                writeIndices(count, type, indices);
+                GLCapture::end();
+            }
+            ::glDrawRangeElements(mode, start, end, count, type, indices);
+        }
+
+        void glDrawArraysIndirect(GLenum mode, const void *indirect)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandDrawArraysIndirect);
+                GLCapture::writeUint(mode);
+                GLCapture::writeUint64((uintptr_t)indirect);
+                GLCapture::end();
+            }
+            ::glDrawArraysIndirect(mode, indirect);
+        }
+
+        void glDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandDrawElementsIndirect);
+                GLCapture::writeUint(mode);
+                GLCapture::writeUint(type);
+                GLCapture::writeUint64((uintptr_t)indirect);
+                GLCapture::end();
+            }
+            ::glDrawElementsIndirect(mode, type, indirect);
+        }
+
+        void glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+        {
+            record(GLCapture::CommandDispatchCompute, num_groups_x, num_groups_y, num_groups_z);
+            ::glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
+        }
+
+        void glDispatchComputeIndirect(GLintptr indirect)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandDispatchComputeIndirect);
+                GLCapture::writeUint64(indirect);
+                GLCapture::end();
+            }
+            ::glDispatchComputeIndirect(indirect);
+        }
+
+        void glMemoryBarrier(GLbitfield barriers)
+        {
+            record(GLCapture::CommandMemoryBarrier, barriers);
+            ::glMemoryBarrier(barriers);
+        }
+
+        GLsync glFenceSync(GLenum condition, GLbitfield flags)
+        {
+            GLsync sync = ::glFenceSync(condition, flags);
+
+            /* The handle only identifies the sync object, the replay keeps its own. */
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandFenceSync);
+                GLCapture::writeUint(condition);
+                GLCapture::writeUint(flags);
+                GLCapture::writeUint64((uintptr_t)sync);
+                GLCapture::end();
+            }
+            return sync;
+        }
+
+        void glDeleteSync(GLsync sync)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandDeleteSync);
+                GLCapture::writeUint64((uintptr_t)sync);
+                GLCapture::end();
+            }
+            ::glDeleteSync(sync);
+        }
+
+        void glWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandWaitSync);
+                GLCapture::writeUint64((uintptr_t)sync);
+                GLCapture::writeUint(flags);
+                GLCapture::writeUint64(timeout);
+                GLCapture::end();
+            }
+            ::glWaitSync(sync, flags, timeout);
+        }
+
+        GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+        {
+            if (GLCapture::isCapturing())
+            {
+                GLCapture::begin(GLCapture::CommandClientWaitSync);
+                GLCapture::writeUint64((uintptr_t)sync);
+                GLCapture::writeUint(flags);
+                GLCapture::writeUint64(timeout);
+                GLCapture::end();
+            }
+            return ::glClientWaitSync(sync, flags, timeout);
+        }
+#endif
+    }
+}
+
+#endif /* defined(GL_CAPTURE) */
@@ -0,0 +1,54 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GLExtensions.h"
+
+#include <cstring>
+
+namespace MaliSDK
+{
+    bool GLExtensions::isInList(const char *extensions, const char *extension)
+    {
+        size_t length = strlen(extension);
+
+        for (const char *found = extensions; found != NULL && (found = strstr(found, extension)) != NULL; found += length)
+        {
+            bool startsName = (found == extensions || found[-1] == ' ');
+            bool endsName = (found[length] == ' ' || found[length] == '\0');
+
+            if (startsName && endsName)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool GLExtensions::isSupported(const char *extension)
+    {
+        return isInList((const char *)glGetString(GL_EXTENSIONS), extension);
+    }
+
+    bool GLExtensions::isEGLSupported(EGLDisplay display, const char *extension)
+    {
+        return isInList(eglQueryString(display, EGL_EXTENSIONS), extension);
+    }
+}
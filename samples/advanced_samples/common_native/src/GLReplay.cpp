@@ -0,0 +1,1443 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* The replay makes the real calls, they must not be captured again. */
+#define GL_CAPTURE_IMPLEMENTATION
+
+#include "GLReplay.h"
+#include "Platform.h"
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+
+namespace MaliSDK
+{
+    namespace
+    {
+        /* Reads the arguments of a command. Reading past them fails the command instead of the process. */
+        class Reader
+        {
+        public:
+            Reader(const unsigned char *data, size_t size)
+                : data(data),
+                  size(size),
+                  position(0),
+                  failed(false)
+            {
+            }
+
+            GLuint readUint(void)
+            {
+                GLuint value = 0;
+                read(&value, sizeof(value));
+                return value;
+            }
+
+            GLint readInt(void)
+            {
+                GLint value = 0;
+                read(&value, sizeof(value));
+                return value;
+            }
+
+            GLfloat readFloat(void)
+            {
+                GLfloat value = 0.0f;
+                read(&value, sizeof(value));
+                return value;
+            }
+
+            unsigned long long readUint64(void)
+            {
+                unsigned long long value = 0;
+                read(&value, sizeof(value));
+                return value;
+            }
+
+            const void *readData(size_t *length)
+            {
+                unsigned long long dataSize = readUint64();
+                *length = 0;
+                if (failed || dataSize > size - position)
+                {
+                    failed = true;
+                    return NULL;
+                }
+
+                const void *result = data + position;
+                *length = dataSize;
+                position += (dataSize + 3) / 4 * 4;
+                position = position < size ? position : size;
+                return result;
+            }
+
+            std::string readString(void)
+            {
+                size_t length = 0;
+                const char *string = static_cast<const char *>(readData(&length));
+                return string != NULL ? std::string(string, length) : std::string();
+            }
+
+            /* Data recorded as GLCapture::Source, an offset is returned as the pointer GL expects. */
+            const void *readSource(void)
+            {
+                size_t length = 0;
+                switch (readUint())
+                {
+                    case GLCapture::SourceData:
+                        return readData(&length);
+                    case GLCapture::SourceOffset:
+                        return reinterpret_cast<const void *>((uintptr_t)readUint64());
+                    default:
+                        return NULL;
+                }
+            }
+
+            void readNames(std::vector<GLuint> &names)
+            {
+                GLint count = readInt();
+                names.clear();
+                for (GLint i = 0; i < count && !failed; i++)
+                {
+                    names.push_back(readUint());
+                }
+            }
+
+            bool hasFailed(void) const
+            {
+                return failed;
+            }
+
+        private:
+            void read(void *value, size_t bytes)
+            {
+                if (failed || bytes > size - position)
+                {
+                    failed = true;
+                    return;
+                }
+                memcpy(value, data + position, bytes);
+                position += bytes;
+            }
+
+            const unsigned char *data;
+            size_t size;
+            size_t position;
+            bool failed;
+        };
+
+        /* Names not created during the capture, 0 among them, are used as they are. */
+        GLuint getName(const std::map<GLuint, GLuint> &names, GLuint name)
+        {
+            std::map<GLuint, GLuint>::const_iterator found = names.find(name);
+            return found != names.end() ? found->second : name;
+        }
+
+        void getNames(const std::map<GLuint, GLuint> &names, std::vector<GLuint> &captured)
+        {
+            for (size_t i = 0; i < captured.size(); i++)
+            {
+                captured[i] = getName(names, captured[i]);
+            }
+        }
+
+        void addNames(std::map<GLuint, GLuint> &names, const std::vector<GLuint> &captured, const std::vector<GLuint> &created)
+        {
+            for (size_t i = 0; i < captured.size(); i++)
+            {
+                names[captured[i]] = created[i];
+            }
+        }
+
+        void removeNames(std::map<GLuint, GLuint> &names, const std::vector<GLuint> &captured)
+        {
+            for (size_t i = 0; i < captured.size(); i++)
+            {
+                names.erase(captured[i]);
+            }
+        }
+
+        /* Calls the glUniform*v() or, for another program than the current one, glProgramUniform*v() the capture recorded. */
+        bool setUniform(GLuint program, GLuint type, GLuint columns, GLuint rows, GLint location, GLsizei count,
+                        GLboolean transpose, const void *values)
+        {
+            const GLfloat *floats = static_cast<const GLfloat *>(values);
+            const GLint *ints = static_cast<const GLint *>(values);
+
+            if (program == 0)
+            {
+                switch (type * 100 + columns * 10 + rows)
+                {
+                    case GLCapture::UniformFloat * 100 + 11: glUniform1fv(location, count, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 21: glUniform2fv(location, count, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 31: glUniform3fv(location, count, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 41: glUniform4fv(location, count, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 22: glUniformMatrix2fv(location, count, transpose, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 33: glUniformMatrix3fv(location, count, transpose, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 44: glUniformMatrix4fv(location, count, transpose, floats); return true;
+                    case GLCapture::UniformInt * 100 + 11: glUniform1iv(location, count, ints); return true;
+                    case GLCapture::UniformInt * 100 + 21: glUniform2iv(location, count, ints); return true;
+                    case GLCapture::UniformInt * 100 + 31: glUniform3iv(location, count, ints); return true;
+                    case GLCapture::UniformInt * 100 + 41: glUniform4iv(location, count, ints); return true;
+                }
+            }
+
+#if GLES_VERSION == 3
+            const GLuint *uints = static_cast<const GLuint *>(values);
+
+            if (program == 0)
+            {
+                switch (type * 100 + columns * 10 + rows)
+                {
+                    case GLCapture::UniformFloat * 100 + 23: glUniformMatrix2x3fv(location, count, transpose, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 32: glUniformMatrix3x2fv(location, count, transpose, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 24: glUniformMatrix2x4fv(location, count, transpose, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 42: glUniformMatrix4x2fv(location, count, transpose, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 34: glUniformMatrix3x4fv(location, count, transpose, floats); return true;
+                    case GLCapture::UniformFloat * 100 + 43: glUniformMatrix4x3fv(location, count, transpose, floats); return true;
+                    case GLCapture::UniformUnsignedInt * 100 + 11: glUniform1uiv(location, count, uints); return true;
+                    case GLCapture::UniformUnsignedInt * 100 + 21: glUniform2uiv(location, count, uints); return true;
+                    case GLCapture::UniformUnsignedInt * 100 + 31: glUniform3uiv(location, count, uints); return true;
+                    case GLCapture::UniformUnsignedInt * 100 + 41: glUniform4uiv(location, count, uints); return true;
+                }
+                return false;
+            }
+
+            switch (type * 100 + columns * 10 + rows)
+            {
+                case GLCapture::UniformFloat * 100 + 11: glProgramUniform1fv(program, location, count, floats); return true;
+                case GLCapture::UniformFloat * 100 + 21: glProgramUniform2fv(program, location, count, floats); return true;
+                case GLCapture::UniformFloat * 100 + 31: glProgramUniform3fv(program, location, count, floats); return true;
+                case GLCapture::UniformFloat * 100 + 41: glProgramUniform4fv(program, location, count, floats); return true;
+                case GLCapture::UniformFloat * 100 + 22: glProgramUniformMatrix2fv(program, location, count, transpose, floats); return true;
+                case GLCapture::UniformFloat * 100 + 33: glProgramUniformMatrix3fv(program, location, count, transpose, floats); return true;
+                case GLCapture::UniformFloat * 100 + 44: glProgramUniformMatrix4fv(program, location, count, transpose, floats); return true;
+                case GLCapture::UniformFloat * 100 + 23: glProgramUniformMatrix2x3fv(program, location, count, transpose, floats); return true;
+                case GLCapture::UniformFloat * 100 + 32: glProgramUniformMatrix3x2fv(program, location, count, transpose, floats); return true;
+                case GLCapture::UniformFloat * 100 + 24: glProgramUniformMatrix2x4fv(program, location, count, transpose, floats); return true;
+                case GLCapture::UniformFloat * 100 + 42: glProgramUniformMatrix4x2fv(program, location, count, transpose, floats); return true;
+                case GLCapture::UniformFloat * 100 + 34: glProgramUniformMatrix3x4fv(program, location, count, transpose, floats); return true;
+                case GLCapture::UniformFloat * 100 + 43: glProgramUniformMatrix4x3fv(program, location, count, transpose, floats); return true;
+                case GLCapture::UniformInt * 100 + 11: glProgramUniform1iv(program, location, count, ints); return true;
+                case GLCapture::UniformInt * 100 + 21: glProgramUniform2iv(program, location, count, ints); return true;
+                case GLCapture::UniformInt * 100 + 31: glProgramUniform3iv(program, location, count, ints); return true;
+                case GLCapture::UniformInt * 100 + 41: glProgramUniform4iv(program, location, count, ints); return true;
+                case GLCapture::UniformUnsignedInt * 100 + 11: glProgramUniform1uiv(program, location, count, uints); return true;
+                case GLCapture::UniformUnsignedInt * 100 + 21: glProgramUniform2uiv(program, location, count, uints); return true;
+                case GLCapture::UniformUnsignedInt * 100 + 31: glProgramUniform3uiv(program, location, count, uints); return true;
+                case GLCapture::UniformUnsignedInt * 100 + 41: glProgramUniform4uiv(program, location, count, uints); return true;
+            }
+#endif
+
+            return false;
+        }
+    }
+
+    GLReplay::GLReplay(void)
+        : setupBegin(0),
+          framesEnd(0),
+          currentProgram(0)
+    {
+        memset(&header, 0, sizeof(header));
+    }
+
+    bool GLReplay::load(const char *path)
+    {
+        FILE *file = fopen(path, "rb");
+        if (file == NULL)
+        {
+            LOGE("Cannot open the capture '%s'.\n", path);
+            return false;
+        }
+
+        data.clear();
+        unsigned char chunk[64 * 1024];
+        size_t read = 0;
+        while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            data.insert(data.end(), chunk, chunk + read);
+        }
+        fclose(file);
+
+        if (data.size() < sizeof(header))
+        {
+            LOGE("'%s' is not a capture.\n", path);
+            return false;
+        }
+
+        memcpy(&header, &data[0], sizeof(header));
+        if (memcmp(header.magic, "GLCP", 4) != 0 || header.version != GLCapture::version)
+        {
+            LOGE("'%s' is not a capture of version %u.\n", path, GLCapture::version);
+            return false;
+        }
+        if (header.glesVersion > GLES_VERSION)
+        {
+            LOGE("'%s' was captured with OpenGL ES %u, the replay is built for %d.\n", path, header.glesVersion, GLES_VERSION);
+            return false;
+        }
+
+        /* Find the frames. A capture which stopped early ends with an incomplete frame, which is left out. */
+        setupBegin = sizeof(header);
+        frameBegins.clear();
+        framesEnd = 0;
+
+        size_t position = setupBegin;
+        while (data.size() - position >= 2 * sizeof(GLuint))
+        {
+            GLuint command = 0;
+            GLuint size = 0;
+            memcpy(&command, &data[position], sizeof(command));
+            memcpy(&size, &data[position + sizeof(command)], sizeof(size));
+
+            position += 2 * sizeof(GLuint);
+            if (size > data.size() - position)
+            {
+                break;
+            }
+            position += size;
+
+            if (command == GLCapture::CommandEndSetup || command == GLCapture::CommandEndFrame)
+            {
+                if (command == GLCapture::CommandEndFrame)
+                {
+                    framesEnd = position;
+                }
+                frameBegins.push_back(position);
+            }
+        }
+
+        /* The last frame has no frame after it. */
+        if (!frameBegins.empty())
+        {
+            frameBegins.pop_back();
+        }
+        if (frameBegins.empty())
+        {
+            LOGE("'%s' has no complete frame.\n", path);
+            return false;
+        }
+
+        LOGI("Loaded %u frames of %ux%u from %s.\n", getNumberOfFrames(), header.width, header.height, path);
+        return true;
+    }
+
+    unsigned int GLReplay::getWidth(void) const
+    {
+        return header.width;
+    }
+
+    unsigned int GLReplay::getHeight(void) const
+    {
+        return header.height;
+    }
+
+    unsigned int GLReplay::getNumberOfFrames(void) const
+    {
+        return frameBegins.size();
+    }
+
+    bool GLReplay::playSetup(void)
+    {
+        return play(setupBegin, frameBegins[0]);
+    }
+
+    bool GLReplay::playFrame(unsigned int frame)
+    {
+        size_t end = frame + 1 < frameBegins.size() ? frameBegins[frame + 1] : framesEnd;
+        return play(frameBegins[frame], end);
+    }
+
+    bool GLReplay::play(size_t begin, size_t end)
+    {
+        for (size_t position = begin; position < end; )
+        {
+            GLuint command = 0;
+            GLuint size = 0;
+            memcpy(&command, &data[position], sizeof(command));
+            memcpy(&size, &data[position + sizeof(command)], sizeof(size));
+            position += 2 * sizeof(GLuint);
+
+            if (!execute(command, &data[position], size))
+            {
+                LOGE("Failed to replay command %u at offset %u.\n", command, (unsigned int)(position - 2 * sizeof(GLuint)));
+                return false;
+            }
+            position += size;
+        }
+
+        return true;
+    }
+
+    GLint GLReplay::getUniformLocation(GLuint program, GLint location) const
+    {
+        /* Locations not looked up during the capture are set in the shaders, and the same in the replay. */
+        std::map<std::pair<GLuint, GLint>, GLint>::const_iterator found = uniformLocations.find(std::make_pair(program, location));
+        return found != uniformLocations.end() ? found->second : location;
+    }
+
+    bool GLReplay::execute(unsigned int command, const unsigned char *arguments, size_t size)
+    {
+        Reader reader(arguments, size);
+        std::vector<GLuint> names;
+
+        switch (command)
+        {
+            case GLCapture::CommandEndSetup:
+            case GLCapture::CommandEndFrame:
+                break;
+
+            case GLCapture::CommandGenBuffers:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> created(names.size());
+                if (!created.empty())
+                {
+                    glGenBuffers(created.size(), &created[0]);
+                }
+                addNames(buffers, names, created);
+                break;
+            }
+            case GLCapture::CommandDeleteBuffers:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> deleted(names);
+                getNames(buffers, deleted);
+                if (!deleted.empty())
+                {
+                    glDeleteBuffers(deleted.size(), &deleted[0]);
+                }
+                removeNames(buffers, names);
+                break;
+            }
+            case GLCapture::CommandGenTextures:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> created(names.size());
+                if (!created.empty())
+                {
+                    glGenTextures(created.size(), &created[0]);
+                }
+                addNames(textures, names, created);
+                break;
+            }
+            case GLCapture::CommandDeleteTextures:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> deleted(names);
+                getNames(textures, deleted);
+                if (!deleted.empty())
+                {
+                    glDeleteTextures(deleted.size(), &deleted[0]);
+                }
+                removeNames(textures, names);
+                break;
+            }
+            case GLCapture::CommandGenFramebuffers:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> created(names.size());
+                if (!created.empty())
+                {
+                    glGenFramebuffers(created.size(), &created[0]);
+                }
+                addNames(framebuffers, names, created);
+                break;
+            }
+            case GLCapture::CommandDeleteFramebuffers:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> deleted(names);
+                getNames(framebuffers, deleted);
+                if (!deleted.empty())
+                {
+                    glDeleteFramebuffers(deleted.size(), &deleted[0]);
+                }
+                removeNames(framebuffers, names);
+                break;
+            }
+            case GLCapture::CommandGenRenderbuffers:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> created(names.size());
+                if (!created.empty())
+                {
+                    glGenRenderbuffers(created.size(), &created[0]);
+                }
+                addNames(renderbuffers, names, created);
+                break;
+            }
+            case GLCapture::CommandDeleteRenderbuffers:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> deleted(names);
+                getNames(renderbuffers, deleted);
+                if (!deleted.empty())
+                {
+                    glDeleteRenderbuffers(deleted.size(), &deleted[0]);
+                }
+                removeNames(renderbuffers, names);
+                break;
+            }
+
+            case GLCapture::CommandBindBuffer:
+            {
+                GLenum target = reader.readUint();
+                glBindBuffer(target, getName(buffers, reader.readUint()));
+                break;
+            }
+            case GLCapture::CommandBindTexture:
+            {
+                GLenum target = reader.readUint();
+                glBindTexture(target, getName(textures, reader.readUint()));
+                break;
+            }
+            case GLCapture::CommandBindFramebuffer:
+            {
+                GLenum target = reader.readUint();
+                glBindFramebuffer(target, getName(framebuffers, reader.readUint()));
+                break;
+            }
+            case GLCapture::CommandBindRenderbuffer:
+            {
+                GLenum target = reader.readUint();
+                glBindRenderbuffer(target, getName(renderbuffers, reader.readUint()));
+                break;
+            }
+
+            case GLCapture::CommandBufferData:
+            {
+                GLenum target = reader.readUint();
+                GLsizeiptr bufferSize = reader.readUint64();
+                GLenum usage = reader.readUint();
+                const void *bufferData = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glBufferData(target, bufferSize, bufferData, usage);
+                }
+                break;
+            }
+            case GLCapture::CommandBufferSubData:
+            {
+                GLenum target = reader.readUint();
+                GLintptr offset = reader.readUint64();
+                size_t length = 0;
+                const void *bufferData = reader.readData(&length);
+                if (!reader.hasFailed())
+                {
+                    glBufferSubData(target, offset, length, bufferData);
+                }
+                break;
+            }
+            case GLCapture::CommandTexImage2D:
+            {
+                GLenum target = reader.readUint();
+                GLint level = reader.readInt();
+                GLint internalformat = reader.readInt();
+                GLsizei width = reader.readInt();
+                GLsizei height = reader.readInt();
+                GLint border = reader.readInt();
+                GLenum format = reader.readUint();
+                GLenum type = reader.readUint();
+                const void *pixels = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+                }
+                break;
+            }
+            case GLCapture::CommandTexSubImage2D:
+            {
+                GLenum target = reader.readUint();
+                GLint level = reader.readInt();
+                GLint xoffset = reader.readInt();
+                GLint yoffset = reader.readInt();
+                GLsizei width = reader.readInt();
+                GLsizei height = reader.readInt();
+                GLenum format = reader.readUint();
+                GLenum type = reader.readUint();
+                const void *pixels = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+                }
+                break;
+            }
+            case GLCapture::CommandCompressedTexImage2D:
+            {
+                GLenum target = reader.readUint();
+                GLint level = reader.readInt();
+                GLenum internalformat = reader.readUint();
+                GLsizei width = reader.readInt();
+                GLsizei height = reader.readInt();
+                GLint border = reader.readInt();
+                GLsizei imageSize = reader.readInt();
+                const void *pixels = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, pixels);
+                }
+                break;
+            }
+            case GLCapture::CommandCompressedTexSubImage2D:
+            {
+                GLenum target = reader.readUint();
+                GLint level = reader.readInt();
+                GLint xoffset = reader.readInt();
+                GLint yoffset = reader.readInt();
+                GLsizei width = reader.readInt();
+                GLsizei height = reader.readInt();
+                GLenum format = reader.readUint();
+                GLsizei imageSize = reader.readInt();
+                const void *pixels = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, pixels);
+                }
+                break;
+            }
+            case GLCapture::CommandGenerateMipmap:
+                glGenerateMipmap(reader.readUint());
+                break;
+            case GLCapture::CommandPixelStorei:
+            {
+                GLenum pname = reader.readUint();
+                glPixelStorei(pname, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandTexParameteri:
+            {
+                GLenum target = reader.readUint();
+                GLenum pname = reader.readUint();
+                glTexParameteri(target, pname, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandTexParameterf:
+            {
+                GLenum target = reader.readUint();
+                GLenum pname = reader.readUint();
+                glTexParameterf(target, pname, reader.readFloat());
+                break;
+            }
+
+            case GLCapture::CommandFramebufferTexture2D:
+            {
+                GLenum target = reader.readUint();
+                GLenum attachment = reader.readUint();
+                GLenum textarget = reader.readUint();
+                GLuint texture = getName(textures, reader.readUint());
+                glFramebufferTexture2D(target, attachment, textarget, texture, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandFramebufferRenderbuffer:
+            {
+                GLenum target = reader.readUint();
+                GLenum attachment = reader.readUint();
+                GLenum renderbuffertarget = reader.readUint();
+                glFramebufferRenderbuffer(target, attachment, renderbuffertarget, getName(renderbuffers, reader.readUint()));
+                break;
+            }
+            case GLCapture::CommandRenderbufferStorage:
+            {
+                GLenum target = reader.readUint();
+                GLenum internalformat = reader.readUint();
+                GLsizei width = reader.readInt();
+                glRenderbufferStorage(target, internalformat, width, reader.readInt());
+                break;
+            }
+
+            case GLCapture::CommandCreateShader:
+            {
+                GLenum type = reader.readUint();
+                programs[reader.readUint()] = glCreateShader(type);
+                break;
+            }
+            case GLCapture::CommandShaderSource:
+            {
+                GLuint shader = getName(programs, reader.readUint());
+                std::string source = reader.readString();
+                const GLchar *string = source.c_str();
+                glShaderSource(shader, 1, &string, NULL);
+                break;
+            }
+            case GLCapture::CommandCompileShader:
+                glCompileShader(getName(programs, reader.readUint()));
+                break;
+            case GLCapture::CommandDeleteShader:
+            {
+                GLuint shader = reader.readUint();
+                glDeleteShader(getName(programs, shader));
+                programs.erase(shader);
+                break;
+            }
+            case GLCapture::CommandCreateProgram:
+                programs[reader.readUint()] = glCreateProgram();
+                break;
+            case GLCapture::CommandAttachShader:
+            {
+                GLuint program = getName(programs, reader.readUint());
+                glAttachShader(program, getName(programs, reader.readUint()));
+                break;
+            }
+            case GLCapture::CommandDetachShader:
+            {
+                GLuint program = getName(programs, reader.readUint());
+                glDetachShader(program, getName(programs, reader.readUint()));
+                break;
+            }
+            case GLCapture::CommandBindAttribLocation:
+            {
+                GLuint program = getName(programs, reader.readUint());
+                GLuint index = reader.readUint();
+                glBindAttribLocation(program, index, reader.readString().c_str());
+                break;
+            }
+            case GLCapture::CommandLinkProgram:
+            {
+                GLuint program = getName(programs, reader.readUint());
+                glLinkProgram(program);
+
+                GLint linked = GL_FALSE;
+                glGetProgramiv(program, GL_LINK_STATUS, &linked);
+                if (!linked)
+                {
+                    LOGE("A program of the capture failed to link.\n");
+                }
+                break;
+            }
+            case GLCapture::CommandUseProgram:
+                currentProgram = reader.readUint();
+                glUseProgram(getName(programs, currentProgram));
+                break;
+            case GLCapture::CommandDeleteProgram:
+            {
+                GLuint program = reader.readUint();
+                glDeleteProgram(getName(programs, program));
+                programs.erase(program);
+                break;
+            }
+            case GLCapture::CommandGetUniformLocation:
+            {
+                GLuint program = reader.readUint();
+                GLint location = reader.readInt();
+                std::string name = reader.readString();
+                if (location >= 0)
+                {
+                    uniformLocations[std::make_pair(program, location)] = glGetUniformLocation(getName(programs, program), name.c_str());
+                }
+                break;
+            }
+            case GLCapture::CommandUniform:
+            {
+                GLuint program = reader.readUint();
+                GLuint type = reader.readUint();
+                GLuint columns = reader.readUint();
+                GLuint rows = reader.readUint();
+                GLint location = reader.readInt();
+                GLsizei count = reader.readInt();
+                GLboolean transpose = reader.readUint();
+                size_t length = 0;
+                const void *values = reader.readData(&length);
+
+                location = getUniformLocation(program != 0 ? program : currentProgram, location);
+                if (reader.hasFailed() || !setUniform(getName(programs, program), type, columns, rows, location, count, transpose, values))
+                {
+                    return false;
+                }
+                break;
+            }
+
+            case GLCapture::CommandEnable:
+                glEnable(reader.readUint());
+                break;
+            case GLCapture::CommandDisable:
+                glDisable(reader.readUint());
+                break;
+            case GLCapture::CommandBlendFunc:
+            {
+                GLenum sfactor = reader.readUint();
+                glBlendFunc(sfactor, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandBlendFuncSeparate:
+            {
+                GLenum sfactorRGB = reader.readUint();
+                GLenum dfactorRGB = reader.readUint();
+                GLenum sfactorAlpha = reader.readUint();
+                glBlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandBlendEquation:
+                glBlendEquation(reader.readUint());
+                break;
+            case GLCapture::CommandBlendEquationSeparate:
+            {
+                GLenum modeRGB = reader.readUint();
+                glBlendEquationSeparate(modeRGB, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandBlendColor:
+            {
+                GLfloat red = reader.readFloat();
+                GLfloat green = reader.readFloat();
+                GLfloat blue = reader.readFloat();
+                glBlendColor(red, green, blue, reader.readFloat());
+                break;
+            }
+            case GLCapture::CommandColorMask:
+            {
+                GLboolean red = reader.readUint();
+                GLboolean green = reader.readUint();
+                GLboolean blue = reader.readUint();
+                glColorMask(red, green, blue, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandDepthFunc:
+                glDepthFunc(reader.readUint());
+                break;
+            case GLCapture::CommandDepthMask:
+                glDepthMask(reader.readUint());
+                break;
+            case GLCapture::CommandDepthRangef:
+            {
+                GLfloat n = reader.readFloat();
+                glDepthRangef(n, reader.readFloat());
+                break;
+            }
+            case GLCapture::CommandCullFace:
+                glCullFace(reader.readUint());
+                break;
+            case GLCapture::CommandFrontFace:
+                glFrontFace(reader.readUint());
+                break;
+            case GLCapture::CommandPolygonOffset:
+            {
+                GLfloat factor = reader.readFloat();
+                glPolygonOffset(factor, reader.readFloat());
+                break;
+            }
+            case GLCapture::CommandLineWidth:
+                glLineWidth(reader.readFloat());
+                break;
+            case GLCapture::CommandScissor:
+            {
+                GLint x = reader.readInt();
+                GLint y = reader.readInt();
+                GLsizei width = reader.readInt();
+                glScissor(x, y, width, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandViewport:
+            {
+                GLint x = reader.readInt();
+                GLint y = reader.readInt();
+                GLsizei width = reader.readInt();
+                glViewport(x, y, width, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandStencilFunc:
+            {
+                GLenum func = reader.readUint();
+                GLint ref = reader.readInt();
+                glStencilFunc(func, ref, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandStencilFuncSeparate:
+            {
+                GLenum face = reader.readUint();
+                GLenum func = reader.readUint();
+                GLint ref = reader.readInt();
+                glStencilFuncSeparate(face, func, ref, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandStencilOp:
+            {
+                GLenum fail = reader.readUint();
+                GLenum zfail = reader.readUint();
+                glStencilOp(fail, zfail, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandStencilOpSeparate:
+            {
+                GLenum face = reader.readUint();
+                GLenum sfail = reader.readUint();
+                GLenum dpfail = reader.readUint();
+                glStencilOpSeparate(face, sfail, dpfail, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandStencilMask:
+                glStencilMask(reader.readUint());
+                break;
+            case GLCapture::CommandStencilMaskSeparate:
+            {
+                GLenum face = reader.readUint();
+                glStencilMaskSeparate(face, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandClearColor:
+            {
+                GLfloat red = reader.readFloat();
+                GLfloat green = reader.readFloat();
+                GLfloat blue = reader.readFloat();
+                glClearColor(red, green, blue, reader.readFloat());
+                break;
+            }
+            case GLCapture::CommandClearDepthf:
+                glClearDepthf(reader.readFloat());
+                break;
+            case GLCapture::CommandClearStencil:
+                glClearStencil(reader.readInt());
+                break;
+            case GLCapture::CommandActiveTexture:
+                glActiveTexture(reader.readUint());
+                break;
+
+            case GLCapture::CommandVertexAttribPointer:
+            {
+                GLuint index = reader.readUint();
+                bool integer = reader.readUint() != 0;
+                GLint attributeSize = reader.readInt();
+                GLenum type = reader.readUint();
+                GLboolean normalized = reader.readUint();
+                GLsizei stride = reader.readInt();
+                bool clientData = reader.readUint() == GLCapture::SourceData;
+                size_t length = 0;
+                const void *pointer = clientData ? reader.readData(&length) : reinterpret_cast<const void *>((uintptr_t)reader.readUint64());
+                if (reader.hasFailed())
+                {
+                    break;
+                }
+
+                /* Vertices recorded from client memory are read from the capture, with no buffer bound to the attribute. */
+                GLint arrayBuffer = 0;
+                if (clientData)
+                {
+                    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+                    glBindBuffer(GL_ARRAY_BUFFER, 0);
+                }
+
+#if GLES_VERSION == 3
+                if (integer)
+                {
+                    glVertexAttribIPointer(index, attributeSize, type, stride, pointer);
+                }
+                else
+#else
+                (void)integer;
+#endif
+                {
+                    glVertexAttribPointer(index, attributeSize, type, normalized, stride, pointer);
+                }
+
+                if (arrayBuffer != 0)
+                {
+                    glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+                }
+                break;
+            }
+            case GLCapture::CommandEnableVertexAttribArray:
+                glEnableVertexAttribArray(reader.readUint());
+                break;
+            case GLCapture::CommandDisableVertexAttribArray:
+                glDisableVertexAttribArray(reader.readUint());
+                break;
+
+            case GLCapture::CommandClear:
+                glClear(reader.readUint());
+                break;
+            case GLCapture::CommandDrawArrays:
+            {
+                GLenum mode = reader.readUint();
+                GLint first = reader.readInt();
+                glDrawArrays(mode, first, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandDrawElements:
+            {
+                GLenum mode = reader.readUint();
+                GLsizei count = reader.readInt();
+                GLenum type = reader.readUint();
+                const void *indices = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glDrawElements(mode, count, type, indices);
+                }
+                break;
+            }
+            case GLCapture::CommandFlush:
+                glFlush();
+                break;
+            case GLCapture::CommandFinish:
+                glFinish();
+                break;
+
+#if GLES_VERSION == 3
+            case GLCapture::CommandGenVertexArrays:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> created(names.size());
+                if (!created.empty())
+                {
+                    glGenVertexArrays(created.size(), &created[0]);
+                }
+                addNames(vertexArrays, names, created);
+                break;
+            }
+            case GLCapture::CommandDeleteVertexArrays:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> deleted(names);
+                getNames(vertexArrays, deleted);
+                if (!deleted.empty())
+                {
+                    glDeleteVertexArrays(deleted.size(), &deleted[0]);
+                }
+                removeNames(vertexArrays, names);
+                break;
+            }
+            case GLCapture::CommandGenSamplers:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> created(names.size());
+                if (!created.empty())
+                {
+                    glGenSamplers(created.size(), &created[0]);
+                }
+                addNames(samplers, names, created);
+                break;
+            }
+            case GLCapture::CommandDeleteSamplers:
+            {
+                reader.readNames(names);
+                std::vector<GLuint> deleted(names);
+                getNames(samplers, deleted);
+                if (!deleted.empty())
+                {
+                    glDeleteSamplers(deleted.size(), &deleted[0]);
+                }
+                removeNames(samplers, names);
+                break;
+            }
+            case GLCapture::CommandBindVertexArray:
+                glBindVertexArray(getName(vertexArrays, reader.readUint()));
+                break;
+            case GLCapture::CommandBindSampler:
+            {
+                GLuint unit = reader.readUint();
+                glBindSampler(unit, getName(samplers, reader.readUint()));
+                break;
+            }
+            case GLCapture::CommandBindBufferBase:
+            {
+                GLenum target = reader.readUint();
+                GLuint index = reader.readUint();
+                glBindBufferBase(target, index, getName(buffers, reader.readUint()));
+                break;
+            }
+            case GLCapture::CommandBindBufferRange:
+            {
+                GLenum target = reader.readUint();
+                GLuint index = reader.readUint();
+                GLuint buffer = getName(buffers, reader.readUint());
+                GLintptr offset = reader.readUint64();
+                glBindBufferRange(target, index, buffer, offset, reader.readUint64());
+                break;
+            }
+            case GLCapture::CommandBindImageTexture:
+            {
+                GLuint unit = reader.readUint();
+                GLuint texture = getName(textures, reader.readUint());
+                GLint level = reader.readInt();
+                GLboolean layered = reader.readUint();
+                GLint layer = reader.readInt();
+                GLenum access = reader.readUint();
+                glBindImageTexture(unit, texture, level, layered, layer, access, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandCopyBufferSubData:
+            {
+                GLenum readTarget = reader.readUint();
+                GLenum writeTarget = reader.readUint();
+                GLintptr readOffset = reader.readUint64();
+                GLintptr writeOffset = reader.readUint64();
+                glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, reader.readUint64());
+                break;
+            }
+            case GLCapture::CommandTexImage3D:
+            {
+                GLenum target = reader.readUint();
+                GLint level = reader.readInt();
+                GLint internalformat = reader.readInt();
+                GLsizei width = reader.readInt();
+                GLsizei height = reader.readInt();
+                GLsizei depth = reader.readInt();
+                GLint border = reader.readInt();
+                GLenum format = reader.readUint();
+                GLenum type = reader.readUint();
+                const void *pixels = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glTexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+                }
+                break;
+            }
+            case GLCapture::CommandTexSubImage3D:
+            {
+                GLenum target = reader.readUint();
+                GLint level = reader.readInt();
+                GLint xoffset = reader.readInt();
+                GLint yoffset = reader.readInt();
+                GLint zoffset = reader.readInt();
+                GLsizei width = reader.readInt();
+                GLsizei height = reader.readInt();
+                GLsizei depth = reader.readInt();
+                GLenum format = reader.readUint();
+                GLenum type = reader.readUint();
+                const void *pixels = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+                }
+                break;
+            }
+            case GLCapture::CommandCompressedTexImage3D:
+            {
+                GLenum target = reader.readUint();
+                GLint level = reader.readInt();
+                GLenum internalformat = reader.readUint();
+                GLsizei width = reader.readInt();
+                GLsizei height = reader.readInt();
+                GLsizei depth = reader.readInt();
+                GLint border = reader.readInt();
+                GLsizei imageSize = reader.readInt();
+                const void *pixels = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glCompressedTexImage3D(target, level, internalformat, width, height, depth, border, imageSize, pixels);
+                }
+                break;
+            }
+            case GLCapture::CommandCompressedTexSubImage3D:
+            {
+                GLenum target = reader.readUint();
+                GLint level = reader.readInt();
+                GLint xoffset = reader.readInt();
+                GLint yoffset = reader.readInt();
+                GLint zoffset = reader.readInt();
+                GLsizei width = reader.readInt();
+                GLsizei height = reader.readInt();
+                GLsizei depth = reader.readInt();
+                GLenum format = reader.readUint();
+                GLsizei imageSize = reader.readInt();
+                const void *pixels = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glCompressedTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, imageSize, pixels);
+                }
+                break;
+            }
+            case GLCapture::CommandTexStorage2D:
+            {
+                GLenum target = reader.readUint();
+                GLsizei levels = reader.readInt();
+                GLenum internalformat = reader.readUint();
+                GLsizei width = reader.readInt();
+                glTexStorage2D(target, levels, internalformat, width, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandTexStorage3D:
+            {
+                GLenum target = reader.readUint();
+                GLsizei levels = reader.readInt();
+                GLenum internalformat = reader.readUint();
+                GLsizei width = reader.readInt();
+                GLsizei height = reader.readInt();
+                glTexStorage3D(target, levels, internalformat, width, height, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandSamplerParameteri:
+            {
+                GLuint sampler = getName(samplers, reader.readUint());
+                GLenum pname = reader.readUint();
+                glSamplerParameteri(sampler, pname, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandSamplerParameterf:
+            {
+                GLuint sampler = getName(samplers, reader.readUint());
+                GLenum pname = reader.readUint();
+                glSamplerParameterf(sampler, pname, reader.readFloat());
+                break;
+            }
+            case GLCapture::CommandFramebufferTextureLayer:
+            {
+                GLenum target = reader.readUint();
+                GLenum attachment = reader.readUint();
+                GLuint texture = getName(textures, reader.readUint());
+                GLint level = reader.readInt();
+                glFramebufferTextureLayer(target, attachment, texture, level, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandRenderbufferStorageMultisample:
+            {
+                GLenum target = reader.readUint();
+                GLsizei samples = reader.readInt();
+                GLenum internalformat = reader.readUint();
+                GLsizei width = reader.readInt();
+                glRenderbufferStorageMultisample(target, samples, internalformat, width, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandDrawBuffers:
+                reader.readNames(names);
+                glDrawBuffers(names.size(), names.empty() ? NULL : &names[0]);
+                break;
+            case GLCapture::CommandReadBuffer:
+                glReadBuffer(reader.readUint());
+                break;
+            case GLCapture::CommandInvalidateFramebuffer:
+            {
+                GLenum target = reader.readUint();
+                reader.readNames(names);
+                glInvalidateFramebuffer(target, names.size(), names.empty() ? NULL : &names[0]);
+                break;
+            }
+            case GLCapture::CommandBlitFramebuffer:
+            {
+                GLint values[8];
+                for (unsigned int i = 0; i < 8; i++)
+                {
+                    values[i] = reader.readInt();
+                }
+                GLbitfield mask = reader.readUint();
+                glBlitFramebuffer(values[0], values[1], values[2], values[3], values[4], values[5], values[6], values[7],
+                                  mask, reader.readUint());
+                break;
+            }
+
+            case GLCapture::CommandProgramParameteri:
+            {
+                GLuint program = getName(programs, reader.readUint());
+                GLenum pname = reader.readUint();
+                glProgramParameteri(program, pname, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandProgramBinary:
+            {
+                GLuint program = getName(programs, reader.readUint());
+                GLenum binaryFormat = reader.readUint();
+                size_t length = 0;
+                const void *binary = reader.readData(&length);
+                if (!reader.hasFailed())
+                {
+                    glProgramBinary(program, binaryFormat, binary, length);
+                }
+
+                /* Binaries only load on the driver which wrote them. */
+                GLint linked = GL_FALSE;
+                glGetProgramiv(program, GL_LINK_STATUS, &linked);
+                if (!linked)
+                {
+                    LOGE("A program binary of the capture was rejected, capture with the program binary cache cleared.\n");
+                }
+                break;
+            }
+            case GLCapture::CommandGetUniformBlockIndex:
+            {
+                GLuint program = reader.readUint();
+                GLuint index = reader.readUint();
+                std::string name = reader.readString();
+                if (index != GL_INVALID_INDEX)
+                {
+                    uniformBlockIndices[std::make_pair(program, index)] = glGetUniformBlockIndex(getName(programs, program), name.c_str());
+                }
+                break;
+            }
+            case GLCapture::CommandUniformBlockBinding:
+            {
+                GLuint program = reader.readUint();
+                GLuint index = reader.readUint();
+                GLuint binding = reader.readUint();
+
+                std::map<std::pair<GLuint, GLuint>, GLuint>::const_iterator found = uniformBlockIndices.find(std::make_pair(program, index));
+                glUniformBlockBinding(getName(programs, program), found != uniformBlockIndices.end() ? found->second : index, binding);
+                break;
+            }
+
+            case GLCapture::CommandVertexAttribDivisor:
+            {
+                GLuint index = reader.readUint();
+                glVertexAttribDivisor(index, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandClearBufferfv:
+            {
+                GLenum buffer = reader.readUint();
+                GLint drawbuffer = reader.readInt();
+                size_t length = 0;
+                const void *value = reader.readData(&length);
+                if (!reader.hasFailed())
+                {
+                    glClearBufferfv(buffer, drawbuffer, static_cast<const GLfloat *>(value));
+                }
+                break;
+            }
+            case GLCapture::CommandClearBufferiv:
+            {
+                GLenum buffer = reader.readUint();
+                GLint drawbuffer = reader.readInt();
+                size_t length = 0;
+                const void *value = reader.readData(&length);
+                if (!reader.hasFailed())
+                {
+                    glClearBufferiv(buffer, drawbuffer, static_cast<const GLint *>(value));
+                }
+                break;
+            }
+            case GLCapture::CommandClearBufferuiv:
+            {
+                GLenum buffer = reader.readUint();
+                GLint drawbuffer = reader.readInt();
+                size_t length = 0;
+                const void *value = reader.readData(&length);
+                if (!reader.hasFailed())
+                {
+                    glClearBufferuiv(buffer, drawbuffer, static_cast<const GLuint *>(value));
+                }
+                break;
+            }
+            case GLCapture::CommandDrawArraysInstanced:
+            {
+                GLenum mode = reader.readUint();
+                GLint first = reader.readInt();
+                GLsizei count = reader.readInt();
+                glDrawArraysInstanced(mode, first, count, reader.readInt());
+                break;
+            }
+            case GLCapture::CommandDrawElementsInstanced:
+            {
+                GLenum mode = reader.readUint();
+                GLsizei count = reader.readInt();
+                GLenum type = reader.readUint();
+                GLsizei instances = reader.readInt();
+                const void *indices = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glDrawElementsInstanced(mode, count, type, indices, instances);
+                }
+                break;
+            }
+            case GLCapture::CommandDrawRangeElements:
+            {
+                GLenum mode = reader.readUint();
+                GLuint start = reader.readUint();
+                GLuint end = reader.readUint();
+                GLsizei count = reader.readInt();
+                GLenum type = reader.readUint();
+                const void *indices = reader.readSource();
+                if (!reader.hasFailed())
+                {
+                    glDrawRangeElements(mode, start, end, count, type, indices);
+                }
+                break;
+            }
+            case GLCapture::CommandDrawArraysIndirect:
+            {
+                GLenum mode = reader.readUint();
+                glDrawArraysIndirect(mode, reinterpret_cast<const void *>((uintptr_t)reader.readUint64()));
+                break;
+            }
+            case GLCapture::CommandDrawElementsIndirect:
+            {
+                GLenum mode = reader.readUint();
+                GLenum type = reader.readUint();
+                glDrawElementsIndirect(mode, type, reinterpret_cast<const void *>((uintptr_t)reader.readUint64()));
+                break;
+            }
+            case GLCapture::CommandDispatchCompute:
+            {
+                GLuint x = reader.readUint();
+                GLuint y = reader.readUint();
+                glDispatchCompute(x, y, reader.readUint());
+                break;
+            }
+            case GLCapture::CommandDispatchComputeIndirect:
+                glDispatchComputeIndirect(reader.readUint64());
+                break;
+            case GLCapture::CommandMemoryBarrier:
+                glMemoryBarrier(reader.readUint());
+                break;
+
+            case GLCapture::CommandFenceSync:
+            {
+                GLenum condition = reader.readUint();
+                GLbitfield flags = reader.readUint();
+                unsigned long long handle = reader.readUint64();
+
+                /* A handle is only reused once the sync object it named is deleted. */
+                std::map<unsigned long long, GLsync>::iterator found = syncs.find(handle);
+                if (found != syncs.end())
+                {
+                    glDeleteSync(found->second);
+                }
+                syncs[handle] = glFenceSync(condition, flags);
+                break;
+            }
+            case GLCapture::CommandDeleteSync:
+            {
+                std::map<unsigned long long, GLsync>::iterator found = syncs.find(reader.readUint64());
+                if (found != syncs.end())
+                {
+                    glDeleteSync(found->second);
+                    syncs.erase(found);
+                }
+                break;
+            }
+            case GLCapture::CommandWaitSync:
+            case GLCapture::CommandClientWaitSync:
+            {
+                std::map<unsigned long long, GLsync>::iterator found = syncs.find(reader.readUint64());
+                GLbitfield flags = reader.readUint();
+                GLuint64 timeout = reader.readUint64();
+                if (found == syncs.end())
+                {
+                    break;
+                }
+
+                if (command == GLCapture::CommandWaitSync)
+                {
+                    glWaitSync(found->second, flags, timeout);
+                }
+                else
+                {
+                    glClientWaitSync(found->second, flags, timeout);
+                }
+                break;
+            }
+#endif
+
+            default:
+                LOGE("Command %u is not supported by this replay.\n", command);
+                return false;
+        }
+
+        return !reader.hasFailed();
+    }
+}
@@ -0,0 +1,407 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GLStateCache.h"
+#include "GLCallCounters.h"
+#include "GLCapture.h"
+#include "GPUMemory.h"
+
+#include <cstddef>
+
+namespace MaliSDK
+{
+    const GLuint GLStateCache::unknown;
+
+    bool GLStateCache::bypass = false;
+
+    GLuint GLStateCache::program = GLStateCache::unknown;
+    GLuint GLStateCache::activeTextureUnit = GLStateCache::unknown;
+    GLuint GLStateCache::textures[GLStateCache::maxTextureUnits][GLStateCache::numberOfTextureTargets];
+    GLuint GLStateCache::arrayBuffer = GLStateCache::unknown;
+    GLuint GLStateCache::elementArrayBuffer = GLStateCache::unknown;
+    GLuint GLStateCache::vertexArray = GLStateCache::unknown;
+#if GLES_VERSION == 3
+    GLuint GLStateCache::samplers[GLStateCache::maxTextureUnits];
+#endif
+
+    signed char GLStateCache::blendEnabled = -1;
+    signed char GLStateCache::cullFaceEnabled = -1;
+    signed char GLStateCache::depthTestEnabled = -1;
+    signed char GLStateCache::stencilTestEnabled = -1;
+    signed char GLStateCache::scissorTestEnabled = -1;
+    signed char GLStateCache::polygonOffsetFillEnabled = -1;
+
+    GLenum GLStateCache::blendSourceRGB = GLStateCache::unknown;
+    GLenum GLStateCache::blendDestinationRGB = GLStateCache::unknown;
+    GLenum GLStateCache::blendSourceAlpha = GLStateCache::unknown;
+    GLenum GLStateCache::blendDestinationAlpha = GLStateCache::unknown;
+    GLenum GLStateCache::blendEquationRGB = GLStateCache::unknown;
+    GLenum GLStateCache::blendEquationAlpha = GLStateCache::unknown;
+    GLenum GLStateCache::depthFunction = GLStateCache::unknown;
+    GLuint GLStateCache::depthWriteMask = GLStateCache::unknown;
+    GLenum GLStateCache::cullFaceMode = GLStateCache::unknown;
+    GLenum GLStateCache::frontFaceMode = GLStateCache::unknown;
+
+    /* The static initialisers cannot fill the texture bindings, so the cache starts out invalidated. */
+    static struct GLStateCacheInitializer
+    {
+        GLStateCacheInitializer(void)
+        {
+            GLStateCache::invalidate();
+        }
+    } initializer;
+
+    int GLStateCache::getTextureTargetIndex(GLenum target)
+    {
+        switch (target)
+        {
+            case GL_TEXTURE_2D:
+                return 0;
+            case GL_TEXTURE_CUBE_MAP:
+                return 1;
+#if GLES_VERSION == 3
+            case GL_TEXTURE_3D:
+                return 2;
+            case GL_TEXTURE_2D_ARRAY:
+                return 3;
+#endif
+            default:
+                return -1;
+        }
+    }
+
+    signed char *GLStateCache::getCapability(GLenum capability)
+    {
+        switch (capability)
+        {
+            case GL_BLEND:
+                return &blendEnabled;
+            case GL_CULL_FACE:
+                return &cullFaceEnabled;
+            case GL_DEPTH_TEST:
+                return &depthTestEnabled;
+            case GL_STENCIL_TEST:
+                return &stencilTestEnabled;
+            case GL_SCISSOR_TEST:
+                return &scissorTestEnabled;
+            case GL_POLYGON_OFFSET_FILL:
+                return &polygonOffsetFillEnabled;
+            default:
+                return NULL;
+        }
+    }
+
+    void GLStateCache::setBypass(bool bypassCache)
+    {
+        /* Nothing is tracked while bypassed, so the state is unknown when filtering starts again. */
+        if (bypass && !bypassCache)
+        {
+            invalidate();
+        }
+        bypass = bypassCache;
+    }
+
+    bool GLStateCache::isBypassed(void)
+    {
+        return bypass;
+    }
+
+    void GLStateCache::invalidate(void)
+    {
+        program = unknown;
+        activeTextureUnit = unknown;
+        for (int unit = 0; unit < maxTextureUnits; unit++)
+        {
+            for (int target = 0; target < numberOfTextureTargets; target++)
+            {
+                textures[unit][target] = unknown;
+            }
+        }
+        arrayBuffer = unknown;
+        elementArrayBuffer = unknown;
+        vertexArray = unknown;
+#if GLES_VERSION == 3
+        for (int unit = 0; unit < maxTextureUnits; unit++)
+        {
+            samplers[unit] = unknown;
+        }
+#endif
+
+        blendEnabled = -1;
+        cullFaceEnabled = -1;
+        depthTestEnabled = -1;
+        stencilTestEnabled = -1;
+        scissorTestEnabled = -1;
+        polygonOffsetFillEnabled = -1;
+
+        blendSourceRGB = unknown;
+        blendDestinationRGB = unknown;
+        blendSourceAlpha = unknown;
+        blendDestinationAlpha = unknown;
+        blendEquationRGB = unknown;
+        blendEquationAlpha = unknown;
+        depthFunction = unknown;
+        depthWriteMask = unknown;
+        cullFaceMode = unknown;
+        frontFaceMode = unknown;
+    }
+
+    void GLStateCache::useProgram(GLuint newProgram)
+    {
+        if (bypass || program != newProgram)
+        {
+            glUseProgram(newProgram);
+            program = bypass ? unknown : newProgram;
+        }
+    }
+
+    void GLStateCache::activeTexture(GLenum unit)
+    {
+        GLuint index = unit - GL_TEXTURE0;
+
+        if (bypass || activeTextureUnit != index)
+        {
+            glActiveTexture(unit);
+            activeTextureUnit = bypass ? unknown : index;
+        }
+    }
+
+    void GLStateCache::bindTexture(GLenum target, GLuint texture)
+    {
+        int targetIndex = getTextureTargetIndex(target);
+
+        /* Without knowing the unit, the binding cannot be tracked. */
+        if (bypass || targetIndex < 0 || activeTextureUnit >= (GLuint)maxTextureUnits)
+        {
+            glBindTexture(target, texture);
+            return;
+        }
+
+        GLuint &binding = textures[activeTextureUnit][targetIndex];
+        if (binding != texture)
+        {
+            glBindTexture(target, texture);
+            binding = texture;
+        }
+    }
+
+    void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+    {
+        GLuint *binding = NULL;
+
+        if (target == GL_ARRAY_BUFFER)
+        {
+            binding = &arrayBuffer;
+        }
+        else if (target == GL_ELEMENT_ARRAY_BUFFER)
+        {
+            binding = &elementArrayBuffer;
+        }
+
+        if (bypass || binding == NULL)
+        {
+            glBindBuffer(target, buffer);
+            return;
+        }
+
+        if (*binding != buffer)
+        {
+            glBindBuffer(target, buffer);
+            *binding = buffer;
+        }
+    }
+
+#if GLES_VERSION == 3
+    void GLStateCache::bindVertexArray(GLuint array)
+    {
+        if (bypass || vertexArray != array)
+        {
+            glBindVertexArray(array);
+            vertexArray = bypass ? unknown : array;
+            elementArrayBuffer = unknown;
+        }
+    }
+
+    void GLStateCache::bindSampler(GLuint unit, GLuint sampler)
+    {
+        if (bypass || unit >= (GLuint)maxTextureUnits)
+        {
+            glBindSampler(unit, sampler);
+            return;
+        }
+
+        if (samplers[unit] != sampler)
+        {
+            glBindSampler(unit, sampler);
+            samplers[unit] = sampler;
+        }
+    }
+#endif
+
+    void GLStateCache::setEnabled(GLenum capability, bool enabled)
+    {
+        signed char *state = getCapability(capability);
+        signed char newState = enabled ? 1 : 0;
+
+        if (bypass || state == NULL || *state != newState)
+        {
+            if (enabled)
+            {
+                glEnable(capability);
+            }
+            else
+            {
+                glDisable(capability);
+            }
+
+            if (state != NULL)
+            {
+                *state = bypass ? -1 : newState;
+            }
+        }
+    }
+
+    void GLStateCache::blendFunc(GLenum source, GLenum destination)
+    {
+        if (bypass || blendSourceRGB != source || blendDestinationRGB != destination ||
+            blendSourceAlpha != source || blendDestinationAlpha != destination)
+        {
+            glBlendFunc(source, destination);
+            blendSourceRGB = blendSourceAlpha = bypass ? unknown : source;
+            blendDestinationRGB = blendDestinationAlpha = bypass ? unknown : destination;
+        }
+    }
+
+    void GLStateCache::blendFuncSeparate(GLenum sourceRGB, GLenum destinationRGB, GLenum sourceAlpha, GLenum destinationAlpha)
+    {
+        if (bypass || blendSourceRGB != sourceRGB || blendDestinationRGB != destinationRGB ||
+            blendSourceAlpha != sourceAlpha || blendDestinationAlpha != destinationAlpha)
+        {
+            glBlendFuncSeparate(sourceRGB, destinationRGB, sourceAlpha, destinationAlpha);
+            blendSourceRGB = bypass ? unknown : sourceRGB;
+            blendDestinationRGB = bypass ? unknown : destinationRGB;
+            blendSourceAlpha = bypass ? unknown : sourceAlpha;
+            blendDestinationAlpha = bypass ? unknown : destinationAlpha;
+        }
+    }
+
+    void GLStateCache::blendEquation(GLenum mode)
+    {
+        if (bypass || blendEquationRGB != mode || blendEquationAlpha != mode)
+        {
+            glBlendEquation(mode);
+            blendEquationRGB = blendEquationAlpha = bypass ? unknown : mode;
+        }
+    }
+
+    void GLStateCache::depthFunc(GLenum function)
+    {
+        if (bypass || depthFunction != function)
+        {
+            glDepthFunc(function);
+            depthFunction = bypass ? unknown : function;
+        }
+    }
+
+    void GLStateCache::depthMask(GLboolean writeMask)
+    {
+        GLuint mask = writeMask ? GL_TRUE : GL_FALSE;
+
+        if (bypass || depthWriteMask != mask)
+        {
+            glDepthMask(writeMask);
+            depthWriteMask = bypass ? unknown : mask;
+        }
+    }
+
+    void GLStateCache::cullFace(GLenum mode)
+    {
+        if (bypass || cullFaceMode != mode)
+        {
+            glCullFace(mode);
+            cullFaceMode = bypass ? unknown : mode;
+        }
+    }
+
+    void GLStateCache::frontFace(GLenum mode)
+    {
+        if (bypass || frontFaceMode != mode)
+        {
+            glFrontFace(mode);
+            frontFaceMode = bypass ? unknown : mode;
+        }
+    }
+
+    void GLStateCache::deleteBuffers(GLsizei count, const GLuint *buffers)
+    {
+        for (GLsizei index = 0; index < count; index++)
+        {
+            if (arrayBuffer == buffers[index])
+            {
+                arrayBuffer = 0;
+            }
+            if (elementArrayBuffer == buffers[index])
+            {
+                elementArrayBuffer = 0;
+            }
+        }
+
+        GPUMemory::forget(GPUMemory::CATEGORY_BUFFER, count, buffers);
+        glDeleteBuffers(count, buffers);
+    }
+
+    void GLStateCache::deleteTextures(GLsizei count, const GLuint *texturesToDelete)
+    {
+        for (GLsizei index = 0; index < count; index++)
+        {
+            for (int unit = 0; unit < maxTextureUnits; unit++)
+            {
+                for (int target = 0; target < numberOfTextureTargets; target++)
+                {
+                    if (textures[unit][target] == texturesToDelete[index])
+                    {
+                        textures[unit][target] = 0;
+                    }
+                }
+            }
+        }
+
+        GPUMemory::forget(GPUMemory::CATEGORY_TEXTURE, count, texturesToDelete);
+        glDeleteTextures(count, texturesToDelete);
+    }
+
+#if GLES_VERSION == 3
+    void GLStateCache::deleteSamplers(GLsizei count, const GLuint *samplersToDelete)
+    {
+        for (GLsizei index = 0; index < count; index++)
+        {
+            for (int unit = 0; unit < maxTextureUnits; unit++)
+            {
+                if (samplers[unit] == samplersToDelete[index])
+                {
+                    samplers[unit] = 0;
+                }
+            }
+        }
+
+        glDeleteSamplers(count, samplersToDelete);
+    }
+#endif
+}
@@ -0,0 +1,290 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GLWorkerPool.h"
+#include "EGLWorkerContext.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace MaliSDK
+{
+    /* Every worker costs a context (and a pbuffer without surfaceless contexts), more than this rarely helps the driver. */
+    static const unsigned int maximumNumberOfWorkers = 4;
+
+    GLWorkerPool::GLWorkerPool(void)
+        : display(EGL_NO_DISPLAY),
+          stopping(false)
+    {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&jobQueued, NULL);
+        pthread_cond_init(&jobDone, NULL);
+    }
+
+    GLWorkerPool::~GLWorkerPool(void)
+    {
+        terminate();
+
+        pthread_cond_destroy(&jobDone);
+        pthread_cond_destroy(&jobQueued);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    bool GLWorkerPool::initialize(unsigned int numberOfWorkers)
+    {
+        if (!workers.empty())
+        {
+            LOGE("GLWorkerPool::initialize() called twice.\n");
+            exit(1);
+        }
+
+        EGLContext mainContext = eglGetCurrentContext();
+
+        display = eglGetCurrentDisplay();
+
+        if (mainContext == EGL_NO_CONTEXT)
+        {
+            LOGI("GLWorkerPool: no current context, jobs will run on the calling thread.\n");
+            return false;
+        }
+
+        if (numberOfWorkers == 0)
+        {
+            long numberOfCores = sysconf(_SC_NPROCESSORS_ONLN);
+
+            numberOfWorkers = numberOfCores > 1 ? (unsigned int)(numberOfCores - 1) : 1;
+        }
+        numberOfWorkers = std::min(numberOfWorkers, maximumNumberOfWorkers);
+
+        /* The threads keep a pointer to their Worker, the vector must not reallocate. */
+        workers.reserve(numberOfWorkers);
+        stopping = false;
+
+        for (unsigned int workerIndex = 0; workerIndex < numberOfWorkers; workerIndex++)
+        {
+            Worker worker;
+
+            worker.pool = this;
+            if (!EGLWorkerContext::create(display, mainContext, &worker.surface, &worker.context))
+            {
+                break;
+            }
+
+            workers.push_back(worker);
+
+            if (pthread_create(&workers.back().thread, NULL, &workerFunction, &workers.back()) != 0)
+            {
+                EGLWorkerContext::destroy(display, worker.surface, worker.context);
+                workers.pop_back();
+                break;
+            }
+        }
+
+        if (workers.empty())
+        {
+            LOGI("GLWorkerPool: cannot create a worker context (0x%.4x), jobs will run on the calling thread.\n", (int)eglGetError());
+            return false;
+        }
+
+        LOGI("GLWorkerPool: started %u worker threads.\n", (unsigned int)workers.size());
+        return true;
+    }
+
+    void GLWorkerPool::terminate(void)
+    {
+        if (!workers.empty())
+        {
+            pthread_mutex_lock(&mutex);
+            stopping = true;
+            pthread_cond_broadcast(&jobQueued);
+            pthread_mutex_unlock(&mutex);
+
+            for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++)
+            {
+                pthread_join(workers[workerIndex].thread, NULL);
+                EGLWorkerContext::destroy(display, workers[workerIndex].surface, workers[workerIndex].context);
+            }
+
+            workers.clear();
+        }
+
+        /* The workers have drained the queue, every job left is complete. */
+        while (!submittedJobs.empty())
+        {
+            releaseJob(submittedJobs.back());
+        }
+    }
+
+    unsigned int GLWorkerPool::getNumberOfWorkers(void) const
+    {
+        return (unsigned int)workers.size();
+    }
+
+    void GLWorkerPool::releaseJob(Job *job)
+    {
+#if GLES_VERSION == 3
+        /* Without a current context there is nothing to delete the fence with, it goes with the share group. */
+        if (job->fence != NULL && eglGetCurrentContext() != EGL_NO_CONTEXT)
+        {
+            GL_CHECK(glDeleteSync(job->fence));
+        }
+#endif
+
+        submittedJobs.erase(std::find(submittedJobs.begin(), submittedJobs.end(), job));
+        delete job;
+    }
+
+    void *GLWorkerPool::workerFunction(void *worker)
+    {
+        Worker *self = (Worker *)worker;
+        GLWorkerPool *pool = self->pool;
+
+        if (!eglMakeCurrent(pool->display, self->surface, self->surface, self->context))
+        {
+            LOGE("GLWorkerPool: cannot make the worker context current (0x%.4x).\n", (int)eglGetError());
+            exit(1);
+        }
+
+        pthread_mutex_lock(&pool->mutex);
+
+        while (true)
+        {
+            while (pool->pendingJobs.empty() && !pool->stopping)
+            {
+                pthread_cond_wait(&pool->jobQueued, &pool->mutex);
+            }
+
+            if (pool->pendingJobs.empty())
+            {
+                break;
+            }
+
+            Job *job = pool->pendingJobs.front();
+            pool->pendingJobs.pop_front();
+            pthread_mutex_unlock(&pool->mutex);
+
+            job->function(job->userData);
+
+#if GLES_VERSION == 3
+            /* The flush makes sure the fence can signal without this context issuing more commands. */
+            GLsync fence = GL_CHECK(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+            GL_CHECK(glFlush());
+#else
+            /* There are no fences in OpenGL ES 2.0, the results are only known to be visible once they have completed. */
+            GL_CHECK(glFinish());
+#endif
+
+            pthread_mutex_lock(&pool->mutex);
+#if GLES_VERSION == 3
+            job->fence = fence;
+#endif
+            job->done = true;
+            pthread_cond_broadcast(&pool->jobDone);
+        }
+
+        pthread_mutex_unlock(&pool->mutex);
+
+        eglMakeCurrent(pool->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglReleaseThread();
+
+        return NULL;
+    }
+
+    GLWorkerPool::Job *GLWorkerPool::submit(JobFunction function, void *userData)
+    {
+        Job *job = new Job;
+
+        job->function = function;
+        job->userData = userData;
+        job->done = false;
+#if GLES_VERSION == 3
+        job->fence = NULL;
+#endif
+
+        submittedJobs.push_back(job);
+
+        if (workers.empty())
+        {
+            /* Commands issued on the calling context need no fence to be ordered with the rendering. */
+            function(userData);
+            job->done = true;
+            return job;
+        }
+
+        pthread_mutex_lock(&mutex);
+        pendingJobs.push_back(job);
+        pthread_cond_signal(&jobQueued);
+        pthread_mutex_unlock(&mutex);
+
+        return job;
+    }
+
+    bool GLWorkerPool::isComplete(Job *job)
+    {
+        pthread_mutex_lock(&mutex);
+        bool done = job->done;
+        pthread_mutex_unlock(&mutex);
+
+        if (!done)
+        {
+            return false;
+        }
+
+#if GLES_VERSION == 3
+        if (job->fence != NULL)
+        {
+            GLenum status = GL_CHECK(glClientWaitSync(job->fence, 0, 0));
+
+            return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+        }
+#endif
+
+        return true;
+    }
+
+    void GLWorkerPool::wait(Job *job)
+    {
+        pthread_mutex_lock(&mutex);
+        while (!job->done)
+        {
+            pthread_cond_wait(&jobDone, &mutex);
+        }
+        pthread_mutex_unlock(&mutex);
+
+#if GLES_VERSION == 3
+        if (job->fence != NULL)
+        {
+            GL_CHECK(glWaitSync(job->fence, 0, GL_TIMEOUT_IGNORED));
+        }
+#endif
+
+        releaseJob(job);
+    }
+
+    void GLWorkerPool::waitAll(void)
+    {
+        while (!submittedJobs.empty())
+        {
+            wait(submittedJobs.front());
+        }
+    }
+}
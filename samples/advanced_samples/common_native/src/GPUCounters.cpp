@@ -0,0 +1,176 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GPUCounters.h"
+#include "Platform.h"
+
+#include <cstdio>
+
+#if defined(HAVE_HWCPIPE)
+#include "hwcpipe.h"
+
+#include <exception>
+#endif
+
+namespace MaliSDK
+{
+    GPUCounters::GPUCounters(void)
+        : pipe(NULL),
+          supported(false),
+          gpuCycles(0.0),
+          fragmentCycles(0.0),
+          shaderCycles(0.0),
+          externalReadBytes(0.0),
+          externalWriteBytes(0.0),
+          tiles(0.0)
+    {
+#if defined(HAVE_HWCPIPE)
+        hwcpipe::GpuCounterSet counters;
+        counters.insert(hwcpipe::GpuCounter::GpuCycles);
+        counters.insert(hwcpipe::GpuCounter::FragmentCycles);
+        counters.insert(hwcpipe::GpuCounter::ShaderCycles);
+        counters.insert(hwcpipe::GpuCounter::ExternalMemoryReadBytes);
+        counters.insert(hwcpipe::GpuCounter::ExternalMemoryWriteBytes);
+        counters.insert(hwcpipe::GpuCounter::Tiles);
+
+        try
+        {
+            pipe = new hwcpipe::HWCPipe(hwcpipe::CpuCounterSet(), counters);
+            pipe->run();
+
+            /* Without access to the counters HWCPipe still works, it just has no GPU profiler. */
+            supported = pipe->gpu_profiler() != NULL;
+        }
+        catch (const std::exception &exception)
+        {
+            LOGE("Cannot start HWCPipe: %s\n", exception.what());
+        }
+
+        if (!supported)
+        {
+            delete pipe;
+            pipe = NULL;
+        }
+#endif
+
+        if (!supported)
+        {
+            LOGI("Mali hardware counters are not available.\n");
+        }
+    }
+
+    GPUCounters::~GPUCounters(void)
+    {
+#if defined(HAVE_HWCPIPE)
+        if (pipe != NULL)
+        {
+            pipe->stop();
+            delete pipe;
+        }
+#endif
+    }
+
+    bool GPUCounters::isSupported(void) const
+    {
+        return supported;
+    }
+
+#if defined(HAVE_HWCPIPE)
+    /* A counter the GPU does not have is missing from the measurements, it reads as 0. */
+    static double getCounter(const hwcpipe::GpuMeasurements &measurements, hwcpipe::GpuCounter counter)
+    {
+        hwcpipe::GpuMeasurements::const_iterator found = measurements.find(counter);
+
+        return found != measurements.end() ? found->second.get<double>() : 0.0;
+    }
+#endif
+
+    void GPUCounters::sample(void)
+    {
+#if defined(HAVE_HWCPIPE)
+        if (!supported)
+        {
+            return;
+        }
+
+        hwcpipe::Measurements measurements = pipe->sample();
+        if (measurements.gpu == NULL)
+        {
+            return;
+        }
+
+        gpuCycles = getCounter(*measurements.gpu, hwcpipe::GpuCounter::GpuCycles);
+        fragmentCycles = getCounter(*measurements.gpu, hwcpipe::GpuCounter::FragmentCycles);
+        shaderCycles = getCounter(*measurements.gpu, hwcpipe::GpuCounter::ShaderCycles);
+        externalReadBytes = getCounter(*measurements.gpu, hwcpipe::GpuCounter::ExternalMemoryReadBytes);
+        externalWriteBytes = getCounter(*measurements.gpu, hwcpipe::GpuCounter::ExternalMemoryWriteBytes);
+        tiles = getCounter(*measurements.gpu, hwcpipe::GpuCounter::Tiles);
+#endif
+    }
+
+    double GPUCounters::getGPUCycles(void) const
+    {
+        return gpuCycles;
+    }
+
+    double GPUCounters::getFragmentCycles(void) const
+    {
+        return fragmentCycles;
+    }
+
+    double GPUCounters::getExternalReadBytes(void) const
+    {
+        return externalReadBytes;
+    }
+
+    double GPUCounters::getExternalWriteBytes(void) const
+    {
+        return externalWriteBytes;
+    }
+
+    double GPUCounters::getTiles(void) const
+    {
+        return tiles;
+    }
+
+    double GPUCounters::getShaderCoreUtilisation(void) const
+    {
+        if (gpuCycles <= 0.0)
+        {
+            return 0.0;
+        }
+
+        /* The counters are not read at exactly the same instant, so the ratio can slightly exceed 1. */
+        double utilisation = shaderCycles / gpuCycles;
+
+        return utilisation < 1.0 ? utilisation : 1.0;
+    }
+
+    void GPUCounters::getBandwidthString(char *buffer, size_t size) const
+    {
+        snprintf(buffer, size, "Read %.1f MB Write %.1f MB", externalReadBytes / (1024.0 * 1024.0), externalWriteBytes / (1024.0 * 1024.0));
+    }
+
+    void GPUCounters::getUtilisationString(char *buffer, size_t size) const
+    {
+        snprintf(buffer, size, "GPU %.1f Mcycles Fragment %.1f Mcycles Tiles %.0f Shader cores %.0f%%",
+                 gpuCycles / 1000000.0, fragmentCycles / 1000000.0, tiles, 100.0 * getShaderCoreUtilisation());
+    }
+}
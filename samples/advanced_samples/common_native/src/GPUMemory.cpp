@@ -0,0 +1,354 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GPUMemory.h"
+#include "Platform.h"
+
+#include <pthread.h>
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace MaliSDK
+{
+    struct Allocation
+    {
+        size_t bytes;
+        GLenum format;
+        const char *owner;
+    };
+
+    typedef std::map<GLuint, Allocation> Allocations;
+
+    static Allocations allocations[GPUMemory::NUMBER_OF_CATEGORIES];
+    static pthread_mutex_t allocationsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    static const char *categoryNames[GPUMemory::NUMBER_OF_CATEGORIES] = { "textures", "buffers", "renderbuffers" };
+
+    /* Compressed formats: block width, block height and bytes per block. */
+    struct BlockFormat
+    {
+        GLenum format;
+        int blockWidth;
+        int blockHeight;
+        int blockBytes;
+    };
+
+    static const BlockFormat blockFormats[] =
+    {
+        { 0x8D64, 4, 4, 8 },   /* GL_ETC1_RGB8_OES */
+        { 0x9270, 4, 4, 8 },   /* GL_COMPRESSED_R11_EAC */
+        { 0x9271, 4, 4, 8 },   /* GL_COMPRESSED_SIGNED_R11_EAC */
+        { 0x9272, 4, 4, 16 },  /* GL_COMPRESSED_RG11_EAC */
+        { 0x9273, 4, 4, 16 },  /* GL_COMPRESSED_SIGNED_RG11_EAC */
+        { 0x9274, 4, 4, 8 },   /* GL_COMPRESSED_RGB8_ETC2 */
+        { 0x9275, 4, 4, 8 },   /* GL_COMPRESSED_SRGB8_ETC2 */
+        { 0x9276, 4, 4, 8 },   /* GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 */
+        { 0x9277, 4, 4, 8 },   /* GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2 */
+        { 0x9278, 4, 4, 16 },  /* GL_COMPRESSED_RGBA8_ETC2_EAC */
+        { 0x9279, 4, 4, 16 },  /* GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC */
+    };
+
+    /* ASTC formats, from GL_COMPRESSED_RGBA_ASTC_4x4_KHR and GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR on, 16 bytes per block. */
+    static const int astcBlockSizes[14][2] =
+    {
+        { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 },
+        { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+    };
+
+    /* Uncompressed formats and their bytes per texel. */
+    struct TexelFormat
+    {
+        GLenum format;
+        int texelBytes;
+    };
+
+    static const TexelFormat texelFormats[] =
+    {
+        { GL_ALPHA, 1 },
+        { GL_LUMINANCE, 1 },
+        { GL_LUMINANCE_ALPHA, 2 },
+        { GL_RGB, 3 },
+        { GL_RGBA, 4 },
+        { GL_RGB565, 2 },
+        { GL_RGBA4, 2 },
+        { GL_RGB5_A1, 2 },
+        { GL_DEPTH_COMPONENT16, 2 },
+        { GL_STENCIL_INDEX8, 1 },
+        { 0x8229, 1 },  /* GL_R8 */
+        { 0x822B, 2 },  /* GL_RG8 */
+        { 0x8051, 3 },  /* GL_RGB8 */
+        { 0x8058, 4 },  /* GL_RGBA8 */
+        { 0x8C41, 3 },  /* GL_SRGB8 */
+        { 0x8C43, 4 },  /* GL_SRGB8_ALPHA8 */
+        { 0x822D, 2 },  /* GL_R16F */
+        { 0x822F, 4 },  /* GL_RG16F */
+        { 0x881B, 6 },  /* GL_RGB16F */
+        { 0x881A, 8 },  /* GL_RGBA16F */
+        { 0x822E, 4 },  /* GL_R32F */
+        { 0x8230, 8 },  /* GL_RG32F */
+        { 0x8815, 12 }, /* GL_RGB32F */
+        { 0x8814, 16 }, /* GL_RGBA32F */
+        { 0x8C3A, 4 },  /* GL_R11F_G11F_B10F */
+        { 0x8C3D, 4 },  /* GL_RGB9_E5 */
+        { 0x8059, 4 },  /* GL_RGB10_A2 */
+        { 0x8232, 1 },  /* GL_R8UI */
+        { 0x8231, 1 },  /* GL_R8I */
+        { 0x8234, 2 },  /* GL_R16UI */
+        { 0x8233, 2 },  /* GL_R16I */
+        { 0x8236, 4 },  /* GL_R32UI */
+        { 0x8235, 4 },  /* GL_R32I */
+        { 0x823C, 8 },  /* GL_RG32UI */
+        { 0x8D70, 16 }, /* GL_RGBA32UI */
+        { 0x8D7C, 4 },  /* GL_RGBA8UI */
+        { 0x81A6, 4 },  /* GL_DEPTH_COMPONENT24, padded */
+        { 0x8CAC, 4 },  /* GL_DEPTH_COMPONENT32F */
+        { 0x88F0, 4 },  /* GL_DEPTH24_STENCIL8 */
+        { 0x8CAD, 8 },  /* GL_DEPTH32F_STENCIL8, padded */
+    };
+
+    static void track(GPUMemory::Category category, GLuint name, size_t bytes, GLenum format, const char *owner)
+    {
+        if (name == 0)
+        {
+            return;
+        }
+
+        Allocation allocation;
+        allocation.bytes = bytes;
+        allocation.format = format;
+        allocation.owner = owner != NULL ? owner : "unknown";
+
+        pthread_mutex_lock(&allocationsMutex);
+        allocations[category][name] = allocation;
+        pthread_mutex_unlock(&allocationsMutex);
+    }
+
+    void GPUMemory::trackTexture(GLuint texture, size_t bytes, GLenum internalFormat, const char *owner)
+    {
+        track(CATEGORY_TEXTURE, texture, bytes, internalFormat, owner);
+    }
+
+    void GPUMemory::trackBuffer(GLuint buffer, size_t bytes, GLenum usage, const char *owner)
+    {
+        track(CATEGORY_BUFFER, buffer, bytes, usage, owner);
+    }
+
+    void GPUMemory::trackRenderbuffer(GLuint renderbuffer, size_t bytes, GLenum internalFormat, const char *owner)
+    {
+        track(CATEGORY_RENDERBUFFER, renderbuffer, bytes, internalFormat, owner);
+    }
+
+    void GPUMemory::forget(Category category, GLsizei count, const GLuint *names)
+    {
+        pthread_mutex_lock(&allocationsMutex);
+        for (GLsizei index = 0; index < count; index++)
+        {
+            allocations[category].erase(names[index]);
+        }
+        pthread_mutex_unlock(&allocationsMutex);
+    }
+
+    void GPUMemory::prune(void)
+    {
+        pthread_mutex_lock(&allocationsMutex);
+        for (int category = 0; category < NUMBER_OF_CATEGORIES; category++)
+        {
+            Allocations &recorded = allocations[category];
+
+            for (Allocations::iterator iterator = recorded.begin(); iterator != recorded.end();)
+            {
+                GLboolean exists = GL_FALSE;
+                switch (category)
+                {
+                    case CATEGORY_TEXTURE:
+                        exists = glIsTexture(iterator->first);
+                        break;
+                    case CATEGORY_BUFFER:
+                        exists = glIsBuffer(iterator->first);
+                        break;
+                    default:
+                        exists = glIsRenderbuffer(iterator->first);
+                        break;
+                }
+
+                if (exists)
+                {
+                    ++iterator;
+                }
+                else
+                {
+                    recorded.erase(iterator++);
+                }
+            }
+        }
+        pthread_mutex_unlock(&allocationsMutex);
+    }
+
+    size_t GPUMemory::getTotal(Category category)
+    {
+        size_t total = 0;
+
+        pthread_mutex_lock(&allocationsMutex);
+        for (Allocations::const_iterator iterator = allocations[category].begin(); iterator != allocations[category].end(); ++iterator)
+        {
+            total += iterator->second.bytes;
+        }
+        pthread_mutex_unlock(&allocationsMutex);
+
+        return total;
+    }
+
+    size_t GPUMemory::getCount(Category category)
+    {
+        pthread_mutex_lock(&allocationsMutex);
+        size_t count = allocations[category].size();
+        pthread_mutex_unlock(&allocationsMutex);
+
+        return count;
+    }
+
+    void GPUMemory::getSummary(char *string, size_t size)
+    {
+        int written = snprintf(string, size, "GPU memory:");
+
+        for (int category = 0; category < NUMBER_OF_CATEGORIES && written >= 0 && (size_t)written < size; category++)
+        {
+            written += snprintf(string + written, size - written, "%s %s %.1f MB (%u)", category > 0 ? "," : "", categoryNames[category],
+                                getTotal((Category)category) / (1024.0 * 1024.0), (unsigned int)getCount((Category)category));
+        }
+    }
+
+    void GPUMemory::log(void)
+    {
+        pthread_mutex_lock(&allocationsMutex);
+        for (int category = 0; category < NUMBER_OF_CATEGORIES; category++)
+        {
+            std::map<std::string, size_t> owners;
+            size_t total = 0;
+
+            for (Allocations::const_iterator iterator = allocations[category].begin(); iterator != allocations[category].end(); ++iterator)
+            {
+                owners[iterator->second.owner] += iterator->second.bytes;
+                total += iterator->second.bytes;
+            }
+
+            LOGI("GPU memory, %s: %.2f MB in %u resources.\n", categoryNames[category], total / (1024.0 * 1024.0),
+                 (unsigned int)allocations[category].size());
+            for (std::map<std::string, size_t>::const_iterator owner = owners.begin(); owner != owners.end(); ++owner)
+            {
+                LOGI("  %24s: %10.2f MB\n", owner->first.c_str(), owner->second / (1024.0 * 1024.0));
+            }
+        }
+        pthread_mutex_unlock(&allocationsMutex);
+    }
+
+    unsigned int GPUMemory::reportLeaks(void)
+    {
+        prune();
+
+        unsigned int leaks = 0;
+
+        pthread_mutex_lock(&allocationsMutex);
+        for (int category = 0; category < NUMBER_OF_CATEGORIES; category++)
+        {
+            for (Allocations::const_iterator iterator = allocations[category].begin(); iterator != allocations[category].end(); ++iterator)
+            {
+                const Allocation &allocation = iterator->second;
+                LOGE("GPU memory leak: %s %u of %s, %u bytes, format 0x%.4x.\n", categoryNames[category], iterator->first,
+                     allocation.owner, (unsigned int)allocation.bytes, allocation.format);
+                leaks++;
+            }
+            allocations[category].clear();
+        }
+        pthread_mutex_unlock(&allocationsMutex);
+
+        return leaks;
+    }
+
+    size_t GPUMemory::computeTextureSize(GLenum internalFormat, int width, int height, int depth, int levels)
+    {
+        int blockWidth = 1;
+        int blockHeight = 1;
+        int blockBytes = 4;
+
+        bool found = false;
+        for (size_t index = 0; index < sizeof(blockFormats) / sizeof(blockFormats[0]) && !found; index++)
+        {
+            if (blockFormats[index].format == internalFormat)
+            {
+                blockWidth = blockFormats[index].blockWidth;
+                blockHeight = blockFormats[index].blockHeight;
+                blockBytes = blockFormats[index].blockBytes;
+                found = true;
+            }
+        }
+
+        /* GL_COMPRESSED_RGBA_ASTC_4x4_KHR and GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR. */
+        GLenum astcBase = internalFormat >= 0x93D0 ? 0x93D0 : 0x93B0;
+        if (!found && internalFormat >= astcBase && internalFormat < astcBase + 14)
+        {
+            blockWidth = astcBlockSizes[internalFormat - astcBase][0];
+            blockHeight = astcBlockSizes[internalFormat - astcBase][1];
+            blockBytes = 16;
+            found = true;
+        }
+
+        for (size_t index = 0; index < sizeof(texelFormats) / sizeof(texelFormats[0]) && !found; index++)
+        {
+            if (texelFormats[index].format == internalFormat)
+            {
+                blockBytes = texelFormats[index].texelBytes;
+                found = true;
+            }
+        }
+
+        /* Array layers and cube faces do not get smaller with the levels, 3D textures are assumed to be rare here. */
+        size_t bytes = 0;
+        for (int level = 0; level < levels && (width > 0 || height > 0); level++)
+        {
+            int levelWidth = width > 1 ? width : 1;
+            int levelHeight = height > 1 ? height : 1;
+
+            bytes += (size_t)((levelWidth + blockWidth - 1) / blockWidth) * ((levelHeight + blockHeight - 1) / blockHeight) *
+                     blockBytes * (depth > 1 ? depth : 1);
+            width /= 2;
+            height /= 2;
+        }
+
+        return bytes;
+    }
+}
+
+extern "C" unsigned int MaliSDK_GPUMemory_reportLeaks(void)
+{
+    return MaliSDK::GPUMemory::reportLeaks();
+}
+
+extern "C" unsigned long long MaliSDK_GPUMemory_getTotal(void)
+{
+    unsigned long long total = 0;
+    for (int category = 0; category < MaliSDK::GPUMemory::NUMBER_OF_CATEGORIES; category++)
+    {
+        total += MaliSDK::GPUMemory::getTotal((MaliSDK::GPUMemory::Category)category);
+    }
+
+    return total;
+}
@@ -0,0 +1,267 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "GPUSkinning.h"
+#include "Platform.h"
+#include "Shader.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* One invocation per vertex. The output is the vertex buffer of the passes, see GPUSkinning::VERTEX_STRIDE. */
+    static const char *skinningComputeShaderSource =
+        "#version 310 es\n"
+        "layout(local_size_x = 64) in;\n"
+        "struct BindPoseVertex\n"
+        "{\n"
+        "    vec4 position;\n"
+        "    vec4 normal;\n"
+        "    uvec4 bones;\n"
+        "    vec4 weights;\n"
+        "};\n"
+        "struct SkinnedVertex\n"
+        "{\n"
+        "    vec4 position;\n"
+        "    vec4 normal;\n"
+        "};\n"
+        "layout(std430, binding = 0) readonly buffer BindPose { BindPoseVertex bindPose[]; };\n"
+        "layout(std430, binding = 1) readonly buffer Palette { vec4 palette[]; };\n"
+        "layout(std430, binding = 2) writeonly buffer Skinned { SkinnedVertex skinned[]; };\n"
+        "uniform uint numberOfVertices;\n"
+        "void main()\n"
+        "{\n"
+        "    uint index = gl_GlobalInvocationID.x;\n"
+        "    if (index >= numberOfVertices)\n"
+        "    {\n"
+        "        return;\n"
+        "    }\n"
+        "    BindPoseVertex vertex = bindPose[index];\n"
+        /* Blending the rows of the matrices first transforms each vertex only once. */
+        "    vec4 row0 = vec4(0.0);\n"
+        "    vec4 row1 = vec4(0.0);\n"
+        "    vec4 row2 = vec4(0.0);\n"
+        "    for (int i = 0; i < 4; i++)\n"
+        "    {\n"
+        "        uint bone = vertex.bones[i] * 3u;\n"
+        "        row0 += vertex.weights[i] * palette[bone + 0u];\n"
+        "        row1 += vertex.weights[i] * palette[bone + 1u];\n"
+        "        row2 += vertex.weights[i] * palette[bone + 2u];\n"
+        "    }\n"
+        "    vec4 position = vec4(vertex.position.xyz, 1.0);\n"
+        "    vec3 normal = vertex.normal.xyz;\n"
+        "    skinned[index].position = vec4(dot(row0, position), dot(row1, position), dot(row2, position), 1.0);\n"
+        "    skinned[index].normal = vec4(normalize(vec3(dot(row0.xyz, normal), dot(row1.xyz, normal), dot(row2.xyz, normal))), 0.0);\n"
+        "}\n";
+
+    GPUSkinning::GPUSkinning(void)
+        : numberOfVertices(0),
+          numberOfBones(0),
+          computeSupported(false),
+          skinningProgram(0),
+          numberOfVerticesLocation(-1),
+          bindPoseBuffer(0),
+          paletteBuffer(0),
+          vertexBuffer(0)
+    {
+    }
+
+    GPUSkinning::~GPUSkinning(void)
+    {
+        terminate();
+    }
+
+    bool GPUSkinning::initialize(const float *positions, const float *normals, const unsigned int *boneIndices, const float *boneWeights,
+                                 unsigned int numberOfVertices, unsigned int numberOfBones)
+    {
+        terminate();
+
+        this->numberOfVertices = numberOfVertices;
+        this->numberOfBones = numberOfBones;
+
+        bindPose.resize(numberOfVertices);
+        for (unsigned int vertexIndex = 0; vertexIndex < numberOfVertices; vertexIndex++)
+        {
+            BindPoseVertex &vertex = bindPose[vertexIndex];
+
+            for (int component = 0; component < 3; component++)
+            {
+                vertex.position[component] = positions[vertexIndex * 3 + component];
+                vertex.normal[component] = normals[vertexIndex * 3 + component];
+            }
+            vertex.position[3] = 1.0f;
+            vertex.normal[3] = 0.0f;
+
+            for (int influence = 0; influence < 4; influence++)
+            {
+                vertex.bones[influence] = boneIndices[vertexIndex * 4 + influence];
+                vertex.weights[influence] = boneWeights[vertexIndex * 4 + influence];
+            }
+        }
+
+        GLint majorVersion = 0;
+        GLint minorVersion = 0;
+
+        /* On an OpenGL ES 2.0 context the queries fail and leave the versions at 0. */
+        glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+        glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+        glGetError();
+        computeSupported = majorVersion > 3 || (majorVersion == 3 && minorVersion >= 1);
+
+        GL_CHECK(glGenBuffers(1, &vertexBuffer));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, numberOfVertices * VERTEX_STRIDE, NULL,
+                              computeSupported ? GL_DYNAMIC_COPY : GL_DYNAMIC_DRAW));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+        if (!computeSupported)
+        {
+            LOGI("GPUSkinning: no compute shaders, %u vertices are skinned on the CPU.\n", numberOfVertices);
+            skinnedVertices.resize(numberOfVertices * VERTEX_STRIDE / sizeof(float));
+            return false;
+        }
+
+        Shader::processComputeProgramSource(&skinningProgram, skinningComputeShaderSource);
+        numberOfVerticesLocation = GL_CHECK(glGetUniformLocation(skinningProgram, "numberOfVertices"));
+
+        GL_CHECK(glGenBuffers(1, &bindPoseBuffer));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, bindPoseBuffer));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, numberOfVertices * sizeof(BindPoseVertex), &bindPose[0], GL_STATIC_DRAW));
+
+        GL_CHECK(glGenBuffers(1, &paletteBuffer));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, paletteBuffer));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, numberOfBones * 12 * sizeof(float), NULL, GL_DYNAMIC_DRAW));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+        /* The GPU has its copy. */
+        std::vector<BindPoseVertex>().swap(bindPose);
+
+        return true;
+    }
+
+    void GPUSkinning::terminate(void)
+    {
+        if (skinningProgram != 0)
+        {
+            GL_CHECK(glDeleteProgram(skinningProgram));
+            skinningProgram = 0;
+        }
+
+        GLuint buffers[3] = { bindPoseBuffer, paletteBuffer, vertexBuffer };
+        if (vertexBuffer != 0)
+        {
+            GL_CHECK(glDeleteBuffers(3, buffers));
+        }
+        bindPoseBuffer = 0;
+        paletteBuffer = 0;
+        vertexBuffer = 0;
+
+        std::vector<BindPoseVertex>().swap(bindPose);
+        std::vector<float>().swap(skinnedVertices);
+        numberOfVertices = 0;
+        numberOfBones = 0;
+    }
+
+    void GPUSkinning::update(const float *palette)
+    {
+        if (!computeSupported)
+        {
+            skinOnCPU(palette);
+            return;
+        }
+
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, paletteBuffer));
+        GL_CHECK(glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, numberOfBones * 12 * sizeof(float), palette));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+        GL_CHECK(glUseProgram(skinningProgram));
+        GL_CHECK(glUniform1ui(numberOfVerticesLocation, numberOfVertices));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, bindPoseBuffer));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, paletteBuffer));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, vertexBuffer));
+        GL_CHECK(glDispatchCompute((numberOfVertices + 63) / 64, 1, 1));
+
+        /* The passes fetch the skinned vertices as attributes. */
+        GL_CHECK(glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT));
+    }
+
+    void GPUSkinning::skinOnCPU(const float *palette)
+    {
+        for (unsigned int vertexIndex = 0; vertexIndex < numberOfVertices; vertexIndex++)
+        {
+            const BindPoseVertex &vertex = bindPose[vertexIndex];
+            float rows[12] = { 0.0f };
+
+            for (int influence = 0; influence < 4; influence++)
+            {
+                const float weight = vertex.weights[influence];
+                const float *matrix = palette + vertex.bones[influence] * 12;
+
+                if (weight != 0.0f)
+                {
+                    for (int element = 0; element < 12; element++)
+                    {
+                        rows[element] += weight * matrix[element];
+                    }
+                }
+            }
+
+            float *skinned = &skinnedVertices[vertexIndex * 8];
+            float normalLength = 0.0f;
+
+            for (int row = 0; row < 3; row++)
+            {
+                const float *r = rows + row * 4;
+
+                skinned[row] = r[0] * vertex.position[0] + r[1] * vertex.position[1] + r[2] * vertex.position[2] + r[3];
+                skinned[4 + row] = r[0] * vertex.normal[0] + r[1] * vertex.normal[1] + r[2] * vertex.normal[2];
+                normalLength += skinned[4 + row] * skinned[4 + row];
+            }
+
+            normalLength = normalLength > 0.0f ? 1.0f / sqrtf(normalLength) : 0.0f;
+            skinned[3] = 1.0f;
+            skinned[4] *= normalLength;
+            skinned[5] *= normalLength;
+            skinned[6] *= normalLength;
+            skinned[7] = 0.0f;
+        }
+
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+        GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, 0, skinnedVertices.size() * sizeof(float), &skinnedVertices[0]));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+
+    GLuint GPUSkinning::getVertexBuffer(void) const
+    {
+        return vertexBuffer;
+    }
+
+    unsigned int GPUSkinning::getNumberOfVertices(void) const
+    {
+        return numberOfVertices;
+    }
+
+    bool GPUSkinning::isComputeSupported(void) const
+    {
+        return computeSupported;
+    }
+}
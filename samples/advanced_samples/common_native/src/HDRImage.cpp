@@ -18,31 +18,194 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#include <cassert>
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <cstdio>
+#include <new>
 #include <string>
 
 #include "HDRImage.h"
+#include "AssetFile.h"
 #include "Platform.h"
+#include "StartupProfiler.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HDR_USE_NEON 1
+#else
+#define HDR_USE_NEON 0
+#endif
 
 using std::string;
 
 #ifndef _WIN32
     #define MAXSHORT 0x7fff
     #define MAXCHAR  0x7f
-#endif _WIN32
+#endif
 
-static const string radianceHeader = "?#RADIANCE";
-const int    radianceHeaderLength = 11;
+/* Both signatures are written by Radiance tools. */
+static const char radianceHeader[] = "#?RADIANCE";
+static const char rgbeHeader[] = "#?RGBE";
 
 const int rgbComponentsCount = 3;
 const int rgbeComponentsCount = 4;
 const int minLineLength = 8;
 const int maxLineLength = MAXSHORT;
 
-const char startOfText = '\002';
+const unsigned char startOfText = '\002';
+
+/* Largest finite half float. */
+const float maxHalfValue = 65504.0f;
+
+namespace
+{
+    /*
+     * 2^(exponent - 128) / MAXCHAR, which is what convertSingleComponent() used to compute with pow().
+     * The power of two is built from its bits; the two smallest exponents give denormals and are flushed to 0.
+     */
+    inline float getRGBEScale(unsigned char exponent)
+    {
+        union
+        {
+            unsigned int bits;
+            float value;
+        } scale;
+
+        scale.bits = exponent > 1 ? (unsigned int)(exponent - 1) << 23 : 0;
+
+        return scale.value * (1.0f / MAXCHAR);
+    }
+
+    /* Round to nearest even. Values are never negative or NaN here, too large ones are clamped to the largest finite half. */
+    unsigned short convertToHalf(float value)
+    {
+        union
+        {
+            float value;
+            unsigned int bits;
+        } single;
+
+        single.value = value;
+
+        int exponent = (int)(single.bits >> 23) - 127 + 15;
+        unsigned int mantissa = single.bits & 0x7fffff;
+
+        if (exponent >= 31)
+        {
+            return 0x7bff;
+        }
+
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+            {
+                return 0;
+            }
+
+            /* Denormal half, the implicit 1 becomes part of the mantissa. */
+            unsigned int shift = 14 - exponent;
+            unsigned int halfway = 1u << (shift - 1);
+
+            mantissa |= 0x800000;
+
+            unsigned int half = mantissa >> shift;
+            unsigned int remainder = mantissa & ((1u << shift) - 1);
+
+            if (remainder > halfway || (remainder == halfway && (half & 1)))
+            {
+                half++;
+            }
+
+            return (unsigned short)half;
+        }
+
+        unsigned int half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+        unsigned int remainder = mantissa & 0x1fff;
+
+        /* A carry out of the mantissa correctly moves on to the next exponent. */
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        {
+            half++;
+        }
+
+        return (unsigned short)std::min(half, 0x7bffu);
+    }
+
+    /* As described in EXT_texture_shared_exponent. */
+    unsigned int convertToRGB9E5(float red, float green, float blue)
+    {
+        const int mantissaBits = 9;
+        const int exponentBias = 15;
+        const float maxValue = 65408.0f;
+
+        red = std::min(red, maxValue);
+        green = std::min(green, maxValue);
+        blue = std::min(blue, maxValue);
+
+        float maxComponent = std::max(red, std::max(green, blue));
+        int sharedExponent = 0;
+
+        if (maxComponent > 0.0f)
+        {
+            int exponent;
+
+            /* frexp() returns a fraction in [0.5, 1), so floor(log2(maxComponent)) is exponent - 1. */
+            frexp(maxComponent, &exponent);
+            sharedExponent = std::max(-exponentBias - 1, exponent - 1) + 1 + exponentBias;
+        }
+
+        if ((int)floorf(ldexpf(maxComponent, mantissaBits + exponentBias - sharedExponent) + 0.5f) == (1 << mantissaBits))
+        {
+            sharedExponent++;
+        }
+
+        int scaleExponent = mantissaBits + exponentBias - sharedExponent;
+        unsigned int redMantissa = (unsigned int)floorf(ldexpf(red, scaleExponent) + 0.5f);
+        unsigned int greenMantissa = (unsigned int)floorf(ldexpf(green, scaleExponent) + 0.5f);
+        unsigned int blueMantissa = (unsigned int)floorf(ldexpf(blue, scaleExponent) + 0.5f);
+
+        return redMantissa | (greenMantissa << 9) | (blueMantissa << 18) | ((unsigned int)sharedExponent << 27);
+    }
+
+    /* Find the first occurrence of "\n\n" and return what follows it, or NULL. */
+    const unsigned char* skipHeader(const unsigned char* data, const unsigned char* end)
+    {
+        for (const unsigned char* cursor = data; cursor + 1 < end; ++cursor)
+        {
+            if (cursor[0] == '\n' && cursor[1] == '\n')
+            {
+                return cursor + 2;
+            }
+        }
+
+        return NULL;
+    }
+
+#if HDR_USE_NEON
+    /* Convert 8 pixels of a decoded scanline to floats, 4 pixels per vector. */
+    inline void convertEightPixels(const unsigned char* planes, int lineLength, int x, float32x4_t rgb[2][3])
+    {
+        /* exponent - 1 as float bits is 2^(exponent - 128), see getRGBEScale(). */
+        uint8x8_t exponent = vqsub_u8(vld1_u8(planes + 3 * lineLength + x), vdup_n_u8(1));
+        uint16x8_t exponent16 = vmovl_u8(exponent);
+        float32x4_t scale[2] =
+        {
+            vmulq_n_f32(vreinterpretq_f32_u32(vshlq_n_u32(vmovl_u16(vget_low_u16(exponent16)), 23)), 1.0f / MAXCHAR),
+            vmulq_n_f32(vreinterpretq_f32_u32(vshlq_n_u32(vmovl_u16(vget_high_u16(exponent16)), 23)), 1.0f / MAXCHAR)
+        };
+
+        /* getRGBEScale() flushes exponent 1 to 0, and so does its bit pattern here. */
+        for (int component = 0; component < rgbComponentsCount; ++component)
+        {
+            uint16x8_t value = vmovl_u8(vld1_u8(planes + component * lineLength + x));
+
+            rgb[0][component] = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(value))), scale[0]);
+            rgb[1][component] = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(value))), scale[1]);
+        }
+    }
+#endif
+}
 
 namespace MaliSDK
 {
@@ -51,31 +214,59 @@ namespace MaliSDK
         width = 0;
         height = 0;
         rgbData = NULL;
+        packedData = NULL;
+        file = NULL;
+        planes = NULL;
+        cursor = NULL;
+        end = NULL;
+        decodedRows = 0;
+        format = FORMAT_RGB32F;
     }
 
-    HDRImage::HDRImage(const std::string& filePath)
+    HDRImage::HDRImage(const std::string& filePath, Format format)
     {
-        loadFromFile(filePath);
+        width = 0;
+        height = 0;
+        rgbData = NULL;
+        packedData = NULL;
+        file = NULL;
+        planes = NULL;
+        cursor = NULL;
+        end = NULL;
+        decodedRows = 0;
+        this->format = format;
+
+        loadFromFile(filePath, format);
     }
 
     HDRImage::~HDRImage(void)
     {
-        if (rgbData != NULL)
-        {
-            delete [] rgbData;
-            rgbData = NULL;
-        }
+        release();
     }
 
     HDRImage& HDRImage::operator= (const HDRImage &another)
     {
         if(this != &another)
         {
-            delete [] rgbData;
+            release();
             this->width = another.width;
             this->height = another.height;
-            this->rgbData = new float[this->width * this->height * rgbComponentsCount];
-            memcpy(this->rgbData, another.rgbData, this->width * this->width * rgbComponentsCount * sizeof(float));
+            this->format = another.format;
+            this->decodedRows = another.decodedRows;
+
+            size_t size = (size_t)another.width * another.height * getBytesPerPixel(another.format);
+
+            if (another.rgbData != NULL)
+            {
+                this->rgbData = new float[another.width * another.height * rgbComponentsCount];
+                memcpy(this->rgbData, another.rgbData, size);
+            }
+
+            if (another.packedData != NULL)
+            {
+                this->packedData = new unsigned char[size];
+                memcpy(this->packedData, another.packedData, size);
+            }
         }
 
         return *this;
@@ -83,209 +274,404 @@ namespace MaliSDK
 
     HDRImage::HDRImage(HDRImage& another)
     {
-        if(this != &another)
+        width = 0;
+        height = 0;
+        rgbData = NULL;
+        packedData = NULL;
+        file = NULL;
+        planes = NULL;
+        cursor = NULL;
+        end = NULL;
+        decodedRows = 0;
+        format = FORMAT_RGB32F;
+
+        *this = another;
+    }
+
+    size_t HDRImage::getBytesPerPixel(Format format)
+    {
+        switch (format)
         {
-            this->width = another.width;
-            this->height = another.height;
-            this->rgbData = new float[this->width * this->height * rgbComponentsCount];
-            memcpy(this->rgbData, another.rgbData, this->width * this->width * rgbComponentsCount * sizeof(float));
+            case FORMAT_RGB16F:
+                return rgbComponentsCount * sizeof(unsigned short);
+
+            case FORMAT_RGBA16F:
+                return rgbeComponentsCount * sizeof(unsigned short);
+
+            case FORMAT_RGB9_E5:
+            case FORMAT_RGBE8:
+                return rgbeComponentsCount;
+
+            default:
+                return rgbComponentsCount * sizeof(float);
         }
     }
 
-    void HDRImage::loadFromFile(const std::string& filePath)
+    void HDRImage::release(void)
     {
-        FILE* file;
+        close();
+        delete [] rgbData;
+        delete [] packedData;
+        rgbData = NULL;
+        packedData = NULL;
+        width = 0;
+        height = 0;
+        decodedRows = 0;
+    }
 
-        file = fopen(filePath.c_str(), "rb");
+    void HDRImage::loadFromFile(const std::string& filePath, Format format)
+    {
+        if (!open(filePath, format))
+        {
+            return;
+        }
 
-        if (file == NULL)
+        if (decodeRows(height) != height)
         {
-            LOGE("Could not open file %s", filePath.c_str());
+            release();
             return;
         }
 
+        close();
+    }
+
+    bool HDRImage::open(const std::string& filePath, Format format)
+    {
+        release();
+        this->format = format;
+
+        /* The whole file is mapped, the scanlines are decoded straight from it. */
+        file = new AssetFile();
+
+        if (!file->open(filePath.c_str()))
+        {
+            LOGE("Could not open file %s", filePath.c_str());
+            release();
+            return false;
+        }
+
+        const unsigned char* data = file->getData();
+        size_t size = file->getSize();
+
+        end = data + size;
+
         /* Read header. */
-        char header[radianceHeaderLength];
+        bool radiance = size >= sizeof(radianceHeader) - 1 && memcmp(data, radianceHeader, sizeof(radianceHeader) - 1) == 0;
+        bool rgbe = size >= sizeof(rgbeHeader) - 1 && memcmp(data, rgbeHeader, sizeof(rgbeHeader) - 1) == 0;
+
+        if (!radiance && !rgbe)
+        {
+            LOGE("File header has not been recognized.\n");
+            release();
+            return false;
+        }
 
-        fread(header, 1, radianceHeaderLength, file);
-        header[radianceHeaderLength - 1] = 0;
-        string readHeader = header;
+        /* Search for resolution data, the header ends with an empty line. */
+        cursor = skipHeader(data, end);
 
-        if (!readHeader.compare(radianceHeader))
+        if (cursor == NULL)
         {
             LOGE("File header has not been recognized.\n");
-            fclose(file);
-            return;
+            release();
+            return false;
         }
 
-        /* Search for resolution data. */
-        char currentChar  = 0;
-        char previousChar = 0;
+        /* The scanlines start right after the resolution line. */
+        char resolution[64];
+        size_t resolutionLength = 0;
 
-        while ((previousChar != '\n' || currentChar != '\n') && currentChar != EOF)
+        while (cursor < end && *cursor != '\n' && resolutionLength < sizeof(resolution) - 1)
         {
-            previousChar = currentChar;
-            currentChar = fgetc(file);
+            resolution[resolutionLength++] = (char)*cursor++;
         }
+        resolution[resolutionLength] = '\0';
+        cursor++;
 
         int imageWidth = 0;
         int imageHeight = 0;
 
-        fscanf(file, "-Y %d ", &imageHeight);
-        fscanf(file, "+X %d ", &imageWidth);
+        if (cursor > end || sscanf(resolution, "-Y %d +X %d", &imageHeight, &imageWidth) != 2 || imageHeight <= 0)
+        {
+            LOGE("Only images with coordinates specified in -Y +X are supported.\n");
+            release();
+            return false;
+        }
 
         if (imageWidth < minLineLength || imageWidth > maxLineLength)
         {
             LOGE("Cannot decode image with width lower than %d or higher than %d", minLineLength, maxLineLength);
-            return;
+            release();
+            return false;
         }
 
-        height = imageHeight;
-        width = imageWidth;
-
-        RGBEPixel* scanLine = NULL;
-
         try
         {
-            rgbData = new float[imageWidth * imageHeight * rgbComponentsCount];
-            scanLine = new RGBEPixel[imageWidth * rgbeComponentsCount];
+            planes = new unsigned char[imageWidth * rgbeComponentsCount];
+
+            if (format == FORMAT_RGB32F)
+            {
+                rgbData = new float[imageWidth * imageHeight * rgbComponentsCount];
+            }
+            else
+            {
+                packedData = new unsigned char[(size_t)imageWidth * imageHeight * getBytesPerPixel(format)];
+            }
         }
         catch (std::bad_alloc& ba)
         {
             LOGE("Exception caught: %s", ba.what());
-            return;
+            release();
+            return false;
+        }
+
+        width = imageWidth;
+        height = imageHeight;
+        decodedRows = 0;
+
+        return true;
+    }
+
+    int HDRImage::decodeRows(int numberOfRows)
+    {
+        STARTUP_PHASE(PHASE_DECODE);
+        if (file == NULL)
+        {
+            return -1;
         }
 
-        for (int y = 0; y < imageHeight; ++y)
+        size_t rowSize = (size_t)width * getBytesPerPixel(format);
+        unsigned char* destination = (format == FORMAT_RGB32F) ? (unsigned char*)rgbData : packedData;
+        int lastRow = std::min(decodedRows + numberOfRows, height);
+        int firstRow = decodedRows;
+
+        for (int y = firstRow; y < lastRow; ++y)
         {
-            if (!decodeLine(file, imageWidth, scanLine))
+            if (!decodeLine(&cursor, end, width, planes))
             {
                 LOGE("One of the scan lines has not been encoded correctly.\n");
 
-                delete [] scanLine;
-                fclose(file);
-
-                return;
+                return -1;
             }
 
-            for (int x = 0; x < imageWidth; ++x)
-            {
-                int rgbPixelMove = (y * imageWidth + x) * 3;
-                convertRGBEPixel(scanLine[x], rgbData + rgbPixelMove);
-            }
+            convertLine(planes, width, format, destination + (size_t)y * rowSize);
+            decodedRows++;
         }
 
-        delete [] scanLine;
-
-        fclose(file);
+        return lastRow - firstRow;
     }
 
-    inline void HDRImage::convertRGBEPixel(const RGBEPixel& pixel, float* rgbData)
+    int HDRImage::getDecodedRows(void) const
     {
-        int exponent = pixel.e - 128;
-
-        rgbData[0] = convertSingleComponent(pixel.r, exponent);
-        rgbData[1] = convertSingleComponent(pixel.g, exponent);
-        rgbData[2] = convertSingleComponent(pixel.b, exponent);
+        return decodedRows;
     }
 
-    inline float HDRImage::convertSingleComponent(unsigned char value, int exponent)
+    void HDRImage::close(void)
     {
-        float floatValue = static_cast<float> (value) / MAXCHAR;
-        float multiplier = pow(2.0f, exponent);
-
-        return floatValue * multiplier;
+        delete file;
+        delete [] planes;
+        file = NULL;
+        planes = NULL;
+        cursor = NULL;
+        end = NULL;
     }
 
-    bool HDRImage::decodeLine(FILE* file, int lineLength, RGBEPixel* scanLine)
+    bool HDRImage::decodeLine(const unsigned char** cursor, const unsigned char* end, int lineLength, unsigned char* planes)
     {
-        /* Check if line beginning is correct. */
-        char startLineChar1 = fgetc(file);
-        char startLineChar2 = fgetc(file);
-        char startLineChar3 = fgetc(file);
+        const unsigned char* input = *cursor;
 
-        if (startLineChar1 != startOfText || startLineChar2 != startOfText || startLineChar3 & 0x80)
+        /* Check if line beginning is correct, it also stores the line length. */
+        if (end - input < 4 ||
+            input[0] != startOfText || input[1] != startOfText || (input[2] & 0x80) ||
+            ((input[2] << 8) | input[3]) != lineLength)
         {
             LOGE("Error occured while encoding HDR data. Unknown line beginnings.");
 
             return false;
         }
 
-        /* Move file position indicator by one character. */
-        fgetc(file);
+        input += 4;
 
+        /* Each component is run-length encoded separately, one after the other. */
         for (int componentIndex = 0; componentIndex < rgbeComponentsCount; ++componentIndex)
         {
-            int pixelIndex = 0;
+            unsigned char* output = planes + componentIndex * lineLength;
+            unsigned char* outputEnd = output + lineLength;
 
-            while (pixelIndex < lineLength)
+            while (output < outputEnd)
             {
+                if (input >= end)
+                {
+                    return false;
+                }
+
                 /* Code for RLE compression algorithm. */
-                unsigned char rleCode = fgetc(file);
+                int rleCode = *input++;
 
                 if (rleCode > MAXCHAR + 1)
                 {
-                    /* 
-                     * Read code indicates how many pixels are written with the same value,
-                     *.so it is read only once.
-                     */
-                    unsigned char value = fgetc(file);
-
+                    /* Read code indicates how many pixels are written with the same value. */
                     rleCode &= MAXCHAR;
 
-                    while (rleCode--)
+                    if (rleCode > outputEnd - output || input >= end)
                     {
-                        writeDecodedComponent(componentIndex, value, &scanLine[pixelIndex++]);
+                        return false;
                     }
+
+                    memset(output, *input++, rleCode);
                 }
                 else
                 {
-                    while (rleCode--)
+                    /* Read code indicates how many values follow, stored as they are. */
+                    if (rleCode == 0 || rleCode > outputEnd - output || rleCode > end - input)
                     {
-                        /* 
-                         * Read code indicates how many pixels are written next to each other,
-                         * so their value must be read each time this loop is executed.
-                         */
-                        unsigned char value = fgetc(file);
-
-                        writeDecodedComponent(componentIndex, value, &scanLine[pixelIndex++]);
+                        return false;
                     }
+
+                    memcpy(output, input, rleCode);
+                    input += rleCode;
                 }
+
+                output += rleCode;
             }
         }
 
+        *cursor = input;
+
         return true;
     }
 
-    inline void HDRImage::writeDecodedComponent(int componentIndicator, unsigned char value, RGBEPixel* rgbePixel)
+    void HDRImage::convertLine(const unsigned char* planes, int lineLength, Format format, void* destination)
     {
-        if (rgbePixel == NULL)
+        const unsigned char* red = planes;
+        const unsigned char* green = planes + lineLength;
+        const unsigned char* blue = planes + 2 * lineLength;
+        const unsigned char* exponent = planes + 3 * lineLength;
+        int x = 0;
+
+        switch (format)
         {
-            LOGE("Cannot write encoded component to a NULL pointer.\n");
+            case FORMAT_RGB32F:
+            {
+                float* output = (float*)destination;
 
-            return;
-        }
+#if HDR_USE_NEON
+                for (; x + 8 <= lineLength; x += 8)
+                {
+                    float32x4_t rgb[2][3];
 
-        switch (componentIndicator)
-        {
-            case 0:
-                rgbePixel->r = value;
-                break;
+                    convertEightPixels(planes, lineLength, x, rgb);
+
+                    for (int half = 0; half < 2; ++half)
+                    {
+                        float32x4x3_t pixels = { { rgb[half][0], rgb[half][1], rgb[half][2] } };
 
-            case 1:
-                rgbePixel->g = value;
+                        vst3q_f32(output + (x + half * 4) * rgbComponentsCount, pixels);
+                    }
+                }
+#endif
+                for (; x < lineLength; ++x)
+                {
+                    float scale = getRGBEScale(exponent[x]);
+
+                    output[x * rgbComponentsCount + 0] = red[x] * scale;
+                    output[x * rgbComponentsCount + 1] = green[x] * scale;
+                    output[x * rgbComponentsCount + 2] = blue[x] * scale;
+                }
                 break;
+            }
+
+            case FORMAT_RGB16F:
+            case FORMAT_RGBA16F:
+            {
+                unsigned short* output = (unsigned short*)destination;
+                /* Half float 1.0 for the alpha channel. */
+                const unsigned short alpha = 0x3c00;
+
+#if HDR_USE_NEON && defined(__aarch64__)
+                /* The float to half conversion is only guaranteed on arm64, armeabi-v7a uses convertToHalf(). */
+                for (; x + 8 <= lineLength; x += 8)
+                {
+                    float32x4_t rgb[2][3];
+                    float32x4_t maxValue = vdupq_n_f32(maxHalfValue);
+
+                    convertEightPixels(planes, lineLength, x, rgb);
+
+                    for (int half = 0; half < 2; ++half)
+                    {
+                        uint16x4_t components[3];
+
+                        for (int component = 0; component < rgbComponentsCount; ++component)
+                        {
+                            components[component] = vreinterpret_u16_f16(vcvt_f16_f32(vminq_f32(rgb[half][component], maxValue)));
+                        }
+
+                        if (format == FORMAT_RGBA16F)
+                        {
+                            uint16x4x4_t pixels = { { components[0], components[1], components[2], vdup_n_u16(alpha) } };
+
+                            vst4_u16(output + (x + half * 4) * rgbeComponentsCount, pixels);
+                        }
+                        else
+                        {
+                            uint16x4x3_t pixels = { { components[0], components[1], components[2] } };
 
-            case 2:
-                rgbePixel->b = value;
+                            vst3_u16(output + (x + half * 4) * rgbComponentsCount, pixels);
+                        }
+                    }
+                }
+#endif
+                int stride = (format == FORMAT_RGBA16F) ? rgbeComponentsCount : rgbComponentsCount;
+
+                for (; x < lineLength; ++x)
+                {
+                    float scale = getRGBEScale(exponent[x]);
+
+                    output[x * stride + 0] = convertToHalf(red[x] * scale);
+                    output[x * stride + 1] = convertToHalf(green[x] * scale);
+                    output[x * stride + 2] = convertToHalf(blue[x] * scale);
+
+                    if (format == FORMAT_RGBA16F)
+                    {
+                        output[x * stride + 3] = alpha;
+                    }
+                }
                 break;
+            }
+
+            case FORMAT_RGB9_E5:
+            {
+                unsigned int* output = (unsigned int*)destination;
+
+                for (; x < lineLength; ++x)
+                {
+                    float scale = getRGBEScale(exponent[x]);
 
-            case 3:
-                rgbePixel->e = value;
+                    output[x] = convertToRGB9E5(red[x] * scale, green[x] * scale, blue[x] * scale);
+                }
                 break;
+            }
 
-            default:
-                LOGE("Invalid value of componentIndicator was passed.\n");
+            case FORMAT_RGBE8:
+            {
+                unsigned char* output = (unsigned char*)destination;
+
+#if HDR_USE_NEON
+                for (; x + 8 <= lineLength; x += 8)
+                {
+                    uint8x8x4_t pixels = { { vld1_u8(red + x), vld1_u8(green + x), vld1_u8(blue + x), vld1_u8(exponent + x) } };
+
+                    vst4_u8(output + x * rgbeComponentsCount, pixels);
+                }
+#endif
+                for (; x < lineLength; ++x)
+                {
+                    output[x * rgbeComponentsCount + 0] = red[x];
+                    output[x * rgbeComponentsCount + 1] = green[x];
+                    output[x * rgbeComponentsCount + 2] = blue[x];
+                    output[x * rgbeComponentsCount + 3] = exponent[x];
+                }
+                break;
+            }
         }
     }
 }
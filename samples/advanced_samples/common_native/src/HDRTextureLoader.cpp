@@ -0,0 +1,370 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "HDRTextureLoader.h"
+#include "Platform.h"
+#include "Shader.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* A triangle covering the viewport, generated from gl_VertexID so no vertex buffer is needed. */
+    static const char prefilterVertexShaderSource[] =
+        "#version 300 es\n"
+        "out vec2 texCoord;\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));\n"
+        "    texCoord = position;\n"
+        "    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);\n"
+        "}\n";
+
+    /*
+     * Each destination texel sits between 2x2 source texels. Bilinear taps 0.75 source texels away on each axis
+     * weigh the 4x4 texels around it [1 3 3 1] / 8 per axis.
+     */
+    static const char prefilterFragmentShaderSource[] =
+        "#version 300 es\n"
+        "precision highp float;\n"
+        "uniform sampler2D source;\n"
+        "uniform vec2 sourceTexelSize;\n"
+        "in vec2 texCoord;\n"
+        "out vec4 color;\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 offset = 0.75 * sourceTexelSize;\n"
+        "    color = 0.25 * (textureLod(source, texCoord + vec2(-offset.x, -offset.y), 0.0) +\n"
+        "                    textureLod(source, texCoord + vec2( offset.x, -offset.y), 0.0) +\n"
+        "                    textureLod(source, texCoord + vec2(-offset.x,  offset.y), 0.0) +\n"
+        "                    textureLod(source, texCoord + vec2( offset.x,  offset.y), 0.0));\n"
+        "}\n";
+
+    static bool isExtensionSupported(const char *extension)
+    {
+        GLint numberOfExtensions = 0;
+
+        GL_CHECK(glGetIntegerv(GL_NUM_EXTENSIONS, &numberOfExtensions));
+
+        for (GLint extensionIndex = 0; extensionIndex < numberOfExtensions; extensionIndex++)
+        {
+            const char *name = (const char *)GL_CHECK(glGetStringi(GL_EXTENSIONS, extensionIndex));
+
+            if (name != NULL && strcmp(name, extension) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    HDRTextureLoader::HDRTextureLoader(void)
+        : stripHeight(0),
+          uploadedRows(0),
+          numberOfLevels(0),
+          texture(0),
+          complete(false),
+          prefilterProgram(0),
+          sourceTexelSizeLocation(-1),
+          workerStarted(false),
+          cancelled(false),
+          failed(false),
+          decodedRows(0)
+    {
+        pthread_mutex_init(&mutex, NULL);
+    }
+
+    HDRTextureLoader::~HDRTextureLoader(void)
+    {
+        pthread_mutex_lock(&mutex);
+        cancelled = true;
+        pthread_mutex_unlock(&mutex);
+
+        joinWorker();
+
+        if (texture != 0)
+        {
+            GL_CHECK(glDeleteTextures(1, &texture));
+        }
+
+        if (prefilterProgram != 0)
+        {
+            GL_CHECK(glDeleteProgram(prefilterProgram));
+        }
+
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void HDRTextureLoader::joinWorker(void)
+    {
+        if (workerStarted)
+        {
+            pthread_join(workerThread, NULL);
+            workerStarted = false;
+        }
+    }
+
+    void *HDRTextureLoader::workerFunction(void *loader)
+    {
+        HDRTextureLoader *self = (HDRTextureLoader *)loader;
+
+        while (true)
+        {
+            int rows = self->image.decodeRows(self->stripHeight);
+
+            pthread_mutex_lock(&self->mutex);
+
+            bool stop = self->cancelled || rows <= 0;
+
+            if (rows > 0)
+            {
+                self->decodedRows += rows;
+                stop = stop || self->decodedRows == self->image.height;
+            }
+            if (rows < 0)
+            {
+                self->failed = true;
+            }
+
+            pthread_mutex_unlock(&self->mutex);
+
+            if (stop)
+            {
+                break;
+            }
+        }
+
+        /* The mapping is only needed while decoding. */
+        self->image.close();
+
+        return NULL;
+    }
+
+    bool HDRTextureLoader::start(const std::string &filePath, int stripHeight)
+    {
+        if (workerStarted || texture != 0)
+        {
+            LOGE("HDRTextureLoader::start() called twice.\n");
+            exit(1);
+        }
+
+        /* Only the header is read here, so start() returns straight away. */
+        if (!image.open(filePath, HDRImage::FORMAT_RGBA16F))
+        {
+            return false;
+        }
+
+        this->filePath = filePath;
+        this->stripHeight = stripHeight > 0 ? stripHeight : 1;
+
+        /* Full mip chain: floor(log2(max(width, height))) + 1 levels. */
+        int size = image.width > image.height ? image.width : image.height;
+
+        numberOfLevels = 1;
+        while (size > 1)
+        {
+            size >>= 1;
+            numberOfLevels++;
+        }
+
+        if (!isExtensionSupported("GL_EXT_color_buffer_half_float") && !isExtensionSupported("GL_EXT_color_buffer_float"))
+        {
+            LOGI("HDRTextureLoader: GL_RGBA16F is not renderable, %s will not be mipmapped.\n", filePath.c_str());
+            numberOfLevels = 1;
+        }
+
+        GL_CHECK(glGenTextures(1, &texture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, numberOfLevels, GL_RGBA16F, image.width, image.height));
+        /* Equirectangular maps wrap around horizontally. */
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, numberOfLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+
+        uploadedRows = 0;
+        decodedRows = 0;
+        complete = false;
+        failed = false;
+        cancelled = false;
+
+        if (pthread_create(&workerThread, NULL, &workerFunction, this) != 0)
+        {
+            /* No thread, decode everything now so update() still works. */
+            LOGI("HDRTextureLoader: cannot start a worker thread, decoding %s on the rendering thread.\n", filePath.c_str());
+            workerFunction(this);
+        }
+        else
+        {
+            workerStarted = true;
+        }
+
+        return true;
+    }
+
+    bool HDRTextureLoader::update(void)
+    {
+        if (complete || texture == 0)
+        {
+            return complete;
+        }
+
+        pthread_mutex_lock(&mutex);
+        int availableRows = decodedRows;
+        bool decodingFailed = failed;
+        pthread_mutex_unlock(&mutex);
+
+        if (availableRows > uploadedRows)
+        {
+            size_t rowSize = (size_t)image.width * HDRImage::getBytesPerPixel(image.format);
+
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+            GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, uploadedRows, image.width, availableRows - uploadedRows,
+                                     GL_RGBA, GL_HALF_FLOAT, image.packedData + uploadedRows * rowSize));
+
+            uploadedRows = availableRows;
+        }
+
+        if (decodingFailed)
+        {
+            /* Whatever was decoded stays in the texture, the rest of it is undefined. */
+            LOGE("HDRTextureLoader: %s is truncated after %d rows.\n", filePath.c_str(), uploadedRows);
+            uploadedRows = image.height;
+        }
+
+        if (uploadedRows == image.height)
+        {
+            joinWorker();
+
+            if (numberOfLevels > 1)
+            {
+                generateMipmaps();
+            }
+
+            complete = true;
+        }
+
+        return complete;
+    }
+
+    void HDRTextureLoader::generateMipmaps(void)
+    {
+        if (prefilterProgram == 0)
+        {
+            Shader::processProgramSource(&prefilterProgram, prefilterVertexShaderSource, prefilterFragmentShaderSource);
+
+            sourceTexelSizeLocation = GL_CHECK(glGetUniformLocation(prefilterProgram, "sourceTexelSize"));
+            GL_CHECK(glUseProgram(prefilterProgram));
+            GL_CHECK(glUniform1i(glGetUniformLocation(prefilterProgram, "source"), 0));
+        }
+
+        GLint previousFramebuffer = 0;
+        GLint previousProgram = 0;
+        GLint previousViewport[4];
+        GLint previousActiveTexture = 0;
+        GLint previousVertexArray = 0;
+        GLuint framebuffer = 0;
+        GLuint vertexArray = 0;
+
+        GL_CHECK(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer));
+        GL_CHECK(glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram));
+        GL_CHECK(glGetIntegerv(GL_VIEWPORT, previousViewport));
+        GL_CHECK(glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture));
+        GL_CHECK(glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray));
+
+        GL_CHECK(glGenFramebuffers(1, &framebuffer));
+        GL_CHECK(glGenVertexArrays(1, &vertexArray));
+        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer));
+        GL_CHECK(glBindVertexArray(vertexArray));
+        GL_CHECK(glUseProgram(prefilterProgram));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+
+        GLboolean blend = GL_CHECK(glIsEnabled(GL_BLEND));
+        GLboolean depthTest = GL_CHECK(glIsEnabled(GL_DEPTH_TEST));
+        GL_CHECK(glDisable(GL_BLEND));
+        GL_CHECK(glDisable(GL_DEPTH_TEST));
+
+        int sourceWidth = image.width;
+        int sourceHeight = image.height;
+
+        for (int level = 1; level < numberOfLevels; level++)
+        {
+            int levelWidth = sourceWidth > 1 ? sourceWidth >> 1 : 1;
+            int levelHeight = sourceHeight > 1 ? sourceHeight >> 1 : 1;
+
+            /* Only the previous level may be sampled, anything else would be a feedback loop with the attached level. */
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1));
+            GL_CHECK(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, level));
+
+            GL_CHECK(glViewport(0, 0, levelWidth, levelHeight));
+            GL_CHECK(glUniform2f(sourceTexelSizeLocation, 1.0f / sourceWidth, 1.0f / sourceHeight));
+            GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+
+            sourceWidth = levelWidth;
+            sourceHeight = levelHeight;
+        }
+
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numberOfLevels - 1));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+
+        if (blend)
+        {
+            GL_CHECK(glEnable(GL_BLEND));
+        }
+        if (depthTest)
+        {
+            GL_CHECK(glEnable(GL_DEPTH_TEST));
+        }
+
+        GL_CHECK(glBindVertexArray(previousVertexArray));
+        GL_CHECK(glDeleteVertexArrays(1, &vertexArray));
+        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebuffer));
+        GL_CHECK(glDeleteFramebuffers(1, &framebuffer));
+        GL_CHECK(glUseProgram(previousProgram));
+        GL_CHECK(glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]));
+        GL_CHECK(glActiveTexture(previousActiveTexture));
+    }
+
+    bool HDRTextureLoader::isComplete(void) const
+    {
+        return complete;
+    }
+
+    GLuint HDRTextureLoader::getTexture(void) const
+    {
+        return texture;
+    }
+
+    int HDRTextureLoader::getWidth(void) const
+    {
+        return image.width;
+    }
+
+    int HDRTextureLoader::getHeight(void) const
+    {
+        return image.height;
+    }
+}
@@ -0,0 +1,315 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "HardwareBufferTexture.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+
+#include <GLES2/gl2ext.h>
+#include <android/hardware_buffer.h>
+#include <dlfcn.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+
+/* EGL_ANDROID_image_native_buffer and EGL_ANDROID_native_fence_sync, missing from older headers. */
+#ifndef EGL_NATIVE_BUFFER_ANDROID
+#define EGL_NATIVE_BUFFER_ANDROID 0x3140
+#endif
+#ifndef EGL_SYNC_NATIVE_FENCE_ANDROID
+#define EGL_SYNC_NATIVE_FENCE_ANDROID 0x3144
+#endif
+#ifndef EGL_SYNC_NATIVE_FENCE_FD_ANDROID
+#define EGL_SYNC_NATIVE_FENCE_FD_ANDROID 0x3145
+#endif
+#ifndef EGL_NO_NATIVE_FENCE_FD_ANDROID
+#define EGL_NO_NATIVE_FENCE_FD_ANDROID -1
+#endif
+
+namespace MaliSDK
+{
+    /* AHardwareBuffer is looked up at run time, it only exists from API level 26. */
+    typedef int (*AHardwareBufferAllocateFunction)(const AHardwareBuffer_Desc *description, AHardwareBuffer **buffer);
+    typedef void (*AHardwareBufferReleaseFunction)(AHardwareBuffer *buffer);
+    typedef void (*AHardwareBufferDescribeFunction)(const AHardwareBuffer *buffer, AHardwareBuffer_Desc *description);
+    typedef int (*AHardwareBufferLockFunction)(AHardwareBuffer *buffer, uint64_t usage, int32_t fence, const ARect *rect, void **address);
+    typedef int (*AHardwareBufferUnlockFunction)(AHardwareBuffer *buffer, int32_t *fence);
+
+    typedef EGLClientBuffer (EGLAPIENTRYP GetNativeClientBufferFunction)(const AHardwareBuffer *buffer);
+    typedef EGLImageKHR (EGLAPIENTRYP CreateImageFunction)(EGLDisplay display, EGLContext context, EGLenum target,
+                                                           EGLClientBuffer buffer, const EGLint *attributes);
+    typedef EGLBoolean (EGLAPIENTRYP DestroyImageFunction)(EGLDisplay display, EGLImageKHR image);
+    typedef EGLSyncKHR (EGLAPIENTRYP CreateSyncFunction)(EGLDisplay display, EGLenum type, const EGLint *attributes);
+    typedef EGLBoolean (EGLAPIENTRYP DestroySyncFunction)(EGLDisplay display, EGLSyncKHR sync);
+    typedef EGLint (EGLAPIENTRYP WaitSyncFunction)(EGLDisplay display, EGLSyncKHR sync, EGLint flags);
+    typedef EGLint (EGLAPIENTRYP DupNativeFenceFDFunction)(EGLDisplay display, EGLSyncKHR sync);
+    typedef void (GL_APIENTRYP EGLImageTargetTexture2DFunction)(GLenum target, GLeglImageOES image);
+
+    static AHardwareBufferAllocateFunction hardwareBufferAllocate = NULL;
+    static AHardwareBufferReleaseFunction hardwareBufferRelease = NULL;
+    static AHardwareBufferDescribeFunction hardwareBufferDescribe = NULL;
+    static AHardwareBufferLockFunction hardwareBufferLock = NULL;
+    static AHardwareBufferUnlockFunction hardwareBufferUnlock = NULL;
+    static pthread_once_t hardwareBufferLookUp = PTHREAD_ONCE_INIT;
+
+    static GetNativeClientBufferFunction getNativeClientBuffer = NULL;
+    static CreateImageFunction createImage = NULL;
+    static DestroyImageFunction destroyImage = NULL;
+    static CreateSyncFunction createSync = NULL;
+    static DestroySyncFunction destroySync = NULL;
+    static WaitSyncFunction waitSync = NULL;
+    static DupNativeFenceFDFunction dupNativeFenceFD = NULL;
+    static EGLImageTargetTexture2DFunction imageTargetTexture2D = NULL;
+
+    static const uint64_t writeUsage = AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN | AHARDWAREBUFFER_USAGE_CPU_READ_NEVER;
+
+    static void lookUpHardwareBufferOnce(void)
+    {
+        void *library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+        if (library != NULL)
+        {
+            hardwareBufferAllocate = (AHardwareBufferAllocateFunction)dlsym(library, "AHardwareBuffer_allocate");
+            hardwareBufferRelease = (AHardwareBufferReleaseFunction)dlsym(library, "AHardwareBuffer_release");
+            hardwareBufferDescribe = (AHardwareBufferDescribeFunction)dlsym(library, "AHardwareBuffer_describe");
+            hardwareBufferLock = (AHardwareBufferLockFunction)dlsym(library, "AHardwareBuffer_lock");
+            hardwareBufferUnlock = (AHardwareBufferUnlockFunction)dlsym(library, "AHardwareBuffer_unlock");
+        }
+    }
+
+    bool HardwareBufferTexture::isSupported(void)
+    {
+        pthread_once(&hardwareBufferLookUp, lookUpHardwareBufferOnce);
+
+        if (hardwareBufferAllocate == NULL || hardwareBufferRelease == NULL || hardwareBufferDescribe == NULL ||
+            hardwareBufferLock == NULL || hardwareBufferUnlock == NULL)
+        {
+            return false;
+        }
+
+        const char *eglExtensions = eglQueryString(eglGetCurrentDisplay(), EGL_EXTENSIONS);
+        const char *glExtensions = (const char *)glGetString(GL_EXTENSIONS);
+
+        if (!GLExtensions::isInList(eglExtensions, "EGL_ANDROID_get_native_client_buffer") ||
+            !GLExtensions::isInList(eglExtensions, "EGL_ANDROID_image_native_buffer") ||
+            !GLExtensions::isInList(eglExtensions, "EGL_KHR_image_base") ||
+            !GLExtensions::isInList(eglExtensions, "EGL_ANDROID_native_fence_sync") ||
+            !GLExtensions::isInList(eglExtensions, "EGL_KHR_wait_sync") ||
+            !GLExtensions::isInList(glExtensions, "GL_OES_EGL_image"))
+        {
+            return false;
+        }
+
+        getNativeClientBuffer = (GetNativeClientBufferFunction)eglGetProcAddress("eglGetNativeClientBufferANDROID");
+        createImage = (CreateImageFunction)eglGetProcAddress("eglCreateImageKHR");
+        destroyImage = (DestroyImageFunction)eglGetProcAddress("eglDestroyImageKHR");
+        createSync = (CreateSyncFunction)eglGetProcAddress("eglCreateSyncKHR");
+        destroySync = (DestroySyncFunction)eglGetProcAddress("eglDestroySyncKHR");
+        waitSync = (WaitSyncFunction)eglGetProcAddress("eglWaitSyncKHR");
+        dupNativeFenceFD = (DupNativeFenceFDFunction)eglGetProcAddress("eglDupNativeFenceFDANDROID");
+        imageTargetTexture2D = (EGLImageTargetTexture2DFunction)eglGetProcAddress("glEGLImageTargetTexture2DOES");
+
+        return getNativeClientBuffer != NULL && createImage != NULL && destroyImage != NULL && createSync != NULL &&
+               destroySync != NULL && waitSync != NULL && dupNativeFenceFD != NULL && imageTargetTexture2D != NULL;
+    }
+
+    HardwareBufferTexture::HardwareBufferTexture(int width, int height)
+        : display(eglGetCurrentDisplay()),
+          width(width),
+          height(height),
+          stride(width),
+          buffer(NULL),
+          image(EGL_NO_IMAGE_KHR),
+          textureID(0),
+          acquireFence(-1),
+          releaseFence(-1)
+    {
+        if (!isSupported())
+        {
+            LOGE("Hardware buffer textures are not supported.\n");
+            exit(1);
+        }
+
+        AHardwareBuffer_Desc description;
+        memset(&description, 0, sizeof(description));
+        description.width = width;
+        description.height = height;
+        description.layers = 1;
+        description.format = AHARDWAREBUFFER_FORMAT_R8G8B8A8_UNORM;
+        description.usage = writeUsage | AHARDWAREBUFFER_USAGE_GPU_SAMPLED_IMAGE;
+
+        if (hardwareBufferAllocate(&description, &buffer) != 0)
+        {
+            LOGE("Could not allocate a %dx%d hardware buffer.\n", width, height);
+            exit(1);
+        }
+
+        /* The allocator picks the row pitch the GPU needs. */
+        hardwareBufferDescribe(buffer, &description);
+        stride = description.stride;
+
+        const EGLint imageAttributes[] = { EGL_IMAGE_PRESERVED_KHR, EGL_TRUE, EGL_NONE };
+        image = createImage(display, EGL_NO_CONTEXT, EGL_NATIVE_BUFFER_ANDROID, getNativeClientBuffer(buffer), imageAttributes);
+        if (image == EGL_NO_IMAGE_KHR)
+        {
+            LOGE("Could not create an EGLImage from a hardware buffer: 0x%x\n", eglGetError());
+            exit(1);
+        }
+
+        /* The storage of the texture is the buffer itself, so it is immutable and has a single level. */
+        GL_CHECK(glGenTextures(1, &textureID));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, textureID));
+        GL_CHECK(imageTargetTexture2D(GL_TEXTURE_2D, (GLeglImageOES)image));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+    }
+
+    HardwareBufferTexture::~HardwareBufferTexture(void)
+    {
+        GL_CHECK(glDeleteTextures(1, &textureID));
+        destroyImage(display, image);
+        hardwareBufferRelease(buffer);
+
+        if (acquireFence >= 0)
+        {
+            close(acquireFence);
+        }
+        if (releaseFence >= 0)
+        {
+            close(releaseFence);
+        }
+    }
+
+    unsigned char *HardwareBufferTexture::lock(int *rowStride)
+    {
+        /* Our own writes are already done, the GPU just never waited for them. */
+        if (acquireFence >= 0)
+        {
+            close(acquireFence);
+            acquireFence = -1;
+        }
+
+        /* AHardwareBuffer_lock() waits for the fence and takes it over, also when it fails. */
+        void *address = NULL;
+        int fence = releaseFence;
+        releaseFence = -1;
+
+        if (hardwareBufferLock(buffer, writeUsage, fence, NULL, &address) != 0)
+        {
+            LOGE("Could not lock a hardware buffer.\n");
+            return NULL;
+        }
+
+        *rowStride = stride;
+
+        return (unsigned char *)address;
+    }
+
+    void HardwareBufferTexture::unlock(void)
+    {
+        int32_t fence = -1;
+
+        if (hardwareBufferUnlock(buffer, &fence) != 0)
+        {
+            LOGE("Could not unlock a hardware buffer.\n");
+            return;
+        }
+
+        acquireFence = fence;
+    }
+
+    void HardwareBufferTexture::acquire(void)
+    {
+        if (acquireFence < 0)
+        {
+            return;
+        }
+
+        /* The sync object takes over the file descriptor. */
+        const EGLint attributes[] = { EGL_SYNC_NATIVE_FENCE_FD_ANDROID, acquireFence, EGL_NONE };
+        EGLSyncKHR sync = createSync(display, EGL_SYNC_NATIVE_FENCE_ANDROID, attributes);
+
+        if (sync == EGL_NO_SYNC_KHR)
+        {
+            /* Native fences become readable once signalled, so wait for it on the CPU instead. */
+            LOGE("Could not import a hardware buffer fence: 0x%x\n", eglGetError());
+
+            pollfd fence = { acquireFence, POLLIN, 0 };
+            poll(&fence, 1, -1);
+            close(acquireFence);
+            acquireFence = -1;
+            return;
+        }
+
+        acquireFence = -1;
+        waitSync(display, sync, 0);
+        destroySync(display, sync);
+    }
+
+    void HardwareBufferTexture::release(void)
+    {
+        if (releaseFence >= 0)
+        {
+            close(releaseFence);
+            releaseFence = -1;
+        }
+
+        const EGLint attributes[] = { EGL_SYNC_NATIVE_FENCE_FD_ANDROID, EGL_NO_NATIVE_FENCE_FD_ANDROID, EGL_NONE };
+        EGLSyncKHR sync = createSync(display, EGL_SYNC_NATIVE_FENCE_ANDROID, attributes);
+
+        if (sync == EGL_NO_SYNC_KHR)
+        {
+            /* Without a fence, wait for the draws here so the next lock() cannot overwrite texels they read. */
+            LOGE("Could not create a hardware buffer fence: 0x%x\n", eglGetError());
+            GL_CHECK(glFinish());
+            return;
+        }
+
+        /* The fence only gets a file descriptor once it has been flushed. */
+        GL_CHECK(glFlush());
+        releaseFence = dupNativeFenceFD(display, sync);
+        destroySync(display, sync);
+
+        if (releaseFence == EGL_NO_NATIVE_FENCE_FD_ANDROID)
+        {
+            LOGE("Could not get a hardware buffer fence: 0x%x\n", eglGetError());
+            GL_CHECK(glFinish());
+        }
+    }
+
+    GLuint HardwareBufferTexture::getTexture(void) const
+    {
+        return textureID;
+    }
+
+    int HardwareBufferTexture::getWidth(void) const
+    {
+        return width;
+    }
+
+    int HardwareBufferTexture::getHeight(void) const
+    {
+        return height;
+    }
+}
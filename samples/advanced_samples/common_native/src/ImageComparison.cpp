@@ -0,0 +1,292 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ImageComparison.h"
+#include "Platform.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* Delta between black and white, which the differences are relative to. */
+    static const float maximumDelta = 35215.0f;
+
+    static float brightness(const unsigned char *pixel)
+    {
+        return pixel[0] * 0.29889531f + pixel[1] * 0.58662247f + pixel[2] * 0.11448223f;
+    }
+
+    /* Perceived difference of two colours in YIQ, negative if the first one is the brighter. */
+    static float colourDelta(const unsigned char *first, const unsigned char *second)
+    {
+        float red = (float)first[0] - second[0];
+        float green = (float)first[1] - second[1];
+        float blue = (float)first[2] - second[2];
+
+        float y = red * 0.29889531f + green * 0.58662247f + blue * 0.11448223f;
+        float i = red * 0.59597799f - green * 0.27417610f - blue * 0.32180189f;
+        float q = red * 0.21147017f - green * 0.52261711f + blue * 0.31114694f;
+        float delta = 0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q;
+
+        return y > 0.0f ? -delta : delta;
+    }
+
+    /* Whether the pixel has at least 3 neighbours of the same colour, pixels outside the image counting as one. */
+    static bool hasManySiblings(const unsigned char *image, int x, int y, int width, int height)
+    {
+        const unsigned char *pixel = image + (y * width + x) * 3;
+        int equal = (x == 0 || y == 0 || x == width - 1 || y == height - 1) ? 1 : 0;
+
+        for (int neighbourY = (y > 0 ? y - 1 : 0); neighbourY <= (y < height - 1 ? y + 1 : y); neighbourY++)
+        {
+            for (int neighbourX = (x > 0 ? x - 1 : 0); neighbourX <= (x < width - 1 ? x + 1 : x); neighbourX++)
+            {
+                if ((neighbourX != x || neighbourY != y) && memcmp(pixel, image + (neighbourY * width + neighbourX) * 3, 3) == 0)
+                {
+                    if (++equal > 2)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /*
+     * Whether the pixel of the image is on an anti-aliased edge: between a darker and a brighter neighbour, with at
+     * most 2 neighbours of its own colour, and one of the two in a flat area of both images.
+     */
+    static bool isAntialiased(const unsigned char *image, const unsigned char *other, int x, int y, int width, int height)
+    {
+        const unsigned char *pixel = image + (y * width + x) * 3;
+        int equal = (x == 0 || y == 0 || x == width - 1 || y == height - 1) ? 1 : 0;
+        float darkest = 0.0f;
+        float brightest = 0.0f;
+        int darkestX = 0;
+        int darkestY = 0;
+        int brightestX = 0;
+        int brightestY = 0;
+
+        for (int neighbourY = (y > 0 ? y - 1 : 0); neighbourY <= (y < height - 1 ? y + 1 : y); neighbourY++)
+        {
+            for (int neighbourX = (x > 0 ? x - 1 : 0); neighbourX <= (x < width - 1 ? x + 1 : x); neighbourX++)
+            {
+                if (neighbourX == x && neighbourY == y)
+                {
+                    continue;
+                }
+
+                float delta = brightness(pixel) - brightness(image + (neighbourY * width + neighbourX) * 3);
+                if (delta == 0.0f)
+                {
+                    if (++equal > 2)
+                    {
+                        return false;
+                    }
+                }
+                else if (delta < darkest)
+                {
+                    darkest = delta;
+                    darkestX = neighbourX;
+                    darkestY = neighbourY;
+                }
+                else if (delta > brightest)
+                {
+                    brightest = delta;
+                    brightestX = neighbourX;
+                    brightestY = neighbourY;
+                }
+            }
+        }
+
+        if (darkest == 0.0f || brightest == 0.0f)
+        {
+            return false;
+        }
+
+        return (hasManySiblings(image, darkestX, darkestY, width, height) && hasManySiblings(other, darkestX, darkestY, width, height)) ||
+               (hasManySiblings(image, brightestX, brightestY, width, height) && hasManySiblings(other, brightestX, brightestY, width, height));
+    }
+
+    ImageComparison::Result ImageComparison::compare(const unsigned char *image, const unsigned char *reference, int width, int height,
+                                                     float threshold, std::vector<unsigned char> *difference)
+    {
+        Result result;
+        result.differentPixels = 0;
+        result.antialiasedPixels = 0;
+        result.maximumDifference = 0.0f;
+
+        float thresholdDelta = maximumDelta * threshold * threshold;
+        float largestDelta = 0.0f;
+
+        if (difference != NULL)
+        {
+            difference->resize(width * height * 3);
+        }
+
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                int offset = (y * width + x) * 3;
+                float delta = fabsf(colourDelta(image + offset, reference + offset));
+                unsigned char red = 0;
+                unsigned char green = 0;
+                unsigned char blue = 0;
+
+                if (delta > largestDelta)
+                {
+                    largestDelta = delta;
+                }
+
+                if (delta > thresholdDelta)
+                {
+                    if (isAntialiased(image, reference, x, y, width, height) || isAntialiased(reference, image, x, y, width, height))
+                    {
+                        result.antialiasedPixels++;
+                        red = 255;
+                        green = 255;
+                    }
+                    else
+                    {
+                        result.differentPixels++;
+                        red = 255;
+                    }
+                }
+                else
+                {
+                    /* Same pixels faded to a light grey, so the differences stand out. */
+                    red = green = blue = (unsigned char)(255.0f - (255.0f - brightness(reference + offset)) * 0.1f);
+                }
+
+                if (difference != NULL)
+                {
+                    (*difference)[offset] = red;
+                    (*difference)[offset + 1] = green;
+                    (*difference)[offset + 2] = blue;
+                }
+            }
+        }
+
+        result.maximumDifference = sqrtf(largestDelta / maximumDelta);
+        return result;
+    }
+
+    void ImageComparison::convertFramebuffer(const unsigned char *pixels, int width, int height, std::vector<unsigned char> &image)
+    {
+        image.resize(width * height * 3);
+
+        for (int y = 0; y < height; y++)
+        {
+            const unsigned char *source = pixels + (height - 1 - y) * width * 4;
+            unsigned char *destination = &image[y * width * 3];
+
+            for (int x = 0; x < width; x++, source += 4, destination += 3)
+            {
+                destination[0] = source[0];
+                destination[1] = source[1];
+                destination[2] = source[2];
+            }
+        }
+    }
+
+    /* Skips whitespace and comments, then reads the next number of a PPM header. */
+    static bool readHeaderValue(FILE *file, int *value)
+    {
+        int character = fgetc(file);
+        while (character == '#' || character == ' ' || character == '\t' || character == '\r' || character == '\n')
+        {
+            if (character == '#')
+            {
+                while (character != '\n' && character != EOF)
+                {
+                    character = fgetc(file);
+                }
+            }
+            character = fgetc(file);
+        }
+
+        if (character < '0' || character > '9')
+        {
+            return false;
+        }
+
+        *value = 0;
+        while (character >= '0' && character <= '9')
+        {
+            *value = *value * 10 + (character - '0');
+            character = fgetc(file);
+        }
+
+        /* A single whitespace character ends the header, the pixels start right after it. */
+        return character == ' ' || character == '\t' || character == '\r' || character == '\n';
+    }
+
+    bool ImageComparison::loadPPM(const char *filename, std::vector<unsigned char> &image, int *width, int *height)
+    {
+        FILE *file = fopen(filename, "rb");
+        if (file == NULL)
+        {
+            return false;
+        }
+
+        char magic[2] = { 0, 0 };
+        int maximumValue = 0;
+        bool loaded = fread(magic, 1, 2, file) == 2 && magic[0] == 'P' && magic[1] == '6' &&
+                      readHeaderValue(file, width) && readHeaderValue(file, height) && readHeaderValue(file, &maximumValue) &&
+                      *width > 0 && *height > 0 && maximumValue == 255;
+
+        if (loaded)
+        {
+            image.resize((size_t)*width * *height * 3);
+            loaded = fread(&image[0], 1, image.size(), file) == image.size();
+        }
+
+        if (!loaded)
+        {
+            LOGE("%s is not an 8 bit binary PPM file.\n", filename);
+        }
+
+        fclose(file);
+        return loaded;
+    }
+
+    bool ImageComparison::savePPM(const char *filename, const unsigned char *image, int width, int height)
+    {
+        FILE *file = fopen(filename, "wb");
+        if (file == NULL)
+        {
+            LOGE("Cannot write the image to '%s'.\n", filename);
+            return false;
+        }
+
+        fprintf(file, "P6\n%d %d\n255\n", width, height);
+        fwrite(image, 1, (size_t)width * height * 3, file);
+
+        bool written = !ferror(file);
+        fclose(file);
+
+        return written;
+    }
+}
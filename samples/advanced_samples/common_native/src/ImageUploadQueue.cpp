@@ -0,0 +1,115 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ImageUploadQueue.h"
+#include "Platform.h"
+
+namespace MaliSDK
+{
+    ImageUploadQueue::ImageUploadQueue(JobScheduler *scheduler)
+        : scheduler(scheduler)
+    {
+    }
+
+    ImageUploadQueue::~ImageUploadQueue(void)
+    {
+        finish();
+    }
+
+    void ImageUploadQueue::decodeJob(void *upload)
+    {
+        Upload *image = (Upload *)upload;
+
+        image->decoded = image->decode(image->destination, image->size, image->userData);
+    }
+
+    void ImageUploadQueue::add(size_t size, DecodeFunction decode, UploadFunction upload, void *userData)
+    {
+        Upload *image = new Upload;
+
+        image->size = size;
+        image->decode = decode;
+        image->upload = upload;
+        image->userData = userData;
+        image->decoded = false;
+
+        GL_CHECK(glGenBuffers(1, &image->buffer));
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, image->buffer));
+        GL_CHECK(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW));
+        image->destination = GL_CHECK(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+        if (image->destination == NULL)
+        {
+            /* Still decoded on a worker, but uploaded from memory. */
+            LOGE("ImageUploadQueue: cannot map a pixel unpack buffer of %u bytes, decoding to memory.\n", (unsigned int)size);
+            GL_CHECK(glDeleteBuffers(1, &image->buffer));
+            image->buffer = 0;
+            image->fallback.resize(size);
+            image->destination = &image->fallback[0];
+        }
+
+        image->job = scheduler->create("ImageUploadQueue decode", decodeJob, image);
+        scheduler->submit(image->job);
+        uploads.push_back(image);
+    }
+
+    void ImageUploadQueue::finish(void)
+    {
+        if (uploads.empty())
+        {
+            return;
+        }
+
+        for (size_t uploadIndex = 0; uploadIndex < uploads.size(); uploadIndex++)
+        {
+            Upload *image = uploads[uploadIndex];
+
+            scheduler->wait(image->job);
+
+            if (image->buffer != 0)
+            {
+                GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, image->buffer));
+
+                /* The contents are undefined if the unmap fails, typically after the context lost its memory. */
+                GLboolean unmapped = GL_CHECK(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+                if (!unmapped)
+                {
+                    LOGE("ImageUploadQueue: the buffer of an image was corrupted, skipping it.\n");
+                    image->decoded = false;
+                }
+
+                image->upload(NULL, image->decoded, image->userData);
+
+                GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+                GL_CHECK(glDeleteBuffers(1, &image->buffer));
+            }
+            else
+            {
+                image->upload(image->destination, image->decoded, image->userData);
+            }
+
+            delete image;
+        }
+
+        uploads.clear();
+    }
+}
@@ -0,0 +1,423 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "JobScheduler.h"
+#include "Platform.h"
+#include "Profiler.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+
+namespace MaliSDK
+{
+    /* The scheduler and queue of the worker running on the calling thread, if any. */
+    static __thread JobScheduler *currentScheduler = NULL;
+    static __thread unsigned int currentQueueIndex = 0;
+
+    /* A job of parallelFor(), one range of indices. */
+    struct RangeJob
+    {
+        JobScheduler::RangeFunction function;
+        void *userData;
+        unsigned int begin;
+        unsigned int end;
+    };
+
+    static void runRange(void *rangeJob)
+    {
+        RangeJob *range = (RangeJob *)rangeJob;
+        range->function(range->begin, range->end, range->userData);
+    }
+
+    JobScheduler::JobScheduler(void)
+        : queuedJobs(0),
+          stopping(false)
+    {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&changed, NULL);
+
+        /* Only the shared queue, run by the threads waiting for jobs. */
+        queues.push_back(new Queue);
+        pthread_mutex_init(&queues.back()->mutex, NULL);
+    }
+
+    JobScheduler::~JobScheduler(void)
+    {
+        terminate();
+
+        pthread_mutex_destroy(&queues.back()->mutex);
+        delete queues.back();
+        pthread_cond_destroy(&changed);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    unsigned int JobScheduler::getNumberOfBigCores(void)
+    {
+        long numberOfCores = sysconf(_SC_NPROCESSORS_CONF);
+        if (numberOfCores < 1)
+        {
+            return 1;
+        }
+
+        std::vector<long> maximumFrequencies;
+        for (long core = 0; core < numberOfCores; core++)
+        {
+            char path[128];
+            sprintf(path, "/sys/devices/system/cpu/cpu%ld/cpufreq/cpuinfo_max_freq", core);
+
+            FILE *file = fopen(path, "r");
+            long frequency = 0;
+            bool read = file != NULL && fscanf(file, "%ld", &frequency) == 1;
+            if (file != NULL)
+            {
+                fclose(file);
+            }
+
+            /* Without frequencies, or with a core offline, all cores are taken to be the same. */
+            if (!read)
+            {
+                return (unsigned int)numberOfCores;
+            }
+            maximumFrequencies.push_back(frequency);
+        }
+
+        long lowest = maximumFrequencies[0];
+        for (size_t core = 1; core < maximumFrequencies.size(); core++)
+        {
+            lowest = maximumFrequencies[core] < lowest ? maximumFrequencies[core] : lowest;
+        }
+
+        unsigned int numberOfBigCores = 0;
+        for (size_t core = 0; core < maximumFrequencies.size(); core++)
+        {
+            if (maximumFrequencies[core] > lowest)
+            {
+                numberOfBigCores++;
+            }
+        }
+
+        return numberOfBigCores > 0 ? numberOfBigCores : (unsigned int)numberOfCores;
+    }
+
+    unsigned int JobScheduler::initialize(unsigned int numberOfWorkers)
+    {
+        terminate();
+
+        if (numberOfWorkers == 0)
+        {
+            unsigned int numberOfBigCores = getNumberOfBigCores();
+            numberOfWorkers = numberOfBigCores > 1 ? numberOfBigCores - 1 : 0;
+        }
+
+        /* Worker queues go in front of the shared one. */
+        Queue *sharedQueue = queues.back();
+        queues.pop_back();
+        for (unsigned int workerIndex = 0; workerIndex < numberOfWorkers; workerIndex++)
+        {
+            queues.push_back(new Queue);
+            pthread_mutex_init(&queues.back()->mutex, NULL);
+        }
+        queues.push_back(sharedQueue);
+
+        workers.resize(numberOfWorkers);
+        for (unsigned int workerIndex = 0; workerIndex < numberOfWorkers; workerIndex++)
+        {
+            Worker &worker = workers[workerIndex];
+            worker.scheduler = this;
+            worker.index = workerIndex;
+            if (pthread_create(&worker.thread, NULL, &workerFunction, &worker) != 0)
+            {
+                /* Run with what we have, waiting threads can always run all the jobs themselves. */
+                LOGI("JobScheduler: started %u of %u worker threads.\n", workerIndex, numberOfWorkers);
+                workers.resize(workerIndex);
+                break;
+            }
+        }
+
+        return (unsigned int)workers.size();
+    }
+
+    void JobScheduler::terminate(void)
+    {
+        pthread_mutex_lock(&mutex);
+        stopping = true;
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&mutex);
+
+        for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++)
+        {
+            pthread_join(workers[workerIndex].thread, NULL);
+        }
+        workers.clear();
+
+        /* The queues of workers which could not be started, they are empty. */
+        while (queues.size() > 1)
+        {
+            pthread_mutex_destroy(&queues.front()->mutex);
+            delete queues.front();
+            queues.erase(queues.begin());
+        }
+
+        stopping = false;
+    }
+
+    unsigned int JobScheduler::getNumberOfWorkers(void) const
+    {
+        return (unsigned int)workers.size();
+    }
+
+    unsigned int JobScheduler::getQueueIndex(void) const
+    {
+        if (currentScheduler == this)
+        {
+            return currentQueueIndex;
+        }
+
+        return (unsigned int)queues.size() - 1;
+    }
+
+    void JobScheduler::enqueue(Job *job)
+    {
+        Queue *queue = queues[getQueueIndex()];
+
+        pthread_mutex_lock(&queue->mutex);
+        queue->jobs.push_back(job);
+        pthread_mutex_unlock(&queue->mutex);
+
+        /* Counted under the mutex, so a thread about to sleep cannot miss it. */
+        pthread_mutex_lock(&mutex);
+        queuedJobs++;
+        pthread_cond_signal(&changed);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    JobScheduler::Job *JobScheduler::findJob(unsigned int queueIndex)
+    {
+        if (queuedJobs.load() <= 0)
+        {
+            return NULL;
+        }
+
+        /* The newest job of our own queue, its data is the most likely to be in the cache. */
+        Queue *queue = queues[queueIndex];
+        Job *job = NULL;
+
+        pthread_mutex_lock(&queue->mutex);
+        if (!queue->jobs.empty())
+        {
+            job = queue->jobs.back();
+            queue->jobs.pop_back();
+        }
+        pthread_mutex_unlock(&queue->mutex);
+
+        /* Otherwise the oldest job of another queue, which is the least likely to be touched by its owner soon. */
+        for (size_t offset = 1; job == NULL && offset < queues.size(); offset++)
+        {
+            queue = queues[(queueIndex + offset) % queues.size()];
+
+            pthread_mutex_lock(&queue->mutex);
+            if (!queue->jobs.empty())
+            {
+                job = queue->jobs.front();
+                queue->jobs.pop_front();
+            }
+            pthread_mutex_unlock(&queue->mutex);
+        }
+
+        if (job != NULL)
+        {
+            queuedJobs--;
+        }
+
+        return job;
+    }
+
+    void JobScheduler::run(Job *job)
+    {
+        Profiler::beginTraceSection(job->name);
+        job->function(job->userData);
+        Profiler::endTraceSection();
+
+        std::vector<Job *> readyJobs;
+
+        pthread_mutex_lock(&mutex);
+        job->finished = true;
+        for (size_t dependentIndex = 0; dependentIndex < job->dependents.size(); dependentIndex++)
+        {
+            if (job->dependents[dependentIndex]->blockers.fetch_sub(1) == 1)
+            {
+                readyJobs.push_back(job->dependents[dependentIndex]);
+            }
+        }
+        job->dependents.clear();
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&mutex);
+
+        for (size_t readyIndex = 0; readyIndex < readyJobs.size(); readyIndex++)
+        {
+            enqueue(readyJobs[readyIndex]);
+        }
+    }
+
+    void *JobScheduler::workerFunction(void *worker)
+    {
+        Worker *self = (Worker *)worker;
+        JobScheduler *scheduler = self->scheduler;
+
+        currentScheduler = scheduler;
+        currentQueueIndex = self->index;
+
+        for (;;)
+        {
+            Job *job = scheduler->findJob(self->index);
+            if (job != NULL)
+            {
+                scheduler->run(job);
+                continue;
+            }
+
+            pthread_mutex_lock(&scheduler->mutex);
+            while (!scheduler->stopping && scheduler->queuedJobs.load() <= 0)
+            {
+                pthread_cond_wait(&scheduler->changed, &scheduler->mutex);
+            }
+            bool stop = scheduler->stopping && scheduler->queuedJobs.load() <= 0;
+            pthread_mutex_unlock(&scheduler->mutex);
+
+            if (stop)
+            {
+                break;
+            }
+        }
+
+        currentScheduler = NULL;
+
+        return NULL;
+    }
+
+    JobScheduler::Job *JobScheduler::create(const char *name, JobFunction function, void *userData)
+    {
+        Job *job = new Job;
+
+        job->name = name;
+        job->function = function;
+        job->userData = userData;
+        job->blockers.store(1);
+        job->finished = false;
+
+        return job;
+    }
+
+    void JobScheduler::addDependency(Job *job, Job *dependency)
+    {
+        pthread_mutex_lock(&mutex);
+        if (!dependency->finished)
+        {
+            dependency->dependents.push_back(job);
+            job->blockers++;
+        }
+        pthread_mutex_unlock(&mutex);
+    }
+
+    void JobScheduler::submit(Job *job)
+    {
+        if (job->blockers.fetch_sub(1) == 1)
+        {
+            enqueue(job);
+        }
+    }
+
+    void JobScheduler::wait(Job *job)
+    {
+        unsigned int queueIndex = getQueueIndex();
+
+        for (;;)
+        {
+            pthread_mutex_lock(&mutex);
+            bool finished = job->finished;
+            pthread_mutex_unlock(&mutex);
+            if (finished)
+            {
+                break;
+            }
+
+            /* Help out instead of idling. */
+            Job *otherJob = findJob(queueIndex);
+            if (otherJob != NULL)
+            {
+                run(otherJob);
+                continue;
+            }
+
+            /* Nothing to run: the job or its dependencies are running on other threads. */
+            pthread_mutex_lock(&mutex);
+            while (!job->finished && queuedJobs.load() <= 0)
+            {
+                pthread_cond_wait(&changed, &mutex);
+            }
+            pthread_mutex_unlock(&mutex);
+        }
+
+        delete job;
+    }
+
+    void JobScheduler::parallelFor(const char *name, unsigned int count, unsigned int grainSize, RangeFunction function, void *userData)
+    {
+        if (grainSize == 0)
+        {
+            /* A few jobs per thread, so threads which get held up do not hold up the whole range. */
+            unsigned int numberOfJobs = (getNumberOfWorkers() + 1) * 4;
+            grainSize = (count + numberOfJobs - 1) / numberOfJobs;
+            grainSize = grainSize > 0 ? grainSize : 1;
+        }
+
+        /* Not worth waking anyone up. */
+        if (count <= grainSize || workers.empty())
+        {
+            if (count > 0)
+            {
+                Profiler::beginTraceSection(name);
+                function(0, count, userData);
+                Profiler::endTraceSection();
+            }
+            return;
+        }
+
+        std::vector<RangeJob> ranges((count + grainSize - 1) / grainSize);
+        std::vector<Job *> jobs(ranges.size());
+        for (size_t rangeIndex = 0; rangeIndex < ranges.size(); rangeIndex++)
+        {
+            RangeJob &range = ranges[rangeIndex];
+            range.function = function;
+            range.userData = userData;
+            range.begin = (unsigned int)rangeIndex * grainSize;
+            range.end = range.begin + grainSize < count ? range.begin + grainSize : count;
+
+            jobs[rangeIndex] = create(name, runRange, &range);
+            submit(jobs[rangeIndex]);
+        }
+
+        for (size_t rangeIndex = 0; rangeIndex < jobs.size(); rangeIndex++)
+        {
+            wait(jobs[rangeIndex]);
+        }
+    }
+}
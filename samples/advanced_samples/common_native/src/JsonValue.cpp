@@ -0,0 +1,258 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "JsonValue.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using std::string;
+
+namespace MaliSDK
+{
+    JsonValue::JsonValue(void)
+        : type(Null)
+        , boolean(false)
+        , number(0.0)
+    {
+    }
+
+    const JsonValue *JsonValue::get(const char *key) const
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if (keys[i] == key)
+            {
+                return &items[i];
+            }
+        }
+
+        return NULL;
+    }
+
+    string JsonValue::getString(const char *key) const
+    {
+        const JsonValue *value = get(key);
+
+        return value != NULL && value->type == String ? value->text : "";
+    }
+
+    double JsonValue::getNumber(const char *key) const
+    {
+        const JsonValue *value = get(key);
+
+        return value != NULL && value->type == Number ? value->number : 0.0;
+    }
+
+    static void skipSpace(const char **cursor)
+    {
+        while (**cursor == ' ' || **cursor == '\t' || **cursor == '\n' || **cursor == '\r')
+        {
+            (*cursor)++;
+        }
+    }
+
+    static bool parseString(const char **cursor, string &text)
+    {
+        const char *c = *cursor;
+
+        if (*c++ != '"')
+        {
+            return false;
+        }
+
+        text.clear();
+        while (*c != '"')
+        {
+            if (*c == '\0')
+            {
+                return false;
+            }
+
+            if (*c != '\\')
+            {
+                text += *c++;
+                continue;
+            }
+
+            c++;
+            switch (*c)
+            {
+                case 'b':
+                    text += '\b';
+                    break;
+                case 'f':
+                    text += '\f';
+                    break;
+                case 'n':
+                    text += '\n';
+                    break;
+                case 'r':
+                    text += '\r';
+                    break;
+                case 't':
+                    text += '\t';
+                    break;
+                case 'u':
+                {
+                    /* The reports only escape control characters, anything beyond ASCII is replaced. */
+                    char digits[5] = { 0, 0, 0, 0, 0 };
+                    for (int digit = 0; digit < 4; digit++)
+                    {
+                        if (c[1 + digit] == '\0')
+                        {
+                            return false;
+                        }
+                        digits[digit] = c[1 + digit];
+                    }
+
+                    long code = strtol(digits, NULL, 16);
+                    text += code < 0x80 ? (char)code : '?';
+                    c += 4;
+                    break;
+                }
+                case '\0':
+                    return false;
+                default:
+                    text += *c;
+                    break;
+            }
+            c++;
+        }
+
+        *cursor = c + 1;
+
+        return true;
+    }
+
+    static bool parseValue(const char **cursor, JsonValue &value, int depth)
+    {
+        /* Reports are only a few levels deep, this only guards against corrupt files. */
+        if (depth > 16)
+        {
+            return false;
+        }
+
+        skipSpace(cursor);
+        const char *c = *cursor;
+
+        if (*c == '{' || *c == '[')
+        {
+            bool object = (*c == '{');
+            char close = object ? '}' : ']';
+
+            value.type = object ? JsonValue::Object : JsonValue::Array;
+            *cursor = c + 1;
+            skipSpace(cursor);
+
+            if (**cursor == close)
+            {
+                (*cursor)++;
+                return true;
+            }
+
+            while (true)
+            {
+                if (object)
+                {
+                    string key;
+
+                    skipSpace(cursor);
+                    if (!parseString(cursor, key))
+                    {
+                        return false;
+                    }
+
+                    skipSpace(cursor);
+                    if (**cursor != ':')
+                    {
+                        return false;
+                    }
+                    (*cursor)++;
+                    value.keys.push_back(key);
+                }
+
+                value.items.push_back(JsonValue());
+                if (!parseValue(cursor, value.items.back(), depth + 1))
+                {
+                    return false;
+                }
+
+                skipSpace(cursor);
+                if (**cursor == ',')
+                {
+                    (*cursor)++;
+                }
+                else if (**cursor == close)
+                {
+                    (*cursor)++;
+                    return true;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+        }
+
+        if (*c == '"')
+        {
+            value.type = JsonValue::String;
+            return parseString(cursor, value.text);
+        }
+
+        if (strncmp(c, "true", 4) == 0 || strncmp(c, "false", 5) == 0)
+        {
+            value.type = JsonValue::Boolean;
+            value.boolean = (*c == 't');
+            *cursor = c + (value.boolean ? 4 : 5);
+            return true;
+        }
+
+        if (strncmp(c, "null", 4) == 0)
+        {
+            value.type = JsonValue::Null;
+            *cursor = c + 4;
+            return true;
+        }
+
+        char *numberEnd = NULL;
+        value.type = JsonValue::Number;
+        value.number = strtod(c, &numberEnd);
+        *cursor = numberEnd;
+
+        return numberEnd != c;
+    }
+
+    bool JsonValue::parse(const char *text, JsonValue &value)
+    {
+        const char *cursor = text;
+
+        value = JsonValue();
+        if (!parseValue(&cursor, value, 0))
+        {
+            return false;
+        }
+
+        skipSpace(&cursor);
+
+        return *cursor == '\0';
+    }
+}
@@ -0,0 +1,487 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "KTXLoader.h"
+#include "AssetFile.h"
+#include "GPUMemory.h"
+#include "Platform.h"
+#include "StartupProfiler.h"
+#include "Texture.h"
+#include "Timer.h"
+
+#include <cstring>
+
+namespace MaliSDK
+{
+    static const unsigned char ktx1Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    static const unsigned char ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    /* Both headers are followed by fixed size fields, KTX 2.0 then has a level index of 3 64-bit values per level. */
+    static const size_t ktx1HeaderSize = 64;
+    static const size_t ktx2HeaderSize = 80;
+    static const size_t ktx2LevelIndexEntrySize = 24;
+
+    static const unsigned int ktx1Endianness = 0x04030201;
+    static const unsigned int ktx1SwappedEndianness = 0x01020304;
+
+    /* The GL_TEXTURE_2D_ARRAY token, for OpenGL ES 2.0 builds which cannot create array textures anyway. */
+    static const GLenum texture2DArray = 0x8C1A;
+
+    /**
+     * \brief A Vulkan format used by KTX 2.0 and the OpenGL ES format holding the same blocks.
+     */
+    struct FormatMapping
+    {
+        unsigned int vkFormat;
+        GLenum glInternalFormat;
+        int blockWidth;
+        int blockHeight;
+        int bytesPerBlock;
+    };
+
+    /* VK_FORMAT_ETC2_*, VK_FORMAT_EAC_* and VK_FORMAT_ASTC_*, UNORM followed by SRGB (or SNORM for EAC). */
+    static const FormatMapping formatMappings[] =
+    {
+        { 147, 0x9274, 4, 4, 8 },   /* GL_COMPRESSED_RGB8_ETC2 */
+        { 148, 0x9275, 4, 4, 8 },   /* GL_COMPRESSED_SRGB8_ETC2 */
+        { 149, 0x9276, 4, 4, 8 },   /* GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 */
+        { 150, 0x9277, 4, 4, 8 },   /* GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2 */
+        { 151, 0x9278, 4, 4, 16 },  /* GL_COMPRESSED_RGBA8_ETC2_EAC */
+        { 152, 0x9279, 4, 4, 16 },  /* GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC */
+        { 153, 0x9270, 4, 4, 8 },   /* GL_COMPRESSED_R11_EAC */
+        { 154, 0x9271, 4, 4, 8 },   /* GL_COMPRESSED_SIGNED_R11_EAC */
+        { 155, 0x9272, 4, 4, 16 },  /* GL_COMPRESSED_RG11_EAC */
+        { 156, 0x9273, 4, 4, 16 },  /* GL_COMPRESSED_SIGNED_RG11_EAC */
+        { 157, 0x93B0, 4, 4, 16 },  /* GL_COMPRESSED_RGBA_ASTC_4x4_KHR */
+        { 158, 0x93D0, 4, 4, 16 },  /* GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR */
+        { 159, 0x93B1, 5, 4, 16 },
+        { 160, 0x93D1, 5, 4, 16 },
+        { 161, 0x93B2, 5, 5, 16 },
+        { 162, 0x93D2, 5, 5, 16 },
+        { 163, 0x93B3, 6, 5, 16 },
+        { 164, 0x93D3, 6, 5, 16 },
+        { 165, 0x93B4, 6, 6, 16 },
+        { 166, 0x93D4, 6, 6, 16 },
+        { 167, 0x93B5, 8, 5, 16 },
+        { 168, 0x93D5, 8, 5, 16 },
+        { 169, 0x93B6, 8, 6, 16 },
+        { 170, 0x93D6, 8, 6, 16 },
+        { 171, 0x93B7, 8, 8, 16 },
+        { 172, 0x93D7, 8, 8, 16 },
+        { 173, 0x93B8, 10, 5, 16 },
+        { 174, 0x93D8, 10, 5, 16 },
+        { 175, 0x93B9, 10, 6, 16 },
+        { 176, 0x93D9, 10, 6, 16 },
+        { 177, 0x93BA, 10, 8, 16 },
+        { 178, 0x93DA, 10, 8, 16 },
+        { 179, 0x93BB, 10, 10, 16 },
+        { 180, 0x93DB, 10, 10, 16 },
+        { 181, 0x93BC, 12, 10, 16 },
+        { 182, 0x93DC, 12, 10, 16 },
+        { 183, 0x93BD, 12, 12, 16 },
+        { 184, 0x93DD, 12, 12, 16 },
+    };
+
+    static unsigned int readUInt32(const unsigned char *data, bool swap)
+    {
+        unsigned int value;
+
+        memcpy(&value, data, sizeof(value));
+
+        if (swap)
+        {
+            value = (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+        }
+
+        return value;
+    }
+
+    /* KTX 2.0 is always little endian, as are all the targets of the SDK. */
+    static unsigned long long readUInt64(const unsigned char *data)
+    {
+        unsigned long long value;
+
+        memcpy(&value, data, sizeof(value));
+
+        return value;
+    }
+
+    static size_t alignTo4(size_t offset)
+    {
+        return (offset + 3) & ~(size_t)3;
+    }
+
+    static bool selectTarget(KTXTextureInfo *info)
+    {
+        if (info->numberOfLayers > 0)
+        {
+#if GLES_VERSION == 3
+            if (info->numberOfFaces != 1)
+            {
+                LOGE("KTXLoader: cube map arrays are not supported.\n");
+                return false;
+            }
+
+            info->target = GL_TEXTURE_2D_ARRAY;
+            return true;
+#else
+            LOGE("KTXLoader: array textures need OpenGL ES 3.0.\n");
+            return false;
+#endif
+        }
+
+        if (info->numberOfFaces == 6)
+        {
+            info->target = GL_TEXTURE_CUBE_MAP;
+            return true;
+        }
+
+        if (info->numberOfFaces != 1)
+        {
+            LOGE("KTXLoader: %d faces is neither a 2D texture nor a cube map.\n", info->numberOfFaces);
+            return false;
+        }
+
+        info->target = GL_TEXTURE_2D;
+        return true;
+    }
+
+    bool KTXLoader::uploadLevel(const KTXTextureInfo *info, int level, int face, int width, int height,
+                                GLenum format, GLenum type, size_t imageSize, const unsigned char *data)
+    {
+        GLenum imageTarget = (info->target == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : info->target;
+        bool compressed = (type == 0);
+
+        /* Not GL_CHECK: an unsupported format is reported to the caller rather than being fatal. */
+        if (info->target == texture2DArray)
+        {
+#if GLES_VERSION == 3
+            if (compressed)
+            {
+                glCompressedTexImage3D(imageTarget, level, info->internalFormat, width, height, info->numberOfLayers, 0, (GLsizei)imageSize, data);
+            }
+            else
+            {
+                glTexImage3D(imageTarget, level, info->internalFormat, width, height, info->numberOfLayers, 0, format, type, data);
+            }
+#endif
+        }
+        else if (compressed)
+        {
+            glCompressedTexImage2D(imageTarget, level, info->internalFormat, width, height, 0, (GLsizei)imageSize, data);
+        }
+        else
+        {
+#if GLES_VERSION == 2
+            /* OpenGL ES 2.0 has no sized internal formats, the internal format must match the format. */
+            glTexImage2D(imageTarget, level, format, width, height, 0, format, type, data);
+#else
+            glTexImage2D(imageTarget, level, info->internalFormat, width, height, 0, format, type, data);
+#endif
+        }
+
+        GLenum error = glGetError();
+
+        if (error != GL_NO_ERROR)
+        {
+            LOGE("KTXLoader: the driver rejected level %d of format 0x%.4x (error 0x%.4x).\n", level, info->internalFormat, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool KTXLoader::loadKTX1(const unsigned char *data, size_t size, GLuint texture, KTXTextureInfo *info)
+    {
+        if (size < ktx1HeaderSize)
+        {
+            return false;
+        }
+
+        unsigned int endianness = readUInt32(data + 12, false);
+        bool swap = (endianness == ktx1SwappedEndianness);
+
+        if (endianness != ktx1Endianness && !swap)
+        {
+            LOGE("KTXLoader: invalid endianness 0x%.8x.\n", endianness);
+            return false;
+        }
+
+        GLenum glType = readUInt32(data + 16, swap);
+        unsigned int glTypeSize = readUInt32(data + 20, swap);
+        GLenum glFormat = readUInt32(data + 24, swap);
+        int pixelDepth = (int)readUInt32(data + 44, swap);
+        unsigned int bytesOfKeyValueData = readUInt32(data + 60, swap);
+
+        info->internalFormat = readUInt32(data + 28, swap);
+        info->width = (int)readUInt32(data + 36, swap);
+        info->height = (int)readUInt32(data + 40, swap);
+        info->numberOfLayers = (int)readUInt32(data + 48, swap);
+        info->numberOfFaces = (int)readUInt32(data + 52, swap);
+        info->numberOfLevels = (int)readUInt32(data + 56, swap);
+
+        /* 1D textures are loaded as 2D textures of height 1. */
+        if (info->height == 0)
+        {
+            info->height = 1;
+        }
+
+        if (pixelDepth > 1)
+        {
+            LOGE("KTXLoader: 3D textures are not supported.\n");
+            return false;
+        }
+
+        /* The pixel data would need swapping too, which only matters for uncompressed formats. */
+        if (swap && glType != 0 && glTypeSize > 1)
+        {
+            LOGE("KTXLoader: big endian files are only supported for compressed and 8-bit formats.\n");
+            return false;
+        }
+
+        /* 0 levels asks for the mip levels to be generated by the loader. */
+        bool generateMipmaps = (info->numberOfLevels == 0);
+
+        if (generateMipmaps)
+        {
+            if (glType == 0)
+            {
+                LOGE("KTXLoader: mip levels cannot be generated for compressed formats.\n");
+                return false;
+            }
+
+            info->numberOfLevels = 1;
+        }
+
+        if (!selectTarget(info))
+        {
+            return false;
+        }
+
+        GL_CHECK(glBindTexture(info->target, texture));
+
+        size_t offset = ktx1HeaderSize + bytesOfKeyValueData;
+        /* Every face of a cube map has its own image, array textures and arrays of faces share one per level. */
+        bool imagePerFace = (info->target == GL_TEXTURE_CUBE_MAP);
+
+        for (int level = 0; level < info->numberOfLevels; level++)
+        {
+            if (offset + 4 > size)
+            {
+                return false;
+            }
+
+            size_t imageSize = readUInt32(data + offset, swap);
+            int levelWidth = Texture::getLevelSize(info->width, level);
+            int levelHeight = Texture::getLevelSize(info->height, level);
+            int numberOfImages = imagePerFace ? info->numberOfFaces : 1;
+
+            offset += 4;
+
+            for (int face = 0; face < numberOfImages; face++)
+            {
+                if (offset + imageSize > size)
+                {
+                    LOGE("KTXLoader: file is truncated at level %d.\n", level);
+                    return false;
+                }
+
+                if (!uploadLevel(info, level, face, levelWidth, levelHeight, glFormat, glType, imageSize, data + offset))
+                {
+                    return false;
+                }
+
+                info->dataSize += imageSize;
+                offset = alignTo4(offset + imageSize);
+            }
+        }
+
+        if (generateMipmaps)
+        {
+            GL_CHECK(glGenerateMipmap(info->target));
+        }
+
+        return true;
+    }
+
+    bool KTXLoader::loadKTX2(const unsigned char *data, size_t size, GLuint texture, KTXTextureInfo *info)
+    {
+        if (size < ktx2HeaderSize)
+        {
+            return false;
+        }
+
+        unsigned int vkFormat = readUInt32(data + 12, false);
+        int pixelDepth = (int)readUInt32(data + 28, false);
+        unsigned int supercompressionScheme = readUInt32(data + 44, false);
+        const FormatMapping *mapping = NULL;
+
+        info->width = (int)readUInt32(data + 20, false);
+        info->height = (int)readUInt32(data + 24, false);
+        info->numberOfLayers = (int)readUInt32(data + 32, false);
+        info->numberOfFaces = (int)readUInt32(data + 36, false);
+        info->numberOfLevels = (int)readUInt32(data + 40, false);
+
+        for (size_t mappingIndex = 0; mappingIndex < sizeof(formatMappings) / sizeof(formatMappings[0]); mappingIndex++)
+        {
+            if (formatMappings[mappingIndex].vkFormat == vkFormat)
+            {
+                mapping = &formatMappings[mappingIndex];
+            }
+        }
+
+        if (mapping == NULL)
+        {
+            LOGE("KTXLoader: VkFormat %u is not an ETC2, EAC or ASTC format.\n", vkFormat);
+            return false;
+        }
+
+        if (supercompressionScheme != 0)
+        {
+            LOGE("KTXLoader: supercompression scheme %u is not supported.\n", supercompressionScheme);
+            return false;
+        }
+
+        if (pixelDepth > 1)
+        {
+            LOGE("KTXLoader: 3D textures are not supported.\n");
+            return false;
+        }
+
+        if (info->height == 0)
+        {
+            info->height = 1;
+        }
+
+        /* Block compressed data has no way of generating levels, 0 just means a single level. */
+        if (info->numberOfLevels == 0)
+        {
+            info->numberOfLevels = 1;
+        }
+
+        info->internalFormat = mapping->glInternalFormat;
+
+        if (!selectTarget(info) || ktx2HeaderSize + info->numberOfLevels * ktx2LevelIndexEntrySize > size)
+        {
+            return false;
+        }
+
+        GL_CHECK(glBindTexture(info->target, texture));
+
+        int numberOfLayers = (info->numberOfLayers > 0) ? info->numberOfLayers : 1;
+
+        for (int level = 0; level < info->numberOfLevels; level++)
+        {
+            const unsigned char *levelIndex = data + ktx2HeaderSize + level * ktx2LevelIndexEntrySize;
+            unsigned long long byteOffset = readUInt64(levelIndex);
+            unsigned long long byteLength = readUInt64(levelIndex + 8);
+            int levelWidth = Texture::getLevelSize(info->width, level);
+            int levelHeight = Texture::getLevelSize(info->height, level);
+
+            /* Images are tightly packed: layers, then faces within each layer. */
+            size_t imageSize = (size_t)((levelWidth + mapping->blockWidth - 1) / mapping->blockWidth) *
+                               ((levelHeight + mapping->blockHeight - 1) / mapping->blockHeight) * mapping->bytesPerBlock;
+            size_t levelSize = imageSize * numberOfLayers * info->numberOfFaces;
+
+            if (byteOffset + byteLength > size || byteLength < levelSize)
+            {
+                LOGE("KTXLoader: file is truncated at level %d.\n", level);
+                return false;
+            }
+
+            if (info->target == GL_TEXTURE_CUBE_MAP)
+            {
+                for (int face = 0; face < info->numberOfFaces; face++)
+                {
+                    if (!uploadLevel(info, level, face, levelWidth, levelHeight, 0, 0, imageSize, data + byteOffset + face * imageSize))
+                    {
+                        return false;
+                    }
+                }
+            }
+            else if (!uploadLevel(info, level, 0, levelWidth, levelHeight, 0, 0, levelSize, data + byteOffset))
+            {
+                return false;
+            }
+
+            info->dataSize += levelSize;
+        }
+
+        return true;
+    }
+
+    bool KTXLoader::load(const char *filename, GLuint *textureID, KTXTextureInfo *info)
+    {
+        KTXTextureInfo localInfo;
+        AssetFile file;
+
+        if (info == NULL)
+        {
+            info = &localInfo;
+        }
+
+        memset(info, 0, sizeof(*info));
+        *textureID = 0;
+
+        /* One mapping for the whole file, every image is uploaded from it. */
+        if (!file.open(filename))
+        {
+            LOGE("KTXLoader: cannot open '%s'.\n", filename);
+            return false;
+        }
+
+        const unsigned char *data = file.getData();
+        size_t size = file.getSize();
+        bool isKTX1 = size >= sizeof(ktx1Identifier) && memcmp(data, ktx1Identifier, sizeof(ktx1Identifier)) == 0;
+        bool isKTX2 = size >= sizeof(ktx2Identifier) && memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) == 0;
+
+        if (!isKTX1 && !isKTX2)
+        {
+            LOGE("KTXLoader: '%s' is not a KTX file.\n", filename);
+            return false;
+        }
+
+        GL_CHECK(glGenTextures(1, textureID));
+
+        /* The target is only known once the header has been parsed, so the loaders bind the texture. */
+        STARTUP_PHASE(PHASE_UPLOAD);
+        Timer timer;
+        bool loaded = isKTX1 ? loadKTX1(data, size, *textureID, info) : loadKTX2(data, size, *textureID, info);
+
+        info->uploadTime = timer.getTime() * 1000.0f;
+
+        if (!loaded)
+        {
+            LOGE("KTXLoader: cannot load '%s'.\n", filename);
+            GL_CHECK(glDeleteTextures(1, textureID));
+            *textureID = 0;
+            return false;
+        }
+
+        GL_CHECK(glTexParameteri(info->target, GL_TEXTURE_MIN_FILTER, info->numberOfLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+        GL_CHECK(glTexParameteri(info->target, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GPUMemory::trackTexture(*textureID, info->dataSize, info->internalFormat, "KTXLoader");
+
+        LOGI("KTXLoader: '%s', %dx%d format 0x%.4x, %d levels, %u bytes uploaded in %.2f ms.\n", filename,
+             info->width, info->height, info->internalFormat, info->numberOfLevels, (unsigned int)info->dataSize, info->uploadTime);
+
+        return true;
+    }
+}
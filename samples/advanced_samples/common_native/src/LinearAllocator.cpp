@@ -0,0 +1,116 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LinearAllocator.h"
+#include "Platform.h"
+
+#include <cstdlib>
+#include <stdint.h>
+
+namespace MaliSDK
+{
+    LinearAllocator::LinearAllocator(size_t capacity)
+        : memory(NULL),
+          capacity(capacity),
+          offset(0),
+          overflowSize(0)
+    {
+        memory = (unsigned char *)malloc(capacity);
+        if (memory == NULL)
+        {
+            LOGE("Could not allocate %u bytes for the linear allocator.", (unsigned int)capacity);
+            this->capacity = 0;
+        }
+    }
+
+    LinearAllocator::~LinearAllocator(void)
+    {
+        reset();
+        free(memory);
+    }
+
+    void *LinearAllocator::allocate(size_t size, size_t alignment)
+    {
+        uintptr_t base = (uintptr_t)memory;
+        uintptr_t start = (base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+        if (memory != NULL && start + size <= base + capacity)
+        {
+            offset = start + size - base;
+            return (void *)start;
+        }
+
+        /* Full. Serve it from the heap for now, reset() makes room for it next time. */
+        void *pointer = NULL;
+        if (posix_memalign(&pointer, alignment < sizeof(void *) ? sizeof(void *) : alignment, size) != 0)
+        {
+            LOGE("Could not allocate %u bytes.", (unsigned int)size);
+            return NULL;
+        }
+
+        overflow.push_back(pointer);
+        overflowSize += size + alignment;
+        return pointer;
+    }
+
+    void LinearAllocator::deallocate(void *pointer)
+    {
+        /* Released by reset(). */
+    }
+
+    void LinearAllocator::reset(void)
+    {
+        for (size_t i = 0; i < overflow.size(); i++)
+        {
+            free(overflow[i]);
+        }
+        overflow.clear();
+
+        if (overflowSize > 0)
+        {
+            size_t newCapacity = capacity > 0 ? capacity : 1024;
+            while (newCapacity < offset + overflowSize)
+            {
+                newCapacity *= 2;
+            }
+
+            unsigned char *newMemory = (unsigned char *)malloc(newCapacity);
+            if (newMemory != NULL)
+            {
+                free(memory);
+                memory = newMemory;
+                capacity = newCapacity;
+            }
+            overflowSize = 0;
+        }
+
+        offset = 0;
+    }
+
+    size_t LinearAllocator::getUsedSize(void) const
+    {
+        return offset + overflowSize;
+    }
+
+    size_t LinearAllocator::getCapacity(void) const
+    {
+        return capacity;
+    }
+}
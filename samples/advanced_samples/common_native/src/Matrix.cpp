@@ -28,6 +28,161 @@
 #include <cstdio>
 #include <cstdlib>
 
+/*
+ * The 4-wide helpers below are the only place where the NEON and scalar builds differ.
+ * NEON is used whenever the compiler targets it (always on arm64-v8a, and on armeabi-v7a when built with -mfpu=neon).
+ */
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MATRIX_USE_NEON 1
+#else
+#define MATRIX_USE_NEON 0
+#endif
+
+namespace
+{
+#if MATRIX_USE_NEON
+    typedef float32x4_t SimdVector4;
+
+    inline SimdVector4 simdLoad(const float *source)
+    {
+        return vld1q_f32(source);
+    }
+
+    inline void simdStore(float *destination, SimdVector4 vector)
+    {
+        vst1q_f32(destination, vector);
+    }
+
+    inline void simdStore3(float *destination, SimdVector4 vector)
+    {
+        vst1_f32(destination, vget_low_f32(vector));
+        vst1q_lane_f32(destination + 2, vector, 2);
+    }
+
+    inline SimdVector4 simdSubtract(SimdVector4 left, SimdVector4 right)
+    {
+        return vsubq_f32(left, right);
+    }
+
+    inline SimdVector4 simdScale(SimdVector4 vector, float scale)
+    {
+        return vmulq_n_f32(vector, scale);
+    }
+
+    /* Returns accumulator + vector * scale. */
+    inline SimdVector4 simdMultiplyAdd(SimdVector4 accumulator, SimdVector4 vector, float scale)
+    {
+        return vmlaq_n_f32(accumulator, vector, scale);
+    }
+
+    inline SimdVector4 simdSetW(SimdVector4 vector, float w)
+    {
+        return vsetq_lane_f32(w, vector, 3);
+    }
+
+    /* Rotates (x, y, z, w) into (y, z, x, y). */
+    inline SimdVector4 simdShuffleYZX(SimdVector4 vector)
+    {
+        float32x2_t low = vget_low_f32(vector);
+        float32x2_t yz = vext_f32(low, vget_high_f32(vector), 1);
+
+        return vcombine_f32(yz, low);
+    }
+
+    inline float simdDot3(SimdVector4 left, SimdVector4 right)
+    {
+        SimdVector4 product = vmulq_f32(left, right);
+        float32x2_t sum = vpadd_f32(vget_low_f32(product), vget_low_f32(product));
+
+        return vget_lane_f32(sum, 0) + vgetq_lane_f32(product, 2);
+    }
+
+    /* Cross product of the xyz components, the w component of the result is undefined. */
+    inline SimdVector4 simdCross(SimdVector4 left, SimdVector4 right)
+    {
+        SimdVector4 cross = vmlsq_f32(vmulq_f32(left, simdShuffleYZX(right)), simdShuffleYZX(left), right);
+
+        return simdShuffleYZX(cross);
+    }
+#else
+    struct SimdVector4
+    {
+        float x, y, z, w;
+    };
+
+    inline SimdVector4 simdLoad(const float *source)
+    {
+        SimdVector4 result = { source[0], source[1], source[2], source[3] };
+
+        return result;
+    }
+
+    inline void simdStore(float *destination, SimdVector4 vector)
+    {
+        destination[0] = vector.x;
+        destination[1] = vector.y;
+        destination[2] = vector.z;
+        destination[3] = vector.w;
+    }
+
+    inline void simdStore3(float *destination, SimdVector4 vector)
+    {
+        destination[0] = vector.x;
+        destination[1] = vector.y;
+        destination[2] = vector.z;
+    }
+
+    inline SimdVector4 simdSubtract(SimdVector4 left, SimdVector4 right)
+    {
+        SimdVector4 result = { left.x - right.x, left.y - right.y, left.z - right.z, left.w - right.w };
+
+        return result;
+    }
+
+    inline SimdVector4 simdScale(SimdVector4 vector, float scale)
+    {
+        SimdVector4 result = { vector.x * scale, vector.y * scale, vector.z * scale, vector.w * scale };
+
+        return result;
+    }
+
+    /* Returns accumulator + vector * scale. */
+    inline SimdVector4 simdMultiplyAdd(SimdVector4 accumulator, SimdVector4 vector, float scale)
+    {
+        SimdVector4 result = { accumulator.x + vector.x * scale,
+                               accumulator.y + vector.y * scale,
+                               accumulator.z + vector.z * scale,
+                               accumulator.w + vector.w * scale };
+
+        return result;
+    }
+
+    inline SimdVector4 simdSetW(SimdVector4 vector, float w)
+    {
+        vector.w = w;
+
+        return vector;
+    }
+
+    inline float simdDot3(SimdVector4 left, SimdVector4 right)
+    {
+        return left.x * right.x + left.y * right.y + left.z * right.z;
+    }
+
+    /* Cross product of the xyz components, the w component of the result is undefined. */
+    inline SimdVector4 simdCross(SimdVector4 left, SimdVector4 right)
+    {
+        SimdVector4 result = { left.y * right.z - left.z * right.y,
+                               left.z * right.x - left.x * right.z,
+                               left.x * right.y - left.y * right.x,
+                               0.0f };
+
+        return result;
+    }
+#endif
+}
+
 namespace MaliSDK
 {
     /* Identity matrix. */
@@ -39,7 +194,19 @@ namespace MaliSDK
         0.0f, 0.0f, 0.0f, 1.0f,
     };
 
+    /* Bias matrix. */
+    /* [Define bias matrix] */
+    const float biasArray[16] =
+    {
+        0.5f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.5f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.5f, 0.0f,
+        0.5f, 0.5f, 0.5f, 1.0f,
+    };
+    /* [Define bias matrix] */
+
     Matrix Matrix::identityMatrix = Matrix(identityArray);
+    Matrix Matrix::biasMatrix = Matrix(biasArray);
 
     Matrix::Matrix(const float* array)
     {
@@ -60,19 +227,19 @@ namespace MaliSDK
         return elements[element]; 
     }
 
-    Matrix Matrix::operator* (Matrix right)
+    Matrix Matrix::operator* (const Matrix &right) const
     {
         return multiply(this, &right);
     }
 
-    Matrix& Matrix::operator= (const Matrix &another)
+    Matrix::Matrix(const math::mat4 &matrix)
     {
-        if(this != &another)
-        {
-            memcpy(this->elements, another.elements, 16 * sizeof(float));
-        }
+        memcpy(elements, matrix.data(), 16 * sizeof(float));
+    }
 
-        return *this;
+    math::mat4 Matrix::getAsMat4(void) const
+    {
+        return math::mat4::fromArray(elements);
     }
 
     float* Matrix::getAsArray(void)
@@ -152,210 +319,51 @@ namespace MaliSDK
         return result;
     }
 
-    Matrix Matrix::matrixInvert(Matrix *matrix)
+    Matrix Matrix::matrixInvert(const Matrix *matrix)
     {
         Matrix result;
-        float matrix3x3[9];
-
-        /* Find the cofactor of each element. */
-        /* Element (i, j) (1, 1) */
-        matrix3x3[0] = matrix->elements[ 5];
-        matrix3x3[1] = matrix->elements[ 6];
-        matrix3x3[2] = matrix->elements[ 7];
-        matrix3x3[3] = matrix->elements[ 9];
-        matrix3x3[4] = matrix->elements[10];
-        matrix3x3[5] = matrix->elements[11];
-        matrix3x3[6] = matrix->elements[13];
-        matrix3x3[7] = matrix->elements[14];
-        matrix3x3[8] = matrix->elements[15];
-        result.elements[0] = matrixDeterminant(matrix3x3);
 
-        /* Element (i, j) (1, 2) */
-        matrix3x3[0] = matrix->elements[ 1];
-        matrix3x3[1] = matrix->elements[ 2];
-        matrix3x3[2] = matrix->elements[ 3];
-        matrix3x3[3] = matrix->elements[ 9];
-        matrix3x3[4] = matrix->elements[10];
-        matrix3x3[5] = matrix->elements[11];
-        matrix3x3[6] = matrix->elements[13];
-        matrix3x3[7] = matrix->elements[14];
-        matrix3x3[8] = matrix->elements[15];
-        result.elements[4] = -matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (1, 3) */
-        matrix3x3[0] = matrix->elements[ 1];
-        matrix3x3[1] = matrix->elements[ 2];
-        matrix3x3[2] = matrix->elements[ 3];
-        matrix3x3[3] = matrix->elements[ 5];
-        matrix3x3[4] = matrix->elements[ 6];
-        matrix3x3[5] = matrix->elements[ 7];
-        matrix3x3[6] = matrix->elements[13];
-        matrix3x3[7] = matrix->elements[14];
-        matrix3x3[8] = matrix->elements[15];
-        result.elements[8] = matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (1, 4) */
-        matrix3x3[0] = matrix->elements[ 1];
-        matrix3x3[1] = matrix->elements[ 2];
-        matrix3x3[2] = matrix->elements[ 3];
-        matrix3x3[3] = matrix->elements[ 5];
-        matrix3x3[4] = matrix->elements[ 6];
-        matrix3x3[5] = matrix->elements[ 7];
-        matrix3x3[6] = matrix->elements[ 9];
-        matrix3x3[7] = matrix->elements[10];
-        matrix3x3[8] = matrix->elements[11];
-        result.elements[12] = -matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (2, 1) */
-        matrix3x3[0] = matrix->elements[ 4];
-        matrix3x3[1] = matrix->elements[ 6];
-        matrix3x3[2] = matrix->elements[ 7];
-        matrix3x3[3] = matrix->elements[ 8];
-        matrix3x3[4] = matrix->elements[10];
-        matrix3x3[5] = matrix->elements[11];
-        matrix3x3[6] = matrix->elements[12];
-        matrix3x3[7] = matrix->elements[14];
-        matrix3x3[8] = matrix->elements[15];
-        result.elements[1] = -matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (2, 2) */
-        matrix3x3[0] = matrix->elements[ 0];
-        matrix3x3[1] = matrix->elements[ 2];
-        matrix3x3[2] = matrix->elements[ 3];
-        matrix3x3[3] = matrix->elements[ 8];
-        matrix3x3[4] = matrix->elements[10];
-        matrix3x3[5] = matrix->elements[11];
-        matrix3x3[6] = matrix->elements[12];
-        matrix3x3[7] = matrix->elements[14];
-        matrix3x3[8] = matrix->elements[15];
-        result.elements[5] = matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (2, 3) */
-        matrix3x3[0] = matrix->elements[ 0];
-        matrix3x3[1] = matrix->elements[ 2];
-        matrix3x3[2] = matrix->elements[ 3];
-        matrix3x3[3] = matrix->elements[ 4];
-        matrix3x3[4] = matrix->elements[ 6];
-        matrix3x3[5] = matrix->elements[ 7];
-        matrix3x3[6] = matrix->elements[12];
-        matrix3x3[7] = matrix->elements[14];
-        matrix3x3[8] = matrix->elements[15];
-        result.elements[9] = -matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (2, 4) */
-        matrix3x3[0] = matrix->elements[ 0];
-        matrix3x3[1] = matrix->elements[ 2];
-        matrix3x3[2] = matrix->elements[ 3];
-        matrix3x3[3] = matrix->elements[ 4];
-        matrix3x3[4] = matrix->elements[ 6];
-        matrix3x3[5] = matrix->elements[ 7];
-        matrix3x3[6] = matrix->elements[ 8];
-        matrix3x3[7] = matrix->elements[10];
-        matrix3x3[8] = matrix->elements[11];
-        result.elements[13] = matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (3, 1) */
-        matrix3x3[0] = matrix->elements[ 4];
-        matrix3x3[1] = matrix->elements[ 5];
-        matrix3x3[2] = matrix->elements[ 7];
-        matrix3x3[3] = matrix->elements[ 8];
-        matrix3x3[4] = matrix->elements[ 9];
-        matrix3x3[5] = matrix->elements[11];
-        matrix3x3[6] = matrix->elements[12];
-        matrix3x3[7] = matrix->elements[13];
-        matrix3x3[8] = matrix->elements[15];
-        result.elements[2] = matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (3, 2) */
-        matrix3x3[0] = matrix->elements[ 0];
-        matrix3x3[1] = matrix->elements[ 1];
-        matrix3x3[2] = matrix->elements[ 3];
-        matrix3x3[3] = matrix->elements[ 8];
-        matrix3x3[4] = matrix->elements[ 9];
-        matrix3x3[5] = matrix->elements[11];
-        matrix3x3[6] = matrix->elements[12];
-        matrix3x3[7] = matrix->elements[13];
-        matrix3x3[8] = matrix->elements[15];
-        result.elements[6] = -matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (3, 3) */
-        matrix3x3[0] = matrix->elements[ 0];
-        matrix3x3[1] = matrix->elements[ 1];
-        matrix3x3[2] = matrix->elements[ 3];
-        matrix3x3[3] = matrix->elements[ 4];
-        matrix3x3[4] = matrix->elements[ 5];
-        matrix3x3[5] = matrix->elements[ 7];
-        matrix3x3[6] = matrix->elements[12];
-        matrix3x3[7] = matrix->elements[13];
-        matrix3x3[8] = matrix->elements[15];
-        result.elements[10] = matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (3, 4) */
-        matrix3x3[0] = matrix->elements[ 0];
-        matrix3x3[1] = matrix->elements[ 1];
-        matrix3x3[2] = matrix->elements[ 3];
-        matrix3x3[3] = matrix->elements[ 4];
-        matrix3x3[4] = matrix->elements[ 5];
-        matrix3x3[5] = matrix->elements[ 7];
-        matrix3x3[6] = matrix->elements[ 8];
-        matrix3x3[7] = matrix->elements[ 9];
-        matrix3x3[8] = matrix->elements[11];
-        result.elements[14] = -matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (4, 1) */
-        matrix3x3[0] = matrix->elements[ 4];
-        matrix3x3[1] = matrix->elements[ 5];
-        matrix3x3[2] = matrix->elements[ 6];
-        matrix3x3[3] = matrix->elements[ 8];
-        matrix3x3[4] = matrix->elements[ 9];
-        matrix3x3[5] = matrix->elements[10];
-        matrix3x3[6] = matrix->elements[12];
-        matrix3x3[7] = matrix->elements[13];
-        matrix3x3[8] = matrix->elements[14];
-        result.elements[3] = -matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (4, 2) */
-        matrix3x3[0] = matrix->elements[ 0];
-        matrix3x3[1] = matrix->elements[ 1];
-        matrix3x3[2] = matrix->elements[ 2];
-        matrix3x3[3] = matrix->elements[ 8];
-        matrix3x3[4] = matrix->elements[ 9];
-        matrix3x3[5] = matrix->elements[10];
-        matrix3x3[6] = matrix->elements[12];
-        matrix3x3[7] = matrix->elements[13];
-        matrix3x3[8] = matrix->elements[14];
-        result.elements[7] = matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (4, 3) */
-        matrix3x3[0] = matrix->elements[ 0];
-        matrix3x3[1] = matrix->elements[ 1];
-        matrix3x3[2] = matrix->elements[ 2];
-        matrix3x3[3] = matrix->elements[ 4];
-        matrix3x3[4] = matrix->elements[ 5];
-        matrix3x3[5] = matrix->elements[ 6];
-        matrix3x3[6] = matrix->elements[12];
-        matrix3x3[7] = matrix->elements[13];
-        matrix3x3[8] = matrix->elements[14];
-        result.elements[11] = -matrixDeterminant(matrix3x3);
-
-        /* Element (i, j) (4, 4) */
-        matrix3x3[0] = matrix->elements[ 0];
-        matrix3x3[1] = matrix->elements[ 1];
-        matrix3x3[2] = matrix->elements[ 2];
-        matrix3x3[3] = matrix->elements[ 4];
-        matrix3x3[4] = matrix->elements[ 5];
-        matrix3x3[5] = matrix->elements[ 6];
-        matrix3x3[6] = matrix->elements[ 8];
-        matrix3x3[7] = matrix->elements[ 9];
-        matrix3x3[8] = matrix->elements[10];
-        result.elements[15] = matrixDeterminant(matrix3x3);
-
-        /* The adjoint is the transpose of the cofactor matrix. */
+        /*
+         * Treat the columns a, b, c and d of the matrix as 3D vectors plus a w component
+         * so the adjoint can be built from four cross products rather than sixteen 3x3 determinants.
+         */
+        SimdVector4 a = simdLoad(&matrix->elements[ 0]);
+        SimdVector4 b = simdLoad(&matrix->elements[ 4]);
+        SimdVector4 c = simdLoad(&matrix->elements[ 8]);
+        SimdVector4 d = simdLoad(&matrix->elements[12]);
+
+        float aw = matrix->elements[ 3];
+        float bw = matrix->elements[ 7];
+        float cw = matrix->elements[11];
+        float dw = matrix->elements[15];
+
+        SimdVector4 s = simdCross(a, b);
+        SimdVector4 t = simdCross(c, d);
+        SimdVector4 u = simdSubtract(simdScale(a, bw), simdScale(b, aw));
+        SimdVector4 v = simdSubtract(simdScale(c, dw), simdScale(d, cw));
+
+        /* The determinant falls out of the same terms. */
+        float inverseDeterminant = 1.0f / (simdDot3(s, v) + simdDot3(t, u));
+
+        s = simdScale(s, inverseDeterminant);
+        t = simdScale(t, inverseDeterminant);
+        u = simdScale(u, inverseDeterminant);
+        v = simdScale(v, inverseDeterminant);
+
+        /* Each of these is a row of the inverse. */
+        SimdVector4 row0 = simdMultiplyAdd(simdCross(b, v), t,  bw);
+        SimdVector4 row1 = simdMultiplyAdd(simdCross(v, a), t, -aw);
+        SimdVector4 row2 = simdMultiplyAdd(simdCross(d, u), s,  dw);
+        SimdVector4 row3 = simdMultiplyAdd(simdCross(u, c), s, -cw);
+
+        simdStore(&result.elements[ 0], simdSetW(row0, -simdDot3(b, t)));
+        simdStore(&result.elements[ 4], simdSetW(row1,  simdDot3(a, t)));
+        simdStore(&result.elements[ 8], simdSetW(row2, -simdDot3(d, s)));
+        simdStore(&result.elements[12], simdSetW(row3,  simdDot3(c, s)));
+
+        /* The rows were stored as columns, so transpose into column major order. */
         matrixTranspose(&result);
 
-        /* The inverse is the adjoint divided by the determinant. */
-        result = matrixScale(&result, 1.0f / matrixDeterminant(matrix));
-
         return result;
     }
 
@@ -480,6 +488,48 @@ namespace MaliSDK
 		return result;
 	}
 
+    Matrix Matrix::matrixLookAt(Vec3f eye, Vec3f center, Vec3f up)
+    {
+        Matrix result = identityMatrix;
+
+        Vec3f cameraX, cameraY;
+
+        Vec3f cameraZ = {center.x - eye.x, center.y - eye.y, center.z - eye.z};
+        cameraZ.normalize();
+
+        cameraX = Vec3f::cross(cameraZ, up);
+        cameraX.normalize();
+
+        cameraY = Vec3f::cross(cameraX, cameraZ);
+
+        /*
+         * The final lookAt should look like:
+         *
+         * lookAt[] = { cameraX.x,              cameraY.x,              -cameraZ.x,              0.0f,
+         *              cameraX.y,              cameraY.y,              -cameraZ.y,              0.0f,
+         *              cameraX.z,              cameraY.z,              -cameraZ.z,              0.0f,
+         *              dot(cameraX, eye),      dot(cameraY, eye),       dot(cameraZ, eye),      1.0f };
+         */
+
+        result[0]  = cameraX.x;
+        result[1]  = cameraY.x;
+        result[2]  = -cameraZ.x;
+
+        result[4]  = cameraX.y;
+        result[5]  = cameraY.y;
+        result[6]  = -cameraZ.y;
+
+        result[8]  = cameraX.z;
+        result[9]  = cameraY.z;
+        result[10] = -cameraZ.z;
+
+        result[12] = Vec3f::dot(cameraX, eye);
+        result[13] = Vec3f::dot(cameraY, eye);
+        result[14] = Vec3f::dot(cameraZ, eye);
+
+        return result;
+    }
+
     Matrix Matrix::matrixOrthographic(float left, float right, float bottom, float top, float zNear, float zFar)
     {
         Matrix result = identityMatrix;
@@ -532,83 +582,88 @@ namespace MaliSDK
         return result;
     }
 
-    Matrix Matrix::multiply(Matrix *left, Matrix *right)
+    Matrix Matrix::multiply(const Matrix *left, const Matrix *right)
     {
         Matrix result;
 
-        for(int row = 0; row < 4; row ++)
+        SimdVector4 leftColumn0 = simdLoad(&left->elements[ 0]);
+        SimdVector4 leftColumn1 = simdLoad(&left->elements[ 4]);
+        SimdVector4 leftColumn2 = simdLoad(&left->elements[ 8]);
+        SimdVector4 leftColumn3 = simdLoad(&left->elements[12]);
+
+        /* Each column of the result is a linear combination of the columns of left. */
+        for(int column = 0; column < 4; column ++)
         {
-            for(int column = 0; column < 4; column ++)
-            {
-                /*result.elements[row * 4 + column]  = left->elements[0 + row * 4] * right->elements[column + 0 * 4];
-                result.elements[row * 4 + column] += left->elements[1 + row * 4] * right->elements[column + 1 * 4];
-                result.elements[row * 4 + column] += left->elements[2 + row * 4] * right->elements[column + 2 * 4];
-                result.elements[row * 4 + column] += left->elements[3 + row * 4] * right->elements[column + 3 * 4];*/
-                float accumulator = 0.0f;
-                for(int allElements = 0; allElements < 4; allElements ++)
-                {
-                    accumulator += left->elements[allElements * 4 + row] * right->elements[column * 4 + allElements];
-                }
-                result.elements[column * 4 + row] = accumulator;
-            }
+            const float *rightColumn = &right->elements[column * 4];
+            SimdVector4 accumulator = simdScale(leftColumn0, rightColumn[0]);
+
+            accumulator = simdMultiplyAdd(accumulator, leftColumn1, rightColumn[1]);
+            accumulator = simdMultiplyAdd(accumulator, leftColumn2, rightColumn[2]);
+            accumulator = simdMultiplyAdd(accumulator, leftColumn3, rightColumn[3]);
+
+            simdStore(&result.elements[column * 4], accumulator);
         }
 
         return result;
     }
 
-    Vec4f Matrix::vertexTransform(Vec4f *vertex, Matrix *matrix)
+    Vec4f Matrix::vertexTransform(const Vec4f *vertex, const Matrix *matrix)
     {
         Vec4f result;
-        
-        result.x  = vertex->x * matrix->elements[ 0];
-        result.x += vertex->y * matrix->elements[ 4];
-        result.x += vertex->z * matrix->elements[ 8];
-        result.x += vertex->w * matrix->elements[12];
-
-        result.y  = vertex->x * matrix->elements[ 1];
-        result.y += vertex->y * matrix->elements[ 5];
-        result.y += vertex->z * matrix->elements[ 9];
-        result.y += vertex->w * matrix->elements[13];
-
-        result.z  = vertex->x * matrix->elements[ 2];
-        result.z += vertex->y * matrix->elements[ 6];
-        result.z += vertex->z * matrix->elements[10];
-        result.z += vertex->w * matrix->elements[14];
-
-        result.w  = vertex->x * matrix->elements[ 3];
-        result.w += vertex->y * matrix->elements[ 7];
-        result.w += vertex->z * matrix->elements[11];
-        result.w += vertex->w * matrix->elements[15];
+
+        vertexTransformArray(vertex, &result, 1, matrix);
 
         return result;
     }
 
-    Vec3f Matrix::vertexTransform(Vec3f *vertex, Matrix *matrix)
+    Vec3f Matrix::vertexTransform(const Vec3f *vertex, const Matrix *matrix)
     {
         Vec3f result;
-        Vec4f extendedVertex;
 
-        extendedVertex.x = vertex->x;
-        extendedVertex.y = vertex->y;
-        extendedVertex.z = vertex->z;
-        extendedVertex.w = 1.0f;
+        vertexTransformArray(vertex, &result, 1, matrix);
+
+        return result;
+    }
+
+    void Matrix::vertexTransformArray(const Vec4f *vertices, Vec4f *results, int count, const Matrix *matrix)
+    {
+        SimdVector4 column0 = simdLoad(&matrix->elements[ 0]);
+        SimdVector4 column1 = simdLoad(&matrix->elements[ 4]);
+        SimdVector4 column2 = simdLoad(&matrix->elements[ 8]);
+        SimdVector4 column3 = simdLoad(&matrix->elements[12]);
 
-        result.x  = extendedVertex.x * matrix->elements[ 0];
-        result.x += extendedVertex.y * matrix->elements[ 4];
-        result.x += extendedVertex.z * matrix->elements[ 8];
-        result.x += extendedVertex.w * matrix->elements[12];
+        for(int vertexIndex = 0; vertexIndex < count; vertexIndex ++)
+        {
+            /* Read the vertex before writing so that vertices and results may alias. */
+            Vec4f vertex = vertices[vertexIndex];
+            SimdVector4 accumulator = simdScale(column0, vertex.x);
 
-        result.y  = extendedVertex.x * matrix->elements[ 1];
-        result.y += extendedVertex.y * matrix->elements[ 5];
-        result.y += extendedVertex.z * matrix->elements[ 9];
-        result.y += extendedVertex.w * matrix->elements[13];
+            accumulator = simdMultiplyAdd(accumulator, column1, vertex.y);
+            accumulator = simdMultiplyAdd(accumulator, column2, vertex.z);
+            accumulator = simdMultiplyAdd(accumulator, column3, vertex.w);
 
-        result.z  = extendedVertex.x * matrix->elements[ 2];
-        result.z += extendedVertex.y * matrix->elements[ 6];
-        result.z += extendedVertex.z * matrix->elements[10];
-        result.z += extendedVertex.w * matrix->elements[14];
+            simdStore(&results[vertexIndex].x, accumulator);
+        }
+    }
 
-        return result;
+    void Matrix::vertexTransformArray(const Vec3f *vertices, Vec3f *results, int count, const Matrix *matrix)
+    {
+        SimdVector4 column0 = simdLoad(&matrix->elements[ 0]);
+        SimdVector4 column1 = simdLoad(&matrix->elements[ 4]);
+        SimdVector4 column2 = simdLoad(&matrix->elements[ 8]);
+        SimdVector4 column3 = simdLoad(&matrix->elements[12]);
+
+        for(int vertexIndex = 0; vertexIndex < count; vertexIndex ++)
+        {
+            /* The w component is implicitly 1.0f, so the translation column is the starting point. */
+            Vec3f vertex = vertices[vertexIndex];
+            SimdVector4 accumulator = simdMultiplyAdd(column3, column0, vertex.x);
+
+            accumulator = simdMultiplyAdd(accumulator, column1, vertex.y);
+            accumulator = simdMultiplyAdd(accumulator, column2, vertex.z);
+
+            simdStore3(&results[vertexIndex].x, accumulator);
+        }
     }
 
     void Matrix::print(void)
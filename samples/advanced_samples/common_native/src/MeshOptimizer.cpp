@@ -0,0 +1,377 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "MeshOptimizer.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* FNV-1a over the bytes of a vertex. */
+    static unsigned int hashVertex(const float *vertex, int floatsPerVertex)
+    {
+        const unsigned char *bytes = (const unsigned char *)vertex;
+        unsigned int hash = 2166136261u;
+        for (size_t i = 0; i < floatsPerVertex * sizeof(float); i++)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    bool MeshOptimizer::index(const float *const *streams, const int *components, int numberOfStreams, int numberOfVertices, IndexedModel *model)
+    {
+        int floatsPerVertex = 0;
+        for (int i = 0; i < numberOfStreams; i++)
+        {
+            floatsPerVertex += components[i];
+        }
+
+        model->floatsPerVertex = floatsPerVertex;
+        model->vertices.clear();
+        model->indices.clear();
+        model->indices.reserve(numberOfVertices);
+
+        /* Open addressing table of unique vertex indices, at most half full. */
+        size_t tableSize = 1;
+        while (tableSize < 2 * (size_t)numberOfVertices)
+        {
+            tableSize *= 2;
+        }
+        std::vector<int> table(tableSize, -1);
+        std::vector<float> vertex(floatsPerVertex);
+        int numberOfUniqueVertices = 0;
+
+        for (int v = 0; v < numberOfVertices; v++)
+        {
+            int offset = 0;
+            for (int i = 0; i < numberOfStreams; i++)
+            {
+                memcpy(&vertex[offset], streams[i] + v * components[i], components[i] * sizeof(float));
+                offset += components[i];
+            }
+
+            size_t slot = hashVertex(&vertex[0], floatsPerVertex) & (tableSize - 1);
+            while (table[slot] >= 0 &&
+                   memcmp(&model->vertices[table[slot] * floatsPerVertex], &vertex[0], floatsPerVertex * sizeof(float)) != 0)
+            {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+
+            if (table[slot] < 0)
+            {
+                if (numberOfUniqueVertices == 65536)
+                {
+                    LOGE("Model has more than 65536 unique vertices, it cannot use 16-bit indices.");
+                    return false;
+                }
+
+                table[slot] = numberOfUniqueVertices++;
+                model->vertices.insert(model->vertices.end(), vertex.begin(), vertex.end());
+            }
+
+            model->indices.push_back((unsigned short)table[slot]);
+        }
+
+        return true;
+    }
+
+    /* Pick the next fanning vertex, see getNextVertex() in the Tipsify paper. -1 when every triangle is emitted. */
+    static int nextVertex(int numberOfVertices, int &cursor, int cacheSize, const std::vector<int> &candidates,
+                          const std::vector<int> &timestamps, int time, const std::vector<int> &liveTriangles,
+                          std::vector<int> &deadEnds, bool *skipped)
+    {
+        int best = -1;
+        int bestPriority = -1;
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            int v = candidates[i];
+            if (liveTriangles[v] > 0)
+            {
+                /* Prefer vertices that will still be in the cache once all their triangles are emitted, oldest first. */
+                int priority = 0;
+                if (time - timestamps[v] + 2 * liveTriangles[v] <= cacheSize)
+                {
+                    priority = time - timestamps[v];
+                }
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    best = v;
+                }
+            }
+        }
+
+        if (best >= 0)
+        {
+            *skipped = false;
+            return best;
+        }
+
+        /* Dead end, the next triangles do not share anything with the cache. */
+        *skipped = true;
+        while (!deadEnds.empty())
+        {
+            int v = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[v] > 0)
+            {
+                return v;
+            }
+        }
+        while (cursor < numberOfVertices)
+        {
+            if (liveTriangles[cursor] > 0)
+            {
+                return cursor;
+            }
+            cursor++;
+        }
+        return -1;
+    }
+
+    void MeshOptimizer::optimizeVertexCache(std::vector<unsigned short> &indices, int numberOfVertices, int cacheSize, std::vector<int> *clusters)
+    {
+        int numberOfTriangles = (int)indices.size() / 3;
+
+        /* Triangles using each vertex, as offsets into one array. */
+        std::vector<int> liveTriangles(numberOfVertices, 0);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            liveTriangles[indices[i]]++;
+        }
+        std::vector<int> adjacencyOffsets(numberOfVertices + 1, 0);
+        for (int v = 0; v < numberOfVertices; v++)
+        {
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+        }
+        std::vector<int> adjacency(indices.size());
+        std::vector<int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            adjacency[fill[indices[i]]++] = (int)i / 3;
+        }
+
+        std::vector<int> timestamps(numberOfVertices, 0);
+        std::vector<bool> emitted(numberOfTriangles, false);
+        std::vector<int> deadEnds;
+        std::vector<int> candidates;
+        std::vector<unsigned short> output;
+        output.reserve(indices.size());
+        clusters->clear();
+
+        int time = cacheSize + 1;
+        int cursor = 0;
+        bool skipped = true;
+        int fanning = numberOfVertices > 0 ? 0 : -1;
+
+        while (fanning >= 0)
+        {
+            if (skipped)
+            {
+                clusters->push_back((int)output.size() / 3);
+            }
+
+            candidates.clear();
+            for (int a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++)
+            {
+                int t = adjacency[a];
+                if (emitted[t])
+                {
+                    continue;
+                }
+
+                for (int c = 0; c < 3; c++)
+                {
+                    int v = indices[3 * t + c];
+                    output.push_back((unsigned short)v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    liveTriangles[v]--;
+                    if (time - timestamps[v] > cacheSize)
+                    {
+                        timestamps[v] = time++;
+                    }
+                }
+                emitted[t] = true;
+            }
+
+            fanning = nextVertex(numberOfVertices, cursor, cacheSize, candidates, timestamps, time, liveTriangles, deadEnds, &skipped);
+        }
+
+        indices.swap(output);
+    }
+
+    struct Cluster
+    {
+        int firstTriangle;
+        int numberOfTriangles;
+        float sortKey;
+    };
+
+    static bool isDrawnBefore(const Cluster &a, const Cluster &b)
+    {
+        return a.sortKey > b.sortKey;
+    }
+
+    void MeshOptimizer::optimizeOverdraw(IndexedModel *model, const std::vector<int> &clusterStarts)
+    {
+        const std::vector<unsigned short> &indices = model->indices;
+        int numberOfTriangles = (int)indices.size() / 3;
+        if (clusterStarts.size() < 2)
+        {
+            return;
+        }
+
+        /* Area weighted centroid and normal of every cluster, and centroid of the model. */
+        std::vector<Cluster> clusters(clusterStarts.size());
+        std::vector<float> centroids(3 * clusters.size(), 0.0f);
+        std::vector<float> normals(3 * clusters.size(), 0.0f);
+        float modelCentroid[3] = { 0.0f, 0.0f, 0.0f };
+        float modelArea = 0.0f;
+
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            clusters[c].firstTriangle = clusterStarts[c];
+            clusters[c].numberOfTriangles = (c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : numberOfTriangles) - clusterStarts[c];
+
+            float area = 0.0f;
+            for (int t = clusters[c].firstTriangle; t < clusters[c].firstTriangle + clusters[c].numberOfTriangles; t++)
+            {
+                const float *p0 = &model->vertices[indices[3 * t + 0] * model->floatsPerVertex + model->positionOffset];
+                const float *p1 = &model->vertices[indices[3 * t + 1] * model->floatsPerVertex + model->positionOffset];
+                const float *p2 = &model->vertices[indices[3 * t + 2] * model->floatsPerVertex + model->positionOffset];
+
+                float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                float triangleArea = 0.5f * sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+                for (int i = 0; i < 3; i++)
+                {
+                    float centre = (p0[i] + p1[i] + p2[i]) / 3.0f;
+                    centroids[3 * c + i] += centre * triangleArea;
+                    modelCentroid[i] += centre * triangleArea;
+                    normals[3 * c + i] += normal[i];
+                }
+                area += triangleArea;
+            }
+
+            if (area > 0.0f)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    centroids[3 * c + i] /= area;
+                }
+            }
+            modelArea += area;
+        }
+
+        if (modelArea <= 0.0f)
+        {
+            return;
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            modelCentroid[i] /= modelArea;
+        }
+
+        /* Clusters facing away from the centre are most likely in front of the rest of the model, draw them first. */
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            const float *n = &normals[3 * c];
+            float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            float key = 0.0f;
+            if (length > 0.0f)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    key += (centroids[3 * c + i] - modelCentroid[i]) * n[i] / length;
+                }
+            }
+            clusters[c].sortKey = key;
+        }
+        std::stable_sort(clusters.begin(), clusters.end(), isDrawnBefore);
+
+        std::vector<unsigned short> sorted;
+        sorted.reserve(indices.size());
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            sorted.insert(sorted.end(), indices.begin() + 3 * clusters[c].firstTriangle,
+                          indices.begin() + 3 * (clusters[c].firstTriangle + clusters[c].numberOfTriangles));
+        }
+        model->indices.swap(sorted);
+    }
+
+    void MeshOptimizer::optimizeVertexFetch(IndexedModel *model)
+    {
+        int numberOfVertices = model->getNumberOfVertices();
+        std::vector<int> remap(numberOfVertices, -1);
+        std::vector<float> vertices;
+        vertices.reserve(model->vertices.size());
+        int next = 0;
+
+        for (size_t i = 0; i < model->indices.size(); i++)
+        {
+            int v = model->indices[i];
+            if (remap[v] < 0)
+            {
+                remap[v] = next++;
+                vertices.insert(vertices.end(), model->vertices.begin() + v * model->floatsPerVertex,
+                                model->vertices.begin() + (v + 1) * model->floatsPerVertex);
+            }
+            model->indices[i] = (unsigned short)remap[v];
+        }
+
+        /* Vertices no triangle uses are dropped. */
+        model->vertices.swap(vertices);
+    }
+
+    void MeshOptimizer::optimize(IndexedModel *model, int cacheSize)
+    {
+        std::vector<int> clusters;
+        optimizeVertexCache(model->indices, model->getNumberOfVertices(), cacheSize, &clusters);
+        optimizeOverdraw(model, clusters);
+        optimizeVertexFetch(model);
+    }
+
+    float MeshOptimizer::getACMR(const std::vector<unsigned short> &indices, int numberOfVertices, int cacheSize)
+    {
+        if (indices.size() < 3)
+        {
+            return 0.0f;
+        }
+
+        /* A vertex is in the FIFO if it entered it less than cacheSize misses ago. */
+        std::vector<int> entered(numberOfVertices, -cacheSize - 1);
+        int misses = 0;
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            if (misses - entered[indices[i]] > cacheSize)
+            {
+                entered[indices[i]] = misses++;
+            }
+        }
+        return (float)misses / (indices.size() / 3);
+    }
+}
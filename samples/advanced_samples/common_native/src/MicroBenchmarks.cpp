@@ -0,0 +1,912 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "MicroBenchmarks.h"
+
+#include "AndroidPlatform.h"
+#include "GLExtensions.h"
+#include "Shader.h"
+#include "Timer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using std::vector;
+
+/* Formats which are not in the core headers. */
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+#define GL_COMPRESSED_RGBA_ASTC_8x8_KHR 0x93B7
+#endif
+
+namespace MaliSDK
+{
+    /* Size of the framebuffer of the cases which are not limited by fragment work. */
+    static const int smallTargetSize = 64;
+
+    /*
+     * Fragment shaders of the fill and sampling cases discard below a coordinate which is never reached.
+     * The GPU cannot tell, so it has to shade every layer instead of removing the ones which get covered.
+     */
+    static const float neverDiscardBelow = -1.0f;
+
+    static const char drawVertexShaderSource[] =
+        "#version 300 es\n"
+        "layout(std140) uniform Instance\n"
+        "{\n"
+        "    vec4 offset;\n"
+        "};\n"
+        "layout(location = 0) in vec2 position;\n"
+        "out vec2 texCoord;\n"
+        "void main()\n"
+        "{\n"
+        "    texCoord = position;\n"
+        "    gl_Position = vec4(position * 0.05 + offset.xy, 0.0, 1.0);\n"
+        "}\n";
+
+    /* The two programs of the program change case only differ in their tint. */
+    static const char *const drawFragmentShaderSources[2] =
+    {
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "in vec2 texCoord;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    fragColor = texture(tex, texCoord);\n"
+        "}\n",
+
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "in vec2 texCoord;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    fragColor = texture(tex, texCoord) * 0.5;\n"
+        "}\n"
+    };
+
+    static const char vertexThroughputVertexShaderSource[] =
+        "#version 300 es\n"
+        "uniform mat4 transform;\n"
+        "layout(location = 0) in vec4 position;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_Position = transform * position;\n"
+        "}\n";
+
+    static const char constantFragmentShaderSource[] =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    fragColor = vec4(1.0);\n"
+        "}\n";
+
+    /* A triangle which covers the whole framebuffer, from gl_VertexID alone. */
+    static const char fullScreenVertexShaderSource[] =
+        "#version 300 es\n"
+        "out vec2 texCoord;\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 position = vec2(float((gl_VertexID & 1) * 4 - 1), float((gl_VertexID & 2) * 2 - 1));\n"
+        "    texCoord = position * 0.5 + 0.5;\n"
+        "    gl_Position = vec4(position, 0.0, 1.0);\n"
+        "}\n";
+
+    static const char fillFragmentShaderSource[] =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform float discardBelow;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    if (gl_FragCoord.x < discardBelow)\n"
+        "    {\n"
+        "        discard;\n"
+        "    }\n"
+        "    fragColor = vec4(0.5, 0.25, 0.75, 0.5);\n"
+        "}\n";
+
+    /* Four bilinear samples half a texel apart, so most texels are in the cache already. */
+    static const char samplingFragmentShaderSource[] =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "uniform float discardBelow;\n"
+        "uniform vec2 halfTexel;\n"
+        "in vec2 texCoord;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    if (gl_FragCoord.x < discardBelow)\n"
+        "    {\n"
+        "        discard;\n"
+        "    }\n"
+        "    vec4 sum = texture(tex, texCoord);\n"
+        "    sum += texture(tex, texCoord + vec2(halfTexel.x, 0.0));\n"
+        "    sum += texture(tex, texCoord + vec2(0.0, halfTexel.y));\n"
+        "    sum += texture(tex, texCoord + halfTexel);\n"
+        "    fragColor = sum * 0.25;\n"
+        "}\n";
+
+    /* The same sequence on every run, so every run measures the same content. */
+    static unsigned int nextRandom(unsigned int *state)
+    {
+        *state = *state * 1664525u + 1013904223u;
+
+        return *state >> 8;
+    }
+
+    static void fillRandom(vector<unsigned char> &data, unsigned int seed)
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            data[i] = (unsigned char)nextRandom(&seed);
+        }
+    }
+
+    /* Write value to count bits of block from bit offset on, least significant bit first. */
+    static void setBits(unsigned char *block, int offset, int count, unsigned int value)
+    {
+        for (int bit = 0; bit < count; bit++)
+        {
+            if (value & (1u << bit))
+            {
+                block[(offset + bit) / 8] |= (unsigned char)(1u << ((offset + bit) % 8));
+            }
+        }
+    }
+
+    /*
+     * An ASTC LDR block of random content which goes through the full decoder, unlike a constant colour block.
+     * Block mode 0x042 is a 4x4 grid of 2 bit weights, stored from bit 127 downwards, which fits both 4x4 and 8x8 blocks.
+     * A single partition with colour endpoint mode 8, direct LDR RGB, leaves room for its six values at 8 bits each.
+     */
+    static void encodeAstcBlock(unsigned char block[16], unsigned int *state)
+    {
+        memset(block, 0, 16);
+        setBits(block, 0, 11, 0x042);
+        setBits(block, 11, 2, 0);
+        setBits(block, 13, 4, 8);
+
+        for (int value = 0; value < 6; value++)
+        {
+            setBits(block, 17 + 8 * value, 8, nextRandom(state) & 0xFF);
+        }
+
+        for (int byte = 12; byte < 16; byte++)
+        {
+            block[byte] = (unsigned char)nextRandom(state);
+        }
+    }
+
+    /*
+     * Create a framebuffer with a single colour texture.
+     * Returns 0 and deletes both if the framebuffer is not complete.
+     */
+    static GLuint createFramebuffer(GLenum internalFormat, int width, int height, GLuint *colorTexture)
+    {
+        GLuint framebuffer = 0;
+
+        GL_CHECK(glGenTextures(1, colorTexture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, *colorTexture));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+
+        GL_CHECK(glGenFramebuffers(1, &framebuffer));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, *colorTexture, 0));
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            GL_CHECK(glDeleteFramebuffers(1, &framebuffer));
+            GL_CHECK(glDeleteTextures(1, colorTexture));
+            *colorTexture = 0;
+
+            return 0;
+        }
+
+        return framebuffer;
+    }
+
+    /* Bind the framebuffer of a case, with the state every case expects. */
+    static void bindFramebuffer(GLuint framebuffer, int size)
+    {
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GL_CHECK(glViewport(0, 0, size, size));
+        GL_CHECK(glDisable(GL_DEPTH_TEST));
+        GL_CHECK(glDisable(GL_CULL_FACE));
+        GL_CHECK(glDisable(GL_SCISSOR_TEST));
+        GL_CHECK(glDisable(GL_BLEND));
+        GL_CHECK(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+        GL_CHECK(glClear(GL_COLOR_BUFFER_BIT));
+    }
+
+    /* Formats which core OpenGL ES 3.0 does not render to. */
+    static bool isColorRenderable(GLenum internalFormat)
+    {
+        switch (internalFormat)
+        {
+            case GL_RGBA16F:
+                return GLExtensions::isSupported("GL_EXT_color_buffer_half_float") || GLExtensions::isSupported("GL_EXT_color_buffer_float");
+            case GL_R11F_G11F_B10F:
+                return GLExtensions::isSupported("GL_EXT_color_buffer_float");
+            default:
+                return true;
+        }
+    }
+
+    DrawCallBenchmark::DrawCallBenchmark(StateChange change)
+        : change(change)
+        , framebuffer(0)
+        , colorTexture(0)
+        , uniformBuffer(0)
+        , uniformRangeStride(0)
+        , uniformRangeCount(0)
+    {
+        memset(programs, 0, sizeof(programs));
+        memset(textures, 0, sizeof(textures));
+        memset(vertexArrays, 0, sizeof(vertexArrays));
+        memset(vertexBuffers, 0, sizeof(vertexBuffers));
+    }
+
+    const char *DrawCallBenchmark::getName(void) const
+    {
+        switch (change)
+        {
+            case ProgramChange:
+                return "program_changes";
+            case TextureChange:
+                return "texture_changes";
+            case VertexArrayChange:
+                return "vertex_array_changes";
+            case UniformBufferRangeChange:
+                return "uniform_buffer_range_changes";
+            default:
+                return "draw_calls";
+        }
+    }
+
+    const char *DrawCallBenchmark::getUnit(void) const
+    {
+        /* There is one change before every draw. */
+        return change == NoChange ? "draws" : "changes";
+    }
+
+    bool DrawCallBenchmark::setUp(void)
+    {
+        framebuffer = createFramebuffer(GL_RGBA8, smallTargetSize, smallTargetSize, &colorTexture);
+
+        for (int i = 0; i < 2; i++)
+        {
+            Shader::processProgramSource(&programs[i], drawVertexShaderSource, drawFragmentShaderSources[i]);
+            GL_CHECK(glUniformBlockBinding(programs[i], glGetUniformBlockIndex(programs[i], "Instance"), 0));
+        }
+
+        /* Textures of different colours, so switching them changes what is drawn. */
+        GL_CHECK(glGenTextures(objectCount, textures));
+        for (int i = 0; i < objectCount; i++)
+        {
+            GLubyte texels[4 * 4 * 4];
+            for (int texel = 0; texel < 4 * 4; texel++)
+            {
+                texels[4 * texel + 0] = (GLubyte)(32 * i);
+                texels[4 * texel + 1] = (GLubyte)(255 - 32 * i);
+                texels[4 * texel + 2] = (GLubyte)(16 * texel);
+                texels[4 * texel + 3] = 255;
+            }
+
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D, textures[i]));
+            GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 4, 4));
+            GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 4, 4, GL_RGBA, GL_UNSIGNED_BYTE, texels));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        }
+
+        /* A vertex array and buffer per triangle shape. */
+        GL_CHECK(glGenVertexArrays(objectCount, vertexArrays));
+        GL_CHECK(glGenBuffers(objectCount, vertexBuffers));
+        for (int i = 0; i < objectCount; i++)
+        {
+            const GLfloat size = 0.5f + 0.0625f * i;
+            const GLfloat triangle[] = { 0.0f, 0.0f, size, 0.0f, 0.0f, size };
+
+            GL_CHECK(glBindVertexArray(vertexArrays[i]));
+            GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffers[i]));
+            GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(triangle), triangle, GL_STATIC_DRAW));
+            GL_CHECK(glEnableVertexAttribArray(0));
+            GL_CHECK(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0));
+        }
+        GL_CHECK(glBindVertexArray(0));
+
+        /* A uniform buffer of offsets, one per range, each range aligned as the driver requires. */
+        GLint alignment = 0;
+        GL_CHECK(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+        uniformRangeStride = alignment > 16 ? alignment : 16;
+        uniformRangeCount = 256;
+
+        vector<unsigned char> uniformData(uniformRangeStride * uniformRangeCount, 0);
+        unsigned int state = 1;
+        for (int i = 0; i < uniformRangeCount; i++)
+        {
+            GLfloat *offset = (GLfloat *)&uniformData[i * uniformRangeStride];
+            offset[0] = (nextRandom(&state) % 1800) / 1000.0f - 0.9f;
+            offset[1] = (nextRandom(&state) % 1800) / 1000.0f - 0.9f;
+        }
+
+        GL_CHECK(glGenBuffers(1, &uniformBuffer));
+        GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer));
+        GL_CHECK(glBufferData(GL_UNIFORM_BUFFER, uniformData.size(), &uniformData[0], GL_STATIC_DRAW));
+        GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+
+        return framebuffer != 0;
+    }
+
+    double DrawCallBenchmark::renderFrame(void)
+    {
+        bindFramebuffer(framebuffer, smallTargetSize);
+
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glUseProgram(programs[0]));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, textures[0]));
+        GL_CHECK(glBindVertexArray(vertexArrays[0]));
+        GL_CHECK(glBindBufferRange(GL_UNIFORM_BUFFER, 0, uniformBuffer, 0, 16));
+
+        /* No GL_CHECK in the loop, glGetError() after every call would cost as much as the calls being measured. */
+        for (int i = 0; i < drawsPerFrame; i++)
+        {
+            switch (change)
+            {
+                case ProgramChange:
+                    glUseProgram(programs[i & 1]);
+                    break;
+                case TextureChange:
+                    glBindTexture(GL_TEXTURE_2D, textures[i % objectCount]);
+                    break;
+                case VertexArrayChange:
+                    glBindVertexArray(vertexArrays[i % objectCount]);
+                    break;
+                case UniformBufferRangeChange:
+                    glBindBufferRange(GL_UNIFORM_BUFFER, 0, uniformBuffer, (i % uniformRangeCount) * uniformRangeStride, 16);
+                    break;
+                default:
+                    break;
+            }
+
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+
+        GL_CHECK(glBindVertexArray(0));
+
+        return drawsPerFrame;
+    }
+
+    void DrawCallBenchmark::tearDown(void)
+    {
+        GL_CHECK(glDeleteBuffers(1, &uniformBuffer));
+        GL_CHECK(glDeleteBuffers(objectCount, vertexBuffers));
+        GL_CHECK(glDeleteVertexArrays(objectCount, vertexArrays));
+        GL_CHECK(glDeleteTextures(objectCount, textures));
+        for (int i = 0; i < 2; i++)
+        {
+            GL_CHECK(glDeleteProgram(programs[i]));
+        }
+        GL_CHECK(glDeleteFramebuffers(1, &framebuffer));
+        GL_CHECK(glDeleteTextures(1, &colorTexture));
+
+        uniformBuffer = 0;
+        framebuffer = 0;
+        colorTexture = 0;
+        memset(programs, 0, sizeof(programs));
+        memset(textures, 0, sizeof(textures));
+        memset(vertexArrays, 0, sizeof(vertexArrays));
+        memset(vertexBuffers, 0, sizeof(vertexBuffers));
+    }
+
+    VertexThroughputBenchmark::VertexThroughputBenchmark(void)
+        : framebuffer(0)
+        , colorTexture(0)
+        , program(0)
+        , vertexArray(0)
+        , vertexBuffer(0)
+        , transformLocation(-1)
+    {
+    }
+
+    const char *VertexThroughputBenchmark::getName(void) const
+    {
+        return "vertex_throughput";
+    }
+
+    const char *VertexThroughputBenchmark::getUnit(void) const
+    {
+        return "vertices";
+    }
+
+    bool VertexThroughputBenchmark::setUp(void)
+    {
+        framebuffer = createFramebuffer(GL_RGBA8, smallTargetSize, smallTargetSize, &colorTexture);
+
+        Shader::processProgramSource(&program, vertexThroughputVertexShaderSource, constantFragmentShaderSource);
+        transformLocation = glGetUniformLocation(program, "transform");
+
+        /* The three corners of every triangle are the same point, spread over the framebuffer. */
+        vector<GLfloat> positions(4 * vertexCount);
+        unsigned int state = 1;
+        for (int triangle = 0; triangle < vertexCount / 3; triangle++)
+        {
+            GLfloat x = (nextRandom(&state) % 2000) / 1000.0f - 1.0f;
+            GLfloat y = (nextRandom(&state) % 2000) / 1000.0f - 1.0f;
+
+            for (int corner = 0; corner < 3; corner++)
+            {
+                GLfloat *position = &positions[4 * (3 * triangle + corner)];
+                position[0] = x;
+                position[1] = y;
+                position[2] = 0.0f;
+                position[3] = 1.0f;
+            }
+        }
+
+        GL_CHECK(glGenVertexArrays(1, &vertexArray));
+        GL_CHECK(glGenBuffers(1, &vertexBuffer));
+        GL_CHECK(glBindVertexArray(vertexArray));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(GLfloat), &positions[0], GL_STATIC_DRAW));
+        GL_CHECK(glEnableVertexAttribArray(0));
+        GL_CHECK(glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0));
+        GL_CHECK(glBindVertexArray(0));
+
+        return framebuffer != 0;
+    }
+
+    double VertexThroughputBenchmark::renderFrame(void)
+    {
+        /* Not the identity, so the transform cannot be optimised out. */
+        static const GLfloat transform[16] =
+        {
+            0.9f, 0.1f, 0.0f, 0.0f,
+           -0.1f, 0.9f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f
+        };
+        const int drawnVertices = vertexCount / 3 * 3;
+
+        bindFramebuffer(framebuffer, smallTargetSize);
+
+        GL_CHECK(glUseProgram(program));
+        GL_CHECK(glUniformMatrix4fv(transformLocation, 1, GL_FALSE, transform));
+        GL_CHECK(glBindVertexArray(vertexArray));
+
+        for (int i = 0; i < drawsPerFrame; i++)
+        {
+            GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, drawnVertices));
+        }
+
+        GL_CHECK(glBindVertexArray(0));
+
+        return (double)drawsPerFrame * drawnVertices;
+    }
+
+    void VertexThroughputBenchmark::tearDown(void)
+    {
+        GL_CHECK(glDeleteBuffers(1, &vertexBuffer));
+        GL_CHECK(glDeleteVertexArrays(1, &vertexArray));
+        GL_CHECK(glDeleteProgram(program));
+        GL_CHECK(glDeleteFramebuffers(1, &framebuffer));
+        GL_CHECK(glDeleteTextures(1, &colorTexture));
+
+        vertexBuffer = 0;
+        vertexArray = 0;
+        program = 0;
+        framebuffer = 0;
+        colorTexture = 0;
+    }
+
+    FillRateBenchmark::FillRateBenchmark(GLenum internalFormat, const char *formatName, bool blend)
+        : internalFormat(internalFormat)
+        , blend(blend)
+        , framebuffer(0)
+        , colorTexture(0)
+        , program(0)
+        , vertexArray(0)
+    {
+        snprintf(name, sizeof(name), "fill_%s_%s", formatName, blend ? "blend" : "opaque");
+    }
+
+    const char *FillRateBenchmark::getName(void) const
+    {
+        return name;
+    }
+
+    const char *FillRateBenchmark::getUnit(void) const
+    {
+        return "pixels";
+    }
+
+    bool FillRateBenchmark::setUp(void)
+    {
+        if (!isColorRenderable(internalFormat))
+        {
+            return false;
+        }
+
+        framebuffer = createFramebuffer(internalFormat, targetSize, targetSize, &colorTexture);
+        if (framebuffer == 0)
+        {
+            return false;
+        }
+
+        Shader::processProgramSource(&program, fullScreenVertexShaderSource, fillFragmentShaderSource);
+        GL_CHECK(glUseProgram(program));
+        GL_CHECK(glUniform1f(glGetUniformLocation(program, "discardBelow"), neverDiscardBelow));
+
+        /* The triangle has no attributes, but a vertex array has to be bound to draw. */
+        GL_CHECK(glGenVertexArrays(1, &vertexArray));
+
+        return true;
+    }
+
+    double FillRateBenchmark::renderFrame(void)
+    {
+        bindFramebuffer(framebuffer, targetSize);
+
+        if (blend)
+        {
+            GL_CHECK(glEnable(GL_BLEND));
+            GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+        }
+
+        GL_CHECK(glUseProgram(program));
+        GL_CHECK(glBindVertexArray(vertexArray));
+
+        for (int layer = 0; layer < layersPerFrame; layer++)
+        {
+            GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+        }
+
+        GL_CHECK(glBindVertexArray(0));
+        GL_CHECK(glDisable(GL_BLEND));
+
+        return (double)layersPerFrame * targetSize * targetSize;
+    }
+
+    void FillRateBenchmark::tearDown(void)
+    {
+        GL_CHECK(glDeleteVertexArrays(1, &vertexArray));
+        GL_CHECK(glDeleteProgram(program));
+        GL_CHECK(glDeleteFramebuffers(1, &framebuffer));
+        GL_CHECK(glDeleteTextures(1, &colorTexture));
+
+        vertexArray = 0;
+        program = 0;
+        framebuffer = 0;
+        colorTexture = 0;
+    }
+
+    TextureSamplingBenchmark::TextureSamplingBenchmark(GLenum internalFormat, const char *formatName)
+        : internalFormat(internalFormat)
+        , framebuffer(0)
+        , colorTexture(0)
+        , program(0)
+        , vertexArray(0)
+        , texture(0)
+    {
+        snprintf(name, sizeof(name), "sampling_%s", formatName);
+    }
+
+    const char *TextureSamplingBenchmark::getName(void) const
+    {
+        return name;
+    }
+
+    const char *TextureSamplingBenchmark::getUnit(void) const
+    {
+        return "samples";
+    }
+
+    bool TextureSamplingBenchmark::setUp(void)
+    {
+        int blockSize = 4;
+        int bytesPerBlock = 16;
+        bool astc = false;
+
+        switch (internalFormat)
+        {
+            case GL_RGBA8:
+                break;
+            case GL_COMPRESSED_RGB8_ETC2:
+                bytesPerBlock = 8;
+                break;
+            case GL_COMPRESSED_RGBA8_ETC2_EAC:
+                break;
+            case GL_COMPRESSED_RGBA_ASTC_4x4_KHR:
+                astc = true;
+                break;
+            case GL_COMPRESSED_RGBA_ASTC_8x8_KHR:
+                blockSize = 8;
+                astc = true;
+                break;
+            default:
+                return false;
+        }
+
+        if (astc && !GLExtensions::isSupported("GL_KHR_texture_compression_astc_ldr"))
+        {
+            return false;
+        }
+
+        framebuffer = createFramebuffer(GL_RGBA8, targetSize, targetSize, &colorTexture);
+        if (framebuffer == 0)
+        {
+            return false;
+        }
+
+        GL_CHECK(glGenTextures(1, &texture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, textureSize, textureSize));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+
+        if (internalFormat == GL_RGBA8)
+        {
+            vector<unsigned char> texels(4 * textureSize * textureSize);
+            fillRandom(texels, 1);
+            GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureSize, textureSize, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0]));
+        }
+        else
+        {
+            /* Every bit pattern is a valid ETC2 or EAC block, ASTC blocks need a valid header. */
+            int blocks = (textureSize / blockSize) * (textureSize / blockSize);
+            vector<unsigned char> data(blocks * bytesPerBlock);
+
+            if (astc)
+            {
+                unsigned int state = 1;
+                for (int block = 0; block < blocks; block++)
+                {
+                    encodeAstcBlock(&data[block * bytesPerBlock], &state);
+                }
+            }
+            else
+            {
+                fillRandom(data, 1);
+            }
+
+            GL_CHECK(glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureSize, textureSize, internalFormat, data.size(), &data[0]));
+        }
+
+        Shader::processProgramSource(&program, fullScreenVertexShaderSource, samplingFragmentShaderSource);
+        GL_CHECK(glUseProgram(program));
+        GL_CHECK(glUniform1i(glGetUniformLocation(program, "tex"), 0));
+        GL_CHECK(glUniform1f(glGetUniformLocation(program, "discardBelow"), neverDiscardBelow));
+        GL_CHECK(glUniform2f(glGetUniformLocation(program, "halfTexel"), 0.5f / textureSize, 0.5f / textureSize));
+
+        GL_CHECK(glGenVertexArrays(1, &vertexArray));
+
+        return true;
+    }
+
+    double TextureSamplingBenchmark::renderFrame(void)
+    {
+        bindFramebuffer(framebuffer, targetSize);
+
+        GL_CHECK(glUseProgram(program));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+        GL_CHECK(glBindVertexArray(vertexArray));
+
+        for (int layer = 0; layer < layersPerFrame; layer++)
+        {
+            GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+        }
+
+        GL_CHECK(glBindVertexArray(0));
+
+        return (double)layersPerFrame * samplesPerFragment * targetSize * targetSize;
+    }
+
+    void TextureSamplingBenchmark::tearDown(void)
+    {
+        GL_CHECK(glDeleteVertexArrays(1, &vertexArray));
+        GL_CHECK(glDeleteProgram(program));
+        GL_CHECK(glDeleteTextures(1, &texture));
+        GL_CHECK(glDeleteFramebuffers(1, &framebuffer));
+        GL_CHECK(glDeleteTextures(1, &colorTexture));
+
+        vertexArray = 0;
+        program = 0;
+        texture = 0;
+        framebuffer = 0;
+        colorTexture = 0;
+    }
+
+    double MicroBenchmarkSuite::Result::getRate(void) const
+    {
+        return seconds > 0.0 ? units / seconds : 0.0;
+    }
+
+    MicroBenchmarkSuite::MicroBenchmarkSuite(int warmupFrames, int measuredFrames)
+        : warmupFrames(warmupFrames)
+        , measuredFrames(measuredFrames > 0 ? measuredFrames : 1)
+        , current(0)
+        , frame(0)
+    {
+    }
+
+    MicroBenchmarkSuite::~MicroBenchmarkSuite(void)
+    {
+        /* Objects of the case which was running when the suite was stopped. */
+        if (current < benchmarks.size() && frame > 0)
+        {
+            benchmarks[current]->tearDown();
+        }
+
+        for (size_t i = 0; i < benchmarks.size(); i++)
+        {
+            delete benchmarks[i];
+        }
+    }
+
+    void MicroBenchmarkSuite::add(MicroBenchmark *benchmark)
+    {
+        Result result = { false, false, 0, 0.0, 0.0 };
+
+        benchmarks.push_back(benchmark);
+        results.push_back(result);
+    }
+
+    void MicroBenchmarkSuite::addDefaultBenchmarks(void)
+    {
+        add(new DrawCallBenchmark(DrawCallBenchmark::NoChange));
+        add(new DrawCallBenchmark(DrawCallBenchmark::ProgramChange));
+        add(new DrawCallBenchmark(DrawCallBenchmark::TextureChange));
+        add(new DrawCallBenchmark(DrawCallBenchmark::VertexArrayChange));
+        add(new DrawCallBenchmark(DrawCallBenchmark::UniformBufferRangeChange));
+
+        add(new VertexThroughputBenchmark());
+
+        static const struct
+        {
+            GLenum internalFormat;
+            const char *name;
+        } fillFormats[] =
+        {
+            { GL_RGBA8, "rgba8" },
+            { GL_RGB565, "rgb565" },
+            { GL_RGB10_A2, "rgb10_a2" },
+            { GL_RGBA16F, "rgba16f" },
+            { GL_R11F_G11F_B10F, "r11f_g11f_b10f" },
+        };
+
+        for (size_t i = 0; i < sizeof(fillFormats) / sizeof(fillFormats[0]); i++)
+        {
+            add(new FillRateBenchmark(fillFormats[i].internalFormat, fillFormats[i].name, false));
+            add(new FillRateBenchmark(fillFormats[i].internalFormat, fillFormats[i].name, true));
+        }
+
+        add(new TextureSamplingBenchmark(GL_RGBA8, "rgba8"));
+        add(new TextureSamplingBenchmark(GL_COMPRESSED_RGB8_ETC2, "etc2_rgb8"));
+        add(new TextureSamplingBenchmark(GL_COMPRESSED_RGBA8_ETC2_EAC, "etc2_eac_rgba8"));
+        add(new TextureSamplingBenchmark(GL_COMPRESSED_RGBA_ASTC_4x4_KHR, "astc_4x4"));
+        add(new TextureSamplingBenchmark(GL_COMPRESSED_RGBA_ASTC_8x8_KHR, "astc_8x8"));
+    }
+
+    void MicroBenchmarkSuite::step(void)
+    {
+        if (current >= benchmarks.size())
+        {
+            return;
+        }
+
+        MicroBenchmark *benchmark = benchmarks[current];
+        Result &result = results[current];
+
+        if (frame == 0)
+        {
+            result.supported = benchmark->setUp();
+            if (!result.supported)
+            {
+                LOGI("%s: not supported.\n", benchmark->getName());
+                benchmark->tearDown();
+                result.finished = true;
+                current++;
+                return;
+            }
+        }
+
+        static Timer timer(Timer::RealClock);
+
+        /* Nothing queued before, such as what was drawn since the last step, is counted. */
+        GL_CHECK(glFinish());
+        long long start = timer.getTimeNanoseconds();
+
+        double units = benchmark->renderFrame();
+
+        GL_CHECK(glFinish());
+        long long end = timer.getTimeNanoseconds();
+
+        if (frame >= warmupFrames)
+        {
+            result.frames++;
+            result.units += units;
+            result.seconds += (end - start) * 1.0e-9;
+        }
+
+        frame++;
+        if (frame == warmupFrames + measuredFrames)
+        {
+            benchmark->tearDown();
+            result.finished = true;
+            LOGI("%s: %.3f M%s/s\n", benchmark->getName(), result.getRate() * 1.0e-6, benchmark->getUnit());
+
+            current++;
+            frame = 0;
+        }
+    }
+
+    bool MicroBenchmarkSuite::isFinished(void) const
+    {
+        return current >= benchmarks.size();
+    }
+
+    size_t MicroBenchmarkSuite::getCurrent(void) const
+    {
+        return current;
+    }
+
+    size_t MicroBenchmarkSuite::getCount(void) const
+    {
+        return benchmarks.size();
+    }
+
+    const MicroBenchmark *MicroBenchmarkSuite::getBenchmark(size_t index) const
+    {
+        return benchmarks[index];
+    }
+
+    const MicroBenchmarkSuite::Result &MicroBenchmarkSuite::getResult(size_t index) const
+    {
+        return results[index];
+    }
+
+    int MicroBenchmarkSuite::getWarmupFrames(void) const
+    {
+        return warmupFrames;
+    }
+
+    int MicroBenchmarkSuite::getMeasuredFrames(void) const
+    {
+        return measuredFrames;
+    }
+}
@@ -0,0 +1,451 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "MipmapGenerator.h"
+#include "Platform.h"
+#include "Shader.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace MaliSDK
+{
+    /* Texels of the new level along a side of the tile a compute work group makes. */
+    static const int groupSize = 8;
+
+    /* Levels a box filter dispatch makes, one image uniform each. OpenGL ES 3.1 guarantees 4 of them. */
+    static const int maxLevelsPerDispatch = 4;
+
+    /*
+     * Fetching, colour space conversion and filtering, shared by the compute and fragment shaders.
+     * Texels outside the level repeat the edge, as GL_CLAMP_TO_EDGE would.
+     */
+    static const char *filterSource =
+        "precision highp float;\n"
+        "precision highp int;\n"
+        "precision highp sampler2D;\n"
+        "uniform sampler2D source;\n"
+        "uniform ivec2 sourceSize;\n"
+        "uniform int sourceLevel;\n"
+        "#if KAISER\n"
+        "uniform float kaiserWeights[3];\n"
+        "#endif\n"
+        "vec4 fetch(ivec2 texel)\n"
+        "{\n"
+        "    vec4 color = texelFetch(source, clamp(texel, ivec2(0), sourceSize - 1), sourceLevel);\n"
+        "#if SRGB\n"
+        "    color.rgb = mix(color.rgb / 12.92, pow((color.rgb + 0.055) / 1.055, vec3(2.4)), step(vec3(0.04045), color.rgb));\n"
+        "#endif\n"
+        "    return color;\n"
+        "}\n"
+        "vec4 encode(vec4 color)\n"
+        "{\n"
+        "#if SRGB\n"
+        "    color.rgb = clamp(color.rgb, 0.0, 1.0);\n"
+        "    color.rgb = mix(color.rgb * 12.92, 1.055 * pow(color.rgb, vec3(1.0 / 2.4)) - 0.055, step(vec3(0.0031308), color.rgb));\n"
+        "#endif\n"
+        "    return color;\n"
+        "}\n"
+        /* The 2 by 2 texels of the source under a texel of the new level start at twice its coordinates. */
+        "vec4 downsample(ivec2 texel)\n"
+        "{\n"
+        "    ivec2 corner = texel * 2;\n"
+        "#if KAISER\n"
+        "    float weights[6] = float[6](kaiserWeights[2], kaiserWeights[1], kaiserWeights[0], kaiserWeights[0], kaiserWeights[1], kaiserWeights[2]);\n"
+        "    vec4 color = vec4(0.0);\n"
+        "    for (int y = 0; y < 6; y++)\n"
+        "    {\n"
+        "        vec4 row = vec4(0.0);\n"
+        "        for (int x = 0; x < 6; x++)\n"
+        "        {\n"
+        "            row += weights[x] * fetch(corner + ivec2(x - 2, y - 2));\n"
+        "        }\n"
+        "        color += weights[y] * row;\n"
+        "    }\n"
+        "    return color;\n"
+        "#else\n"
+        "    return 0.25 * (fetch(corner) + fetch(corner + ivec2(1, 0)) + fetch(corner + ivec2(0, 1)) + fetch(corner + ivec2(1, 1)));\n"
+        "#endif\n"
+        "}\n";
+
+    /*
+     * The first level is filtered from the source, the next ones from the tile the group keeps in shared memory.
+     * barrier() cannot be in a loop in OpenGL ES 3.1, so the reductions are written out, see getComputeProgram().
+     */
+    static const char *computeSource =
+        "layout(local_size_x = 8, local_size_y = 8) in;\n"
+        "shared vec4 tile[64];\n"
+        "vec4 reduce(ivec2 local, int width, ivec2 previousSize)\n"
+        "{\n"
+        "    ivec2 corner = local * 2;\n"
+        /* The last row and column of odd sizes are left out, except for levels 1 texel wide. */
+        "    ivec2 far = corner + ivec2(lessThan(ivec2(gl_WorkGroupID.xy) * width * 2 + corner + 1, previousSize));\n"
+        "    return 0.25 * (tile[corner.y * 8 + corner.x] + tile[corner.y * 8 + far.x] + tile[far.y * 8 + corner.x] + tile[far.y * 8 + far.x]);\n"
+        "}\n"
+        "void main()\n"
+        "{\n"
+        "    ivec2 local = ivec2(gl_LocalInvocationID.xy);\n"
+        "    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);\n"
+        "    ivec2 size = max(sourceSize / 2, ivec2(1));\n"
+        "    vec4 color = downsample(texel);\n"
+        "    bool active = true;\n"
+        "    if (all(lessThan(texel, size)))\n"
+        "    {\n"
+        "        imageStore(level0, texel, encode(color));\n"
+        "    }\n"
+        "    tile[local.y * 8 + local.x] = color;\n"
+        "REDUCTIONS"
+        "}\n";
+
+    /* One reduction in shared memory, LEVEL and WIDTH replaced by getComputeProgram(). */
+    static const char *reductionSource =
+        "    memoryBarrierShared();\n"
+        "    barrier();\n"
+        "    active = all(lessThan(local, ivec2(WIDTH)));\n"
+        "    if (active)\n"
+        "    {\n"
+        "        color = reduce(local, WIDTH, size);\n"
+        "    }\n"
+        "    size = max(size / 2, ivec2(1));\n"
+        "    texel = ivec2(gl_WorkGroupID.xy) * WIDTH + local;\n"
+        "    if (active && all(lessThan(texel, size)))\n"
+        "    {\n"
+        "        imageStore(levelLEVEL, texel, encode(color));\n"
+        "    }\n"
+        "    barrier();\n"
+        "    if (active)\n"
+        "    {\n"
+        "        tile[local.y * 8 + local.x] = color;\n"
+        "    }\n";
+
+    /* A triangle covering the viewport, without vertex buffers. */
+    static const char *vertexShaderSource =
+        "#version 300 es\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 position = vec2(float((gl_VertexID & 1) * 4 - 1), float((gl_VertexID & 2) * 2 - 1));\n"
+        "    gl_Position = vec4(position, 0.0, 1.0);\n"
+        "}\n";
+
+    static const char *fragmentSource =
+        "out vec4 fragmentColor;\n"
+        "void main()\n"
+        "{\n"
+        "    fragmentColor = encode(downsample(ivec2(gl_FragCoord.xy)));\n"
+        "}\n";
+
+    /* The layout qualifier of the formats compute shaders can write, NULL for the others. */
+    static const char *getImageFormat(GLenum internalFormat)
+    {
+        switch (internalFormat)
+        {
+            case GL_RGBA8: return "rgba8";
+            case GL_RGBA8_SNORM: return "rgba8_snorm";
+            case GL_RGBA16F: return "rgba16f";
+            case GL_RGBA32F: return "rgba32f";
+            case GL_R32F: return "r32f";
+            default: return NULL;
+        }
+    }
+
+    static std::string replaceAll(std::string text, const std::string &from, const std::string &to)
+    {
+        for (size_t position = text.find(from); position != std::string::npos; position = text.find(from, position + to.size()))
+        {
+            text.replace(position, from.size(), to);
+        }
+        return text;
+    }
+
+    static std::string getDefines(MipmapGenerator::Filter filter, bool srgb)
+    {
+        std::string defines = filter == MipmapGenerator::Kaiser ? "#define KAISER 1\n" : "#define KAISER 0\n";
+        defines += srgb ? "#define SRGB 1\n" : "#define SRGB 0\n";
+        return defines;
+    }
+
+    /* Modified Bessel function of the first kind, order 0, from its series. */
+    static double besselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 25; k++)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    MipmapGenerator::MipmapGenerator(void)
+        : computeSupported(false),
+          framebuffer(0),
+          vertexArray(0)
+    {
+        GLint majorVersion = 0;
+        GLint minorVersion = 0;
+
+        glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+        glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+        glGetError();
+        computeSupported = majorVersion > 3 || (majorVersion == 3 && minorVersion >= 1);
+
+        /*
+         * sinc(x) windowed by Kaiser with alpha 4, over 3 texels of the new level. The taps are source texel
+         * centres, a quarter, three quarters and five quarters of a new texel away from the one being made.
+         */
+        const double alpha = 4.0;
+        const double halfWidth = 1.5;
+        const double pi = 3.14159265358979323846;
+        double sum = 0.0;
+        double weights[3];
+        for (int tap = 0; tap < 3; tap++)
+        {
+            double x = (2 * tap + 1) * 0.25;
+            double ratio = x / halfWidth;
+            double sinc = sin(pi * x) / (pi * x);
+            weights[tap] = sinc * besselI0(alpha * sqrt(1.0 - ratio * ratio)) / besselI0(alpha);
+            sum += 2.0 * weights[tap];
+        }
+        for (int tap = 0; tap < 3; tap++)
+        {
+            kaiserWeights[tap] = (float)(weights[tap] / sum);
+        }
+
+        GL_CHECK(glGenFramebuffers(1, &framebuffer));
+
+        /* No attributes, but a vertex array of its own keeps the sample's enabled arrays out of the draws. */
+        GL_CHECK(glGenVertexArrays(1, &vertexArray));
+    }
+
+    MipmapGenerator::~MipmapGenerator(void)
+    {
+        for (std::map<unsigned int, Program>::iterator program = computePrograms.begin(); program != computePrograms.end(); ++program)
+        {
+            GL_CHECK(glDeleteProgram(program->second.program));
+        }
+        for (std::map<unsigned int, Program>::iterator program = fragmentPrograms.begin(); program != fragmentPrograms.end(); ++program)
+        {
+            GL_CHECK(glDeleteProgram(program->second.program));
+        }
+        GL_CHECK(glDeleteVertexArrays(1, &vertexArray));
+        GL_CHECK(glDeleteFramebuffers(1, &framebuffer));
+    }
+
+    MipmapGenerator::Program MipmapGenerator::linkProgram(GLuint program, Filter filter)
+    {
+        Program linked;
+        linked.program = program;
+        linked.sourceSizeLocation = GL_CHECK(glGetUniformLocation(program, "sourceSize"));
+        linked.sourceLevelLocation = GL_CHECK(glGetUniformLocation(program, "sourceLevel"));
+
+        GL_CHECK(glUseProgram(program));
+        GL_CHECK(glUniform1i(glGetUniformLocation(program, "source"), 0));
+        if (filter == Kaiser)
+        {
+            GL_CHECK(glUniform1fv(glGetUniformLocation(program, "kaiserWeights"), 3, kaiserWeights));
+        }
+
+        return linked;
+    }
+
+    const MipmapGenerator::Program &MipmapGenerator::getComputeProgram(Filter filter, GLenum internalFormat, bool srgb, int levels)
+    {
+        unsigned int key = (internalFormat << 8) | (levels << 2) | (srgb ? 2 : 0) | (filter == Kaiser ? 1 : 0);
+        std::map<unsigned int, Program>::iterator found = computePrograms.find(key);
+        if (found != computePrograms.end())
+        {
+            return found->second;
+        }
+
+        std::string source = "#version 310 es\n" + getDefines(filter, srgb) + filterSource;
+        for (int level = 0; level < levels; level++)
+        {
+            char image[128];
+            sprintf(image, "layout(%s, binding = %d) writeonly uniform highp image2D level%d;\n", getImageFormat(internalFormat), level, level);
+            source += image;
+        }
+
+        std::string reductions;
+        for (int level = 1; level < levels; level++)
+        {
+            char width[16];
+            char index[16];
+            sprintf(width, "%d", groupSize >> level);
+            sprintf(index, "%d", level);
+            reductions += replaceAll(replaceAll(reductionSource, "WIDTH", width), "LEVEL", index);
+        }
+        source += replaceAll(computeSource, "REDUCTIONS", reductions);
+
+        GLuint program = 0;
+        Shader::processComputeProgramSource(&program, source.c_str());
+        return computePrograms[key] = linkProgram(program, filter);
+    }
+
+    const MipmapGenerator::Program &MipmapGenerator::getFragmentProgram(Filter filter, bool srgb)
+    {
+        unsigned int key = (srgb ? 2 : 0) | (filter == Kaiser ? 1 : 0);
+        std::map<unsigned int, Program>::iterator found = fragmentPrograms.find(key);
+        if (found != fragmentPrograms.end())
+        {
+            return found->second;
+        }
+
+        std::string source = "#version 300 es\n" + getDefines(filter, srgb) + filterSource + fragmentSource;
+
+        GLuint program = 0;
+        Shader::processProgramSource(&program, vertexShaderSource, source.c_str());
+        return fragmentPrograms[key] = linkProgram(program, filter);
+    }
+
+    void MipmapGenerator::generateWithCompute(GLuint texture, GLenum internalFormat, GLsizei width, GLsizei height, GLint levels, Filter filter, bool srgb)
+    {
+        /* Image units need the levels they write between the base and maximum levels. */
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1));
+
+        int levelsPerDispatch = filter == Kaiser ? 1 : maxLevelsPerDispatch;
+        for (GLint sourceLevel = 0; sourceLevel < levels - 1; )
+        {
+            int dispatchLevels = levels - 1 - sourceLevel < levelsPerDispatch ? levels - 1 - sourceLevel : levelsPerDispatch;
+            const Program &program = getComputeProgram(filter, internalFormat, srgb, dispatchLevels);
+
+            GLsizei sourceWidth = width >> sourceLevel > 0 ? width >> sourceLevel : 1;
+            GLsizei sourceHeight = height >> sourceLevel > 0 ? height >> sourceLevel : 1;
+            GLsizei levelWidth = sourceWidth / 2 > 0 ? sourceWidth / 2 : 1;
+            GLsizei levelHeight = sourceHeight / 2 > 0 ? sourceHeight / 2 : 1;
+
+            GL_CHECK(glUseProgram(program.program));
+            GL_CHECK(glUniform2i(program.sourceSizeLocation, sourceWidth, sourceHeight));
+            GL_CHECK(glUniform1i(program.sourceLevelLocation, sourceLevel));
+            for (int level = 0; level < dispatchLevels; level++)
+            {
+                GL_CHECK(glBindImageTexture(level, texture, sourceLevel + 1 + level, GL_FALSE, 0, GL_WRITE_ONLY, internalFormat));
+            }
+            GL_CHECK(glDispatchCompute((levelWidth + groupSize - 1) / groupSize, (levelHeight + groupSize - 1) / groupSize, 1));
+
+            /* The next dispatch fetches the last level this one wrote. */
+            GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
+            sourceLevel += dispatchLevels;
+        }
+
+        /* Later passes may also render to the levels or update them. */
+        GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT));
+    }
+
+    bool MipmapGenerator::generateWithFragment(GLuint texture, GLsizei width, GLsizei height, GLint levels, Filter filter, bool srgb)
+    {
+        /* Every texel of the levels is written, their previous contents don't need to be loaded. */
+        static const GLenum colorAttachment[] = { GL_COLOR_ATTACHMENT0 };
+
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        for (GLint level = 1; level < levels; level++)
+        {
+            GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, level));
+            if (level == 1)
+            {
+                GLenum status = GL_CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER));
+                if (status != GL_FRAMEBUFFER_COMPLETE)
+                {
+                    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0));
+                    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+                    return false;
+                }
+
+                GL_CHECK(glDisable(GL_DEPTH_TEST));
+                GL_CHECK(glDisable(GL_BLEND));
+                GL_CHECK(glDisable(GL_SCISSOR_TEST));
+                GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+                GL_CHECK(glBindVertexArray(vertexArray));
+            }
+
+            /* Only the level above is sampled, which keeps the level drawn into out of a feedback loop. */
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1));
+
+            GLsizei sourceWidth = width >> (level - 1) > 0 ? width >> (level - 1) : 1;
+            GLsizei sourceHeight = height >> (level - 1) > 0 ? height >> (level - 1) : 1;
+            GLsizei levelWidth = sourceWidth / 2 > 0 ? sourceWidth / 2 : 1;
+            GLsizei levelHeight = sourceHeight / 2 > 0 ? sourceHeight / 2 : 1;
+
+            const Program &program = getFragmentProgram(filter, srgb);
+            GL_CHECK(glUseProgram(program.program));
+            GL_CHECK(glUniform2i(program.sourceSizeLocation, sourceWidth, sourceHeight));
+            GL_CHECK(glUniform1i(program.sourceLevelLocation, 0));
+
+            GL_CHECK(glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, colorAttachment));
+            GL_CHECK(glViewport(0, 0, levelWidth, levelHeight));
+            GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+        }
+
+        GL_CHECK(glBindVertexArray(0));
+        GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        return true;
+    }
+
+    MipmapGenerator::Path MipmapGenerator::generate(GLuint texture, GLenum internalFormat, GLsizei width, GLsizei height, Filter filter, bool srgb)
+    {
+        GLint immutable = GL_FALSE;
+        GLint levels = 0;
+        GLint baseLevel = 0;
+        GLint maxLevel = 0;
+
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+        GL_CHECK(glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable));
+
+        /* The levels of textures from glTexImage2D() may not exist yet, only the driver can allocate them. */
+        if (!immutable)
+        {
+            GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
+            return Driver;
+        }
+
+        GL_CHECK(glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_LEVELS, &levels));
+        GL_CHECK(glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, &baseLevel));
+        GL_CHECK(glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel));
+
+        /* The hardware decodes and encodes sRGB formats itself. */
+        bool srgbFormat = internalFormat == GL_SRGB8_ALPHA8 || internalFormat == GL_SRGB8;
+        bool convert = srgb && !srgbFormat;
+
+        Path path = Driver;
+        if (computeSupported && getImageFormat(internalFormat) != NULL)
+        {
+            generateWithCompute(texture, internalFormat, width, height, levels, filter, convert);
+            path = Compute;
+        }
+        else if (generateWithFragment(texture, width, height, levels, filter, convert))
+        {
+            path = Fragment;
+        }
+        else
+        {
+            GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
+        }
+
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel));
+
+        return path;
+    }
+}
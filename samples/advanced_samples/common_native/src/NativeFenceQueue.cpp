@@ -0,0 +1,335 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "NativeFenceQueue.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+
+#include <GLES3/gl3.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+
+/* EGL_ANDROID_native_fence_sync, missing from older headers. */
+#ifndef EGL_SYNC_NATIVE_FENCE_ANDROID
+#define EGL_SYNC_NATIVE_FENCE_ANDROID 0x3144
+#endif
+#ifndef EGL_SYNC_NATIVE_FENCE_FD_ANDROID
+#define EGL_SYNC_NATIVE_FENCE_FD_ANDROID 0x3145
+#endif
+#ifndef EGL_NO_NATIVE_FENCE_FD_ANDROID
+#define EGL_NO_NATIVE_FENCE_FD_ANDROID -1
+#endif
+
+namespace MaliSDK
+{
+    typedef EGLSyncKHR (EGLAPIENTRYP CreateSyncFunction)(EGLDisplay display, EGLenum type, const EGLint *attributes);
+    typedef EGLBoolean (EGLAPIENTRYP DestroySyncFunction)(EGLDisplay display, EGLSyncKHR sync);
+    typedef EGLint (EGLAPIENTRYP WaitSyncFunction)(EGLDisplay display, EGLSyncKHR sync, EGLint flags);
+    typedef EGLint (EGLAPIENTRYP DupNativeFenceFDFunction)(EGLDisplay display, EGLSyncKHR sync);
+
+    static CreateSyncFunction createSync = NULL;
+    static DestroySyncFunction destroySync = NULL;
+    static WaitSyncFunction waitSync = NULL;
+    static DupNativeFenceFDFunction dupNativeFenceFD = NULL;
+    static pthread_once_t functionLookUp = PTHREAD_ONCE_INIT;
+
+    /* The entry points do not depend on the context, so they are looked up once for all threads. */
+    static void lookUpFunctionsOnce(void)
+    {
+        createSync = (CreateSyncFunction)eglGetProcAddress("eglCreateSyncKHR");
+        destroySync = (DestroySyncFunction)eglGetProcAddress("eglDestroySyncKHR");
+        waitSync = (WaitSyncFunction)eglGetProcAddress("eglWaitSyncKHR");
+        dupNativeFenceFD = (DupNativeFenceFDFunction)eglGetProcAddress("eglDupNativeFenceFDANDROID");
+    }
+
+    static bool hasFunctions(void)
+    {
+        pthread_once(&functionLookUp, lookUpFunctionsOnce);
+
+        return createSync != NULL && destroySync != NULL && waitSync != NULL && dupNativeFenceFD != NULL;
+    }
+
+    /* Monotonic time, comparable between the threads. */
+    static long long getTimeNanoseconds(void)
+    {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        return now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
+
+    bool NativeFenceQueue::isSupported(void)
+    {
+        const char *eglExtensions = eglQueryString(eglGetCurrentDisplay(), EGL_EXTENSIONS);
+
+        if (!GLExtensions::isInList(eglExtensions, "EGL_ANDROID_native_fence_sync") ||
+            !GLExtensions::isInList(eglExtensions, "EGL_KHR_wait_sync"))
+        {
+            return false;
+        }
+
+        return hasFunctions();
+    }
+
+    int NativeFenceQueue::createFence(void)
+    {
+        EGLDisplay display = eglGetCurrentDisplay();
+        EGLSyncKHR sync = EGL_NO_SYNC_KHR;
+
+        if (hasFunctions())
+        {
+            const EGLint attributes[] = { EGL_SYNC_NATIVE_FENCE_FD_ANDROID, EGL_NO_NATIVE_FENCE_FD_ANDROID, EGL_NONE };
+            sync = createSync(display, EGL_SYNC_NATIVE_FENCE_ANDROID, attributes);
+        }
+
+        if (sync == EGL_NO_SYNC_KHR)
+        {
+            LOGE("Could not create a native fence: 0x%x\n", eglGetError());
+            GL_CHECK(glFinish());
+            return -1;
+        }
+
+        /* The fence only gets a file descriptor once it has been flushed. */
+        GL_CHECK(glFlush());
+        int fence = dupNativeFenceFD(display, sync);
+        destroySync(display, sync);
+
+        if (fence == EGL_NO_NATIVE_FENCE_FD_ANDROID)
+        {
+            LOGE("Could not get a native fence: 0x%x\n", eglGetError());
+            GL_CHECK(glFinish());
+            return -1;
+        }
+
+        return fence;
+    }
+
+    void NativeFenceQueue::waitFence(int fence)
+    {
+        if (fence < 0)
+        {
+            return;
+        }
+
+        EGLDisplay display = eglGetCurrentDisplay();
+        EGLSyncKHR sync = EGL_NO_SYNC_KHR;
+
+        /* The sync object takes over the file descriptor. */
+        if (hasFunctions())
+        {
+            const EGLint attributes[] = { EGL_SYNC_NATIVE_FENCE_FD_ANDROID, fence, EGL_NONE };
+            sync = createSync(display, EGL_SYNC_NATIVE_FENCE_ANDROID, attributes);
+        }
+
+        if (sync == EGL_NO_SYNC_KHR)
+        {
+            /* Native fences become readable once signalled, so wait for it on the CPU instead. */
+            LOGE("Could not import a native fence: 0x%x\n", eglGetError());
+
+            pollfd signalled = { fence, POLLIN, 0 };
+            poll(&signalled, 1, -1);
+            close(fence);
+            return;
+        }
+
+        waitSync(display, sync, 0);
+        destroySync(display, sync);
+    }
+
+    NativeFenceQueue::NativeFenceQueue(int numberOfSlots)
+        : display(eglGetCurrentDisplay()),
+          slots(numberOfSlots > 0 ? numberOfSlots : 1),
+          droppedFrames(0)
+    {
+        if (!isSupported())
+        {
+            LOGE("Native fences are not supported.\n");
+            exit(1);
+        }
+
+        pthread_mutex_init(&mutex, NULL);
+
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            slots[i].state = SLOT_FREE;
+            slots[i].fence = -1;
+            slots[i].queueTime = 0;
+        }
+    }
+
+    NativeFenceQueue::~NativeFenceQueue(void)
+    {
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            if (slots[i].fence >= 0)
+            {
+                close(slots[i].fence);
+            }
+        }
+
+        pthread_mutex_destroy(&mutex);
+    }
+
+    int NativeFenceQueue::dequeue(int *releaseFence)
+    {
+        int slot = -1;
+        int oldestQueued = -1;
+
+        pthread_mutex_lock(&mutex);
+        for (int i = 0; i < (int)slots.size() && slot < 0; i++)
+        {
+            if (slots[i].state == SLOT_FREE)
+            {
+                slot = i;
+            }
+            else if (slots[i].state == SLOT_QUEUED && (oldestQueued < 0 || slots[i].queueTime < slots[oldestQueued].queueTime))
+            {
+                oldestQueued = i;
+            }
+        }
+
+        /* The fence of a queued slot is the one of the producer, so waiting for it again costs next to nothing. */
+        if (slot < 0 && oldestQueued >= 0)
+        {
+            slot = oldestQueued;
+            droppedFrames++;
+        }
+
+        int fence = -1;
+        if (slot >= 0)
+        {
+            fence = slots[slot].fence;
+            slots[slot].fence = -1;
+            slots[slot].state = SLOT_DEQUEUED;
+        }
+        pthread_mutex_unlock(&mutex);
+
+        if (releaseFence != NULL)
+        {
+            *releaseFence = fence;
+        }
+        else
+        {
+            waitFence(fence);
+        }
+
+        return slot;
+    }
+
+    void NativeFenceQueue::queue(int slot, int acquireFence)
+    {
+        /* Created outside of the lock, as it flushes. */
+        int fence = acquireFence >= 0 ? acquireFence : createFence();
+        long long now = getTimeNanoseconds();
+
+        pthread_mutex_lock(&mutex);
+        int oldFence = slots[slot].fence;
+        slots[slot].fence = fence;
+        slots[slot].queueTime = now;
+        slots[slot].state = SLOT_QUEUED;
+        pthread_mutex_unlock(&mutex);
+
+        if (oldFence >= 0)
+        {
+            close(oldFence);
+        }
+    }
+
+    int NativeFenceQueue::acquire(void)
+    {
+        int slot = -1;
+
+        pthread_mutex_lock(&mutex);
+        for (int i = 0; i < (int)slots.size(); i++)
+        {
+            if (slots[i].state == SLOT_QUEUED && (slot < 0 || slots[i].queueTime > slots[slot].queueTime))
+            {
+                slot = i;
+            }
+        }
+
+        /* Older frames are never going to be shown. Their fences stay, the producer waits for them on reuse. */
+        for (int i = 0; i < (int)slots.size(); i++)
+        {
+            if (slots[i].state == SLOT_QUEUED && i != slot)
+            {
+                slots[i].state = SLOT_FREE;
+                droppedFrames++;
+            }
+        }
+
+        int fence = -1;
+        long long queueTime = 0;
+        if (slot >= 0)
+        {
+            fence = slots[slot].fence;
+            queueTime = slots[slot].queueTime;
+            slots[slot].fence = -1;
+            slots[slot].state = SLOT_ACQUIRED;
+        }
+        pthread_mutex_unlock(&mutex);
+
+        if (slot >= 0)
+        {
+            latencyStatistics.addFrameTime((getTimeNanoseconds() - queueTime) / 1000000.0f);
+            waitFence(fence);
+        }
+
+        return slot;
+    }
+
+    void NativeFenceQueue::release(int slot, int releaseFence)
+    {
+        int fence = releaseFence >= 0 ? releaseFence : createFence();
+
+        pthread_mutex_lock(&mutex);
+        int oldFence = slots[slot].fence;
+        slots[slot].fence = fence;
+        slots[slot].state = SLOT_FREE;
+        pthread_mutex_unlock(&mutex);
+
+        if (oldFence >= 0)
+        {
+            close(oldFence);
+        }
+    }
+
+    int NativeFenceQueue::getNumberOfSlots(void) const
+    {
+        return (int)slots.size();
+    }
+
+    int NativeFenceQueue::getNumberOfDroppedFrames(void)
+    {
+        pthread_mutex_lock(&mutex);
+        int frames = droppedFrames;
+        pthread_mutex_unlock(&mutex);
+
+        return frames;
+    }
+
+    FrameStatistics &NativeFenceQueue::getLatencyStatistics(void)
+    {
+        return latencyStatistics;
+    }
+}
@@ -0,0 +1,159 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "OcclusionQueryScheduler.h"
+#include "Platform.h"
+
+namespace MaliSDK
+{
+    /* Queries generated at once when the pool runs dry. */
+    static const int queryPoolGrowth = 32;
+
+    OcclusionQueryScheduler::OcclusionQueryScheduler(int numberOfObjects, unsigned int latency)
+        : objects(numberOfObjects),
+          latency(latency > 0 ? latency : 1),
+          frame(0),
+          activeObject(-1)
+    {
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            objects[i].visible = true;
+        }
+    }
+
+    OcclusionQueryScheduler::~OcclusionQueryScheduler(void)
+    {
+        if (!allQueries.empty())
+        {
+            GL_CHECK(glDeleteQueries((GLsizei)allQueries.size(), &allQueries[0]));
+        }
+    }
+
+    GLuint OcclusionQueryScheduler::acquireQuery(void)
+    {
+        if (freeQueries.empty())
+        {
+            GLuint queries[queryPoolGrowth];
+            GL_CHECK(glGenQueries(queryPoolGrowth, queries));
+            for (int i = queryPoolGrowth - 1; i >= 0; i--)
+            {
+                freeQueries.push_back(queries[i]);
+                allQueries.push_back(queries[i]);
+            }
+        }
+
+        GLuint query = freeQueries.back();
+        freeQueries.pop_back();
+        return query;
+    }
+
+    void OcclusionQueryScheduler::beginFrame(void)
+    {
+        frame++;
+
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            std::vector<PendingQuery> &pending = objects[i].pending;
+            size_t collected = 0;
+
+            /* Results complete in order, so stop at the first one that is not ready. */
+            while (collected < pending.size() && frame - pending[collected].frame >= latency)
+            {
+                GLuint available = GL_FALSE;
+                GL_CHECK(glGetQueryObjectuiv(pending[collected].query, GL_QUERY_RESULT_AVAILABLE, &available));
+                if (!available)
+                {
+                    break;
+                }
+
+                GLuint anySamplesPassed = GL_TRUE;
+                GL_CHECK(glGetQueryObjectuiv(pending[collected].query, GL_QUERY_RESULT, &anySamplesPassed));
+                objects[i].visible = anySamplesPassed != GL_FALSE;
+
+                freeQueries.push_back(pending[collected].query);
+                collected++;
+            }
+
+            pending.erase(pending.begin(), pending.begin() + collected);
+        }
+    }
+
+    bool OcclusionQueryScheduler::canQuery(int object) const
+    {
+        return objects[object].pending.size() < latency;
+    }
+
+    void OcclusionQueryScheduler::beginQuery(int object)
+    {
+        if (activeObject >= 0)
+        {
+            LOGE("Occlusion queries cannot nest, end the query of object %d first.", activeObject);
+            return;
+        }
+
+        PendingQuery pendingQuery;
+        pendingQuery.query = acquireQuery();
+        pendingQuery.frame = frame;
+        objects[object].pending.push_back(pendingQuery);
+
+        GL_CHECK(glBeginQuery(GL_ANY_SAMPLES_PASSED, pendingQuery.query));
+        activeObject = object;
+    }
+
+    void OcclusionQueryScheduler::endQuery(void)
+    {
+        if (activeObject < 0)
+        {
+            return;
+        }
+
+        GL_CHECK(glEndQuery(GL_ANY_SAMPLES_PASSED));
+        activeObject = -1;
+    }
+
+    bool OcclusionQueryScheduler::isVisible(int object) const
+    {
+        return objects[object].visible;
+    }
+
+    void OcclusionQueryScheduler::reset(void)
+    {
+        /* A query object can start a new query before the result of its previous one was read. */
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            for (size_t p = 0; p < objects[i].pending.size(); p++)
+            {
+                freeQueries.push_back(objects[i].pending[p].query);
+            }
+            objects[i].pending.clear();
+            objects[i].visible = true;
+        }
+    }
+
+    int OcclusionQueryScheduler::getNumberOfPendingQueries(void) const
+    {
+        return (int)(allQueries.size() - freeQueries.size());
+    }
+
+    int OcclusionQueryScheduler::getPoolSize(void) const
+    {
+        return (int)allQueries.size();
+    }
+}
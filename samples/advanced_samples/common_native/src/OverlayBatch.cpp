@@ -0,0 +1,353 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "OverlayBatch.h"
+#include "Shader.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace MaliSDK
+{
+    static const char *vertexShaderSource =
+        "#version 300 es\n"
+        "uniform mat4 u_m4Projection;\n"
+        "layout(location = 0) in vec2 a_v2Position;\n"
+        "layout(location = 1) in vec3 a_v3TexCoord;\n"
+        "layout(location = 2) in vec4 a_v4Color;\n"
+        "layout(location = 3) in vec2 a_v2Shading;\n"
+        "out vec3 v_v3TexCoord;\n"
+        "out vec4 v_v4Color;\n"
+        "flat out int v_iShading;\n"
+        "out float v_fSmoothing;\n"
+        "void main()\n"
+        "{\n"
+        "    v_v3TexCoord = a_v3TexCoord;\n"
+        "    v_v4Color = a_v4Color;\n"
+        "    v_iShading = int(a_v2Shading.x + 0.5);\n"
+        "    v_fSmoothing = a_v2Shading.y;\n"
+        "    gl_Position = u_m4Projection * vec4(a_v2Position, 0.0, 1.0);\n"
+        "}\n";
+
+    /*
+     * Both textures are sampled whatever the shading, so the samples stay out of control flow.
+     * A sampler without a texture bound reads black, which the shading then ignores.
+     */
+    static const char *fragmentShaderSource =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D u_s2dTexture;\n"
+        "uniform mediump sampler2DArray u_s2dArrayTexture;\n"
+        "in vec3 v_v3TexCoord;\n"
+        "in vec4 v_v4Color;\n"
+        "flat in int v_iShading;\n"
+        "in float v_fSmoothing;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    vec4 texel = texture(u_s2dTexture, v_v3TexCoord.xy);\n"
+        "    vec4 arrayTexel = texture(u_s2dArrayTexture, v_v3TexCoord);\n"
+        "    float coverage = smoothstep(0.5 - v_fSmoothing, 0.5 + v_fSmoothing, texel.a);\n"
+        "    if (v_iShading == 1)\n"
+        "        fragColor = v_v4Color * texel;\n"
+        "    else if (v_iShading == 2)\n"
+        "        fragColor = v_v4Color * arrayTexel;\n"
+        "    else if (v_iShading == 3)\n"
+        "        fragColor = vec4(v_v4Color.rgb, v_v4Color.a * coverage);\n"
+        "    else\n"
+        "        fragColor = v_v4Color;\n"
+        "}\n";
+
+    /* The indices are 16 bit, 4 vertices per quad. */
+    static const int quadLimit = 65536 / 4;
+
+    static int limitNumberOfQuads(int numberOfQuads)
+    {
+        return numberOfQuads < quadLimit ? numberOfQuads : quadLimit;
+    }
+
+    static GLubyte toByte(int value)
+    {
+        return (GLubyte)(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    /* Corners of an axis aligned rectangle, in the order addQuad() takes them. */
+    static void setRectangle(OverlayBatch::Vertex vertices[4], float x, float y, float width, float height,
+                             float uMin, float vMin, float uMax, float vMax, float layer,
+                             OverlayBatch::Shading shading, int red, int green, int blue, int alpha)
+    {
+        const float positions[4][2] = { { x, y }, { x + width, y }, { x, y + height }, { x + width, y + height } };
+        const float texCoords[4][2] = { { uMin, vMin }, { uMax, vMin }, { uMin, vMax }, { uMax, vMax } };
+
+        for (int corner = 0; corner < 4; corner++)
+        {
+            OverlayBatch::Vertex &vertex = vertices[corner];
+            vertex.position[0] = positions[corner][0];
+            vertex.position[1] = positions[corner][1];
+            vertex.texCoord[0] = texCoords[corner][0];
+            vertex.texCoord[1] = texCoords[corner][1];
+            vertex.texCoord[2] = layer;
+            vertex.color[0] = toByte(red);
+            vertex.color[1] = toByte(green);
+            vertex.color[2] = toByte(blue);
+            vertex.color[3] = toByte(alpha);
+            vertex.shading = (GLfloat)shading;
+            vertex.smoothing = 0.0f;
+        }
+    }
+
+    bool OverlayBatch::SortKey::operator<(const SortKey &other) const
+    {
+        if (layer != other.layer)
+        {
+            return layer < other.layer;
+        }
+        if (texture != other.texture)
+        {
+            return texture < other.texture;
+        }
+        if (arrayTexture != other.arrayTexture)
+        {
+            return arrayTexture < other.arrayTexture;
+        }
+        return index < other.index;
+    }
+
+    OverlayBatch::OverlayBatch(int windowWidth, int windowHeight, int maximumNumberOfQuads)
+        : maximumNumberOfQuads(limitNumberOfQuads(maximumNumberOfQuads)),
+          vertexBuffer(GL_ARRAY_BUFFER, limitNumberOfQuads(maximumNumberOfQuads) * 4 * sizeof(Vertex)),
+          indexBuffer(0),
+          vertexArray(0),
+          programID(0),
+          iLocProjection(-1),
+          numberOfDrawCalls(0),
+          droppedQuads(0)
+    {
+        projectionMatrix = Matrix::matrixOrthographic(0, (float)windowWidth, 0, (float)windowHeight, 0, 1);
+
+        Shader::processProgramSource(&programID, vertexShaderSource, fragmentShaderSource);
+        iLocProjection = GL_CHECK(glGetUniformLocation(programID, "u_m4Projection"));
+
+        GL_CHECK(glUseProgram(programID));
+        GL_CHECK(glUniform1i(glGetUniformLocation(programID, "u_s2dTexture"), 0));
+        GL_CHECK(glUniform1i(glGetUniformLocation(programID, "u_s2dArrayTexture"), 1));
+        GL_CHECK(glUniformMatrix4fv(iLocProjection, 1, GL_FALSE, projectionMatrix.getAsArray()));
+
+        /* Two triangles per quad. Each draw starts at a quad, so one index buffer serves every draw of the frame. */
+        std::vector<GLushort> indices(this->maximumNumberOfQuads * 6);
+        for (int quad = 0; quad < this->maximumNumberOfQuads; quad++)
+        {
+            GLushort firstVertex = (GLushort)(quad * 4);
+            GLushort *index = &indices[quad * 6];
+
+            index[0] = firstVertex;
+            index[1] = firstVertex + 1;
+            index[2] = firstVertex + 2;
+            index[3] = firstVertex + 2;
+            index[4] = firstVertex + 1;
+            index[5] = firstVertex + 3;
+        }
+
+        GL_CHECK(glGenVertexArrays(1, &vertexArray));
+        GL_CHECK(glBindVertexArray(vertexArray));
+
+        GL_CHECK(glGenBuffers(1, &indexBuffer));
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+        GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), &indices[0], GL_STATIC_DRAW));
+
+        for (GLuint attribute = 0; attribute < 4; attribute++)
+        {
+            GL_CHECK(glEnableVertexAttribArray(attribute));
+        }
+
+        /* The element array binding is part of the vertex array, unbind that first. */
+        GL_CHECK(glBindVertexArray(0));
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    }
+
+    OverlayBatch::~OverlayBatch(void)
+    {
+        GL_CHECK(glDeleteProgram(programID));
+        GL_CHECK(glDeleteVertexArrays(1, &vertexArray));
+        GL_CHECK(glDeleteBuffers(1, &indexBuffer));
+    }
+
+    void OverlayBatch::clear(void)
+    {
+        quads.clear();
+    }
+
+    void OverlayBatch::addQuad(int layer, GLuint texture, GLuint arrayTexture, const Vertex vertices[4])
+    {
+        if ((int)quads.size() >= maximumNumberOfQuads)
+        {
+            droppedQuads++;
+            return;
+        }
+
+        quads.push_back(Quad());
+        Quad &quad = quads.back();
+        quad.layer = layer;
+        quad.texture = texture;
+        quad.arrayTexture = arrayTexture;
+        std::copy(vertices, vertices + 4, quad.vertices);
+    }
+
+    void OverlayBatch::addRectangle(int layer, float x, float y, float width, float height, int red, int green, int blue, int alpha)
+    {
+        Vertex vertices[4];
+        setRectangle(vertices, x, y, width, height, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, SHADING_SOLID, red, green, blue, alpha);
+        addQuad(layer, 0, 0, vertices);
+    }
+
+    void OverlayBatch::addSprite(int layer, GLuint texture, float uMin, float vMin, float uMax, float vMax,
+                                 float x, float y, float width, float height,
+                                 int red, int green, int blue, int alpha)
+    {
+        Vertex vertices[4];
+        setRectangle(vertices, x, y, width, height, uMin, vMin, uMax, vMax, 0.0f, SHADING_TEXTURE, red, green, blue, alpha);
+        addQuad(layer, texture, 0, vertices);
+    }
+
+    void OverlayBatch::addSprite(int layer, GLuint arrayTexture, const TextureAtlas::Region &region,
+                                 float x, float y, float width, float height,
+                                 int red, int green, int blue, int alpha)
+    {
+        /* The region's top left corner goes to the top left, which is the high Y of the rectangle. */
+        Vertex vertices[4];
+        setRectangle(vertices, x, y, width, height, region.uMin, region.vMax, region.uMax, region.vMin,
+                     (float)region.layer, SHADING_ARRAY_TEXTURE, red, green, blue, alpha);
+        addQuad(layer, 0, arrayTexture, vertices);
+    }
+
+    void OverlayBatch::setVertexOffset(GLintptr offset)
+    {
+        const GLsizei stride = sizeof(Vertex);
+
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer.getBuffer()));
+        GL_CHECK(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (const void *)(offset + offsetof(Vertex, position))));
+        GL_CHECK(glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (const void *)(offset + offsetof(Vertex, texCoord))));
+        GL_CHECK(glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (const void *)(offset + offsetof(Vertex, color))));
+        GL_CHECK(glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, (const void *)(offset + offsetof(Vertex, shading))));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+
+    void OverlayBatch::draw(void)
+    {
+        numberOfDrawCalls = 0;
+        if (quads.empty())
+        {
+            return;
+        }
+
+        keys.resize(quads.size());
+        for (size_t quad = 0; quad < quads.size(); quad++)
+        {
+            keys[quad].layer = quads[quad].layer;
+            keys[quad].texture = quads[quad].texture;
+            keys[quad].arrayTexture = quads[quad].arrayTexture;
+            keys[quad].index = (unsigned int)quad;
+        }
+        std::sort(keys.begin(), keys.end());
+
+        vertexBuffer.beginFrame();
+        GLintptr offset = 0;
+        Vertex *vertices = static_cast<Vertex *>(vertexBuffer.map(quads.size() * 4 * sizeof(Vertex), &offset));
+        if (vertices == NULL)
+        {
+            vertexBuffer.endFrame();
+            return;
+        }
+
+        for (size_t key = 0; key < keys.size(); key++)
+        {
+            std::copy(quads[keys[key].index].vertices, quads[keys[key].index].vertices + 4, &vertices[key * 4]);
+        }
+        vertexBuffer.unmap();
+
+        GL_CHECK(glUseProgram(programID));
+        GL_CHECK(glBindVertexArray(vertexArray));
+        setVertexOffset(offset);
+
+        GLboolean depthTest = GL_CHECK(glIsEnabled(GL_DEPTH_TEST));
+        GL_CHECK(glDisable(GL_DEPTH_TEST));
+        GL_CHECK(glEnable(GL_BLEND));
+        GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+        /*
+         * Quads without a texture of one kind don't care which is bound, so a run only ends when a quad needs
+         * another texture than the one the run has bound. The sort puts quads of the same textures next to each other.
+         */
+        size_t first = 0;
+        while (first < keys.size())
+        {
+            GLuint texture = keys[first].texture;
+            GLuint arrayTexture = keys[first].arrayTexture;
+            size_t end = first + 1;
+
+            while (end < keys.size())
+            {
+                const SortKey &next = keys[end];
+                if ((next.texture != 0 && texture != 0 && next.texture != texture) ||
+                    (next.arrayTexture != 0 && arrayTexture != 0 && next.arrayTexture != arrayTexture))
+                {
+                    break;
+                }
+
+                texture = texture != 0 ? texture : next.texture;
+                arrayTexture = arrayTexture != 0 ? arrayTexture : next.arrayTexture;
+                end++;
+            }
+
+            GL_CHECK(glActiveTexture(GL_TEXTURE0));
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+            GL_CHECK(glActiveTexture(GL_TEXTURE1));
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, arrayTexture));
+
+            GL_CHECK(glDrawElements(GL_TRIANGLES, (GLsizei)((end - first) * 6), GL_UNSIGNED_SHORT,
+                                    (const void *)(first * 6 * sizeof(GLushort))));
+            numberOfDrawCalls++;
+            first = end;
+        }
+
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+        GL_CHECK(glDisable(GL_BLEND));
+        if (depthTest)
+        {
+            GL_CHECK(glEnable(GL_DEPTH_TEST));
+        }
+        GL_CHECK(glBindVertexArray(0));
+
+        vertexBuffer.endFrame();
+    }
+
+    int OverlayBatch::getNumberOfDrawCalls(void) const
+    {
+        return numberOfDrawCalls;
+    }
+
+    int OverlayBatch::getDroppedQuads(void) const
+    {
+        return droppedQuads;
+    }
+}
@@ -0,0 +1,166 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PartialUpdate.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+
+#include <cstring>
+
+#ifndef EGL_BUFFER_AGE_KHR
+#define EGL_BUFFER_AGE_KHR 0x313D
+#endif
+
+namespace MaliSDK
+{
+    /* Grow rectangle (x, y, width, height) to contain another one, empty rectangles have a width of 0. */
+    static void unionRectangle(EGLint *rectangle, const EGLint *other)
+    {
+        if (other[2] <= 0 || other[3] <= 0)
+        {
+            return;
+        }
+
+        if (rectangle[2] <= 0 || rectangle[3] <= 0)
+        {
+            memcpy(rectangle, other, 4 * sizeof(EGLint));
+            return;
+        }
+
+        EGLint left = rectangle[0] < other[0] ? rectangle[0] : other[0];
+        EGLint bottom = rectangle[1] < other[1] ? rectangle[1] : other[1];
+        EGLint right = rectangle[0] + rectangle[2] > other[0] + other[2] ? rectangle[0] + rectangle[2] : other[0] + other[2];
+        EGLint top = rectangle[1] + rectangle[3] > other[1] + other[3] ? rectangle[1] + rectangle[3] : other[1] + other[3];
+
+        rectangle[0] = left;
+        rectangle[1] = bottom;
+        rectangle[2] = right - left;
+        rectangle[3] = top - bottom;
+    }
+
+    PartialUpdate::PartialUpdate(void)
+        : display(eglGetCurrentDisplay()),
+          surface(eglGetCurrentSurface(EGL_DRAW)),
+          setDamageRegion(NULL),
+          swapBuffersWithDamage(NULL),
+          surfaceWidth(0),
+          surfaceHeight(0)
+    {
+        memset(damage, 0, sizeof(damage));
+        memset(region, 0, sizeof(region));
+
+        if (GLExtensions::isEGLSupported(display, "EGL_KHR_partial_update"))
+        {
+            setDamageRegion = (SetDamageRegionFunction)eglGetProcAddress("eglSetDamageRegionKHR");
+        }
+
+        if (GLExtensions::isEGLSupported(display, "EGL_KHR_swap_buffers_with_damage"))
+        {
+            swapBuffersWithDamage = (SwapBuffersWithDamageFunction)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+        }
+        else if (GLExtensions::isEGLSupported(display, "EGL_EXT_swap_buffers_with_damage"))
+        {
+            swapBuffersWithDamage = (SwapBuffersWithDamageFunction)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+        }
+
+        LOGI("PartialUpdate: partial update %s, swap with damage %s.\n",
+             setDamageRegion != NULL ? "supported" : "not supported",
+             swapBuffersWithDamage != NULL ? "supported" : "not supported");
+
+        addFullDamage();
+    }
+
+    bool PartialUpdate::isSupported(void) const
+    {
+        return setDamageRegion != NULL;
+    }
+
+    void PartialUpdate::addDamage(EGLint x, EGLint y, EGLint width, EGLint height)
+    {
+        const EGLint rectangle[4] = { x, y, width, height };
+
+        unionRectangle(damage[0], rectangle);
+    }
+
+    void PartialUpdate::addFullDamage(void)
+    {
+        eglQuerySurface(display, surface, EGL_WIDTH, &surfaceWidth);
+        eglQuerySurface(display, surface, EGL_HEIGHT, &surfaceHeight);
+
+        addDamage(0, 0, surfaceWidth, surfaceHeight);
+    }
+
+    void PartialUpdate::beginFrame(EGLint *x, EGLint *y, EGLint *width, EGLint *height)
+    {
+        EGLint bufferAge = 0;
+
+        if (setDamageRegion != NULL)
+        {
+            /* Querying the age is needed before setting the damage region. */
+            if (!eglQuerySurface(display, surface, EGL_BUFFER_AGE_KHR, &bufferAge))
+            {
+                bufferAge = 0;
+            }
+        }
+
+        /* An age of 0 means the content is undefined, n is the frame presented n swaps ago. */
+        if (bufferAge <= 0 || bufferAge > maximumBufferAge)
+        {
+            region[0] = 0;
+            region[1] = 0;
+            region[2] = surfaceWidth;
+            region[3] = surfaceHeight;
+        }
+        else
+        {
+            memcpy(region, damage[0], sizeof(region));
+
+            for (int age = 1; age < bufferAge; age++)
+            {
+                unionRectangle(region, damage[age]);
+            }
+        }
+
+        if (setDamageRegion != NULL)
+        {
+            setDamageRegion(display, surface, region, region[2] > 0 && region[3] > 0 ? 1 : 0);
+        }
+
+        *x = region[0];
+        *y = region[1];
+        *width = region[2];
+        *height = region[3];
+
+        /* Start the damage of the next frame. */
+        memmove(damage[1], damage[0], (maximumBufferAge - 1) * sizeof(damage[0]));
+        memset(damage[0], 0, sizeof(damage[0]));
+    }
+
+    EGLBoolean PartialUpdate::swapBuffers(void)
+    {
+        /* The frame's own damage is what changed on screen, it moved to damage[1] in beginFrame(). */
+        if (swapBuffersWithDamage != NULL && damage[1][2] > 0 && damage[1][3] > 0)
+        {
+            return swapBuffersWithDamage(display, surface, damage[1], 1);
+        }
+
+        return eglSwapBuffers(display, surface);
+    }
+}
@@ -0,0 +1,120 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PoolAllocator.h"
+#include "Platform.h"
+
+#include <cstdlib>
+
+namespace MaliSDK
+{
+    PoolAllocator::PoolAllocator(size_t blockSize, size_t blocksPerChunk)
+        : blockSize((blockSize + defaultAlignment - 1) / defaultAlignment * defaultAlignment),
+          blocksPerChunk(blocksPerChunk > 0 ? blocksPerChunk : 1),
+          freeList(NULL),
+          numberOfAllocatedBlocks(0)
+    {
+        /* Free blocks store the next free block in their first bytes. */
+        if (this->blockSize < sizeof(void *))
+        {
+            this->blockSize = sizeof(void *);
+        }
+    }
+
+    PoolAllocator::~PoolAllocator(void)
+    {
+        if (numberOfAllocatedBlocks > 0)
+        {
+            LOGI("Pool allocator destroyed with %u blocks still allocated.", (unsigned int)numberOfAllocatedBlocks);
+        }
+
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            free(chunks[i]);
+        }
+    }
+
+    void PoolAllocator::addChunk(void)
+    {
+        void *chunk = NULL;
+        if (posix_memalign(&chunk, defaultAlignment, blockSize * blocksPerChunk) != 0)
+        {
+            LOGE("Could not allocate a chunk of %u blocks of %u bytes.", (unsigned int)blocksPerChunk, (unsigned int)blockSize);
+            return;
+        }
+
+        unsigned char *blocks = (unsigned char *)chunk;
+        chunks.push_back(blocks);
+
+        /* Thread the new blocks onto the free list, in address order. */
+        for (size_t i = blocksPerChunk; i > 0; i--)
+        {
+            void *block = blocks + (i - 1) * blockSize;
+            *(void **)block = freeList;
+            freeList = block;
+        }
+    }
+
+    void *PoolAllocator::allocate(size_t size, size_t alignment)
+    {
+        if (size > blockSize || alignment > defaultAlignment)
+        {
+            LOGE("Pool allocator cannot serve %u bytes aligned to %u, its blocks are %u bytes.",
+                 (unsigned int)size, (unsigned int)alignment, (unsigned int)blockSize);
+            return NULL;
+        }
+
+        if (freeList == NULL)
+        {
+            addChunk();
+            if (freeList == NULL)
+            {
+                return NULL;
+            }
+        }
+
+        void *block = freeList;
+        freeList = *(void **)block;
+        numberOfAllocatedBlocks++;
+        return block;
+    }
+
+    void PoolAllocator::deallocate(void *pointer)
+    {
+        if (pointer == NULL)
+        {
+            return;
+        }
+
+        *(void **)pointer = freeList;
+        freeList = pointer;
+        numberOfAllocatedBlocks--;
+    }
+
+    size_t PoolAllocator::getBlockSize(void) const
+    {
+        return blockSize;
+    }
+
+    size_t PoolAllocator::getNumberOfAllocatedBlocks(void) const
+    {
+        return numberOfAllocatedBlocks;
+    }
+}
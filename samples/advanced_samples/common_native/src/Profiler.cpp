@@ -0,0 +1,366 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Profiler.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+#include "Timer.h"
+
+#include <EGL/egl.h>
+#include <pthread.h>
+#include <cstdio>
+#include <cstring>
+
+#if defined(ANDROID)
+#include <dlfcn.h>
+#endif
+
+/* GL_EXT_disjoint_timer_query, not part of the core headers. */
+#ifndef GL_QUERY_COUNTER_BITS_EXT
+#define GL_QUERY_COUNTER_BITS_EXT 0x8864
+#endif
+#ifndef GL_QUERY_RESULT_EXT
+#define GL_QUERY_RESULT_EXT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE_EXT
+#define GL_QUERY_RESULT_AVAILABLE_EXT 0x8867
+#endif
+#ifndef GL_TIMESTAMP_EXT
+#define GL_TIMESTAMP_EXT 0x8E28
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+namespace MaliSDK
+{
+    typedef void (GL_APIENTRYP PFNGLGENQUERIESEXTPROC_LOCAL)(GLsizei n, GLuint *ids);
+    typedef void (GL_APIENTRYP PFNGLDELETEQUERIESEXTPROC_LOCAL)(GLsizei n, const GLuint *ids);
+    typedef void (GL_APIENTRYP PFNGLQUERYCOUNTEREXTPROC_LOCAL)(GLuint id, GLenum target);
+    typedef void (GL_APIENTRYP PFNGLGETQUERYIVEXTPROC_LOCAL)(GLenum target, GLenum pname, GLint *params);
+    typedef void (GL_APIENTRYP PFNGLGETQUERYOBJECTUIVEXTPROC_LOCAL)(GLuint id, GLenum pname, GLuint *params);
+    typedef void (GL_APIENTRYP PFNGLGETQUERYOBJECTUI64VEXTPROC_LOCAL)(GLuint id, GLenum pname, khronos_uint64_t *params);
+
+    static PFNGLGENQUERIESEXTPROC_LOCAL genQueries = NULL;
+    static PFNGLDELETEQUERIESEXTPROC_LOCAL deleteQueries = NULL;
+    static PFNGLQUERYCOUNTEREXTPROC_LOCAL queryCounter = NULL;
+    static PFNGLGETQUERYOBJECTUIVEXTPROC_LOCAL getQueryObjectuiv = NULL;
+    static PFNGLGETQUERYOBJECTUI64VEXTPROC_LOCAL getQueryObjectui64v = NULL;
+
+    /* ATrace is looked up at run time, ATrace_setCounter() only exists from API level 29. */
+    typedef void (*ATraceBeginSectionFunction)(const char *name);
+    typedef void (*ATraceEndSectionFunction)(void);
+    typedef void (*ATraceSetCounterFunction)(const char *name, long long value);
+    typedef bool (*ATraceIsEnabledFunction)(void);
+
+    static ATraceBeginSectionFunction traceBeginSection = NULL;
+    static ATraceEndSectionFunction traceEndSection = NULL;
+    static ATraceSetCounterFunction traceSetCounter = NULL;
+    static ATraceIsEnabledFunction traceIsEnabled = NULL;
+    static pthread_once_t traceLookUp = PTHREAD_ONCE_INIT;
+
+    static Timer cpuTimer(Timer::RealClock);
+
+    bool Profiler::gpuSupported = false;
+    std::vector<Profiler::OpenScope> Profiler::openScopes;
+    std::vector<Profiler::PendingScope> Profiler::pendingScopes;
+    std::vector<GLuint> Profiler::freeQueries;
+    std::map<std::string, Profiler::Statistic> Profiler::statistics;
+
+    static void lookUpTraceOnce(void)
+    {
+#if defined(ANDROID)
+        void *library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+        if (library != NULL)
+        {
+            traceBeginSection = (ATraceBeginSectionFunction)dlsym(library, "ATrace_beginSection");
+            traceEndSection = (ATraceEndSectionFunction)dlsym(library, "ATrace_endSection");
+            traceSetCounter = (ATraceSetCounterFunction)dlsym(library, "ATrace_setCounter");
+            traceIsEnabled = (ATraceIsEnabledFunction)dlsym(library, "ATrace_isEnabled");
+        }
+
+        if (traceBeginSection == NULL || traceEndSection == NULL)
+        {
+            traceBeginSection = NULL;
+            traceEndSection = NULL;
+        }
+#endif
+    }
+
+    /* Once for all threads, trace sections can be opened from any of them. */
+    static void lookUpTrace(void)
+    {
+        pthread_once(&traceLookUp, lookUpTraceOnce);
+    }
+
+    void Profiler::initialize(void)
+    {
+        lookUpTrace();
+
+        gpuSupported = false;
+        if (GLExtensions::isSupported("GL_EXT_disjoint_timer_query"))
+        {
+            PFNGLGETQUERYIVEXTPROC_LOCAL getQueryiv = (PFNGLGETQUERYIVEXTPROC_LOCAL)eglGetProcAddress("glGetQueryivEXT");
+
+            genQueries = (PFNGLGENQUERIESEXTPROC_LOCAL)eglGetProcAddress("glGenQueriesEXT");
+            deleteQueries = (PFNGLDELETEQUERIESEXTPROC_LOCAL)eglGetProcAddress("glDeleteQueriesEXT");
+            queryCounter = (PFNGLQUERYCOUNTEREXTPROC_LOCAL)eglGetProcAddress("glQueryCounterEXT");
+            getQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVEXTPROC_LOCAL)eglGetProcAddress("glGetQueryObjectuivEXT");
+            getQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC_LOCAL)eglGetProcAddress("glGetQueryObjectui64vEXT");
+
+            /* The extension allows timestamps with 0 bits, meaning only time elapsed queries work. */
+            GLint timestampBits = 0;
+            if (getQueryiv != NULL)
+            {
+                getQueryiv(GL_TIMESTAMP_EXT, GL_QUERY_COUNTER_BITS_EXT, &timestampBits);
+            }
+
+            gpuSupported = timestampBits > 0 && genQueries != NULL && deleteQueries != NULL && queryCounter != NULL &&
+                           getQueryObjectuiv != NULL && getQueryObjectui64v != NULL;
+        }
+
+        /* Clear a stale disjoint flag. */
+        if (gpuSupported)
+        {
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        }
+
+        LOGI("Profiler: GPU timestamps %s, ATrace %s.\n", gpuSupported ? "supported" : "not supported",
+             traceBeginSection != NULL ? "supported" : "not supported");
+    }
+
+    void Profiler::terminate(void)
+    {
+        if (gpuSupported)
+        {
+            for (size_t scopeIndex = 0; scopeIndex < pendingScopes.size(); scopeIndex++)
+            {
+                freeQueries.push_back(pendingScopes[scopeIndex].gpuBegin);
+                freeQueries.push_back(pendingScopes[scopeIndex].gpuEnd);
+            }
+
+            if (!freeQueries.empty())
+            {
+                deleteQueries((GLsizei)freeQueries.size(), &freeQueries[0]);
+            }
+        }
+
+        gpuSupported = false;
+        openScopes.clear();
+        pendingScopes.clear();
+        freeQueries.clear();
+        statistics.clear();
+    }
+
+    GLuint Profiler::getQuery(void)
+    {
+        GLuint query;
+
+        if (freeQueries.empty())
+        {
+            genQueries(1, &query);
+        }
+        else
+        {
+            query = freeQueries.back();
+            freeQueries.pop_back();
+        }
+
+        return query;
+    }
+
+    void Profiler::beginScope(const char *name)
+    {
+        lookUpTrace();
+
+        if (traceBeginSection != NULL)
+        {
+            traceBeginSection(name);
+        }
+
+        OpenScope scope;
+        scope.name = name;
+        scope.gpuBegin = 0;
+
+        if (gpuSupported)
+        {
+            scope.gpuBegin = getQuery();
+            queryCounter(scope.gpuBegin, GL_TIMESTAMP_EXT);
+        }
+
+        /* Read the clock last, so the scope does not include its own overhead. */
+        scope.cpuBegin = cpuTimer.getTimeNanoseconds();
+        openScopes.push_back(scope);
+    }
+
+    void Profiler::endScope(void)
+    {
+        long long cpuEnd = cpuTimer.getTimeNanoseconds();
+
+        if (openScopes.empty())
+        {
+            LOGE("Profiler::endScope() without an open scope.\n");
+            return;
+        }
+
+        OpenScope scope = openScopes.back();
+        openScopes.pop_back();
+
+        Statistic &statistic = statistics[scope.name];
+        statistic.cpuTotal += (cpuEnd - scope.cpuBegin) / 1000000.0;
+        statistic.cpuCount++;
+
+        if (scope.gpuBegin != 0)
+        {
+            PendingScope pending;
+            pending.name = scope.name;
+            pending.gpuBegin = scope.gpuBegin;
+            pending.gpuEnd = getQuery();
+            queryCounter(pending.gpuEnd, GL_TIMESTAMP_EXT);
+            pendingScopes.push_back(pending);
+        }
+
+        if (traceEndSection != NULL)
+        {
+            traceEndSection();
+        }
+    }
+
+    void Profiler::beginTraceSection(const char *name)
+    {
+        lookUpTrace();
+
+        if (traceBeginSection != NULL)
+        {
+            traceBeginSection(name);
+        }
+    }
+
+    void Profiler::endTraceSection(void)
+    {
+        if (traceEndSection != NULL)
+        {
+            traceEndSection();
+        }
+    }
+
+    void Profiler::collectGPUResults(void)
+    {
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+        bool tracing = traceSetCounter != NULL && (traceIsEnabled == NULL || traceIsEnabled());
+        size_t collected = 0;
+
+        /* Queries complete in order, stop at the first one which is not available yet. */
+        while (collected < pendingScopes.size())
+        {
+            const PendingScope &pending = pendingScopes[collected];
+            GLuint available = 0;
+
+            getQueryObjectuiv(pending.gpuEnd, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+            if (!available)
+            {
+                break;
+            }
+
+            /* A disjoint operation (frequency change, power event) makes all the results in flight meaningless. */
+            if (!disjoint)
+            {
+                khronos_uint64_t begin = 0;
+                khronos_uint64_t end = 0;
+
+                getQueryObjectui64v(pending.gpuBegin, GL_QUERY_RESULT_EXT, &begin);
+                getQueryObjectui64v(pending.gpuEnd, GL_QUERY_RESULT_EXT, &end);
+
+                Statistic &statistic = statistics[pending.name];
+                statistic.gpuTotal += (end - begin) / 1000000.0;
+                statistic.gpuCount++;
+
+                if (tracing)
+                {
+                    char counterName[128];
+                    snprintf(counterName, sizeof(counterName), "GPU %s", pending.name);
+                    traceSetCounter(counterName, (long long)(end - begin));
+                }
+            }
+
+            freeQueries.push_back(pending.gpuBegin);
+            freeQueries.push_back(pending.gpuEnd);
+            collected++;
+        }
+
+        pendingScopes.erase(pendingScopes.begin(), pendingScopes.begin() + collected);
+    }
+
+    void Profiler::endFrame(void)
+    {
+        if (!openScopes.empty())
+        {
+            LOGE("Profiler::endFrame() with %u scopes still open.\n", (unsigned int)openScopes.size());
+        }
+
+        if (gpuSupported)
+        {
+            collectGPUResults();
+        }
+    }
+
+    void Profiler::log(const char *label)
+    {
+        LOGI("%s:\n", label);
+
+        for (std::map<std::string, Statistic>::iterator iterator = statistics.begin(); iterator != statistics.end(); ++iterator)
+        {
+            const Statistic &statistic = iterator->second;
+
+            if (statistic.gpuCount > 0)
+            {
+                LOGI("  %24s: CPU %7.3f ms, GPU %7.3f ms\n", iterator->first.c_str(),
+                     statistic.cpuTotal / statistic.cpuCount, statistic.gpuTotal / statistic.gpuCount);
+            }
+            else
+            {
+                LOGI("  %24s: CPU %7.3f ms\n", iterator->first.c_str(), statistic.cpuTotal / statistic.cpuCount);
+            }
+        }
+
+        statistics.clear();
+    }
+
+    unsigned int Profiler::getGPUAverage(const char *name, double *milliseconds)
+    {
+        std::map<std::string, Statistic>::const_iterator iterator = statistics.find(name);
+
+        if (iterator == statistics.end() || iterator->second.gpuCount == 0)
+        {
+            return 0;
+        }
+
+        *milliseconds = iterator->second.gpuTotal / iterator->second.gpuCount;
+        return iterator->second.gpuCount;
+    }
+
+    void Profiler::resetScope(const char *name)
+    {
+        statistics.erase(name);
+    }
+}
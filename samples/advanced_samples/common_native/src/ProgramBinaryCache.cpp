@@ -0,0 +1,265 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ProgramBinaryCache.h"
+#include "Platform.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace MaliSDK
+{
+    /* Identifies a cache file and its layout: magic, binary format, binary length, binary. */
+    static const unsigned int cacheFileMagic = 0x43425047; /* "GPBC" */
+
+    /* 64-bit FNV-1a, good enough to tell shader sources apart. */
+    static unsigned long long hashString(unsigned long long hash, const char *string)
+    {
+        /* Missing shader stages still contribute, so they can't shift the remaining sources into other positions. */
+        if (string == NULL)
+        {
+            return hash * 0x100000001b3ULL;
+        }
+
+        while (*string != '\0')
+        {
+            hash ^= (unsigned char)*string++;
+            hash *= 0x100000001b3ULL;
+        }
+
+        /* Hash the terminator too so that ("ab", "c") and ("a", "bc") differ. */
+        hash *= 0x100000001b3ULL;
+
+        return hash;
+    }
+
+    /* Same as hashString() for strings that are not null-terminated, a string and its mapped file give the same hash. */
+    static unsigned long long hashBytes(unsigned long long hash, const char *bytes, size_t length)
+    {
+        for (size_t byteIndex = 0; byteIndex < length; byteIndex++)
+        {
+            hash ^= (unsigned char)bytes[byteIndex];
+            hash *= 0x100000001b3ULL;
+        }
+
+        hash *= 0x100000001b3ULL;
+
+        return hash;
+    }
+
+    string ProgramBinaryCache::directory;
+
+    void ProgramBinaryCache::setDirectory(const char *cacheDirectory)
+    {
+        directory = (cacheDirectory != NULL) ? cacheDirectory : "";
+    }
+
+    string ProgramBinaryCache::getPath(unsigned long long key)
+    {
+        char filename[32];
+
+        sprintf(filename, "program_%016llx.bin", key);
+
+        return directory + filename;
+    }
+
+    unsigned long long ProgramBinaryCache::computeKey(const char * const *sources, int numberOfSources)
+    {
+        unsigned long long hash = 0xcbf29ce484222325ULL;
+
+        /* GL_VERSION carries the driver version on Mali, so a driver update invalidates the cache. */
+        hash = hashString(hash, (const char *)glGetString(GL_RENDERER));
+        hash = hashString(hash, (const char *)glGetString(GL_VERSION));
+
+        for (int sourceIndex = 0; sourceIndex < numberOfSources; sourceIndex++)
+        {
+            hash = hashString(hash, sources[sourceIndex]);
+        }
+
+        return hash;
+    }
+
+    unsigned long long ProgramBinaryCache::computeKey(const char * const *sources, const size_t *lengths, int numberOfSources)
+    {
+        unsigned long long hash = 0xcbf29ce484222325ULL;
+
+        hash = hashString(hash, (const char *)glGetString(GL_RENDERER));
+        hash = hashString(hash, (const char *)glGetString(GL_VERSION));
+
+        for (int sourceIndex = 0; sourceIndex < numberOfSources; sourceIndex++)
+        {
+            if (sources[sourceIndex] == NULL)
+            {
+                hash = hashString(hash, NULL);
+            }
+            else
+            {
+                hash = hashBytes(hash, sources[sourceIndex], lengths[sourceIndex]);
+            }
+        }
+
+        return hash;
+    }
+
+#if GLES_VERSION == 3
+    bool ProgramBinaryCache::isAvailable(void)
+    {
+        if (directory.empty())
+        {
+            return false;
+        }
+
+        GLint numberOfFormats = 0;
+        GL_CHECK(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numberOfFormats));
+
+        return numberOfFormats > 0;
+    }
+
+    bool ProgramBinaryCache::loadProgram(GLuint program, unsigned long long key)
+    {
+        if (!isAvailable())
+        {
+            return false;
+        }
+
+        string path = getPath(key);
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == NULL)
+        {
+            return false;
+        }
+
+        unsigned int magic = 0;
+        GLenum binaryFormat = 0;
+        GLint binaryLength = 0;
+        bool headerRead = fread(&magic,        sizeof(magic),        1, file) == 1 &&
+                          fread(&binaryFormat, sizeof(binaryFormat), 1, file) == 1 &&
+                          fread(&binaryLength, sizeof(binaryLength), 1, file) == 1;
+
+        if (!headerRead || magic != cacheFileMagic || binaryLength <= 0)
+        {
+            LOGE("Program binary cache file %s is corrupt, ignoring it.\n", path.c_str());
+            fclose(file);
+            remove(path.c_str());
+            return false;
+        }
+
+        vector<unsigned char> binary(binaryLength);
+        size_t read = fread(&binary[0], 1, binaryLength, file);
+        fclose(file);
+
+        if (read != (size_t)binaryLength)
+        {
+            LOGE("Program binary cache file %s is truncated, ignoring it.\n", path.c_str());
+            remove(path.c_str());
+            return false;
+        }
+
+        /* The driver is allowed to reject any binary, in which case we fall back to compiling from source. */
+        GL_CHECK(glProgramBinary(program, binaryFormat, &binary[0], binaryLength));
+
+        GLint linkStatus = GL_FALSE;
+        GL_CHECK(glGetProgramiv(program, GL_LINK_STATUS, &linkStatus));
+
+        if (linkStatus != GL_TRUE)
+        {
+            LOGI("Program binary %s was rejected by the driver, recompiling.\n", path.c_str());
+            remove(path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    void ProgramBinaryCache::prepareProgram(GLuint program)
+    {
+        if (!directory.empty())
+        {
+            GL_CHECK(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        }
+    }
+
+    void ProgramBinaryCache::storeProgram(GLuint program, unsigned long long key)
+    {
+        if (!isAvailable())
+        {
+            return;
+        }
+
+        GLint linkStatus = GL_FALSE;
+        GLint binaryLength = 0;
+        GL_CHECK(glGetProgramiv(program, GL_LINK_STATUS, &linkStatus));
+        GL_CHECK(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength));
+
+        if (linkStatus != GL_TRUE || binaryLength <= 0)
+        {
+            return;
+        }
+
+        vector<unsigned char> binary(binaryLength);
+        GLenum binaryFormat = 0;
+        GL_CHECK(glGetProgramBinary(program, binaryLength, &binaryLength, &binaryFormat, &binary[0]));
+
+        string path = getPath(key);
+        FILE *file = fopen(path.c_str(), "wb");
+        if (file == NULL)
+        {
+            LOGE("Cannot write program binary cache file %s\n", path.c_str());
+            return;
+        }
+
+        bool written = fwrite(&cacheFileMagic, sizeof(cacheFileMagic), 1, file) == 1 &&
+                       fwrite(&binaryFormat,   sizeof(binaryFormat),   1, file) == 1 &&
+                       fwrite(&binaryLength,   sizeof(binaryLength),   1, file) == 1 &&
+                       fwrite(&binary[0], 1, binaryLength, file) == (size_t)binaryLength;
+        fclose(file);
+
+        /* Never leave a partial file behind, it would only be rejected on the next run. */
+        if (!written)
+        {
+            LOGE("Failed to write program binary cache file %s\n", path.c_str());
+            remove(path.c_str());
+        }
+    }
+#elif GLES_VERSION == 2
+    bool ProgramBinaryCache::isAvailable(void)
+    {
+        return false;
+    }
+
+    bool ProgramBinaryCache::loadProgram(GLuint program, unsigned long long key)
+    {
+        return false;
+    }
+
+    void ProgramBinaryCache::prepareProgram(GLuint program)
+    {
+    }
+
+    void ProgramBinaryCache::storeProgram(GLuint program, unsigned long long key)
+    {
+    }
+#endif
+}
@@ -0,0 +1,319 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ProgramCompileQueue.h"
+#include "EGLWorkerContext.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+#include "ProgramBinaryCache.h"
+#include "Shader.h"
+
+#include <cstdlib>
+#include <cstring>
+
+/* GL_KHR_parallel_shader_compile, not part of the core headers. */
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (GL_APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_LOCAL)(GLuint count);
+
+namespace MaliSDK
+{
+    ProgramCompileQueue::ProgramCompileQueue(void)
+        : submitted(false),
+          useParallelCompile(false),
+          workerStarted(false),
+          workerDone(false),
+          workerDisplay(EGL_NO_DISPLAY),
+          workerSurface(EGL_NO_SURFACE),
+          workerContext(EGL_NO_CONTEXT)
+    {
+        pthread_mutex_init(&workerMutex, NULL);
+    }
+
+    ProgramCompileQueue::~ProgramCompileQueue(void)
+    {
+        if (workerStarted)
+        {
+            pthread_join(workerThread, NULL);
+        }
+
+        EGLWorkerContext::destroy(workerDisplay, workerSurface, workerContext);
+
+        pthread_mutex_destroy(&workerMutex);
+    }
+
+    GLuint ProgramCompileQueue::addProgram(const char *vertexShaderSource, const char *fragmentShaderSource)
+    {
+        if (submitted)
+        {
+            LOGE("ProgramCompileQueue::addProgram() called after submit().\n");
+            exit(1);
+        }
+
+        Entry entry;
+
+        entry.program = GL_CHECK(glCreateProgram());
+        entry.vertexShader = 0;
+        entry.fragmentShader = 0;
+        entry.vertexShaderSource = vertexShaderSource;
+        entry.fragmentShaderSource = fragmentShaderSource;
+        entry.key = 0;
+        entry.complete = false;
+
+        entries.push_back(entry);
+
+        return entry.program;
+    }
+
+    void ProgramCompileQueue::compileAndLink(Entry *entry)
+    {
+        const char *vertexStrings[1] = { entry->vertexShaderSource.c_str() };
+        const char *fragmentStrings[1] = { entry->fragmentShaderSource.c_str() };
+
+        entry->vertexShader = GL_CHECK(glCreateShader(GL_VERTEX_SHADER));
+        entry->fragmentShader = GL_CHECK(glCreateShader(GL_FRAGMENT_SHADER));
+
+        GL_CHECK(glShaderSource(entry->vertexShader, 1, vertexStrings, NULL));
+        GL_CHECK(glShaderSource(entry->fragmentShader, 1, fragmentStrings, NULL));
+
+        /* Querying the compile status here would serialise the compiler, so it is left to checkEntry(). */
+        GL_CHECK(glCompileShader(entry->vertexShader));
+        GL_CHECK(glCompileShader(entry->fragmentShader));
+
+        GL_CHECK(glAttachShader(entry->program, entry->vertexShader));
+        GL_CHECK(glAttachShader(entry->program, entry->fragmentShader));
+        ProgramBinaryCache::prepareProgram(entry->program);
+        GL_CHECK(glLinkProgram(entry->program));
+    }
+
+    void ProgramCompileQueue::checkEntry(Entry *entry)
+    {
+        /* Loaded from the program binary cache, there is nothing to check. */
+        if (entry->vertexShader == 0)
+        {
+            return;
+        }
+
+        GLint status;
+        GL_CHECK(glGetProgramiv(entry->program, GL_LINK_STATUS, &status));
+
+        if (status != GL_TRUE)
+        {
+            GLuint shaders[2] = { entry->vertexShader, entry->fragmentShader };
+
+            for (int shaderIndex = 0; shaderIndex < 2; shaderIndex++)
+            {
+                GLint compileStatus;
+                GL_CHECK(glGetShaderiv(shaders[shaderIndex], GL_COMPILE_STATUS, &compileStatus));
+
+                if (compileStatus != GL_TRUE)
+                {
+                    Shader::dumpShaderLog(shaders[shaderIndex]);
+                    LOGE("Compilation FAILED!\n\n");
+                    exit(1);
+                }
+            }
+
+            Shader::dumpProgramLog(entry->program);
+
+            LOGE("Linking program %u FAILED!\n\n", entry->program);
+            exit(1);
+        }
+
+        ProgramBinaryCache::storeProgram(entry->program, entry->key);
+
+        /* The program keeps what it needs, the shaders are only flagged for deletion. */
+        GL_CHECK(glDeleteShader(entry->vertexShader));
+        GL_CHECK(glDeleteShader(entry->fragmentShader));
+        entry->vertexShader = 0;
+        entry->fragmentShader = 0;
+    }
+
+    bool ProgramCompileQueue::createWorkerContext(void)
+    {
+        workerDisplay = eglGetCurrentDisplay();
+
+        return EGLWorkerContext::create(workerDisplay, eglGetCurrentContext(), &workerSurface, &workerContext);
+    }
+
+    void *ProgramCompileQueue::workerFunction(void *queue)
+    {
+        ProgramCompileQueue *compileQueue = (ProgramCompileQueue *)queue;
+
+        if (!eglMakeCurrent(compileQueue->workerDisplay, compileQueue->workerSurface, compileQueue->workerSurface, compileQueue->workerContext))
+        {
+            LOGE("ProgramCompileQueue: cannot make the worker context current (0x%.4x).\n", (int)eglGetError());
+            exit(1);
+        }
+
+        for (size_t entryIndex = 0; entryIndex < compileQueue->entries.size(); entryIndex++)
+        {
+            if (!compileQueue->entries[entryIndex].complete)
+            {
+                compileAndLink(&compileQueue->entries[entryIndex]);
+            }
+        }
+
+        /* Make sure the results are visible to the main context before reporting completion. */
+        GL_CHECK(glFinish());
+        eglMakeCurrent(compileQueue->workerDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        pthread_mutex_lock(&compileQueue->workerMutex);
+        compileQueue->workerDone = true;
+        pthread_mutex_unlock(&compileQueue->workerMutex);
+
+        return NULL;
+    }
+
+    void ProgramCompileQueue::submit(void)
+    {
+        if (submitted)
+        {
+            return;
+        }
+
+        submitted = true;
+
+        /* Programs cached by a previous run only need their binary loaded. */
+        for (size_t entryIndex = 0; entryIndex < entries.size(); entryIndex++)
+        {
+            Entry &entry = entries[entryIndex];
+            const char *sources[2] = { entry.vertexShaderSource.c_str(), entry.fragmentShaderSource.c_str() };
+
+            entry.key = ProgramBinaryCache::computeKey(sources, 2);
+            entry.complete = ProgramBinaryCache::loadProgram(entry.program, entry.key);
+        }
+
+        useParallelCompile = GLExtensions::isSupported("GL_KHR_parallel_shader_compile");
+
+        if (useParallelCompile)
+        {
+            PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_LOCAL maxShaderCompilerThreads =
+                (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_LOCAL)eglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+
+            /* Let the driver use as many threads as it likes. */
+            if (maxShaderCompilerThreads != NULL)
+            {
+                GL_CHECK(maxShaderCompilerThreads(0xFFFFFFFF));
+            }
+
+            for (size_t entryIndex = 0; entryIndex < entries.size(); entryIndex++)
+            {
+                if (!entries[entryIndex].complete)
+                {
+                    compileAndLink(&entries[entryIndex]);
+                }
+            }
+
+            LOGI("ProgramCompileQueue: compiling %u programs using GL_KHR_parallel_shader_compile.\n", (unsigned int)entries.size());
+            return;
+        }
+
+        /* The program objects and their pre-link state must reach the server before the worker context uses them. */
+        GL_CHECK(glFlush());
+
+        if (createWorkerContext() && pthread_create(&workerThread, NULL, &workerFunction, this) == 0)
+        {
+            workerStarted = true;
+            LOGI("ProgramCompileQueue: compiling %u programs on a worker thread.\n", (unsigned int)entries.size());
+            return;
+        }
+
+        /* No way to compile in the background, build everything now so finish() still works. */
+        LOGI("ProgramCompileQueue: cannot create a worker context, compiling on the rendering thread.\n");
+
+        for (size_t entryIndex = 0; entryIndex < entries.size(); entryIndex++)
+        {
+            if (!entries[entryIndex].complete)
+            {
+                compileAndLink(&entries[entryIndex]);
+            }
+        }
+
+        workerDone = true;
+    }
+
+    bool ProgramCompileQueue::isComplete(void)
+    {
+        if (!submitted)
+        {
+            return false;
+        }
+
+        if (useParallelCompile)
+        {
+            for (size_t entryIndex = 0; entryIndex < entries.size(); entryIndex++)
+            {
+                Entry &entry = entries[entryIndex];
+
+                if (!entry.complete)
+                {
+                    GLint status = GL_FALSE;
+                    GL_CHECK(glGetProgramiv(entry.program, GL_COMPLETION_STATUS_KHR, &status));
+
+                    if (status != GL_TRUE)
+                    {
+                        return false;
+                    }
+
+                    entry.complete = true;
+                }
+            }
+
+            return true;
+        }
+
+        pthread_mutex_lock(&workerMutex);
+        bool done = workerDone;
+        pthread_mutex_unlock(&workerMutex);
+
+        return done;
+    }
+
+    void ProgramCompileQueue::finish(void)
+    {
+        if (!submitted)
+        {
+            submit();
+        }
+
+        if (workerStarted)
+        {
+            pthread_join(workerThread, NULL);
+            workerStarted = false;
+
+            EGLWorkerContext::destroy(workerDisplay, workerSurface, workerContext);
+            workerContext = EGL_NO_CONTEXT;
+            workerSurface = EGL_NO_SURFACE;
+        }
+
+        /* In the parallel compile case these queries block until the driver is done. */
+        for (size_t entryIndex = 0; entryIndex < entries.size(); entryIndex++)
+        {
+            checkEntry(&entries[entryIndex]);
+            entries[entryIndex].complete = true;
+        }
+    }
+}
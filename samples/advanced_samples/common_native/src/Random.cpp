@@ -0,0 +1,202 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Random.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RANDOM_USE_NEON 1
+#else
+#define RANDOM_USE_NEON 0
+#endif
+
+namespace MaliSDK
+{
+    /* 2^-24, from the top 24 bits of a value to [0.0, 1.0). */
+    static const float floatScale = 1.0f / 16777216.0f;
+
+    /* SplitMix32, so seeds which differ by one still give unrelated lanes. */
+    static uint32_t mix(uint32_t *state)
+    {
+        uint32_t value = (*state += 0x9E3779B9u);
+        value = (value ^ (value >> 16)) * 0x85EBCA6Bu;
+        value = (value ^ (value >> 13)) * 0xC2B2AE35u;
+        return value ^ (value >> 16);
+    }
+
+    Random::Random(uint32_t seed)
+    {
+        setSeed(seed);
+    }
+
+    void Random::setSeed(uint32_t seed)
+    {
+        uint32_t state = seed;
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            x[lane] = mix(&state);
+            y[lane] = mix(&state);
+            z[lane] = mix(&state);
+            w[lane] = mix(&state);
+
+            /* The all zero state would only ever give zeros. */
+            if ((x[lane] | y[lane] | z[lane] | w[lane]) == 0)
+            {
+                w[lane] = 88675123;
+            }
+        }
+
+        numberOfBufferedValues = 0;
+    }
+
+    /* The state is kept in locals while stepping, stores through values could otherwise alias it. */
+    void Random::step(uint32_t *values, size_t numberOfSteps)
+    {
+#if RANDOM_USE_NEON
+        uint32x4_t vx = vld1q_u32(x);
+        uint32x4_t vy = vld1q_u32(y);
+        uint32x4_t vz = vld1q_u32(z);
+        uint32x4_t vw = vld1q_u32(w);
+
+        for (size_t index = 0; index < numberOfSteps; index++)
+        {
+            uint32x4_t t = veorq_u32(vx, vshlq_n_u32(vx, 11));
+
+            vx = vy;
+            vy = vz;
+            vz = vw;
+            vw = veorq_u32(veorq_u32(vw, vshrq_n_u32(vw, 19)), veorq_u32(t, vshrq_n_u32(t, 8)));
+            vst1q_u32(values + 4 * index, vw);
+        }
+
+        vst1q_u32(x, vx);
+        vst1q_u32(y, vy);
+        vst1q_u32(z, vz);
+        vst1q_u32(w, vw);
+#else
+        uint32_t lx[4], ly[4], lz[4], lw[4];
+        for (int lane = 0; lane < 4; lane++)
+        {
+            lx[lane] = x[lane];
+            ly[lane] = y[lane];
+            lz[lane] = z[lane];
+            lw[lane] = w[lane];
+        }
+
+        for (size_t index = 0; index < numberOfSteps; index++)
+        {
+            for (int lane = 0; lane < 4; lane++)
+            {
+                uint32_t t = lx[lane] ^ (lx[lane] << 11);
+
+                lx[lane] = ly[lane];
+                ly[lane] = lz[lane];
+                lz[lane] = lw[lane];
+                lw[lane] = lw[lane] ^ (lw[lane] >> 19) ^ (t ^ (t >> 8));
+                values[4 * index + lane] = lw[lane];
+            }
+        }
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            x[lane] = lx[lane];
+            y[lane] = ly[lane];
+            z[lane] = lz[lane];
+            w[lane] = lw[lane];
+        }
+#endif
+    }
+
+    uint32_t Random::next(void)
+    {
+        if (numberOfBufferedValues == 0)
+        {
+            step(buffered, 1);
+            numberOfBufferedValues = 4;
+        }
+
+        return buffered[4 - numberOfBufferedValues--];
+    }
+
+    float Random::nextFloat(void)
+    {
+        return (next() >> 8) * floatScale;
+    }
+
+    void Random::fill(uint32_t *values, size_t count)
+    {
+        size_t index = 0;
+
+        /* Finish the step next() started first, to stay in sequence. */
+        while (index < count && numberOfBufferedValues > 0)
+        {
+            values[index++] = next();
+        }
+
+        size_t numberOfSteps = (count - index) / 4;
+        step(values + index, numberOfSteps);
+        index += 4 * numberOfSteps;
+
+        while (index < count)
+        {
+            values[index++] = next();
+        }
+    }
+
+    void Random::fill(float *values, size_t count, float minimum, float maximum)
+    {
+        const float scale = (maximum - minimum) * floatScale;
+        size_t index = 0;
+
+        while (index < count && numberOfBufferedValues > 0)
+        {
+            values[index++] = minimum + (next() >> 8) * scale;
+        }
+
+        /* The bits of a chunk are generated first, then converted while they are still in the cache. */
+        uint32_t bits[256];
+        while (count - index >= 4)
+        {
+            size_t chunk = count - index < 256 ? (count - index) & ~(size_t)3 : 256;
+            step(bits, chunk / 4);
+
+#if RANDOM_USE_NEON
+            const float32x4_t vminimum = vdupq_n_f32(minimum);
+            for (size_t offset = 0; offset < chunk; offset += 4)
+            {
+                float32x4_t value = vcvtq_f32_u32(vshrq_n_u32(vld1q_u32(bits + offset), 8));
+                vst1q_f32(values + index + offset, vmlaq_n_f32(vminimum, value, scale));
+            }
+#else
+            for (size_t offset = 0; offset < chunk; offset++)
+            {
+                values[index + offset] = minimum + (bits[offset] >> 8) * scale;
+            }
+#endif
+            index += chunk;
+        }
+
+        while (index < count)
+        {
+            values[index++] = minimum + (next() >> 8) * scale;
+        }
+    }
+}
@@ -0,0 +1,309 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "RenderPass.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+
+#include <EGL/egl.h>
+#include <cstring>
+
+#if GLES_VERSION == 2
+/* GL_EXT_discard_framebuffer, not part of the core OpenGL ES 2.0 headers. */
+#ifndef GL_COLOR_EXT
+#define GL_COLOR_EXT 0x1800
+#define GL_DEPTH_EXT 0x1801
+#define GL_STENCIL_EXT 0x1802
+#endif
+
+typedef void (GL_APIENTRYP PFNGLDISCARDFRAMEBUFFEREXTPROC_LOCAL)(GLenum target, GLsizei numAttachments, const GLenum *attachments);
+#endif
+
+namespace MaliSDK
+{
+    unsigned long long RenderPass::bytesTransferred = 0;
+    unsigned long long RenderPass::bytesSaved = 0;
+    int RenderPass::framebufferSwitches = 0;
+    int RenderPass::lastLoggedFramebufferSwitches = -1;
+
+#if GLES_VERSION == 2
+    /* Looked up on first use, NULL if the extension is not supported. */
+    static PFNGLDISCARDFRAMEBUFFEREXTPROC_LOCAL getDiscardFramebuffer(void)
+    {
+        static bool checked = false;
+        static PFNGLDISCARDFRAMEBUFFEREXTPROC_LOCAL discardFramebuffer = NULL;
+
+        if (!checked)
+        {
+            checked = true;
+
+            if (GLExtensions::isSupported("GL_EXT_discard_framebuffer"))
+            {
+                discardFramebuffer = (PFNGLDISCARDFRAMEBUFFEREXTPROC_LOCAL)eglGetProcAddress("glDiscardFramebufferEXT");
+            }
+        }
+
+        return discardFramebuffer;
+    }
+#endif
+
+    RenderPass::RenderPass(GLuint framebuffer, GLsizei width, GLsizei height)
+        : framebuffer(framebuffer),
+          width(width),
+          height(height),
+          numberOfColorAttachments(1),
+          hasClearColor(false),
+          hasClearDepth(false),
+          hasClearStencil(false),
+          clearDepth(1.0f),
+          clearStencil(0)
+    {
+        for (int attachmentIndex = 0; attachmentIndex < ATTACHMENT_COUNT; attachmentIndex++)
+        {
+            attachments[attachmentIndex].used = false;
+            attachments[attachmentIndex].load = LOAD_OP_LOAD;
+            attachments[attachmentIndex].store = STORE_OP_STORE;
+            attachments[attachmentIndex].bytesPerPixel = 0;
+        }
+    }
+
+    void RenderPass::setAttachment(Attachment attachment, LoadOp load, StoreOp store, int bytesPerPixel)
+    {
+        attachments[attachment].used = true;
+        attachments[attachment].load = load;
+        attachments[attachment].store = store;
+        attachments[attachment].bytesPerPixel = bytesPerPixel;
+    }
+
+    void RenderPass::setNumberOfColorAttachments(int count)
+    {
+        if (count < 1 || count > maxColorAttachments)
+        {
+            LOGE("RenderPass supports between 1 and %d colour attachments, %d requested.\n", maxColorAttachments, count);
+            return;
+        }
+
+        numberOfColorAttachments = count;
+    }
+
+    void RenderPass::setClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+    {
+        hasClearColor = true;
+        clearColor[0] = red;
+        clearColor[1] = green;
+        clearColor[2] = blue;
+        clearColor[3] = alpha;
+    }
+
+    void RenderPass::setClearDepth(GLfloat depth)
+    {
+        hasClearDepth = true;
+        clearDepth = depth;
+    }
+
+    void RenderPass::setClearStencil(GLint stencil)
+    {
+        hasClearStencil = true;
+        clearStencil = stencil;
+    }
+
+    void RenderPass::invalidate(bool atBegin)
+    {
+        /* The window surface names its buffers differently to framebuffer objects. */
+#if GLES_VERSION == 3
+        static const GLenum defaultNames[ATTACHMENT_COUNT] = { GL_COLOR, GL_DEPTH, GL_STENCIL };
+#else
+        static const GLenum defaultNames[ATTACHMENT_COUNT] = { GL_COLOR_EXT, GL_DEPTH_EXT, GL_STENCIL_EXT };
+#endif
+        static const GLenum objectNames[ATTACHMENT_COUNT] = { GL_COLOR_ATTACHMENT0, GL_DEPTH_ATTACHMENT, GL_STENCIL_ATTACHMENT };
+
+        GLenum invalidated[maxColorAttachments + ATTACHMENT_COUNT - 1];
+        GLsizei numberOfInvalidated = 0;
+
+        for (int attachmentIndex = 0; attachmentIndex < ATTACHMENT_COUNT; attachmentIndex++)
+        {
+            const AttachmentState &state = attachments[attachmentIndex];
+            bool dontCare = atBegin ? (state.load == LOAD_OP_DONT_CARE) : (state.store == STORE_OP_DONT_CARE);
+
+            if (!state.used || !dontCare)
+            {
+                continue;
+            }
+
+            if (framebuffer == 0)
+            {
+                invalidated[numberOfInvalidated++] = defaultNames[attachmentIndex];
+            }
+            else if (attachmentIndex == ATTACHMENT_COLOR)
+            {
+                for (int colorIndex = 0; colorIndex < numberOfColorAttachments; colorIndex++)
+                {
+                    invalidated[numberOfInvalidated++] = GL_COLOR_ATTACHMENT0 + colorIndex;
+                }
+            }
+            else
+            {
+                invalidated[numberOfInvalidated++] = objectNames[attachmentIndex];
+            }
+        }
+
+        if (numberOfInvalidated == 0)
+        {
+            return;
+        }
+
+#if GLES_VERSION == 3
+        GL_CHECK(glInvalidateFramebuffer(GL_FRAMEBUFFER, numberOfInvalidated, invalidated));
+#else
+        PFNGLDISCARDFRAMEBUFFEREXTPROC_LOCAL discardFramebuffer = getDiscardFramebuffer();
+
+        if (discardFramebuffer != NULL)
+        {
+            GL_CHECK(discardFramebuffer(GL_FRAMEBUFFER, numberOfInvalidated, invalidated));
+        }
+#endif
+    }
+
+    void RenderPass::begin(void)
+    {
+        /* The binding is queried rather than tracked, so framebuffers bound outside of RenderPass are seen too. */
+        GLint boundFramebuffer = 0;
+        GL_CHECK(glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFramebuffer));
+
+        if ((GLuint)boundFramebuffer != framebuffer)
+        {
+            GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+            framebufferSwitches++;
+        }
+
+        GL_CHECK(glViewport(0, 0, width, height));
+
+        invalidate(true);
+
+        static const GLbitfield clearBits[ATTACHMENT_COUNT] = { GL_COLOR_BUFFER_BIT, GL_DEPTH_BUFFER_BIT, GL_STENCIL_BUFFER_BIT };
+        GLbitfield clearMask = 0;
+
+        for (int attachmentIndex = 0; attachmentIndex < ATTACHMENT_COUNT; attachmentIndex++)
+        {
+            if (attachments[attachmentIndex].used && attachments[attachmentIndex].load == LOAD_OP_CLEAR)
+            {
+                clearMask |= clearBits[attachmentIndex];
+            }
+        }
+
+        if (clearMask == 0)
+        {
+            return;
+        }
+
+        if (hasClearColor && (clearMask & GL_COLOR_BUFFER_BIT))
+        {
+            GL_CHECK(glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]));
+        }
+
+        if (hasClearDepth && (clearMask & GL_DEPTH_BUFFER_BIT))
+        {
+            GL_CHECK(glClearDepthf(clearDepth));
+        }
+
+        if (hasClearStencil && (clearMask & GL_STENCIL_BUFFER_BIT))
+        {
+            GL_CHECK(glClearStencil(clearStencil));
+        }
+
+        GL_CHECK(glClear(clearMask));
+    }
+
+    void RenderPass::end(void)
+    {
+        invalidate(false);
+
+        unsigned long long pixels = (unsigned long long)width * height;
+
+        for (int attachmentIndex = 0; attachmentIndex < ATTACHMENT_COUNT; attachmentIndex++)
+        {
+            const AttachmentState &state = attachments[attachmentIndex];
+            unsigned long long bytes = pixels * state.bytesPerPixel;
+
+            if (attachmentIndex == ATTACHMENT_COLOR)
+            {
+                bytes *= numberOfColorAttachments;
+            }
+
+            if (!state.used)
+            {
+                continue;
+            }
+
+            if (state.load == LOAD_OP_LOAD)
+            {
+                bytesTransferred += bytes;
+            }
+            else
+            {
+                bytesSaved += bytes;
+            }
+
+            if (state.store == STORE_OP_STORE)
+            {
+                bytesTransferred += bytes;
+            }
+            else
+            {
+                bytesSaved += bytes;
+            }
+        }
+    }
+
+    unsigned long long RenderPass::getBytesTransferred(void)
+    {
+        return bytesTransferred;
+    }
+
+    unsigned long long RenderPass::getBytesSaved(void)
+    {
+        return bytesSaved;
+    }
+
+    int RenderPass::getFramebufferSwitches(void)
+    {
+        return framebufferSwitches;
+    }
+
+    void RenderPass::resetCounters(void)
+    {
+        bytesTransferred = 0;
+        bytesSaved = 0;
+        framebufferSwitches = 0;
+    }
+
+    void RenderPass::endFrame(void)
+    {
+        /* Steady frames are not logged, only changes, so the log stays readable. */
+        if (framebufferSwitches != lastLoggedFramebufferSwitches)
+        {
+            LOGD("RenderPass: %d framebuffer switches per frame, %llu KB of attachments transferred, %llu KB saved.\n",
+                 framebufferSwitches, bytesTransferred / 1024, bytesSaved / 1024);
+            lastLoggedFramebufferSwitches = framebufferSwitches;
+        }
+
+        resetCounters();
+    }
+}
@@ -0,0 +1,319 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SDFText.h"
+#include "Shader.h"
+#include "Platform.h"
+#if GLES_VERSION == 3
+#include "OverlayBatch.h"
+#endif
+
+#include <cstdlib>
+#include <cstring>
+
+namespace MaliSDK
+{
+    static const char *vertexShaderSource =
+        "#version 100\n"
+        "uniform mat4 u_m4Projection;\n"
+        "attribute vec4 a_v4Position;\n"
+        "attribute vec2 a_v2TexCoord;\n"
+        "attribute vec4 a_v4FontColor;\n"
+        "attribute float a_fSmoothing;\n"
+        "varying vec2 v_v2TexCoord;\n"
+        "varying vec4 v_v4FontColor;\n"
+        "varying float v_fSmoothing;\n"
+        "void main()\n"
+        "{\n"
+        "    v_v2TexCoord = a_v2TexCoord;\n"
+        "    v_v4FontColor = a_v4FontColor;\n"
+        "    v_fSmoothing = a_fSmoothing;\n"
+        "    gl_Position = u_m4Projection * a_v4Position;\n"
+        "}\n";
+
+    /* The edge is where the distance crosses 0.5, blurred over about one pixel. */
+    static const char *fragmentShaderSource =
+        "#version 100\n"
+        "precision mediump float;\n"
+        "uniform sampler2D u_s2dTexture;\n"
+        "varying vec2 v_v2TexCoord;\n"
+        "varying vec4 v_v4FontColor;\n"
+        "varying float v_fSmoothing;\n"
+        "void main()\n"
+        "{\n"
+        "    float distance = texture2D(u_s2dTexture, v_v2TexCoord).a;\n"
+        "    float coverage = smoothstep(0.5 - v_fSmoothing, 0.5 + v_fSmoothing, distance);\n"
+        "    gl_FragColor = vec4(v_v4FontColor.rgb, v_v4FontColor.a * coverage);\n"
+        "}\n";
+
+    /* The indices are 16 bit, 4 vertices per character. */
+    static const int maximumNumberOfCharacters = 65536 / 4;
+
+    SDFText::SDFText(const FontAtlas *atlas, int windowWidth, int windowHeight)
+        : atlas(atlas),
+          numberOfCharacters(0),
+          vertexData(NULL),
+          characterCapacity(0),
+          vertexBuffer(0),
+          indexBuffer(0),
+          bufferCapacity(0),
+          uploadedCharacters(0),
+          dirtyBegin(0),
+          dirtyEnd(0)
+    {
+        projectionMatrix = Matrix::matrixOrthographic(0, (float)windowWidth, 0, (float)windowHeight, 0, 1);
+
+        Shader::processProgramSource(&programID, vertexShaderSource, fragmentShaderSource);
+
+        iLocPosition = GL_CHECK(glGetAttribLocation(programID, "a_v4Position"));
+        iLocTexCoord = GL_CHECK(glGetAttribLocation(programID, "a_v2TexCoord"));
+        iLocFontColor = GL_CHECK(glGetAttribLocation(programID, "a_v4FontColor"));
+        iLocSmoothing = GL_CHECK(glGetAttribLocation(programID, "a_fSmoothing"));
+        iLocProjection = GL_CHECK(glGetUniformLocation(programID, "u_m4Projection"));
+
+        GL_CHECK(glUseProgram(programID));
+        GL_CHECK(glUniform1i(glGetUniformLocation(programID, "u_s2dTexture"), 0));
+
+        GL_CHECK(glGenBuffers(1, &vertexBuffer));
+        GL_CHECK(glGenBuffers(1, &indexBuffer));
+    }
+
+    SDFText::~SDFText(void)
+    {
+        free(vertexData);
+    }
+
+    void SDFText::clear(void)
+    {
+        numberOfCharacters = 0;
+    }
+
+    void SDFText::reserveCharacters(int count)
+    {
+        if (count <= characterCapacity)
+        {
+            return;
+        }
+
+        int newCapacity = characterCapacity > 0 ? characterCapacity : 64;
+        while (newCapacity < count)
+        {
+            newCapacity *= 2;
+        }
+
+        vertexData = (float *)realloc(vertexData, newCapacity * floatsPerCharacter * sizeof(float));
+        if (vertexData == NULL)
+        {
+            LOGE("Out of memory at %s:%i\n", __FILE__, __LINE__);
+            exit(1);
+        }
+
+        characterCapacity = newCapacity;
+    }
+
+    float SDFText::addString(float xPosition, float yPosition, const char *string, float height, int font,
+                             int red, int green, int blue, int alpha)
+    {
+        int length = strlen(string);
+
+        if (numberOfCharacters + length > maximumNumberOfCharacters)
+        {
+            LOGE("Too many characters at %s:%i\n", __FILE__, __LINE__);
+            return xPosition;
+        }
+
+        reserveCharacters(numberOfCharacters + length);
+
+        const float advance = height * atlas->getAspectRatio(font);
+        const float padding = height * atlas->getPadding(font);
+
+        /* Half a pixel either side of the edge, in distance units: a pixel covers glyphHeight / height texels. */
+        float smoothing = 0.5f * atlas->getGlyphHeight(font) / (height * 2.0f * atlas->getSpread());
+        smoothing = smoothing < 0.5f ? smoothing : 0.5f;
+
+        const float r = red / 255.0f;
+        const float g = green / 255.0f;
+        const float b = blue / 255.0f;
+        const float a = alpha / 255.0f;
+
+        for (int iChar = 0; iChar < length; iChar++)
+        {
+            FontAtlas::Glyph glyph = atlas->getGlyph(font, string[iChar]);
+
+            float left = xPosition + iChar * advance - padding;
+            float right = xPosition + (iChar + 1) * advance + padding;
+            float bottom = yPosition - padding;
+            float top = yPosition + height + padding;
+
+            const float character[floatsPerCharacter] =
+            {
+                left,  bottom, glyph.left,  glyph.bottom, r, g, b, a, smoothing,
+                right, bottom, glyph.right, glyph.bottom, r, g, b, a, smoothing,
+                left,  top,    glyph.left,  glyph.top,    r, g, b, a, smoothing,
+                right, top,    glyph.right, glyph.top,    r, g, b, a, smoothing,
+            };
+
+            /* Only characters which differ from what the buffer already holds need uploading. */
+            float *destination = &vertexData[numberOfCharacters * floatsPerCharacter];
+            if (numberOfCharacters >= uploadedCharacters || memcmp(destination, character, sizeof(character)) != 0)
+            {
+                memcpy(destination, character, sizeof(character));
+
+                if (dirtyBegin >= dirtyEnd)
+                {
+                    dirtyBegin = numberOfCharacters;
+                    dirtyEnd = numberOfCharacters;
+                }
+                dirtyBegin = dirtyBegin < numberOfCharacters ? dirtyBegin : numberOfCharacters;
+                dirtyEnd = dirtyEnd > numberOfCharacters + 1 ? dirtyEnd : numberOfCharacters + 1;
+            }
+
+            numberOfCharacters++;
+        }
+
+        return xPosition + length * advance;
+    }
+
+    void SDFText::draw(void)
+    {
+#if GLES_VERSION == 3
+        GL_CHECK(glBindVertexArray(0));
+#endif
+        if (numberOfCharacters == 0)
+        {
+            return;
+        }
+
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+
+        if (bufferCapacity < characterCapacity)
+        {
+            bufferCapacity = characterCapacity;
+            GL_CHECK(glBufferData(GL_ARRAY_BUFFER, bufferCapacity * floatsPerCharacter * sizeof(float), NULL, GL_DYNAMIC_DRAW));
+
+            /* Quads joined into one triangle strip by degenerate triangles. */
+            int numberOfIndices = bufferCapacity * 6 - 2;
+            GLushort *indices = (GLushort *)malloc(numberOfIndices * sizeof(GLushort));
+            int index = 0;
+
+            if (indices == NULL)
+            {
+                LOGE("Out of memory at %s:%i\n", __FILE__, __LINE__);
+                exit(1);
+            }
+
+            for (int character = 0; character < bufferCapacity; character++)
+            {
+                GLushort firstVertex = (GLushort)(character * 4);
+
+                if (character > 0)
+                {
+                    indices[index++] = firstVertex - 1;
+                    indices[index++] = firstVertex;
+                }
+
+                indices[index++] = firstVertex;
+                indices[index++] = firstVertex + 1;
+                indices[index++] = firstVertex + 2;
+                indices[index++] = firstVertex + 3;
+            }
+
+            GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, numberOfIndices * sizeof(GLushort), indices, GL_STATIC_DRAW));
+            free(indices);
+
+            uploadedCharacters = 0;
+            dirtyBegin = 0;
+            dirtyEnd = numberOfCharacters;
+        }
+
+        if (dirtyBegin < dirtyEnd)
+        {
+            GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, dirtyBegin * floatsPerCharacter * sizeof(float),
+                                     (dirtyEnd - dirtyBegin) * floatsPerCharacter * sizeof(float),
+                                     &vertexData[dirtyBegin * floatsPerCharacter]));
+
+            uploadedCharacters = uploadedCharacters > dirtyEnd ? uploadedCharacters : dirtyEnd;
+            dirtyBegin = 0;
+            dirtyEnd = 0;
+        }
+
+        const GLsizei stride = floatsPerVertex * sizeof(float);
+
+        GL_CHECK(glUseProgram(programID));
+        GL_CHECK(glUniformMatrix4fv(iLocProjection, 1, GL_FALSE, projectionMatrix.getAsArray()));
+
+        GL_CHECK(glEnableVertexAttribArray(iLocPosition));
+        GL_CHECK(glVertexAttribPointer(iLocPosition, 2, GL_FLOAT, GL_FALSE, stride, (const void *)0));
+        GL_CHECK(glEnableVertexAttribArray(iLocTexCoord));
+        GL_CHECK(glVertexAttribPointer(iLocTexCoord, 2, GL_FLOAT, GL_FALSE, stride, (const void *)(2 * sizeof(float))));
+        GL_CHECK(glEnableVertexAttribArray(iLocFontColor));
+        GL_CHECK(glVertexAttribPointer(iLocFontColor, 4, GL_FLOAT, GL_FALSE, stride, (const void *)(4 * sizeof(float))));
+        GL_CHECK(glEnableVertexAttribArray(iLocSmoothing));
+        GL_CHECK(glVertexAttribPointer(iLocSmoothing, 1, GL_FLOAT, GL_FALSE, stride, (const void *)(8 * sizeof(float))));
+
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, atlas->getTexture()));
+
+        GL_CHECK(glEnable(GL_BLEND));
+        GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+        GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, numberOfCharacters * 6 - 2, GL_UNSIGNED_SHORT, (const void *)0));
+
+        GL_CHECK(glDisable(GL_BLEND));
+        GL_CHECK(glDisableVertexAttribArray(iLocSmoothing));
+        GL_CHECK(glDisableVertexAttribArray(iLocFontColor));
+        GL_CHECK(glDisableVertexAttribArray(iLocTexCoord));
+        GL_CHECK(glDisableVertexAttribArray(iLocPosition));
+
+        /* Samples draw with client side arrays after the text, leave no buffer bound. */
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+
+#if GLES_VERSION == 3
+    void SDFText::submit(OverlayBatch &batch, int layer) const
+    {
+        for (int character = 0; character < numberOfCharacters; character++)
+        {
+            const float *source = &vertexData[character * floatsPerCharacter];
+            OverlayBatch::Vertex vertices[4];
+
+            for (int corner = 0; corner < 4; corner++, source += floatsPerVertex)
+            {
+                OverlayBatch::Vertex &vertex = vertices[corner];
+                vertex.position[0] = source[0];
+                vertex.position[1] = source[1];
+                vertex.texCoord[0] = source[2];
+                vertex.texCoord[1] = source[3];
+                vertex.texCoord[2] = 0.0f;
+                for (int component = 0; component < 4; component++)
+                {
+                    vertex.color[component] = (GLubyte)(source[4 + component] * 255.0f + 0.5f);
+                }
+                vertex.shading = (GLfloat)OverlayBatch::SHADING_DISTANCE_FIELD;
+                vertex.smoothing = source[8];
+            }
+
+            batch.addQuad(layer, atlas->getTexture(), 0, vertices);
+        }
+    }
+#endif
+}
@@ -0,0 +1,172 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SampleParameters.h"
+#include "Platform.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+namespace MaliSDK
+{
+    typedef std::map<std::string, std::string> ParameterMap;
+
+    /* Constructed on first use, as the harness may set values before other static constructors of the library ran. */
+    static ParameterMap &getParameters(void)
+    {
+        static ParameterMap parameters;
+
+        return parameters;
+    }
+
+    /* A copy of the text without the spaces around it. */
+    static std::string trim(const char *begin, const char *end)
+    {
+        while (begin < end && (*begin == ' ' || *begin == '\t'))
+        {
+            begin++;
+        }
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n'))
+        {
+            end--;
+        }
+
+        return std::string(begin, end);
+    }
+
+    bool SampleParameters::loadFile(const std::string &path)
+    {
+        FILE *file = fopen(path.c_str(), "r");
+        if (file == NULL)
+        {
+            return false;
+        }
+
+        char line[256];
+        while (fgets(line, sizeof(line), file) != NULL)
+        {
+            const char *separator = strchr(line, '=');
+            std::string name = trim(line, separator != NULL ? separator : line);
+
+            if (separator == NULL || name.empty() || name[0] == '#')
+            {
+                continue;
+            }
+
+            std::string value = trim(separator + 1, line + strlen(line));
+            if (getParameters().find(name) == getParameters().end())
+            {
+                getParameters()[name] = value;
+            }
+        }
+        fclose(file);
+
+        LOGI("Read parameters from %s.\n", path.c_str());
+
+        return true;
+    }
+
+    const char *SampleParameters::find(const char *name)
+    {
+        ParameterMap::const_iterator parameter = getParameters().find(name);
+
+        return parameter != getParameters().end() ? parameter->second.c_str() : NULL;
+    }
+
+    void SampleParameters::set(const char *name, const char *value)
+    {
+        getParameters()[name] = value;
+    }
+
+    void SampleParameters::load(const char *resourceDirectory)
+    {
+        std::string directory = resourceDirectory;
+
+        loadFile(directory + "intent_parameters.txt");
+        loadFile(directory + "parameters.txt");
+    }
+
+    void SampleParameters::clear(void)
+    {
+        getParameters().clear();
+    }
+
+    bool SampleParameters::has(const char *name)
+    {
+        return find(name) != NULL;
+    }
+
+    int SampleParameters::getInt(const char *name, int defaultValue, int minimum, int maximum)
+    {
+        const char *text = find(name);
+        int value = defaultValue;
+
+        if (text != NULL)
+        {
+            char *end = NULL;
+            long parsed = strtol(text, &end, 10);
+
+            if (end == text || *end != '\0')
+            {
+                LOGE("Parameter %s is not an integer: %s.\n", name, text);
+            }
+            else
+            {
+                value = parsed < minimum ? minimum : (parsed > maximum ? maximum : (int)parsed);
+            }
+        }
+
+        LOGI("Parameter %s = %d%s.\n", name, value, text == NULL ? " (default)" : "");
+
+        return value;
+    }
+
+    float SampleParameters::getFloat(const char *name, float defaultValue, float minimum, float maximum)
+    {
+        const char *text = find(name);
+        float value = defaultValue;
+
+        if (text != NULL)
+        {
+            char *end = NULL;
+            float parsed = strtof(text, &end);
+
+            if (end == text || *end != '\0')
+            {
+                LOGE("Parameter %s is not a number: %s.\n", name, text);
+            }
+            else
+            {
+                value = parsed < minimum ? minimum : (parsed > maximum ? maximum : parsed);
+            }
+        }
+
+        LOGI("Parameter %s = %g%s.\n", name, value, text == NULL ? " (default)" : "");
+
+        return value;
+    }
+}
+
+extern "C" void MaliSDK_SampleParameters_set(const char *name, const char *value)
+{
+    MaliSDK::SampleParameters::set(name, value);
+}
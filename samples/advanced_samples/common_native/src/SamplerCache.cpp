@@ -0,0 +1,191 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SamplerCache.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Platform.h"
+
+#include <cstring>
+
+/* GL_EXT_texture_filter_anisotropic, not part of the core headers. */
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+namespace MaliSDK
+{
+    std::map<SamplerState, GLuint> SamplerCache::samplers;
+    GLfloat SamplerCache::maxSupportedAnisotropy = 0.0f;
+
+    SamplerState::SamplerState(void)
+        : minFilter(GL_NEAREST_MIPMAP_LINEAR),
+          magFilter(GL_LINEAR),
+          wrapS(GL_REPEAT),
+          wrapT(GL_REPEAT),
+          wrapR(GL_REPEAT),
+          compareMode(GL_NONE),
+          compareFunction(GL_LEQUAL),
+          maxAnisotropy(1.0f),
+          minLod(-1000.0f),
+          maxLod(1000.0f)
+    {
+    }
+
+    SamplerState SamplerState::nearest(GLenum wrap)
+    {
+        SamplerState state;
+        state.minFilter = GL_NEAREST;
+        state.magFilter = GL_NEAREST;
+        state.wrapS = state.wrapT = state.wrapR = wrap;
+        return state;
+    }
+
+    SamplerState SamplerState::linear(GLenum wrap)
+    {
+        SamplerState state;
+        state.minFilter = GL_LINEAR;
+        state.magFilter = GL_LINEAR;
+        state.wrapS = state.wrapT = state.wrapR = wrap;
+        return state;
+    }
+
+    SamplerState SamplerState::trilinear(GLenum wrap, GLfloat maxAnisotropy)
+    {
+        SamplerState state;
+        state.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        state.magFilter = GL_LINEAR;
+        state.wrapS = state.wrapT = state.wrapR = wrap;
+        state.maxAnisotropy = maxAnisotropy;
+        return state;
+    }
+
+    SamplerState SamplerState::depthCompare(GLenum minFilter, GLenum compareFunction)
+    {
+        SamplerState state;
+        state.minFilter = minFilter;
+        state.magFilter = GL_LINEAR;
+        state.wrapS = state.wrapT = state.wrapR = GL_CLAMP_TO_EDGE;
+        state.compareMode = GL_COMPARE_REF_TO_TEXTURE;
+        state.compareFunction = compareFunction;
+        return state;
+    }
+
+    bool SamplerState::operator<(const SamplerState &other) const
+    {
+        const GLenum enums[7] = { minFilter, magFilter, wrapS, wrapT, wrapR, compareMode, compareFunction };
+        const GLenum otherEnums[7] = { other.minFilter, other.magFilter, other.wrapS, other.wrapT, other.wrapR, other.compareMode, other.compareFunction };
+
+        for (int index = 0; index < 7; index++)
+        {
+            if (enums[index] != otherEnums[index])
+            {
+                return enums[index] < otherEnums[index];
+            }
+        }
+
+        if (maxAnisotropy != other.maxAnisotropy)
+        {
+            return maxAnisotropy < other.maxAnisotropy;
+        }
+        if (minLod != other.minLod)
+        {
+            return minLod < other.minLod;
+        }
+        return maxLod < other.maxLod;
+    }
+
+    GLuint SamplerCache::getSampler(const SamplerState &state)
+    {
+        if (maxSupportedAnisotropy == 0.0f)
+        {
+            maxSupportedAnisotropy = 1.0f;
+            if (GLExtensions::isSupported("GL_EXT_texture_filter_anisotropic"))
+            {
+                GL_CHECK(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxSupportedAnisotropy));
+            }
+        }
+
+        /* States asking for more anisotropy than supported all get the same sampler. */
+        SamplerState key = state;
+        if (key.maxAnisotropy > maxSupportedAnisotropy)
+        {
+            key.maxAnisotropy = maxSupportedAnisotropy;
+        }
+        if (key.maxAnisotropy < 1.0f)
+        {
+            key.maxAnisotropy = 1.0f;
+        }
+
+        std::map<SamplerState, GLuint>::iterator found = samplers.find(key);
+        if (found != samplers.end())
+        {
+            return found->second;
+        }
+
+        GLuint sampler = 0;
+        GL_CHECK(glGenSamplers(1, &sampler));
+        GL_CHECK(glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, key.minFilter));
+        GL_CHECK(glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, key.magFilter));
+        GL_CHECK(glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, key.wrapS));
+        GL_CHECK(glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, key.wrapT));
+        GL_CHECK(glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, key.wrapR));
+        GL_CHECK(glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_MODE, key.compareMode));
+        GL_CHECK(glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, key.compareFunction));
+        GL_CHECK(glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, key.minLod));
+        GL_CHECK(glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, key.maxLod));
+        if (maxSupportedAnisotropy > 1.0f)
+        {
+            GL_CHECK(glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, key.maxAnisotropy));
+        }
+
+        samplers[key] = sampler;
+        return sampler;
+    }
+
+    void SamplerCache::bind(GLuint unit, const SamplerState &state)
+    {
+        GLStateCache::bindSampler(unit, getSampler(state));
+    }
+
+    void SamplerCache::unbind(GLuint unit)
+    {
+        GLStateCache::bindSampler(unit, 0);
+    }
+
+    unsigned int SamplerCache::getNumberOfSamplers(void)
+    {
+        return (unsigned int)samplers.size();
+    }
+
+    void SamplerCache::clear(bool deleteObjects)
+    {
+        for (std::map<SamplerState, GLuint>::iterator sampler = samplers.begin(); deleteObjects && sampler != samplers.end(); ++sampler)
+        {
+            GLStateCache::deleteSamplers(1, &sampler->second);
+        }
+
+        samplers.clear();
+        maxSupportedAnisotropy = 0.0f;
+    }
+}
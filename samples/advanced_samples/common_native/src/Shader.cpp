@@ -19,87 +19,235 @@
  */
 
 #include "Shader.h"
+#include "AssetFile.h"
 #include "Platform.h"
+#include "ProgramBinaryCache.h"
+#include "StartupProfiler.h"
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if GLES_VERSION == 3
+#include <GLES3/gl31.h>
+#endif
 
 namespace MaliSDK
 {
-    void Shader::processShader(GLuint *shader, const char *filename, GLint shaderType)
+    /* The start of the line after #version, the source is not null-terminated. */
+    static const char *findLineAfterVersion(const char *source, GLint length)
+    {
+        const char *end = source + length;
+
+        for (const char *c = source; c + 8 <= end; c++)
+        {
+            if (memcmp(c, "#version", 8) == 0)
+            {
+                const char *newline = (const char *)memchr(c, '\n', end - c);
+
+                return newline != NULL ? newline + 1 : NULL;
+            }
+        }
+
+        return NULL;
+    }
+
+    void Shader::processShader(GLuint *shader, const char *filename, GLint shaderType, const char *defines)
     {  
-        const char *strings[1] = { NULL };
+        AssetFile source;
+
+        /* [Load shader source] */
+        loadShader(filename, &source);
+        /* [Load shader source] */
+
+        compileShader(shader, (const char *)source.getData(), (GLint)source.getSize(), shaderType, defines);
+    }
+
+    void Shader::processShaderSource(GLuint *shader, const char *source, GLint shaderType)
+    {
+        compileShader(shader, source, (GLint)strlen(source), shaderType);
+    }
+
+    void Shader::processProgram(GLuint *program, const char *vertexShaderFilename, const char *fragmentShaderFilename)
+    {
+        AssetFile files[2];
+
+        loadShader(vertexShaderFilename, &files[0]);
+        loadShader(fragmentShaderFilename, &files[1]);
+
+        const char *sources[2] = { (const char *)files[0].getData(), (const char *)files[1].getData() };
+        const size_t lengths[2] = { files[0].getSize(), files[1].getSize() };
+        std::string name = std::string(vertexShaderFilename) + " and " + fragmentShaderFilename;
+
+        linkProgram(program, sources, lengths, name.c_str());
+    }
+
+    void Shader::processProgramSource(GLuint *program, const char *vertexShaderSource, const char *fragmentShaderSource)
+    {
+        const char *sources[2] = { vertexShaderSource, fragmentShaderSource };
+        const size_t lengths[2] = { strlen(vertexShaderSource), strlen(fragmentShaderSource) };
+
+        linkProgram(program, sources, lengths, "built-in shaders");
+    }
+
+#if GLES_VERSION == 3
+    void Shader::processComputeProgramSource(GLuint *program, const char *computeShaderSource)
+    {
+        GLuint computeShader;
+
+        compileShader(&computeShader, computeShaderSource, (GLint)strlen(computeShaderSource), GL_COMPUTE_SHADER);
+
+        *program = GL_CHECK(glCreateProgram());
+        GL_CHECK(glAttachShader(*program, computeShader));
+        GL_CHECK(glLinkProgram(*program));
+        GL_CHECK(glDeleteShader(computeShader));
+
+        GLint status;
+        GL_CHECK(glGetProgramiv(*program, GL_LINK_STATUS, &status));
+
+        if(status != GL_TRUE)
+        {
+            dumpProgramLog(*program);
+
+            LOGE("Linking compute shader FAILED!\n\n");
+            exit(1);
+        }
+    }
+#endif
+
+    void Shader::linkProgram(GLuint *program, const char * const sources[2], const size_t lengths[2], const char *name)
+    {
+        STARTUP_PHASE(PHASE_SHADERS);
+        unsigned long long key = ProgramBinaryCache::computeKey(sources, lengths, 2);
+
+        *program = GL_CHECK(glCreateProgram());
+
+        /* Only compile and link from source if there's no usable binary from a previous run. */
+        if (!ProgramBinaryCache::loadProgram(*program, key))
+        {
+            GLuint vertexShader = 0;
+            GLuint fragmentShader = 0;
+
+            compileShader(&vertexShader, sources[0], (GLint)lengths[0], GL_VERTEX_SHADER);
+            compileShader(&fragmentShader, sources[1], (GLint)lengths[1], GL_FRAGMENT_SHADER);
+
+            GL_CHECK(glAttachShader(*program, vertexShader));
+            GL_CHECK(glAttachShader(*program, fragmentShader));
+            ProgramBinaryCache::prepareProgram(*program);
+            GL_CHECK(glLinkProgram(*program));
+
+            /* The program keeps what it needs, the shaders are only flagged for deletion. */
+            GL_CHECK(glDeleteShader(vertexShader));
+            GL_CHECK(glDeleteShader(fragmentShader));
+
+            GLint status;
+            GL_CHECK(glGetProgramiv(*program, GL_LINK_STATUS, &status));
+
+            if(status != GL_TRUE)
+            {
+                dumpProgramLog(*program);
+
+                LOGE("Linking %s FAILED!\n\n", name);
+                exit(1);
+            }
+
+            ProgramBinaryCache::storeProgram(*program, key);
+        }
+    }
+
+    void Shader::compileShader(GLuint *shader, const char *source, GLint length, GLint shaderType, const char *defines)
+    {
+        STARTUP_PHASE(PHASE_SHADERS);
+        const char *strings[3] = { source, NULL, NULL };
+        GLint lengths[3] = { length, 0, 0 };
+        GLsizei count = 1;
+
+        /* Nothing but comments may come before #version, so the defines go after its line. */
+        if (defines != NULL)
+        {
+            const char *afterVersion = findLineAfterVersion(source, length);
+
+            if (afterVersion == NULL)
+            {
+                LOGE("Cannot insert defines into a shader without a #version line.\n");
+                exit(1);
+            }
+
+            lengths[0] = (GLint)(afterVersion - source);
+            strings[1] = defines;
+            lengths[1] = (GLint)strlen(defines);
+            strings[2] = afterVersion;
+            lengths[2] = length - lengths[0];
+            count = 3;
+        }
 
         /* Create shader and load into GL. */
+        /* [Create shader object] */
         *shader = GL_CHECK(glCreateShader(shaderType));
-        strings[0] = loadShader(filename);
-        GL_CHECK(glShaderSource(*shader, 1, strings, NULL));
-
-        /* Clean up shader source. */
-        free((void *)(strings[0]));
-        strings[0] = NULL;
+        /* [Create shader object] */
+        /* [Attach shader source] */
+        GL_CHECK(glShaderSource(*shader, count, strings, lengths));
+        /* [Attach shader source] */
 
         /* Try compiling the shader. */
+        /* [Compile a shader] */
         GL_CHECK(glCompileShader(*shader));
+        /* [Compile a shader] */
         GLint status;
+        /* [Get compilation status] */
         GL_CHECK(glGetShaderiv(*shader, GL_COMPILE_STATUS, &status));
+        /* [Get compilation status] */
 
         /* Dump debug info (source and log) if compilation failed. */
         if(status != GL_TRUE) 
         {
-            GLint length;
-            char *debugSource = NULL;
-            char *errorLog = NULL;
-
-            /* Get shader source. */
-            GL_CHECK(glGetShaderiv(*shader, GL_SHADER_SOURCE_LENGTH, &length));
-            debugSource = (char *)malloc(length);
-            GL_CHECK(glGetShaderSource(*shader, length, NULL, debugSource));
-            LOGE("Debug source START:\n%s\nDebug source END\n\n", debugSource);
-            free(debugSource);
-
-            /* Now get the info log. */
-            GL_CHECK(glGetShaderiv(*shader, GL_INFO_LOG_LENGTH, &length));
-            errorLog = (char *)malloc(length);
-            GL_CHECK(glGetShaderInfoLog(*shader, length, NULL, errorLog));
-            LOGE("Log START:\n%s\nLog END\n\n", errorLog);
-            free(errorLog);
-
+            dumpShaderLog(*shader);
             LOGE("Compilation FAILED!\n\n");
             exit(1);
         }
     }
 
-    char* Shader::loadShader(const char *filename)
+    void Shader::dumpShaderLog(GLuint shader)
+    {
+        GLint length;
+        char *debugSource = NULL;
+        char *errorLog = NULL;
+
+        /* Get shader source. */
+        GL_CHECK(glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &length));
+        debugSource = (char *)malloc(length);
+        GL_CHECK(glGetShaderSource(shader, length, NULL, debugSource));
+        LOGE("Debug source START:\n%s\nDebug source END\n\n", debugSource);
+        free(debugSource);
+
+        /* Now get the info log. */
+        GL_CHECK(glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length));
+        errorLog = (char *)malloc(length);
+        GL_CHECK(glGetShaderInfoLog(shader, length, NULL, errorLog));
+        LOGE("Log START:\n%s\nLog END\n\n", errorLog);
+        free(errorLog);
+    }
+
+    void Shader::dumpProgramLog(GLuint program)
     {
-        FILE *file = fopen(filename, "rb");
-        if(file == NULL)
+        GLint length;
+        char *errorLog = NULL;
+
+        GL_CHECK(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+        errorLog = (char *)malloc(length);
+        GL_CHECK(glGetProgramInfoLog(program, length, NULL, errorLog));
+        LOGE("Log START:\n%s\nLog END\n\n", errorLog);
+        free(errorLog);
+    }
+
+    void Shader::loadShader(const char *filename, AssetFile *file)
+    {
+        /* The source is handed to glShaderSource() straight from the mapping, with its length. */
+        if (!file->open(filename))
         {
             LOGE("Cannot read file '%s'\n", filename);
             exit(1);
         }
-        /* Seek end of file. */
-        fseek(file, 0, SEEK_END);
-        /* Record the size of the file for memory allocation. */
-        long length = ftell(file);
-        /* Seek start of file again. */
-        fseek(file, 0, SEEK_SET); 
-        char *shader = (char *)calloc(length + 1, sizeof(char));
-        if(shader == NULL)
-        {
-            LOGE("Out of memory at %s:%i\n", __FILE__, __LINE__);
-            exit(1);
-        }
-        /* Read in the file */
-        size_t numberOfBytesRead = fread(shader, sizeof(char), length, file);
-        if (numberOfBytesRead != length) 
-        {
-            LOGE("Error reading %s (read %zu of %ld)", filename, numberOfBytesRead, length);
-            exit(1);
-        }
-        shader[length] = '\0';
-        fclose(file);
-
-        return shader;
     }
 }
@@ -0,0 +1,318 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ShaderVariants.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+#include "ProgramBinaryCache.h"
+#include "Shader.h"
+
+#include <EGL/egl.h>
+#include <cstdlib>
+#include <cstring>
+
+#if GLES_VERSION == 3
+#include <GLES3/gl31.h>
+#endif
+
+/* GL_KHR_parallel_shader_compile, not part of the core headers. */
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (GL_APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_LOCAL)(GLuint count);
+
+namespace MaliSDK
+{
+    ShaderVariants::ShaderVariants(const char *vertexShaderSource, const char *fragmentShaderSource)
+        : numberOfShaders(2),
+          workerPool(NULL),
+          useParallelCompile(false),
+          checkedExtensions(false)
+    {
+        shaderTypes[0] = GL_VERTEX_SHADER;
+        shaderTypes[1] = GL_FRAGMENT_SHADER;
+        baseSources[0] = vertexShaderSource;
+        baseSources[1] = fragmentShaderSource;
+    }
+
+#if GLES_VERSION == 3
+    ShaderVariants::ShaderVariants(const char *computeShaderSource)
+        : numberOfShaders(1),
+          workerPool(NULL),
+          useParallelCompile(false),
+          checkedExtensions(false)
+    {
+        shaderTypes[0] = GL_COMPUTE_SHADER;
+        shaderTypes[1] = GL_NONE;
+        baseSources[0] = computeShaderSource;
+    }
+#endif
+
+    ShaderVariants::~ShaderVariants(void)
+    {
+        for (std::map<unsigned int, Variant>::iterator variant = variants.begin(); variant != variants.end(); ++variant)
+        {
+            /* The worker may still use the objects. */
+            if (variant->second.job != NULL)
+            {
+                workerPool->wait(variant->second.job);
+                variant->second.job = NULL;
+            }
+
+            for (int shaderIndex = 0; shaderIndex < numberOfShaders; shaderIndex++)
+            {
+                if (variant->second.shaders[shaderIndex] != 0)
+                {
+                    GL_CHECK(glDeleteShader(variant->second.shaders[shaderIndex]));
+                }
+            }
+            GL_CHECK(glDeleteProgram(variant->second.program));
+        }
+    }
+
+    unsigned int ShaderVariants::addFeature(const char *define)
+    {
+        if (!variants.empty())
+        {
+            LOGE("ShaderVariants::addFeature() called after a variant was requested.\n");
+            exit(1);
+        }
+
+        if (features.size() >= 32)
+        {
+            return 0;
+        }
+
+        features.push_back(define);
+        return 1u << (features.size() - 1);
+    }
+
+    void ShaderVariants::setWorkerPool(GLWorkerPool *pool)
+    {
+        workerPool = pool;
+    }
+
+    void ShaderVariants::compileAndLink(Variant *variant)
+    {
+        const ShaderVariants *owner = variant->owner;
+
+        variant->program = GL_CHECK(glCreateProgram());
+
+        for (int shaderIndex = 0; shaderIndex < owner->numberOfShaders; shaderIndex++)
+        {
+            const char *strings[1] = { variant->sources[shaderIndex].c_str() };
+
+            variant->shaders[shaderIndex] = GL_CHECK(glCreateShader(owner->shaderTypes[shaderIndex]));
+            GL_CHECK(glShaderSource(variant->shaders[shaderIndex], 1, strings, NULL));
+
+            /* Querying the compile status here would serialise the compiler, so it is left to finishVariant(). */
+            GL_CHECK(glCompileShader(variant->shaders[shaderIndex]));
+            GL_CHECK(glAttachShader(variant->program, variant->shaders[shaderIndex]));
+        }
+
+        ProgramBinaryCache::prepareProgram(variant->program);
+        GL_CHECK(glLinkProgram(variant->program));
+    }
+
+    void ShaderVariants::buildJob(void *userData)
+    {
+        compileAndLink((Variant *)userData);
+    }
+
+    ShaderVariants::Variant &ShaderVariants::startVariant(unsigned int featureMask)
+    {
+        std::map<unsigned int, Variant>::iterator found = variants.find(featureMask);
+        if (found != variants.end())
+        {
+            return found->second;
+        }
+
+        if (!checkedExtensions)
+        {
+            checkedExtensions = true;
+            useParallelCompile = GLExtensions::isSupported("GL_KHR_parallel_shader_compile");
+
+            /* Let the driver use as many threads as it likes. */
+            PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_LOCAL maxShaderCompilerThreads = useParallelCompile ?
+                (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_LOCAL)eglGetProcAddress("glMaxShaderCompilerThreadsKHR") : NULL;
+            if (maxShaderCompilerThreads != NULL)
+            {
+                GL_CHECK(maxShaderCompilerThreads(0xFFFFFFFF));
+            }
+        }
+
+        /* The map never moves its elements, so a worker can keep a pointer to the variant it builds. */
+        Variant &variant = variants[featureMask];
+        variant.owner = this;
+        variant.program = 0;
+        variant.shaders[0] = 0;
+        variant.shaders[1] = 0;
+        variant.ready = false;
+        variant.job = NULL;
+
+        std::string defines;
+        for (size_t feature = 0; feature < features.size(); feature++)
+        {
+            if (featureMask & (1u << feature))
+            {
+                defines += "#define " + features[feature] + " 1\n";
+            }
+        }
+
+        const char *sources[2];
+        for (int shaderIndex = 0; shaderIndex < numberOfShaders; shaderIndex++)
+        {
+            /* The defines go after the #version line, which has to come first. */
+            std::string &source = variant.sources[shaderIndex];
+            source = baseSources[shaderIndex];
+
+            size_t versionEnd = source.compare(0, 8, "#version") == 0 ? source.find('\n') : std::string::npos;
+            if (versionEnd == std::string::npos)
+            {
+                LOGE("ShaderVariants: the shader sources have to start with a #version line.\n");
+                exit(1);
+            }
+            source.insert(versionEnd + 1, defines);
+            sources[shaderIndex] = source.c_str();
+        }
+
+        variant.key = ProgramBinaryCache::computeKey(sources, numberOfShaders);
+
+        /* Programs cached by a previous run only need their binary loaded. */
+        variant.program = GL_CHECK(glCreateProgram());
+        if (ProgramBinaryCache::loadProgram(variant.program, variant.key))
+        {
+            variant.ready = true;
+            return variant;
+        }
+
+        /* A worker builds into a program of its own, so it never touches an object the rendering thread holds. */
+        GL_CHECK(glDeleteProgram(variant.program));
+        variant.program = 0;
+
+        if (!useParallelCompile && workerPool != NULL && workerPool->getNumberOfWorkers() > 0)
+        {
+            variant.job = workerPool->submit(buildJob, &variant);
+        }
+        else
+        {
+            compileAndLink(&variant);
+        }
+
+        return variant;
+    }
+
+    bool ShaderVariants::finishVariant(Variant &variant, bool wait)
+    {
+        if (variant.ready)
+        {
+            return true;
+        }
+
+        if (variant.job != NULL)
+        {
+            if (!wait && !workerPool->isComplete(variant.job))
+            {
+                return false;
+            }
+            workerPool->wait(variant.job);
+            variant.job = NULL;
+        }
+        else if (useParallelCompile && !wait)
+        {
+            GLint complete = GL_FALSE;
+            GL_CHECK(glGetProgramiv(variant.program, GL_COMPLETION_STATUS_KHR, &complete));
+            if (complete != GL_TRUE)
+            {
+                return false;
+            }
+        }
+
+        /* Blocks until the driver is done, if it still compiles. */
+        GLint status;
+        GL_CHECK(glGetProgramiv(variant.program, GL_LINK_STATUS, &status));
+
+        if (status != GL_TRUE)
+        {
+            for (int shaderIndex = 0; shaderIndex < numberOfShaders; shaderIndex++)
+            {
+                GLint compileStatus;
+                GL_CHECK(glGetShaderiv(variant.shaders[shaderIndex], GL_COMPILE_STATUS, &compileStatus));
+
+                if (compileStatus != GL_TRUE)
+                {
+                    Shader::dumpShaderLog(variant.shaders[shaderIndex]);
+                    LOGE("Compilation FAILED!\n\n");
+                    exit(1);
+                }
+            }
+
+            Shader::dumpProgramLog(variant.program);
+
+            LOGE("Linking program %u FAILED!\n\n", variant.program);
+            exit(1);
+        }
+
+        ProgramBinaryCache::storeProgram(variant.program, variant.key);
+
+        /* The program keeps what it needs, the shaders are only flagged for deletion. */
+        for (int shaderIndex = 0; shaderIndex < numberOfShaders; shaderIndex++)
+        {
+            GL_CHECK(glDeleteShader(variant.shaders[shaderIndex]));
+            variant.shaders[shaderIndex] = 0;
+        }
+
+        variant.ready = true;
+        return true;
+    }
+
+    void ShaderVariants::request(unsigned int featureMask)
+    {
+        startVariant(featureMask);
+    }
+
+    GLuint ShaderVariants::tryGetProgram(unsigned int featureMask)
+    {
+        Variant &variant = startVariant(featureMask);
+
+        return finishVariant(variant, false) ? variant.program : 0;
+    }
+
+    GLuint ShaderVariants::getProgram(unsigned int featureMask)
+    {
+        Variant &variant = startVariant(featureMask);
+
+        finishVariant(variant, true);
+        return variant.program;
+    }
+
+    bool ShaderVariants::isReady(unsigned int featureMask)
+    {
+        std::map<unsigned int, Variant>::iterator found = variants.find(featureMask);
+
+        return found != variants.end() && finishVariant(found->second, false);
+    }
+
+    unsigned int ShaderVariants::getNumberOfVariants(void) const
+    {
+        return (unsigned int)variants.size();
+    }
+}
@@ -0,0 +1,151 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SimulationThread.h"
+#include "Platform.h"
+
+#include <cstdlib>
+#include <time.h>
+
+namespace MaliSDK
+{
+    SimulationThread::SimulationThread(void)
+        : stepFunction(NULL),
+          userData(NULL),
+          stepInterval(0),
+          timer(Timer::AnimationClock),
+          threadStarted(false),
+          stopping(false)
+    {
+    }
+
+    SimulationThread::~SimulationThread(void)
+    {
+        stop();
+    }
+
+    void SimulationThread::step(void)
+    {
+        stepFunction(timer.getInterval(), snapshots.getWriteBuffer(), userData);
+        snapshots.publish();
+    }
+
+    void *SimulationThread::threadFunction(void *simulation)
+    {
+        SimulationThread *self = (SimulationThread *)simulation;
+
+        /* Sleep to absolute deadlines, so the time the steps take does not add up to a drift of the rate. */
+        timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+        while (!self->stopping.load())
+        {
+            long long nanoseconds = deadline.tv_nsec + self->stepInterval;
+            deadline.tv_sec += (time_t)(nanoseconds / 1000000000LL);
+            deadline.tv_nsec = (long)(nanoseconds % 1000000000LL);
+
+            /* Behind by more than a step: skip the missed ones rather than running them back to back. */
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec > deadline.tv_nsec))
+            {
+                deadline = now;
+            }
+            else
+            {
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) != 0 && !self->stopping.load())
+                {
+                }
+            }
+
+            if (!self->stopping.load())
+            {
+                self->step();
+            }
+        }
+
+        return NULL;
+    }
+
+    void SimulationThread::start(size_t snapshotSize, StepFunction stepFunction, void *userData, float stepsPerSecond)
+    {
+        if (threadStarted)
+        {
+            LOGE("SimulationThread: start() called while the simulation is running.\n");
+            exit(1);
+        }
+
+        snapshots.initialize(snapshotSize);
+        this->stepFunction = stepFunction;
+        this->userData = userData;
+        stepInterval = (long long)(1000000000.0 / stepsPerSecond);
+        stopping.store(false);
+
+        /* update() has a snapshot from the first frame on. */
+        timer.reset();
+        step();
+
+        if (Timer::isFixedTimeStep())
+        {
+            LOGI("SimulationThread: a fixed time step is set, stepping on the rendering thread.\n");
+        }
+        else if (pthread_create(&thread, NULL, &threadFunction, this) != 0)
+        {
+            LOGI("SimulationThread: cannot start a thread, stepping on the rendering thread.\n");
+        }
+        else
+        {
+            threadStarted = true;
+        }
+    }
+
+    void SimulationThread::stop(void)
+    {
+        if (threadStarted)
+        {
+            stopping.store(true);
+            pthread_join(thread, NULL);
+            threadStarted = false;
+        }
+
+        stepFunction = NULL;
+        snapshots.terminate();
+    }
+
+    const void *SimulationThread::update(void)
+    {
+        if (stepFunction == NULL)
+        {
+            return NULL;
+        }
+
+        if (!threadStarted)
+        {
+            step();
+        }
+
+        return snapshots.acquire();
+    }
+
+    bool SimulationThread::isThreaded(void) const
+    {
+        return threadStarted;
+    }
+}
@@ -0,0 +1,271 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "StartupProfiler.h"
+#include "Platform.h"
+#include "Timer.h"
+
+#include <time.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+
+namespace MaliSDK
+{
+    static Timer startupTimer(Timer::RealClock);
+
+    static const char *phaseNames[StartupProfiler::NUMBER_OF_PHASES] =
+    {
+        "egl",
+        "asset_io",
+        "decode",
+        "shaders",
+        "upload",
+        "first_frame",
+        "other"
+    };
+
+    StartupProfiler::State StartupProfiler::state = StartupProfiler::STATE_IDLE;
+    pthread_t StartupProfiler::thread;
+    long long StartupProfiler::lastTime = 0;
+    double StartupProfiler::phaseTimes[StartupProfiler::NUMBER_OF_PHASES];
+    double StartupProfiler::launchTime = 0.0;
+    StartupProfiler::Phase StartupProfiler::openPhases[StartupProfiler::maximumDepth];
+    int StartupProfiler::depth = 0;
+
+    /* Milliseconds since the process started, from its start time in /proc/self/stat, 0 if it cannot be read. */
+    static double getProcessAge(void)
+    {
+#if defined(__linux__) || defined(ANDROID)
+        FILE *file = fopen("/proc/self/stat", "r");
+        if (file == NULL)
+        {
+            return 0.0;
+        }
+
+        char line[1024];
+        bool read = fgets(line, sizeof(line), file) != NULL;
+        fclose(file);
+
+        /* The name in brackets may contain spaces, the fields are counted from the last bracket. */
+        const char *fields = read ? strrchr(line, ')') : NULL;
+        if (fields == NULL)
+        {
+            return 0.0;
+        }
+
+        /* The start time is field 22, the state after the bracket is field 3. */
+        unsigned long long startTicks = 0;
+        int field = 2;
+        for (const char *character = fields + 1; *character != '\0'; character++)
+        {
+            if (*character == ' ' && ++field == 22)
+            {
+                if (sscanf(character + 1, "%llu", &startTicks) != 1)
+                {
+                    return 0.0;
+                }
+                break;
+            }
+        }
+
+        long ticksPerSecond = sysconf(_SC_CLK_TCK);
+        timespec now;
+        if (startTicks == 0 || ticksPerSecond <= 0 || clock_gettime(CLOCK_BOOTTIME, &now) != 0)
+        {
+            return 0.0;
+        }
+
+        double age = (now.tv_sec + now.tv_nsec / 1000000000.0 - (double)startTicks / ticksPerSecond) * 1000.0;
+        return age > 0.0 ? age : 0.0;
+#else
+        return 0.0;
+#endif
+    }
+
+    bool StartupProfiler::isRecording(void)
+    {
+        return (state == STATE_INIT || state == STATE_FIRST_FRAME) && pthread_equal(thread, pthread_self());
+    }
+
+    void StartupProfiler::accumulate(void)
+    {
+        long long now = startupTimer.getTimeNanoseconds();
+        int top = depth < maximumDepth ? depth : maximumDepth;
+        Phase phase = top > 0 ? openPhases[top - 1] : (state == STATE_INIT ? PHASE_OTHER : PHASE_FIRST_FRAME);
+
+        phaseTimes[phase] += (now - lastTime) / 1000000.0;
+        lastTime = now;
+    }
+
+    void StartupProfiler::start(void)
+    {
+        if (state != STATE_IDLE)
+        {
+            return;
+        }
+
+        for (int phase = 0; phase < NUMBER_OF_PHASES; phase++)
+        {
+            phaseTimes[phase] = 0.0;
+        }
+        depth = 0;
+        launchTime = getProcessAge();
+        thread = pthread_self();
+        state = STATE_INIT;
+        lastTime = startupTimer.getTimeNanoseconds();
+    }
+
+    void StartupProfiler::beginPhase(Phase phase)
+    {
+        if (!isRecording())
+        {
+            return;
+        }
+
+        accumulate();
+
+        /* Deeper phases are counted in the one they are opened in. */
+        if (depth < maximumDepth)
+        {
+            openPhases[depth] = phase;
+        }
+        depth++;
+    }
+
+    void StartupProfiler::endPhase(void)
+    {
+        if (!isRecording())
+        {
+            return;
+        }
+
+        if (depth == 0)
+        {
+            LOGE("StartupProfiler::endPhase() without an open phase.\n");
+            return;
+        }
+
+        accumulate();
+        depth--;
+    }
+
+    void StartupProfiler::endInit(void)
+    {
+        if (!isRecording() || state != STATE_INIT)
+        {
+            return;
+        }
+
+        accumulate();
+        state = STATE_FIRST_FRAME;
+    }
+
+    void StartupProfiler::endFrame(void)
+    {
+        if (!isRecording())
+        {
+            return;
+        }
+
+        if (depth > 0)
+        {
+            LOGE("StartupProfiler::endFrame() with %d phases still open.\n", depth);
+        }
+
+        accumulate();
+        state = STATE_FINISHED;
+        log();
+    }
+
+    bool StartupProfiler::isFinished(void)
+    {
+        return state == STATE_FINISHED;
+    }
+
+    double StartupProfiler::getMilliseconds(Phase phase)
+    {
+        if (phase != NUMBER_OF_PHASES)
+        {
+            return phaseTimes[phase];
+        }
+
+        double total = 0.0;
+        for (int index = 0; index < NUMBER_OF_PHASES; index++)
+        {
+            total += phaseTimes[index];
+        }
+
+        return total;
+    }
+
+    double StartupProfiler::getLaunchMilliseconds(void)
+    {
+        return launchTime;
+    }
+
+    const char *StartupProfiler::getPhaseName(Phase phase)
+    {
+        return phase < NUMBER_OF_PHASES ? phaseNames[phase] : "total";
+    }
+
+    void StartupProfiler::log(void)
+    {
+        double total = getMilliseconds(NUMBER_OF_PHASES);
+
+        LOGI("Startup: %.1f ms to the first frame, %.1f ms from the start of the process to init.\n", total, launchTime);
+        for (int phase = 0; phase < NUMBER_OF_PHASES; phase++)
+        {
+            LOGI("  %12s: %8.1f ms %5.1f %%\n", phaseNames[phase], phaseTimes[phase],
+                 total > 0.0 ? phaseTimes[phase] * 100.0 / total : 0.0);
+        }
+    }
+}
+
+extern "C" void MaliSDK_StartupProfiler_start(void)
+{
+    MaliSDK::StartupProfiler::start();
+}
+
+extern "C" void MaliSDK_StartupProfiler_endInit(void)
+{
+    MaliSDK::StartupProfiler::endInit();
+}
+
+extern "C" void MaliSDK_StartupProfiler_endFrame(void)
+{
+    MaliSDK::StartupProfiler::endFrame();
+}
+
+extern "C" int MaliSDK_StartupProfiler_getBreakdown(double *milliseconds, int numberOfPhases)
+{
+    if (!MaliSDK::StartupProfiler::isFinished())
+    {
+        return 0;
+    }
+
+    int count = numberOfPhases < MaliSDK::StartupProfiler::NUMBER_OF_PHASES ? numberOfPhases : (int)MaliSDK::StartupProfiler::NUMBER_OF_PHASES;
+    for (int phase = 0; phase < count; phase++)
+    {
+        milliseconds[phase] = MaliSDK::StartupProfiler::getMilliseconds((MaliSDK::StartupProfiler::Phase)phase);
+    }
+
+    return count;
+}
@@ -0,0 +1,252 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "StreamingBuffer.h"
+#include "FenceSync.h"
+#include "GLCapture.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+
+#include <EGL/egl.h>
+#include <cstring>
+
+/* GL_EXT_buffer_storage, not part of the core headers. */
+#ifndef GL_MAP_PERSISTENT_BIT_EXT
+#define GL_MAP_PERSISTENT_BIT_EXT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT_EXT
+#define GL_MAP_COHERENT_BIT_EXT 0x0080
+#endif
+
+namespace MaliSDK
+{
+    static GLsizeiptr alignUp(GLsizeiptr value, GLsizeiptr alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    StreamingBuffer::StreamingBuffer(GLenum target, GLsizeiptr frameSize, unsigned int framesInFlight)
+        : target(target),
+          buffer(0),
+          persistent(false),
+          persistentData(NULL),
+          regionSize(alignUp(frameSize, 256)),
+          numberOfRegions(framesInFlight > 0 ? framesInFlight : 1),
+          fences(numberOfRegions, (GLsync)NULL),
+          region(0),
+          head(0),
+          mapped(false),
+          uploadedBytes(0),
+          totalUploadedBytes(0),
+          stalls(0),
+          orphans(0)
+    {
+        GLsizeiptr size = regionSize * numberOfRegions;
+
+        GL_CHECK(glGenBuffers(1, &buffer));
+        GL_CHECK(glBindBuffer(target, buffer));
+
+        /* GLCapture only sees what is written to a mapping when it is unmapped, which a persistent mapping never is. */
+        BufferStorageFunction bufferStorage = NULL;
+        if (!GLCapture::isCapturing() && GLExtensions::isSupported("GL_EXT_buffer_storage"))
+        {
+            bufferStorage = (BufferStorageFunction)eglGetProcAddress("glBufferStorageEXT");
+        }
+
+        if (bufferStorage != NULL)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT;
+
+            GL_CHECK(bufferStorage(target, size, NULL, flags));
+            GL_CHECK(persistentData = (unsigned char *)glMapBufferRange(target, 0, size, flags));
+            persistent = (persistentData != NULL);
+        }
+
+        if (!persistent)
+        {
+            /* Storage made with glBufferStorageEXT is immutable, start over with a buffer that can be orphaned. */
+            if (bufferStorage != NULL)
+            {
+                LOGE("Failed to map the streaming buffer persistently, falling back to glMapBufferRange.");
+                GL_CHECK(glDeleteBuffers(1, &buffer));
+                GL_CHECK(glGenBuffers(1, &buffer));
+                GL_CHECK(glBindBuffer(target, buffer));
+            }
+
+            GL_CHECK(glBufferData(target, size, NULL, GL_STREAM_DRAW));
+        }
+        GL_CHECK(glBindBuffer(target, 0));
+
+        /* The first beginFrame() moves to region 0. */
+        region = numberOfRegions - 1;
+    }
+
+    StreamingBuffer::~StreamingBuffer(void)
+    {
+        deleteFences();
+
+        /* Deleting a buffer unmaps it. */
+        GL_CHECK(glDeleteBuffers(1, &buffer));
+    }
+
+    void StreamingBuffer::deleteFences(void)
+    {
+        for (unsigned int i = 0; i < numberOfRegions; i++)
+        {
+            if (fences[i])
+            {
+                GL_CHECK(glDeleteSync(fences[i]));
+                fences[i] = NULL;
+            }
+        }
+    }
+
+    void StreamingBuffer::beginFrame(void)
+    {
+        if (mapped)
+        {
+            unmap();
+        }
+
+        region = (region + 1) % numberOfRegions;
+        head = 0;
+        uploadedBytes = 0;
+
+        GLsync fence = fences[region];
+        if (!fence)
+        {
+            return;
+        }
+
+        bool signalled = FenceSync::wait(fence, false, "streaming buffer");
+        if (!signalled && !persistent)
+        {
+            /* The frames still reading the old storage keep it alive, every region of the new one is free. */
+            GL_CHECK(glBindBuffer(target, buffer));
+            GL_CHECK(glBufferData(target, regionSize * numberOfRegions, NULL, GL_STREAM_DRAW));
+            GL_CHECK(glBindBuffer(target, 0));
+            deleteFences();
+            orphans++;
+            return;
+        }
+
+        if (!signalled)
+        {
+            stalls++;
+            FenceSync::wait(fence, true, "streaming buffer");
+        }
+
+        GL_CHECK(glDeleteSync(fence));
+        fences[region] = NULL;
+    }
+
+    void *StreamingBuffer::map(GLsizeiptr size, GLintptr *offset, GLsizeiptr alignment)
+    {
+        if (mapped)
+        {
+            unmap();
+        }
+
+        GLsizeiptr start = alignUp(head, alignment > 0 ? alignment : 1);
+        if (start + size > regionSize)
+        {
+            LOGE("Streaming buffer is full, %d of %d bytes used this frame.", (int)head, (int)regionSize);
+            return NULL;
+        }
+
+        head = start + size;
+        *offset = region * regionSize + start;
+        uploadedBytes += size;
+        totalUploadedBytes += size;
+
+        if (persistent)
+        {
+            return persistentData + *offset;
+        }
+
+        /* The fence waited on in beginFrame() guarantees the GPU is done with this region, no need to synchronize again. */
+        GL_CHECK(glBindBuffer(target, buffer));
+        GL_CHECK(void *data = glMapBufferRange(target, *offset, size,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        if (data == NULL)
+        {
+            LOGE("Failed to map the streaming buffer.");
+            GL_CHECK(glBindBuffer(target, 0));
+            return NULL;
+        }
+
+        mapped = true;
+        return data;
+    }
+
+    void StreamingBuffer::unmap(void)
+    {
+        if (!mapped)
+        {
+            return;
+        }
+
+        GL_CHECK(glBindBuffer(target, buffer));
+        GL_CHECK(glUnmapBuffer(target));
+        GL_CHECK(glBindBuffer(target, 0));
+        mapped = false;
+    }
+
+    void StreamingBuffer::endFrame(void)
+    {
+        unmap();
+
+        if (fences[region])
+        {
+            GL_CHECK(glDeleteSync(fences[region]));
+        }
+        GL_CHECK(fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    }
+
+    GLuint StreamingBuffer::getBuffer(void) const
+    {
+        return buffer;
+    }
+
+    bool StreamingBuffer::isPersistent(void) const
+    {
+        return persistent;
+    }
+
+    GLsizeiptr StreamingBuffer::getUploadedBytes(void) const
+    {
+        return uploadedBytes;
+    }
+
+    unsigned long long StreamingBuffer::getTotalUploadedBytes(void) const
+    {
+        return totalUploadedBytes;
+    }
+
+    unsigned int StreamingBuffer::getStalls(void) const
+    {
+        return stalls;
+    }
+
+    unsigned int StreamingBuffer::getOrphans(void) const
+    {
+        return orphans;
+    }
+}
@@ -0,0 +1,366 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TangentFrames.h"
+#include "JobScheduler.h"
+
+#include <cmath>
+
+namespace MaliSDK
+{
+    /* Shared by the jobs accumulating the tangents of the vertices. */
+    struct TangentGather
+    {
+        const IndexedModel *model;
+        /* Unit tangent of each triangle, in the plane of the triangle. */
+        const float *triangleTangents;
+        /* Handedness of each triangle, 1 or -1. */
+        const float *triangleSigns;
+        /* Corners, triangle * 3 + corner, using each vertex: cornerStart[v] to cornerStart[v + 1]. */
+        const unsigned int *cornerStart;
+        const unsigned int *corners;
+        /* Tangent and handedness of each vertex. */
+        float *tangents;
+    };
+
+    static float dot(const float *a, const float *b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    static bool normalize(float *v)
+    {
+        float length = sqrtf(dot(v, v));
+        if (length < 1e-20f)
+        {
+            return false;
+        }
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+        return true;
+    }
+
+    /* Remove the part of v along the unit vector n. */
+    static void makeOrthogonal(const float *n, float *v)
+    {
+        float d = dot(n, v);
+        v[0] -= n[0] * d;
+        v[1] -= n[1] * d;
+        v[2] -= n[2] * d;
+    }
+
+    /* Any unit vector orthogonal to the unit vector n, for vertices whose triangles give no tangent. */
+    static void anyOrthogonal(const float *n, float *v)
+    {
+        float axis[3] = { 0.0f, 0.0f, 0.0f };
+        axis[fabsf(n[0]) < 0.9f ? 0 : 1] = 1.0f;
+        v[0] = axis[0];
+        v[1] = axis[1];
+        v[2] = axis[2];
+        makeOrthogonal(n, v);
+        normalize(v);
+    }
+
+    static void gatherTangents(unsigned int begin, unsigned int end, void *userData)
+    {
+        const TangentGather *gather = (const TangentGather *)userData;
+        const IndexedModel &model = *gather->model;
+
+        for (unsigned int v = begin; v < end; v++)
+        {
+            const float *vertex = &model.vertices[v * model.floatsPerVertex];
+            float normal[3] = { vertex[model.normalOffset], vertex[model.normalOffset + 1], vertex[model.normalOffset + 2] };
+            normalize(normal);
+
+            float *tangent = gather->tangents + v * 4;
+            tangent[0] = tangent[1] = tangent[2] = 0.0f;
+            tangent[3] = 1.0f;
+
+            for (unsigned int c = gather->cornerStart[v]; c < gather->cornerStart[v + 1]; c++)
+            {
+                unsigned int corner = gather->corners[c];
+                unsigned int triangle = corner / 3;
+                const unsigned short *indices = &model.indices[triangle * 3];
+
+                /* The angle of the triangle at this corner, between the edges projected on the plane of the normal. */
+                float edges[2][3];
+                for (int e = 0; e < 2; e++)
+                {
+                    const float *other = &model.vertices[indices[(corner + 1 + e) % 3] * model.floatsPerVertex + model.positionOffset];
+                    for (int i = 0; i < 3; i++)
+                    {
+                        edges[e][i] = other[i] - vertex[model.positionOffset + i];
+                    }
+                    makeOrthogonal(normal, edges[e]);
+                }
+                if (!normalize(edges[0]) || !normalize(edges[1]))
+                {
+                    continue;
+                }
+                float cosine = dot(edges[0], edges[1]);
+                float angle = acosf(cosine < -1.0f ? -1.0f : (cosine > 1.0f ? 1.0f : cosine));
+
+                float triangleTangent[3] = { gather->triangleTangents[triangle * 3], gather->triangleTangents[triangle * 3 + 1], gather->triangleTangents[triangle * 3 + 2] };
+                makeOrthogonal(normal, triangleTangent);
+                if (!normalize(triangleTangent))
+                {
+                    continue;
+                }
+                for (int i = 0; i < 3; i++)
+                {
+                    tangent[i] += triangleTangent[i] * angle;
+                }
+                /* Vertices were split so that all their triangles agree. */
+                tangent[3] = gather->triangleSigns[triangle];
+            }
+
+            if (!normalize(tangent))
+            {
+                anyOrthogonal(normal, tangent);
+            }
+        }
+    }
+
+    bool TangentFrames::generate(IndexedModel *model, JobScheduler *scheduler)
+    {
+        if (model->positionOffset < 0 || model->normalOffset < 0 || model->uvOffset < 0)
+        {
+            return false;
+        }
+
+        unsigned int numberOfTriangles = model->indices.size() / 3;
+        std::vector<float> triangleTangents(numberOfTriangles * 3);
+        std::vector<float> triangleSigns(numberOfTriangles);
+
+        /* The tangent of a triangle is the direction in which U grows, the bitangent the one in which V grows. */
+        for (unsigned int t = 0; t < numberOfTriangles; t++)
+        {
+            const float *corners[3];
+            for (int c = 0; c < 3; c++)
+            {
+                corners[c] = &model->vertices[model->indices[t * 3 + c] * model->floatsPerVertex];
+            }
+
+            float edge1[3], edge2[3];
+            for (int i = 0; i < 3; i++)
+            {
+                edge1[i] = corners[1][model->positionOffset + i] - corners[0][model->positionOffset + i];
+                edge2[i] = corners[2][model->positionOffset + i] - corners[0][model->positionOffset + i];
+            }
+            float s1 = corners[1][model->uvOffset] - corners[0][model->uvOffset];
+            float t1 = corners[1][model->uvOffset + 1] - corners[0][model->uvOffset + 1];
+            float s2 = corners[2][model->uvOffset] - corners[0][model->uvOffset];
+            float t2 = corners[2][model->uvOffset + 1] - corners[0][model->uvOffset + 1];
+
+            /* Both are scaled by the determinant, which only the direction of the tangent depends on. */
+            float determinant = s1 * t2 - s2 * t1;
+            float tangent[3], bitangent[3], normal[3];
+            for (int i = 0; i < 3; i++)
+            {
+                tangent[i] = (edge1[i] * t2 - edge2[i] * t1) * (determinant >= 0.0f ? 1.0f : -1.0f);
+                bitangent[i] = edge2[i] * s1 - edge1[i] * s2;
+                normal[i] = corners[0][model->normalOffset + i] + corners[1][model->normalOffset + i] + corners[2][model->normalOffset + i];
+            }
+            normalize(tangent);
+
+            /* Wherever the texture is mirrored, the bitangent is opposite to cross(normal, tangent). */
+            float cross[3] = { normal[1] * tangent[2] - normal[2] * tangent[1], normal[2] * tangent[0] - normal[0] * tangent[2], normal[0] * tangent[1] - normal[1] * tangent[0] };
+            float sign = dot(cross, bitangent) * determinant >= 0.0f ? 1.0f : -1.0f;
+            triangleTangents[t * 3] = tangent[0];
+            triangleTangents[t * 3 + 1] = tangent[1];
+            triangleTangents[t * 3 + 2] = tangent[2];
+            triangleSigns[t] = sign;
+        }
+
+        /* Split the vertices used by triangles of both handedness, the seams of mirrored textures. */
+        unsigned int numberOfVertices = model->getNumberOfVertices();
+        std::vector<float> vertexSigns(numberOfVertices, 0.0f);
+        std::vector<int> mirrored(numberOfVertices, -1);
+
+        for (unsigned int i = 0; i < numberOfTriangles * 3; i++)
+        {
+            unsigned int v = model->indices[i];
+            float sign = triangleSigns[i / 3];
+            if (vertexSigns[v] == 0.0f)
+            {
+                vertexSigns[v] = sign;
+            }
+            else if (vertexSigns[v] != sign)
+            {
+                if (mirrored[v] < 0)
+                {
+                    if (model->getNumberOfVertices() >= 65536)
+                    {
+                        return false;
+                    }
+                    mirrored[v] = model->getNumberOfVertices();
+                    for (int f = 0; f < model->floatsPerVertex; f++)
+                    {
+                        model->vertices.push_back(model->vertices[v * model->floatsPerVertex + f]);
+                    }
+                }
+                model->indices[i] = (unsigned short)mirrored[v];
+            }
+        }
+        numberOfVertices = model->getNumberOfVertices();
+
+        /* Corners of each vertex, counted then filled in place. */
+        std::vector<unsigned int> cornerStart(numberOfVertices + 1, 0);
+        for (unsigned int i = 0; i < numberOfTriangles * 3; i++)
+        {
+            cornerStart[model->indices[i] + 1]++;
+        }
+        for (unsigned int v = 0; v < numberOfVertices; v++)
+        {
+            cornerStart[v + 1] += cornerStart[v];
+        }
+        std::vector<unsigned int> corners(numberOfTriangles * 3 > 0 ? numberOfTriangles * 3 : 1);
+        std::vector<unsigned int> next(cornerStart.begin(), cornerStart.end() - 1);
+        for (unsigned int i = 0; i < numberOfTriangles * 3; i++)
+        {
+            corners[next[model->indices[i]]++] = i;
+        }
+
+        std::vector<float> tangents(numberOfVertices * 4 > 0 ? numberOfVertices * 4 : 1);
+        TangentGather gather;
+        gather.model = model;
+        gather.triangleTangents = numberOfTriangles > 0 ? &triangleTangents[0] : NULL;
+        gather.triangleSigns = numberOfTriangles > 0 ? &triangleSigns[0] : NULL;
+        gather.cornerStart = &cornerStart[0];
+        gather.corners = &corners[0];
+        gather.tangents = &tangents[0];
+
+        const unsigned int grainSize = 256;
+        if (scheduler != NULL && numberOfVertices > grainSize)
+        {
+            scheduler->parallelFor("tangents", numberOfVertices, grainSize, gatherTangents, &gather);
+        }
+        else
+        {
+            gatherTangents(0, numberOfVertices, &gather);
+        }
+
+        /* Append the tangents to the vertices. */
+        int floatsPerVertex = model->floatsPerVertex + 4;
+        std::vector<float> vertices(numberOfVertices * floatsPerVertex);
+        for (unsigned int v = 0; v < numberOfVertices; v++)
+        {
+            for (int f = 0; f < model->floatsPerVertex; f++)
+            {
+                vertices[v * floatsPerVertex + f] = model->vertices[v * model->floatsPerVertex + f];
+            }
+            for (int f = 0; f < 4; f++)
+            {
+                vertices[v * floatsPerVertex + model->floatsPerVertex + f] = tangents[v * 4 + f];
+            }
+        }
+        model->tangentOffset = model->floatsPerVertex;
+        model->floatsPerVertex = floatsPerVertex;
+        model->vertices.swap(vertices);
+
+        return true;
+    }
+
+    static short toSnorm16(float value)
+    {
+        float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+        return (short)floorf(clamped * 32767.0f + 0.5f);
+    }
+
+    void TangentFrames::encodeQuaternion(const float *normal, const float *tangent, short *encoded)
+    {
+        /* The columns of the rotation are the tangent, the bitangent and the normal, X, Y and Z of tangent space. */
+        float n[3] = { normal[0], normal[1], normal[2] };
+        float t[3] = { tangent[0], tangent[1], tangent[2] };
+        if (!normalize(n))
+        {
+            n[2] = 1.0f;
+        }
+        makeOrthogonal(n, t);
+        if (!normalize(t))
+        {
+            anyOrthogonal(n, t);
+        }
+        float b[3] = { n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2], n[0] * t[1] - n[1] * t[0] };
+
+        /* Shepperd's method, from the largest of the diagonal terms so nothing is divided by a small number. */
+        float q[4];
+        float trace = t[0] + b[1] + n[2];
+        if (trace > 0.0f)
+        {
+            float s = 0.5f / sqrtf(trace + 1.0f);
+            q[0] = (b[2] - n[1]) * s;
+            q[1] = (n[0] - t[2]) * s;
+            q[2] = (t[1] - b[0]) * s;
+            q[3] = 0.25f / s;
+        }
+        else if (t[0] > b[1] && t[0] > n[2])
+        {
+            float s = 2.0f * sqrtf(1.0f + t[0] - b[1] - n[2]);
+            q[0] = 0.25f * s;
+            q[1] = (b[0] + t[1]) / s;
+            q[2] = (n[0] + t[2]) / s;
+            q[3] = (b[2] - n[1]) / s;
+        }
+        else if (b[1] > n[2])
+        {
+            float s = 2.0f * sqrtf(1.0f + b[1] - t[0] - n[2]);
+            q[0] = (b[0] + t[1]) / s;
+            q[1] = 0.25f * s;
+            q[2] = (n[1] + b[2]) / s;
+            q[3] = (n[0] - t[2]) / s;
+        }
+        else
+        {
+            float s = 2.0f * sqrtf(1.0f + n[2] - t[0] - b[1]);
+            q[0] = (n[0] + t[2]) / s;
+            q[1] = (n[1] + b[2]) / s;
+            q[2] = 0.25f * s;
+            q[3] = (t[1] - b[0]) / s;
+        }
+
+        /* q and -q are the same rotation, so w can be made positive, leaving its sign for the handedness. */
+        if (q[3] < 0.0f)
+        {
+            q[0] = -q[0];
+            q[1] = -q[1];
+            q[2] = -q[2];
+            q[3] = -q[3];
+        }
+
+        /* w must not round to 0, which has no sign. */
+        const float minimumW = 1.0f / 32767.0f;
+        if (q[3] < minimumW)
+        {
+            float scale = sqrtf(1.0f - minimumW * minimumW);
+            q[0] *= scale;
+            q[1] *= scale;
+            q[2] *= scale;
+            q[3] = minimumW;
+        }
+
+        float sign = tangent[3] < 0.0f ? -1.0f : 1.0f;
+        for (int i = 0; i < 4; i++)
+        {
+            encoded[i] = toSnorm16(q[i] * sign);
+        }
+    }
+}
@@ -0,0 +1,268 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TemporalUpscaler.h"
+#include "Matrix.h"
+#include "Platform.h"
+#include "Shader.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* A triangle covering the viewport, without vertex buffers. */
+    static const char *resolveVertexShaderSource =
+        "#version 300 es\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 position = vec2(float((gl_VertexID & 1) * 4 - 1), float((gl_VertexID & 2) * 2 - 1));\n"
+        "    gl_Position = vec4(position, 0.0, 1.0);\n"
+        "}\n";
+
+    /*
+     * The rendered sample nearest to the output pixel is the one the jitter moved closest to it. An exact hit
+     * replaces a quarter of the history, a sample a whole output pixel away hardly any of it.
+     */
+    static const char *resolveFragmentShaderSource =
+        "#version 300 es\n"
+        "precision highp float;\n"
+        "precision highp sampler2D;\n"
+        "#define MAX_CURRENT_WEIGHT 0.25\n"
+        "uniform sampler2D colorTexture;\n"
+        "uniform sampler2D depthTexture;\n"
+        "uniform sampler2D historyTexture;\n"
+        "uniform mat4 reprojection;\n"
+        "uniform vec2 outputSize;\n"
+        "uniform vec2 inputSize;\n"
+        "uniform vec2 renderSize;\n"
+        "uniform vec2 jitter;\n"
+        "uniform bool historyValid;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 uv = gl_FragCoord.xy / outputSize;\n"
+        "    vec2 renderPosition = uv * renderSize - jitter;\n"
+        "    ivec2 lastTexel = ivec2(renderSize) - 1;\n"
+        "    ivec2 texel = clamp(ivec2(floor(renderPosition)), ivec2(0), lastTexel);\n"
+        "    vec2 sampleOffset = (vec2(texel) + 0.5 - renderPosition) * (outputSize / renderSize);\n"
+        "\n"
+        "    vec3 nearest = texelFetch(colorTexture, texel, 0).rgb;\n"
+        "    vec3 colorMin = nearest;\n"
+        "    vec3 colorMax = nearest;\n"
+        "    for (int y = -1; y <= 1; y++)\n"
+        "    {\n"
+        "        for (int x = -1; x <= 1; x++)\n"
+        "        {\n"
+        "            vec3 neighbour = texelFetch(colorTexture, clamp(texel + ivec2(x, y), ivec2(0), lastTexel), 0).rgb;\n"
+        "            colorMin = min(colorMin, neighbour);\n"
+        "            colorMax = max(colorMax, neighbour);\n"
+        "        }\n"
+        "    }\n"
+        "\n"
+        "    float depth = texelFetch(depthTexture, texel, 0).r;\n"
+        "    vec4 previous = reprojection * vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);\n"
+        "    vec2 previousUv = previous.xy / previous.w * 0.5 + 0.5;\n"
+        "    bool onScreen = all(greaterThanEqual(previousUv, vec2(0.0))) && all(lessThanEqual(previousUv, vec2(1.0)));\n"
+        "\n"
+        "    if (!historyValid || !onScreen || previous.w <= 0.0)\n"
+        "    {\n"
+        "        vec2 bilinearPosition = clamp(renderPosition, vec2(0.5), renderSize - 0.5);\n"
+        "        fragColor = vec4(texture(colorTexture, bilinearPosition / inputSize).rgb, 1.0);\n"
+        "        return;\n"
+        "    }\n"
+        "\n"
+        "    vec3 history = clamp(texture(historyTexture, previousUv).rgb, colorMin, colorMax);\n"
+        "    float weight = MAX_CURRENT_WEIGHT * exp(-2.0 * dot(sampleOffset, sampleOffset));\n"
+        "    fragColor = vec4(mix(history, nearest, weight), 1.0);\n"
+        "}\n";
+
+    /* Element of the Halton low discrepancy sequence, in [0, 1). */
+    static float halton(unsigned int index, unsigned int base)
+    {
+        float result = 0.0f;
+        float fraction = 1.0f;
+
+        while (index > 0)
+        {
+            fraction /= base;
+            result += fraction * (index % base);
+            index /= base;
+        }
+
+        return result;
+    }
+
+    TemporalUpscaler::TemporalUpscaler(GLsizei outputWidth, GLsizei outputHeight, GLsizei inputWidth, GLsizei inputHeight)
+        : outputWidth(outputWidth),
+          outputHeight(outputHeight),
+          inputWidth(inputWidth),
+          inputHeight(inputHeight),
+          renderWidth(inputWidth),
+          renderHeight(inputHeight),
+          frameIndex(0),
+          jitterX(0.0f),
+          jitterY(0.0f),
+          currentHistory(0),
+          historyValid(false),
+          resolveProgram(0)
+    {
+        memset(previousViewProjection, 0, sizeof(previousViewProjection));
+
+        GL_CHECK(glGenTextures(2, historyTextures));
+        GL_CHECK(glGenFramebuffers(2, historyFramebuffers));
+        for (int i = 0; i < 2; i++)
+        {
+            /* The history is reprojected between pixels, so it is bilinearly filtered. */
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D, historyTextures[i]));
+            GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, outputWidth, outputHeight));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+            GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, historyFramebuffers[i]));
+            GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTextures[i], 0));
+
+            GLenum status = GL_CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER));
+            if (status != GL_FRAMEBUFFER_COMPLETE)
+            {
+                LOGE("TemporalUpscaler: history framebuffer incomplete (0x%x).\n", status);
+                exit(1);
+            }
+        }
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+        Shader::processProgramSource(&resolveProgram, resolveVertexShaderSource, resolveFragmentShaderSource);
+
+        GL_CHECK(glUseProgram(resolveProgram));
+        GL_CHECK(glUniform1i(glGetUniformLocation(resolveProgram, "colorTexture"), 0));
+        GL_CHECK(glUniform1i(glGetUniformLocation(resolveProgram, "depthTexture"), 1));
+        GL_CHECK(glUniform1i(glGetUniformLocation(resolveProgram, "historyTexture"), 2));
+        GL_CHECK(glUniform2f(glGetUniformLocation(resolveProgram, "outputSize"), (float)outputWidth, (float)outputHeight));
+        GL_CHECK(glUniform2f(glGetUniformLocation(resolveProgram, "inputSize"), (float)inputWidth, (float)inputHeight));
+        reprojectionLocation = GL_CHECK(glGetUniformLocation(resolveProgram, "reprojection"));
+        renderSizeLocation = GL_CHECK(glGetUniformLocation(resolveProgram, "renderSize"));
+        jitterLocation = GL_CHECK(glGetUniformLocation(resolveProgram, "jitter"));
+        historyValidLocation = GL_CHECK(glGetUniformLocation(resolveProgram, "historyValid"));
+        GL_CHECK(glUseProgram(0));
+
+        /* No attributes, but a vertex array of its own keeps the sample's enabled arrays out of the resolve. */
+        GL_CHECK(glGenVertexArrays(1, &resolveVertexArray));
+    }
+
+    TemporalUpscaler::~TemporalUpscaler(void)
+    {
+        GL_CHECK(glDeleteVertexArrays(1, &resolveVertexArray));
+        GL_CHECK(glDeleteProgram(resolveProgram));
+        GL_CHECK(glDeleteFramebuffers(2, historyFramebuffers));
+        GL_CHECK(glDeleteTextures(2, historyTextures));
+    }
+
+    void TemporalUpscaler::beginFrame(GLsizei renderWidth, GLsizei renderHeight)
+    {
+        this->renderWidth = renderWidth < inputWidth ? renderWidth : inputWidth;
+        this->renderHeight = renderHeight < inputHeight ? renderHeight : inputHeight;
+
+        /* The sequence starts at 1, its first element is 0 in both bases. */
+        unsigned int index = frameIndex % jitterSequenceLength + 1;
+        jitterX = halton(index, 2) - 0.5f;
+        jitterY = halton(index, 3) - 0.5f;
+        frameIndex++;
+    }
+
+    void TemporalUpscaler::jitterProjection(float *projection) const
+    {
+        /* Adds the offset times w to x and y after the projection, which moves the whole image by it. */
+        float offsetX = 2.0f * jitterX / renderWidth;
+        float offsetY = 2.0f * jitterY / renderHeight;
+
+        for (int column = 0; column < 4; column++)
+        {
+            projection[column * 4 + 0] += offsetX * projection[column * 4 + 3];
+            projection[column * 4 + 1] += offsetY * projection[column * 4 + 3];
+        }
+    }
+
+    float TemporalUpscaler::getJitterX(void) const
+    {
+        return jitterX;
+    }
+
+    float TemporalUpscaler::getJitterY(void) const
+    {
+        return jitterY;
+    }
+
+    void TemporalUpscaler::reset(void)
+    {
+        historyValid = false;
+    }
+
+    void TemporalUpscaler::resolve(GLuint colorTexture, GLuint depthTexture, const float *viewProjection, GLuint targetFramebuffer)
+    {
+        /* From the current normalized device coordinates to the clip coordinates of the previous frame. */
+        Matrix current(viewProjection);
+        Matrix previous(previousViewProjection);
+        Matrix inverse = Matrix::matrixInvert(&current);
+        Matrix reprojection = previous * inverse;
+
+        int previousHistory = 1 - currentHistory;
+
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, historyFramebuffers[currentHistory]));
+        GL_CHECK(glViewport(0, 0, outputWidth, outputHeight));
+
+        /* Every pixel is written, the previous contents don't need to be loaded. */
+        static const GLenum colorAttachment[] = { GL_COLOR_ATTACHMENT0 };
+        GL_CHECK(glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, colorAttachment));
+
+        GL_CHECK(glDisable(GL_DEPTH_TEST));
+        GL_CHECK(glDisable(GL_STENCIL_TEST));
+        GL_CHECK(glDisable(GL_BLEND));
+
+        GL_CHECK(glUseProgram(resolveProgram));
+        GL_CHECK(glUniformMatrix4fv(reprojectionLocation, 1, GL_FALSE, reprojection.getAsArray()));
+        GL_CHECK(glUniform2f(renderSizeLocation, (float)renderWidth, (float)renderHeight));
+        GL_CHECK(glUniform2f(jitterLocation, jitterX, jitterY));
+        GL_CHECK(glUniform1i(historyValidLocation, historyValid ? 1 : 0));
+
+        GL_CHECK(glActiveTexture(GL_TEXTURE2));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, historyTextures[previousHistory]));
+        GL_CHECK(glActiveTexture(GL_TEXTURE1));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, depthTexture));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, colorTexture));
+
+        GL_CHECK(glBindVertexArray(resolveVertexArray));
+        GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+        GL_CHECK(glBindVertexArray(0));
+
+        /* The history is kept as it is for the next frame, so the result is copied out of it. */
+        GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, historyFramebuffers[currentHistory]));
+        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFramebuffer));
+        GL_CHECK(glBlitFramebuffer(0, 0, outputWidth, outputHeight, 0, 0, outputWidth, outputHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer));
+
+        memcpy(previousViewProjection, viewProjection, sizeof(previousViewProjection));
+        currentHistory = previousHistory;
+        historyValid = true;
+    }
+}
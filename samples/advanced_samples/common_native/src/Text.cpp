@@ -23,6 +23,9 @@
 #include "Shader.h"
 #include "Platform.h"
 #include "VectorTypes.h"
+#if GLES_VERSION == 3
+#include "OverlayBatch.h"
+#endif
 #include <stdlib.h>
 
 #include <cstring>
@@ -47,10 +50,14 @@ namespace MaliSDK
         programID = 0;
         
         numberOfCharacters = 0;
-        textVertex = NULL;
-        textTextureCoordinates = NULL;
-        color = NULL;
-        textIndex = NULL;
+        vertexData = NULL;
+        characterCapacity = 0;
+        vertexBuffer = 0;
+        indexBuffer = 0;
+        bufferCapacity = 0;
+        uploadedCharacters = 0;
+        dirtyBegin = 0;
+        dirtyEnd = 0;
 
         LOGD("Text initialization started...\n");
 
@@ -136,71 +143,94 @@ namespace MaliSDK
         free(textureData);
         textureData = NULL;
 
+        GL_CHECK(glGenBuffers(1, &vertexBuffer));
+        GL_CHECK(glGenBuffers(1, &indexBuffer));
+
         LOGD("Text initialization done.\n");
     }
 
     void Text::clear(void)
     {
         numberOfCharacters = 0;
+    }
+
+    void Text::reserveCharacters(int count)
+    {
+        if(count <= characterCapacity)
+        {
+            return;
+        }
 
-        free(textVertex);
-        free(textTextureCoordinates);
-        free(color);
-        free(textIndex);
+        /* Grow geometrically so a string added every frame does not reallocate every frame. */
+        int newCapacity = characterCapacity > 0 ? characterCapacity : 64;
+        while(newCapacity < count)
+        {
+            newCapacity *= 2;
+        }
+
+        vertexData = (float *)realloc(vertexData, newCapacity * floatsPerCharacter * sizeof(float));
+        if(vertexData == NULL)
+        {
+            LOGE("Out of memory at %s:%i\n", __FILE__, __LINE__);
+            exit(1);
+        }
 
-        textVertex = NULL;
-        textTextureCoordinates = NULL;
-        color = NULL;
-        textIndex = NULL;
+        characterCapacity = newCapacity;
     }
 
-    void Text::addString(int xPosition, int yPosition, const char *string, int red, int green, int blue, int alpha)
+    void Text::fillIndexBuffer(void)
     {
-        int length = strlen(string);
-        int iTexCoordPos = 4 * 2 * numberOfCharacters;
-        int iVertexPos = 4 * 3 * numberOfCharacters;
-        int iColorPos = 4 * 4 * numberOfCharacters;
-        int iIndex = 0;
+        int numberOfIndices = bufferCapacity * 6 - 2;
+        GLushort *indices = (GLushort *)malloc(numberOfIndices * sizeof(GLushort));
         int iIndexPos = 0;
 
-        numberOfCharacters += length;
-
-        /* Realloc memory. */
-        textVertex = (float *)realloc(textVertex, numberOfCharacters * 4 * 3 * sizeof(float));
-        textTextureCoordinates = (float *)realloc(textTextureCoordinates, numberOfCharacters * 4 * 2 * sizeof(float));
-        color = (float *)realloc(color, numberOfCharacters * 4 * 4 * sizeof(float));
-        textIndex = (GLshort *)realloc(textIndex, (numberOfCharacters * 6 - 2) * sizeof(GLshort));
-        if((textVertex == NULL) || (textTextureCoordinates == NULL) || (color == NULL) || (textIndex == NULL))
+        if(indices == NULL)
         {
             LOGE("Out of memory at %s:%i\n", __FILE__, __LINE__);
             exit(1);
         }
 
-        /* Re-init entire index array. */
-        textIndex[iIndex ++] = 0;
-        textIndex[iIndex ++] = 1;
-        textIndex[iIndex ++] = 2;
-        textIndex[iIndex ++] = 3;
+        for(int cIndex = 0; cIndex < bufferCapacity; cIndex ++)
+        {
+            GLushort firstVertex = (GLushort)(cIndex * 4);
+
+            /* Repeat the last vertex of the previous quad and the first of this one to join the strips. */
+            if(cIndex > 0)
+            {
+                indices[iIndexPos ++] = firstVertex - 1;
+                indices[iIndexPos ++] = firstVertex;
+            }
+
+            indices[iIndexPos ++] = firstVertex;
+            indices[iIndexPos ++] = firstVertex + 1;
+            indices[iIndexPos ++] = firstVertex + 2;
+            indices[iIndexPos ++] = firstVertex + 3;
+        }
+
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+        GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, numberOfIndices * sizeof(GLushort), indices, GL_STATIC_DRAW));
+        free(indices);
+    }
 
-        iIndexPos = 4;
-        for(int cIndex = 1; cIndex < numberOfCharacters; cIndex ++)
+    void Text::addString(int xPosition, int yPosition, const char *string, int red, int green, int blue, int alpha)
+    {
+        int length = strlen(string);
+
+        /* The indices are 16 bit, 4 vertices per character. */
+        if(numberOfCharacters + length > 65536 / 4)
         {
-            textIndex[iIndexPos ++] = iIndex - 1;
-            textIndex[iIndexPos ++] = iIndex;
-            textIndex[iIndexPos ++] = iIndex++;
-            textIndex[iIndexPos ++] = iIndex++;
-            textIndex[iIndexPos ++] = iIndex++;
-            textIndex[iIndexPos ++] = iIndex++;
+            LOGE("Too many characters at %s:%i\n", __FILE__, __LINE__);
+            return;
         }
 
-        for(int iChar = 0; iChar < (signed int)strlen(string); iChar ++)
+        reserveCharacters(numberOfCharacters + length);
+
+        for(int iChar = 0; iChar < length; iChar ++)
         {
             char cChar = string[iChar];
             int iCharX = 0;
             int iCharY = 0;
             Vec2 sBottom_left;
-            Vec2 sBottom_right;
-            Vec2 sTop_left;
             Vec2 sTop_right;
 
             /* Calculate tex coord for char here. */
@@ -211,54 +241,43 @@ namespace MaliSDK
             iCharY *= textureCharacterHeight;
             sBottom_left.x = iCharX;
             sBottom_left.y = iCharY;
-            sBottom_right.x = iCharX + textureCharacterWidth;
-            sBottom_right.y = iCharY;
-            sTop_left.x = iCharX;
-            sTop_left.y = iCharY + textureCharacterHeight;
             sTop_right.x = iCharX + textureCharacterWidth;
             sTop_right.y = iCharY + textureCharacterHeight;
 
-            /* Add vertex position data here. */
-            textVertex[iVertexPos++] = xPosition + iChar * textureCharacterWidth * scale;
-            textVertex[iVertexPos++] = (float)yPosition;
-            textVertex[iVertexPos++] = 0;
-
-            textVertex[iVertexPos++] = xPosition + (iChar + 1) * textureCharacterWidth * scale;
-            textVertex[iVertexPos++] = (float)yPosition;
-            textVertex[iVertexPos++] = 0;
-
-            textVertex[iVertexPos++] = xPosition + iChar * textureCharacterWidth * scale;
-            textVertex[iVertexPos++] = yPosition + textureCharacterHeight * scale;
-            textVertex[iVertexPos++] = 0;
-
-            textVertex[iVertexPos++] = xPosition + (iChar + 1) * textureCharacterWidth * scale;
-            textVertex[iVertexPos++] = yPosition + textureCharacterHeight * scale;
-            textVertex[iVertexPos++] = 0;
-
-            /* Texture coords here. Because textures are read in upside down, flip Y coords here. */
-            textTextureCoordinates[iTexCoordPos++] = sBottom_left.x / 256.0f;
-            textTextureCoordinates[iTexCoordPos++] = sTop_left.y / 48.0f;
-
-            textTextureCoordinates[iTexCoordPos++] = sBottom_right.x / 256.0f;
-            textTextureCoordinates[iTexCoordPos++] = sTop_right.y / 48.0f;
-
-            textTextureCoordinates[iTexCoordPos++] = sTop_left.x / 256.0f;
-            textTextureCoordinates[iTexCoordPos++] = sBottom_left.y / 48.0f;
-
-            textTextureCoordinates[iTexCoordPos++] = sTop_right.x / 256.0f;
-            textTextureCoordinates[iTexCoordPos++] = sBottom_right.y / 48.0f;
-
-            /* Color data. */
-            color[iColorPos ++] = red / 255.0f;
-            color[iColorPos ++] = green / 255.0f;
-            color[iColorPos ++] = blue / 255.0f;
-            color[iColorPos ++] = alpha / 255.0f;
-
-            /* Copy to the other 3 vertices. */
-            memcpy(&color[iColorPos], &color[iColorPos - 4], 4 * sizeof(float));
-            memcpy(&color[iColorPos + 4], &color[iColorPos], 4 * sizeof(float));
-            memcpy(&color[iColorPos + 8], &color[iColorPos + 4], 4 * sizeof(float));
-            iColorPos += 3 * 4;
+            float left = xPosition + iChar * textureCharacterWidth * scale;
+            float right = xPosition + (iChar + 1) * textureCharacterWidth * scale;
+            float bottom = (float)yPosition;
+            float top = yPosition + textureCharacterHeight * scale;
+
+            /* Texture coords. Because textures are read in upside down, flip Y coords here. */
+            float textureLeft = sBottom_left.x / 256.0f;
+            float textureRight = sTop_right.x / 256.0f;
+            float textureBottom = sTop_right.y / 48.0f;
+            float textureTop = sBottom_left.y / 48.0f;
+
+            const float character[floatsPerCharacter] =
+            {
+                left,  bottom, 0.0f, textureLeft,  textureBottom, red / 255.0f, green / 255.0f, blue / 255.0f, alpha / 255.0f,
+                right, bottom, 0.0f, textureRight, textureBottom, red / 255.0f, green / 255.0f, blue / 255.0f, alpha / 255.0f,
+                left,  top,    0.0f, textureLeft,  textureTop,    red / 255.0f, green / 255.0f, blue / 255.0f, alpha / 255.0f,
+                right, top,    0.0f, textureRight, textureTop,    red / 255.0f, green / 255.0f, blue / 255.0f, alpha / 255.0f,
+            };
+
+            /* Only characters which differ from what the buffer already holds need uploading. */
+            float *destination = &vertexData[numberOfCharacters * floatsPerCharacter];
+            if(numberOfCharacters >= uploadedCharacters || memcmp(destination, character, sizeof(character)) != 0)
+            {
+                memcpy(destination, character, sizeof(character));
+
+                if(dirtyBegin >= dirtyEnd)
+                {
+                    dirtyBegin = numberOfCharacters;
+                }
+                dirtyBegin = dirtyBegin < numberOfCharacters ? dirtyBegin : numberOfCharacters;
+                dirtyEnd = dirtyEnd > numberOfCharacters + 1 ? dirtyEnd : numberOfCharacters + 1;
+            }
+
+            numberOfCharacters ++;
         }
     }
 
@@ -266,31 +285,57 @@ namespace MaliSDK
     {
 #if GLES_VERSION == 3
         GL_CHECK(glBindVertexArray(0));
-        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
 #endif
         if(numberOfCharacters == 0) 
         {
+            GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
             return;
         }
 
         GL_CHECK(glUseProgram(programID));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+
+        if(bufferCapacity < characterCapacity)
+        {
+            /* Reallocate for the whole capacity so it only happens when vertexData grows. */
+            bufferCapacity = characterCapacity;
+            GL_CHECK(glBufferData(GL_ARRAY_BUFFER, bufferCapacity * floatsPerCharacter * sizeof(float), NULL, GL_DYNAMIC_DRAW));
+            fillIndexBuffer();
+
+            uploadedCharacters = 0;
+            dirtyBegin = 0;
+            dirtyEnd = numberOfCharacters;
+        }
+
+        if(dirtyBegin < dirtyEnd)
+        {
+            GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, dirtyBegin * floatsPerCharacter * sizeof(float),
+                                     (dirtyEnd - dirtyBegin) * floatsPerCharacter * sizeof(float),
+                                     &vertexData[dirtyBegin * floatsPerCharacter]));
+
+            uploadedCharacters = uploadedCharacters > dirtyEnd ? uploadedCharacters : dirtyEnd;
+            dirtyBegin = 0;
+            dirtyEnd = 0;
+        }
+
+        const GLsizei stride = floatsPerVertex * sizeof(float);
 
         if(m_iLocPosition != -1)
         {
             GL_CHECK(glEnableVertexAttribArray(m_iLocPosition));
-            GL_CHECK(glVertexAttribPointer(m_iLocPosition, 3, GL_FLOAT, GL_FALSE, 0, textVertex));
+            GL_CHECK(glVertexAttribPointer(m_iLocPosition, 3, GL_FLOAT, GL_FALSE, stride, (const void *)0));
         }
 
         if(m_iLocTextColor != -1)
         {
             GL_CHECK(glEnableVertexAttribArray(m_iLocTextColor));
-            GL_CHECK(glVertexAttribPointer(m_iLocTextColor, 4, GL_FLOAT, GL_FALSE, 0, color));
+            GL_CHECK(glVertexAttribPointer(m_iLocTextColor, 4, GL_FLOAT, GL_FALSE, stride, (const void *)(5 * sizeof(float))));
         }
 
         if(m_iLocTexCoord != -1)
         {
             GL_CHECK(glEnableVertexAttribArray(m_iLocTexCoord));
-            GL_CHECK(glVertexAttribPointer(m_iLocTexCoord, 2, GL_FLOAT, GL_FALSE, 0, textTextureCoordinates));
+            GL_CHECK(glVertexAttribPointer(m_iLocTexCoord, 2, GL_FLOAT, GL_FALSE, stride, (const void *)(3 * sizeof(float))));
         }
 
         if(m_iLocProjection != -1)
@@ -301,7 +346,8 @@ namespace MaliSDK
         GL_CHECK(glActiveTexture(GL_TEXTURE0));
         GL_CHECK(glBindTexture(GL_TEXTURE_2D, textureID));
 
-        GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, numberOfCharacters * 6 - 2, GL_UNSIGNED_SHORT, textIndex));
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+        GL_CHECK(glDrawElements(GL_TRIANGLE_STRIP, numberOfCharacters * 6 - 2, GL_UNSIGNED_SHORT, (const void *)0));
 
         if(m_iLocTextColor != -1)
         {
@@ -317,11 +363,48 @@ namespace MaliSDK
         {
             GL_CHECK(glDisableVertexAttribArray(m_iLocPosition));
         }
+
+        /* Samples draw with client side arrays after the text, leave no buffer bound. */
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+
+#if GLES_VERSION == 3
+    void Text::submit(OverlayBatch &batch, int layer) const
+    {
+        for(int iChar = 0; iChar < numberOfCharacters; iChar ++)
+        {
+            const float *character = &vertexData[iChar * floatsPerCharacter];
+            OverlayBatch::Vertex vertices[4];
+
+            for(int iCorner = 0; iCorner < 4; iCorner ++)
+            {
+                const float *source = &character[iCorner * floatsPerVertex];
+                OverlayBatch::Vertex &vertex = vertices[iCorner];
+
+                vertex.position[0] = source[0];
+                vertex.position[1] = source[1];
+                vertex.texCoord[0] = source[3];
+                vertex.texCoord[1] = source[4];
+                vertex.texCoord[2] = 0.0f;
+                for(int iComponent = 0; iComponent < 4; iComponent ++)
+                {
+                    vertex.color[iComponent] = (GLubyte)(source[5 + iComponent] * 255.0f + 0.5f);
+                }
+                vertex.shading = (GLfloat)OverlayBatch::SHADING_TEXTURE;
+                vertex.smoothing = 0.0f;
+            }
+
+            batch.addQuad(layer, textureID, 0, vertices);
+        }
     }
+#endif
 
     Text::~Text(void)
     {
         clear();
+        free(vertexData);
+        vertexData = NULL;
         
          /*
           * NOTE FROM http://developer.android.com
@@ -19,8 +19,11 @@
  */
 
 #include "Texture.h"
+#include "AssetFile.h"
 #include "ETCHeader.h"
+#include "GPUMemory.h"
 #include "Platform.h"
+#include "StartupProfiler.h"
 
 #if GLES_VERSION == 2
 #include <GLES2/gl2ext.h>
@@ -35,6 +38,19 @@ using std::string;
 
 namespace MaliSDK
 {
+    /* Map a PKM file, the levels are uploaded straight from the mapping. */
+    static void mapPKMFile(const char *filename, AssetFile *file)
+    {
+        /* The 16 byte header has to be there even if the image data is not. */
+        const size_t sizeOfETCHeader = 16;
+
+        if (!file->open(filename) || file->getSize() < sizeOfETCHeader)
+        {
+            LOGE("Failed to open '%s'\n", filename);
+            exit(1);
+        }
+    }
+
     void Texture::getCompressedTextureFormats(GLint** textureFormats, int* numberOfTextureFormats)
     {
         GL_CHECK(glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, numberOfTextureFormats));
@@ -159,43 +175,114 @@ namespace MaliSDK
         }
     }
 
+#if GLES_VERSION == 3
+    static void clearColorBuffer(const GLfloat *color)
+    {
+        GL_CHECK(glClearBufferfv(GL_COLOR, 0, color));
+    }
+
+    static void clearColorBuffer(const GLint *color)
+    {
+        GL_CHECK(glClearBufferiv(GL_COLOR, 0, color));
+    }
+
+    static void clearColorBuffer(const GLuint *color)
+    {
+        GL_CHECK(glClearBufferuiv(GL_COLOR, 0, color));
+    }
+
+    /* Clear the layers one at a time, through a framebuffer which only lives for the fill. */
+    template <typename T>
+    static void fillTextureLayers(GLenum target, GLuint textureID, GLint level, GLint firstLayer, GLint layersCount, const T *color)
+    {
+        GLint  previousFramebufferID = 0;
+        GLuint framebufferID         = 0;
+
+        GL_CHECK(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebufferID));
+        GL_CHECK(glGenFramebuffers(1, &framebufferID));
+        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebufferID));
+
+        for (GLint layer = firstLayer; layer < firstLayer + layersCount; layer++)
+        {
+            if (target == GL_TEXTURE_2D)
+            {
+                GL_CHECK(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureID, level));
+            }
+            else
+            {
+                GL_CHECK(glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textureID, level, layer));
+            }
+
+            GLenum status = GL_CHECK(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER));
+
+            if (status != GL_FRAMEBUFFER_COMPLETE)
+            {
+                LOGE("Texture %u cannot be filled, its framebuffer is incomplete: 0x%x", textureID, status);
+                exit(1);
+            }
+
+            clearColorBuffer(color);
+        }
+
+        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebufferID));
+        GL_CHECK(glDeleteFramebuffers(1, &framebufferID));
+    }
+
+    void Texture::fillTexture(GLenum target, GLuint textureID, GLint level, GLint firstLayer, GLint layersCount, const GLfloat color[4])
+    {
+        fillTextureLayers(target, textureID, level, firstLayer, layersCount, color);
+    }
+
+    void Texture::fillTexture(GLenum target, GLuint textureID, GLint level, GLint firstLayer, GLint layersCount, const GLint color[4])
+    {
+        fillTextureLayers(target, textureID, level, firstLayer, layersCount, color);
+    }
+
+    void Texture::fillTexture(GLenum target, GLuint textureID, GLint level, GLint firstLayer, GLint layersCount, const GLuint color[4])
+    {
+        fillTextureLayers(target, textureID, level, firstLayer, layersCount, color);
+    }
+#endif
+
     void Texture::deleteTextureData(GLvoid** textureData)
     {
         delete[] (unsigned char*)*textureData;
     }
 
+    int Texture::getLevelSize(int size, int level)
+    {
+        int levelSize = size >> level;
+
+        return levelSize > 0 ? levelSize : 1;
+    }
+
+    /* [Load data from file] */
     void Texture::loadData(const char *filename, unsigned char **textureData)
     {
         LOGD("Texture loadData started for %s...\n", filename);
 
-        FILE *file = fopen(filename, "rb");
-        if(file == NULL)
+        /* Through AssetFile, so the data can also come straight from the APK. The copy is what callers free(). */
+        AssetFile file;
+        if(!file.open(filename))
         {
             LOGE("Failed to open '%s'\n", filename);
             exit(1);
         }
-        fseek(file, 0, SEEK_END);
-        unsigned int length = ftell(file);
-        unsigned char *loadedTexture = (unsigned char *)calloc(length, sizeof(unsigned char));
+        unsigned char *loadedTexture = (unsigned char *)calloc(file.getSize(), sizeof(unsigned char));
         if(loadedTexture == NULL)
         {
             LOGE("Out of memory at %s:%i\n", __FILE__, __LINE__);
             exit(1);
         }
-        fseek(file, 0, SEEK_SET);
-        size_t read = fread(loadedTexture, sizeof(unsigned char), length, file);
-        if(read != length)
-        {
-            LOGE("Failed to read in '%s'\n", filename);
-            exit(1);
-        }
-        fclose(file);
+        memcpy(loadedTexture, file.getData(), file.getSize());
 
         *textureData = loadedTexture;
 
         LOGD("Texture loadData for %s done.\n", filename);
     }
+    /* [Load data from file] */
 
+    /* [Load PKM data] */
     void Texture::loadPKMData(const char *filename, ETCHeader* etcHeader, unsigned char **textureData)
     {
         /* PKM file consists of a header with information about image (stored in 16 first bits) and image data. */
@@ -228,6 +315,99 @@ namespace MaliSDK
             exit(1);
         }
     }
+    /* [Load PKM data] */
+
+    void Texture::loadBmpImageData(const char *filename, int *imageWidth, int *imageHeight, unsigned char **textureData)
+    {
+        STARTUP_PHASE(PHASE_ASSET_IO);
+        if (filename == NULL || textureData == NULL)
+        {
+            LOGE("loadBmpImageData(): NULL argument is not acceptable.\n");
+            exit(1);
+        }
+
+        tagBITMAPFILEHEADER bitmapFileHeader;
+        tagBITMAPINFOHEADER bitmapInfoHeader;
+
+        FILE *file = fopen(filename, "rb");
+        if(file == NULL)
+        {
+            LOGE("Failed to open '%s'\n", filename);
+            exit(1);
+        }
+
+        readBitmapFileHeader(file, &bitmapFileHeader);
+        readBitmapInfoHeader(file, &bitmapInfoHeader);
+
+        unsigned char *loadedTexture = (unsigned char *)malloc(bitmapInfoHeader.biSizeImage);
+        if(loadedTexture == NULL)
+        {
+            LOGE("Out of memory at %s:%i\n", __FILE__, __LINE__);
+            exit(1);
+        }
+
+        /* Move the file pointer to the beginning of the bitmap image data. */
+        fseek(file, bitmapFileHeader.bfOffBits, SEEK_SET);
+        size_t read = fread(loadedTexture, sizeof(unsigned char), bitmapInfoHeader.biSizeImage, file);
+        if(read != (size_t)bitmapInfoHeader.biSizeImage)
+        {
+            LOGE("Failed to read in '%s'\n", filename);
+            exit(1);
+        }
+        fclose(file);
+
+        /* Data in a BMP file is stored as BGR, convert it to RGB. */
+        for (int imageIndex = 0; imageIndex + 2 < bitmapInfoHeader.biSizeImage; imageIndex += 3)
+        {
+            unsigned char blue = loadedTexture[imageIndex];
+
+            loadedTexture[imageIndex]     = loadedTexture[imageIndex + 2];
+            loadedTexture[imageIndex + 2] = blue;
+        }
+
+        *textureData = loadedTexture;
+
+        if (imageWidth != NULL)
+        {
+            *imageWidth = bitmapInfoHeader.biWidth;
+        }
+        if (imageHeight != NULL)
+        {
+            *imageHeight = bitmapInfoHeader.biHeight;
+        }
+    }
+
+    void Texture::readBitmapFileHeader(FILE* file, tagBITMAPFILEHEADER* bitmapFileHeader)
+    {
+        /* Fields are read one at a time as the in-memory structure is padded, unlike the file. */
+        fread(&bitmapFileHeader->bfType,      sizeof(bitmapFileHeader->bfType),      1, file);
+        fread(&bitmapFileHeader->bfSize,      sizeof(bitmapFileHeader->bfSize),      1, file);
+        fread(&bitmapFileHeader->bfReserved1, sizeof(bitmapFileHeader->bfReserved1), 1, file);
+        fread(&bitmapFileHeader->bfReserved2, sizeof(bitmapFileHeader->bfReserved2), 1, file);
+        fread(&bitmapFileHeader->bfOffBits,   sizeof(bitmapFileHeader->bfOffBits),   1, file);
+
+        /* "BM" */
+        if (bitmapFileHeader->bfType != 0x4D42)
+        {
+            LOGE("Invalid BMP file type 0x%x\n", bitmapFileHeader->bfType);
+            exit(1);
+        }
+    }
+
+    void Texture::readBitmapInfoHeader(FILE* file, tagBITMAPINFOHEADER* bitmapInfoHeader)
+    {
+        fread(&bitmapInfoHeader->biSize,          sizeof(bitmapInfoHeader->biSize),          1, file);
+        fread(&bitmapInfoHeader->biWidth,         sizeof(bitmapInfoHeader->biWidth),         1, file);
+        fread(&bitmapInfoHeader->biHeight,        sizeof(bitmapInfoHeader->biHeight),        1, file);
+        fread(&bitmapInfoHeader->biPlanes,        sizeof(bitmapInfoHeader->biPlanes),        1, file);
+        fread(&bitmapInfoHeader->biBitCount,      sizeof(bitmapInfoHeader->biBitCount),      1, file);
+        fread(&bitmapInfoHeader->biCompression,   sizeof(bitmapInfoHeader->biCompression),   1, file);
+        fread(&bitmapInfoHeader->biSizeImage,     sizeof(bitmapInfoHeader->biSizeImage),     1, file);
+        fread(&bitmapInfoHeader->biXPelsPerMeter, sizeof(bitmapInfoHeader->biXPelsPerMeter), 1, file);
+        fread(&bitmapInfoHeader->biYPelsPerMeter, sizeof(bitmapInfoHeader->biYPelsPerMeter), 1, file);
+        fread(&bitmapInfoHeader->biClrUsed,       sizeof(bitmapInfoHeader->biClrUsed),       1, file);
+        fread(&bitmapInfoHeader->biClrImportant,  sizeof(bitmapInfoHeader->biClrImportant),  1, file);
+    }
 
     void Texture::loadCompressedMipmaps(const char *filenameBase, const char *filenameSuffix, GLuint *textureID)
     {
@@ -238,14 +418,17 @@ namespace MaliSDK
         /* Load base level Mipmap. */
         /* Construct filename, load and tidy up. */
         string filename = filenameBase + string("0") + filenameSuffix;
-        unsigned char *data = NULL;
-        loadData(filename.c_str(), &data);
-        ETCHeader loadedETCHeader = ETCHeader(data);
+        AssetFile file;
+        mapPKMFile(filename.c_str(), &file);
+        const unsigned char *data = file.getData();
+        ETCHeader loadedETCHeader = ETCHeader((unsigned char *)data);
 
         /* Calculate number of Mipmap levels. */
         LOGD("Base level Mipmap loaded: (%i, %i) padded to 4x4 blocks, (%i, %i) actual\n", loadedETCHeader.getPaddedWidth(), loadedETCHeader.getPaddedHeight(), loadedETCHeader.getWidth(), loadedETCHeader.getHeight());
-        int width = loadedETCHeader.getWidth();
-        int height = loadedETCHeader.getHeight();
+        const int baseWidth = loadedETCHeader.getWidth();
+        const int baseHeight = loadedETCHeader.getHeight();
+        int width = baseWidth;
+        int height = baseHeight;
         int numberOfMipmaps = 1;
         while((width > 1) || (height > 1))
         {
@@ -264,10 +447,9 @@ namespace MaliSDK
 #if GLES_VERSION == 2
         GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_ETC1_RGB8_OES, loadedETCHeader.getWidth(), loadedETCHeader.getHeight(), 0, (loadedETCHeader.getPaddedWidth() * loadedETCHeader.getPaddedHeight()) >> 1, data + 16));
 #elif GLES_VERSION == 3
-        /* TODO */
+        /* ETC1 is a subset of ETC2, which is core in OpenGL ES 3.0. */
+        GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGB8_ETC2, loadedETCHeader.getWidth(), loadedETCHeader.getHeight(), 0, (loadedETCHeader.getPaddedWidth() * loadedETCHeader.getPaddedHeight()) >> 1, data + 16));
 #endif
-        free(data);
-        data = NULL;
 
         /* Load other levels. */
         for(int allMipmaps = 1; allMipmaps < numberOfMipmaps; allMipmaps++)
@@ -294,10 +476,11 @@ namespace MaliSDK
             sprintf(level, "%i", allMipmaps);
 
             filename = filenameBase + string(level) + filenameSuffix;
-            loadData(filename.c_str(), &data);
+            mapPKMFile(filename.c_str(), &file);
             free(level);
             level = NULL;
-            loadedETCHeader = ETCHeader(data);
+            data = file.getData();
+            loadedETCHeader = ETCHeader((unsigned char *)data);
 
             /* Load Mipmap level into texture.
              * Skip the 16 byte header of the PKM file before passing the data to OpenGL ES.
@@ -308,22 +491,16 @@ namespace MaliSDK
 #if GLES_VERSION == 2
             GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, allMipmaps, GL_ETC1_RGB8_OES, loadedETCHeader.getWidth(), loadedETCHeader.getHeight(), 0, (loadedETCHeader.getPaddedWidth() * loadedETCHeader.getPaddedHeight()) >> 1, data + 16));
 #elif GLES_VERSION == 3
-        /* TODO */
+            GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, allMipmaps, GL_COMPRESSED_RGB8_ETC2, loadedETCHeader.getWidth(), loadedETCHeader.getHeight(), 0, (loadedETCHeader.getPaddedWidth() * loadedETCHeader.getPaddedHeight()) >> 1, data + 16));
 #endif
-            free(data);
-            data = NULL;
         }
-    }
 
-    void Texture::reversePixelLine(float* destination, const float* source, int lineWidth)
-    {
-        const int rgbComponentsCount = 3;
-
-        for (int pixelIndex = 0; pixelIndex < lineWidth; ++pixelIndex)
-        {
-            memcpy(destination + pixelIndex * rgbComponentsCount,
-                   source + (lineWidth - pixelIndex - 1) * rgbComponentsCount, 
-                   rgbComponentsCount * sizeof(float));
-        }
+#if GLES_VERSION == 2
+        const GLenum internalFormat = GL_ETC1_RGB8_OES;
+#elif GLES_VERSION == 3
+        const GLenum internalFormat = GL_COMPRESSED_RGB8_ETC2;
+#endif
+        GPUMemory::trackTexture(*textureID, GPUMemory::computeTextureSize(internalFormat, baseWidth, baseHeight, 1, numberOfMipmaps),
+                                internalFormat, "Texture::loadCompressedMipmaps");
     }
 }
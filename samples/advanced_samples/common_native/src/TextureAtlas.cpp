@@ -0,0 +1,353 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TextureAtlas.h"
+#include "AssetFile.h"
+#include "ETCHeader.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using std::vector;
+
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+
+namespace MaliSDK
+{
+    /* Block sizes of the ASTC formats, in the order of their enums. */
+    static const int astcBlockSizes[14][2] =
+    {
+        { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 },
+        { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+    };
+
+    /* Shelves are filled with the tallest images first, so each shelf wastes little height. */
+    struct TallerFirst
+    {
+        const vector<int> *heights;
+
+        bool operator()(int first, int second) const
+        {
+            return (*heights)[first] > (*heights)[second];
+        }
+    };
+
+    bool TextureAtlas::getBlockSize(GLenum internalFormat, int *blockWidth, int *blockHeight)
+    {
+        if (internalFormat == GL_ETC1_RGB8_OES ||
+            (internalFormat >= GL_COMPRESSED_R11_EAC && internalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC))
+        {
+            *blockWidth = 4;
+            *blockHeight = 4;
+            return true;
+        }
+
+        int astcIndex = -1;
+
+        if (internalFormat >= 0x93B0 && internalFormat <= 0x93BD)
+        {
+            astcIndex = internalFormat - 0x93B0;
+        }
+        else if (internalFormat >= 0x93D0 && internalFormat <= 0x93DD)
+        {
+            astcIndex = internalFormat - 0x93D0;
+        }
+
+        if (astcIndex < 0)
+        {
+            return false;
+        }
+
+        *blockWidth = astcBlockSizes[astcIndex][0];
+        *blockHeight = astcBlockSizes[astcIndex][1];
+        return true;
+    }
+
+    TextureAtlas::TextureAtlas(GLenum internalFormat, int layerWidth, int layerHeight, int numberOfLevels)
+        : internalFormat(internalFormat),
+          layerWidth(layerWidth),
+          layerHeight(layerHeight),
+          numberOfLevels(numberOfLevels > 0 ? numberOfLevels : 1),
+          alignmentX(0),
+          alignmentY(0),
+          numberOfLayers(0),
+          texture(0)
+    {
+        /* ETC1 cannot be updated with glCompressedTexSubImage3D(), but its blocks are valid ETC2 RGB8 blocks. */
+        if (internalFormat == GL_ETC1_RGB8_OES)
+        {
+            this->internalFormat = GL_COMPRESSED_RGB8_ETC2;
+        }
+
+        int blockWidth = 0;
+        int blockHeight = 0;
+
+        if (!getBlockSize(this->internalFormat, &blockWidth, &blockHeight))
+        {
+            LOGE("TextureAtlas: format 0x%.4x is not an ETC, EAC or ASTC format.\n", internalFormat);
+            return;
+        }
+
+        /* Every level of every image has to start on a block boundary. */
+        alignmentX = blockWidth << (this->numberOfLevels - 1);
+        alignmentY = blockHeight << (this->numberOfLevels - 1);
+    }
+
+    TextureAtlas::~TextureAtlas(void)
+    {
+        if (texture != 0)
+        {
+            glDeleteTextures(1, &texture);
+        }
+    }
+
+    int TextureAtlas::addImage(int width, int height, const unsigned char *const *levels, const size_t *levelSizes)
+    {
+        if (alignmentX == 0 || width <= 0 || height <= 0 || width % alignmentX != 0 || height % alignmentY != 0)
+        {
+            LOGE("TextureAtlas: a %dx%d image is not a multiple of the %dx%d alignment.\n", width, height, alignmentX, alignmentY);
+            return -1;
+        }
+
+        images.push_back(Image());
+
+        Image &image = images.back();
+
+        image.width = width;
+        image.height = height;
+        image.x = 0;
+        image.y = 0;
+        image.layer = 0;
+
+        for (int level = 0; level < numberOfLevels; level++)
+        {
+            image.levelOffsets.push_back(image.data.size());
+            image.levelSizes.push_back(levelSizes[level]);
+            image.data.insert(image.data.end(), levels[level], levels[level] + levelSizes[level]);
+        }
+
+        return (int)images.size() - 1;
+    }
+
+    int TextureAtlas::addPKMImage(const char *filenameBase, const char *filenameSuffix)
+    {
+        /* PKM files have a 16 byte header followed by the blocks. */
+        const size_t sizeOfETCHeader = 16;
+        vector<AssetFile *> files(numberOfLevels);
+        vector<const unsigned char *> levels(numberOfLevels);
+        vector<size_t> levelSizes(numberOfLevels);
+        int width = 0;
+        int height = 0;
+        bool valid = true;
+
+        for (int level = 0; level < numberOfLevels && valid; level++)
+        {
+            char filename[256];
+
+            snprintf(filename, sizeof(filename), "%s%d%s", filenameBase, level, filenameSuffix);
+            files[level] = new AssetFile;
+
+            if (!files[level]->open(filename) || files[level]->getSize() < sizeOfETCHeader)
+            {
+                LOGE("TextureAtlas: cannot read %s\n", filename);
+                valid = false;
+                break;
+            }
+
+            ETCHeader header((unsigned char *)files[level]->getData());
+
+            if (level == 0)
+            {
+                width = header.getWidth();
+                height = header.getHeight();
+            }
+
+            levels[level] = files[level]->getData() + sizeOfETCHeader;
+            levelSizes[level] = files[level]->getSize() - sizeOfETCHeader;
+        }
+
+        int result = valid ? addImage(width, height, &levels[0], &levelSizes[0]) : -1;
+
+        for (int level = 0; level < numberOfLevels; level++)
+        {
+            delete files[level];
+        }
+
+        return result;
+    }
+
+    bool TextureAtlas::pack(void)
+    {
+        vector<int> order(images.size());
+        vector<int> heights(images.size());
+
+        for (size_t imageIndex = 0; imageIndex < images.size(); imageIndex++)
+        {
+            order[imageIndex] = (int)imageIndex;
+            heights[imageIndex] = images[imageIndex].height;
+        }
+
+        TallerFirst tallerFirst = { &heights };
+        std::stable_sort(order.begin(), order.end(), tallerFirst);
+
+        int layer = 0;
+        int shelfX = 0;
+        int shelfY = 0;
+        int shelfHeight = 0;
+
+        numberOfLayers = images.empty() ? 0 : 1;
+
+        for (size_t orderIndex = 0; orderIndex < order.size(); orderIndex++)
+        {
+            Image &image = images[order[orderIndex]];
+
+            if (image.width > layerWidth || image.height > layerHeight)
+            {
+                LOGE("TextureAtlas: a %dx%d image does not fit in a %dx%d layer.\n", image.width, image.height, layerWidth, layerHeight);
+                return false;
+            }
+
+            /* Start a new shelf when the image does not fit on the current one, and a new layer when the shelf does not fit. */
+            if (shelfX + image.width > layerWidth)
+            {
+                shelfX = 0;
+                shelfY += shelfHeight;
+                shelfHeight = 0;
+            }
+
+            if (shelfY + image.height > layerHeight)
+            {
+                layer++;
+                numberOfLayers++;
+                shelfX = 0;
+                shelfY = 0;
+                shelfHeight = 0;
+            }
+
+            image.x = shelfX;
+            image.y = shelfY;
+            image.layer = layer;
+
+            shelfX += image.width;
+            shelfHeight = std::max(shelfHeight, image.height);
+        }
+
+        return true;
+    }
+
+    bool TextureAtlas::build(void)
+    {
+        /* The image data is released by the first build. */
+        if (!regions.empty())
+        {
+            LOGE("TextureAtlas: the atlas has already been built.\n");
+            return false;
+        }
+
+        if (alignmentX == 0 || images.empty() || !pack())
+        {
+            return false;
+        }
+
+        GL_CHECK(glGenTextures(1, &texture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, texture));
+        GL_CHECK(glTexStorage3D(GL_TEXTURE_2D_ARRAY, numberOfLevels, internalFormat, layerWidth, layerHeight, numberOfLayers));
+
+        /* Not GL_CHECK: an unsupported format is reported to the caller rather than being fatal. */
+        bool uploaded = true;
+
+        for (size_t imageIndex = 0; imageIndex < images.size() && uploaded; imageIndex++)
+        {
+            const Image &image = images[imageIndex];
+
+            for (int level = 0; level < numberOfLevels; level++)
+            {
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, image.x >> level, image.y >> level, image.layer,
+                                          std::max(image.width >> level, 1), std::max(image.height >> level, 1), 1,
+                                          internalFormat, (GLsizei)image.levelSizes[level], &image.data[image.levelOffsets[level]]);
+            }
+
+            GLenum error = glGetError();
+
+            if (error != GL_NO_ERROR)
+            {
+                LOGE("TextureAtlas: image %u was rejected with error 0x%.4x.\n", (unsigned int)imageIndex, error);
+                uploaded = false;
+            }
+        }
+
+        if (!uploaded)
+        {
+            GL_CHECK(glDeleteTextures(1, &texture));
+            texture = 0;
+            return false;
+        }
+
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, numberOfLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+        regions.resize(images.size());
+
+        for (size_t imageIndex = 0; imageIndex < images.size(); imageIndex++)
+        {
+            Image &image = images[imageIndex];
+            Region &region = regions[imageIndex];
+
+            region.uMin = (float)image.x / layerWidth;
+            region.vMin = (float)image.y / layerHeight;
+            region.uMax = (float)(image.x + image.width) / layerWidth;
+            region.vMax = (float)(image.y + image.height) / layerHeight;
+            region.layer = image.layer;
+
+            /* The copies are not needed once the texture holds them. */
+            vector<unsigned char>().swap(image.data);
+        }
+
+        LOGI("TextureAtlas: packed %u images into %d layers of %dx%d.\n", (unsigned int)images.size(), numberOfLayers, layerWidth, layerHeight);
+
+        return true;
+    }
+
+    GLuint TextureAtlas::getTexture(void) const
+    {
+        return texture;
+    }
+
+    int TextureAtlas::getNumberOfLayers(void) const
+    {
+        return numberOfLayers;
+    }
+
+    int TextureAtlas::getNumberOfImages(void) const
+    {
+        return (int)images.size();
+    }
+
+    const TextureAtlas::Region &TextureAtlas::getRegion(int image) const
+    {
+        return regions[image];
+    }
+}
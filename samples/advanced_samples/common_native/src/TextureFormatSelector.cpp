@@ -0,0 +1,1196 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TextureFormatSelector.h"
+#include "AssetFile.h"
+#include "GLExtensions.h"
+#include "Platform.h"
+#include "StartupProfiler.h"
+#include "Texture.h"
+
+#include <cstdio>
+#include <cstring>
+
+using std::string;
+using std::vector;
+
+/* Compressed formats which are not in the core headers of every OpenGL ES version. */
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_R11_EAC
+#define GL_COMPRESSED_R11_EAC 0x9270
+#endif
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+
+namespace MaliSDK
+{
+    static const unsigned char ktx1Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    static const size_t ktx1HeaderSize = 64;
+    static const unsigned int ktx1Endianness = 0x04030201;
+
+    /* The ETC1 modifier tables, as (a, b) for the pixel indices +a, +b, -a, -b. */
+    static const int etc1Modifiers[8][2] =
+    {
+        { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+    };
+
+    /* The EAC modifier tables, for the pixel indices 0 to 7. */
+    static const int eacModifiers[16][8] =
+    {
+        { -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 }, { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+        { -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 }, { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+        { -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 }, { -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+        { -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 }, { -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 }
+    };
+
+    static bool fileExists(const char *filename)
+    {
+        AssetFile file;
+
+        return file.open(filename);
+    }
+
+    static unsigned int readUInt32(const unsigned char *data)
+    {
+        unsigned int value;
+
+        memcpy(&value, data, sizeof(value));
+
+        return value;
+    }
+
+    static void writeUInt32(vector<unsigned char> *output, unsigned int value)
+    {
+        const unsigned char *bytes = (const unsigned char *)&value;
+
+        output->insert(output->end(), bytes, bytes + sizeof(value));
+    }
+
+    static int clampToByte(int value)
+    {
+        return value < 0 ? 0 : (value > 255 ? 255 : value);
+    }
+
+    /**
+     * \brief Pick the modifier table and pixel indices for one half of an ETC1 block.
+     * \param[in] pixels The 16 RGB pixels of the block, row by row.
+     * \param[in] inSubblock Which of the 16 pixels belong to this half.
+     * \param[in] base The base colour of the half, expanded to 8 bits.
+     * \param[out] table The best modifier table.
+     * \param[out] indices The pixel index of each pixel of the half, 0 to 3.
+     * \return The squared error of the half with that table.
+     */
+    static int fitSubblock(const unsigned char pixels[16][3], const bool inSubblock[16], const int base[3], int *table, int indices[16])
+    {
+        int bestError = 0x7fffffff;
+
+        for (int tableIndex = 0; tableIndex < 8; tableIndex++)
+        {
+            const int modifiers[4] = { etc1Modifiers[tableIndex][0], etc1Modifiers[tableIndex][1],
+                                      -etc1Modifiers[tableIndex][0], -etc1Modifiers[tableIndex][1] };
+            int tableIndices[16];
+            int tableError = 0;
+
+            for (int pixel = 0; pixel < 16; pixel++)
+            {
+                if (!inSubblock[pixel])
+                {
+                    continue;
+                }
+
+                int bestPixelError = 0x7fffffff;
+
+                for (int modifier = 0; modifier < 4; modifier++)
+                {
+                    int pixelError = 0;
+
+                    for (int channel = 0; channel < 3; channel++)
+                    {
+                        int difference = clampToByte(base[channel] + modifiers[modifier]) - pixels[pixel][channel];
+
+                        pixelError += difference * difference;
+                    }
+
+                    if (pixelError < bestPixelError)
+                    {
+                        bestPixelError = pixelError;
+                        tableIndices[pixel] = modifier;
+                    }
+                }
+
+                tableError += bestPixelError;
+            }
+
+            if (tableError < bestError)
+            {
+                bestError = tableError;
+                *table = tableIndex;
+                memcpy(indices, tableIndices, sizeof(tableIndices));
+            }
+        }
+
+        return bestError;
+    }
+
+    /**
+     * \brief Encode a 4x4 block of RGB pixels as ETC1, which is also a valid GL_COMPRESSED_RGB8_ETC2 block.
+     *
+     * Both subblock orientations are tried, each with the average colours of its halves as base colours,
+     * in differential mode when they are close enough and individual mode otherwise. This is a fast
+     * single pass encoder meant for one-off transcoding on the device, not an offline quality encoder.
+     * \param[in] pixels The 16 pixels, row by row.
+     * \param[out] block The 8 bytes of the block.
+     */
+    static void encodeETC1Block(const unsigned char pixels[16][3], unsigned char block[8])
+    {
+        int bestError = 0x7fffffff;
+
+        for (int flip = 0; flip < 2; flip++)
+        {
+            bool inSubblock[2][16];
+            int average[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
+
+            /* Without flip the halves are the left and right 2x4 columns, with flip the top and bottom 4x2 rows. */
+            for (int pixel = 0; pixel < 16; pixel++)
+            {
+                int x = pixel % 4;
+                int y = pixel / 4;
+                int subblock = flip ? (y >= 2) : (x >= 2);
+
+                inSubblock[subblock][pixel] = true;
+                inSubblock[1 - subblock][pixel] = false;
+
+                for (int channel = 0; channel < 3; channel++)
+                {
+                    average[subblock][channel] += pixels[pixel][channel];
+                }
+            }
+
+            int quantized[2][3];
+            bool differential = true;
+
+            for (int channel = 0; channel < 3; channel++)
+            {
+                for (int subblock = 0; subblock < 2; subblock++)
+                {
+                    quantized[subblock][channel] = (average[subblock][channel] * 31 + 8 * 255 / 2) / (8 * 255);
+                }
+
+                int delta = quantized[1][channel] - quantized[0][channel];
+
+                differential = differential && delta >= -4 && delta <= 3;
+            }
+
+            int base[2][3];
+
+            for (int channel = 0; channel < 3; channel++)
+            {
+                for (int subblock = 0; subblock < 2; subblock++)
+                {
+                    if (differential)
+                    {
+                        base[subblock][channel] = (quantized[subblock][channel] << 3) | (quantized[subblock][channel] >> 2);
+                    }
+                    else
+                    {
+                        quantized[subblock][channel] = (average[subblock][channel] * 15 + 8 * 255 / 2) / (8 * 255);
+                        base[subblock][channel] = quantized[subblock][channel] * 17;
+                    }
+                }
+            }
+
+            int tables[2];
+            int indices[16];
+            int error = fitSubblock(pixels, inSubblock[0], base[0], &tables[0], indices);
+            int secondIndices[16];
+
+            error += fitSubblock(pixels, inSubblock[1], base[1], &tables[1], secondIndices);
+
+            if (error >= bestError)
+            {
+                continue;
+            }
+
+            bestError = error;
+
+            for (int channel = 0; channel < 3; channel++)
+            {
+                if (differential)
+                {
+                    block[channel] = (unsigned char)((quantized[0][channel] << 3) | ((quantized[1][channel] - quantized[0][channel]) & 7));
+                }
+                else
+                {
+                    block[channel] = (unsigned char)((quantized[0][channel] << 4) | quantized[1][channel]);
+                }
+            }
+
+            block[3] = (unsigned char)((tables[0] << 5) | (tables[1] << 2) | (differential ? 2 : 0) | flip);
+
+            /* Pixel indices are stored column by column, most significant bits first, with +a, +b, -a, -b as 0, 1, 2, 3. */
+            unsigned int indexBits = 0;
+
+            for (int pixel = 0; pixel < 16; pixel++)
+            {
+                int index = inSubblock[0][pixel] ? indices[pixel] : secondIndices[pixel];
+                int bit = (pixel % 4) * 4 + pixel / 4;
+
+                indexBits |= (unsigned int)(index >> 1) << (bit + 16);
+                indexBits |= (unsigned int)(index & 1) << bit;
+            }
+
+            block[4] = (unsigned char)(indexBits >> 24);
+            block[5] = (unsigned char)(indexBits >> 16);
+            block[6] = (unsigned char)(indexBits >> 8);
+            block[7] = (unsigned char)indexBits;
+        }
+    }
+
+    /**
+     * \brief Encode a tightly packed RGB image, replicating the edge pixels into the blocks it only partly covers.
+     */
+    static void encodeETC1Image(const unsigned char *image, int width, int height, vector<unsigned char> *output)
+    {
+        for (int blockY = 0; blockY < height; blockY += 4)
+        {
+            for (int blockX = 0; blockX < width; blockX += 4)
+            {
+                unsigned char pixels[16][3];
+                unsigned char block[8];
+
+                for (int pixel = 0; pixel < 16; pixel++)
+                {
+                    int x = blockX + pixel % 4;
+                    int y = blockY + pixel / 4;
+                    const unsigned char *source = image + ((y < height ? y : height - 1) * width + (x < width ? x : width - 1)) * 3;
+
+                    memcpy(pixels[pixel], source, 3);
+                }
+
+                encodeETC1Block(pixels, block);
+                output->insert(output->end(), block, block + sizeof(block));
+            }
+        }
+    }
+
+    /**
+     * \brief Decode an ETC1 block, the reverse of encodeETC1Block().
+     * \param[in] block The 8 bytes of the block.
+     * \param[out] pixels The 16 pixels, row by row.
+     */
+    static void decodeETC1Block(const unsigned char block[8], unsigned char pixels[16][3])
+    {
+        bool differential = (block[3] & 2) != 0;
+        bool flip = (block[3] & 1) != 0;
+        const int tables[2] = { block[3] >> 5, (block[3] >> 2) & 7 };
+        int base[2][3];
+
+        for (int channel = 0; channel < 3; channel++)
+        {
+            if (differential)
+            {
+                /* The second colour is the first plus a signed 3-bit delta. */
+                int first = block[channel] >> 3;
+                int second = first + ((block[channel] & 7) ^ 4) - 4;
+
+                base[0][channel] = (first << 3) | (first >> 2);
+                base[1][channel] = ((second & 31) << 3) | ((second & 31) >> 2);
+            }
+            else
+            {
+                base[0][channel] = (block[channel] >> 4) * 17;
+                base[1][channel] = (block[channel] & 15) * 17;
+            }
+        }
+
+        unsigned int indexBits = ((unsigned int)block[4] << 24) | ((unsigned int)block[5] << 16) | ((unsigned int)block[6] << 8) | block[7];
+
+        for (int pixel = 0; pixel < 16; pixel++)
+        {
+            int x = pixel % 4;
+            int y = pixel / 4;
+            int subblock = flip ? (y >= 2) : (x >= 2);
+            int bit = x * 4 + y;
+            int index = (int)(((indexBits >> (bit + 16)) & 1) << 1 | ((indexBits >> bit) & 1));
+            int modifier = etc1Modifiers[tables[subblock]][index & 1];
+
+            if (index >= 2)
+            {
+                modifier = -modifier;
+            }
+
+            for (int channel = 0; channel < 3; channel++)
+            {
+                pixels[pixel][channel] = (unsigned char)clampToByte(base[subblock][channel] + modifier);
+            }
+        }
+    }
+
+    /**
+     * \brief The kinds of block encodeEACBlock() produces.
+     */
+    enum EACBlockType
+    {
+        EAC_ALPHA,          /**< The first half of a GL_COMPRESSED_RGBA8_ETC2_EAC block. */
+        EAC_R11,            /**< A GL_COMPRESSED_R11_EAC block, or half of a GL_COMPRESSED_RG11_EAC block. */
+        EAC_SIGNED_R11      /**< A GL_COMPRESSED_SIGNED_R11_EAC block, or half of a GL_COMPRESSED_SIGNED_RG11_EAC block. */
+    };
+
+    /**
+     * \brief Encode 16 values of one channel as an EAC block.
+     *
+     * For every modifier table only the multipliers and base values around the ones that make the table
+     * span the range of the block are tried, which is close to an exhaustive search for smooth data such
+     * as normals and heights.
+     * \param[in] values The 16 values, row by row: 0 to 2047 for 0.0 to 1.0 in an R11 block, -1023 to 1023 for
+     * -1.0 to 1.0 in a signed R11 block, 0 to 255 in an alpha block.
+     * \param[in] type The kind of block to encode.
+     * \param[out] block The 8 bytes of the block.
+     */
+    static void encodeEACBlock(const int values[16], EACBlockType type, unsigned char block[8])
+    {
+        /*
+         * R11 blocks have their base and multiplier in steps of 8, and a multiplier of 0 standing for 1/8.
+         * Unsigned ones decode their base to the middle of its step.
+         */
+        const bool r11 = type != EAC_ALPHA;
+        const int step = r11 ? 8 : 1;
+        const int offset = type == EAC_R11 ? 4 : 0;
+        const int lowestBase = type == EAC_SIGNED_R11 ? -127 : 0;
+        const int highestBase = type == EAC_SIGNED_R11 ? 127 : 255;
+        const int lowestValue = type == EAC_SIGNED_R11 ? -1023 : 0;
+        const int highestValue = type == EAC_SIGNED_R11 ? 1023 : (r11 ? 2047 : 255);
+
+        int minimum = values[0];
+        int maximum = values[0];
+
+        for (int pixel = 1; pixel < 16; pixel++)
+        {
+            minimum = values[pixel] < minimum ? values[pixel] : minimum;
+            maximum = values[pixel] > maximum ? values[pixel] : maximum;
+        }
+
+        int bestError = 0x7fffffff;
+        int bestBase = 0;
+        int bestMultiplier = r11 ? 0 : 1;
+        int bestTable = 0;
+        int bestIndices[16] = { 0 };
+
+        for (int table = 0; table < 16 && bestError > 0; table++)
+        {
+            const int *modifiers = eacModifiers[table];
+            int span = modifiers[7] - modifiers[3];
+            int fittingMultiplier = (2 * (maximum - minimum) + step * span) / (2 * step * span);
+
+            for (int multiplier = fittingMultiplier - 1; multiplier <= fittingMultiplier + 1; multiplier++)
+            {
+                if (multiplier < (r11 ? 0 : 1) || multiplier > 15)
+                {
+                    continue;
+                }
+
+                int scale = multiplier > 0 ? multiplier * step : 1;
+                int centre = (minimum + maximum) / 2 - offset - scale * (modifiers[3] + modifiers[7]) / 2;
+                int fittingBase = centre >= 0 ? (centre + step / 2) / step : -((step / 2 - centre) / step);
+
+                for (int base = fittingBase - 1; base <= fittingBase + 1; base++)
+                {
+                    if (base < lowestBase || base > highestBase)
+                    {
+                        continue;
+                    }
+
+                    int indices[16];
+                    int error = 0;
+
+                    for (int pixel = 0; pixel < 16 && error < bestError; pixel++)
+                    {
+                        int bestPixelError = 0x7fffffff;
+
+                        for (int index = 0; index < 8; index++)
+                        {
+                            int decoded = base * step + offset + modifiers[index] * scale;
+                            decoded = decoded < lowestValue ? lowestValue : (decoded > highestValue ? highestValue : decoded);
+                            int difference = decoded - values[pixel];
+
+                            if (difference * difference < bestPixelError)
+                            {
+                                bestPixelError = difference * difference;
+                                indices[pixel] = index;
+                            }
+                        }
+
+                        error += bestPixelError;
+                    }
+
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        bestBase = base;
+                        bestMultiplier = multiplier;
+                        bestTable = table;
+                        memcpy(bestIndices, indices, sizeof(indices));
+                    }
+                }
+            }
+        }
+
+        block[0] = (unsigned char)(bestBase & 0xff);
+        block[1] = (unsigned char)((bestMultiplier << 4) | bestTable);
+
+        /* Like ETC1, pixel indices are stored column by column, most significant bits first. */
+        unsigned long long indexBits = 0;
+
+        for (int pixel = 0; pixel < 16; pixel++)
+        {
+            int bit = 45 - ((pixel % 4) * 4 + pixel / 4) * 3;
+
+            indexBits |= (unsigned long long)bestIndices[pixel] << bit;
+        }
+
+        for (int byte = 0; byte < 6; byte++)
+        {
+            block[2 + byte] = (unsigned char)(indexBits >> (40 - byte * 8));
+        }
+    }
+
+    /**
+     * \brief Encode a tightly packed RGBA image as GL_COMPRESSED_RGBA8_ETC2_EAC, an alpha EAC block followed by an ETC1 block.
+     */
+    static void encodeETC2EACImage(const unsigned char *image, int width, int height, vector<unsigned char> *output)
+    {
+        for (int blockY = 0; blockY < height; blockY += 4)
+        {
+            for (int blockX = 0; blockX < width; blockX += 4)
+            {
+                unsigned char pixels[16][3];
+                int alpha[16];
+                unsigned char block[16];
+
+                for (int pixel = 0; pixel < 16; pixel++)
+                {
+                    int x = blockX + pixel % 4;
+                    int y = blockY + pixel / 4;
+                    const unsigned char *source = image + ((y < height ? y : height - 1) * width + (x < width ? x : width - 1)) * 4;
+
+                    memcpy(pixels[pixel], source, 3);
+                    alpha[pixel] = source[3];
+                }
+
+                encodeEACBlock(alpha, EAC_ALPHA, block);
+                encodeETC1Block(pixels, block + 8);
+                output->insert(output->end(), block, block + sizeof(block));
+            }
+        }
+    }
+
+    /**
+     * \brief Halve a tightly packed image of 8-bit or 16-bit channels with a box filter, odd edges reuse their last pixel.
+     */
+    template <typename Channel>
+    static void downsample(const vector<Channel> &source, int width, int height, int channels, vector<Channel> *destination)
+    {
+        int destinationWidth = width > 1 ? width / 2 : 1;
+        int destinationHeight = height > 1 ? height / 2 : 1;
+
+        destination->resize(destinationWidth * destinationHeight * channels);
+
+        for (int y = 0; y < destinationHeight; y++)
+        {
+            int y0 = 2 * y < height ? 2 * y : height - 1;
+            int y1 = 2 * y + 1 < height ? 2 * y + 1 : height - 1;
+
+            for (int x = 0; x < destinationWidth; x++)
+            {
+                int x0 = 2 * x < width ? 2 * x : width - 1;
+                int x1 = 2 * x + 1 < width ? 2 * x + 1 : width - 1;
+
+                for (int channel = 0; channel < channels; channel++)
+                {
+                    int sum = source[(y0 * width + x0) * channels + channel] + source[(y0 * width + x1) * channels + channel] +
+                              source[(y1 * width + x0) * channels + channel] + source[(y1 * width + x1) * channels + channel];
+
+                    (*destination)[(y * destinationWidth + x) * channels + channel] = (Channel)((sum + 2) / 4);
+                }
+            }
+        }
+    }
+
+    /**
+     * \brief Append the header of a KTX 1.1 file holding ETC1, ETC2 RGB, ETC2 RGBA or R11 EAC blocks, without key/value data.
+     */
+    static void writeETCHeader(vector<unsigned char> *output, GLenum internalFormat, int width, int height, int numberOfFaces, int numberOfLevels)
+    {
+        output->insert(output->end(), ktx1Identifier, ktx1Identifier + sizeof(ktx1Identifier));
+        writeUInt32(output, ktx1Endianness);
+        writeUInt32(output, 0);                 /* glType */
+        writeUInt32(output, 1);                 /* glTypeSize */
+        writeUInt32(output, 0);                 /* glFormat */
+        writeUInt32(output, internalFormat);
+        writeUInt32(output, internalFormat == GL_COMPRESSED_RGBA8_ETC2_EAC ? GL_RGBA :
+                            (internalFormat == GL_COMPRESSED_R11_EAC ? GL_RED : GL_RGB)); /* glBaseInternalFormat */
+        writeUInt32(output, width);
+        writeUInt32(output, height);
+        writeUInt32(output, 0);                 /* pixelDepth */
+        writeUInt32(output, 0);                 /* numberOfArrayElements */
+        writeUInt32(output, numberOfFaces);
+        writeUInt32(output, numberOfLevels);
+        writeUInt32(output, 0);                 /* bytesOfKeyValueData */
+    }
+
+    /**
+     * \brief Get the number of levels of a full mip chain.
+     */
+    static int getFullMipChainLength(int width, int height)
+    {
+        int numberOfLevels = 1;
+
+        for (int levelSize = (width > height ? width : height); levelSize > 1; levelSize /= 2)
+        {
+            numberOfLevels++;
+        }
+
+        return numberOfLevels;
+    }
+
+    /**
+     * \brief Get the cache file name of a cube map encoded from faces.
+     *
+     * The faces are only known once they are decoded, so the entry is named after the asset instead of its contents.
+     */
+    static string getCubemapCacheName(const string &basePath, GLenum internalFormat, const char *suffix)
+    {
+        unsigned long long hash = 0xcbf29ce484222325ULL ^ internalFormat;
+        char filename[48];
+
+        for (size_t byteIndex = 0; byteIndex < basePath.size(); byteIndex++)
+        {
+            hash ^= (unsigned char)basePath[byteIndex];
+            hash *= 0x100000001b3ULL;
+        }
+
+        sprintf(filename, "cubemap_%016llx%s", hash, suffix);
+
+        return filename;
+    }
+
+    /**
+     * \brief Write a transcoded file to the cache.
+     */
+    static bool writeCacheFile(const string &cachePath, const vector<unsigned char> &output)
+    {
+        FILE *file = fopen(cachePath.c_str(), "wb");
+
+        if (file == NULL)
+        {
+            LOGE("TextureFormatSelector: cannot write %s\n", cachePath.c_str());
+            return false;
+        }
+
+        bool written = fwrite(&output[0], 1, output.size(), file) == output.size();
+
+        /* Never leave a partial file behind, it would be loaded on the next run. */
+        if (fclose(file) != 0 || !written)
+        {
+            LOGE("TextureFormatSelector: failed to write %s\n", cachePath.c_str());
+            remove(cachePath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    vector<GLint> TextureFormatSelector::compressedFormats;
+    bool TextureFormatSelector::astcExtension = false;
+    bool TextureFormatSelector::formatsQueried = false;
+    string TextureFormatSelector::cacheDirectory;
+
+    void TextureFormatSelector::setCacheDirectory(const char *directory)
+    {
+        cacheDirectory = (directory != NULL) ? directory : "";
+    }
+
+    void TextureFormatSelector::queryFormats(void)
+    {
+        if (formatsQueried)
+        {
+            return;
+        }
+
+        GLint numberOfFormats = 0;
+
+        GL_CHECK(glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &numberOfFormats));
+
+        compressedFormats.resize(numberOfFormats);
+
+        if (numberOfFormats > 0)
+        {
+            GL_CHECK(glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, &compressedFormats[0]));
+        }
+
+        astcExtension = GLExtensions::isSupported("GL_KHR_texture_compression_astc_ldr");
+        formatsQueried = true;
+    }
+
+    void TextureFormatSelector::encodeETC1(const unsigned char *image, int width, int height, vector<unsigned char> *output)
+    {
+        encodeETC1Image(image, width, height, output);
+    }
+
+    void TextureFormatSelector::decodeETC1(const unsigned char *blocks, int width, int height, vector<unsigned char> *image)
+    {
+        image->resize(width * height * 3);
+
+        for (int blockY = 0; blockY < height; blockY += 4)
+        {
+            for (int blockX = 0; blockX < width; blockX += 4)
+            {
+                unsigned char pixels[16][3];
+
+                decodeETC1Block(blocks, pixels);
+                blocks += 8;
+
+                for (int pixel = 0; pixel < 16; pixel++)
+                {
+                    int x = blockX + pixel % 4;
+                    int y = blockY + pixel / 4;
+
+                    if (x < width && y < height)
+                    {
+                        memcpy(&(*image)[(y * width + x) * 3], pixels[pixel], 3);
+                    }
+                }
+            }
+        }
+    }
+
+    void TextureFormatSelector::encodeSignedRG11(const unsigned char *image, int width, int height, int channels, vector<unsigned char> *output)
+    {
+        for (int blockY = 0; blockY < height; blockY += 4)
+        {
+            for (int blockX = 0; blockX < width; blockX += 4)
+            {
+                for (int channel = 0; channel < 2; channel++)
+                {
+                    int values[16];
+                    unsigned char block[8];
+
+                    for (int pixel = 0; pixel < 16; pixel++)
+                    {
+                        int x = blockX + pixel % 4;
+                        int y = blockY + pixel / 4;
+                        int value = image[((y < height ? y : height - 1) * width + (x < width ? x : width - 1)) * channels + channel];
+
+                        /* 0 to 255 onto -1023 to 1023, rounded. */
+                        values[pixel] = (value * 2046 * 2 + 255) / (2 * 255) - 1023;
+                    }
+
+                    encodeEACBlock(values, EAC_SIGNED_R11, block);
+                    output->insert(output->end(), block, block + sizeof(block));
+                }
+            }
+        }
+    }
+
+    void TextureFormatSelector::encodeR11(const unsigned short *image, int width, int height, vector<unsigned char> *output)
+    {
+        for (int blockY = 0; blockY < height; blockY += 4)
+        {
+            for (int blockX = 0; blockX < width; blockX += 4)
+            {
+                int values[16];
+                unsigned char block[8];
+
+                for (int pixel = 0; pixel < 16; pixel++)
+                {
+                    int x = blockX + pixel % 4;
+                    int y = blockY + pixel / 4;
+                    int value = image[(y < height ? y : height - 1) * width + (x < width ? x : width - 1)];
+
+                    /* 0 to 65535 onto 0 to 2047, rounded. */
+                    values[pixel] = (value * 2047 + 32767) / 65535;
+                }
+
+                encodeEACBlock(values, EAC_R11, block);
+                output->insert(output->end(), block, block + sizeof(block));
+            }
+        }
+    }
+
+    bool TextureFormatSelector::isFormatSupported(GLenum internalFormat)
+    {
+        queryFormats();
+
+        for (size_t formatIndex = 0; formatIndex < compressedFormats.size(); formatIndex++)
+        {
+            if ((GLenum)compressedFormats[formatIndex] == internalFormat)
+            {
+                return true;
+            }
+        }
+
+        /* The extension covers every LDR block size, whether or not the driver lists them. */
+        return astcExtension && internalFormat >= 0x93B0 && internalFormat <= 0x93DD;
+    }
+
+    bool TextureFormatSelector::isFamilySupported(Family family)
+    {
+        switch (family)
+        {
+            case FAMILY_ASTC:
+                return isFormatSupported(GL_COMPRESSED_RGBA_ASTC_4x4_KHR);
+            case FAMILY_ETC2:
+#if GLES_VERSION == 3
+                /* ETC2 and EAC are core in OpenGL ES 3.0, even where the driver does not list them. */
+                return true;
+#else
+                return isFormatSupported(GL_COMPRESSED_RGB8_ETC2);
+#endif
+            case FAMILY_ETC1:
+                return isFormatSupported(GL_ETC1_RGB8_OES);
+            default:
+                return true;
+        }
+    }
+
+    const char *TextureFormatSelector::getSuffix(Family family)
+    {
+        switch (family)
+        {
+            case FAMILY_ASTC:
+                return ".astc.ktx";
+            case FAMILY_ETC2:
+                return ".etc2.ktx";
+            case FAMILY_ETC1:
+                return ".etc1.ktx";
+            default:
+                return ".ktx";
+        }
+    }
+
+    bool TextureFormatSelector::transcode(const string &sourcePath, GLenum internalFormat, string *cachePath)
+    {
+        STARTUP_PHASE(PHASE_DECODE);
+        AssetFile source;
+
+        if (!source.open(sourcePath.c_str()) || source.getSize() < ktx1HeaderSize)
+        {
+            return false;
+        }
+
+        const unsigned char *data = source.getData();
+        size_t size = source.getSize();
+
+        /* Only 2D, little endian, 8-bit RGB or RGBA sources are transcoded, anything else is uploaded as it is. */
+        if (memcmp(data, ktx1Identifier, sizeof(ktx1Identifier)) != 0 || readUInt32(data + 12) != ktx1Endianness ||
+            readUInt32(data + 16) != GL_UNSIGNED_BYTE || (readUInt32(data + 24) != GL_RGB && readUInt32(data + 24) != GL_RGBA) ||
+            readUInt32(data + 44) > 1 || readUInt32(data + 48) != 0 || readUInt32(data + 52) != 1)
+        {
+            return false;
+        }
+
+        /* Alpha needs the EAC blocks of ETC2, ETC1 has none. */
+        int channels = readUInt32(data + 24) == GL_RGBA ? 4 : 3;
+
+        if (channels == 4)
+        {
+            if (internalFormat == GL_ETC1_RGB8_OES)
+            {
+                return false;
+            }
+
+            internalFormat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+        }
+
+        int width = (int)readUInt32(data + 36);
+        int height = (int)readUInt32(data + 40);
+        int numberOfLevels = (int)readUInt32(data + 56);
+        size_t offset = ktx1HeaderSize + readUInt32(data + 60);
+
+        if (height == 0)
+        {
+            height = 1;
+        }
+
+        /* The file name depends on the contents of the source, an updated source is transcoded again. */
+        unsigned long long hash = 0xcbf29ce484222325ULL ^ internalFormat;
+        char filename[48];
+
+        for (size_t byteIndex = 0; byteIndex < size; byteIndex++)
+        {
+            hash ^= data[byteIndex];
+            hash *= 0x100000001b3ULL;
+        }
+
+        sprintf(filename, "texture_%016llx%s", hash, internalFormat == GL_ETC1_RGB8_OES ? ".etc1.ktx" : ".etc2.ktx");
+        *cachePath = cacheDirectory + filename;
+
+        if (fileExists(cachePath->c_str()))
+        {
+            return true;
+        }
+
+        /* 0 levels asks for the mip levels to be generated, as glGenerateMipmap() cannot be used on compressed textures. */
+        bool generateMipmaps = (numberOfLevels == 0);
+        int outputLevels = numberOfLevels;
+
+        if (generateMipmaps)
+        {
+            outputLevels = getFullMipChainLength(width, height);
+        }
+
+        vector<unsigned char> output;
+        vector<unsigned char> image;
+        vector<unsigned char> nextImage;
+
+        writeETCHeader(&output, internalFormat, width, height, 1, outputLevels);
+
+        for (int level = 0; level < outputLevels; level++)
+        {
+            int levelWidth = Texture::getLevelSize(width, level);
+            int levelHeight = Texture::getLevelSize(height, level);
+
+            if (level == 0 || !generateMipmaps)
+            {
+                /* Source rows are padded to 4 bytes, the encoder wants them packed. */
+                size_t rowSize = levelWidth * channels;
+                size_t paddedRowSize = (rowSize + 3) & ~(size_t)3;
+
+                if (offset + 4 > size || offset + 4 + paddedRowSize * levelHeight > size)
+                {
+                    LOGE("TextureFormatSelector: %s is truncated at level %d.\n", sourcePath.c_str(), level);
+                    return false;
+                }
+
+                size_t imageSize = readUInt32(data + offset);
+
+                offset += 4;
+                image.resize(rowSize * levelHeight);
+
+                for (int y = 0; y < levelHeight; y++)
+                {
+                    memcpy(&image[y * rowSize], data + offset + y * paddedRowSize, rowSize);
+                }
+
+                offset = (offset + imageSize + 3) & ~(size_t)3;
+            }
+            else
+            {
+                downsample(image, width >> (level - 1) > 0 ? width >> (level - 1) : 1,
+                           height >> (level - 1) > 0 ? height >> (level - 1) : 1, channels, &nextImage);
+                image.swap(nextImage);
+            }
+
+            writeUInt32(&output, (unsigned int)(((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * (channels == 4 ? 16 : 8)));
+            if (channels == 4)
+            {
+                encodeETC2EACImage(&image[0], levelWidth, levelHeight, &output);
+            }
+            else
+            {
+                encodeETC1Image(&image[0], levelWidth, levelHeight, &output);
+            }
+        }
+
+        if (!writeCacheFile(*cachePath, output))
+        {
+            return false;
+        }
+
+        LOGI("TextureFormatSelector: transcoded %s to %s\n", sourcePath.c_str(), cachePath->c_str());
+
+        return true;
+    }
+
+    bool TextureFormatSelector::loadPrebuilt(const string &basePath, GLuint *textureID, KTXTextureInfo *info, Family *family)
+    {
+        for (int familyIndex = FAMILY_ASTC; familyIndex <= FAMILY_ETC1; familyIndex++)
+        {
+            Family candidate = (Family)familyIndex;
+            string path = basePath + getSuffix(candidate);
+
+            if (!isFamilySupported(candidate) || !fileExists(path.c_str()))
+            {
+                continue;
+            }
+
+            /* A file may still hold a block size or variant the driver rejects, then the next family is tried. */
+            if (KTXLoader::load(path.c_str(), textureID, info))
+            {
+                LOGI("TextureFormatSelector: loaded %s\n", path.c_str());
+
+                if (family != NULL)
+                {
+                    *family = candidate;
+                }
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool TextureFormatSelector::loadTexture(const char *basePath, GLuint *textureID, KTXTextureInfo *info, Family *family)
+    {
+        string base = basePath;
+
+        *textureID = 0;
+
+        if (loadPrebuilt(base, textureID, info, family))
+        {
+            return true;
+        }
+
+        string sourcePath = base + getSuffix(FAMILY_UNCOMPRESSED);
+
+        if (!cacheDirectory.empty())
+        {
+            Family transcodeFamily = isFamilySupported(FAMILY_ETC2) ? FAMILY_ETC2 : FAMILY_ETC1;
+            GLenum internalFormat = (transcodeFamily == FAMILY_ETC2) ? GL_COMPRESSED_RGB8_ETC2 : GL_ETC1_RGB8_OES;
+            string cachePath;
+
+            if (isFamilySupported(transcodeFamily) && transcode(sourcePath, internalFormat, &cachePath) &&
+                KTXLoader::load(cachePath.c_str(), textureID, info))
+            {
+                LOGI("TextureFormatSelector: loaded %s\n", cachePath.c_str());
+
+                if (family != NULL)
+                {
+                    *family = transcodeFamily;
+                }
+
+                return true;
+            }
+        }
+
+        if (!KTXLoader::load(sourcePath.c_str(), textureID, info))
+        {
+            LOGE("TextureFormatSelector: no usable variant of %s\n", basePath);
+            return false;
+        }
+
+        LOGI("TextureFormatSelector: loaded %s uncompressed\n", sourcePath.c_str());
+
+        if (family != NULL)
+        {
+            *family = FAMILY_UNCOMPRESSED;
+        }
+
+        return true;
+    }
+
+    bool TextureFormatSelector::encodeCubemap(CubemapFaceSource source, void *userData, GLenum internalFormat, const string &cachePath)
+    {
+        STARTUP_PHASE(PHASE_DECODE);
+        vector<unsigned char> faces[6];
+        int size = 0;
+
+        for (int face = 0; face < 6; face++)
+        {
+            int faceSize = 0;
+
+            if (!source(face, &faces[face], &faceSize, userData) || faceSize <= 0 ||
+                faces[face].size() != (size_t)faceSize * faceSize * 3 || (face > 0 && faceSize != size))
+            {
+                LOGE("TextureFormatSelector: face %d of %s is missing or does not match the other faces.\n", face, cachePath.c_str());
+                return false;
+            }
+
+            size = faceSize;
+        }
+
+        /* Cube maps are sampled with seamless filtering across all levels, so the whole chain is generated. */
+        int numberOfLevels = getFullMipChainLength(size, size);
+        vector<unsigned char> output;
+        vector<unsigned char> nextImage;
+
+        writeETCHeader(&output, internalFormat, size, size, 6, numberOfLevels);
+
+        for (int level = 0; level < numberOfLevels; level++)
+        {
+            int levelSize = Texture::getLevelSize(size, level);
+
+            /* imageSize is the size of one face, and 8 byte blocks never need cube padding. */
+            writeUInt32(&output, (unsigned int)(((levelSize + 3) / 4) * ((levelSize + 3) / 4) * 8));
+
+            for (int face = 0; face < 6; face++)
+            {
+                if (level > 0)
+                {
+                    int previousSize = (size >> (level - 1)) > 0 ? (size >> (level - 1)) : 1;
+
+                    downsample(faces[face], previousSize, previousSize, 3, &nextImage);
+                    faces[face].swap(nextImage);
+                }
+
+                encodeETC1Image(&faces[face][0], levelSize, levelSize, &output);
+            }
+        }
+
+        if (!writeCacheFile(cachePath, output))
+        {
+            return false;
+        }
+
+        LOGI("TextureFormatSelector: encoded a %dx%d cube map with %d levels to %s\n", size, size, numberOfLevels, cachePath.c_str());
+
+        return true;
+    }
+
+    bool TextureFormatSelector::loadCubemap(const char *basePath, CubemapFaceSource source, void *userData, GLuint *textureID, KTXTextureInfo *info, Family *family)
+    {
+        string base = basePath;
+
+        *textureID = 0;
+
+        if (loadPrebuilt(base, textureID, info, family))
+        {
+            return true;
+        }
+
+        Family encodeFamily = isFamilySupported(FAMILY_ETC2) ? FAMILY_ETC2 : FAMILY_ETC1;
+
+        if (cacheDirectory.empty() || !isFamilySupported(encodeFamily))
+        {
+            return false;
+        }
+
+        GLenum internalFormat = (encodeFamily == FAMILY_ETC2) ? GL_COMPRESSED_RGB8_ETC2 : GL_ETC1_RGB8_OES;
+        string cachePath = cacheDirectory + getCubemapCacheName(base, internalFormat, getSuffix(encodeFamily));
+
+        if (!fileExists(cachePath.c_str()) && !encodeCubemap(source, userData, internalFormat, cachePath))
+        {
+            return false;
+        }
+
+        if (!KTXLoader::load(cachePath.c_str(), textureID, info))
+        {
+            return false;
+        }
+
+        LOGI("TextureFormatSelector: loaded %s for %s\n", cachePath.c_str(), basePath);
+
+        if (family != NULL)
+        {
+            *family = encodeFamily;
+        }
+
+        return true;
+    }
+
+    bool TextureFormatSelector::encodeHeightCubemap(CubemapHeightSource source, void *userData, const string &cachePath)
+    {
+        STARTUP_PHASE(PHASE_DECODE);
+        vector<unsigned short> faces[6];
+        int size = 0;
+
+        for (int face = 0; face < 6; face++)
+        {
+            int faceSize = 0;
+
+            if (!source(face, &faces[face], &faceSize, userData) || faceSize <= 0 ||
+                faces[face].size() != (size_t)faceSize * faceSize || (face > 0 && faceSize != size))
+            {
+                LOGE("TextureFormatSelector: face %d of %s is missing or does not match the other faces.\n", face, cachePath.c_str());
+                return false;
+            }
+
+            size = faceSize;
+        }
+
+        /* The levels are averaged from 16-bit values, so the smaller ones keep more than the 8 bits of the source. */
+        int numberOfLevels = getFullMipChainLength(size, size);
+        vector<unsigned char> output;
+        vector<unsigned short> nextImage;
+
+        writeETCHeader(&output, GL_COMPRESSED_R11_EAC, size, size, 6, numberOfLevels);
+
+        for (int level = 0; level < numberOfLevels; level++)
+        {
+            int levelSize = Texture::getLevelSize(size, level);
+
+            writeUInt32(&output, (unsigned int)(((levelSize + 3) / 4) * ((levelSize + 3) / 4) * 8));
+
+            for (int face = 0; face < 6; face++)
+            {
+                if (level > 0)
+                {
+                    int previousSize = (size >> (level - 1)) > 0 ? (size >> (level - 1)) : 1;
+
+                    downsample(faces[face], previousSize, previousSize, 1, &nextImage);
+                    faces[face].swap(nextImage);
+                }
+
+                encodeR11(&faces[face][0], levelSize, levelSize, &output);
+            }
+        }
+
+        if (!writeCacheFile(cachePath, output))
+        {
+            return false;
+        }
+
+        LOGI("TextureFormatSelector: encoded a %dx%d height cube map with %d levels to %s\n", size, size, numberOfLevels, cachePath.c_str());
+
+        return true;
+    }
+
+    bool TextureFormatSelector::loadHeightCubemap(const char *basePath, CubemapHeightSource source, void *userData, GLuint *textureID, KTXTextureInfo *info)
+    {
+        string base = basePath;
+
+        *textureID = 0;
+
+        /* EAC is part of ETC2, core in OpenGL ES 3.0. */
+        if (cacheDirectory.empty() || !isFamilySupported(FAMILY_ETC2))
+        {
+            return false;
+        }
+
+        string cachePath = cacheDirectory + getCubemapCacheName(base, GL_COMPRESSED_R11_EAC, ".r11.ktx");
+
+        if (!fileExists(cachePath.c_str()) && !encodeHeightCubemap(source, userData, cachePath))
+        {
+            return false;
+        }
+
+        if (!KTXLoader::load(cachePath.c_str(), textureID, info))
+        {
+            return false;
+        }
+
+        LOGI("TextureFormatSelector: loaded %s for %s\n", cachePath.c_str(), basePath);
+
+        return true;
+    }
+}
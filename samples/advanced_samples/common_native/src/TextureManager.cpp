@@ -0,0 +1,362 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TextureManager.h"
+#include "AssetFile.h"
+#include "ETCHeader.h"
+#include "Platform.h"
+
+#if GLES_VERSION == 2
+#include <GLES2/gl2ext.h>
+#endif
+
+#include <cstdio>
+
+using std::string;
+
+namespace MaliSDK
+{
+#if GLES_VERSION == 2
+    static const GLenum managedInternalFormat = GL_ETC1_RGB8_OES;
+#elif GLES_VERSION == 3
+    /* ETC1 is a subset of ETC2, which is core in OpenGL ES 3.0. */
+    static const GLenum managedInternalFormat = GL_COMPRESSED_RGB8_ETC2;
+#endif
+
+    /* Level files are named as for Texture::loadCompressedMipmaps(). */
+    static string getLevelFilename(const string &filenameBase, int level, const string &filenameSuffix)
+    {
+        char number[16];
+        sprintf(number, "%i", level);
+        return filenameBase + number + filenameSuffix;
+    }
+
+    /* The first level no larger than minimumSize, levels past it are not dropped. */
+    static int getLastDroppableLevel(int width, int height, int numberOfLevels, int minimumSize)
+    {
+        int level = 0;
+        while (level < numberOfLevels - 1 && (width > minimumSize || height > minimumSize))
+        {
+            width = width > 1 ? width >> 1 : 1;
+            height = height > 1 ? height >> 1 : 1;
+            level++;
+        }
+        return level;
+    }
+
+    TextureManager::TextureManager(void)
+        : budget(getDeviceBudget())
+        , residentBytes(0)
+        , minimumSize(32)
+        , frame(0)
+        , overBudgetReported(false)
+    {
+    }
+
+    TextureManager::~TextureManager(void)
+    {
+        clear();
+    }
+
+    size_t TextureManager::getDeviceBudget(void)
+    {
+        const size_t minimumBudget = 32 * 1024 * 1024;
+        unsigned long totalKilobytes = 0;
+
+        FILE *meminfo = fopen("/proc/meminfo", "r");
+        if (meminfo != NULL)
+        {
+            if (fscanf(meminfo, "MemTotal: %lu kB", &totalKilobytes) != 1)
+            {
+                totalKilobytes = 0;
+            }
+            fclose(meminfo);
+        }
+
+        size_t deviceBudget = (size_t)(totalKilobytes / 16) * 1024;
+        return deviceBudget > minimumBudget ? deviceBudget : minimumBudget;
+    }
+
+    void TextureManager::setBudget(size_t bytes)
+    {
+        budget = bytes;
+        overBudgetReported = false;
+    }
+
+    void TextureManager::setMinimumSize(int size)
+    {
+        minimumSize = size > 1 ? size : 1;
+        for (size_t index = 0; index < textures.size(); index++)
+        {
+            ManagedTexture &managed = textures[index];
+            managed.lastDroppableLevel = getLastDroppableLevel(managed.width, managed.height, managed.numberOfLevels, minimumSize);
+        }
+    }
+
+    size_t TextureManager::getBytes(const ManagedTexture &managed, int firstLevel)
+    {
+        size_t bytes = 0;
+        for (int level = firstLevel; level < managed.numberOfLevels; level++)
+        {
+            bytes += managed.levelBytes[level];
+        }
+        return bytes;
+    }
+
+    TextureManager::Handle TextureManager::addCompressedMipmaps(const char *filenameBase, const char *filenameSuffix)
+    {
+        ManagedTexture managed;
+        managed.filenameBase = filenameBase;
+        managed.filenameSuffix = filenameSuffix;
+        managed.texture = 0;
+        managed.lastUsed = frame;
+        managed.residentBytes = 0;
+
+        /* Only the headers are read here, load() maps the files again to upload them. */
+        AssetFile file;
+        string filename = getLevelFilename(managed.filenameBase, 0, managed.filenameSuffix);
+        if (!file.open(filename.c_str()) || file.getSize() < 16)
+        {
+            LOGE("Failed to open '%s'\n", filename.c_str());
+            return -1;
+        }
+        ETCHeader header = ETCHeader((unsigned char *)file.getData());
+        managed.width = header.getWidth();
+        managed.height = header.getHeight();
+
+        int width = managed.width;
+        int height = managed.height;
+        managed.numberOfLevels = 1;
+        managed.levelBytes.push_back(header.getSize(managedInternalFormat));
+        while (width > 1 || height > 1)
+        {
+            if (width > 1) width >>= 1;
+            if (height > 1) height >>= 1;
+
+            filename = getLevelFilename(managed.filenameBase, managed.numberOfLevels, managed.filenameSuffix);
+            if (!file.open(filename.c_str()) || file.getSize() < 16)
+            {
+                LOGE("Failed to open '%s'\n", filename.c_str());
+                return -1;
+            }
+            header = ETCHeader((unsigned char *)file.getData());
+            managed.levelBytes.push_back(header.getSize(managedInternalFormat));
+            managed.numberOfLevels++;
+        }
+
+        managed.firstLevel = managed.numberOfLevels;
+        managed.lastDroppableLevel = getLastDroppableLevel(managed.width, managed.height, managed.numberOfLevels, minimumSize);
+        if (!load(managed, 0))
+        {
+            return -1;
+        }
+
+        textures.push_back(managed);
+        return (Handle)textures.size() - 1;
+    }
+
+    TextureManager::Handle TextureManager::addTexture(GLuint texture, size_t bytes)
+    {
+        ManagedTexture managed;
+        managed.width = 0;
+        managed.height = 0;
+        managed.numberOfLevels = 1;
+        managed.levelBytes.push_back(bytes);
+        managed.texture = texture;
+        managed.firstLevel = 0;
+        managed.lastDroppableLevel = 0;
+        managed.lastUsed = frame;
+        managed.residentBytes = bytes;
+
+        residentBytes += bytes;
+        textures.push_back(managed);
+        return (Handle)textures.size() - 1;
+    }
+
+    bool TextureManager::load(ManagedTexture &managed, int firstLevel)
+    {
+        GLuint texture = 0;
+        GL_CHECK(glGenTextures(1, &texture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+
+        /* The mappings are only needed until each level has been copied by glCompressedTexImage2D. */
+        AssetFile file;
+        for (int level = firstLevel; level < managed.numberOfLevels; level++)
+        {
+            string filename = getLevelFilename(managed.filenameBase, level, managed.filenameSuffix);
+            if (!file.open(filename.c_str()) || file.getSize() < 16 + managed.levelBytes[level])
+            {
+                LOGE("Failed to open '%s'\n", filename.c_str());
+                GL_CHECK(glDeleteTextures(1, &texture));
+                return false;
+            }
+
+            const unsigned char *data = file.getData();
+            ETCHeader header = ETCHeader((unsigned char *)data);
+            GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, level - firstLevel, managedInternalFormat, header.getWidth(), header.getHeight(), 0, managed.levelBytes[level], data + 16));
+        }
+
+        unload(managed);
+        managed.texture = texture;
+        managed.firstLevel = firstLevel;
+        managed.residentBytes = getBytes(managed, firstLevel);
+        residentBytes += managed.residentBytes;
+        return true;
+    }
+
+    void TextureManager::unload(ManagedTexture &managed)
+    {
+        if (managed.texture != 0)
+        {
+            GL_CHECK(glDeleteTextures(1, &managed.texture));
+        }
+        residentBytes -= managed.residentBytes;
+        managed.texture = 0;
+        managed.firstLevel = managed.numberOfLevels;
+        managed.residentBytes = 0;
+    }
+
+    GLuint TextureManager::use(Handle handle)
+    {
+        ManagedTexture &managed = textures[handle];
+        managed.lastUsed = frame;
+
+        /* The smallest levels fill in until update() has room to restore the larger ones. */
+        if (managed.texture == 0 && !managed.filenameBase.empty())
+        {
+            load(managed, managed.lastDroppableLevel);
+        }
+        return managed.texture;
+    }
+
+    void TextureManager::update(void)
+    {
+        frame++;
+
+        while (residentBytes > budget)
+        {
+            /* The least recently used texture of those which can be shrunk and were not drawn in the last frame. */
+            ManagedTexture *victim = NULL;
+            for (size_t index = 0; index < textures.size(); index++)
+            {
+                ManagedTexture &managed = textures[index];
+                if (managed.filenameBase.empty() || managed.texture == 0 || managed.lastUsed + 1 >= frame)
+                {
+                    continue;
+                }
+                if (victim == NULL || managed.lastUsed < victim->lastUsed)
+                {
+                    victim = &managed;
+                }
+            }
+
+            if (victim == NULL)
+            {
+                if (!overBudgetReported)
+                {
+                    LOGI("TextureManager: %u KB of textures in use exceed the budget of %u KB\n", (unsigned int)(residentBytes / 1024), (unsigned int)(budget / 1024));
+                    overBudgetReported = true;
+                }
+                return;
+            }
+
+            /* A level which cannot be read again is no reason to keep all of them. */
+            if (victim->firstLevel >= victim->lastDroppableLevel || !load(*victim, victim->firstLevel + 1))
+            {
+                unload(*victim);
+            }
+        }
+        overBudgetReported = false;
+
+        /* Give back a level to the most recently used of the shrunk textures, one per frame to spread the uploads. */
+        ManagedTexture *restore = NULL;
+        for (size_t index = 0; index < textures.size(); index++)
+        {
+            ManagedTexture &managed = textures[index];
+            if (managed.texture == 0 || managed.firstLevel == 0 || managed.lastUsed + 1 < frame)
+            {
+                continue;
+            }
+            if (residentBytes - managed.residentBytes + getBytes(managed, managed.firstLevel - 1) > budget)
+            {
+                continue;
+            }
+            if (restore == NULL || managed.lastUsed > restore->lastUsed)
+            {
+                restore = &managed;
+            }
+        }
+
+        if (restore != NULL)
+        {
+            load(*restore, restore->firstLevel - 1);
+        }
+    }
+
+    void TextureManager::clear(void)
+    {
+        for (size_t index = 0; index < textures.size(); index++)
+        {
+            if (!textures[index].filenameBase.empty())
+            {
+                unload(textures[index]);
+            }
+        }
+        textures.clear();
+        residentBytes = 0;
+        overBudgetReported = false;
+    }
+
+    size_t TextureManager::getResidentBytes(void) const
+    {
+        return residentBytes;
+    }
+
+    size_t TextureManager::getBudget(void) const
+    {
+        return budget;
+    }
+
+    int TextureManager::getDroppedLevels(Handle handle) const
+    {
+        return textures[handle].firstLevel;
+    }
+
+    void TextureManager::logResidency(const char *label) const
+    {
+        int shrunk = 0;
+        int notResident = 0;
+        for (size_t index = 0; index < textures.size(); index++)
+        {
+            const ManagedTexture &managed = textures[index];
+            if (managed.texture == 0)
+            {
+                notResident++;
+            }
+            else if (managed.firstLevel > 0)
+            {
+                shrunk++;
+            }
+        }
+
+        LOGI("%s: %u KB of %u KB texture budget resident, %i of %i textures shrunk, %i not resident\n", label,
+             (unsigned int)(residentBytes / 1024), (unsigned int)(budget / 1024), shrunk, (int)textures.size(), notResident);
+    }
+}
@@ -0,0 +1,439 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ThermalMonitor.h"
+#include "Platform.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(ANDROID)
+#include <dlfcn.h>
+#endif
+
+namespace MaliSDK
+{
+    /* The NDK thermal API is looked up at run time, it only exists from API level 30. */
+    typedef void *(*AcquireThermalManagerFunction)(void);
+    typedef void (*ReleaseThermalManagerFunction)(void *manager);
+    typedef int (*GetThermalStatusFunction)(void *manager);
+
+    static AcquireThermalManagerFunction acquireThermalManager = NULL;
+    static ReleaseThermalManagerFunction releaseThermalManager = NULL;
+    static GetThermalStatusFunction getThermalStatus = NULL;
+    static pthread_once_t thermalLookUp = PTHREAD_ONCE_INIT;
+
+    /* A limit this far below the maximum frequency is a cap rather than a rounding of the frequency tables. */
+    static const float throttledLimit = 0.95f;
+
+    static void lookUpThermalOnce(void)
+    {
+#if defined(ANDROID)
+        void *library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+        if (library != NULL)
+        {
+            acquireThermalManager = (AcquireThermalManagerFunction)dlsym(library, "AThermal_acquireManager");
+            releaseThermalManager = (ReleaseThermalManagerFunction)dlsym(library, "AThermal_releaseManager");
+            getThermalStatus = (GetThermalStatusFunction)dlsym(library, "AThermal_getCurrentThermalStatus");
+        }
+
+        if (acquireThermalManager == NULL || releaseThermalManager == NULL || getThermalStatus == NULL)
+        {
+            acquireThermalManager = NULL;
+            releaseThermalManager = NULL;
+            getThermalStatus = NULL;
+        }
+#endif
+    }
+
+    static long long getMonotonicNanoseconds(void)
+    {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
+
+    /* The first number in a sysfs file, -1 if it cannot be read. */
+    static long long readNumber(const std::string &path)
+    {
+        FILE *file = fopen(path.c_str(), "r");
+        if (file == NULL)
+        {
+            return -1;
+        }
+
+        long long value = -1;
+        if (fscanf(file, "%lld", &value) != 1)
+        {
+            value = -1;
+        }
+        fclose(file);
+
+        return value;
+    }
+
+    /* The largest of a list of numbers such as available_frequencies, -1 if it cannot be read. */
+    static long long readLargestNumber(const std::string &path)
+    {
+        FILE *file = fopen(path.c_str(), "r");
+        if (file == NULL)
+        {
+            return -1;
+        }
+
+        long long largest = -1;
+        long long value = 0;
+        while (fscanf(file, "%lld", &value) == 1)
+        {
+            largest = value > largest ? value : largest;
+        }
+        fclose(file);
+
+        return largest;
+    }
+
+    static bool containsAny(const char *name, const char *const *words, int numberOfWords)
+    {
+        for (int word = 0; word < numberOfWords; word++)
+        {
+            if (strstr(name, words[word]) != NULL)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    ThermalMonitor::ThermalMonitor(void)
+        : gpuMaximumFrequency(-1),
+          thermalManager(NULL),
+          startTime(getMonotonicNanoseconds()),
+          interval(1000000000LL),
+          stopping(false),
+          threadStarted(false)
+    {
+        pthread_mutex_init(&mutex, NULL);
+
+        /* Deadlines are on the monotonic clock, so a change of the wall clock does not stall the thread. */
+        pthread_condattr_t attributes;
+        pthread_condattr_init(&attributes);
+        pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+        pthread_cond_init(&wakeUp, &attributes);
+        pthread_condattr_destroy(&attributes);
+    }
+
+    ThermalMonitor::~ThermalMonitor(void)
+    {
+        stop();
+
+        if (thermalManager != NULL)
+        {
+            releaseThermalManager(thermalManager);
+        }
+
+        pthread_cond_destroy(&wakeUp);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void ThermalMonitor::findSources(void)
+    {
+        char path[256];
+
+        if (cpus.empty())
+        {
+            long numberOfCPUs = sysconf(_SC_NPROCESSORS_CONF);
+            for (long cpuIndex = 0; cpuIndex < numberOfCPUs; cpuIndex++)
+            {
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/cpufreq/", cpuIndex);
+                std::string directory = path;
+
+                CPU cpu;
+                cpu.currentFrequencyPath = directory + "scaling_cur_freq";
+                cpu.limitPath = directory + "scaling_max_freq";
+                cpu.maximumFrequency = readNumber(directory + "cpuinfo_max_freq");
+
+                /* Offline CPUs have no cpufreq directory until they come back, they are simply skipped then. */
+                if (cpu.maximumFrequency > 0)
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+
+        if (gpuPath.empty())
+        {
+            static const char *const gpuNames[] = { "mali", "gpu", "kgsl" };
+
+            DIR *directory = opendir("/sys/class/devfreq");
+            if (directory != NULL)
+            {
+                for (dirent *entry = readdir(directory); entry != NULL && gpuPath.empty(); entry = readdir(directory))
+                {
+                    if (containsAny(entry->d_name, gpuNames, sizeof(gpuNames) / sizeof(gpuNames[0])))
+                    {
+                        std::string device = std::string("/sys/class/devfreq/") + entry->d_name + "/";
+                        if (readNumber(device + "cur_freq") > 0)
+                        {
+                            gpuPath = device;
+                        }
+                    }
+                }
+                closedir(directory);
+            }
+
+            if (!gpuPath.empty())
+            {
+                gpuMaximumFrequency = readLargestNumber(gpuPath + "available_frequencies");
+            }
+        }
+
+        if (thermalZonePaths.empty())
+        {
+            DIR *directory = opendir("/sys/class/thermal");
+            if (directory != NULL)
+            {
+                for (dirent *entry = readdir(directory); entry != NULL; entry = readdir(directory))
+                {
+                    if (strncmp(entry->d_name, "thermal_zone", strlen("thermal_zone")) == 0)
+                    {
+                        std::string zone = std::string("/sys/class/thermal/") + entry->d_name + "/temp";
+                        if (readNumber(zone) != -1)
+                        {
+                            thermalZonePaths.push_back(zone);
+                        }
+                    }
+                }
+                closedir(directory);
+            }
+        }
+
+        pthread_once(&thermalLookUp, lookUpThermalOnce);
+        if (thermalManager == NULL && acquireThermalManager != NULL)
+        {
+            thermalManager = acquireThermalManager();
+        }
+
+        LOGI("ThermalMonitor: %u CPUs, GPU %s, %u thermal zones, thermal status %s.\n", (unsigned int)cpus.size(),
+             gpuPath.empty() ? "not found" : gpuPath.c_str(), (unsigned int)thermalZonePaths.size(),
+             thermalManager != NULL ? "supported" : "not supported");
+    }
+
+    ThermalMonitor::Sample ThermalMonitor::read(void)
+    {
+        Sample sample;
+        sample.time = getTime();
+        sample.cpuFrequency = -1.0f;
+        sample.cpuLimit = -1.0f;
+        sample.gpuFrequency = -1.0f;
+        sample.gpuLimit = -1.0f;
+        sample.temperature = -1.0f;
+        sample.thermalStatus = STATUS_UNKNOWN;
+
+        /* Frequencies are in kHz for the CPUs and in Hz for devfreq. */
+        for (size_t cpuIndex = 0; cpuIndex < cpus.size(); cpuIndex++)
+        {
+            const CPU &cpu = cpus[cpuIndex];
+            long long frequency = readNumber(cpu.currentFrequencyPath);
+            long long limit = readNumber(cpu.limitPath);
+
+            if (frequency > 0 && frequency / 1000.0f > sample.cpuFrequency)
+            {
+                sample.cpuFrequency = frequency / 1000.0f;
+            }
+            if (limit > 0)
+            {
+                float ratio = (float)limit / cpu.maximumFrequency;
+                if (sample.cpuLimit < 0.0f || ratio < sample.cpuLimit)
+                {
+                    sample.cpuLimit = ratio;
+                }
+            }
+        }
+
+        if (!gpuPath.empty())
+        {
+            long long frequency = readNumber(gpuPath + "cur_freq");
+            long long limit = readNumber(gpuPath + "max_freq");
+
+            if (frequency > 0)
+            {
+                sample.gpuFrequency = frequency / 1000000.0f;
+            }
+
+            /* Without a table of frequencies, the limit seen first is taken as the maximum. */
+            if (gpuMaximumFrequency <= 0)
+            {
+                gpuMaximumFrequency = limit;
+            }
+            if (limit > 0 && gpuMaximumFrequency > 0)
+            {
+                sample.gpuLimit = (float)limit / gpuMaximumFrequency;
+            }
+        }
+
+        for (size_t zone = 0; zone < thermalZonePaths.size(); zone++)
+        {
+            long long value = readNumber(thermalZonePaths[zone]);
+
+            /* Most zones are in millidegrees, a few drivers report whole degrees. Out of range values are sensors which are off. */
+            float temperature = value > 1000 ? value / 1000.0f : (float)value;
+            if (value != -1 && temperature > -40.0f && temperature < 150.0f && temperature > sample.temperature)
+            {
+                sample.temperature = temperature;
+            }
+        }
+
+        if (thermalManager != NULL)
+        {
+            sample.thermalStatus = getThermalStatus(thermalManager);
+        }
+
+        sample.throttled = sample.thermalStatus >= STATUS_MODERATE ||
+                           (sample.cpuLimit >= 0.0f && sample.cpuLimit < throttledLimit) ||
+                           (sample.gpuLimit >= 0.0f && sample.gpuLimit < throttledLimit);
+
+        return sample;
+    }
+
+    void *ThermalMonitor::threadFunction(void *monitor)
+    {
+        ThermalMonitor *self = (ThermalMonitor *)monitor;
+        long long deadline = getMonotonicNanoseconds();
+
+        pthread_mutex_lock(&self->mutex);
+        while (!self->stopping)
+        {
+            deadline += self->interval;
+
+            /* Behind by more than a sample: skip the missed ones. */
+            long long now = getMonotonicNanoseconds();
+            if (now > deadline)
+            {
+                deadline = now;
+            }
+
+            timespec wakeUpTime;
+            wakeUpTime.tv_sec = (time_t)(deadline / 1000000000LL);
+            wakeUpTime.tv_nsec = (long)(deadline % 1000000000LL);
+            while (!self->stopping && pthread_cond_timedwait(&self->wakeUp, &self->mutex, &wakeUpTime) != ETIMEDOUT)
+            {
+            }
+
+            if (!self->stopping)
+            {
+                /* The files are read without the lock, so getSamples() never waits on them. */
+                pthread_mutex_unlock(&self->mutex);
+                Sample sample = self->read();
+                pthread_mutex_lock(&self->mutex);
+                self->samples.push_back(sample);
+            }
+        }
+        pthread_mutex_unlock(&self->mutex);
+
+        return NULL;
+    }
+
+    bool ThermalMonitor::start(float samplesPerSecond)
+    {
+        if (threadStarted)
+        {
+            LOGE("ThermalMonitor: start() called while the monitor is running.\n");
+            exit(1);
+        }
+
+        findSources();
+
+        interval = (long long)(1000000000.0 / samplesPerSecond);
+        startTime = getMonotonicNanoseconds();
+        stopping = false;
+
+        Sample first = read();
+        pthread_mutex_lock(&mutex);
+        samples.clear();
+        samples.push_back(first);
+        pthread_mutex_unlock(&mutex);
+
+        if (pthread_create(&thread, NULL, &threadFunction, this) != 0)
+        {
+            LOGI("ThermalMonitor: cannot start a thread, only the first sample is recorded.\n");
+            return false;
+        }
+
+        threadStarted = true;
+        return true;
+    }
+
+    void ThermalMonitor::stop(void)
+    {
+        if (!threadStarted)
+        {
+            return;
+        }
+
+        pthread_mutex_lock(&mutex);
+        stopping = true;
+        pthread_cond_signal(&wakeUp);
+        pthread_mutex_unlock(&mutex);
+
+        pthread_join(thread, NULL);
+        threadStarted = false;
+    }
+
+    std::vector<ThermalMonitor::Sample> ThermalMonitor::getSamples(void) const
+    {
+        pthread_mutex_lock(&mutex);
+        std::vector<Sample> copy = samples;
+        pthread_mutex_unlock(&mutex);
+
+        return copy;
+    }
+
+    bool ThermalMonitor::hasThrottled(float *firstThrottledTime) const
+    {
+        bool throttled = false;
+
+        pthread_mutex_lock(&mutex);
+        for (size_t sample = 0; sample < samples.size() && !throttled; sample++)
+        {
+            if (samples[sample].throttled)
+            {
+                throttled = true;
+                if (firstThrottledTime != NULL)
+                {
+                    *firstThrottledTime = samples[sample].time;
+                }
+            }
+        }
+        pthread_mutex_unlock(&mutex);
+
+        return throttled;
+    }
+
+    float ThermalMonitor::getTime(void) const
+    {
+        return (float)((getMonotonicNanoseconds() - startTime) / 1000000000.0);
+    }
+}
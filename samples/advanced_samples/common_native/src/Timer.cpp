@@ -27,7 +27,8 @@
 
 namespace MaliSDK
 {
-    Timer::Timer()
+    Timer::Timer(Clock clock)
+        : clock(clock)
     {
         LARGE_INTEGER l;
         QueryPerformanceFrequency(&l);
@@ -45,15 +46,33 @@ namespace MaliSDK
         LARGE_INTEGER l;
         QueryPerformanceCounter(&l);
         resetStamp = (((double)l.QuadPart) * invFreq);
+        fixedStartTime = fixedTime;
     }
 
     float Timer::getTime()
     {
+        if (clock == AnimationClock && fixedTimeStep > 0)
+        {
+            return (float)((fixedTime - fixedStartTime) / 1000000000.0);
+        }
+
         LARGE_INTEGER l;
         QueryPerformanceCounter(&l);
         return (float)(((double)l.QuadPart) * invFreq - resetStamp);
     }
 
+    long long Timer::getTimeNanoseconds()
+    {
+        if (clock == AnimationClock && fixedTimeStep > 0)
+        {
+            return fixedTime - fixedStartTime;
+        }
+
+        LARGE_INTEGER l;
+        QueryPerformanceCounter(&l);
+        return (long long)((((double)l.QuadPart) * invFreq - resetStamp) * 1000000000.0);
+    }
+
     float Timer::getInterval()
     {
         float time = getTime();
@@ -77,29 +96,34 @@ namespace MaliSDK
 }
 #else
 
-#include <sys/time.h>
+#include <time.h>
 
 namespace MaliSDK
 {
-    Timer::Timer()
-        : startTime()
+    Timer::Timer(Clock clock)
+        : clock(clock)
+        , frameCount(0)
+        , fps(0.0f)
+        , lastTime(0.0f)
+        , fixedStartTime(0)
+        , startTime()
         , currentTime()
         , lastIntervalTime(0.0f)
-        , frameCount(0)
         , fpsTime(0.0f)
-        , fps(0.0f)
     {    
         startTime.tv_sec = 0;
-        startTime.tv_usec = 0;
+        startTime.tv_nsec = 0;
         currentTime.tv_sec = 0;
-        currentTime.tv_usec = 0;
+        currentTime.tv_nsec = 0;
 
         reset();
     }
 
     void Timer::reset()
     {
-        gettimeofday(&startTime, NULL);
+        /* gettimeofday() follows the wall clock, which can be stepped while a sample runs. */
+        clock_gettime(CLOCK_MONOTONIC, &startTime);
+        fixedStartTime = fixedTime;
         lastIntervalTime = 0.0;
 
         frameCount = 0;
@@ -108,10 +132,20 @@ namespace MaliSDK
 
     float Timer::getTime()
     {
-        gettimeofday(&currentTime, NULL);
-        float seconds = (currentTime.tv_sec - startTime.tv_sec);
-        float milliseconds = (float(currentTime.tv_usec - startTime.tv_usec)) / 1000000.0f;
-        return seconds + milliseconds;
+        return (float)(getTimeNanoseconds() / 1000000000.0);
+    }
+
+    long long Timer::getTimeNanoseconds()
+    {
+        if (clock == AnimationClock && fixedTimeStep > 0)
+        {
+            return fixedTime - fixedStartTime;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &currentTime);
+        long long seconds = (long long)(currentTime.tv_sec - startTime.tv_sec);
+        long long nanoseconds = (long long)(currentTime.tv_nsec - startTime.tv_nsec);
+        return seconds * 1000000000LL + nanoseconds;
     }
 
     float Timer::getInterval()
@@ -138,6 +172,24 @@ namespace MaliSDK
 
 namespace MaliSDK
 {
+    long long Timer::fixedTimeStep = 0;
+    long long Timer::fixedTime = 0;
+
+    void Timer::setFixedTimeStep(float seconds)
+    {
+        fixedTimeStep = (long long)(seconds * 1000000000.0);
+    }
+
+    void Timer::advanceFixedTime(void)
+    {
+        fixedTime += fixedTimeStep;
+    }
+
+    bool Timer::isFixedTimeStep(void)
+    {
+        return fixedTimeStep > 0;
+    }
+
     bool Timer::isTimePassed(float seconds)
     {
         float time = getTime();
@@ -148,4 +200,14 @@ namespace MaliSDK
         }
         return false;
     }
-}
\ No newline at end of file
+}
+
+extern "C" void MaliSDK_Timer_setFixedTimeStep(float seconds)
+{
+    MaliSDK::Timer::setFixedTimeStep(seconds);
+}
+
+extern "C" void MaliSDK_Timer_advanceFixedTime(void)
+{
+    MaliSDK::Timer::advanceFixedTime();
+}
@@ -0,0 +1,191 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TransformHierarchy.h"
+#include "JobScheduler.h"
+#include "VectorMath.h"
+
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* Nodes per job. Computing a world matrix is a single product, a job needs many to be worth it. */
+    static const unsigned int grainSize = 256;
+
+    static const float identity[16] =
+    {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+
+    /* The nodes of one depth, for updateRange(). */
+    struct UpdateRange
+    {
+        TransformHierarchy *hierarchy;
+        const unsigned int *nodes;
+    };
+
+    unsigned int TransformHierarchy::addNode(int parent, const float *local)
+    {
+        unsigned int node = parents.size();
+
+        if (parent >= (int)node)
+        {
+            parent = -1;
+        }
+
+        parents.push_back(parent);
+        depths.push_back(parent < 0 ? 0 : depths[parent] + 1);
+        locals.insert(locals.end(), local ? local : identity, (local ? local : identity) + 16);
+        worlds.insert(worlds.end(), identity, identity + 16);
+        dirty.push_back(1);
+
+        return node;
+    }
+
+    void TransformHierarchy::clear(void)
+    {
+        parents.clear();
+        depths.clear();
+        locals.clear();
+        worlds.clear();
+        dirty.clear();
+        levels.clear();
+        changedNodes.clear();
+    }
+
+    void TransformHierarchy::setLocal(unsigned int node, const float *local)
+    {
+        memcpy(&locals[node * 16], local, 16 * sizeof(float));
+        dirty[node] = 1;
+    }
+
+    void TransformHierarchy::updateNode(unsigned int node)
+    {
+        int parent = parents[node];
+
+        if (parent < 0)
+        {
+            memcpy(&worlds[node * 16], &locals[node * 16], 16 * sizeof(float));
+            return;
+        }
+
+        math::mat4 world = math::mat4::fromArray(&worlds[parent * 16]) * math::mat4::fromArray(&locals[node * 16]);
+        memcpy(&worlds[node * 16], world.data(), 16 * sizeof(float));
+    }
+
+    void TransformHierarchy::updateRange(unsigned int begin, unsigned int end, void *userData)
+    {
+        UpdateRange *range = static_cast<UpdateRange*>(userData);
+
+        for (unsigned int i = begin; i < end; i++)
+        {
+            range->hierarchy->updateNode(range->nodes[i]);
+        }
+    }
+
+    void TransformHierarchy::update(JobScheduler *scheduler)
+    {
+        unsigned int count = parents.size();
+
+        changedNodes.clear();
+        for (unsigned int level = 0; level < levels.size(); level++)
+        {
+            levels[level].clear();
+        }
+
+        /* Parents come first, so their flag is final by the time their children are reached. */
+        for (unsigned int node = 0; node < count; node++)
+        {
+            int parent = parents[node];
+
+            if (parent >= 0 && dirty[parent])
+            {
+                dirty[node] = 1;
+            }
+            if (dirty[node])
+            {
+                if (depths[node] >= levels.size())
+                {
+                    levels.resize(depths[node] + 1);
+                }
+                levels[depths[node]].push_back(node);
+                changedNodes.push_back(node);
+            }
+        }
+
+        if (changedNodes.empty())
+        {
+            return;
+        }
+
+        for (unsigned int level = 0; level < levels.size(); level++)
+        {
+            const std::vector<unsigned int> &nodes = levels[level];
+            UpdateRange range = { this, nodes.empty() ? NULL : &nodes[0] };
+
+            if (scheduler != NULL && nodes.size() > grainSize)
+            {
+                scheduler->parallelFor("update_transforms", nodes.size(), grainSize, updateRange, &range);
+            }
+            else
+            {
+                updateRange(0, nodes.size(), &range);
+            }
+        }
+
+        for (unsigned int i = 0; i < changedNodes.size(); i++)
+        {
+            dirty[changedNodes[i]] = 0;
+        }
+    }
+
+    const float *TransformHierarchy::getLocal(unsigned int node) const
+    {
+        return &locals[node * 16];
+    }
+
+    const float *TransformHierarchy::getWorld(unsigned int node) const
+    {
+        return &worlds[node * 16];
+    }
+
+    const float *TransformHierarchy::getWorldMatrices(void) const
+    {
+        return worlds.empty() ? NULL : &worlds[0];
+    }
+
+    int TransformHierarchy::getParent(unsigned int node) const
+    {
+        return parents[node];
+    }
+
+    unsigned int TransformHierarchy::getCount(void) const
+    {
+        return parents.size();
+    }
+
+    const std::vector<unsigned int> &TransformHierarchy::getChangedNodes(void) const
+    {
+        return changedNodes;
+    }
+}
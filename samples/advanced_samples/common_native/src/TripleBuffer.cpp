@@ -0,0 +1,88 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TripleBuffer.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace MaliSDK
+{
+    TripleBuffer::TripleBuffer(void)
+        : data(NULL),
+          stateSize(0),
+          sharedIndex(1),
+          writeIndex(2),
+          readIndex(0)
+    {
+    }
+
+    TripleBuffer::~TripleBuffer(void)
+    {
+        terminate();
+    }
+
+    void TripleBuffer::initialize(size_t stateSize)
+    {
+        terminate();
+
+        this->stateSize = stateSize;
+        data = (unsigned char *)calloc(3, stateSize);
+        readIndex = 0;
+        sharedIndex.store(1);
+        writeIndex = 2;
+    }
+
+    void TripleBuffer::terminate(void)
+    {
+        free(data);
+        data = NULL;
+        stateSize = 0;
+    }
+
+    void *TripleBuffer::getWriteBuffer(void)
+    {
+        return data + writeIndex * stateSize;
+    }
+
+    void TripleBuffer::publish(void)
+    {
+        /* Release, so the reader sees the whole snapshot once it sees the index. */
+        unsigned int previous = sharedIndex.exchange(writeIndex | freshBit, std::memory_order_acq_rel);
+        writeIndex = previous & ~freshBit;
+    }
+
+    const void *TripleBuffer::acquire(void)
+    {
+        if (sharedIndex.load(std::memory_order_relaxed) & freshBit)
+        {
+            /* Acquire, pairing with the release of publish(). */
+            unsigned int previous = sharedIndex.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & ~freshBit;
+        }
+
+        return data + readIndex * stateSize;
+    }
+
+    bool TripleBuffer::isFresh(void) const
+    {
+        return (sharedIndex.load(std::memory_order_relaxed) & freshBit) != 0;
+    }
+}
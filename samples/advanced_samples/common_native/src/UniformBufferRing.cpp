@@ -0,0 +1,168 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "UniformBufferRing.h"
+#include "FenceSync.h"
+#include "Platform.h"
+
+#include <cstring>
+
+namespace MaliSDK
+{
+    static GLsizeiptr alignUp(GLsizeiptr value, GLint alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    UniformBufferRing::UniformBufferRing(GLsizeiptr frameSize, unsigned int framesInFlight)
+        : buffer(0),
+          alignment(256),
+          maxBlockSize(16384),
+          regionSize(0),
+          numberOfRegions(framesInFlight > 0 ? framesInFlight : 1),
+          fences(numberOfRegions, (GLsync)NULL),
+          region(0),
+          head(0),
+          flushedHead(0)
+    {
+        GL_CHECK(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+        GL_CHECK(glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize));
+        if (alignment < 1)
+        {
+            alignment = 1;
+        }
+
+        /* Every region starts aligned, so offsets inside the region only need aligning relative to its start. */
+        regionSize = alignUp(frameSize, alignment);
+        staging.resize(regionSize);
+
+        GL_CHECK(glGenBuffers(1, &buffer));
+        GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, buffer));
+        GL_CHECK(glBufferData(GL_UNIFORM_BUFFER, regionSize * numberOfRegions, NULL, GL_STREAM_DRAW));
+        GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+
+        /* The first beginFrame() moves to region 0. */
+        region = numberOfRegions - 1;
+    }
+
+    UniformBufferRing::~UniformBufferRing(void)
+    {
+        for (unsigned int i = 0; i < numberOfRegions; i++)
+        {
+            if (fences[i])
+            {
+                GL_CHECK(glDeleteSync(fences[i]));
+            }
+        }
+        GL_CHECK(glDeleteBuffers(1, &buffer));
+    }
+
+    void UniformBufferRing::beginFrame(void)
+    {
+        region = (region + 1) % numberOfRegions;
+        head = 0;
+        flushedHead = 0;
+
+        GLsync fence = fences[region];
+        if (fence)
+        {
+            FenceSync::wait(fence, true, "uniform buffer");
+
+            GL_CHECK(glDeleteSync(fence));
+            fences[region] = NULL;
+        }
+    }
+
+    void *UniformBufferRing::allocate(GLsizeiptr size, GLintptr *offset)
+    {
+        if (size > maxBlockSize)
+        {
+            LOGE("Uniform allocation of %d bytes exceeds GL_MAX_UNIFORM_BLOCK_SIZE (%d).", (int)size, (int)maxBlockSize);
+            return NULL;
+        }
+
+        GLsizeiptr start = alignUp(head, alignment);
+        if (start + size > regionSize)
+        {
+            LOGE("Uniform buffer ring is full, %d of %d bytes used this frame.", (int)head, (int)regionSize);
+            return NULL;
+        }
+
+        head = start + size;
+        *offset = region * regionSize + start;
+        return &staging[start];
+    }
+
+    void UniformBufferRing::flush(void)
+    {
+        if (head == flushedHead)
+        {
+            return;
+        }
+
+        /* The fence waited on in beginFrame() guarantees the GPU is done with this region, no need to synchronize again. */
+        GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, buffer));
+        GL_CHECK(void *data = glMapBufferRange(GL_UNIFORM_BUFFER, region * regionSize + flushedHead, head - flushedHead,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        if (data)
+        {
+            memcpy(data, &staging[flushedHead], head - flushedHead);
+            GL_CHECK(glUnmapBuffer(GL_UNIFORM_BUFFER));
+        }
+        else
+        {
+            LOGE("Failed to map the uniform buffer ring.");
+        }
+        GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+
+        flushedHead = head;
+    }
+
+    void UniformBufferRing::bindRange(GLuint index, GLintptr offset, GLsizeiptr size) const
+    {
+        GL_CHECK(glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size));
+    }
+
+    void UniformBufferRing::endFrame(void)
+    {
+        flush();
+
+        if (fences[region])
+        {
+            GL_CHECK(glDeleteSync(fences[region]));
+        }
+        GL_CHECK(fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    }
+
+    GLuint UniformBufferRing::getBuffer(void) const
+    {
+        return buffer;
+    }
+
+    GLint UniformBufferRing::getAlignment(void) const
+    {
+        return alignment;
+    }
+
+    GLsizeiptr UniformBufferRing::getUsedSize(void) const
+    {
+        return head;
+    }
+}
@@ -0,0 +1,189 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "VertexLayout.h"
+#include "VertexPacking.h"
+#include "Platform.h"
+
+#include <cmath>
+#include <cstring>
+
+/* OES_vertex_half_float in OpenGL ES 2.0, core in 3.0 under a different value. */
+#if GLES_VERSION == 2
+#define VERTEX_HALF_FLOAT 0x8D61
+#else
+#define VERTEX_HALF_FLOAT GL_HALF_FLOAT
+#endif
+
+#ifndef GL_INT_2_10_10_10_REV
+#define GL_INT_2_10_10_10_REV 0x8D9F
+#endif
+
+namespace MaliSDK
+{
+    static float clampf(float value, float low, float high)
+    {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    static int quantize(float value, float low, float scale)
+    {
+        return (int)floorf(clampf(value, low, 1.0f) * scale + 0.5f);
+    }
+
+    VertexLayout::VertexLayout(void)
+        : stride(0)
+    {
+    }
+
+    GLenum VertexLayout::getType(Format format)
+    {
+        switch (format)
+        {
+            case HalfFloat:     return VERTEX_HALF_FLOAT;
+            case Short:         return GL_SHORT;
+            case UnsignedShort: return GL_UNSIGNED_SHORT;
+            case Byte:          return GL_BYTE;
+            case UnsignedByte:  return GL_UNSIGNED_BYTE;
+            case Int2101010Rev: return GL_INT_2_10_10_10_REV;
+            default:            return GL_FLOAT;
+        }
+    }
+
+    GLsizei VertexLayout::getSize(GLint components, Format format)
+    {
+        switch (format)
+        {
+            case HalfFloat:
+            case Short:
+            case UnsignedShort:
+                return components * 2;
+            case Byte:
+            case UnsignedByte:
+                return components;
+            case Int2101010Rev:
+                return 4;
+            default:
+                return components * 4;
+        }
+    }
+
+    int VertexLayout::add(GLint components, Format format)
+    {
+        if (format == Int2101010Rev && components != 4)
+        {
+            LOGE("Int2101010Rev attributes need 4 components.");
+            components = 4;
+        }
+
+        Attribute attribute;
+        attribute.components = components;
+        attribute.format = format;
+        attribute.offset = stride;
+        attributes.push_back(attribute);
+
+        stride += (getSize(components, format) + 3) & ~3;
+        return (int)attributes.size() - 1;
+    }
+
+    GLsizei VertexLayout::getStride(void) const
+    {
+        return stride;
+    }
+
+    GLsizei VertexLayout::getOffset(int attribute) const
+    {
+        return attributes[attribute].offset;
+    }
+
+    void VertexLayout::pack(int attribute, const float *values, int valueComponents, int numberOfVertices, void *vertices) const
+    {
+        const Attribute &a = attributes[attribute];
+        unsigned char *out = (unsigned char *)vertices + a.offset;
+
+        for (int v = 0; v < numberOfVertices; v++, out += stride)
+        {
+            float component[4];
+            for (int c = 0; c < 4; c++)
+            {
+                component[c] = c < valueComponents ? values[v * valueComponents + c] : (c == 3 ? 1.0f : 0.0f);
+            }
+
+            if (a.format == Int2101010Rev)
+            {
+                unsigned int word = (quantize(component[0], -1.0f, 511.0f) & 0x3ff) |
+                                    ((quantize(component[1], -1.0f, 511.0f) & 0x3ff) << 10) |
+                                    ((quantize(component[2], -1.0f, 511.0f) & 0x3ff) << 20) |
+                                    ((quantize(component[3], -1.0f, 1.0f) & 0x3) << 30);
+                memcpy(out, &word, 4);
+                continue;
+            }
+
+            for (int c = 0; c < a.components; c++)
+            {
+                switch (a.format)
+                {
+                    case HalfFloat:
+                    {
+                        unsigned short half = VertexPacking::floatToHalf(component[c]);
+                        memcpy(out + 2 * c, &half, 2);
+                        break;
+                    }
+                    case Short:
+                    {
+                        short value = (short)quantize(component[c], -1.0f, 32767.0f);
+                        memcpy(out + 2 * c, &value, 2);
+                        break;
+                    }
+                    case UnsignedShort:
+                    {
+                        unsigned short value = (unsigned short)quantize(component[c], 0.0f, 65535.0f);
+                        memcpy(out + 2 * c, &value, 2);
+                        break;
+                    }
+                    case Byte:
+                        out[c] = (unsigned char)(signed char)quantize(component[c], -1.0f, 127.0f);
+                        break;
+                    case UnsignedByte:
+                        out[c] = (unsigned char)quantize(component[c], 0.0f, 255.0f);
+                        break;
+                    default:
+                        memcpy(out + 4 * c, &component[c], 4);
+                        break;
+                }
+            }
+        }
+    }
+
+    void VertexLayout::enable(int attribute, GLuint location, GLsizei firstVertex) const
+    {
+        const Attribute &a = attributes[attribute];
+        GLboolean normalized = (a.format == Float || a.format == HalfFloat) ? GL_FALSE : GL_TRUE;
+
+        GL_CHECK(glEnableVertexAttribArray(location));
+        GL_CHECK(glVertexAttribPointer(location, a.components, getType(a.format), normalized, stride,
+                                       (const GLvoid *)(size_t)(firstVertex * stride + a.offset)));
+    }
+
+    void VertexLayout::disable(GLuint location) const
+    {
+        GL_CHECK(glDisableVertexAttribArray(location));
+    }
+}
@@ -0,0 +1,169 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "VertexPacking.h"
+#include "TangentFrames.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace MaliSDK
+{
+    unsigned short VertexPacking::floatToHalf(float value)
+    {
+        unsigned int bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        unsigned int sign = (bits >> 16) & 0x8000;
+        int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+        unsigned int mantissa = bits & 0x7fffff;
+
+        if (((bits >> 23) & 0xff) == 0xff)
+        {
+            /* Infinity stays infinity, NaN stays NaN. */
+            return (unsigned short)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+        }
+        if (exponent >= 31)
+        {
+            return (unsigned short)(sign | 0x7c00);
+        }
+        if (exponent <= 0)
+        {
+            /* Denormal or zero. */
+            if (exponent < -10)
+            {
+                return (unsigned short)sign;
+            }
+            mantissa |= 0x800000;
+            unsigned int shift = 14 - exponent;
+            unsigned int half = mantissa >> shift;
+            unsigned int remainder = mantissa & ((1u << shift) - 1);
+            unsigned int halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (half & 1)))
+            {
+                half++;
+            }
+            return (unsigned short)(sign | half);
+        }
+
+        unsigned int half = sign | (exponent << 10) | (mantissa >> 13);
+        unsigned int remainder = mantissa & 0x1fff;
+        /* Round to nearest even. A carry into the exponent is still the correctly rounded value. */
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        {
+            half++;
+        }
+        return (unsigned short)half;
+    }
+
+    static signed char toSnorm8(float value)
+    {
+        float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+        return (signed char)floorf(clamped * 127.0f + 0.5f);
+    }
+
+    void VertexPacking::encodeOctahedral(const float *normal, signed char *encoded)
+    {
+        /* Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the upper one. */
+        float sum = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+        if (sum <= 0.0f)
+        {
+            encoded[0] = 0;
+            encoded[1] = 0;
+            return;
+        }
+
+        float x = normal[0] / sum;
+        float y = normal[1] / sum;
+        if (normal[2] < 0.0f)
+        {
+            float foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldedX;
+            y = foldedY;
+        }
+
+        encoded[0] = toSnorm8(x);
+        encoded[1] = toSnorm8(y);
+    }
+
+    VertexPacking::Layout VertexPacking::pack(const IndexedModel &model, std::vector<unsigned char> *packed)
+    {
+        Layout layout;
+        layout.positionOffset = 0;
+        layout.stride = 4 * sizeof(unsigned short);
+        layout.normalOffset = -1;
+        layout.uvOffset = -1;
+        layout.tangentFrameOffset = -1;
+
+        if (model.normalOffset >= 0 && model.tangentOffset >= 0)
+        {
+            layout.tangentFrameOffset = layout.stride;
+            layout.stride += 4 * sizeof(short);
+        }
+        else if (model.normalOffset >= 0)
+        {
+            layout.normalOffset = layout.stride;
+            layout.stride += 4;
+        }
+        if (model.uvOffset >= 0)
+        {
+            layout.uvOffset = layout.stride;
+            layout.stride += 2 * sizeof(unsigned short);
+        }
+
+        int numberOfVertices = model.getNumberOfVertices();
+        packed->assign(numberOfVertices * layout.stride, 0);
+
+        for (int v = 0; v < numberOfVertices; v++)
+        {
+            const float *vertex = &model.vertices[v * model.floatsPerVertex];
+            unsigned char *out = &(*packed)[v * layout.stride];
+
+            unsigned short position[4];
+            for (int i = 0; i < 3; i++)
+            {
+                position[i] = floatToHalf(i < model.positionComponents ? vertex[model.positionOffset + i] : 0.0f);
+            }
+            position[3] = floatToHalf(1.0f);
+            memcpy(out + layout.positionOffset, position, sizeof(position));
+
+            if (layout.normalOffset >= 0)
+            {
+                encodeOctahedral(vertex + model.normalOffset, (signed char *)(out + layout.normalOffset));
+            }
+
+            if (layout.tangentFrameOffset >= 0)
+            {
+                short tangentFrame[4];
+                TangentFrames::encodeQuaternion(vertex + model.normalOffset, vertex + model.tangentOffset, tangentFrame);
+                memcpy(out + layout.tangentFrameOffset, tangentFrame, sizeof(tangentFrame));
+            }
+
+            if (layout.uvOffset >= 0)
+            {
+                unsigned short uv[2] = { floatToHalf(vertex[model.uvOffset]), floatToHalf(vertex[model.uvOffset + 1]) };
+                memcpy(out + layout.uvOffset, uv, sizeof(uv));
+            }
+        }
+
+        return layout;
+    }
+}
@@ -0,0 +1,600 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "VirtualTexture.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+
+namespace MaliSDK
+{
+    /* Enough for the GPU to be done with a feedback before the buffer it was read into comes round again. */
+    static const int numberOfReadbacks = 3;
+
+    VirtualTexture::VirtualTexture(void)
+        : pagesPerSide(0),
+          physicalPagesPerSide(0),
+          physicalTexture(0),
+          indirectionTexture(0),
+          dirtyLevels(0),
+          feedbackDivisor(1),
+          feedbackWidth(0),
+          feedbackHeight(0),
+          feedbackFramebuffer(0),
+          feedbackColour(0),
+          feedbackDepth(0),
+          readbackWritten(0),
+          readbackProcessed(0),
+          scheduler(NULL),
+          loadJob(NULL),
+          loadFinished(false),
+          frame(0),
+          lastFeedbackFrame(0),
+          maximumLoadsPerFrame(8),
+          pagesLoaded(0)
+    {
+        memset(&header, 0, sizeof(header));
+    }
+
+    VirtualTexture::~VirtualTexture(void)
+    {
+        terminate();
+    }
+
+    bool VirtualTexture::initialize(const char *filename, int physicalPagesPerSide, int feedbackDivisor, JobScheduler *scheduler)
+    {
+        terminate();
+
+        if (!file.open(filename) || file.getSize() < sizeof(VirtualTextureHeader))
+        {
+            LOGE("VirtualTexture: cannot open '%s'.\n", filename);
+            return false;
+        }
+
+        memcpy(&header, file.getData(), sizeof(header));
+
+        if (header.magic != VIRTUAL_TEXTURE_MAGIC || header.version != VIRTUAL_TEXTURE_VERSION
+            || header.numberOfLevels < 1 || (1u << (header.numberOfLevels - 1)) > VIRTUAL_TEXTURE_MAX_PAGES
+            || (header.internalFormat != GL_COMPRESSED_RGB8_ETC2 && header.internalFormat != GL_RGB8))
+        {
+            LOGE("VirtualTexture: '%s' is not a virtual texture of version %u.\n", filename, VIRTUAL_TEXTURE_VERSION);
+            file.close();
+            return false;
+        }
+
+        pagesPerSide = 1 << (header.numberOfLevels - 1);
+
+        int numberOfPages = 0;
+        levelFirstPage.resize(header.numberOfLevels);
+        for (unsigned int level = 0; level < header.numberOfLevels; level++)
+        {
+            levelFirstPage[level] = numberOfPages;
+            numberOfPages += (pagesPerSide >> level) * (pagesPerSide >> level);
+        }
+
+        if (header.dataOffset + (size_t)numberOfPages * header.pageBytes > file.getSize())
+        {
+            LOGE("VirtualTexture: '%s' is truncated.\n", filename);
+            file.close();
+            return false;
+        }
+
+        /* The physical texture has to fit the limits of the device. */
+        int paddedPageSize = header.pageSize + 2 * header.border;
+        GLint maximumTextureSize = 0;
+        GL_CHECK(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maximumTextureSize));
+        this->physicalPagesPerSide = std::max(1, std::min(physicalPagesPerSide, (int)maximumTextureSize / paddedPageSize));
+        this->feedbackDivisor = std::max(1, feedbackDivisor);
+        this->scheduler = scheduler;
+
+        pageSlots.assign(numberOfPages, -1);
+        pageRequested.assign(numberOfPages, 0);
+        pageLoading.assign(numberOfPages, false);
+        indirection.assign(numberOfPages, 0);
+
+        Slot freeSlot = { -1, 0 };
+        slots.assign(this->physicalPagesPerSide * this->physicalPagesPerSide, freeSlot);
+
+        int physicalSize = this->physicalPagesPerSide * paddedPageSize;
+        GL_CHECK(glGenTextures(1, &physicalTexture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, physicalTexture));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, header.internalFormat, physicalSize, physicalSize));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+        /* Sampled with texelFetch(), the filters only need to make it complete. */
+        GL_CHECK(glGenTextures(1, &indirectionTexture));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, indirectionTexture));
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, header.numberOfLevels, GL_RGBA8, pagesPerSide, pagesPerSide));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+        /* The coarsest page is what every other page falls back to, it is loaded now and never evicted. */
+        int coarsestPage = numberOfPages - 1;
+        uploadPage(coarsestPage, file.getData() + header.dataOffset + (size_t)coarsestPage * header.pageBytes);
+        dirtyLevels = header.numberOfLevels;
+        updateIndirection();
+
+        LOGI("VirtualTexture: '%s' is %u texels square, streamed into %d of its %d pages.\n",
+             filename, header.size, (int)slots.size(), numberOfPages);
+        return true;
+    }
+
+    void VirtualTexture::terminate(void)
+    {
+        if (loadJob != NULL)
+        {
+            scheduler->wait(loadJob);
+            loadJob = NULL;
+        }
+        loadPages.clear();
+
+        for (size_t i = 0; i < readbacks.size(); i++)
+        {
+            GL_CHECK(glDeleteBuffers(1, &readbacks[i].buffer));
+            if (readbacks[i].fence != NULL)
+            {
+                GL_CHECK(glDeleteSync(readbacks[i].fence));
+            }
+        }
+        readbacks.clear();
+        readbackWritten = 0;
+        readbackProcessed = 0;
+
+        GL_CHECK(glDeleteFramebuffers(1, &feedbackFramebuffer));
+        GL_CHECK(glDeleteRenderbuffers(1, &feedbackColour));
+        GL_CHECK(glDeleteRenderbuffers(1, &feedbackDepth));
+        GL_CHECK(glDeleteTextures(1, &physicalTexture));
+        GL_CHECK(glDeleteTextures(1, &indirectionTexture));
+        feedbackFramebuffer = 0;
+        feedbackColour = 0;
+        feedbackDepth = 0;
+        feedbackWidth = 0;
+        feedbackHeight = 0;
+        physicalTexture = 0;
+        indirectionTexture = 0;
+
+        slots.clear();
+        requestedPages.clear();
+        file.close();
+    }
+
+    bool VirtualTexture::isInitialized(void) const
+    {
+        return physicalTexture != 0;
+    }
+
+    int VirtualTexture::getLevel(int page) const
+    {
+        int level = (int)header.numberOfLevels - 1;
+
+        while (page < levelFirstPage[level])
+        {
+            level--;
+        }
+
+        return level;
+    }
+
+    void VirtualTexture::loadPagesJob(void *virtualTexture)
+    {
+        VirtualTexture *self = (VirtualTexture *)virtualTexture;
+
+        /* The file is mapped, reading the pages is where it is actually read from storage. */
+        for (size_t i = 0; i < self->loadPages.size(); i++)
+        {
+            memcpy(&self->loadData[i * self->header.pageBytes],
+                   self->file.getData() + self->header.dataOffset + (size_t)self->loadPages[i] * self->header.pageBytes,
+                   self->header.pageBytes);
+        }
+
+        self->loadFinished.store(true);
+    }
+
+    void VirtualTexture::update(void)
+    {
+        if (!isInitialized())
+        {
+            return;
+        }
+
+        frame++;
+        processFeedback();
+        streamPages();
+
+        if (dirtyLevels > 0)
+        {
+            updateIndirection();
+        }
+    }
+
+    void VirtualTexture::processFeedback(void)
+    {
+        int numberOfLevels = (int)header.numberOfLevels;
+
+        while (readbackProcessed != readbackWritten)
+        {
+            Readback &readback = readbacks[readbackProcessed % readbacks.size()];
+
+            /* Only look at feedback the GPU has finished, the next frames will catch up. */
+            GLenum status = GL_CHECK(glClientWaitSync(readback.fence, 0, 0));
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            {
+                break;
+            }
+
+            GL_CHECK(glDeleteSync(readback.fence));
+            readback.fence = NULL;
+            readbackProcessed++;
+            lastFeedbackFrame = frame;
+
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+            const unsigned char *texels = (const unsigned char *)GL_CHECK(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                                                           feedbackWidth * feedbackHeight * 4, GL_MAP_READ_BIT));
+
+            for (int i = 0; texels != NULL && i < feedbackWidth * feedbackHeight; i++)
+            {
+                const unsigned char *texel = texels + i * 4;
+
+                /* Cleared pixels request nothing. */
+                if (texel[3] == 0 || texel[2] >= numberOfLevels)
+                {
+                    continue;
+                }
+
+                int x = texel[0];
+                int y = texel[1];
+
+                /* Ask for the page and the ancestors it falls back to, coarsest first, touching the resident ones. */
+                for (int level = texel[2]; level < numberOfLevels; level++, x /= 2, y /= 2)
+                {
+                    int levelPages = pagesPerSide >> level;
+                    if (x >= levelPages || y >= levelPages)
+                    {
+                        break;
+                    }
+
+                    int page = levelFirstPage[level] + y * levelPages + x;
+                    if (pageRequested[page] == frame)
+                    {
+                        break;
+                    }
+                    pageRequested[page] = frame;
+
+                    if (pageSlots[page] >= 0)
+                    {
+                        slots[pageSlots[page]].lastUsed = frame;
+                    }
+                    else if (!pageLoading[page])
+                    {
+                        requestedPages.push_back(page);
+                    }
+                }
+            }
+
+            if (texels != NULL)
+            {
+                GL_CHECK(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+            }
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        }
+    }
+
+    void VirtualTexture::streamPages(void)
+    {
+        /* Upload the batch the last job copied. */
+        if (!loadPages.empty() && loadFinished.load())
+        {
+            if (loadJob != NULL)
+            {
+                scheduler->wait(loadJob);
+                loadJob = NULL;
+            }
+
+            for (size_t i = 0; i < loadPages.size(); i++)
+            {
+                pageLoading[loadPages[i]] = false;
+                if (uploadPage(loadPages[i], &loadData[i * header.pageBytes]))
+                {
+                    pagesLoaded++;
+                }
+            }
+            loadPages.clear();
+        }
+
+        if (!loadPages.empty() || requestedPages.empty())
+        {
+            return;
+        }
+
+        /* Pages are numbered level by level, so the coarsest come first in descending order. */
+        std::sort(requestedPages.begin(), requestedPages.end(), std::greater<int>());
+
+        for (size_t i = 0; i < requestedPages.size() && (int)loadPages.size() < maximumLoadsPerFrame; i++)
+        {
+            int page = requestedPages[i];
+
+            /* Feedback of several frames may ask for the same page. */
+            if (pageSlots[page] < 0 && !pageLoading[page])
+            {
+                pageLoading[page] = true;
+                loadPages.push_back(page);
+            }
+        }
+
+        /* The rest is asked for again by later feedback, if it is still visible. */
+        requestedPages.clear();
+
+        if (loadPages.empty())
+        {
+            return;
+        }
+
+        loadData.resize(loadPages.size() * header.pageBytes);
+        loadFinished.store(false);
+
+        if (scheduler != NULL)
+        {
+            loadJob = scheduler->create("virtual_texture_load", loadPagesJob, this);
+            scheduler->submit(loadJob);
+        }
+        else
+        {
+            loadPagesJob(this);
+        }
+    }
+
+    bool VirtualTexture::uploadPage(int page, const unsigned char *data)
+    {
+        int coarsestPage = (int)pageSlots.size() - 1;
+        int slot = -1;
+
+        /* A free slot, otherwise the least recently used page missing from the latest feedback. */
+        for (int i = 0; i < (int)slots.size(); i++)
+        {
+            if (slots[i].page < 0)
+            {
+                slot = i;
+                break;
+            }
+
+            if (slots[i].page != coarsestPage && slots[i].lastUsed < lastFeedbackFrame
+                && (slot < 0 || slots[i].lastUsed < slots[slot].lastUsed))
+            {
+                slot = i;
+            }
+        }
+
+        if (slot < 0)
+        {
+            /* Everything resident is on screen, the budget is too small for this view. */
+            return false;
+        }
+
+        if (slots[slot].page >= 0)
+        {
+            pageSlots[slots[slot].page] = -1;
+            dirtyLevels = std::max(dirtyLevels, getLevel(slots[slot].page) + 1);
+        }
+
+        slots[slot].page = page;
+        slots[slot].lastUsed = lastFeedbackFrame;
+        pageSlots[page] = slot;
+        dirtyLevels = std::max(dirtyLevels, getLevel(page) + 1);
+
+        int paddedPageSize = header.pageSize + 2 * header.border;
+        int x = (slot % physicalPagesPerSide) * paddedPageSize;
+        int y = (slot / physicalPagesPerSide) * paddedPageSize;
+
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, physicalTexture));
+        if (header.internalFormat == GL_COMPRESSED_RGB8_ETC2)
+        {
+            GL_CHECK(glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, x, y, paddedPageSize, paddedPageSize,
+                                               header.internalFormat, header.pageBytes, data));
+        }
+        else
+        {
+            GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+            GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, paddedPageSize, paddedPageSize, GL_RGB, GL_UNSIGNED_BYTE, data));
+            GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+        }
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+        return true;
+    }
+
+    void VirtualTexture::updateIndirection(void)
+    {
+        int numberOfLevels = (int)header.numberOfLevels;
+
+        /* A change at one level only changes the levels below it, which fall back to it. */
+        for (int level = std::min(dirtyLevels, numberOfLevels) - 1; level >= 0; level--)
+        {
+            int levelPages = pagesPerSide >> level;
+
+            for (int y = 0; y < levelPages; y++)
+            {
+                for (int x = 0; x < levelPages; x++)
+                {
+                    int page = levelFirstPage[level] + y * levelPages + x;
+                    int slot = pageSlots[page];
+
+                    if (slot >= 0)
+                    {
+                        indirection[page] = (slot % physicalPagesPerSide) | ((slot / physicalPagesPerSide) << 8)
+                                          | (level << 16) | (0xffu << 24);
+                    }
+                    else
+                    {
+                        indirection[page] = indirection[levelFirstPage[level + 1] + (y / 2) * (levelPages / 2) + x / 2];
+                    }
+                }
+            }
+        }
+
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, indirectionTexture));
+        for (int level = 0; level < std::min(dirtyLevels, numberOfLevels); level++)
+        {
+            GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, pagesPerSide >> level, pagesPerSide >> level,
+                                     GL_RGBA, GL_UNSIGNED_BYTE, &indirection[levelFirstPage[level]]));
+        }
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+        dirtyLevels = 0;
+    }
+
+    void VirtualTexture::bindFeedbackFramebuffer(int windowWidth, int windowHeight)
+    {
+        int width = std::max(1, windowWidth / feedbackDivisor);
+        int height = std::max(1, windowHeight / feedbackDivisor);
+
+        if (width != feedbackWidth || height != feedbackHeight)
+        {
+            for (size_t i = 0; i < readbacks.size(); i++)
+            {
+                GL_CHECK(glDeleteBuffers(1, &readbacks[i].buffer));
+                if (readbacks[i].fence != NULL)
+                {
+                    GL_CHECK(glDeleteSync(readbacks[i].fence));
+                }
+            }
+            GL_CHECK(glDeleteFramebuffers(1, &feedbackFramebuffer));
+            GL_CHECK(glDeleteRenderbuffers(1, &feedbackColour));
+            GL_CHECK(glDeleteRenderbuffers(1, &feedbackDepth));
+
+            feedbackWidth = width;
+            feedbackHeight = height;
+
+            GL_CHECK(glGenRenderbuffers(1, &feedbackColour));
+            GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, feedbackColour));
+            GL_CHECK(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+            GL_CHECK(glGenRenderbuffers(1, &feedbackDepth));
+            GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, feedbackDepth));
+            GL_CHECK(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, height));
+            GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+            GL_CHECK(glGenFramebuffers(1, &feedbackFramebuffer));
+            GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer));
+            GL_CHECK(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, feedbackColour));
+            GL_CHECK(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, feedbackDepth));
+
+            readbacks.resize(numberOfReadbacks);
+            for (size_t i = 0; i < readbacks.size(); i++)
+            {
+                GL_CHECK(glGenBuffers(1, &readbacks[i].buffer));
+                GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, readbacks[i].buffer));
+                GL_CHECK(glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, NULL, GL_STREAM_READ));
+                readbacks[i].fence = NULL;
+            }
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+            readbackWritten = 0;
+            readbackProcessed = 0;
+        }
+
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer));
+        GL_CHECK(glViewport(0, 0, feedbackWidth, feedbackHeight));
+
+        /* A cleared pixel has an alpha of 0 and requests nothing. */
+        GLfloat clearColour[4];
+        GL_CHECK(glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColour));
+        GL_CHECK(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+        GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        GL_CHECK(glClearColor(clearColour[0], clearColour[1], clearColour[2], clearColour[3]));
+    }
+
+    void VirtualTexture::readFeedback(void)
+    {
+        /* Every buffer still waits for the GPU, skip this feedback rather than stall. */
+        if (readbackWritten - readbackProcessed == readbacks.size())
+        {
+            return;
+        }
+
+        Readback &readback = readbacks[readbackWritten % readbacks.size()];
+
+        GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+        GL_CHECK(glReadPixels(0, 0, feedbackWidth, feedbackHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+        GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        readback.fence = GL_CHECK(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        readbackWritten++;
+    }
+
+    void VirtualTexture::bind(void) const
+    {
+        GL_CHECK(glActiveTexture(GL_TEXTURE1));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, indirectionTexture));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0));
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, physicalTexture));
+    }
+
+    void VirtualTexture::setUniforms(GLuint program, bool feedback) const
+    {
+        int paddedPageSize = header.pageSize + 2 * header.border;
+
+        GLint physicalLocation = GL_CHECK(glGetUniformLocation(program, "u_vtPhysical"));
+        GLint indirectionLocation = GL_CHECK(glGetUniformLocation(program, "u_vtIndirection"));
+        GLint parametersLocation = GL_CHECK(glGetUniformLocation(program, "u_vtParameters"));
+        GLint lodBiasLocation = GL_CHECK(glGetUniformLocation(program, "u_vtLodBias"));
+
+        GL_CHECK(glUniform1i(physicalLocation, 0));
+        GL_CHECK(glUniform1i(indirectionLocation, 1));
+        GL_CHECK(glUniform4f(parametersLocation, (float)pagesPerSide, (float)header.pageSize, (float)header.border,
+                             (float)(physicalPagesPerSide * paddedPageSize)));
+        /* The feedback is smaller than the window, so its derivatives are larger by the divisor. */
+        GL_CHECK(glUniform1f(lodBiasLocation, feedback ? -log2f((float)feedbackDivisor) : 0.0f));
+    }
+
+    int VirtualTexture::getSize(void) const
+    {
+        return (int)header.size;
+    }
+
+    int VirtualTexture::getNumberOfResidentPages(void) const
+    {
+        int residentPages = 0;
+
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            if (slots[i].page >= 0)
+            {
+                residentPages++;
+            }
+        }
+
+        return residentPages;
+    }
+
+    unsigned int VirtualTexture::getNumberOfPagesLoaded(void) const
+    {
+        return pagesLoaded;
+    }
+}
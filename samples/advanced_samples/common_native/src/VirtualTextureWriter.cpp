@@ -0,0 +1,140 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "VirtualTextureWriter.h"
+#include "TextureFormatSelector.h"
+#include "Platform.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+
+using std::string;
+using std::vector;
+
+namespace MaliSDK
+{
+    bool VirtualTextureWriter::write(const char *filename, int pageSize, int border, int numberOfLevels, bool compress,
+                                     RegionSource source, void *userData)
+    {
+        int pagesPerSide = 1 << (numberOfLevels - 1);
+
+        if (pageSize <= 0 || border < 0 || numberOfLevels < 1 || pagesPerSide > (int)VIRTUAL_TEXTURE_MAX_PAGES
+            || border > pageSize || (compress && (pageSize % 4 != 0 || border % 4 != 0)))
+        {
+            LOGE("VirtualTextureWriter: invalid layout for '%s'.\n", filename);
+            return false;
+        }
+
+        int paddedSize = pageSize + 2 * border;
+
+        VirtualTextureHeader header;
+        header.magic = VIRTUAL_TEXTURE_MAGIC;
+        header.version = VIRTUAL_TEXTURE_VERSION;
+        header.internalFormat = compress ? GL_COMPRESSED_RGB8_ETC2 : GL_RGB8;
+        header.size = pageSize * pagesPerSide;
+        header.pageSize = pageSize;
+        header.border = border;
+        header.numberOfLevels = numberOfLevels;
+        header.pageBytes = compress ? (paddedSize / 4) * (paddedSize / 4) * 8 : paddedSize * paddedSize * 3;
+        header.dataOffset = sizeof(VirtualTextureHeader);
+
+        string temporaryName = string(filename) + ".tmp";
+        FILE *file = fopen(temporaryName.c_str(), "wb");
+        if (file == NULL)
+        {
+            LOGE("VirtualTextureWriter: cannot write '%s'.\n", temporaryName.c_str());
+            return false;
+        }
+
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        vector<unsigned char> region;
+        vector<unsigned char> page(paddedSize * paddedSize * 3);
+        vector<unsigned char> blocks;
+
+        for (int level = 0; level < numberOfLevels && written; level++)
+        {
+            int levelPages = pagesPerSide >> level;
+            int levelSize = levelPages * pageSize;
+
+            for (int pageY = 0; pageY < levelPages && written; pageY++)
+            {
+                for (int pageX = 0; pageX < levelPages && written; pageX++)
+                {
+                    /* Ask for the part of the padded page inside the level, and replicate its edges for the rest. */
+                    int left = pageX * pageSize - border;
+                    int top = pageY * pageSize - border;
+                    int x0 = left < 0 ? 0 : left;
+                    int y0 = top < 0 ? 0 : top;
+                    int x1 = left + paddedSize > levelSize ? levelSize : left + paddedSize;
+                    int y1 = top + paddedSize > levelSize ? levelSize : top + paddedSize;
+                    int regionWidth = x1 - x0;
+
+                    region.resize(regionWidth * (y1 - y0) * 3);
+                    source(level, x0, y0, regionWidth, y1 - y0, &region[0], userData);
+
+                    for (int y = 0; y < paddedSize; y++)
+                    {
+                        int sourceY = top + y;
+                        sourceY = sourceY < y0 ? y0 : (sourceY >= y1 ? y1 - 1 : sourceY);
+
+                        for (int x = 0; x < paddedSize; x++)
+                        {
+                            int sourceX = left + x;
+                            sourceX = sourceX < x0 ? x0 : (sourceX >= x1 ? x1 - 1 : sourceX);
+
+                            memcpy(&page[(y * paddedSize + x) * 3], &region[((sourceY - y0) * regionWidth + sourceX - x0) * 3], 3);
+                        }
+                    }
+
+                    if (compress)
+                    {
+                        blocks.clear();
+                        TextureFormatSelector::encodeETC1(&page[0], paddedSize, paddedSize, &blocks);
+                        written = fwrite(&blocks[0], blocks.size(), 1, file) == 1;
+                    }
+                    else
+                    {
+                        written = fwrite(&page[0], page.size(), 1, file) == 1;
+                    }
+                }
+            }
+        }
+
+        written = fclose(file) == 0 && written;
+
+        if (!written || rename(temporaryName.c_str(), filename) != 0)
+        {
+            LOGE("VirtualTextureWriter: failed writing '%s'.\n", filename);
+            remove(temporaryName.c_str());
+            return false;
+        }
+
+        LOGI("VirtualTextureWriter: wrote '%s', %u texels square in %d levels of %d texel pages.\n",
+             filename, header.size, numberOfLevels, pageSize);
+        return true;
+    }
+}
@@ -0,0 +1,434 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "VolumeTextureLoader.h"
+#include "Platform.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace MaliSDK
+{
+    VolumeTextureLoader::VolumeTextureLoader(void)
+        : texture(0),
+          firstLayer(0),
+          loadedFiles(0),
+          uploadedFileCount(0),
+          complete(false),
+          fileCallback(NULL),
+          fileCallbackData(NULL),
+          workerStarted(false),
+          cancelled(false),
+          nextFileIndex(0)
+    {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&slotMapped, NULL);
+    }
+
+    VolumeTextureLoader::~VolumeTextureLoader(void)
+    {
+        release();
+
+        pthread_cond_destroy(&slotMapped);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void VolumeTextureLoader::release(void)
+    {
+        pthread_mutex_lock(&mutex);
+        cancelled = true;
+        pthread_cond_broadcast(&slotMapped);
+        pthread_mutex_unlock(&mutex);
+
+        if (workerStarted)
+        {
+            pthread_join(workerThread, NULL);
+            workerStarted = false;
+        }
+
+        /* The worker is gone, so no buffer is being written to any more. */
+        for (size_t slotIndex = 0; slotIndex < slots.size(); slotIndex++)
+        {
+            Slot &slot = slots[slotIndex];
+
+            if (slot.mappedData != NULL)
+            {
+                GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer));
+                GL_CHECK(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+            }
+            if (slot.fence != 0)
+            {
+                GL_CHECK(glDeleteSync(slot.fence));
+            }
+            GL_CHECK(glDeleteBuffers(1, &slot.buffer));
+        }
+
+        if (!slots.empty())
+        {
+            GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        }
+
+        slots.clear();
+    }
+
+    void VolumeTextureLoader::stop(void)
+    {
+        release();
+
+        texture = 0;
+        complete = false;
+        loadedFiles = 0;
+        uploadedFileCount = 0;
+        uploadedFiles.clear();
+        filePaths.clear();
+    }
+
+    bool VolumeTextureLoader::readFile(const std::string &filePath, void *destination) const
+    {
+        FILE *file = fopen(filePath.c_str(), "rb");
+
+        if (file == NULL)
+        {
+            LOGE("VolumeTextureLoader: failed to open '%s'.\n", filePath.c_str());
+            return false;
+        }
+
+        size_t read = fread(destination, 1, layout.bytesPerFile, file);
+
+        fclose(file);
+
+        if (read != layout.bytesPerFile)
+        {
+            LOGE("VolumeTextureLoader: '%s' is shorter than %u bytes.\n", filePath.c_str(), (unsigned int)layout.bytesPerFile);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool VolumeTextureLoader::fillBuffer(int fileIndex, void *destination, std::vector<unsigned char> &scratch) const
+    {
+        if (fileCallback == NULL)
+        {
+            return readFile(filePaths[fileIndex], destination);
+        }
+
+        scratch.resize(layout.bytesPerFile);
+
+        if (!readFile(filePaths[fileIndex], &scratch[0]))
+        {
+            return false;
+        }
+
+        fileCallback(fileIndex, &scratch[0], fileCallbackData);
+        memcpy(destination, &scratch[0], layout.bytesPerFile);
+
+        return true;
+    }
+
+    void *VolumeTextureLoader::workerFunction(void *loader)
+    {
+        VolumeTextureLoader *self = (VolumeTextureLoader *)loader;
+        int fileCount = (int)self->filePaths.size();
+        std::vector<unsigned char> scratch;
+
+        pthread_mutex_lock(&self->mutex);
+
+        while (true)
+        {
+            Slot *slot = NULL;
+
+            while (!self->cancelled && self->nextFileIndex < fileCount)
+            {
+                for (size_t slotIndex = 0; slotIndex < self->slots.size() && slot == NULL; slotIndex++)
+                {
+                    if (self->slots[slotIndex].state == SLOT_MAPPED)
+                    {
+                        slot = &self->slots[slotIndex];
+                    }
+                }
+
+                if (slot != NULL)
+                {
+                    break;
+                }
+
+                pthread_cond_wait(&self->slotMapped, &self->mutex);
+            }
+
+            if (slot == NULL)
+            {
+                break;
+            }
+
+            /* Files are taken in order and read one at a time, so they also finish in order. */
+            slot->state = SLOT_FILLING;
+            slot->fileIndex = self->nextFileIndex++;
+
+            void *destination = slot->mappedData;
+            int fileIndex = slot->fileIndex;
+
+            pthread_mutex_unlock(&self->mutex);
+
+            bool read = self->fillBuffer(fileIndex, destination, scratch);
+
+            pthread_mutex_lock(&self->mutex);
+
+            slot->readFailed = !read;
+            slot->state = SLOT_FILLED;
+        }
+
+        pthread_mutex_unlock(&self->mutex);
+
+        return NULL;
+    }
+
+    void VolumeTextureLoader::setFileCallback(FileCallback callback, void *userData)
+    {
+        fileCallback = callback;
+        fileCallbackData = userData;
+    }
+
+    bool VolumeTextureLoader::start(GLuint texture, const VolumeLayout &layout, int firstLayer,
+                                    const std::vector<std::string> &filePaths, int ringSize)
+    {
+        if (workerStarted || this->texture != 0)
+        {
+            LOGE("VolumeTextureLoader::start() called twice.\n");
+            exit(1);
+        }
+
+        if (texture == 0 || filePaths.empty() || layout.bytesPerFile == 0 || layout.layersPerFile < 1)
+        {
+            return false;
+        }
+
+        this->texture = texture;
+        this->layout = layout;
+        this->firstLayer = firstLayer;
+        this->filePaths = filePaths;
+
+        uploadedFiles.assign(filePaths.size(), false);
+        loadedFiles = 0;
+        uploadedFileCount = 0;
+        complete = false;
+        cancelled = false;
+        nextFileIndex = 0;
+
+        /* More buffers than files would never be used. */
+        if (ringSize > (int)filePaths.size())
+        {
+            ringSize = (int)filePaths.size();
+        }
+        if (ringSize < 1)
+        {
+            ringSize = 1;
+        }
+
+        slots.resize(ringSize);
+
+        for (int slotIndex = 0; slotIndex < ringSize; slotIndex++)
+        {
+            Slot &slot = slots[slotIndex];
+
+            slot.fence = 0;
+            slot.mappedData = NULL;
+            slot.state = SLOT_IDLE;
+            slot.fileIndex = -1;
+            slot.readFailed = false;
+
+            GL_CHECK(glGenBuffers(1, &slot.buffer));
+            GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer));
+            GL_CHECK(glBufferData(GL_PIXEL_UNPACK_BUFFER, layout.bytesPerFile, NULL, GL_STREAM_DRAW));
+        }
+
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+        if (pthread_create(&workerThread, NULL, &workerFunction, this) != 0)
+        {
+            /* No thread, update() reads the files itself. */
+            LOGI("VolumeTextureLoader: cannot start a worker thread, reading the files on the rendering thread.\n");
+        }
+        else
+        {
+            workerStarted = true;
+        }
+
+        return true;
+    }
+
+    void VolumeTextureLoader::uploadSlot(const Slot &slot)
+    {
+        int layer = firstLayer + slot.fileIndex * layout.layersPerFile;
+
+        GL_CHECK(glBindTexture(layout.target, texture));
+
+        if (layout.format == GL_NONE)
+        {
+            GL_CHECK(glCompressedTexSubImage3D(layout.target, 0, 0, 0, layer, layout.width, layout.height, layout.layersPerFile,
+                                               layout.internalFormat, layout.bytesPerFile, 0));
+        }
+        else
+        {
+            GL_CHECK(glTexSubImage3D(layout.target, 0, 0, 0, layer, layout.width, layout.height, layout.layersPerFile,
+                                     layout.format, layout.type, 0));
+        }
+    }
+
+    bool VolumeTextureLoader::update(void)
+    {
+        if (complete || texture == 0)
+        {
+            return complete;
+        }
+
+        int fileCount = (int)filePaths.size();
+
+        /* Copy the filled buffers to the texture. The worker never touches a filled slot, so no lock is needed for it. */
+        for (size_t slotIndex = 0; slotIndex < slots.size(); slotIndex++)
+        {
+            Slot &slot = slots[slotIndex];
+
+            pthread_mutex_lock(&mutex);
+            bool filled = slot.state == SLOT_FILLED;
+            pthread_mutex_unlock(&mutex);
+
+            if (!filled)
+            {
+                continue;
+            }
+
+            GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer));
+            GL_CHECK(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+            if (slot.readFailed)
+            {
+                /* The layers of the file keep whatever they held before. */
+                LOGE("VolumeTextureLoader: skipping '%s'.\n", filePaths[slot.fileIndex].c_str());
+            }
+            else
+            {
+                uploadSlot(slot);
+                uploadedFiles[slot.fileIndex] = true;
+
+                /* The buffer may only be written again once the copy out of it is done. */
+                slot.fence = GL_CHECK(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+            }
+
+            uploadedFileCount++;
+
+            pthread_mutex_lock(&mutex);
+            slot.mappedData = NULL;
+            slot.state = SLOT_IDLE;
+            pthread_mutex_unlock(&mutex);
+        }
+
+        /* Hand the buffers whose copies are done to the worker, while some files have no buffer yet. */
+        int requestedFiles = uploadedFileCount;
+
+        for (size_t slotIndex = 0; slotIndex < slots.size(); slotIndex++)
+        {
+            if (slots[slotIndex].state != SLOT_IDLE)
+            {
+                requestedFiles++;
+            }
+        }
+
+        for (size_t slotIndex = 0; slotIndex < slots.size() && requestedFiles < fileCount; slotIndex++)
+        {
+            Slot &slot = slots[slotIndex];
+
+            if (slot.state != SLOT_IDLE)
+            {
+                continue;
+            }
+
+            if (slot.fence != 0)
+            {
+                GLenum status = GL_CHECK(glClientWaitSync(slot.fence, 0, 0));
+
+                if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                {
+                    continue;
+                }
+
+                GL_CHECK(glDeleteSync(slot.fence));
+                slot.fence = 0;
+            }
+
+            GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer));
+            void *mappedData = GL_CHECK(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, layout.bytesPerFile,
+                                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+
+            if (mappedData == NULL)
+            {
+                LOGE("VolumeTextureLoader: mapping a pixel unpack buffer FAILED!\n");
+                exit(1);
+            }
+
+            requestedFiles++;
+
+            if (workerStarted)
+            {
+                pthread_mutex_lock(&mutex);
+                slot.mappedData = mappedData;
+                slot.state = SLOT_MAPPED;
+                pthread_cond_signal(&slotMapped);
+                pthread_mutex_unlock(&mutex);
+            }
+            else
+            {
+                /* Uploaded by the next call, like a buffer filled by the worker. */
+                slot.mappedData = mappedData;
+                slot.fileIndex = nextFileIndex++;
+                std::vector<unsigned char> scratch;
+
+                slot.readFailed = !fillBuffer(slot.fileIndex, mappedData, scratch);
+                slot.state = SLOT_FILLED;
+            }
+        }
+
+        GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+        while (loadedFiles < fileCount && uploadedFiles[loadedFiles])
+        {
+            loadedFiles++;
+        }
+
+        if (uploadedFileCount == fileCount)
+        {
+            release();
+            complete = true;
+        }
+
+        return complete;
+    }
+
+    bool VolumeTextureLoader::isComplete(void) const
+    {
+        return complete;
+    }
+
+    int VolumeTextureLoader::getLoadedLayers(void) const
+    {
+        return loadedFiles * layout.layersPerFile;
+    }
+}
@@ -0,0 +1,186 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "WeightedBlendedOIT.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Platform.h"
+#include "Shader.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* A triangle covering the viewport, without vertex buffers. */
+    static const char *resolveVertexShaderSource =
+        "#version 300 es\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 position = vec2(float((gl_VertexID & 1) * 4 - 1), float((gl_VertexID & 2) * 2 - 1));\n"
+        "    gl_Position = vec4(position, 0.0, 1.0);\n"
+        "}\n";
+
+    /* Pixels no transparent fragment touched keep a revealage of 1 and are not blended at all. */
+    static const char *resolveFragmentShaderSource =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D accumulationTexture;\n"
+        "uniform sampler2D weightTexture;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    ivec2 texel = ivec2(gl_FragCoord.xy);\n"
+        "    vec4 accumulation = texelFetch(accumulationTexture, texel, 0);\n"
+        "    float revealage = accumulation.a;\n"
+        "    if (revealage >= 1.0)\n"
+        "    {\n"
+        "        discard;\n"
+        "    }\n"
+        "    float weight = texelFetch(weightTexture, texel, 0).r;\n"
+        "    fragColor = vec4(accumulation.rgb / max(weight, 1e-5), 1.0 - revealage);\n"
+        "}\n";
+
+    static GLuint createTarget(GLenum internalFormat, GLsizei width, GLsizei height)
+    {
+        GLuint texture = 0;
+
+        GL_CHECK(glGenTextures(1, &texture));
+        GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+        GL_CHECK(glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+        return texture;
+    }
+
+    bool WeightedBlendedOIT::isSupported(void)
+    {
+        return GLExtensions::isSupported("GL_EXT_color_buffer_half_float") || GLExtensions::isSupported("GL_EXT_color_buffer_float");
+    }
+
+    WeightedBlendedOIT::WeightedBlendedOIT(GLsizei width, GLsizei height)
+        : width(width),
+          height(height),
+          resolveProgram(0)
+    {
+        accumulationTexture = createTarget(GL_RGBA16F, width, height);
+        weightTexture = createTarget(GL_R16F, width, height);
+
+        GL_CHECK(glGenRenderbuffers(1, &depthRenderbuffer));
+        GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer));
+        GL_CHECK(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height));
+        GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+        GL_CHECK(glGenFramebuffers(1, &framebuffer));
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulationTexture, 0));
+        GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weightTexture, 0));
+        GL_CHECK(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer));
+
+        static const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        GL_CHECK(glDrawBuffers(2, drawBuffers));
+
+        GLenum status = GL_CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER));
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            LOGE("WeightedBlendedOIT: framebuffer incomplete (0x%x), half float targets are not renderable.\n", status);
+            exit(1);
+        }
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+        Shader::processProgramSource(&resolveProgram, resolveVertexShaderSource, resolveFragmentShaderSource);
+
+        GLStateCache::useProgram(resolveProgram);
+        GLint accumulationTextureLocation = GL_CHECK(glGetUniformLocation(resolveProgram, "accumulationTexture"));
+        GLint weightTextureLocation = GL_CHECK(glGetUniformLocation(resolveProgram, "weightTexture"));
+        GL_CHECK(glUniform1i(accumulationTextureLocation, 0));
+        GL_CHECK(glUniform1i(weightTextureLocation, 1));
+
+        /* No attributes, but a vertex array of its own keeps the sample's enabled arrays out of the resolve. */
+        GL_CHECK(glGenVertexArrays(1, &resolveVertexArray));
+    }
+
+    WeightedBlendedOIT::~WeightedBlendedOIT(void)
+    {
+        GL_CHECK(glDeleteVertexArrays(1, &resolveVertexArray));
+        GL_CHECK(glDeleteProgram(resolveProgram));
+        GL_CHECK(glDeleteFramebuffers(1, &framebuffer));
+        GL_CHECK(glDeleteRenderbuffers(1, &depthRenderbuffer));
+        GLStateCache::deleteTextures(1, &accumulationTexture);
+        GLStateCache::deleteTextures(1, &weightTexture);
+    }
+
+    void WeightedBlendedOIT::beginOccluders(void)
+    {
+        static const GLfloat clearAccumulation[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        static const GLfloat clearWeight[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        static const GLfloat clearDepth = 1.0f;
+
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GL_CHECK(glViewport(0, 0, width, height));
+
+        /* Clearing everything at the start lets the previous contents be discarded instead of loaded. */
+        GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+        GLStateCache::depthMask(GL_TRUE);
+        GL_CHECK(glClearBufferfv(GL_COLOR, 0, clearAccumulation));
+        GL_CHECK(glClearBufferfv(GL_COLOR, 1, clearWeight));
+        GL_CHECK(glClearBufferfv(GL_DEPTH, 0, &clearDepth));
+
+        GL_CHECK(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+        GLStateCache::setEnabled(GL_BLEND, false);
+    }
+
+    void WeightedBlendedOIT::beginAccumulation(void)
+    {
+        GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+        GLStateCache::depthMask(GL_FALSE);
+
+        GLStateCache::setEnabled(GL_BLEND, true);
+        GLStateCache::blendEquation(GL_FUNC_ADD);
+        GLStateCache::blendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    void WeightedBlendedOIT::resolve(GLuint targetFramebuffer, GLsizei targetWidth, GLsizei targetHeight)
+    {
+        /* Only the colour is read back, the depth of the targets is never needed in memory. */
+        static const GLenum depthAttachment[] = { GL_DEPTH_ATTACHMENT };
+        GL_CHECK(glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, depthAttachment));
+
+        GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer));
+        GL_CHECK(glViewport(0, 0, targetWidth, targetHeight));
+
+        GLStateCache::setEnabled(GL_DEPTH_TEST, false);
+        GLStateCache::blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        GLStateCache::useProgram(resolveProgram);
+        GLStateCache::activeTexture(GL_TEXTURE1);
+        GLStateCache::bindTexture(GL_TEXTURE_2D, weightTexture);
+        GLStateCache::activeTexture(GL_TEXTURE0);
+        GLStateCache::bindTexture(GL_TEXTURE_2D, accumulationTexture);
+
+        GLStateCache::bindVertexArray(resolveVertexArray);
+        GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+        GLStateCache::bindVertexArray(0);
+    }
+}
@@ -26,7 +26,7 @@
 
 namespace MaliSDK
 {   
-    void CubeModel::getTriangleRepresentation(float scalingFactor, int* numberOfCoordinates, float** coordinates)
+    void CubeModel::getTriangleRepresentation(float scalingFactor, int* numberOfCoordinates, float** coordinates, Allocator* allocator)
     {
         if (coordinates == NULL)
         {
@@ -40,7 +40,7 @@ namespace MaliSDK
         int currentIndex = 0;
 
         /* Allocate memory for result array. */
-        *coordinates = (float*) malloc (numberOfCubeTriangleCoordinates * sizeof(float));
+        *coordinates = (float*) (allocator ? allocator->allocate(numberOfCubeTriangleCoordinates * sizeof(float)) : malloc(numberOfCubeTriangleCoordinates * sizeof(float)));
 
         /* Is allocation successful?. */
         if (*coordinates == NULL)
@@ -353,7 +353,7 @@ namespace MaliSDK
         }
     }
 
-    void CubeModel::getNormals(int* numberOfCoordinates, float** normals)
+    void CubeModel::getNormals(int* numberOfCoordinates, float** normals, Allocator* allocator)
     {
         /* Set the same normals for both triangles from each face.
          * For details: see example for getCubeTriangleRepresentation() function. 
@@ -372,7 +372,7 @@ namespace MaliSDK
         int currentIndex = 0;
 
         /* Allocate memory for result array. */
-        *normals = (float*) malloc (numberOfCubeNormalsCoordinates * sizeof(float));
+        *normals = (float*) (allocator ? allocator->allocate(numberOfCubeNormalsCoordinates * sizeof(float)) : malloc(numberOfCubeNormalsCoordinates * sizeof(float)));
 
         /* Is allocation successfu?. */
         if (*normals == NULL)
@@ -457,4 +457,38 @@ namespace MaliSDK
         
         }
     }
-}
\ No newline at end of file
+
+    void CubeModel::getIndexedRepresentation(float scalingFactor, IndexedModel* model)
+    {
+        if (model == NULL)
+        {
+            LOGE("Cannot use null pointer while creating an indexed model.");
+            return;
+        }
+
+        int numberOfCoordinates = 0;
+        float* coordinates = NULL;
+        float* normals = NULL;
+
+        getTriangleRepresentation(scalingFactor, &numberOfCoordinates, &coordinates);
+        getNormals(NULL, &normals);
+
+        if (coordinates != NULL && normals != NULL)
+        {
+            const float* streams[] = { coordinates, normals };
+            const int components[] = { 3, 3 };
+
+            if (MeshOptimizer::index(streams, components, 2, numberOfCoordinates / 3, model))
+            {
+                model->positionOffset = 0;
+                model->positionComponents = 3;
+                model->normalOffset = 3;
+                model->uvOffset = -1;
+                MeshOptimizer::optimize(model);
+            }
+        }
+
+        free(coordinates);
+        free(normals);
+    }
+}
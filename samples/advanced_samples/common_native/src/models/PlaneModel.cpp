@@ -24,10 +24,11 @@
 #include "Platform.h"
 
 #include <cassert>
+#include <cstdlib>
 
 namespace MaliSDK
 {
-    void PlaneModel::getTriangleRepresentationUVCoordinates(int* numberOfCoordinates, float** uvCoordinates)
+    void PlaneModel::getTriangleRepresentationUVCoordinates(int* numberOfCoordinates, float** uvCoordinates, Allocator* allocator)
     {
         /* Example:
          *  v   D __________ C
@@ -50,7 +51,7 @@ namespace MaliSDK
         const int numberOfUVCoordinates = 2 * 3 * 2;
 
         /* Allocate memory for result array. */
-        *uvCoordinates = (float*) malloc (numberOfUVCoordinates * sizeof(float));
+        *uvCoordinates = (float*) (allocator ? allocator->allocate(numberOfUVCoordinates * sizeof(float)) : malloc(numberOfUVCoordinates * sizeof(float)));
 
         /* Is allocation successfu?. */
         if (*uvCoordinates == NULL)
@@ -114,7 +115,7 @@ namespace MaliSDK
         }
     }
 
-    void PlaneModel::getTriangleRepresentation(int* numberOfCoordinates, float** coordinates)
+    void PlaneModel::getTriangleRepresentation(int* numberOfCoordinates, float** coordinates, Allocator* allocator)
     {
         /* Example:
          *  z   D __________ C
@@ -137,7 +138,7 @@ namespace MaliSDK
         const int numberOfSquareCoordinates = 2 * 3 * 4;
 
         /* Allocate memory for result array. */
-        *coordinates = (float*) malloc (numberOfSquareCoordinates * sizeof(float));
+        *coordinates = (float*) (allocator ? allocator->allocate(numberOfSquareCoordinates * sizeof(float)) : malloc(numberOfSquareCoordinates * sizeof(float)));
 
         /* Is allocation successfu?. */
         if (*coordinates == NULL)
@@ -237,7 +238,7 @@ namespace MaliSDK
         }
     }
 
-    void PlaneModel::getNormals(int* numberOfCoordinates, float** normals)
+    void PlaneModel::getNormals(int* numberOfCoordinates, float** normals, Allocator* allocator)
     {
         if (normals == NULL)
         {
@@ -252,7 +253,7 @@ namespace MaliSDK
         int currentIndex = 0;
 
         /* Allocate memory for result array. */
-        *normals = (float*) malloc (numberOfNormalsCoordinates * sizeof(float));
+        *normals = (float*) (allocator ? allocator->allocate(numberOfNormalsCoordinates * sizeof(float)) : malloc(numberOfNormalsCoordinates * sizeof(float)));
 
         /* Is allocation successfu?. */
         if (*normals == NULL)
@@ -293,4 +294,41 @@ namespace MaliSDK
             (*squareCoordinates)[allCoordinates + 3] = rotatedVertex.w;
         }
     }
-}
\ No newline at end of file
+
+    void PlaneModel::getIndexedRepresentation(IndexedModel* model)
+    {
+        if (model == NULL)
+        {
+            LOGE("Cannot use null pointer while creating an indexed model.");
+            return;
+        }
+
+        int numberOfCoordinates = 0;
+        float* coordinates = NULL;
+        float* normals = NULL;
+        float* uvCoordinates = NULL;
+
+        getTriangleRepresentation(&numberOfCoordinates, &coordinates);
+        getNormals(NULL, &normals);
+        getTriangleRepresentationUVCoordinates(NULL, &uvCoordinates);
+
+        if (coordinates != NULL && normals != NULL && uvCoordinates != NULL)
+        {
+            const float* streams[] = { coordinates, normals, uvCoordinates };
+            const int components[] = { 4, 3, 2 };
+
+            if (MeshOptimizer::index(streams, components, 3, numberOfCoordinates / 4, model))
+            {
+                model->positionOffset = 0;
+                model->positionComponents = 4;
+                model->normalOffset = 4;
+                model->uvOffset = 7;
+                MeshOptimizer::optimize(model);
+            }
+        }
+
+        free(coordinates);
+        free(normals);
+        free(uvCoordinates);
+    }
+}
@@ -28,7 +28,7 @@
 
 namespace MaliSDK
 {
-    void SphereModel::getPointRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, float** coordinates)
+    void SphereModel::getPointRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, float** coordinates, Allocator* allocator)
     {
        /* 
         * Sphere vertices are created according to rule: 
@@ -77,7 +77,7 @@ namespace MaliSDK
         const int numberOfSphereCoordinates = numberOfSamples * numberOfSamples * 3;
 
         /* Allocate memory for result array. */
-        *coordinates = (float*) malloc (numberOfSphereCoordinates * sizeof(float));
+        *coordinates = (float*) (allocator ? allocator->allocate(numberOfSphereCoordinates * sizeof(float)) : malloc(numberOfSphereCoordinates * sizeof(float)));
 
         if (*coordinates == NULL)
         {
@@ -130,7 +130,7 @@ namespace MaliSDK
         }
     }
 
-    void SphereModel::getTriangleRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, float** coordinates)
+    void SphereModel::getTriangleRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, float** coordinates, Allocator* allocator)
     {
         /* Check if parameters have compatibile values. */
         if (radius <= 0.0f)
@@ -170,7 +170,7 @@ namespace MaliSDK
         const int numberOfSphereTriangleCoordinates = (numberOfSamples - 1) * numberOfSamples * 2 * 3 * 3;
 
         /* Compute coordinates of points which make up a sphere. */
-        getPointRepresentation(radius, numberOfSamples, NULL, &pointCoordinates);
+        getPointRepresentation(radius, numberOfSamples, NULL, &pointCoordinates, allocator);
 
         if (pointCoordinates == NULL)
         {
@@ -178,7 +178,7 @@ namespace MaliSDK
             return;
         }
 
-        *coordinates = (float*) malloc (numberOfSphereTriangleCoordinates * sizeof(float));
+        *coordinates = (float*) (allocator ? allocator->allocate(numberOfSphereTriangleCoordinates * sizeof(float)) : malloc(numberOfSphereTriangleCoordinates * sizeof(float)));
 
         if (*coordinates == NULL)
         {
@@ -357,10 +357,65 @@ namespace MaliSDK
         }
 
         /* Deallocate memory. */
-        free(pointCoordinates);
+        if (allocator)
+        {
+            allocator->deallocate(pointCoordinates);
+        }
+        else
+        {
+            free(pointCoordinates);
+        }
         pointCoordinates = NULL;
     }
 
+    void SphereModel::getIndexedRepresentation(const float radius, const int numberOfSamples, IndexedModel* model)
+    {
+        if (model == NULL)
+        {
+            LOGE("Cannot use null pointer while creating an indexed model.");
+            return;
+        }
+
+        int numberOfCoordinates = 0;
+        float* coordinates = NULL;
+
+        getTriangleRepresentation(radius, numberOfSamples, &numberOfCoordinates, &coordinates);
+
+        if (coordinates == NULL)
+        {
+            return;
+        }
+
+        /* The normal of a point on a sphere centred at the origin is its direction. */
+        float* normals = (float*) malloc (numberOfCoordinates * sizeof(float));
+
+        if (normals != NULL)
+        {
+            for (int i = 0; i < numberOfCoordinates; i += 3)
+            {
+                normals[i + 0] = coordinates[i + 0] / radius;
+                normals[i + 1] = coordinates[i + 1] / radius;
+                normals[i + 2] = coordinates[i + 2] / radius;
+            }
+
+            const float* streams[] = { coordinates, normals };
+            const int components[] = { 3, 3 };
 
-    
-}
\ No newline at end of file
+            if (MeshOptimizer::index(streams, components, 2, numberOfCoordinates / 3, model))
+            {
+                model->positionOffset = 0;
+                model->positionComponents = 3;
+                model->normalOffset = 3;
+                model->uvOffset = -1;
+                MeshOptimizer::optimize(model);
+            }
+        }
+        else
+        {
+            LOGE("Could not allocate memory for normals.");
+        }
+
+        free(coordinates);
+        free(normals);
+    }
+}
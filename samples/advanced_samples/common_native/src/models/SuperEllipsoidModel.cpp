@@ -228,4 +228,39 @@ namespace MaliSDK
 	    roundedCubeNormalVectors[normalVectorIndex++] = normalVector.y;
 	    roundedCubeNormalVectors[normalVectorIndex++] = normalVector.z;
     }
-}
\ No newline at end of file
+
+    void SuperEllipsoidModel::createIndexed(int samples, float n1, float n2, float scale, IndexedModel* model)
+    {
+        if (model == NULL)
+        {
+            LOGE("Cannot use null pointer while creating an indexed model.");
+            return;
+        }
+
+        float* coordinates = NULL;
+        float* normals = NULL;
+        int numberOfVertices = 0;
+        int numberOfCoordinates = 0;
+        int numberOfNormals = 0;
+
+        create(samples, n1, n2, scale, &coordinates, &normals, &numberOfVertices, &numberOfCoordinates, &numberOfNormals);
+
+        if (coordinates != NULL && normals != NULL)
+        {
+            const float* streams[] = { coordinates, normals };
+            const int components[] = { 4, 3 };
+
+            if (MeshOptimizer::index(streams, components, 2, numberOfVertices, model))
+            {
+                model->positionOffset = 0;
+                model->positionComponents = 4;
+                model->normalOffset = 4;
+                model->uvOffset = -1;
+                MeshOptimizer::optimize(model);
+            }
+        }
+
+        delete [] coordinates;
+        delete [] normals;
+    }
+}
@@ -0,0 +1,169 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Converts a model to the baked mesh format of BakedMesh, so samples load it without the Open Asset Importer.
+ *
+ * The model is read with Assimp, which can import anything it supports (.obj, .nff, .dae, .fbx, ...). Its meshes are
+ * merged into one with their transforms applied, indexed, and ordered for the GPU with MeshOptimizer, then
+ * BakedMeshWriter quantizes the vertices and adds the levels of detail and meshlets.
+ *
+ * Built as <sample>-mesh-baker next to the samples which link Assimp, and run on the device, as the bundled
+ * Assimp library is for ARMv7 only:
+ *     adb push AssetLoading-mesh-baker libassimp.so model.obj /data/local/tmp
+ *     adb shell LD_LIBRARY_PATH=/data/local/tmp /data/local/tmp/AssetLoading-mesh-baker \
+ *         /data/local/tmp/model.obj /data/local/tmp/model.mesh
+ *     adb pull /data/local/tmp/model.mesh assets/
+ */
+
+#include "BakedMeshWriter.h"
+#include "MeshOptimizer.h"
+
+#include <assimp/cimport.h>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace MaliSDK;
+
+static void printUsage(const char *name)
+{
+    fprintf(stderr, "Usage: %s <input model> <output mesh> [--levels <count>] [--no-uvs]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = NULL;
+    const char *output = NULL;
+    unsigned int levels = 4;
+    bool keepUVs = true;
+
+    for (int argument = 1; argument < argc; argument++)
+    {
+        if (strcmp(argv[argument], "--levels") == 0 && argument + 1 < argc)
+        {
+            levels = (unsigned int)atoi(argv[++argument]);
+        }
+        else if (strcmp(argv[argument], "--no-uvs") == 0)
+        {
+            keepUVs = false;
+        }
+        else if (input == NULL)
+        {
+            input = argv[argument];
+        }
+        else if (output == NULL)
+        {
+            output = argv[argument];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (input == NULL || output == NULL || levels == 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    /* One mesh of triangles in model space, with normals so the models can be lit. */
+    const aiScene *scene = aiImportFile(input, aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_PreTransformVertices |
+                                               aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices);
+    if (scene == NULL)
+    {
+        fprintf(stderr, "Cannot import '%s': %s\n", input, aiGetErrorString());
+        return 1;
+    }
+
+    bool hasUVs = keepUVs;
+    for (unsigned int mesh = 0; mesh < scene->mNumMeshes; mesh++)
+    {
+        hasUVs = hasUVs && scene->mMeshes[mesh]->HasTextureCoords(0);
+    }
+
+    IndexedModel model;
+    model.positionOffset = 0;
+    model.positionComponents = 3;
+    model.normalOffset = 3;
+    model.uvOffset = hasUVs ? 6 : -1;
+    model.floatsPerVertex = hasUVs ? 8 : 6;
+
+    /* Indices are relative to their mesh, so offset them by the vertices of the meshes before. */
+    unsigned int firstVertex = 0;
+    for (unsigned int meshIndex = 0; meshIndex < scene->mNumMeshes; meshIndex++)
+    {
+        const aiMesh *mesh = scene->mMeshes[meshIndex];
+        if (!(mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE))
+        {
+            continue;
+        }
+
+        if (firstVertex + mesh->mNumVertices > 65536)
+        {
+            fprintf(stderr, "'%s' has more than 65536 vertices, which 16-bit indices cannot address.\n", input);
+            aiReleaseImport(scene);
+            return 1;
+        }
+
+        for (unsigned int vertex = 0; vertex < mesh->mNumVertices; vertex++)
+        {
+            const aiVector3D &position = mesh->mVertices[vertex];
+            const aiVector3D &normal = mesh->mNormals[vertex];
+
+            model.vertices.push_back(position.x);
+            model.vertices.push_back(position.y);
+            model.vertices.push_back(position.z);
+            model.vertices.push_back(normal.x);
+            model.vertices.push_back(normal.y);
+            model.vertices.push_back(normal.z);
+            if (hasUVs)
+            {
+                model.vertices.push_back(mesh->mTextureCoords[0][vertex].x);
+                model.vertices.push_back(mesh->mTextureCoords[0][vertex].y);
+            }
+        }
+
+        for (unsigned int face = 0; face < mesh->mNumFaces; face++)
+        {
+            if (mesh->mFaces[face].mNumIndices == 3)
+            {
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    model.indices.push_back((unsigned short)(mesh->mFaces[face].mIndices[corner] + firstVertex));
+                }
+            }
+        }
+
+        firstVertex += mesh->mNumVertices;
+    }
+    aiReleaseImport(scene);
+
+    printf("%s: %d vertices, %u triangles, ACMR %.2f", input, model.getNumberOfVertices(), (unsigned int)model.indices.size() / 3,
+           MeshOptimizer::getACMR(model.indices, model.getNumberOfVertices()));
+    MeshOptimizer::optimize(&model);
+    printf(", %.2f once optimized.\n", MeshOptimizer::getACMR(model.indices, model.getNumberOfVertices()));
+
+    return BakedMeshWriter::write(model, output, levels) ? 0 : 1;
+}
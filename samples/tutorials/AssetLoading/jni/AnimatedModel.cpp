@@ -0,0 +1,280 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "AnimatedModel.h"
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <cmath>
+
+#define LOG_TAG "libNative"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+/* Index of the last key at or before a time, for any of the key types of aiNodeAnim. */
+template <typename Key>
+static unsigned int findKey(const Key *keys, unsigned int numberOfKeys, double ticks)
+{
+    unsigned int key = 0;
+
+    while (key + 1 < numberOfKeys && keys[key + 1].mTime <= ticks)
+    {
+        key++;
+    }
+
+    return key;
+}
+
+/* Fraction of the way from a key to the next one. */
+template <typename Key>
+static float keyFraction(const Key *keys, unsigned int numberOfKeys, unsigned int key, double ticks)
+{
+    if (key + 1 >= numberOfKeys || keys[key + 1].mTime <= keys[key].mTime)
+    {
+        return 0.0f;
+    }
+
+    return (float)((ticks - keys[key].mTime) / (keys[key + 1].mTime - keys[key].mTime));
+}
+
+static aiVector3D interpolateVectorKeys(const aiVectorKey *keys, unsigned int numberOfKeys, double ticks)
+{
+    unsigned int key = findKey(keys, numberOfKeys, ticks);
+    float fraction = keyFraction(keys, numberOfKeys, key, ticks);
+
+    if (fraction == 0.0f)
+    {
+        return keys[key].mValue;
+    }
+
+    return keys[key].mValue + (keys[key + 1].mValue - keys[key].mValue) * fraction;
+}
+
+static aiQuaternion interpolateQuaternionKeys(const aiQuatKey *keys, unsigned int numberOfKeys, double ticks)
+{
+    unsigned int key = findKey(keys, numberOfKeys, ticks);
+    float fraction = keyFraction(keys, numberOfKeys, key, ticks);
+    aiQuaternion rotation = keys[key].mValue;
+
+    if (fraction != 0.0f)
+    {
+        aiQuaternion::Interpolate(rotation, keys[key].mValue, keys[key + 1].mValue, fraction);
+    }
+
+    return rotation.Normalize();
+}
+
+AnimatedModel::AnimatedModel(void)
+    : numberOfBones(0),
+      numberOfFrames(0),
+      framesPerSecond(0.0f),
+      duration(0.0f)
+{
+}
+
+void AnimatedModel::computeNodeTransformations(const aiAnimation *animation, const aiNode *node, const aiMatrix4x4 &parentTransformation, double ticks,
+                                               const std::map<std::string, unsigned int> &channels, std::map<std::string, aiMatrix4x4> &transformations)
+{
+    aiMatrix4x4 localTransformation = node->mTransformation;
+    std::map<std::string, unsigned int>::const_iterator channel = channels.find(node->mName.data);
+
+    if (channel != channels.end())
+    {
+        const aiNodeAnim *nodeAnimation = animation->mChannels[channel->second];
+        aiVector3D position = interpolateVectorKeys(nodeAnimation->mPositionKeys, nodeAnimation->mNumPositionKeys, ticks);
+        aiVector3D scaling = interpolateVectorKeys(nodeAnimation->mScalingKeys, nodeAnimation->mNumScalingKeys, ticks);
+        aiMatrix3x3 rotation = interpolateQuaternionKeys(nodeAnimation->mRotationKeys, nodeAnimation->mNumRotationKeys, ticks).GetMatrix();
+
+        /* Translation * rotation * scaling, rows first as Assimp stores them. */
+        localTransformation = aiMatrix4x4(rotation);
+        localTransformation.a1 *= scaling.x; localTransformation.a2 *= scaling.y; localTransformation.a3 *= scaling.z;
+        localTransformation.b1 *= scaling.x; localTransformation.b2 *= scaling.y; localTransformation.b3 *= scaling.z;
+        localTransformation.c1 *= scaling.x; localTransformation.c2 *= scaling.y; localTransformation.c3 *= scaling.z;
+        localTransformation.a4 = position.x;
+        localTransformation.b4 = position.y;
+        localTransformation.c4 = position.z;
+    }
+
+    const aiMatrix4x4 transformation = parentTransformation * localTransformation;
+    transformations[node->mName.data] = transformation;
+
+    for (unsigned int child = 0; child < node->mNumChildren; child++)
+    {
+        computeNodeTransformations(animation, node->mChildren[child], transformation, ticks, channels, transformations);
+    }
+}
+
+bool AnimatedModel::load(const aiScene *scene, float samplingRate)
+{
+    const aiMesh *mesh = NULL;
+
+    for (unsigned int i = 0; i < scene->mNumMeshes && mesh == NULL; i++)
+    {
+        if (scene->mMeshes[i]->mNumBones > 0 && scene->mMeshes[i]->HasNormals())
+        {
+            mesh = scene->mMeshes[i];
+        }
+    }
+
+    if (mesh == NULL || scene->mNumAnimations == 0)
+    {
+        LOGE("The scene has no skinned mesh or no animation.\n");
+        return false;
+    }
+
+    /* [Read the bind pose and the bone influences.] */
+    const unsigned int numberOfVertices = mesh->mNumVertices;
+
+    positions.resize(numberOfVertices * 3);
+    normals.resize(numberOfVertices * 3);
+    boneIndices.assign(numberOfVertices * 4, 0);
+    boneWeights.assign(numberOfVertices * 4, 0.0f);
+
+    for (unsigned int i = 0; i < numberOfVertices; i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            positions[i * 3 + k] = mesh->mVertices[i][k];
+            normals[i * 3 + k] = mesh->mNormals[i][k];
+        }
+    }
+
+    numberOfBones = mesh->mNumBones;
+    for (unsigned int bone = 0; bone < numberOfBones; bone++)
+    {
+        const aiBone *aiBone = mesh->mBones[bone];
+
+        for (unsigned int i = 0; i < aiBone->mNumWeights; i++)
+        {
+            const aiVertexWeight &weight = aiBone->mWeights[i];
+            float *weights = &boneWeights[weight.mVertexId * 4];
+
+            /* Keep the 4 largest influences, in place of the smallest one. */
+            int smallest = 0;
+            for (int k = 1; k < 4; k++)
+            {
+                if (weights[k] < weights[smallest])
+                {
+                    smallest = k;
+                }
+            }
+
+            if (weight.mWeight > weights[smallest])
+            {
+                weights[smallest] = weight.mWeight;
+                boneIndices[weight.mVertexId * 4 + smallest] = bone;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < numberOfVertices; i++)
+    {
+        float *weights = &boneWeights[i * 4];
+        float sum = weights[0] + weights[1] + weights[2] + weights[3];
+
+        for (int k = 0; k < 4 && sum > 0.0f; k++)
+        {
+            weights[k] /= sum;
+        }
+    }
+
+    indices.clear();
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+    {
+        const aiFace &face = mesh->mFaces[i];
+
+        if (face.mNumIndices == 3)
+        {
+            indices.push_back(face.mIndices[0]);
+            indices.push_back(face.mIndices[1]);
+            indices.push_back(face.mIndices[2]);
+        }
+    }
+    /* [Read the bind pose and the bone influences.] */
+
+    /* [Sample the animation into palettes.] */
+    const aiAnimation *animation = scene->mAnimations[0];
+    /* Assimp leaves the rate at 0 when the file does not give one. */
+    const double ticksPerSecond = animation->mTicksPerSecond != 0.0 ? animation->mTicksPerSecond : 25.0;
+    std::map<std::string, unsigned int> channels;
+
+    for (unsigned int i = 0; i < animation->mNumChannels; i++)
+    {
+        channels[animation->mChannels[i]->mNodeName.data] = i;
+    }
+
+    framesPerSecond = samplingRate;
+    duration = (float)(animation->mDuration / ticksPerSecond);
+    numberOfFrames = (unsigned int)ceilf(duration * framesPerSecond) + 1;
+    palettes.resize(numberOfFrames * numberOfBones * 12);
+
+    /* The palettes bring the vertices to model space, undo the transformation of the root node. */
+    aiMatrix4x4 rootInverse = scene->mRootNode->mTransformation;
+    rootInverse.Inverse();
+
+    std::map<std::string, aiMatrix4x4> transformations;
+    for (unsigned int frame = 0; frame < numberOfFrames; frame++)
+    {
+        double ticks = std::min(frame / framesPerSecond * ticksPerSecond, animation->mDuration);
+
+        computeNodeTransformations(animation, scene->mRootNode, aiMatrix4x4(), ticks, channels, transformations);
+
+        for (unsigned int bone = 0; bone < numberOfBones; bone++)
+        {
+            const aiBone *aiBone = mesh->mBones[bone];
+            const aiMatrix4x4 matrix = rootInverse * transformations[aiBone->mName.data] * aiBone->mOffsetMatrix;
+
+            /* aiMatrix4x4 is row major, its first three rows are the 3x4 matrix. */
+            float *rows = &palettes[(frame * numberOfBones + bone) * 12];
+            for (int element = 0; element < 12; element++)
+            {
+                rows[element] = matrix[element / 4][element % 4];
+            }
+        }
+    }
+    /* [Sample the animation into palettes.] */
+
+    LOGI("Sampled %u bones over %u frames, %.2f s of animation in %u KiB.\n",
+         numberOfBones, numberOfFrames, duration, (unsigned int)(palettes.size() * sizeof(float) / 1024));
+
+    return true;
+}
+
+void AnimatedModel::samplePalette(float time, float *palette) const
+{
+    float frame = fmodf(time, duration) * framesPerSecond;
+    if (frame < 0.0f)
+    {
+        frame += duration * framesPerSecond;
+    }
+
+    const unsigned int first = std::min((unsigned int)frame, numberOfFrames - 1);
+    const unsigned int second = std::min(first + 1, numberOfFrames - 1);
+    const float fraction = frame - first;
+
+    /* Frames are close enough together for the matrices to be blended directly. */
+    const float *firstPalette = &palettes[first * numberOfBones * 12];
+    const float *secondPalette = &palettes[second * numberOfBones * 12];
+    for (unsigned int element = 0; element < numberOfBones * 12; element++)
+    {
+        palette[element] = firstPalette[element] + (secondPalette[element] - firstPalette[element]) * fraction;
+    }
+}
@@ -0,0 +1,104 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ANIMATEDMODEL_H
+#define ANIMATEDMODEL_H
+
+#include <assimp/scene.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * \brief A skinned mesh imported by the Open Asset Importer, with its first animation baked into bone palettes.
+ *
+ * Evaluating an aiAnimation means searching the keys of every aiNodeAnim, interpolating them and walking the node
+ * hierarchy, for every bone of every character, every frame. None of that depends on the character, so load()
+ * does it once per sampled frame of the animation and keeps only the result: one 3x4 matrix per bone, from the
+ * bind pose to the current pose. A character then blends the two frames around its time into a palette.
+ *
+ * The palettes are laid out as MaliSDK::GPUSkinning expects them.
+ */
+class AnimatedModel
+{
+private:
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<unsigned int> boneIndices;
+    std::vector<float> boneWeights;
+    std::vector<unsigned short> indices;
+
+    unsigned int numberOfBones;
+    unsigned int numberOfFrames;
+    float framesPerSecond;
+    float duration;
+
+    /* numberOfFrames palettes of numberOfBones matrices, 12 floats each. */
+    std::vector<float> palettes;
+
+    /**
+     * \brief Compute the model space transformation of a node and its children, at a time of the animation.
+     * \param[in] animation The animation sampled.
+     * \param[in] node The node to start from.
+     * \param[in] parentTransformation Model space transformation of the parent of node.
+     * \param[in] ticks Time in the animation, in ticks.
+     * \param[in] channels Index of the channel animating each node, by name.
+     * \param[out] transformations Model space transformation of every node, by name.
+     */
+    static void computeNodeTransformations(const aiAnimation *animation, const aiNode *node, const aiMatrix4x4 &parentTransformation, double ticks,
+                                           const std::map<std::string, unsigned int> &channels, std::map<std::string, aiMatrix4x4> &transformations);
+public:
+    AnimatedModel(void);
+
+    /**
+     * \brief Take the first mesh with bones of a scene, and sample the first animation.
+     *
+     * The scene can be released afterwards. Meshes should be imported with aiProcess_LimitBoneWeights,
+     * influences past the 4 largest of a vertex are dropped.
+     * \param[in] scene The scene imported by the Open Asset Importer.
+     * \param[in] samplingRate Number of palettes per second of animation.
+     * \return False if the scene has no skinned mesh or no animation.
+     */
+    bool load(const aiScene *scene, float samplingRate = 30.0f);
+
+    /**
+     * \brief Blend the palettes sampled around a time of the animation, which loops.
+     * \param[in] time Time in seconds.
+     * \param[out] palette 12 floats per bone.
+     */
+    void samplePalette(float time, float *palette) const;
+
+    const float *getPositions(void) const { return &positions[0]; }
+    const float *getNormals(void) const { return &normals[0]; }
+    const unsigned int *getBoneIndices(void) const { return &boneIndices[0]; }
+    const float *getBoneWeights(void) const { return &boneWeights[0]; }
+    const unsigned short *getIndices(void) const { return &indices[0]; }
+    unsigned int getNumberOfVertices(void) const { return (unsigned int)(positions.size() / 3); }
+    unsigned int getNumberOfIndices(void) const { return (unsigned int)indices.size(); }
+    unsigned int getNumberOfBones(void) const { return numberOfBones; }
+
+    /**
+     * \brief Get the length of the animation.
+     * \return The duration in seconds.
+     */
+    float getDuration(void) const { return duration; }
+};
+#endif /* ANIMATEDMODEL_H */
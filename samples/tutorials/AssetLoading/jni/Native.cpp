@@ -19,29 +19,88 @@
  */
 
 #include <jni.h>
+#include <android/asset_manager_jni.h>
 #include <android/log.h>
 
-#include <GLES2/gl2.h>
-#include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
 
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
 
-#include "Matrix.h"
+#include "MatrixFunctions.h"
+#include "AssetFile.h"
+#include "BakedMesh.h"
+#include "GLWorkerPool.h"
+#include "JobScheduler.h"
+#include "GPUSkinning.h"
+#include "TransformHierarchy.h"
+#include "Timer.h"
+#include "AnimatedModel.h"
 
 /* [New includes and global variables.] */
 #include <assimp/cimport.h>
+#include <assimp/postprocess.h>
 #include <assimp/scene.h>
+#include <pthread.h>
+#include <deque>
 #include <vector>
 
-/* The global Assimp scene object. */
-const struct aiScene* scene = NULL;
+/* A mesh of the imported scene, drawn from its own buffers once they are uploaded. */
+struct ImportedMesh
+{
+    std::vector<GLfloat> vertices;
+    std::vector<GLushort> indices;
+    GLuint buffers[2];
+    GLsizei numberOfIndices;
+    MaliSDK::GLWorkerPool::Job *upload;
+};
+
+/* Meshes handed over by the import job, not yet taken by the rendering thread. */
+pthread_mutex_t importMutex = PTHREAD_MUTEX_INITIALIZER;
+std::deque<ImportedMesh *> importedMeshQueue;
 
-std::vector<GLfloat> vertices;
-std::vector<GLushort> indices;
+/* Meshes owned by the rendering thread, uploading or drawn. */
+std::vector<ImportedMesh *> importedMeshes;
+
+MaliSDK::JobScheduler jobScheduler;
+MaliSDK::JobScheduler::Job *importJob = NULL;
+MaliSDK::GLWorkerPool uploadPool;
 /* [New includes and global variables.] */
 
+/*
+ * The sphere baked offline with MeshBaker (see common_native/tools/MeshBaker.cpp), loaded without Assimp.
+ * The Open Asset Importer is only used if it is missing.
+ */
+#define ASSET_DIRECTORY "/data/data/com.arm.malideveloper.openglessdk.assetloading/"
+MaliSDK::BakedMesh bakedMesh;
+unsigned int bakedMeshLevel = 0;
+
+/*
+ * Characters playing the animation of character.smd, each at its own time.
+ * Each one is skinned once per frame, and drawn twice from the skinned buffer: as a planar shadow, then lit.
+ */
+#define NUMBER_OF_CHARACTERS 3
+AnimatedModel characterModel;
+MaliSDK::GPUSkinning characterSkinning[NUMBER_OF_CHARACTERS];
+std::vector<float> characterPalette;
+GLuint characterIndexBuffer = 0;
+MaliSDK::Timer animationTimer;
+MaliSDK::Timer cpuTimer(MaliSDK::Timer::RealClock);
+long long characterSkinningTime[NUMBER_OF_CHARACTERS];
+unsigned int characterFrames = 0;
+
+/*
+ * The model view matrix of every character, and of its shadow as a child of it. Nothing moves, so they are
+ * computed by the first update() and are not touched again.
+ */
+MaliSDK::TransformHierarchy characterTransforms;
+unsigned int characterNodes[NUMBER_OF_CHARACTERS];
+unsigned int characterShadowNodes[NUMBER_OF_CHARACTERS];
+
+/* The characters are only translated, so directions in model space are the same as in view space. */
+const float lightDirection[] = { 0.48f, 0.8f, 0.36f };
+
 #define LOG_TAG "libNative"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
@@ -52,10 +111,14 @@ static const char  glVertexShader[] =
         "varying vec3 fragColour;\n"
         "uniform mat4 projection;\n"
         "uniform mat4 modelView;\n"
+        "/* Baked positions are quantized to their bounding box. */\n"
+        "uniform vec3 positionScale;\n"
+        "uniform vec3 positionBias;\n"
         "void main()\n"
         "{\n"
-        "    gl_Position = projection * modelView * vertexPosition;\n"
-        "    fragColour = vertexColour;\n"
+        "    vec3 position = vertexPosition.xyz * positionScale + positionBias;\n"
+        "    gl_Position = projection * modelView * vec4(position, 1.0);\n"
+        "    fragColour = vertexColour * positionScale + positionBias;\n"
         "}\n";
 
 static const char  glFragmentShader[] =
@@ -66,6 +129,23 @@ static const char  glFragmentShader[] =
         "    gl_FragColor = vec4(fragColour, 1.0);\n"
         "}\n";
 
+static const char  glCharacterVertexShader[] =
+        "attribute vec4 skinnedPosition;\n"
+        "attribute vec3 skinnedNormal;\n"
+        "varying vec3 fragColour;\n"
+        "uniform mat4 projection;\n"
+        "uniform mat4 modelView;\n"
+        "/* In model space, towards the light. */\n"
+        "uniform vec3 lightDirection;\n"
+        "/* 1.0 when drawing the planar shadow. */\n"
+        "uniform float shadow;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_Position = projection * modelView * skinnedPosition;\n"
+        "    float diffuse = max(dot(normalize(skinnedNormal), lightDirection), 0.0);\n"
+        "    fragColour = mix(vec3(0.3, 0.5, 0.9) * (0.3 + 0.7 * diffuse), vec3(0.0), shadow);\n"
+        "}\n";
+
 GLuint loadShader(GLenum shaderType, const char* shaderSource)
 {
     GLuint shader = glCreateShader(shaderType);
@@ -152,13 +232,286 @@ GLuint vertexLocation;
 GLuint vertexColourLocation;
 GLuint projectionLocation;
 GLuint modelViewLocation;
+GLuint positionScaleLocation;
+GLuint positionBiasLocation;
+
+GLuint characterProgram;
+GLuint skinnedPositionLocation;
+GLuint skinnedNormalLocation;
+GLuint characterProjectionLocation;
+GLuint characterModelViewLocation;
+GLuint lightDirectionLocation;
+GLuint shadowLocation;
 
 float projectionMatrix[16];
 float modelViewMatrix[16];
 float angle = 0;
 
+/*
+ * Import job, run on a thread of jobScheduler.
+ * Reading the model and the post-processing steps are the slow part of importing, and need no context.
+ */
+void importScene(void *userData)
+{
+    /* [Load a model into the Open Asset Importer.] */
+    std::string sphere = "s 0 0 0 10";
+    const struct aiScene* scene = aiImportFileFromMemory(sphere.c_str(), sphere.length(),
+            aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType, ".nff");
+
+    if(!scene)
+    {
+        LOGE("Open Asset Importer could not load scene. \n");
+        return;
+    }
+    /* [Load a model into the Open Asset Importer.] */
+
+    /* [Accumulate the model vertices and indices.] */
+    /* Go through each mesh in the scene. */
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+    {
+        const aiMesh *sceneMesh = scene->mMeshes[i];
+
+        /* Points and lines are sorted into meshes of their own, only draw triangles. */
+        if (sceneMesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE)
+        {
+            continue;
+        }
+
+        ImportedMesh *mesh = new ImportedMesh;
+
+        /* Add all the vertices in the mesh to its array. */
+        for (unsigned int j = 0; j < sceneMesh->mNumVertices; j++)
+        {
+            const aiVector3D& vector = sceneMesh->mVertices[j];
+            mesh->vertices.push_back(vector.x);
+            mesh->vertices.push_back(vector.y);
+            mesh->vertices.push_back(vector.z);
+        }
+
+        /*
+         * Add all the indices in the mesh to its array.
+         * Indices are listed in the Open Asset importer relative to the mesh they are in,
+         * and each mesh gets buffers of its own, so they can be used as they are.
+         */
+        for (unsigned int j = 0 ; j < sceneMesh->mNumFaces ; j++)
+        {
+            const aiFace& face = sceneMesh->mFaces[j];
+            mesh->indices.push_back(face.mIndices[0]);
+            mesh->indices.push_back(face.mIndices[1]);
+            mesh->indices.push_back(face.mIndices[2]);
+        }
+
+        mesh->buffers[0] = 0;
+        mesh->buffers[1] = 0;
+        mesh->numberOfIndices = mesh->indices.size();
+        mesh->upload = NULL;
+
+        /* Hand the mesh over to be uploaded straight away, without waiting for the rest of the scene. */
+        pthread_mutex_lock(&importMutex);
+        importedMeshQueue.push_back(mesh);
+        pthread_mutex_unlock(&importMutex);
+    }
+    /* [Accumulate the model vertices and indices.] */
+
+    aiReleaseImport(scene);
+}
+
+/* Upload job, run on a thread of uploadPool with a context sharing objects with the rendering one. */
+void uploadMesh(void *userData)
+{
+    ImportedMesh *mesh = (ImportedMesh *)userData;
+
+    glGenBuffers(2, mesh->buffers);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, mesh->vertices.size() * sizeof(GLfloat), &mesh->vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->buffers[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->indices.size() * sizeof(GLushort), &mesh->indices[0], GL_STATIC_DRAW);
+}
+
+/* Wait for the import and the uploads, and delete every mesh. */
+void releaseImportedMeshes()
+{
+    if (importJob != NULL)
+    {
+        jobScheduler.wait(importJob);
+        importJob = NULL;
+    }
+
+    uploadPool.terminate();
+
+    pthread_mutex_lock(&importMutex);
+    importedMeshes.insert(importedMeshes.end(), importedMeshQueue.begin(), importedMeshQueue.end());
+    importedMeshQueue.clear();
+    pthread_mutex_unlock(&importMutex);
+
+    for (size_t i = 0; i < importedMeshes.size(); i++)
+    {
+        glDeleteBuffers(2, importedMeshes[i]->buffers);
+        delete importedMeshes[i];
+    }
+    importedMeshes.clear();
+}
+
+/* Import the animated character and set up the skinning of each copy of it. */
+bool loadCharacters()
+{
+    for (int i = 0; i < NUMBER_OF_CHARACTERS; i++)
+    {
+        characterSkinning[i].terminate();
+    }
+    glDeleteBuffers(1, &characterIndexBuffer);
+    characterIndexBuffer = 0;
+
+    MaliSDK::AssetFile file;
+    if (!file.open(ASSET_DIRECTORY "character.smd"))
+    {
+        LOGE("Could not open character.smd.\n");
+        return false;
+    }
+
+    /* [Import the animated model.] */
+    const struct aiScene* scene = aiImportFileFromMemory((const char *)file.getData(), file.getSize(),
+            aiProcess_Triangulate | aiProcess_LimitBoneWeights, "smd");
+    if(!scene)
+    {
+        LOGE("Open Asset Importer could not load character.smd.\n");
+        return false;
+    }
+
+    /* Everything needed from the animation is sampled, the scene can go. */
+    bool loaded = characterModel.load(scene);
+    aiReleaseImport(scene);
+    /* [Import the animated model.] */
+
+    if (!loaded)
+    {
+        LOGE("character.smd has no skinned mesh or no animation.\n");
+        return false;
+    }
+
+    /* [Set up the skinning.] */
+    bool computeSupported = false;
+    for (int i = 0; i < NUMBER_OF_CHARACTERS; i++)
+    {
+        computeSupported = characterSkinning[i].initialize(characterModel.getPositions(), characterModel.getNormals(),
+                                                           characterModel.getBoneIndices(), characterModel.getBoneWeights(),
+                                                           characterModel.getNumberOfVertices(), characterModel.getNumberOfBones());
+        characterSkinningTime[i] = 0;
+    }
+    characterPalette.resize(characterModel.getNumberOfBones() * 12);
+
+    /* Flatten the character onto the ground at y = 0, along the light. */
+    float shadowMatrix[16];
+    MaliSDK::matrixIdentityFunction(shadowMatrix);
+    shadowMatrix[4] = -lightDirection[0] / lightDirection[1];
+    shadowMatrix[5] = 0.0f;
+    shadowMatrix[6] = -lightDirection[2] / lightDirection[1];
+
+    characterTransforms.clear();
+    for (int i = 0; i < NUMBER_OF_CHARACTERS; i++)
+    {
+        float characterModelView[16];
+        MaliSDK::matrixIdentityFunction(characterModelView);
+        MaliSDK::matrixTranslate(characterModelView, (i - (NUMBER_OF_CHARACTERS - 1) / 2.0f) * 1.5f, -1.5f, -6.0f);
+
+        characterNodes[i] = characterTransforms.addNode(-1, characterModelView);
+        characterShadowNodes[i] = characterTransforms.addNode(characterNodes[i], shadowMatrix);
+    }
+
+    /* The characters only differ in their skinned vertices, the triangles are the same. */
+    glGenBuffers(1, &characterIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, characterIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, characterModel.getNumberOfIndices() * sizeof(GLushort), characterModel.getIndices(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    /* [Set up the skinning.] */
+
+    LOGI("Loaded the character, %u vertices and %u bones, skinned %s.\n", characterModel.getNumberOfVertices(),
+         characterModel.getNumberOfBones(), computeSupported ? "by a compute shader" : "on the CPU");
+
+    characterFrames = 0;
+    animationTimer.reset();
+    return true;
+}
+
+/* Skin every character for this frame, then draw each of them twice from its skinned buffer. */
+void renderCharacters()
+{
+    if (characterIndexBuffer == 0)
+    {
+        return;
+    }
+
+    /* [Skin the characters.] */
+    float time = animationTimer.getTime();
+    for (int i = 0; i < NUMBER_OF_CHARACTERS; i++)
+    {
+        long long start = cpuTimer.getTimeNanoseconds();
+
+        /* Spread the characters over the animation, so they do not move in step. */
+        characterModel.samplePalette(time + i * characterModel.getDuration() / NUMBER_OF_CHARACTERS, &characterPalette[0]);
+        characterSkinning[i].update(&characterPalette[0]);
+
+        characterSkinningTime[i] += cpuTimer.getTimeNanoseconds() - start;
+    }
+    /* [Skin the characters.] */
+
+    /* The characters are drawn over the sphere. */
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(characterProgram);
+    glUniformMatrix4fv(characterProjectionLocation, 1, GL_FALSE, projectionMatrix);
+
+    glUniform3fv(lightDirectionLocation, 1, lightDirection);
+
+    /* Only recomputes the matrices of the nodes which moved, none after the first frame. */
+    characterTransforms.update(&jobScheduler);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, characterIndexBuffer);
+    glEnableVertexAttribArray(skinnedPositionLocation);
+    glEnableVertexAttribArray(skinnedNormalLocation);
+
+    for (int i = 0; i < NUMBER_OF_CHARACTERS; i++)
+    {
+        /* [Draw the skinned vertices.] */
+        glBindBuffer(GL_ARRAY_BUFFER, characterSkinning[i].getVertexBuffer());
+        glVertexAttribPointer(skinnedPositionLocation, 4, GL_FLOAT, GL_FALSE, MaliSDK::GPUSkinning::VERTEX_STRIDE,
+                              (const void *)MaliSDK::GPUSkinning::POSITION_OFFSET);
+        glVertexAttribPointer(skinnedNormalLocation, 3, GL_FLOAT, GL_FALSE, MaliSDK::GPUSkinning::VERTEX_STRIDE,
+                              (const void *)MaliSDK::GPUSkinning::NORMAL_OFFSET);
+
+        /* Both passes read the vertices skinned once above. */
+        glUniformMatrix4fv(characterModelViewLocation, 1, GL_FALSE, characterTransforms.getWorld(characterShadowNodes[i]));
+        glUniform1f(shadowLocation, 1.0f);
+        glDrawElements(GL_TRIANGLES, characterModel.getNumberOfIndices(), GL_UNSIGNED_SHORT, 0);
+
+        glUniformMatrix4fv(characterModelViewLocation, 1, GL_FALSE, characterTransforms.getWorld(characterNodes[i]));
+        glUniform1f(shadowLocation, 0.0f);
+        glDrawElements(GL_TRIANGLES, characterModel.getNumberOfIndices(), GL_UNSIGNED_SHORT, 0);
+        /* [Draw the skinned vertices.] */
+    }
+
+    glDisableVertexAttribArray(skinnedPositionLocation);
+    glDisableVertexAttribArray(skinnedNormalLocation);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    /* Report what skinning costs the CPU, per character and frame, every couple of seconds. */
+    if (++characterFrames == 120)
+    {
+        for (int i = 0; i < NUMBER_OF_CHARACTERS; i++)
+        {
+            LOGI("Character %d: %.3f ms of CPU per frame, skinned %s.\n", i, characterSkinningTime[i] / (characterFrames * 1.0e6),
+                 characterSkinning[i].isComputeSupported() ? "by a compute shader" : "on the CPU");
+            characterSkinningTime[i] = 0;
+        }
+        characterFrames = 0;
+    }
+}
+
 bool setupGraphics(int width, int height)
 {
+    releaseImportedMeshes();
+
     glProgram = createProgram(glVertexShader, glFragmentShader);
 
     if (glProgram == 0)
@@ -171,56 +524,65 @@ bool setupGraphics(int width, int height)
     vertexColourLocation = glGetAttribLocation(glProgram, "vertexColour");
     projectionLocation = glGetUniformLocation(glProgram, "projection");
     modelViewLocation = glGetUniformLocation(glProgram, "modelView");
+    positionScaleLocation = glGetUniformLocation(glProgram, "positionScale");
+    positionBiasLocation = glGetUniformLocation(glProgram, "positionBias");
+
+    characterProgram = createProgram(glCharacterVertexShader, glFragmentShader);
+
+    if (characterProgram == 0)
+    {
+        LOGE ("Could not create character program");
+        return false;
+    }
+
+    skinnedPositionLocation = glGetAttribLocation(characterProgram, "skinnedPosition");
+    skinnedNormalLocation = glGetAttribLocation(characterProgram, "skinnedNormal");
+    characterProjectionLocation = glGetUniformLocation(characterProgram, "projection");
+    characterModelViewLocation = glGetUniformLocation(characterProgram, "modelView");
+    lightDirectionLocation = glGetUniformLocation(characterProgram, "lightDirection");
+    shadowLocation = glGetUniformLocation(characterProgram, "shadow");
 
     /* Setup the perspective */
-    matrixPerspective(projectionMatrix, 45, (float)width / (float)height, 0.1f, 100);
+    MaliSDK::matrixPerspective(projectionMatrix, 45, (float)width / (float)height, 0.1f, 100);
     glEnable(GL_DEPTH_TEST);
 
     glViewport(0, 0, width, height);
 
-    /* [Load a model into the Open Asset Importer.] */
-    std::string sphere = "s 0 0 0 10";
-    scene = aiImportFileFromMemory(sphere.c_str(), sphere.length(), 0, ".nff");
+    /* The sample still draws the sphere without them. */
+    loadCharacters();
 
-    if(!scene)
+    /* [Load the baked model.] */
+    /* The vertices and indices go from the mapped file to the buffers, nothing is parsed. */
+    if (bakedMesh.load(ASSET_DIRECTORY "sphere.mesh"))
     {
-        LOGE("Open Asset Importer could not load scene. \n");
-        return false;
+        /* The coarsest level which is still exact to a pixel, at the distance the sphere is drawn at. */
+        float pixelsPerUnit = height / (2.0f * 10.0f * tanf(45.0f * M_PI / 360.0f));
+        bakedMeshLevel = bakedMesh.selectLevel(pixelsPerUnit);
+        LOGI("Loaded the baked sphere, %u vertices, drawing level of detail %u of %u.\n",
+             bakedMesh.getHeader()->numberOfVertices, bakedMeshLevel, bakedMesh.getHeader()->numberOfLevels);
+        return true;
     }
-    /* [Load a model into the Open Asset Importer.] */
+    /* [Load the baked model.] */
 
-    /* [Accumulate the model vertices and indices.] */
-    int vertices_accumulation = 0;
-    /* Go through each mesh in the scene. */
-    for (int i = 0; i < scene->mNumMeshes; i++)
-    {
-        /* Add all the vertices in the mesh to our array. */
-        for (int j = 0; j < scene->mMeshes[i]->mNumVertices; j++)
-        {
-            const aiVector3D& vector = scene->mMeshes[i]->mVertices[j];
-            vertices.push_back(vector.x);
-            vertices.push_back(vector.y);
-            vertices.push_back(vector.z);
-        }
+    LOGI("No baked model, importing it with the Open Asset Importer instead.\n");
 
-        /*
-         * Add all the indices in the mesh to our array.
-         * Indices are listed in the Open Asset importer relative to the mesh they are in.
-         * Because we are adding all vertices from all meshes to one array we must add an offset
-         * to the indices to correct for this.
-         */
-        for (unsigned int j = 0 ; j < scene->mMeshes[i]->mNumFaces ; j++)
-        {
-            const aiFace& face = scene->mMeshes[i]->mFaces[j];
-            indices.push_back(face.mIndices[0] + vertices_accumulation);
-            indices.push_back(face.mIndices[1] + vertices_accumulation);
-            indices.push_back(face.mIndices[2] + vertices_accumulation);
-        }
+    /* The upload contexts share objects with this one, they have to be created while it is current. */
+    uploadPool.initialize(1);
 
-        /* Keep track of number of vertices loaded so far to use as an offset for the indices. */
-        vertices_accumulation += scene->mMeshes[i]->mNumVertices;
+    /* The first frames are drawn while the scene is imported, with the meshes which are ready so far. */
+    if (jobScheduler.getNumberOfWorkers() == 0)
+    {
+        jobScheduler.initialize(1);
+    }
+    importJob = jobScheduler.create("import_scene", importScene, NULL);
+    jobScheduler.submit(importJob);
+
+    if (jobScheduler.getNumberOfWorkers() == 0)
+    {
+        /* No thread to import on, the scene is ready before the first frame instead. */
+        jobScheduler.wait(importJob);
+        importJob = NULL;
     }
-    /* [Accumulate the model vertices and indices.] */
 
     return true;
 }
@@ -230,28 +592,93 @@ void renderFrame()
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
-    matrixIdentityFunction(modelViewMatrix);
+    MaliSDK::matrixIdentityFunction(modelViewMatrix);
 
-    matrixRotateX(modelViewMatrix, angle);
-    matrixRotateY(modelViewMatrix, angle);
+    MaliSDK::matrixRotateX(modelViewMatrix, angle);
+    MaliSDK::matrixRotateY(modelViewMatrix, angle);
 
-    matrixTranslate(modelViewMatrix, 0.0f, 0.0f, -10.0f);
+    MaliSDK::matrixTranslate(modelViewMatrix, 0.0f, 0.0f, -10.0f);
 
-    /* [Pass the the model vertices and indices to OpenGL ES.] */
     glUseProgram(glProgram);
-    /* Use the vertex data loaded from the Open Asset Importer. */
-    glVertexAttribPointer(vertexLocation, 3, GL_FLOAT, GL_FALSE, 0, &vertices[0]);
-    glEnableVertexAttribArray(vertexLocation);
-    /* We're using vertices as the colour data here for simplicity. */
-    glVertexAttribPointer(vertexColourLocation, 3, GL_FLOAT, GL_FALSE, 0, &vertices[0]);
-    glEnableVertexAttribArray(vertexColourLocation);
-
     glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, projectionMatrix);
     glUniformMatrix4fv(modelViewLocation, 1, GL_FALSE, modelViewMatrix);
 
-    /* Use the index data loaded from the Open Asset Importer. */
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, &indices[0]);
+    /* [Draw the baked model.] */
+    const MaliSDK::BakedMeshHeader *header = bakedMesh.getHeader();
+    if (header != NULL)
+    {
+        glUniform3fv(positionScaleLocation, 1, header->positionScale);
+        glUniform3fv(positionBiasLocation, 1, header->positionBias);
+
+        /* As with the imported model, the positions are the colours too. */
+        bakedMesh.enableAttributes(vertexLocation, -1, -1);
+        bakedMesh.enableAttributes(vertexColourLocation, -1, -1);
+        bakedMesh.draw(bakedMeshLevel);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+    /* [Draw the baked model.] */
+    else
+    {
+    /* [Upload the meshes as they are imported.] */
+    pthread_mutex_lock(&importMutex);
+    while (!importedMeshQueue.empty())
+    {
+        ImportedMesh *mesh = importedMeshQueue.front();
+        importedMeshQueue.pop_front();
+
+        mesh->upload = uploadPool.submit(uploadMesh, mesh);
+        importedMeshes.push_back(mesh);
+    }
+    pthread_mutex_unlock(&importMutex);
+    /* [Upload the meshes as they are imported.] */
+
+    /* [Pass the the model vertices and indices to OpenGL ES.] */
+    const GLfloat unitScale[] = { 1.0f, 1.0f, 1.0f };
+    const GLfloat noBias[] = { 0.0f, 0.0f, 0.0f };
+    glUniform3fv(positionScaleLocation, 1, unitScale);
+    glUniform3fv(positionBiasLocation, 1, noBias);
+
+    for (size_t i = 0; i < importedMeshes.size(); i++)
+    {
+        ImportedMesh *mesh = importedMeshes[i];
+
+        /* Meshes still uploading are drawn from a later frame, rather than holding this one up. */
+        if (mesh->upload != NULL)
+        {
+            if (!uploadPool.isComplete(mesh->upload))
+            {
+                continue;
+            }
+
+            uploadPool.wait(mesh->upload);
+            mesh->upload = NULL;
+
+            /* The buffers hold their own copy now. */
+            std::vector<GLfloat>().swap(mesh->vertices);
+            std::vector<GLushort>().swap(mesh->indices);
+        }
+
+        /* Use the vertex data loaded from the Open Asset Importer. */
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->buffers[0]);
+        glVertexAttribPointer(vertexLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(vertexLocation);
+        /* We're using vertices as the colour data here for simplicity. */
+        glVertexAttribPointer(vertexColourLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(vertexColourLocation);
+
+        /* Use the index data loaded from the Open Asset Importer. */
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->buffers[1]);
+        glDrawElements(GL_TRIANGLES, mesh->numberOfIndices, GL_UNSIGNED_SHORT, 0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     /* [Pass the the model vertices and indices to OpenGL ES.] */
+    }
+
+    renderCharacters();
 
     angle += 1;
     if (angle > 360)
@@ -262,12 +689,27 @@ void renderFrame()
 
 extern "C"
 {
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_assetloading_NativeLibrary_setAssetManager(
+            JNIEnv * env, jobject obj, jobject assetManager);
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_assetloading_NativeLibrary_init(
             JNIEnv * env, jobject obj, jint width, jint height);
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_assetloading_NativeLibrary_step(
             JNIEnv * env, jobject obj);
 };
 
+JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_assetloading_NativeLibrary_setAssetManager(
+        JNIEnv * env, jobject obj, jobject assetManager)
+{
+    /* The native asset manager is only valid while the Java one is, so keep a reference to it for good. */
+    static jobject assetManagerReference = NULL;
+
+    if (assetManagerReference == NULL)
+    {
+        assetManagerReference = env->NewGlobalRef(assetManager);
+        MaliSDK::AssetFile::setAssetManager(AAssetManager_fromJava(env, assetManagerReference), ASSET_DIRECTORY);
+    }
+}
+
 JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_assetloading_NativeLibrary_init(
         JNIEnv * env, jobject obj, jint width, jint height)
 {
@@ -33,6 +33,7 @@ public class AssetLoading extends Activity
     protected void onCreate(Bundle savedInstanceState)
     {
         super.onCreate(savedInstanceState);
+        NativeLibrary.setAssetManager(getAssets());
         Log.i(LOGTAG, "Creating New Tutorial View");
         graphicsView = new TutorialView(getApplication());
         setContentView(graphicsView);
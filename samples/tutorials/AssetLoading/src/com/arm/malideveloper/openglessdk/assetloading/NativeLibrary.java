@@ -20,12 +20,15 @@
 
 package com.arm.malideveloper.openglessdk.assetloading;
 
+import android.content.res.AssetManager;
+
 public class NativeLibrary
 {
     static
     {
         System.loadLibrary("Native");
     }
+    public static native void setAssetManager(AssetManager assetManager);
     public static native void init(int width, int height);
     public static native void step();
 }
@@ -51,8 +51,14 @@ class TutorialView extends GLSurfaceView
         public EGLContext createContext(EGL10 egl, EGLDisplay display, EGLConfig eglConfig)
         {
             final int EGL_CONTEXT_CLIENT_VERSION = 0x3098;
-            int[] attrib_list = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL10.EGL_NONE };
+            int[] attrib_list = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL10.EGL_NONE };
             EGLContext context = egl.eglCreateContext(display, eglConfig, EGL10.EGL_NO_CONTEXT, attrib_list);
+            if (context == EGL10.EGL_NO_CONTEXT)
+            {
+                /* The sample still runs on OpenGL ES 2.0, skinning on the CPU. */
+                attrib_list[1] = 2;
+                context = egl.eglCreateContext(display, eglConfig, EGL10.EGL_NO_CONTEXT, attrib_list);
+            }
             return context;
         }
 
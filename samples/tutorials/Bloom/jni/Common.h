@@ -1,4 +1,4 @@
-/* Copyright (c) 2014-2017, ARM Limited and Contributors
+/* Copyright (c) 2017, ARM Limited and Contributors
  *
  * SPDX-License-Identifier: MIT
  *
@@ -18,13 +18,18 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifndef SHADER_H
-#define SHADER_H
+#ifndef COMMON_H
+#define COMMON_H
 
-#include <GLES3/gl3.h>
+#include <android/log.h>
 #include <cstdio>
 #include <cstdlib>
-#include <android/log.h>
+#include <GLES3/gl31.h>
+
+#define LOG_TAG "libNative"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO,  LOG_TAG, __VA_ARGS__)
 
 #define ASSERT(x) \
     if (!(x))\
@@ -43,27 +48,4 @@
         } \
     }
 
-namespace MaliSDK
-{
-    /**
-     * \brief Functions for working with OpenGL ES shaders.
-     */
-    class Shader
-    {
-    public:
-        /**
-         * \brief Create shader, load in source, compile, and dump debug as necessary.
-         *
-         * Loads the OpenGL ES Shading Language code into memory.
-         * Creates a shader using with the required shaderType using glCreateShader(shaderType) and then compiles it using glCompileShader.
-         * The output from the compilation is checked for success and a log of the compilation errors is printed in the case of failure.
-         *
-         * \param[out] shaderPtr      The shader ID of the newly compiled shader. Cannot be NULL.
-         * \param[in] shaderSourcePtr Contains OpenGL ES SL source code. Cannot be NULL.
-         * \param[in] shaderType      Passed to glCreateShader to define the type of shader being processed.
-         *                            Must be GL_VERTEX_SHADER or GL_FRAGMENT_SHADER.
-         */
-        static void processShader(GLuint* shaderPtr, const char* shaderSourcePtr, GLint shaderType);
-    };
-}
-#endif /* SHADER_H */
+#endif /* COMMON_H */
@@ -21,14 +21,7 @@
 #ifndef CUBE_MODEL_H
 #define CUBE_MODEL_H
 
-#include <android/log.h>
-#include <cstdio>
-#include <cstdlib>
-
-#define LOG_TAG "libNative"
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO,  LOG_TAG, __VA_ARGS__)
+#include "Common.h"
 
 namespace MaliSDK
 {
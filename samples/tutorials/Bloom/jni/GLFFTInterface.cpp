@@ -0,0 +1,83 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <time.h>
+
+#include "glfft_api_headers.hpp"
+
+/** Directory the Java activity extracts the GLFFT shaders to. */
+#define GLFFT_SHADER_DIRECTORY "/data/data/com.arm.malideveloper.openglessdk.bloom/files/"
+
+/** \brief Read a GLFFT shader source extracted from the assets.
+ *
+ * \param path      Name of the shader file.
+ * \param outBuffer Deref is set to the NULL-terminated contents of the file, to be freed with free().
+ *
+ * \return True if the file was read.
+ */
+bool glfftReadFileString(const char* path, char** outBuffer)
+{
+    std::string fullPath = std::string(GLFFT_SHADER_DIRECTORY) + path;
+    FILE*       file     = fopen(fullPath.c_str(), "rb");
+
+    if (file == NULL)
+    {
+        LOGE("Failed to open file: %s.", fullPath.c_str());
+
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    rewind(file);
+
+    char* buffer = (char*) malloc(length + 1);
+
+    if (buffer == NULL || fread(buffer, 1, length, file) != (size_t) length)
+    {
+        free(buffer);
+        fclose(file);
+
+        return false;
+    }
+
+    fclose(file);
+
+    buffer[length] = '\0';
+    *outBuffer     = buffer;
+
+    return true;
+}
+
+/** \brief Time used by GLFFT for benchmarking FFT passes.
+ *
+ * \return Monotonic time, in seconds.
+ */
+double glfftGetTime()
+{
+    timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
@@ -45,6 +45,28 @@
  *            The colours of those two textures are mixed together with an appropriate factor value.
  *            (for more details please see the mix() function description in the OpenGL ES Shading Language documentation).
  *
+ *        Step 3 can alternatively be done with a dual filter (see bloomMode): the bloom source is progressively
+ *        downsampled into smaller and smaller textures, and then upsampled back. Each pass reads
+ *        a handful of bilinearly filtered taps, so the blur gets wider with each level at a fraction
+ *        of the cost of repeating full resolution passes. The effect strength is then changed by changing
+ *        the number of levels instead of the number of blur passes.
+ *
+ *        On OpenGL ES 3.1, the separable blur can also be done with compute shaders (see bloomMode).
+ *        Each work group loads a row (or a column) tile of the image, together with the texels the blur
+ *        reaches outside of it, into shared memory once, and then blurs the tile from there. The results
+ *        are written to the same textures with image stores, so no framebuffer has to be switched.
+ *
+ *        Also on OpenGL ES 3.1, the blur can be a convolution done with FFTs (see bloomMode and GLFFT::Convolution).
+ *        The bloom source is transformed once, multiplied with the cached spectrum of a kernel,
+ *        and transformed back, so the cost does not grow with the width of the kernel. This makes room
+ *        for kernels no blur pass could afford, here a gaussian with the glare streaks of a hexagonal aperture.
+ *
+ *        When the GPU can render to floating point textures (see isHDREnabled), the scene is rendered with high dynamic range,
+ *        and the bright cubes are brighter than white. A compute shader then builds a histogram of the logarithm of the scene
+ *        luminance every frame, and a second one averages it and slowly adapts the exposure towards it, like eyes do.
+ *        The exposure never leaves the GPU: the blending pass reads it from a texture, and applies it together with the
+ *        tonemapping, so no average luminance has to be read back, and no extra full screen pass is needed.
+ *
  *        Besides the bloom effect, the application also shows:
  *        - matrix calculations (e.g. used for perspective view),
  *        - instanced drawing (each cube drawn on a screen is an instance of the same object),
@@ -55,12 +77,24 @@
 
 #include <jni.h>
 #include <android/log.h>
+#include <math.h>
+#include <string.h>
 
-#include <GLES3/gl3.h>
+#include <exception>
+#include <string>
+#include <vector>
 
+#include <GLES3/gl31.h>
+
+#include "Common.h"
 #include "CubeModel.h"
+#include "FrameGraph.h"
+#include "Mathematics.h"
 #include "Matrix.h"
+#include "ProgramCompileQueue.h"
+#include "RenderPass.h"
 #include "Shader.h"
+#include "glfft_convolution.hpp"
 
 using namespace MaliSDK;
 
@@ -88,6 +122,11 @@ using namespace MaliSDK;
 /** Minimum number of blur passes. */
 #define MIN_NUMBER_OF_BLUR_PASSES  (2)
 
+/** Maximum number of dual filter levels, i.e. how many times the bloom source texture is downsampled. */
+#define MAX_NUMBER_OF_DUAL_FILTER_LEVELS (6)
+/** Minimum number of dual filter levels. */
+#define MIN_NUMBER_OF_DUAL_FILTER_LEVELS (2)
+
 /** Step which is used for changing mix factor values (used while mixing colour textures to get a continuous sampling effect). */
 #define BLUR_MIX_FACTOR_STEP_VALUE (0.05f)
 /** Indicates positive sign, used in blur calculations when the effect should be increased. */
@@ -111,6 +150,44 @@ using namespace MaliSDK;
 #define TEXTURE_UNIT_BLURRED_TEXTURE         (3)
 /** Texture unit which a texture with stronger blur effect will be bound to. */
 #define TEXTURE_UNIT_STRONGER_BLUR_TEXTURE   (4)
+/** Texture unit which the source texture of a dual filter pass will be bound to. */
+#define TEXTURE_UNIT_DUAL_FILTER_TEXTURE     (5)
+/** Texture unit which the result of an FFT convolution will be bound to. */
+#define TEXTURE_UNIT_CONVOLVED_TEXTURE       (6)
+/** Texture unit which the adapted scene luminance of the auto exposure will be bound to. */
+#define TEXTURE_UNIT_ADAPTED_LUMINANCE_TEXTURE (7)
+
+/** Bloom mode: the bloom source is blurred with repeated horizontal and vertical blur passes. */
+#define BLOOM_MODE_SEPARABLE_BLUR (0)
+/** Bloom mode: the bloom source is blurred by a chain of downsampling and upsampling passes. */
+#define BLOOM_MODE_DUAL_FILTER    (1)
+/** Bloom mode: the same blur as BLOOM_MODE_SEPARABLE_BLUR, done with compute shaders. Requires OpenGL ES 3.1. */
+#define BLOOM_MODE_COMPUTE_BLUR   (2)
+/** Bloom mode: the bloom source is convolved with a glare kernel with FFTs. Requires OpenGL ES 3.1. */
+#define BLOOM_MODE_FFT_CONVOLUTION (3)
+
+/** Number of texels blurred by one compute work group. Has to match local_size_x of the compute blur shader. */
+#define COMPUTE_BLUR_TILE_SIZE (128)
+
+/** Largest number of FFT samples along each side of the FFT convolution. */
+#define FFT_CONVOLUTION_MAX_SIZE (256)
+/** Standard deviation of the blur done by one horizontal and vertical blur pass, in texels.
+ *  The FFT convolution kernel for n iterations is a gaussian with sqrt(n) times this deviation. */
+#define BLUR_PASS_STANDARD_DEVIATION (5.6f)
+/** Number of glare streaks in the FFT convolution kernel, as diffracted by the 6 blades of a hexagonal aperture. */
+#define GLARE_NUMBER_OF_STREAKS (6)
+/** Part of the light which goes to the glare streaks, the rest goes to the gaussian. */
+#define GLARE_STRENGTH (0.35f)
+
+/** Brightness of the bloomed cubes when the scene is rendered with high dynamic range. White is 1. */
+#define HDR_LIGHT_CUBE_INTENSITY (4.0f)
+/** Number of pixels along each side of the work groups building the luminance histogram. Has to match the histogram shader. */
+#define AUTO_EXPOSURE_TILE_SIZE (16)
+/** Range of scene luminance covered by the histogram, as log2 of the luminance. Darker pixels are not measured. */
+#define AUTO_EXPOSURE_MIN_LOG_LUMINANCE   (-8.0f)
+#define AUTO_EXPOSURE_LOG_LUMINANCE_RANGE (12.0f)
+/** How quickly the exposure adapts to a change of the scene luminance, in 1 / seconds. */
+#define AUTO_EXPOSURE_ADAPTATION_RATE (1.5f)
 
 /** Camera depth location for horizontal position
  * (should be used when the window width is greater than window height).
@@ -142,6 +219,7 @@ struct BlendingProgramLocations
 };
 
 /** \brief Structure holding ID of objects which were generated for blurring.
+ *         The horizontal blur texture is a transient target of the frame graph, see buildBlurFrameGraph().
  */
 struct BlurringObjects
 {
@@ -158,6 +236,127 @@ struct BlurringObjects
     }
 };
 
+/** \brief Structure holding IDs of objects which were generated for the dual filter blur.
+ *         Index i of the arrays holds the texture of level (i + 1), which is 2^(i + 1) times smaller than the bloom source texture.
+ *         The textures are transient targets of the frame graph, see buildBlurFrameGraph().
+ */
+struct DualFilterObjects
+{
+    GLuint framebufferObjectId;
+    GLuint textureObjectIdsDownsampled[MAX_NUMBER_OF_DUAL_FILTER_LEVELS];
+    GLuint textureObjectIdsUpsampled[MAX_NUMBER_OF_DUAL_FILTER_LEVELS - 1];
+
+    /* Default values constructor. */
+    DualFilterObjects()
+    {
+        framebufferObjectId = 0;
+
+        memset(textureObjectIdsDownsampled, 0, sizeof(textureObjectIdsDownsampled) );
+        memset(textureObjectIdsUpsampled,   0, sizeof(textureObjectIdsUpsampled) );
+    }
+};
+
+/** \brief Structure holding locations of uniforms
+ *         used by the compute program responsible for blurring.
+ */
+struct ComputeBlurProgramLocations
+{
+    GLint uniformDirection;
+    GLint uniformRegionOffset;
+    GLint uniformRegionSize;
+    GLint uniformTextureSampler;
+
+    /* Default values constructor. */
+    ComputeBlurProgramLocations()
+    {
+        uniformDirection      = -1;
+        uniformRegionOffset   = -1;
+        uniformRegionSize     = -1;
+        uniformTextureSampler = -1;
+    }
+};
+
+/** \brief Structure holding objects used by the FFT convolution.
+ *         Kernel k is the one for (k + MIN_NUMBER_OF_BLUR_PASSES - 1) blur iterations.
+ */
+struct FFTConvolutionObjects
+{
+    GLFFT::Convolution* convolution;
+    /* Results of the convolution for the weaker and the stronger blur. */
+    GLuint              textureObjectIdsConvolved[2];
+
+    /* Default values constructor. */
+    FFTConvolutionObjects()
+    {
+        convolution = NULL;
+
+        memset(textureObjectIdsConvolved, 0, sizeof(textureObjectIdsConvolved) );
+    }
+};
+
+/** \brief Structure holding locations of uniforms
+ *         used by the program object copying the results of the FFT convolution to the blurred region.
+ */
+struct FFTResolveProgramLocations
+{
+    GLint uniformConvolvedTexture;
+    GLint uniformRegionOffset;
+    GLint uniformRegionSize;
+
+    /* Default values constructor. */
+    FFTResolveProgramLocations()
+    {
+        uniformConvolvedTexture = -1;
+        uniformRegionOffset     = -1;
+        uniformRegionSize       = -1;
+    }
+};
+
+/** \brief Structure holding IDs of objects which were generated for the auto exposure.
+ */
+struct AutoExposureObjects
+{
+    /* Luminance histogram of the current frame, cleared again once it has been averaged. */
+    GLuint bufferObjectIdHistogram;
+    /* 1x1 texture storing the average scene luminance the exposure is adapted to. */
+    GLuint textureObjectIdAdaptedLuminance;
+
+    /* Default values constructor. */
+    AutoExposureObjects()
+    {
+        bufferObjectIdHistogram         = 0;
+        textureObjectIdAdaptedLuminance = 0;
+    }
+};
+
+/** \brief Structure holding locations of uniforms
+ *         used by the compute programs responsible for the auto exposure.
+ */
+struct AutoExposureProgramLocations
+{
+    /* Luminance histogram program. */
+    GLint uniformSceneTexture;
+    GLint uniformHistogramMinLogLuminance;
+    GLint uniformInverseLogLuminanceRange;
+    /* Exposure adaptation program. */
+    GLint uniformNumberOfPixels;
+    GLint uniformAdaptationMinLogLuminance;
+    GLint uniformLogLuminanceRange;
+    GLint uniformAdaptationFactor;
+
+    /* Default values constructor. */
+    AutoExposureProgramLocations()
+    {
+        uniformSceneTexture              = -1;
+        uniformHistogramMinLogLuminance  = -1;
+        uniformInverseLogLuminanceRange  = -1;
+        uniformNumberOfPixels            = -1;
+        uniformAdaptationMinLogLuminance = -1;
+        uniformLogLuminanceRange         = -1;
+        uniformAdaptationFactor          = -1;
+    }
+};
+
 /** \brief Structure holding locations of uniforms
  *         used by a program object responsible for blurring.
  */
@@ -210,6 +409,7 @@ struct ProgramAndShadersIds
 
 /** \brief Structure holding ID of objects which were generated
  *         to support scene rendering.
+ *         The depth texture is a transient target of the frame graph, only there while the scene is rendered.
  */
 struct SceneRenderingObjects
 {
@@ -251,6 +451,7 @@ struct SceneRenderingProgramLocations
     GLint uniformLightPropertiesPosition;
     GLint uniformLightPropertiesShininess;
     GLint uniformLightPropertiesStrength;
+    GLint uniformLightCubeIntensity;
     GLint uniformMvMatrix;
     GLint uniformMvpMatrix;
 
@@ -269,6 +470,7 @@ struct SceneRenderingProgramLocations
         uniformLightPropertiesPosition              = -1;
         uniformLightPropertiesShininess             = -1;
         uniformLightPropertiesStrength              = -1;
+        uniformLightCubeIntensity                   = -1;
         uniformMvMatrix                             = -1;
         uniformMvpMatrix                            = -1;
     }
@@ -294,6 +496,7 @@ struct StrongerBlurObjects
 /* [Blend fragment shader source] */
 static const char blendFragmentShaderSource[] =         "#version 300 es\n"
                                                         "precision mediump float;\n"
+                                                        "precision mediump sampler2D;\n"
                                                         "/* UNIFORMS */\n"
                                                         "/** Factor which will be used for mixing higher and lower blur effect texture colours. */\n"
                                                         "uniform float     mix_factor;\n"
@@ -319,9 +522,49 @@ static const char blendFragmentShaderSource[] =         "#version 300 es\n"
                                                         "    color = original_color + mixed_blur_color;\n"
                                                         "}\n";
 /* [Blend fragment shader source] */
+/* [HDR blend fragment shader source] */
+static const char hdrBlendFragmentShaderSource[] =      "#version 300 es\n"
+                                                        "precision highp float;\n"
+                                                        "precision mediump sampler2D;\n"
+                                                        "/** Middle grey the average scene luminance is exposed to. */\n"
+                                                        "#define EXPOSURE_KEY (0.5)\n"
+                                                        "/* UNIFORMS */\n"
+                                                        "/** Factor which will be used for mixing higher and lower blur effect texture colours. */\n"
+                                                        "uniform float     mix_factor;\n"
+                                                        "/** Texture storing high dynamic range colour data (with all the cubes). */\n"
+                                                        "uniform sampler2D original_texture;\n"
+                                                        "/** Texture in which (n+1) blur operations have been applied to the input texture. */\n"
+                                                        "uniform sampler2D stronger_blur_texture;\n"
+                                                        "/** Texture in which (n)   blur operations have been applied to the input texture. */\n"
+                                                        "uniform sampler2D weaker_blur_texture;\n"
+                                                        "/** 1x1 texture storing the scene luminance the exposure is adapted to. */\n"
+                                                        "uniform highp sampler2D adapted_luminance_texture;\n"
+                                                        "/* INPUTS */\n"
+                                                        "/** Texture coordinates. */\n"
+                                                        "in vec2 texture_coordinates;\n"
+                                                        "/* OUTPUTS */\n"
+                                                        "/** Fragment colour to be returned. */\n"
+                                                        "out vec4 color;\n"
+                                                        "/** Filmic curve fitted to the ACES reference tonemapper. */\n"
+                                                        "vec3 tonemap(vec3 x)\n"
+                                                        "{\n"
+                                                        "    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);\n"
+                                                        "}\n"
+                                                        "void main()\n"
+                                                        "{\n"
+                                                        "    vec4  stronger_blur_texture_color = texture(stronger_blur_texture, texture_coordinates);\n"
+                                                        "    vec4  weaker_blur_texture_color   = texture(weaker_blur_texture,   texture_coordinates);\n"
+                                                        "    vec4  mixed_blur_color            = mix(weaker_blur_texture_color, stronger_blur_texture_color, mix_factor);\n"
+                                                        "    vec4  original_color              = texture(original_texture, texture_coordinates);\n"
+                                                        "    float exposure                    = EXPOSURE_KEY / texelFetch(adapted_luminance_texture, ivec2(0), 0).x;\n"
+                                                        "    /* Return the exposed and tonemapped blend, in a single pass. */\n"
+                                                        "    color = vec4(tonemap((original_color.xyz + mixed_blur_color.xyz) * exposure), 1.0);\n"
+                                                        "}\n";
+/* [HDR blend fragment shader source] */
 /* [Blur fragment shader source for horizontal blurring] */
 static const char blurHorizontalFragmentShaderSource[] = "#version 300 es\n"
                                                          "precision mediump float;\n"
+                                                         "precision mediump sampler2D;\n"
                                                          "/** Defines gaussian weights. */\n"
                                                          "const float gaussian_weights[] = float[] (0.2270270270,\n"
                                                          "                                          0.3162162162,\n"
@@ -358,6 +601,7 @@ static const char blurHorizontalFragmentShaderSource[] = "#version 300 es\n"
 /* [Blur fragment shader source for vertical blurring] */
 static const char blurVerticalFragmentShaderSource[] =  "#version 300 es\n"
                                                         "precision mediump float;\n"
+                                                        "precision mediump sampler2D;\n"
                                                         "/** Defines gaussian weights. */\n"
                                                         "const float gaussian_weights[] = float[] (0.2270270270,\n"
                                                         "                                          0.3162162162,\n"
@@ -391,9 +635,244 @@ static const char blurVerticalFragmentShaderSource[] =  "#version 300 es\n"
                                                         "    output_color = vec4(total_color.xyz, 1.0);\n"
                                                         "}";
 /* [Blur fragment shader source for vertical blurring] */
+/* [Compute blur shader source] */
+static const char computeBlurShaderSource[] = "#version 310 es\n"
+                                              "precision mediump float;\n"
+                                              "precision mediump image2D;\n"
+                                              "precision mediump sampler2D;\n"
+                                              "/** Number of texels blurred by one work group. */\n"
+                                              "#define TILE_SIZE 128\n"
+                                              "/** Distance between blur taps, in texels. Matches BLUR_RADIUS. */\n"
+                                              "#define TAP_DISTANCE 3\n"
+                                              "/** Number of texels on each side of the tile needed for blurring it (3 taps). */\n"
+                                              "#define APRON (3 * TAP_DISTANCE)\n"
+                                              "layout(local_size_x = TILE_SIZE) in;\n"
+                                              "/** Defines gaussian weights. */\n"
+                                              "const float gaussian_weights[] = float[] (0.2270270270,\n"
+                                              "                                          0.3162162162,\n"
+                                              "                                          0.0702702703);\n"
+                                              "/* UNIFORMS */\n"
+                                              "/** Blur direction: (1, 0) for horizontal and (0, 1) for vertical blurring. */\n"
+                                              "uniform ivec2 direction;\n"
+                                              "/** Bottom-left corner and size of the region of the image to blur. */\n"
+                                              "uniform ivec2 region_offset;\n"
+                                              "uniform ivec2 region_size;\n"
+                                              "/** Texture sampler on which the effect will be applied. */\n"
+                                              "uniform sampler2D texture_sampler;\n"
+                                              "/* OUTPUTS */\n"
+                                              "/** Image the blurred colours are stored in. */\n"
+                                              "layout(rgba8, binding = 0) writeonly uniform image2D output_image;\n"
+                                              "/** Texels of the tile and its apron, shared by the whole work group. */\n"
+                                              "shared vec3 tile[TILE_SIZE + 2 * APRON];\n"
+                                              "void main()\n"
+                                              "{\n"
+                                              "    ivec2 image_size  = textureSize(texture_sampler, 0);\n"
+                                              "    int   tile_start  = int(gl_WorkGroupID.x) * TILE_SIZE;\n"
+                                              "    int   local_index = int(gl_LocalInvocationID.x);\n"
+                                              "    /* Work groups blur tiles along the blur direction, one line (row or column) per gl_WorkGroupID.y. */\n"
+                                              "    ivec2 tile_origin = region_offset + direction * (tile_start - APRON) + direction.yx * int(gl_WorkGroupID.y);\n"
+                                              "    /* Load the tile and its apron, each texel is fetched only once. */\n"
+                                              "    for (int i = local_index; i < TILE_SIZE + 2 * APRON; i += TILE_SIZE)\n"
+                                              "    {\n"
+                                              "        tile[i] = texelFetch(texture_sampler, clamp(tile_origin + direction * i, ivec2(0), image_size - 1), 0).xyz;\n"
+                                              "    }\n"
+                                              "    barrier();\n"
+                                              "    /* Calculate blurred colour, with the same taps as the fragment shaders. */\n"
+                                              "    int  center      = local_index + APRON;\n"
+                                              "    vec3 total_color = (tile[center + 1 * TAP_DISTANCE] + tile[center - 1 * TAP_DISTANCE]) * gaussian_weights[0] +\n"
+                                              "                       (tile[center + 2 * TAP_DISTANCE] + tile[center - 2 * TAP_DISTANCE]) * gaussian_weights[1] +\n"
+                                              "                       (tile[center + 3 * TAP_DISTANCE] + tile[center - 3 * TAP_DISTANCE]) * gaussian_weights[2];\n"
+                                              "    /* The last tile of a line can reach past the region. */\n"
+                                              "    if (tile_start + local_index < (direction.x == 1 ? region_size.x : region_size.y))\n"
+                                              "    {\n"
+                                              "        imageStore(output_image, tile_origin + direction * center, vec4(total_color, 1.0));\n"
+                                              "    }\n"
+                                              "}";
+/* [Compute blur shader source] */
+/* [Luminance histogram shader source] */
+static const char luminanceHistogramShaderSource[] = "#version 310 es\n"
+                                                     "precision highp float;\n"
+                                                     "precision highp int;\n"
+                                                     "/** Number of histogram bins. Bin 0 counts the pixels too dark to be measured. */\n"
+                                                     "#define NUMBER_OF_BINS 256\n"
+                                                     "/** Matches AUTO_EXPOSURE_TILE_SIZE, so there is one invocation per bin. */\n"
+                                                     "layout(local_size_x = 16, local_size_y = 16) in;\n"
+                                                     "/* UNIFORMS */\n"
+                                                     "/** High dynamic range scene colour. */\n"
+                                                     "uniform highp sampler2D scene_texture;\n"
+                                                     "/** log2 of the luminance of bin 1, and the inverse of the range of log2 of the luminance of the histogram. */\n"
+                                                     "uniform float min_log_luminance;\n"
+                                                     "uniform float inverse_log_luminance_range;\n"
+                                                     "/* OUTPUTS */\n"
+                                                     "/** Histogram of the whole frame. */\n"
+                                                     "layout(std430, binding = 0) buffer histogram_buffer\n"
+                                                     "{\n"
+                                                     "    uint histogram[NUMBER_OF_BINS];\n"
+                                                     "};\n"
+                                                     "/** Histogram of the work group, so the global one only gets one atomic per bin and work group. */\n"
+                                                     "shared uint local_histogram[NUMBER_OF_BINS];\n"
+                                                     "void main()\n"
+                                                     "{\n"
+                                                     "    local_histogram[gl_LocalInvocationIndex] = 0u;\n"
+                                                     "    barrier();\n"
+                                                     "    /* Each invocation measures the middle of a 2x2 texel block, where one bilinear tap averages all four. */\n"
+                                                     "    ivec2 texture_size = textureSize(scene_texture, 0);\n"
+                                                     "    ivec2 block        = ivec2(gl_GlobalInvocationID.xy);\n"
+                                                     "    if (all(lessThan(block, texture_size / 2)))\n"
+                                                     "    {\n"
+                                                     "        vec3  color     = textureLod(scene_texture, vec2(2 * block + 1) / vec2(texture_size), 0.0).xyz;\n"
+                                                     "        float luminance = dot(color, vec3(0.2125, 0.7154, 0.0721));\n"
+                                                     "        uint  bin       = 0u;\n"
+                                                     "        if (luminance > exp2(min_log_luminance))\n"
+                                                     "        {\n"
+                                                     "            float position = clamp((log2(luminance) - min_log_luminance) * inverse_log_luminance_range, 0.0, 1.0);\n"
+                                                     "            bin = uint(position * float(NUMBER_OF_BINS - 2) + 1.0);\n"
+                                                     "        }\n"
+                                                     "        atomicAdd(local_histogram[bin], 1u);\n"
+                                                     "    }\n"
+                                                     "    barrier();\n"
+                                                     "    uint count = local_histogram[gl_LocalInvocationIndex];\n"
+                                                     "    if (count != 0u)\n"
+                                                     "    {\n"
+                                                     "        atomicAdd(histogram[gl_LocalInvocationIndex], count);\n"
+                                                     "    }\n"
+                                                     "}";
+/* [Luminance histogram shader source] */
+/* [Exposure adaptation shader source] */
+static const char adaptExposureShaderSource[] = "#version 310 es\n"
+                                                "precision highp float;\n"
+                                                "precision highp int;\n"
+                                                "precision highp image2D;\n"
+                                                "/** Number of histogram bins, one invocation per bin. */\n"
+                                                "#define NUMBER_OF_BINS 256\n"
+                                                "layout(local_size_x = NUMBER_OF_BINS) in;\n"
+                                                "/* UNIFORMS */\n"
+                                                "/** Number of pixels counted in the histogram. */\n"
+                                                "uniform uint  number_of_pixels;\n"
+                                                "/** Same range of log2 of the luminance as the histogram shader. */\n"
+                                                "uniform float min_log_luminance;\n"
+                                                "uniform float log_luminance_range;\n"
+                                                "/** Part of the way to the measured luminance which is adapted to during this frame. */\n"
+                                                "uniform float adaptation_factor;\n"
+                                                "/* INPUTS */\n"
+                                                "/** Histogram of the frame, cleared once it has been read. */\n"
+                                                "layout(std430, binding = 0) buffer histogram_buffer\n"
+                                                "{\n"
+                                                "    uint histogram[NUMBER_OF_BINS];\n"
+                                                "};\n"
+                                                "/* OUTPUTS */\n"
+                                                "/** Luminance adapted to so far, updated in place. */\n"
+                                                "layout(r32f, binding = 0) uniform image2D adapted_luminance_image;\n"
+                                                "/** Sum of the bins of all the measured pixels. */\n"
+                                                "shared uint bin_sum;\n"
+                                                "void main()\n"
+                                                "{\n"
+                                                "    uint bin   = gl_LocalInvocationIndex;\n"
+                                                "    uint count = histogram[bin];\n"
+                                                "    /* Ready for the histogram of the next frame. */\n"
+                                                "    histogram[bin] = 0u;\n"
+                                                "    if (bin == 0u)\n"
+                                                "    {\n"
+                                                "        bin_sum = 0u;\n"
+                                                "    }\n"
+                                                "    barrier();\n"
+                                                "    atomicAdd(bin_sum, count * bin);\n"
+                                                "    barrier();\n"
+                                                "    /* The pixels of bin 0, like the black background, do not take part in the average. */\n"
+                                                "    if (bin == 0u && count < number_of_pixels)\n"
+                                                "    {\n"
+                                                "        float average_bin      = float(bin_sum) / float(number_of_pixels - count);\n"
+                                                "        float average_log      = (average_bin - 1.0) / float(NUMBER_OF_BINS - 2) * log_luminance_range + min_log_luminance;\n"
+                                                "        float adapted_luminance = imageLoad(adapted_luminance_image, ivec2(0)).x;\n"
+                                                "        /* The average of log2 is the log2 of the geometric mean, which a few very bright pixels cannot dominate. */\n"
+                                                "        adapted_luminance += (exp2(average_log) - adapted_luminance) * adaptation_factor;\n"
+                                                "        imageStore(adapted_luminance_image, ivec2(0), vec4(adapted_luminance));\n"
+                                                "    }\n"
+                                                "}";
+/* [Exposure adaptation shader source] */
+/* [FFT resolve fragment shader source] */
+static const char fftResolveFragmentShaderSource[] = "#version 300 es\n"
+                                                     "precision mediump float;\n"
+                                                     "precision mediump sampler2D;\n"
+                                                     "/* UNIFORMS */\n"
+                                                     "/** Result of the FFT convolution. The blurred region is its middle half, the rest is padding. */\n"
+                                                     "uniform sampler2D convolved_texture;\n"
+                                                     "/** Bottom-left corner and size of the blurred region, in texels. */\n"
+                                                     "uniform vec2      region_offset;\n"
+                                                     "uniform vec2      region_size;\n"
+                                                     "/* OUTPUTS */\n"
+                                                     "/** Fragment colour that will be returned. */\n"
+                                                     "out vec4 output_color;\n"
+                                                     "void main()\n"
+                                                     "{\n"
+                                                     "    vec2 convolved_uv = 0.25 + 0.5 * (gl_FragCoord.xy - region_offset) / region_size;\n"
+                                                     "    /* Set the output colour. */\n"
+                                                     "    output_color = vec4(texture(convolved_texture, convolved_uv).xyz, 1.0);\n"
+                                                     "}";
+/* [FFT resolve fragment shader source] */
+/* [Dual filter downsample fragment shader source] */
+static const char dualFilterDownsampleFragmentShaderSource[] = "#version 300 es\n"
+                                                               "precision mediump float;\n"
+                                                               "precision mediump sampler2D;\n"
+                                                               "/* UNIFORMS */\n"
+                                                               "/** Texture sampler which will be downsampled. It is twice as big as the render target. */\n"
+                                                               "uniform sampler2D texture_sampler;\n"
+                                                               "/* INPUTS */\n"
+                                                               "/** Texture coordinates. */\n"
+                                                               "in vec2 texture_coordinates;\n"
+                                                               "/* OUTPUTS */\n"
+                                                               "/** Fragment colour that will be returned. */\n"
+                                                               "out vec4 output_color;\n"
+                                                               "void main()\n"
+                                                               "{\n"
+                                                               "    /* Half of a render target texel. Each bilinear tap placed there averages 4 source texels. */\n"
+                                                               "    vec2 half_texel  = 1.0 / vec2(textureSize(texture_sampler, 0));\n"
+                                                               "    vec4 total_color = texture(texture_sampler, texture_coordinates) * 4.0;\n"
+                                                               "    /* Add the 4 diagonal taps, covering 4x4 source texels in total. */\n"
+                                                               "    total_color += texture(texture_sampler, texture_coordinates - half_texel);\n"
+                                                               "    total_color += texture(texture_sampler, texture_coordinates + half_texel);\n"
+                                                               "    total_color += texture(texture_sampler, texture_coordinates + vec2(half_texel.x, -half_texel.y));\n"
+                                                               "    total_color += texture(texture_sampler, texture_coordinates - vec2(half_texel.x, -half_texel.y));\n"
+                                                               "    /* Set the output colour. */\n"
+                                                               "    output_color = vec4(total_color.xyz / 8.0, 1.0);\n"
+                                                               "}";
+/* [Dual filter downsample fragment shader source] */
+/* [Dual filter upsample fragment shader source] */
+static const char dualFilterUpsampleFragmentShaderSource[] = "#version 300 es\n"
+                                                             "precision mediump float;\n"
+                                                             "precision mediump sampler2D;\n"
+                                                             "/* UNIFORMS */\n"
+                                                             "/** Texture sampler which will be upsampled. It is half as big as the render target. */\n"
+                                                             "uniform sampler2D texture_sampler;\n"
+                                                             "/* INPUTS */\n"
+                                                             "/** Texture coordinates. */\n"
+                                                             "in vec2 texture_coordinates;\n"
+                                                             "/* OUTPUTS */\n"
+                                                             "/** Fragment colour that will be returned. */\n"
+                                                             "out vec4 output_color;\n"
+                                                             "void main()\n"
+                                                             "{\n"
+                                                             "    /* One source texel. */\n"
+                                                             "    vec2 texel       = 1.0 / vec2(textureSize(texture_sampler, 0));\n"
+                                                             "    vec4 total_color = vec4(0.0);\n"
+                                                             "    /* Add the 4 taps placed one texel away along the axes. */\n"
+                                                             "    total_color += texture(texture_sampler, texture_coordinates + vec2(-texel.x, 0.0));\n"
+                                                             "    total_color += texture(texture_sampler, texture_coordinates + vec2( texel.x, 0.0));\n"
+                                                             "    total_color += texture(texture_sampler, texture_coordinates + vec2(0.0, -texel.y));\n"
+                                                             "    total_color += texture(texture_sampler, texture_coordinates + vec2(0.0,  texel.y));\n"
+                                                             "    /* Add the 4 diagonal taps placed half a texel away, with twice the weight. */\n"
+                                                             "    total_color += texture(texture_sampler, texture_coordinates + vec2(-texel.x, -texel.y) * 0.5) * 2.0;\n"
+                                                             "    total_color += texture(texture_sampler, texture_coordinates + vec2( texel.x, -texel.y) * 0.5) * 2.0;\n"
+                                                             "    total_color += texture(texture_sampler, texture_coordinates + vec2(-texel.x,  texel.y) * 0.5) * 2.0;\n"
+                                                             "    total_color += texture(texture_sampler, texture_coordinates + vec2( texel.x,  texel.y) * 0.5) * 2.0;\n"
+                                                             "    /* Set the output colour. */\n"
+                                                             "    output_color = vec4(total_color.xyz / 12.0, 1.0);\n"
+                                                             "}";
+/* [Dual filter upsample fragment shader source] */
 /* [Get luminance image fragment shader source] */
 static const char getLuminanceImageFragmentShaderSource[] = "#version 300 es\n"
                                                             "precision highp float;\n"
+                                                            "precision highp sampler2D;\n"
                                                             "/* UNIFORMS */\n"
                                                             "uniform sampler2D texture_sampler;\n"
                                                             "/* INPUTS */\n"
@@ -419,7 +898,7 @@ static const char getLuminanceImageFragmentShaderSource[] = "#version 300 es\n"
 /* [Get luminance image fragment shader source] */
 /* [Render scene fragment shader source] */
 static const char renderSceneFragmentShaderSource[] =   "#version 300 es\n"
-                                                        "precision lowp float;\n"
+                                                        "precision mediump float;\n"
                                                         "/** Defines epsilon used for float values comparison. */\n"
                                                         "#define EPSILON (0.00001)\n"
                                                         "/** Structure holding light properties. */\n"
@@ -439,6 +918,8 @@ static const char renderSceneFragmentShaderSource[] =   "#version 300 es\n"
                                                         "uniform vec3              camera_position;\n"
                                                         "/** Directional light properties. */\n"
                                                         "uniform _light_properties light_properties;\n"
+                                                        "/** Brightness of the cubes placed on diagonals. Above 1 when rendering with high dynamic range. */\n"
+                                                        "uniform float             light_cube_intensity;\n"
                                                         "/* INPUTS */\n"
                                                         "/** Vertex normal. */\n"
                                                         "     in vec3 normal;\n"
@@ -452,7 +933,7 @@ static const char renderSceneFragmentShaderSource[] =   "#version 300 es\n"
                                                         "void main()\n"
                                                         "{\n"
                                                         "    vec4  dark_cube_colour   = vec4(0.2, 0.4, 0.8, 1.0);\n"
-		                                                "    vec4  light_cube_colour  = vec4(1.0);\n"
+		                                                "    vec4  light_cube_colour  = vec4(vec3(light_cube_intensity), 1.0);\n"
                                                         "    vec3  normalized_normals = normalize(normal);\n"
                                                         "    vec3  light_direction    = normalize(vec3(light_properties.position - vertex.xyz));\n"
                                                         "    float attenuation        = 1.0 / (light_properties.constant_attenuation + (light_properties.linear_attenuation + light_properties.quadratic_attenauation));\n"
@@ -577,6 +1058,25 @@ int         windowWidth                 = 0;
 /* Number of blur loop iterations. */
 int lastNumberOfIterations = 0;
 
+/* Way of blurring the bloom source: BLOOM_MODE_SEPARABLE_BLUR, BLOOM_MODE_DUAL_FILTER, BLOOM_MODE_COMPUTE_BLUR
+ * or BLOOM_MODE_FFT_CONVOLUTION. They all give a similar effect, so they can be switched to compare their cost.
+ * The FFT convolution adds glare streaks, its cost stays the same however wide the kernel is. */
+int bloomMode = BLOOM_MODE_SEPARABLE_BLUR;
+
+/* True: the scene is rendered with high dynamic range, exposed automatically and tonemapped.
+ * Falls back to false if compute shaders or floating point render targets are not supported. */
+bool isHDREnabled = true;
+
+/* Internal formats of the scene colour texture and of all the bloom textures. They depend on isHDREnabled. */
+GLenum sceneTextureFormat = GL_RGBA8;
+GLenum bloomTextureFormat = GL_RGBA8;
+
+/* Time of the previous frame, the exposure adapts by the time in between. */
+float lastFrameTime = 0.0f;
+
+/* Region of the downscaled textures that is blurred (x, y, width, height). It matches the scissor box. */
+GLint blurRegion[4] = {0, 0, 0, 0};
+
 /* Variables used for rendering a geometry. */
 GLfloat* cubeCoordinates    = NULL;
 GLfloat* cubeLocations      = NULL;
@@ -586,22 +1086,74 @@ int      nOfCubeLocations   = 0;
 int      nOfCubeNormals     = 0;
 
 /* Variables used for program object configurations. */
+GLint                          adaptedLuminanceTextureLocation = -1;
+GLuint                         adaptExposureProgramObjectId = 0;
+GLuint                         adaptExposureShaderObjectId  = 0;
+AutoExposureProgramLocations   autoExposureProgramLocations;
 BlendingProgramLocations       blendingProgramLocations;
 ProgramAndShadersIds           blendingProgramShaderObjects;
 BlurringProgramLocations       blurringHorizontalProgramLocations;
 ProgramAndShadersIds           blurringHorizontalProgramShaderObjects;
 BlurringProgramLocations       blurringVerticalProgramLocations;
 ProgramAndShadersIds           blurringVerticalProgramShaderObjects;
+ComputeBlurProgramLocations    computeBlurProgramLocations;
+GLuint                         computeBlurProgramObjectId = 0;
+GLuint                         computeBlurShaderObjectId  = 0;
+GLint                          dualFilterDownsampleTextureSamplerLocation = -1;
+ProgramAndShadersIds           dualFilterDownsampleProgramShaderObjects;
+GLint                          dualFilterUpsampleTextureSamplerLocation   = -1;
+ProgramAndShadersIds           dualFilterUpsampleProgramShaderObjects;
+FFTResolveProgramLocations     fftResolveProgramLocations;
+ProgramAndShadersIds           fftResolveProgramShaderObjects;
 ProgramAndShadersIds           getLuminanceImageProgramShaderObjects;
+GLuint                         luminanceHistogramProgramObjectId = 0;
+GLuint                         luminanceHistogramShaderObjectId  = 0;
 SceneRenderingProgramLocations sceneRenderingProgramLocations;
 ProgramAndShadersIds           sceneRenderingProgramShaderObjects;
 
+/* All program objects are built in the background while loading frames are shown. */
+ProgramCompileQueue programCompileQueue;
+bool                areProgramsReady = false;
+
+/* Allocates the render targets only needed within the blur passes, or while the scene is rendered,
+ * sharing textures between the ones which are never needed at the same time. */
+FrameGraph* frameGraph = NULL;
+
 /* Variables used to store generated objects IDs. */
+AutoExposureObjects           autoExposureObjects;
 BlurringObjects               blurringObjects;
+DualFilterObjects             dualFilterObjects;
+FFTConvolutionObjects         fftConvolutionObjects;
 GetLuminanceImageBloomObjects getLuminanceImageBloomObjects;
 SceneRenderingObjects         sceneRenderingObjects;
 StrongerBlurObjects           strongerBlurObjects;
 
+/** \brief Delete objects which were generated for the auto exposure, and its compute programs.
+ *
+ * \param objectIdsStoragePtr Objects described by the structure will be deleted by the function.
+ *                            Cannot be NULL.
+ */
+static void deleteAutoExposureObjects(AutoExposureObjects* objectIdsStoragePtr)
+{
+    ASSERT(objectIdsStoragePtr != NULL);
+
+    GL_CHECK(glDeleteBuffers (1, &objectIdsStoragePtr->bufferObjectIdHistogram) );
+    GL_CHECK(glDeleteTextures(1, &objectIdsStoragePtr->textureObjectIdAdaptedLuminance) );
+
+    objectIdsStoragePtr->bufferObjectIdHistogram         = 0;
+    objectIdsStoragePtr->textureObjectIdAdaptedLuminance = 0;
+
+    GL_CHECK(glDeleteShader (luminanceHistogramShaderObjectId) );
+    GL_CHECK(glDeleteProgram(luminanceHistogramProgramObjectId) );
+    GL_CHECK(glDeleteShader (adaptExposureShaderObjectId) );
+    GL_CHECK(glDeleteProgram(adaptExposureProgramObjectId) );
+
+    luminanceHistogramShaderObjectId  = 0;
+    luminanceHistogramProgramObjectId = 0;
+    adaptExposureShaderObjectId       = 0;
+    adaptExposureProgramObjectId      = 0;
+}
+
 /** \brief Delete objects which were generated for blurring purposes.
  *         According to the OpenGL ES specification, objects will not be deleted if bound.
  *         It is the user's responsibility to call glBindBuffer(), glBindFramebuffer()
@@ -614,7 +1166,6 @@ static void deleteBlurringObjects(BlurringObjects* objectIdsStoragePtr)
 {
     ASSERT(objectIdsStoragePtr != NULL);
 
-    GL_CHECK(glDeleteTextures    (1, &objectIdsStoragePtr->textureObjectIdHorizontal) );
     GL_CHECK(glDeleteTextures    (1, &objectIdsStoragePtr->textureObjectIdVertical) );
     GL_CHECK(glDeleteFramebuffers(1, &objectIdsStoragePtr->framebufferObjectId) );
 
@@ -623,6 +1174,45 @@ static void deleteBlurringObjects(BlurringObjects* objectIdsStoragePtr)
     objectIdsStoragePtr->framebufferObjectId       = 0;
 }
 
+/** \brief Delete objects which were generated for the dual filter blur.
+ *         According to the OpenGL ES specification, objects will not be deleted if bound.
+ *         It is the user's responsibility to call glBindFramebuffer() and glBindTexture()
+ *         with default object ids (id = 0) at some point.
+ *
+ * \param objectIdsStoragePtr Objects described by the structure will be deleted by the function.
+ *                            Cannot be NULL.
+ */
+static void deleteDualFilterObjects(DualFilterObjects* objectIdsStoragePtr)
+{
+    ASSERT(objectIdsStoragePtr != NULL);
+
+    /* The textures belong to the frame graph. */
+    GL_CHECK(glDeleteFramebuffers(1, &objectIdsStoragePtr->framebufferObjectId) );
+
+    memset(objectIdsStoragePtr->textureObjectIdsDownsampled, 0, sizeof(objectIdsStoragePtr->textureObjectIdsDownsampled) );
+    memset(objectIdsStoragePtr->textureObjectIdsUpsampled,   0, sizeof(objectIdsStoragePtr->textureObjectIdsUpsampled) );
+
+    objectIdsStoragePtr->framebufferObjectId = 0;
+}
+
+/** \brief Delete the FFT convolution and the textures it was storing results in.
+ *
+ * \param objectIdsStoragePtr Objects described by the structure will be deleted by the function.
+ *                            Cannot be NULL.
+ */
+static void deleteFFTConvolutionObjects(FFTConvolutionObjects* objectIdsStoragePtr)
+{
+    ASSERT(objectIdsStoragePtr != NULL);
+
+    delete objectIdsStoragePtr->convolution;
+
+    GL_CHECK(glDeleteTextures(2, objectIdsStoragePtr->textureObjectIdsConvolved) );
+
+    memset(objectIdsStoragePtr->textureObjectIdsConvolved, 0, sizeof(objectIdsStoragePtr->textureObjectIdsConvolved) );
+
+    objectIdsStoragePtr->convolution = NULL;
+}
+
 /** \brief Delete objects which were generated for getting downscaled luminance image.
  *         According to the OpenGL ES specification, objects will not be deleted if bound.
  *         It is the user's responsibility to call glBindFramebuffer() and glBindTexture()
@@ -678,7 +1268,6 @@ static void deleteSceneRenderingObjects(SceneRenderingObjects* objectIdsStorageP
     GL_CHECK(glDeleteBuffers     (1, &objectIdsStoragePtr->bufferObjectIdCubeNormals) );
     GL_CHECK(glDeleteBuffers     (1, &objectIdsStoragePtr->bufferObjectIdElementLocations) );
     GL_CHECK(glDeleteFramebuffers(1, &objectIdsStoragePtr->framebufferObjectId) );
-    GL_CHECK(glDeleteTextures    (1, &objectIdsStoragePtr->textureObjectIdDepthImage) );
     GL_CHECK(glDeleteTextures    (1, &objectIdsStoragePtr->textureObjectIdOriginalImage) );
 
     objectIdsStoragePtr->bufferObjectIdCubeCoords       = 0;
@@ -710,66 +1299,32 @@ static void deleteStrongerBlurObjects(StrongerBlurObjects* objectIdsStoragePtr)
 
 /** \brief Generate texture and framebuffer objects, configure texture parameters.
  *         Finally, reset GL_TEXTURE_2D texture binding to 0 for active texture unit.
- *         Objects will be used for applying blur effect.
+ *         Objects will be used for applying blur effect. The horizontal blur texture comes from the frame graph.
  *
  *  \param framebufferObjectIdPtr       Deref will be used to store generated framebuffer object ID.
  *                                      Cannot be NULL.
- *  \param horizontalTextureObjectIdPtr Deref will be used to store generated horizontal texture object ID.
- *                                      Cannot be NULL.
  *  \param verticalTextureObjectIdPtr   Deref will be used to store generated vertical texture object ID.
  *                                      Cannot be NULL.
  */
 static void generateAndPrepareObjectsUsedForBlurring(GLuint* framebufferObjectIdPtr,
-                                                     GLuint* horizontalTextureObjectIdPtr,
                                                      GLuint* verticalTextureObjectIdPtr)
 {
     ASSERT(framebufferObjectIdPtr       != NULL);
-    ASSERT(horizontalTextureObjectIdPtr != NULL);
     ASSERT(verticalTextureObjectIdPtr   != NULL);
 
     /* Generate objects. */
     GL_CHECK(glGenFramebuffers(1,
                                framebufferObjectIdPtr) );
-    GL_CHECK(glGenTextures    (1,
-                               horizontalTextureObjectIdPtr) );
     GL_CHECK(glGenTextures    (1,
                                verticalTextureObjectIdPtr) );
 
-    GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
-                            *horizontalTextureObjectIdPtr) );
-    GL_CHECK(glTexImage2D   (GL_TEXTURE_2D,
-                             0,
-                             GL_RGBA8,
-                             windowWidth  / WINDOW_RESOLUTION_DIVISOR,
-                             windowHeight / WINDOW_RESOLUTION_DIVISOR,
-                             0,
-                             GL_RGBA,
-                             GL_UNSIGNED_BYTE,
-                             NULL) );
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
-                             GL_TEXTURE_WRAP_S,
-                             GL_CLAMP_TO_EDGE) );
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
-                             GL_TEXTURE_WRAP_T,
-                             GL_CLAMP_TO_EDGE) );
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
-                             GL_TEXTURE_MAG_FILTER,
-                             GL_LINEAR) );
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
-                             GL_TEXTURE_MIN_FILTER,
-                             GL_LINEAR) );
-
     GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
                             *verticalTextureObjectIdPtr) );
-    GL_CHECK(glTexImage2D   (GL_TEXTURE_2D,
-                             0,
-                             GL_RGBA8,
+    GL_CHECK(glTexStorage2D (GL_TEXTURE_2D,
+                             1,
+                             bloomTextureFormat,
                              windowWidth  / WINDOW_RESOLUTION_DIVISOR,
-                             windowHeight / WINDOW_RESOLUTION_DIVISOR,
-                             0,
-                             GL_RGBA,
-                             GL_UNSIGNED_BYTE,
-                             NULL) );
+                             windowHeight / WINDOW_RESOLUTION_DIVISOR) );
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
                              GL_TEXTURE_WRAP_S,
                              GL_CLAMP_TO_EDGE) );
@@ -791,21 +1346,18 @@ static void generateAndPrepareObjectsUsedForBlurring(GLuint* framebufferObjectId
 /** \brief Generate texture and framebuffer objects and configure texture parameters accordingly.
  *         Finally, reset GL_FRAEMBUFFER and GL_TEXTURE_2D bindings to 0.
  *         Objects will be used for rendering the scene into texture.
+ *         The depth texture comes from the frame graph, and is only attached while the scene is rendered.
  *
  *  \param framebufferObjectIdPtr     Deref will be used to store generated framebuffer object ID.
  *                                    Cannot be NULL.
  *  \param originalTextureObjectIdPtr Deref will be used to store generated original texture object ID.
  *                                    Cannot be NULL.
- *  \param depthToIdPtr               Deref will be used to store generated depth texture object ID.
- *                                    Cannot be NULL.
  */
 static void generateAndPrepareObjectsUsedForSceneRendering(GLuint* framebufferObjectIdPtr,
-                                                           GLuint* originalTextureObjectIdPtr,
-                                                           GLuint* depthToIdPtr)
+                                                           GLuint* originalTextureObjectIdPtr)
 {
     ASSERT(framebufferObjectIdPtr    != NULL);
     ASSERT(originalTextureObjectIdPtr!= NULL);
-    ASSERT(depthToIdPtr              != NULL);
 
     /* [Generate Objects For Scene Rendering] */
     /* Generate objects. */
@@ -813,8 +1365,6 @@ static void generateAndPrepareObjectsUsedForSceneRendering(GLuint* framebufferOb
                                framebufferObjectIdPtr) );
     GL_CHECK(glGenTextures    (1,
                                originalTextureObjectIdPtr) );
-    GL_CHECK(glGenTextures    (1,
-                               depthToIdPtr) );
 
     /* Bind generated framebuffer and texture objects to specific binding points. */
     GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER,
@@ -822,15 +1372,11 @@ static void generateAndPrepareObjectsUsedForSceneRendering(GLuint* framebufferOb
 
     GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
                             *originalTextureObjectIdPtr) );
-    GL_CHECK(glTexImage2D   (GL_TEXTURE_2D,
-                             0,
-                             GL_RGBA8,
+    GL_CHECK(glTexStorage2D (GL_TEXTURE_2D,
+                             1,
+                             sceneTextureFormat,
                              windowWidth,
-                             windowHeight,
-                             0,
-                             GL_RGBA,
-                             GL_UNSIGNED_BYTE,
-                             NULL) );
+                             windowHeight) );
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
                              GL_TEXTURE_WRAP_S,
                              GL_CLAMP_TO_EDGE) );
@@ -843,44 +1389,15 @@ static void generateAndPrepareObjectsUsedForSceneRendering(GLuint* framebufferOb
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
                              GL_TEXTURE_MIN_FILTER,
                              GL_LINEAR) );
-
-    GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
-                            *depthToIdPtr) );
-    GL_CHECK(glTexImage2D   (GL_TEXTURE_2D,
-                             0,
-                             GL_DEPTH_COMPONENT32F,
-                             windowWidth,
-                             windowHeight,
-                             0,
-                             GL_DEPTH_COMPONENT,
-                             GL_FLOAT,
-                             NULL) );
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
-                             GL_TEXTURE_MIN_FILTER,
-                             GL_NEAREST) );
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
-                             GL_TEXTURE_MAG_FILTER,
-                             GL_NEAREST) );
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
-                             GL_TEXTURE_WRAP_S,
-                             GL_CLAMP_TO_EDGE) );
-    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
-                             GL_TEXTURE_WRAP_T,
-                             GL_CLAMP_TO_EDGE) );
     /* [Generate Objects For Scene Rendering] */
 
    /* [Bind Textures to Framebuffer] */
-    /* Bind colour and depth textures to framebuffer object. */
+    /* Bind colour texture to framebuffer object. */
     GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER,
                                     GL_COLOR_ATTACHMENT0,
                                     GL_TEXTURE_2D,
                                    *originalTextureObjectIdPtr,
                                     0) );
-    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER,
-                                    GL_DEPTH_ATTACHMENT,
-                                    GL_TEXTURE_2D,
-                                   *depthToIdPtr,
-                                    0) );
     /* [Bind Textures to Framebuffer] */
 
     /* At the end, restore default environment settings (bind default FBO and TO). */
@@ -917,7 +1434,7 @@ static void generateDownscaledObjects(GLuint* fboIdPtr,
                             *toIdPtr) );
     GL_CHECK(glTexStorage2D (GL_TEXTURE_2D,
                              1,
-                             GL_RGBA8,
+                             bloomTextureFormat,
                              windowWidth   / WINDOW_RESOLUTION_DIVISOR,
                              windowHeight / WINDOW_RESOLUTION_DIVISOR));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
@@ -950,6 +1467,151 @@ static void generateDownscaledObjects(GLuint* fboIdPtr,
 }
 /* [Generate downscaled objects] */
 
+/** \brief Get the resolution of a dual filter level. Level 0 is the bloom source texture resolution.
+ *
+ * \param level     Dual filter level.
+ * \param widthPtr  Deref will be used to store the level width. Cannot be NULL.
+ * \param heightPtr Deref will be used to store the level height. Cannot be NULL.
+ */
+static void getDualFilterLevelResolution(int level, GLsizei* widthPtr, GLsizei* heightPtr)
+{
+    ASSERT(widthPtr  != NULL);
+    ASSERT(heightPtr != NULL);
+
+    *widthPtr  = (windowWidth  / WINDOW_RESOLUTION_DIVISOR) >> level;
+    *heightPtr = (windowHeight / WINDOW_RESOLUTION_DIVISOR) >> level;
+
+    if (*widthPtr < 1)
+    {
+        *widthPtr = 1;
+    }
+
+    if (*heightPtr < 1)
+    {
+        *heightPtr = 1;
+    }
+}
+
+/** \brief Generate the framebuffer object used for the dual filter blur. The textures of the levels come from the frame graph.
+ *
+ *  \param objectIdsStoragePtr Deref will be used to store generated object IDs.
+ *                             Cannot be NULL.
+ */
+static void generateDualFilterObjects(DualFilterObjects* objectIdsStoragePtr)
+{
+    ASSERT(objectIdsStoragePtr != NULL);
+
+    GL_CHECK(glGenFramebuffers(1,
+                              &objectIdsStoragePtr->framebufferObjectId) );
+}
+
+/* [Blur frame graph] */
+/** \brief Declare the transient targets of the blur passes of the bloom mode in the frame graph, then compile it.
+ *         The textures it gives the targets are stored in blurringObjects and dualFilterObjects for the blur functions.
+ *         The weaker and the stronger blur textures are sampled in every frame, so they are not transient.
+ *
+ * \param numberOfIterations Number of blur iterations, or of dual filter levels, the blur is about to use.
+ */
+static void buildBlurFrameGraph(int numberOfIterations)
+{
+    ASSERT(frameGraph != NULL);
+
+    int horizontal = -1;
+    int downsampled[MAX_NUMBER_OF_DUAL_FILTER_LEVELS];
+    int upsampled  [MAX_NUMBER_OF_DUAL_FILTER_LEVELS - 1];
+
+    frameGraph->clear();
+
+    if (bloomMode == BLOOM_MODE_DUAL_FILTER)
+    {
+        ASSERT(numberOfIterations >= 2 && numberOfIterations <= MAX_NUMBER_OF_DUAL_FILTER_LEVELS);
+
+        for (int level = 1; level <= numberOfIterations; level++)
+        {
+            GLsizei levelWidth  = 0;
+            GLsizei levelHeight = 0;
+
+            getDualFilterLevelResolution(level, &levelWidth, &levelHeight);
+
+            downsampled[level - 1] = frameGraph->addTarget("dual filter downsampled", levelWidth, levelHeight, bloomTextureFormat, GL_LINEAR);
+
+            if (level < numberOfIterations)
+            {
+                upsampled[level - 1] = frameGraph->addTarget("dual filter upsampled", levelWidth, levelHeight, bloomTextureFormat, GL_LINEAR);
+            }
+        }
+
+        /* The passes of renderDualFilterBlur(). Every downsampled level is dead by the time the upsampled level
+         * of the same size is written, so the two share a texture. */
+        for (int level = 1; level <= numberOfIterations; level++)
+        {
+            int pass = frameGraph->addPass("dual filter downsample");
+
+            if (level > 1)
+            {
+                frameGraph->read(pass, downsampled[level - 2]);
+            }
+
+            frameGraph->write(pass, downsampled[level - 1]);
+        }
+
+        for (int chain = 0; chain < 2; chain++)
+        {
+            /* The weaker blur chain first, then the stronger one. */
+            const int chainLevels = numberOfIterations - 1 + chain;
+
+            for (int level = chainLevels - 1; level >= 0; level--)
+            {
+                int pass = frameGraph->addPass("dual filter upsample");
+
+                frameGraph->read(pass, (level == chainLevels - 1) ? downsampled[level] : upsampled[level]);
+
+                if (level > 0)
+                {
+                    frameGraph->write(pass, upsampled[level - 1]);
+                }
+            }
+        }
+    }
+    else if (bloomMode == BLOOM_MODE_SEPARABLE_BLUR || bloomMode == BLOOM_MODE_COMPUTE_BLUR)
+    {
+        horizontal = frameGraph->addTarget("horizontal blur",
+                                           windowWidth  / WINDOW_RESOLUTION_DIVISOR,
+                                           windowHeight / WINDOW_RESOLUTION_DIVISOR,
+                                           bloomTextureFormat,
+                                           GL_LINEAR);
+
+        for (int blurIterationIndex = 0; blurIterationIndex < numberOfIterations; blurIterationIndex++)
+        {
+            frameGraph->write(frameGraph->addPass("horizontal blur"), horizontal);
+            frameGraph->read (frameGraph->addPass("vertical blur"),   horizontal);
+        }
+    }
+    /* The FFT convolution writes straight to the weaker and the stronger blur textures. */
+
+    ASSERT(frameGraph->compile() );
+
+    blurringObjects.textureObjectIdHorizontal = frameGraph->getTexture(horizontal);
+
+    for (int level = 1; level <= MAX_NUMBER_OF_DUAL_FILTER_LEVELS; level++)
+    {
+        const bool isUsed = bloomMode == BLOOM_MODE_DUAL_FILTER && level <= numberOfIterations;
+
+        dualFilterObjects.textureObjectIdsDownsampled[level - 1] = isUsed ? frameGraph->getTexture(downsampled[level - 1]) : 0;
+
+        if (level < MAX_NUMBER_OF_DUAL_FILTER_LEVELS)
+        {
+            dualFilterObjects.textureObjectIdsUpsampled[level - 1] = (isUsed && level < numberOfIterations) ? frameGraph->getTexture(upsampled[level - 1]) : 0;
+        }
+    }
+
+    /* The blur passes sample the horizontal blur texture on its texture unit. */
+    GL_CHECK(glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_HORIZONTAL_BLUR_TEXTURE) );
+    GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
+                             blurringObjects.textureObjectIdHorizontal) );
+}
+/* [Blur frame graph] */
+
 /* [Calculate cube locations] */
 /** \brief Calculate the world space locations of all the cubes that we will be rendering.
  *         The cubes are arranged in a 2D array consisting of \p numberOfColumns columns
@@ -1092,6 +1754,8 @@ static void getLocationsForSceneRenderingProgram(GLuint
                                                                                                        "light_properties.shininess") );
     locationsStoragePtr->uniformLightPropertiesStrength              = GL_CHECK(glGetUniformLocation  (programObjectId,
                                                                                                        "light_properties.strength") );
+    locationsStoragePtr->uniformLightCubeIntensity                   = GL_CHECK(glGetUniformLocation  (programObjectId,
+                                                                                                       "light_cube_intensity") );
     locationsStoragePtr->uniformMvMatrix                             = GL_CHECK(glGetUniformLocation  (programObjectId,
                                                                                                        "mv_matrix") );
     locationsStoragePtr->uniformMvpMatrix                            = GL_CHECK(glGetUniformLocation  (programObjectId,
@@ -1109,12 +1773,14 @@ static void getLocationsForSceneRenderingProgram(GLuint
     ASSERT(locationsStoragePtr->uniformLightPropertiesQuadraticAttenauation != -1);
     ASSERT(locationsStoragePtr->uniformLightPropertiesShininess             != -1);
     ASSERT(locationsStoragePtr->uniformLightPropertiesStrength              != -1);
+    ASSERT(locationsStoragePtr->uniformLightCubeIntensity                   != -1);
     ASSERT(locationsStoragePtr->uniformMvMatrix                             != -1);
     ASSERT(locationsStoragePtr->uniformMvpMatrix                            != -1);
 }
 
-/** \brief Create and compile shader objects.
- *         If successful, they are attached to the program object, which is then linked.
+/** \brief Queue the program object to be built from the shader sources.
+ *         The program object ID is valid straight away, but the program cannot be used
+ *         until programCompileQueue has finished building it.
  *
  * \param objectIdsPtr         Deref where generated program and shader objects IDs will be stored.
  *                             Cannot be NULL.
@@ -1129,25 +1795,10 @@ static void initializeProgramObject(ProgramAndShadersIds* objectIdsPtr,
 {
     ASSERT(objectIdsPtr != NULL);
 
-    GLint linkStatus = 0;
-
-    objectIdsPtr->programObjectId = GL_CHECK(glCreateProgram() );
-
-    Shader::processShader(&objectIdsPtr->fragmentShaderObjectId,
-                           fragmentShaderSource,
-                           GL_FRAGMENT_SHADER);
-    Shader::processShader(&objectIdsPtr->vertexShaderObjectId,
-                           vertexShaderSource,
-                           GL_VERTEX_SHADER);
-
-    GL_CHECK(glAttachShader(objectIdsPtr->programObjectId, objectIdsPtr->fragmentShaderObjectId) );
-    GL_CHECK(glAttachShader(objectIdsPtr->programObjectId, objectIdsPtr->vertexShaderObjectId) );
-
-    GL_CHECK(glLinkProgram(objectIdsPtr->programObjectId) );
-
-    GL_CHECK(glGetProgramiv(objectIdsPtr->programObjectId, GL_LINK_STATUS, &linkStatus) );
-
-    ASSERT(linkStatus == GL_TRUE);
+    /* The shader objects are owned by the queue, which deletes them once the program is linked. */
+    objectIdsPtr->programObjectId        = programCompileQueue.addProgram(vertexShaderSource, fragmentShaderSource);
+    objectIdsPtr->fragmentShaderObjectId = 0;
+    objectIdsPtr->vertexShaderObjectId   = 0;
 }
 
 /* \brief Render the luminance image (which then can be bloomed) and store the result in corresponding texture object.
@@ -1158,17 +1809,18 @@ static void renderDowscaledLuminanceTexture()
     /* Get the luminance image, store it in the downscaled texture. */
     GL_CHECK(glUseProgram(getLuminanceImageProgramShaderObjects.programObjectId));
     {
-        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
-                                   getLuminanceImageBloomObjects.framebufferObjectId));
-        /* Set the viewport for the whole screen size. */
-        GL_CHECK(glViewport(0,
-                            0,
-                            windowWidth  / WINDOW_RESOLUTION_DIVISOR,
-                            windowHeight / WINDOW_RESOLUTION_DIVISOR) );
-        /* Clear the framebuffer's content. */
-        GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT) );
+        /* The quad covers every pixel, so the previous contents are invalidated instead of cleared. */
+        RenderPass luminancePass(getLuminanceImageBloomObjects.framebufferObjectId,
+                                 windowWidth  / WINDOW_RESOLUTION_DIVISOR,
+                                 windowHeight / WINDOW_RESOLUTION_DIVISOR);
+
+        luminancePass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_DONT_CARE, RenderPass::STORE_OP_STORE, 4);
+
+        /* Bind the framebuffer object and set the viewport for the whole texture size. */
+        luminancePass.begin();
         /* Draw texture. */
         GL_CHECK(glDrawArrays(GL_TRIANGLE_FAN, 0, 4) );
+        luminancePass.end();
     }
     /* [Render luminance image into downscaled texture] */
 }
@@ -1186,17 +1838,25 @@ static void renderSceneColourTexture()
     */
     GL_CHECK(glUseProgram(sceneRenderingProgramShaderObjects.programObjectId) );
     {
-        /* Bind a framebuffer object to the GL_DRAW_FRAMEBUFFER framebuffer binding point,
-        * so that everything we render will end up in the FBO's attachments. */
-        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
-                                   sceneRenderingObjects.framebufferObjectId) );
-        /* Set the viewport for the whole screen size. */
-        GL_CHECK(glViewport(0,
-                            0,
-                            windowWidth,
-                            windowHeight) );
-        /* Clear the framebuffer's content. */
-        GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT) );
+        /* The depth image is only needed while the cubes are drawn, and is never sampled.
+         * It is discarded at the end of the pass so that it stays on-tile and is not written out to memory. */
+        RenderPass scenePass(sceneRenderingObjects.framebufferObjectId, windowWidth, windowHeight);
+
+        scenePass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE,      4);
+        scenePass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_DONT_CARE, 4);
+
+        /* The depth texture is a transient target of the frame graph, only attached for this pass. */
+        GL_CHECK(glBindFramebuffer     (GL_FRAMEBUFFER,
+                                        sceneRenderingObjects.framebufferObjectId) );
+        GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER,
+                                        GL_DEPTH_ATTACHMENT,
+                                        GL_TEXTURE_2D,
+                                        sceneRenderingObjects.textureObjectIdDepthImage,
+                                        0) );
+
+        /* Bind the framebuffer object, so that everything we render will end up in the FBO's attachments,
+         * set the viewport for the whole screen size and clear the framebuffer's content. */
+        scenePass.begin();
         /* [Instanced drawing] */
         /* Draw scene. */
         GL_CHECK(glDrawArraysInstanced(GL_TRIANGLES,
@@ -1204,10 +1864,461 @@ static void renderSceneColourTexture()
                                        nOfCubeCoordinates,
                                        NUMBER_OF_CUBES) );
         /* [Instanced drawing] */
+
+        scenePass.end();
+
+        /* Detach the depth texture, or the framebuffer object would keep it alive once the frame graph releases it. */
+        GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER,
+                                        GL_DEPTH_ATTACHMENT,
+                                        GL_TEXTURE_2D,
+                                        0,
+                                        0) );
     }
     /* [Render scene into texture objects] */
 }
 
+/** \brief Upsample a chain of dual filter levels, starting from a downsampled level, back to the bloom source resolution.
+ *         The dual filter framebuffer object and the upsample program have to be bound.
+ *
+ * \param numberOfLevels   Level which the chain starts from. Has to be between 1 and MAX_NUMBER_OF_DUAL_FILTER_LEVELS.
+ * \param targetTextureId  Texture object ID to store the result in. It has to have the bloom source texture resolution.
+ */
+static void upsampleDualFilterLevels(int numberOfLevels, GLuint targetTextureId)
+{
+    for (int level = numberOfLevels - 1; level >= 0; level--)
+    {
+        /* The first pass reads the smallest downsampled level, the next ones read the result of the previous pass. */
+        GLuint  sourceTextureId = (level == numberOfLevels - 1) ? dualFilterObjects.textureObjectIdsDownsampled[level]
+                                                                : dualFilterObjects.textureObjectIdsUpsampled  [level];
+        GLuint  resultTextureId = (level == 0)                  ? targetTextureId
+                                                                : dualFilterObjects.textureObjectIdsUpsampled  [level - 1];
+        GLsizei levelWidth      = 0;
+        GLsizei levelHeight     = 0;
+
+        getDualFilterLevelResolution(level, &levelWidth, &levelHeight);
+
+        GL_CHECK(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER,
+                                        GL_COLOR_ATTACHMENT0,
+                                        GL_TEXTURE_2D,
+                                        resultTextureId,
+                                        0) );
+        GL_CHECK(glBindTexture         (GL_TEXTURE_2D,
+                                        sourceTextureId) );
+        GL_CHECK(glViewport            (0, 0, levelWidth, levelHeight) );
+
+        /* Draw texture. */
+        GL_CHECK(glDrawArrays(GL_TRIANGLE_FAN, 0, 4) );
+    }
+}
+
+/** \brief Blur the bloom source texture with a dual filter.
+ *         The bloom source is downsampled \p numberOfLevels times and upsampled back into the stronger blur texture.
+ *         The chain starting one level higher is upsampled into the weaker blur texture, so the two can be mixed
+ *         in the same way as the results of the separable blur.
+ *
+ * \param numberOfLevels Number of downsampling passes used for the stronger blur effect.
+ *                       Has to be between 2 and MAX_NUMBER_OF_DUAL_FILTER_LEVELS.
+ */
+static void renderDualFilterBlur(int numberOfLevels)
+{
+    ASSERT(numberOfLevels >= 2 && numberOfLevels <= MAX_NUMBER_OF_DUAL_FILTER_LEVELS);
+
+    /* [Dual filter blur] */
+    GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
+                               dualFilterObjects.framebufferObjectId) );
+    GL_CHECK(glActiveTexture  (GL_TEXTURE0 + TEXTURE_UNIT_DUAL_FILTER_TEXTURE) );
+
+    /* DOWNSAMPLE
+     * Each level is half the size of the previous one. The first level reads the bloom source texture.
+     */
+    GL_CHECK(glUseProgram(dualFilterDownsampleProgramShaderObjects.programObjectId) );
+    {
+        for (int level = 1; level <= numberOfLevels; level++)
+        {
+            GLuint  sourceTextureId = (level == 1) ? getLuminanceImageBloomObjects.textureObjectId
+                                                   : dualFilterObjects.textureObjectIdsDownsampled[level - 2];
+            GLsizei levelWidth      = 0;
+            GLsizei levelHeight     = 0;
+
+            getDualFilterLevelResolution(level, &levelWidth, &levelHeight);
+
+            GL_CHECK(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER,
+                                            GL_COLOR_ATTACHMENT0,
+                                            GL_TEXTURE_2D,
+                                            dualFilterObjects.textureObjectIdsDownsampled[level - 1],
+                                            0) );
+            GL_CHECK(glBindTexture         (GL_TEXTURE_2D,
+                                            sourceTextureId) );
+            GL_CHECK(glViewport            (0, 0, levelWidth, levelHeight) );
+
+            /* Draw texture. */
+            GL_CHECK(glDrawArrays(GL_TRIANGLE_FAN, 0, 4) );
+        }
+    } /* DOWNSAMPLE */
+
+    /* UPSAMPLE
+     * The same lower levels are used for both results, so they are only downsampled once.
+     * The shorter chain goes first: once it has read the last but one downsampled level, no downsampled level
+     * is read again before it is upsampled into, so each one can share its texture with the upsampled level.
+     */
+    GL_CHECK(glUseProgram(dualFilterUpsampleProgramShaderObjects.programObjectId) );
+    {
+        upsampleDualFilterLevels(numberOfLevels - 1, blurringObjects.textureObjectIdVertical);
+        upsampleDualFilterLevels(numberOfLevels,     strongerBlurObjects.textureObjectId);
+    } /* UPSAMPLE */
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0) );
+    /* [Dual filter blur] */
+}
+
+/** \brief Check whether compute shaders can be used, i.e. whether the context is OpenGL ES 3.1 or newer.
+ */
+static bool isComputeShaderSupported()
+{
+    GLint majorVersion = 0;
+    GLint minorVersion = 0;
+
+    GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &majorVersion) );
+    GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minorVersion) );
+
+    return majorVersion > 3 || (majorVersion == 3 && minorVersion >= 1);
+}
+
+/** \brief Check whether an OpenGL ES extension is supported.
+ *
+ * \param extensionName Name of the extension. Cannot be NULL.
+ */
+static bool isExtensionSupported(const char* extensionName)
+{
+    ASSERT(extensionName != NULL);
+
+    GLint numberOfExtensions = 0;
+
+    GL_CHECK(glGetIntegerv(GL_NUM_EXTENSIONS, &numberOfExtensions) );
+
+    for (GLint extensionIndex = 0; extensionIndex < numberOfExtensions; extensionIndex++)
+    {
+        const char* name = (const char*) GL_CHECK(glGetStringi(GL_EXTENSIONS, extensionIndex) );
+
+        if (strcmp(name, extensionName) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** \brief Decide whether the scene can be rendered with high dynamic range, and pick the texture formats for it.
+ *         The auto exposure needs compute shaders, and the scene and bloom textures have to be renderable floating point ones.
+ *         The scene texture is never written by a compute shader, so it can be R11F_G11F_B10F, half the size of RGBA16F.
+ */
+static void setupTextureFormats()
+{
+    const bool isFloatRenderable     = isExtensionSupported("GL_EXT_color_buffer_float");
+    const bool isHalfFloatRenderable = isFloatRenderable || isExtensionSupported("GL_EXT_color_buffer_half_float");
+
+    if (isHDREnabled && !(isComputeShaderSupported() && isHalfFloatRenderable) )
+    {
+        LOGI("Floating point render targets or compute shaders are not supported, falling back to low dynamic range.");
+
+        isHDREnabled = false;
+    }
+
+    if (isHDREnabled)
+    {
+        sceneTextureFormat = isFloatRenderable ? GL_R11F_G11F_B10F : GL_RGBA16F;
+        bloomTextureFormat = GL_RGBA16F;
+    }
+    else
+    {
+        sceneTextureFormat = GL_RGBA8;
+        bloomTextureFormat = GL_RGBA8;
+    }
+}
+
+/** \brief Create the compute programs and the objects used for the auto exposure, and set the uniforms which do not change.
+ *         The scene texture has to be bound to TEXTURE_UNIT_COLOR_TEXTURE already.
+ */
+static void setupAutoExposure()
+{
+    const float initialAdaptedLuminance = 1.0f;
+    GLuint      emptyHistogram[256]     = {0};
+
+    /* The histogram starts out empty, the adaptation pass clears it again after each frame. */
+    GL_CHECK(glGenBuffers(1,
+                         &autoExposureObjects.bufferObjectIdHistogram) );
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER,
+                          autoExposureObjects.bufferObjectIdHistogram) );
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER,
+                          sizeof(emptyHistogram),
+                          emptyHistogram,
+                          GL_DYNAMIC_COPY) );
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER,
+                          0) );
+
+    /* Read and written by the adaptation pass, and fetched by the blending pass. R32F cannot be filtered. */
+    GL_CHECK(glGenTextures  (1,
+                            &autoExposureObjects.textureObjectIdAdaptedLuminance) );
+    GL_CHECK(glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_ADAPTED_LUMINANCE_TEXTURE) );
+    GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
+                             autoExposureObjects.textureObjectIdAdaptedLuminance) );
+    GL_CHECK(glTexStorage2D (GL_TEXTURE_2D,
+                             1,
+                             GL_R32F,
+                             1,
+                             1) );
+    GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D,
+                             0,
+                             0,
+                             0,
+                             1,
+                             1,
+                             GL_RED,
+                             GL_FLOAT,
+                            &initialAdaptedLuminance) );
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
+                             GL_TEXTURE_MAG_FILTER,
+                             GL_NEAREST) );
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
+                             GL_TEXTURE_MIN_FILTER,
+                             GL_NEAREST) );
+
+    /* The compute programs are not queued, as the queue only builds vertex and fragment shader programs. */
+    Shader::processShaderSource(&luminanceHistogramShaderObjectId, luminanceHistogramShaderSource, GL_COMPUTE_SHADER);
+
+    luminanceHistogramProgramObjectId = GL_CHECK(glCreateProgram() );
+
+    GL_CHECK(glAttachShader(luminanceHistogramProgramObjectId, luminanceHistogramShaderObjectId) );
+    GL_CHECK(glLinkProgram (luminanceHistogramProgramObjectId) );
+    GL_CHECK(glUseProgram  (luminanceHistogramProgramObjectId) );
+
+    autoExposureProgramLocations.uniformSceneTexture             = GL_CHECK(glGetUniformLocation(luminanceHistogramProgramObjectId, "scene_texture") );
+    autoExposureProgramLocations.uniformHistogramMinLogLuminance = GL_CHECK(glGetUniformLocation(luminanceHistogramProgramObjectId, "min_log_luminance") );
+    autoExposureProgramLocations.uniformInverseLogLuminanceRange = GL_CHECK(glGetUniformLocation(luminanceHistogramProgramObjectId, "inverse_log_luminance_range") );
+
+    ASSERT(autoExposureProgramLocations.uniformSceneTexture             != -1);
+    ASSERT(autoExposureProgramLocations.uniformHistogramMinLogLuminance != -1);
+    ASSERT(autoExposureProgramLocations.uniformInverseLogLuminanceRange != -1);
+
+    GL_CHECK(glUniform1i(autoExposureProgramLocations.uniformSceneTexture,             TEXTURE_UNIT_COLOR_TEXTURE) );
+    GL_CHECK(glUniform1f(autoExposureProgramLocations.uniformHistogramMinLogLuminance, AUTO_EXPOSURE_MIN_LOG_LUMINANCE) );
+    GL_CHECK(glUniform1f(autoExposureProgramLocations.uniformInverseLogLuminanceRange, 1.0f / AUTO_EXPOSURE_LOG_LUMINANCE_RANGE) );
+
+    Shader::processShaderSource(&adaptExposureShaderObjectId, adaptExposureShaderSource, GL_COMPUTE_SHADER);
+
+    adaptExposureProgramObjectId = GL_CHECK(glCreateProgram() );
+
+    GL_CHECK(glAttachShader(adaptExposureProgramObjectId, adaptExposureShaderObjectId) );
+    GL_CHECK(glLinkProgram (adaptExposureProgramObjectId) );
+    GL_CHECK(glUseProgram  (adaptExposureProgramObjectId) );
+
+    autoExposureProgramLocations.uniformNumberOfPixels            = GL_CHECK(glGetUniformLocation(adaptExposureProgramObjectId, "number_of_pixels") );
+    autoExposureProgramLocations.uniformAdaptationMinLogLuminance = GL_CHECK(glGetUniformLocation(adaptExposureProgramObjectId, "min_log_luminance") );
+    autoExposureProgramLocations.uniformLogLuminanceRange         = GL_CHECK(glGetUniformLocation(adaptExposureProgramObjectId, "log_luminance_range") );
+    autoExposureProgramLocations.uniformAdaptationFactor          = GL_CHECK(glGetUniformLocation(adaptExposureProgramObjectId, "adaptation_factor") );
+
+    ASSERT(autoExposureProgramLocations.uniformNumberOfPixels            != -1);
+    ASSERT(autoExposureProgramLocations.uniformAdaptationMinLogLuminance != -1);
+    ASSERT(autoExposureProgramLocations.uniformLogLuminanceRange         != -1);
+    ASSERT(autoExposureProgramLocations.uniformAdaptationFactor          != -1);
+
+    /* The histogram measures one pixel per 2x2 texel block of the scene texture. */
+    GL_CHECK(glUniform1ui(autoExposureProgramLocations.uniformNumberOfPixels,            (windowWidth / 2) * (windowHeight / 2) ) );
+    GL_CHECK(glUniform1f (autoExposureProgramLocations.uniformAdaptationMinLogLuminance, AUTO_EXPOSURE_MIN_LOG_LUMINANCE) );
+    GL_CHECK(glUniform1f (autoExposureProgramLocations.uniformLogLuminanceRange,         AUTO_EXPOSURE_LOG_LUMINANCE_RANGE) );
+}
+
+/** \brief Measure the scene luminance and adapt the exposure towards it, entirely on the GPU.
+ *         The blending pass then reads the exposure from the adapted luminance texture.
+ *
+ * \param deltaTime Time passed since the previous frame (in seconds).
+ */
+static void renderAutoExposure(float deltaTime)
+{
+    /* [Auto exposure] */
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+                              0,
+                              autoExposureObjects.bufferObjectIdHistogram) );
+
+    /* HISTOGRAM
+     * One invocation per 2x2 texel block of the scene texture.
+     */
+    GL_CHECK(glUseProgram     (luminanceHistogramProgramObjectId) );
+    GL_CHECK(glDispatchCompute((windowWidth  / 2 + AUTO_EXPOSURE_TILE_SIZE - 1) / AUTO_EXPOSURE_TILE_SIZE,
+                               (windowHeight / 2 + AUTO_EXPOSURE_TILE_SIZE - 1) / AUTO_EXPOSURE_TILE_SIZE,
+                               1) );
+
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT) );
+
+    /* ADAPTATION
+     * A single work group averages the histogram. The adaptation does not depend on the frame rate.
+     */
+    GL_CHECK(glUseProgram      (adaptExposureProgramObjectId) );
+    GL_CHECK(glUniform1f       (autoExposureProgramLocations.uniformAdaptationFactor,
+                                1.0f - expf(-deltaTime * AUTO_EXPOSURE_ADAPTATION_RATE) ) );
+    GL_CHECK(glBindImageTexture(0,
+                                autoExposureObjects.textureObjectIdAdaptedLuminance,
+                                0,
+                                GL_FALSE,
+                                0,
+                                GL_READ_WRITE,
+                                GL_R32F) );
+    GL_CHECK(glDispatchCompute (1, 1, 1) );
+
+    /* The blending pass fetches the adapted luminance, and the next frame reuses both the histogram and the image. */
+    GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT) );
+    /* [Auto exposure] */
+}
+
+/** \brief Create the compute program responsible for blurring, and set the uniforms which do not change.
+ *         The blurred region has to be known already.
+ */
+static void setupComputeBlurProgram()
+{
+    /* The image format of the shader has to match the format of the bloom textures. */
+    std::string computeBlurSource = computeBlurShaderSource;
+
+    if (bloomTextureFormat == GL_RGBA16F)
+    {
+        computeBlurSource.replace(computeBlurSource.find("rgba8"), strlen("rgba8"), "rgba16f");
+    }
+
+    Shader::processShaderSource(&computeBlurShaderObjectId, computeBlurSource.c_str(), GL_COMPUTE_SHADER);
+
+    computeBlurProgramObjectId = GL_CHECK(glCreateProgram() );
+
+    GL_CHECK(glAttachShader(computeBlurProgramObjectId, computeBlurShaderObjectId) );
+    GL_CHECK(glLinkProgram (computeBlurProgramObjectId) );
+    GL_CHECK(glUseProgram  (computeBlurProgramObjectId) );
+
+    computeBlurProgramLocations.uniformDirection      = GL_CHECK(glGetUniformLocation(computeBlurProgramObjectId, "direction") );
+    computeBlurProgramLocations.uniformRegionOffset   = GL_CHECK(glGetUniformLocation(computeBlurProgramObjectId, "region_offset") );
+    computeBlurProgramLocations.uniformRegionSize     = GL_CHECK(glGetUniformLocation(computeBlurProgramObjectId, "region_size") );
+    computeBlurProgramLocations.uniformTextureSampler = GL_CHECK(glGetUniformLocation(computeBlurProgramObjectId, "texture_sampler") );
+
+    ASSERT(computeBlurProgramLocations.uniformDirection      != -1);
+    ASSERT(computeBlurProgramLocations.uniformRegionOffset   != -1);
+    ASSERT(computeBlurProgramLocations.uniformRegionSize     != -1);
+    ASSERT(computeBlurProgramLocations.uniformTextureSampler != -1);
+
+    GL_CHECK(glUniform2i(computeBlurProgramLocations.uniformRegionOffset, blurRegion[0], blurRegion[1]) );
+    GL_CHECK(glUniform2i(computeBlurProgramLocations.uniformRegionSize,   blurRegion[2], blurRegion[3]) );
+}
+
+/** \brief Blur the bloom source texture with compute shaders.
+ *         It is the same blur as the one done by the blur loop in renderFrame(), and the results are stored
+ *         in the same textures, so the separate framebuffer objects are not needed.
+ *
+ * \param numberOfIterations Number of times the horizontal and the vertical blur are applied.
+ */
+static void renderComputeBlur(int numberOfIterations)
+{
+    /* [Compute blur] */
+    /* One work group per tile, and one row of tiles per line of the blurred region. */
+    const GLuint numberOfHorizontalTiles = (blurRegion[2] + COMPUTE_BLUR_TILE_SIZE - 1) / COMPUTE_BLUR_TILE_SIZE;
+    const GLuint numberOfVerticalTiles   = (blurRegion[3] + COMPUTE_BLUR_TILE_SIZE - 1) / COMPUTE_BLUR_TILE_SIZE;
+
+    GL_CHECK(glUseProgram(computeBlurProgramObjectId) );
+
+    for (int blurIterationIndex = 0;
+             blurIterationIndex < numberOfIterations;
+             blurIterationIndex++)
+    {
+        /* HORIZONTAL BLUR
+         * As in the blur loop, the first iteration takes the bloom source and the next ones the previous result.
+         */
+        GL_CHECK(glUniform1i       (computeBlurProgramLocations.uniformTextureSampler,
+                                    (blurIterationIndex == 0) ? TEXTURE_UNIT_BLOOM_SOURCE_TEXTURE : TEXTURE_UNIT_BLURRED_TEXTURE) );
+        GL_CHECK(glUniform2i       (computeBlurProgramLocations.uniformDirection, 1, 0) );
+        GL_CHECK(glBindImageTexture(0,
+                                    blurringObjects.textureObjectIdHorizontal,
+                                    0,
+                                    GL_FALSE,
+                                    0,
+                                    GL_WRITE_ONLY,
+                                    bloomTextureFormat) );
+        GL_CHECK(glDispatchCompute (numberOfHorizontalTiles, blurRegion[3], 1) );
+
+        /* The vertical blur samples the result with texture fetches. */
+        GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT) );
+
+        /* VERTICAL BLUR
+         * The last iteration stores the result in the stronger blur texture, so the previous result is kept for blending.
+         */
+        GL_CHECK(glUniform1i       (computeBlurProgramLocations.uniformTextureSampler,
+                                    TEXTURE_UNIT_HORIZONTAL_BLUR_TEXTURE) );
+        GL_CHECK(glUniform2i       (computeBlurProgramLocations.uniformDirection, 0, 1) );
+        GL_CHECK(glBindImageTexture(0,
+                                    (blurIterationIndex == numberOfIterations - 1) ? strongerBlurObjects.textureObjectId
+                                                                                   : blurringObjects.textureObjectIdVertical,
+                                    0,
+                                    GL_FALSE,
+                                    0,
+                                    GL_WRITE_ONLY,
+                                    bloomTextureFormat) );
+        GL_CHECK(glDispatchCompute (numberOfVerticalTiles, blurRegion[2], 1) );
+
+        /* The next iteration and the blending pass sample the result with texture fetches. */
+        GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT) );
+    }
+    /* [Compute blur] */
+}
+
+/** \brief Blur the bloom source texture with an FFT convolution.
+ *         The results are copied to the same textures as the ones of the blur loop in renderFrame(),
+ *         with the kernels of (numberOfIterations - 1) and numberOfIterations blur iterations.
+ *
+ * \param numberOfIterations Number of blur iterations the stronger blur replaces.
+ */
+static void renderFFTConvolutionBlur(int numberOfIterations)
+{
+    /* [FFT convolution blur] */
+    const int kernelIndex = numberOfIterations - MIN_NUMBER_OF_BLUR_PASSES;
+
+    /* The bloom source is transformed once for both kernels. */
+    fftConvolutionObjects.convolution->transform_input(getLuminanceImageBloomObjects.textureObjectId);
+    fftConvolutionObjects.convolution->convolve       (fftConvolutionObjects.textureObjectIdsConvolved[0], kernelIndex);
+    fftConvolutionObjects.convolution->convolve       (fftConvolutionObjects.textureObjectIdsConvolved[1], kernelIndex + 1);
+
+    /* The copies sample the results with texture fetches. */
+    GL_CHECK(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT) );
+
+    /* GLFFT samples its input on texture unit 0, put the colour texture back. */
+    GL_CHECK(glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_COLOR_TEXTURE) );
+    GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
+                             sceneRenderingObjects.textureObjectIdOriginalImage) );
+
+    /* Copy the padded results to the blurred region of the weaker and the stronger blur textures. */
+    GL_CHECK(glUseProgram(fftResolveProgramShaderObjects.programObjectId) );
+    GL_CHECK(glViewport  (0,
+                          0,
+                          windowWidth  / WINDOW_RESOLUTION_DIVISOR,
+                          windowHeight / WINDOW_RESOLUTION_DIVISOR) );
+    GL_CHECK(glEnable    (GL_SCISSOR_TEST) );
+
+    GL_CHECK(glBindFramebuffer     (GL_DRAW_FRAMEBUFFER,
+                                    blurringObjects.framebufferObjectId) );
+    GL_CHECK(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER,
+                                    GL_COLOR_ATTACHMENT0,
+                                    GL_TEXTURE_2D,
+                                    blurringObjects.textureObjectIdVertical,
+                                    0) );
+    GL_CHECK(glActiveTexture       (GL_TEXTURE0 + TEXTURE_UNIT_CONVOLVED_TEXTURE) );
+    GL_CHECK(glBindTexture         (GL_TEXTURE_2D,
+                                    fftConvolutionObjects.textureObjectIdsConvolved[0]) );
+    GL_CHECK(glDrawArrays          (GL_TRIANGLE_FAN, 0, 4) );
+
+    GL_CHECK(glBindFramebuffer     (GL_DRAW_FRAMEBUFFER,
+                                    strongerBlurObjects.framebufferObjectId) );
+    GL_CHECK(glBindTexture         (GL_TEXTURE_2D,
+                                    fftConvolutionObjects.textureObjectIdsConvolved[1]) );
+    GL_CHECK(glDrawArrays          (GL_TRIANGLE_FAN, 0, 4) );
+
+    GL_CHECK(glDisable(GL_SCISSOR_TEST) );
+    /* [FFT convolution blur] */
+}
+
 /** \brief Configure the scene rendering program's uniforms.
  *
  * \param locationsPtr   Pointer to structure object where uniform locations are stored.
@@ -1232,6 +2343,7 @@ static void setUniformValuesForSceneRenderingProgram(const SceneRenderingProgram
     const float lightQuadraticAttenuation = 0.05f;
     const float lightShininess            = 0.1f;
     const float lightStrength             = 0.01f;
+    const float lightCubeIntensity        = isHDREnabled ? HDR_LIGHT_CUBE_INTENSITY : 1.0f;
     bool        result                    = true;
 
     /* Set model-view-(projection) matrices. */
@@ -1262,6 +2374,180 @@ static void setUniformValuesForSceneRenderingProgram(const SceneRenderingProgram
     GL_CHECK(glUniform1f(locationsPtr->uniformLightPropertiesQuadraticAttenauation, lightQuadraticAttenuation) );
     GL_CHECK(glUniform1f(locationsPtr->uniformLightPropertiesShininess,             lightShininess) );
     GL_CHECK(glUniform1f(locationsPtr->uniformLightPropertiesStrength,              lightStrength) );
+    GL_CHECK(glUniform1f(locationsPtr->uniformLightCubeIntensity,                   lightCubeIntensity) );
+}
+
+/** \brief Retrieve locations and set constant uniform values for the program objects,
+ *         then render the scene and the luminance image. Called once all program objects have been built.
+ */
+static void setupProgramObjects()
+{
+    /* Both dual filter programs always sample the texture bound to the same texture unit. */
+    GL_CHECK(glUseProgram(dualFilterDownsampleProgramShaderObjects.programObjectId) );
+    {
+        dualFilterDownsampleTextureSamplerLocation = GL_CHECK(glGetUniformLocation(dualFilterDownsampleProgramShaderObjects.programObjectId,
+                                                                                   "texture_sampler") );
+
+        ASSERT(dualFilterDownsampleTextureSamplerLocation != -1);
+
+        GL_CHECK(glUniform1i(dualFilterDownsampleTextureSamplerLocation, TEXTURE_UNIT_DUAL_FILTER_TEXTURE) );
+    }
+
+    GL_CHECK(glUseProgram(dualFilterUpsampleProgramShaderObjects.programObjectId) );
+    {
+        dualFilterUpsampleTextureSamplerLocation = GL_CHECK(glGetUniformLocation(dualFilterUpsampleProgramShaderObjects.programObjectId,
+                                                                                 "texture_sampler") );
+
+        ASSERT(dualFilterUpsampleTextureSamplerLocation != -1);
+
+        GL_CHECK(glUniform1i(dualFilterUpsampleTextureSamplerLocation, TEXTURE_UNIT_DUAL_FILTER_TEXTURE) );
+    }
+
+    /* Set attribute/uniform values for program object responsible for scene rendering. */
+    GL_CHECK(glUseProgram(sceneRenderingProgramShaderObjects.programObjectId) );
+    {
+        /* Restore uniform locations for program object responsible for scene rendering. */
+        getLocationsForSceneRenderingProgram(sceneRenderingProgramShaderObjects.programObjectId,
+                                            &sceneRenderingProgramLocations);
+        /* Set values for uniforms, which are constant during rendering process. */
+        setUniformValuesForSceneRenderingProgram(&sceneRenderingProgramLocations,
+                                                  cameraViewMatrix,
+                                                  cameraViewProjectionMatrix,
+                                                  cameraPosition,
+                                                  lightPosition);
+        /* [Uniform block settings] */
+        /* Cube locations are constant during rendering process. Set them now. */
+        GL_CHECK(glUniformBlockBinding(sceneRenderingProgramShaderObjects.programObjectId,
+                                       sceneRenderingProgramLocations.uniformBlockCubeProperties,
+                                       0 ) );
+        GL_CHECK(glBindBufferBase     (GL_UNIFORM_BUFFER,
+                                       0,
+                                       sceneRenderingObjects.bufferObjectIdElementLocations) );
+        /* [Uniform block settings] */
+    }
+
+    /* [Define vertex attrib data array] */
+    /* Cube coordinates are constant during rendering process. Set them now. */
+    GL_CHECK(glBindBuffer         (GL_ARRAY_BUFFER,
+                                   sceneRenderingObjects.bufferObjectIdCubeCoords) );
+    GL_CHECK(glVertexAttribPointer(sceneRenderingProgramLocations.attribCubeVertexCoordinates,
+                                   NUMBER_OF_COMPONENTS_PER_VERTEX,
+                                   GL_FLOAT,
+                                   GL_FALSE,
+                                   0,
+                                   NULL) );
+    /* [Define vertex attrib data array] */
+    GL_CHECK(glBindBuffer         (GL_ARRAY_BUFFER,
+                                   sceneRenderingObjects.bufferObjectIdCubeNormals) );
+    GL_CHECK(glVertexAttribPointer(sceneRenderingProgramLocations.attribCubeVertexNormals,
+                                   NUMBER_OF_COMPONENTS_PER_VERTEX,
+                                   GL_FLOAT,
+                                   GL_FALSE,
+                                   0,
+                                   NULL) );
+
+    /* Enable VAAs. */
+    /* [Enable cube vertex coordinates attrib array] */
+    GL_CHECK(glEnableVertexAttribArray(sceneRenderingProgramLocations.attribCubeVertexCoordinates) );
+    /* [Enable cube vertex coordinates attrib array] */
+    GL_CHECK(glEnableVertexAttribArray(sceneRenderingProgramLocations.attribCubeVertexNormals) );
+
+    /* Retrieve uniform and attribute locations for program object responsible for applying blur effect. */
+    GL_CHECK(glUseProgram(blurringHorizontalProgramShaderObjects.programObjectId) );
+    {
+        getLocationsForBlurringProgram(blurringHorizontalProgramShaderObjects.programObjectId,
+                                      &blurringHorizontalProgramLocations);
+
+        /* Set values for uniforms which are constant during rendering process. */
+        GL_CHECK(glUniform1f(blurringHorizontalProgramLocations.uniformBlurRadius, BLUR_RADIUS) );
+    }
+
+    /* Retrieve uniform and attribute locations for program object responsible for applying blur effect. */
+    GL_CHECK(glUseProgram(blurringVerticalProgramShaderObjects.programObjectId) );
+    {
+        getLocationsForBlurringProgram(blurringVerticalProgramShaderObjects.programObjectId,
+                                      &blurringVerticalProgramLocations);
+
+        /* Set values for uniforms which are constant during rendering process. */
+        GL_CHECK(glUniform1f(blurringVerticalProgramLocations.uniformBlurRadius, BLUR_RADIUS) );
+    }
+
+    /* Retrieve uniform and attribute locations for program object responsible for applying blend effect. */
+    GL_CHECK(glUseProgram(blendingProgramShaderObjects.programObjectId) );
+    {
+        getLocationsForBlendingProgram(blendingProgramShaderObjects.programObjectId,
+                                      &blendingProgramLocations);
+
+        /* Set values for uniforms which are constant during rendering process. */
+        /* [Set original texture uniform value] */
+        GL_CHECK(glUniform1i(blendingProgramLocations.uniformOriginalTexture,     TEXTURE_UNIT_COLOR_TEXTURE) );
+        /* [Set original texture uniform value] */
+        GL_CHECK(glUniform1i(blendingProgramLocations.uniformStrongerBlurTexture, TEXTURE_UNIT_STRONGER_BLUR_TEXTURE) );
+        GL_CHECK(glUniform1i(blendingProgramLocations.uniformWeakerBlurTexture,   TEXTURE_UNIT_BLURRED_TEXTURE) );
+
+        if (isHDREnabled)
+        {
+            adaptedLuminanceTextureLocation = GL_CHECK(glGetUniformLocation(blendingProgramShaderObjects.programObjectId,
+                                                                            "adapted_luminance_texture") );
+
+            ASSERT(adaptedLuminanceTextureLocation != -1);
+
+            GL_CHECK(glUniform1i(adaptedLuminanceTextureLocation, TEXTURE_UNIT_ADAPTED_LUMINANCE_TEXTURE) );
+        }
+    }
+
+    if (bloomMode == BLOOM_MODE_FFT_CONVOLUTION)
+    {
+        /* The copy program always samples the texture bound to the same texture unit, and copies to the same region. */
+        GL_CHECK(glUseProgram(fftResolveProgramShaderObjects.programObjectId) );
+        {
+            fftResolveProgramLocations.uniformConvolvedTexture = GL_CHECK(glGetUniformLocation(fftResolveProgramShaderObjects.programObjectId, "convolved_texture") );
+            fftResolveProgramLocations.uniformRegionOffset     = GL_CHECK(glGetUniformLocation(fftResolveProgramShaderObjects.programObjectId, "region_offset") );
+            fftResolveProgramLocations.uniformRegionSize       = GL_CHECK(glGetUniformLocation(fftResolveProgramShaderObjects.programObjectId, "region_size") );
+
+            ASSERT(fftResolveProgramLocations.uniformConvolvedTexture != -1);
+            ASSERT(fftResolveProgramLocations.uniformRegionOffset     != -1);
+            ASSERT(fftResolveProgramLocations.uniformRegionSize       != -1);
+
+            GL_CHECK(glUniform1i(fftResolveProgramLocations.uniformConvolvedTexture, TEXTURE_UNIT_CONVOLVED_TEXTURE) );
+            GL_CHECK(glUniform2f(fftResolveProgramLocations.uniformRegionOffset,     (float) blurRegion[0], (float) blurRegion[1]) );
+            GL_CHECK(glUniform2f(fftResolveProgramLocations.uniformRegionSize,       (float) blurRegion[2], (float) blurRegion[3]) );
+        }
+    }
+
+    /* The model is not changing during the rendering process (the only thing that changes is the strength of the bloom effect).
+     * That is why it is enough to render the scene and the luminance image only once and then use them as an input for blooming
+     * and blurring functions in the next steps. */
+    /* The depth texture is only needed while the scene is rendered, it is released right after. */
+    frameGraph->clear();
+
+    int depth = frameGraph->addTarget("scene depth", windowWidth, windowHeight, GL_DEPTH_COMPONENT32F, GL_NEAREST);
+
+    frameGraph->write(frameGraph->addPass("scene"), depth);
+    ASSERT(frameGraph->compile() );
+
+    sceneRenderingObjects.textureObjectIdDepthImage = frameGraph->getTexture(depth);
+
+    renderSceneColourTexture();
+    renderDowscaledLuminanceTexture();
+
+    frameGraph->clear();
+    ASSERT(frameGraph->compile() );
+    frameGraph->releaseUnusedTextures();
+
+    sceneRenderingObjects.textureObjectIdDepthImage = 0;
+
+    /* Build the blur graph of every number of iterations once, so that the pool holds every texture they need
+     * and the graphs rebuilt while the effect animates never allocate. */
+    const int minNumberOfBlurPasses = (bloomMode == BLOOM_MODE_DUAL_FILTER) ? MIN_NUMBER_OF_DUAL_FILTER_LEVELS : MIN_NUMBER_OF_BLUR_PASSES;
+    const int maxNumberOfBlurPasses = (bloomMode == BLOOM_MODE_DUAL_FILTER) ? MAX_NUMBER_OF_DUAL_FILTER_LEVELS : MAX_NUMBER_OF_BLUR_PASSES;
+
+    for (int numberOfIterations = minNumberOfBlurPasses; numberOfIterations <= maxNumberOfBlurPasses; numberOfIterations++)
+    {
+        buildBlurFrameGraph(numberOfIterations);
+    }
+
+    frameGraph->log();
 }
 
 /** \brief Setup the environment: create and prepare objects for rendering purposes.
@@ -1271,6 +2557,161 @@ static void setUniformValuesForSceneRenderingProgram(const SceneRenderingProgram
  *
  *  \return True if successful, false otherwise.
  */
+/** \brief Compute the FFT convolution kernel which stands in for a number of blur iterations.
+ *         It is a gaussian, as wide as the one the blur passes add up to, with glare streaks
+ *         which get longer as the gaussian gets wider.
+ *
+ * \param numberOfIterations Number of blur iterations the kernel replaces.
+ * \param texelsPerSample    Distance between FFT samples, in texels of the bloom source.
+ * \param kernelSize         Width and height of the kernel, in FFT samples. Has to be odd.
+ * \param kernel             Deref will be used to store kernelSize * kernelSize weights, which add up to 1.
+ *                           Cannot be NULL.
+ */
+static void getGlareKernel(int numberOfIterations, float texelsPerSample, int kernelSize, float* kernel)
+{
+    ASSERT(kernel != NULL);
+
+    const float        deviation    = BLUR_PASS_STANDARD_DEVIATION * sqrtf( (float) numberOfIterations) / texelsPerSample;
+    const float        streakLength = 3.0f * deviation;
+    const float        streakWidth  = 0.75f;
+    const int          center       = kernelSize / 2;
+    std::vector<float> streaks(kernelSize * kernelSize);
+    float              gaussianSum  = 0.0f;
+    float              streakSum    = 0.0f;
+
+    for (int y = 0; y < kernelSize; y++)
+    {
+        for (int x = 0; x < kernelSize; x++)
+        {
+            const float dx    = (float) (x - center);
+            const float dy    = (float) (y - center);
+            const int   index = y * kernelSize + x;
+
+            kernel[index] = expf(-(dx * dx + dy * dy) / (2.0f * deviation * deviation) );
+            gaussianSum  += kernel[index];
+
+            /* Each streak fades out along its direction, and is a couple of samples wide across it.
+             * The first one is turned away from the axes, so it does not line up with the FFT rows. */
+            streaks[index] = 0.0f;
+
+            for (int streakIndex = 0; streakIndex < GLARE_NUMBER_OF_STREAKS; streakIndex++)
+            {
+                const float angle  = (streakIndex + 0.25f) * 2.0f * M_PI / GLARE_NUMBER_OF_STREAKS;
+                const float along  = dx * cosf(angle) + dy * sinf(angle);
+                const float across = dx * sinf(angle) - dy * cosf(angle);
+
+                if (along >= 0.0f)
+                {
+                    streaks[index] += expf(-along / streakLength - across * across / (2.0f * streakWidth * streakWidth) );
+                }
+            }
+
+            streakSum += streaks[index];
+        }
+    }
+
+    for (int index = 0; index < kernelSize * kernelSize; index++)
+    {
+        kernel[index] = (1.0f - GLARE_STRENGTH) * kernel[index] / gaussianSum + GLARE_STRENGTH * streaks[index] / streakSum;
+    }
+}
+
+/** \brief Create the FFT convolution, its kernels and the textures storing its results.
+ *         The blurred region has to be known already.
+ *         GLFFT reports errors with exceptions, in which case bloomMode falls back to the fragment shader blur.
+ */
+static void setupFFTConvolution()
+{
+    /* The FFT covers the blurred region and half of it again on each side.
+     * The kernels are not wider than that padding, so what the convolution wraps around never reaches the region. */
+    const GLint  windowOffsetX   = blurRegion[0] - blurRegion[2] / 2;
+    const GLint  windowOffsetY   = blurRegion[1] - blurRegion[3] / 2;
+    const GLint  windowSize      = 2 * blurRegion[2];
+    unsigned int fftSize         = 1;
+
+    while (fftSize < (unsigned int) blurRegion[2] && fftSize < FFT_CONVOLUTION_MAX_SIZE)
+    {
+        fftSize *= 2;
+    }
+
+    const float  texelsPerSample = (float) windowSize / fftSize;
+    const int    kernelSize      = fftSize / 2 + 1;
+    const float  textureWidth    = (float) (windowWidth  / WINDOW_RESOLUTION_DIVISOR);
+    const float  textureHeight   = (float) (windowHeight / WINDOW_RESOLUTION_DIVISOR);
+
+    try
+    {
+        GLFFT::FFTWisdom wisdom;
+
+        wisdom.set_static_wisdom(GLFFT::FFTWisdom::get_static_wisdom_from_renderer( (const char*) glGetString(GL_RENDERER) ) );
+
+        fftConvolutionObjects.convolution = new GLFFT::Convolution(fftSize,
+                                                                   fftSize,
+                                                                   std::make_shared<GLFFT::ProgramCache>(),
+                                                                   GLFFT::FFTOptions(),
+                                                                   wisdom);
+
+        /* The bloom source is sampled with linear filtering, so wide windows are downsampled on the way in. */
+        fftConvolutionObjects.convolution->set_texture_offset_scale( (windowOffsetX + 0.5f * texelsPerSample) / textureWidth,
+                                                                     (windowOffsetY + 0.5f * texelsPerSample) / textureHeight,
+                                                                     texelsPerSample / textureWidth,
+                                                                     texelsPerSample / textureHeight);
+
+        /* The spectra of all kernels are cached, changing the effect strength then costs no more than keeping it. */
+        std::vector<float> kernel(kernelSize * kernelSize);
+
+        for (int numberOfIterations  = MIN_NUMBER_OF_BLUR_PASSES - 1;
+                 numberOfIterations <= MAX_NUMBER_OF_BLUR_PASSES;
+                 numberOfIterations++)
+        {
+            getGlareKernel(numberOfIterations, texelsPerSample, kernelSize, &kernel[0]);
+
+            fftConvolutionObjects.convolution->add_kernel(&kernel[0], kernelSize, kernelSize);
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        LOGI("FFT convolution is not available (%s), falling back to the fragment shader blur.", exception.what() );
+
+        delete fftConvolutionObjects.convolution;
+
+        fftConvolutionObjects.convolution = NULL;
+        bloomMode                         = BLOOM_MODE_SEPARABLE_BLUR;
+
+        return;
+    }
+
+    /* Created on their own texture unit, so the bindings set up for blending are left alone. */
+    GL_CHECK(glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_CONVOLVED_TEXTURE) );
+    GL_CHECK(glGenTextures(2, fftConvolutionObjects.textureObjectIdsConvolved) );
+
+    for (int textureIndex = 0; textureIndex < 2; textureIndex++)
+    {
+        GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
+                                 fftConvolutionObjects.textureObjectIdsConvolved[textureIndex]) );
+        GL_CHECK(glTexStorage2D (GL_TEXTURE_2D,
+                                 1,
+                                 GL_RGBA16F,
+                                 fftSize,
+                                 fftSize) );
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
+                                 GL_TEXTURE_WRAP_S,
+                                 GL_CLAMP_TO_EDGE) );
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
+                                 GL_TEXTURE_WRAP_T,
+                                 GL_CLAMP_TO_EDGE) );
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
+                                 GL_TEXTURE_MAG_FILTER,
+                                 GL_LINEAR) );
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
+                                 GL_TEXTURE_MIN_FILTER,
+                                 GL_LINEAR) );
+    }
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D,
+                           0) );
+}
+
 void setupGraphics(int width, int height)
 {
     float cameraDepthPosition = 0.0f;
@@ -1320,9 +2761,12 @@ void setupGraphics(int width, int height)
     initializeProgramObject(&sceneRenderingProgramShaderObjects,
                              renderSceneFragmentShaderSource,
                              renderSceneVertexShaderSource);
-    /* Create program object responsible for blending. */
+    /* The texture formats and the blending program depend on whether the scene can be rendered with high dynamic range. */
+    setupTextureFormats();
+
+    /* Create program object responsible for blending. With high dynamic range, it also applies the exposure and tonemaps. */
     initializeProgramObject(&blendingProgramShaderObjects,
-                             blendFragmentShaderSource,
+                             isHDREnabled ? hdrBlendFragmentShaderSource : blendFragmentShaderSource,
                              renderTextureVertexShaderSource);
     /* Create program object responsible for blurring (horizontal blur). */
     initializeProgramObject(&blurringHorizontalProgramShaderObjects,
@@ -1332,6 +2776,13 @@ void setupGraphics(int width, int height)
     initializeProgramObject(&blurringVerticalProgramShaderObjects,
                              blurVerticalFragmentShaderSource,
                              renderTextureVertexShaderSource );
+    /* Create program objects responsible for the dual filter blur. */
+    initializeProgramObject(&dualFilterDownsampleProgramShaderObjects,
+                             dualFilterDownsampleFragmentShaderSource,
+                             renderTextureVertexShaderSource);
+    initializeProgramObject(&dualFilterUpsampleProgramShaderObjects,
+                             dualFilterUpsampleFragmentShaderSource,
+                             renderTextureVertexShaderSource);
     /* Create program object responsible for generating luminance image that will be then bloomed. */
     initializeProgramObject(&getLuminanceImageProgramShaderObjects,
                              getLuminanceImageFragmentShaderSource,
@@ -1372,102 +2823,21 @@ void setupGraphics(int width, int height)
     /* [Uniform buffer with cube locations] */
 
     /* Generate objects which will be used for scene rendering. */
+    frameGraph = new FrameGraph("Bloom");
+
     generateAndPrepareObjectsUsedForSceneRendering(&sceneRenderingObjects.framebufferObjectId,
-                                                   &sceneRenderingObjects.textureObjectIdOriginalImage,
-                                                   &sceneRenderingObjects.textureObjectIdDepthImage);
+                                                   &sceneRenderingObjects.textureObjectIdOriginalImage);
 
     /* Generate objects which will be used for applying blur effect. */
     generateAndPrepareObjectsUsedForBlurring(&blurringObjects.framebufferObjectId,
-                                             &blurringObjects.textureObjectIdHorizontal,
                                              &blurringObjects.textureObjectIdVertical);
     /* Generate objects that will be used for rendering into downscaled texture. */
     generateDownscaledObjects(&getLuminanceImageBloomObjects.framebufferObjectId,
                               &getLuminanceImageBloomObjects.textureObjectId);
     generateDownscaledObjects(&strongerBlurObjects.framebufferObjectId,
                               &strongerBlurObjects.textureObjectId);
-
-    /* Set attribute/uniform values for program object responsible for scene rendering. */
-    GL_CHECK(glUseProgram(sceneRenderingProgramShaderObjects.programObjectId) );
-    {
-        /* Restore uniform locations for program object responsible for scene rendering. */
-        getLocationsForSceneRenderingProgram(sceneRenderingProgramShaderObjects.programObjectId,
-                                            &sceneRenderingProgramLocations);
-        /* Set values for uniforms, which are constant during rendering process. */
-        setUniformValuesForSceneRenderingProgram(&sceneRenderingProgramLocations,
-                                                  cameraViewMatrix,
-                                                  cameraViewProjectionMatrix,
-                                                  cameraPosition,
-                                                  lightPosition);
-        /* [Uniform block settings] */
-        /* Cube locations are constant during rendering process. Set them now. */
-        GL_CHECK(glUniformBlockBinding(sceneRenderingProgramShaderObjects.programObjectId,
-                                       sceneRenderingProgramLocations.uniformBlockCubeProperties,
-                                       0 ) );
-        GL_CHECK(glBindBufferBase     (GL_UNIFORM_BUFFER,
-                                       0,
-                                       sceneRenderingObjects.bufferObjectIdElementLocations) );
-        /* [Uniform block settings] */
-    }
-
-    /* [Define vertex attrib data array] */
-    /* Cube coordinates are constant during rendering process. Set them now. */
-    GL_CHECK(glBindBuffer         (GL_ARRAY_BUFFER,
-                                   sceneRenderingObjects.bufferObjectIdCubeCoords) );
-    GL_CHECK(glVertexAttribPointer(sceneRenderingProgramLocations.attribCubeVertexCoordinates,
-                                   NUMBER_OF_COMPONENTS_PER_VERTEX,
-                                   GL_FLOAT,
-                                   GL_FALSE,
-                                   0,
-                                   NULL) );
-    /* [Define vertex attrib data array] */
-    GL_CHECK(glBindBuffer         (GL_ARRAY_BUFFER,
-                                   sceneRenderingObjects.bufferObjectIdCubeNormals) );
-    GL_CHECK(glVertexAttribPointer(sceneRenderingProgramLocations.attribCubeVertexNormals,
-                                   NUMBER_OF_COMPONENTS_PER_VERTEX,
-                                   GL_FLOAT,
-                                   GL_FALSE,
-                                   0,
-                                   NULL) );
-
-    /* Enable VAAs. */
-    /* [Enable cube vertex coordinates attrib array] */
-    GL_CHECK(glEnableVertexAttribArray(sceneRenderingProgramLocations.attribCubeVertexCoordinates) );
-    /* [Enable cube vertex coordinates attrib array] */
-    GL_CHECK(glEnableVertexAttribArray(sceneRenderingProgramLocations.attribCubeVertexNormals) );
-
-    /* Retrieve uniform and attribute locations for program object responsible for applying blur effect. */
-    GL_CHECK(glUseProgram(blurringHorizontalProgramShaderObjects.programObjectId) );
-    {
-        getLocationsForBlurringProgram(blurringHorizontalProgramShaderObjects.programObjectId,
-                                      &blurringHorizontalProgramLocations);
-
-        /* Set values for uniforms which are constant during rendering process. */
-        GL_CHECK(glUniform1f(blurringHorizontalProgramLocations.uniformBlurRadius, BLUR_RADIUS) );
-    }
-
-    /* Retrieve uniform and attribute locations for program object responsible for applying blur effect. */
-    GL_CHECK(glUseProgram(blurringVerticalProgramShaderObjects.programObjectId) );
-    {
-        getLocationsForBlurringProgram(blurringVerticalProgramShaderObjects.programObjectId,
-                                      &blurringVerticalProgramLocations);
-
-        /* Set values for uniforms which are constant during rendering process. */
-        GL_CHECK(glUniform1f(blurringVerticalProgramLocations.uniformBlurRadius, BLUR_RADIUS) );
-    }
-
-    /* Retrieve uniform and attribute locations for program object responsible for applying blend effect. */
-    GL_CHECK(glUseProgram(blendingProgramShaderObjects.programObjectId) );
-    {
-        getLocationsForBlendingProgram(blendingProgramShaderObjects.programObjectId,
-                                      &blendingProgramLocations);
-
-        /* Set values for uniforms which are constant during rendering process. */
-        /* [Set original texture uniform value] */
-        GL_CHECK(glUniform1i(blendingProgramLocations.uniformOriginalTexture,     TEXTURE_UNIT_COLOR_TEXTURE) );
-        /* [Set original texture uniform value] */
-        GL_CHECK(glUniform1i(blendingProgramLocations.uniformStrongerBlurTexture, TEXTURE_UNIT_STRONGER_BLUR_TEXTURE) );
-        GL_CHECK(glUniform1i(blendingProgramLocations.uniformWeakerBlurTexture,   TEXTURE_UNIT_BLURRED_TEXTURE) );
-    }
+    /* Generate objects which will be used for the dual filter blur. */
+    generateDualFilterObjects(&dualFilterObjects);
 
     /* Set up texture unit bindings. */
     /* [Bind colour texture object to specific binding point] */
@@ -1480,9 +2850,6 @@ void setupGraphics(int width, int height)
     GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
                              getLuminanceImageBloomObjects.textureObjectId) );
     /* [Bind bloom source texture object to specific binding point] */
-    GL_CHECK(glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_HORIZONTAL_BLUR_TEXTURE) );
-    GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
-                             blurringObjects.textureObjectIdHorizontal) );
     GL_CHECK(glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_BLURRED_TEXTURE) );
     GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
                              blurringObjects.textureObjectIdVertical) );
@@ -1515,11 +2882,47 @@ void setupGraphics(int width, int height)
 
     GL_CHECK(glScissor(x, y, scissorBoxWidth, scissorBoxHeight));
 
-    /* The model is not changing during the rendering process (the only thing that changes is the strength of the bloom effect).
-     * That is why it is enough to render the scene and the luminance image only once and then use them as an input for blooming
-     * and blurring functions in the next steps. */
-    renderSceneColourTexture();
-    renderDowscaledLuminanceTexture();
+    /* The compute blur only processes the same region. */
+    blurRegion[0] = x;
+    blurRegion[1] = y;
+    blurRegion[2] = scissorBoxWidth;
+    blurRegion[3] = scissorBoxHeight;
+
+    if ((bloomMode == BLOOM_MODE_COMPUTE_BLUR || bloomMode == BLOOM_MODE_FFT_CONVOLUTION) && !isComputeShaderSupported())
+    {
+        LOGI("Compute shaders are not supported, falling back to the fragment shader blur.");
+
+        bloomMode = BLOOM_MODE_SEPARABLE_BLUR;
+    }
+
+    if (bloomMode == BLOOM_MODE_COMPUTE_BLUR)
+    {
+        /* The compute program is not queued, as the queue only builds vertex and fragment shader programs. */
+        setupComputeBlurProgram();
+    }
+
+    if (bloomMode == BLOOM_MODE_FFT_CONVOLUTION)
+    {
+        /* GLFFT builds its compute programs right away, only the copy program is queued. */
+        setupFFTConvolution();
+    }
+
+    /* Checked again, setupFFTConvolution() falls back to the fragment shader blur if GLFFT fails. */
+    if (bloomMode == BLOOM_MODE_FFT_CONVOLUTION)
+    {
+        initializeProgramObject(&fftResolveProgramShaderObjects,
+                                 fftResolveFragmentShaderSource,
+                                 renderTextureVertexShaderSource);
+    }
+
+    if (isHDREnabled)
+    {
+        /* Left bound to its own texture unit, for the blending pass. */
+        setupAutoExposure();
+    }
+
+    /* Start building the program objects, they are set up in renderFrame() once they are ready. */
+    programCompileQueue.submit();
 }
 
 /** \brief Render one frame.
@@ -1528,6 +2931,22 @@ void setupGraphics(int width, int height)
  */
 void renderFrame (float time)
 {
+    if (!areProgramsReady)
+    {
+        /* Show an empty frame instead of stalling until the program objects have been built. */
+        if (!programCompileQueue.isComplete())
+        {
+            GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT) );
+
+            return;
+        }
+
+        programCompileQueue.finish();
+        setupProgramObjects();
+
+        areProgramsReady = true;
+    }
+
     /* True:  if scene should be updated (number of blur iterations changes),
      * False: if there is no need to update the scene, but blend operations
      *        will use updated mix factor value.
@@ -1538,7 +2957,9 @@ void renderFrame (float time)
     int       blurEffectDirection       = BLUR_EFFECT_INCREASE;
     int       currentNumberOfIterations = 0;
     float     mixFactor                 = 0.0f;
-    const int numberOfBlurPasses        = (MAX_NUMBER_OF_BLUR_PASSES - MIN_NUMBER_OF_BLUR_PASSES + 1) * 2;
+    const int minNumberOfBlurPasses     = (bloomMode == BLOOM_MODE_DUAL_FILTER) ? MIN_NUMBER_OF_DUAL_FILTER_LEVELS : MIN_NUMBER_OF_BLUR_PASSES;
+    const int maxNumberOfBlurPasses     = (bloomMode == BLOOM_MODE_DUAL_FILTER) ? MAX_NUMBER_OF_DUAL_FILTER_LEVELS : MAX_NUMBER_OF_BLUR_PASSES;
+    const int numberOfBlurPasses        = (maxNumberOfBlurPasses - minNumberOfBlurPasses + 1) * 2;
     int       nOfIterations             =  0;
     int       timeIntervalIndex         = 0;
 
@@ -1566,7 +2987,7 @@ void renderFrame (float time)
     }
 
     mixFactor                 = (time - ((int)(time / TIME_INTERVAL) * TIME_INTERVAL)) / TIME_INTERVAL;
-    currentNumberOfIterations = MIN_NUMBER_OF_BLUR_PASSES + nOfIterations;
+    currentNumberOfIterations = minNumberOfBlurPasses + nOfIterations;
 
     if (blurEffectDirection == BLUR_EFFECT_DECREASE)
     {
@@ -1582,8 +3003,27 @@ void renderFrame (float time)
     lastNumberOfIterations = currentNumberOfIterations;
     /* [Mix factor calculations] */
 
-    /* Update the scene only if needed. */
+    /* The transient targets of the blur depend on the number of iterations. */
     if (shouldSceneBeUpdated)
+    {
+        buildBlurFrameGraph(currentNumberOfIterations);
+    }
+
+    /* Update the scene only if needed. */
+    if (shouldSceneBeUpdated && bloomMode == BLOOM_MODE_DUAL_FILTER)
+    {
+        /* In dual filter mode, the number of iterations is the number of levels. */
+        renderDualFilterBlur(currentNumberOfIterations);
+    }
+    else if (shouldSceneBeUpdated && bloomMode == BLOOM_MODE_COMPUTE_BLUR)
+    {
+        renderComputeBlur(currentNumberOfIterations);
+    }
+    else if (shouldSceneBeUpdated && bloomMode == BLOOM_MODE_FFT_CONVOLUTION)
+    {
+        renderFFTConvolutionBlur(currentNumberOfIterations);
+    }
+    else if (shouldSceneBeUpdated)
     {
         /* [Blur loop] */
         /* Apply the blur effect.
@@ -1679,25 +3119,39 @@ void renderFrame (float time)
         /* [Blur loop] */
     } /* if (shouldSceneBeUpdated) */
 
+    if (isHDREnabled)
+    {
+        /* The scene does not change, but the exposure keeps adapting to it. */
+        renderAutoExposure(time - lastFrameTime);
+    }
+
+    lastFrameTime = time;
+
     /* [Blending] */
     /* Apply blend effect.
      * Take the original scene texture and blend it with texture that contains the total blurring effect.
      */
     GL_CHECK(glUseProgram(blendingProgramShaderObjects.programObjectId) );
     {
-        /* Bind the default framebuffer object. That indicates that the result is to be drawn to the back buffer. */
-        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0) );
-        /* Set viewport values so that the rendering will take whole screen space. */
-        GL_CHECK(glViewport(0, 0, windowWidth, windowHeight) );
+        /* The quad covers the whole back buffer, so its colour does not need clearing. Depth is never needed afterwards. */
+        RenderPass blendingPass(0, windowWidth, windowHeight);
+
+        blendingPass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_DONT_CARE, RenderPass::STORE_OP_STORE,      4);
+        blendingPass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR,     RenderPass::STORE_OP_DONT_CARE, 4);
+
+        /* Bind the default framebuffer object. That indicates that the result is to be drawn to the back buffer.
+         * Viewport values are set so that the rendering will take whole screen space. */
+        blendingPass.begin();
         /* Set uniform value. */
         GL_CHECK(glUniform1f(blendingProgramLocations.uniformMixFactor, mixFactor) ); /* Current mixFactor will be used for mixing two textures color values
                                                                                        * (texture with higher and lower blur effect value). */
-        /* Clear framebuffer content. */
-        GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT) );
         /* Draw texture. */
         GL_CHECK(glDrawArrays(GL_TRIANGLE_FAN, 0, 4) );
+        blendingPass.end();
     }
     /* [Blending] */
+
+    RenderPass::endFrame();
 }
 
 /** \brief Delete created objects and free allocated memory.
@@ -1705,6 +3159,9 @@ void renderFrame (float time)
  */
 void uninit()
 {
+    /* Wait for any program objects still being built, they are about to be deleted. */
+    programCompileQueue.finish();
+
     /* Destroy created objects. */
     GL_CHECK(glUseProgram     (0) );
     GL_CHECK(glBindBuffer     (GL_ARRAY_BUFFER,
@@ -1726,19 +3183,45 @@ void uninit()
     GL_CHECK(glBindTexture    (GL_TEXTURE_2D,
                                0) );
     GL_CHECK(glActiveTexture  (GL_TEXTURE0 + TEXTURE_UNIT_STRONGER_BLUR_TEXTURE) );
+    GL_CHECK(glBindTexture    (GL_TEXTURE_2D,
+                               0) );
+    GL_CHECK(glActiveTexture  (GL_TEXTURE0 + TEXTURE_UNIT_DUAL_FILTER_TEXTURE) );
+    GL_CHECK(glBindTexture    (GL_TEXTURE_2D,
+                               0) );
+    GL_CHECK(glActiveTexture  (GL_TEXTURE0 + TEXTURE_UNIT_CONVOLVED_TEXTURE) );
+    GL_CHECK(glBindTexture    (GL_TEXTURE_2D,
+                               0) );
+    GL_CHECK(glActiveTexture  (GL_TEXTURE0 + TEXTURE_UNIT_ADAPTED_LUMINANCE_TEXTURE) );
     GL_CHECK(glBindTexture    (GL_TEXTURE_2D,
                                0) );
 
+    deleteAutoExposureObjects          (&autoExposureObjects);
     deleteBlurringObjects              (&blurringObjects);
+    deleteDualFilterObjects            (&dualFilterObjects);
+    deleteFFTConvolutionObjects        (&fftConvolutionObjects);
     deleteGetLuminanceImageBloomObjects(&getLuminanceImageBloomObjects);
     deleteProgramShaderObjects         (&blendingProgramShaderObjects);
     deleteProgramShaderObjects         (&blurringHorizontalProgramShaderObjects);
     deleteProgramShaderObjects         (&blurringVerticalProgramShaderObjects);
+    deleteProgramShaderObjects         (&dualFilterDownsampleProgramShaderObjects);
+    deleteProgramShaderObjects         (&dualFilterUpsampleProgramShaderObjects);
+    deleteProgramShaderObjects         (&fftResolveProgramShaderObjects);
+
+    GL_CHECK(glDeleteShader (computeBlurShaderObjectId) );
+    GL_CHECK(glDeleteProgram(computeBlurProgramObjectId) );
+
+    computeBlurShaderObjectId  = 0;
+    computeBlurProgramObjectId = 0;
     deleteProgramShaderObjects         (&getLuminanceImageProgramShaderObjects);
     deleteProgramShaderObjects         (&sceneRenderingProgramShaderObjects);
     deleteSceneRenderingObjects        (&sceneRenderingObjects);
     deleteStrongerBlurObjects          (&strongerBlurObjects);
 
+    /* The transient targets go with the frame graph. */
+    delete frameGraph;
+
+    frameGraph = NULL;
+
     /* Free allocated memory. */
     if (cubeCoordinates != NULL)
     {
@@ -0,0 +1,38 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GLFFT_API_HEADERS__
+#define GLFFT_API_HEADERS__
+
+#include <GLES3/gl31.h>
+
+#include "CubeModel.h"
+#include "Shader.h"
+
+/* GLFFT is used by the FFT convolution bloom mode, see GLFFTInterface.cpp. */
+bool   glfftReadFileString(const char* path, char** outBuffer);
+double glfftGetTime();
+
+#define GLFFT_LOG_OVERRIDE LOGI
+#define GLFFT_READ_FILE_STRING_OVERRIDE glfftReadFileString
+#define GLFFT_TIME_OVERRIDE glfftGetTime
+#define GLFFT_GLSL_LANG_STRING "#version 310 es\n"
+
+#endif
@@ -20,20 +20,39 @@
 
 package com.arm.malideveloper.openglessdk.bloom;
 
+import java.io.File;
+import java.io.InputStream;
+import java.io.RandomAccessFile;
 import android.os.Bundle;
 import android.app.Activity;
+import android.content.res.AssetManager;
 import android.util.Log;
 
 public class Bloom extends Activity
 {
-    private static String LOGTAG = "Bloom";
-    protected TutorialView tutorialView;
+    private static android.content.Context applicationContext = null;
+    private static String                  assetsDirectory    = null;
+    private static String                  LOGTAG             = "Bloom";
+    protected TutorialView                 tutorialView;
     
     @Override protected void onCreate(Bundle savedInstanceState)
     {
         super.onCreate(savedInstanceState);
         Log.i(LOGTAG, "Creating New Tutorial View");
         tutorialView = new TutorialView(getApplication());
+
+        /* The FFT convolution bloom mode loads the GLFFT shaders from files. */
+        applicationContext = getApplicationContext();
+        assetsDirectory    = applicationContext.getFilesDir().getPath() + "/";
+
+        extractAsset("fft_common.comp");
+        extractAsset("fft_main.comp");
+        extractAsset("fft_radix4.comp");
+        extractAsset("fft_radix8.comp");
+        extractAsset("fft_radix16.comp");
+        extractAsset("fft_radix64.comp");
+        extractAsset("fft_shared.comp");
+
         setContentView(tutorialView);
     }
     @Override protected void onPause()
@@ -50,4 +69,39 @@ public class Bloom extends Activity
     {
         super.onDestroy();
     }
-}
\ No newline at end of file
+
+    private void extractAsset(String assetName)
+    {
+        File file = new File(assetsDirectory + assetName);
+
+        if(file.exists()) {
+            Log.d(LOGTAG, assetName +  " already exists. No extraction needed.\n");
+        } else {
+            Log.d(LOGTAG, assetName + " doesn't exist. Extraction needed. \n");
+
+            try {
+                RandomAccessFile randomAccessFile = new RandomAccessFile(assetsDirectory + assetName,"rw");
+                AssetManager     assetManager     = applicationContext.getResources().getAssets();
+                InputStream      inputStream      = assetManager.open(assetName);
+
+                byte buffer[] = new byte[1024];
+                int count     = inputStream.read(buffer, 0, 1024);
+
+                while (count > 0) {
+                    randomAccessFile.write(buffer, 0, count);
+
+                    count = inputStream.read(buffer, 0, 1024);
+                }
+
+                randomAccessFile.close();
+                inputStream.close();
+            } catch(Exception e) {
+                Log.e(LOGTAG, "Failure in extractAssets(): " + e.toString() + " " + assetsDirectory + assetName);
+            }
+
+            if(file.exists()) {
+                Log.d(LOGTAG,"File extracted successfully");
+            }
+        }
+    }
+}
@@ -23,6 +23,8 @@
 
 namespace MaliSDK
 {
+    /** Directory the shader files are named in, they are read from the APK with AssetFile. */
+    #define ASSET_DIRECTORY ("/data/data/com.arm.malideveloper.openglessdk.boids/files/")
     /** Name of a fragment shader file. */
     #define FRAGMENT_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.boids/files/fragment_shader_source.frag")
     /** Name of a vertex shader file. */
@@ -31,5 +33,17 @@ namespace MaliSDK
     #define MOVEMENT_FRAGMENT_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.boids/files/movement.frag")
     /** Name of a movement vertex shader file. */
     #define MOVEMENT_VERTEX_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.boids/files/movement.vert")
+    /** Name of a vertex shader file drawing spheres from an instanced attribute. */
+    #define INSTANCED_VERTEX_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.boids/files/vertex_shader_instanced.vert")
+    /** Name of a compute shader file counting boids in each spatial hash bucket. */
+    #define GRID_COUNT_COMPUTE_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.boids/files/boids_grid_count.comp")
+    /** Name of a compute shader file computing the start of each spatial hash bucket. */
+    #define GRID_SCAN_COMPUTE_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.boids/files/boids_grid_scan.comp")
+    /** Name of a compute shader file sorting boids by spatial hash bucket. */
+    #define GRID_SCATTER_COMPUTE_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.boids/files/boids_grid_scatter.comp")
+    /** Name of a movement compute shader file. */
+    #define MOVEMENT_COMPUTE_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.boids/files/boids_movement.comp")
+    /** Name of a compute shader file sorting boids by level of detail. */
+    #define LEVEL_OF_DETAIL_COMPUTE_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.boids/files/boids_level_of_detail.comp")
 }
 #endif /* BOIDS_H */
@@ -24,7 +24,7 @@
 #include <android/log.h>
 #include <cstdio>
 #include <cstdlib>
-#include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
 
     #define LOG_TAG "libNative"
     #define LOGD(...) __android_log_print(ANDROID_LOG_DEBBUG, LOG_TAG, __VA_ARGS__)
@@ -33,16 +33,25 @@
  * transferred back to the CPU. Transform feedback buffers are used to store the output of the
  * movement vertex shader, this data is then used as the input data on the next pass.
  * The same data is used when rendering the scene.
+ *
+ * On OpenGL ES 3.1, a much larger flock is simulated by compute shaders instead. Boids are sorted into
+ * a spatial hash grid each frame, so each boid only looks for close neighbours in the grid cells around it
+ * rather than through the whole flock.
  */
 #include <jni.h>
+#include <android/asset_manager_jni.h>
 #include <android/log.h>
 
-#include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
+#include "AssetFile.h"
 #include "Boids.h"
 #include "Common.h"
+#include "Random.h"
 #include "Shader.h"
 #include "SphereModel.h"
 #include "Timer.h"
+#include <math.h>
+#include <string.h>
 #include <stdlib.h>
 using namespace MaliSDK;
 
@@ -66,17 +75,47 @@ GLuint movementVertexShaderId = 0;
 /* Program name. */
 GLuint movementProgramId = 0;
 
+/* Programs used for simulating the flock with compute shaders, instead of the movement program. */
+/* Compute shader names. */
+GLuint gridCountShaderId       = 0;
+GLuint gridScanShaderId        = 0;
+GLuint gridScatterShaderId     = 0;
+GLuint computeMovementShaderId = 0;
+/* Program names. */
+GLuint gridCountProgramId       = 0;
+GLuint gridScanProgramId        = 0;
+GLuint gridScatterProgramId     = 0;
+GLuint computeMovementProgramId = 0;
+/* Compute shader name. */
+GLuint levelOfDetailShaderId = 0;
+/* Program name. */
+GLuint levelOfDetailProgramId = 0;
+
 /* Spheres. */
+/* Number of sphere meshes of decreasing detail. The first one is used unless level of detail is selected per sphere. */
+const int numberOfLevelsOfDetail = 3;
 /* A sphere consists of \param numberOfSamples circles and \param numberOfSamples points lying on one circle. */
-const int numberOfSamples = 20;
+const int numberOfSamples[numberOfLevelsOfDetail] = {20, 12, 6};
+/* Radius of the spheres. */
+const float sphereRadius = 10.0f;
 /* Number of spheres that are drawn on a screen. */
 const int numberOfSpheresToGenerate = 30;
-/* Number of coordinates written to sphereTrianglesCoordinates array*/
-int numberOfSphereTriangleCoordinates = 0;
-/* Number of points written to sphereTrianglesCoordinates array*/
-int numberOfSphereTrianglePoints = 0;
-/* Array holding coordinates of triangles which a sphere consists of. */
-float* sphereTrianglesCoordinates = NULL;
+/* Number of spheres that are drawn on a screen when they are simulated by compute shaders. */
+const int numberOfComputeSpheres = 4096;
+/* Number of spheres actually simulated and drawn. */
+int numberOfSpheres = numberOfSpheresToGenerate;
+/* Number of coordinates written to sphereCoordinates array. */
+int numberOfSphereCoordinates = 0;
+/* Array holding coordinates of points which the spheres of all levels of detail consist of. */
+float* sphereCoordinates = NULL;
+/* Number of indices written to sphereIndices array. */
+int numberOfSphereIndices = 0;
+/* Array holding indices of triangles which the spheres of all levels of detail consist of. */
+unsigned short* sphereIndices = NULL;
+/* Number of indices making up the sphere of each level of detail. */
+int sphereIndexCounts[numberOfLevelsOfDetail] = {0};
+/* Index in sphereIndices array of the first triangle of the sphere of each level of detail. */
+int sphereFirstIndices[numberOfLevelsOfDetail] = {0};
 /* Size of vertexColors array. */
 int colorArraySize = 0;
 /* Array holding color values for each vertex of sphere triangle. */
@@ -103,25 +142,75 @@ GLint scalingMatrixLocation = 0;
 GLint sphereVertexColorLocation = 0;
 /* "Time" shader uniform is used to hold timer value. timeLocation provides information about the uniform's location. */
 GLint timeLocation = 0;
+/* Location of the "time" uniform of the movement compute shader. */
+GLint computeTimeLocation = 0;
+/* "Location" per-instance shader attribute's location, used when spheres are simulated by compute shaders. */
+GLint instanceLocationLocation = 0;
+/* "Leader instance" shader uniform's location. Tells which instance of a draw call is the leader, if any. */
+GLint leaderInstanceLocation = 0;
 
 /* Buffer objects. */
 /* If true - ping buffer object is used as transform feedback output. Otherwise pong buffer object should be used. */
 bool usePingBufferForTransformFeedbackOutput = true;
 /* Constant telling number of buffer objects that should be generated. */
-const GLuint numberOfBufferObjectIds = 4;
+const GLuint numberOfBufferObjectIds = 5;
 /* Array of buffer object names. */
 GLuint bufferObjectIds[numberOfBufferObjectIds] = {0};
 /* There are 4 coordinates for each uniform, and 2 uniforms (location and velocity) for each sphere. */
 const int spherePositionsAndVelocitiesLength = 4 * 2 * numberOfSpheresToGenerate;
 /* Name of buffer object which holds color of triangle vertices. */
 GLuint sphereColorsBufferObjectId  = 0;
-/* Name of buffer object which holds coordinates of triangles making sphere. */
+/* Name of buffer object which holds coordinates of points making sphere. */
 GLuint sphereCoordinatesBufferObjectId = 0;
+/* Name of buffer object which holds indices of triangles making sphere. */
+GLuint sphereIndicesBufferObjectId = 0;
 /* Name of buffer object which holds newly generated data containing location and velocity of spheres. */
 GLuint spherePingPositionAndVelocityBufferObjectId = 0;
 /* Name of buffer object which holds location and velocity data from previous iteration. */
 GLuint spherePongPositionAndVelocityBufferObjectId = 0;
 
+/* Compute shader simulation. */
+/* If true - spheres are simulated by compute shaders (OpenGL ES 3.1), otherwise by transform feedback. */
+bool useComputeShaders = false;
+/* Number of buckets in the spatial hash table. Has to be a power of two, and a multiple of the scan work group size. */
+const GLuint hashTableSize = 8192;
+/* Number of invocations in a work group of the per-sphere compute shaders. */
+const GLuint computeWorkGroupSize = 128;
+/* Constant telling number of buffer objects that should be generated for the compute shaders. */
+const GLuint numberOfComputeBufferObjectIds = 7;
+/* Array of buffer object names used by the compute shaders. */
+GLuint computeBufferObjectIds[numberOfComputeBufferObjectIds] = {0};
+/* Name of buffer object which holds location and velocity of each sphere, interleaved. Updated in place. */
+GLuint boidsBufferObjectId = 0;
+/* Name of buffer object which holds the number of spheres in each hash table bucket. */
+GLuint cellCountsBufferObjectId = 0;
+/* Name of buffer object which holds the sums of locations and velocities of the flock, followed by the start of each bucket. */
+GLuint gridBufferObjectId = 0;
+/* Name of buffer object which holds the index of each sphere within its bucket. */
+GLuint boidRanksBufferObjectId = 0;
+/* Name of buffer object which holds copies of the spheres, sorted by bucket. */
+GLuint sortedBoidsBufferObjectId = 0;
+
+/* Level of detail selection. */
+/* If true - mesh detail is selected per sphere from its distance to the camera. Otherwise the most detailed mesh is drawn straight from boidsBufferObjectId. */
+const bool useLevelOfDetail = true;
+/* Radius of a sphere on screen, in pixels, below which a less detailed mesh is drawn. */
+const float levelOfDetailPixelRadii[numberOfLevelsOfDetail - 1] = {16.0f, 6.0f};
+/* Name of buffer object which holds locations of the spheres drawn with each level of detail. */
+GLuint levelOfDetailInstancesBufferObjectId = 0;
+/* Name of buffer object which holds an indirect draw command for each level of detail. */
+GLuint levelOfDetailDrawCommandsBufferObjectId = 0;
+/* Number of values in a DrawElementsIndirectCommand structure. */
+const int drawCommandSize = 5;
+/* Draw commands written to levelOfDetailDrawCommandsBufferObjectId at the start of each frame, with no spheres but the leader. */
+GLuint levelOfDetailDrawCommandsReset[numberOfLevelsOfDetail * drawCommandSize] = {0};
+/* "Camera vector" and "level of detail distances" uniforms' locations of the level of detail compute shader. */
+GLint levelOfDetailCameraVectorLocation = 0;
+GLint levelOfDetailDistancesLocation    = 0;
+
+/* Vertex array object name. Indirect draws cannot use the default vertex array object. */
+GLuint vertexArrayId = 0;
+
 /* Positions and velocities of spheres in 3D space. */
 /* Array holding positions and velocities of spheres in 3D space which are used to draw spheres for the first time. */
 float startPositionAndVelocity[spherePositionsAndVelocitiesLength] = {0};
@@ -131,22 +220,13 @@ float startPositionAndVelocity[spherePositionsAndVelocitiesLength] = {0};
 */
 void generateStartPositionAndVelocity()
 {
-    /* Fill the array with position data (starting at index 0). */
-    for (int allComponents = 0;
-             allComponents < 4 * numberOfSpheresToGenerate;
-             allComponents++)
-    {
-        /* Random data with range -20 to -10. */
-        startPositionAndVelocity[allComponents] = 10.0f * (float(rand()) / float(RAND_MAX)) - 20.0f;
-    }
+    Random random;
+
+    /* Fill the array with position data (starting at index 0): random data with range -20 to -10. */
+    random.fill(startPositionAndVelocity, 4 * numberOfSpheresToGenerate, -20.0f, -10.0f);
 
     /* Fill array with velocity data (which follows position data). */
-    for (int allComponents = 4 * numberOfSpheresToGenerate;
-             allComponents < 4 * 2 * numberOfSpheresToGenerate;
-             allComponents++)
-    {
-        startPositionAndVelocity[allComponents] = 0;
-    }
+    memset(startPositionAndVelocity + 4 * numberOfSpheresToGenerate, 0, 4 * numberOfSpheresToGenerate * sizeof(float));
 }
 
 /**
@@ -155,20 +235,20 @@ void generateStartPositionAndVelocity()
 void fillVertexColorsArray()
 {
     /*
-    * Number of vertices for all the spheres is equal to numberOfSphereTriangleCoordinates / 3 (3 verticies per triangle).
+    * Number of vertices for all the spheres is equal to numberOfSphereCoordinates / 3 (3 coordinates per vertex).
     * For each vertex there are 4 color components (R, G, B and A values).
     */
-    colorArraySize = int (numberOfSphereTriangleCoordinates / 3.0f * 4.0f);
+    colorArraySize = numberOfSphereCoordinates / 3 * 4;
 
     /* Allocate memory for vertexColors array. */
     vertexColors = (float*) malloc (colorArraySize * sizeof(float));
 
     ASSERT(vertexColors != NULL, "Could not allocate memory for vertexColors array.");
 
-    for (int i = 0; i < colorArraySize; i++)
-    {
-        vertexColors[i] = float(rand()%RAND_MAX)/float(RAND_MAX);
-    }
+    /* Seeded differently from the positions, so the colours are not correlated with them. */
+    Random random(2);
+
+    random.fill(vertexColors, colorArraySize);
 }
 
 /**
@@ -176,20 +256,169 @@ void fillVertexColorsArray()
 */
 void createSpheresData()
 {
-    /* Radius of the spheres. */
-    const float radius = 10.0f;
-
-    /* [Generate geometry] */
-    SphereModel::getTriangleRepresentation(radius,
-                                           numberOfSamples,
-                                          &numberOfSphereTriangleCoordinates,
-                                          &numberOfSphereTrianglePoints,
-                                          &sphereTrianglesCoordinates);
-    /* [Generate geometry] */
+    /* Coordinates and indices of the sphere of each level of detail. */
+    float*          levelCoordinates[numberOfLevelsOfDetail]         = {NULL};
+    unsigned short* levelIndices[numberOfLevelsOfDetail]             = {NULL};
+    int             numberOfLevelCoordinates[numberOfLevelsOfDetail] = {0};
+
+    for (int level = 0; level < numberOfLevelsOfDetail; level++)
+    {
+        /* [Generate geometry] */
+        SphereModel::getIndexedTriangleRepresentation(sphereRadius,
+                                                      numberOfSamples[level],
+                                                     &numberOfLevelCoordinates[level],
+                                                     &levelCoordinates[level],
+                                                     &sphereIndexCounts[level],
+                                                     &levelIndices[level]);
+        /* [Generate geometry] */
+
+        ASSERT(levelCoordinates[level] != NULL && levelIndices[level] != NULL, "Could not generate sphere geometry.");
+
+        sphereFirstIndices[level]  = numberOfSphereIndices;
+        numberOfSphereCoordinates += numberOfLevelCoordinates[level];
+        numberOfSphereIndices     += sphereIndexCounts[level];
+    }
+
+    /* Put the spheres of all levels of detail one after another, so they can be drawn from the same buffers. */
+    sphereCoordinates = (float*)          malloc(numberOfSphereCoordinates * sizeof(float));
+    sphereIndices     = (unsigned short*) malloc(numberOfSphereIndices     * sizeof(unsigned short));
+
+    ASSERT(sphereCoordinates != NULL && sphereIndices != NULL, "Could not allocate memory for sphere geometry.");
+    ASSERT(numberOfSphereCoordinates / 3 <= 65536,             "Too many sphere vertices to use 16-bit indices.");
+
+    int firstCoordinate = 0;
+
+    for (int level = 0; level < numberOfLevelsOfDetail; level++)
+    {
+        /* There is no base vertex for instanced draws in OpenGL ES 3.1, so indices are offset to the level's first vertex instead. */
+        const int firstVertex = firstCoordinate / 3;
+
+        memcpy(sphereCoordinates + firstCoordinate, levelCoordinates[level], numberOfLevelCoordinates[level] * sizeof(float));
+
+        for (int index = 0; index < sphereIndexCounts[level]; index++)
+        {
+            sphereIndices[sphereFirstIndices[level] + index] = (unsigned short) (levelIndices[level][index] + firstVertex);
+        }
+
+        firstCoordinate += numberOfLevelCoordinates[level];
+
+        free(levelCoordinates[level]);
+        free(levelIndices[level]);
+    }
+
     generateStartPositionAndVelocity();
     fillVertexColorsArray();
 }
 
+/**
+ * \brief Check whether compute shaders can be used, i.e. whether the context is OpenGL ES 3.1 or newer.
+ */
+bool isComputeShaderSupported()
+{
+    GLint majorVersion = 0;
+    GLint minorVersion = 0;
+
+    GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &majorVersion));
+    GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minorVersion));
+
+    return majorVersion > 3 || (majorVersion == 3 && minorVersion >= 1);
+}
+
+/**
+ * \brief Create the buffers used by the compute shaders, and fill the spheres buffer with random positions.
+ */
+void initializeComputeData()
+{
+    GL_CHECK(glGenBuffers(numberOfComputeBufferObjectIds, computeBufferObjectIds));
+
+    boidsBufferObjectId       = computeBufferObjectIds[0];
+    cellCountsBufferObjectId  = computeBufferObjectIds[1];
+    gridBufferObjectId        = computeBufferObjectIds[2];
+    boidRanksBufferObjectId   = computeBufferObjectIds[3];
+    sortedBoidsBufferObjectId = computeBufferObjectIds[4];
+
+    levelOfDetailInstancesBufferObjectId    = computeBufferObjectIds[5];
+    levelOfDetailDrawCommandsBufferObjectId = computeBufferObjectIds[6];
+
+    /* Location and velocity of each sphere, 4 coordinates each. */
+    float* boids = (float*) malloc(numberOfSpheres * 8 * sizeof(float));
+
+    ASSERT(boids != NULL, "Could not allocate memory for boids array.");
+
+    /* Spread the spheres over a larger cube than for transform feedback, so they start about as densely packed. */
+    const float startCubeSize = 10.0f * cbrtf(float(numberOfSpheres) / float(numberOfSpheresToGenerate));
+
+    for (int i = 0; i < numberOfSpheres; i++)
+    {
+        for (int component = 0; component < 3; component++)
+        {
+            boids[8 * i + component]     = startCubeSize * (float(rand()) / float(RAND_MAX) - 0.5f) - 15.0f;
+            boids[8 * i + 4 + component] = 0.0f;
+        }
+
+        boids[8 * i + 3] = 1.0f;
+        boids[8 * i + 7] = 0.0f;
+    }
+
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, boidsBufferObjectId));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, numberOfSpheres * 8 * sizeof(float), boids, GL_DYNAMIC_DRAW));
+
+    free(boids);
+    boids = NULL;
+
+    /* The bucket counts have to start at zero. The scan pass clears them again after each use. */
+    GLuint* zeroCounts = (GLuint*) calloc(hashTableSize, sizeof(GLuint));
+
+    ASSERT(zeroCounts != NULL, "Could not allocate memory for zeroCounts array.");
+
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellCountsBufferObjectId));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, hashTableSize * sizeof(GLuint), zeroCounts, GL_DYNAMIC_DRAW));
+
+    free(zeroCounts);
+    zeroCounts = NULL;
+
+    /* Two vec4 flock sums, followed by hashTableSize + 1 bucket starts. */
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, gridBufferObjectId));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, 8 * sizeof(float) + (hashTableSize + 1) * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW));
+
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, boidRanksBufferObjectId));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, numberOfSpheres * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW));
+
+    /* Sorted spheres have a location, a velocity and an index, padded to 12 values under std430 rules. */
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, sortedBoidsBufferObjectId));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, numberOfSpheres * 12 * sizeof(float), NULL, GL_DYNAMIC_DRAW));
+
+    /* Room for every sphere's location in each level of detail, as any of them can hold all the spheres. */
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, levelOfDetailInstancesBufferObjectId));
+    GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, numberOfLevelsOfDetail * numberOfSpheres * 4 * sizeof(float), NULL, GL_DYNAMIC_DRAW));
+    GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+    /*
+     * Each level of detail draws its own range of the index buffer. The instance counts are filled in by the level of detail compute shader.
+     * The leader always takes the first instance of the most detailed level, so it can still be told apart from the followers.
+     */
+    for (int level = 0; level < numberOfLevelsOfDetail; level++)
+    {
+        levelOfDetailDrawCommandsReset[level * drawCommandSize + 0] = sphereIndexCounts[level];
+        levelOfDetailDrawCommandsReset[level * drawCommandSize + 1] = (level == 0) ? 1 : 0;
+        levelOfDetailDrawCommandsReset[level * drawCommandSize + 2] = sphereFirstIndices[level];
+        levelOfDetailDrawCommandsReset[level * drawCommandSize + 3] = 0;
+        levelOfDetailDrawCommandsReset[level * drawCommandSize + 4] = 0;
+    }
+
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, levelOfDetailDrawCommandsBufferObjectId));
+    GL_CHECK(glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(levelOfDetailDrawCommandsReset), levelOfDetailDrawCommandsReset, GL_DYNAMIC_DRAW));
+
+    /* The buffers stay bound to the binding points the compute shaders declare. */
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, boidsBufferObjectId));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cellCountsBufferObjectId));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, gridBufferObjectId));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, boidRanksBufferObjectId));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, sortedBoidsBufferObjectId));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, levelOfDetailInstancesBufferObjectId));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, levelOfDetailDrawCommandsBufferObjectId));
+}
+
 /**
 * \brief Initializes data used for rendering.
 */
@@ -214,26 +443,35 @@ void initializeData()
     sphereColorsBufferObjectId                  = bufferObjectIds[1];
     spherePingPositionAndVelocityBufferObjectId = bufferObjectIds[2];
     spherePongPositionAndVelocityBufferObjectId = bufferObjectIds[3];
+    sphereIndicesBufferObjectId                 = bufferObjectIds[4];
     /* [Generate buffer objects] */
 
     /* Fill buffer object with vertex data. */
-    /* Buffer holding coordinates of triangles which create a sphere. */
+    /* Buffer holding coordinates of points which create a sphere. */
     /* [Bind coordinates buffer object] */
     GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER,
                           sphereCoordinatesBufferObjectId));
     /* [Bind coordinates buffer object] */
     /* [Set data for coordinates buffer object] */
     GL_CHECK(glBufferData(GL_ARRAY_BUFFER,
-                          numberOfSphereTriangleCoordinates,
-                          sphereTrianglesCoordinates,
+                          numberOfSphereCoordinates * sizeof(float),
+                          sphereCoordinates,
                           GL_STATIC_DRAW));
     /* [Set data for coordinates buffer object] */
 
+    /* Buffer holding indices of triangles which create a sphere. */
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                          sphereIndicesBufferObjectId));
+    GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                          numberOfSphereIndices * sizeof(unsigned short),
+                          sphereIndices,
+                          GL_STATIC_DRAW));
+
     /* Buffer holding RGBA values of color for each vertex. */
     GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER,
                           sphereColorsBufferObjectId));
     GL_CHECK(glBufferData(GL_ARRAY_BUFFER,
-                          colorArraySize,
+                          colorArraySize * sizeof(float),
                           vertexColors,
                           GL_STATIC_DRAW));
 
@@ -255,74 +493,157 @@ void initializeData()
                           GL_STATIC_DRAW));
     /* [Setup storage for buffer objects] */
 
+    if (useComputeShaders)
+    {
+        initializeComputeData();
+    }
+
     /* Deallocate memory (data are now saved in buffer objects). */
     free(vertexColors);
     vertexColors = NULL;
 
-    free(sphereTrianglesCoordinates);
-    sphereTrianglesCoordinates = NULL;
+    free(sphereCoordinates);
+    sphereCoordinates = NULL;
+
+    free(sphereIndices);
+    sphereIndices = NULL;
 }
 
-/*
-* \brief Create programs that will be used to rasterize the geometry and transforming the spheres.
-*
-*/
-void setupPrograms()
+/**
+ * \brief Create a program from a single compute shader.
+ *
+ * \param shaderObjectIdPtr Deref will be used to store generated shader object ID.
+ * \param filename          Name of a file containing the compute shader source code.
+ *
+ * \return Name of the linked program.
+ */
+GLuint createComputeProgram(GLuint* shaderObjectIdPtr, const char* filename)
 {
-    /* [Array of varyings' names which are used by shader for transform feedback] */
-    const GLchar* varyingNames[] = {"location", "velocity"};
-    /* [Array of varyings' names which are used by shader for transform feedback] */
+    GLuint programId  = GL_CHECK(glCreateProgram());
+    GLint  linkStatus = GL_FALSE;
 
-    /* Create program objects. */
-    movementProgramId  = GL_CHECK(glCreateProgram());
-    /* [Create program object] */
-    renderingProgramId = GL_CHECK(glCreateProgram());
-    /* [Create program object] */
+    Shader::processShader(shaderObjectIdPtr, filename, GL_COMPUTE_SHADER);
 
-    /* Initialize movement program. */
-    Shader::processShader(&movementVertexShaderId,
-                           MOVEMENT_VERTEX_SHADER_FILE_NAME,
-                           GL_VERTEX_SHADER);
-    Shader::processShader(&movementFragmentShaderId,
-                           MOVEMENT_FRAGMENT_SHADER_FILE_NAME,
-                           GL_FRAGMENT_SHADER);
+    GL_CHECK(glAttachShader(programId, *shaderObjectIdPtr));
+    GL_CHECK(glLinkProgram (programId));
+    GL_CHECK(glGetProgramiv(programId, GL_LINK_STATUS, &linkStatus));
 
-    /* Attach vertex and fragment shaders to the program which is used for transform feedback. */
-    GL_CHECK(glAttachShader(movementProgramId, movementVertexShaderId));
-    GL_CHECK(glAttachShader(movementProgramId, movementFragmentShaderId));
+    ASSERT(linkStatus == GL_TRUE, "Compute program linking FAILED!");
 
-    /* [Specify transform feedback varyings] */
-    /*
-     * Specify varyings which are used with transform feedback buffer.
-     * In shader we are using uniform block for holding location and velocity data.
-     * Uniform block takes data from buffer object. Buffer object is filled with position data for each sphere first, and then with velocity data for each sphere.
-     * Setting mode to GL_SEPARATE_ATTRIBS indicates that data are written to output buffer in exactly the same way as in input buffer object.
-     */
-    GL_CHECK(glTransformFeedbackVaryings(movementProgramId,
-                                         2,
-                                         varyingNames,
-                                         GL_SEPARATE_ATTRIBS));
-    /* [Specify transform feedback varyings] */
+    /* Set the uniforms which are the same for all compute passes. Passes which do not use the hash table do not declare its size. */
+    GLint numberOfBoidsLocation = GL_CHECK(glGetUniformLocation(programId, "numberOfBoids"));
+    GLint hashTableSizeLocation = GL_CHECK(glGetUniformLocation(programId, "hashTableSize"));
 
-    /* [Link movement program object] */
-    GL_CHECK(glLinkProgram(movementProgramId));
-    /* [Link movement program object] */
-    GL_CHECK(glUseProgram (movementProgramId));
+    ASSERT(numberOfBoidsLocation != -1, "Could not retrieve uniform location: numberOfBoids");
 
-    /* Get uniform locations from current program. */
-    GLuint transformationUniformBlockIndex = GL_CHECK(glGetUniformBlockIndex(movementProgramId, "inputData"));
+    GL_CHECK(glUseProgram (programId));
+    GL_CHECK(glUniform1ui(numberOfBoidsLocation, numberOfSpheres));
 
-    timeLocation = GL_CHECK(glGetUniformLocation(movementProgramId, "time"));
+    if (hashTableSizeLocation != -1)
+    {
+        GL_CHECK(glUniform1ui(hashTableSizeLocation, hashTableSize));
+    }
 
-    /* Check if the uniform was found in the vertex shader. */
-    ASSERT(timeLocation                    != -1,               "Could not retrieve uniform location: timeLocation");
-    ASSERT(transformationUniformBlockIndex != GL_INVALID_INDEX, "Could not find uniform block: inputData");
+    return programId;
+}
+
+/**
+ * \brief Create programs that will be used to simulate the spheres with compute shaders.
+ */
+void setupComputePrograms()
+{
+    gridCountProgramId       = createComputeProgram(&gridCountShaderId,       GRID_COUNT_COMPUTE_SHADER_FILE_NAME);
+    gridScanProgramId        = createComputeProgram(&gridScanShaderId,        GRID_SCAN_COMPUTE_SHADER_FILE_NAME);
+    gridScatterProgramId     = createComputeProgram(&gridScatterShaderId,     GRID_SCATTER_COMPUTE_SHADER_FILE_NAME);
+    computeMovementProgramId = createComputeProgram(&computeMovementShaderId, MOVEMENT_COMPUTE_SHADER_FILE_NAME);
+
+    computeTimeLocation = GL_CHECK(glGetUniformLocation(computeMovementProgramId, "time"));
 
-    GL_CHECK(glUniformBlockBinding(movementProgramId, transformationUniformBlockIndex, 0));
+    ASSERT(computeTimeLocation != -1, "Could not retrieve uniform location: computeTimeLocation");
+
+    if (useLevelOfDetail)
+    {
+        levelOfDetailProgramId = createComputeProgram(&levelOfDetailShaderId, LEVEL_OF_DETAIL_COMPUTE_SHADER_FILE_NAME);
+
+        levelOfDetailCameraVectorLocation = GL_CHECK(glGetUniformLocation(levelOfDetailProgramId, "cameraVector"));
+        levelOfDetailDistancesLocation    = GL_CHECK(glGetUniformLocation(levelOfDetailProgramId, "levelOfDetailDistances"));
+
+        ASSERT(levelOfDetailCameraVectorLocation != -1, "Could not retrieve uniform location: levelOfDetailCameraVectorLocation");
+        ASSERT(levelOfDetailDistancesLocation    != -1, "Could not retrieve uniform location: levelOfDetailDistancesLocation");
+    }
+}
+
+/*
+* \brief Create programs that will be used to rasterize the geometry and transforming the spheres.
+*
+*/
+void setupPrograms()
+{
+    /* Create program object. */
+    /* [Create program object] */
+    renderingProgramId = GL_CHECK(glCreateProgram());
+    /* [Create program object] */
+
+    if (useComputeShaders)
+    {
+        /* The spheres are moved by compute shaders, so the transform feedback program is not needed. */
+        setupComputePrograms();
+    }
+    else
+    {
+        /* [Array of varyings' names which are used by shader for transform feedback] */
+        const GLchar* varyingNames[] = {"location", "velocity"};
+        /* [Array of varyings' names which are used by shader for transform feedback] */
+
+        /* Create program object. */
+        movementProgramId = GL_CHECK(glCreateProgram());
+
+        /* Initialize movement program. */
+        Shader::processShader(&movementVertexShaderId,
+                               MOVEMENT_VERTEX_SHADER_FILE_NAME,
+                               GL_VERTEX_SHADER);
+        Shader::processShader(&movementFragmentShaderId,
+                               MOVEMENT_FRAGMENT_SHADER_FILE_NAME,
+                               GL_FRAGMENT_SHADER);
+
+        /* Attach vertex and fragment shaders to the program which is used for transform feedback. */
+        GL_CHECK(glAttachShader(movementProgramId, movementVertexShaderId));
+        GL_CHECK(glAttachShader(movementProgramId, movementFragmentShaderId));
+
+        /* [Specify transform feedback varyings] */
+        /*
+         * Specify varyings which are used with transform feedback buffer.
+         * In shader we are using uniform block for holding location and velocity data.
+         * Uniform block takes data from buffer object. Buffer object is filled with position data for each sphere first, and then with velocity data for each sphere.
+         * Setting mode to GL_SEPARATE_ATTRIBS indicates that data are written to output buffer in exactly the same way as in input buffer object.
+         */
+        GL_CHECK(glTransformFeedbackVaryings(movementProgramId,
+                                             2,
+                                             varyingNames,
+                                             GL_SEPARATE_ATTRIBS));
+        /* [Specify transform feedback varyings] */
+
+        /* [Link movement program object] */
+        GL_CHECK(glLinkProgram(movementProgramId));
+        /* [Link movement program object] */
+        GL_CHECK(glUseProgram (movementProgramId));
+
+        /* Get uniform locations from current program. */
+        GLuint transformationUniformBlockIndex = GL_CHECK(glGetUniformBlockIndex(movementProgramId, "inputData"));
+
+        timeLocation = GL_CHECK(glGetUniformLocation(movementProgramId, "time"));
+
+        /* Check if the uniform was found in the vertex shader. */
+        ASSERT(timeLocation                    != -1,               "Could not retrieve uniform location: timeLocation");
+        ASSERT(transformationUniformBlockIndex != GL_INVALID_INDEX, "Could not find uniform block: inputData");
+
+        GL_CHECK(glUniformBlockBinding(movementProgramId, transformationUniformBlockIndex, 0));
+    }
 
     /* Initialize rendering program. */
+    /* Spheres simulated by compute shaders take their location from a per-instance attribute instead of the uniform block. */
     Shader::processShader(&vertexShaderId,
-                           VERTEX_SHADER_FILE_NAME,
+                           useComputeShaders ? INSTANCED_VERTEX_SHADER_FILE_NAME : VERTEX_SHADER_FILE_NAME,
                            GL_VERTEX_SHADER);
     Shader::processShader(&fragmentShaderId,
                            FRAGMENT_SHADER_FILE_NAME,
@@ -352,7 +673,6 @@ void setupPrograms()
     perspectiveMatrixLocation = GL_CHECK(glGetUniformLocation  (renderingProgramId, "perspectiveVector"));
     cameraPositionLocation    = GL_CHECK(glGetUniformLocation  (renderingProgramId, "cameraVector"));
     /* [Get uniform locations] */
-    movementUniformBlockIndex = GL_CHECK(glGetUniformBlockIndex(renderingProgramId, "BoidsUniformBlock"));
 
     /* [Check if all uniforms, attributes and uniform blocks were found in vertex shader] */
     ASSERT(positionLocation          != -1,               "Could not retrieve attribute location: attributePosition");
@@ -360,9 +680,23 @@ void setupPrograms()
     ASSERT(scalingMatrixLocation     != -1,               "Could not retrieve uniform location: scalingMatrixLocation");
     ASSERT(perspectiveMatrixLocation != -1,               "Could not retrieve uniform location: perspectiveMatrixLocation");
     ASSERT(cameraPositionLocation    != -1,               "Could not retrieve uniform location: cameraPositionLocation");
-    ASSERT(movementUniformBlockIndex != GL_INVALID_INDEX, "Could not retrieve uniform block index: BoidsUniformBlock")
     /* [Check if all uniforms, attributes and uniform blocks were found in vertex shader] */
 
+    if (useComputeShaders)
+    {
+        instanceLocationLocation = GL_CHECK(glGetAttribLocation (renderingProgramId, "attributeLocation"));
+        leaderInstanceLocation   = GL_CHECK(glGetUniformLocation(renderingProgramId, "leaderInstance"));
+
+        ASSERT(instanceLocationLocation != -1, "Could not retrieve attribute location: attributeLocation");
+        ASSERT(leaderInstanceLocation   != -1, "Could not retrieve uniform location: leaderInstanceLocation");
+
+        return;
+    }
+
+    movementUniformBlockIndex = GL_CHECK(glGetUniformBlockIndex(renderingProgramId, "BoidsUniformBlock"));
+
+    ASSERT(movementUniformBlockIndex != GL_INVALID_INDEX, "Could not retrieve uniform block index: BoidsUniformBlock")
+
     GL_CHECK(glUniformBlockBinding(renderingProgramId, movementUniformBlockIndex, 0));
     /* [Fill position and velocity buffer with data] */
     GL_CHECK(glBindBuffer   (GL_ARRAY_BUFFER,
@@ -374,6 +708,78 @@ void setupPrograms()
     /* [Fill position and velocity buffer with data] */
 }
 
+/**
+ * \brief Move the spheres with compute shaders, using a spatial hash grid to find neighbours.
+ *
+ * \param timerTime Time used for determining the leader's position.
+ */
+void renderFrameCompute(float timerTime)
+{
+    const GLuint numberOfWorkGroups = (numberOfSpheres + computeWorkGroupSize - 1) / computeWorkGroupSize;
+
+    /* Count the spheres in each bucket of the hash table, and remember each sphere's slot within its bucket. */
+    GL_CHECK(glUseProgram     (gridCountProgramId));
+    GL_CHECK(glDispatchCompute(numberOfWorkGroups, 1, 1));
+    GL_CHECK(glMemoryBarrier  (GL_SHADER_STORAGE_BARRIER_BIT));
+
+    /* Turn the counts into bucket start offsets, and sum the locations and velocities of the whole flock. */
+    GL_CHECK(glUseProgram     (gridScanProgramId));
+    GL_CHECK(glDispatchCompute(1, 1, 1));
+    GL_CHECK(glMemoryBarrier  (GL_SHADER_STORAGE_BARRIER_BIT));
+
+    /* Copy the spheres into their buckets. */
+    GL_CHECK(glUseProgram     (gridScatterProgramId));
+    GL_CHECK(glDispatchCompute(numberOfWorkGroups, 1, 1));
+    GL_CHECK(glMemoryBarrier  (GL_SHADER_STORAGE_BARRIER_BIT));
+
+    /* Move the spheres. Only the neighbouring buckets are searched for spheres that are too close. */
+    GL_CHECK(glUseProgram     (computeMovementProgramId));
+    GL_CHECK(glUniform1f      (computeTimeLocation, timerTime));
+    GL_CHECK(glDispatchCompute(numberOfWorkGroups, 1, 1));
+
+    if (!useLevelOfDetail)
+    {
+        GL_CHECK(glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+
+        /* Rasterizer pass. The new locations are read straight from the spheres buffer through an instanced attribute. */
+        GL_CHECK(glUseProgram(renderingProgramId));
+        GL_CHECK(glDrawElementsInstanced(GL_TRIANGLES,
+                                         sphereIndexCounts[0],
+                                         GL_UNSIGNED_SHORT,
+                                         0,
+                                         numberOfSpheres));
+
+        return;
+    }
+
+    GL_CHECK(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+
+    /* Sort the new locations by level of detail, counting the spheres of each level straight into the draw commands. */
+    GL_CHECK(glBufferSubData  (GL_DRAW_INDIRECT_BUFFER, 0, sizeof(levelOfDetailDrawCommandsReset), levelOfDetailDrawCommandsReset));
+    GL_CHECK(glUseProgram     (levelOfDetailProgramId));
+    GL_CHECK(glDispatchCompute(numberOfWorkGroups, 1, 1));
+    GL_CHECK(glMemoryBarrier  (GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+
+    /* Rasterizer pass. One indirect draw per level of detail; the CPU never needs to know how many spheres each one holds. */
+    GL_CHECK(glUseProgram(renderingProgramId));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, levelOfDetailInstancesBufferObjectId));
+
+    for (int level = 0; level < numberOfLevelsOfDetail; level++)
+    {
+        /* There is no base instance in OpenGL ES 3.1, so the instanced attribute is pointed at the level's locations instead. */
+        GL_CHECK(glVertexAttribPointer(instanceLocationLocation,
+                                       4,
+                                       GL_FLOAT,
+                                       GL_FALSE,
+                                       0,
+                                       (const GLvoid*) (level * numberOfSpheres * 4 * sizeof(float))));
+        GL_CHECK(glUniform1i          (leaderInstanceLocation, (level == 0) ? 0 : -1));
+        GL_CHECK(glDrawElementsIndirect(GL_TRIANGLES,
+                                        GL_UNSIGNED_SHORT,
+                                        (const GLvoid*) (level * drawCommandSize * sizeof(GLuint))));
+    }
+}
+
 /**
  * \brief Render new frame's contents into back buffer.
  */
@@ -385,6 +791,13 @@ void renderFrame()
     /* Value of time returned by timer used for determining leader's position and to keep the leader's velocity constant across different GPUs. */
     float timerTime = timer.getTime();
 
+    if (useComputeShaders)
+    {
+        renderFrameCompute(timerTime);
+
+        return;
+    }
+
     /*
      * Transform feedback is used for setting position and velocity for each of the spheres.
      * You cannot read from and write to the same buffer object at a time, so we use a ping-pong approach.
@@ -493,10 +906,11 @@ void renderFrame()
     }
 
     /* [Draw spheres] */
-    GL_CHECK(glDrawArraysInstanced(GL_TRIANGLES,
-                                   0,
-                                   numberOfSphereTrianglePoints,
-                                   numberOfSpheresToGenerate));
+    GL_CHECK(glDrawElementsInstanced(GL_TRIANGLES,
+                                     sphereIndexCounts[0],
+                                     GL_UNSIGNED_SHORT,
+                                     0,
+                                     numberOfSpheresToGenerate));
     /* [Draw spheres] */
 
     /* Swap the ping and pong buffer objects. */
@@ -508,6 +922,12 @@ void setupGraphics(int width, int height)
     windowHeight = height;
     windowWidth  = width;
 
+    /* Simulate a much larger flock if compute shaders are available. */
+    useComputeShaders = isComputeShaderSupported();
+    numberOfSpheres   = useComputeShaders ? numberOfComputeSpheres : numberOfSpheresToGenerate;
+
+    LOGI("Simulating %d boids with %s.", numberOfSpheres, useComputeShaders ? "compute shaders" : "transform feedback");
+
     /* Initialize data used for rendering. */
     initializeData();
     /* Create programs. */
@@ -524,6 +944,10 @@ void setupGraphics(int width, int height)
     /* Array used for view configuration in vertex shader. */
     float cameraVector[] = {0.0f, 0.0f, -60.0f};
 
+    /* Vertex attribute and element array buffer bindings are stored in a vertex array object. */
+    GL_CHECK(glGenVertexArrays(1, &vertexArrayId));
+    GL_CHECK(glBindVertexArray(vertexArrayId));
+
     /* Set values for uniforms for model-view program. */
     GL_CHECK(glUseProgram(renderingProgramId));
     /* [Set uniform values] */
@@ -544,6 +968,9 @@ void setupGraphics(int width, int height)
                                        0));
     /* [Enable VAA for sphere coordinates] */
 
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                          sphereIndicesBufferObjectId));
+
     GL_CHECK(glBindBuffer             (GL_ARRAY_BUFFER,
                                        sphereColorsBufferObjectId));
     GL_CHECK(glEnableVertexAttribArray(sphereVertexColorLocation));
@@ -553,6 +980,37 @@ void setupGraphics(int width, int height)
                                        GL_FALSE,
                                        0,
                                        0));
+
+    if (useComputeShaders)
+    {
+        /* One location per sphere instance, taken from the interleaved location and velocity data. */
+        GL_CHECK(glBindBuffer             (GL_ARRAY_BUFFER,
+                                           boidsBufferObjectId));
+        GL_CHECK(glEnableVertexAttribArray(instanceLocationLocation));
+        GL_CHECK(glVertexAttribPointer    (instanceLocationLocation,
+                                           4,
+                                           GL_FLOAT,
+                                           GL_FALSE,
+                                           8 * sizeof(float),
+                                           0));
+        GL_CHECK(glVertexAttribDivisor    (instanceLocationLocation, 1));
+        GL_CHECK(glUniform1i              (leaderInstanceLocation,   0));
+    }
+
+    if (useComputeShaders && useLevelOfDetail)
+    {
+        /*
+         * Distances from the camera at which spheres cover fewer pixels than levelOfDetailPixelRadii, using the same projection as the vertex shader.
+         * Spheres closer than the first one are drawn with the most detailed mesh.
+         */
+        const float fieldOfAngle      = 1.0f / tanf(perspectiveVector[0] * 0.5f);
+        const float projectedRadius   = sphereRadius * scalingFactor * fieldOfAngle * 0.5f * float(windowHeight);
+        float levelOfDetailDistances[] = {projectedRadius / levelOfDetailPixelRadii[0], projectedRadius / levelOfDetailPixelRadii[1]};
+
+        GL_CHECK(glUseProgram(levelOfDetailProgramId));
+        GL_CHECK(glUniform3fv(levelOfDetailCameraVectorLocation, 1, cameraVector));
+        GL_CHECK(glUniform2fv(levelOfDetailDistancesLocation,    1, levelOfDetailDistances));
+    }
 }
 
 void uninit()
@@ -569,15 +1027,47 @@ void uninit()
     GL_CHECK(glDeleteShader (vertexShaderId));
     GL_CHECK(glDeleteProgram(renderingProgramId));
     GL_CHECK(glDeleteProgram(movementProgramId));
+
+    if (useComputeShaders)
+    {
+        GL_CHECK(glDeleteBuffers(numberOfComputeBufferObjectIds, computeBufferObjectIds));
+
+        GL_CHECK(glDeleteShader (gridCountShaderId));
+        GL_CHECK(glDeleteShader (gridScanShaderId));
+        GL_CHECK(glDeleteShader (gridScatterShaderId));
+        GL_CHECK(glDeleteShader (computeMovementShaderId));
+        GL_CHECK(glDeleteProgram(gridCountProgramId));
+        GL_CHECK(glDeleteProgram(gridScanProgramId));
+        GL_CHECK(glDeleteProgram(gridScatterProgramId));
+        GL_CHECK(glDeleteProgram(computeMovementProgramId));
+        GL_CHECK(glDeleteShader (levelOfDetailShaderId));
+        GL_CHECK(glDeleteProgram(levelOfDetailProgramId));
+    }
+
+    GL_CHECK(glDeleteVertexArrays(1, &vertexArrayId));
 }
 
 extern "C"
 {
+    JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_boids_NativeLibrary_setAssetManager(JNIEnv * env, jobject obj, jobject assetManager);
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_boids_NativeLibrary_init  (JNIEnv * env, jobject obj, jint width, jint height);
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_boids_NativeLibrary_step  (JNIEnv * env, jobject obj);
     JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_boids_NativeLibrary_uninit(JNIEnv * env, jobject obj);
 };
 
+JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_boids_NativeLibrary_setAssetManager(
+        JNIEnv * env, jobject obj, jobject assetManager)
+{
+    /* The native asset manager is only valid while the Java one is, so keep a reference to it for good. */
+    static jobject assetManagerReference = NULL;
+
+    if (assetManagerReference == NULL)
+    {
+        assetManagerReference = env->NewGlobalRef(assetManager);
+        AssetFile::setAssetManager(AAssetManager_fromJava(env, assetManagerReference), ASSET_DIRECTORY);
+    }
+}
+
 JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_boids_NativeLibrary_init(
         JNIEnv * env, jobject obj, jint width, jint height)
 {
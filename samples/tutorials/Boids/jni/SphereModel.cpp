@@ -368,6 +368,71 @@ namespace MaliSDK
         pointCoordinates = NULL;
     }
 
+    void SphereModel::getIndexedTriangleRepresentation(const float      radius,
+                                                       const int        numberOfSamples,
+                                                       int*             numberOfCoordinates,
+                                                       float**          coordinates,
+                                                       int*             numberOfIndices,
+                                                       unsigned short** indices)
+    {
+        /* Check if parameters have compatible values. */
+        if (numberOfSamples <= 0 || numberOfSamples * numberOfSamples > 65536)
+        {
+            LOGE("numberOfSamples value has to be greater than zero, and numberOfSamples * numberOfSamples cannot exceed 65536.");
+
+            return;
+        }
+        if (coordinates == NULL || indices == NULL)
+        {
+            LOGE("Cannot use null pointer while calculating coordinates.");
+
+            return;
+        }
+
+        /* Compute coordinates of points which make up a sphere. These are used as they are. */
+        getPointRepresentation(radius, numberOfSamples, numberOfCoordinates, coordinates);
+
+        if (*coordinates == NULL)
+        {
+            LOGE("Could not get coordinates of points which make up a sphere.");
+            return;
+        }
+
+        /* 2 triangles for each point of each circle (excluding last one), 3 indices per triangle. */
+        const int numberOfSphereIndices = (numberOfSamples - 1) * numberOfSamples * 2 * 3;
+        /* Current index used for accessing indices array. */
+        int sphereIndex = 0;
+
+        *indices = (unsigned short*) malloc (numberOfSphereIndices * sizeof(unsigned short));
+
+        if (*indices == NULL)
+        {
+            LOGE("Could not allocate memory for result array.");
+            return;
+        }
+
+        for (int point = 0; point < (numberOfSamples - 1) * numberOfSamples; point++)
+        {
+            /* Next point lying on current circle. For the last point of a circle this is the first point of the same circle. */
+            const int nextPoint = ((point + 1) % numberOfSamples == 0) ? point + 1 - numberOfSamples : point + 1;
+
+            /* First triangle: A1 B1 B2. */
+            (*indices)[sphereIndex++] = (unsigned short) point;
+            (*indices)[sphereIndex++] = (unsigned short) nextPoint;
+            (*indices)[sphereIndex++] = (unsigned short) (nextPoint + numberOfSamples);
+
+            /* Second triangle: A1 B2 A2. */
+            (*indices)[sphereIndex++] = (unsigned short) point;
+            (*indices)[sphereIndex++] = (unsigned short) (nextPoint + numberOfSamples);
+            (*indices)[sphereIndex++] = (unsigned short) (point + numberOfSamples);
+        }
+
+        if (numberOfIndices != NULL)
+        {
+            *numberOfIndices = numberOfSphereIndices;
+        }
+    }
+
 
     
 }
@@ -68,6 +68,22 @@ namespace MaliSDK
          * \param[out] coordinates         Deref will be used to store generated coordinates. Cannot be null.
          */
         static void getTriangleRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, int* numberOfPoints, float** coordinates);
+
+        /**
+         * \brief Create indexed triangular representation of a sphere.
+         *
+         * Triangles are built according to the same rule as in getTriangleRepresentation(), but each point of the sphere
+         * is stored only once and triangles refer to the points by index.
+         *
+         * \param[in]  radius              Radius of a sphere. Has to be greater than zero.
+         * \param[in]  numberOfSamples     A sphere consists of numberOfSamples circles and numberOfSamples points lying on one circle.
+         *                                 Has to be greater than zero, and small enough for all points to be indexed with 16 bits.
+         * \param[out] numberOfCoordinates Number of generated coordinates.
+         * \param[out] coordinates         Deref will be used to store generated coordinates. Cannot be null.
+         * \param[out] numberOfIndices     Number of generated indices.
+         * \param[out] indices             Deref will be used to store generated indices, 3 per triangle. Cannot be null.
+         */
+        static void getIndexedTriangleRepresentation(const float radius, const int numberOfSamples, int* numberOfCoordinates, float** coordinates, int* numberOfIndices, unsigned short** indices);
     };
 }
 #endif /* SPHERE_MODEL_H */
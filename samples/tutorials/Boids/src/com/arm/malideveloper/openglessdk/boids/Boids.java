@@ -20,19 +20,12 @@
 
 package com.arm.malideveloper.openglessdk.boids;
 
-import java.io.File;
-import java.io.InputStream;
-import java.io.RandomAccessFile;
 import android.os.Bundle;
 import android.app.Activity;
-import android.content.res.AssetManager;
-import android.util.Log;
 
 public class Boids extends Activity
 {
     private static android.content.Context applicationContext = null;
-    private static String                  assetsDirectory    = null;
-    private static String                  LOGTAG             = "EtcTexture";
     protected TutorialView                 tutorialView;
     
     @Override protected void onCreate(Bundle savedInstanceState)
@@ -43,12 +36,9 @@ public class Boids extends Activity
 
         /* [onCreateNew] */
         applicationContext = getApplicationContext();
-        assetsDirectory    = applicationContext.getFilesDir().getPath() + "/";
 
-        extractAsset("fragment_shader_source.frag");
-        extractAsset("movement.frag");
-        extractAsset("movement.vert");
-        extractAsset("vertex_shader_source.vert");
+        /* The shaders are read straight from the APK, nothing is extracted. */
+        NativeLibrary.setAssetManager(applicationContext.getAssets());
 
         /* [onCreateNew] */
         setContentView(tutorialView);
@@ -67,39 +57,4 @@ public class Boids extends Activity
     {
         super.onDestroy();
     }
-
-    private void extractAsset(String assetName)
-    {
-        File file = new File(assetsDirectory + assetName);
-
-        if(file.exists()) {
-            Log.d(LOGTAG, assetName +  " already exists. No extraction needed.\n");
-        } else {
-            Log.d(LOGTAG, assetName + " doesn't exist. Extraction needed. \n");
-
-            try {
-                RandomAccessFile randomAccessFile = new RandomAccessFile(assetsDirectory + assetName,"rw");
-                AssetManager     assetManager     = applicationContext.getResources().getAssets();
-                InputStream      inputStream      = assetManager.open(assetName);
-                
-                byte buffer[] = new byte[1024];
-                int count     = inputStream.read(buffer, 0, 1024);
-
-                while (count > 0) {
-                    randomAccessFile.write(buffer, 0, count);
-
-                    count = inputStream.read(buffer, 0, 1024);
-                }
-
-                randomAccessFile.close();
-                inputStream.close();
-            } catch(Exception e) {
-                Log.e(LOGTAG, "Failure in extractAssets(): " + e.toString() + " " + assetsDirectory + assetName);
-            }
-
-            if(file.exists()) {
-                Log.d(LOGTAG,"File extracted successfully");
-            }
-        }
-    }
-}
\ No newline at end of file
+}
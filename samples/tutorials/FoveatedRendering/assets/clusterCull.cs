@@ -0,0 +1,108 @@
+#version 310 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Cluster culling pre-pass of the room.
+ * Each invocation tests one cluster against the frustum of every view, and against its normal cone
+ * from every eye. The indices of the clusters visible in at least one view are appended to the visible
+ * index buffer, and counted in the indirect draw command, whose count the application resets to 0.
+ * VIEWS is defined by the application.
+ */
+
+layout(local_size_x = 64) in;
+
+struct Cluster
+{
+    vec4 sphere;    // Centre and radius of the bounding sphere
+    vec4 cone;      // Axis and cutoff of the normal cone
+    uvec4 range;    // First index and number of indices
+};
+
+layout(std430, binding = 0) readonly buffer Clusters
+{
+    Cluster clusters[];
+};
+
+layout(std430, binding = 1) readonly buffer Indices
+{
+    uint indices[];
+};
+
+layout(std430, binding = 2) writeonly buffer VisibleIndices
+{
+    uint visibleIndices[];
+};
+
+layout(std430, binding = 3) buffer DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint reservedMustBeZero;
+} command;
+
+// Planes of the frustum of each view and position of each eye, in the space of the model
+uniform vec4 frustumPlanes[6 * VIEWS];
+uniform vec3 eyePositions[VIEWS];
+uniform uint clustersCount;
+
+void main()
+{
+    uint clusterIndex = gl_GlobalInvocationID.x;
+    if (clusterIndex >= clustersCount)
+    {
+        return;
+    }
+
+    Cluster cluster = clusters[clusterIndex];
+    vec3 center = cluster.sphere.xyz;
+    float radius = cluster.sphere.w;
+
+    bool visible = false;
+    for (int view = 0; view < VIEWS && !visible; ++view)
+    {
+        bool inside = true;
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            vec4 frustumPlane = frustumPlanes[view * 6 + plane];
+            inside = inside && dot(frustumPlane.xyz, center) + frustumPlane.w > -radius;
+        }
+
+        // All the triangles face away if the eye is behind the cone, with the sphere standing in for its apex
+        vec3 toCluster = center - eyePositions[view];
+        bool backFacing = dot(toCluster, cluster.cone.xyz) >= cluster.cone.w * length(toCluster) + radius;
+
+        visible = inside && !backFacing;
+    }
+
+    if (!visible)
+    {
+        return;
+    }
+
+    uint firstVisibleIndex = atomicAdd(command.count, cluster.range.y);
+    for (uint i = 0u; i < cluster.range.y; ++i)
+    {
+        visibleIndices[firstVisibleIndex + i] = indices[cluster.range.x + i];
+    }
+}
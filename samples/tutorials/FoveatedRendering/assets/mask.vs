@@ -26,7 +26,11 @@ in vec3 vertexPosition;
 
 uniform uint maskType;
 
-layout(num_views = 4) in;
+// Inset mask of each view: centre (xy) and radius (z) of the next foveation ring, in the view's normalized device coordinates.
+// A radius of 0 means there is no inner ring to mask out.
+uniform vec3 insetMasks[VIEWS];
+
+layout(num_views = VIEWS) in;
 
 void main()
 {
@@ -35,10 +39,17 @@ void main()
 	// Force the mask to be rendered in front of everything by default
 	position.z = 0.0f;
 
-	// If it's not the right mask for the view, push it to the background
-	if((gl_ViewID_OVR == uint(2) || gl_ViewID_OVR == uint(3)) && maskType == uint(1)){
-		position.z = 1.0f;
+	// The inset mask covers the part of the view that an inner ring renders, and follows the gaze
+	if(maskType == uint(1)){
+		vec3 insetMask = insetMasks[gl_ViewID_OVR];
+		position.xy = insetMask.xy + position.xy * insetMask.z;
+
+		if(insetMask.z == 0.0f){
+			position.z = 1.0f;
+		}
 	}
+
+	// The outset mask is only needed by the inner rings, the periphery covers the whole view
 	if((gl_ViewID_OVR == uint(0) || gl_ViewID_OVR == uint(1)) && maskType == uint(2)){
 		position.z = 1.0f;
 	}
@@ -22,17 +22,17 @@
 
 #extension GL_OVR_multiview2 : enable
 
-layout(num_views = 4) in;
+layout(num_views = VIEWS) in;
 
 in vec4 vertexPosition;
 in vec3 vertexNormal;
 in vec3 vertexTangent;
 in vec2 uvCoordinates;
 
-uniform mat4 View[4];
-uniform mat4 ModelView[4];
-uniform mat4 ModelViewProjection[4];
-uniform mat4 Projection[4];
+uniform mat4 View[VIEWS];
+uniform mat4 ModelView[VIEWS];
+uniform mat4 ModelViewProjection[VIEWS];
+uniform mat4 Projection[VIEWS];
 uniform mat4 Model;
 
 out highp vec2 vUV;
@@ -23,16 +23,40 @@
 #define MASK
 #define RED
 
-#ifdef FOVEATED
+// Number of foveation rings, the periphery included. Each ring is rendered to one view per eye,
+// so it cannot be more than half of GL_MAX_VIEWS_OVR.
+#define FOVEATION_RINGS 2
+
+// Instead of the foveation rings, render each eye as a 3x3 grid of cells with their own resolution, fixed to the lens,
+// and warp them back together matching the lens distortion. See gridScales.
+//#define LENS_MATCHED
+
+#ifdef LENS_MATCHED
+	#undef FOVEATED
+	#undef MASK
+
+	#undef RATIO
+	#define RATIO 1.0
+
+	#undef FOVEATION_RINGS
+	#define FOVEATION_RINGS 1
+
+	// Each cell of the grid is rendered to one view per eye
+	#define GRID_SIZE 3
+	#define VIEWS (2 * GRID_SIZE * GRID_SIZE)
+#elif defined(FOVEATED)
 	#ifndef RATIO
 		#define RATIO 0.3
 	#endif
 
-	#define VIEWS 4
+	#define VIEWS (2 * FOVEATION_RINGS)
 #else
 	#undef RATIO
 	#define RATIO 1.0
 
+	#undef FOVEATION_RINGS
+	#define FOVEATION_RINGS 1
+
 	#ifdef MULTIVIEW
 		#define VIEWS 2
 	#else
@@ -45,7 +69,7 @@
 #include <jni.h>
 #include <android/log.h>
 
-#include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
 #include <EGL/egl.h>
 
 #include <stdio.h>
@@ -57,6 +81,9 @@
 
 #include "Matrix.h"
 
+#define STRINGIFY_VALUE(x) #x
+#define STRINGIFY(x) STRINGIFY_VALUE(x)
+
 #define LOG_TAG "Foveated_Sample"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
@@ -80,12 +107,17 @@ GLuint screenHeight;
 // Switch to define the structure holding the main view framebuffers
 // Regular contains two FB, for left and right eye while the others
 // use a single one based on multiview
+// The others render the views in as few multiview passes as GL_MAX_VIEWS_OVR allows, with a framebuffer for each.
+// This is a single pass unless the lens matched grid has more views than that.
 #ifdef REGULAR
 GLuint frameBufferObjectId[2];
 #else
-GLuint frameBufferObjectId;
+GLuint frameBufferObjectId[VIEWS];
 #endif
 
+// Number of views rendered by each pass, and by the multiview shaders
+int viewsPerPass = VIEWS;
+
 // Array of texture 2D containing left and right eye
 #ifdef REGULAR
 GLuint frameBufferTextureId[2];
@@ -127,10 +159,15 @@ GLuint texturedQuadSamplerLocation;
 GLuint texturedQuadLayerIndexLocation;
 GLuint textureQuadFoveatedRatio;
 GLuint textureQuadWidthHeight;
+GLuint textureQuadRingCenters;
+GLuint textureQuadRingRadii;
+GLuint textureQuadGridBounds;
+GLuint textureQuadLensDistortion;
 
 GLuint maskProgram;
 GLuint maskVertexLocation;
 GLuint maskTypeLocation;
+GLuint maskInsetMasksLocation;
 GLuint masklInsetVertexArray;
 GLuint maskOutsetVertexArray;
 
@@ -142,6 +179,38 @@ Matrix modelViewProjectionMatrix[VIEWS];
 Matrix modelMatrix;
 float angle = 0;
 
+// Projection of the periphery, the projections of the inner rings are derived from it
+Matrix peripheryProjectionMatrix;
+
+#ifdef FOVEATED
+// Radius of each foveation ring, as a fraction of the periphery (the first ring, always 1.0).
+// Every ring is rendered at the FBO resolution, so ring i is displayed at RATIO / foveationRingRadii[i]
+// times the screen resolution. The radii have to decrease.
+const float foveationRingRadii[FOVEATION_RINGS] = { 1.0f, RATIO };
+#endif
+
+// Centre of each foveation ring in the normalized device coordinates of an eye.
+// The periphery stays centred, the inner rings follow the gaze.
+float foveationRingCenters[FOVEATION_RINGS * 2];
+
+#ifdef LENS_MATCHED
+// Resolution of the columns and rows of the grid, relative to the centre. Cell (i, j) is rendered at gridScales[i]
+// times the screen resolution horizontally and gridScales[j] vertically. Every cell is rendered to a layer of the
+// same size, so the grid lines are placed for each cell to cover as much of the eye as its scale allows.
+const float gridScales[GRID_SIZE] = { 0.5f, 1.0f, 0.5f };
+
+// Grid lines in the normalized device coordinates of an eye, the same horizontally and vertically
+float gridBounds[GRID_SIZE + 1];
+
+// Radial distortion of the lens, as k1 and k2 of r' = r * (1 + k1 * r^2 + k2 * r^4), with r = 1 at the top of an eye.
+// The composition applies it the other way round, which compresses the periphery the lens then stretches out.
+const float lensDistortion[2] = { 0.22f, 0.24f };
+#endif
+
+// Gaze point in the normalized device coordinates of an eye, set by the gaze source with setGaze()
+float gazeX = 0.0f;
+float gazeY = 0.0f;
+
 const uint8_t circleStepConst = 16;
 
 // The textures should be multiple of 2
@@ -150,8 +219,34 @@ const uint16_t TextureSize = 2048;
 std::string assetFolder;
 Model3D::Model3D room;
 
+// Interleaved vertices of the room, see Model3D::build_interleaved_vertices
+GLuint roomVertexBuffer;
+
 std::vector<GLushort> I_OutsetCircle;
 
+// Cluster culling of the room, with a compute shader writing the indices of the visible clusters
+// and the indirect draw command drawing them. Without compute shaders the whole room is drawn.
+bool clusterCulling = false;
+GLuint clusterCullProgram;
+GLuint clusterCullFrustumPlanesLocation;
+GLuint clusterCullEyePositionsLocation;
+GLuint clusterCullClustersCountLocation;
+
+GLuint roomVertexArray;
+GLuint roomClusterBuffer;
+GLuint roomIndexBuffer;
+GLuint roomVisibleIndexBuffer;
+GLuint roomDrawCommandBuffer;
+
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint reservedMustBeZero;
+};
+
 
 #define GL_TEXTURE_2D_MULTISAMPLE_ARRAY 0x9102
 
@@ -169,6 +264,16 @@ PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXT glFramebufferTexture2DMultisampleEXT;
 typedef void( *PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXT )(GLenum, GLsizei, GLenum, GLsizei, GLsizei);
 PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXT glRenderbufferStorageMultisampleEXT;
 
+#define GL_MAX_VIEWS_OVR 0x9631
+
+// Foveated textures, used on top of the rings when available
+#define GL_FOVEATION_ENABLE_BIT_QCOM 0x00000001
+#define GL_FOVEATION_SCALED_BIN_METHOD_BIT_QCOM 0x00000002
+#define GL_TEXTURE_FOVEATED_FEATURE_BITS_QCOM 0x8BFB
+
+typedef void( *PFNGLTEXTUREFOVEATIONPARAMETERSQCOM )(GLuint, GLuint, GLuint, GLfloat, GLfloat, GLfloat, GLfloat, GLfloat);
+PFNGLTEXTUREFOVEATIONPARAMETERSQCOM glTextureFoveationParametersQCOM = NULL;
+
 /* Textured quad fragmentShader */
 static const char texturedQuadFragmentShader[] =
 "#version 300 es\n"
@@ -191,22 +296,72 @@ static const char texturedQuadFragmentShader[] =
 "uniform int layerIndex;\n"
 "uniform vec2 width_height;\n"
 
+#ifdef FOVEATED
+"#define RINGS " STRINGIFY(FOVEATION_RINGS) "\n"
+
+"uniform vec2 ringCenters[RINGS];\n"
+"uniform float ringRadii[RINGS];\n"
+#elif defined(LENS_MATCHED)
+"#define GRID_SIZE " STRINGIFY(GRID_SIZE) "\n"
+
+"uniform float gridBounds[GRID_SIZE + 1];\n"
+"uniform vec2 lensDistortion;\n"
+#endif
+
 "void main()\n"
 "{\n"
 #ifdef FOVEATED
-"   vec2 distVec = (vec2(0.5) - vHighResTexCoord) / vec2(1, width_height.x/width_height.y);\n"
-"   float squaredDist = dot(distVec, distVec);\n"
+"   vec2 position = vLowResTexCoord * 2.0 - 1.0;\n"
+"   vec4 border = vec4(0.0);\n"
 
-"   if( squaredDist > 0.25) { \n"
-"      fragColor = textureLod(tex, vec3(vLowResTexCoord, layerIndex), 0.0);\n"
+"   fragColor = textureLod(tex, vec3(vLowResTexCoord, layerIndex), 0.0);\n"
+
+	// Going from the outer to the inner rings, the innermost ring containing the fragment is kept
+"   for (int ring = 1; ring < RINGS; ++ring) { \n"
+"      vec2 ringTexCoord = (position - ringCenters[ring]) / ringRadii[ring] * 0.5 + 0.5;\n"
+"      vec2 distVec = (vec2(0.5) - ringTexCoord) / vec2(1, width_height.x/width_height.y);\n"
+"      float squaredDist = dot(distVec, distVec);\n"
+
+"      if( squaredDist <= 0.25) { \n"
+"         fragColor = textureLod(tex, vec3(ringTexCoord, layerIndex + 2 * ring), 0.0);\n"
+"      } \n"
+
+#ifdef RED
+"      if( squaredDist > 0.23 && squaredDist < 0.27) { \n"
+"         border = vec4(0.2,0.0,0.0,1.0);\n"
+"      } \n"
+#endif
+"   } \n"
+
+"   fragColor += border;\n"
+#elif defined(LENS_MATCHED)
+	// Pre-distort the eye against the lens, the fragments which end up outside of the grid are not seen
+"   vec2 position = vLowResTexCoord * 2.0 - 1.0;\n"
+"   vec2 lensPosition = position * vec2(width_height.x / width_height.y, 1.0);\n"
+"   float squaredRadius = dot(lensPosition, lensPosition);\n"
+"   position *= 1.0 + squaredRadius * (lensDistortion.x + squaredRadius * lensDistortion.y);\n"
+
+"   if (any(greaterThan(abs(position), vec2(1.0)))) { \n"
+"      fragColor = vec4(0.0, 0.0, 0.0, 1.0);\n"
+"      return;\n"
 "   } \n"
-"   else { \n"
-"      fragColor = textureLod(tex, vec3(vHighResTexCoord, layerIndex + 2), 0.0);\n"
+
+	// Find the cell containing the fragment, each cell covers a whole layer
+"   ivec2 cell = ivec2(0);\n"
+"   for (int line = 1; line < GRID_SIZE; ++line) { \n"
+"      cell += ivec2(greaterThanEqual(position, vec2(gridBounds[line])));\n"
 "   } \n"
 
+"   vec2 cellMin = vec2(gridBounds[cell.x], gridBounds[cell.y]);\n"
+"   vec2 cellMax = vec2(gridBounds[cell.x + 1], gridBounds[cell.y + 1]);\n"
+"   vec2 cellTexCoord = (position - cellMin) / (cellMax - cellMin);\n"
+
+"   fragColor = textureLod(tex, vec3(cellTexCoord, layerIndex + 2 * (cell.y * GRID_SIZE + cell.x)), 0.0);\n"
+
 #ifdef RED
-"   if( squaredDist > 0.23 && squaredDist < 0.27) { \n"
-"      fragColor += vec4(0.2,0.0,0.0,1.0);\n"
+"   vec2 edgeDist = min(cellTexCoord, 1.0 - cellTexCoord) * (cellMax - cellMin);\n"
+"   if (min(edgeDist.x, edgeDist.y) < 0.005) { \n"
+"      fragColor += vec4(0.2, 0.0, 0.0, 1.0);\n"
 "   } \n"
 #endif
 #else
@@ -281,7 +436,7 @@ void generateDepthCircleVBO( const uint8_t circleStep, const float radius )
 	for ( int j = 0; j < circleStep; ++j )
 	{
 		// Draw the inset mask
-		// The inset mask is dependent on the radius of the fovea region
+		// The inset mask is scaled and moved to the next ring by the mask shader
 		// A small ratio (0.9) is applied in order to prevent uncovered area between the two masks
 		/*
 				X
@@ -350,6 +505,138 @@ void generateDepthCircleVBO( const uint8_t circleStep, const float radius )
 	delete[] VX_OutsetCircle;
 }
 
+// Compute the ring centres, projections and masks for the current gaze point
+void updateFoveation()
+{
+	#ifdef FOVEATED
+	// Keep the inner rings inside the periphery
+	const float gazeLimit = 1.0f - foveationRingRadii[1];
+	const float x = fmaxf( -gazeLimit, fminf( gazeX, gazeLimit ) );
+	const float y = fmaxf( -gazeLimit, fminf( gazeY, gazeLimit ) );
+
+	GLfloat insetMasks[VIEWS * 3];
+
+	for ( int ring = 0; ring < FOVEATION_RINGS; ++ring )
+	{
+		const float radius = foveationRingRadii[ring];
+
+		foveationRingCenters[ring * 2 + 0] = ring == 0 ? 0.0f : x;
+		foveationRingCenters[ring * 2 + 1] = ring == 0 ? 0.0f : y;
+
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			const int view = ring * 2 + eye;
+
+			// Zoom the periphery projection into the ring, this gives an off-centre frustum around the gaze
+			projectionMatrix[view] = Matrix::createTranslation( -foveationRingCenters[ring * 2 + 0] / radius, -foveationRingCenters[ring * 2 + 1] / radius, 0.0f ) *
+									 Matrix::createScaling( 1.0f / radius, 1.0f / radius, 1.0f ) * peripheryProjectionMatrix;
+
+			// Mask out the part of the ring covered by the next one, in the coordinates of this ring
+			if ( ring + 1 < FOVEATION_RINGS )
+			{
+				insetMasks[view * 3 + 0] = (x - foveationRingCenters[ring * 2 + 0]) / radius;
+				insetMasks[view * 3 + 1] = (y - foveationRingCenters[ring * 2 + 1]) / radius;
+				insetMasks[view * 3 + 2] = foveationRingRadii[ring + 1] / radius * 0.9f;
+			}
+			else
+			{
+				insetMasks[view * 3 + 0] = 0.0f;
+				insetMasks[view * 3 + 1] = 0.0f;
+				insetMasks[view * 3 + 2] = 0.0f;
+			}
+		}
+	}
+
+	#ifdef MASK
+	GL_CHECK( glUseProgram( maskProgram ) );
+	GL_CHECK( glUniform3fv( maskInsetMasksLocation, VIEWS, insetMasks ) );
+	#endif
+
+	// Let the periphery layers also lose density away from the gaze
+	if ( glTextureFoveationParametersQCOM != NULL )
+	{
+		for ( GLuint eye = 0; eye < 2; ++eye )
+		{
+			GL_CHECK( glTextureFoveationParametersQCOM( frameBufferTextureId, eye, 0, x, y, 1.0f, 1.0f, 0.0f ) );
+		}
+	}
+	#elif defined(LENS_MATCHED)
+	// The grid does not follow the gaze, its projections are set up once by setupGrid()
+	foveationRingCenters[0] = 0.0f;
+	foveationRingCenters[1] = 0.0f;
+	#else
+	for ( int view = 0; view < VIEWS; ++view )
+	{
+		projectionMatrix[view] = peripheryProjectionMatrix;
+	}
+
+	foveationRingCenters[0] = 0.0f;
+	foveationRingCenters[1] = 0.0f;
+	#endif
+}
+
+#ifdef LENS_MATCHED
+// Size of the layer of a cell, relative to an eye on the screen
+float gridLayerRatio()
+{
+	// A cell of scale s covers 2 * ratio / s of the normalized device coordinates, and the cells cover all of them
+	float inverseScalesSum = 0.0f;
+	for ( int i = 0; i < GRID_SIZE; ++i )
+	{
+		inverseScalesSum += 1.0f / gridScales[i];
+	}
+
+	return 1.0f / inverseScalesSum;
+}
+
+// Place the grid lines and compute the projection of each cell, which is fixed to the lens
+void setupGrid()
+{
+	const float ratio = gridLayerRatio();
+
+	gridBounds[0] = -1.0f;
+	for ( int i = 0; i < GRID_SIZE; ++i )
+	{
+		gridBounds[i + 1] = gridBounds[i] + 2.0f * ratio / gridScales[i];
+	}
+	gridBounds[GRID_SIZE] = 1.0f;
+
+	for ( int row = 0; row < GRID_SIZE; ++row )
+	{
+		for ( int column = 0; column < GRID_SIZE; ++column )
+		{
+			const float centerX = 0.5f * (gridBounds[column] + gridBounds[column + 1]);
+			const float centerY = 0.5f * (gridBounds[row] + gridBounds[row + 1]);
+			const float scaleX = 2.0f / (gridBounds[column + 1] - gridBounds[column]);
+			const float scaleY = 2.0f / (gridBounds[row + 1] - gridBounds[row]);
+
+			// Like the foveation rings, each cell zooms the full projection into an off-centre frustum,
+			// which also clips away what the other cells render
+			for ( int eye = 0; eye < 2; ++eye )
+			{
+				const int view = (row * GRID_SIZE + column) * 2 + eye;
+
+				projectionMatrix[view] = Matrix::createTranslation( -centerX * scaleX, -centerY * scaleY, 0.0f ) *
+										 Matrix::createScaling( scaleX, scaleY, 1.0f ) * peripheryProjectionMatrix;
+			}
+		}
+	}
+
+	LOGI( "Lens matched grid of %d cells per eye, %.0f%% of the pixels of the eye are rendered.\n",
+		  GRID_SIZE * GRID_SIZE, 100.0f * GRID_SIZE * GRID_SIZE * ratio * ratio );
+}
+#endif
+
+// Insert a #define line after the #version line of a shader
+std::string insertShaderDefine( const char* shaderSource, int shaderLength, const std::string &define )
+{
+	std::string source( shaderSource, shaderLength );
+
+	source.insert( source.find( '\n' ) + 1, define + "\n" );
+
+	return source;
+}
+
 GLuint loadShader( GLenum shaderType, const char* shaderSource, const int* length = NULL )
 {
 	GLuint shader = GL_CHECK( glCreateShader( shaderType ) );
@@ -505,6 +792,18 @@ bool setupFBO( int width, int height )
 	GL_CHECK( glBindTexture( GL_TEXTURE_2D_ARRAY, frameBufferTextureId ) );
 	GL_CHECK( glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR ) );
 	GL_CHECK( glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR ) );
+	#ifdef FOVEATED
+	if ( glTextureFoveationParametersQCOM != NULL )
+	{
+		GL_CHECK( glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_FOVEATED_FEATURE_BITS_QCOM,
+								   GL_FOVEATION_ENABLE_BIT_QCOM | GL_FOVEATION_SCALED_BIN_METHOD_BIT_QCOM ) );
+	}
+	#endif
+	#ifdef LENS_MATCHED
+	// The cells are sampled up to their edges, which must not blend with the opposite edge
+	GL_CHECK( glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE ) );
+	GL_CHECK( glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE ) );
+	#endif
 	GL_CHECK( glTexStorage3D( GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, width, height, VIEWS ) );
 
 	// Generate depth texture
@@ -513,25 +812,173 @@ bool setupFBO( int width, int height )
 	GL_CHECK( glTexStorage3D( GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT24, width, height, VIEWS ) );
 
 
-	GL_CHECK( glGenFramebuffers( 1, &frameBufferObjectId ) );
-	GL_CHECK( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, frameBufferObjectId ) );
+	// Each pass renders the next viewsPerPass layers
+	for ( int pass = 0; pass < VIEWS / viewsPerPass; ++pass )
+	{
+		GL_CHECK( glGenFramebuffers( 1, &frameBufferObjectId[pass] ) );
+		GL_CHECK( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, frameBufferObjectId[pass] ) );
 
-	GL_CHECK( glFramebufferTextureMultisampleMultiviewOVR( GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, frameBufferTextureId, 0, 4, 0, VIEWS ) );
-	GL_CHECK( glFramebufferTextureMultisampleMultiviewOVR( GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, frameBufferDepthTextureId, 0, 4, 0, VIEWS ) );
+		GL_CHECK( glFramebufferTextureMultisampleMultiviewOVR( GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, frameBufferTextureId, 0, 4, pass * viewsPerPass, viewsPerPass ) );
+		GL_CHECK( glFramebufferTextureMultisampleMultiviewOVR( GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, frameBufferDepthTextureId, 0, 4, pass * viewsPerPass, viewsPerPass ) );
 
-	GLenum result = GL_CHECK( glCheckFramebufferStatus( GL_DRAW_FRAMEBUFFER ) );
-	if ( result != GL_FRAMEBUFFER_COMPLETE )
+		GLenum result = GL_CHECK( glCheckFramebufferStatus( GL_DRAW_FRAMEBUFFER ) );
+		if ( result != GL_FRAMEBUFFER_COMPLETE )
+		{
+			LOGE( "Framebuffer incomplete at %s:%i\n", __FILE__, __LINE__ );
+			/* Unbind framebuffer. */
+			GL_CHECK( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, 0 ) );
+			return false;
+		}
+	}
+	#endif
+
+	return true;
+}
+
+// Point the attributes of the room program at the interleaved vertices of the room, in the bound GL_ARRAY_BUFFER
+void enableRoomAttributes()
+{
+	room.enable_attribute( Model3D::Model3D::ATTRIBUTE_POSITION, multiviewVertexLocation );
+	room.enable_attribute( Model3D::Model3D::ATTRIBUTE_NORMAL, multiviewVertexNormalLocation );
+	room.enable_attribute( Model3D::Model3D::ATTRIBUTE_TEXTURE_COORDINATES0, multiviewVertexUVLocation );
+	room.enable_attribute( Model3D::Model3D::ATTRIBUTE_TANGENT, multiviewVertexTangentLocation );
+}
+
+// Upload the room and its clusters to buffers, and build the culling program
+bool setupClusterCulling()
+{
+	GLint majorVersion = 0;
+	GLint minorVersion = 0;
+	GL_CHECK( glGetIntegerv( GL_MAJOR_VERSION, &majorVersion ) );
+	GL_CHECK( glGetIntegerv( GL_MINOR_VERSION, &minorVersion ) );
+	if ( majorVersion * 10 + minorVersion < 31 || room.get_clusters_count() == 0 )
 	{
-		LOGE( "Framebuffer incomplete at %s:%i\n", __FILE__, __LINE__ );
-		/* Unbind framebuffer. */
-		GL_CHECK( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, 0 ) );
+		LOGI( "Cluster culling needs OpenGL ES 3.1, the whole room is drawn.\n" );
 		return false;
 	}
-	#endif
 
+	// The compute shader is built for the number of views of a pass, like the room shaders
+	char viewsDefine[32];
+	snprintf( viewsDefine, sizeof( viewsDefine ), "#define VIEWS %d", viewsPerPass );
+
+	int computeShaderLength;
+	const char* computeShaderSource = loadShaderFromFile( assetFolder + "clusterCull.cs", &computeShaderLength );
+	std::string clusterCullShaderSource = insertShaderDefine( computeShaderSource, computeShaderLength, viewsDefine );
+	delete[] computeShaderSource;
+
+	GLuint computeShader = loadShader( GL_COMPUTE_SHADER, clusterCullShaderSource.c_str() );
+	if ( computeShader == 0 )
+	{
+		return false;
+	}
+
+	clusterCullProgram = GL_CHECK( glCreateProgram() );
+	GL_CHECK( glAttachShader( clusterCullProgram, computeShader ) );
+	GL_CHECK( glLinkProgram( clusterCullProgram ) );
+	GL_CHECK( glDeleteShader( computeShader ) );
+
+	GLint linkStatus = GL_FALSE;
+	GL_CHECK( glGetProgramiv( clusterCullProgram, GL_LINK_STATUS, &linkStatus ) );
+	if ( linkStatus != GL_TRUE )
+	{
+		LOGE( "Could not link cluster culling program" );
+		GL_CHECK( glDeleteProgram( clusterCullProgram ) );
+		return false;
+	}
+
+	clusterCullFrustumPlanesLocation = GL_CHECK( glGetUniformLocation( clusterCullProgram, "frustumPlanes" ) );
+	clusterCullEyePositionsLocation = GL_CHECK( glGetUniformLocation( clusterCullProgram, "eyePositions" ) );
+	clusterCullClustersCountLocation = GL_CHECK( glGetUniformLocation( clusterCullProgram, "clustersCount" ) );
+
+	// Indirect draws cannot source client side arrays, the interleaved vertices are attached to a vertex array
+	GL_CHECK( glGenVertexArrays( 1, &roomVertexArray ) );
+	GL_CHECK( glBindVertexArray( roomVertexArray ) );
+	GL_CHECK( glBindBuffer( GL_ARRAY_BUFFER, roomVertexBuffer ) );
+	enableRoomAttributes();
+
+	// The visible indices are the element array of the vertex array, the culling pass rewrites them every frame
+	const GLsizeiptr indicesSize = room.get_indices_count() * 3 * sizeof( GLuint );
+
+	GL_CHECK( glGenBuffers( 1, &roomVisibleIndexBuffer ) );
+	GL_CHECK( glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, roomVisibleIndexBuffer ) );
+	GL_CHECK( glBufferData( GL_ELEMENT_ARRAY_BUFFER, indicesSize, NULL, GL_DYNAMIC_DRAW ) );
+	GL_CHECK( glBindVertexArray( 0 ) );
+	GL_CHECK( glBindBuffer( GL_ARRAY_BUFFER, 0 ) );
+
+	GL_CHECK( glGenBuffers( 1, &roomIndexBuffer ) );
+	GL_CHECK( glBindBuffer( GL_SHADER_STORAGE_BUFFER, roomIndexBuffer ) );
+	GL_CHECK( glBufferData( GL_SHADER_STORAGE_BUFFER, indicesSize, room.get_indices(), GL_STATIC_DRAW ) );
+
+	GL_CHECK( glGenBuffers( 1, &roomClusterBuffer ) );
+	GL_CHECK( glBindBuffer( GL_SHADER_STORAGE_BUFFER, roomClusterBuffer ) );
+	GL_CHECK( glBufferData( GL_SHADER_STORAGE_BUFFER, room.get_clusters_count() * sizeof( Model3D::Cluster ), room.get_clusters(), GL_STATIC_DRAW ) );
+
+	GL_CHECK( glGenBuffers( 1, &roomDrawCommandBuffer ) );
+	GL_CHECK( glBindBuffer( GL_SHADER_STORAGE_BUFFER, roomDrawCommandBuffer ) );
+	GL_CHECK( glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( DrawElementsIndirectCommand ), NULL, GL_DYNAMIC_DRAW ) );
+	GL_CHECK( glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 ) );
+
+	LOGI( "Culling %u clusters of the room on the GPU.\n", room.get_clusters_count() );
 	return true;
 }
 
+// Write the indices of the clusters visible from any view of a pass, and the command drawing them
+void cullClusters( const int firstView )
+{
+	GLfloat frustumPlanes[VIEWS * 6 * 4];
+	GLfloat eyePositions[VIEWS * 3];
+
+	for ( int view = 0; view < viewsPerPass; ++view )
+	{
+		// The planes of the clip volume, taken from the rows of the model view projection, are in model space
+		Matrix &matrix = modelViewProjectionMatrix[firstView + view];
+
+		for ( int plane = 0; plane < 6; ++plane )
+		{
+			const int row = plane / 2;
+			const float sign = plane % 2 == 0 ? 1.0f : -1.0f;
+			GLfloat *frustumPlane = frustumPlanes + (view * 6 + plane) * 4;
+
+			for ( int column = 0; column < 4; ++column )
+			{
+				frustumPlane[column] = matrix[column * 4 + 3] + sign * matrix[column * 4 + row];
+			}
+
+			const float length = sqrtf( frustumPlane[0] * frustumPlane[0] + frustumPlane[1] * frustumPlane[1] + frustumPlane[2] * frustumPlane[2] );
+			for ( int column = 0; column < 4; ++column )
+			{
+				frustumPlane[column] /= length;
+			}
+		}
+
+		// The eye is the translation of the inverse model view
+		Matrix modelViewInverse = Matrix::matrixInvert( &modelViewMatrix[firstView + view] );
+		eyePositions[view * 3 + 0] = modelViewInverse[12];
+		eyePositions[view * 3 + 1] = modelViewInverse[13];
+		eyePositions[view * 3 + 2] = modelViewInverse[14];
+	}
+
+	const DrawElementsIndirectCommand emptyCommand = { 0, 1, 0, 0, 0 };
+	GL_CHECK( glBindBuffer( GL_SHADER_STORAGE_BUFFER, roomDrawCommandBuffer ) );
+	GL_CHECK( glBufferSubData( GL_SHADER_STORAGE_BUFFER, 0, sizeof( emptyCommand ), &emptyCommand ) );
+	GL_CHECK( glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 ) );
+
+	GL_CHECK( glUseProgram( clusterCullProgram ) );
+	GL_CHECK( glUniform4fv( clusterCullFrustumPlanesLocation, viewsPerPass * 6, frustumPlanes ) );
+	GL_CHECK( glUniform3fv( clusterCullEyePositionsLocation, viewsPerPass, eyePositions ) );
+	GL_CHECK( glUniform1ui( clusterCullClustersCountLocation, room.get_clusters_count() ) );
+
+	GL_CHECK( glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, roomClusterBuffer ) );
+	GL_CHECK( glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 1, roomIndexBuffer ) );
+	GL_CHECK( glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, roomVisibleIndexBuffer ) );
+	GL_CHECK( glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 3, roomDrawCommandBuffer ) );
+
+	GL_CHECK( glDispatchCompute( (room.get_clusters_count() + 63) / 64, 1, 1 ) );
+
+	// The draw reads the command and the indices the dispatch has written
+	GL_CHECK( glMemoryBarrier( GL_COMMAND_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT ) );
+}
+
 bool setupGraphics( int width, int height )
 {
 	#ifdef FOVEATED
@@ -540,6 +987,8 @@ bool setupGraphics( int width, int height )
 	#else
 	LOGI( "Running with foveated rendering." );
 	#endif
+	#elif defined(LENS_MATCHED)
+	LOGI( "Running with lens matched rendering." );
 	#elif defined(MULTIVIEW)
 	LOGI( "Running with multiview." );
 	#else
@@ -590,8 +1039,34 @@ bool setupGraphics( int width, int height )
 			LOGI( "Cannot get proc address for glFramebufferTextureMultisampleMultiviewOVR.\n" );
 			exit( EXIT_FAILURE );
 		}
+
+		GLint maxViews = 0;
+		GL_CHECK( glGetIntegerv( GL_MAX_VIEWS_OVR, &maxViews ) );
+		#ifdef LENS_MATCHED
+		// The cells are split in passes of the same number of views
+		while ( viewsPerPass > maxViews || VIEWS % viewsPerPass != 0 )
+		{
+			--viewsPerPass;
+		}
+		LOGI( "The %d views of the grid are rendered in %d passes.\n", VIEWS, VIEWS / viewsPerPass );
+		#else
+		if ( maxViews < VIEWS )
+		{
+			LOGI( "GL_OVR_multiview supports %d views, %d are needed for %d foveation rings.\n", maxViews, VIEWS, FOVEATION_RINGS );
+			exit( EXIT_FAILURE );
+		}
+		#endif
 	}
 
+	#ifdef FOVEATED
+	if ( strstr( (const char*) extensions, "GL_QCOM_texture_foveated" ) != NULL )
+	{
+		glTextureFoveationParametersQCOM =
+			(PFNGLTEXTUREFOVEATIONPARAMETERSQCOM) eglGetProcAddress( "glTextureFoveationParametersQCOM" );
+	}
+	LOGI( "Foveated textures are %s.", glTextureFoveationParametersQCOM != NULL ? "used" : "not supported" );
+	#endif
+
 	GL_CHECK( glDisable( GL_CULL_FACE ) );
 	GL_CHECK( glEnable( GL_DEPTH_TEST ) );
 	GL_CHECK( glDepthFunc( GL_LEQUAL ) );
@@ -601,8 +1076,14 @@ bool setupGraphics( int width, int height )
 	screenHeight = height;
 
 	// Set fbo size based on screen width/height
+	#ifdef LENS_MATCHED
+	// Every layer holds a cell
+	fboWidth = (screenWidth / 2) * gridLayerRatio();
+	fboHeight = screenHeight * gridLayerRatio();
+	#else
 	fboWidth = (screenWidth / 2) * RATIO;
 	fboHeight = screenHeight * RATIO;
+	#endif
 
 	LOGI( "Resolution is %u-%u on %u-%u screen resolution", fboWidth, fboHeight, screenWidth, screenHeight );
 
@@ -628,9 +1109,13 @@ bool setupGraphics( int width, int height )
 	texturedQuadLayerIndexLocation = GL_CHECK( glGetUniformLocation( texturedQuadProgram, "layerIndex" ) );
 	textureQuadFoveatedRatio = GL_CHECK( glGetUniformLocation( texturedQuadProgram, "foveatedRatio" ) );
 	textureQuadWidthHeight = GL_CHECK( glGetUniformLocation( texturedQuadProgram, "width_height" ) );
+	textureQuadRingCenters = GL_CHECK( glGetUniformLocation( texturedQuadProgram, "ringCenters" ) );
+	textureQuadRingRadii = GL_CHECK( glGetUniformLocation( texturedQuadProgram, "ringRadii" ) );
+	textureQuadGridBounds = GL_CHECK( glGetUniformLocation( texturedQuadProgram, "gridBounds" ) );
+	textureQuadLensDistortion = GL_CHECK( glGetUniformLocation( texturedQuadProgram, "lensDistortion" ) );
 
 	/* Creating program for drawing object with multiview. */
-	#ifdef FOVEATED
+	#if defined FOVEATED || defined LENS_MATCHED
 	std::string roomVertexShader = assetFolder + "roomFoveated.vs";
 	#elif defined(MULTIVIEW)
 	std::string roomVertexShader = assetFolder + "roomMultiview.vs";
@@ -638,7 +1123,20 @@ bool setupGraphics( int width, int height )
 	std::string roomVertexShader = assetFolder + "roomRegular.vs";
 	#endif // FOVEATED
 
+	#if defined FOVEATED || defined LENS_MATCHED
+	// The foveated shaders are built for the number of views used by the rings, or by a pass over the grid cells.
+	// Layout qualifiers only take literals, so VIEWS has to be evaluated here.
+	char viewsDefine[32];
+	snprintf( viewsDefine, sizeof( viewsDefine ), "#define VIEWS %d", viewsPerPass );
+
+	const char* roomVertexShaderSource = loadShaderFromFile( roomVertexShader, &vertexShaderLength );
+	std::string roomFoveatedVertexShaderSource = insertShaderDefine( roomVertexShaderSource, vertexShaderLength, viewsDefine );
+	delete[] roomVertexShaderSource;
+
+	multiviewProgram = createProgram( roomFoveatedVertexShaderSource.c_str(), loadShaderFromFile( assetFolder + "roomPBR.fs", &fragmentShaderLength ), NULL, &fragmentShaderLength );
+	#else
 	multiviewProgram = createProgram( loadShaderFromFile( roomVertexShader, &vertexShaderLength ), loadShaderFromFile( assetFolder + "roomPBR.fs", &fragmentShaderLength ), &vertexShaderLength, &fragmentShaderLength );
+	#endif
 	if ( multiviewProgram == 0 )
 	{
 		LOGE( "Could not create multiview program" );
@@ -666,7 +1164,11 @@ bool setupGraphics( int width, int height )
 	//multiviewTimeLocation = GL_CHECK( glGetUniformLocation( multiviewProgram, "time" ) );
 
 	#if defined FOVEATED && defined MASK
-	maskProgram = createProgram( loadShaderFromFile( assetFolder + "mask.vs", &vertexShaderLength ), loadShaderFromFile( assetFolder + "mask.fs", &fragmentShaderLength ), &vertexShaderLength, &fragmentShaderLength );
+	const char* maskVertexShaderSource = loadShaderFromFile( assetFolder + "mask.vs", &vertexShaderLength );
+	std::string maskViewsVertexShaderSource = insertShaderDefine( maskVertexShaderSource, vertexShaderLength, viewsDefine );
+	delete[] maskVertexShaderSource;
+
+	maskProgram = createProgram( maskViewsVertexShaderSource.c_str(), loadShaderFromFile( assetFolder + "mask.fs", &fragmentShaderLength ), NULL, &fragmentShaderLength );
 	if ( maskProgram == 0 )
 	{
 		LOGE( "Could not create mask program %i", maskProgram );
@@ -674,28 +1176,27 @@ bool setupGraphics( int width, int height )
 	}
 	maskVertexLocation = GL_CHECK( glGetAttribLocation( maskProgram, "vertexPosition" ) );
 	maskTypeLocation = GL_CHECK( glGetUniformLocation( maskProgram, "maskType" ) );
+	maskInsetMasksLocation = GL_CHECK( glGetUniformLocation( maskProgram, "insetMasks" ) );
 
-	generateDepthCircleVBO( circleStepConst, RATIO );
+	// The inset mask is scaled to each ring by the shader
+	generateDepthCircleVBO( circleStepConst, 1.0f );
 	#endif
 
 	/*
-	 * Set up the perspective matrices for each view. Rendering is done twice in each eye position with different
-	 * field of view. The narrower field of view should give half the size for the near plane in order to
-	 * render the center of the scene at a higher resolution. The resulting high resolution and low resolution
-	 * images will later be interpolated to create an image with higher resolution in the center of the screen
-	 * than on the outer parts of the screen.
+	 * Set up the perspective matrices for each view. Rendering is done once per foveation ring in each eye position,
+	 * with a narrower field of view for every inner ring. A ring whose radius is RATIO gives RATIO times the size
+	 * for the near plane in order to render that part of the scene at a higher resolution. The resulting images
+	 * will later be interpolated to create an image with higher resolution around the gaze point
+	 * than on the outer parts of the screen. The inner ring projections are updated with the gaze in updateFoveation().
 	 * 1.5707963268 rad = 90 degrees.
-	 * 0.9272952188 rad = 53.1301024 degrees. This angle gives half the size for the near plane.
 	 */
 	const float FOV = M_PI_2;
-	double insetFOV = std::atan( std::tan( FOV / 2 ) * RATIO ) * 2;
 
-	projectionMatrix[0] = Matrix::matrixPerspective( FOV, (float) (width/2) / (float) height, 0.1f, 1000.0f );
-	projectionMatrix[1] = Matrix::matrixPerspective( FOV, (float) (width / 2) / (float) height, 0.1f, 1000.0f );
-	#ifdef FOVEATED
-	projectionMatrix[2] = Matrix::matrixPerspective( insetFOV, (float) (width / 2) / (float) height, 0.1f, 1000.0f );
-	projectionMatrix[3] = Matrix::matrixPerspective( insetFOV, (float) (width / 2) / (float) height, 0.1f, 1000.0f );
+	peripheryProjectionMatrix = Matrix::matrixPerspective( FOV, (float) (width / 2) / (float) height, 0.1f, 1000.0f );
+	#ifdef LENS_MATCHED
+	setupGrid();
 	#endif
+	updateFoveation();
 
 	/* Setting up model view matrices for each of the */
 	Vec3f leftCameraPos = { -0.5f, 0.0f, 5.0f };
@@ -704,10 +1205,10 @@ bool setupGraphics( int width, int height )
 	Vec3f upVec = { 0.0f, 1.0f, 0.0f };
 	viewMatrix[0] = Matrix::matrixCameraLookAt( leftCameraPos, lookAt, upVec );
 	viewMatrix[1] = Matrix::matrixCameraLookAt( rightCameraPos, lookAt, upVec );
-	#ifdef FOVEATED
-	viewMatrix[2] = Matrix::matrixCameraLookAt( leftCameraPos, lookAt, upVec );
-	viewMatrix[3] = Matrix::matrixCameraLookAt( rightCameraPos, lookAt, upVec );
-	#endif
+	for ( int view = 2; view < VIEWS; ++view )
+	{
+		viewMatrix[view] = viewMatrix[view % 2];
+	}
 
 	if ( !room.load( assetFolder + "room.geom" ) )
 	{
@@ -716,6 +1217,13 @@ bool setupGraphics( int width, int height )
 	}
 	LOGI( "Asset Loaded" );
 
+	GL_CHECK( glGenBuffers( 1, &roomVertexBuffer ) );
+	GL_CHECK( glBindBuffer( GL_ARRAY_BUFFER, roomVertexBuffer ) );
+	GL_CHECK( glBufferData( GL_ARRAY_BUFFER, room.get_interleaved_vertices_size(), room.get_interleaved_vertices(), GL_STATIC_DRAW ) );
+	GL_CHECK( glBindBuffer( GL_ARRAY_BUFFER, 0 ) );
+
+	clusterCulling = setupClusterCulling();
+
 	// Create and load textures
 	createTexture( assetFolder + "T_Exterior_D.raw", &textureIdDiffuse );
 	createTexture( assetFolder + "T_Exterior_N.raw", &textureIdNormal );
@@ -726,8 +1234,23 @@ bool setupGraphics( int width, int height )
 	return true;
 }
 
-void renderToFBO( const int width, const int height, const GLuint frameBufferID )
+// Render the views firstView to firstView + viewsPerPass - 1
+void renderToFBO( const int width, const int height, const GLuint frameBufferID, const int firstView )
 {
+	modelMatrix = Matrix::createTranslation( 0.0, 30.0, -45.0 ) * Matrix::createScaling( 0.2, 0.2, 0.2 ) * Matrix::createRotationX( -90.0 ) * Matrix::createRotationZ( 90.0 );
+
+	for ( int i = 0; i < VIEWS; ++i )
+	{
+		modelViewMatrix[i] = viewMatrix[i] * modelMatrix;
+		modelViewProjectionMatrix[i] = projectionMatrix[i] * modelViewMatrix[i];
+	}
+
+	// Cull before the framebuffer is bound, so the render pass is not split by the dispatch
+	if ( clusterCulling )
+	{
+		cullClusters( firstView );
+	}
+
 	/* Rendering to FBO. */
 	GL_CHECK( glViewport( 0, 0, width, height ) );
 
@@ -765,36 +1288,20 @@ void renderToFBO( const int width, const int height, const GLuint frameBufferID
 	GL_CHECK( glActiveTexture( GL_TEXTURE4 ) );
 	GL_CHECK( glBindTexture( GL_TEXTURE_2D, textureIdBump ) );
 
-	modelMatrix = Matrix::createTranslation( 0.0, 30.0, -45.0 ) * Matrix::createScaling( 0.2, 0.2, 0.2 ) * Matrix::createRotationX( -90.0 ) * Matrix::createRotationZ( 90.0 );
-	
-	for ( int i = 0; i < VIEWS; ++i )
-	{
-		modelViewMatrix[i] = viewMatrix[i] * modelMatrix;
-		modelViewProjectionMatrix[i] = projectionMatrix[i] * modelViewMatrix[i];
-	}
-
 	GL_CHECK( glUseProgram( multiviewProgram ) );
 
-	GL_CHECK( glUniformMatrix4fv( multiviewViewLocation, VIEWS, GL_FALSE, viewMatrix[0].getAsArray() ) );
-	GL_CHECK( glUniformMatrix4fv( multiviewProjectionLocation, VIEWS, GL_FALSE, projectionMatrix[0].getAsArray() ) );
-	GL_CHECK( glUniformMatrix4fv( multiviewModelViewLocation, VIEWS, GL_FALSE, modelViewMatrix[0].getAsArray() ) );
-	GL_CHECK( glUniformMatrix4fv( multiviewModelViewProjectionLocation, VIEWS, GL_FALSE, modelViewProjectionMatrix[0].getAsArray() ) );
-
-	// Upload vertex location
-	GL_CHECK( glVertexAttribPointer( multiviewVertexLocation, 3, GL_FLOAT, GL_FALSE, 0, room.get_positions() ) );
-	GL_CHECK( glEnableVertexAttribArray( multiviewVertexLocation ) );
+	GL_CHECK( glUniformMatrix4fv( multiviewViewLocation, viewsPerPass, GL_FALSE, viewMatrix[firstView].getAsArray() ) );
+	GL_CHECK( glUniformMatrix4fv( multiviewProjectionLocation, viewsPerPass, GL_FALSE, projectionMatrix[firstView].getAsArray() ) );
+	GL_CHECK( glUniformMatrix4fv( multiviewModelViewLocation, viewsPerPass, GL_FALSE, modelViewMatrix[firstView].getAsArray() ) );
+	GL_CHECK( glUniformMatrix4fv( multiviewModelViewProjectionLocation, viewsPerPass, GL_FALSE, modelViewProjectionMatrix[firstView].getAsArray() ) );
 
-	// Upload vertex normal
-	GL_CHECK( glVertexAttribPointer( multiviewVertexNormalLocation, 3, GL_FLOAT, GL_FALSE, 0, room.get_normals() ) );
-	GL_CHECK( glEnableVertexAttribArray( multiviewVertexNormalLocation ) );
-
-	// Upload vertex UV
-	GL_CHECK( glVertexAttribPointer( multiviewVertexUVLocation, 3, GL_FLOAT, GL_FALSE, 0, room.get_texture_coordinates0() ) );
-	GL_CHECK( glEnableVertexAttribArray( multiviewVertexUVLocation ) );
-
-	// Upload vertex tangent
-	GL_CHECK( glVertexAttribPointer( multiviewVertexTangentLocation, 3, GL_FLOAT, GL_FALSE, 0, room.get_tangents() ) );
-	GL_CHECK( glEnableVertexAttribArray( multiviewVertexTangentLocation ) );
+	if ( !clusterCulling )
+	{
+		// Point the attributes at the interleaved vertices, the indices stay client side
+		GL_CHECK( glBindBuffer( GL_ARRAY_BUFFER, roomVertexBuffer ) );
+		enableRoomAttributes();
+		GL_CHECK( glBindBuffer( GL_ARRAY_BUFFER, 0 ) );
+	}
 
 	/* Upload model view projection matrices. */
 	GL_CHECK( glUniformMatrix4fv( multiviewModelLocation, 1, GL_FALSE, modelMatrix.getAsArray() ) );
@@ -809,7 +1316,19 @@ void renderToFBO( const int width, const int height, const GLuint frameBufferID
 
 
 	/* Draw the room. */
-	GL_CHECK( glDrawElements( GL_TRIANGLES, room.get_indices_count() * 3, GL_UNSIGNED_INT, room.get_indices() ) );
+	if ( clusterCulling )
+	{
+		// Only the triangles of the clusters visible in one of the views are rasterized
+		GL_CHECK( glBindVertexArray( roomVertexArray ) );
+		GL_CHECK( glBindBuffer( GL_DRAW_INDIRECT_BUFFER, roomDrawCommandBuffer ) );
+		GL_CHECK( glDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, (void*) 0 ) );
+		GL_CHECK( glBindBuffer( GL_DRAW_INDIRECT_BUFFER, 0 ) );
+		GL_CHECK( glBindVertexArray( 0 ) );
+	}
+	else
+	{
+		GL_CHECK( glDrawElements( GL_TRIANGLES, room.get_indices_count() * 3, GL_UNSIGNED_INT, room.get_indices() ) );
+	}
 
 	// Invalidate the depth buffer
 	GLenum invalidateList[] = { GL_DEPTH_ATTACHMENT };
@@ -824,11 +1343,14 @@ void renderFrame()
 	// Start the render frame timer
 	Stats::StartFrame();
 
+	// Follow the latest gaze point
+	updateFoveation();
+
 
 	#ifdef REGULAR
 	for ( int i = 0; i < 2; ++i )
 	{
-		renderToFBO( fboWidth, fboHeight, frameBufferObjectId[i] );
+		renderToFBO( fboWidth, fboHeight, frameBufferObjectId[i], 0 );
 
 	}
 	#else
@@ -836,7 +1358,10 @@ void renderFrame()
 	* Render the scene to the multiview texture. This will render to 4 different layers of the texture,
 	* using different projection and view matrices for each layer.
 	*/
-	renderToFBO( fboWidth, fboHeight, frameBufferObjectId );
+	for ( int pass = 0; pass < VIEWS / viewsPerPass; ++pass )
+	{
+		renderToFBO( fboWidth, fboHeight, frameBufferObjectId[pass], pass * viewsPerPass );
+	}
 	#endif
 
 
@@ -884,6 +1409,13 @@ void renderFrame()
 		GL_CHECK( glUniform1i( texturedQuadLayerIndexLocation, i ) );
 		GL_CHECK( glUniform1f( textureQuadFoveatedRatio, RATIO ) );
 		GL_CHECK( glUniform2f( textureQuadWidthHeight, screenWidth / 2.0, screenHeight ) );
+		#ifdef FOVEATED
+		GL_CHECK( glUniform2fv( textureQuadRingCenters, FOVEATION_RINGS, foveationRingCenters ) );
+		GL_CHECK( glUniform1fv( textureQuadRingRadii, FOVEATION_RINGS, foveationRingRadii ) );
+		#elif defined(LENS_MATCHED)
+		GL_CHECK( glUniform1fv( textureQuadGridBounds, GRID_SIZE + 1, gridBounds ) );
+		GL_CHECK( glUniform2fv( textureQuadLensDistortion, 1, lensDistortion ) );
+		#endif
 
 		/* Draw textured quad using the multiview texture. */
 		GL_CHECK( glDrawArrays( GL_TRIANGLES, 0, 6 ) );
@@ -904,6 +1436,8 @@ extern "C"
 			JNIEnv * env, jobject obj, jint width, jint height, jstring localPath );
 	JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_foveatedrendering_NativeLibrary_step(
 			JNIEnv * env, jobject obj );
+	JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_foveatedrendering_NativeLibrary_setGaze(
+			JNIEnv * env, jobject obj, jfloat x, jfloat y );
 };
 
 JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_foveatedrendering_NativeLibrary_init(
@@ -919,3 +1453,11 @@ JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_foveatedrendering_
 {
 	renderFrame();
 }
+
+// The gaze point is given in the normalized device coordinates of an eye, and is used from the next frame
+JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_foveatedrendering_NativeLibrary_setGaze(
+		JNIEnv * env, jobject obj, jfloat x, jfloat y )
+{
+	gazeX = x;
+	gazeY = y;
+}
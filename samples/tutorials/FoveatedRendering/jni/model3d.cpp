@@ -27,6 +27,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cmath>
 
 namespace Model3D
 {
@@ -119,6 +121,7 @@ namespace Model3D
         this->m_positions               = NULL;
         this->m_texture_coordinates0    = NULL;
         this->m_normals                 = NULL;
+        this->m_tangents                = NULL;
         this->m_bone_ids                = NULL;
         this->m_weights                 = NULL;
         this->m_materials               = NULL;
@@ -131,6 +134,11 @@ namespace Model3D
 
         this->m_bounding_box_minimum    = NULL;
         this->m_bounding_box_maximum    = NULL;
+
+        for (int i = 0; i < ATTRIBUTES_COUNT; ++i)
+        {
+            this->m_attributes[i] = -1;
+        }
     }
 
     Model3D::~Model3D()
@@ -162,6 +170,7 @@ namespace Model3D
         this->m_positions               = NULL;
         this->m_texture_coordinates0    = NULL;
         this->m_normals                 = NULL;
+        this->m_tangents                = NULL;
         this->m_bone_ids                = NULL;
         this->m_weights                 = NULL;
         this->m_materials               = NULL;
@@ -366,6 +375,15 @@ namespace Model3D
 		}
 		LOGI( "Here" );
 
+        if (this->m_has_indices)
+        {
+            this->build_clusters();
+            LOGI( "%u triangles in %u clusters", *this->m_indices_count, this->get_clusters_count() );
+        }
+
+        this->build_interleaved_vertices();
+        LOGI( "%d bytes per interleaved vertex", this->m_vertex_layout.getStride() );
+
         return true;
     }
 
@@ -403,4 +421,159 @@ namespace Model3D
     {
         return this->m_indices;
     }
+
+    unsigned int Model3D::get_vertices_count() const
+    {
+        return *this->m_vertices_count;
+    }
+
+    void Model3D::build_clusters(const unsigned int a_triangles_per_cluster)
+    {
+        this->m_clusters.clear();
+
+        const unsigned int triangles_count = *this->m_indices_count;
+        std::vector<float> normals;
+
+        for (unsigned int first = 0; first < triangles_count; first += a_triangles_per_cluster)
+        {
+            const unsigned int last = std::min(first + a_triangles_per_cluster, triangles_count);
+            Cluster cluster;
+
+            float minimum[3] = { INFINITY, INFINITY, INFINITY };
+            float maximum[3] = { -INFINITY, -INFINITY, -INFINITY };
+            float axis[3] = { 0.0f, 0.0f, 0.0f };
+
+            normals.clear();
+
+            for (unsigned int triangle = first; triangle < last; ++triangle)
+            {
+                const float *corners[3];
+
+                for (unsigned int corner = 0; corner < 3; ++corner)
+                {
+                    corners[corner] = this->m_positions + 3 * this->m_indices[triangle * 3 + corner];
+
+                    for (unsigned int k = 0; k < 3; ++k)
+                    {
+                        minimum[k] = std::min(minimum[k], corners[corner][k]);
+                        maximum[k] = std::max(maximum[k], corners[corner][k]);
+                    }
+                }
+
+                const float edge0[3] = { corners[1][0] - corners[0][0], corners[1][1] - corners[0][1], corners[1][2] - corners[0][2] };
+                const float edge1[3] = { corners[2][0] - corners[0][0], corners[2][1] - corners[0][1], corners[2][2] - corners[0][2] };
+                float normal[3] = { edge0[1] * edge1[2] - edge0[2] * edge1[1],
+                                    edge0[2] * edge1[0] - edge0[0] * edge1[2],
+                                    edge0[0] * edge1[1] - edge0[1] * edge1[0] };
+                const float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+                // Degenerate triangles are never rasterized, they do not widen the cone
+                if (length == 0.0f)
+                {
+                    continue;
+                }
+
+                for (unsigned int k = 0; k < 3; ++k)
+                {
+                    normal[k] /= length;
+                    axis[k] += normal[k];
+                    normals.push_back(normal[k]);
+                }
+            }
+
+            // The sphere around the bounding box is not the tightest, but clusters are small and it is cheap to build
+            float radius_squared = 0.0f;
+            for (unsigned int k = 0; k < 3; ++k)
+            {
+                cluster.m_center[k] = (minimum[k] + maximum[k]) * 0.5f;
+                radius_squared += (maximum[k] - cluster.m_center[k]) * (maximum[k] - cluster.m_center[k]);
+            }
+            cluster.m_radius = sqrtf(radius_squared);
+
+            const float axis_length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+            float minimum_dot = axis_length > 0.0f ? 1.0f : -1.0f;
+
+            for (unsigned int k = 0; k < 3; ++k)
+            {
+                cluster.m_cone_axis[k] = axis_length > 0.0f ? axis[k] / axis_length : 0.0f;
+            }
+
+            for (size_t n = 0; n < normals.size(); n += 3)
+            {
+                const float dot = normals[n + 0] * cluster.m_cone_axis[0] +
+                                  normals[n + 1] * cluster.m_cone_axis[1] +
+                                  normals[n + 2] * cluster.m_cone_axis[2];
+                minimum_dot = std::min(minimum_dot, dot);
+            }
+
+            // A cone wider than a hemisphere, nearly, always has a front facing triangle: never cull the cluster on it
+            cluster.m_cone_cutoff = minimum_dot <= 0.1f ? 1.0f : sqrtf(1.0f - minimum_dot * minimum_dot);
+
+            cluster.m_first_index   = first * 3;
+            cluster.m_indices_count = (last - first) * 3;
+            cluster.m_padding[0]    = 0;
+            cluster.m_padding[1]    = 0;
+
+            this->m_clusters.push_back(cluster);
+        }
+    }
+
+    unsigned int Model3D::get_clusters_count() const
+    {
+        return static_cast<unsigned int>(this->m_clusters.size());
+    }
+
+    const Cluster* Model3D::get_clusters() const
+    {
+        return this->m_clusters.empty() ? NULL : &this->m_clusters[0];
+    }
+
+    void Model3D::build_interleaved_vertices()
+    {
+        const unsigned int vertices_count = *this->m_vertices_count;
+
+        this->m_vertex_layout = MaliSDK::VertexLayout();
+        this->m_attributes[ATTRIBUTE_POSITION]             = this->m_vertex_layout.add(3, MaliSDK::VertexLayout::Float);
+        this->m_attributes[ATTRIBUTE_NORMAL]               = this->m_normals ? this->m_vertex_layout.add(4, MaliSDK::VertexLayout::Int2101010Rev) : -1;
+        this->m_attributes[ATTRIBUTE_TEXTURE_COORDINATES0] = this->m_texture_coordinates0 ? this->m_vertex_layout.add(2, MaliSDK::VertexLayout::Float) : -1;
+        this->m_attributes[ATTRIBUTE_TANGENT]              = this->m_tangents ? this->m_vertex_layout.add(4, MaliSDK::VertexLayout::Int2101010Rev) : -1;
+
+        const float* sources[ATTRIBUTES_COUNT] = { this->m_positions, this->m_normals, this->m_texture_coordinates0, this->m_tangents };
+
+        this->m_interleaved_vertices.assign(this->m_vertex_layout.getStride() * vertices_count, 0);
+
+        for (int i = 0; i < ATTRIBUTES_COUNT; ++i)
+        {
+            if (this->m_attributes[i] >= 0)
+            {
+                this->m_vertex_layout.pack(this->m_attributes[i], sources[i], 3, vertices_count, &this->m_interleaved_vertices[0]);
+            }
+        }
+    }
+
+    const MaliSDK::VertexLayout& Model3D::get_vertex_layout() const
+    {
+        return this->m_vertex_layout;
+    }
+
+    const unsigned char* Model3D::get_interleaved_vertices() const
+    {
+        return this->m_interleaved_vertices.empty() ? NULL : &this->m_interleaved_vertices[0];
+    }
+
+    unsigned int Model3D::get_interleaved_vertices_size() const
+    {
+        return static_cast<unsigned int>(this->m_interleaved_vertices.size());
+    }
+
+    bool Model3D::enable_attribute(const Attribute a_attribute, const GLuint a_location) const
+    {
+        if (this->m_attributes[a_attribute] < 0)
+        {
+            return false;
+        }
+
+        this->m_vertex_layout.enable(this->m_attributes[a_attribute], a_location);
+        return true;
+    }
 }
@@ -21,6 +21,8 @@
 #ifndef __MODEL3D_H_INCLUDED__
 #define __MODEL3D_H_INCLUDED__
 
+#include "VertexLayout.h"
+
 #include <string>
 #include <vector>
 
@@ -98,6 +100,27 @@ namespace Model3D
         float   *m_transforms;  //!< Transformations for all the bones in the current keyframe
     };
 
+    /**
+    Objects of Cluster class describe a run of about 64 consecutive triangles of a model.
+    Clusters are the unit of culling: one cluster whose bounding sphere is outside the frustum,
+    or whose triangles all face away from the camera, is skipped as a whole.
+    The layout matches a std430 structure of vec4 sphere, vec4 cone and uvec4 range,
+    so the clusters can be copied as they are to a shader storage buffer.
+    @ingroup FrescoModel3D
+    */
+
+    class Cluster
+    {
+    public:
+        float           m_center[3];        //!< Centre of the bounding sphere of the cluster
+        float           m_radius;           //!< Radius of the bounding sphere of the cluster
+        float           m_cone_axis[3];     //!< Average direction of the cluster's triangle normals
+        float           m_cone_cutoff;      //!< Sine of the largest angle between a normal and the axis, 1 if the cone cannot be used for culling
+        unsigned int    m_first_index;      //!< First index of the cluster in the model's indices
+        unsigned int    m_indices_count;    //!< Number of indices of the cluster, 3 per triangle
+        unsigned int    m_padding[2];       //!< Pads the cluster to 16 bytes
+    };
+
     /**
     Objects of Model3D class contains one complete model.
     This class can be used to load *.geom files from filesystem.
@@ -121,6 +144,18 @@ namespace Model3D
 
         friend class Model3DClientGL;
 
+        /**
+        Attributes of the interleaved vertices built by build_interleaved_vertices()
+        */
+        enum Attribute
+        {
+            ATTRIBUTE_POSITION,
+            ATTRIBUTE_NORMAL,
+            ATTRIBUTE_TEXTURE_COORDINATES0,
+            ATTRIBUTE_TANGENT,
+            ATTRIBUTES_COUNT
+        };
+
         /**
         Default constructor sets all pointers to NULL
         */
@@ -184,6 +219,68 @@ namespace Model3D
         */
         unsigned int* get_indices() const;
 
+        /**
+        This method returns the vertices count in the model
+        @return vertices count
+        */
+        unsigned int get_vertices_count() const;
+
+        /**
+        Split the indexed triangles into clusters, which load() does with the default size.
+        Triangles are grouped in the order they are indexed, so the indices should be ordered
+        for the vertex cache, which keeps neighbouring triangles together.
+        @param a_triangles_per_cluster maximum number of triangles in each cluster
+        */
+        void build_clusters(const unsigned int a_triangles_per_cluster = 64);
+
+        /**
+        This method returns the clusters count in the model
+        @return clusters count, 0 if the model is not indexed
+        */
+        unsigned int get_clusters_count() const;
+
+        /**
+        This method returns the list of clusters in the model
+        @return clusters
+        */
+        const Cluster* get_clusters() const;
+
+        /**
+        Interleave the attributes the model has into one vertex buffer, which load() does.
+        Normals and tangents are unit vectors, they are quantized to GL_INT_2_10_10_10_REV.
+        Positions and texture coordinates stay floats: the model spans hundreds of units and
+        its texture coordinates go past [0, 1], where half floats would be visibly off.
+        Only the two first texture coordinates are kept, the third one is the unused material id.
+        */
+        void build_interleaved_vertices();
+
+        /**
+        This method returns the layout of the interleaved vertices
+        @return vertex layout
+        */
+        const MaliSDK::VertexLayout& get_vertex_layout() const;
+
+        /**
+        This method returns the interleaved vertices, get_vertex_layout().getStride() bytes per vertex
+        @return interleaved vertices
+        */
+        const unsigned char* get_interleaved_vertices() const;
+
+        /**
+        This method returns the size of the interleaved vertices in bytes
+        @return interleaved vertices size
+        */
+        unsigned int get_interleaved_vertices_size() const;
+
+        /**
+        Enable a vertex attribute array and point it at an attribute of the interleaved vertices,
+        which must be in the bound GL_ARRAY_BUFFER
+        @param a_attribute the attribute of the model
+        @param a_location location of the attribute in the program
+        @return false if the model does not have this attribute, and the array is left disabled
+        */
+        bool enable_attribute(const Attribute a_attribute, const GLuint a_location) const;
+
 
     protected:
         bool            m_has_animation;            //!< True if the model has animation data
@@ -216,6 +313,12 @@ namespace Model3D
 
         float           *m_bounding_box_minimum;    //!< Bounding box minimum of the model
         float           *m_bounding_box_maximum;    //!< Bounding box maximum of the model
+
+        std::vector<Cluster> m_clusters;            //!< Clusters of the indexed triangles, built by build_clusters()
+
+        MaliSDK::VertexLayout m_vertex_layout;                  //!< Layout of the interleaved vertices
+        int             m_attributes[ATTRIBUTES_COUNT];         //!< Index of each attribute in the layout, -1 if the model does not have it
+        std::vector<unsigned char> m_interleaved_vertices;      //!< Interleaved vertices, built by build_interleaved_vertices()
     };
 }
 
@@ -56,6 +56,7 @@ public class FoveatedRendering extends Activity
         extractAsset("roomPBR.fs");
         extractAsset("mask.vs");
         extractAsset("mask.fs");
+        extractAsset("clusterCull.cs");
 
         extractAsset("T_Exterior_B.raw");
         extractAsset("T_Exterior_D.raw");
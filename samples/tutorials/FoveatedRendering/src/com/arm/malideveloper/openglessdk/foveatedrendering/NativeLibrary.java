@@ -28,4 +28,6 @@ public class NativeLibrary
     }
     public static native void init(int width, int height, String localPath);
     public static native void step();
+    // Gaze point in the normalized device coordinates of an eye, from an eye or head tracker
+    public static native void setGaze(float x, float y);
 }
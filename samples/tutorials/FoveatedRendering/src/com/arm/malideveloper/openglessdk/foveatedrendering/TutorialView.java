@@ -22,6 +22,7 @@ package com.arm.malideveloper.openglessdk.foveatedrendering;
 
 import android.content.Context;
 import android.opengl.GLSurfaceView;
+import android.view.MotionEvent;
 import javax.microedition.khronos.egl.EGL10;
 import javax.microedition.khronos.egl.EGLConfig;
 import javax.microedition.khronos.egl.EGLContext;
@@ -47,6 +48,24 @@ class TutorialView extends GLSurfaceView
         setRenderer(new Renderer());
     }
 
+    // Touches stand in for a gaze source: the touched point of either eye becomes the gaze point of both
+    @Override
+    public boolean onTouchEvent(MotionEvent event)
+    {
+        final float eyeWidth = getWidth() / 2.0f;
+        final float x = (event.getX() % eyeWidth) / eyeWidth * 2.0f - 1.0f;
+        final float y = 1.0f - event.getY() / getHeight() * 2.0f;
+
+        queueEvent(new Runnable()
+        {
+            public void run()
+            {
+                NativeLibrary.setGaze(x, y);
+            }
+        });
+        return true;
+    }
+
     private static class ContextFactory implements GLSurfaceView.EGLContextFactory
     {
         public EGLContext createContext(EGL10 egl, EGLDisplay display, EGLConfig eglConfig)
@@ -29,10 +29,19 @@ const uint controlPointsPerPatchCount = patchDimension * patchDimension;
 const uint quadsInPatchCount = (patchDimension - 1u) * (patchDimension - 1u);
 /* Total number of vertices in a patch. */
 const uint verticesCount = 144u;
+/* Number of quads along an edge of a patch at the finest level of detail. */
+const uint maximumPatchSegments = 16u;
 
 /* Input patch vertex coordinates. */
 in vec2 patchUVPosition;
 
+/*
+ * Per-instance patch description: bits 0-7 hold the index of the patch, bits 8-23 the levels of detail of the
+ * neighbours across the u = 0, u = 1, v = 0 and v = 1 edges (4 bits each) and bits 24-27 the level of the patch itself.
+ * Level n has maximumPatchSegments >> n quads along an edge.
+ */
+in uint patchData;
+
 /* Constant transofrmation matrices. */
 uniform mat4 cameraMatrix;
 uniform mat4 projectionMatrix;
@@ -56,33 +65,87 @@ uniform ControlPointsVertices
 /* Normal vector set in Model-View-Projection space. */
 out vec3 modelViewProjectionNormalVector;
 
+/* Array storing control vertices of current patch. */
+vec4 controlVertices[controlPointsPerPatchCount];
+
+/* Position of a point on the Bezier surface of the current patch. */
+vec3 evaluatePatch(vec2 uv)
+{
+    /* Coefficients of Bernstein polynomials. */
+    vec2 bernsteinUV0 = (1.0 - uv) * (1.0 - uv) * (1.0 - uv);
+    vec2 bernsteinUV1 =  3.0 * uv  * (1.0 - uv) * (1.0 - uv);
+    vec2 bernsteinUV2 =  3.0 * uv  *        uv  * (1.0 - uv);
+    vec2 bernsteinUV3 =        uv  *        uv  *        uv ;
+
+    return bernsteinUV0.x * (bernsteinUV0.y * controlVertices[ 0].xyz + bernsteinUV1.y * controlVertices[ 1].xyz + bernsteinUV2.y * controlVertices[ 2].xyz + bernsteinUV3.y * controlVertices[ 3].xyz) +
+           bernsteinUV1.x * (bernsteinUV0.y * controlVertices[ 4].xyz + bernsteinUV1.y * controlVertices[ 5].xyz + bernsteinUV2.y * controlVertices[ 6].xyz + bernsteinUV3.y * controlVertices[ 7].xyz) +
+           bernsteinUV2.x * (bernsteinUV0.y * controlVertices[ 8].xyz + bernsteinUV1.y * controlVertices[ 9].xyz + bernsteinUV2.y * controlVertices[10].xyz + bernsteinUV3.y * controlVertices[11].xyz) +
+           bernsteinUV3.x * (bernsteinUV0.y * controlVertices[12].xyz + bernsteinUV1.y * controlVertices[13].xyz + bernsteinUV2.y * controlVertices[14].xyz + bernsteinUV3.y * controlVertices[15].xyz);
+}
+
+/*
+ * Position of a vertex on an edge shared with a coarser neighbour, moved onto the straight segment the neighbour
+ * draws there so both patches meet without cracks. edgeUV is the vertex with the coordinate along the edge in y.
+ */
+vec3 evaluateStitchedEdge(vec2 edgeUV, bool alongU, float neighbourSegments)
+{
+    float segment  = edgeUV.y * neighbourSegments;
+    float first    = min(floor(segment), neighbourSegments - 1.0);
+    vec2  startUV  = vec2(edgeUV.x, first / neighbourSegments);
+    vec2  endUV    = vec2(edgeUV.x, (first + 1.0) / neighbourSegments);
+
+    vec3 start = evaluatePatch(alongU ? startUV.yx : startUV);
+    vec3 end   = evaluatePatch(alongU ? endUV.yx   : endUV);
+
+    return mix(start, end, segment - first);
+}
+
 void main()
 {
     const float pi = 3.14159265358979323846;
     
     mat4 modelViewMatrix;
     mat4 modelViewProjectionMatrix;
-    
-    /* Array storing control vertices of current patch. */
-    vec4 controlVertices[controlPointsPerPatchCount];
-    
+
+    /* Index of the patch drawn by this instance. */
+    uint patchID = patchData & 0xFFu;
+
     /* Initialize array of current control vertices. */
     for (uint i = 0u; i < controlPointsPerPatchCount; ++i)
     {
-        controlVertices[i] = vertices[indices[uint(gl_InstanceID) * controlPointsPerPatchCount + i]];
+        controlVertices[i] = vertices[indices[patchID * controlPointsPerPatchCount + i]];
     }
-    
-    /* Coefficients of Bernstein polynomials. */
-    vec2 bernsteinUV0 = (1.0 - patchUVPosition) * (1.0 - patchUVPosition) * (1.0 - patchUVPosition);
-    vec2 bernsteinUV1 =  3.0 * patchUVPosition  * (1.0 - patchUVPosition) * (1.0 - patchUVPosition);
-    vec2 bernsteinUV2 =  3.0 * patchUVPosition  *        patchUVPosition  * (1.0 - patchUVPosition);
-    vec2 bernsteinUV3 =        patchUVPosition  *        patchUVPosition  *        patchUVPosition ;
-    
+
     /* Position of a patch vertex on Bezier surface. */
-    vec3 position = bernsteinUV0.x * (bernsteinUV0.y * controlVertices[ 0].xyz + bernsteinUV1.y * controlVertices[ 1].xyz + bernsteinUV2.y * controlVertices[ 2].xyz + bernsteinUV3.y * controlVertices[ 3].xyz) +
-                    bernsteinUV1.x * (bernsteinUV0.y * controlVertices[ 4].xyz + bernsteinUV1.y * controlVertices[ 5].xyz + bernsteinUV2.y * controlVertices[ 6].xyz + bernsteinUV3.y * controlVertices[ 7].xyz) +
-                    bernsteinUV2.x * (bernsteinUV0.y * controlVertices[ 8].xyz + bernsteinUV1.y * controlVertices[ 9].xyz + bernsteinUV2.y * controlVertices[10].xyz + bernsteinUV3.y * controlVertices[11].xyz) +
-                    bernsteinUV3.x * (bernsteinUV0.y * controlVertices[12].xyz + bernsteinUV1.y * controlVertices[13].xyz + bernsteinUV2.y * controlVertices[14].xyz + bernsteinUV3.y * controlVertices[15].xyz);
+    vec3 position = evaluatePatch(patchUVPosition);
+
+    /* Stitch edges shared with neighbours drawn at a coarser level of detail. */
+    uint  level    = (patchData >> 24u) & 0xFu;
+    uint  neighbourLevel = 0u;
+    vec2  edgeUV   = patchUVPosition;
+    bool  alongU   = false;
+    bool  onEdge   = true;
+
+    if (patchUVPosition.x == 0.0 || patchUVPosition.x == 1.0)
+    {
+        neighbourLevel = (patchData >> (patchUVPosition.x == 0.0 ? 8u : 12u)) & 0xFu;
+        edgeUV         = patchUVPosition;
+    }
+    else if (patchUVPosition.y == 0.0 || patchUVPosition.y == 1.0)
+    {
+        neighbourLevel = (patchData >> (patchUVPosition.y == 0.0 ? 16u : 20u)) & 0xFu;
+        edgeUV         = patchUVPosition.yx;
+        alongU         = true;
+    }
+    else
+    {
+        onEdge = false;
+    }
+
+    if (onEdge && neighbourLevel > level)
+    {
+        position = evaluateStitchedEdge(edgeUV, alongU, float(maximumPatchSegments >> neighbourLevel));
+    }
     
     /* Matrix rotating Model-View matrix around X axis. */
     mat4 xRotationMatrix = mat4(1.0,  0.0,                            0.0,                            0.0, 
@@ -116,10 +179,10 @@ void main()
     gl_Position = modelViewProjectionMatrix * vec4(position, 1.0);
 
     /* Angle on the "big circle" of torus. */
-    float phi = (patchUVPosition.x + mod(float(gl_InstanceID), 4.0)) * pi / 2.0;
+    float phi = (patchUVPosition.x + mod(float(patchID), 4.0)) * pi / 2.0;
 
     /* Angle on the "small circle" of torus. */
-    float theta = (patchUVPosition.y + mod(float(gl_InstanceID / 4), 4.0)) * pi / 2.0;
+    float theta = (patchUVPosition.y + mod(float(patchID / 4u), 4.0)) * pi / 2.0;
 
     /* Horizontal tangent to torus. */
     vec3 dBdu = vec3(-sin(phi), 0.0, cos(phi));
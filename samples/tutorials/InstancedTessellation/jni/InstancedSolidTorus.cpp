@@ -25,16 +25,39 @@
 #include "Shader.h"
 #include "TorusModel.h"
 
-#include <GLES3/gl3.h>
+#include <EGL/egl.h>
+#include <GLES3/gl31.h>
 #include <GLES3/gl3ext.h>
 
 #include <cmath>
 #include <string>
+#include <vector>
 
 using namespace MaliSDK;
 using std::string;
+using std::vector;
+
+const float InstancedSolidTorus::targetEdgeLength = 16.0f;
+
+/* Layout of GL_DRAW_INDIRECT_BUFFER contents for glDrawElementsIndirect(). */
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLuint baseVertex;
+    GLuint reservedMustBeZero;
+};
 
 InstancedSolidTorus::InstancedSolidTorus(float torusRadius, float circleRadius)
+    : patchDataBufferID(0)
+    , drawCommandsBufferID(0)
+    , levelOfDetailProgramID(0)
+    , levelOfDetailRotationVectorLocation(-1)
+    , patchDataLocation(-1)
+    , dispatchCompute(NULL)
+    , memoryBarrier(NULL)
+    , drawElementsIndirect(NULL)
 {
     /* Initialize class fields. */
     this->torusRadius  = torusRadius;
@@ -53,6 +76,8 @@ InstancedSolidTorus::InstancedSolidTorus(float torusRadius, float circleRadius)
     initializeControlUniformBuffers();
     /* Create patch data and initialize vertex attribs corresponding to it. */
     initializeVertexAttribs();
+    /* Use per-patch levels of detail if compute shaders are available. */
+    initializeLevelOfDetail();
 
     /* Set torus color to green. */
     setColor(0.0f, 0.7f, 0.0f, 1.0f);
@@ -63,11 +88,30 @@ InstancedSolidTorus::InstancedSolidTorus(float torusRadius, float circleRadius)
 
 InstancedSolidTorus::~InstancedSolidTorus()
 {
-    GLuint buffersArray[]   = {controlIndicesBufferID, controlVerticesBufferID, patchIndicesBufferID, patchVertexBufferID};
+    GLuint buffersArray[]   = {controlIndicesBufferID, controlVerticesBufferID, patchIndicesBufferID, patchVertexBufferID,
+                               patchDataBufferID, drawCommandsBufferID};
     GLint  buffersArraySize = sizeof(buffersArray) / sizeof(buffersArray[0]);
 
     /* Delete all buffers corresponding to this class. */
-    GL_CHECK(glDeleteBuffers(buffersArraySize, &controlIndicesBufferID));
+    GL_CHECK(glDeleteBuffers(buffersArraySize, buffersArray));
+
+    if (levelOfDetailProgramID != 0)
+    {
+        GL_CHECK(glDeleteProgram(levelOfDetailProgramID));
+    }
+}
+
+void InstancedSolidTorus::setProjectionMatrix(Matrix* projectionMatrix)
+{
+    Torus::setProjectionMatrix(projectionMatrix);
+
+    if (levelOfDetailProgramID != 0)
+    {
+        GLint projectionMatrixLocation = GL_CHECK(glGetUniformLocation(levelOfDetailProgramID, "projectionMatrix"));
+
+        GL_CHECK(glUseProgram(levelOfDetailProgramID));
+        GL_CHECK(glUniformMatrix4fv(projectionMatrixLocation, 1, GL_FALSE, projectionMatrix->getAsArray()));
+    }
 }
 
 /* [Draw solid torus] */
@@ -91,11 +135,133 @@ void InstancedSolidTorus::draw(float* rotationVector)
         LOGE("Could not locate \"rotationVector\" uniform in program [%d]", programID);
     }
 
-    /* Draw patchInstancesCount instances of patchTriangleIndicesCount triangles. */ 
-    GL_CHECK(glDrawElementsInstanced(GL_TRIANGLES, patchTriangleIndicesCount, GL_UNSIGNED_INT, 0, patchInstancesCount));
+    if (levelOfDetailProgramID == 0)
+    {
+        /* Draw patchInstancesCount instances of patchTriangleIndicesCount triangles. */
+        GL_CHECK(glDrawElementsInstanced(GL_TRIANGLES, patchTriangleIndicesCount, GL_UNSIGNED_INT, 0, patchInstancesCount));
+
+        return;
+    }
+
+    /* [Select levels of detail] */
+    /* Only the instance counts change, but rewriting the whole commands is as cheap. */
+    DrawElementsIndirectCommand commands[levelsCount];
+
+    for (unsigned int level = 0; level < levelsCount; ++level)
+    {
+        DrawElementsIndirectCommand command = {levelIndicesCount[level], 0, levelFirstIndex[level], 0, 0};
+
+        commands[level] = command;
+    }
+
+    GL_CHECK(glBindBuffer   (GL_DRAW_INDIRECT_BUFFER, drawCommandsBufferID));
+    GL_CHECK(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(commands), commands));
+
+    GL_CHECK(glUseProgram    (levelOfDetailProgramID));
+    GL_CHECK(glUniform3fv    (levelOfDetailRotationVectorLocation, 1, rotationVector));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawCommandsBufferID));
+    GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, patchDataBufferID));
+
+    /* A single work group; one invocation per patch. */
+    GL_CHECK(dispatchCompute(1, 1, 1));
+    GL_CHECK(memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT));
+    /* [Select levels of detail] */
+
+    /* [Draw levels of detail] */
+    GL_CHECK(glUseProgram(programID));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, patchDataBufferID));
+
+    for (unsigned int level = 0; level < levelsCount; ++level)
+    {
+        /* Instances of this level read their description from the level's list. Levels with no visible patches draw nothing. */
+        GL_CHECK(glVertexAttribIPointer(patchDataLocation, 1, GL_UNSIGNED_INT, 0,
+                                        (const GLvoid*)(level * patchInstancesCount * sizeof(GLuint))));
+        GL_CHECK(drawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                      (const GLvoid*)(level * sizeof(DrawElementsIndirectCommand))));
+    }
+    /* [Draw levels of detail] */
 }
 /* [Draw solid torus] */
 
+void InstancedSolidTorus::initializeLevelOfDetail()
+{
+    GLint majorVersion = 0;
+    GLint minorVersion = 0;
+
+    GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &majorVersion));
+    GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minorVersion));
+
+    if (majorVersion < 3 || (majorVersion == 3 && minorVersion < 1))
+    {
+        LOGI("OpenGL ES 3.1 is not available, all patches are drawn with %u quads per edge.", maximumPatchSegments);
+
+        return;
+    }
+
+    /* The tutorial runs on OpenGL ES 3.0 devices, so the OpenGL ES 3.1 entry points are not linked directly. */
+    dispatchCompute      = (DispatchComputeFunction)eglGetProcAddress("glDispatchCompute");
+    memoryBarrier        = (MemoryBarrierFunction)eglGetProcAddress("glMemoryBarrier");
+    drawElementsIndirect = (DrawElementsIndirectFunction)eglGetProcAddress("glDrawElementsIndirect");
+
+    if (dispatchCompute == NULL || memoryBarrier == NULL || drawElementsIndirect == NULL)
+    {
+        LOGE("Could not get OpenGL ES 3.1 function pointers.");
+
+        return;
+    }
+
+    const string computeShaderPath = resourceDirectory + "Instanced_Tessellation_LOD_shader.comp";
+
+    GLuint computeShaderID = 0;
+    GLint  linkStatus      = GL_FALSE;
+
+    Shader::processShader(&computeShaderID, computeShaderPath.c_str(), GL_COMPUTE_SHADER);
+
+    levelOfDetailProgramID = GL_CHECK(glCreateProgram());
+
+    GL_CHECK(glAttachShader(levelOfDetailProgramID, computeShaderID));
+    GL_CHECK(glLinkProgram (levelOfDetailProgramID));
+    GL_CHECK(glDeleteShader(computeShaderID));
+    GL_CHECK(glGetProgramiv(levelOfDetailProgramID, GL_LINK_STATUS, &linkStatus));
+
+    if (linkStatus != GL_TRUE)
+    {
+        LOGE("Could not link the level of detail program, all patches are drawn with %u quads per edge.", maximumPatchSegments);
+
+        GL_CHECK(glDeleteProgram(levelOfDetailProgramID));
+        levelOfDetailProgramID = 0;
+
+        return;
+    }
+
+    /* The control mesh is shared with the rendering program through the same uniform buffer binding points. */
+    GLuint controlIndicesBlockIndex  = GL_CHECK(glGetUniformBlockIndex(levelOfDetailProgramID, "ControlPointsIndices"));
+    GLuint controlVerticesBlockIndex = GL_CHECK(glGetUniformBlockIndex(levelOfDetailProgramID, "ControlPointsVertices"));
+
+    ASSERT(controlIndicesBlockIndex  != GL_INVALID_INDEX, "Could not locate \"ControlPointsIndices\" uniform block in the level of detail program.");
+    ASSERT(controlVerticesBlockIndex != GL_INVALID_INDEX, "Could not locate \"ControlPointsVertices\" uniform block in the level of detail program.");
+
+    GL_CHECK(glUniformBlockBinding(levelOfDetailProgramID, controlIndicesBlockIndex,  0));
+    GL_CHECK(glUniformBlockBinding(levelOfDetailProgramID, controlVerticesBlockIndex, 1));
+
+    setConstantMatrices(levelOfDetailProgramID);
+
+    GLint viewport[4];
+    GL_CHECK(glGetIntegerv(GL_VIEWPORT, viewport));
+
+    levelOfDetailRotationVectorLocation = GL_CHECK(glGetUniformLocation(levelOfDetailProgramID, "rotationVector"));
+    GLint viewportSizeLocation          = GL_CHECK(glGetUniformLocation(levelOfDetailProgramID, "viewportSize"));
+    GLint targetEdgeLengthLocation      = GL_CHECK(glGetUniformLocation(levelOfDetailProgramID, "targetEdgeLength"));
+
+    GL_CHECK(glUseProgram(levelOfDetailProgramID));
+    GL_CHECK(glUniform2f (viewportSizeLocation, (float)viewport[2], (float)viewport[3]));
+    GL_CHECK(glUniform1f (targetEdgeLengthLocation, targetEdgeLength));
+
+    GL_CHECK(glGenBuffers(1, &drawCommandsBufferID));
+    GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandsBufferID));
+    GL_CHECK(glBufferData(GL_DRAW_INDIRECT_BUFFER, levelsCount * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_DRAW));
+}
+
 bool InstancedSolidTorus::initializeControlUniformBuffers()
 {
     float        torusVertices       [componentsCount];
@@ -146,11 +312,31 @@ bool InstancedSolidTorus::initializeVertexAttribs()
     /* Find input attribute location. */
     GLint positionLocation = GL_CHECK(glGetAttribLocation(programID, "patchUVPosition"));
 
-    float        patchVertices       [patchComponentsCount];
-    unsigned int patchTriangleIndices[patchTriangleIndicesCount];
+    /* All levels of detail share one vertex and one index buffer, the finest level first. */
+    vector<float>        patchVertices;
+    vector<unsigned int> patchTriangleIndices;
+
+    for (unsigned int level = 0; level < levelsCount; ++level)
+    {
+        const unsigned int levelDensity         = (maximumPatchSegments >> level) + 1;
+        const unsigned int levelVerticesCount   = levelDensity * levelDensity;
+        const unsigned int levelFirstVertex     = patchVertices.size() / 2;
+        const unsigned int levelTriangleIndices = (levelDensity - 1) * (levelDensity - 1) * 6;
+
+        levelFirstIndex[level]   = patchTriangleIndices.size();
+        levelIndicesCount[level] = levelTriangleIndices;
+
+        patchVertices.resize(patchVertices.size() + levelVerticesCount * 2);
+        patchTriangleIndices.resize(patchTriangleIndices.size() + levelTriangleIndices);
 
-    /* Determine input data. */
-    TorusModel::calculatePatchData(patchDensity, patchVertices, patchTriangleIndices);
+        /* Determine input data. */
+        TorusModel::calculatePatchData(levelDensity, &patchVertices[levelFirstVertex * 2], &patchTriangleIndices[levelFirstIndex[level]]);
+
+        for (unsigned int index = levelFirstIndex[level]; index < patchTriangleIndices.size(); ++index)
+        {
+            patchTriangleIndices[index] += levelFirstVertex;
+        }
+    }
 
     /* Generate corresponding vertex array object. */
     GL_CHECK(glGenVertexArrays(1, &vaoID));
@@ -162,7 +348,7 @@ bool InstancedSolidTorus::initializeVertexAttribs()
         GL_CHECK(glGenBuffers(1,               &patchVertexBufferID));
         GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, patchVertexBufferID ));
         /* Put data to the buffer. */
-        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, patchComponentsCount * sizeof(float), patchVertices, GL_STATIC_DRAW));
+        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, patchVertices.size() * sizeof(float), &patchVertices[0], GL_STATIC_DRAW));
         /* Set vertex attribute pointer to the beginning of the buffer. */
         GL_CHECK(glVertexAttribPointer    (positionLocation, 2, GL_FLOAT, GL_FALSE, 0, NULL));
         GL_CHECK(glEnableVertexAttribArray(positionLocation                                ));
@@ -177,7 +363,34 @@ bool InstancedSolidTorus::initializeVertexAttribs()
     GL_CHECK(glGenBuffers(1, &patchIndicesBufferID                                                                                       ));
     GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, patchIndicesBufferID                                                                  ));
     /* Put data to the buffer. */
-    GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, patchTriangleIndicesCount * sizeof(unsigned int), patchTriangleIndices, GL_STATIC_DRAW));
+    GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, patchTriangleIndices.size() * sizeof(unsigned int), &patchTriangleIndices[0], GL_STATIC_DRAW));
+
+    /* Find per-instance input attribute location. */
+    patchDataLocation = GL_CHECK(glGetAttribLocation(programID, "patchData"));
+
+    if (patchDataLocation == -1)
+    {
+        LOGE("Could not locate \"patchData\" input attribute in program [%d].", programID);
+        return false;
+    }
+
+    /*
+     * One list of patch descriptions per level of detail. Without the level of detail program only the first one is used
+     * and holds every patch at the finest level, so the instance index is the patch index.
+     */
+    unsigned int patchData[levelsCount * patchInstancesCount] = {0};
+
+    for (unsigned int patch = 0; patch < patchInstancesCount; ++patch)
+    {
+        patchData[patch] = patch;
+    }
+
+    GL_CHECK(glGenBuffers(1, &patchDataBufferID));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, patchDataBufferID));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(patchData), patchData, GL_DYNAMIC_COPY));
+    GL_CHECK(glVertexAttribIPointer   (patchDataLocation, 1, GL_UNSIGNED_INT, 0, NULL));
+    GL_CHECK(glVertexAttribDivisor    (patchDataLocation, 1));
+    GL_CHECK(glEnableVertexAttribArray(patchDataLocation));
 
     return true;
 }
@@ -40,6 +40,9 @@
  *        - an array buffer storing patch vertices,
  *        - an element array buffer storing indices,
  *        which are used in a glDrawElementsInstanced() call. It is also capable of determining the needed indices arrays.
+ *        When OpenGL ES 3.1 is available, a compute shader picks one of four patch densities for every patch from its size
+ *        on screen and skips patches outside of the view frustum. The patches of each density are then drawn with an indirect
+ *        draw whose instance count the compute shader wrote, so the CPU never reads back what is visible.
  */
 class InstancedSolidTorus : public Torus
 {
@@ -64,22 +67,32 @@ private:
      * \brief Number of instances needed to draw the whole torus.
      */
     static const unsigned int patchInstancesCount = controlPointsIndicesCount / controlPointsInPatchCount;
-    /** 
-     * \brief Number of vertices in one edge of a patch.
+    /**
+     * \brief Number of levels of detail a patch can be drawn with.
      */
-    static const unsigned int patchDensity = 16;
-    /** 
-     * \brief Total number of vertices in a patch.
+    static const unsigned int levelsCount = 4;
+    /**
+     * \brief Number of quads in one edge of a patch at the finest level of detail. Level n has half as many as level n - 1,
+     *        so the vertices on an edge of a coarse patch are a subset of those of a finer neighbour.
      */
-    static const unsigned int patchVerticesCount = patchDensity * patchDensity;
-    /** 
-     * \brief Total number of components describing a patch (only U/V components are defined).
+    static const unsigned int maximumPatchSegments = 16;
+    /**
+     * \brief Number of vertices in one edge of a patch at the finest level of detail.
+     */
+    static const unsigned int patchDensity = maximumPatchSegments + 1;
+    /**
+     * \brief Total number of components describing a patch at the finest level of detail (only U/V components are defined).
      */
-    static const unsigned int patchComponentsCount = patchVerticesCount * 2;
+    static const unsigned int patchComponentsCount = patchDensity * patchDensity * 2;
     /**
-     * \brief Number of indices that need to be defined to draw quads consisting of triangles (6 points per quad needed) over the entire patch.
+     * \brief Number of indices that need to be defined to draw quads consisting of triangles (6 points per quad needed) over the entire patch
+     *        at the finest level of detail.
      */
-    static const unsigned int patchTriangleIndicesCount = (patchDensity - 1) * (patchDensity - 1) * 6;
+    static const unsigned int patchTriangleIndicesCount = maximumPatchSegments * maximumPatchSegments * 6;
+    /**
+     * \brief Desired length on screen, in pixels, of the triangle edges of a patch. Used to pick its level of detail.
+     */
+    static const float targetEdgeLength;
 
     /** 
      * \brief Index of a buffer that we bind to GL_UNIFORM_BUFFER binding point. It stores uniform control indices of torus control mesh.
@@ -99,6 +112,40 @@ private:
      *        It stores patch vertices passed as an input to the corresponding vertex shader.
      */
     GLuint patchVertexBufferID;
+    /**
+     * \brief Index of a buffer that we bind to GL_ARRAY_BUFFER binding point. It stores levelsCount lists of patchInstancesCount
+     *        packed patch descriptions, read as a per-instance attribute. Written by the level of detail program.
+     */
+    GLuint patchDataBufferID;
+    /**
+     * \brief Index of a buffer that we bind to GL_DRAW_INDIRECT_BUFFER binding point. It stores one draw command per level of detail.
+     */
+    GLuint drawCommandsBufferID;
+    /**
+     * \brief Program selecting levels of detail and culling patches. 0 if OpenGL ES 3.1 is not available.
+     */
+    GLuint levelOfDetailProgramID;
+    /**
+     * \brief Location of the rotation vector uniform in the level of detail program.
+     */
+    GLint levelOfDetailRotationVectorLocation;
+    /**
+     * \brief Location of the patchData input attribute in the rendering program.
+     */
+    GLint patchDataLocation;
+    /**
+     * \brief Offset in the index buffer, in indices, and number of indices of each level of detail.
+     */
+    unsigned int levelFirstIndex[levelsCount];
+    unsigned int levelIndicesCount[levelsCount];
+
+    typedef void (GL_APIENTRYP DispatchComputeFunction)(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ);
+    typedef void (GL_APIENTRYP MemoryBarrierFunction)(GLbitfield barriers);
+    typedef void (GL_APIENTRYP DrawElementsIndirectFunction)(GLenum mode, GLenum type, const void *indirect);
+
+    DispatchComputeFunction      dispatchCompute;
+    MemoryBarrierFunction        memoryBarrier;
+    DrawElementsIndirectFunction drawElementsIndirect;
 
     /**
      * \brief Initializes control mesh data and stores it in appropriate uniform buffers.
@@ -107,6 +154,12 @@ private:
 
     bool initializeVertexAttribs(void);
 
+    /**
+     * \brief Creates the level of detail program and its buffers if OpenGL ES 3.1 is available.
+     *        Otherwise all patches are drawn at the finest level of detail with glDrawElementsInstanced().
+     */
+    void initializeLevelOfDetail(void);
+
     /**
      * \brief Sets directionl light parameters, such as light direction, its color and ambient intensity
      *        and passes it to corresponding uniforms in shader.
@@ -134,6 +187,13 @@ public:
      * \param rotationVector [in] Vector of 3 elements storing rotation parameters to be passed to the vertex shader.
      */
     void draw(float* rotationVector);
+
+    /**
+     * \brief Pass the projection matrix to the rendering program and to the level of detail program.
+     *
+     * \param projectionMatrix [in] Projection matrix which will be passed to the shaders.
+     */
+    void setProjectionMatrix(MaliSDK::Matrix* projectionMatrix);
 };
 
 #endif /* INSTANCED_SOLID_TORUS_H. */
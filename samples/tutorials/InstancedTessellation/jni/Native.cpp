@@ -28,6 +28,8 @@
  *        triangles and *improves the effect of round surfaces. In the first stage of tessellation, patches consist of vertices
  *        placed in a form of a square. Once passed to the shader, they are transformed into Bezier surfaces on the basis of control
  *        points stored in uniform blocks. Each instance of a draw call renders next part of the torus.
+ *        On OpenGL ES 3.1 devices a compute shader also picks how densely each patch is drawn from its size on screen, skips
+ *        patches outside of the view and writes indirect draw commands, so the vertex work follows the on-screen detail.
  *
  *        The following application instantiates 2 classes, these manage both the solid torus model and the wireframe that surrounds it.
  *        The first class is responsible for configuration of a program with shaders capable of instanced drawing, initialization
@@ -87,16 +87,21 @@ void Torus::setupGraphics(const string vertexShaderPath, const string fragmentSh
 
     GL_CHECK(glLinkProgram(programID));
 
+    setConstantMatrices(programID);
+}
+
+void Torus::setConstantMatrices(GLuint program)
+{
     float scalingFactor     =  0.7f;
     float cameraTranslation = -2.5f;
 
     Matrix cameraMatrix = Matrix::createTranslation(0.0f, 0.0f, cameraTranslation);
     Matrix scaleMatrix  = Matrix::createScaling(scalingFactor, scalingFactor, scalingFactor);
 
-    GLint scaleMatrixLocation  = GL_CHECK(glGetUniformLocation(programID, "scaleMatrix"));
-    GLint cameraMatrixLocation = GL_CHECK(glGetUniformLocation(programID, "cameraMatrix"));
+    GLint scaleMatrixLocation  = GL_CHECK(glGetUniformLocation(program, "scaleMatrix"));
+    GLint cameraMatrixLocation = GL_CHECK(glGetUniformLocation(program, "cameraMatrix"));
 
-    GL_CHECK(glUseProgram(programID));
+    GL_CHECK(glUseProgram(program));
 
     GL_CHECK(glUniformMatrix4fv(scaleMatrixLocation,  1, GL_FALSE, scaleMatrix.getAsArray()));
     GL_CHECK(glUniformMatrix4fv(cameraMatrixLocation, 1, GL_FALSE, cameraMatrix.getAsArray()));
@@ -112,6 +112,13 @@ protected:
      */
     void setupGraphics(const std::string vertexShaderPath, const std::string fragmentShaderPath);
 
+    /**
+     * \brief Pass the constant camera and scale matrices to a program.
+     *
+     * \param program [in] Program declaring "cameraMatrix" and "scaleMatrix" uniforms.
+     */
+    void setConstantMatrices(GLuint program);
+
 public:
 
     /**
@@ -131,7 +138,7 @@ public:
      *
      * \param projectionMatrix [in] Projection matrix which will be passed to the vertex shader.
      */
-    void setProjectionMatrix(MaliSDK::Matrix* projectionMatrix);
+    virtual void setProjectionMatrix(MaliSDK::Matrix* projectionMatrix);
 
     /**
      * \brief Set the resource directory for all tori.
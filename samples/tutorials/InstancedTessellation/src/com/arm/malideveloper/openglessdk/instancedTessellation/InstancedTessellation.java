@@ -50,6 +50,7 @@ public class InstancedTessellation extends Activity
 
         extractAsset("Instanced_Tessellation_Instanced_shader.frag");
         extractAsset("Instanced_Tessellation_Instanced_shader.vert");
+        extractAsset("Instanced_Tessellation_LOD_shader.comp");
         extractAsset("Instanced_Tessellation_Wireframe_shader.frag");
         extractAsset("Instanced_Tessellation_Wireframe_shader.vert");
 
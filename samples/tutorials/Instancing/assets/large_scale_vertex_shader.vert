@@ -0,0 +1,39 @@
+#version 300 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* [Large scale vertex shader code] */
+layout(location = 0) in vec4 attributePosition;
+layout(location = 1) in vec4 attributeColor;
+/* Per-instance attributes sourced from the compacted buffer written by the culling shader. */
+layout(location = 2) in mat4 instanceModelMatrix;
+layout(location = 6) in vec4 instanceColor;
+
+uniform mat4 viewProjectionMatrix;
+
+out vec4 vertexColor;
+
+void main()
+{
+    vertexColor = attributeColor * instanceColor;
+    gl_Position = viewProjectionMatrix * instanceModelMatrix * attributePosition;
+}
+/* [Large scale vertex shader code] */
@@ -22,7 +22,11 @@
 
 /* [Vertex shader code] */
 /* [Define number of cubes] */
-const int   numberOfCubes = 10;
+/* NUMBER_OF_CUBES is defined by the sample, after the #version line. */
+#ifndef NUMBER_OF_CUBES
+#define NUMBER_OF_CUBES 10
+#endif
+const int   numberOfCubes = NUMBER_OF_CUBES;
 /* [Define number of cubes] */
 const float pi            = 3.14159265358979323846;
 const float radius        = 20.0;
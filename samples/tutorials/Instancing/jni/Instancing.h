@@ -28,10 +28,25 @@ namespace MaliSDK
     /* Number of colour components: we will be using RGBA values. */
     #define NUMBER_OF_COLOR_COMPONENTS (4)
     /* [Define number of elements to render] */
-    /* Number of cubes that are drawn on a screen. */
+    /* Number of cubes that are drawn on a screen, unless the number_of_cubes parameter is set. */
     #define NUMBER_OF_CUBES (10)
 /* [Define number of elements to render] */
+    /** Directory read by SampleParameters, where parameters.txt can be pushed. */
+    #define PARAMETERS_DIRECTORY ("/data/data/com.arm.malideveloper.openglessdk.instancing/")
     /** Name of a vertex shader file. */
     #define VERTEX_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.instancing/files/vertex_shader_source.vert")
+
+    /* Set to 1 to draw NUMBER_OF_LARGE_SCALE_CUBES cubes animated and frustum culled on the GPU instead.
+     * Falls back to NUMBER_OF_CUBES cubes when OpenGL ES 3.1 is not available.
+     * Overridden by the large_scale_instancing parameter, and the number of cubes by large_scale_cubes. */
+    #ifndef LARGE_SCALE_INSTANCING
+        #define LARGE_SCALE_INSTANCING (0)
+    #endif
+    /* Number of cubes drawn in the large scale mode. */
+    #define NUMBER_OF_LARGE_SCALE_CUBES (131072)
+    /** Name of the compute shader file animating and culling cubes in the large scale mode. */
+    #define LARGE_SCALE_CULLING_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.instancing/files/large_scale_culling.comp")
+    /** Name of the vertex shader file used in the large scale mode. */
+    #define LARGE_SCALE_VERTEX_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.instancing/files/large_scale_vertex_shader.vert")
 }
 #endif /* INSTANCING_H */
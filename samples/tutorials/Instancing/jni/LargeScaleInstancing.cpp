@@ -0,0 +1,350 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LargeScaleInstancing.h"
+#include "Common.h"
+#include "Instancing.h"
+#include "Shader.h"
+
+#include <EGL/egl.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+
+namespace MaliSDK
+{
+    /* Number of invocations in a work group of the culling shader. */
+    static const int cullingWorkGroupSize = 128;
+
+    /* Layout of GL_DRAW_INDIRECT_BUFFER contents for glDrawElementsIndirect. */
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLuint baseVertex;
+        GLuint reservedMustBeZero;
+    };
+
+    /* Layout of an element of the Instances buffer in the culling shader. */
+    struct InstanceData
+    {
+        float orbit[4];
+        float color[4];
+    };
+
+    /* Layout of an element of the VisibleInstances buffer in the culling shader: a mat4 and a vec4. */
+    static const int visibleInstanceStride = 20 * sizeof(float);
+
+    LargeScaleInstancing::DispatchComputeFunction LargeScaleInstancing::dispatchCompute = NULL;
+    LargeScaleInstancing::MemoryBarrierFunction LargeScaleInstancing::memoryBarrier = NULL;
+    LargeScaleInstancing::DrawElementsIndirectFunction LargeScaleInstancing::drawElementsIndirect = NULL;
+
+    /* Please see header for specification. */
+    bool LargeScaleInstancing::isSupported()
+    {
+        GLint majorVersion = 0;
+        GLint minorVersion = 0;
+
+        GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &majorVersion));
+        GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minorVersion));
+
+        if (majorVersion < 3 || (majorVersion == 3 && minorVersion < 1))
+        {
+            return false;
+        }
+
+        dispatchCompute      = (DispatchComputeFunction)eglGetProcAddress("glDispatchCompute");
+        memoryBarrier        = (MemoryBarrierFunction)eglGetProcAddress("glMemoryBarrier");
+        drawElementsIndirect = (DrawElementsIndirectFunction)eglGetProcAddress("glDrawElementsIndirect");
+
+        return dispatchCompute != NULL && memoryBarrier != NULL && drawElementsIndirect != NULL;
+    }
+
+    /* Please see header for specification. */
+    LargeScaleInstancing::LargeScaleInstancing(int numberOfInstances, float cubeSize, const Vec4f &perspectiveVector, const Vec3f &cameraVector)
+        : numberOfInstances(numberOfInstances)
+        , cullingProgramId(0)
+        , renderingProgramId(0)
+        , instanceBufferObjectId(0)
+        , visibleInstanceBufferObjectId(0)
+        , drawCommandBufferObjectId(0)
+        , vertexBufferObjectId(0)
+        , indexBufferObjectId(0)
+        , vertexArrayObjectId(0)
+    {
+        createPrograms();
+        createGeometry(cubeSize);
+        createInstances();
+        computeViewProjection(perspectiveVector, cameraVector);
+
+        /* Scaled cube corners are cubeSize away from the centre along each axis. */
+        GL_CHECK(glUseProgram(cullingProgramId));
+        GL_CHECK(glUniform1ui(numberOfInstancesLocation, numberOfInstances));
+        GL_CHECK(glUniform4fv(frustumPlanesLocation, 6, &frustumPlanes[0][0]));
+        GL_CHECK(glUniform1f(boundingRadiusLocation, cubeSize * sqrtf(3.0f)));
+
+        GL_CHECK(glUseProgram(renderingProgramId));
+        GL_CHECK(glUniformMatrix4fv(viewProjectionMatrixLocation, 1, GL_FALSE, viewProjectionMatrix));
+    }
+
+    LargeScaleInstancing::~LargeScaleInstancing()
+    {
+        GLuint buffers[] =
+        {
+            instanceBufferObjectId,
+            visibleInstanceBufferObjectId,
+            drawCommandBufferObjectId,
+            vertexBufferObjectId,
+            indexBufferObjectId
+        };
+
+        GL_CHECK(glDeleteVertexArrays(1, &vertexArrayObjectId));
+        GL_CHECK(glDeleteBuffers(sizeof(buffers) / sizeof(buffers[0]), buffers));
+        GL_CHECK(glDeleteProgram(cullingProgramId));
+        GL_CHECK(glDeleteProgram(renderingProgramId));
+    }
+
+    void LargeScaleInstancing::createPrograms()
+    {
+        GLuint computeShaderId  = 0;
+        GLuint vertexShaderId   = 0;
+        GLuint fragmentShaderId = 0;
+        GLint  linkStatus       = GL_FALSE;
+
+        Shader::processShader(&computeShaderId, LARGE_SCALE_CULLING_SHADER_FILE_NAME, GL_COMPUTE_SHADER);
+
+        cullingProgramId = GL_CHECK(glCreateProgram());
+        GL_CHECK(glAttachShader(cullingProgramId, computeShaderId));
+        GL_CHECK(glLinkProgram(cullingProgramId));
+        GL_CHECK(glGetProgramiv(cullingProgramId, GL_LINK_STATUS, &linkStatus));
+        ASSERT(linkStatus == GL_TRUE, "Could not link the culling program.");
+        GL_CHECK(glDeleteShader(computeShaderId));
+
+        /* The fragment shader of the ten cube version is reused as is. */
+        Shader::processShader(&vertexShaderId,   LARGE_SCALE_VERTEX_SHADER_FILE_NAME, GL_VERTEX_SHADER);
+        Shader::processShader(&fragmentShaderId, FRAGMENT_SHADER_FILE_NAME,           GL_FRAGMENT_SHADER);
+
+        renderingProgramId = GL_CHECK(glCreateProgram());
+        GL_CHECK(glAttachShader(renderingProgramId, vertexShaderId));
+        GL_CHECK(glAttachShader(renderingProgramId, fragmentShaderId));
+        GL_CHECK(glLinkProgram(renderingProgramId));
+        GL_CHECK(glGetProgramiv(renderingProgramId, GL_LINK_STATUS, &linkStatus));
+        ASSERT(linkStatus == GL_TRUE, "Could not link the large scale rendering program.");
+        GL_CHECK(glDeleteShader(vertexShaderId));
+        GL_CHECK(glDeleteShader(fragmentShaderId));
+
+        timeLocation                 = GL_CHECK(glGetUniformLocation(cullingProgramId,   "time"));
+        numberOfInstancesLocation    = GL_CHECK(glGetUniformLocation(cullingProgramId,   "numberOfInstances"));
+        frustumPlanesLocation        = GL_CHECK(glGetUniformLocation(cullingProgramId,   "frustumPlanes"));
+        boundingRadiusLocation       = GL_CHECK(glGetUniformLocation(cullingProgramId,   "boundingRadius"));
+        viewProjectionMatrixLocation = GL_CHECK(glGetUniformLocation(renderingProgramId, "viewProjectionMatrix"));
+
+        ASSERT(timeLocation                 != -1, "Could not retrieve uniform location: time");
+        ASSERT(numberOfInstancesLocation    != -1, "Could not retrieve uniform location: numberOfInstances");
+        ASSERT(frustumPlanesLocation        != -1, "Could not retrieve uniform location: frustumPlanes");
+        ASSERT(boundingRadiusLocation       != -1, "Could not retrieve uniform location: boundingRadius");
+        ASSERT(viewProjectionMatrixLocation != -1, "Could not retrieve uniform location: viewProjectionMatrix");
+    }
+
+    void LargeScaleInstancing::createGeometry(float cubeSize)
+    {
+        /* Eight shared corners, each with a random colour, instead of the 36 unindexed vertices of the ten cube version. */
+        const int numberOfCorners = 8;
+        GLfloat vertices[numberOfCorners * (NUMBER_OF_POINT_COORDINATES + NUMBER_OF_COLOR_COMPONENTS)];
+        GLfloat *vertex = vertices;
+
+        for (int corner = 0; corner < numberOfCorners; corner++)
+        {
+            *vertex++ = (corner & 1) ? cubeSize : -cubeSize;
+            *vertex++ = (corner & 2) ? cubeSize : -cubeSize;
+            *vertex++ = (corner & 4) ? cubeSize : -cubeSize;
+
+            for (int component = 0; component < NUMBER_OF_COLOR_COMPONENTS; component++)
+            {
+                *vertex++ = (float)rand() / (float)RAND_MAX;
+            }
+        }
+
+        /* Two triangles for each face, corner bit 0 is x, bit 1 is y and bit 2 is z. */
+        static const GLushort indices[] =
+        {
+            0, 2, 3,  0, 3, 1, /* -z */
+            4, 5, 7,  4, 7, 6, /* +z */
+            0, 4, 6,  0, 6, 2, /* -x */
+            1, 3, 7,  1, 7, 5, /* +x */
+            0, 1, 5,  0, 5, 4, /* -y */
+            2, 6, 7,  2, 7, 3, /* +y */
+        };
+
+        const GLsizei stride = (NUMBER_OF_POINT_COORDINATES + NUMBER_OF_COLOR_COMPONENTS) * sizeof(GLfloat);
+
+        GL_CHECK(glGenVertexArrays(1, &vertexArrayObjectId));
+        GL_CHECK(glBindVertexArray(vertexArrayObjectId));
+
+        GL_CHECK(glGenBuffers(1, &vertexBufferObjectId));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vertexBufferObjectId));
+        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW));
+
+        GL_CHECK(glEnableVertexAttribArray(0));
+        GL_CHECK(glVertexAttribPointer(0, NUMBER_OF_POINT_COORDINATES, GL_FLOAT, GL_FALSE, stride, 0));
+        GL_CHECK(glEnableVertexAttribArray(1));
+        GL_CHECK(glVertexAttribPointer(1, NUMBER_OF_COLOR_COMPONENTS, GL_FLOAT, GL_FALSE, stride,
+                                       (const GLvoid *)(NUMBER_OF_POINT_COORDINATES * sizeof(GLfloat))));
+
+        GL_CHECK(glGenBuffers(1, &indexBufferObjectId));
+        GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferObjectId));
+        GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW));
+
+        /* The visible instances are read as instanced attributes: the mat4 takes locations 2 to 5, the colour 6. */
+        GL_CHECK(glGenBuffers(1, &visibleInstanceBufferObjectId));
+        GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, visibleInstanceBufferObjectId));
+        GL_CHECK(glBufferData(GL_ARRAY_BUFFER, numberOfInstances * visibleInstanceStride, NULL, GL_DYNAMIC_COPY));
+
+        for (int column = 0; column < 5; column++)
+        {
+            GL_CHECK(glEnableVertexAttribArray(2 + column));
+            GL_CHECK(glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, visibleInstanceStride,
+                                           (const GLvoid *)(column * 4 * sizeof(GLfloat))));
+            GL_CHECK(glVertexAttribDivisor(2 + column, 1));
+        }
+
+        GL_CHECK(glBindVertexArray(0));
+
+        DrawElementsIndirectCommand command = { sizeof(indices) / sizeof(indices[0]), 0, 0, 0, 0 };
+
+        GL_CHECK(glGenBuffers(1, &drawCommandBufferObjectId));
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBufferObjectId));
+        GL_CHECK(glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(command), &command, GL_DYNAMIC_DRAW));
+    }
+
+    void LargeScaleInstancing::createInstances()
+    {
+        InstanceData *instances = (InstanceData *)malloc(numberOfInstances * sizeof(InstanceData));
+
+        ASSERT(instances != NULL, "Could not allocate memory for instance data.");
+
+        for (int instance = 0; instance < numberOfInstances; instance++)
+        {
+            /* Uniform over a disc of radius 200, a good share of which falls outside of the frustum near the camera. */
+            float radius = 200.0f * sqrtf((float)rand() / (float)RAND_MAX);
+
+            instances[instance].orbit[0] = 2.0f * M_PI * (float)rand() / (float)RAND_MAX;
+            instances[instance].orbit[1] = radius;
+            instances[instance].orbit[2] = 20.0f - 420.0f * (float)rand() / (float)RAND_MAX;
+            instances[instance].orbit[3] = 2.0f / (3.0f + radius);
+
+            instances[instance].color[0] = (float)rand() / (float)RAND_MAX;
+            instances[instance].color[1] = (float)rand() / (float)RAND_MAX;
+            instances[instance].color[2] = (float)rand() / (float)RAND_MAX;
+            instances[instance].color[3] = 5.0f + 95.0f * (float)rand() / (float)RAND_MAX;
+        }
+
+        GL_CHECK(glGenBuffers(1, &instanceBufferObjectId));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBufferObjectId));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER, numberOfInstances * sizeof(InstanceData), instances, GL_STATIC_DRAW));
+
+        free(instances);
+    }
+
+    void LargeScaleInstancing::computeViewProjection(const Vec4f &perspectiveVector, const Vec3f &cameraVector)
+    {
+        /* Same expressions as the perspective matrix built in vertex_shader_source.vert. */
+        const float fieldOfView = 1.0f / tanf(perspectiveVector.x * 0.5f);
+        const float nearPlane   = perspectiveVector.z;
+        const float farPlane    = perspectiveVector.w;
+
+        float *m = viewProjectionMatrix;
+
+        for (int element = 0; element < 16; element++)
+        {
+            m[element] = 0.0f;
+        }
+
+        m[0]  = fieldOfView / perspectiveVector.y;
+        m[5]  = fieldOfView;
+        m[10] = -(farPlane + nearPlane) / (farPlane - nearPlane);
+        m[11] = -1.0f;
+        m[14] = (-2.0f * farPlane * nearPlane) / (farPlane - nearPlane);
+
+        /* The camera matrix is a translation, so multiplying it from the right only changes the last column. */
+        for (int row = 0; row < 4; row++)
+        {
+            m[12 + row] += m[row] * cameraVector.x + m[4 + row] * cameraVector.y + m[8 + row] * cameraVector.z;
+        }
+
+        /* Planes are sums and differences of the fourth row with the others: left, right, bottom, top, near, far. */
+        for (int plane = 0; plane < 6; plane++)
+        {
+            const int   row  = plane / 2;
+            const float sign = (plane % 2 == 0) ? 1.0f : -1.0f;
+
+            for (int column = 0; column < 4; column++)
+            {
+                frustumPlanes[plane][column] = m[column * 4 + 3] + sign * m[column * 4 + row];
+            }
+
+            const float length = sqrtf(frustumPlanes[plane][0] * frustumPlanes[plane][0] +
+                                       frustumPlanes[plane][1] * frustumPlanes[plane][1] +
+                                       frustumPlanes[plane][2] * frustumPlanes[plane][2]);
+
+            for (int column = 0; column < 4; column++)
+            {
+                frustumPlanes[plane][column] /= length;
+            }
+        }
+    }
+
+    /* Please see header for specification. */
+    void LargeScaleInstancing::update(float time)
+    {
+        /* Only the instance count has to be cleared, the rest of the command never changes. */
+        const GLuint zero = 0;
+
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBufferObjectId));
+        GL_CHECK(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, offsetof(DrawElementsIndirectCommand, instanceCount), sizeof(zero), &zero));
+
+        GL_CHECK(glUseProgram(cullingProgramId));
+        GL_CHECK(glUniform1f(timeLocation, time));
+
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBufferObjectId));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleInstanceBufferObjectId));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawCommandBufferObjectId));
+
+        GL_CHECK(dispatchCompute((numberOfInstances + cullingWorkGroupSize - 1) / cullingWorkGroupSize, 1, 1));
+
+        /* The draw reads the command written by the atomics and the compacted transforms as vertex attributes. */
+        GL_CHECK(memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT));
+    }
+
+    /* Please see header for specification. */
+    void LargeScaleInstancing::draw()
+    {
+        GL_CHECK(glUseProgram(renderingProgramId));
+        GL_CHECK(glBindVertexArray(vertexArrayObjectId));
+        GL_CHECK(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBufferObjectId));
+
+        /* [Indirect drawing command] */
+        GL_CHECK(drawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, NULL));
+        /* [Indirect drawing command] */
+
+        GL_CHECK(glBindVertexArray(0));
+    }
+}
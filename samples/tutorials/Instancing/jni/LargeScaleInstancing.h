@@ -0,0 +1,134 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef LARGE_SCALE_INSTANCING_H
+#define LARGE_SCALE_INSTANCING_H
+
+#include <GLES3/gl31.h>
+#include "VectorTypes.h"
+
+namespace MaliSDK
+{
+    /**
+     * \brief GPU driven instancing of a very large number of cubes.
+     *
+     * A compute shader animates every instance, tests its bounding sphere against the view frustum and appends
+     * the transforms of the visible instances to a compacted buffer. The instance count of the indirect draw command
+     * is incremented by the same compute shader, so the cubes are drawn with a single glDrawElementsIndirect call
+     * without the CPU ever reading back how many of them are visible.
+     *
+     * \note Requires OpenGL ES 3.1. The entry points are fetched at run time so the tutorial still runs on OpenGL ES 3.0.
+     */
+    class LargeScaleInstancing
+    {
+    private:
+        typedef void (GL_APIENTRYP DispatchComputeFunction)(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ);
+        typedef void (GL_APIENTRYP MemoryBarrierFunction)(GLbitfield barriers);
+        typedef void (GL_APIENTRYP DrawElementsIndirectFunction)(GLenum mode, GLenum type, const void *indirect);
+
+        static DispatchComputeFunction dispatchCompute;
+        static MemoryBarrierFunction memoryBarrier;
+        static DrawElementsIndirectFunction drawElementsIndirect;
+
+        /* Number of instances which are animated and culled every frame. */
+        int numberOfInstances;
+
+        /* Program animating and culling the instances. */
+        GLuint cullingProgramId;
+        /* Program rendering the visible instances. */
+        GLuint renderingProgramId;
+
+        /* Per-instance orbit and colour, written once. */
+        GLuint instanceBufferObjectId;
+        /* Transforms and colours of the instances which passed the frustum test. */
+        GLuint visibleInstanceBufferObjectId;
+        /* Indirect draw command whose instance count is written by the culling program. */
+        GLuint drawCommandBufferObjectId;
+        /* Positions and colours of the cube vertices. */
+        GLuint vertexBufferObjectId;
+        /* Indices of the cube triangles. */
+        GLuint indexBufferObjectId;
+        /* Vertex array object binding cube vertices and visible instances. */
+        GLuint vertexArrayObjectId;
+
+        GLint timeLocation;
+        GLint numberOfInstancesLocation;
+        GLint frustumPlanesLocation;
+        GLint boundingRadiusLocation;
+        GLint viewProjectionMatrixLocation;
+
+        /* Column-major view-projection matrix, the same projection as the vertex shader of the ten cube version. */
+        float viewProjectionMatrix[16];
+        /* World space frustum planes extracted from viewProjectionMatrix, normals pointing inwards. */
+        float frustumPlanes[6][4];
+
+        void createPrograms();
+        void createGeometry(float cubeSize);
+        void createInstances();
+        void computeViewProjection(const Vec4f &perspectiveVector, const Vec3f &cameraVector);
+
+        /* Forbid copying; the object owns GL names. */
+        LargeScaleInstancing(const LargeScaleInstancing &);
+        LargeScaleInstancing &operator=(const LargeScaleInstancing &);
+
+    public:
+        /**
+         * \brief Check the current context supports compute shaders and indirect draws.
+         *
+         * \note Must be called with a current context, before creating an instance of the class.
+         *
+         * \return True if OpenGL ES 3.1 is available.
+         */
+        static bool isSupported();
+
+        /**
+         * \brief Create programs, geometry and instance data.
+         *
+         * \param numberOfInstances Number of cubes to animate and cull every frame.
+         * \param cubeSize          Scaling factor indicating size of a cube.
+         * \param perspectiveVector Field of view, aspect ratio, near and far planes, as used by the ten cube version.
+         * \param cameraVector      Camera position.
+         */
+        LargeScaleInstancing(int numberOfInstances, float cubeSize, const Vec4f &perspectiveVector, const Vec3f &cameraVector);
+
+        ~LargeScaleInstancing();
+
+        /**
+         * \brief Animate and cull all instances on the GPU.
+         *
+         * \param time Time in seconds used for setting positions and rotations of the cubes.
+         */
+        void update(float time);
+
+        /**
+         * \brief Draw the instances which passed the culling in update() with a single indirect draw call.
+         */
+        void draw();
+
+        /**
+         * \brief Get the number of instances which are animated and culled every frame.
+         */
+        int getNumberOfInstances() const
+        {
+            return numberOfInstances;
+        }
+    };
+}
+#endif /* LARGE_SCALE_INSTANCING_H */
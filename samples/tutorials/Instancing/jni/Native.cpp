@@ -26,6 +26,9 @@
  * This reduces the amount of memory which needs to be transferred to the GPU.
  * By using gl_instanceID in the shader, each of the cubes can have a different position, rotation speed and colour.
  * This technique can be used everywhere repeated geometry is used in a scene.
+ *
+ * With LARGE_SCALE_INSTANCING set, over a hundred thousand cubes are animated and frustum culled by a compute shader
+ * instead, and drawn with a single indirect draw call (see LargeScaleInstancing).
  */
 #include <jni.h>
 #include <android/log.h>
@@ -34,9 +37,13 @@
 #include "Common.h"
 #include "CubeModel.h"
 #include "Instancing.h"
+#include "LargeScaleInstancing.h"
+#include "SampleParameters.h"
 #include "Shader.h"
 #include "Timer.h"
+#include <cstdio>
 #include <cstring>
+#include <vector>
 
 using namespace MaliSDK;
 
@@ -61,12 +68,21 @@ float* cubeTrianglesCoordinates = NULL;
 int numberOfValuesInVertexColorsArray = 0;
 /* Array holding color values for each vertex of cube triangle. */
 GLfloat* vertexColors = NULL;
-/* Number of values written to cubeColors array. RGBA values for each cube. */
-const int numberOfValuesInCubeColorsArray = NUMBER_OF_COLOR_COMPONENTS * NUMBER_OF_CUBES;
-/* Array holding color values for each cube. */
-GLfloat cubeColors[numberOfValuesInCubeColorsArray] = {0};
+/* Number of cubes drawn, NUMBER_OF_CUBES unless the number_of_cubes parameter is set. */
+int numberOfCubes = NUMBER_OF_CUBES;
+/* Array holding color values for each cube, RGBA values for each cube. */
+std::vector<GLfloat> cubeColors;
 /* Scaling factor indicating size of a cube. */
 const float cubeSize = 2.5f;
+/* Scaling factor indicating size of a cube in the large scale mode. */
+const float largeScaleCubeSize = 0.5f;
+
+/* GPU animated and culled cubes, only created when LARGE_SCALE_INSTANCING is set and OpenGL ES 3.1 is available. */
+LargeScaleInstancing* largeScaleInstancing = NULL;
+/* Number of frames rendered since the frame rate was last logged in the large scale mode. */
+int largeScaleFrameCount = 0;
+/* Time at which the frame rate was last logged in the large scale mode. */
+float largeScaleLogTime = 0.0f;
 
 /* Uniform and attribute locations. */
 /* "Camera position" shader uniform which is used to set up a view. */
@@ -100,7 +116,7 @@ GLuint uniformBlockDataBufferObjectId = 0;
 
 /* Start positions of cubes in 3D space. */
 /* Array holding start position of cubes in 3D space which are used to draw cubes for the first time. */
-GLfloat startPosition[NUMBER_OF_CUBES] = {0};
+std::vector<GLfloat> startPosition;
 
 /*
  * Arrays holding data used for setting perspective and view.
@@ -120,10 +136,12 @@ Vec3f cameraVector;
  */
 void generateStartPosition()
 {
-    float spaceBetweenCubes = (2 * M_PI) / (NUMBER_OF_CUBES);
+    float spaceBetweenCubes = (2 * M_PI) / (numberOfCubes);
+
+    startPosition.resize(numberOfCubes);
 
     /* Fill array with startPosition data. */
-    for (int allCubes = 0; allCubes < NUMBER_OF_CUBES; allCubes++)
+    for (int allCubes = 0; allCubes < numberOfCubes; allCubes++)
     {
         startPosition[allCubes] = allCubes * spaceBetweenCubes;
     }
@@ -136,8 +154,10 @@ void generateStartPosition()
  */
 void fillCubeColorsArray()
 {
+    cubeColors.resize(NUMBER_OF_COLOR_COMPONENTS * numberOfCubes);
+
     for (int allComponents = 0;
-             allComponents < numberOfValuesInCubeColorsArray;
+             allComponents < (int)cubeColors.size();
              allComponents++)
     {
         /* Get random value from [0.0, 1.0] range. */
@@ -236,19 +256,22 @@ void initializeData()
     /* Buffer holding coordinates of start positions of cubes and RGBA values of colors. */
     GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER,
                           uniformBlockDataBufferObjectId));
+    const GLsizeiptr startPositionSize = startPosition.size() * sizeof(GLfloat);
+    const GLsizeiptr cubeColorsSize    = cubeColors.size() * sizeof(GLfloat);
+
     GL_CHECK(glBufferData(GL_ARRAY_BUFFER,
-                          sizeof(startPosition) + sizeof(cubeColors),
+                          startPositionSize + cubeColorsSize,
                           NULL,
                           GL_STATIC_DRAW));
 
     GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER,
                              0,
-                             sizeof(startPosition),
-                             startPosition));
+                             startPositionSize,
+                             &startPosition[0]));
     GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER,
-                             sizeof(startPosition),
-                             sizeof(cubeColors),
-                             cubeColors));
+                             startPositionSize,
+                             cubeColorsSize,
+                             &cubeColors[0]));
     /* [Set uniform block buffer data] */
 
     /* Deallocate memory (data is now stored in buffer objects). */
@@ -276,9 +299,13 @@ void setupProgram()
     renderingProgramId = GL_CHECK(glCreateProgram());
     /* [Create a program object] */
 
+    /* The uniform block of the vertex shader is sized for the cubes drawn. */
+    char vertexShaderDefines[64];
+    snprintf(vertexShaderDefines, sizeof(vertexShaderDefines), "#define NUMBER_OF_CUBES %d\n", numberOfCubes);
+
     /* Initialize rendering program. */
     /* [Initialize shader objects] */
-    Shader::processShader(&vertexShaderId,   VERTEX_SHADER_FILE_NAME,   GL_VERTEX_SHADER);
+    Shader::processShader(&vertexShaderId,   VERTEX_SHADER_FILE_NAME,   GL_VERTEX_SHADER, vertexShaderDefines);
     Shader::processShader(&fragmentShaderId, FRAGMENT_SHADER_FILE_NAME, GL_FRAGMENT_SHADER);
     /* [Initialize shader objects] */
 
@@ -330,6 +357,24 @@ void renderFrame()
     /* Value of time returned by timer used for setting cubes rotations and positions. */
     const float time = timer.getTime();
 
+    if (largeScaleInstancing != NULL)
+    {
+        largeScaleInstancing->update(time);
+        largeScaleInstancing->draw();
+
+        /* Log the frame rate every few seconds, it is the figure of merit of this mode. */
+        largeScaleFrameCount++;
+        if (time - largeScaleLogTime > 5.0f)
+        {
+            LOGI("%d instances: %.1f FPS", largeScaleInstancing->getNumberOfInstances(), largeScaleFrameCount / (time - largeScaleLogTime));
+
+            largeScaleFrameCount = 0;
+            largeScaleLogTime    = time;
+        }
+
+        return;
+    }
+
     /* [Set time uniform value] */
     GL_CHECK(glUniform1f(timeLocation, time));
     /* [Set time uniform value] */
@@ -339,7 +384,7 @@ void renderFrame()
     GL_CHECK(glDrawArraysInstanced(GL_TRIANGLES,
                                    0,
                                    numberOfCubeVertices,
-                                   NUMBER_OF_CUBES));
+                                   numberOfCubes));
     /* [Instanced drawing command] */
 }
 
@@ -354,6 +399,38 @@ void setupGraphics(int width, int height)
     cameraVector.y = 0.0f;
     cameraVector.z = -60.0f;
 
+    /* Workload sizes, so the benchmark harness can sweep them without rebuilding. */
+    SampleParameters::load(PARAMETERS_DIRECTORY);
+
+    /*
+     * Each cube takes a float and a vec4 of the uniform block, each padded to 16 bytes in the worst case,
+     * so the block holds at least GL_MAX_UNIFORM_BLOCK_SIZE / 32 cubes.
+     */
+    GLint maximumUniformBlockSize = 0;
+    GL_CHECK(glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maximumUniformBlockSize));
+    numberOfCubes = SampleParameters::getInt("number_of_cubes", NUMBER_OF_CUBES, 1, maximumUniformBlockSize / 32);
+
+    bool largeScale = SampleParameters::getInt("large_scale_instancing", LARGE_SCALE_INSTANCING, 0, 1) != 0;
+    int numberOfLargeScaleCubes = SampleParameters::getInt("large_scale_cubes", NUMBER_OF_LARGE_SCALE_CUBES, 1, 16 * 1024 * 1024);
+
+    if (largeScale)
+    {
+        if (LargeScaleInstancing::isSupported())
+        {
+            largeScaleInstancing = new LargeScaleInstancing(numberOfLargeScaleCubes, largeScaleCubeSize, perspectiveVector, cameraVector);
+
+            GL_CHECK(glEnable(GL_DEPTH_TEST));
+
+            largeScaleFrameCount = 0;
+            largeScaleLogTime    = 0.0f;
+            timer.reset();
+
+            return;
+        }
+
+        LOGI("OpenGL ES 3.1 is not available, drawing %d cubes instead of %d.", numberOfCubes, numberOfLargeScaleCubes);
+    }
+
     /* Initialize data used for rendering. */
     initializeData();
     /* Create program. */
@@ -411,6 +488,13 @@ void setupGraphics(int width, int height)
 
 void uninit()
 {
+    if (largeScaleInstancing != NULL)
+    {
+        delete largeScaleInstancing;
+
+        largeScaleInstancing = NULL;
+    }
+
     /* Delete buffers. */
     GL_CHECK(glDeleteBuffers(numberOfBufferObjectIds, bufferObjectIds));
 
@@ -47,6 +47,8 @@ public class Instancing extends Activity
 
         extractAsset("fragment_shader_source.frag");
         extractAsset("vertex_shader_source.vert");
+        extractAsset("large_scale_culling.comp");
+        extractAsset("large_scale_vertex_shader.vert");
 
         /* [onCreateNew] */
         setContentView(tutorialView);
@@ -0,0 +1,45 @@
+#version 300 es
+
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+precision highp float;
+precision highp usampler2D;
+
+/* Number of bits (cells) stored in a single texel of the packed texture. */
+#define CELLS_PER_WORD 32
+
+/* Sampler holding the bit-packed cells written by the compute shader. */
+uniform usampler2D packedTexture;
+
+/* UV coordinates received from vertex shader, unused: the texture is addressed in window coordinates. */
+in vec2 fragmentTexCoord;
+
+/* Output variable. */
+out vec4 fragColor;
+
+void main()
+{
+    ivec2 cell = ivec2(gl_FragCoord.xy);
+    uint  word = texelFetch(packedTexture, ivec2(cell.x / CELLS_PER_WORD, cell.y), 0).r;
+
+    /* Extract the bit of the current cell. */
+    fragColor = vec4(float((word >> uint(cell.x % CELLS_PER_WORD)) & 1u));
+}
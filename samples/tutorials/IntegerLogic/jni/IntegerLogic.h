@@ -35,6 +35,17 @@ namespace MaliSDK
     #define  FRAGMENT_RULE_30_SHADER_FILENAME ("/data/data/com.arm.malideveloper.openglessdk.integerLogic/files/IntegerLogic_Rule30_shader.frag")
     /* Name of the file in which "merge" fragment shader's body is located. */
     #define  FRAGMENT_MERGE_SHADER_FILENAME ("/data/data/com.arm.malideveloper.openglessdk.integerLogic/files/IntegerLogic_Merge_shader.frag")
+    /* Name of the file in which "rule 30" compute shader's body is located. */
+    #define  COMPUTE_RULE_30_SHADER_FILENAME ("/data/data/com.arm.malideveloper.openglessdk.integerLogic/files/IntegerLogic_Rule30_shader.comp")
+    /* Name of the file in which "unpack" fragment shader's body is located. */
+    #define  FRAGMENT_UNPACK_SHADER_FILENAME ("/data/data/com.arm.malideveloper.openglessdk.integerLogic/files/IntegerLogic_Unpack_shader.frag")
+
+    /* Number of cells packed into a single 32-bit texel by the compute path. */
+    #define CELLS_PER_WORD (32)
+    /* Number of invocations in a work group of the "rule 30" compute shader. Must match the shader. */
+    #define RULE_30_WORK_GROUP_SIZE (64)
+    /* Number of generations evolved by a single dispatch. The one-word halo of a work group allows up to CELLS_PER_WORD. */
+    #define GENERATIONS_PER_DISPATCH (CELLS_PER_WORD)
 
     /* Structure storing locations of attributes and uniforms for merge program. */
     struct MergeProgramLocations
@@ -55,6 +66,21 @@ namespace MaliSDK
         }
     };
 
+    /* Structure storing locations of uniforms for the "rule 30" compute program. */
+    struct Rule30ComputeProgramLocations
+    {
+        GLint firstRowLocation;
+        GLint numberOfCellsLocation;
+        GLint numberOfGenerationsLocation;
+
+        Rule30ComputeProgramLocations()
+        {
+            firstRowLocation            = -1;
+            numberOfCellsLocation       = -1;
+            numberOfGenerationsLocation = -1;
+        }
+    };
+
     /* Structure storing locations of attributes and uniforms for rule30 program. */
     struct Rule30ProgramLocations
     {
@@ -39,12 +39,19 @@
  *        For the first run, the input line has only one pixel lit, so it generates
  *        the commonly known Rule 30 pattern. Then, every 5 seconds, textures are reset
  *        and the input is randomly generated.
+ *
+ *        On OpenGL ES 3.1 devices, the pattern is computed by a compute shader instead. It packs 32 cells into
+ *        each texel of an R32UI image, so a single bitwise expression evolves 32 cells at once, and it evolves
+ *        GENERATIONS_PER_DISPATCH generations per dispatch in shared memory rather than one row per draw call.
+ *        The packed image is then unpacked to the back buffer by a fragment shader.
  */
 
 #include <jni.h>
 #include <android/log.h>
 
+#include <EGL/egl.h>
 #include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
 #include "Common.h"
 #include "CubeModel.h"
 #include "Mathematics.h"
@@ -55,6 +62,7 @@
 #include "Texture.h"
 #include "Timer.h"
 #include <cstring>
+#include <vector>
 
 using namespace MaliSDK;
 
@@ -109,6 +117,30 @@ Timer timer;
 /* Time interval in seconds. */
 const float timeInterval = 5.0f;
 
+/* OpenGL ES 3.1 entry points used by the compute path, fetched at run time so the tutorial still runs on OpenGL ES 3.0. */
+typedef void (GL_APIENTRYP BindImageTextureFunction)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+typedef void (GL_APIENTRYP DispatchComputeFunction) (GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ);
+typedef void (GL_APIENTRYP MemoryBarrierFunction)   (GLbitfield barriers);
+
+BindImageTextureFunction bindImageTexture = NULL;
+DispatchComputeFunction  dispatchCompute  = NULL;
+MemoryBarrierFunction    memoryBarrier    = NULL;
+
+/* True if the pattern is evolved by the compute shader on bit-packed cells. */
+bool useComputePath = false;
+/* ID assigned by GL ES for the "rule 30" compute program. */
+GLuint rule30ComputeProgramID = 0;
+/* ID assigned by GL ES for the "unpack" program. */
+GLuint unpackProgramID        = 0;
+/* Texture unit used for the bit-packed texture. */
+const GLuint packedTextureUnit = 2;
+/* ID of the texture holding CELLS_PER_WORD cells per texel, written by the compute shader. */
+GLuint packedTextureID = 0;
+/* Number of texels needed to store a row of cells in the packed texture. */
+GLsizei wordsPerRow = 0;
+/* "rule 30" compute program locations. */
+Rule30ComputeProgramLocations rule30ComputeProgramLocations;
+
 
 /**
  * \brief Generates input for Rule 30 Cellular Automaton, setting a white dot in the top line of the texture
@@ -156,6 +188,21 @@ void setupGraphics(int width, int height);
 /* Perform a clean up. */
 void uninit();
 
+/* Check whether the compute path can be used and fetch the OpenGL ES 3.1 entry points it needs. */
+bool isComputePathSupported();
+
+/* Creates the programs and the packed texture used by the compute path. The merge program must be set up already. */
+void setupComputePath();
+
+/* Packs the first line of the ping texture data into the top row of the packed texture. */
+void uploadPackedInput();
+
+/* Evolves the whole pattern, GENERATIONS_PER_DISPATCH rows per dispatch, into the packed texture. */
+void performComputeEvolution();
+
+/* Renders the packed texture to the back buffer. */
+void renderPackedToBackBuffer();
+
 /* [Generate input texture data] */
 /* Please see the specification above. */
 void generateRule30Input(unsigned int xoffset,
@@ -275,6 +322,170 @@ void renderToBackBuffer()
 }
 /* [Perform textures' merging] */
 
+/* Please see the specification above. */
+bool isComputePathSupported()
+{
+    GLint majorVersion = 0;
+    GLint minorVersion = 0;
+
+    GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &majorVersion));
+    GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minorVersion));
+
+    if (majorVersion < 3 || (majorVersion == 3 && minorVersion < 1))
+    {
+        return false;
+    }
+
+    bindImageTexture = (BindImageTextureFunction) eglGetProcAddress("glBindImageTexture");
+    dispatchCompute  = (DispatchComputeFunction)  eglGetProcAddress("glDispatchCompute");
+    memoryBarrier    = (MemoryBarrierFunction)    eglGetProcAddress("glMemoryBarrier");
+
+    return bindImageTexture != NULL && dispatchCompute != NULL && memoryBarrier != NULL;
+}
+
+/* Please see the specification above. */
+void setupComputePath()
+{
+    GLuint computeShaderID        = 0;
+    GLuint fragmentUnpackShaderID = 0;
+    GLuint vertexMergeShaderID    = 0;
+
+    wordsPerRow = (windowWidth + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+
+    /* [Prepare packed texture object] */
+    GL_CHECK(glGenTextures  (1, &packedTextureID));
+    GL_CHECK(glActiveTexture(GL_TEXTURE0 + packedTextureUnit));
+    GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
+                             packedTextureID));
+    GL_CHECK(glTexStorage2D (GL_TEXTURE_2D,
+                             1,
+                             GL_R32UI,
+                             wordsPerRow,
+                             windowHeight));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
+                             GL_TEXTURE_MAG_FILTER,
+                             GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D,
+                             GL_TEXTURE_MIN_FILTER,
+                             GL_NEAREST));
+    /* [Prepare packed texture object] */
+
+    uploadPackedInput();
+
+    /* The same image is read for the first row of a dispatch and written for the following ones. */
+    bindImageTexture(0, packedTextureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+
+    /* Set up the compute program. */
+    Shader::processShader(&computeShaderID, COMPUTE_RULE_30_SHADER_FILENAME, GL_COMPUTE_SHADER);
+
+    rule30ComputeProgramID = GL_CHECK(glCreateProgram());
+
+    GL_CHECK(glAttachShader(rule30ComputeProgramID, computeShaderID));
+    GL_CHECK(glLinkProgram (rule30ComputeProgramID));
+    GL_CHECK(glUseProgram  (rule30ComputeProgramID));
+
+    rule30ComputeProgramLocations.firstRowLocation            = GL_CHECK(glGetUniformLocation(rule30ComputeProgramID, "firstRow")           );
+    rule30ComputeProgramLocations.numberOfCellsLocation       = GL_CHECK(glGetUniformLocation(rule30ComputeProgramID, "numberOfCells")      );
+    rule30ComputeProgramLocations.numberOfGenerationsLocation = GL_CHECK(glGetUniformLocation(rule30ComputeProgramID, "numberOfGenerations"));
+
+    ASSERT(rule30ComputeProgramLocations.firstRowLocation            != -1, "Could not find location of a uniform in rule30 compute program: firstRow"           );
+    ASSERT(rule30ComputeProgramLocations.numberOfCellsLocation       != -1, "Could not find location of a uniform in rule30 compute program: numberOfCells"      );
+    ASSERT(rule30ComputeProgramLocations.numberOfGenerationsLocation != -1, "Could not find location of a uniform in rule30 compute program: numberOfGenerations");
+
+    GL_CHECK(glUniform1i(rule30ComputeProgramLocations.numberOfCellsLocation, windowWidth));
+
+    /* Set up the unpack program. It shares the quad VAO with the merge program, so the attribute locations are bound to match. */
+    Shader::processShader(&vertexMergeShaderID,    VERTEX_MERGE_SHADER_FILENAME,    GL_VERTEX_SHADER);
+    Shader::processShader(&fragmentUnpackShaderID, FRAGMENT_UNPACK_SHADER_FILENAME, GL_FRAGMENT_SHADER);
+
+    unpackProgramID = GL_CHECK(glCreateProgram());
+
+    GL_CHECK(glAttachShader      (unpackProgramID, vertexMergeShaderID));
+    GL_CHECK(glAttachShader      (unpackProgramID, fragmentUnpackShaderID));
+    GL_CHECK(glBindAttribLocation(unpackProgramID, mergeProgramLocations.positionLocation, "position"));
+    GL_CHECK(glBindAttribLocation(unpackProgramID, mergeProgramLocations.texCoordLocation, "vertexTexCoord"));
+    GL_CHECK(glLinkProgram       (unpackProgramID));
+    GL_CHECK(glUseProgram        (unpackProgramID));
+
+    GLint mvpMatrixLocation     = GL_CHECK(glGetUniformLocation(unpackProgramID, "mvpMatrix"));
+    GLint packedTextureLocation = GL_CHECK(glGetUniformLocation(unpackProgramID, "packedTexture"));
+
+    ASSERT(mvpMatrixLocation     != -1, "Could not find location of a uniform in unpack program: mvpMatrix");
+    ASSERT(packedTextureLocation != -1, "Could not find location of a uniform in unpack program: packedTexture");
+
+    GL_CHECK(glUniformMatrix4fv(mvpMatrixLocation,
+                                1,
+                                GL_FALSE,
+                                modelViewProjectionMatrix.getAsArray()));
+    GL_CHECK(glUniform1i       (packedTextureLocation,
+                                packedTextureUnit));
+}
+
+/* Please see the specification above. */
+void uploadPackedInput()
+{
+    const unsigned char* inputLine = (const unsigned char*) pingTextureData + (windowHeight - 1) * windowWidth;
+    std::vector<GLuint>  packedLine(wordsPerRow, 0);
+
+    for (GLsizei cellIndex = 0; cellIndex < windowWidth; ++cellIndex)
+    {
+        if (inputLine[cellIndex] != 0)
+        {
+            packedLine[cellIndex / CELLS_PER_WORD] |= 1u << (cellIndex % CELLS_PER_WORD);
+        }
+    }
+
+    /* Only the top row is uploaded: all the other rows are overwritten by the compute shader. */
+    GL_CHECK(glActiveTexture(GL_TEXTURE0 + packedTextureUnit));
+    GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D,
+                             0,
+                             0,
+                             windowHeight - 1,
+                             wordsPerRow,
+                             1,
+                             GL_RED_INTEGER,
+                             GL_UNSIGNED_INT,
+                             &packedLine[0]));
+}
+
+/* [Perform the compute evolution] */
+/* Please see the specification above. */
+void performComputeEvolution()
+{
+    /* Each work group writes all but its two halo words. */
+    const GLuint numberOfWorkGroups = (wordsPerRow + RULE_30_WORK_GROUP_SIZE - 3) / (RULE_30_WORK_GROUP_SIZE - 2);
+
+    GL_CHECK(glUseProgram(rule30ComputeProgramID));
+
+    /* The top row holds the input, every dispatch continues from the last row written by the previous one. */
+    for (GLint firstRow = windowHeight - 1; firstRow > 0; firstRow -= GENERATIONS_PER_DISPATCH)
+    {
+        GLint numberOfGenerations = (firstRow < GENERATIONS_PER_DISPATCH) ? firstRow : GENERATIONS_PER_DISPATCH;
+
+        GL_CHECK(glUniform1i(rule30ComputeProgramLocations.firstRowLocation,            firstRow));
+        GL_CHECK(glUniform1i(rule30ComputeProgramLocations.numberOfGenerationsLocation, numberOfGenerations));
+
+        dispatchCompute(numberOfWorkGroups, 1, 1);
+
+        /* The next dispatch reads the last row written by this one. */
+        memoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    /* The packed texture is sampled next. */
+    memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+/* [Perform the compute evolution] */
+
+/* Please see the specification above. */
+void renderPackedToBackBuffer()
+{
+    GL_CHECK(glUseProgram     (unpackProgramID));
+    GL_CHECK(glBindVertexArray(quadVAOID));
+
+    /* Draw a quad as a triangle strip defined by 4 vertices. */
+    GL_CHECK(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+}
+
 /* Please see the specification above. */
 void setupGraphics(int width, int height)
 {
@@ -565,14 +776,33 @@ void setupGraphics(int width, int height)
     /* Set line width to 1.5, to avoid rounding errors. */
     GL_CHECK(glLineWidth(1.5));
 
+    useComputePath = isComputePathSupported();
+
+    if (useComputePath)
+    {
+        setupComputePath();
+    }
+    else
+    {
+        LOGI("OpenGL ES 3.1 is not supported: using the fragment shader path.\n");
+    }
+
     timer.reset();
 }
 
 /* Please see the specification above. */
 void renderFrame()
 {
-    performOffscreenRendering();
-    renderToBackBuffer();
+    if (useComputePath)
+    {
+        performComputeEvolution();
+        renderPackedToBackBuffer();
+    }
+    else
+    {
+        performOffscreenRendering();
+        renderToBackBuffer();
+    }
 
     if (timer.getTime()> timeInterval)
     {
@@ -605,6 +835,11 @@ void resetTextures()
                              GL_UNSIGNED_BYTE,
                              pingTextureData));
     /* [Substitute ping texture data] */
+
+    if (useComputePath)
+    {
+        uploadPackedInput();
+    }
 }
 
 /* Please see the specification above. */
@@ -612,6 +847,17 @@ void uninit()
 {
     /* Delete texture data. */
     Texture::deleteTextureData(&pingTextureData);
+
+    if (useComputePath)
+    {
+        GL_CHECK(glDeleteTextures(1, &packedTextureID));
+        GL_CHECK(glDeleteProgram (rule30ComputeProgramID));
+        GL_CHECK(glDeleteProgram (unpackProgramID));
+
+        packedTextureID        = 0;
+        rule30ComputeProgramID = 0;
+        unpackProgramID        = 0;
+    }
 }
 
 extern "C"
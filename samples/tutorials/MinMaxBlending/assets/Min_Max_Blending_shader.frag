@@ -38,12 +38,24 @@ uniform isampler3D textureSampler;
 uniform bool isMinBlending;
 /* Threshold used for min blending. */
 uniform float minBlendingThreshold;
+/* Layers in <firstUnloadedLayer, backLayersStart) have not been streamed in yet. */
+uniform int firstUnloadedLayer;
+uniform int backLayersStart;
 
 /* Output variable. */
 out vec4 fragColor;
 
 void main()
 {
+    /* Skip the layers of images which have not been loaded yet. */
+    int depth = textureSize(textureSampler, 0).z;
+    int layer = clamp(int(floor(uvwCoordinates.z * float(depth))), 0, depth - 1);
+
+    if (layer >= firstUnloadedLayer && layer < backLayersStart)
+    {
+        discard;
+    }
+
     /* Loaded texture short integer data are in big endian order. Swap the bytes. */
     ivec4 initialTexture          = ivec4(texture(textureSampler, uvwCoordinates).rrr, 1.0);
     ivec4 swappedBytesTextureTemp =  (initialTexture << 8) & ivec4(0xFF00);
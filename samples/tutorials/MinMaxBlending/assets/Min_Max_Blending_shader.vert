@@ -24,6 +24,8 @@
 in vec4 inputPosition;
 /* Input U/V/W texture coordinates. */
 in vec3 inputUVWCoordinates;
+/* Tile drawn by the instance: tile X, tile Y and slice. */
+in uvec4 inputTile;
 
 /* Constant transformation matrices. */
 uniform mat4 cameraMatrix;
@@ -35,6 +37,9 @@ uniform vec3 rotationVector;
 /* Number of instances that are going to be drawn. */
 uniform int instancesCount;
 
+/* Number of tiles along each side of a slice. */
+uniform int tilesPerSide;
+
 /* Output texture coordinates passed to fragment shader. */
 out vec3 uvwCoordinates;
 
@@ -42,6 +47,12 @@ void main()
 {
     mat4 modelViewProjectionMatrix;
 
+    /* Slice of the tile, and the position of the tile in the slice. */
+    float slice      = float(inputTile.z);
+    vec2  tileOffset = vec2(inputTile.xy);
+    vec4  position   = vec4((inputPosition.xy + vec2(1.0) + 2.0 * tileOffset) / float(tilesPerSide) - vec2(1.0), inputPosition.zw);
+    vec3  uvw        = vec3((inputUVWCoordinates.xy + tileOffset) / float(tilesPerSide), inputUVWCoordinates.z);
+
     /* Matrix rotating texture coordinates around X axis. */
     mat3 xRotationMatrix = mat3(1.0,  0.0,                            0.0,
                                 0.0,  cos(radians(rotationVector.x)), sin(radians(rotationVector.x)), 
@@ -57,8 +68,8 @@ void main()
                                 -sin(radians(rotationVector.z)), cos(radians(rotationVector.z)), 0.0, 
                                 0.0,                             0.0,                            1.0);
 
-    /* U/V/W coordinates pointing at appropriate layer depending on gl_InstanceID. */
-    vec3 translatedUVWCoordinates = inputUVWCoordinates - vec3(0.0, 0.0, float(gl_InstanceID) / float(instancesCount - 1));
+    /* U/V/W coordinates pointing at appropriate layer depending on the slice. */
+    vec3 translatedUVWCoordinates = uvw - vec3(0.0, 0.0, slice / float(instancesCount - 1));
 
     /* 
     * Translate from <0.0, 1.0> interval to <-1.0, 1.0> to rotate texture coordinates around their center. 
@@ -79,6 +90,6 @@ void main()
     modelViewProjectionMatrix = projectionMatrix * cameraMatrix;
 
     /* Calculate position of vertex. With each instance squares are drawn closer to the viewer. */
-    gl_Position = modelViewProjectionMatrix * (inputPosition + vec4(0.0, 0.0, float(gl_InstanceID) / float(instancesCount - 1), 0.0));
+    gl_Position = modelViewProjectionMatrix * (position + vec4(0.0, 0.0, slice / float(instancesCount - 1), 0.0));
 }
 /* [Vertex shader code] */
\ No newline at end of file
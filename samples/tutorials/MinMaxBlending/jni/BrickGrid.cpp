@@ -0,0 +1,233 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "BrickGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MaliSDK
+{
+    /* Margin in texels added around the bounds of a tile, to cover rounding in the shaders. */
+    static const float tileBoundsMargin = 0.5f;
+
+    /* Rotate a vector the way the vertex shader rotates texture coordinates: around X, then Y, then Z. */
+    static void rotate(const float angles[3], const float input[3], float output[3])
+    {
+        const float degreesToRadians = 3.14159265f / 180.0f;
+
+        float sinX = sinf(angles[0] * degreesToRadians), cosX = cosf(angles[0] * degreesToRadians);
+        float sinY = sinf(angles[1] * degreesToRadians), cosY = cosf(angles[1] * degreesToRadians);
+        float sinZ = sinf(angles[2] * degreesToRadians), cosZ = cosf(angles[2] * degreesToRadians);
+
+        float x = input[0];
+        float y = cosX * input[1] - sinX * input[2];
+        float z = sinX * input[1] + cosX * input[2];
+
+        float rotatedX =  cosY * x + sinY * z;
+        float rotatedZ = -sinY * x + cosY * z;
+
+        output[0] = cosZ * rotatedX - sinZ * y;
+        output[1] = sinZ * rotatedX + cosZ * y;
+        output[2] = rotatedZ;
+    }
+
+    /* Range of bricks holding the texels sampled with nearest filtering and clamping to edge in <low, high>. */
+    static void brickRange(float low, float high, int size, int brickSize, int *first, int *last)
+    {
+        int firstTexel = (int)floorf(low  * size - tileBoundsMargin);
+        int lastTexel  = (int)floorf(high * size + tileBoundsMargin);
+
+        *first = std::min(std::max(firstTexel, 0), size - 1) / brickSize;
+        *last  = std::min(std::max(lastTexel,  0), size - 1) / brickSize;
+    }
+
+    BrickGrid::BrickGrid(int width, int height, int depth, int brickWidth, int brickHeight, int brickDepth)
+        : width(width),
+          height(height),
+          depth(depth),
+          brickWidth(brickWidth),
+          brickHeight(brickHeight),
+          brickDepth(brickDepth),
+          bricksX((width  + brickWidth  - 1) / brickWidth),
+          bricksY((height + brickHeight - 1) / brickHeight),
+          bricksZ((depth  + brickDepth  - 1) / brickDepth),
+          classifiedFirstHiddenLayer(-1),
+          classifiedEndHiddenLayer(-1),
+          classifiedVisibleLimit(-1)
+    {
+        layerMaxima.assign(depth * bricksY * bricksX, 0);
+        nonEmptySums.assign((bricksX + 1) * (bricksY + 1) * (bricksZ + 1), 0);
+    }
+
+    int BrickGrid::sumIndex(int x, int y, int z) const
+    {
+        return (z * (bricksY + 1) + y) * (bricksX + 1) + x;
+    }
+
+    void BrickGrid::setLayer(int layer, const GLshort *data)
+    {
+        unsigned short *maxima = &layerMaxima[layer * bricksY * bricksX];
+
+        std::fill(maxima, maxima + bricksY * bricksX, 0);
+
+        for (int y = 0; y < height; y++)
+        {
+            const unsigned short *row    = (const unsigned short *)data + y * width;
+            unsigned short       *rowMax = maxima + (y / brickHeight) * bricksX;
+
+            for (int x = 0; x < width; x++)
+            {
+                /* Swap the bytes, as the fragment shader does. */
+                unsigned short value = (unsigned short)((row[x] << 8) | (row[x] >> 8));
+
+                rowMax[x / brickWidth] = std::max(rowMax[x / brickWidth], value);
+            }
+        }
+    }
+
+    void BrickGrid::setUniformLayer(int layer, GLshort value)
+    {
+        unsigned short *maxima  = &layerMaxima[layer * bricksY * bricksX];
+        unsigned short  swapped = (unsigned short)(((unsigned short)value << 8) | ((unsigned short)value >> 8));
+
+        std::fill(maxima, maxima + bricksY * bricksX, swapped);
+    }
+
+    void BrickGrid::classify(int firstHiddenLayer, int endHiddenLayer, int visibleLimit)
+    {
+        if (firstHiddenLayer == classifiedFirstHiddenLayer &&
+            endHiddenLayer   == classifiedEndHiddenLayer   &&
+            visibleLimit     == classifiedVisibleLimit)
+        {
+            return;
+        }
+
+        classifiedFirstHiddenLayer = firstHiddenLayer;
+        classifiedEndHiddenLayer   = endHiddenLayer;
+        classifiedVisibleLimit     = visibleLimit;
+
+        for (int z = 0; z < bricksZ; z++)
+        {
+            for (int y = 0; y < bricksY; y++)
+            {
+                for (int x = 0; x < bricksX; x++)
+                {
+                    int nonEmpty = 0;
+
+                    for (int layer = z * brickDepth; layer < std::min((z + 1) * brickDepth, depth) && nonEmpty == 0; layer++)
+                    {
+                        bool hidden = layer >= firstHiddenLayer && layer < endHiddenLayer;
+
+                        if (!hidden && layerMaxima[(layer * bricksY + y) * bricksX + x] >= visibleLimit)
+                        {
+                            nonEmpty = 1;
+                        }
+                    }
+
+                    nonEmptySums[sumIndex(x + 1, y + 1, z + 1)] = nonEmpty
+                        + nonEmptySums[sumIndex(x,     y + 1, z + 1)]
+                        + nonEmptySums[sumIndex(x + 1, y,     z + 1)]
+                        + nonEmptySums[sumIndex(x + 1, y + 1, z    )]
+                        - nonEmptySums[sumIndex(x,     y,     z + 1)]
+                        - nonEmptySums[sumIndex(x,     y + 1, z    )]
+                        - nonEmptySums[sumIndex(x + 1, y,     z    )]
+                        + nonEmptySums[sumIndex(x,     y,     z    )];
+                }
+            }
+        }
+    }
+
+    int BrickGrid::countNonEmpty(int x0, int y0, int z0, int x1, int y1, int z1) const
+    {
+        x1++;
+        y1++;
+        z1++;
+
+        return nonEmptySums[sumIndex(x1, y1, z1)]
+             - nonEmptySums[sumIndex(x0, y1, z1)]
+             - nonEmptySums[sumIndex(x1, y0, z1)]
+             - nonEmptySums[sumIndex(x1, y1, z0)]
+             + nonEmptySums[sumIndex(x0, y0, z1)]
+             + nonEmptySums[sumIndex(x0, y1, z0)]
+             + nonEmptySums[sumIndex(x1, y0, z0)]
+             - nonEmptySums[sumIndex(x0, y0, z0)];
+    }
+
+    int BrickGrid::cullTiles(const float rotationVector[3], int slicesCount, int tilesPerSide, GLubyte *tiles) const
+    {
+        /* The rotation is linear, so texture coordinates change by fixed steps along a slice. */
+        const float unitU[3] = {1.0f, 0.0f, 0.0f};
+        const float unitV[3] = {0.0f, 1.0f, 0.0f};
+        float stepU[3];
+        float stepV[3];
+
+        rotate(rotationVector, unitU, stepU);
+        rotate(rotationVector, unitV, stepV);
+
+        int visibleTilesCount = 0;
+
+        for (int slice = 0; slice < slicesCount; slice++)
+        {
+            /* Corner U = V = 0 of the slice, in the <-1.0, 1.0> interval the vertex shader rotates in. */
+            float corner[3] = {-1.0f, -1.0f, 1.0f - 2.0f * (float)slice / (float)(slicesCount - 1)};
+            float rotatedCorner[3];
+
+            rotate(rotationVector, corner, rotatedCorner);
+
+            for (int tileY = 0; tileY < tilesPerSide; tileY++)
+            {
+                for (int tileX = 0; tileX < tilesPerSide; tileX++)
+                {
+                    int firstBrick[3];
+                    int lastBrick[3];
+                    const int sizes[3]      = {width,      height,      depth};
+                    const int brickSizes[3] = {brickWidth, brickHeight, brickDepth};
+
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        /* The tile is a parallelogram in texture space, bound it by its corners. */
+                        float edgeU  = stepU[axis] / tilesPerSide;
+                        float edgeV  = stepV[axis] / tilesPerSide;
+                        float origin = (rotatedCorner[axis] + 1.0f) / 2.0f + edgeU * tileX + edgeV * tileY;
+                        float low    = origin + std::min(edgeU, 0.0f) + std::min(edgeV, 0.0f);
+                        float high   = origin + std::max(edgeU, 0.0f) + std::max(edgeV, 0.0f);
+
+                        brickRange(low, high, sizes[axis], brickSizes[axis], &firstBrick[axis], &lastBrick[axis]);
+                    }
+
+                    if (countNonEmpty(firstBrick[0], firstBrick[1], firstBrick[2], lastBrick[0], lastBrick[1], lastBrick[2]) > 0)
+                    {
+                        GLubyte *tile = tiles + 4 * visibleTilesCount;
+
+                        tile[0] = (GLubyte)tileX;
+                        tile[1] = (GLubyte)tileY;
+                        tile[2] = (GLubyte)slice;
+                        tile[3] = 0;
+
+                        visibleTilesCount++;
+                    }
+                }
+            }
+        }
+
+        return visibleTilesCount;
+    }
+}
@@ -0,0 +1,126 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BRICK_GRID_H
+#define BRICK_GRID_H
+
+#include <GLES3/gl3.h>
+#include <vector>
+
+namespace MaliSDK
+{
+    /**
+     * \brief Coarse grid of the maximum luminance of the bricks of the 3D texture, used to skip empty parts of the slices.
+     *
+     * The texture is divided into bricks of brickWidth x brickHeight x brickDepth texels. The maximum of every brick
+     * is kept per layer, as the layers are streamed in, and classify() turns the bricks into empty or non-empty flags
+     * for the current blending equation, stored as a summed volume table. Every frame, cullTiles() splits each slice
+     * into tiles, bounds the texels a tile samples with the same rotation as the vertex shader, and keeps only the
+     * tiles that touch a non-empty brick.
+     *
+     * Only the maximum is needed: the shader decodes the texels to non-negative values, and a texel below the visible
+     * limit changes neither min nor max blending. Both equations are order independent, so bricks are never occluded.
+     */
+    class BrickGrid
+    {
+    private:
+        int width;
+        int height;
+        int depth;
+        int brickWidth;
+        int brickHeight;
+        int brickDepth;
+        int bricksX;
+        int bricksY;
+        int bricksZ;
+
+        /* Maximum decoded value of every layer of every brick column, indexed [layer][brickY][brickX]. */
+        std::vector<unsigned short> layerMaxima;
+
+        /* Number of non-empty bricks in the box from brick 0 to the brick before, with one padding entry per axis. */
+        std::vector<int> nonEmptySums;
+
+        /* Arguments of the last classify(), to only rebuild the table when they change. */
+        int classifiedFirstHiddenLayer;
+        int classifiedEndHiddenLayer;
+        int classifiedVisibleLimit;
+
+        int sumIndex(int x, int y, int z) const;
+
+        /**
+         * \brief Count the non-empty bricks in an inclusive box of bricks.
+         */
+        int countNonEmpty(int x0, int y0, int z0, int x1, int y1, int z1) const;
+
+    public:
+        /**
+         * \brief Create a grid with every brick empty.
+         *
+         * \param width       Width of the texture in texels.
+         * \param height      Height of the texture in texels.
+         * \param depth       Number of layers of the texture.
+         * \param brickWidth  Width of a brick in texels.
+         * \param brickHeight Height of a brick in texels.
+         * \param brickDepth  Number of layers of a brick.
+         */
+        BrickGrid(int width, int height, int depth, int brickWidth, int brickHeight, int brickDepth);
+
+        /**
+         * \brief Record the maxima of a texture layer.
+         *
+         * Different layers can be set from different threads at the same time.
+         *
+         * \param layer Index of the layer.
+         * \param data  width x height big endian shorts, as uploaded to the texture.
+         */
+        void setLayer(int layer, const GLshort *data);
+
+        /**
+         * \brief Record the maxima of a texture layer filled with a single value.
+         *
+         * \param layer Index of the layer.
+         * \param value Big endian short the whole layer holds.
+         */
+        void setUniformLayer(int layer, GLshort value);
+
+        /**
+         * \brief Decide which bricks are empty.
+         *
+         * \param firstHiddenLayer First layer discarded by the shader regardless of its texels.
+         * \param endHiddenLayer   Layer after the last one discarded by the shader.
+         * \param visibleLimit     Lowest decoded value that is visible with the current blending equation.
+         */
+        void classify(int firstHiddenLayer, int endHiddenLayer, int visibleLimit);
+
+        /**
+         * \brief Find the tiles of the slices that sample a non-empty brick.
+         *
+         * \param rotationVector Rotation of the texture coordinates in degrees, as passed to the vertex shader.
+         * \param slicesCount    Number of slices drawn.
+         * \param tilesPerSide   Number of tiles along each side of a slice.
+         * \param tiles          Receives 4 bytes for every visible tile: tile X, tile Y, slice and 0.
+         *                       Must have room for slicesCount x tilesPerSide x tilesPerSide tiles.
+         *
+         * \return Number of visible tiles.
+         */
+        int cullTiles(const float rotationVector[3], int slicesCount, int tilesPerSide, GLubyte *tiles) const;
+    };
+}
+#endif /* BRICK_GRID_H */
@@ -36,6 +36,15 @@
  *
  * To use your own input images, it is check their format and adjust values of min blending threshold,
  * luminance of additional edge layers and contrast modifier.
+ *
+ * The images are not read before the first frame. A VolumeTextureLoader reads them on a worker thread into a ring of
+ * pixel unpack buffers and copies them to the 3D texture a few at a time, so the head builds up from the front while
+ * the sample is already rendering. The fragment shader discards the layers which have not been copied yet.
+ *
+ * While the images are read, a BrickGrid records the maximum of every 16 x 16 x 8 brick of the texture. Each slice is
+ * split into tiles, and every frame only the tiles whose rotated texture coordinates reach a brick bright enough to be
+ * seen with the current blending equation are drawn. The other tiles would only be discarded or leave the framebuffer
+ * unchanged, so skipping them saves fill rate in proportion to the empty space of the dataset.
  */
 
 #include <jni.h>
@@ -46,13 +55,16 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "BrickGrid.h"
 #include "Common.h"
 #include "Matrix.h"
 #include "Native.h"
 #include "Texture.h"
 #include "Timer.h"
 #include "Shader.h"
+#include "VolumeTextureLoader.h"
 
 using namespace std;
 using namespace MaliSDK;
@@ -82,6 +94,26 @@ const GLint textureDepth  = 128;
 const GLfloat minBlendingThreshold = 0.37f;
 /* Color value of a 3D texture layer. */
 const short fillerLuminance = 4;
+/* Size in bytes of a single image: 256 x 256 big endian shorts. */
+const size_t imageSize = textureWidth * textureHeight * sizeof(short);
+
+/* Streams the images into the 3D texture while the sample is running. */
+VolumeTextureLoader volumeLoader;
+
+/* Maxima of 16 x 16 x 8 texel bricks of the 3D texture. */
+BrickGrid brickGrid(textureWidth, textureHeight, textureDepth, 16, 16, 8);
+/* Number of tiles along each side of a slice. */
+const int tilesPerSide = 8;
+
+/* Lowest decoded texel value visible with max blending: brighter than half a step of an 8-bit framebuffer
+ * once scaled by the contrast modifier of the fragment shader (3.0 / 32768). */
+const int maxBlendingVisibleLimit = 21;
+/* Lowest decoded texel value not discarded by min blending: length(vec4(c, c, c, a)) reaches minBlendingThreshold,
+ * where a = 256.0 / 32768.0 * 3.0 is the decoded alpha. Rounded down, so no fragment drawn before is skipped. */
+const int minBlendingVisibleLimit = 2328;
+
+/* Tiles drawn in the current frame, 4 bytes each. */
+std::vector<GLubyte> visibleTiles(textureDepth * tilesPerSide * tilesPerSide * 4);
 
 /* ID of a 3D texture rendered on the screen. Filled by OpenGL ES. */
 GLuint textureID = 0;
@@ -94,12 +126,20 @@ GLuint verticesBufferID = 0;
 /* ID of a buffer object storing U/V/W texture coordinates. */
 GLuint uvwBufferID = 0;
 
+/* ID of a buffer object storing the tiles drawn in the current frame, one per instance. */
+GLuint tilesBufferID = 0;
+
 /* ID of a vertex array object. */
 GLuint vaoID = 0;
 
 /* Locations of changable uniforms. */
-GLint isMinBlendingLocation  = -1;
-GLint rotationVectorLocation = -1;
+GLint isMinBlendingLocation      = -1;
+GLint rotationVectorLocation     = -1;
+GLint firstUnloadedLayerLocation = -1;
+
+/* Layers of the 3D texture between frontLayersCount and backLayersStart hold the images. */
+GLint frontLayersCount = 0;
+GLint backLayersStart  = 0;
 
 /* Since there are additional layers in the front and in the back of original texture images, there
  * are two different functions used to load them. That is why we need this variable to indicate which
@@ -185,9 +225,11 @@ void initializeAttribArrays()
     /* Location of input variables in vertex shader. */
     GLint positionLocation            = GL_CHECK(glGetAttribLocation(programID, "inputPosition"));
     GLint inputUVWCoordinatesLocation = GL_CHECK(glGetAttribLocation(programID, "inputUVWCoordinates"));
+    GLint inputTileLocation           = GL_CHECK(glGetAttribLocation(programID, "inputTile"));
 
     ASSERT(positionLocation            != -1, "Could not find attribute location for: inputPosition");
     ASSERT(inputUVWCoordinatesLocation != -1, "Could not find attribute location for: inputUVWCoordinates");
+    ASSERT(inputTileLocation           != -1, "Could not find attribute location for: inputTile");
 
     /* Generate and bind a vertex array object. */
     GL_CHECK(glGenVertexArrays(1, &vaoID));
@@ -214,6 +256,16 @@ void initializeAttribArrays()
     /* Set vertex attribute pointer at the beginning of the buffer. */
     GL_CHECK(glVertexAttribPointer(inputUVWCoordinatesLocation, 3, GL_FLOAT, GL_FALSE, 0, 0));
     GL_CHECK(glEnableVertexAttribArray(inputUVWCoordinatesLocation));
+
+    /* Generate and bind a buffer object storing the visible tiles. It is refilled every frame. */
+    GL_CHECK(glGenBuffers(1, &tilesBufferID));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, tilesBufferID));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, visibleTiles.size(), NULL, GL_STREAM_DRAW));
+
+    /* Every instance draws one tile. */
+    GL_CHECK(glVertexAttribIPointer(inputTileLocation, 4, GL_UNSIGNED_BYTE, 0, 0));
+    GL_CHECK(glVertexAttribDivisor(inputTileLocation, 1));
+    GL_CHECK(glEnableVertexAttribArray(inputTileLocation));
 }
 
 /* Please look into header for the specification. */
@@ -250,9 +302,11 @@ void initializeProgram()
 void initializeTextureData()
 {
     /* Number of layers added at the front of a 3D texture. */
-    const int frontLayersCount = (textureDepth - imagesCount) / 2;
+    frontLayersCount = (textureDepth - imagesCount) / 2;
+    /* First layer added at the back of a 3D texture. */
+    backLayersStart = frontLayersCount + imagesCount;
     /* Number of layers added at the back of a 3D texture. */
-    const int backLayersCount = textureDepth - frontLayersCount - imagesCount;
+    const int backLayersCount = textureDepth - backLayersStart;
 
     /* Check if both numbers of additional layers are not negative. */
     ASSERT(frontLayersCount >= 0 && backLayersCount >= 0,
@@ -260,8 +314,9 @@ void initializeTextureData()
 
     /* Load front layers. */
     loadUniformTextures(frontLayersCount);
-    /* Load imagesCount images. */
-    loadImages();
+    /* Start streaming imagesCount images, the layers they are going to fill are skipped. */
+    startLoadingImages();
+    textureZOffset += imagesCount;
     /* Load back layers. */
     loadUniformTextures(backLayersCount);
 
@@ -281,10 +336,13 @@ void initializeUniformData()
     /* [Get 3D sampler uniform location] */
     GLint instancesCountLocation       = GL_CHECK(glGetUniformLocation(programID, "instancesCount"));
     GLint minBlendingThresholdLocation = GL_CHECK(glGetUniformLocation(programID, "minBlendingThreshold"));
+    GLint backLayersStartLocation      = GL_CHECK(glGetUniformLocation(programID, "backLayersStart"));
+    GLint tilesPerSideLocation         = GL_CHECK(glGetUniformLocation(programID, "tilesPerSide"));
 
     /* Locations in shaders of uniform variables whose values are going to be modified. */
     isMinBlendingLocation  = GL_CHECK(glGetUniformLocation(programID, "isMinBlending"));
     rotationVectorLocation = GL_CHECK(glGetUniformLocation(programID, "rotationVector"));
+    firstUnloadedLayerLocation = GL_CHECK(glGetUniformLocation(programID, "firstUnloadedLayer"));
 
     ASSERT(cameraMatrixLocation         != -1, "Could not find location for uniform: cameraMatrix");
     ASSERT(projectionMatrixLocation     != -1, "Could not find location for uniform: projectionMatrix");
@@ -295,6 +353,9 @@ void initializeUniformData()
     ASSERT(minBlendingThresholdLocation != -1, "Could not find location for uniform: minBlendingThreshold");
     ASSERT(isMinBlendingLocation        != -1, "Could not find location for uniform: isMinBlending");
     ASSERT(rotationVectorLocation       != -1, "Could not find location for uniform: rotationVector");
+    ASSERT(backLayersStartLocation      != -1, "Could not find location for uniform: backLayersStart");
+    ASSERT(tilesPerSideLocation         != -1, "Could not find location for uniform: tilesPerSide");
+    ASSERT(firstUnloadedLayerLocation   != -1, "Could not find location for uniform: firstUnloadedLayer");
 
     /* Value of translation of camera in Z axis. */
     const float cameraTranslation = -2.0f;
@@ -327,56 +388,82 @@ void initializeUniformData()
 
     /* Pass the value of threshold used for min blending. */
     GL_CHECK(glUniform1f(minBlendingThresholdLocation, minBlendingThreshold));
+
+    /* Pass the first layer behind the images. Layers from firstUnloadedLayer up to it are not drawn. */
+    GL_CHECK(glUniform1i(backLayersStartLocation, backLayersStart));
+
+    /* Pass the number of tiles along each side of a slice. */
+    GL_CHECK(glUniform1i(tilesPerSideLocation, tilesPerSide));
+}
+
+/* Please look into header for the specification. */
+void recordImageMaxima(int fileIndex, const void* data, void* userData)
+{
+    brickGrid.setLayer(frontLayersCount + fileIndex, (const GLshort*) data);
 }
 
 /* Please look into header for the specification. */
-void loadImages()
+void startLoadingImages()
 {
+    std::vector<string> filePaths;
+
     /* Indices of images start with 1. */
     for (int currentImageIndex = 1; currentImageIndex <= imagesCount; ++currentImageIndex)
     {
-        GLvoid* textureData = 0;
-        /* Maximum number of digits representing extensions. */
-        const int digitsCount = 3;
-
         /* Convert index of the current image, to a string. */
         std::stringstream stringStream;
         stringStream << currentImageIndex;
         string numericExtension = stringStream.str();
 
         /* Path to the image. */
-        const string filePath = resourceDirectory + imagesFilename + "." + numericExtension;
+        filePaths.push_back(resourceDirectory + imagesFilename + "." + numericExtension);
+    }
+
+    /* Every file holds one raw layer of the texture. */
+    VolumeTextureLoader::VolumeLayout layout;
 
-        /* Load data from a file. */
-        Texture::loadData(filePath.c_str(), (unsigned char**) &textureData);
+    layout.target         = GL_TEXTURE_3D;
+    layout.internalFormat = GL_R16I;
+    layout.format         = GL_RED_INTEGER;
+    layout.type           = GL_SHORT;
+    layout.width          = textureWidth;
+    layout.height         = textureHeight;
+    layout.layersPerFile  = 1;
+    layout.bytesPerFile   = imageSize;
 
-        /* Push loaded data to the next layer of a 3D texture that has not been filled yet. */
-        setNextTextureImage(textureData);
+    /* Record the maxima of every image on the worker thread, as it is read. */
+    volumeLoader.setFileCallback(recordImageMaxima, NULL);
 
-        /* Free allocated memory space. */
-        free(textureData);
+    if (!volumeLoader.start(textureID, layout, frontLayersCount, filePaths))
+    {
+        LOGE("Could not start loading the images.");
+        exit(1);
     }
 }
 
 /* Please look into header for the specification. */
 void loadUniformTextures(int count)
 {
-    GLvoid* textureData = 0;
+    if (count == 0)
+    {
+        return;
+    }
 
-    /* Create texture with short data type. */
-    Texture::createTexture(textureWidth,
-                           textureHeight,
-                           fillerLuminance,
-                           (short**) &textureData);
+    /* The texels are uploaded as raw shorts, so the integer clear value has the same bits as the filler. */
+    const GLint fillerValue[] = {fillerLuminance, 0, 0, 0};
+
+    /* [Fill uniform texture layers] */
+    /* Clear the layers on the GPU instead of uploading count copies of a filler image. */
+    Texture::fillTexture(GL_TEXTURE_3D, textureID, 0, textureZOffset, count, fillerValue);
+    /* [Fill uniform texture layers] */
 
-    /* Load created texture count times. */
     for (int i = 0; i < count; ++i)
     {
-        setNextTextureImage(textureData);
-    }
+        /* The edge layers count as bricks too, they are visible with max blending. */
+        brickGrid.setUniformLayer(textureZOffset, fillerLuminance);
 
-    /* Free allocated memory space. */
-    delete [] (unsigned char *)textureData;
+        textureZOffset++;
+    }
 }
 
 /**
@@ -407,15 +494,37 @@ void renderFrame()
     /* Vector storing rotation angles that is going to be passed to shader. */
     float rotationVector[] = {angleX, angleY, angleZ};
 
+    /* Copy the images read since the last frame to the texture, and hide the layers still missing. */
+    GLint firstUnloadedLayer = backLayersStart;
+
+    if (!volumeLoader.update())
+    {
+        firstUnloadedLayer = frontLayersCount + volumeLoader.getLoadedLayers();
+    }
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_3D, textureID));
+    GL_CHECK(glUniform1i(firstUnloadedLayerLocation, firstUnloadedLayer));
+
     /* Clear the screen. */
     GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
     /* Pass the rotation vector to shader. */
     GL_CHECK(glUniform3fv(rotationVectorLocation, 1, rotationVector));
 
+    /* Find the tiles of the slices which reach a visible brick, and upload them to the instance buffer. */
+    brickGrid.classify(firstUnloadedLayer,
+                       backLayersStart,
+                       isMinBlending ? minBlendingVisibleLimit : maxBlendingVisibleLimit);
+
+    int visibleTilesCount = brickGrid.cullTiles(rotationVector, textureDepth, tilesPerSide, &visibleTiles[0]);
+
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, tilesBufferID));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, visibleTiles.size(), NULL, GL_STREAM_DRAW));
+    GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, 0, visibleTilesCount * 4, &visibleTiles[0]));
+
     /* [Draw 3D texture] */
-    /* Draw a single square layer consisting of 6 vertices for textureDepth times. */
-    GL_CHECK(glDrawArraysInstanced(GL_TRIANGLES, 0, 6, textureDepth));
+    /* Draw a single tile consisting of 6 vertices for each visible tile of the textureDepth slices. */
+    GL_CHECK(glDrawArraysInstanced(GL_TRIANGLES, 0, 6, visibleTilesCount));
     /* [Draw 3D texture] */
 
     /* Increment rotation angles.*/
@@ -455,28 +564,6 @@ void setBlendEquation(GLboolean isMinBlending)
     GL_CHECK(glUniform1i(isMinBlendingLocation, isMinBlending));
 }
 
-/* Please look into header for the specification. */
-void setNextTextureImage(GLvoid* textureData)
-{
-    /* [Fill texture layer with data] */
-    /* Set 2D image at the current textureZOffset. */
-    GL_CHECK(glTexSubImage3D(GL_TEXTURE_3D,
-                             0,
-                             0,
-                             0,
-                             textureZOffset,
-                             textureWidth,
-                             textureHeight,
-                             1,
-                             GL_RED_INTEGER,
-                             GL_SHORT,
-                             textureData));
-    /* [Fill texture layer with data] */
-
-    /* Increment textureZOffset. */
-    textureZOffset++;
-}
-
 /**
  * \brief Initializes OpenGL ES context.
  *
@@ -517,9 +604,13 @@ void setupGraphics(int width, int height)
  */
 void uninit()
 {
+    /* Stop streaming before the texture goes away. */
+    volumeLoader.stop();
+
     GL_CHECK(glDeleteTextures    (1, &textureID       ));
     GL_CHECK(glDeleteBuffers     (1, &verticesBufferID));
     GL_CHECK(glDeleteBuffers     (1, &uvwBufferID     ));
+    GL_CHECK(glDeleteBuffers     (1, &tilesBufferID   ));
     GL_CHECK(glDeleteVertexArrays(1, &vaoID           ));
     GL_CHECK(glDeleteProgram     (programID           ));
 }
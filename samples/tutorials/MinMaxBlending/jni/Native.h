@@ -49,12 +49,23 @@
     void initializeUniformData();
 
     /**
-     * \brief Loads imagesCount images located in resourceDirectory.
+     * \brief Records the brick maxima of an image. Called on the loader worker thread.
+     *
+     * \param fileIndex Index of the image, from 0.
+     * \param data      Data of the image.
+     * \param userData  Unused.
+     */
+    void recordImageMaxima(int fileIndex, const void* data, void* userData);
+
+    /**
+     * \brief Starts streaming imagesCount images located in resourceDirectory to the 3D texture.
+     *
+     * The images are read on a worker thread and copied to the texture by renderFrame().
      */
-    void loadImages();
+    void startLoadingImages();
 
     /**
-     * \brief Creates and loads count unicolor layers to a 3D texture.
+     * \brief Fills the next count layers of the 3D texture with the filler value, clearing them on the GPU.
      *
      * \param count Number of layers to be filled.
      */
@@ -66,14 +77,4 @@
      * \param isMinBlending True, if GL_MIN blending mode should be used.
      */
     void setBlendEquation(GLboolean isMinBlending);
-
-    /**
-     * \brief Fills next empty 3D texture layer with textureData.
-     *
-     * It is called by the functions which prepare texture data either
-     * by creating it inside the application or loading it from from a file.
-     *
-     * \param textureData Data the 3D texture is filled with.
-     */
-    void setNextTextureImage(GLvoid* textureData);
 #endif /* MIN_MAX_BLENDING_H */
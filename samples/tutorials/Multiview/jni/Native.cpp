@@ -29,6 +29,7 @@
 #include <math.h>
 #include <cstring>
 
+#include "DynamicResolution.h"
 #include "Matrix.h"
 
 #define LOG_TAG "libNative"
@@ -49,17 +50,32 @@ using namespace MaliSDK;
 
 GLuint fboWidth = 1280;
 GLuint fboHeight = 720;
+
+/* GPU time the frame is kept around by scaling the multiview render, in milliseconds. Leaves headroom for 60 FPS. */
+const float targetFrameTime = 12.0f;
+DynamicResolution* dynamicResolution = NULL;
 GLuint screenWidth;
 GLuint screenHeight;
 GLuint frameBufferTextureId;
 GLuint frameBufferDepthTextureId;
 GLuint frameBufferObjectId;
 
+/*
+ * Set when GL_OVR_multiview is missing. The 4 views are then drawn side by side in one layer, by instanced draws
+ * selecting the view from gl_InstanceID, so each object still takes a single draw call.
+ */
+bool instancedStereo = false;
+GLint maxTextureSize = 0;
+
 GLuint multiviewProgram;
 GLuint multiviewVertexLocation;
 GLuint multiviewVertexNormalLocation;
 GLuint multiviewModelViewProjectionLocation;
 GLuint multiviewModelLocation;
+GLint multiviewViewWidthScaleLocation;
+
+GLuint maskProgram;
+GLint maskViewWidthScaleLocation;
 
 GLuint texturedQuadProgram;
 GLuint texturedQuadVertexLocation;
@@ -67,6 +83,8 @@ GLuint texturedQuadLowResTexCoordLocation;
 GLuint texturedQuadHighResTexCoordLocation;
 GLuint texturedQuadSamplerLocation;
 GLuint texturedQuadLayerIndexLocation;
+GLuint texturedQuadTexCoordScaleLocation;
+GLuint texturedQuadViewsAcrossLocation;
 
 Matrix projectionMatrix[4];
 Matrix viewMatrix[4];
@@ -97,31 +115,191 @@ static const char multiviewVertexShader[] =
     "    v_normal = (model * vec4(vertexNormal, 0.0f)).xyz;\n"
     "}\n";
 
+/* Lighting shared by the multiview and instanced fragmentShaders. */
+#define LIGHTING_FRAGMENT_SHADER                                                             \
+    "in vec3 v_normal;\n"                                                                    \
+    "out vec4 f_color;\n"                                                                    \
+                                                                                             \
+    "vec3 light(vec3 n, vec3 l, vec3 c)\n"                                                   \
+    "{\n"                                                                                    \
+    "    float ndotl = max(dot(n, l), 0.0);\n"                                               \
+    "    return ndotl * c;\n"                                                                \
+    "}\n"                                                                                    \
+                                                                                             \
+    "void shade()\n"                                                                         \
+    "{\n"                                                                                    \
+    "    vec3 albedo = vec3(0.95, 0.84, 0.62);\n"                                            \
+    "    vec3 n = normalize(v_normal);\n"                                                    \
+    "    f_color.rgb = vec3(0.0);\n"                                                         \
+    "    f_color.rgb += light(n, normalize(vec3(1.0)), vec3(1.0));\n"                        \
+    "    f_color.rgb += light(n, normalize(vec3(-1.0, -1.0, 0.0)), vec3(0.2, 0.23, 0.35));\n" \
+                                                                                             \
+    "    f_color.a = 1.0;\n"                                                                 \
+    "}\n"
+
 /* Multiview fragmentShader */
 static const char multiviewFragmentShader[] =
     "#version 300 es\n"
     "precision highp float;\n"
 
-    "in vec3 v_normal;\n"
-    "out vec4 f_color;\n"
+    LIGHTING_FRAGMENT_SHADER
 
-    "vec3 light(vec3 n, vec3 l, vec3 c)\n"
+    "void main()\n"
     "{\n"
-    "    float ndotl = max(dot(n, l), 0.0);\n"
-    "    return ndotl * c;\n"
+    "    shade();\n"
+    "}\n";
+
+/*
+ * Moves a clip space position of a view into its column of the instanced stereo framebuffer. Views are
+ * viewWidthScale * 1/4 of the viewport wide, as the rendered area scales with the dynamic resolution, and start
+ * every quarter of the viewport. Without viewports or clip planes in OpenGL ES 3.0, the sides of the view are
+ * clipped in the fragmentShader, from distances to the planes that interpolate like the clip space position.
+ */
+#define VIEW_ATLAS_VERTEX_SHADER                                                                              \
+    "uniform float viewWidthScale;\n"                                                                         \
+    "out vec2 v_viewClip;\n"                                                                                  \
+                                                                                                              \
+    "vec4 toViewAtlas(vec4 position, int view)\n"                                                             \
+    "{\n"                                                                                                     \
+    "    v_viewClip = vec2(position.w + position.x, position.w - position.x);\n"                              \
+    "    float scale = 0.25 * viewWidthScale;\n"                                                              \
+    "    position.x = position.x * scale + position.w * (float(view) * 0.5 - 1.0 + scale);\n"                 \
+    "    return position;\n"                                                                                  \
     "}\n"
 
+#define VIEW_ATLAS_FRAGMENT_SHADER                        \
+    "in vec2 v_viewClip;\n"                               \
+                                                          \
+    "void clipView()\n"                                   \
+    "{\n"                                                 \
+    "    if (any(lessThan(v_viewClip, vec2(0.0))))\n"     \
+    "    {\n"                                             \
+    "        discard;\n"                                  \
+    "    }\n"                                             \
+    "}\n"
+
+/* Instanced stereo vertexShader, drawing an instance per view. */
+static const char instancedVertexShader[] =
+    "#version 300 es\n"
+
+    "in vec3 vertexPosition;\n"
+    "in vec3 vertexNormal;\n"
+    "uniform mat4 modelViewProjection[4];\n"
+    "uniform mat4 model;\n"
+    "out vec3 v_normal;\n"
+
+    VIEW_ATLAS_VERTEX_SHADER
+
+    "void main()\n"
+    "{\n"
+    "    gl_Position = toViewAtlas(modelViewProjection[gl_InstanceID] * vec4(vertexPosition, 1.0), gl_InstanceID);\n"
+    "    v_normal = (model * vec4(vertexNormal, 0.0f)).xyz;\n"
+    "}\n";
+
+/* Instanced stereo fragmentShader */
+static const char instancedFragmentShader[] =
+    "#version 300 es\n"
+    "precision highp float;\n"
+
+    LIGHTING_FRAGMENT_SHADER
+    VIEW_ATLAS_FRAGMENT_SHADER
+
+    "void main()\n"
+    "{\n"
+    "    clipView();\n"
+    "    shade();\n"
+    "}\n";
+
+/* Number of quads in the ring drawn by the mask vertexShaders, passed to them as a #define. */
+#define MASK_SEGMENTS 32
+#define MASK_SEGMENTS_DEFINE_STRING(segments) "#define MASK_SEGMENTS " #segments "\n"
+#define MASK_SEGMENTS_DEFINE(segments) MASK_SEGMENTS_DEFINE_STRING(segments)
+
+/*
+ * Mask vertexShader. Draws a ring of MASK_SEGMENTS quads without any vertex attributes,
+ * in front of everything, so the parts of each layer that never show on screen are not shaded:
+ * - in the wide field of view layers, the centre where only the high res layers are used,
+ * - in the narrow field of view layers, the corners outside the circle used for interpolation.
+ * Radii are in normalized device coordinates, and leave a margin around the interpolation circles.
+ */
+static const char maskVertexShader[] =
+    "#version 300 es\n"
+    "#extension GL_OVR_multiview : enable\n"
+
+    "layout(num_views = 4) in;\n"
+
+    MASK_SEGMENTS_DEFINE(MASK_SEGMENTS)
+
     "void main()\n"
     "{\n"
-    "    vec3 albedo = vec3(0.95, 0.84, 0.62);\n"
-    "    vec3 n = normalize(v_normal);\n"
-    "    f_color.rgb = vec3(0.0);\n"
-    "    f_color.rgb += light(n, normalize(vec3(1.0)), vec3(1.0));\n"
-    "    f_color.rgb += light(n, normalize(vec3(-1.0, -1.0, 0.0)), vec3(0.2, 0.23, 0.35));\n"
+    "    float angle = float(gl_VertexID / 2) * (6.2831853 / float(MASK_SEGMENTS));\n"
+    "    bool outer = (gl_VertexID % 2) == 1;\n"
+    "    float radius;\n"
+    "    if (gl_ViewID_OVR < 2u)\n"
+    "    {\n"
+    "        radius = outer ? 0.18 : 0.0;\n"
+    "    }\n"
+    "    else\n"
+    "    {\n"
+    "        radius = outer ? 2.0 : 1.1;\n"
+    "    }\n"
+    "    gl_Position = vec4(cos(angle) * radius, sin(angle) * radius, -1.0, 1.0);\n"
+    "}\n";
+
+/* Mask fragmentShader */
+static const char maskFragmentShader[] =
+    "#version 300 es\n"
+    "precision mediump float;\n"
 
-    "    f_color.a = 1.0;\n"
+    "out vec4 f_color;\n"
+
+    "void main()\n"
+    "{\n"
+    "    f_color = vec4(0.0);\n"
     "}\n";
 
+/* Instanced stereo mask vertexShader, the same ring drawn in the column of each view. */
+static const char instancedMaskVertexShader[] =
+    "#version 300 es\n"
+
+    MASK_SEGMENTS_DEFINE(MASK_SEGMENTS)
+
+    VIEW_ATLAS_VERTEX_SHADER
+
+    "void main()\n"
+    "{\n"
+    "    float angle = float(gl_VertexID / 2) * (6.2831853 / float(MASK_SEGMENTS));\n"
+    "    bool outer = (gl_VertexID % 2) == 1;\n"
+    "    float radius;\n"
+    "    if (gl_InstanceID < 2)\n"
+    "    {\n"
+    "        radius = outer ? 0.18 : 0.0;\n"
+    "    }\n"
+    "    else\n"
+    "    {\n"
+    "        radius = outer ? 2.0 : 1.1;\n"
+    "    }\n"
+    "    gl_Position = toViewAtlas(vec4(cos(angle) * radius, sin(angle) * radius, -1.0, 1.0), gl_InstanceID);\n"
+    "}\n";
+
+/* Instanced stereo mask fragmentShader */
+static const char instancedMaskFragmentShader[] =
+    "#version 300 es\n"
+    "precision mediump float;\n"
+
+    "out vec4 f_color;\n"
+
+    VIEW_ATLAS_FRAGMENT_SHADER
+
+    "void main()\n"
+    "{\n"
+    "    clipView();\n"
+    "    f_color = vec4(0.0);\n"
+    "}\n";
+
+/* Number of vertices of the triangle strip drawn by the mask vertexShader, closing the ring. */
+const GLsizei maskVertexCount = 2 * (MASK_SEGMENTS + 1);
+
 /* Textured quad vertexShader */
 static const char  texturedQuadVertexShader[] =
     "#version 300 es\n"
@@ -148,10 +326,28 @@ static const char texturedQuadFragmentShader[] =
     "out vec4 fragColor;\n"
     "uniform sampler2DArray tex;\n"
     "uniform int layerIndex;\n"
+    "// Only this corner of the layers has been rendered to, see DynamicResolution.\n"
+    "uniform vec2 texCoordScale;\n"
+    "// 1 when the views are layers, 4 when they are side by side in the first layer, see instancedStereo.\n"
+    "uniform int viewsAcross;\n"
+    "vec4 sampleView(vec2 texCoord, int view)\n"
+    "{\n"
+    "    if (viewsAcross == 1)\n"
+    "    {\n"
+    "        return texture(tex, vec3(texCoord, view));\n"
+    "    }\n"
+    "    return texture(tex, vec3((texCoord.x + float(view)) / float(viewsAcross), texCoord.y, 0.0));\n"
+    "}\n"
     "void main()\n"
     "{\n"
-    "    vec4 lowResSample = texture(tex, vec3(vLowResTexCoord, layerIndex));\n"
-    "    vec4 highResSample = texture(tex, vec3(vHighResTexCoord, layerIndex + 2));\n"
+    "    // Clamp half a texel inside the rendered area so bilinear filtering never reads outside of it,\n"
+    "    // nor from the next view.\n"
+    "    vec2 halfTexel = 0.5 / (vec2(textureSize(tex, 0).xy) / vec2(viewsAcross, 1));\n"
+    "    vec2 maxTexCoord = texCoordScale - halfTexel;\n"
+    "    vec2 lowResTexCoord = clamp(vLowResTexCoord * texCoordScale, halfTexel, maxTexCoord);\n"
+    "    vec2 highResTexCoord = clamp(vHighResTexCoord * texCoordScale, halfTexel, maxTexCoord);\n"
+    "    vec4 lowResSample = sampleView(lowResTexCoord, layerIndex);\n"
+    "    vec4 highResSample = sampleView(highResTexCoord, layerIndex + 2);\n"
     "    // Using squared distance to middle of screen for interpolating.\n"
     "    vec2 distVec = vec2(0.5) - vHighResTexCoord;\n"
     "    float squaredDist = dot(distVec, distVec);\n"
@@ -385,8 +581,51 @@ GLuint createProgram(const char* vertexSource, const char * fragmentSource)
     return program;
 }
 
+/*
+ * Without multiview, the 4 views are laid side by side in a single layer 4 times as wide,
+ * rendered to with one ordinary framebuffer.
+ */
+bool setupInstancedStereoFBO(int width, int height)
+{
+    if (4 * width > maxTextureSize)
+    {
+        LOGE("Instanced stereo needs %d pixels wide textures, only %d are supported.\n", 4 * width, maxTextureSize);
+        return false;
+    }
+
+    /* Create a single layer array texture, so the same textured quad program samples it. */
+    GL_CHECK(glGenTextures(1, &frameBufferTextureId));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, frameBufferTextureId));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GL_CHECK(glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, 4 * width, height, 1));
+
+    GL_CHECK(glGenFramebuffers(1, &frameBufferObjectId));
+    GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, frameBufferObjectId));
+    GL_CHECK(glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, frameBufferTextureId, 0, 0));
+
+    GL_CHECK(glGenTextures(1, &frameBufferDepthTextureId));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, frameBufferDepthTextureId));
+    GL_CHECK(glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT24, 4 * width, height, 1));
+    GL_CHECK(glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, frameBufferDepthTextureId, 0, 0));
+
+    GLenum result = GL_CHECK(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER));
+    if (result != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOGE("Framebuffer incomplete at %s:%i\n", __FILE__, __LINE__);
+        GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
+        return false;
+    }
+    return true;
+}
+
 bool setupFBO(int width, int height)
 {
+    if (instancedStereo)
+    {
+        return setupInstancedStereoFBO(width, height);
+    }
+
     // Create array texture
     GL_CHECK(glGenTextures(1, &frameBufferTextureId));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, frameBufferTextureId));
@@ -428,14 +667,14 @@ bool setupFBO(int width, int height)
 bool setupGraphics(int width, int height)
 {
     /*
-     * Make sure the required multiview extension is present.
+     * Use the multiview extension when it is present, and fall back to instanced stereo otherwise.
      */
     const GLubyte* extensions = GL_CHECK(glGetString(GL_EXTENSIONS));
     const char *found_extension = strstr((const char*)extensions, "GL_OVR_multiview");
     if (NULL == found_extension)
     {
-        LOGI("OpenGL ES 3.0 implementation does not support GL_OVR_multiview extension.\n");
-        exit(EXIT_FAILURE);
+        LOGI("OpenGL ES 3.0 implementation does not support GL_OVR_multiview extension, using instanced stereo.\n");
+        instancedStereo = true;
     }
     else
     {
@@ -443,10 +682,11 @@ bool setupGraphics(int width, int height)
                         (PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVR)eglGetProcAddress ("glFramebufferTextureMultiviewOVR");
         if (!glFramebufferTextureMultiviewOVR)
         {
-            LOGI("Can not get proc address for glFramebufferTextureMultiviewOVR.\n");
-            exit(EXIT_FAILURE);
+            LOGI("Can not get proc address for glFramebufferTextureMultiviewOVR, using instanced stereo.\n");
+            instancedStereo = true;
         }
     }
+    GL_CHECK(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize));
 
     /* Enable culling and depth testing. */
     GL_CHECK(glDisable(GL_CULL_FACE));
@@ -463,6 +703,10 @@ bool setupGraphics(int width, int height)
         return false;
     }
 
+    /* The FBO stays at its full size, only the area rendered to changes. */
+    delete dynamicResolution;
+    dynamicResolution = new DynamicResolution(fboWidth, fboHeight, targetFrameTime);
+
     /* Creating program for drawing textured quad. */
     texturedQuadProgram = createProgram(texturedQuadVertexShader, texturedQuadFragmentShader);
     if (texturedQuadProgram == 0)
@@ -477,9 +721,35 @@ bool setupGraphics(int width, int height)
     texturedQuadHighResTexCoordLocation = GL_CHECK(glGetAttribLocation(texturedQuadProgram,  "attributeHighResTexCoord"));
     texturedQuadSamplerLocation         = GL_CHECK(glGetUniformLocation(texturedQuadProgram, "tex"));
     texturedQuadLayerIndexLocation      = GL_CHECK(glGetUniformLocation(texturedQuadProgram, "layerIndex"));
+    texturedQuadTexCoordScaleLocation   = GL_CHECK(glGetUniformLocation(texturedQuadProgram, "texCoordScale"));
+    texturedQuadViewsAcrossLocation     = GL_CHECK(glGetUniformLocation(texturedQuadProgram, "viewsAcross"));
+
+    /* Creating program for masking out the parts of the layers that are not used. */
+    /* The instanced stereo programs take the same attributes and uniforms, and place the views themselves. */
+    if (instancedStereo)
+    {
+        maskProgram = createProgram(instancedMaskVertexShader, instancedMaskFragmentShader);
+    }
+    else
+    {
+        maskProgram = createProgram(maskVertexShader, maskFragmentShader);
+    }
+    if (maskProgram == 0)
+    {
+        LOGE("Could not create mask program");
+        return false;
+    }
+    maskViewWidthScaleLocation = GL_CHECK(glGetUniformLocation(maskProgram, "viewWidthScale"));
 
     /* Creating program for drawing object with multiview. */
-    multiviewProgram = createProgram(multiviewVertexShader, multiviewFragmentShader);
+    if (instancedStereo)
+    {
+        multiviewProgram = createProgram(instancedVertexShader, instancedFragmentShader);
+    }
+    else
+    {
+        multiviewProgram = createProgram(multiviewVertexShader, multiviewFragmentShader);
+    }
     if (multiviewProgram == 0)
     {
         LOGE ("Could not create multiview program");
@@ -491,6 +761,7 @@ bool setupGraphics(int width, int height)
     multiviewVertexNormalLocation        = GL_CHECK(glGetAttribLocation(multiviewProgram,  "vertexNormal"));
     multiviewModelViewProjectionLocation = GL_CHECK(glGetUniformLocation(multiviewProgram, "modelViewProjection"));
     multiviewModelLocation               = GL_CHECK(glGetUniformLocation(multiviewProgram, "model"));
+    multiviewViewWidthScaleLocation      = GL_CHECK(glGetUniformLocation(multiviewProgram, "viewWidthScale"));
 
     /*
      * Set up the perspective matrices for each view. Rendering is done twice in each eye position with different
@@ -526,16 +797,60 @@ bool setupGraphics(int width, int height)
     return true;
 }
 
+/* Draws the views of an object, in one draw call either way. */
+void drawViews(GLenum mode, GLsizei count, const GLushort* indices)
+{
+    GLsizei instances = instancedStereo ? 4 : 1;
+    if (indices != NULL)
+    {
+        GL_CHECK(glDrawElementsInstanced(mode, count, GL_UNSIGNED_SHORT, indices, instances));
+    }
+    else
+    {
+        GL_CHECK(glDrawArraysInstanced(mode, 0, count, instances));
+    }
+}
+
 void renderToFBO(int width, int height)
 {
-    /* Rendering to FBO. */
-    GL_CHECK(glViewport(0, 0, width, height));
+    /*
+     * Rendering to FBO. With instanced stereo the viewport covers the 4 views, each drawn in the corner of its
+     * quarter scaled by width / fboWidth. The uniform is not in the multiview programs, and ignored there.
+     */
+    float viewWidthScale = (float)width / (float)fboWidth;
+    if (instancedStereo)
+    {
+        GL_CHECK(glViewport(0, 0, 4 * fboWidth, height));
+    }
+    else
+    {
+        GL_CHECK(glViewport(0, 0, width, height));
+    }
 
     /* Bind our framebuffer for rendering. */
     GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, frameBufferObjectId));
 
     GL_CHECK(glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
 
+    /*
+     * Fill the depth buffer in the parts of the layers that are not used when interpolating,
+     * so the cubes are only shaded where each layer is visible. This keeps the fill-rate savings
+     * of foveated rendering while all four views are still rendered in a single pass.
+     */
+    GL_CHECK(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+    GL_CHECK(glUseProgram(maskProgram));
+
+    /* The mask has no attributes, and the client side arrays of the other programs are shorter than the mask. */
+    GL_CHECK(glDisableVertexAttribArray(texturedQuadVertexLocation));
+    GL_CHECK(glDisableVertexAttribArray(texturedQuadLowResTexCoordLocation));
+    GL_CHECK(glDisableVertexAttribArray(texturedQuadHighResTexCoordLocation));
+    GL_CHECK(glDisableVertexAttribArray(multiviewVertexLocation));
+    GL_CHECK(glDisableVertexAttribArray(multiviewVertexNormalLocation));
+
+    GL_CHECK(glUniform1f(maskViewWidthScaleLocation, viewWidthScale));
+    drawViews(GL_TRIANGLE_STRIP, maskVertexCount, NULL);
+    GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+
     /* Rotating the cube. */
     modelMatrix = Matrix::createRotationX(angle * 1.5f) * Matrix::createRotationY(angle);
     modelViewProjectionMatrix[0] = viewProjectionMatrix[0] * modelMatrix;
@@ -555,9 +870,10 @@ void renderToFBO(int width, int height)
 
     GL_CHECK(glUniformMatrix4fv(multiviewModelViewProjectionLocation, 4, GL_FALSE, modelViewProjectionMatrix[0].getAsArray()));
     GL_CHECK(glUniformMatrix4fv(multiviewModelLocation, 1, GL_FALSE, modelMatrix.getAsArray()));
+    GL_CHECK(glUniform1f(multiviewViewWidthScaleLocation, viewWidthScale));
 
     /* Draw a cube. */
-    GL_CHECK(glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, multiviewIndices));
+    drawViews(GL_TRIANGLES, 36, multiviewIndices);
 
     /* Draw a translated cube. */
     Matrix translatedModelMatrix = Matrix::createTranslation(-3.5, 0.0, 0.0) * modelMatrix;
@@ -567,7 +883,7 @@ void renderToFBO(int width, int height)
     modelViewProjectionMatrix[3] = viewProjectionMatrix[3] * translatedModelMatrix;
     GL_CHECK(glUniformMatrix4fv(multiviewModelViewProjectionLocation, 4, GL_FALSE, modelViewProjectionMatrix[0].getAsArray()));
     GL_CHECK(glUniformMatrix4fv(multiviewModelLocation, 1, GL_FALSE, translatedModelMatrix.getAsArray()));
-    GL_CHECK(glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, multiviewIndices));
+    drawViews(GL_TRIANGLES, 36, multiviewIndices);
 
     /* Draw another translated cube. */
     translatedModelMatrix = Matrix::createTranslation(3.5, 0.0, 0.0) * modelMatrix;
@@ -577,7 +893,7 @@ void renderToFBO(int width, int height)
     modelViewProjectionMatrix[3] = viewProjectionMatrix[3] * translatedModelMatrix;
     GL_CHECK(glUniformMatrix4fv(multiviewModelViewProjectionLocation, 4, GL_FALSE, modelViewProjectionMatrix[0].getAsArray()));
     GL_CHECK(glUniformMatrix4fv(multiviewModelLocation, 1, GL_FALSE, translatedModelMatrix.getAsArray()));
-    GL_CHECK(glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, multiviewIndices));
+    drawViews(GL_TRIANGLES, 36, multiviewIndices);
 
     angle += 1;
     if (angle > 360)
@@ -591,11 +907,14 @@ void renderToFBO(int width, int height)
 
 void renderFrame()
 {
+    dynamicResolution->beginFrame();
+
     /*
      * Render the scene to the multiview texture. This will render to 4 different layers of the texture,
-     * using different projection and view matrices for each layer.
+     * using different projection and view matrices for each layer. The rendered area is scaled down
+     * when the GPU time of the frames goes over target.
      */
-    renderToFBO(fboWidth, fboHeight);
+    renderToFBO(dynamicResolution->getWidth(), dynamicResolution->getHeight());
 
     GL_CHECK(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
     GL_CHECK(glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
@@ -633,10 +952,15 @@ void renderFrame()
          */
         GL_CHECK(glUniform1i(texturedQuadSamplerLocation, 0));
         GL_CHECK(glUniform1i(texturedQuadLayerIndexLocation, i));
+        GL_CHECK(glUniform2f(texturedQuadTexCoordScaleLocation,
+                             dynamicResolution->getTexCoordScaleX(), dynamicResolution->getTexCoordScaleY()));
+        GL_CHECK(glUniform1i(texturedQuadViewsAcrossLocation, instancedStereo ? 4 : 1));
 
-        /* Draw textured quad using the multiview texture. */
+        /* Draw textured quad using the multiview texture, which upscales the rendered area with bilinear filtering. */
         GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 6));
     }
+
+    dynamicResolution->endFrame();
 }
 
 extern "C"
@@ -27,9 +27,15 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <cstddef>
 
-#include "Matrix.h"
+#include "MatrixFunctions.h"
 #include "Texture.h"
+#include "TangentFrames.h"
+
+using namespace MaliSDK;
+
+#include <vector>
 
 #define LOG_TAG "libNative"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -39,19 +45,26 @@
 static const char glVertexShader[] =
         "attribute vec4 vertexPosition;\n"
         "attribute vec2 vertexTextureCord;\n"
-        "attribute vec3 vertexNormal;\n"
         "attribute vec3 vertexColor; \n"
-        "attribute vec3 vertexTangent;\n"
-        "attribute vec3 vertexBiNormal;\n"
+        "attribute vec4 vertexTangentFrame;\n"
         "varying vec2 textureCord;\n"
         "varying vec3 varyingColor; \n"
         "varying vec3 inverseLightDirection;\n"
         "varying vec3 inverseEyeDirection;\n"
         "uniform mat4 projection;\n"
         "uniform mat4 modelView;\n"
+        /* Rotate v by the quaternion q. */
+        "vec3 rotate(vec4 q, vec3 v)\n"
+        "{\n"
+        "   return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);\n"
+        "}\n"
         "void main()\n"
         "{\n"
         "   vec3 worldSpaceVertex =(modelView * vertexPosition).xyz;"
+        /* The tangent frame is a rotation from tangent space, the sign of w its handedness. */
+        "   vec3 vertexNormal = rotate(vertexTangentFrame, vec3(0.0, 0.0, 1.0));\n"
+        "   vec3 vertexTangent = rotate(vertexTangentFrame, vec3(1.0, 0.0, 0.0));\n"
+        "   vec3 vertexBiNormal = cross(vertexNormal, vertexTangent) * (vertexTangentFrame.w < 0.0 ? -1.0 : 1.0);\n"
         "   vec3 transformedVertexNormal = normalize((modelView *  vec4(vertexNormal, 0.0)).xyz);"
 
         "   inverseLightDirection = normalize(vec3(0.0, 0.0, 1.0));\n"
@@ -72,6 +85,9 @@ static const char glVertexShader[] =
 static const char glFragmentShader[] =
         "precision mediump float;\n"
         "uniform sampler2D texture;\n"
+        "uniform vec4 normalX;\n"
+        "uniform vec4 normalY;\n"
+        "uniform vec2 normalBias;\n"
         "varying vec2 textureCord;\n"
         "varying vec3 varyingColor;\n"
         "varying vec3 inverseLightDirection;\n"
@@ -80,8 +96,10 @@ static const char glFragmentShader[] =
         "void main()\n"
         "{\n"
         "   vec3 fragColor = vec3(0.0,0.0,0.0); \n"
-        "   vec3 normal = texture2D(texture, textureCord).xyz;"
-        "   normal = normalize(normal * 2.0 -1.0);"
+        /* Only X and Y are stored, Z is positive in tangent space. */
+        "   vec4 texel = texture2D(texture, textureCord);\n"
+        "   vec2 normalXY = vec2(dot(texel, normalX), dot(texel, normalY)) + normalBias;\n"
+        "   vec3 normal = vec3(normalXY, sqrt(max(0.0, 1.0 - dot(normalXY, normalXY))));\n"
         /* Calculate the diffuse component. */
         "   vec3 diffuseLightIntensity = vec3(1.0, 1.0, 1.0);\n"
         "   float normalDotLight = max(0.0, dot(normal, inverseLightDirection));\n"
@@ -198,14 +216,16 @@ GLuint modelViewLocation;
 GLuint textureCordLocation;
 GLuint colorLocation;
 GLuint textureId;
-GLuint vertexNormalLocation;
-GLuint tangentLocation;
-GLuint biNormalLocation;
+GLuint tangentFrameLocation;
+GLuint normalXLocation;
+GLuint normalYLocation;
+GLuint normalBiasLocation;
 /* [LocationVariables] */
 
 float projectionMatrix[16];
 float modelViewMatrix[16];
 float angle = 0;
+NormalMapChannels normalMapChannels;
 
 bool setupGraphics(int width, int height)
 {
@@ -223,10 +243,11 @@ bool setupGraphics(int width, int height)
     projectionLocation = glGetUniformLocation(glProgram, "projection");
     modelViewLocation = glGetUniformLocation(glProgram, "modelView");
     samplerLocation = glGetUniformLocation(glProgram, "texture");
-    vertexNormalLocation = glGetAttribLocation(glProgram, "vertexNormal");
     colorLocation = glGetAttribLocation(glProgram, "vertexColor");
-    tangentLocation = glGetAttribLocation(glProgram, "vertexTangent");
-    biNormalLocation = glGetAttribLocation(glProgram, "vertexBiNormal");
+    tangentFrameLocation = glGetAttribLocation(glProgram, "vertexTangentFrame");
+    normalXLocation = glGetUniformLocation(glProgram, "normalX");
+    normalYLocation = glGetUniformLocation(glProgram, "normalY");
+    normalBiasLocation = glGetUniformLocation(glProgram, "normalBias");
     /* [setLocation] */
 
     /* Setup the perspective. */
@@ -236,7 +257,7 @@ bool setupGraphics(int width, int height)
     glViewport(0, 0, width, height);
 
     /* Load the Texture. */
-    textureId = loadTexture();
+    textureId = loadTexture(&normalMapChannels);
     if(textureId == 0)
     {
         return false;
@@ -325,58 +346,6 @@ GLfloat colour[] =      {1.0f, 0.0f, 0.0f,
                         1.0f, 0.0f, 1.0f
 };
 
-GLfloat tangents[] =    {-1.0f, 0.0f, 0.0f,            /* Back */
-                        -1.0f, 0.0f, 0.0f,
-                        -1.0f, 0.0f, 0.0f,
-                        -1.0f, 0.0f, 0.0f,
-                        1.0f, 0.0f, 0.0f,                /* Front */
-                        1.0f, 0.0f, 0.0f,
-                        1.0f, 0.0f, 0.0f,
-                        1.0f, 0.0f, 0.0f,
-                        0.0f, 0.0f, 1.0f,                /* Left */
-                        0.0f, 0.0f, 1.0f,
-                        0.0f, 0.0f, 1.0f,
-                        0.0f, 0.0f, 1.0f,
-                        0.0f, 0.0f, -1.0f,                /* Right */
-                        0.0f, 0.0f, -1.0f,
-                        0.0f, 0.0f, -1.0f,
-                        0.0f, 0.0f, -1.0f,
-                        1.0f, 0.0f, 0.0f,                /* Top */
-                        1.0f, 0.0f, 0.0f,
-                        1.0f, 0.0f, 0.0f,
-                        1.0f, 0.0f, 0.0f,
-                        1.0f, 0.0f, 0.0f,                /* Bottom */
-                        1.0f, 0.0f, 0.0f,
-                        1.0f, 0.0f, 0.0f,
-                        1.0f, 0.0f, 0.0f
-};
-
-GLfloat biNormals[] = {    0.0f, 1.0f, 0.0f,                /* Back */
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,                /* Front */
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,                /* Left */
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,                 /* Right */
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f,
-                        0.0f, 0.0f, -1.0f,                /* Top */
-                        0.0f, 0.0f, -1.0f,
-                        0.0f, 0.0f, -1.0f,
-                        0.0f, 0.0f, -1.0f,
-                        0.0f, 0.0f, 1.0f,                /* Bottom */
-                        0.0f, 0.0f, 1.0f,
-                        0.0f, 0.0f, 1.0f,
-                        0.0f, 0.0f, 1.0f
-
-};
 GLfloat textureCords[] = {1.0f, 1.0f, /* Back. */
                         0.0f, 1.0f,
                         1.0f, 0.0f,
@@ -404,6 +373,63 @@ GLfloat textureCords[] = {1.0f, 1.0f, /* Back. */
 };
 
 GLushort indicies[] = {0, 3, 2, 0, 1, 3, 4, 6, 7, 4, 7, 5,  8, 9, 10, 8, 11, 10, 12, 13, 14, 15, 12, 14, 16, 17, 18, 16, 19, 18, 20, 21, 22, 20, 23, 22};
+
+/* The normal, tangent and bitangent of a vertex are packed in one quaternion. */
+struct Vertex
+{
+    GLfloat position[3];
+    GLfloat textureCord[2];
+    GLfloat colour[3];
+    GLshort tangentFrame[4];
+};
+
+std::vector<Vertex> vertices;
+std::vector<GLushort> indices;
+
+bool setupVertices()
+{
+    /* Positions, normals, texture coordinates and colours, the tangents are generated from them. */
+    MaliSDK::IndexedModel model;
+    model.floatsPerVertex = 11;
+    model.positionOffset = 0;
+    model.positionComponents = 3;
+    model.normalOffset = 3;
+    model.uvOffset = 6;
+
+    const int numberOfVertices = sizeof(cubeVertices) / (3 * sizeof(GLfloat));
+    for (int i = 0; i < numberOfVertices; i++)
+    {
+        model.vertices.insert(model.vertices.end(), cubeVertices + i * 3, cubeVertices + i * 3 + 3);
+        model.vertices.insert(model.vertices.end(), normals + i * 3, normals + i * 3 + 3);
+        model.vertices.insert(model.vertices.end(), textureCords + i * 2, textureCords + i * 2 + 2);
+        model.vertices.insert(model.vertices.end(), colour + i * 3, colour + i * 3 + 3);
+    }
+    model.indices.assign(indicies, indicies + sizeof(indicies) / sizeof(GLushort));
+
+    if (!MaliSDK::TangentFrames::generate(&model))
+    {
+        LOGE("Could not generate the tangents");
+        return false;
+    }
+
+    /* Mirrored vertices may have been split, so there can be more vertices than in the arrays. */
+    vertices.resize(model.getNumberOfVertices());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const float *vertex = &model.vertices[i * model.floatsPerVertex];
+        for (int c = 0; c < 3; c++)
+        {
+            vertices[i].position[c] = vertex[model.positionOffset + c];
+            vertices[i].colour[c] = vertex[8 + c];
+        }
+        vertices[i].textureCord[0] = vertex[model.uvOffset];
+        vertices[i].textureCord[1] = vertex[model.uvOffset + 1];
+        MaliSDK::TangentFrames::encodeQuaternion(vertex + model.normalOffset, vertex + model.tangentOffset, vertices[i].tangentFrame);
+    }
+    indices = model.indices;
+
+    return true;
+}
 /* [vertexColourTangentNormal] */
 
 void renderFrame()
@@ -421,26 +447,25 @@ void renderFrame()
     glUseProgram(glProgram);
 
     /* [supplyData] */
-    glVertexAttribPointer(vertexLocation, 3, GL_FLOAT, GL_FALSE, 0, cubeVertices);
+    glVertexAttribPointer(vertexLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), vertices[0].position);
     glEnableVertexAttribArray(vertexLocation);
-    glVertexAttribPointer(textureCordLocation, 2, GL_FLOAT, GL_FALSE, 0, textureCords);
+    glVertexAttribPointer(textureCordLocation, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), vertices[0].textureCord);
     glEnableVertexAttribArray(textureCordLocation);
-    glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, 0, colour);
+    glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), vertices[0].colour);
     glEnableVertexAttribArray(colorLocation);
-    glVertexAttribPointer(vertexNormalLocation, 3, GL_FLOAT, GL_FALSE, 0, normals);
-    glEnableVertexAttribArray(vertexNormalLocation);
-    glVertexAttribPointer(biNormalLocation, 3, GL_FLOAT, GL_FALSE, 0, biNormals);
-    glEnableVertexAttribArray(biNormalLocation);
-    glVertexAttribPointer(tangentLocation, 3, GL_FLOAT, GL_FALSE, 0, tangents);
-    glEnableVertexAttribArray(tangentLocation);
+    glVertexAttribPointer(tangentFrameLocation, 4, GL_SHORT, GL_TRUE, sizeof(Vertex), vertices[0].tangentFrame);
+    glEnableVertexAttribArray(tangentFrameLocation);
     glUniformMatrix4fv(projectionLocation, 1, GL_FALSE,projectionMatrix);
     glUniformMatrix4fv(modelViewLocation, 1, GL_FALSE, modelViewMatrix);
+    glUniform4fv(normalXLocation, 1, normalMapChannels.x);
+    glUniform4fv(normalYLocation, 1, normalMapChannels.y);
+    glUniform2fv(normalBiasLocation, 1, normalMapChannels.bias);
     /* [supplyData] */
 
     /* Set the sampler texture unit to 0. */
     glUniform1i(samplerLocation, 0);
 
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, indicies);
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, &indices[0]);
 
     angle += 1;
     if (angle > 360)
@@ -459,7 +484,10 @@ extern "C"
 JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_normalmapping_NativeLibrary_init(
         JNIEnv * env, jobject obj, jint width, jint height)
 {
-    setupGraphics(width, height);
+    if (setupVertices())
+    {
+        setupGraphics(width, height);
+    }
 }
 
 JNIEXPORT void JNICALL Java_com_arm_malideveloper_openglessdk_normalmapping_NativeLibrary_step(
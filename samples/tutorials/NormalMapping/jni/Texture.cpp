@@ -19,10 +19,14 @@
  */
 
 #include "Texture.h"
+#include "KTXLoader.h"
+#include "TextureFormatSelector.h"
 
 #include <GLES2/gl2ext.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cmath>
+#include <vector>
 #include <android/log.h>
 
 #define LOG_TAG "libNative"
@@ -33,12 +37,50 @@
 #define TEXTURE_HEIGHT  256
 #define CHANNELS_PER_PIXEL  3
 
+#ifndef GL_COMPRESSED_SIGNED_RG11_EAC
+#define GL_COMPRESSED_SIGNED_RG11_EAC 0x9273
+#endif
+
+#define FILES_DIRECTORY "/data/data/com.arm.malideveloper.openglessdk.normalmapping/files/"
+
+using MaliSDK::TextureFormatSelector;
+
+static void setChannels(NormalMapChannels *channels, int xChannel, int yChannel, GLfloat scale, GLfloat bias)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        channels->x[i] = (i == xChannel) ? scale : 0.0f;
+        channels->y[i] = (i == yChannel) ? scale : 0.0f;
+    }
+    channels->bias[0] = bias;
+    channels->bias[1] = bias;
+}
+
 GLubyte * theTexture;
 
 /* [loadTexture] */
-GLuint loadTexture()
+GLuint loadTexture(NormalMapChannels *channels)
 {
     static GLuint textureId;
+
+    /*
+     * A dual plane ASTC normal map made offline, for example with astcenc -normal, which stores X in RGB
+     * and Y in alpha. The two planes are encoded separately, so X and Y do not bleed into each other.
+     */
+    FILE * astcFile = fopen(FILES_DIRECTORY "normalMap256.astc.ktx", "rb");
+    if (astcFile != NULL)
+    {
+        fclose(astcFile);
+
+        if (TextureFormatSelector::isFamilySupported(TextureFormatSelector::FAMILY_ASTC) &&
+            MaliSDK::KTXLoader::load(FILES_DIRECTORY "normalMap256.astc.ktx", &textureId))
+        {
+            setChannels(channels, 0, 3, 2.0f, -1.0f);
+            LOGI("Using the ASTC normal map");
+            return textureId;
+        }
+    }
+
     theTexture = (GLubyte *)malloc(sizeof(GLubyte) * TEXTURE_WIDTH * TEXTURE_HEIGHT * CHANNELS_PER_PIXEL);
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -52,18 +94,56 @@ GLuint loadTexture()
     /* Bind the texture object. */
     glBindTexture(GL_TEXTURE_2D, textureId);
 
-    FILE * theFile = fopen("/data/data/com.arm.malideveloper.openglessdk.normalmapping/files/normalMap256.raw", "r");
+    FILE * theFile = fopen(FILES_DIRECTORY "normalMap256.raw", "r");
 
     if(theFile == NULL)
     {
         LOGE("Failure to load the texture");
+        free(theTexture);
         return 0;
     }
 
     fread(theTexture, TEXTURE_WIDTH * TEXTURE_HEIGHT * CHANNELS_PER_PIXEL, 1, theFile);
+    fclose(theFile);
+
+    /* Z is reconstructed from X and Y, which requires unit normals. The file stores Z as 1.0 and does not normalize. */
+    for (int pixel = 0; pixel < TEXTURE_WIDTH * TEXTURE_HEIGHT; pixel++)
+    {
+        GLubyte *texel = theTexture + pixel * CHANNELS_PER_PIXEL;
+        float normal[3];
+        for (int i = 0; i < 3; i++)
+        {
+            normal[i] = texel[i] / 127.5f - 1.0f;
+        }
+        float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (int i = 0; i < 3; i++)
+        {
+            texel[i] = (GLubyte)floorf((normal[i] / length * 0.5f + 0.5f) * 255.0f + 0.5f);
+        }
+    }
 
     /* Load the texture. */
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, TEXTURE_WIDTH, TEXTURE_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, theTexture);
+    if (TextureFormatSelector::isFormatSupported(GL_COMPRESSED_SIGNED_RG11_EAC))
+    {
+        /* 8 bits per texel, with the sign kept in the format so X and Y reach the shader as -1.0 to 1.0. */
+        std::vector<unsigned char> blocks;
+        TextureFormatSelector::encodeSignedRG11(theTexture, TEXTURE_WIDTH, TEXTURE_HEIGHT, CHANNELS_PER_PIXEL, &blocks);
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_SIGNED_RG11_EAC, TEXTURE_WIDTH, TEXTURE_HEIGHT, 0, blocks.size(), &blocks[0]);
+        setChannels(channels, 0, 1, 1.0f, 0.0f);
+        LOGI("Using the RG11 EAC normal map");
+    }
+    else
+    {
+        /* X in luminance, Y in alpha: 16 bits per texel instead of 24. */
+        for (int pixel = 0; pixel < TEXTURE_WIDTH * TEXTURE_HEIGHT; pixel++)
+        {
+            theTexture[pixel * 2] = theTexture[pixel * CHANNELS_PER_PIXEL];
+            theTexture[pixel * 2 + 1] = theTexture[pixel * CHANNELS_PER_PIXEL + 1];
+        }
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, TEXTURE_WIDTH, TEXTURE_HEIGHT, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, theTexture);
+        setChannels(channels, 0, 3, 2.0f, -1.0f);
+        LOGI("Using the uncompressed normal map");
+    }
 
     /* Set the filtering mode. */
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -24,8 +24,25 @@
 #include <GLES2/gl2.h>
 
 /**
- * \brief Loads a 256 x 256 texture from the Android filesystem
+ * \brief Which channels of the normal map hold the X and Y of the normal.
+ *
+ * Only two channels are stored, the shader reconstructs Z. Each of X and Y is the dot product of the texel
+ * with the matching vector, plus the bias.
+ */
+struct NormalMapChannels
+{
+    GLfloat x[4];
+    GLfloat y[4];
+    GLfloat bias[2];
+};
+
+/**
+ * \brief Loads a 256 x 256 normal map from the Android filesystem
+ *
+ * The most compact format the device supports is used: ASTC if normalMap256.astc.ktx is there, signed
+ * RG11 EAC encoded at load time, and uncompressed luminance alpha otherwise.
+ * \param[out] channels Where the normal is in the texels.
  * \return Returns the handle to the texture object.
  */
-GLuint loadTexture();
+GLuint loadTexture(NormalMapChannels *channels);
 #endif
@@ -28,6 +28,8 @@ in vec4 modelPosition;
 
 /* Color of a geometry. */
 uniform vec4 color;
+/* False for the objects drawn at a coarse level of detail, which skip the specular highlight. */
+uniform bool specularEnabled;
 /* Inverted model-view-projection matrix that will be used to compute light. */
 uniform mat4 worldInverseMatrix;
 
@@ -98,7 +100,7 @@ void main()
     /* Check if the light source is on the proper side. */
     vec3 specularReflection = vec3(0.0, 0.0, 0.0);
 
-    if (dot(normalDirection, lightDirection) >= 0.0)
+    if (specularEnabled && dot(normalDirection, lightDirection) >= 0.0)
     {
         /* If it's on the right side, compute specularReflection. Specular reflection = attenuation * lightSpecular * materialSpecular * (-lightDirection o normalDirection). */
         specularReflection = attenuation                  *
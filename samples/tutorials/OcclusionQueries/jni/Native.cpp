@@ -43,8 +43,13 @@
 *almost of the same size and shape), and once we get the results, we are able to render only those
 *rounded cubes which passed the test.
 *
-*There is also text displayed (at the bottom left corner of the screen) showing whether the occlusion
-*query mode is currently on or off. The mode changes every 10 seconds.
+*A third mode also picks a level of detail and a shading quality per visible cube. OpenGL ES has no
+*GL_SAMPLES_PASSED to count the pixels a cube covers, so its footprint is estimated from the screen rectangle
+*of its bounding box, and a second query on a smaller proxy inside it tells whether its middle is occluded.
+*Cubes that are small on screen or mostly hidden get fewer triangles and no specular highlight.
+*
+*There is also text displayed (at the bottom left corner of the screen) showing which occlusion
+*query mode is currently on. The mode changes every 10 seconds.
  *
  */
 
@@ -56,12 +61,16 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "Common.h"
 #include "CubeModel.h"
+#include "DepthSorter.h"
 #include "Matrix.h"
 #include "Native.h"
+#include "OcclusionQueryScheduler.h"
 #include "PlaneModel.h"
+#include "SampleParameters.h"
 #include "Shader.h"
 #include "SuperEllipsoidModel.h"
 #include "Text.h"
@@ -74,6 +83,9 @@ using namespace MaliSDK;
 /* Asset directories and filenames */
 const string resourceDirectory = "/data/data/com.arm.malideveloper.openglessdk.occlusionQueries/files/";
 
+/* Directory read by SampleParameters, where parameters.txt can be pushed. */
+const string parametersDirectory = "/data/data/com.arm.malideveloper.openglessdk.occlusionQueries/";
+
 /* Window properties. */
 int windowWidth  = 0;
 int windowHeight = 0;
@@ -87,32 +99,59 @@ Timer fpsTimer;
 /* Id of OpenGL program we use for rendering. */
 GLuint programId = 0;
 
-/* Pointer to an array that stores vertices of rounded cube. */
-float* roundedCubeCoordinates = NULL;
-
-/* Pointer to an array that stores normal vectors of rounded cube. */
-float* roundedCubeNormalVectors = NULL;
+/* Vertices and normal vectors of the rounded cube, all its levels of detail one after the other. */
+std::vector<float> roundedCubeCoordinates;
+std::vector<float> roundedCubeNormalVectors;
 
-/* This value represents number of rounded cube vertices. */
+/* This value represents number of rounded cube vertices, at the finest level of detail. */
 int numberOfRoundedCubesVertices = 0;
 
-/* Represents a number of rounded cube's coordinates. */
-int numberOfRoundedCubeCoordinates = 0;
+/* Samples of each level of detail of the rounded cube, see SuperEllipsoidModel::create(). */
+const int lodSamples[NUMBER_OF_LODS] = {NUMBER_OF_SAMPLES, 64, 24};
+
+/* Smallest footprint (in pixels) of a cube drawn at each level of detail. The last one takes all the others. */
+const float lodMinimumFootprint[NUMBER_OF_LODS] = {16384.0f, 2048.0f, 0.0f};
+
+/* Levels of detail from this one on are drawn without specular highlights. */
+const int lodDiffuseOnly = 2;
+
+/* First vertex and number of vertices of each level of detail in the rounded cube buffers. */
+int lodFirstVertex[NUMBER_OF_LODS];
+int lodNumberOfVertices[NUMBER_OF_LODS];
 
-/* Represents a number of rounded cube's normal vectors. */
-int numberOfRoundedCubeNormalVectors = 0;
+/* Cubes drawn at each level of detail in the last frame. */
+int numberOfCubesPerLod[NUMBER_OF_LODS];
+
+/* Number of cubes rendered per frame, NUMBER_OF_CUBES unless the number_of_cubes parameter is set. */
+int numberOfCubes = NUMBER_OF_CUBES;
 
 /* Array that stores random position of each cube. */
-Vec2f randomCubesPositions[NUMBER_OF_CUBES];
+std::vector<Vec2f> randomCubesPositions;
 
 /* Minimum distance between cubes. */
 const float minimumDistance = ROUNDED_CUBE_SCALE_FACTOR * 2.0f + 0.1f;
 
-/* Array of queries for each of numberOfCubes cubes. */
-GLuint cubeQuery[NUMBER_OF_CUBES] = {0};
+/* Occlusion queries of the cubes, collected a few frames late so reading them back never stalls. */
+OcclusionQueryScheduler* cubeOcclusion = NULL;
+
+/* Occlusion queries of a proxy CORE_PROXY_SCALE times smaller inside each cube, issued in level of detail mode.
+ * A cube whose proxy passes but whose core does not is mostly hidden, only its edges can be seen. */
+OcclusionQueryScheduler* cubeCoreOcclusion = NULL;
+
+/* The modes the application goes through, one every TIME_INTERVAL seconds. */
+enum RenderingMode
+{
+    MODE_QUERIES_OFF,   /* All the rounded cubes are drawn. */
+    MODE_QUERIES_ON,    /* Only the visible rounded cubes are drawn. */
+    MODE_QUERIES_LOD,   /* Only the visible rounded cubes are drawn, at a level of detail depending on their footprint. */
+    NUMBER_OF_MODES
+};
+
+/* Text shown for each mode. */
+const char* modeNames[NUMBER_OF_MODES] = {"Occlusion query OFF", "Occlusion query ON", "Occlusion query ON, LOD"};
 
-/* Flag that informs us what mode is turned on (if it's occlusion query mode or not). */
-bool occlusionQueriesOn = false;
+/* The mode turned on. */
+RenderingMode renderingMode = MODE_QUERIES_OFF;
 
 /* This is the angle that is used to rotate camera around Y axis. */
 float angleY = 0.0f;
@@ -141,9 +180,13 @@ GLint normalMatrixUniformLocation       = -1;
 GLint mvpMatrixUniformLocation          = -1;
 GLint worldInverseMatrixUniformLocation = -1;
 GLint colorUniformLocation              = -1;
+GLint specularUniformLocation           = -1;
 
-/* Array to store sorted positions of the cubes. Each cube has 2 coordinates. */
-float sortedCubesPositions[2 * NUMBER_OF_CUBES] = {0.0f};
+/* Array to store positions of the cubes. Each cube has 2 coordinates. */
+std::vector<float> sortedCubesPositions;
+
+/* Sorts the cubes front to back every frame. */
+DepthSorter cubeSorter;
 
 /* Scaling factor to scale up the plane. */
 const float planeScalingFactor = 40.0f;
@@ -195,7 +238,7 @@ float* planeNormalVectors = NULL;
 /* Determines the size of the dynamically allocated plane Normals array. */
 int sizeOfPlaneNormalsArray = 0;
 
-/* Flag indicating that the rendering mode has changed (occlusion query OFF => ON) */
+/* Flag indicating that the occlusion queries have just been turned on (occlusion query OFF => ON) */
 bool modeChanged = false;
 
 /* Counter for the number of rounded cubes drawn each frame. */
@@ -284,22 +327,23 @@ void generateCubesLocations(float planeWidth, float planeHeight, float minDistan
     Vec2f firstRandomPoint = {(xRange + xRange) * uniformRandomNumber() - xRange,
                               (zRange + zRange) * uniformRandomNumber() - zRange};
 
+    randomCubesPositions.resize(numberOfCubes);
     randomCubesPositions[0] = firstRandomPoint;
 
-    for (int i = 1; i < NUMBER_OF_CUBES; i++)
+    for (int i = 1; i < numberOfCubes; i++)
     {
-        /* Check if the loop has not iterated too many times. */
-        if (loopsCounter > NUMBER_OF_CUBES * NUMBER_OF_CUBES)
-        {
-            return;
-        }
+        /*
+         * When the loop has iterated too many times, the plane is too crowded: let the remaining cubes overlap.
+         * Bounded by 20 attempts per cube, as each check goes through all the cubes placed so far.
+         */
+        bool crowded = loopsCounter > float(numberOfCubes) * float(numberOfCubes < 20 ? numberOfCubes : 20);
 
         /* We choose another random point on a plane. */
         Vec2f randomPoint = {(xRange + xRange) * uniformRandomNumber() - xRange,
                              (zRange + zRange) * uniformRandomNumber() - zRange};
 
         /* And check if it's a proper distance from any other point that is already stored in the array. */
-        if (!inNeighbourhood(randomPoint, minDistance, i))
+        if (crowded || !inNeighbourhood(randomPoint, minDistance, i))
         {
             /* If it is, we can save it to the array of random cubes positions. */
             randomCubesPositions[i] = randomPoint;
@@ -318,51 +362,24 @@ void generateCubesLocations(float planeWidth, float planeHeight, float minDistan
 /**
  * \brief Function that is used to sort cubes' center positions from the nearest to the furthest, relative to the camera position.
  *
- * We use bubble sort algorithm that checks whether an array is sorted or not.
+ * The view space depth of each cube is computed once, then DepthSorter orders them starting from the order of the
+ * previous frame, which the slowly moving camera barely changes. The positions stay where they are so that a cube keeps
+ * its index, which identifies its occlusion queries; the cubes are drawn in the order cubeSorter.getOrder() gives.
  *
- * \param[in,out] arrayToSort An array to be sorted.
+ * \param[in] positions Positions of the cubes, 2 coordinates each.
  */
-void sortCubePositions(float* arrayToSort)
+void sortCubePositions(const float* positions)
 {
-    /* The upper limit position of sorted elements. We subtract 4 because we will refer to the 4 array's
-     * cells ahead and we don't want to go out of bounds of the array. */
-    int max = (NUMBER_OF_CUBES * 2) - 4;
+    std::vector<Vec3f> cubeCentres(numberOfCubes);
 
-    bool swapped = true;
-
-    while(swapped)
+    for (int i = 0; i < numberOfCubes; i++)
     {
-        swapped = false;
-
-        for (int i = 0; i <= max; i += 2)
-        {
-            /* Temporarily store location points. */
-            Vec2f firstCubeLocation, secondCubeLocation;
+        Vec3f cubeCentre = {positions[2 * i], 1, positions[2 * i + 1]};
 
-            firstCubeLocation.x = arrayToSort[i];
-            firstCubeLocation.y = arrayToSort[i + 1];
-
-            secondCubeLocation.x = arrayToSort[i + 2];
-            secondCubeLocation.y = arrayToSort[i + 3];
-
-            Vec3f first_cube_location              = {firstCubeLocation.x,  1, firstCubeLocation.y};
-            Vec3f second_cube_location             = {secondCubeLocation.x, 1, secondCubeLocation.y};
-            Vec3f transformed_first_cube_location  = Matrix::vertexTransform(&first_cube_location,  &rotatedViewMatrix);
-            Vec3f transformed_second_cube_location = Matrix::vertexTransform(&second_cube_location, &rotatedViewMatrix);
-
-            if (transformed_first_cube_location.z < transformed_second_cube_location.z)
-            {
-                /* Swap coordinates' positions. */
-                arrayToSort[i]     = secondCubeLocation.x;
-                arrayToSort[i + 1] = secondCubeLocation.y;
-
-                arrayToSort[i + 2] = firstCubeLocation.x;
-                arrayToSort[i + 3] = firstCubeLocation.y;
+        cubeCentres[i] = cubeCentre;
+    }
 
-                swapped = true;
-            }
-        } /* for (int i = 0; i <= max; i += 2) */
-    }/* while(swapped) */
+    cubeSorter.sort(&cubeCentres[0], numberOfCubes, &rotatedViewMatrix, DepthSorter::FrontToBack);
 }
 
 /**
@@ -373,7 +390,9 @@ void sortCubePositions(float* arrayToSort)
  */
 void rewriteVec2fArrayToFloatArray()
 {
-    for (int i = 0; i < NUMBER_OF_CUBES; i++)
+    sortedCubesPositions.resize(2 * numberOfCubes);
+
+    for (int i = 0; i < numberOfCubes; i++)
     {
         sortedCubesPositions[i * 2]     = randomCubesPositions[i].x;
         sortedCubesPositions[i * 2 + 1] = randomCubesPositions[i].y;
@@ -419,6 +438,77 @@ inline void sendCubeLocationVectorToUniform(int whichCube)
                                 cubeMvpMatrix.getAsArray()));
 }
 
+/**
+ * \brief Estimates how many pixels a cube covers on screen.
+ *
+ * The footprint is the screen rectangle of the cube's bounding box, clamped to the window, so it is conservative:
+ * a cube never covers more. It is the whole window when a corner of the box is behind the camera.
+ * Expects cubeMvpMatrix to be set for the cube, see sendCubeLocationVectorToUniform().
+ *
+ * \return Area of the rectangle in pixels.
+ */
+float calculateCubeFootprint()
+{
+    float minX =  1.0f;
+    float maxX = -1.0f;
+    float minY =  1.0f;
+    float maxY = -1.0f;
+
+    for (int corner = 0; corner < 8; corner++)
+    {
+        Vec4f position;
+
+        position.x = (corner & 1) ? ROUNDED_CUBE_SCALE_FACTOR : -ROUNDED_CUBE_SCALE_FACTOR;
+        position.y = (corner & 2) ? ROUNDED_CUBE_SCALE_FACTOR : -ROUNDED_CUBE_SCALE_FACTOR;
+        position.z = (corner & 4) ? ROUNDED_CUBE_SCALE_FACTOR : -ROUNDED_CUBE_SCALE_FACTOR;
+        position.w = 1.0f;
+
+        Vec4f clip = Matrix::vertexTransform(&position, &cubeMvpMatrix);
+
+        if (clip.w <= 0.0f)
+        {
+            return float(windowWidth) * float(windowHeight);
+        }
+
+        minX = fminf(minX, clip.x / clip.w);
+        maxX = fmaxf(maxX, clip.x / clip.w);
+        minY = fminf(minY, clip.y / clip.w);
+        maxY = fmaxf(maxY, clip.y / clip.w);
+    }
+
+    /* Normalized device coordinates span 2 units across the window. */
+    float width  = fmaxf(0.0f, fminf(maxX, 1.0f) - fmaxf(minX, -1.0f)) * 0.5f * windowWidth;
+    float height = fmaxf(0.0f, fminf(maxY, 1.0f) - fmaxf(minY, -1.0f)) * 0.5f * windowHeight;
+
+    return width * height;
+}
+
+/**
+ * \brief Chooses the level of detail of a visible cube.
+ *
+ * \param[in] whichCube Cube to choose for. cubeMvpMatrix has to be set for it.
+ *
+ * \return Level of detail, 0 being the finest.
+ */
+int chooseCubeLod(int whichCube)
+{
+    /* Only the edges of a cube with an occluded core can be seen, the coarsest level is enough for them. */
+    if (!cubeCoreOcclusion->isVisible(whichCube))
+    {
+        return NUMBER_OF_LODS - 1;
+    }
+
+    float footprint = calculateCubeFootprint();
+    int   lod       = 0;
+
+    while (lod < NUMBER_OF_LODS - 1 && footprint < lodMinimumFootprint[lod])
+    {
+        lod++;
+    }
+
+    return lod;
+}
+
 /**
  * \brief Function that sets up shaders, programs, uniforms locations, generates buffer objects and query objects.
  *
@@ -434,6 +524,10 @@ void setupGraphics(int width, int height)
     windowHeight = height;
     windowWidth  = width;
 
+    /* Workload size, so the benchmark harness can sweep it without rebuilding. */
+    SampleParameters::load(parametersDirectory.c_str());
+    numberOfCubes = SampleParameters::getInt("number_of_cubes", NUMBER_OF_CUBES, 1, 4096);
+
     /* Initialize scaling matrix. */
     Matrix scaling = Matrix::createScaling(planeScalingFactor,
                                            planeScalingFactor,
@@ -461,7 +555,7 @@ void setupGraphics(int width, int height)
 
     /* Set up the text object. */
     text = new Text(resourceDirectory.c_str(), windowWidth, windowHeight);
-    text->addString(0, 0, "Occlusion query OFF", 255, 0, 0, 255);
+    text->addString(0, 0, modeNames[renderingMode], 255, 0, 0, 255);
 
     /* Set clear color. */
     GL_CHECK(glClearColor(0.3f, 0.6f, 0.70f, 1.0f));
@@ -506,27 +600,52 @@ void setupGraphics(int width, int height)
     /* [Get program attrib locations] */
 
     colorUniformLocation              = GL_CHECK(glGetUniformLocation(programId, "color"));
+    specularUniformLocation           = GL_CHECK(glGetUniformLocation(programId, "specularEnabled"));
     normalMatrixUniformLocation       = GL_CHECK(glGetUniformLocation(programId, "normalMatrix"));
     worldInverseMatrixUniformLocation = GL_CHECK(glGetUniformLocation(programId, "worldInverseMatrix"));
     mvpMatrixUniformLocation          = GL_CHECK(glGetUniformLocation(programId, "mvpMatrix"));
 
     ASSERT(colorUniformLocation              != -1, "Could not retrieve uniform location:   color");
+    ASSERT(specularUniformLocation           != -1, "Could not retrieve uniform location:   specularEnabled");
     ASSERT(verticesAttributeLocation         != -1, "Could not retrieve attribute location: vertex");
     ASSERT(normalAttributeLocation           != -1, "Could not retrieve attribute location: normal");
     ASSERT(normalMatrixUniformLocation       != -1, "Could not retrieve uniform location:   normalMatrix");
     ASSERT(worldInverseMatrixUniformLocation != -1, "Could not retrieve uniform location:   worldInverseMatrix");
     ASSERT(mvpMatrixUniformLocation          != -1, "Could not retrieve uniform location:   mvpMatrix");
 
-    /* Generate super ellipsoid. */
-    SuperEllipsoidModel::create(NUMBER_OF_SAMPLES,
-                                SQUARENESS_1,
-                                SQUARENESS_2,
-                                ROUNDED_CUBE_SCALE_FACTOR,
-                                &roundedCubeCoordinates,
-                                &roundedCubeNormalVectors,
-                                &numberOfRoundedCubesVertices,
-                                &numberOfRoundedCubeCoordinates,
-                                &numberOfRoundedCubeNormalVectors);
+    /* Generate super ellipsoids, one per level of detail, into the same arrays. */
+    for (int lod = 0; lod < NUMBER_OF_LODS; lod++)
+    {
+        float* coordinates         = NULL;
+        float* normalVectors       = NULL;
+        int    numberOfVertices    = 0;
+        int    numberOfCoordinates = 0;
+        int    numberOfNormals     = 0;
+
+        SuperEllipsoidModel::create(lodSamples[lod],
+                                    SQUARENESS_1,
+                                    SQUARENESS_2,
+                                    ROUNDED_CUBE_SCALE_FACTOR,
+                                    &coordinates,
+                                    &normalVectors,
+                                    &numberOfVertices,
+                                    &numberOfCoordinates,
+                                    &numberOfNormals);
+
+        ASSERT(coordinates   != NULL, "Could not create super ellipsoid's coordinates.");
+        ASSERT(normalVectors != NULL, "Could not create super ellipsoid's normal vectors.");
+
+        lodFirstVertex[lod]      = roundedCubeCoordinates.size() / 4;
+        lodNumberOfVertices[lod] = numberOfVertices;
+
+        roundedCubeCoordinates.insert  (roundedCubeCoordinates.end(),   coordinates,   coordinates   + numberOfCoordinates);
+        roundedCubeNormalVectors.insert(roundedCubeNormalVectors.end(), normalVectors, normalVectors + numberOfNormals);
+
+        delete[] coordinates;
+        delete[] normalVectors;
+    }
+    numberOfRoundedCubesVertices = lodNumberOfVertices[0];
+
     /* Generate triangular representation of a cube. */
     CubeModel::getTriangleRepresentation(NORMAL_CUBE_SCALE_FACTOR,
                                          &numberOfCubeVertices,
@@ -543,8 +662,6 @@ void setupGraphics(int width, int height)
     /* [Get plane normals] */
 
     /* Make sure the models'coordinates were created successfully. */
-    ASSERT(roundedCubeCoordinates   != NULL, "Could not create super ellipsoid's coordinates.");
-    ASSERT(roundedCubeNormalVectors != NULL, "Could not create super ellipsoid's normal vectors.");
     ASSERT(normalCubeVertices       != NULL, "Could not create triangular representation of a cube.");
     ASSERT(planeVertices            != NULL, "Could not create triangular representation of a plane.");
     ASSERT(planeNormalVectors       != NULL, "Could not create plane's normal vector.");
@@ -644,8 +761,8 @@ void setupGraphics(int width, int height)
         GL_CHECK(glBindBuffer         (GL_ARRAY_BUFFER,
                                        roundedCubeVerticesBufferId));
         GL_CHECK(glBufferData         (GL_ARRAY_BUFFER,
-                                       numberOfRoundedCubeCoordinates * sizeof(float),
-                                       roundedCubeCoordinates,
+                                       roundedCubeCoordinates.size() * sizeof(float),
+                                       &roundedCubeCoordinates[0],
                                        GL_STATIC_DRAW));
         GL_CHECK(glVertexAttribPointer(verticesAttributeLocation,
                                        4,
@@ -657,8 +774,8 @@ void setupGraphics(int width, int height)
         GL_CHECK(glBindBuffer         (GL_ARRAY_BUFFER,
                                        roundedCubeNormalVectorsBufferId));
         GL_CHECK(glBufferData         (GL_ARRAY_BUFFER,
-                                       numberOfRoundedCubeNormalVectors * sizeof(float),
-                                       roundedCubeNormalVectors,
+                                       roundedCubeNormalVectors.size() * sizeof(float),
+                                       &roundedCubeNormalVectors[0],
                                        GL_STATIC_DRAW));
         GL_CHECK(glVertexAttribPointer(normalAttributeLocation,
                                        4,
@@ -672,7 +789,9 @@ void setupGraphics(int width, int height)
     }
 
     /* [Generate query objects] */
-    GL_CHECK(glGenQueries(NUMBER_OF_CUBES, cubeQuery));
+    /* Query objects are generated by the scheduler when first needed. */
+    cubeOcclusion     = new OcclusionQueryScheduler(numberOfCubes);
+    cubeCoreOcclusion = new OcclusionQueryScheduler(numberOfCubes);
     /* [Generate query objects] */
 
     /* Define blending function that will be used when enabled. */
@@ -697,17 +816,8 @@ void setupGraphics(int width, int height)
         planeNormalVectors = NULL;
     }
 
-    if(roundedCubeCoordinates != NULL)
-    {
-        delete[] roundedCubeCoordinates;
-        roundedCubeCoordinates = NULL;
-    }
-
-    if(roundedCubeNormalVectors != NULL)
-    {
-        delete[] roundedCubeNormalVectors;
-        roundedCubeNormalVectors = NULL;
-    }
+    std::vector<float>().swap(roundedCubeCoordinates);
+    std::vector<float>().swap(roundedCubeNormalVectors);
 
     fpsTimer.reset();
     timer.reset();
@@ -723,6 +833,17 @@ void draw(void)
 {
     numberOfRoundedCubesDrawn = 0;
 
+    for (int lod = 0; lod < NUMBER_OF_LODS; lod++)
+    {
+        numberOfCubesPerLod[lod] = 0;
+    }
+
+    const bool occlusionQueriesOn = renderingMode != MODE_QUERIES_OFF;
+    const bool lodOn              = renderingMode == MODE_QUERIES_LOD;
+
+    /* Front to back, see sortCubePositions(). */
+    const int* cubeOrder = cubeSorter.getOrder();
+
     /* Set active program object. */
     GL_CHECK(glUseProgram(programId));
 
@@ -731,6 +852,7 @@ void draw(void)
         GL_CHECK(glUniform4fv(colorUniformLocation,
                               1,
                               cubeColor));
+        GL_CHECK(glUniform1i(specularUniformLocation, 1));
 
         if (occlusionQueriesOn)
         {
@@ -742,16 +864,62 @@ void draw(void)
             /* [Set color mask to GL_FALSE] */
 
             /* [Issue the occlusion test] */
-            for (int i = 0; i < NUMBER_OF_CUBES; i++)
+            /* Collect the results of the queries issued a few frames ago, without waiting for any. */
+            if (modeChanged)
+            {
+                cubeOcclusion->reset();
+                cubeCoreOcclusion->reset();
+            }
+            cubeOcclusion->beginFrame();
+            cubeCoreOcclusion->beginFrame();
+
+            /* The plain cube encloses the rounded one, so it is a conservative proxy for it. */
+            for (int i = 0; i < numberOfCubes; i++)
             {
-                sendCubeLocationVectorToUniform(i);
-                /* Begin occlusion query. */
-                GL_CHECK(glBeginQuery(GL_ANY_SAMPLES_PASSED, cubeQuery[i]));
+                int cube = cubeOrder[i];
+
+                sendCubeLocationVectorToUniform(cube);
+
+                /* The core is tested before the proxy around it, which would hide it. It is inside the proxy,
+                 * so the depth it writes changes nothing for the cubes further away. */
+                if (lodOn && cubeCoreOcclusion->canQuery(cube))
+                {
+                    Matrix coreMvpMatrix = cubeMvpMatrix * Matrix::createScaling(CORE_PROXY_SCALE,
+                                                                                 CORE_PROXY_SCALE,
+                                                                                 CORE_PROXY_SCALE);
+
+                    GL_CHECK(glUniformMatrix4fv(mvpMatrixUniformLocation,
+                                                1,
+                                                GL_FALSE,
+                                                coreMvpMatrix.getAsArray()));
+
+                    cubeCoreOcclusion->beginQuery(cube);
+                    {
+                        GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, numberOfCubeVertices));
+                    }
+                    cubeCoreOcclusion->endQuery();
+
+                    GL_CHECK(glUniformMatrix4fv(mvpMatrixUniformLocation,
+                                                1,
+                                                GL_FALSE,
+                                                cubeMvpMatrix.getAsArray()));
+                }
+
+                if (cubeOcclusion->canQuery(cube))
+                {
+                    /* Begin occlusion query. */
+                    cubeOcclusion->beginQuery(cube);
+                    {
+                        GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, numberOfCubeVertices));
+                    }
+                    cubeOcclusion->endQuery();
+                    /* End occlusion query. */
+                }
+                else
                 {
+                    /* Still fill the depth buffer, the cubes behind are tested against it. */
                     GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, numberOfCubeVertices));
                 }
-                GL_CHECK(glEndQuery(GL_ANY_SAMPLES_PASSED));
-                /* End occlusion query. */
             }
             /* [Issue the occlusion test] */
 
@@ -773,28 +941,40 @@ void draw(void)
             GL_CHECK(glBindVertexArray(roundedCubeVertexArrayObjectId));
             /* [Bind rounded cubes vertex array object] */
 
-            for(int i = 0; i < NUMBER_OF_CUBES; i++)
+            for(int i = 0; i < numberOfCubes; i++)
             {
-                GLuint queryResult = GL_FALSE;
+                int cube = cubeOrder[i];
 
                 /* [Check query result] */
-                GL_CHECK(glGetQueryObjectuiv(cubeQuery[i], GL_QUERY_RESULT, &queryResult));
+                bool cubeVisible = cubeOcclusion->isVisible(cube);
                 /* [Check query result] */
 
-                /* If the cube has become visible in this frame, render it again as a rounded cube. */
-                if (queryResult == GL_TRUE)
+                /* If the cube was visible in the latest collected result, render it again as a rounded cube. */
+                if (cubeVisible)
                 {
-                    sendCubeLocationVectorToUniform(i);
+                    sendCubeLocationVectorToUniform(cube);
+
+                    /* In level of detail mode, cubes small on screen or mostly occluded get fewer triangles
+                     * and simpler shading. */
+                    int lod = lodOn ? chooseCubeLod(cube) : 0;
+
+                    if (lodOn)
+                    {
+                        GL_CHECK(glUniform1i(specularUniformLocation, lod < lodDiffuseOnly ? 1 : 0));
+                    }
 
                     /* [Draw rounded cube] */
                     GL_CHECK(glDrawArrays(GL_TRIANGLES,
-                                          0,
-                                          numberOfRoundedCubesVertices));
+                                          lodFirstVertex[lod],
+                                          lodNumberOfVertices[lod]));
                     /* [Draw rounded cube] */
 
                     numberOfRoundedCubesDrawn++;
+                    numberOfCubesPerLod[lod]++;
                 }
             }
+
+            GL_CHECK(glUniform1i(specularUniformLocation, 1));
         }
         else
         {
@@ -802,16 +982,16 @@ void draw(void)
             /* Draw all rounded cubes without using occlusion queries. */
             GL_CHECK(glBindVertexArray(roundedCubeVertexArrayObjectId));
 
-            for(int i = 0; i < NUMBER_OF_CUBES; i++)
+            for(int i = 0; i < numberOfCubes; i++)
             {
-                sendCubeLocationVectorToUniform(i);
+                sendCubeLocationVectorToUniform(cubeOrder[i]);
 
                 GL_CHECK(glDrawArrays(GL_TRIANGLES,
                                       0,
                                       numberOfRoundedCubesVertices));
             }
 
-            numberOfRoundedCubesDrawn = NUMBER_OF_CUBES;
+            numberOfRoundedCubesDrawn = numberOfCubes;
             /* [Draw for disabled occlusion query mode] */
         }
     } /* Draw the cubes. */
@@ -853,6 +1033,11 @@ void renderFrame()
 
         LOGI("FPS:\t%.1f", FPS);
         LOGI("Number of Cubes drawn: %d\n", numberOfRoundedCubesDrawn);
+
+        if (renderingMode == MODE_QUERIES_LOD)
+        {
+            LOGI("Cubes drawn per level of detail: %d %d %d\n", numberOfCubesPerLod[0], numberOfCubesPerLod[1], numberOfCubesPerLod[2]);
+        }
     }
 
     /* Clear color and depth buffers. */
@@ -879,32 +1064,26 @@ void renderFrame()
      * It is important that the cubes are rendered front to back because the occlusion test is done per draw call.
      * If the cubes are draw out of order then some cubes may pass the occlusion test even when they end up being
      * occluded by geometry drawn later. */
-    sortCubePositions(sortedCubesPositions);
+    sortCubePositions(&sortedCubesPositions[0]);
     /* [Sort positions] */
 
     modeChanged = false;
 
-    /* Check timer to know if we should turn off/on occlusion queries. */
+    /* Check timer to know if we should switch to the next mode. */
     if(timer.getTime() > TIME_INTERVAL)
     {
-        occlusionQueriesOn = !occlusionQueriesOn;
+        renderingMode = RenderingMode((renderingMode + 1) % NUMBER_OF_MODES);
 
-        if(occlusionQueriesOn)
+        if(renderingMode == MODE_QUERIES_ON)
         {
             /* Mark that mode has changed */
             modeChanged = true;
-
-            LOGI("\nOcclusion query ON\n");
-            text->clear();
-            text->addString(0, 0, "Occlusion query ON", 255, 0, 0, 255);
-        }
-        else
-        {
-            LOGI("\nOcclusion query OFF\n");
-            text->clear();
-            text->addString(0, 0, "Occlusion query OFF", 255, 0, 0, 255);
         }
 
+        LOGI("\n%s\n", modeNames[renderingMode]);
+        text->clear();
+        text->addString(0, 0, modeNames[renderingMode], 255, 0, 0, 255);
+
         timer.reset();
     }
 
@@ -940,7 +1119,10 @@ void uninit()
     GL_CHECK(glDeleteVertexArrays(1, &roundedCubeVertexArrayObjectId));
 
     /* Delete the query objects. */
-    GL_CHECK(glDeleteQueries(NUMBER_OF_CUBES, cubeQuery));
+    delete cubeOcclusion;
+    cubeOcclusion = NULL;
+    delete cubeCoreOcclusion;
+    cubeCoreOcclusion = NULL;
 }
 
 extern "C"
@@ -24,12 +24,18 @@
     /* Interval expressed in seconds in which we change between modes. */
     #define TIME_INTERVAL (10.0f)
 
-    /* Determines number of cubes that are going to be rendered per frame. */
+    /* Determines number of cubes that are going to be rendered per frame, unless the number_of_cubes parameter is set. */
     #define NUMBER_OF_CUBES (20)
 
     /* Determines accuracy of rounded cubes - number of sample triangles that will make up a super ellipsoid. */
     #define NUMBER_OF_SAMPLES (256)
 
+    /* Levels of detail of the rounded cubes, used by the level of detail mode. The first one has NUMBER_OF_SAMPLES. */
+    #define NUMBER_OF_LODS (3)
+
+    /* Scale of the inner proxy cube of the level of detail mode, relative to the proxy cube. */
+    #define CORE_PROXY_SCALE (0.5f)
+
     /* These two "squareness" parameters determine what kind of figure we will get.
      * Different values can create for example a sphere, rounded cube, something like a star, cylinder, etc.
      * These given values (0.3f and 0.3f) will create a rounded cube. */
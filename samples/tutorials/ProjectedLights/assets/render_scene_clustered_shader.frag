@@ -0,0 +1,290 @@
+#version 310 es
+
+/* Copyright (c) 2014-2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+precision highp float;
+precision highp sampler2D;
+precision highp sampler2DShadow;
+
+/* Value used in float values comparison. */
+#define EPSILON 0.00001
+
+/* Must match CLUSTER_GRID_SIZE_* and MAXIMUM_LIGHTS_PER_CLUSTER in ProjectedLights.h. */
+#define CLUSTER_GRID_SIZE_X        16u
+#define CLUSTER_GRID_SIZE_Y        8u
+#define CLUSTER_GRID_SIZE_Z        24u
+#define MAXIMUM_LIGHTS_PER_CLUSTER 32u
+
+/* Light parameters expressed in eye space. */
+struct ClusteredLight
+{
+    vec4 positionAndRange;
+    vec4 directionAndCosAngle;
+    vec4 color;               /* The w component is greater than zero if the light projects the colour texture. */
+    mat4 viewToTextureMatrix;
+};
+
+layout(std430, binding = 0) readonly buffer Lights
+{
+    ClusteredLight lights[];
+};
+
+/* For every cluster: the number of lights, followed by MAXIMUM_LIGHTS_PER_CLUSTER light indices. */
+layout(std430, binding = 1) readonly buffer ClusterLightLists
+{
+    uint clusterLightLists[];
+};
+
+/* INPUTS */
+in vec3 normalInEyeSpace; /* Normal vector for the coordinates. */
+in vec4 vertexInEyeSpace; /* Vertex coordinates expressed in eye space. */
+
+/* UNIFORMS */
+uniform sampler2D       colorTexture;                   /* Colour texture that will be projected onto the scene. */
+uniform float           directionalLightAmbient;        /* Directional light ambient. */
+uniform vec3            directionalLightColor;          /* Directional light colour. */
+uniform vec3            directionalLightPosition;       /* Directional light position. */
+uniform vec4            geometryColor;                  /* Current colour of a geometry to be rendered. */
+uniform vec2            shadowDepthRange;               /* Near and far plane of the spot light projection. */
+uniform sampler2DShadow shadowMap;                      /* Sampler of the depth texture used for shadow-mapping. */
+uniform sampler2D       shadowMoments;                  /* Sampler of the blurred, mipmapped exponential variance moments of the shadow map. */
+uniform vec4            spotLightColor;                 /* Spot light colour. */
+uniform float           spotLightCosAngle;              /* Cosine of the spot light angle. */
+uniform vec4            spotLightLookAtPointInEyeSpace; /* Point coordinates translated into eye-space which spot light is looking at. */
+uniform vec4            spotLightPositionInEyeSpace;    /* Vector of position of spot light source translated into eye-space. */
+uniform mat4            viewToColorTextureMatrix;       /* Matrix we will use in the fragment shader to sample the colour texture for given fragment. */
+uniform mat4            viewToDepthTextureMatrix;       /* Matrix we will use in the fragment shader to sample the shadow map for given fragment. */
+uniform bool            useFilterableShadowMap;         /* If true, the shadow is looked up in shadowMoments rather than compared with shadowMap. */
+uniform bool            isCameraPointOfView;            /* The colour output is only needed when rendering from the camera point of view. */
+uniform vec2            clusterTileSize;                /* Size of a cluster on screen in pixels. */
+uniform float           clusterDepthScale;              /* Scale applied to log(-z) to get the depth slice of a fragment. */
+uniform float           clusterDepthBias;               /* Bias applied to the scaled log(-z) to get the depth slice of a fragment. */
+
+/* OUTPUTS */
+out vec4 color; /* Output colour variable. */
+
+/* [Calculate directional light] */
+/** \brief Get the directional lighting factor.
+ *
+ *  \return As per description.
+ */
+vec4 calculateLightFactor()
+{
+    vec3  normalizedNormal         = normalize(normalInEyeSpace);
+    vec3  normalizedLightDirection = normalize(directionalLightPosition - vertexInEyeSpace.xyz);
+    vec4  result                   = vec4(directionalLightColor, 1.0) * max(dot(normalizedNormal, normalizedLightDirection), 0.0);
+
+    return result * directionalLightAmbient;
+}
+/* [Calculate directional light] */
+
+/* [Get fragment to light cos value] */
+/** \brief Get cosine of the angle between the current fragment and spot light direction.
+ *
+ *  \return As per description.
+ */
+float getFragmentToLightCosValue()
+{
+    vec4  fragmentToLightdirection = normalize(vertexInEyeSpace - spotLightPositionInEyeSpace);
+    vec4  spotLightDirection       = normalize(spotLightLookAtPointInEyeSpace- spotLightPositionInEyeSpace);
+    float cosine                   = dot(spotLightDirection, fragmentToLightdirection);
+
+    return cosine;
+}
+/* [Get fragment to light cos value] */
+
+/* [Calculate projected texture] */
+/** \brief Get projected texture colour sampled for a specific fragment.
+ *
+ *  \return As per description.
+ */
+vec4 calculateProjectedTexture()
+{
+    vec3 textureCoordinates           = (viewToColorTextureMatrix * vertexInEyeSpace).xyz;
+    vec3 normalizedTextureCoordinates = normalize(textureCoordinates);
+    vec4 textureColor                 = textureProj(colorTexture, normalizedTextureCoordinates);
+
+    return textureColor;
+}
+/* [Calculate projected texture] */
+
+/* [Calculate spot light] */
+/** \brief Get the spot lighting factor.
+ *  \note  Can be called only if a fragment is placed in the spot light cone.
+ *
+ *  \param fragmentToLightCosValue Cosine of the angle between the current fragment and spot light direction.
+ *
+ *  \return As per description.
+ */
+vec4 calculateSpotLight(float fragmentToLightCosValue)
+{
+    const float constantAttenuation  = 0.01;
+    const float linearAttenuation    = 0.001;
+    const float quadraticAttenuation = 0.0004;
+    vec4        result               = vec4(0.0);
+
+    /* Calculate the distance from a spot light source to fragment. */
+    float distance             = distance(vertexInEyeSpace.xyz, spotLightPositionInEyeSpace.xyz);
+    float factor               = clamp((fragmentToLightCosValue - spotLightCosAngle), 0.0, 1.0);
+    float attenuation          = 1.0 / (constantAttenuation             +
+                                        linearAttenuation    * distance +
+                                        quadraticAttenuation * distance * distance);
+    vec4 projectedTextureColor = calculateProjectedTexture();
+
+    result = (spotLightColor * 0.5 + projectedTextureColor)* factor * attenuation;
+
+    return result;
+}
+/* [Calculate spot light] */
+
+/** \brief Get the contribution of the small lights assigned to the cluster of the fragment.
+ *
+ *  \return As per description.
+ */
+vec4 calculateClusteredLights()
+{
+    uvec2 tile         = min(uvec2(gl_FragCoord.xy / clusterTileSize), uvec2(CLUSTER_GRID_SIZE_X - 1u, CLUSTER_GRID_SIZE_Y - 1u));
+    float slice        = clamp(log(-vertexInEyeSpace.z) * clusterDepthScale + clusterDepthBias, 0.0, float(CLUSTER_GRID_SIZE_Z - 1u));
+    uint  clusterIndex = (uint(slice) * CLUSTER_GRID_SIZE_Y + tile.y) * CLUSTER_GRID_SIZE_X + tile.x;
+    uint  listOffset   = clusterIndex * (MAXIMUM_LIGHTS_PER_CLUSTER + 1u);
+    uint  lightsCount  = clusterLightLists[listOffset];
+    vec3  normal       = normalize(normalInEyeSpace);
+    vec4  result       = vec4(0.0);
+
+    for (uint i = 0u; i < lightsCount; i++)
+    {
+        ClusteredLight light           = lights[clusterLightLists[listOffset + 1u + i]];
+        vec3           fragmentToLight = light.positionAndRange.xyz - vertexInEyeSpace.xyz;
+        float          distance        = length(fragmentToLight);
+        vec3           lightDirection  = fragmentToLight / distance;
+        float          cone            = smoothstep(light.directionAndCosAngle.w, 1.0, dot(-lightDirection, light.directionAndCosAngle.xyz));
+        float          falloff         = clamp(1.0 - distance / light.positionAndRange.w, 0.0, 1.0);
+        vec4           lightColor      = vec4(light.color.rgb, 1.0);
+
+        if (light.color.w > 0.0)
+        {
+            vec4 textureCoordinates = light.viewToTextureMatrix * vertexInEyeSpace;
+
+            /* textureLod avoids derivatives in non-uniform control flow. */
+            lightColor *= textureLod(colorTexture, textureCoordinates.xy / textureCoordinates.w, 0.0);
+        }
+
+        result += lightColor * cone * falloff * falloff * max(dot(normal, lightDirection), 0.0);
+    }
+
+    return result;
+}
+
+/* [Filterable shadow map lookup] */
+/** \brief Get an upper bound of the fraction of the filter footprint which is lit, from the mean and variance of the occluder depth.
+ *
+ *  \param moments         Mean and mean square of the warped occluder depth.
+ *  \param mean            Warped depth of the fragment.
+ *  \param minimumVariance Variance below which depth differences are treated as precision errors.
+ *
+ *  \return As per description.
+ */
+float chebyshevUpperBound(vec2 moments, float mean, float minimumVariance)
+{
+    float variance   = max(moments.y - moments.x * moments.x, minimumVariance);
+    float difference = mean - moments.x;
+    /* Cut off the tail of the bound, which is where light bleeds through overlapping occluders. */
+    float bound      = clamp((variance / (variance + difference * difference) - 0.2) / 0.8, 0.0, 1.0);
+
+    return mean <= moments.x ? 1.0 : bound;
+}
+
+/** \brief Get the visibility of the spot light from a single trilinear lookup of the exponentially warped moments.
+ *
+ *  \param positionInShadowMap Fragment position in shadow map texture space, after the perspective division.
+ *
+ *  \return As per description.
+ */
+float getFilteredShadowVisibility(vec3 positionInShadowMap)
+{
+    float near            = shadowDepthRange.x;
+    float far             = shadowDepthRange.y;
+    float distance        = near * far / (far - positionInShadowMap.z * (far - near));
+    float depth           = 2.0 * (distance - near) / (far - near) - 1.0;
+    vec2  warpedDepth     = vec2(exp(5.0 * depth), -exp(-5.0 * depth));
+    vec2  minimumVariance = 2.5e-5 * warpedDepth * warpedDepth;
+    vec4  moments         = texture(shadowMoments, positionInShadowMap.xy);
+
+    return min(chebyshevUpperBound(moments.xy, warpedDepth.x, minimumVariance.x),
+               chebyshevUpperBound(moments.zw, warpedDepth.y, minimumVariance.y));
+}
+/* [Filterable shadow map lookup] */
+
+void main()
+{
+    /* Only depth is written while rendering the shadow map. */
+    if (!isCameraPointOfView)
+    {
+        color = vec4(0.0);
+
+        return;
+    }
+
+    /* Calculate light factor. */
+    vec4 directionalLighting = calculateLightFactor();
+    /* Position of the vertex translated to texture space. */
+    vec4 vertexPositionInTexture = viewToDepthTextureMatrix * vertexInEyeSpace;
+    /* Normalized position of the vertex translated to texture space. */
+    vec4 normalizedVertexPositionInTexture = normalize(vertexPositionInTexture);
+    /* [Get shadow map depth value] */
+    /* Depth value retrieved from the shadow map. */
+    float shadowMapDepth = textureProj(shadowMap, normalizedVertexPositionInTexture);
+    /* [Get shadow map depth value] */
+    /* [Get model depth value] */
+    /* Depth value retrieved from drawn model. */
+    float modelDepth = normalizedVertexPositionInTexture.z;
+    /* [Get model depth value] */
+    /* Calculate cosine of the angle between current fragment and the light direction. */
+    float fragmentToLightCosValue = getFragmentToLightCosValue();
+
+    /* Calculate colour of a geometry lit by directional light. */
+    color = geometryColor * directionalLighting;
+
+    /* Partially lit fragments are only found with the filtered moments. */
+    float spotLightVisibility = 0.0;
+
+    if (useFilterableShadowMap)
+    {
+        spotLightVisibility = getFilteredShadowVisibility(vertexPositionInTexture.xyz / vertexPositionInTexture.w);
+    }
+    else if (modelDepth < shadowMapDepth + EPSILON)
+    {
+        spotLightVisibility = 1.0;
+    }
+
+    /* [Project texture on a fragment if needed] */
+    /* Apply spot lighting and shadowing if needed). */
+    if ((fragmentToLightCosValue > spotLightCosAngle) && /* If fragment is in spot light cone. */
+         spotLightVisibility > 0.0)
+    {
+        vec4 spotLighting = calculateSpotLight(fragmentToLightCosValue);
+
+        color += spotLighting * spotLightVisibility;
+    }
+    /* [Project texture on a fragment if needed] */
+
+    color += calculateClusteredLights() * geometryColor;
+}
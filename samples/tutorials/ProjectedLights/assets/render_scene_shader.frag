@@ -21,6 +21,7 @@
  */
 
 precision highp float;
+precision highp sampler2D;
 precision highp sampler2DShadow;
 
 /* Value used in float values comparison. */
@@ -36,13 +37,16 @@ uniform float           directionalLightAmbient;        /* Directional light amb
 uniform vec3            directionalLightColor;          /* Directional light colour. */
 uniform vec3            directionalLightPosition;       /* Directional light position. */
 uniform vec4            geometryColor;                  /* Current colour of a geometry to be rendered. */
+uniform vec2            shadowDepthRange;               /* Near and far plane of the spot light projection. */
 uniform sampler2DShadow shadowMap;                      /* Sampler of the depth texture used for shadow-mapping. */
+uniform sampler2D       shadowMoments;                  /* Sampler of the blurred, mipmapped exponential variance moments of the shadow map. */
 uniform vec4            spotLightColor;                 /* Spot light colour. */
 uniform float           spotLightCosAngle;              /* Cosine of the spot light angle. */
 uniform vec4            spotLightLookAtPointInEyeSpace; /* Point coordinates translated into eye-space which spot light is looking at. */
 uniform vec4            spotLightPositionInEyeSpace;    /* Vector of position of spot light source translated into eye-space. */
 uniform mat4            viewToColorTextureMatrix;       /* Matrix we will use in the fragment shader to sample the colour texture for given fragment. */
 uniform mat4            viewToDepthTextureMatrix;       /* Matrix we will use in the fragment shader to sample the shadow map for given fragment. */
+uniform bool            useFilterableShadowMap;         /* If true, the shadow is looked up in shadowMoments rather than compared with shadowMap. */
 
 /* OUTPUTS */
 out vec4 color; /* Output colour variable. */
@@ -121,6 +125,46 @@ vec4 calculateSpotLight(float fragmentToLightCosValue)
 }
 /* [Calculate spot light] */
 
+/* [Filterable shadow map lookup] */
+/** \brief Get an upper bound of the fraction of the filter footprint which is lit, from the mean and variance of the occluder depth.
+ *
+ *  \param moments         Mean and mean square of the warped occluder depth.
+ *  \param mean            Warped depth of the fragment.
+ *  \param minimumVariance Variance below which depth differences are treated as precision errors.
+ *
+ *  \return As per description.
+ */
+float chebyshevUpperBound(vec2 moments, float mean, float minimumVariance)
+{
+    float variance   = max(moments.y - moments.x * moments.x, minimumVariance);
+    float difference = mean - moments.x;
+    /* Cut off the tail of the bound, which is where light bleeds through overlapping occluders. */
+    float bound      = clamp((variance / (variance + difference * difference) - 0.2) / 0.8, 0.0, 1.0);
+
+    return mean <= moments.x ? 1.0 : bound;
+}
+
+/** \brief Get the visibility of the spot light from a single trilinear lookup of the exponentially warped moments.
+ *
+ *  \param positionInShadowMap Fragment position in shadow map texture space, after the perspective division.
+ *
+ *  \return As per description.
+ */
+float getFilteredShadowVisibility(vec3 positionInShadowMap)
+{
+    float near            = shadowDepthRange.x;
+    float far             = shadowDepthRange.y;
+    float distance        = near * far / (far - positionInShadowMap.z * (far - near));
+    float depth           = 2.0 * (distance - near) / (far - near) - 1.0;
+    vec2  warpedDepth     = vec2(exp(5.0 * depth), -exp(-5.0 * depth));
+    vec2  minimumVariance = 2.5e-5 * warpedDepth * warpedDepth;
+    vec4  moments         = texture(shadowMoments, positionInShadowMap.xy);
+
+    return min(chebyshevUpperBound(moments.xy, warpedDepth.x, minimumVariance.x),
+               chebyshevUpperBound(moments.zw, warpedDepth.y, minimumVariance.y));
+}
+/* [Filterable shadow map lookup] */
+
 void main()
 {
     /* Calculate light factor. */
@@ -143,14 +187,26 @@ void main()
     /* Calculate colour of a geometry lit by directional light. */
     color = geometryColor * directionalLighting;
 
+    /* Partially lit fragments are only found with the filtered moments. */
+    float spotLightVisibility = 0.0;
+
+    if (useFilterableShadowMap)
+    {
+        spotLightVisibility = getFilteredShadowVisibility(vertexPositionInTexture.xyz / vertexPositionInTexture.w);
+    }
+    else if (modelDepth < shadowMapDepth + EPSILON)
+    {
+        spotLightVisibility = 1.0;
+    }
+
     /* [Project texture on a fragment if needed] */
     /* Apply spot lighting and shadowing if needed). */
     if ((fragmentToLightCosValue > spotLightCosAngle) && /* If fragment is in spot light cone. */
-         modelDepth < shadowMapDepth + EPSILON)
+         spotLightVisibility > 0.0)
     {
         vec4 spotLighting = calculateSpotLight(fragmentToLightCosValue);
 
-        color += spotLighting;
+        color += spotLighting * spotLightVisibility;
     }
     /* [Project texture on a fragment if needed] */
 }
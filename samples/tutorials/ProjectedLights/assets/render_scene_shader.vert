@@ -36,6 +36,9 @@ uniform mat4 normalMatrix;              /* transpose(inverse(Model * View)) matr
 out vec3 normalInEyeSpace; /* Normal vector for the coordinates. */
 out vec4 vertexInEyeSpace; /* Vertex coordinates expressed in eye space. */
 
+/* The depth pre-pass of DepthPrePass computes the same position, it has to give exactly the same depth. */
+invariant gl_Position;
+
 void main()
 {
     /* Calculate and set output vectors. */
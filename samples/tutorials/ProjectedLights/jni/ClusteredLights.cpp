@@ -0,0 +1,289 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ClusteredLights.h"
+#include "Common.h"
+#include "Mathematics.h"
+#include "Shader.h"
+
+#include <EGL/egl.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace MaliSDK
+{
+    /* Must match the work group size of the cluster shader. */
+    static const int clusterWorkGroupSizeX = CLUSTER_GRID_SIZE_X;
+    static const int clusterWorkGroupSizeY = CLUSTER_GRID_SIZE_Y;
+
+    /* Cone angle [in degrees] of every clustered light. */
+    static const float clusteredLightAngleInDegrees = 30.0f;
+    /* Distance beyond which a clustered light has no effect. Used as the radius of its bounding sphere. */
+    static const float clusteredLightRange = 4.0f;
+    /* Height of the clustered lights above the plane. */
+    static const float clusteredLightHeight = 2.0f;
+    /* Every n-th clustered light projects the colour texture instead of a plain colour. */
+    static const int projectedLightInterval = 4;
+
+    /* Layout of an element of the Lights buffer (std430). */
+    struct LightData
+    {
+        float positionAndRange[4];     /* Eye-space position and the range of the light. */
+        float directionAndCosAngle[4]; /* Eye-space direction and the cosine of the cone angle. */
+        float color[4];                /* Colour of the light, w is 1 for a projected light. */
+        float viewToTextureMatrix[16]; /* Eye space to projected texture space matrix, only used by projected lights. */
+    };
+
+    ClusteredLights::DispatchComputeFunction ClusteredLights::dispatchCompute = NULL;
+    ClusteredLights::MemoryBarrierFunction   ClusteredLights::memoryBarrier   = NULL;
+
+    /* Please see header for specification. */
+    bool ClusteredLights::isSupported()
+    {
+        GLint majorVersion                = 0;
+        GLint minorVersion                = 0;
+        GLint fragmentShaderStorageBlocks = 0;
+
+        GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &majorVersion));
+        GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &minorVersion));
+
+        if (majorVersion < 3 || (majorVersion == 3 && minorVersion < 1))
+        {
+            return false;
+        }
+
+        /* Shader storage blocks are optional in fragment shaders, the scene program needs two. */
+        GL_CHECK(glGetIntegerv(GL_MAX_FRAGMENT_SHADER_STORAGE_BLOCKS, &fragmentShaderStorageBlocks));
+
+        if (fragmentShaderStorageBlocks < 2)
+        {
+            return false;
+        }
+
+        dispatchCompute = (DispatchComputeFunction)eglGetProcAddress("glDispatchCompute");
+        memoryBarrier   = (MemoryBarrierFunction)eglGetProcAddress("glMemoryBarrier");
+
+        return dispatchCompute != NULL && memoryBarrier != NULL;
+    }
+
+    /* Please see header for specification. */
+    ClusteredLights::ClusteredLights(GLuint sceneProgramId, int windowWidth, int windowHeight)
+        : clusterProgramId(0)
+        , sceneProgramId(sceneProgramId)
+        , lightsBufferObjectId(0)
+        , clusterLightListsBufferObjectId(0)
+        , isCameraPointOfViewLocation(-1)
+    {
+        createPrograms();
+        createBuffers();
+        createLights();
+        setConstantUniforms(windowWidth, windowHeight);
+    }
+
+    ClusteredLights::~ClusteredLights()
+    {
+        GLuint buffers[] =
+        {
+            lightsBufferObjectId,
+            clusterLightListsBufferObjectId
+        };
+
+        GL_CHECK(glDeleteBuffers(sizeof(buffers) / sizeof(buffers[0]), buffers));
+        GL_CHECK(glDeleteProgram(clusterProgramId));
+    }
+
+    void ClusteredLights::createPrograms()
+    {
+        GLuint computeShaderId = 0;
+        GLint  linkStatus      = GL_FALSE;
+
+        Shader::processShader(&computeShaderId, CLUSTER_LIGHTS_SHADER_FILE_NAME, GL_COMPUTE_SHADER);
+
+        clusterProgramId = GL_CHECK(glCreateProgram());
+        GL_CHECK(glAttachShader(clusterProgramId, computeShaderId));
+        GL_CHECK(glLinkProgram(clusterProgramId));
+        GL_CHECK(glGetProgramiv(clusterProgramId, GL_LINK_STATUS, &linkStatus));
+        ASSERT(linkStatus == GL_TRUE, "Could not link the cluster program.");
+        GL_CHECK(glDeleteShader(computeShaderId));
+
+        isCameraPointOfViewLocation = GL_CHECK(glGetUniformLocation(sceneProgramId, "isCameraPointOfView"));
+
+        ASSERT(isCameraPointOfViewLocation != -1, "Could not retrieve uniform location: isCameraPointOfView");
+    }
+
+    void ClusteredLights::createBuffers()
+    {
+        const int numberOfClusters = CLUSTER_GRID_SIZE_X * CLUSTER_GRID_SIZE_Y * CLUSTER_GRID_SIZE_Z;
+
+        GL_CHECK(glGenBuffers(1, &lightsBufferObjectId));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightsBufferObjectId));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER,
+                              NUMBER_OF_CLUSTERED_LIGHTS * sizeof(LightData),
+                              NULL,
+                              GL_DYNAMIC_DRAW));
+
+        /* Fixed-size lists let every cluster be written by a single invocation, without atomics or a compaction pass. */
+        GL_CHECK(glGenBuffers(1, &clusterLightListsBufferObjectId));
+        GL_CHECK(glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterLightListsBufferObjectId));
+        GL_CHECK(glBufferData(GL_SHADER_STORAGE_BUFFER,
+                              numberOfClusters * (MAXIMUM_LIGHTS_PER_CLUSTER + 1) * sizeof(GLuint),
+                              NULL,
+                              GL_DYNAMIC_COPY));
+    }
+
+    void ClusteredLights::createLights()
+    {
+        for (int lightIndex = 0; lightIndex < NUMBER_OF_CLUSTERED_LIGHTS; lightIndex++)
+        {
+            const float direction = (rand() % 2 == 0) ? 1.0f : -1.0f;
+
+            /* Lights orbit the center of the plane, not further than its edge. */
+            animations[lightIndex].orbitRadius = 1.0f + (PLANE_SCALING_FACTOR - 1.0f) * (float)rand() / (float)RAND_MAX;
+            animations[lightIndex].orbitPhase  = 2.0f * M_PI * (float)rand() / (float)RAND_MAX;
+            animations[lightIndex].orbitSpeed  = direction * (0.2f + 0.6f * (float)rand() / (float)RAND_MAX);
+            animations[lightIndex].height      = MODEL_Y_POSITION - CUBE_SCALING_FACTOR + clusteredLightHeight;
+
+            colors[lightIndex].x = 0.2f + 0.8f * (float)rand() / (float)RAND_MAX;
+            colors[lightIndex].y = 0.2f + 0.8f * (float)rand() / (float)RAND_MAX;
+            colors[lightIndex].z = 0.2f + 0.8f * (float)rand() / (float)RAND_MAX;
+            colors[lightIndex].w = (lightIndex % projectedLightInterval == 0) ? 1.0f : 0.0f;
+        }
+    }
+
+    void ClusteredLights::setConstantUniforms(int windowWidth, int windowHeight)
+    {
+        const float tangentOfHalfFieldOfView = tanf(degreesToRadians(CAMERA_PERSPECTIVE_FOV_IN_DEGREES) / 2.0f);
+        const float aspectRatio              = float(windowWidth) / float(windowHeight);
+        /* Slices are distributed exponentially: slice = log(depth / near) * CLUSTER_GRID_SIZE_Z / log(far / near). */
+        const float depthScale               = float(CLUSTER_GRID_SIZE_Z) / logf(FAR_PLANE / NEAR_PLANE);
+        const float depthBias                = -logf(NEAR_PLANE) * depthScale;
+
+        GLint numberOfLightsLocation     = GL_CHECK(glGetUniformLocation(clusterProgramId, "numberOfLights"));
+        GLint tanHalfFieldOfViewLocation = GL_CHECK(glGetUniformLocation(clusterProgramId, "tanHalfFieldOfView"));
+        GLint nearPlaneLocation          = GL_CHECK(glGetUniformLocation(clusterProgramId, "nearPlane"));
+        GLint farPlaneLocation           = GL_CHECK(glGetUniformLocation(clusterProgramId, "farPlane"));
+        GLint clusterTileSizeLocation    = GL_CHECK(glGetUniformLocation(sceneProgramId,   "clusterTileSize"));
+        GLint clusterDepthScaleLocation  = GL_CHECK(glGetUniformLocation(sceneProgramId,   "clusterDepthScale"));
+        GLint clusterDepthBiasLocation   = GL_CHECK(glGetUniformLocation(sceneProgramId,   "clusterDepthBias"));
+
+        ASSERT(numberOfLightsLocation     != -1 &&
+               tanHalfFieldOfViewLocation != -1 &&
+               nearPlaneLocation          != -1 &&
+               farPlaneLocation           != -1 &&
+               clusterTileSizeLocation    != -1 &&
+               clusterDepthScaleLocation  != -1 &&
+               clusterDepthBiasLocation   != -1,
+               "At least one of the clustered lighting uniform locations retrieved is not valid.");
+
+        GL_CHECK(glUseProgram(clusterProgramId));
+        GL_CHECK(glUniform1ui(numberOfLightsLocation,     NUMBER_OF_CLUSTERED_LIGHTS));
+        GL_CHECK(glUniform2f (tanHalfFieldOfViewLocation, tangentOfHalfFieldOfView * aspectRatio, tangentOfHalfFieldOfView));
+        GL_CHECK(glUniform1f (nearPlaneLocation,          NEAR_PLANE));
+        GL_CHECK(glUniform1f (farPlaneLocation,           FAR_PLANE));
+
+        GL_CHECK(glUseProgram(sceneProgramId));
+        GL_CHECK(glUniform2f (clusterTileSizeLocation,    float(windowWidth) / float(CLUSTER_GRID_SIZE_X), float(windowHeight) / float(CLUSTER_GRID_SIZE_Y)));
+        GL_CHECK(glUniform1f (clusterDepthScaleLocation,  depthScale));
+        GL_CHECK(glUniform1f (clusterDepthBiasLocation,   depthBias));
+    }
+
+    /* Please see header for specification. */
+    void ClusteredLights::update(float time, const Matrix &viewMatrix)
+    {
+        LightData lights[NUMBER_OF_CLUSTERED_LIGHTS];
+        Matrix    cameraViewMatrix        = viewMatrix;
+        Matrix    inverseCameraViewMatrix = Matrix::matrixInvert(&cameraViewMatrix);
+        /* The light cone is the field of view of the projected texture. */
+        Matrix    projectionMatrix        = Matrix::matrixPerspective(degreesToRadians(2.0f * clusteredLightAngleInDegrees), 1.0f, 0.1f, clusteredLightRange);
+        Vec3f     origin                  = {0.0f,  0.0f,  0.0f};
+        Vec3f     downVector              = {0.0f, -1.0f,  0.0f};
+        Vec3f     upVector                = {0.0f,  0.0f, -1.0f};
+        /* All lights point straight down, they only differ by translation. */
+        Matrix    lightRotationMatrix     = Matrix::matrixLookAt(origin, downVector, upVector);
+
+        /* The loop runs for every light each frame, so its maths uses the inline VectorMath.h types. */
+        const math::mat4 cameraView             = cameraViewMatrix.getAsMat4();
+        const math::mat4 inverseCameraView      = inverseCameraViewMatrix.getAsMat4();
+        const math::mat4 lightToTexture         = (Matrix::biasMatrix * projectionMatrix * lightRotationMatrix).getAsMat4();
+        const math::vec4 directionInEyeSpace    = cameraView * math::vec4{0.0f, -1.0f, 0.0f, 0.0f};
+        const float      cosClusteredLightAngle = cosf(degreesToRadians(clusteredLightAngleInDegrees));
+
+        for (int lightIndex = 0; lightIndex < NUMBER_OF_CLUSTERED_LIGHTS; lightIndex++)
+        {
+            const LightAnimation& animation          = animations[lightIndex];
+            const float           angle              = animation.orbitPhase + animation.orbitSpeed * time;
+            const math::vec4      position           = {animation.orbitRadius * cosf(angle), animation.height, animation.orbitRadius * sinf(angle), 1.0f};
+            const math::vec4      positionInEyeSpace = cameraView * position;
+            LightData&            light              = lights[lightIndex];
+
+            light.positionAndRange[0]     = positionInEyeSpace.x;
+            light.positionAndRange[1]     = positionInEyeSpace.y;
+            light.positionAndRange[2]     = positionInEyeSpace.z;
+            light.positionAndRange[3]     = clusteredLightRange;
+            light.directionAndCosAngle[0] = directionInEyeSpace.x;
+            light.directionAndCosAngle[1] = directionInEyeSpace.y;
+            light.directionAndCosAngle[2] = directionInEyeSpace.z;
+            light.directionAndCosAngle[3] = cosClusteredLightAngle;
+            light.color[0]                = colors[lightIndex].x;
+            light.color[1]                = colors[lightIndex].y;
+            light.color[2]                = colors[lightIndex].z;
+            light.color[3]                = colors[lightIndex].w;
+
+            if (colors[lightIndex].w > 0.0f)
+            {
+                /* Translating by -position first only changes the last column of the light to texture matrix. */
+                math::mat4 worldToTexture = lightToTexture;
+
+                worldToTexture[3] = lightToTexture * math::vec4{-position.x, -position.y, -position.z, 1.0f};
+
+                math::mat4 viewToTextureMatrix = worldToTexture * inverseCameraView;
+
+                memcpy(light.viewToTextureMatrix, viewToTextureMatrix.data(), sizeof(light.viewToTextureMatrix));
+            }
+            else
+            {
+                memset(light.viewToTextureMatrix, 0, sizeof(light.viewToTextureMatrix));
+            }
+        }
+
+        GL_CHECK(glBindBuffer   (GL_SHADER_STORAGE_BUFFER, lightsBufferObjectId));
+        GL_CHECK(glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(lights), lights));
+
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightsBufferObjectId));
+        GL_CHECK(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, clusterLightListsBufferObjectId));
+
+        /* One invocation per cluster, one work group per depth slice. */
+        GL_CHECK(glUseProgram(clusterProgramId));
+        GL_CHECK(dispatchCompute(CLUSTER_GRID_SIZE_X / clusterWorkGroupSizeX,
+                                 CLUSTER_GRID_SIZE_Y / clusterWorkGroupSizeY,
+                                 CLUSTER_GRID_SIZE_Z));
+
+        /* The light lists are read by the fragment shader of the scene program. */
+        GL_CHECK(memoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+        GL_CHECK(glUseProgram(sceneProgramId));
+    }
+
+    /* Please see header for specification. */
+    void ClusteredLights::setCameraPointOfView(bool isCameraPointOfView)
+    {
+        GL_CHECK(glUniform1i(isCameraPointOfViewLocation, isCameraPointOfView));
+    }
+}
@@ -0,0 +1,125 @@
+/* Copyright (c) 2017, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <GLES3/gl31.h>
+#include "Matrix.h"
+#include "ProjectedLights.h"
+#include "VectorTypes.h"
+
+namespace MaliSDK
+{
+    /**
+     * \brief Clustered forward shading of a large number of small spot and projected lights.
+     *
+     * The view frustum is divided into CLUSTER_GRID_SIZE_X x CLUSTER_GRID_SIZE_Y screen tiles and CLUSTER_GRID_SIZE_Z
+     * exponentially distributed depth slices. Every frame a compute shader tests the bounding sphere of each light
+     * against the bounds of each cluster and writes the indices of up to MAXIMUM_LIGHTS_PER_CLUSTER lights into the
+     * list of the cluster. The fragment shader then only loops over the list of the cluster it falls into.
+     *
+     * \note Requires OpenGL ES 3.1 with shader storage blocks in fragment shaders. The entry points are fetched at
+     *       run time so the tutorial still runs on OpenGL ES 3.0.
+     */
+    class ClusteredLights
+    {
+    private:
+        typedef void (GL_APIENTRYP DispatchComputeFunction)(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ);
+        typedef void (GL_APIENTRYP MemoryBarrierFunction)(GLbitfield barriers);
+
+        static DispatchComputeFunction dispatchCompute;
+        static MemoryBarrierFunction   memoryBarrier;
+
+        /* Animation parameters of a light. */
+        struct LightAnimation
+        {
+            float orbitRadius;
+            float orbitPhase;
+            float orbitSpeed;
+            float height;
+        };
+
+        /* Program building the light list of every cluster. */
+        GLuint clusterProgramId;
+        /* Program rendering the scene, its uniforms used by clustered lighting are set by this class. */
+        GLuint sceneProgramId;
+
+        /* Eye-space light parameters, rewritten every frame. */
+        GLuint lightsBufferObjectId;
+        /* Light count followed by MAXIMUM_LIGHTS_PER_CLUSTER light indices for every cluster. */
+        GLuint clusterLightListsBufferObjectId;
+
+        GLint isCameraPointOfViewLocation;
+
+        LightAnimation animations[NUMBER_OF_CLUSTERED_LIGHTS];
+        Vec4f          colors[NUMBER_OF_CLUSTERED_LIGHTS];
+
+        void createPrograms();
+        void createBuffers();
+        void createLights();
+        void setConstantUniforms(int windowWidth, int windowHeight);
+
+        /* Forbid copying; the object owns GL names. */
+        ClusteredLights(const ClusteredLights &);
+        ClusteredLights &operator=(const ClusteredLights &);
+
+    public:
+        /**
+         * \brief Check the current context supports compute shaders and shader storage blocks in fragment shaders.
+         *
+         * \note Must be called with a current context, before creating an instance of the class.
+         *
+         * \return True if clustered lighting can be used.
+         */
+        static bool isSupported();
+
+        /**
+         * \brief Create the cluster program, light buffers and lights.
+         *
+         * \param sceneProgramId Program object rendering the scene, linked with CLUSTERED_FRAGMENT_SHADER_FILE_NAME.
+         * \param windowWidth    Window width.
+         * \param windowHeight   Window height.
+         */
+        ClusteredLights(GLuint sceneProgramId, int windowWidth, int windowHeight);
+
+        ~ClusteredLights();
+
+        /**
+         * \brief Animate the lights and build the light list of every cluster.
+         *
+         * The buffers are left bound to their shader storage binding points for the scene program.
+         *
+         * \param time       Time in seconds used for setting positions of the lights.
+         * \param viewMatrix View matrix of the camera.
+         */
+        void update(float time, const Matrix &viewMatrix);
+
+        /**
+         * \brief Enable or disable the shading of the scene program.
+         *
+         * \note The scene program must be in use.
+         *
+         * \param isCameraPointOfView False when only depth is rendered (for the shadow map), so the clustered lights are not shaded.
+         */
+        void setCameraPointOfView(bool isCameraPointOfView);
+    };
+}
+#endif /* CLUSTERED_LIGHTS_H */
@@ -37,14 +37,23 @@
  *            c. A spot light effect is implemented, however it is adjusted to display texture rather than
  *               a simple colour.
  *            d. Shadows are computed for the spot lighting (the result of the first step is now used).
+ *            e. Where half float targets are renderable, the shadow map is converted into blurred, mipmapped
+ *               exponential variance moments (see FilterableShadowMap.h), so the shadow edges are soft
+ *               and filtered by the hardware with a single lookup.
+ *            f. On OpenGL ES 3.1 devices, a few hundred small spot lights are added with clustered forward
+ *               shading: a compute shader assigns the lights to a grid of view-space clusters and each
+ *               fragment only evaluates the lights listed for its cluster (see ClusteredLights.h).
  */
 
 #include <jni.h>
 #include <android/log.h>
 
 #include <GLES3/gl3.h>
+#include "ClusteredLights.h"
 #include "Common.h"
 #include "CubeModel.h"
+#include "DepthPrePass.h"
+#include "FilterableShadowMap.h"
 #include "Mathematics.h"
 #include "Matrix.h"
 #include "PlaneModel.h"
@@ -66,6 +75,13 @@ using namespace MaliSDK;
  */
 static void drawCubeAndPlane(bool isCameraPointOfView);
 
+/**
+ * \brief Draw the positions of the cube and the plane from the camera point of view, for the depth pre-pass.
+ *
+ * DepthPrePass has bound its own program, which only needs the model-view-projection matrices.
+ */
+static void drawCubeAndPlanePositions();
+
 /**
  * \brief Generate a colour texture object and fill it with data.
  *
@@ -158,6 +174,9 @@ SpotLightProperties         spotLightProperties;
 Timer                       timer;
 GLsizei                     windowHeight;
 GLsizei                     windowWidth;
+ClusteredLights*            clusteredLights = NULL;
+DepthPrePass*               depthPrePass = NULL;
+FilterableShadowMap*        filterableShadowMap = NULL;
 
 /* Please see the specification above. */
 static void drawCubeAndPlane(bool isCameraPointOfView)
@@ -275,6 +294,22 @@ static void drawCubeAndPlane(bool isCameraPointOfView)
     }
 }
 
+/* Please see the specification above. */
+static void drawCubeAndPlanePositions()
+{
+    depthPrePass->setModelViewProjection(cameraViewProperties.cubeViewProperties.modelViewProjectionMatrix.getAsArray());
+    GL_CHECK(glBindVertexArray(renderSceneObjects.renderCube.positionsVertexArrayObjectId));
+    GL_CHECK(glDrawArrays(GL_TRIANGLES,
+                          0,
+                          cubeGeometryProperties.numberOfElementsInCoordinatesArray / NUMBER_OF_POINT_COORDINATES));
+
+    depthPrePass->setModelViewProjection(cameraViewProperties.planeViewProperties.modelViewProjectionMatrix.getAsArray());
+    GL_CHECK(glBindVertexArray(renderSceneObjects.renderPlane.positionsVertexArrayObjectId));
+    GL_CHECK(glDrawArrays(GL_TRIANGLES,
+                          0,
+                          planeGeometryProperties.numberOfElementsInCoordinatesArray / NUMBER_OF_POINT_COORDINATES));
+}
+
 /* Please see the specification above. */
 static void generateAndPrepareColorTextureObject()
 {
@@ -423,12 +458,15 @@ static void getRenderSceneProgramLocations(GLuint                       programO
     /* [Get depth texture uniform location] */
     locationsStoragePtr->uniformShadowMap                      = GL_CHECK(glGetUniformLocation  (programObjectId, "shadowMap"));
     /* [Get depth texture uniform location] */
+    locationsStoragePtr->uniformShadowDepthRange               = GL_CHECK(glGetUniformLocation  (programObjectId, "shadowDepthRange"));
+    locationsStoragePtr->uniformShadowMoments                  = GL_CHECK(glGetUniformLocation  (programObjectId, "shadowMoments"));
     locationsStoragePtr->uniformSpotLightColor                 = GL_CHECK(glGetUniformLocation  (programObjectId, "spotLightColor"));
     locationsStoragePtr->uniformSpotLightCosAngle              = GL_CHECK(glGetUniformLocation  (programObjectId, "spotLightCosAngle"));
     locationsStoragePtr->uniformSpotLightLookAtPointInEyeSpace = GL_CHECK(glGetUniformLocation  (programObjectId, "spotLightLookAtPointInEyeSpace"));
     locationsStoragePtr->uniformSpotLightPositionInEyeSpace    = GL_CHECK(glGetUniformLocation  (programObjectId, "spotLightPositionInEyeSpace"));
     locationsStoragePtr->uniformViewToColorTextureMatrix       = GL_CHECK(glGetUniformLocation  (programObjectId, "viewToColorTextureMatrix"));
     locationsStoragePtr->uniformViewToDepthTextureMatrix       = GL_CHECK(glGetUniformLocation  (programObjectId, "viewToDepthTextureMatrix"));
+    locationsStoragePtr->uniformUseFilterableShadowMap         = GL_CHECK(glGetUniformLocation  (programObjectId, "useFilterableShadowMap"));
 
     /* Make sure that the data retrieved is valid. */
     ASSERT(locationsStoragePtr->attributeVertexCoordinates            != -1 &&
@@ -441,13 +479,16 @@ static void getRenderSceneProgramLocations(GLuint                       programO
            locationsStoragePtr->uniformModelViewMatrix                != -1 &&
            locationsStoragePtr->uniformModelViewProjectionMatrix      != -1 &&
            locationsStoragePtr->uniformNormalMatrix                   != -1 &&
+           locationsStoragePtr->uniformShadowDepthRange               != -1 &&
            locationsStoragePtr->uniformShadowMap                      != -1 &&
+           locationsStoragePtr->uniformShadowMoments                  != -1 &&
            locationsStoragePtr->uniformSpotLightColor                 != -1 &&
            locationsStoragePtr->uniformSpotLightCosAngle              != -1 &&
            locationsStoragePtr->uniformSpotLightLookAtPointInEyeSpace != -1 &&
            locationsStoragePtr->uniformSpotLightPositionInEyeSpace    != -1 &&
            locationsStoragePtr->uniformViewToColorTextureMatrix       != -1 &&
-           locationsStoragePtr->uniformViewToDepthTextureMatrix       != -1,
+           locationsStoragePtr->uniformViewToDepthTextureMatrix       != -1 &&
+           locationsStoragePtr->uniformUseFilterableShadowMap         != -1,
            "At least one of uniform/attribute locations retrieved is not valid. The uniform/attribute seems to be inactive.");
 }
 
@@ -568,6 +609,12 @@ static void renderFrame()
     /* Spot light direction is changing during the rendering process: update it now. */
     updateSpotLightDirection();
 
+    /* Assign the small lights to the clusters of the current view. */
+    if (clusteredLights != NULL)
+    {
+        clusteredLights->update(timer.getTime(), cameraViewProperties.viewMatrix);
+    }
+
     /* Clear the contents of back buffer. */
     GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
@@ -615,29 +662,74 @@ static void renderFrame()
         /* [Set colour mask for shadow map rendering] */
 
         /* [Draw the scene from spot light point of view] */
+        if (clusteredLights != NULL)
+        {
+            clusteredLights->setCameraPointOfView(false);
+        }
+
         drawCubeAndPlane(false);
         /* [Draw the scene from spot light point of view] */
+
+        /* Blur the moments of the new depth values. This changes the program and the texture bound to unit 0, restore them. */
+        if (filterableShadowMap != NULL)
+        {
+            filterableShadowMap->update(renderSceneObjects.depthTextureObjectId);
+
+            GL_CHECK(glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_FOR_COLOR_TEXTURE));
+            GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
+                                     renderSceneObjects.colorTextureObjectId));
+            GL_CHECK(glUseProgram   (renderSceneProgramAndShadersIds.programObjectId));
+            GL_CHECK(glEnable       (GL_DEPTH_TEST));
+        }
     } /* 1. */
 
     /* 2. Draw a scene with lights and shadows from eye point of view. */
     {
+        GL_CHECK(glDisable(GL_CULL_FACE));
+        GL_CHECK(glDisable(GL_POLYGON_OFFSET_FILL));
+
+        /* Measure the overdraw now and then, before the default framebuffer is started. */
+        bool useDepthPrePass = depthPrePass->beginFrame();
+
+        if (depthPrePass->beginMeasurement())
+        {
+            drawCubeAndPlanePositions();
+            depthPrePass->endMeasurement();
+        }
+
         /* Use the default framebuffer object: scene will be rendered on a screen. */
         GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
 
-        /* Clear the depth and colour buffers. */
-        GL_CHECK(glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT));
-
         /* Set the view port to the size of the window. */
         GL_CHECK(glViewport(0, 0, windowWidth, windowHeight));
 
-        GL_CHECK(glDisable(GL_CULL_FACE));
-        GL_CHECK(glDisable(GL_POLYGON_OFFSET_FILL));
-
         /* Enable writing of each frame buffer colour component. */
         GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
 
+        /* Clear the depth and colour buffers. */
+        GL_CHECK(glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT));
+
+        /* Lay down the depth first, so the spot light and the clustered lights are only shaded for visible fragments. */
+        if (useDepthPrePass)
+        {
+            depthPrePass->beginDepthPass();
+            drawCubeAndPlanePositions();
+            depthPrePass->beginShadingPass();
+        }
+
+        /* The measurement and the pre-pass use programs of their own. */
+        GL_CHECK(glUseProgram(renderSceneProgramAndShadersIds.programObjectId));
+
         /* Draw the scene from camera point of view. */
+        if (clusteredLights != NULL)
+        {
+            clusteredLights->setCameraPointOfView(true);
+        }
+
         drawCubeAndPlane(true);
+
+        /* Restores the depth state, and drops the depth buffer, which is not needed after the frame. */
+        depthPrePass->endFrame();
     } /* 2. */
 }
 
@@ -760,10 +852,24 @@ static void setupGraphics(int width, int height)
     GL_CHECK(glGenVertexArrays(1, &renderSceneObjects.renderPlane.vertexArrayObjectId));
     /* [Generate objects for rendering the geometry] */
 
-    /* Initialize program object responsible for rendering the scene. */
-    initializeProgramObject(&renderSceneProgramAndShadersIds,
-                            FRAGMENT_SHADER_FILE_NAME,
-                            VERTEX_SHADER_FILE_NAME);
+    /* Initialize program object responsible for rendering the scene.
+     * The clustered variant of the shaders also adds the small lights, but needs OpenGL ES 3.1. */
+    bool isClusteringSupported = ClusteredLights::isSupported();
+
+    if (isClusteringSupported)
+    {
+        initializeProgramObject(&renderSceneProgramAndShadersIds,
+                                CLUSTERED_FRAGMENT_SHADER_FILE_NAME,
+                                CLUSTERED_VERTEX_SHADER_FILE_NAME);
+    }
+    else
+    {
+        LOGI("OpenGL ES 3.1 is not supported: clustered lights are disabled.\n");
+
+        initializeProgramObject(&renderSceneProgramAndShadersIds,
+                                FRAGMENT_SHADER_FILE_NAME,
+                                VERTEX_SHADER_FILE_NAME);
+    }
 
     /* Initialize OpenGLES objects. */
     generateAndPrepareColorTextureObject();
@@ -776,6 +882,14 @@ static void setupGraphics(int width, int height)
     getRenderSceneProgramLocations(renderSceneProgramAndShadersIds.programObjectId,
                                   &renderSceneProgramLocations);
 
+    /* Create the small lights and the cluster grid. Leaves the scene program active. */
+    if (isClusteringSupported)
+    {
+        delete clusteredLights;
+
+        clusteredLights = new ClusteredLights(renderSceneProgramAndShadersIds.programObjectId, windowWidth, windowHeight);
+    }
+
     /* Set the uniform data which is constant during the rendering process. */
     /* [Set texture object for colour texture sampler] */
     GL_CHECK(glUniform1i       (renderSceneProgramLocations.uniformColorTexture,
@@ -798,6 +912,31 @@ static void setupGraphics(int width, int height)
     GL_CHECK(glUniform4fv      (renderSceneProgramLocations.uniformSpotLightColor,
                                 1,
                                 (GLfloat*)&spotLightProperties.color));
+    GL_CHECK(glUniform1i       (renderSceneProgramLocations.uniformShadowMoments,
+                                TEXTURE_UNIT_FOR_SHADOW_MOMENTS_TEXTURE));
+    GL_CHECK(glUniform2f       (renderSceneProgramLocations.uniformShadowDepthRange,
+                                NEAR_PLANE,
+                                FAR_PLANE));
+
+    /* The moments are a third of the resolution of the depth texture in each direction, the size of the window. */
+    if (USE_FILTERABLE_SHADOW_MAP && FilterableShadowMap::isSupported())
+    {
+        delete filterableShadowMap;
+
+        filterableShadowMap = new FilterableShadowMap(shadowMapWidth / 3, shadowMapHeight / 3, NEAR_PLANE, FAR_PLANE);
+
+        GL_CHECK(glUseProgram   (renderSceneProgramAndShadersIds.programObjectId));
+        GL_CHECK(glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_FOR_SHADOW_MOMENTS_TEXTURE));
+        GL_CHECK(glBindTexture  (GL_TEXTURE_2D,
+                                 filterableShadowMap->getTexture()));
+    }
+    else if (USE_FILTERABLE_SHADOW_MAP)
+    {
+        LOGI("Half float render targets are not supported: the shadow map is compared without filtering.\n");
+    }
+
+    GL_CHECK(glUniform1i       (renderSceneProgramLocations.uniformUseFilterableShadowMap,
+                                filterableShadowMap != NULL));
 
     /* [Set up Vertex Attrib Arrays] */
     /* Enable cube VAAs. */
@@ -866,11 +1005,40 @@ static void setupGraphics(int width, int height)
     /* Enable depth test to do comparison of depth values. */
     GL_CHECK(glEnable(GL_DEPTH_TEST));
     /* [Enable depth test] */
+
+    /* The depth pre-pass reads the coordinates buffers alone. */
+    delete depthPrePass;
+
+    depthPrePass = new DepthPrePass(windowWidth, windowHeight, DEPTH_PRE_PASS_MODE, DEPTH_PRE_PASS_OVERDRAW_THRESHOLD);
+
+    renderSceneObjects.renderCube.positionsVertexArrayObjectId  = DepthPrePass::createVertexArray(renderSceneObjects.renderCube.coordinatesBufferObjectId,
+                                                                                                  NUMBER_OF_POINT_COORDINATES,
+                                                                                                  GL_FLOAT,
+                                                                                                  0,
+                                                                                                  0);
+    renderSceneObjects.renderPlane.positionsVertexArrayObjectId = DepthPrePass::createVertexArray(renderSceneObjects.renderPlane.coordinatesBufferObjectId,
+                                                                                                  NUMBER_OF_POINT_COORDINATES,
+                                                                                                  GL_FLOAT,
+                                                                                                  0,
+                                                                                                  0);
 }
 
 /* Please see the specification above. */
 static void uninit()
 {
+    /* Release the clustered lights objects while the context is still current. */
+    delete clusteredLights;
+
+    clusteredLights = NULL;
+
+    delete filterableShadowMap;
+
+    filterableShadowMap = NULL;
+
+    delete depthPrePass;
+
+    depthPrePass = NULL;
+
     /* Use default program object. */
     GL_CHECK(glUseProgram(0));
     /* Bind default objects. */
@@ -894,6 +1062,8 @@ static void uninit()
     /* Delete vertex arrays. */
     GL_CHECK(glDeleteVertexArrays(1, &renderSceneObjects.renderCube.vertexArrayObjectId));
     GL_CHECK(glDeleteVertexArrays(1, &renderSceneObjects.renderPlane.vertexArrayObjectId));
+    GL_CHECK(glDeleteVertexArrays(1, &renderSceneObjects.renderCube.positionsVertexArrayObjectId));
+    GL_CHECK(glDeleteVertexArrays(1, &renderSceneObjects.renderPlane.positionsVertexArrayObjectId));
 
     /* Delete program and shader objects. */
     GL_CHECK(glDeleteShader (renderSceneProgramAndShadersIds.fragmentShaderObjectId));
@@ -29,6 +29,18 @@ namespace MaliSDK
 {
     /** Field of view used for projection matrix calculations [in degrees] from camera point of view. */
     #define CAMERA_PERSPECTIVE_FOV_IN_DEGREES (60.0f)
+    /** Number of view-space clusters along the X axis of the screen. */
+    #define CLUSTER_GRID_SIZE_X (16)
+    /** Number of view-space clusters along the Y axis of the screen. */
+    #define CLUSTER_GRID_SIZE_Y (8)
+    /** Number of view-space clusters between the near and the far plane. Clusters are distributed exponentially in depth. */
+    #define CLUSTER_GRID_SIZE_Z (24)
+    /** Name of a compute shader file building the per-cluster light lists. */
+    #define CLUSTER_LIGHTS_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.projectedLights/files/cluster_lights_shader.comp")
+    /** Name of a fragment shader file used instead of FRAGMENT_SHADER_FILE_NAME when clustered lighting is supported. */
+    #define CLUSTERED_FRAGMENT_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.projectedLights/files/render_scene_clustered_shader.frag")
+    /** Name of a vertex shader file used instead of VERTEX_SHADER_FILE_NAME when clustered lighting is supported. */
+    #define CLUSTERED_VERTEX_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.projectedLights/files/render_scene_clustered_shader.vert")
     /** Name of a bmp file where colour texture image is stored. */
     #define COLOR_TEXTURE_NAME ("/data/data/com.arm.malideveloper.openglessdk.projectedLights/files/mali.bmp")
     /** Define a translation in x and Z space of a colour texture. */
@@ -37,6 +49,14 @@ namespace MaliSDK
     #define CUBE_SCALING_FACTOR (2.0f)
     /** Field of view used for projection matrix calculations [in degrees] from light point of view. */
     #define LIGHT_PERSPECTIVE_FOV_IN_DEGREES (90.0f)
+    /** Maximum number of lights shaded by a fragment. Bounds the per-fragment cost of clustered lighting. */
+    #define MAXIMUM_LIGHTS_PER_CLUSTER (32)
+    #ifndef DEPTH_PRE_PASS_MODE
+        /** When the depth of the scene is drawn before it is shaded: DepthPrePass::MODE_OFF, MODE_ON, or MODE_AUTOMATIC to decide from the measured overdraw. */
+        #define DEPTH_PRE_PASS_MODE (DepthPrePass::MODE_AUTOMATIC)
+    #endif /* DEPTH_PRE_PASS_MODE */
+    /** Average number of fragments per covered pixel above which the automatic mode turns the depth pre-pass on. */
+    #define DEPTH_PRE_PASS_OVERDRAW_THRESHOLD (2.0f)
     /** Value of the far plane used to set-up a projection view. */
     #define FAR_PLANE (50.0f)
     /** Name of a fragment shader file. */
@@ -49,6 +69,8 @@ namespace MaliSDK
     #define MODEL_Y_ROTATION_ANGLE_IN_DEGREES (60.0f)
     /** Value of the near plane used to set-up a projection view. */
     #define NEAR_PLANE (1.0f)
+    /** Number of small spot lights shaded with clustered lighting, in addition to the shadowed projected light. */
+    #define NUMBER_OF_CLUSTERED_LIGHTS (256)
     /** Scaling factor used to set-up a plane geometry (indicates the size of the plane). */
     #define PLANE_SCALING_FACTOR (10.0f)
     /** Value of the projected light angle (in degrees) */
@@ -59,6 +81,12 @@ namespace MaliSDK
     #define TEXTURE_UNIT_FOR_COLOR_TEXTURE (0)
     /** Texture unit that will be used for shadow map texture binding purposes.*/
     #define TEXTURE_UNIT_FOR_SHADOW_MAP_TEXTURE (1)
+    /** Texture unit that will be used for the filtered moments of the shadow map.*/
+    #define TEXTURE_UNIT_FOR_SHADOW_MOMENTS_TEXTURE (2)
+    #ifndef USE_FILTERABLE_SHADOW_MAP
+        /** If 1, the spot light shadow is looked up in blurred, mipmapped moments of the shadow map where half float targets are renderable. If 0, the depth is always compared. */
+        #define USE_FILTERABLE_SHADOW_MAP (1)
+    #endif /* USE_FILTERABLE_SHADOW_MAP */
     /** Name of a vertex shader file. */
     #define VERTEX_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.projectedLights/files/render_scene_shader.vert")
 
@@ -102,13 +130,15 @@ namespace MaliSDK
     {
         GLuint coordinatesBufferObjectId;
         GLuint normalsBufferObjectId;
+        GLuint positionsVertexArrayObjectId; /* Reads the coordinates alone, for the depth pre-pass. */
         GLuint vertexArrayObjectId;
 
         RenderGeometryObjects()
         {
-            coordinatesBufferObjectId = 0;
-            normalsBufferObjectId     = 0;
-            vertexArrayObjectId       = 0;
+            coordinatesBufferObjectId    = 0;
+            normalsBufferObjectId        = 0;
+            positionsVertexArrayObjectId = 0;
+            vertexArrayObjectId          = 0;
         }
     };
 
@@ -143,13 +173,16 @@ namespace MaliSDK
         GLint uniformModelViewMatrix;
         GLint uniformModelViewProjectionMatrix;
         GLint uniformNormalMatrix;
+        GLint uniformShadowDepthRange;
         GLint uniformShadowMap;
+        GLint uniformShadowMoments;
         GLint uniformSpotLightColor;
         GLint uniformSpotLightCosAngle;
         GLint uniformSpotLightLookAtPointInEyeSpace;
         GLint uniformSpotLightPositionInEyeSpace;
         GLint uniformViewToColorTextureMatrix;
         GLint uniformViewToDepthTextureMatrix;
+        GLint uniformUseFilterableShadowMap;
 
         RenderSceneProgramLocations()
         {
@@ -163,13 +196,16 @@ namespace MaliSDK
             uniformModelViewMatrix                = -1;
             uniformModelViewProjectionMatrix      = -1;
             uniformNormalMatrix                   = -1;
+            uniformShadowDepthRange               = -1;
             uniformShadowMap                      = -1;
+            uniformShadowMoments                  = -1;
             uniformSpotLightColor                 = -1;
             uniformSpotLightCosAngle              = -1;
             uniformSpotLightLookAtPointInEyeSpace = -1;
             uniformSpotLightPositionInEyeSpace    = -1;
             uniformViewToColorTextureMatrix       = -1;
             uniformViewToDepthTextureMatrix       = -1;
+            uniformUseFilterableShadowMap         = -1;
         }
     };
 
@@ -48,6 +48,9 @@ public class ProjectedLights extends Activity
         extractAsset("mali.bmp");
         extractAsset("render_scene_shader.frag");
         extractAsset("render_scene_shader.vert");
+        extractAsset("cluster_lights_shader.comp");
+        extractAsset("render_scene_clustered_shader.frag");
+        extractAsset("render_scene_clustered_shader.vert");
 
         /* [onCreateNew] */
         setContentView(tutorialView);
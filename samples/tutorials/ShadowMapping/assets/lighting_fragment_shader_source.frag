@@ -22,17 +22,34 @@
 
 /* [Fragment shader code] */
 precision highp float;
+precision highp sampler2D;
 precision highp sampler2DShadow;
+precision highp sampler2DArrayShadow;
+
+/* Maximum number of cascades of the directional light shadow map. */
+#define maximumNumberOfCascades 4
 
 in vec4 outputLightPosition;       /* Vector of the spot light position translated into eye-space. */
 in vec3 outputNormal;              /* Normal vector for the coordinates. */
 in vec4 outputPosition;            /* Vertex coordinates expressed in eye space. */
 in mat4 outputViewToTextureMatrix; /* Matrix we will use in the fragment shader to sample the shadow map for given fragment. */
+in vec3 outputWorldPosition;       /* Vertex coordinates expressed in world space. */
 
 uniform vec4            colorOfGeometry; /* Colour of the geometry. */
 uniform vec3            lightDirection;  /* Normalized direction vector for the spot light. */
 uniform sampler2DShadow shadowMap;       /* Sampler of the depth texture used for shadow-mapping. */
 
+uniform bool      useFilterableShadowMap; /* If true, the spot light shadow is looked up in shadowMoments rather than compared with shadowMap. */
+uniform sampler2D shadowMoments;          /* Sampler of the blurred, mipmapped exponential variance moments of the spot light shadow map. */
+uniform vec2      shadowDepthRange;       /* Near and far plane of the spot light projection. */
+
+uniform bool                 isCameraPointOfView;                                    /* If false, only depth is written, so no shading is needed. */
+uniform vec3                 directionalLightDirection;                              /* Direction of the directional light. */
+uniform int                  numberOfCascades;                                       /* Number of cascades of the directional light shadow map. */
+uniform float                cascadeFarPlanes[maximumNumberOfCascades];              /* Distance from the camera at which each cascade ends. */
+uniform mat4                 cascadeViewProjectionMatrices[maximumNumberOfCascades]; /* View-projection matrices of the cascades. */
+uniform sampler2DArrayShadow cascadeShadowMap;                                       /* Sampler of the depth texture array holding the static, then the dynamic layers of the cascades. */
+
 out vec4 color; /* Output colour variable. */
 
 #define PI 3.14159265358979323846
@@ -58,13 +75,48 @@ struct SpotLight
     vec4  position;             /* Coordinates of position of spot light source. */
 };
 
+/* [Filterable shadow map lookup] */
+/* Upper bound of the fraction of the filter footprint which is lit, from the mean and variance of the occluder depth. */
+float chebyshevUpperBound(vec2 moments, float mean, float minimumVariance)
+{
+    float variance   = max(moments.y - moments.x * moments.x, minimumVariance);
+    float difference = mean - moments.x;
+    /* Cut off the tail of the bound, which is where light bleeds through overlapping occluders. */
+    float bound      = clamp((variance / (variance + difference * difference) - 0.2) / 0.8, 0.0, 1.0);
+
+    return mean <= moments.x ? 1.0 : bound;
+}
+
+/* Visibility of the spot light, from a single trilinear lookup of the exponentially warped moments. */
+float getFilteredShadowVisibility(vec3 positionInShadowMap)
+{
+    float near            = shadowDepthRange.x;
+    float far             = shadowDepthRange.y;
+    float distance        = near * far / (far - positionInShadowMap.z * (far - near));
+    float depth           = 2.0 * (distance - near) / (far - near) - 1.0;
+    vec2  warpedDepth     = vec2(exp(5.0 * depth), -exp(-5.0 * depth));
+    vec2  minimumVariance = 2.5e-5 * warpedDepth * warpedDepth;
+    vec4  moments         = texture(shadowMoments, positionInShadowMap.xy);
+
+    return min(chebyshevUpperBound(moments.xy, warpedDepth.x, minimumVariance.x),
+               chebyshevUpperBound(moments.zw, warpedDepth.y, minimumVariance.y));
+}
+/* [Filterable shadow map lookup] */
+
 void main()
 {
+    /* Shadow maps only hold depth values. Skip the lighting calculations when rendering them. */
+    if (!isCameraPointOfView)
+    {
+        color = vec4(0.0);
+        return;
+    }
+
     DirectionalLight directionalLight;
 
     directionalLight.ambient   = 0.01;
     directionalLight.color     = vec3(1.0,  1.0,  1.0);
-    directionalLight.direction = vec3(0.2, -1.0, -0.2);
+    directionalLight.direction = directionalLightDirection;
 
     SpotLight spotLight;
 
@@ -88,8 +140,33 @@ void main()
     /* Calculate the value of diffuse intensity. */
     float diffuseIntensity = max(0.0, -dot(outputNormal, normalize(directionalLight.direction)));
 
+    /* [Select cascade] */
+    /* Directional light shadow. Use the first cascade which ends behind the fragment. */
+    float eyeDepth                   = -outputPosition.z;
+    float directionalLightVisibility = 1.0;
+
+    if (eyeDepth < cascadeFarPlanes[numberOfCascades - 1])
+    {
+        int cascade = 0;
+
+        while (cascade < numberOfCascades - 1 && eyeDepth > cascadeFarPlanes[cascade])
+        {
+            cascade++;
+        }
+
+        /* The cascades use orthographic projections, so no perspective division is needed. */
+        vec3 positionInCascade = (cascadeViewProjectionMatrices[cascade] * vec4(outputWorldPosition, 1.0)).xyz * 0.5 + 0.5;
+
+        /* A fragment is lit only if neither the cached static casters nor the dynamic casters occlude it. */
+        float staticVisibility  = texture(cascadeShadowMap, vec4(positionInCascade.xy, float(cascade),                    positionInCascade.z));
+        float dynamicVisibility = texture(cascadeShadowMap, vec4(positionInCascade.xy, float(cascade + numberOfCascades), positionInCascade.z));
+
+        directionalLightVisibility = min(staticVisibility, dynamicVisibility);
+    }
+    /* [Select cascade] */
+
     /* Calculate colour for directional lighting. */
-    color = colorOfGeometry * vec4(directionalLight.color * (directionalLight.ambient + diffuseIntensity), 1.0);
+    color = colorOfGeometry * vec4(directionalLight.color * (directionalLight.ambient + diffuseIntensity * directionalLightVisibility), 1.0);
 
     /* Spot light. */
     /* Compute the dot product between normal and light direction. */
@@ -127,9 +204,21 @@ void main()
      */
     const float shadowMapBias = 0.00001;
 
+    /* Partially lit fragments are only found with the filtered moments. */
+    float spotLightVisibility = 0.0;
+
+    if (useFilterableShadowMap)
+    {
+        spotLightVisibility = getFilteredShadowVisibility(normalizedVertexPositionInTexture.xyz);
+    }
+    else if (modelDepth < shadowMapDepth + shadowMapBias)
+    {
+        spotLightVisibility = 1.0;
+    }
+
     if (alpha < spotLight.angle)
     {
-        if (modelDepth < shadowMapDepth + shadowMapBias)
+        if (spotLightVisibility > 0.0)
         {
             float spotEffect = dot(normalize(spotLight.direction), normalize(vectorFromLightToFragment));
 
@@ -143,7 +232,7 @@ void main()
 
             /* Calculate colour for spot lighting.
              * Scale the colour by 0.5 to make the shadows more obvious. */
-            color = color / 0.5 + (attenuation * (normalDotLight + spotLight.ambient));
+            color = mix(color, color / 0.5 + (attenuation * (normalDotLight + spotLight.ambient)), spotLightVisibility);
         }
     }
 
@@ -22,6 +22,8 @@
 /* [Vertex shader code] */
 /* Number of cubes to be drawn. */ 
 #define numberOfCubes 2
+/* Maximum number of cascades of the directional light shadow map. */
+#define maximumNumberOfCascades 4
 
 /* [Define attributes] */
 in vec4 attributePosition; /* Attribute: holding coordinates of triangles that make up a geometry. */
@@ -41,6 +43,10 @@ uniform bool shouldRenderPlane;   /* If true: draw plane, else: draw cubes. */
 
 uniform vec3 planePosition; /* Position of plane used to calculate translation matrix for a plane. */
 
+uniform int  cascadeIndex;                                           /* Index of the cascade being rendered from the directional light's point of view, -1 for the spot light. */
+uniform int  firstCubeIndex;                                         /* Index of the cube drawn by the first instance. */
+uniform mat4 cascadeViewProjectionMatrices[maximumNumberOfCascades]; /* View-projection matrices of the cascades. */
+
 /* Uniform block holding data used for rendering cubes (position of cubes) - used to calculate translation matrix for each cube in world space. */
 uniform cubesDataUniformBlock
 {
@@ -51,6 +57,7 @@ out vec4 outputLightPosition;       /* Output variable: vector of position of sp
 out vec3 outputNormal;              /* Output variable: normal vector for the coordinates. */
 out vec4 outputPosition;            /* Output variable: vertex coordinates expressed in eye space. */
 out mat4 outputViewToTextureMatrix; /* Output variable: matrix we will use in the fragment shader to sample the shadow map for given fragment. */
+out vec3 outputWorldPosition;       /* Output variable: vertex coordinates expressed in world space, used to sample the cascaded shadow map. */
 
 void main()
 {
@@ -70,7 +77,7 @@ void main()
     }
     else
     {
-        modelPosition = vec3(cubesPosition[gl_InstanceID].x, cubesPosition[gl_InstanceID].y, cubesPosition[gl_InstanceID].z);
+        modelPosition = cubesPosition[firstCubeIndex + gl_InstanceID].xyz;
     }
     /* [Use different position for a specific geometry] */
 
@@ -94,6 +101,12 @@ void main()
         modelViewProjectionMatrix = cameraProjectionMatrix * modelViewMatrix;
     
     }
+    /* Compute matrices for the directional light point of view. The light view matrix is part of the cascade matrix. */
+    else if (cascadeIndex >= 0)
+    {
+        modelViewMatrix           = translationMatrix;
+        modelViewProjectionMatrix = cascadeViewProjectionMatrices[cascadeIndex] * translationMatrix;
+    }
     /* Compute matrices for light point of view. */
     else
     {
@@ -121,6 +134,8 @@ void main()
 
     if (isCameraPointOfView)
     {
+        outputWorldPosition = (translationMatrix * attributePosition).xyz;
+
         /* [Calculate matrix that will be used to convert camera to eye space] */
         outputViewToTextureMatrix = biasMatrix * lightProjectionMatrix * lightViewMatrix * inverse(cameraViewMatrix);
         /* [Calculate matrix that will be used to convert camera to eye space] */
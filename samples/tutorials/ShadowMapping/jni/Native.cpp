@@ -27,6 +27,14 @@
  * in 3D space are regularly updated.
  * The cube and planes models are shadow receivers, but only the cubes are shadow casters.
  * The application uses shadow mapping for rendering and displaying shadows.
+ * Shadows of the directional light are rendered into cascaded shadow maps: the camera frustum is split into
+ * NUMBER_OF_CASCADES slices, each covered by its own layer of a depth texture array.
+ * Every cascade keeps the depth of the static plane in a cached layer, and only the bouncing cubes are rendered
+ * into a second, dynamic layer each frame. The fragment shader combines both layers.
+ * The spot light shadow map is converted into a blurred, mipmapped exponential variance shadow map when half float
+ * targets are renderable (see FilterableShadowMap.h), so its soft edges take one filtered lookup per fragment.
+ * The dynamic cascades are culled and recorded into command lists on worker threads in parallel (see CommandList.h),
+ * and the rendering thread only replays them.
  */
 
 #include <jni.h>
@@ -34,10 +42,15 @@
 
 #include <GLES3/gl3.h>
 #include "Common.h"
+#include "CommandList.h"
 #include "CubeModel.h"
+#include "FilterableShadowMap.h"
+#include "GLStateCache.h"
+#include "JobScheduler.h"
 #include "Mathematics.h"
 #include "Matrix.h"
 #include "PlaneModel.h"
+#include "RenderPass.h"
 #include "ShadowMapping.h"
 #include "Shader.h"
 #include "Texture.h"
@@ -82,6 +95,19 @@ struct ShadowMapTextureProperties
     GLsizei width;                 /* Width of the shadow map texture. */
 } shadowMap;
 
+/* Structure holding the data describing the cascaded shadow map of the directional light. */
+struct CascadedShadowMapProperties
+{
+    GLuint framebufferObjectNames[2 * NUMBER_OF_CASCADES]; /* Names of framebuffer objects, each of them renders into one layer of the texture array. */
+    GLuint textureName;                                /* Name of a depth texture array holding the static casters of every cascade, followed by the dynamic casters of every cascade. */
+    float  farPlanes[NUMBER_OF_CASCADES];              /* Distance from the camera at which each cascade ends. */
+    Matrix lightViewMatrix;                            /* View matrix looking along the directional light (rotation only). */
+    Matrix viewProjectionMatrices[NUMBER_OF_CASCADES]; /* Texel-snapped orthographic projection of each cascade multiplied by lightViewMatrix. */
+    Vec3f  boundsMinimum[NUMBER_OF_CASCADES];          /* Minimum corner of the light-space box covered by each cascade. Used for culling the shadow casters. */
+    Vec3f  boundsMaximum[NUMBER_OF_CASCADES];          /* Maximum corner of the light-space box covered by each cascade. Used for culling the shadow casters. */
+    bool   staticLayersNeedUpdate;                     /* Set whenever the cascades are recalculated, that is when the camera or the directional light moves. */
+} cascadedShadowMap;
+
 /* Structure holding the data used for configuring the program object that is responsible for drawing cubes and plane and calculating the shadow map. */
 struct CubesAndPlaneProgramProperties
 {
@@ -100,6 +126,13 @@ struct CubesAndPlaneProgramProperties
     GLuint normalsAttributeLocation;        /* Shader attribute location that is used to hold normal vectors of the cubes or the plane. */
     GLuint positionAttributeLocation;       /* Shader attribute location that is used to hold coordinates of the cubes or the plane to be drawn. */
     GLint  shadowMapLocation;               /* Shader uniform location that is used to hold the shadow map texture unit id. */
+    GLint  useFilterableShadowMapLocation;  /* Shader uniform location that is used to hold a boolean value indicating whether the spot light shadow
+                                             * is looked up in the filtered moments (if true) or compared with the depth texture (if false).
+                                             */
+    GLint  cascadeIndexLocation;            /* Shader uniform location that is used to hold the index of the cascade being rendered from the directional light's point of view,
+                                             * or -1 if the spot light's point of view is used.
+                                             */
+    GLint  firstCubeIndexLocation;          /* Shader uniform location that is used to hold the index of the first cube drawn by an instanced draw call. */
     GLuint shouldRenderPlaneLocation;       /* Shader uniform location that is used to hold boolean value indicating whether the plane (if true) or the cubes
                                              * (if false) are being drawn (different data is used for cubes and plane).
                                              */
@@ -119,6 +152,13 @@ struct LightRepresentationProgramProperties
 /* Instance of a timer. Used for setting position and direction of light source. */
 Timer timer;
 
+/* Blurred moments of the spot light shadow map. NULL if USE_FILTERABLE_SHADOW_MAP is 0 or half float targets are not renderable. */
+FilterableShadowMap* filterableShadowMap = NULL;
+
+/* Records the dynamic cascade casters of every cascade, one cascade per job. */
+JobScheduler jobScheduler;
+CommandList  dynamicCascadeCasters[NUMBER_OF_CASCADES];
+
 /* Buffer object names. */
 GLuint cubeCoordinatesBufferObjectId                = 0; /* Name of buffer object which holds coordinates of the triangles making up the scene cubes. */
 GLuint cubeNormalsBufferObjectId                    = 0; /* Name of buffer object which holds the scene cubes normal vectors. */
@@ -138,6 +178,13 @@ Matrix cameraProjectionMatrix;
 Matrix lightProjectionMatrix;
 
 const Vec3f cameraPosition   = {0.0f, 0.0f, 30.0f}; /* Array holding position of camera. */
+const float cameraFieldOfView = 60.0f;              /* Vertical field of view of the camera, in degrees. */
+const float cameraNearPlane   = 1.0f;               /* Distance to the near plane of the camera. */
+const float cameraFarPlane    = 50.0f;              /* Distance to the far plane of the camera. */
+const float lightNearPlane    = 1.0f;               /* Distance to the near plane of the spot light. */
+const float lightFarPlane     = 50.0f;              /* Distance to the far plane of the spot light. */
+
+const Vec3f directionalLightDirection = {0.2f, -1.0f, -0.2f}; /* Direction of the directional light. */
 Vec3f       lookAtPoint      = {0.0f, 0.0f,  0.0f}; /* Coordinates of a point the camera should look at (from light point of view). */
 Matrix      viewMatrixForShadowMapPass;             /* Matrix used for translating geometry relative to light position. This is used for shadow map rendering pass. */
 
@@ -208,16 +255,21 @@ void initializeStructureData()
     shadowMap.textureName           = 0;
 
     /* We use different projection matrices for both passes. */
-    cameraProjectionMatrix = Matrix::matrixPerspective(degreesToRadians(60.0f),
+    cameraProjectionMatrix = Matrix::matrixPerspective(degreesToRadians(cameraFieldOfView),
                                                        float(window.width) / float(window.height),
-                                                       1.0f,
-                                                       50.0f);
+                                                       cameraNearPlane,
+                                                       cameraFarPlane);
     /* [Calculate projection matrix from spot light point of view] */
     lightProjectionMatrix  = Matrix::matrixPerspective(degreesToRadians(90.0f),
                                                        1.0f,
-                                                       1.0f,
-                                                       50.0f);
+                                                       lightNearPlane,
+                                                       lightFarPlane);
     /* [Calculate projection matrix from spot light point of view] */
+
+    /* Set up cascaded shadow map properties. */
+    memset(cascadedShadowMap.framebufferObjectNames, 0, sizeof(cascadedShadowMap.framebufferObjectNames));
+    cascadedShadowMap.textureName = 0;
+    cascadedShadowMap.staticLayersNeedUpdate = true;
 }
 
 /**
@@ -300,6 +352,54 @@ void createObjects()
                                     shadowMap.textureName,
                                     0));
     /* [Bind depth texture to framebuffer] */
+
+    /* Generate and configure the texture array holding depth values of every cascade.
+     * 16-bit depth is enough for the orthographic projections of the cascades and halves memory and bandwidth.
+     * Layers [0, NUMBER_OF_CASCADES) cache the static casters, the following ones hold the dynamic casters. */
+    GL_CHECK(glGenTextures  (1,
+                            &cascadedShadowMap.textureName));
+    GL_CHECK(glBindTexture  (GL_TEXTURE_2D_ARRAY,
+                             cascadedShadowMap.textureName));
+    GL_CHECK(glTexStorage3D (GL_TEXTURE_2D_ARRAY,
+                             1,
+                             GL_DEPTH_COMPONENT16,
+                             CASCADE_SHADOW_MAP_RESOLUTION,
+                             CASCADE_SHADOW_MAP_RESOLUTION,
+                             2 * NUMBER_OF_CASCADES));
+    /* Linear filtering of a depth comparison gives 2x2 percentage-closer filtering for free. */
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY,
+                             GL_TEXTURE_MIN_FILTER,
+                             GL_LINEAR));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY,
+                             GL_TEXTURE_MAG_FILTER,
+                             GL_LINEAR));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY,
+                             GL_TEXTURE_WRAP_S,
+                             GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY,
+                             GL_TEXTURE_WRAP_T,
+                             GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY,
+                             GL_TEXTURE_COMPARE_FUNC,
+                             GL_LEQUAL));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY,
+                             GL_TEXTURE_COMPARE_MODE,
+                             GL_COMPARE_REF_TO_TEXTURE));
+
+    /* Attach each layer of the texture array to the depth attachment point of its own framebuffer object. */
+    GL_CHECK(glGenFramebuffers(2 * NUMBER_OF_CASCADES,
+                               cascadedShadowMap.framebufferObjectNames));
+
+    for (int layerIndex = 0; layerIndex < 2 * NUMBER_OF_CASCADES; layerIndex++)
+    {
+        GL_CHECK(glBindFramebuffer        (GL_FRAMEBUFFER,
+                                           cascadedShadowMap.framebufferObjectNames[layerIndex]));
+        GL_CHECK(glFramebufferTextureLayer(GL_FRAMEBUFFER,
+                                           GL_DEPTH_ATTACHMENT,
+                                           cascadedShadowMap.textureName,
+                                           0,
+                                           layerIndex));
+    }
 }
 
 /**
@@ -317,9 +417,15 @@ void deleteObjects()
 
     /* Delete framebuffer object. */
     GL_CHECK(glDeleteFramebuffers(1, &shadowMap.framebufferObjectName));
+    GL_CHECK(glDeleteFramebuffers(2 * NUMBER_OF_CASCADES, cascadedShadowMap.framebufferObjectNames));
 
-    /* Delete texture. */
+    /* Delete textures. */
     GL_CHECK(glDeleteTextures(1, &shadowMap.textureName));
+    GL_CHECK(glDeleteTextures(1, &cascadedShadowMap.textureName));
+
+    delete filterableShadowMap;
+
+    filterableShadowMap = NULL;
 
     /* Delete vertex arrays. */
     GL_CHECK(glDeleteVertexArrays(1, &cubesVertexArrayObjectId));
@@ -414,6 +520,105 @@ void calculateLookAtMatrix()
                                  viewMatrixForShadowMapPass;
 }
 
+/**
+ * \brief Calculates the cascades of the directional light shadow map.
+ *
+ * The camera frustum is split into NUMBER_OF_CASCADES slices and each slice is enclosed in a bounding sphere.
+ * A sphere keeps the size of a cascade independent of the camera orientation, and moving the cascade in whole texels
+ * of its shadow map keeps the rasterization of the shadow casters, and so the shadow edges, stable when the camera moves.
+ */
+void calculateCascades()
+{
+    Vec3f origin   = {0.0f, 0.0f,  0.0f};
+    Vec3f upVector = {0.0f, 0.0f, -1.0f};
+
+    /* Blend between logarithmic split distances, which match the perspective aliasing, and uniform ones, which keep the far cascades from growing too large. */
+    const float splitLambda = 0.75f;
+    /* Shadow casters between the light and a cascade have to be rendered into it too, so each cascade is extended towards the light by the size of the scene. */
+    const float casterExtension = 2.0f * plane.scalingFactor;
+
+    const float tangentOfHalfFieldOfView = tanf(degreesToRadians(cameraFieldOfView) / 2.0f);
+    const float aspectRatio              = float(window.width) / float(window.height);
+    /* Squared distance of a frustum corner from the view axis, divided by the squared distance from the camera plane. */
+    const float cornerSpread             = tangentOfHalfFieldOfView * tangentOfHalfFieldOfView * (1.0f + aspectRatio * aspectRatio);
+
+    /* The light is directional, so its view matrix only needs to rotate the scene. Translation is handled by the projections of the cascades. */
+    cascadedShadowMap.lightViewMatrix = Matrix::matrixLookAt(origin, directionalLightDirection, upVector);
+
+    float sliceNear = cameraNearPlane;
+
+    for (int cascadeIndex = 0; cascadeIndex < NUMBER_OF_CASCADES; cascadeIndex++)
+    {
+        const float fraction         = float(cascadeIndex + 1) / float(NUMBER_OF_CASCADES);
+        const float logarithmicSplit = cameraNearPlane * powf(cameraFarPlane / cameraNearPlane, fraction);
+        const float uniformSplit     = cameraNearPlane + (cameraFarPlane - cameraNearPlane) * fraction;
+        const float sliceFar         = splitLambda * logarithmicSplit + (1.0f - splitLambda) * uniformSplit;
+
+        /* The center of the bounding sphere lies on the view axis, at the point equally distant from the near and the far corners of the slice. */
+        float centerDistance = 0.5f * (sliceFar + sliceNear) * (1.0f + cornerSpread);
+
+        if (centerDistance > sliceFar)
+        {
+            centerDistance = sliceFar;
+        }
+
+        float radius = sqrtf((sliceFar - centerDistance) * (sliceFar - centerDistance) + sliceFar * sliceFar * cornerSpread);
+
+        /* Round the radius up, so that a cascade does not change its size due to floating-point noise. */
+        radius = ceilf(radius * 16.0f) / 16.0f;
+
+        /* The camera looks along the negative Z axis. */
+        Vec3f center           = {cameraPosition.x, cameraPosition.y, cameraPosition.z - centerDistance};
+        Vec3f lightSpaceCenter = Matrix::vertexTransform(&center, &cascadedShadowMap.lightViewMatrix);
+
+        /* [Snap cascade to shadow map texels] */
+        const float texelSize = 2.0f * radius / float(CASCADE_SHADOW_MAP_RESOLUTION);
+
+        lightSpaceCenter.x = floorf(lightSpaceCenter.x / texelSize) * texelSize;
+        lightSpaceCenter.y = floorf(lightSpaceCenter.y / texelSize) * texelSize;
+        /* [Snap cascade to shadow map texels] */
+
+        /* The light looks along the negative Z axis of the light space, so the casters extension is added to the maximum Z. */
+        Vec3f boundsMinimum = {lightSpaceCenter.x - radius, lightSpaceCenter.y - radius, lightSpaceCenter.z - radius};
+        Vec3f boundsMaximum = {lightSpaceCenter.x + radius, lightSpaceCenter.y + radius, lightSpaceCenter.z + radius + casterExtension};
+
+        Matrix projectionMatrix = Matrix::matrixOrthographic(boundsMinimum.x,
+                                                             boundsMaximum.x,
+                                                             boundsMinimum.y,
+                                                             boundsMaximum.y,
+                                                            -boundsMaximum.z,
+                                                            -boundsMinimum.z);
+
+        cascadedShadowMap.boundsMinimum[cascadeIndex]          = boundsMinimum;
+        cascadedShadowMap.boundsMaximum[cascadeIndex]          = boundsMaximum;
+        cascadedShadowMap.farPlanes[cascadeIndex]              = sliceFar;
+        cascadedShadowMap.viewProjectionMatrices[cascadeIndex] = projectionMatrix * cascadedShadowMap.lightViewMatrix;
+
+        sliceNear = sliceFar;
+    }
+
+    /* The cached depth of the static casters no longer matches the cascades. */
+    cascadedShadowMap.staticLayersNeedUpdate = true;
+}
+
+/**
+ * \brief Checks whether a bounding sphere overlaps the light-space box covered by a cascade.
+ * \param[in] cascadeIndex Index of the cascade to check.
+ * \param[in] center       Center of the bounding sphere in world space.
+ * \param[in] radius       Radius of the bounding sphere.
+ * \return True if the sphere has to be rendered into the cascade.
+ */
+bool isInsideCascade(int cascadeIndex, const Vec3f& center, float radius)
+{
+    const Vec3f& boundsMinimum    = cascadedShadowMap.boundsMinimum[cascadeIndex];
+    const Vec3f& boundsMaximum    = cascadedShadowMap.boundsMaximum[cascadeIndex];
+    Vec3f        lightSpaceCenter = Matrix::vertexTransform(&center, &cascadedShadowMap.lightViewMatrix);
+
+    return lightSpaceCenter.x + radius >= boundsMinimum.x && lightSpaceCenter.x - radius <= boundsMaximum.x &&
+           lightSpaceCenter.y + radius >= boundsMinimum.y && lightSpaceCenter.y - radius <= boundsMaximum.y &&
+           lightSpaceCenter.z + radius >= boundsMinimum.z && lightSpaceCenter.z - radius <= boundsMaximum.z;
+}
+
 /* [Generate geometry data] */
 /**
  * \brief Initialize data used for drawing the scene.
@@ -513,7 +718,7 @@ void initializeData()
     GL_CHECK(glBufferData(GL_ARRAY_BUFFER,
                           cube.numberOfElementsInPositionArray * sizeof(float),
                           cube.position,
-                          GL_STATIC_DRAW));
+                          GL_DYNAMIC_DRAW));
 }
 
 /**
@@ -574,6 +779,9 @@ void setupCubesAndPlaneProgram()
     /* [Get depth texture uniform location] */
     cubesAndPlaneProgram.shadowMapLocation           = GL_CHECK(glGetUniformLocation(cubesAndPlaneProgram.programId, "shadowMap"));
     /* [Get depth texture uniform location] */
+    cubesAndPlaneProgram.cascadeIndexLocation        = GL_CHECK(glGetUniformLocation(cubesAndPlaneProgram.programId, "cascadeIndex"));
+    cubesAndPlaneProgram.firstCubeIndexLocation      = GL_CHECK(glGetUniformLocation(cubesAndPlaneProgram.programId, "firstCubeIndex"));
+    cubesAndPlaneProgram.useFilterableShadowMapLocation = GL_CHECK(glGetUniformLocation(cubesAndPlaneProgram.programId, "useFilterableShadowMap"));
 
     /* Get uniform locations and uniform block index (index of "cubesDataUniformBlock" uniform block) for the current program.
      * Values for those uniforms will be set now (only once, because they are constant).
@@ -583,6 +791,13 @@ void setupCubesAndPlaneProgram()
     GLuint cameraPositionLocation         = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "cameraPosition"));           /* Uniform holding the position of camera (which is used to render the scene from the camera's point of view). */
     GLuint cameraProjectionMatrixLocation = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "cameraProjectionMatrix"));   /* Uniform holding the projection matrix (which is used to render the scene from the camera's point of view). */
     GLuint lightProjectionMatrixLocation  = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "lightProjectionMatrix"));    /* Uniform holding the projection matrix (which is used to render the scene from the light's point of view). */
+    GLint  cascadeMatricesLocation        = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "cascadeViewProjectionMatrices")); /* Uniform holding the view-projection matrix of each cascade. */
+    GLint  cascadeFarPlanesLocation       = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "cascadeFarPlanes"));         /* Uniform holding the distance from the camera at which each cascade ends. */
+    GLint  numberOfCascadesLocation       = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "numberOfCascades"));         /* Uniform holding the number of cascades in use. */
+    GLint  cascadeShadowMapLocation       = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "cascadeShadowMap"));         /* Uniform holding the cascaded shadow map texture unit id. */
+    GLint  directionalLightLocation       = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "directionalLightDirection")); /* Uniform holding the direction of the directional light. */
+    GLint  shadowMomentsLocation          = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "shadowMoments"));            /* Uniform holding the filtered moments texture unit id. */
+    GLint  shadowDepthRangeLocation       = GL_CHECK(glGetUniformLocation  (cubesAndPlaneProgram.programId, "shadowDepthRange"));         /* Uniform holding the near and far plane of the spot light. */
 
     /* Check if uniform and attribute locations were found in the shaders. */
     ASSERT(cubesAndPlaneProgram.positionAttributeLocation   != -1,               "Could not retrieve attribute location: positionAttributeLocation.");
@@ -599,6 +814,16 @@ void setupCubesAndPlaneProgram()
     ASSERT(cameraPositionLocation                           != -1,               "Could not retrieve uniform location: cameraPositionLocation");
     ASSERT(cameraProjectionMatrixLocation                   != -1,               "Could not retrieve uniform location: cameraProjectionMatrixLocation");
     ASSERT(lightProjectionMatrixLocation                    != -1,               "Could not retrieve uniform location: lightProjectionMatrixLocation");
+    ASSERT(cubesAndPlaneProgram.cascadeIndexLocation        != -1,               "Could not retrieve uniform location: cascadeIndexLocation");
+    ASSERT(cubesAndPlaneProgram.firstCubeIndexLocation      != -1,               "Could not retrieve uniform location: firstCubeIndexLocation");
+    ASSERT(cascadeMatricesLocation                          != -1,               "Could not retrieve uniform location: cascadeMatricesLocation");
+    ASSERT(cascadeFarPlanesLocation                         != -1,               "Could not retrieve uniform location: cascadeFarPlanesLocation");
+    ASSERT(numberOfCascadesLocation                         != -1,               "Could not retrieve uniform location: numberOfCascadesLocation");
+    ASSERT(cascadeShadowMapLocation                         != -1,               "Could not retrieve uniform location: cascadeShadowMapLocation");
+    ASSERT(directionalLightLocation                         != -1,               "Could not retrieve uniform location: directionalLightLocation");
+    ASSERT(cubesAndPlaneProgram.useFilterableShadowMapLocation != -1,            "Could not retrieve uniform location: useFilterableShadowMapLocation");
+    ASSERT(shadowMomentsLocation                            != -1,               "Could not retrieve uniform location: shadowMomentsLocation");
+    ASSERT(shadowDepthRangeLocation                         != -1,               "Could not retrieve uniform location: shadowDepthRangeLocation");
 
     /*
      * Set the binding point for the uniform block. The uniform block holds the position of the scene cubes.
@@ -621,6 +846,38 @@ void setupCubesAndPlaneProgram()
                                    1,
                                    GL_FALSE,
                                    lightProjectionMatrix.getAsArray()));
+
+    /* The cascades are static, so their uniforms are set just once as well. */
+    float cascadeMatrices[NUMBER_OF_CASCADES * 16];
+
+    for (int cascadeIndex = 0; cascadeIndex < NUMBER_OF_CASCADES; cascadeIndex++)
+    {
+        memcpy(cascadeMatrices + cascadeIndex * 16,
+               cascadedShadowMap.viewProjectionMatrices[cascadeIndex].getAsArray(),
+               16 * sizeof(float));
+    }
+
+    GL_CHECK(glUniformMatrix4fv   (cascadeMatricesLocation,
+                                   NUMBER_OF_CASCADES,
+                                   GL_FALSE,
+                                   cascadeMatrices));
+    GL_CHECK(glUniform1fv         (cascadeFarPlanesLocation,
+                                   NUMBER_OF_CASCADES,
+                                   cascadedShadowMap.farPlanes));
+    GL_CHECK(glUniform1i          (numberOfCascadesLocation,
+                                   NUMBER_OF_CASCADES));
+    GL_CHECK(glUniform1i          (cascadeShadowMapLocation,
+                                   1));
+    GL_CHECK(glUniform3fv         (directionalLightLocation,
+                                   1,
+                                   (float*)&directionalLightDirection));
+    GL_CHECK(glUniform1i          (shadowMomentsLocation,
+                                   2));
+    GL_CHECK(glUniform2f          (shadowDepthRangeLocation,
+                                   lightNearPlane,
+                                   lightFarPlane));
+    GL_CHECK(glUniform1i          (cubesAndPlaneProgram.useFilterableShadowMapLocation,
+                                   false));
 }
 
 /**
@@ -676,9 +933,6 @@ void setupLightRepresentationProgram()
  */
 void draw(bool hasShadowMapBeenCalculated)
 {
-    /* Clear the depth and color buffers. */
-    GL_CHECK(glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT));
-
     /* Let's focus on drawing the model. */
     GL_CHECK(glUseProgram(cubesAndPlaneProgram.programId));
 
@@ -697,6 +951,9 @@ void draw(bool hasShadowMapBeenCalculated)
 
     /* Set uniform value indicating point of view: camera or light. */
     GL_CHECK(glUniform1i(cubesAndPlaneProgram.isCameraPointOfViewLocation, hasShadowMapBeenCalculated));
+    /* The spot light is used rather than one of the cascades, and both cubes are drawn. */
+    GL_CHECK(glUniform1i(cubesAndPlaneProgram.cascadeIndexLocation,        -1));
+    GL_CHECK(glUniform1i(cubesAndPlaneProgram.firstCubeIndexLocation,      0));
 
     /* If the light's point of view, set calculated view matrix. (View is static from camera point of view - no need to change that value). */
     if (!hasShadowMapBeenCalculated)
@@ -766,20 +1023,153 @@ void draw(bool hasShadowMapBeenCalculated)
     }
 }
 
+/**
+ * \brief Draw the static shadow casters (the plane) which overlap a cascade from the directional light's point of view.
+ * \param[in] cascadeIndex Index of the cascade to draw.
+ */
+void drawStaticCascadeCasters(int cascadeIndex)
+{
+    const float planeRadius = plane.scalingFactor * sqrtf(2.0f);
+    Vec3f       planeCenter = {plane.position[0], plane.position[1], plane.position[2]};
+
+    if (isInsideCascade(cascadeIndex, planeCenter, planeRadius))
+    {
+        GL_CHECK(glUniform1i      (cubesAndPlaneProgram.cascadeIndexLocation,      cascadeIndex));
+        GL_CHECK(glUniform1i      (cubesAndPlaneProgram.shouldRenderPlaneLocation, true));
+        GL_CHECK(glBindVertexArray(planeVertexArrayObjectId));
+        GL_CHECK(glDrawArrays     (GL_TRIANGLES, 0, plane.numberOfPoints));
+    }
+}
+
+/**
+ * \brief Record the dynamic shadow casters (the cubes) which overlap a cascade from the directional light's point of view.
+ *
+ * Runs on a worker thread, so it only reads the scene and writes to the cascade's command list.
+ * \param[in] cascadeIndex Index of the cascade to record.
+ */
+void recordDynamicCascadeCasters(int cascadeIndex)
+{
+    const int    numberOfCubes    = cube.numberOfElementsInPositionArray / 4;
+    const float  cubeRadius       = cube.scalingFactor * sqrtf(3.0f);
+    int          firstVisibleCube = -1;
+    CommandList& commandList      = dynamicCascadeCasters[cascadeIndex];
+
+    commandList.reset();
+    commandList.useProgram     (cubesAndPlaneProgram.programId);
+    commandList.uniform1i      (cubesAndPlaneProgram.cascadeIndexLocation,      cascadeIndex);
+    commandList.uniform1i      (cubesAndPlaneProgram.shouldRenderPlaneLocation, false);
+    commandList.bindVertexArray(cubesVertexArrayObjectId);
+
+    /* Cull the cubes against the cascade and draw each run of consecutive visible cubes with one instanced draw call. */
+    for (int cubeIndex = 0; cubeIndex <= numberOfCubes; cubeIndex++)
+    {
+        bool isVisible = false;
+
+        if (cubeIndex < numberOfCubes)
+        {
+            Vec3f cubeCenter = {cube.position[4 * cubeIndex], cube.position[4 * cubeIndex + 1], cube.position[4 * cubeIndex + 2]};
+
+            isVisible = isInsideCascade(cascadeIndex, cubeCenter, cubeRadius);
+        }
+
+        if (isVisible && firstVisibleCube < 0)
+        {
+            firstVisibleCube = cubeIndex;
+        }
+        else if (!isVisible && firstVisibleCube >= 0)
+        {
+            commandList.uniform1i (cubesAndPlaneProgram.firstCubeIndexLocation, firstVisibleCube);
+            commandList.drawArrays(GL_TRIANGLES, 0, cube.numberOfPoints, cubeIndex - firstVisibleCube);
+
+            firstVisibleCube = -1;
+        }
+    }
+}
+
+/**
+ * \brief JobScheduler::RangeFunction recording the dynamic casters of cascades [begin, end).
+ */
+void recordDynamicCascadeCastersRange(unsigned int begin, unsigned int end, void* userData)
+{
+    for (unsigned int cascadeIndex = begin; cascadeIndex < end; cascadeIndex++)
+    {
+        recordDynamicCascadeCasters(cascadeIndex);
+    }
+}
+
+/**
+ * \brief JobScheduler::JobFunction recording the dynamic casters of all the cascades in parallel.
+ */
+void recordDynamicCascadeCastersJob(void* userData)
+{
+    jobScheduler.parallelFor("record_cascade", NUMBER_OF_CASCADES, 1, recordDynamicCascadeCastersRange, NULL);
+}
+
+/**
+ * \brief Draw the scene from the directional light's point of view into the cascaded shadow map.
+ *
+ * The static layers are only redrawn after the cascades have changed; the dynamic layers are redrawn on every call.
+ */
+void createCascadedShadowMap()
+{
+    /* The workers cull and record the dynamic casters while the static layers are drawn. */
+    JobScheduler::Job* recordJob = jobScheduler.create("record_cascade_casters", recordDynamicCascadeCastersJob, NULL);
+    jobScheduler.submit(recordJob);
+
+    GL_CHECK(glUseProgram(cubesAndPlaneProgram.programId));
+    GL_CHECK(glUniform1i (cubesAndPlaneProgram.isCameraPointOfViewLocation, false));
+
+    GL_CHECK(glEnable   (GL_CULL_FACE));
+    GL_CHECK(glEnable   (GL_DEPTH_TEST));
+    GL_CHECK(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+
+    /* 16-bit depth needs a larger offset than the spot light shadow map. */
+    GL_CHECK(glEnable       (GL_POLYGON_OFFSET_FILL));
+    GL_CHECK(glPolygonOffset(2.0, 4.0));
+
+    if (cascadedShadowMap.staticLayersNeedUpdate)
+    {
+        for (int cascadeIndex = 0; cascadeIndex < NUMBER_OF_CASCADES; cascadeIndex++)
+        {
+            RenderPass staticPass(cascadedShadowMap.framebufferObjectNames[cascadeIndex], CASCADE_SHADOW_MAP_RESOLUTION, CASCADE_SHADOW_MAP_RESOLUTION);
+            staticPass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 2);
+
+            staticPass.begin();
+            drawStaticCascadeCasters(cascadeIndex);
+            staticPass.end();
+        }
+
+        cascadedShadowMap.staticLayersNeedUpdate = false;
+    }
+
+    /* The rest of the sample binds programs and vertex arrays directly, so the cache filtering the replay starts from scratch. */
+    jobScheduler.wait(recordJob);
+    GLStateCache::invalidate();
+
+    for (int cascadeIndex = 0; cascadeIndex < NUMBER_OF_CASCADES; cascadeIndex++)
+    {
+        RenderPass dynamicPass(cascadedShadowMap.framebufferObjectNames[NUMBER_OF_CASCADES + cascadeIndex], CASCADE_SHADOW_MAP_RESOLUTION, CASCADE_SHADOW_MAP_RESOLUTION);
+        dynamicPass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 2);
+
+        dynamicPass.begin();
+        dynamicCascadeCasters[cascadeIndex].execute();
+        dynamicPass.end();
+    }
+
+    GL_CHECK(glPolygonOffset(1.0, 0.0));
+    GL_CHECK(glDisable      (GL_POLYGON_OFFSET_FILL));
+}
+
 /**
  * \brief Draw the scene from the light's point of view to calculate depth values (calculated values are held in shadow map texture).
  */
 void createShadowMap()
 {
-    /* Bind framebuffer object.
-     * There is a texture attached to depth attachment point for this framebuffer object.
-     * By using this framebuffer object, calculated depth values are stored in the texture. */
-    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, shadowMap.framebufferObjectName));
-
-    /* Set the view port to size of shadow map texture. */
-    /* [Set viewport for light perspective] */
-    GL_CHECK(glViewport(0, 0, shadowMap.width, shadowMap.height));
-    /* [Set viewport for light perspective] */
+    /* There is a texture attached to depth attachment point for this framebuffer object.
+     * By using this framebuffer object, calculated depth values are stored in the texture,
+     * so the depth attachment is the one attachment which has to be written out. */
+    RenderPass shadowPass(shadowMap.framebufferObjectName, shadowMap.width, shadowMap.height);
+    shadowPass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 4);
 
     /* Set back face to be culled */
     GL_CHECK(glEnable(GL_CULL_FACE));
@@ -794,6 +1184,11 @@ void createShadowMap()
     GL_CHECK(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
     /* [Set colour mask for shadow map rendering] */
 
+    /* Bind the framebuffer object, set the view port to size of shadow map texture and clear the depth values. */
+    /* [Set viewport for light perspective] */
+    shadowPass.begin();
+    /* [Set viewport for light perspective] */
+
     /* Update the lookAt matrix that we use for view matrix (to look at scene from the light's point of view). */
     calculateLookAtMatrix();
 
@@ -809,6 +1204,8 @@ void createShadowMap()
     draw(false);
     /* [Draw the scene from spot light point of view] */
     GL_CHECK(glDisable(GL_POLYGON_OFFSET_FILL));
+
+    shadowPass.end();
 }
 
 /**
@@ -816,23 +1213,28 @@ void createShadowMap()
  */
 void drawScene()
 {
-    /* Use the default framebuffer object. */
-    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
-
-    /* Set the view port to the size of the window. */
-    GL_CHECK(glViewport(0, 0, window.width, window.height));
+    /* Use the default framebuffer object. Its depth buffer is not needed once the scene is drawn. */
+    RenderPass scenePass(0, window.width, window.height);
+    scenePass.setAttachment(RenderPass::ATTACHMENT_COLOR, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_STORE, 4);
+    scenePass.setAttachment(RenderPass::ATTACHMENT_DEPTH, RenderPass::LOAD_OP_CLEAR, RenderPass::STORE_OP_DONT_CARE, 4);
 
-    /* Disable culling. */
+    /* Disable culling. Filtering the shadow map turns depth testing off, so enable it again. */
     GL_CHECK(glDisable(GL_CULL_FACE));
+    GL_CHECK(glEnable (GL_DEPTH_TEST));
 
     /* Enable writing of each frame buffer color component. */
     GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
 
+    /* Bind the default framebuffer object, set the view port to the size of the window and clear it. */
+    scenePass.begin();
+
     /* Draw the scene.
      * Value of parameter indicates that shadow map has been already calculated and the normal scene should now be drawn.
      * All elements should be drawn (scene cubes, plane, and the light cube).
      * Scene should be rendered from the camera's point of view. */
     draw(true);
+
+    scenePass.end();
 }
 
 /**
@@ -860,14 +1262,40 @@ void renderFrame()
     light.direction.normalize();
     /* [Update spot light position and direction] */
 
-    /* Clear the contents of back buffer. */
-    GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    /* Bounce the cubes on the plane. Each cube is half a period behind the previous one. */
+    const int   numberOfCubes  = cube.numberOfElementsInPositionArray / 4;
+    const float restingHeight  = plane.position[1] + cube.scalingFactor;
+    const float bounceHeight   = 1.5f;
+
+    for (int cubeIndex = 0; cubeIndex < numberOfCubes; cubeIndex++)
+    {
+        cube.position[4 * cubeIndex + 1] = restingHeight + bounceHeight * fabsf(sinf(1.5f * time + M_PI * 0.5f * cubeIndex));
+    }
+
+    GL_CHECK(glBindBuffer   (GL_UNIFORM_BUFFER, uniformBlockDataBufferObjectId));
+    GL_CHECK(glBufferSubData(GL_UNIFORM_BUFFER,
+                             0,
+                             cube.numberOfElementsInPositionArray * sizeof(float),
+                             cube.position));
+
+    /* Fill the cascaded shadow map of the directional light. Only the layers of the moving cubes are redrawn. */
+    createCascadedShadowMap();
 
     /* Fill the shadow map texture with the calculated depth values. */
     createShadowMap();
 
+    /* Blur the moments of the new depth values. The moments stay bound to texture unit 2, the depth texture is bound back to unit 0. */
+    if (filterableShadowMap != NULL)
+    {
+        filterableShadowMap->update(shadowMap.textureName);
+
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, shadowMap.textureName));
+    }
+
     /* Draw the scene consisting of all objects, light and shadow. Use created shadow map to display shadows. */
     drawScene();
+
+    RenderPass::endFrame();
 }
 
 void setupGraphics(int width, int height)
@@ -880,17 +1308,37 @@ void setupGraphics(int width, int height)
 
     initializeStructureData();
     initializeData();
+    calculateCascades();
 
     /* Set up the program for rendering the scene. */
     setupCubesAndPlaneProgram();
     setupLightRepresentationProgram();
 
+    /* The moments are half the resolution of the depth texture in each direction. */
+    if (USE_FILTERABLE_SHADOW_MAP && FilterableShadowMap::isSupported())
+    {
+        filterableShadowMap = new FilterableShadowMap(shadowMap.width / 2, shadowMap.height / 2, lightNearPlane, lightFarPlane);
+
+        GL_CHECK(glUseProgram   (cubesAndPlaneProgram.programId));
+        GL_CHECK(glUniform1i    (cubesAndPlaneProgram.useFilterableShadowMapLocation, true));
+        GL_CHECK(glActiveTexture(GL_TEXTURE2));
+        GL_CHECK(glBindTexture  (GL_TEXTURE_2D, filterableShadowMap->getTexture()));
+    }
+    else if (USE_FILTERABLE_SHADOW_MAP)
+    {
+        LOGI("Half float render targets are not supported: the spot light shadow map is compared without filtering.\n");
+    }
+
     /* [Set shadow map drawing properties] */
     /* Set the Polygon offset, used when rendering the into the shadow map to eliminate z-fighting in the shadows. */
     GL_CHECK(glPolygonOffset(1.0, 0.0));
     GL_CHECK(glCullFace(GL_BACK));
     /* [Set shadow map drawing properties] */
 
+    /* The cascaded shadow map uses texture unit 1. */
+    GL_CHECK(glActiveTexture(GL_TEXTURE1));
+    GL_CHECK(glBindTexture  (GL_TEXTURE_2D_ARRAY, cascadedShadowMap.textureName));
+
     /* [Bind depth texture to specific binding point] */
     /* Set active texture. Shadow map texture will be passed to shader. */
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
@@ -922,12 +1370,18 @@ void setupGraphics(int width, int height)
     /* Bind buffer with uniform data. Used to set the locations of the cubes. */
     GL_CHECK(glBindBufferBase(GL_UNIFORM_BUFFER, 0, uniformBlockDataBufferObjectId));
 
+    if (jobScheduler.getNumberOfWorkers() == 0)
+    {
+        jobScheduler.initialize(0);
+    }
+
     /* Start counting time. */
     timer.reset();
 }
 
 void uninit()
 {
+    jobScheduler.terminate();
     /* Delete all created GL objects. */
     deleteObjects();
     /* Deallocate memory. */
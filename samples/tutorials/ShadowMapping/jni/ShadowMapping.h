@@ -35,5 +35,24 @@ namespace MaliSDK
     #define FRAGMENT_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.shadowMapping/files/lighting_fragment_shader_source.frag")
     /** Name of a vertex shader file that will be used to render a scene. */
     #define VERTEX_SHADER_FILE_NAME ("/data/data/com.arm.malideveloper.openglessdk.shadowMapping/files/model_vertex.vert")
+
+    #ifndef NUMBER_OF_CASCADES
+        /** Number of cascades the directional light shadow map is split into. Must not exceed 4, the size of the cascade arrays in the shaders. */
+        #define NUMBER_OF_CASCADES (3)
+    #endif /* NUMBER_OF_CASCADES */
+
+    #if NUMBER_OF_CASCADES < 1 || NUMBER_OF_CASCADES > 4
+        #error NUMBER_OF_CASCADES must be between 1 and 4.
+    #endif
+
+    #ifndef CASCADE_SHADOW_MAP_RESOLUTION
+        /** Width and height of every layer of the cascaded shadow map texture array. */
+        #define CASCADE_SHADOW_MAP_RESOLUTION (1024)
+    #endif /* CASCADE_SHADOW_MAP_RESOLUTION */
+
+    #ifndef USE_FILTERABLE_SHADOW_MAP
+        /** If 1, the spot light shadow is looked up in blurred, mipmapped moments of the shadow map where half float targets are renderable. If 0, the depth is always compared. */
+        #define USE_FILTERABLE_SHADOW_MAP (1)
+    #endif /* USE_FILTERABLE_SHADOW_MAP */
 }
 #endif /* SHADOW_MAPPING_H */
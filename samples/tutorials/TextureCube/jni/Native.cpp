@@ -28,9 +28,11 @@
 #include <cstdlib>
 #include <cmath>
 
-#include "Matrix.h"
+#include "MatrixFunctions.h"
 #include "Texture.h"
 
+using namespace MaliSDK;
+
 #define LOG_TAG "libNative"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
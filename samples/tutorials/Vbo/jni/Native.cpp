@@ -28,7 +28,9 @@
 #include <cstdlib>
 #include <cmath>
 
-#include "Matrix.h"
+#include "MatrixFunctions.h"
+
+using namespace MaliSDK;
 
 #define LOG_TAG "libNative"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)